@@ -2,4 +2,5 @@
 GRANT ALL ON TABLE documentdb_api_distributed.documentdb_cluster_data TO __API_ADMIN_ROLE__;
 GRANT SELECT ON TABLE documentdb_api_distributed.documentdb_cluster_data TO __API_READONLY_ROLE__;
 
-#include "udfs/operations/move_collection--0.109-0.sql"
\ No newline at end of file
+#include "udfs/operations/move_collection--0.109-0.sql"
+#include "udfs/rebalancer/rebalancer_operations--0.109-0.sql"
@@ -17,4 +17,23 @@ CREATE OR REPLACE FUNCTION __API_DISTRIBUTED_SCHEMA__.rebalancer_stop(p_spec __C
  RETURNS __CORE_SCHEMA_V2__.bson
  LANGUAGE C
    STRICT
- AS 'MODULE_PATHNAME', $$command_rebalancer_stop$$;
\ No newline at end of file
+ AS 'MODULE_PATHNAME', $$command_rebalancer_stop$$;
+
+CREATE OR REPLACE FUNCTION __API_DISTRIBUTED_SCHEMA__.shard_load_cost(shard_id bigint)
+ RETURNS real
+ LANGUAGE C
+   STRICT
+ AS 'MODULE_PATHNAME', $$documentdb_shard_load_cost$$;
+
+DO LANGUAGE plpgsql $cmd$
+BEGIN
+    IF NOT EXISTS (SELECT 1 FROM pg_catalog.pg_dist_rebalance_strategy WHERE name = 'by_operation_load') THEN
+        PERFORM pg_catalog.citus_add_rebalance_strategy(
+            'by_operation_load',
+            '__API_DISTRIBUTED_SCHEMA__.shard_load_cost',
+            'pg_catalog.citus_node_capacity_1',
+            'pg_catalog.citus_shard_allowed_on_node_true',
+            0.1, 0.01, 0.5);
+    END IF;
+END;
+$cmd$;
@@ -51,6 +51,9 @@ extern char *ApiExtensionName;
 extern char *ApiGucPrefix;
 extern char *ClusterAdminRole;
 
+/* 升级时单条 GRANT 语句授权的集合表数量 */
+#define READ_ONLY_ROLE_GRANT_BATCH_SIZE 100
+
 /* 分布式 API 的 schema 名称 */
 char *ApiDistributedSchemaName = "documentdb_api_distributed";
 char *ApiDistributedSchemaNameV2 = "documentdb_api_distributed";
@@ -1010,6 +1013,9 @@ GetInstalledVersion(ExtensionVersion *installedVersion)
 
 /*
  * SetPermissionsForReadOnlyRole - Set the right permissions for ApiReadOnlyRole
+ * -----
+ * 每条 GRANT 都会被 Citus 传播到所有节点执行，因此按批次授权多个集合表，
+ * 使集合较多的集群在升级时需要传播的 DDL 数量减少为原来的 1/批次大小。
  */
 static void
 SetPermissionsForReadOnlyRole()
@@ -1036,13 +1042,20 @@ SetPermissionsForReadOnlyRole()
 	deconstruct_array(arrayValue, INT8OID, sizeof(int64), true, TYPALIGN_INT,
 					  &elements, &val_is_null_marker, &numElements);
 
-	for (int i = 0; i < numElements; i++)
+	for (int i = 0; i < numElements; i += READ_ONLY_ROLE_GRANT_BATCH_SIZE)
 	{
-		int64_t collection_id = DatumGetInt64(elements[i]);
 		resetStringInfo(cmdStr);
-		appendStringInfo(cmdStr,
-						 "GRANT SELECT ON %s.documents_%ld TO %s;",
-						 ApiDataSchemaName, collection_id, ApiReadOnlyRole);
+		appendStringInfoString(cmdStr, "GRANT SELECT ON ");
+
+		int batchEnd = Min(i + READ_ONLY_ROLE_GRANT_BATCH_SIZE, numElements);
+		for (int j = i; j < batchEnd; j++)
+		{
+			int64_t collection_id = DatumGetInt64(elements[j]);
+			appendStringInfo(cmdStr, "%s%s.documents_%ld", j > i ? ", " : "",
+							 ApiDataSchemaName, collection_id);
+		}
+
+		appendStringInfo(cmdStr, " TO %s;", ApiReadOnlyRole);
 		ExtensionExecuteQueryViaSPI(cmdStr->data, readOnly, SPI_OK_UTILITY,
 									&isNull);
 	}
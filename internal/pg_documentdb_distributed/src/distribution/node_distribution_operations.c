@@ -17,6 +17,7 @@
 #include <utils/lsyscache.h>
 
 #include "utils/query_utils.h"
+#include "utils/guc_utils.h"
 #include "utils/documentdb_errors.h"
 #include "utils/error_utils.h"
 #include "io/bson_core.h"
@@ -25,6 +26,12 @@
 #include "api_hooks.h"
 
 
+extern bool EnableParallelPerNodeReadCommands;
+
+/* 每次从游标中取出的节点结果数 */
+#define PER_NODE_COMMAND_FETCH_BATCH_SIZE 64
+
+
 /*
  * ChooseShardNamesForTable - 为分布式表选择分片名称
  * @distributedTableName: 分布式表的名称
@@ -180,34 +187,68 @@ ExecutePerNodeCommand(Oid nodeFunction, pgbson *nodeFunctionArg, bool readOnly,
 	};
 	char argNulls[3] = { ' ', ' ', ' ' };
 
-	List *resultList = NIL;
-
-	/* 步骤3：执行分布式查询并收集结果 */
-	int tupleCountLimit = 0;
-	if (SPI_execute_with_args(s.data, nargs, argTypes, argValues, argNulls,
-							  readOnly, tupleCountLimit) != SPI_OK_SELECT)
+	/* 步骤3：执行分布式查询
+	 *
+	 * Citus 的自适应执行器已经并发地将任务发送到各个节点，但每个节点默认
+	 * 从一个连接开始并逐步增加（slow start），该节点上非选中分片的 noop
+	 * 任务会排在选中分片之前。对于只读命令，强制每个分片任务使用独立的
+	 * 连接，使所有节点上的节点函数同时开始执行。写命令不这样做，因为它们
+	 * 需要复用事务中已经修改过分片的连接。
+	 */
+	int savedGUCLevel = -1;
+	if (readOnly && EnableParallelPerNodeReadCommands)
 	{
-		ereport(ERROR, (errmsg("could not run SPI query")));
+		savedGUCLevel = NewGUCNestLevel();
+		SetGUCLocally("citus.force_max_query_parallelization", "true");
 	}
 
-	/* 步骤4：遍历结果集，收集每个节点的返回值 */
-	for (uint64 i = 0; i < SPI_processed && SPI_tuptable; i++)
+	Portal nodeQueryPortal = SPI_cursor_open_with_args("perNodeCommandPortal", s.data,
+													   nargs, argTypes, argValues,
+													   argNulls, readOnly, 0);
+
+	/* 步骤4：分批遍历结果集，收集每个节点的返回值
+	 *
+	 * 结果在到达时逐批复制到目标上下文中，而不是先在 SPI 中物化所有分片的
+	 * 元组再统一复制。
+	 */
+	List *resultList = NIL;
+	bool hasData = true;
+	while (hasData)
 	{
-		AttrNumber attrNumber = 1;
-		bool isNull = false;
-		Datum resultDatum = SPI_getbinval(SPI_tuptable->vals[i],
-										  SPI_tuptable->tupdesc, attrNumber, &isNull);
-		if (isNull)
+		SPI_cursor_fetch(nodeQueryPortal, true, PER_NODE_COMMAND_FETCH_BATCH_SIZE);
+		hasData = SPI_processed >= 1 && SPI_tuptable != NULL;
+
+		for (uint64 i = 0; hasData && i < SPI_processed; i++)
 		{
-			/* 该分片没有处理任何响应，跳过 */
-			continue;
+			AttrNumber attrNumber = 1;
+			bool isNull = false;
+			Datum resultDatum = SPI_getbinval(SPI_tuptable->vals[i],
+											  SPI_tuptable->tupdesc, attrNumber,
+											  &isNull);
+			if (isNull)
+			{
+				/* 该分片没有处理任何响应，跳过 */
+				continue;
+			}
+
+			pgbson *resultBson = DatumGetPgBson(resultDatum);
+			MemoryContext oldContext = MemoryContextSwitchTo(targetContext);
+			pgbson *copiedBson = CopyPgbsonIntoMemoryContext(resultBson, targetContext);
+			resultList = lappend(resultList, copiedBson);
+			MemoryContextSwitchTo(oldContext);
 		}
 
-		pgbson *resultBson = DatumGetPgBson(resultDatum);
-		MemoryContext oldContext = MemoryContextSwitchTo(targetContext);
-		pgbson *copiedBson = CopyPgbsonIntoMemoryContext(resultBson, targetContext);
-		resultList = lappend(resultList, copiedBson);
-		MemoryContextSwitchTo(oldContext);
+		if (hasData)
+		{
+			SPI_freetuptable(SPI_tuptable);
+		}
+	}
+
+	SPI_cursor_close(nodeQueryPortal);
+
+	if (savedGUCLevel >= 0)
+	{
+		RollbackGUCChange(savedGUCLevel);
 	}
 
 	SPI_finish();
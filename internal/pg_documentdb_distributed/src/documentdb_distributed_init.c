@@ -12,6 +12,7 @@
 #include <utils/guc.h>
 
 #include "documentdb_distributed_init.h"
+#include "commands/create_indexes.h"
 
 
 /* --------------------------------------------------------- */
@@ -35,6 +36,23 @@ char *ClusterAdminRole = DEFAULT_CLUSTER_ADMIN_ROLE;
 #define DEFAULT_ENABLE_MOVE_COLLECTION true
 bool EnableMoveCollection = DEFAULT_ENABLE_MOVE_COLLECTION;
 
+/* 按负载重新平衡时，写操作相对于读操作的权重 */
+#define DEFAULT_REBALANCER_WRITE_LOAD_WEIGHT 4.0
+double RebalancerWriteLoadWeight = DEFAULT_REBALANCER_WRITE_LOAD_WEIGHT;
+
+/* 只读的按节点命令是否为每个分片任务使用独立连接并发执行 */
+#define DEFAULT_ENABLE_PARALLEL_PER_NODE_READ_COMMANDS false
+bool EnableParallelPerNodeReadCommands = DEFAULT_ENABLE_PARALLEL_PER_NODE_READ_COMMANDS;
+
+/* 每个节点上并发构建的分片索引数，0 表示使用 Citus 自适应执行器的连接池大小 */
+#define DEFAULT_MAX_SHARD_INDEX_BUILDS_PER_NODE 0
+int MaxShardIndexBuildsPerNode = DEFAULT_MAX_SHARD_INDEX_BUILDS_PER_NODE;
+
+/* 传递给分片索引构建连接的选项 */
+static char ShardIndexBuildOptions[64] = { 0 };
+
+static void AssignMaxShardIndexBuildsPerNode(int newValue, void *extra);
+
 /* --------------------------------------------------------- */
 /* Top level exports */
 /* 顶层导出函数 */
@@ -52,6 +70,9 @@ bool EnableMoveCollection = DEFAULT_ENABLE_MOVE_COLLECTION;
  * 2. enable_shard_rebalancer_apis: 启用/禁用分片重新平衡器 API
  * 3. enable_move_collection: 启用/禁用移动集合功能
  * 4. clusterAdminRole: 集群管理员角色名称
+ * 5. rebalancer_write_load_weight: 按负载重新平衡时写操作的权重
+ * 6. enable_parallel_per_node_read_commands: 只读按节点命令的并发分发
+ * 7. max_shard_index_builds_per_node: 每个节点并发构建的分片索引数
  */
 void
 InitDocumentDBDistributedConfigurations(const char *prefix)
@@ -95,4 +116,64 @@ InitDocumentDBDistributedConfigurations(const char *prefix)
 			"The cluster admin role."),
 		NULL, &ClusterAdminRole, DEFAULT_CLUSTER_ADMIN_ROLE,
 		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	/* 定义 rebalancer_write_load_weight 配置参数
+	 * 该参数控制 by_operation_load 重新平衡策略中，每个写入的行
+	 * 相对于每个读取的行的成本。该参数只能在服务器配置中设置，
+	 * 以便不同会话计算的重新平衡计划使用相同的权重
+	 */
+	DefineCustomRealVariable(
+		psprintf("%s.rebalancer_write_load_weight", prefix),
+		gettext_noop(
+			"The cost of a written row relative to a read row in the by_operation_load "
+			"rebalance strategy."),
+		NULL, &RebalancerWriteLoadWeight, DEFAULT_REBALANCER_WRITE_LOAD_WEIGHT,
+		0, 1000, PGC_SIGHUP, 0, NULL, NULL, NULL);
+
+	/* 定义 enable_parallel_per_node_read_commands 配置参数
+	 * 该参数控制只读的 ExecutePerNodeCommand 是否强制 Citus 为每个分片任务
+	 * 打开独立连接，使所有节点同时执行节点函数
+	 */
+	DefineCustomBoolVariable(
+		psprintf("%s.enable_parallel_per_node_read_commands", prefix),
+		gettext_noop(
+			"Determines whether read only per node commands open a connection per "
+			"shard task to run on all nodes concurrently."),
+		NULL, &EnableParallelPerNodeReadCommands,
+		DEFAULT_ENABLE_PARALLEL_PER_NODE_READ_COMMANDS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	/* 定义 max_shard_index_builds_per_node 配置参数
+	 * CREATE INDEX CONCURRENTLY 由 Citus 在各节点上并发地对分片执行，
+	 * 该参数限制（或放宽）每个节点同时构建的分片索引数
+	 */
+	DefineCustomIntVariable(
+		psprintf("%s.max_shard_index_builds_per_node", prefix),
+		gettext_noop(
+			"The maximum number of shard indexes built concurrently on each node "
+			"by an index build of a sharded collection, 0 uses the executor default."),
+		NULL, &MaxShardIndexBuildsPerNode, DEFAULT_MAX_SHARD_INDEX_BUILDS_PER_NODE,
+		0, 1000, PGC_USERSET, 0, NULL, AssignMaxShardIndexBuildsPerNode, NULL);
+}
+
+
+/*
+ * AssignMaxShardIndexBuildsPerNode - 设置分片索引构建连接的选项
+ *
+ * 分片索引构建在不能处于事务块中的本地连接上执行，因此通过连接的后端
+ * 选项设置 citus.max_adaptive_executor_pool_size，该值限制 Citus 对每个
+ * 节点打开的连接数，即每个节点并发构建的分片索引数。
+ */
+static void
+AssignMaxShardIndexBuildsPerNode(int newValue, void *extra)
+{
+	if (newValue <= 0)
+	{
+		IndexBuildParallelExecutionOptions = NULL;
+		return;
+	}
+
+	snprintf(ShardIndexBuildOptions, sizeof(ShardIndexBuildOptions),
+			 "-c citus.max_adaptive_executor_pool_size=%d", newValue);
+	IndexBuildParallelExecutionOptions = ShardIndexBuildOptions;
 }
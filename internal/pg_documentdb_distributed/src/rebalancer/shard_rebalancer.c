@@ -27,6 +27,7 @@
 #include "api_hooks.h"
 
 extern bool EnableShardRebalancer;
+extern double RebalancerWriteLoadWeight;
 
 /* PostgreSQL 函数信息宏声明
  * 这些宏将 C 函数注册为 PostgreSQL 可调用的函数
@@ -34,6 +35,7 @@ extern bool EnableShardRebalancer;
 PG_FUNCTION_INFO_V1(command_rebalancer_status);
 PG_FUNCTION_INFO_V1(command_rebalancer_start);
 PG_FUNCTION_INFO_V1(command_rebalancer_stop);
+PG_FUNCTION_INFO_V1(documentdb_shard_load_cost);
 
 
 /* 静态辅助函数声明 */
@@ -241,6 +243,66 @@ command_rebalancer_stop(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * documentdb_shard_load_cost - by_operation_load 重新平衡策略的分片成本函数
+ * @shard_id: 分片 ID
+ *
+ * Citus 内置策略按分片数量（by_shard_count）或磁盘大小（by_disk_size）
+ * 平衡分片，而热点通常来自少数访问频繁的租户。该函数从分片所在节点的
+ * pg_stat_all_tables 读取分片表的操作计数器，成本为：
+ *   1 + 读取的行数 + rebalancer_write_load_weight * 写入的行数
+ * 其中常数 1 保证空闲的分片仍然按数量参与平衡。
+ *
+ * 计数器从统计信息上次重置开始累计，因此在重新平衡之前可以通过
+ * pg_stat_reset() 把成本限定在最近的负载上。
+ *
+ * 与 citus_shard_cost_by_disk_size 一样，每个分片会向其所在节点发起一次查询。
+ *
+ * 返回值：分片的成本（real）
+ */
+Datum
+documentdb_shard_load_cost(PG_FUNCTION_ARGS)
+{
+	int64 shardId = PG_GETARG_INT64(0);
+
+	/*
+	 * 在分片所在的节点上读取分片表的读写计数器
+	 * master_run_on_worker 把 NULL 结果返回为空字符串，因此先转换回 NULL
+	 */
+	const char *query =
+		"SELECT (1 + COALESCE(NULLIF(r.result, ''), '0')::float8)::float4"
+		" FROM pg_catalog.pg_dist_shard s"
+		" JOIN pg_catalog.pg_dist_placement p ON p.shardid = s.shardid"
+		" JOIN pg_catalog.pg_dist_node n ON n.groupid = p.groupid,"
+		" LATERAL pg_catalog.master_run_on_worker(ARRAY[n.nodename], ARRAY[n.nodeport],"
+		"  ARRAY[pg_catalog.format("
+		"   'SELECT COALESCE(seq_tup_read, 0) + COALESCE(idx_tup_fetch, 0) +"
+		" %s * (n_tup_ins + n_tup_upd + n_tup_del)"
+		" FROM pg_catalog.pg_stat_all_tables WHERE relid = %L::regclass',"
+		"   $2, pg_catalog.shard_name(s.logicalrelid, s.shardid))], false) r"
+		" WHERE s.shardid = $1 AND r.success LIMIT 1";
+
+	Oid argTypes[2] = { INT8OID, FLOAT8OID };
+	Datum argValues[2] = {
+		Int64GetDatum(shardId), Float8GetDatum(RebalancerWriteLoadWeight)
+	};
+
+	bool readOnly = true;
+	bool isNull = false;
+	Datum result = ExtensionExecuteQueryWithArgsViaSPI(query, 2, argTypes, argValues,
+													   NULL, readOnly, SPI_OK_SELECT,
+													   &isNull);
+
+	/* 无法获取计数器时（如节点不可用），按照 by_shard_count 的成本处理 */
+	if (isNull)
+	{
+		PG_RETURN_FLOAT4(1.0);
+	}
+
+	PG_RETURN_DATUM(result);
+}
+
+
 /*
  * PopulateRebalancerRowsFromResponse - 从 Citus 响应填充 DocumentDB 兼容的重新平衡状态
  * @responseWriter: BSON 写入器，用于构造响应
@@ -15,6 +15,12 @@ SELECT * FROM bson_dollar_project('{"a":{"$date": { "$numberLong" : "0" }}}', '{
 SELECT * FROM bson_dollar_project('{"a":{"$date": { "$numberLong" : "0" }}}', '{"result": { "$add": [ "$a", {"$numberDouble": "43200000.56"}]}}');
 SELECT * FROM bson_dollar_project('{"a":{"$date": { "$numberLong" : "0" }}}', '{"result": { "$add": [ "$a", {"$numberDecimal": "1e10"}]}}');
 
+-- Leading constant operands are folded when parsed, the result matches the same operands read from the document
+SELECT * FROM bson_dollar_project('{"a": 1, "x": 1, "y": 2.5}', '{"result": { "$add": [ 1, 2.5, "$a" ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "x": 1, "y": 2.5}', '{"result": { "$add": [ "$x", "$y", "$a" ]}}');
+SELECT * FROM bson_dollar_project('{"d": {"$date": { "$numberLong" : "0" }}, "k": 1000}', '{"result": { "$add": [ 1000, 1000, "$d" ]}}');
+SELECT * FROM bson_dollar_project('{"d": {"$date": { "$numberLong" : "0" }}, "k": 1000}', '{"result": { "$add": [ "$k", "$k", "$d" ]}}');
+
 -- A single expression is also valid
 SELECT * FROM bson_dollar_project('{"a":{"$numberLong": "10"}}', '{"result": { "$add": "$a"}}');
 SELECT * FROM bson_dollar_project('{"a":{"$numberLong": "10"}}', '{"result": { "$add": "$b"}}');
@@ -25,6 +31,10 @@ SELECT * FROM bson_dollar_project('{"a":{"$numberLong": "10"}}', '{"result": { "
 SELECT * FROM bson_dollar_project('{"a":2147483646}', '{"result": { "$add": [ "$a", 2]}}');
 SELECT * FROM bson_dollar_project('{"a":1073741823, "b": 1073741825}', '{"result": { "$add": [ "$a", "$b"]}}');
 
+-- Folded constant operands overflow the same way
+SELECT * FROM bson_dollar_project('{"a": 1}', '{"result": { "$add": [ 2147483647, 1, "$a" ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "b": 2147483647, "c": 1}', '{"result": { "$add": [ "$b", "$c", "$a" ]}}');
+
 -- Int64 overflow coerce to double
 SELECT * FROM bson_dollar_project('{"a":9223372036854775807}', '{"result": { "$add": [ "$a", 2]}}');
 
@@ -37,6 +47,10 @@ SELECT * FROM bson_dollar_project('{"a":1 }', '{"result": { "$add": [ "$a", "$a.
 SELECT * FROM bson_dollar_project('{"a":{"$date": { "$numberLong" : "9223372036854775807" }} }', '{"result": { "$add": [ "$a", 100, 100, null ]}}');
 SELECT * FROM bson_dollar_project('{"a":{"$date": { "$numberLong" : "9223372036854775807" }}, "b": null }', '{"result": { "$add": [ "$a", 100, 100, "$b" ]}}');
 
+-- Non-existent paths after folded constant operands return null
+SELECT * FROM bson_dollar_project('{"a": 1}', '{"result": { "$add": [ 1, 2, "$b" ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "c": 2}', '{"result": { "$add": [ "$a", "$c", "$b" ]}}');
+
 -- Should return invalid date (INT64_MAX) if there is a decimal128 overflow
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$add": [ {"$date": { "$numberLong" : "0" }}, {"$numberDecimal": "1e5000"}]}}');
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$add": [ {"$date": { "$numberLong" : "0" }}, {"$numberDecimal": "NaN"}]}}');
@@ -139,6 +153,10 @@ SELECT * FROM bson_dollar_project('{"a": 1}', '{"result": { "$multiply": [ "$a",
 SELECT * FROM bson_dollar_project('{"a":{"$numberDecimal": "102123"}}', '{"result": { "$multiply": [ "$a", {"$numberDecimal": "-1232"}]}}');
 SELECT * FROM bson_dollar_project('{"a":{"$numberLong": "10"}}', '{"result": { "$multiply": [ "$a", -1000]}}');
 
+-- Leading constant operands are folded when parsed, the result matches the same operands read from the document
+SELECT * FROM bson_dollar_project('{"a": 1}', '{"result": { "$multiply": [ 2, 0.5, "$a" ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "b": 2, "c": 0.5}', '{"result": { "$multiply": [ "$b", "$c", "$a" ]}}');
+
 -- Int32 overflow to -> Int64
 SELECT * FROM bson_dollar_project('{"a":1073741824}', '{"result": { "$multiply": [ "$a", 2]}}');
 SELECT * FROM bson_dollar_project('{"a":-1073741824}', '{"result": { "$multiply": [ "$a", 2, 2]}}');
@@ -49,6 +49,24 @@ SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [1, 2, 3, 4, 6, 7,
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": null}}');
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$not": []}, 2, 3]}}');
 
+-- constant arrays with more than 16 elements are hashed, equality must match the scan for mixed numeric types, documents, arrays and null
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [2, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$numberDecimal": "2"}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$numberLong": "3"}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$numberDouble": "4.0"}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$numberDecimal": "0.5"}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$numberDouble": "1e20"}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$numberDouble": "NaN"}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$literal": {"a": {"$numberDouble": "1.0"}}}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$literal": [{"$numberLong": "1"}, {"$numberDecimal": "2.0"}]}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": ["s15", ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [5, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": ["S15", ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [null, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [{"$undefined": true}, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": [null, ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$undefined": true}]]}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$in": ["$z", ["s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15", {"$numberDouble": "2.0"}, {"$numberDecimal": "3"}, {"$numberLong": "4"}, {"$numberDouble": "0.5"}, {"$numberDecimal": "1E+20"}, {"a": 1}, [1, 2], null, {"$numberDouble": "NaN"}]]}}');
+
 -- $size operator
 -- returns expected result
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$size": [[1, 2]]}}');
@@ -855,6 +873,28 @@ select *from bson_dollar_project('{"a":[{"fieldA":"abc","fieldB":2,"fieldC":[{"n
 select *from bson_dollar_project('{"a": 1}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$add": ["$$x", 1] } } } }');
 select *from bson_dollar_project('{"a": [1, 2, 3]}', '{"result": {"$map": {"input": "$a" }} }');
 
+-- $map over double arrays, with and without the double kernels
+select *from bson_dollar_project('{"a": [1.0, -1.0, 0.0, 100.0]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$sin": "$$x" } } } }');
+select *from bson_dollar_project('{"a": [1.0, 0.0, 100.0]}', '{"result": {"$map": {"input": "$a", "in": { "$cos": "$$this" } } } }');
+select *from bson_dollar_project('{"a": [1.0, 1, 0.0]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$tan": "$$x" } } } }');
+select *from bson_dollar_project('{"a": [1.5, 2.5, -4.0, 3]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$multiply": ["$$x", 2] } } } }');
+select *from bson_dollar_project('{"a": [1.5, 2.5, -4.0, {"$numberDouble": "Infinity"}]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$multiply": [0.5, "$$x"] } } } }');
+select *from bson_dollar_project('{"a": [1.0, {"$numberDouble": "Infinity"}]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$sin": "$$x" } } } }');
+SET documentdb.enableDollarMapDoubleKernels TO on;
+select *from bson_dollar_project('{"a": [1.0, -1.0, 0.0, 100.0]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$sin": "$$x" } } } }');
+select *from bson_dollar_project('{"a": [1.0, 0.0, 100.0]}', '{"result": {"$map": {"input": "$a", "in": { "$cos": "$$this" } } } }');
+select *from bson_dollar_project('{"a": [1.0, 1, 0.0]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$tan": "$$x" } } } }');
+select *from bson_dollar_project('{"a": [1.5, 2.5, -4.0, 3]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$multiply": ["$$x", 2] } } } }');
+select *from bson_dollar_project('{"a": [1.5, 2.5, -4.0, {"$numberDouble": "Infinity"}]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$multiply": [0.5, "$$x"] } } } }');
+select *from bson_dollar_project('{"a": [1.0, {"$numberDouble": "Infinity"}]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$sin": "$$x" } } } }');
+select *from bson_dollar_project('{"a": [1, 2, 3]}', '{"result": {"$map": {"input": "$a", "as": "x", "in": { "$add": ["$$x", 1] } } } }');
+select *from bson_dollar_project('{"str": ["a", "b", "c"]}', '{"result": {"$map": {"input": "$str", "as": "y", "in": { "$concat": ["$$y", "ddd"] } } } }');
+select *from bson_dollar_project('{"bools": [true, true, false, true] }', '{"allTrue": { "$map": { "input": "$bools", "as": "x", "in": { "$and": ["$$x", false] }   } } }');
+select *from bson_dollar_project('{ "a": ["Hello", "", "big", "World", "!"] }', '{"a": { "$map": { "input": "$a", "as": "x", "in": { "$concat": [{ "$trim": { "input" : "$$x" }}, {"$cond": {"if": { "$eq": [ "$$x", "" ] }, "then": "1", "else": "2" } }, { "$trim": { "input" : "$$x" } } ] } } } }');
+select *from bson_dollar_project('{"a": [["a", "b"], ["b", "c"], ["c", "d"], ["e", "a"], ["y", "z"]] }', '{"result": {"$map": {"input": "$a","as": "x","in": { "$setUnion": ["$$x", ["a","b"]] }}}}');
+select *from bson_dollar_project('{"a": [{"b": [1, 2, 3]},{"b": [4, 5, 6]}]}', '{"result": {"$map": {"input": "$a","as": "outer","in": {"$map": {"input": "$$outer.b","as": "inner","in": { "$multiply": ["$$inner", 2] }}}}}}');
+RESET documentdb.enableDollarMapDoubleKernels;
+
 -- $reduce
 select *from bson_dollar_project('{"a": ["a", "b", "c"]}', '{"result": { "$reduce": { "input": "$a", "initialValue": "", "in": { "$concat": ["$$value", "$$this"] } } } }');
 select *from bson_dollar_project('{"a": [ 1, 2, 3, 4 ]}', '{"result": { "$reduce": { "input": "$a", "initialValue": { "sum": 5, "product": 2 }, "in": { "sum": { "$add" : ["$$value.sum", "$$this"] }, "product": { "$multiply": [ "$$value.product", "$$this" ] }  } } } }');
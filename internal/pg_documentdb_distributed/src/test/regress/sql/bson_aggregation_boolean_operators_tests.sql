@@ -22,6 +22,10 @@ SELECT * FROM bson_dollar_project('{"a": true, "b": true, "c": true}', '{"result
 SELECT * FROM bson_dollar_project('{"a": { "b": true, "c": true}}', '{"result": { "$and": ["$a.b", "$a.c"]}}');
 SELECT * FROM bson_dollar_project('{"a": { "c": true}}', '{"result": { "$and": [{"$add": [0, 1]}, "$a.c"]}}');
 
+-- nested $and operators are flattened and truthy constants are dropped
+SELECT * FROM bson_dollar_project('{"a": 1, "t": true}', '{"result": { "$and": [ "$t", { "$and": [ true, "$a" ] }, 1 ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "t": true}', '{"result": { "$and": [ "$t", { "$and": [ "$t", "$a" ] }, "$a" ]}}');
+
 -- should return false
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$and": false}}');
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$and": 0}}');
@@ -36,6 +40,10 @@ SELECT * FROM bson_dollar_project('{"a": true, "b": true, "c": false}', '{"resul
 SELECT * FROM bson_dollar_project('{"a": { "b": true, "c": false}}', '{"result": { "$and": ["$a.b", "$a.c"]}}');
 SELECT * FROM bson_dollar_project('{"a": { "c": true}}', '{"result": { "$and": [{"$add": [0, 0]}, "$a.c"]}}');
 
+-- a leading false constant makes the whole operator constant
+SELECT * FROM bson_dollar_project('{"a": 1, "f": false}', '{"result": { "$and": [ false, "$a" ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "f": false}', '{"result": { "$and": [ "$f", "$a" ]}}');
+
 -- If nested expression parses to a constant that evaluates to an error, the error from the nested expression will be thrown. 
 SELECT * FROM bson_dollar_project('{"a": { "c": true}}', '{"result": { "$and": [false, {"$divide": [1, 0]}, "$a.c"]}}');
 SELECT * FROM bson_dollar_project('{"a": { "c": true}}', '{"result": { "$and": [false, "$a.c", {"$subtract": [1, {"$date": {"$numberLong": "11232"}}]}]}}');
@@ -45,6 +53,10 @@ SELECT * FROM bson_dollar_project('{"a": { "c": false}}', '{"result": { "$and":
 SELECT * FROM bson_dollar_project('{"a": { "c": 0}}', '{"result": { "$and": [false, {"$divide": [1, "$a.c"]}, "$a.c"]}}');
 SELECT * FROM bson_dollar_project('{"a": { "c": 0}}', '{"result": { "$and": [true, {"$divide": [1, "$a.c"]}, "$a.c"]}}');
 
+-- operands before a false constant are still evaluated
+SELECT * FROM bson_dollar_project('{"a": 1, "zero": 0, "f": false}', '{"result": { "$and": [ { "$divide": [ "$a", "$zero" ] }, false ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "zero": 0, "f": false}', '{"result": { "$and": [ { "$divide": [ "$a", "$zero" ] }, "$f" ]}}');
+
 -- $or operator
 -- should return true
 SELECT * FROM bson_dollar_project('{}', '{"result": { "$or": true}}');
@@ -86,6 +98,12 @@ SELECT * FROM bson_dollar_project('{"a": false, "b": false, "c": false}', '{"res
 SELECT * FROM bson_dollar_project('{"a": { "b": false, "c": false}}', '{"result": { "$or": ["$z", "$a.b", "$a.c"]}}');
 SELECT * FROM bson_dollar_project('{"a": { "c": false}}', '{"result": { "$or": [{"$add": [0, 0]}, "$a.c"]}}');
 
+-- a true constant drops the operands after it, nested $or operators are flattened
+SELECT * FROM bson_dollar_project('{"a": 1, "zero": 0, "f": false, "t": true}', '{"result": { "$or": [ "$f", true, { "$divide": [ "$a", "$zero" ] } ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "zero": 0, "f": false, "t": true}', '{"result": { "$or": [ "$f", "$t", { "$divide": [ "$a", "$zero" ] } ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "zero": 0, "f": false, "t": true}', '{"result": { "$or": [ "$f", { "$or": [ "$f", 1 ] }, { "$divide": [ "$a", "$zero" ] } ]}}');
+SELECT * FROM bson_dollar_project('{"a": 1, "zero": 0, "f": false, "t": true}', '{"result": { "$or": [ "$f", { "$or": [ "$f", "$t" ] }, { "$divide": [ "$a", "$zero" ] } ]}}');
+
 -- If nested expression parses to a constant that evaluates to an error should get that error.
 SELECT * FROM bson_dollar_project('{"a": false, "b": false, "c": false}', '{"result": { "$or": ["$a", "$b", "$c", {"$divide": []}]}}');
 SELECT * FROM bson_dollar_project('{"a": { "c": true}}', '{"result": { "$or": [false, {"$divide": [1, 0]}, "$a.c"]}}');
@@ -75,3 +75,25 @@ SELECT document FROM bson_aggregation_pipeline('countdb', '{ "aggregate" : "coun
 EXPLAIN (COSTS OFF, VERBOSE ON, TIMING OFF, SUMMARY OFF)
     SELECT document FROM bson_aggregation_pipeline('countdb', '{ "aggregate" : "countcoll", "pipeline" : [{ "$match" : { "value" : { "$gt" : 50 } } }, { "$group" : { "_id" : { "$literal" : "sumUtf8" }, "cnt" : { "$sum" : "constant-non-numeric" } } }] }');
 SELECT document FROM bson_aggregation_pipeline('countdb', '{ "aggregate" : "countcoll", "pipeline" : [{ "$match" : { "value" : { "$gt" : 50 } } }, { "$group" : { "_id" : { "$literal" : "sumUtf8" }, "cnt" : { "$sum" : "constant-non-numeric" } } }] }');
+
+-- count only $collStats served by the live tuple stats
+SELECT COUNT(documentdb_api.insert_one('countdb', 'statscoll', bson_build_document('_id'::text, i, 'value'::text, i))) FROM generate_series(1, 50) i;
+ANALYZE documentdb_data.documents_58002;
+SELECT documentdb_api.create_collection('countdb', 'emptycoll');
+
+BEGIN;
+set local client_min_messages to DEBUG1;
+set local documentdb.forceRunDiagnosticCommandInline to on;
+set local documentdb.usePgStatsLiveTuplesForCount to off;
+
+-- small collections are counted at runtime
+SELECT document FROM bson_aggregation_count('countdb', '{ "count": "statscoll", "query": {} }');
+SELECT document FROM bson_aggregation_count('countdb', '{ "count": "emptycoll", "query": {} }');
+
+set local documentdb.enableStatsOnlyCollectionCount to on;
+
+-- the count is taken from the live stats, empty stats are checked with an EXISTS probe
+SELECT document FROM bson_aggregation_count('countdb', '{ "count": "statscoll", "query": {} }');
+SELECT document FROM bson_aggregation_pipeline('countdb', '{ "aggregate": "statscoll", "pipeline": [ { "$collStats": { "count": {} }} ] }');
+SELECT document FROM bson_aggregation_count('countdb', '{ "count": "emptycoll", "query": {} }');
+ROLLBACK;
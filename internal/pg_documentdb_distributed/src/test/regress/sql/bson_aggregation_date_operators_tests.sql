@@ -214,6 +214,22 @@ SELECT * FROM bson_dollar_project('{"date": {"$date": "2017-06-19T15:13:25.713Z"
 -- oid == 2017-06-19T15:13:25.713Z UTC.
 SELECT * FROM bson_dollar_project('{"_id": {"$oid": "58c7cba47bbadf523cf2c313"}}', '{"dateParts": {"$dateToParts": { "date": "$_id", "timezone": "Europe/London" }}}');
 
+-- $dateToParts across DST transitions of an Olson timezone
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2021-03-14T06:59:59.999Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "America/New_York" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2021-03-14T07:00:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "America/New_York" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2021-11-07T05:30:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "America/New_York" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2021-11-07T06:30:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "America/New_York" }}}');
+-- $dateToParts with a UTC offset crossing day, year and leap day boundaries
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2021-12-31T20:00:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "+05:30" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2021-12-31T20:00:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "+05:30", "iso8601": true }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2022-01-01T03:00:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "-08:00" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": "2024-02-28T23:00:00.000Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "+01:00" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": {"$numberLong": "-1"}}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "-01:00" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": {"$numberLong": "-1"}}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "+01:00" }}}');
+-- $dateToParts with a UTC offset moving the date past year 9999
+SELECT * FROM bson_dollar_project('{"date": {"$date": {"$numberLong": "253402299000000"}}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "UTC" }}}');
+SELECT * FROM bson_dollar_project('{"date": {"$date": {"$numberLong": "253402299000000"}}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "+01:00" }}}');
+
 -- $dateToParts should return null
 SELECT * FROM bson_dollar_project('{"date": {"$date": "2017-06-19T15:13:25.713Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": "$tz" }}}');
 SELECT * FROM bson_dollar_project('{"date": {"$date": "2017-06-19T15:13:25.713Z"}}', '{"dateParts": {"$dateToParts": { "date": "$date", "timezone": null }}}');
@@ -479,6 +495,11 @@ select * from bson_dollar_project(' {"isoWeekYear": 2024, "isoWeek":50, "isoDayO
 select * from bson_dollar_project(' {"isoWeekYear": 2024, "isoWeek":50, "isoDayOfWeek": 2 ,"hour":18, "minute":45, "second":12, "timezone" : "America/New_York"}', '{"result": {"$dateFromParts":  {"isoWeekYear": "$isoWeekYear", "isoWeek": "$isoWeek", "isoDayOfWeek": "$isoDayOfWeek", "timezone": "$timezone"} }}');
 
 
+-- $dateTrunc sub day units with a UTC offset
+select * from bson_dollar_project('{}', '{"result": {"$dateTrunc": {"date": {"$date" : {"$numberLong": "1707123355381"}}, "unit": "hour", "binSize": 5, "timezone": "+05:30" }  }}');
+select * from bson_dollar_project('{}', '{"result": {"$dateTrunc": {"date": {"$date" : {"$numberLong": "-1"}}, "unit": "hour", "binSize": 1, "timezone": "+05:30" }  }}');
+select * from bson_dollar_project('{}', '{"result": {"$dateTrunc": {"date": {"$date" : {"$numberLong": "253402300799999"}}, "unit": "hour", "binSize": 1, "timezone": "+01:00" }  }}');
+
 --$dateTrunc null cases
 select * from bson_dollar_project('{}', '{"result": {"$dateTrunc": null }}');
 select * from bson_dollar_project('{}', '{"result": {"$dateTrunc": {"$undefined": true} }}');
@@ -165,3 +165,19 @@ SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "
 
 /* Explain */
 EXPLAIN (VERBOSE ON, COSTS OFF) SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "dollarBucketAuto", "pipeline": [ { "$bucketAuto": { "groupBy": "$price", "buckets": 3 } } ] }');
+
+/* approximate boundaries */
+-- the boundaries are estimated from quantiles of the unsorted values
+SET documentdb.enableApproximateBucketAuto TO on;
+-- a single bucket has the exact min and max
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "bucketAutoGranularity", "pipeline": [ { "$bucketAuto": { "groupBy": "$amount", "buckets": 1 } } ] }');
+-- every document is in one of the buckets, the first and last bounds are the min and max
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "bucketAutoGranularity", "pipeline": [ { "$bucketAuto": { "groupBy": "$amount", "buckets": 4 } }, { "$group": { "_id": null, "buckets": { "$sum": 1 }, "count": { "$sum": "$count" }, "min": { "$min": "$_id.min" }, "max": { "$max": "$_id.max" } } } ] }');
+-- fewer documents than buckets
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "bucketAutoGranularity", "pipeline": [ { "$match": { "amount": { "$lte": 1 } } }, { "$bucketAuto": { "groupBy": "$amount", "buckets": 4 } }, { "$group": { "_id": null, "count": { "$sum": "$count" }, "min": { "$min": "$_id.min" }, "max": { "$max": "$_id.max" } } } ] }');
+-- null values are in the first bucket
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "dollarBucketAuto", "pipeline": [ { "$bucketAuto": { "groupBy": "$price", "buckets": 2 } }, { "$sort": { "_id.min": 1 } }, { "$limit": 1 }, { "$project": { "_id": 0, "min": "$_id.min", "max": { "$gt": [ "$_id.max", 4 ] } } } ] }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "dollarBucketAuto", "pipeline": [ { "$bucketAuto": { "groupBy": "$price", "buckets": 2 } }, { "$group": { "_id": null, "buckets": { "$sum": 1 }, "count": { "$sum": "$count" } } } ] }');
+-- approximate boundaries are only computed for numbers
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "dollarBucketAuto", "pipeline": [ { "$bucketAuto": { "groupBy": "$product", "buckets": 3 } } ] }');
+RESET documentdb.enableApproximateBucketAuto;
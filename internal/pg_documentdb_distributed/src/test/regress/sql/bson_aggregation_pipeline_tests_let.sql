@@ -734,6 +734,12 @@ SELECT documentdb_api_internal.bson_query_match('{"a": 2}', '{"$expr": {"$and":
 SELECT documentdb_api_internal.bson_query_match('{"a": 2}', '{"$expr": {"$not": {"$lt": ["$a", "$$varRef"] } } }', '{ "let": {"varRef": 5} }', NULL);
 SELECT documentdb_api_internal.bson_query_match('{"a": "cat"}', '{"$expr": {"$in": ["$a", ["$$varRef1", "$$varRef2"]] } }', '{ "let": {"varRef1": "cat", "varRef2": "dog"} }', NULL);
 
+-- query match: the fallback of @@ for filters that are not constants, with and without compiling the filter
+SELECT f.id, documentdb_api_catalog.bson_query_match('{ "a": [ 1, 5, 9 ], "b": "cat" }', f.filter) FROM (VALUES (1, '{ "a": { "$gt": 4, "$lt": 6 } }'::bson), (2, '{ "b": { "$regex": "^c" } }'::bson), (3, '{ "a": { "$in": [ 2, 3 ] } }'::bson), (4, '{ "$or": [ { "b": "dog" }, { "a": 9 } ] }'::bson), (5, '{ "a": { "$elemMatch": { "$gt": 9 } } }'::bson)) f(id, filter) ORDER BY f.id;
+SET documentdb.enableCompiledQueryMatch TO on;
+SELECT f.id, documentdb_api_catalog.bson_query_match('{ "a": [ 1, 5, 9 ], "b": "cat" }', f.filter) FROM (VALUES (1, '{ "a": { "$gt": 4, "$lt": 6 } }'::bson), (2, '{ "b": { "$regex": "^c" } }'::bson), (3, '{ "a": { "$in": [ 2, 3 ] } }'::bson), (4, '{ "$or": [ { "b": "dog" }, { "a": 9 } ] }'::bson), (5, '{ "a": { "$elemMatch": { "$gt": 9 } } }'::bson)) f(id, filter) ORDER BY f.id;
+RESET documentdb.enableCompiledQueryMatch;
+
 -- query match: sharded collection
 SELECT documentdb_api.shard_collection('db', 'coll_query_op_let', '{ "_id": "hashed" }', false);
 SELECT documentdb_api.insert_one('db', 'coll_query_op_let', '{"_id": 1, "a": "cat" }', NULL);
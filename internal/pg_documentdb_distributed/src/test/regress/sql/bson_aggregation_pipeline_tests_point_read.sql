@@ -78,4 +78,14 @@ EXPLAIN (ANALYZE ON, VERBOSE ON, COSTS ON, BUFFERS OFF, TIMING OFF, SUMMARY OFF)
 EXPLAIN (ANALYZE ON, VERBOSE ON, COSTS ON, BUFFERS OFF, TIMING OFF, SUMMARY OFF) SELECT document FROM bson_aggregation_find('agg_db', '{ "find": "aggregation_find_point_read", "filter": { "_id": "2", "_id": { "$gt": 2 } }, "sort": { "a": 1 }, "batchSize": 0 }');
 
 -- multiple _id
-EXPLAIN (ANALYZE ON, VERBOSE ON, COSTS ON, BUFFERS OFF, TIMING OFF, SUMMARY OFF) SELECT document FROM bson_aggregation_find('agg_db', '{ "find": "aggregation_find_point_read", "filter": { "$and": [ { "_id": "2" }, { "_id": { "$regex": "^\\d+" } } ] } }');
\ No newline at end of file
+EXPLAIN (ANALYZE ON, VERBOSE ON, COSTS ON, BUFFERS OFF, TIMING OFF, SUMMARY OFF) SELECT document FROM bson_aggregation_find('agg_db', '{ "find": "aggregation_find_point_read", "filter": { "$and": [ { "_id": "2" }, { "_id": { "$regex": "^\\d+" } } ] } }');
+
+-- $in on _id with the multi point read plan probes the primary key for all the ids
+SET documentdb.enableMultiPointReadPlan TO on;
+SELECT bson_dollar_project(cursorPage, '{ "_id": 0, "ids": "$cursor.firstBatch._id" }') AS ids, continuation IS NULL AS done FROM find_cursor_first_page(database => 'agg_db', commandSpec => '{ "find": "aggregation_find_point_read", "filter": { "_id": { "$in": [ "3", "1", "5", "3" ] } }, "batchSize": 10 }', cursorId => 4294967294);
+SELECT bson_dollar_project(cursorPage, '{ "_id": 0, "ids": "$cursor.firstBatch._id" }') AS ids, continuation IS NULL AS done FROM find_cursor_first_page(database => 'agg_db', commandSpec => '{ "find": "aggregation_find_point_read", "filter": { "_id": { "$in": [ "3", "1", "2" ] }, "a": { "$type": "object" } }, "batchSize": 10 }', cursorId => 4294967294);
+-- the results past the first batch go to a cursor
+SELECT bson_dollar_project(cursorPage, '{ "_id": 0, "ids": "$cursor.firstBatch._id" }') AS ids, continuation IS NULL AS done FROM find_cursor_first_page(database => 'agg_db', commandSpec => '{ "find": "aggregation_find_point_read", "filter": { "_id": { "$in": [ "3", "1", "5", "3" ] } }, "batchSize": 1 }', cursorId => 4294967294);
+-- a sort keeps the regular cursor
+SELECT bson_dollar_project(cursorPage, '{ "_id": 0, "ids": "$cursor.firstBatch._id" }') AS ids, continuation IS NULL AS done FROM find_cursor_first_page(database => 'agg_db', commandSpec => '{ "find": "aggregation_find_point_read", "filter": { "_id": { "$in": [ "3", "1", "2" ] } }, "sort": { "_id": -1 }, "batchSize": 2 }', cursorId => 4294967294);
+RESET documentdb.enableMultiPointReadPlan;
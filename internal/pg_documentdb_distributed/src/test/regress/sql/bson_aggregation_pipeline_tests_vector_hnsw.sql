@@ -317,6 +317,31 @@ SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregatio
 SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 4, "path": "v", "filter": {"$and": [ { "$or": [{ "meta.b": { "$eq": 2 } }, { "c": { "$eq": false } } ] }, { "meta.b": { "$lt": 5 } } ] } }  } }, { "$project": {"searchScore": {"$round": [ {"$multiply": ["$__cosmos_meta__.score", 100000]}]} } } ], "cursor": {} }');
 SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 4, "path": "v", "filter": {"$and": [ { "$or": [{ "meta.a": { "$regex": "^some", "$options" : "i" } }, { "meta.b": { "$eq": 5 } } ] }, { "meta.b": { "$lt": 5 } } ] } }  } }, { "$project": {"searchScore": {"$round": [ {"$multiply": ["$__cosmos_meta__.score", 100000]}]} } } ], "cursor": {} }');
 
+-- adaptive pre-filter: the estimated filter selectivity on the local shard picks exact or iterative search
+SET documentdb.enableVectorAdaptivePreFilter TO on;
+SET documentdb.vectorPreFilterExactSearchMaxRows TO 0;
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 4, "path": "v", "filter": {"$and": [ { "$or": [{ "meta.a": { "$regex": "^some", "$options" : "i" } }, { "meta.b": { "$eq": 5 } } ] }, { "meta.b": { "$lt": 5 } } ] } }  } }, { "$project": {"searchScore": {"$round": [ {"$multiply": ["$__cosmos_meta__.score", 100000]}]} } } ], "cursor": {} }');
+SELECT trim(query_plan) AS query_plan FROM documentdb_distributed_test_helpers.mask_plan_id_from_distributed_subplan($Q$
+EXPLAIN (COSTS OFF, VERBOSE ON) SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 4, "path": "v", "filter": {"$and": [ { "$or": [{ "meta.a": { "$regex": "^some", "$options" : "i" } }, { "meta.b": { "$eq": 5 } } ] }, { "meta.b": { "$lt": 5 } } ] } }  } }, { "$project": {"searchScore": {"$round": [ {"$multiply": ["$__cosmos_meta__.score", 100000]}]} } } ], "cursor": {} }')
+$Q$) query_plan WHERE query_plan ~ 'CosmosSearch Custom Params';
+RESET documentdb.vectorPreFilterExactSearchMaxRows;
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 4, "path": "v", "filter": {"$and": [ { "$or": [{ "meta.a": { "$regex": "^some", "$options" : "i" } }, { "meta.b": { "$eq": 5 } } ] }, { "meta.b": { "$lt": 5 } } ] } }  } }, { "$project": {"searchScore": {"$round": [ {"$multiply": ["$__cosmos_meta__.score", 100000]}]} } } ], "cursor": {} }');
+SELECT trim(query_plan) AS query_plan FROM documentdb_distributed_test_helpers.mask_plan_id_from_distributed_subplan($Q$
+EXPLAIN (COSTS OFF, VERBOSE ON) SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 4, "path": "v", "filter": {"$and": [ { "$or": [{ "meta.a": { "$regex": "^some", "$options" : "i" } }, { "meta.b": { "$eq": 5 } } ] }, { "meta.b": { "$lt": 5 } } ] } }  } }, { "$project": {"searchScore": {"$round": [ {"$multiply": ["$__cosmos_meta__.score", 100000]}]} } } ], "cursor": {} }')
+$Q$) query_plan WHERE query_plan ~ 'CosmosSearch Custom Params';
+RESET documentdb.enableVectorAdaptivePreFilter;
+
+-- batched vector search: each query vector gets the results of its own single vector search
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 3.0, 4.9, 1.0 ], "k": 2, "path": "v" }  } }, { "$project": { "_id": 1 } } ], "cursor": {} }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vector": [ 15.0, 5.0, 0.1 ], "k": 2, "path": "v" }  } }, { "$project": { "_id": 1 } } ], "cursor": {} }');
+SET documentdb.enableVectorSearchBatchedQueries TO on;
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vectors": [ [ 3.0, 4.9, 1.0 ], [ 15.0, 5.0, 0.1 ] ], "k": 2, "path": "v" }  } }, { "$project": { "results._id": 1, "queryIndex": 1 } } ], "cursor": {} }');
+-- both query vectors are searched with the vector index in a single plan
+SELECT regexp_replace(trim(query_plan), ' collection(_[0-9]+)?$', '') AS query_plan FROM documentdb_distributed_test_helpers.mask_plan_id_from_distributed_subplan($Q$
+EXPLAIN (COSTS OFF, VERBOSE ON) SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "aggregation_pipeline_hnsw_filter", "pipeline": [ { "$search": { "cosmosSearch": { "vectors": [ [ 3.0, 4.9, 1.0 ], [ 15.0, 5.0, 0.1 ] ], "k": 2, "path": "v" }  } }, { "$project": { "results._id": 1, "queryIndex": 1 } } ], "cursor": {} }')
+$Q$) query_plan WHERE query_plan ~ 'Index Scan using hnsw_index';
+RESET documentdb.enableVectorSearchBatchedQueries;
+
 -- check the vector index is forced to be used
 ALTER ROLE test_filter_user_hnsw SET documentdb.enableVectorPreFilter = "True";
 SELECT current_setting('citus' || '.next_shard_id') as vector_citus__next_shard_id \gset
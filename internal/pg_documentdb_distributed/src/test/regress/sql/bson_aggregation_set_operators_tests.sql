@@ -257,6 +257,16 @@ select bson_dollar_project('{"_id":"1", "a": [1,2,3,5], "b": [1,2,3,4]}', '{"dif
 select bson_dollar_project('{"_id":"1", "a" : [1,2,3,4,5], "b" : [1,2,3,4]  }', '{"difference" : { "$setDifference" : [{"$slice": ["$a",1,6]},{"$slice": ["$b",1,6]}] } }');
 select bson_dollar_project('{"_id":"1", "a" : [1,2,3,4,5], "b" : [1,2,3,4]  }', '{"difference" : { "$setDifference" : [{"$slice": ["$a",1,3]},{"$slice": ["$b",1,3]}] } }');
 
+-- $setDifference operator: small arrays are scanned and larger ones hashed, both must treat mixed numeric types and null the same
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[1,{"$numberLong": "2"},{"$numberDouble": "3.0"},{"$numberDecimal": "4"},5],[{"$numberDecimal": "1.0"},{"$numberDouble": "2.0"},3,{"$numberLong": "4"}]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[1,{"$numberLong": "2"},{"$numberDouble": "3.0"},{"$numberDecimal": "4"},5],[{"$numberDecimal": "1.0"},{"$numberDouble": "2.0"},3,{"$numberLong": "4"},"s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[1,1.0,{"$numberDecimal": "1"},2],["a"]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[1,1.0,{"$numberDecimal": "1"},2],["a","s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[null,{"$undefined": true},1],[null]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[null,{"$undefined": true},1],[null,"s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[{"$numberDouble": "0.5"},{"$numberDecimal": "0.5"},1],[{"$numberDecimal": "0.5"}]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[{"$numberDouble": "0.5"},{"$numberDecimal": "0.5"},1],[{"$numberDecimal": "0.5"},"s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+
 -- $setDifference operator: Negative Cases :
 select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [[],[],[]]} }');
 select bson_dollar_project('{"_id":"1"}', '{"difference" : { "$setDifference" : [1,2,3]} }');
@@ -304,6 +314,14 @@ select bson_dollar_project('{"_id":"1", "a": [1,2,3,5], "b": [1,2,3,4]}', '{"isS
 select bson_dollar_project('{"_id":"1", "a" : [1,2,3,4,5], "b" : [1,2,3,4,5,6]  }', '{"isSubset" : { "$setIsSubset" : [{"$slice": ["$a",1,6]},{"$slice": ["$b",1,6]}] } }');
 select bson_dollar_project('{"_id":"1", "a" : [1,2,3,4,5], "b" : [1,2,3,4]  }', '{"isSubset" : { "$setIsSubset" : [{"$slice": ["$a",1,3]},{"$slice": ["$b",1,3]}] } }');
 
+-- $setIsSubset operator: small arrays are scanned and larger ones hashed, both must treat mixed numeric types and null the same
+select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[1,{"$numberDouble": "2.0"},{"$numberDecimal": "3"},null],[{"$numberDecimal": "1"},{"$numberLong": "2"},3,{"$undefined": true}]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[1,{"$numberDouble": "2.0"},{"$numberDecimal": "3"},null],[{"$numberDecimal": "1"},{"$numberLong": "2"},3,{"$undefined": true},"s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[{"$numberDouble": "0.5"}],[{"$numberDecimal": "0.5"}]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[{"$numberDouble": "0.5"}],[{"$numberDecimal": "0.5"},"s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[{"$numberLong": "9223372036854775807"}],[{"$numberDouble": "9223372036854775807"}]]} }');
+select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[{"$numberLong": "9223372036854775807"}],[{"$numberDouble": "9223372036854775807"},"s0","s1","s2","s3","s4","s5","s6","s7","s8","s9","s10","s11","s12","s13","s14","s15","s16"]]} }');
+
 -- $setIsSubset operator: Negative Cases :
 select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [[],[],[]]} }');
 select bson_dollar_project('{"_id":"1"}', '{"isSubset" : { "$setIsSubset" : [1,2,3]} }');
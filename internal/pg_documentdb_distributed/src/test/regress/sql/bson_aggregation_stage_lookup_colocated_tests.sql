@@ -0,0 +1,53 @@
+SET citus.next_shard_id TO 268000;
+SET documentdb.next_collection_id TO 2680;
+SET documentdb.next_collection_index_id TO 2680;
+SET search_path TO documentdb_api,documentdb_api_catalog,documentdb_api_internal,documentdb_core;
+
+CREATE SCHEMA colocated_lookup_test;
+CREATE FUNCTION colocated_lookup_test.lookup_joins_on_shard_key(pipelineSpec text)
+RETURNS bool LANGUAGE plpgsql AS $fn$
+DECLARE
+    planLine text;
+BEGIN
+    FOR planLine IN EXECUTE format('EXPLAIN (COSTS OFF, VERBOSE ON) SELECT document FROM bson_aggregation_pipeline(%L, %L)', 'colocated_lookup_db', pipelineSpec) LOOP
+        IF planLine LIKE '%lookup_shard_key%' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END;
+$fn$;
+
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'customers', '{ "_id": 1, "cust": "a", "name": "alice" }');
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'customers', '{ "_id": 2, "cust": "b", "name": "bob" }');
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'customers', '{ "_id": 3, "cust": "d", "name": "dan" }');
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'orders', '{ "_id": 1, "cust": "a", "qty": 1 }');
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'orders', '{ "_id": 2, "cust": "a", "qty": 2 }');
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'orders', '{ "_id": 3, "cust": "b", "qty": 5 }');
+SELECT documentdb_api.insert_one('colocated_lookup_db', 'orders', '{ "_id": 4, "cust": "c", "qty": 7 }');
+
+-- both collections are sharded on the join field
+SELECT documentdb_api.shard_collection('colocated_lookup_db', 'customers', '{ "cust": "hashed" }', false);
+SELECT documentdb_api.shard_collection('colocated_lookup_db', 'orders', '{ "cust": "hashed" }', false);
+
+-- without the setting the lookup only joins on the documents
+SELECT colocated_lookup_test.lookup_joins_on_shard_key('{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+SELECT document FROM bson_aggregation_pipeline('colocated_lookup_db', '{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+
+-- with it the lookup also joins on the shard key value, with the same results
+SET documentdb.enableColocatedLookupPushdown TO on;
+SELECT colocated_lookup_test.lookup_joins_on_shard_key('{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+SELECT document FROM bson_aggregation_pipeline('colocated_lookup_db', '{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+SELECT colocated_lookup_test.lookup_joins_on_shard_key('{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust", "pipeline": [ { "$match": { "name": { "$ne": "bob" } } } ] } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+SELECT document FROM bson_aggregation_pipeline('colocated_lookup_db', '{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust", "pipeline": [ { "$match": { "name": { "$ne": "bob" } } } ] } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+
+-- a local field that is not the shard key can't join on the shard key value
+SELECT colocated_lookup_test.lookup_joins_on_shard_key('{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "qty", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+SELECT document FROM bson_aggregation_pipeline('colocated_lookup_db', '{ "aggregate": "orders", "pipeline": [ { "$lookup": { "from": "customers", "as": "customer", "localField": "qty", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+
+-- neither can a left side that is projected before the lookup
+SELECT colocated_lookup_test.lookup_joins_on_shard_key('{ "aggregate": "orders", "pipeline": [ { "$project": { "cust": 1 } }, { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+SELECT document FROM bson_aggregation_pipeline('colocated_lookup_db', '{ "aggregate": "orders", "pipeline": [ { "$project": { "cust": 1 } }, { "$lookup": { "from": "customers", "as": "customer", "localField": "cust", "foreignField": "cust" } }, { "$sort": { "_id": 1 } } ], "cursor": {} }');
+
+RESET documentdb.enableColocatedLookupPushdown;
+DROP SCHEMA colocated_lookup_test CASCADE;
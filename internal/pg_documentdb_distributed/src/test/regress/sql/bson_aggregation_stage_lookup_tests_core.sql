@@ -36,6 +36,27 @@ LEFT JOIN LATERAL (
 	WHERE bson_dollar_in(t2.document, t1.match)
 ) t2_agg ON TRUE;
 
+-- Repeated local values are removed from the filter with enableLookupFilterDeduplication
+SELECT bson_dollar_lookup_extract_filter_expression('{ "item_name" : [ "shirt", "hat", "shirt", "shirt" ] }', '{"item_code" : "item_name"}');
+SET documentdb.enableLookupFilterDeduplication TO on;
+SELECT bson_dollar_lookup_extract_filter_expression('{ "item_name" : [ "shirt", "hat", "shirt", "shirt" ] }', '{"item_code" : "item_name"}');
+
+-- Test filter generation 
+SELECT bson_dollar_lookup_extract_filter_expression(document, '{"item_code" : "item_name"}') FROM documentdb_api.collection('db', 'customer_purchases');
+
+-- Test full lookup sql
+WITH 
+t1 AS (SELECT document, bson_dollar_lookup_extract_filter_expression(document, '{"item_code" : "item_name"}') 
+	AS match FROM documentdb_api.collection('db', 'customer_purchases')) 
+SELECT bson_dollar_lookup_project(t1.document, t2_agg.agg, 'matched_docs'::text)
+FROM t1 
+LEFT JOIN LATERAL ( 
+	SELECT COALESCE (array_agg(t2.document::documentdb_core.bson), '{}'::bson[]) as agg 
+	FROM documentdb_api.collection('db', 'catalog_items') AS t2
+	WHERE bson_dollar_in(t2.document, t1.match)
+) t2_agg ON TRUE;
+RESET documentdb.enableLookupFilterDeduplication;
+
 -- Create Index on catalog_items
 SELECT documentdb_api_internal.create_indexes_non_concurrently(
   'db',
@@ -204,4 +204,24 @@ SELECT * FROM aggregate_cursor_first_page('db', '{ "aggregate": "source", "pipel
 
 -- out should fail when query has mutable function, if query non existent collection or query has $sample stage
 SELECT * FROM  aggregate_cursor_first_page('db', '{ "aggregate": "nonImmutable", "pipeline": [ {"$lookup": {"from": "bar", "as": "x", "localField": "f_id", "foreignField": "_id"}}, {"$out" :  "bar" } ], "cursor": { "batchSize": 1 } }', 4294967294);
-SELECT * FROM  aggregate_cursor_first_page('db', '{ "aggregate": "nonImmutable", "pipeline": [ { "$sample": { "size": 1000000 } }, {"$out" :  "bar" } ], "cursor": { "batchSize": 1 } }', 4294967294);
\ No newline at end of file
+SELECT * FROM  aggregate_cursor_first_page('db', '{ "aggregate": "nonImmutable", "pipeline": [ { "$sample": { "size": 1000000 } }, {"$out" :  "bar" } ], "cursor": { "batchSize": 1 } }', 4294967294);
+
+-- with the staged load, the output is loaded into a staging collection that gets the indexes of the target and replaces it
+SET documentdb.enableStagedOutLoad TO on;
+SELECT documentdb_api.insert('newdb', '{"insert":"src", "documents":[{ "_id" : 1, "data": "This is source collection"}]}');
+SELECT documentdb_api.insert('newdb', '{"insert":"tar", "documents":[{ "_id" : 1, "data": "This is target collection"}]}');
+SELECT documentdb_api_internal.create_indexes_non_concurrently('newdb', '{ "createIndexes": "tar", "indexes": [{ "key": {"a": 1, "b" : 1, "c" :1}, "name": "index_1" }] }'::documentdb_core.bson, true);
+SELECT documentdb_api_internal.create_indexes_non_concurrently('newdb', '{ "createIndexes": "tar", "indexes": [{ "key": {"his is some index" :1}, "name": "index_2" }] }'::documentdb_core.bson, true);
+SELECT * FROM aggregate_cursor_first_page('newdb', '{ "aggregate": "src", "pipeline": [ {"$project" : {"data" : "updating data"} }, {"$out" : { "db" : "newdb", "coll" : "tar" }  } ], "cursor": { "batchSize": 1 } }', 4294967294);
+SELECT bson_dollar_unwind(cursorpage, '$cursor.firstBatch') FROM documentdb_api.list_indexes_cursor_first_page('newdb', '{ "listIndexes": "tar" }') ORDER BY 1;
+SELECT document FROM documentdb_api.collection('newdb', 'tar');
+SELECT collection_name FROM documentdb_api_catalog.collections WHERE database_name = 'newdb' AND collection_name LIKE 'tmp.agg_out.%';
+
+-- a target that does not exist yet is loaded in place
+SELECT * FROM aggregate_cursor_first_page('newdb', '{ "aggregate": "src", "pipeline": [ {"$project" : {"data" : "updating data"} }, {"$out" : { "db" : "newdb", "coll" : "newtar" }  } ], "cursor": { "batchSize": 1 } }', 4294967294);
+SELECT document FROM documentdb_api.collection('newdb', 'newtar');
+SELECT collection_name FROM documentdb_api_catalog.collections WHERE database_name = 'newdb' AND collection_name LIKE 'tmp.agg_out.%';
+SELECT documentdb_api.drop_collection('newdb','src');
+SELECT documentdb_api.drop_collection('newdb','tar');
+SELECT documentdb_api.drop_collection('newdb','newtar');
+RESET documentdb.enableStagedOutLoad;
\ No newline at end of file
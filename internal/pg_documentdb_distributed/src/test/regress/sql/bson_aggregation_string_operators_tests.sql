@@ -766,6 +766,22 @@ select bson_dollar_project('{"_id":"1"}', '{"result" : { "$substrCP" : ["This is
 select bson_dollar_project('{"_id":"1"}', '{"result" : { "$substrCP" : ["This isa test", 2.9, -1] } }');
 select bson_dollar_project('{"_id":"1"}', '{"result" : { "$substrCP" : ["This isa test", 1, 4.2] } }');
 
+-- code point operators on multibyte strings longer than a few 8 byte words
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$strLenCP" : "aéééééééééb"} }');
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$strLenCP" : "ab€€€€€x€"} }');
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$indexOfCP" : ["ab€€€€€x€", "x"]} }');
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$indexOfCP" : ["ab€€€€€x€", "€", 3]} }');
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$indexOfCP" : ["ab€€€€€x€", "€", 7, 8]} }');
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$substrCP" : ["ab€€€€€x€", 6, 2]} }');
+select bson_dollar_project('{"_id":"1"}', '{"result" : { "$substrCP" : ["ñandú ñandú ñandú", 12, 5]} }');
+-- code point operators count every byte that is not a continuation byte, also on invalid UTF-8
+select bson_dollar_project('\x190000000273000d00000061ff808062636465666768c30000'::bytea::bson, '{"result" : { "$strLenBytes" : "$s"} }');
+select bson_dollar_project('\x190000000273000d00000061ff808062636465666768c30000'::bytea::bson, '{"result" : { "$strLenCP" : "$s"} }');
+select bson_dollar_project('\x190000000273000d00000061ff808062636465666768c30000'::bytea::bson, '{"result" : { "$indexOfCP" : ["$s", "g"]} }');
+select bson_dollar_project('\x180000000273000c0000006162ff636465666768696a0000'::bytea::bson, '{"result" : { "$strLenCP" : "$s"} }');
+select bson_dollar_project('\x180000000273000c0000006162ff636465666768696a0000'::bytea::bson, '{"result" : { "$indexOfCP" : ["$s", "c"]} }');
+select bson_dollar_project('\x180000000273000c0000006162ff636465666768696a0000'::bytea::bson, '{"result" : { "$substrCP" : ["$s", 3, 4]} }');
+
 -- $regexMatch operator: basic test:
 select bson_dollar_project('{"_id":"1"}', '{"result" : { "$regexMatch" : {"input":"", "regex" : "" }} }');
 select bson_dollar_project('{"_id":"1"}', '{"result" : { "$regexMatch" : {"input":"a", "regex" : "a" }} }');
@@ -564,6 +564,28 @@ SELECT * FROM bson_dollar_project('{}', '{"result": {"$toLong": {"$numberDouble"
 -- min supported value for $convert, $toLong
 SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "-9223372036854776832"}, "to": "long"}}}');
 SELECT * FROM bson_dollar_project('{}', '{"result": {"$toLong": {"$numberDouble": "-9223372036854776832"}}}');
+-- $convert on the boundaries of the target type with onError, only the conversions that can fail fall back to it
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "9223372036854775296"}, "to": "long", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "-9223372036854776832"}, "to": "long", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "2147483647"}, "to": "int", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "2147483648"}, "to": "int", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberLong" : "-2147483648"}, "to": "int", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberLong" : "-2147483649"}, "to": "int", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "NaN"}, "to": "int", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDecimal" : "Infinity"}, "to": "long", "onError": "failed"}}}');
+-- conversions that cannot fail, with and without onError
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberInt" : "-2147483648"}, "to": "string", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberLong" : "-9223372036854775808"}, "to": "string"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberInt" : "-2147483648"}, "to": "long", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberLong" : "9223372036854775807"}, "to": "decimal", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$date" : {"$numberLong" : "-1"}}, "to": "long", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDouble" : "NaN"}, "to": "bool", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{}', '{"result": {"$convert": {"input": {"$numberDecimal" : "-0"}, "to": "bool"}}}');
+-- a 'to' read from the document is resolved on every evaluation
+SELECT * FROM bson_dollar_project('{"t": "int"}', '{"result": {"$convert": {"input": {"$numberLong" : "2147483648"}, "to": "$t", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{"t": "int"}', '{"result": {"$convert": {"input": {"$numberLong" : "2147483647"}, "to": "$t", "onError": "failed"}}}');
+SELECT * FROM bson_dollar_project('{"t": "long"}', '{"result": {"$convert": {"input": {"$numberLong" : "2147483648"}, "to": "$t", "onError": "failed"}}}');
+
 --
 --
 -- $to* alias tests.
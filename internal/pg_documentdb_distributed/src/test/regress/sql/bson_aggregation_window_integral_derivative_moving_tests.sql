@@ -0,0 +1,18 @@
+SET search_path TO documentdb_api_catalog;
+
+SET citus.next_shard_id TO 269000;
+SET documentdb.next_collection_id TO 2690;
+SET documentdb.next_collection_index_id TO 2690;
+
+-- $integral and $derivative over sliding frames use the moving aggregate, these frames
+-- hold more points than the initial frame buffer and move past its end
+SELECT COUNT(documentdb_api.insert_one('db', 'movingIntegral', FORMAT('{ "_id": %s, "x": %s, "y": %s }', i, i * 1.5, ((i * 7) % 11) * 0.25 + 0.5)::documentdb_core.bson)) FROM generate_series(0, 39) i;
+
+-- the frame outgrows the buffer
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "movingIntegral", "pipeline": [ { "$setWindowFields": { "sortBy": { "x": 1 }, "output": { "integral": { "$integral": { "input": "$y" }, "window": { "documents": [ -20, 0 ] } }, "derivative": { "$derivative": { "input": "$y" }, "window": { "documents": [ -20, 0 ] } } } } }, { "$sort": { "x": 1 } }, { "$project": { "_id": 0 } } ] }');
+
+-- the frame is moved back to the front of the buffer
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "movingIntegral", "pipeline": [ { "$setWindowFields": { "sortBy": { "x": 1 }, "output": { "integral": { "$integral": { "input": "$y" }, "window": { "documents": [ -5, 0 ] } }, "derivative": { "$derivative": { "input": "$y" }, "window": { "documents": [ -5, 0 ] } } } } }, { "$sort": { "x": 1 } }, { "$project": { "_id": 0 } } ] }');
+
+-- range frames drop a variable number of points per row
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "movingIntegral", "pipeline": [ { "$setWindowFields": { "sortBy": { "x": 1 }, "output": { "integral": { "$integral": { "input": "$y" }, "window": { "range": [ -4.5, 0 ] } }, "derivative": { "$derivative": { "input": "$y" }, "window": { "range": [ -4.5, 0 ] } } } } }, { "$sort": { "x": 1 } }, { "$project": { "_id": 0 } } ] }');
@@ -0,0 +1,125 @@
+SET citus.next_shard_id TO 267000;
+SET documentdb.next_collection_id TO 2670;
+SET documentdb.next_collection_index_id TO 2670;
+SET search_path TO documentdb_api,documentdb_api_catalog,documentdb_api_internal,documentdb_core;
+
+SET documentdb.enableIndexOnlyScan to on;
+SET documentdb.forceIndexOnlyScanIfAvailable to on;
+SET enable_seqscan to off;
+
+
+-- if documentdb_extended_rum exists, set alternate index handler
+SELECT pg_catalog.set_config('documentdb.alternate_index_handler_name', 'extended_rum', false), extname FROM pg_extension WHERE extname = 'documentdb_extended_rum';
+
+CREATE SCHEMA covered_projection_test;
+CREATE FUNCTION covered_projection_test.find_uses_index_only_scan(findSpec text)
+RETURNS bool LANGUAGE plpgsql AS $fn$
+DECLARE
+    planLine text;
+BEGIN
+    FOR planLine IN EXECUTE format('EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_find(%L, %L)', 'covered_db', findSpec) LOOP
+        IF planLine LIKE '%Index Only Scan%' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END;
+$fn$;
+CREATE FUNCTION covered_projection_test.distinct_uses_index_only_scan(distinctSpec text)
+RETURNS bool LANGUAGE plpgsql AS $fn$
+DECLARE
+    planLine text;
+BEGIN
+    FOR planLine IN EXECUTE format('EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_distinct(%L, %L)', 'covered_db', distinctSpec) LOOP
+        IF planLine LIKE '%Index Only Scan%' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END;
+$fn$;
+CREATE FUNCTION covered_projection_test.pipeline_uses_index_only_scan(pipelineSpec text)
+RETURNS bool LANGUAGE plpgsql AS $fn$
+DECLARE
+    planLine text;
+BEGIN
+    FOR planLine IN EXECUTE format('EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_pipeline(%L, %L)', 'covered_db', pipelineSpec) LOOP
+        IF planLine LIKE '%Index Only Scan%' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END;
+$fn$;
+
+SELECT documentdb_api.create_collection('covered_db', 'covered_coll');
+SELECT documentdb_api_internal.create_indexes_non_concurrently('covered_db', '{ "createIndexes": "covered_coll", "indexes": [ { "key": { "a": 1, "b": 1 }, "storageEngine": { "enableOrderedIndex": true }, "name": "a_b_1" }] }', true);
+SELECT documentdb_api.insert_one('covered_db', 'covered_coll', '{ "_id": 1, "a": 1, "b": 1 }');
+SELECT documentdb_api.insert_one('covered_db', 'covered_coll', '{ "_id": 2, "a": 2 }');
+SELECT documentdb_api.insert_one('covered_db', 'covered_coll', '{ "_id": 3, "a": 3, "b": "x" }');
+
+-- without the covered projection setting, finds don't use index only scans
+SELECT covered_projection_test.find_uses_index_only_scan('{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+SELECT document FROM bson_aggregation_find('covered_db', '{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+
+-- with it the document is rebuilt from the index terms, paths missing from the document are left out
+SET documentdb.enableCoveredProjectionIndexOnlyScan to on;
+SELECT covered_projection_test.find_uses_index_only_scan('{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+SELECT document FROM bson_aggregation_find('covered_db', '{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+
+-- projections of paths that are not indexed need the document
+SELECT covered_projection_test.find_uses_index_only_scan('{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "c": 1, "_id": 0 } }');
+SELECT covered_projection_test.find_uses_index_only_scan('{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1 } }');
+
+-- distinct reads the whole document unless the distinct index only scan setting is on
+SELECT covered_projection_test.distinct_uses_index_only_scan('{ "distinct": "covered_coll", "key": "a" }');
+SELECT bson_dollar_unwind(document, '$values') FROM bson_aggregation_distinct('covered_db', '{ "distinct": "covered_coll", "key": "a" }') ORDER BY 1;
+SET documentdb.enableDistinctIndexOnlyScan to on;
+SELECT covered_projection_test.distinct_uses_index_only_scan('{ "distinct": "covered_coll", "key": "a" }');
+SELECT bson_dollar_unwind(document, '$values') FROM bson_aggregation_distinct('covered_db', '{ "distinct": "covered_coll", "key": "a" }') ORDER BY 1;
+
+-- documents missing the distinct path add no value, with or without a filter
+SELECT covered_projection_test.distinct_uses_index_only_scan('{ "distinct": "covered_coll", "key": "b" }');
+SELECT bson_dollar_unwind(document, '$values') FROM bson_aggregation_distinct('covered_db', '{ "distinct": "covered_coll", "key": "b" }') ORDER BY 1;
+SELECT covered_projection_test.distinct_uses_index_only_scan('{ "distinct": "covered_coll", "key": "b", "query": { "a": { "$gte": 2 } } }');
+SELECT bson_dollar_unwind(document, '$values') FROM bson_aggregation_distinct('covered_db', '{ "distinct": "covered_coll", "key": "b", "query": { "a": { "$gte": 2 } } }') ORDER BY 1;
+
+-- paths that are not indexed need the document
+SELECT covered_projection_test.distinct_uses_index_only_scan('{ "distinct": "covered_coll", "key": "c" }');
+RESET documentdb.enableDistinctIndexOnlyScan;
+
+-- $group reads the whole document unless the group index only scan setting is on
+SELECT covered_projection_test.pipeline_uses_index_only_scan('{ "aggregate": "covered_coll", "pipeline": [ { "$group": { "_id": "$a", "n": { "$sum": 1 } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('covered_db', '{ "aggregate": "covered_coll", "pipeline": [ { "$group": { "_id": "$a", "n": { "$sum": 1 } } } ] }') ORDER BY 1;
+SET documentdb.enableGroupIndexOnlyScan to on;
+SELECT covered_projection_test.pipeline_uses_index_only_scan('{ "aggregate": "covered_coll", "pipeline": [ { "$group": { "_id": "$a", "n": { "$sum": 1 } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('covered_db', '{ "aggregate": "covered_coll", "pipeline": [ { "$group": { "_id": "$a", "n": { "$sum": 1 } } } ] }') ORDER BY 1;
+
+-- groups on paths missing from a document use a null key, with or without a filter
+SELECT covered_projection_test.pipeline_uses_index_only_scan('{ "aggregate": "covered_coll", "pipeline": [ { "$match": { "a": { "$gte": 2 } } }, { "$group": { "_id": "$b", "total": { "$sum": "$a" } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('covered_db', '{ "aggregate": "covered_coll", "pipeline": [ { "$match": { "a": { "$gte": 2 } } }, { "$group": { "_id": "$b", "total": { "$sum": "$a" } } } ] }') ORDER BY 1;
+SELECT covered_projection_test.pipeline_uses_index_only_scan('{ "aggregate": "covered_coll", "pipeline": [ { "$sortByCount": "$b" } ] }');
+SELECT document FROM bson_aggregation_pipeline('covered_db', '{ "aggregate": "covered_coll", "pipeline": [ { "$sortByCount": "$b" } ] }') ORDER BY 1;
+
+-- accumulators of paths that are not indexed need the document
+SELECT covered_projection_test.pipeline_uses_index_only_scan('{ "aggregate": "covered_coll", "pipeline": [ { "$group": { "_id": "$a", "c": { "$max": "$c" } } } ] }');
+RESET documentdb.enableGroupIndexOnlyScan;
+
+-- once the index is multikey, the index terms don't rebuild the document
+SELECT documentdb_api.insert_one('covered_db', 'covered_coll', '{ "_id": 4, "a": 4, "b": [ 1, 2 ] }');
+SELECT covered_projection_test.find_uses_index_only_scan('{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+SELECT document FROM bson_aggregation_find('covered_db', '{ "find": "covered_coll", "filter": { "a": { "$gte": 1 } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+
+-- indexes with truncated terms don't rebuild the document either
+SELECT documentdb_api.create_collection('covered_db', 'covered_truncated');
+SELECT documentdb_api_internal.create_indexes_non_concurrently('covered_db', '{ "createIndexes": "covered_truncated", "indexes": [ { "key": { "a": 1, "b": 1 }, "storageEngine": { "enableOrderedIndex": true }, "name": "a_b_1" }] }', true);
+SELECT documentdb_api.insert_one('covered_db', 'covered_truncated', '{ "_id": 1, "a": "a", "b": 1 }');
+SELECT documentdb_api.insert_one('covered_db', 'covered_truncated', FORMAT('{ "_id": 2, "a": "%s", "b": 2 }', repeat('z', 10000))::bson);
+SELECT covered_projection_test.find_uses_index_only_scan('{ "find": "covered_truncated", "filter": { "a": { "$lt": "b" } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+SELECT document FROM bson_aggregation_find('covered_db', '{ "find": "covered_truncated", "filter": { "a": { "$lt": "b" } }, "projection": { "a": 1, "b": 1, "_id": 0 } }');
+
+RESET documentdb.enableCoveredProjectionIndexOnlyScan;
+RESET enable_seqscan;
+RESET documentdb.forceIndexOnlyScanIfAvailable;
+RESET documentdb.enableIndexOnlyScan;
+DROP SCHEMA covered_projection_test CASCADE;
@@ -258,6 +258,27 @@ s2 AS (SELECT COALESCE(document -> 'b' <= (LAG(document, 1) OVER ()) -> 'b', tru
 SELECT MIN(greater_check::int4), MAX(greater_check::int4) FROM s2;
 
 
+-- with parallel backward ordered scans, workers also seize the leaf pages of the backward scan and each document is returned once in order
+SET parallel_tuple_cost TO 0;
+SET parallel_setup_cost TO 0;
+SET min_parallel_table_scan_size TO 0;
+SET min_parallel_index_scan_size TO 0;
+SET max_parallel_workers_per_gather TO 2;
+SET documentdb_rum.enable_parallel_backward_ordered_scan to on;
+WITH s1 AS (SELECT document FROM bson_aggregation_pipeline('comp_db', '{ "aggregate": "query_orderby_perf2", "pipeline": [ { "$match": { "b": { "$exists": true } } }, { "$sort": { "b": 1 } } ] }')),
+s2 AS (SELECT COALESCE(document -> 'b' >= (LAG(document, 1) OVER ()) -> 'b', true) AS greater_check FROM s1)
+SELECT COUNT(*), MIN(greater_check::int4), MAX(greater_check::int4) FROM s2;
+
+WITH s1 AS (SELECT document FROM bson_aggregation_pipeline('comp_db', '{ "aggregate": "query_orderby_perf2", "pipeline": [ { "$match": { "b": { "$exists": true } } }, { "$sort": { "b": -1 } } ] }')),
+s2 AS (SELECT COALESCE(document -> 'b' <= (LAG(document, 1) OVER ()) -> 'b', true) AS greater_check FROM s1)
+SELECT COUNT(*), MIN(greater_check::int4), MAX(greater_check::int4) FROM s2;
+RESET documentdb_rum.enable_parallel_backward_ordered_scan;
+RESET max_parallel_workers_per_gather;
+RESET min_parallel_index_scan_size;
+RESET min_parallel_table_scan_size;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+
 reset documentdb.forceDisableSeqScan;
 
 -- add the complex tests that were in the composite filter order by
@@ -516,3 +537,9 @@ SELECT documentdb_api.coll_mod('comp_db', 'index_orderby_selection', '{ "collMod
 -- now it picks the sort index
 EXPLAIN (COSTS OFF, ANALYZE ON, SUMMARY OFF, TIMING OFF)
     SELECT * FROM bson_aggregation_find('comp_db', '{ "find": "index_orderby_selection", "filter": { "filter1": "filter1-5", "filter2": { "$gte": "filter2-55" }, "filter3": { "$gt": 50 } }, "sort": { "orderKey": 1 }, "limit": 10 }');
+
+-- sorted finds that stream their pages resume with a seek of the ordered index scan to the resume key
+SET documentdb.enableSortedFindStreamingCursor TO on;
+EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_getmore('comp_db', '{ "getMore": { "$numberLong": "4294967294" }, "collection": "unique_sort", "batchSize": 5 }', '{ "qi": { "$numberLong": "4294967294" }, "qp": false, "qk": 1, "qo": { "find": "unique_sort", "sort": { "a": 1 }, "batchSize": 5 }, "qr": { "k": [ { "a": 50 }, { "": 50 } ] } }');
+SELECT bson_dollar_project(cursorPage, '{ "ids": "$cursor.nextBatch._id" }') FROM cursor_get_more('comp_db', '{ "getMore": { "$numberLong": "4294967294" }, "collection": "unique_sort", "batchSize": 5 }', '{ "qi": { "$numberLong": "4294967294" }, "qp": false, "qk": 1, "qo": { "find": "unique_sort", "sort": { "a": 1 }, "batchSize": 5 }, "qr": { "k": [ { "a": 50 }, { "": 50 } ] } }');
+RESET documentdb.enableSortedFindStreamingCursor;
@@ -148,6 +148,45 @@ SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$n
 SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "-7548269564658974956438658719038456E-6120"} } }',
                                                 '{ "": { "$mul": { "a.b": {"$numberDecimal": "+9875467895987245907845734785643106E-2179"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
 
+-- Decimal128 operations on small coefficients use integer arithmetic, check it matches the BID library on the edges
+-- negative zero and exact zero results
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "-0"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "-0"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "-0"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "0"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "1.5"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "-1.50"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "-1.5"} } }',
+                                                '{ "": { "$mul": { "a.b": {"$numberDecimal": "0.00"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$subtract": [ {"$numberDecimal": "-0"}, {"$numberDecimal": "0"} ] }}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$subtract": [ {"$numberDecimal": "0"}, {"$numberDecimal": "0"} ] }}');
+-- exponent limits
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "1E+6111"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "1E+6111"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "1E-6176"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "1E-6176"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "1E+6000"} } }',
+                                                '{ "": { "$mul": { "a.b": {"$numberDecimal": "1E+111"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "0E+100"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "1.5"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+-- overflow of the coefficient or of the exponent falls back to the BID library
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "9223372036854775807"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "1"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "9223372036854775807"} } }',
+                                                '{ "": { "$mul": { "a.b": {"$numberDecimal": "2"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "1E+18"} } }',
+                                                '{ "": { "$inc": { "a.b": {"$numberDecimal": "1E-1"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "1E+6111"} } }',
+                                                '{ "": { "$mul": { "a.b": {"$numberDecimal": "1E+6111"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+SELECT documentdb_api_internal.update_bson_document('{"_id": 1, "a": { "b": {"$numberDecimal": "-1E-6176"} } }',
+                                                '{ "": { "$mul": { "a.b": {"$numberDecimal": "1E-1"} } } }', '{}', NULL::documentdb_core.bson, NULL::documentdb_core.bson,NULL::TEXT);
+-- comparisons
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$cmp": [ {"$numberDecimal": "-0"}, {"$numberDecimal": "0"} ] }}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$cmp": [ {"$numberDecimal": "1.50"}, {"$numberDecimal": "1.5"} ] }}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$cmp": [ {"$numberDecimal": "-1E-6176"}, {"$numberDecimal": "0"} ] }}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$cmp": [ {"$numberDecimal": "1E+18"}, {"$numberDecimal": "1E-1"} ] }}');
+SELECT * FROM bson_dollar_project('{}', '{"result": { "$cmp": [ {"$numberDecimal": "9223372036854775808"}, {"$numberDecimal": "9223372036854775807"} ] }}');
+
 -- Invalid exceptions are skipped because no valid test cases found (this is generally signalled if "SNaN" is part of operation which is not valid Decimal128 value to store)
 
 -- TEST for double and decimal128 ordering
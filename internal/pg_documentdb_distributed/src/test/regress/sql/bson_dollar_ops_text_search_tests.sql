@@ -25,6 +25,14 @@ SELECT document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_searc
 
 EXPLAIN (COSTS OFF) SELECT document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_search') WHERE document @@ '{ "$text": { "$search": "cat" } }';
 
+-- with the runtime recheck skipped, the text index matches the documents; the meta qual only rechecks lossy pages
+SET documentdb.enableTextIndexSkipRuntimeRecheck TO on;
+SELECT document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_search') WHERE document @@ '{ "$text": { "$search": "cat" } }';
+SELECT document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_search') WHERE document @@ '{ "$text": { "$search": "dog" } }';
+SELECT document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_search') WHERE document @@ '{ "$text": { "$search": "cat | dog" } }';
+EXPLAIN (COSTS OFF) SELECT document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_search') WHERE document @@ '{ "$text": { "$search": "cat" } }';
+RESET documentdb.enableTextIndexSkipRuntimeRecheck;
+
 -- invalid queries
 -- $text on subsequent stages should fail.
 WITH r1 AS (SELECT bson_dollar_project(document, '{ "a": 1 }') AS document FROM documentdb_api.collection('db', 'bson_dollar_ops_text_search'))
@@ -0,0 +1,53 @@
+
+SET search_path TO documentdb_core,documentdb_api,documentdb_api_catalog,documentdb_api_internal;
+SET citus.next_shard_id TO 265000;
+SET documentdb.next_collection_id TO 2650;
+SET documentdb.next_collection_index_id TO 2650;
+
+SELECT documentdb_api.drop_collection('db', 'elemmatchtest') IS NOT NULL;
+SELECT documentdb_api.create_collection('db', 'elemmatchtest') IS NOT NULL;
+
+-- the index marks documents with nested arrays so that $elemMatch expressions can skip the recheck
+SET documentdb.enableElemMatchNestedArrayTerm TO on;
+\set prevEcho :ECHO
+\set ECHO none
+\o /dev/null
+-- Create a wildcard index by using CREATE INDEX command instead of
+-- using documentdb_api.create_indexes. This is because, we will use
+-- that index to test whether we can use the index via query operators
+-- other than "@@".
+SELECT documentdb_api_internal.create_indexes_non_concurrently('db', documentdb_distributed_test_helpers.generate_create_index_arg('elemmatchtest', 'index_2', '{"$**": 1}'), true);
+\o
+\set ECHO :prevEcho
+RESET documentdb.enableElemMatchNestedArrayTerm;
+
+SELECT indexdef LIKE '%nat=true%' FROM pg_indexes WHERE schemaname = 'documentdb_data' AND indexname = 'documents_rum_index_2651';
+
+
+-- avoid plans that use the primary key index
+SELECT documentdb_distributed_test_helpers.drop_primary_key('db','elemmatchtest');
+
+BEGIN;
+set local enable_seqscan TO off;
+set local documentdb.forceUseIndexIfAvailable to on;
+\i sql/bson_query_operator_elemmatch_tests_core.sql
+ROLLBACK;
+
+-- Invalid Arguments
+SELECT object_id, document FROM documentdb_api.collection('db', 'elemmatchtest') where document @@ '{"a" : { "$elemMatch": [] }}';
+
+-- documents without nested arrays are not rechecked
+SELECT documentdb_api.insert_one('db','elemmatchtest', '{ "_id": 1, "a": [ 1, 2, 3 ] }', NULL);
+SELECT documentdb_api.insert_one('db','elemmatchtest', '{ "_id": 2, "a": [ 4, 5 ] }', NULL);
+SELECT documentdb_api.insert_one('db','elemmatchtest', '{ "_id": 3, "a": [ 4 ] }', NULL);
+BEGIN;
+set local enable_seqscan TO off;
+set local enable_bitmapscan TO off;
+set local documentdb.forceUseIndexIfAvailable to on;
+EXPLAIN (COSTS OFF, ANALYZE ON, TIMING OFF, SUMMARY OFF) SELECT document FROM bson_aggregation_find('db', '{ "find": "elemmatchtest", "filter": { "a": { "$elemMatch": { "$ne": 4 } } } }');
+
+-- the inner array of a nested array matches the expression, so that document is rechecked and removed
+SELECT documentdb_api.insert_one('db','elemmatchtest', '{ "_id": 4, "a": [ [ 3, 4 ] ] }', NULL);
+EXPLAIN (COSTS OFF, ANALYZE ON, TIMING OFF, SUMMARY OFF) SELECT document FROM bson_aggregation_find('db', '{ "find": "elemmatchtest", "filter": { "a": { "$elemMatch": { "$ne": 4 } } } }');
+SELECT document FROM documentdb_api.collection('db', 'elemmatchtest') WHERE document @@ '{ "a": { "$elemMatch": { "$ne": 4 } } }' ORDER BY object_id;
+ROLLBACK;
@@ -357,6 +357,27 @@ RESET client_min_messages;
 -- should fail even with hash collision and truncation
 SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "a": "thiskeyisalittlelargerthanthemaximumallowedsizeof60characters", "b": "thiskeyisalotorinotherwordsmuchmuchlargerthanthemaximumallowedsizeof60characters" }');
 
+-- the new equality function finds the same duplicates, also for documents with more terms than it compares without a hash table
+SET documentdb.useNewUniqueHashEqualityFunction TO on;
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "a": "thiskeyisalittlelargerthanthemaximumallowedsizeof60characters", "b": "thiskeyisalotorinotherwordsmuchmuchlargerthanthemaximumallowedsizeof60characters" }');
+-- a single term per path
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 1, "a": 1, "b": 1 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 2, "a": 1, "b": 2 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 3, "a": 1, "b": 1 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 4, "a": 1.0, "b": 2 }');
+-- a few array terms
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 5, "a": [ 1, 2, 3 ], "b": 5 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 6, "a": 3, "b": 5 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 7, "a": [ 4, 5 ], "b": 5 }');
+-- more terms than are compared without a hash table
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 8, "a": [ 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119 ], "b": 7 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 9, "a": 119, "b": 7 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 10, "a": [ 200, 201, 202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219 ], "b": 7 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 11, "a": [ 300, 301, 302, 303, 304, 305, 306, 307, 308, 309, 310, 311, 312, 313, 314, 315, 316, 317, 318, 319, 105 ], "b": 7 }');
+SELECT documentdb_api.insert_one('db', 'queryuniqueindex', '{ "_id": 12, "a": [ 300, 301, 302, 303, 304, 305, 306, 307, 308, 309, 310, 311, 312, 313, 314, 315, 316, 317, 318, 319, 105 ], "b": 9 }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "queryuniqueindex", "pipeline": [ { "$match": { "b": { "$type": "number" } } }, { "$sort": { "_id": 1 } }, { "$group": { "_id": null, "ids": { "$push": "$_id" } } } ] }');
+RESET documentdb.useNewUniqueHashEqualityFunction;
+
 -- reset data
 set documentdb.enable_large_unique_index_keys to on;
 set documentdb.indexTermLimitOverride to 60;
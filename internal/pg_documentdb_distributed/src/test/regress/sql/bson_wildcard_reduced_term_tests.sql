@@ -75,4 +75,72 @@ EXPLAIN (COSTS OFF) SELECT object_id, document FROM documentdb_api.collection('d
 
 -- these won't be pushed
 EXPLAIN (COSTS OFF) SELECT object_id, document FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "c.0.d" : { "$eq" : [ [ -1, 1, 2 ] ] }}';
-EXPLAIN (COSTS OFF) SELECT object_id, document FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "c.0" : { "$eq" : { "d" : [ [ -1, 1, 2 ] ] } }}';
\ No newline at end of file
+EXPLAIN (COSTS OFF) SELECT object_id, document FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "c.0" : { "$eq" : { "d" : [ [ -1, 1, 2 ] ] } }}';
+
+-- the path filter of wildcard indexes must not change query results
+SELECT documentdb_api.insert_one('db','wildcardpathfilter', '{"_id": 1, "a": 1, "b": { "c": "x" } }', NULL);
+SELECT documentdb_api.insert_one('db','wildcardpathfilter', '{"_id": 2, "a": [ 1, 2 ], "d": [ { "e": 5 }, { "f": null } ] }', NULL);
+SELECT documentdb_api.insert_one('db','wildcardpathfilter', '{"_id": 3, "g": [ [ { "h": 1 } ], [ 2 ] ] }', NULL);
+SELECT documentdb_api.insert_one('db','wildcardpathfilter', '{"_id": 4, "a": null }', NULL);
+
+-- build the index after the load, seeding the path filter
+SET documentdb.enableWildcardIndexPathFilter TO on;
+SELECT documentdb_api_internal.create_indexes_non_concurrently('db', '{ "createIndexes": "wildcardpathfilter", "indexes": [ { "key": { "$**": 1 }, "name": "path_filter_idx" }] }');
+
+-- inserts after the build add new paths (including under nested arrays)
+SELECT documentdb_api.insert_one('db','wildcardpathfilter', '{"_id": 5, "k": { "l": 7 } }', NULL);
+SELECT documentdb_api.insert_one('db','wildcardpathfilter', '{"_id": 6, "m": [ [ { "n": "y" } ] ] }', NULL);
+
+-- with the filter on
+BEGIN;
+SET LOCAL enable_seqscan TO off;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": { "$gt": 1 } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": { "$size": 2 } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "b.c": { "$regex": "^x" } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "d.e": 5 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "g": [ 2 ] }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "g.h": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "k.l": { "$in": [ 7, 8 ] } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "m": [ { "n": "y" } ] }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "d.f": { "$exists": true } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "b.zz": "x" }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$exists": true } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$in": [ 1, 2 ] } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$exists": false } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$in": [ 1, null ] } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": null }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "d.f": null }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": 1, "zz": 1 }' ORDER BY object_id;
+-- an index built without the filter (as if before it existed) is always scanned
+SELECT object_id FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "c.d": { "$exists": true } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "zz": 1 }' ORDER BY object_id;
+ROLLBACK;
+
+-- and with the filter off
+SET documentdb.enableWildcardIndexPathFilter TO off;
+BEGIN;
+SET LOCAL enable_seqscan TO off;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": { "$gt": 1 } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": { "$size": 2 } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "b.c": { "$regex": "^x" } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "d.e": 5 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "g": [ 2 ] }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "g.h": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "k.l": { "$in": [ 7, 8 ] } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "m": [ { "n": "y" } ] }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "d.f": { "$exists": true } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "b.zz": "x" }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$exists": true } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$in": [ 1, 2 ] } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$exists": false } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "zz": { "$in": [ 1, null ] } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": null }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "d.f": null }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardpathfilter') WHERE document @@ '{ "a": 1, "zz": 1 }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "c.d": { "$exists": true } }' ORDER BY object_id;
+SELECT object_id FROM documentdb_api.collection('db','wildcardreducedterms') WHERE document @@ '{ "zz": 1 }' ORDER BY object_id;
+ROLLBACK;
@@ -41,6 +41,9 @@ SELECT documentdb_api.coll_stats('commands_compact_db','compact_test')->>'storag
 -- Need to investigate this further for test, for live servers this should be okay because the analyze thereshold is set to 0.
 SELECT documentdb_api.compact('{"compact": "compact_test", "$db": "commands_compact_db", "dryRun": true}');
 SELECT documentdb_api.compact('{"compact": "compact_test", "$db": "commands_compact_db", "dryRun": false}');
+
+-- online compact
+SELECT documentdb_api.compact('{"compact": "compact_test", "$db": "commands_compact_db", "force": false}');
 SELECT documentdb_api.coll_stats('commands_compact_db','compact_test')->>'storageSize';
 
 SELECT documentdb_api.drop_collection('commands_compact_db','compact_test');
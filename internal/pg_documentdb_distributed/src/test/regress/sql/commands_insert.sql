@@ -59,6 +59,36 @@ select documentdb_api.insert('db', '{"insert":"into", "documents":[{"_id":1,"$a"
 select document from documentdb_api.collection('db','into') where document @@ '{}' order by document-> '_id';
 rollback;
 
+-- multi-row insert with a duplicate _id and ordered:false
+begin;
+select documentdb_api.insert('db', '{"insert":"into", "documents":[{"_id":1,"a":1},{"_id":2,"a":2},{"_id":1,"a":3},{"_id":3,"a":4}],"ordered":false}');
+select document from documentdb_api.collection('db','into') where document @@ '{}' order by document-> '_id';
+rollback;
+-- batched inserts into a local shard can write the rows directly into the table
+SET documentdb.enableDirectShardMultiInsert TO on;
+begin;
+select documentdb_api.insert('db', '{"insert":"into", "documents":[{"_id":1,"a":1},{"_id":2,"a":2},{"_id":1,"a":3},{"_id":3,"a":4}],"ordered":false}');
+select document from documentdb_api.collection('db','into') where document @@ '{}' order by document-> '_id';
+rollback;
+-- regular multi-row insert
+begin;
+select documentdb_api.insert('db', '{"insert":"into", "documents":[{"_id":1,"a":1},{"_id":2,"a":2}]}');
+select document from documentdb_api.collection('db','into') where document @@ '{}' order by document-> '_id';
+rollback;
+
+-- multi-row insert with first document key starts with $
+begin;
+select documentdb_api.insert('db', '{"insert":"into", "documents":[{"_id":1,"$a":1},{"_id":2,"a":2}]}');
+select document from documentdb_api.collection('db','into') where document @@ '{}' order by document-> '_id';
+rollback;
+
+-- multi-row insert with first document key starts with $ and ordered:false
+begin;
+select documentdb_api.insert('db', '{"insert":"into", "documents":[{"_id":1,"$a":1},{"_id":2,"a":2}],"ordered":false}');
+select document from documentdb_api.collection('db','into') where document @@ '{}' order by document-> '_id';
+rollback;
+RESET documentdb.enableDirectShardMultiInsert;
+
 -- shard the collection by _id
 select documentdb_api.shard_collection('db', 'into', '{"_id":"hashed"}', false);
 
@@ -38,6 +38,32 @@ SELECT document -> 'a' FROM documentdb_api.collection('db', 'create_indexes_vect
 
 SELECT document -> 'a' FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY documentdb_api_internal.bson_extract_vector(document, 'elem') <=> '[3, 5, 2]' DESC limit 1;
 
+-- the extract fast path builds the same vectors and raises the same errors
+SELECT documentdb_api_internal.bson_extract_vector(document, 'elem') FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY document -> 'a';
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": [ 1, 2.5, { "$numberLong": "3" } ] }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": [ 1, { "$numberDouble": "NaN" }, 3 ] }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": [ 1, { "$numberDouble": "Infinity" }, 3 ] }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": { "$binary": { "base64": "JwAAAEBAAACgQAAAwD8=", "subType": "09" } } }', 'elem');
+SET documentdb.enableVectorExtractFastPath TO on;
+SELECT documentdb_api_internal.bson_extract_vector(document, 'elem') FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY document -> 'a';
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": [ 1, 2.5, { "$numberLong": "3" } ] }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": [ 1, { "$numberDouble": "NaN" }, 3 ] }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": [ 1, { "$numberDouble": "Infinity" }, 3 ] }', 'elem');
+SELECT document -> 'a' FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY documentdb_api_internal.bson_extract_vector(document, 'elem') <=> '[10, 1, 2]';
+
+SELECT document -> 'a' FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY documentdb_api_internal.bson_extract_vector(document, 'elem') <=> '[10, 1, 2]';
+
+SELECT document -> 'a' FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY documentdb_api_internal.bson_extract_vector(document, 'elem') <=> '[3, 5, 2]' limit 1;
+
+SELECT document -> 'a' FROM documentdb_api.collection('db', 'create_indexes_vector') ORDER BY documentdb_api_internal.bson_extract_vector(document, 'elem') <=> '[3, 5, 2]' DESC limit 1;
+-- bson binary vectors: float32 and int8 are extracted, packed bit vectors are ignored
+SET documentdb.enableVectorBinaryVectorSubtype TO on;
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": { "$binary": { "base64": "JwAAAEBAAACgQAAAwD8=", "subType": "09" } } }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": { "$binary": { "base64": "AwAD+wE=", "subType": "09" } } }', 'elem');
+SELECT documentdb_api_internal.bson_extract_vector('{ "elem": { "$binary": { "base64": "EAD/", "subType": "09" } } }', 'elem');
+RESET documentdb.enableVectorBinaryVectorSubtype;
+RESET documentdb.enableVectorExtractFastPath;
+
 SELECT documentdb_distributed_test_helpers.drop_primary_key('db', 'create_indexes_vector');
 
 \d documentdb_data.documents_91000;
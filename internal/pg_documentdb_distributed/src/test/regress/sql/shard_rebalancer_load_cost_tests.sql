@@ -0,0 +1,22 @@
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+
+SET citus.next_shard_id TO 266000;
+SET documentdb.next_collection_id TO 2660;
+SET documentdb.next_collection_index_id TO 2660;
+
+
+-- the by_operation_load strategy costs shards with the function of the extension
+SELECT name, shard_cost_function::regproc, default_threshold, minimum_threshold, improvement_threshold FROM pg_catalog.pg_dist_rebalance_strategy WHERE name = 'by_operation_load';
+SELECT documentdb_api.insert_one('db', 'shard_load_cost', '{ "_id": 1, "a": 1 }');
+SELECT documentdb_api.insert_one('db', 'shard_load_cost', '{ "_id": 2, "a": 2 }');
+SELECT documentdb_api.insert_one('db', 'shard_load_cost', '{ "_id": 3, "a": 3 }');
+
+-- the cost of a shard is 1 plus its weighted operations
+SELECT documentdb_api_distributed.shard_load_cost(shardid) >= 1 FROM pg_catalog.pg_dist_shard WHERE logicalrelid = 'documentdb_data.documents_2660'::regclass;
+
+-- shards whose counters can't be read cost as much as with by_shard_count
+SELECT documentdb_api_distributed.shard_load_cost(-1);
+
+-- the write weight applies to the whole cluster, it is only set in the server configuration
+SHOW documentdb_distributed.rebalancer_write_load_weight;
+SET documentdb_distributed.rebalancer_write_load_weight TO 1;
@@ -104,6 +104,53 @@ SELECT bulk_write.do_bulk_insert(41, false);
 SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
 ROLLBACK;
 
+-- with batch resume, the documents of a failed batch are inserted one by one and the rest in batches again,
+-- the write errors and inserted documents are the same
+SET documentdb.enableInsertBatchResumeAfterFailure TO on;
+-- introduce a failure in the 432'th position (Everything before that succeeds)
+BEGIN;
+SELECT documentdb_api.insert_one('db', 'write_batching', '{ "_id": 432, "a": 600 }');
+SELECT bulk_write.do_bulk_insert(5000, true);
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
+ROLLBACK;
+
+-- introduce a failure in the 432'th position (Everything except that succeeds)
+BEGIN;
+SELECT documentdb_api.insert_one('db', 'write_batching', '{ "_id": 432, "a": 600 }');
+SELECT bulk_write.do_bulk_insert(5000, false);
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
+ROLLBACK;
+
+BEGIN;
+set local documentdb.batchWriteSubTransactionCount TO 40;
+SELECT documentdb_api.insert_one('db', 'write_batching', '{ "_id": 31, "a": 600 }');
+SELECT bulk_write.do_bulk_insert(35, false);
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
+ROLLBACK;
+
+BEGIN;
+set local documentdb.batchWriteSubTransactionCount TO 40;
+SELECT documentdb_api.insert_one('db', 'write_batching', '{ "_id": 31, "a": 600 }');
+SELECT bulk_write.do_bulk_insert(39, false);
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
+ROLLBACK;
+
+BEGIN;
+set local documentdb.batchWriteSubTransactionCount TO 40;
+SELECT documentdb_api.insert_one('db', 'write_batching', '{ "_id": 31, "a": 600 }');
+SELECT bulk_write.do_bulk_insert(40, false);
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
+ROLLBACK;
+
+BEGIN;
+set local documentdb.batchWriteSubTransactionCount TO 40;
+SELECT documentdb_api.insert_one('db', 'write_batching', '{ "_id": 31, "a": 600 }');
+SELECT bulk_write.do_bulk_insert(41, false);
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'write_batching');
+ROLLBACK;
+
+RESET documentdb.enableInsertBatchResumeAfterFailure;
+
 -- now insert 10 docs and commit
 SELECT bulk_write.do_bulk_insert(10, false);
 
@@ -72,6 +72,13 @@ typedef enum QueryCursorType
 	 */
 	QueryCursorType_PointRead,
 
+	/*
+	 * The cursor plan is a set of point reads for an $in on _id.
+	 * The ids are probed on the primary key index and returned in a single
+	 * batch, spilling to a file based cursor if the batch is full.
+	 */
+	QueryCursorType_MultiPointRead,
+
 	/*
 	 * Whether or not the query can be done as a tailable query.
 	 * 可追加游标：用于监听 capped collection 的追加数据
@@ -83,6 +90,13 @@ typedef enum QueryCursorType
 	 */
 	QueryCursorType_Tailable,
 
+	/*
+	 * A sorted find that is streamed page by page: each page reruns the query
+	 * starting from the sort key and object_id of the first document the prior
+	 * page did not return.
+	 */
+	QueryCursorType_SortedStreamable,
+
 	/*
 	 * By default all queries are persistent cursors.
 	 * 持久游标：默认类型，游标状态持久化存储
@@ -95,6 +109,31 @@ typedef enum QueryCursorType
 	QueryCursorType_Persistent,
 } QueryCursorType;
 
+/*
+ * An $out that loads its output into a staging collection: the staging
+ * collection is loaded unlogged and without secondary indexes, and replaces
+ * the target collection once the load completes.
+ */
+typedef struct OutputStagingInfo
+{
+	/* The database of the target collection */
+	text *databaseName;
+
+	/* The collection that the output is loaded into */
+	text *stagingCollectionName;
+	uint64 stagingCollectionId;
+
+	/*
+	 * The collection that the staging collection replaces, 0 if the target is
+	 * created by the $out (it is then the staging collection itself).
+	 */
+	text *targetCollectionName;
+	uint64 targetCollectionId;
+
+	/* Whether the data table of the target is clustered on _id */
+	bool targetIsClustered;
+} OutputStagingInfo;
+
 /*
  * QueryData - 查询元数据结构
  *
@@ -126,6 +165,12 @@ typedef struct
 	/* Optional cursor state const param / 可选的游标状态常量参数 */
 	pgbson *cursorStateConst;	/* 存储游标当前状态的 BSON 文档（如扫描位置、排序键等） */
 
+	/*
+	 * The resume key of a sorted streamable find (see QueryCursorType_SortedStreamable),
+	 * an empty document restarts the find from its first document.
+	 */
+	pgbson *sortResumeKeyConst;
+
 	/*
 	 * The namespaceName associated with the query.
 	 * 查询关联的命名空间名称（格式：database.collection）
@@ -160,6 +205,21 @@ typedef struct
 	 * - 这些变量在查询执行时会被替换为实际值
 	 */
 	TimeSystemVariables timeSystemVariables;
+
+	/*
+	 * Whether the query can be planned with parallel workers when it is run
+	 * to completion (single batch or file based persisted cursors).
+	 */
+	bool allowParallelPlan;
+
+	/*
+	 * The maxAwaitTimeMS of a getMore, how long a tailable cursor waits
+	 * for new results before returning an empty batch. 0 if not specified.
+	 */
+	int32_t maxAwaitTimeMS;
+
+	/* The staging collection of an $out, NULL if the output is loaded in place */
+	OutputStagingInfo *outputStaging;
 } QueryData;
 
 
@@ -330,6 +390,9 @@ Query * GenerateAggregationQuery(text *database, pgbson *aggregationSpec,
 								 QueryData *queryData, bool addCursorParams,
 								 bool setStatementTimeout);
 
+/* Builds the indexes of a staged $out and swaps it in for the target collection */
+void CompleteStagedOutput(OutputStagingInfo *outputStaging);
+
 /* ========== 辅助函数声明 ========== */
 
 /*
@@ -480,6 +543,9 @@ void ParseInputForNGroupAccumulators(const bson_value_t *inputDocument,
 									 bson_value_t *elementsToFetch,
 									 const char *opName);
 
+/* Returns the name of the stage for a Stage enum value (used by the stage counters) */
+const char * GetAggregationStageNameById(int stageId);
+
 /* ========== 全局变量 ========== */
 
 /*
@@ -47,6 +47,7 @@ typedef enum ParentStageName
 	ParentStageName_FACET,				/* $facet 阶段的子管道 */
 	ParentStageName_UNIONWITH,			/* $unionWith 阶段的子管道 */
 	ParentStageName_INVERSEMATCH,		/* $inverseMatch 阶段的子管道（DocumentDB 扩展） */
+	ParentStageName_RANKFUSION,			/* $rankFusion 阶段的输入管道 */
 } ParentStageName;
 
 
@@ -102,6 +103,7 @@ typedef enum
 	Stage_Merge,				/* $merge：将聚合结果合并到指定集合 */
 	Stage_Out,					/* $out：将聚合结果写入到指定集合（替换原内容） */
 	Stage_Project,				/* $project：重塑文档结构，包括/排除/重命名字段 */
+	Stage_RankFusion,			/* $rankFusion：按倒数排名融合多个排序管道的结果（混合检索） */
 	Stage_Redact,				/* $redact：基于条件控制文档的访问权限 */
 	Stage_ReplaceRoot,			/* $replaceRoot：将文档替换为指定字段的值 */
 	Stage_ReplaceWith,			/* $replaceWith：将文档替换为指定表达式的值 */
@@ -321,6 +323,21 @@ typedef struct
 	 */
 	bool isPointReadQuery;
 
+	/* Whether or not it's an $in on _id that can be read as multiple point reads */
+	bool isMultiPointReadQuery;
+
+	/* Whether the pipeline has a $unionWith stage */
+	bool hasUnionWith;
+
+	/*
+	 * Whether an $out may load its output into a staging collection, which is
+	 * only the case when the caller completes the staged output after the load.
+	 */
+	bool allowStagedOutput;
+
+	/* The staging collection of an $out, if any */
+	OutputStagingInfo *outputStaging;
+
 	/*Parent Stage Name*/
 	/* 父阶段名称 */
 	/*
@@ -538,6 +555,15 @@ Query * HandleDocumentsStage(const bson_value_t *existingValue, Query *query,
 Query * HandleUnionWith(const bson_value_t *existingValue, Query *query,
 						AggregationPipelineBuildContext *context);
 
+/*
+ * HandleRankFusion - 处理 $rankFusion 阶段
+ *
+ * 在同一查询中执行多个排序输入管道（如向量搜索和全文搜索）
+ * 并按倒数排名融合（RRF）合并其结果
+ */
+Query * HandleRankFusion(const bson_value_t *existingValue, Query *query,
+						 AggregationPipelineBuildContext *context);
+
 /*
  * HandleInternalInhibitOptimization - 处理内部禁止优化阶段
  *
@@ -0,0 +1,21 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/aggregation/bson_query_shape.h
+ *
+ * Query shape hashing of find/aggregate requests.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef BSON_QUERY_SHAPE_H
+#define BSON_QUERY_SHAPE_H
+
+#include <nodes/parsenodes.h>
+
+#include "io/bson_core.h"
+
+uint64 ComputeQueryShapeHash(text *database, pgbson *querySpec);
+void SetQueryShapeHash(Query *query, text *database, pgbson *querySpec);
+
+#endif
@@ -0,0 +1,21 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/aggregation/bson_tdigest.h
+ *
+ * In memory t-digest used outside of the percentile aggregates.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef BSON_TDIGEST_H
+#define BSON_TDIGEST_H
+
+typedef struct tdigest_aggstate_t TDigestState;
+
+TDigestState * CreateTDigestState(const double *percentiles, int npercentiles,
+								  int compression);
+void TDigestAddValue(TDigestState *state, double value);
+void TDigestComputePercentiles(TDigestState *state, double *result);
+
+#endif
@@ -113,6 +113,14 @@ typedef struct
 	/* Flag to decide whether to run the job on metadata coordinator only or on all nodes. */
 	/* 标志：决定是仅在元数据协调器上运行作业还是在所有节点上运行 */
 	bool toBeExecutedOnMetadataCoordinatorOnly;
+
+	/*
+	 * Whether the job command splits its work by the backgroundJobPartitionIndex and
+	 * backgroundJobPartitionCount settings. Such jobs are run as
+	 * bg_worker_max_parallel_job_executions parallel executions, one per partition.
+	 * 标志：作业命令是否按分区设置拆分工作，若是则按分区并行执行
+	 */
+	bool supportsPartitionedExecution;
 } BackgroundWorkerJob;
 
 /*
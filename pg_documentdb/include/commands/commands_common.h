@@ -132,6 +132,9 @@ void ValidateIdField(const bson_value_t *idValue);
 // 设置显式语句超时
 void SetExplicitStatementTimeout(int timeoutMilliseconds);
 
+// 按 writeConcern 设置事务的提交模式
+void SetWriteConcernCommitMode(const bson_value_t *writeConcern);
+
 // 提交写入过程并重新获取集合锁
 void CommitWriteProcedureAndReacquireCollectionLock(MongoCollection *collection,
 													Oid shardTableOid,
@@ -33,6 +33,12 @@
 /* 每个集合允许创建的最大索引数量 */
 extern int32 MaxIndexesPerCollection;
 
+/*
+ * 分片集合的 CREATE INDEX CONCURRENTLY 在各分片上扇出执行时，本地连接后端
+ * 使用的选项（例如限制每个节点并发构建的分片索引数），由分布式层设置
+ */
+extern char *IndexBuildParallelExecutionOptions;
+
 
 /* 索引定义键路径结构体 */
 typedef struct IndexDefKeyPath
@@ -16,6 +16,10 @@
 bool DrainStreamingQuery(HTAB *cursorMap, Query *query, int batchSize,
 						 int32_t *numIterations, uint32_t accumulatedSize,
 						 pgbson_array_writer *arrayWriters);
+/* Drains a page of a sorted streamable find, returning the resume key of the next page */
+bool DrainSortedStreamingQuery(Query *query, int batchSize, int32_t *numIterations,
+							   uint32_t accumulatedSize, pgbson_array_writer *arrayWriter,
+							   pgbson **resumeKey);
 /* 清空可跟踪游标查询，返回 BSON 格式的结果 */
 pgbson * DrainTailableQuery(HTAB *cursorMap, Query *query, int batchSize,
 							int32_t *numIterations, uint32_t accumulatedSize,
@@ -29,14 +33,15 @@ bool CreateAndDrainPersistedQuery(const char *cursorName, Query *query,
 /* 创建并清空单批次查询，一次性获取所有结果 */
 void CreateAndDrainSingleBatchQuery(const char *cursorName, Query *query,
 									int batchSize, int32_t *numIterations, uint32_t
-									accumulatedSize, pgbson_array_writer *arrayWriter);
+									accumulatedSize, pgbson_array_writer *arrayWriter,
+									bool allowParallelPlan);
 /* 创建并清空带文件的持久化查询，返回文件状态 */
 bytea * CreateAndDrainPersistedQueryWithFiles(const char *cursorName, Query *query,
 											  int batchSize, int32_t *numIterations,
 											  uint32_t
 											  accumulatedSize,
 											  pgbson_array_writer *arrayWriter, bool
-											  closeCursor);
+											  closeCursor, bool allowParallelPlan);
 /* 清空持久化游标，继续之前的查询 */
 bool DrainPersistedCursor(const char *cursorName, int batchSize,
 						  int32_t *numIterations, uint32_t accumulatedSize,
@@ -53,6 +58,12 @@ void CreateAndDrainPointReadQuery(const char *cursorName, Query *query,
 								  accumulatedSize,
 								  pgbson_array_writer *arrayWriter);
 
+/* Drains an $in on _id query as point reads, spilling past the batch to a cursor file */
+bytea * CreateAndDrainMultiPointReadQuery(const char *cursorName, Query *query,
+										  int batchSize, int32_t *numIterations,
+										  uint32_t accumulatedSize,
+										  pgbson_array_writer *arrayWriter);
+
 /* 构造游标结果表的元数据描述 */
 TupleDesc ConstructCursorResultTupleDesc(AttrNumber maxAttrNum);
 
@@ -73,6 +73,18 @@ typedef struct
 
 	/* parsed variable spec */
 	const bson_value_t *variableSpec;
+
+	/*
+	 * Set on the _id only upserts of a batch update when the batch probe found
+	 * no document with their _id, they skip the lookup of the document.
+	 */
+	bool isKnownToMatchNoDocument;
+
+	/*
+	 * Whether the document to update is chosen among the matching documents
+	 * that aren't locked by concurrent writes (queue style findAndModify).
+	 */
+	bool skipLockedDocuments;
 } UpdateOneParams;
 
 
@@ -53,4 +53,10 @@ void InitializeSharedMemoryHooks(void);
  * 初始化后台工作进程可以执行的安全命令列表，确保后台操作的安全性
  */
 void InitializeBackgroundWorkerJobAllowedCommands(void);
+
+/*
+ * InitializeBackgroundWorkerJobs - 注册扩展自身的后台工作进程任务
+ * 在启用 enableBackgroundWorkerTTLJob 时注册按分区执行的 TTL 清理任务
+ */
+void InitializeBackgroundWorkerJobs(void);
 #endif
@@ -72,6 +72,9 @@ typedef struct
 	/* 是否支持并行扫描 */
 	bool can_support_parallel_scans;
 
+	/* 是否支持跳跃扫描（复合索引未指定前导列时按前导列的不同值逐段定位） */
+	bool is_skip_scan_supported;
+
 	/* 获取访问方法OID的函数 */
 	Oid (*get_am_oid)(void);
 
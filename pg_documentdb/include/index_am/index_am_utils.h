@@ -156,6 +156,14 @@ GetMultikeyStatusFunc GetMultiKeyStatusByRelAm(Oid relam);
  */
 bool GetIndexSupportsBackwardsScan(Oid relam, bool *indexCanOrder);
 
+/*
+ * 获取索引访问方法是否支持跳跃扫描
+ * 输入参数：
+ *   - relam: 关系访问方法OID
+ * 返回值：是否支持跳过复合索引中未指定的前导列
+ */
+bool GetIndexAmSupportsSkipScan(Oid relam);
+
 /*
  * 获取索引访问方法是否支持仅索引扫描
  * 输入参数：
@@ -0,0 +1,35 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/index_am/index_path_filter.h
+ *
+ * 通配符索引的路径布隆过滤器
+ *
+ * 过滤器记录索引中文档出现过的所有路径，存放在RUM元页中。
+ * 查询要求某个路径存在而过滤器表明该路径从未出现过时，
+ * 索引扫描可以直接返回空结果，而不必下探条目B树。
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef INDEX_PATH_FILTER_H
+#define INDEX_PATH_FILTER_H
+
+#include "io/bson_core.h"
+
+/* 过滤器大小（字节），固定以便与元页中已有的过滤器匹配 */
+#define INDEX_PATH_FILTER_SIZE 1024
+
+/*
+ * 将文档中的所有路径加入过滤器
+ * 数组元素与其所在的数组共享同一路径（不包含数组下标）
+ */
+void IndexPathFilterAddDocumentPaths(uint8 *filter, pgbson *document);
+
+/*
+ * 如果过滤器中可能包含该路径则返回true（可能存在误报，但不会漏报）
+ */
+bool IndexPathFilterMayContainPath(const uint8 *filter, const char *path,
+								   uint32_t pathLength);
+
+#endif
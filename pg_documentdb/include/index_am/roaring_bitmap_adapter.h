@@ -22,4 +22,22 @@
  */
 void RegisterRoaringBitmapHooks(void);
 
+struct TIDBitmap;
+
+/*
+ * 将另一个Roaring位图状态求交到当前状态中（原地修改state）
+ */
+void RoaringBitmapStateIntersect(void *state, const void *otherState);
+
+/*
+ * 返回Roaring位图状态中元组的数量
+ */
+uint64 RoaringBitmapStateCardinality(const void *state);
+
+/*
+ * 将Roaring位图状态中的所有元组加入TIDBitmap，返回加入的元组数量
+ */
+int64 RoaringBitmapStateAddToTidBitmap(const void *state, struct TIDBitmap *tbm,
+									   bool recheck);
+
  #endif
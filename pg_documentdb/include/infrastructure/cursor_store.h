@@ -79,7 +79,8 @@ void WriteToCursorFile(CursorFileState *cursorFileState, pgbson *bson);
  * 从游标文件读取BSON数据
  * 输入参数：
  *   - cursorFileState: 游标文件状态
- * 返回值：读取的BSON数据
+ * 返回值：读取的BSON数据，指向当前数据块（或文件映射）内部，
+ *         在下一次读取或关闭游标文件状态前有效，调用方不得释放
  */
 pgbson * ReadFromCursorFile(CursorFileState *cursorFileState);
 
@@ -0,0 +1,20 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/infrastructure/documentdb_geospatial_shape_cache.h
+ *
+ * Backend local cache of geospatial query shapes.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef DOCUMENTDB_GEOSPATIAL_SHAPE_CACHE_H
+#define DOCUMENTDB_GEOSPATIAL_SHAPE_CACHE_H
+
+#include "geospatial/bson_geospatial_shape_operators.h"
+
+Datum GetCachedShapeDatum(const ShapeOperator *shapeOperator,
+						  const bson_value_t *shapePointsValue,
+						  ShapeOperatorInfo *opInfo);
+
+#endif
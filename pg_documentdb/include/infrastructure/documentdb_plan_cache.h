@@ -109,6 +109,9 @@
 /* 带双过滤器和let和collation的更新选择更新候选查询ID */
 #define QUERY_UPDATE_SELECT_UPDATE_CANDIDATE_BOTH_FILTER_LET_AND_COLLATION (38L << 32)
 
+/* 跳过被锁定文档（SKIP LOCKED）的更新选择更新候选查询ID偏移量 */
+#define QUERY_UPDATE_SELECT_UPDATE_CANDIDATE_SKIP_LOCKED_OFFSET (64L << 32)
+
 
 /* 更新多个操作的偏移量定义 */
 #define QUERY_UPDATE_MANY_SHARD_KEY_QUERY_OFFSET (1L << 32)
@@ -231,4 +234,17 @@ SPIPlanPtr GetSPIQueryPlanWithLocalShard(uint64 collectionId, const char *shardT
 										 uint64 queryId,
 										 const char *query, Oid *argTypes, int argCount);
 
+/*
+ * 跨会话共享的查询计划提示（plan hints）
+ * SPI计划本身只能存在于后端本地；共享内存中仅记录某个QueryKey
+ * 是否已经稳定在通用计划（generic plan）上，新的后端据此跳过自定义计划试探。
+ */
+Size QueryPlanHintShmemSize(void);
+void InitializeQueryPlanHintShmem(void);
+
+/*
+ * 使某个集合的共享计划提示失效（由relcache失效回调调用）
+ */
+void InvalidateSharedQueryPlanHints(uint64 collectionId);
+
 #endif
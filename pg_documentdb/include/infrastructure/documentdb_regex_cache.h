@@ -0,0 +1,20 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/infrastructure/documentdb_regex_cache.h
+ *
+ * Backend local cache of compiled regular expressions.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef DOCUMENTDB_REGEX_CACHE_H
+#define DOCUMENTDB_REGEX_CACHE_H
+
+#include "types/pcre_regex.h"
+
+PcreData * GetCachedRegexForAggregation(char *regexPatternStr, char *options,
+										bool enableNoAutoCapture,
+										const char *regexInvalidErrorMessage);
+
+#endif
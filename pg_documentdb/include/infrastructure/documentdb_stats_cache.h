@@ -0,0 +1,27 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/infrastructure/documentdb_stats_cache.h
+ *
+ * Shared cache of collStats/dbStats responses.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef DOCUMENTDB_STATS_CACHE_H
+#define DOCUMENTDB_STATS_CACHE_H
+
+#include <datatype/timestamp.h>
+
+#include "io/bson_core.h"
+
+Size StatsCacheShmemSize(void);
+void InitializeStatsCacheShmem(void);
+
+pgbson * GetCachedStatsResponse(const char *namespaceName, uint64 collectionId,
+								int32 scale);
+void StoreCachedStatsResponse(const char *namespaceName, uint64 collectionId,
+							  int32 scale, TimestampTz computationStartTime,
+							  const pgbson *response);
+
+#endif
@@ -14,6 +14,8 @@
 #ifndef BSON_JSON_SCHEMA_TREE_H
 #define BSON_JSON_SCHEMA_TREE_H
 
+#include <utils/hsearch.h>
+
 #include "query/bson_compare.h"
 
 #include "types/pcre_regex.h"
@@ -145,8 +147,30 @@ typedef struct ValidationsObject
 
 	/* Array of required field names */
 	bson_value_t *required;
+
+	/*
+	 * Hash of the property and required field names (SchemaFieldLookupEntry),
+	 * built once after the tree is built. NULL when not built.
+	 */
+	HTAB *fieldLookup;
+
+	/* Number of required field names in the fieldLookup */
+	int32_t numRequiredFields;
 } ValidationsObject;
 
+/* Entry of the field name lookup of an object node */
+typedef struct SchemaFieldLookupEntry
+{
+	/* The field name (key of the hash) */
+	StringView field;
+
+	/* The property node of the field, NULL if it's only required */
+	SchemaFieldNode *fieldNode;
+
+	/* Position of the field in the required array, -1 if not required */
+	int32_t requiredIndex;
+} SchemaFieldLookupEntry;
+
 typedef struct ValidationsCommon
 {
 	BsonTypeFlags jsonTypes;
@@ -245,5 +269,7 @@ typedef struct SchemaTreeState
 void BuildSchemaTree(SchemaTreeState *treeState, bson_iter_t *schemaIter);
 SchemaFieldNode * FindFieldNodeByName(const SchemaNode *parent, const
 									  char *field);
+const SchemaFieldLookupEntry * FindSchemaFieldLookupEntry(const SchemaNode *node,
+														  const StringView *field);
 
 #endif
@@ -18,6 +18,7 @@
 #include <access/attnum.h>
 #include <utils/uuid.h>
 #include <utils/array.h>
+#include <nodes/pg_list.h>
 
 #include "io/bson_core.h"
 
@@ -89,6 +90,17 @@ typedef enum
 	ValidationAction_Error         /* 错误模式 - 拒绝无效文档并报错 */
 } ValidationActions;
 
+/*
+ * The compression method used for the document column of new collection
+ * data tables (documentdb.collectionDocumentCompression).
+ */
+typedef enum
+{
+	DocumentCompression_Default = 0,  /* the server's default_toast_compression */
+	DocumentCompression_Pglz,
+	DocumentCompression_Lz4
+} DocumentCompressionMethod;
+
 /* 此结构体存储与集合关联的模式验证选项 */
 typedef struct
 {
@@ -226,6 +238,9 @@ Oid GetRelationIdForCollectionId(uint64 collectionId, LOCKMODE lockMode);
 /* create_collection()函数的C语言包装器 */
 bool CreateCollection(Datum dbNameDatum, Datum collectionNameDatum);
 
+/* 在同一事务中批量创建集合，返回新创建的集合数量 */
+int CreateCollections(text *databaseDatum, List *collectionNames);
+
 /* rename_collection()函数的C语言包装器 */
 void RenameCollection(Datum dbNameDatum, Datum srcCollectionNameDatum, Datum
 					  destCollectionNameDatum, bool dropTarget);
@@ -0,0 +1,30 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/metadata/collection_shared_cache.h
+ *
+ * Shared cache of the collection catalog rows.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef COLLECTION_SHARED_CACHE_H
+#define COLLECTION_SHARED_CACHE_H
+
+#include "metadata/collection.h"
+
+Size SharedCollectionCacheShmemSize(void);
+void InitializeSharedCollectionCacheShmem(void);
+
+bool CanUseSharedCollectionCache(void);
+uint64 GetSharedCollectionCacheVersion(void);
+bool TryGetSharedCollectionByName(const MongoCollectionName *name,
+								  MongoCollection *collection);
+bool TryGetSharedCollectionByRelationId(Oid relationId, MongoCollection *collection);
+void StoreSharedCollection(const MongoCollection *collection, uint64 cacheVersion);
+
+void InvalidateSharedCollectionByRelationId(Oid relationId);
+void ResetSharedCollectionCache(void);
+void ApplyPendingSharedCollectionInvalidations(bool isCommit);
+
+#endif
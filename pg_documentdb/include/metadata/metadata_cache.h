@@ -48,6 +48,9 @@ extern MemoryContext DocumentDBApiMetadataCacheContext;
 
 /* functions related with pg_documentdb "extension" itself */
 void InitializeDocumentDBApiExtensionCache(void);
+Size SharedMetadataCacheShmemSize(void);
+void InitializeSharedMetadataCacheShmem(void);
+void PublishDocumentDBApiOidCache(void);
 void InvalidateCollectionsCache(void);
 bool IsDocumentDBApiExtensionActive(void);
 Oid DocumentDBApiExtensionOwner(void);
@@ -404,6 +407,9 @@ Oid BsonLookupExtractFilterExpressionFunctionOid(void);
 Oid BsonDollarLookupExpressionEvalMergeOid(void);
 Oid DocumentDBApiInternalBsonLookupExtractFilterExpressionFunctionOid(void);
 Oid BsonDollarLookupJoinFilterFunctionOid(void);
+Oid BsonDollarLookupFilterHashesFunctionOid(void);
+Oid BsonDollarLookupDocumentHashesFunctionOid(void);
+Oid BsonDollarGraphLookupFunctionOid(void);
 Oid BsonLookupExtractFilterArrayFunctionOid(void);
 Oid BsonLookupUnwindFunctionOid(void);
 Oid BsonDistinctUnwindFunctionOid(void);
@@ -418,6 +424,12 @@ Oid BsonMaxNAggregateFunctionOid(void);
 Oid BsonMinNAggregateFunctionOid(void);
 Oid BsonMedianAggregateFunctionOid(void);
 Oid BsonPercentileAggregateFunctionOid(void);
+Oid BsonPercentileSketchAggregateFunctionOid(void);
+Oid BsonPercentileFromSketchesAggregateFunctionOid(void);
+Oid BsonMedianFromSketchesAggregateFunctionOid(void);
+Oid BsonArrayAggregateCombinableFunctionOid(void);
+Oid BsonAddToSetCombinableAggregateFunctionOid(void);
+Oid BsonMergeObjectsCombinableFunctionOid(void);
 
 /* Window functions*/
 Oid BsonLinearFillFunctionOid(void);
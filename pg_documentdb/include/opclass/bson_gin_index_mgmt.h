@@ -86,6 +86,12 @@ typedef struct
 	bool isWildcard;
 	bool generateNotFoundTerm;
 	bool useReducedWildcardTerms;
+
+	/* Whether documents with arrays of arrays get the root nested array term */
+	bool generateNestedArrayTerm;
+
+	/* The max terms a wildcard index generates for a document, 0 for no limit */
+	int32_t maxTermsPerDocument;
 	int path;
 } BsonGinSinglePathOptions;
 
@@ -103,6 +109,9 @@ typedef struct
 	BsonGinIndexOptionsBase base;
 	bool isExclusion;
 	bool includeId;
+
+	/* The max terms generated for a document, 0 for no limit */
+	int32_t maxTermsPerDocument;
 	int pathSpec;
 } BsonGinWildcardProjectionPathOptions;
 
@@ -226,6 +235,9 @@ int32_t GetCompositeOpClassPathCount(void *contextOptions);
 const char * GetCompositeFirstIndexPath(void *contextOptions);
 const char * GetFirstPathFromIndexOptionsIfApplicable(bytea *indexOptions,
 													  bool *isWildcardIndex);
+bool GetWildcardIndexQueryRequiredPath(bytea *indexOptions, Datum queryValue,
+									   BsonIndexStrategy strategy, const char **path,
+									   uint32_t *pathLength);
 bool PathHasArrayIndexElements(const StringView *path);
 bool SubPathHasArrayIndexElements(const StringView *path, StringView subPath);
 
@@ -69,7 +69,8 @@ Datum * GinBsonExtractQueryElemMatch(BsonExtractQueryArgs *args);
 int32_t GinBsonComparePartialElemMatch(BsonIndexTerm *queryValue,
 									   BsonIndexTerm *compareValue,
 									   Pointer extraData);
-bool GinBsonElemMatchConsistent(bool *checkArray, Pointer *extraData, int32_t numKeys);
+bool GinBsonElemMatchConsistent(bool *checkArray, Pointer *extraData, int32_t numKeys,
+								bool *recheck, bool isPreconsistent);
 
 /* Shared with exclusion ops */
 
@@ -160,6 +161,9 @@ typedef struct GinEntryPathData
 	 */
 	bool useReducedWildcardTerms;
 
+	/* Whether or not to generate the root nested array term (see hasNestedArrays) */
+	bool generateNestedArrayTerm;
+
 	/* OUTPUT: The core terms count - without any metadata post-term generation */
 	int32_t coreTermsCount;
 
@@ -176,6 +180,12 @@ typedef struct GinEntryPathData
 	 * For wildcard indexes, returns true if any path had an array ancestor
 	 */
 	bool hasArrayAncestors;
+
+	/*
+	 * OUTPUT: Whether an array at or above the path has an array element:
+	 * for a: [ [ 1, 2 ] ] the inner array also generates the term a: [ 1, 2 ].
+	 */
+	bool hasNestedArrays;
 } GinEntryPathData;
 
 
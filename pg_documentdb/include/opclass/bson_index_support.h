@@ -149,6 +149,7 @@ void ConsiderIndexOrderByPushdownForId(PlannerInfo *root, RelOptInfo *rel,
 									   ReplaceExtensionFunctionContext *context);
 void ConsiderIndexOnlyScan(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte,
 						   Index rti, ReplaceExtensionFunctionContext *context);
+void ConsiderPartialIndexesImpliedByQuals(PlannerInfo *root, RelOptInfo *rel);
 bool IsOpExprShardKeyForUnshardedCollections(Expr *expr, uint64 collectionId);
 
 IndexPath * TrimIndexRestrictInfoForBtreePath(PlannerInfo *root,
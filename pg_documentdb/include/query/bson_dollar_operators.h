@@ -104,4 +104,7 @@ bool CompareArrayForBitsAnySet(bson_iter_t *sourceArrayIter,
 Datum BsonOrderby(pgbson *leftBson, pgbson *rightBson, bool validateSort,
 				  const char *collationString);
 
+void ResetQueryDocumentDetoastCache(void);
+pgbson * GetDetoastCachedDocument(Datum documentDatum);
+
 #endif
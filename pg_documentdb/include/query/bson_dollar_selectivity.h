@@ -24,4 +24,7 @@ double GetDollarOperatorSelectivity(PlannerInfo *planner, Oid selectivityOpExpr,
 									List *args, Oid collation, int varRelId, double
 									defaultExprSelectivity);
 
+bool TryGetPathDistinctValueCount(PlannerInfo *planner, Node *documentExpr, int varRelId,
+								  const char *path, double *distinctCount);
+
 #endif
@@ -135,7 +135,7 @@ Expr * CreateShardKeyFiltersForQuery(const bson_value_t *queryDocument, pgbson *
 									 bool *isShardKeyCollationAware);
 Expr * CreateIdFilterForQuery(List *existingQuals,
 							  Index collectionVarno, bool *isCollationAware,
-							  bool *isPointRead);
+							  bool *isPointRead, bool *isMultiPointRead);
 Expr * MakeSimpleIdExpr(const bson_value_t *filterValue, Index collectionVarno, Oid
 						operatorId);
 Expr * MakeLowerBoundIdExpr(const bson_value_t *filterValue, Index collectionVarno);
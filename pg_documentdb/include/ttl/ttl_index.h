@@ -0,0 +1,23 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/ttl/ttl_index.h
+ *
+ * Exports for the ttl index purger.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef TTL_INDEX_H
+#define TTL_INDEX_H
+
+#include <postgres.h>
+
+/* The id and the timeout of the partitioned TTL background worker job */
+#define TTL_BACKGROUND_JOB_ID 1
+#define TTL_BACKGROUND_JOB_TIMEOUT_SEC 120
+
+Size TtlIndexProgressShmemSize(void);
+void InitializeTtlIndexProgressShmem(void);
+
+#endif
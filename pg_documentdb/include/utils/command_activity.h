@@ -0,0 +1,117 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/utils/command_activity.h
+ *
+ * Per backend slots describing the command each backend is running, read
+ * by currentOp.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef COMMAND_ACTIVITY_H
+#define COMMAND_ACTIVITY_H
+
+#include <datatype/timestamp.h>
+#include <utils/hsearch.h>
+
+#include "io/bson_core.h"
+#include "metadata/collection.h"
+
+#define COMMAND_ACTIVITY_NAME_LENGTH 32
+
+/*
+ * Counters of the work done by the command running in a backend. They are
+ * only written by the backend running the command so plain increments
+ * suffice, readers of other backends may see them slightly behind.
+ */
+typedef struct CommandExecutionCounters
+{
+	/* The documents the query operators were evaluated against */
+	uint64 docsExamined;
+
+	/* The index entries returned by the index scans */
+	uint64 keysExamined;
+
+	/* The index terms generated for the documents written */
+	uint64 keysInserted;
+
+	/*
+	 * The bytes written to and read from temporary files (e.g. by sorts that
+	 * spill past work_mem), only set once the command ends.
+	 */
+	uint64 tempBytesWritten;
+	uint64 tempBytesRead;
+} CommandExecutionCounters;
+
+typedef struct CommandActivitySlot
+{
+	/* The pid of the backend running the command, 0 if the slot is unused */
+	int pid;
+
+	/*
+	 * Incremented before and after every update of the slot, readers retry
+	 * while it is odd or changed during their copy (like st_changecount in
+	 * PgBackendStatus).
+	 */
+	uint32 changeCount;
+
+	/* The statement start time of the command, matches query_start */
+	TimestampTz commandStartTime;
+
+	/* The "op" reported by currentOp (e.g. "insert", "query", "command") */
+	char opType[COMMAND_ACTIVITY_NAME_LENGTH];
+
+	/* The name of the command (e.g. "find", "aggregate") */
+	char commandName[COMMAND_ACTIVITY_NAME_LENGTH];
+
+	char databaseName[MAX_DATABASE_NAME_LENGTH];
+
+	char collectionName[MAX_COLLECTION_NAME_LENGTH];
+
+	/* Not covered by changeCount, see CommandExecutionCounters */
+	CommandExecutionCounters executionCounters;
+} CommandActivitySlot;
+
+extern CommandExecutionCounters *CurrentCommandExecutionCounters;
+
+extern Size CommandActivityShmemSize(void);
+extern void InitializeCommandActivityShmem(void);
+
+extern void PublishCommandActivity(const char *opType, text *databaseName,
+								   pgbson *commandSpec);
+extern void ClearCommandActivity(void);
+extern HTAB * GetCommandActivitySnapshot(void);
+
+
+/*
+ * Counts a document examined by the query operators of the current command.
+ */
+static inline void
+ReportDocumentExamined(void)
+{
+	CurrentCommandExecutionCounters->docsExamined++;
+}
+
+
+/*
+ * Counts the index terms generated for a document written by the current command.
+ */
+static inline void
+ReportKeysInserted(uint64 keyCount)
+{
+	CurrentCommandExecutionCounters->keysInserted += keyCount;
+}
+
+
+/*
+ * Counts index entries returned to the current command by an index scan.
+ */
+static inline void
+ReportKeysExamined(uint64 keyCount)
+{
+	CurrentCommandExecutionCounters->keysExamined += keyCount;
+}
+
+
+#endif /* COMMAND_ACTIVITY_H */
@@ -19,7 +19,7 @@
 #include <port/atomics.h>
 
 #define MAX_FEATURE_NAME_LENGTH 255
-#define MAX_FEATURE_COUNT 351
+#define MAX_FEATURE_COUNT 358
 
 /* Internal features that are not exposed */
 #define INTERNAL_FEATURE_TYPE MAX_FEATURE_COUNT
@@ -206,6 +206,7 @@ typedef enum
 	FEATURE_COMMAND_CURRENTOP,
 	FEATURE_COMMAND_DBSTATS,
 	FEATURE_COMMAND_DELETE,
+	FEATURE_COMMAND_DELETE_MANY_BATCHED,
 	FEATURE_COMMAND_DISTINCT,
 	FEATURE_COMMAND_FINDANDMODIFY,
 	FEATURE_COMMAND_FIND_CURSOR_FIRST_PAGE,
@@ -266,6 +267,8 @@ typedef enum
 	FEATURE_CREATE_UNIQUE_INDEX_WITH_TERM_TRUNCATION,
 
 	/* Feature counter region - Cursor types */
+	FEATURE_CURSOR_TYPE_MULTI_POINT_READ,
+	FEATURE_CURSOR_TYPE_SORTED_STREAMING,
 	FEATURE_CURSOR_TYPE_PERSISTENT,
 	FEATURE_CURSOR_TYPE_POINT_READ,
 	FEATURE_CURSOR_TYPE_SINGLE_BATCH,
@@ -338,6 +341,7 @@ typedef enum
 	FEATURE_STAGE_FILL,
 	FEATURE_STAGE_GEONEAR,
 	FEATURE_STAGE_GRAPH_LOOKUP,
+	FEATURE_STAGE_GRAPH_LOOKUP_NATIVE,
 	FEATURE_STAGE_GROUP,
 	FEATURE_STAGE_GROUP_ACC_BOTTOMN,
 	FEATURE_STAGE_GROUP_ACC_FIRSTN,
@@ -357,12 +361,14 @@ typedef enum
 	FEATURE_STAGE_OUT,
 	FEATURE_STAGE_PROJECT,
 	FEATURE_STAGE_PROJECT_FIND,
+	FEATURE_STAGE_RANK_FUSION,
 	FEATURE_STAGE_REDACT,
 	FEATURE_STAGE_REPLACE_ROOT,
 	FEATURE_STAGE_REPLACE_WITH,
 	FEATURE_STAGE_SAMPLE,
 	FEATURE_STAGE_SEARCH,
 	FEATURE_STAGE_SEARCH_VECTOR,
+	FEATURE_STAGE_SEARCH_VECTOR_BATCHED,
 	FEATURE_STAGE_SEARCH_VECTOR_COMPRESSION_HALF,
 	FEATURE_STAGE_SEARCH_VECTOR_COMPRESSION_PQ,
 	FEATURE_STAGE_SEARCH_VECTOR_DEFAULT_NPROBES,
@@ -405,6 +411,12 @@ typedef enum
 	FEATURE_UPDATE_OPERATOR_UNSET,
 
 	/* Feature usage stats */
+	FEATURE_USAGE_GEO_SHAPE_CACHE_HIT,
+	FEATURE_USAGE_GEO_SHAPE_CACHE_MISS,
+	FEATURE_USAGE_REGEX_CACHE_HIT,
+	FEATURE_USAGE_REGEX_CACHE_MISS,
+	FEATURE_USAGE_STATS_CACHE_HIT,
+	FEATURE_USAGE_STATS_CACHE_MISS,
 	FEATURE_USAGE_TTL_PURGER_CALLS,
 	FEATURE_USAGE_TTL_SATURATED_BATCHES,
 	FEATURE_USAGE_TTL_SLOW_BATCHES,
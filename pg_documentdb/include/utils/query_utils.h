@@ -43,6 +43,13 @@ void ExtensionExecuteMultiValueQueryWithArgsViaSPI(const char *query, int nargs,
 												   char *argNulls, bool readOnly,
 												   int expectedSPIOK, Datum *datums,
 												   bool *isNull, int numValues);
+void ExtensionExecuteCappedMultiValueQueryWithArgsViaSPI(const char *query, int nargs,
+														 Oid *argTypes, Datum *argValues,
+														 char *argNulls, bool readOnly,
+														 int expectedSPIOK, Datum *datums,
+														 bool *isNull, int numValues,
+														 int statementTimeout,
+														 int lockTimeout);
 uint64 ExtensionExecuteCappedStatementWithArgsViaSPI(const char *query, int nargs,
 													 Oid *argTypes,
 													 Datum *argValues, char *argNulls,
@@ -100,6 +107,16 @@ char * ExtensionExecuteQueryOnLocalhostViaLibPQ(char *query);
 char * ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ(char *query, const Oid userOid,
 													  bool useSerialExecution);
 
+/*
+ * Same as ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ, but passes the given
+ * command-line options to the new backend.
+ */
+char * ExtensionExecuteQueryAsUserOnLocalhostWithOptionsViaLibPQ(char *query, const
+																 Oid userOid,
+																 bool useSerialExecution,
+																 const char *
+																 backendOptions);
+
 /* Same as ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ, but it allows to execute parameterized query */
 char * ExtensionExecuteQueryWithArgsAsUserOnLocalhostViaLibPQ(char *query, const Oid
 															  userOid, int nParams,
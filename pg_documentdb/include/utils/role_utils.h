@@ -51,6 +51,10 @@ void WriteMultipleRolePrivileges(HTAB *rolesTable,
 /* Function to check if a given role name contains any reserved pg role name prefixes. */
 bool ContainsReservedPgRoleNamePrefix(const char *name);
 
+/* Functions to look up and cache the role a user is a member of */
+const char * GetCachedUserParentRole(Oid userId);
+void CacheUserParentRole(Oid userId, const char *parentRole);
+
 /* Function to build a List of parent role names from an array of Datums */
 List * ConvertUserOrRoleNamesDatumToList(Datum *parentRolesDatums, int parentRolesCount);
 
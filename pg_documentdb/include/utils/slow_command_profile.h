@@ -0,0 +1,48 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/utils/slow_command_profile.h
+ *
+ * Ring buffer in shared memory of the sampled commands that ran for longer
+ * than the slow command profile threshold, read per database by the
+ * slowCommandProfile command.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef SLOW_COMMAND_PROFILE_H
+#define SLOW_COMMAND_PROFILE_H
+
+#include <utils/rel.h>
+
+#include "io/bson_core.h"
+#include "utils/command_activity.h"
+
+/* Whether the command running in the current backend was sampled for the profile */
+extern bool CurrentCommandProfiled;
+
+extern Size SlowCommandProfileShmemSize(void);
+extern void InitializeSlowCommandProfileShmem(void);
+
+extern void StartSlowCommandProfile(pgbson *commandSpec);
+extern void RecordSlowCommandProfile(const CommandActivitySlot *activity,
+									 const CommandExecutionCounters *counters,
+									 int64 durationMs);
+extern void ReportProfiledIndexScan(Relation indexRelation);
+
+
+/*
+ * Records the index scanned by the current command for the plan summary of
+ * its profile entry, if the command is profiled.
+ */
+static inline void
+ReportIndexScanForProfile(Relation indexRelation)
+{
+	if (unlikely(CurrentCommandProfiled))
+	{
+		ReportProfiledIndexScan(indexRelation);
+	}
+}
+
+
+#endif /* SLOW_COMMAND_PROFILE_H */
@@ -0,0 +1,70 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/utils/stage_counter.h
+ *
+ * Per backend counters of the work done to build aggregation stages.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef STAGE_COUNTER_H
+#define STAGE_COUNTER_H
+
+#if PG_VERSION_NUM >= 170000
+#include <storage/proc.h>
+#else
+#include <storage/backendid.h>
+#endif
+#include <port/atomics.h>
+
+/*
+ * Counters are indexed by the Stage enum of the aggregation pipeline,
+ * make sure all the stages fit.
+ */
+#define MAX_STAGE_COUNTER_COUNT 128
+
+typedef struct StageCounter
+{
+	/* The number of times the stage was built */
+	uint64 invocations;
+
+	/* The total time spent building the stage */
+	uint64 totalBuildTimeMicros;
+
+	/* The total memory allocated while building the stage */
+	uint64 allocatedBytes;
+} StageCounter;
+
+typedef StageCounter StageCounters[MAX_STAGE_COUNTER_COUNT];
+
+extern Size SharedStageCounterShmemSize(void);
+extern void SharedStageCounterShmemInit(void);
+extern StageCounters *StageCounterBackendArray;
+
+/*
+ *  Adds the cost of building a stage to the counters of the current backend.
+ *  Each backend only writes its own slot so no atomics are needed here.
+ */
+static inline void
+ReportStageBuildStats(int stageId, uint64 buildTimeMicros, uint64 allocatedBytes)
+{
+	if (stageId < 0 || stageId >= MAX_STAGE_COUNTER_COUNT)
+	{
+		return;
+	}
+
+#if PG_VERSION_NUM >= 170000
+	StageCounter *counter = &StageCounterBackendArray[MyProcNumber][stageId];
+#else
+	StageCounter *counter = &StageCounterBackendArray[MyBackendId - 1][stageId];
+#endif
+
+	counter->invocations++;
+	counter->totalBuildTimeMicros += buildTimeMicros;
+	counter->allocatedBytes += allocatedBytes;
+	pg_write_barrier();
+}
+
+
+#endif /* STAGE_COUNTER_H */
@@ -52,6 +52,20 @@
 #define VECTOR_PARAMETER_NAME_ITERATIVE_SCAN "iterativeScan"
 #define VECTOR_PARAMETER_NAME_ITERATIVE_SCAN_STR_LEN 13
 
+/* Search parameter name for the pre-filtering strategy chosen (reported in explain) */
+#define VECTOR_PARAMETER_NAME_PRE_FILTER_STRATEGY "preFilterStrategy"
+#define VECTOR_PARAMETER_NAME_PRE_FILTER_STRATEGY_STR_LEN 17
+
+/* Search parameter name for the recall the nProbes/efSearch are derived from */
+#define VECTOR_PARAMETER_NAME_TARGET_RECALL "targetRecall"
+#define VECTOR_PARAMETER_NAME_TARGET_RECALL_STR_LEN 12
+
+/* The recall the default nProbes/efSearch are expected to give, used to scale for targetRecall */
+#define VECTOR_REFERENCE_RECALL 0.9
+
+/* The maximum number of query vectors in a single batched vector search */
+#define VECTOR_SEARCH_MAX_BATCHED_VECTORS 256
+
 /* dynamic calculation of nprobes or efSearch depending on collection size */
 #define VECTOR_SEARCH_SMALL_COLLECTION_ROWS 10000
 
@@ -79,11 +93,26 @@ extern bool EnableVectorPreFilterV2;
  */
 extern int VectorPreFilterIterativeScanMode;
 
+/*
+ * GUCs to choose the pre-filtering strategy from the estimated number
+ * of documents matching the filter.
+ */
+extern bool EnableVectorAdaptivePreFilter;
+
+/*
+ * GUC to enable batched vector search, with a list of query vectors.
+ */
+extern bool EnableVectorSearchBatchedQueries;
+extern bool EnableVectorExtractFastPath;
+extern bool EnableVectorBinaryVectorSubtype;
+extern int VectorPreFilterExactSearchMaxRows;
+
 /*
  * GUC to enable vector compression feature for vector search.
  */
 extern bool EnableVectorCompressionHalf;
 extern bool EnableVectorCompressionPQ;
+extern bool EnableVectorCompressionSingleRerankDistance;
 
 /*
  * GUC to enable vector search default search parameter calculation.
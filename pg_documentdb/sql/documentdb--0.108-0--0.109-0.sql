@@ -2,13 +2,21 @@
 #include "udfs/query/bson_dollar_evaluation--0.109-0.sql"
 #include "schema/background_jobs_registry--0.109-0.sql"
 #include "udfs/commands_diagnostic/kill_op--0.109-0.sql"
+#include "udfs/telemetry/command_stage_counter--0.109-0.sql"
+#include "udfs/commands_diagnostic/slow_command_profile--0.109-0.sql"
+#include "udfs/schema_mgmt/drop_orphaned_collection_tables_background--0.109-0.sql"
+#include "udfs/index_mgmt/create_collections_with_indexes--0.109-0.sql"
 #include "udfs/aggregation/group_aggregates_support--0.109-0.sql"
 #include "udfs/aggregation/group_aggregates--0.109-0.sql"
+#include "udfs/aggregation/window_aggregate_support--0.109-0.sql"
+#include "udfs/aggregation/window_aggregates--0.109-0.sql"
 #include "udfs/rum/bson_rum_shard_exclusion_functions--0.109-0.sql"
 #include "schema/unique_shard_path_operator_class--0.109-0.sql"
 #include "udfs/aggregation/bson_aggregation_getmore--0.109-0.sql"
+#include "udfs/aggregation/bson_lookup_functions--0.109-0.sql"
 
 #include "schema/background_index_queue--0.109-0.sql"
+#include "schema/index_build_progress--0.109-0.sql"
 
 
 -- fix the return of gin_bson_compare which was created incorrectly.
@@ -0,0 +1,43 @@
+-- Progress and throughput of the index builds running on this node.
+-- The rates are computed from the start of the current transaction of the build, which for
+-- concurrent builds is the start of the current phase. The estimate of the remaining time
+-- only applies to the table scan (where blocks_total is set).
+CREATE OR REPLACE VIEW __API_CATALOG_SCHEMA_V2__.__EXTENSION_OBJECT_V2__(_index_build_progress) AS
+  WITH progress AS (
+    SELECT p.pid,
+           p.phase,
+           p.command LIKE '%CONCURRENTLY%' AS concurrent,
+           substring(t.relname FROM '^documents_([0-9]+)')::bigint AS collection_id,
+           substring(i.relname FROM '^documents_rum_index_([0-9]+)')::integer AS index_id,
+           p.blocks_done,
+           p.blocks_total,
+           p.tuples_done,
+           p.tuples_total,
+           EXTRACT(EPOCH FROM (pg_catalog.now() - a.xact_start))::float8 AS secs_running,
+           (SELECT COUNT(*) FROM pg_catalog.pg_stat_activity w WHERE w.leader_pid = p.pid)::int4 AS workers
+    FROM pg_catalog.pg_stat_progress_create_index p
+    LEFT JOIN pg_catalog.pg_stat_activity a ON a.pid = p.pid
+    LEFT JOIN pg_catalog.pg_class t ON t.oid = p.relid
+    LEFT JOIN pg_catalog.pg_class i ON i.oid = p.index_relid)
+  SELECT progress.pid,
+         coll.database_name,
+         coll.collection_name,
+         (ind.index_spec).index_name AS index_name,
+         progress.phase,
+         progress.concurrent,
+         progress.blocks_done,
+         progress.blocks_total,
+         progress.tuples_done,
+         progress.tuples_total,
+         progress.secs_running,
+         (progress.blocks_done / NULLIF(progress.secs_running, 0))::float8 AS blocks_per_sec,
+         (progress.tuples_done / NULLIF(progress.secs_running, 0))::float8 AS tuples_per_sec,
+         (CASE WHEN progress.blocks_total > 0
+               THEN (progress.blocks_total - progress.blocks_done) * progress.secs_running / NULLIF(progress.blocks_done, 0)
+          END)::float8 AS estimated_secs_remaining,
+         progress.workers
+  FROM progress
+  LEFT JOIN __API_CATALOG_SCHEMA__.collections coll ON coll.collection_id = progress.collection_id
+  LEFT JOIN __API_CATALOG_SCHEMA__.collection_indexes ind ON ind.index_id = progress.index_id;
+
+GRANT SELECT ON TABLE __API_CATALOG_SCHEMA_V2__.__EXTENSION_OBJECT_V2__(_index_build_progress) TO public;
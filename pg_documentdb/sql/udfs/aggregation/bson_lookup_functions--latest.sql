@@ -35,4 +35,22 @@ CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_dollar_lookup_project
  RETURNS SETOF __CORE_SCHEMA__.bson
  LANGUAGE c
  IMMUTABLE PARALLEL SAFE STRICT ROWS 100
-AS 'MODULE_PATHNAME', $function$bson_dollar_lookup_project$function$;
\ No newline at end of file
+AS 'MODULE_PATHNAME', $function$bson_dollar_lookup_project$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_dollar_lookup_filter_hashes(__CORE_SCHEMA__.bson)
+ RETURNS SETOF int8
+ LANGUAGE c
+ IMMUTABLE PARALLEL SAFE STRICT ROWS 2
+AS 'MODULE_PATHNAME', $function$bson_dollar_lookup_filter_hashes$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_dollar_lookup_document_hashes(__CORE_SCHEMA__.bson, text)
+ RETURNS SETOF int8
+ LANGUAGE c
+ IMMUTABLE PARALLEL SAFE STRICT ROWS 2
+AS 'MODULE_PATHNAME', $function$bson_dollar_lookup_document_hashes$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_dollar_graph_lookup(__CORE_SCHEMA__.bson, __CORE_SCHEMA__.bson)
+ RETURNS __CORE_SCHEMA__.bson
+ LANGUAGE c
+ STABLE PARALLEL RESTRICTED STRICT
+AS 'MODULE_PATHNAME', $function$bson_dollar_graph_lookup$function$;
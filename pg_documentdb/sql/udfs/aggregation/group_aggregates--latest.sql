@@ -205,11 +205,17 @@ CREATE OR REPLACE AGGREGATE __API_CATALOG_SCHEMA__.BSONLASTNONSORTED(__CORE_SCHE
     PARALLEL = SAFE
 );
 
+/*
+ * The states of $push, $addToSet and $mergeObjects grow with the group, SSPACE is
+ * the per group estimate the planner and the hash aggregate use to size the
+ * groups kept in memory before spilling (the default is the width of a bytea).
+ */
 CREATE OR REPLACE AGGREGATE __API_CATALOG_SCHEMA__.BSON_ARRAY_AGG(__CORE_SCHEMA__.bson, text)
 (
     SFUNC = __API_CATALOG_SCHEMA__.bson_array_agg_transition,
     FINALFUNC = __API_CATALOG_SCHEMA__.bson_array_agg_final,
     stype = bytea,
+    SSPACE = 1024,
     PARALLEL = SAFE
 );
 
@@ -218,6 +224,7 @@ CREATE OR REPLACE AGGREGATE __API_CATALOG_SCHEMA__.BSON_OBJECT_AGG(__CORE_SCHEMA
     SFUNC = __API_CATALOG_SCHEMA__.bson_object_agg_transition,
     FINALFUNC = __API_CATALOG_SCHEMA__.bson_object_agg_final,
     stype = bytea,
+    SSPACE = 1024,
     PARALLEL = SAFE
 );
 
@@ -230,6 +237,7 @@ CREATE OR REPLACE AGGREGATE __API_CATALOG_SCHEMA__.BSON_ARRAY_AGG(__CORE_SCHEMA_
     SFUNC = __API_CATALOG_SCHEMA__.bson_array_agg_transition,
     FINALFUNC = __API_CATALOG_SCHEMA__.bson_array_agg_final,
     stype = bytea,
+    SSPACE = 1024,
     mstype = bytea,
     MSFUNC = __API_CATALOG_SCHEMA__.bson_array_agg_transition,
     MFINALFUNC = __API_CATALOG_SCHEMA__.bson_array_agg_final,
@@ -242,6 +250,7 @@ CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSON_ADD_TO_SET(__CORE_SC
     SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_transition,
     FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_final,
     stype = bytea,
+    SSPACE = 1024,
     PARALLEL = SAFE
 );
 
@@ -250,6 +259,7 @@ CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSON_MERGE_OBJECTS_ON_SOR
     SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_transition_on_sorted,
     FINALFUNC = __API_CATALOG_SCHEMA__.bson_object_agg_final,
     stype = bytea,
+    SSPACE = 1024,
     PARALLEL = SAFE
 );
 
@@ -261,6 +271,7 @@ CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSON_MERGE_OBJECTS(__CORE
     SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_transition,
     FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_final,
     stype = bytea,
+    SSPACE = 1024,
     COMBINEFUNC = __API_CATALOG_SCHEMA__.bson_firstn_combine,
     PARALLEL = SAFE
 );
@@ -415,4 +426,77 @@ CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSONMEDIAN(__CORE_SCHEMA_
     DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_deserial,
     COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_combine,
     PARALLEL = SAFE
+);
+
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSONPERCENTILESKETCH(__CORE_SCHEMA__.bson, int4)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_add_double_for_sketch,
+    stype = internal,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_sketch_final,
+    SERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_serial,
+    DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_deserial,
+    COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_combine,
+    PARALLEL = SAFE
+);
+
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSONPERCENTILEFROMSKETCHES(__CORE_SCHEMA__.bson, int4, __CORE_SCHEMA__.bson)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_add_sketch,
+    stype = internal,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_array_percentiles,
+    SERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_serial,
+    DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_deserial,
+    COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_combine,
+    PARALLEL = SAFE
+);
+
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSONMEDIANFROMSKETCHES(__CORE_SCHEMA__.bson, int4, __CORE_SCHEMA__.bson)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_add_sketch,
+    stype = internal,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_percentile,
+    SERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_serial,
+    DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_deserial,
+    COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.tdigest_combine,
+    PARALLEL = SAFE
+);
+
+/*
+ * Combinable versions of $push, $addToSet and $mergeObjects (without a sort spec)
+ * that support partial aggregation across parallel workers and shards.
+ */
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSON_ARRAY_AGG_COMBINABLE(__CORE_SCHEMA__.bson, text, boolean)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_array_agg_combinable_transition,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_array_agg_combinable_final,
+    stype = internal,
+    SSPACE = 1024,
+    SERIALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_array_agg_serialize,
+    DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_array_agg_deserialize,
+    COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.bson_array_agg_combine,
+    PARALLEL = SAFE
+);
+
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSON_ADD_TO_SET_COMBINABLE(__CORE_SCHEMA_V2__.bson)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_combinable_transition,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_combinable_final,
+    stype = internal,
+    SSPACE = 1024,
+    SERIALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_serialize,
+    DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_deserialize,
+    COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_combine,
+    PARALLEL = SAFE
+);
+
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSON_MERGE_OBJECTS_COMBINABLE(__CORE_SCHEMA_V2__.bson)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_combinable_transition,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_combinable_final,
+    stype = internal,
+    SSPACE = 1024,
+    SERIALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_object_agg_serialize,
+    DESERIALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_object_agg_deserialize,
+    COMBINEFUNC = __API_SCHEMA_INTERNAL_V2__.bson_object_agg_combine,
+    PARALLEL = SAFE
 );
\ No newline at end of file
@@ -368,6 +368,24 @@ CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.tdigest_deserial(bytea, in
  IMMUTABLE STRICT
 AS 'MODULE_PATHNAME', $function$tdigest_deserial$function$;
 
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.tdigest_add_double_for_sketch(internal, __CORE_SCHEMA__.bson, int4)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE
+AS 'MODULE_PATHNAME', $function$tdigest_add_double_for_sketch$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.tdigest_sketch_final(internal)
+ RETURNS __CORE_SCHEMA__.bson
+ LANGUAGE c
+ IMMUTABLE
+AS 'MODULE_PATHNAME', $function$tdigest_sketch_final$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.tdigest_add_sketch(internal, __CORE_SCHEMA__.bson, int4, __CORE_SCHEMA__.bson)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE
+AS 'MODULE_PATHNAME', $function$tdigest_add_sketch$function$;
+
 CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_count_transition(int8, int4)
  RETURNS int8
  LANGUAGE c
@@ -391,3 +409,98 @@ CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_command_count_final(i
  LANGUAGE c
  STABLE
 AS 'MODULE_PATHNAME', $function$bson_command_count_final$function$;
+
+/*
+ * Support functions of the combinable $push, $addToSet and $mergeObjects aggregates.
+ * The transition and final functions are shared with the bytea aggregates, the
+ * state is an internal pointer that is flattened by the serialize functions.
+ */
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_array_agg_combinable_transition(internal, __CORE_SCHEMA__.bson, text, boolean)
+ RETURNS internal
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_array_agg_transition$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_array_agg_combinable_final(internal)
+ RETURNS __CORE_SCHEMA__.bson
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_array_agg_final$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_array_agg_serialize(internal)
+ RETURNS bytea
+ LANGUAGE c
+ IMMUTABLE STRICT
+AS 'MODULE_PATHNAME', $function$bson_array_agg_serialize$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_array_agg_deserialize(bytea, internal)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE STRICT
+AS 'MODULE_PATHNAME', $function$bson_array_agg_deserialize$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_array_agg_combine(internal, internal)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE
+AS 'MODULE_PATHNAME', $function$bson_array_agg_combine$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_combinable_transition(internal, __CORE_SCHEMA_V2__.bson)
+ RETURNS internal
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_add_to_set_transition$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_combinable_final(internal)
+ RETURNS __CORE_SCHEMA_V2__.bson
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_add_to_set_final$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_serialize(internal)
+ RETURNS bytea
+ LANGUAGE c
+ IMMUTABLE STRICT
+AS 'MODULE_PATHNAME', $function$bson_add_to_set_serialize$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_deserialize(bytea, internal)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE STRICT
+AS 'MODULE_PATHNAME', $function$bson_add_to_set_deserialize$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_add_to_set_combine(internal, internal)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE
+AS 'MODULE_PATHNAME', $function$bson_add_to_set_combine$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_combinable_transition(internal, __CORE_SCHEMA_V2__.bson)
+ RETURNS internal
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_merge_objects_transition_on_sorted$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_merge_objects_combinable_final(internal)
+ RETURNS __CORE_SCHEMA__.bson
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_object_agg_final$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_object_agg_serialize(internal)
+ RETURNS bytea
+ LANGUAGE c
+ IMMUTABLE STRICT
+AS 'MODULE_PATHNAME', $function$bson_object_agg_serialize$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_object_agg_deserialize(bytea, internal)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE STRICT
+AS 'MODULE_PATHNAME', $function$bson_object_agg_deserialize$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_object_agg_combine(internal, internal)
+ RETURNS internal
+ LANGUAGE c
+ IMMUTABLE
+AS 'MODULE_PATHNAME', $function$bson_object_agg_combine$function$;
@@ -107,6 +107,30 @@ CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_f
  STABLE
 AS 'MODULE_PATHNAME', $function$bson_integral_derivative_final$function$;
 
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_integral_moving_transition(bytea, __CORE_SCHEMA__.bson, __CORE_SCHEMA__.bson, bigint)
+ RETURNS bytea
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_integral_moving_transition$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_derivative_moving_transition(bytea, __CORE_SCHEMA__.bson, __CORE_SCHEMA__.bson, bigint)
+ RETURNS bytea
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_derivative_moving_transition$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_minvtransition(bytea, __CORE_SCHEMA__.bson, __CORE_SCHEMA__.bson, bigint)
+ RETURNS bytea
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_integral_derivative_minvtransition$function$;
+
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_moving_final(bytea)
+ RETURNS __CORE_SCHEMA__.bson
+ LANGUAGE c
+ STABLE
+AS 'MODULE_PATHNAME', $function$bson_integral_derivative_moving_final$function$;
+
 CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.bson_std_dev_pop_samp_winfunc_invtransition(bytea, __CORE_SCHEMA__.bson)
  RETURNS bytea
  LANGUAGE c
@@ -0,0 +1,24 @@
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSONDERIVATIVE(__CORE_SCHEMA__.bson, __CORE_SCHEMA__.bson, bigint)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_derivative_transition,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_final,
+    stype = bytea,
+    mstype = bytea,
+    MSFUNC = __API_SCHEMA_INTERNAL_V2__.bson_derivative_moving_transition,
+    MFINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_moving_final,
+    MINVFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_minvtransition,
+    PARALLEL = SAFE
+);
+
+
+CREATE OR REPLACE AGGREGATE __API_SCHEMA_INTERNAL_V2__.BSONINTEGRAL(__CORE_SCHEMA__.bson, __CORE_SCHEMA__.bson, bigint)
+(
+    SFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_transition,
+    FINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_final,
+    stype = bytea,
+    mstype = bytea,
+    MSFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_moving_transition,
+    MFINALFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_moving_final,
+    MINVFUNC = __API_SCHEMA_INTERNAL_V2__.bson_integral_derivative_minvtransition,
+    PARALLEL = SAFE
+);
@@ -0,0 +1,7 @@
+-- slowCommandProfile diagnostic command implementation, returns the slow commands
+-- profiled for the database
+CREATE OR REPLACE FUNCTION __API_SCHEMA_V2__.slow_command_profile(p_database_name text)
+RETURNS __CORE_SCHEMA_V2__.bson
+ LANGUAGE c
+ VOLATILE STRICT
+AS 'MODULE_PATHNAME', $function$command_slow_command_profile$function$;
@@ -0,0 +1,12 @@
+/*
+ * Creates a set of collections along with their indexes in a single
+ * transaction, the spec is of the form
+ * { "collections": [ { "name": <collection>, "indexes": [ <index specs> ] } ] }
+ */
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.create_collections_with_indexes(
+    IN p_database_name text,
+    IN p_spec __CORE_SCHEMA_V2__.bson)
+ RETURNS __CORE_SCHEMA_V2__.bson
+ LANGUAGE C
+ VOLATILE STRICT
+AS 'MODULE_PATHNAME', $$command_create_collections_with_indexes$$;
@@ -0,0 +1,11 @@
+/*
+ * Drops the data and retry tables of collections that were dropped with
+ * deferred storage reclamation (enableDeferredCollectionDrop). This is called
+ * periodically by the background worker framework and drops at most
+ * p_batch_size tables per call (deferredCollectionDropBatchSize if negative).
+ */
+CREATE OR REPLACE PROCEDURE __API_SCHEMA_INTERNAL_V2__.drop_orphaned_collection_tables_background(IN p_batch_size int default -1)
+    LANGUAGE c
+AS 'MODULE_PATHNAME', $procedure$drop_orphaned_collection_tables_background$procedure$;
+COMMENT ON PROCEDURE __API_SCHEMA_INTERNAL_V2__.drop_orphaned_collection_tables_background(int)
+    IS 'Drops the tables of collections whose drop deferred the storage reclamation.';
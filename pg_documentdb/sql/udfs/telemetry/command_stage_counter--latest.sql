@@ -0,0 +1,11 @@
+-- This function is used to get the number of times each aggregation stage was built
+-- and the time and memory spent building it, for reporting to the telemetry pipeline
+CREATE OR REPLACE FUNCTION __API_SCHEMA_INTERNAL_V2__.command_stage_counter_stats(
+	IN reset_stats_after_read bool,
+	OUT stage_name text,
+	OUT invocations bigint,
+	OUT total_build_time_us bigint,
+	OUT allocated_bytes bigint)
+RETURNS SETOF RECORD
+LANGUAGE C VOLATILE PARALLEL UNSAFE
+AS 'MODULE_PATHNAME', $$get_stage_counter_stats$$;
@@ -18,6 +18,7 @@
 #include "query/bson_compare.h"
 #include <utils/array.h>
 #include <utils/builtins.h>
+#include <utils/memutils.h>
 #include <utils/heap_utils.h>
 #include "utils/documentdb_errors.h"
 #include "metadata/collection.h"
@@ -59,6 +60,12 @@ typedef struct BsonArrayAggState
 typedef struct BsonObjectAggState
 {
 	BsonIntermediatePathNode *tree;
+
+	/*
+	 * Holds the nodes of the tree and the documents they point into, so that
+	 * they are released at once when the tree is no longer needed.
+	 */
+	MemoryContext treeContext;
 	int64_t currentSizeWritten;
 	bool addEmptyPath;
 } BsonObjectAggState;
@@ -86,8 +93,13 @@ const char charset[] = "abcdefghijklmnopqrstuvwxyz0123456789";
 
 static MaxAlignedVarlena * AllocateBsonNumericAggState(void);
 static void CheckAggregateIntermediateResultSize(uint32_t size);
+static void InitializeObjectAggState(BsonObjectAggState *state,
+									 MemoryContext parentContext);
 static void CreateObjectAggTreeNodes(BsonObjectAggState *currentState,
 									 pgbson *currentValue);
+static void AddFieldsToObjectAggTree(BsonObjectAggState *currentState,
+									 bson_iter_t *docIter);
+static pgbson * WriteObjectAggTreeToPgbson(BsonObjectAggState *state);
 static void ValidateMergeObjectsInput(pgbson *input);
 static Datum ParseAndReturnMergeObjectsTree(BsonObjectAggState *state);
 static Datum bson_maxminn_transition(PG_FUNCTION_ARGS, bool isMaxN);
@@ -135,6 +147,15 @@ PG_FUNCTION_INFO_V1(bson_count_transition);
 PG_FUNCTION_INFO_V1(bson_count_combine);
 PG_FUNCTION_INFO_V1(bson_count_final);
 PG_FUNCTION_INFO_V1(bson_command_count_final);
+PG_FUNCTION_INFO_V1(bson_array_agg_serialize);
+PG_FUNCTION_INFO_V1(bson_array_agg_deserialize);
+PG_FUNCTION_INFO_V1(bson_array_agg_combine);
+PG_FUNCTION_INFO_V1(bson_add_to_set_serialize);
+PG_FUNCTION_INFO_V1(bson_add_to_set_deserialize);
+PG_FUNCTION_INFO_V1(bson_add_to_set_combine);
+PG_FUNCTION_INFO_V1(bson_object_agg_serialize);
+PG_FUNCTION_INFO_V1(bson_object_agg_deserialize);
+PG_FUNCTION_INFO_V1(bson_object_agg_combine);
 
 Datum
 bson_out_transition(PG_FUNCTION_ARGS)
@@ -397,9 +418,7 @@ AggregateObjectsCore(PG_FUNCTION_ARGS)
 		bytes = AllocateMaxAlignedVarlena(sizeof(BsonObjectAggState));
 
 		currentState = (BsonObjectAggState *) bytes->state;
-		currentState->currentSizeWritten = 0;
-		currentState->tree = MakeRootNode();
-		currentState->addEmptyPath = false;
+		InitializeObjectAggState(currentState, aggregateContext);
 	}
 	else
 	{
@@ -418,6 +437,7 @@ AggregateObjectsCore(PG_FUNCTION_ARGS)
 		 * in the tree will reference an address in the stack. These are released after
 		 * the function resolves and will point to garbage.
 		 */
+		MemoryContextSwitchTo(currentState->treeContext);
 		currentValue = PgbsonCloneFromPgbson(currentValue);
 		CreateObjectAggTreeNodes(currentState, currentValue);
 		currentState->currentSizeWritten += PgbsonGetBsonSize(currentValue);
@@ -475,9 +495,7 @@ bson_merge_objects_final(PG_FUNCTION_ARGS)
 	 * Here we initialize BsonObjectAggState.
 	 * It is necessary to build the bson tree used by $mergeObjects.
 	 */
-	mergeObjectsState.currentSizeWritten = 0;
-	mergeObjectsState.tree = MakeRootNode();
-	mergeObjectsState.addEmptyPath = false;
+	InitializeObjectAggState(&mergeObjectsState, CurrentMemoryContext);
 
 	/* Deserializing the structure used to sort data. */
 	DeserializeOrderState(PG_GETARG_BYTEA_P(0), &orderState);
@@ -510,6 +528,8 @@ bson_merge_objects_final(PG_FUNCTION_ARGS)
 		/* Check for null value*/
 		if (orderState.currentResult[i]->value != NULL)
 		{
+			MemoryContext oldContext = MemoryContextSwitchTo(
+				mergeObjectsState.treeContext);
 			PgbsonWriterInit(&writer);
 			EvaluateAggregationExpressionDataToWriter(state,
 													  orderState.currentResult[i]->value,
@@ -524,6 +544,7 @@ bson_merge_objects_final(PG_FUNCTION_ARGS)
 			/* Feed the tree with the evaluated bson. */
 			CreateObjectAggTreeNodes(&mergeObjectsState,
 									 evaluatedDoc);
+			MemoryContextSwitchTo(oldContext);
 		}
 	}
 
@@ -1213,6 +1234,465 @@ bson_add_to_set_final(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * The functions below support partial aggregation (parallel workers and
+ * distributed $group) for $push, $addToSet and $mergeObjects. The states of
+ * these accumulators hold pointers (lists, hash tables and bson trees), so
+ * the combinable aggregates use an internal state that is flattened by the
+ * serialize functions and rebuilt by the deserialize functions.
+ * The transition and final functions are the same as the bytea aggregates.
+ */
+
+/*
+ * Serializes the state of the $push aggregate as
+ * | currentSizeWritten | handleSingleValueElement | pathLength | path |
+ * | count | (length | bson bytes) ... |
+ * where a length of 0 stands for a NULL value.
+ */
+Datum
+bson_array_agg_serialize(PG_FUNCTION_ARGS)
+{
+	MaxAlignedVarlena *bytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(0);
+	BsonArrayAggState *state = (BsonArrayAggState *) bytes->state;
+
+	uint32 pathLength = strlen(state->path);
+	uint32 count = list_length(state->aggregateList);
+	Size size = VARHDRSZ + sizeof(int32) + sizeof(bool) + sizeof(uint32) +
+				pathLength + sizeof(uint32) + count * sizeof(uint32);
+
+	ListCell *cell;
+	foreach(cell, state->aggregateList)
+	{
+		pgbson *value = lfirst(cell);
+		if (value != NULL)
+		{
+			size += PgbsonGetBsonSize(value);
+		}
+	}
+
+	bytea *result = palloc(size);
+	SET_VARSIZE(result, size);
+	char *ptr = VARDATA(result);
+
+	memcpy(ptr, &state->currentSizeWritten, sizeof(int32));
+	ptr += sizeof(int32);
+	memcpy(ptr, &state->handleSingleValueElement, sizeof(bool));
+	ptr += sizeof(bool);
+	memcpy(ptr, &pathLength, sizeof(uint32));
+	ptr += sizeof(uint32);
+	memcpy(ptr, state->path, pathLength);
+	ptr += pathLength;
+	memcpy(ptr, &count, sizeof(uint32));
+	ptr += sizeof(uint32);
+
+	foreach(cell, state->aggregateList)
+	{
+		pgbson *value = lfirst(cell);
+		uint32 valueLength = value != NULL ? PgbsonGetBsonSize(value) : 0;
+		memcpy(ptr, &valueLength, sizeof(uint32));
+		ptr += sizeof(uint32);
+		if (valueLength > 0)
+		{
+			memcpy(ptr, VARDATA_ANY(value), valueLength);
+			ptr += valueLength;
+		}
+	}
+
+	Assert(ptr == (char *) result + size);
+	PG_RETURN_BYTEA_P(result);
+}
+
+
+/*
+ * Rebuilds the state of the $push aggregate from its serialized form.
+ */
+Datum
+bson_array_agg_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *serialized = PG_GETARG_BYTEA_PP(0);
+	const char *ptr = VARDATA_ANY(serialized);
+
+	MaxAlignedVarlena *bytes = AllocateMaxAlignedVarlena(sizeof(BsonArrayAggState));
+	BsonArrayAggState *state = (BsonArrayAggState *) bytes->state;
+	state->isWindowAggregation = false;
+	state->aggregateList = NIL;
+
+	memcpy(&state->currentSizeWritten, ptr, sizeof(int32));
+	ptr += sizeof(int32);
+	memcpy(&state->handleSingleValueElement, ptr, sizeof(bool));
+	ptr += sizeof(bool);
+
+	uint32 pathLength;
+	memcpy(&pathLength, ptr, sizeof(uint32));
+	ptr += sizeof(uint32);
+	state->path = pnstrdup(ptr, pathLength);
+	ptr += pathLength;
+
+	uint32 count;
+	memcpy(&count, ptr, sizeof(uint32));
+	ptr += sizeof(uint32);
+
+	for (uint32 i = 0; i < count; i++)
+	{
+		uint32 valueLength;
+		memcpy(&valueLength, ptr, sizeof(uint32));
+		ptr += sizeof(uint32);
+
+		pgbson *value = NULL;
+		if (valueLength > 0)
+		{
+			value = PgbsonInitFromBuffer(ptr, valueLength);
+			ptr += valueLength;
+		}
+
+		state->aggregateList = lappend(state->aggregateList, value);
+	}
+
+	PG_RETURN_POINTER(bytes);
+}
+
+
+/*
+ * Combines two partial states of the $push aggregate by appending the
+ * values of the second state to the first one.
+ */
+Datum
+bson_array_agg_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggregateContext;
+	if (!AggCheckCallContext(fcinfo, &aggregateContext))
+	{
+		ereport(ERROR, errmsg(
+					"Aggregate function invoked in non-aggregate context"));
+	}
+
+	if (PG_ARGISNULL(1))
+	{
+		if (PG_ARGISNULL(0))
+		{
+			PG_RETURN_NULL();
+		}
+
+		PG_RETURN_DATUM(PG_GETARG_DATUM(0));
+	}
+
+	MaxAlignedVarlena *rightBytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(1);
+	BsonArrayAggState *rightState = (BsonArrayAggState *) rightBytes->state;
+
+	MemoryContext oldContext = MemoryContextSwitchTo(aggregateContext);
+
+	MaxAlignedVarlena *leftBytes;
+	BsonArrayAggState *leftState;
+	if (PG_ARGISNULL(0))
+	{
+		leftBytes = AllocateMaxAlignedVarlena(sizeof(BsonArrayAggState));
+		leftState = (BsonArrayAggState *) leftBytes->state;
+		leftState->isWindowAggregation = false;
+		leftState->currentSizeWritten = 0;
+		leftState->aggregateList = NIL;
+		leftState->handleSingleValueElement = rightState->handleSingleValueElement;
+		leftState->path = pstrdup(rightState->path);
+	}
+	else
+	{
+		leftBytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(0);
+		leftState = (BsonArrayAggState *) leftBytes->state;
+	}
+
+	CheckAggregateIntermediateResultSize(leftState->currentSizeWritten +
+										 rightState->currentSizeWritten);
+
+	ListCell *cell;
+	foreach(cell, rightState->aggregateList)
+	{
+		pgbson *value = lfirst(cell);
+		leftState->aggregateList = lappend(leftState->aggregateList,
+										   value == NULL ? NULL :
+										   CopyPgbsonIntoMemoryContext(value,
+																	   aggregateContext));
+	}
+
+	leftState->currentSizeWritten += rightState->currentSizeWritten;
+
+	MemoryContextSwitchTo(oldContext);
+	PG_RETURN_POINTER(leftBytes);
+}
+
+
+/*
+ * Serializes the state of the $addToSet aggregate as
+ * | currentSizeWritten | bson of { "": [ values ] } |
+ */
+Datum
+bson_add_to_set_serialize(PG_FUNCTION_ARGS)
+{
+	MaxAlignedVarlena *bytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(0);
+	BsonAddToSetState *state = (BsonAddToSetState *) bytes->state;
+
+	HASH_SEQ_STATUS seq_status;
+	const bson_value_t *entry;
+	hash_seq_init(&seq_status, state->set);
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+
+	pgbson_array_writer arrayWriter;
+	PgbsonWriterStartArray(&writer, "", 0, &arrayWriter);
+	while ((entry = hash_seq_search(&seq_status)) != NULL)
+	{
+		PgbsonArrayWriterWriteValue(&arrayWriter, entry);
+	}
+	PgbsonWriterEndArray(&writer, &arrayWriter);
+
+	pgbson *values = PgbsonWriterGetPgbson(&writer);
+	uint32 valuesLength = PgbsonGetBsonSize(values);
+
+	Size size = VARHDRSZ + sizeof(int64_t) + valuesLength;
+	bytea *result = palloc(size);
+	SET_VARSIZE(result, size);
+	char *ptr = VARDATA(result);
+
+	memcpy(ptr, &state->currentSizeWritten, sizeof(int64_t));
+	ptr += sizeof(int64_t);
+	memcpy(ptr, VARDATA_ANY(values), valuesLength);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+
+/*
+ * Rebuilds the state of the $addToSet aggregate from its serialized form.
+ */
+Datum
+bson_add_to_set_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *serialized = PG_GETARG_BYTEA_PP(0);
+	const char *ptr = VARDATA_ANY(serialized);
+
+	MaxAlignedVarlena *bytes = AllocateMaxAlignedVarlena(sizeof(BsonAddToSetState));
+	BsonAddToSetState *state = (BsonAddToSetState *) bytes->state;
+	state->isWindowAggregation = false;
+	state->set = CreateBsonValueHashSet();
+
+	memcpy(&state->currentSizeWritten, ptr, sizeof(int64_t));
+	ptr += sizeof(int64_t);
+
+	/* The entries of the set point into the values document */
+	pgbson *values = PgbsonInitFromBuffer(ptr, VARSIZE_ANY_EXHDR(serialized) -
+										  sizeof(int64_t));
+	pgbsonelement valuesElement;
+	PgbsonToSinglePgbsonElement(values, &valuesElement);
+
+	bson_iter_t arrayIter;
+	BsonValueInitIterator(&valuesElement.bsonValue, &arrayIter);
+	while (bson_iter_next(&arrayIter))
+	{
+		bool found = false;
+		hash_search(state->set, bson_iter_value(&arrayIter), HASH_ENTER, &found);
+	}
+
+	PG_RETURN_POINTER(bytes);
+}
+
+
+/*
+ * Combines two partial states of the $addToSet aggregate by adding the
+ * values of the second set that are missing from the first one.
+ */
+Datum
+bson_add_to_set_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggregateContext;
+	if (!AggCheckCallContext(fcinfo, &aggregateContext))
+	{
+		ereport(ERROR, errmsg(
+					"Aggregate function invoked in non-aggregate context"));
+	}
+
+	if (PG_ARGISNULL(1))
+	{
+		if (PG_ARGISNULL(0))
+		{
+			PG_RETURN_NULL();
+		}
+
+		PG_RETURN_DATUM(PG_GETARG_DATUM(0));
+	}
+
+	MaxAlignedVarlena *rightBytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(1);
+	BsonAddToSetState *rightState = (BsonAddToSetState *) rightBytes->state;
+
+	MemoryContext oldContext = MemoryContextSwitchTo(aggregateContext);
+
+	MaxAlignedVarlena *leftBytes;
+	BsonAddToSetState *leftState;
+	if (PG_ARGISNULL(0))
+	{
+		leftBytes = AllocateMaxAlignedVarlena(sizeof(BsonAddToSetState));
+		leftState = (BsonAddToSetState *) leftBytes->state;
+		leftState->isWindowAggregation = false;
+		leftState->currentSizeWritten = 0;
+		leftState->set = CreateBsonValueHashSet();
+	}
+	else
+	{
+		leftBytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(0);
+		leftState = (BsonAddToSetState *) leftBytes->state;
+	}
+
+	HASH_SEQ_STATUS seq_status;
+	const bson_value_t *entry;
+	hash_seq_init(&seq_status, rightState->set);
+	while ((entry = hash_seq_search(&seq_status)) != NULL)
+	{
+		bool found = false;
+		hash_search(leftState->set, entry, HASH_FIND, &found);
+		if (found)
+		{
+			continue;
+		}
+
+		/*
+		 * Copy the value into the aggregate context, the size is accounted
+		 * the same way as in the transition function.
+		 */
+		pgbson *currentValue = BsonValueToDocumentPgbson(entry);
+		CheckAggregateIntermediateResultSize(leftState->currentSizeWritten +
+											 PgbsonGetBsonSize(currentValue));
+
+		pgbsonelement singleBsonElement;
+		PgbsonToSinglePgbsonElement(currentValue, &singleBsonElement);
+		hash_search(leftState->set, &singleBsonElement.bsonValue, HASH_ENTER, &found);
+		leftState->currentSizeWritten += PgbsonGetBsonSize(currentValue);
+	}
+
+	MemoryContextSwitchTo(oldContext);
+	PG_RETURN_POINTER(leftBytes);
+}
+
+
+/*
+ * Serializes the state of the $mergeObjects aggregate (without a sort spec) as
+ * | currentSizeWritten | addEmptyPath | bson of the merged document |
+ */
+Datum
+bson_object_agg_serialize(PG_FUNCTION_ARGS)
+{
+	MaxAlignedVarlena *bytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(0);
+	BsonObjectAggState *state = (BsonObjectAggState *) bytes->state;
+
+	pgbson *document = WriteObjectAggTreeToPgbson(state);
+	uint32 documentLength = PgbsonGetBsonSize(document);
+
+	Size size = VARHDRSZ + sizeof(int64_t) + sizeof(bool) + documentLength;
+	bytea *result = palloc(size);
+	SET_VARSIZE(result, size);
+	char *ptr = VARDATA(result);
+
+	memcpy(ptr, &state->currentSizeWritten, sizeof(int64_t));
+	ptr += sizeof(int64_t);
+	memcpy(ptr, &state->addEmptyPath, sizeof(bool));
+	ptr += sizeof(bool);
+	memcpy(ptr, VARDATA_ANY(document), documentLength);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+
+/*
+ * Rebuilds the state of the $mergeObjects aggregate from its serialized form.
+ */
+Datum
+bson_object_agg_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *serialized = PG_GETARG_BYTEA_PP(0);
+	const char *ptr = VARDATA_ANY(serialized);
+
+	MaxAlignedVarlena *bytes = AllocateMaxAlignedVarlena(sizeof(BsonObjectAggState));
+	BsonObjectAggState *state = (BsonObjectAggState *) bytes->state;
+	InitializeObjectAggState(state, CurrentMemoryContext);
+
+	memcpy(&state->currentSizeWritten, ptr, sizeof(int64_t));
+	ptr += sizeof(int64_t);
+	memcpy(&state->addEmptyPath, ptr, sizeof(bool));
+	ptr += sizeof(bool);
+
+	/* The nodes of the tree point into the document */
+	MemoryContext oldContext = MemoryContextSwitchTo(state->treeContext);
+	pgbson *document = PgbsonInitFromBuffer(ptr, VARSIZE_ANY_EXHDR(serialized) -
+											sizeof(int64_t) - sizeof(bool));
+	bson_iter_t docIter;
+	PgbsonInitIterator(document, &docIter);
+	AddFieldsToObjectAggTree(state, &docIter);
+	MemoryContextSwitchTo(oldContext);
+
+	PG_RETURN_POINTER(bytes);
+}
+
+
+/*
+ * Combines two partial states of the $mergeObjects aggregate by merging the
+ * document of the second state into the first one. Only used when there is
+ * no sort spec, so the order of the partial states doesn't matter.
+ */
+Datum
+bson_object_agg_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggregateContext;
+	if (!AggCheckCallContext(fcinfo, &aggregateContext))
+	{
+		ereport(ERROR, errmsg(
+					"Aggregate function invoked in non-aggregate context"));
+	}
+
+	if (PG_ARGISNULL(1))
+	{
+		if (PG_ARGISNULL(0))
+		{
+			PG_RETURN_NULL();
+		}
+
+		PG_RETURN_DATUM(PG_GETARG_DATUM(0));
+	}
+
+	MaxAlignedVarlena *rightBytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(1);
+	BsonObjectAggState *rightState = (BsonObjectAggState *) rightBytes->state;
+
+	MemoryContext oldContext = MemoryContextSwitchTo(aggregateContext);
+
+	MaxAlignedVarlena *leftBytes;
+	BsonObjectAggState *leftState;
+	if (PG_ARGISNULL(0))
+	{
+		leftBytes = AllocateMaxAlignedVarlena(sizeof(BsonObjectAggState));
+		leftState = (BsonObjectAggState *) leftBytes->state;
+		InitializeObjectAggState(leftState, aggregateContext);
+	}
+	else
+	{
+		leftBytes = (MaxAlignedVarlena *) PG_GETARG_POINTER(0);
+		leftState = (BsonObjectAggState *) leftBytes->state;
+	}
+
+	CheckAggregateIntermediateResultSize(leftState->currentSizeWritten +
+										 rightState->currentSizeWritten);
+
+	/* Written in the tree context since the left tree points into it */
+	MemoryContextSwitchTo(leftState->treeContext);
+	pgbson *rightDocument = WriteObjectAggTreeToPgbson(rightState);
+	bson_iter_t docIter;
+	PgbsonInitIterator(rightDocument, &docIter);
+	AddFieldsToObjectAggTree(leftState, &docIter);
+	MemoryContextSwitchTo(aggregateContext);
+
+	leftState->currentSizeWritten += rightState->currentSizeWritten;
+	leftState->addEmptyPath = leftState->addEmptyPath || rightState->addEmptyPath;
+
+	MemoryContextSwitchTo(oldContext);
+	PG_RETURN_POINTER(leftBytes);
+}
+
+
 /* --------------------------------------------------------- */
 /* Private helper methods */
 /* --------------------------------------------------------- */
@@ -1284,6 +1764,28 @@ CheckAggregateIntermediateResultSize(uint32_t size)
 }
 
 
+/*
+ * Initializes an empty object aggregation state whose tree lives in a new
+ * child context of the given memory context. The tree is merged into in place
+ * by every transition and is released by deleting the context rather than
+ * walking its nodes.
+ */
+static void
+InitializeObjectAggState(BsonObjectAggState *state, MemoryContext parentContext)
+{
+	state->treeContext = AllocSetContextCreate(parentContext,
+											   "Object aggregation tree",
+											   ALLOCSET_DEFAULT_SIZES);
+
+	MemoryContext oldContext = MemoryContextSwitchTo(state->treeContext);
+	state->tree = MakeRootNode();
+	MemoryContextSwitchTo(oldContext);
+
+	state->currentSizeWritten = 0;
+	state->addEmptyPath = false;
+}
+
+
 /*
  * Helper method that iterates a pgbson writing its values to a bson tree. If a key already
  * exists in the tree, then it's overwritten.
@@ -1293,8 +1795,6 @@ CreateObjectAggTreeNodes(BsonObjectAggState *currentState, pgbson *currentValue)
 {
 	bson_iter_t docIter;
 	pgbsonelement singleBsonElement;
-	bool treatLeafDataAsConstant = true;
-	ParseAggregationExpressionContext parseContext = { 0 };
 
 	/*
 	 * If currentValue has the form of { "": value } and value is a bson document,
@@ -1313,10 +1813,24 @@ CreateObjectAggTreeNodes(BsonObjectAggState *currentState, pgbson *currentValue)
 		PgbsonInitIterator(currentValue, &docIter);
 	}
 
-	while (bson_iter_next(&docIter))
+	AddFieldsToObjectAggTree(currentState, &docIter);
+}
+
+
+/*
+ * Writes the fields of the document being iterated to the bson tree of the
+ * object aggregation, overwriting the fields that already exist.
+ */
+static void
+AddFieldsToObjectAggTree(BsonObjectAggState *currentState, bson_iter_t *docIter)
+{
+	bool treatLeafDataAsConstant = true;
+	ParseAggregationExpressionContext parseContext = { 0 };
+
+	while (bson_iter_next(docIter))
 	{
-		StringView pathView = bson_iter_key_string_view(&docIter);
-		const bson_value_t *docValue = bson_iter_value(&docIter);
+		StringView pathView = bson_iter_key_string_view(docIter);
+		const bson_value_t *docValue = bson_iter_value(docIter);
 
 		bool nodeCreated = false;
 		const BsonLeafPathNode *treeNode = TraverseDottedPathAndGetOrAddLeafFieldNode(
@@ -1374,6 +1888,20 @@ ValidateMergeObjectsInput(pgbson *input)
 }
 
 
+/*
+ * Writes the fields of the object aggregation tree to a new pgbson
+ * without freeing the tree.
+ */
+static pgbson *
+WriteObjectAggTreeToPgbson(BsonObjectAggState *state)
+{
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	TraverseTreeAndWrite(state->tree, &writer, NULL);
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
 /*
  * Function used to parse and return a mergeObjects tree.
  */
@@ -1403,7 +1931,11 @@ ParseAndReturnMergeObjectsTree(BsonObjectAggState *state)
 
 
 		pgbson *result = PgbsonWriterGetPgbson(&writer);
-		FreeTree(state->tree);
+
+		/* Releases the tree along with the documents it points into */
+		MemoryContextDelete(state->treeContext);
+		state->tree = NULL;
+		state->treeContext = NULL;
 
 		PG_RETURN_POINTER(result);
 	}
@@ -15,6 +15,7 @@
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <utils/lsyscache.h>
+#include <utils/fmgroids.h>
 
 #include <catalog/pg_operator.h>
 #include <optimizer/planner.h>
@@ -35,6 +36,7 @@
 #include <utils/version_utils.h>
 
 #include "io/bson_core.h"
+#include "metadata/collection.h"
 #include "metadata/metadata_cache.h"
 #include "query/query_operator.h"
 #include "planner/documentdb_planner.h"
@@ -57,8 +59,15 @@ const int MaximumLookupPipelineDepth = 20;
 extern bool EnableLookupIdJoinOptimizationOnCollation;
 extern bool EnableNowSystemVariable;
 extern bool EnableLookupInnerJoin;
+extern bool EnableLookupHashJoin;
+extern bool EnableNativeGraphLookup;
+extern bool EnableColocatedLookupPushdown;
 extern bool EnableOperatorVariablesInLookup;
 extern bool EnableUseForeignKeyLookupInline;
+extern bool EnableRankFusionStage;
+
+/* The k of the reciprocal rank fusion score weight / (k + rank) of a document */
+#define RANK_FUSION_RANK_CONSTANT 60.0
 
 /*
  * Struct having parsed view of the
@@ -174,6 +183,12 @@ typedef struct LookupOptimizationArgs
 	 * The attrNum for the lookup let in left query
 	 */
 	AttrNumber lookupLetAttrNum;
+
+	/*
+	 * Can the join also be done on the shard_key_value (both collections
+	 * are sharded on the join field)?
+	 */
+	bool isLookupJoinOnShardKey;
 } LookupOptimizationArgs;
 
 
@@ -273,10 +288,29 @@ static Query * ProcessLookupCoreWithLet(Query *query,
 										AggregationPipelineBuildContext *context,
 										LookupArgs *lookupArgs,
 										LookupContext *lookupContext);
+static bool CanUseLookupHashJoin(LookupArgs *lookupArgs,
+								 AggregationPipelineBuildContext *context,
+								 LookupContext *lookupContext,
+								 LookupOptimizationArgs *optimizationArgs);
+static Query * ProcessLookupCoreWithHashJoin(Query *query,
+											 AggregationPipelineBuildContext *context,
+											 LookupArgs *lookupArgs,
+											 LookupOptimizationArgs *optimizationArgs);
+static void AddRowNumberTargetEntry(Query *query, AttrNumber resno, const char *name,
+									List *orderClause);
 static void ValidatePipelineForShardedLookupWithLet(const bson_value_t *pipeline);
+static bool IsShardKeyOnSingleField(pgbson *shardKey, const StringView *field);
+static bool IsUnprojectedBaseTableQuery(Query *query);
 static Query * ProcessGraphLookupCore(Query *query,
 									  AggregationPipelineBuildContext *context,
 									  GraphLookupArgs *lookupArgs);
+static bool CanUseNativeGraphLookup(AggregationPipelineBuildContext *context,
+									GraphLookupArgs *args);
+static Query * ProcessNativeGraphLookup(Query *query,
+										AggregationPipelineBuildContext *context,
+										GraphLookupArgs *lookupArgs);
+static Query * GenerateBaseCaseQuery(AggregationPipelineBuildContext *parentContext,
+									 GraphLookupArgs *args, int baseCteLevelsUp);
 static Query * BuildGraphLookupCteQuery(QuerySource parentSource,
 										CommonTableExpr *baseCteExpr,
 										GraphLookupArgs *args,
@@ -287,6 +321,14 @@ static Query * BuildRecursiveGraphLookupQuery(QuerySource parentSource,
 											  parentContext,
 											  CommonTableExpr *baseCteExpr, int levelsUp);
 static void ValidateUnionWithPipeline(const bson_value_t *pipeline, bool hasCollection);
+static void ValidateRankFusionPipeline(const char *pipelineName,
+									   const bson_value_t *pipeline);
+static double GetRankFusionPipelineWeight(const bson_value_t *weights,
+										  const char *pipelineName);
+static Query * BuildRankFusionPipelineQuery(const bson_value_t *pipeline,
+											double weight, int pipelineIndex,
+											AggregationPipelineBuildContext *context);
+static Expr * CreateIdProjectionExpr(Expr *baseExpr);
 
 static void ValidateVariableIsDefined(AggregationExpressionData *parsedData,
 									  HTAB *operatorVariables);
@@ -1057,6 +1099,7 @@ HandleUnionWith(const bson_value_t *existingValue, Query *query,
 				AggregationPipelineBuildContext *context)
 {
 	ReportFeatureUsage(FEATURE_STAGE_UNIONWITH);
+	context->hasUnionWith = true;
 
 	if (context->nestedPipelineLevel >= MaximumLookupPipelineDepth)
 	{
@@ -1173,6 +1216,526 @@ HandleUnionWith(const bson_value_t *existingValue, Query *query,
 }
 
 
+/*
+ * Handles the $rankFusion stage: runs the named input pipelines against the
+ * collection and fuses their ranked results with reciprocal rank fusion.
+ *   { "$rankFusion": {
+ *       "input": { "pipelines": { "vector": [ { "$vectorSearch": ... } ],
+ *                                 "text": [ { "$match": { "$text": ... } }, { "$sort": ... } ] } },
+ *       "combination": { "weights": { "text": 0.5 } } } }
+ * A document at rank r (1 based) of a pipeline of weight w (1 by default) scores
+ * w / (60 + r), and the documents are returned by the sum of their scores:
+ *
+ * SELECT bsonmax(document) FROM (
+ *      SELECT document, bson_expression_get(document, '{ "_id": "$_id" }') AS fusion_id,
+ *          w1 / (60 + row_number() OVER (ORDER BY <sort 1>)) AS fusion_score
+ *          FROM (<pipeline 1>)
+ *      UNION ALL
+ *      SELECT ... FROM (<pipeline 2>)) fusion
+ * GROUP BY fusion_id ORDER BY sum(fusion_score) DESC, fusion_id
+ *
+ * The pipelines run in a single query against their own indexes and their
+ * candidates are fused by a single aggregation, without building BSON arrays of
+ * them. The input pipelines only select and rank documents, so the document of
+ * any of them can be returned for an _id.
+ */
+Query *
+HandleRankFusion(const bson_value_t *existingValue, Query *query,
+				 AggregationPipelineBuildContext *context)
+{
+	if (!EnableRankFusionStage)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_COMMANDNOTSUPPORTED),
+						errmsg("Stage $rankFusion is not supported yet in native pipeline"),
+						errdetail_log(
+							"Stage $rankFusion is not supported yet in native pipeline")));
+	}
+
+	ReportFeatureUsage(FEATURE_STAGE_RANK_FUSION);
+
+	RangeTblEntry *rte = linitial(query->rtable);
+	if (rte->rtekind != RTE_RELATION || rte->tablesample != NULL ||
+		query->limitCount != NULL || context->stageNum != 0)
+	{
+		/* The input pipelines need the base relation */
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"$rankFusion must appear as the initial stage in the pipeline sequence.")));
+	}
+
+	if (context->nestedPipelineLevel >= MaximumLookupPipelineDepth)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_MAXSUBPIPELINEDEPTHEXCEEDED),
+						errmsg(
+							"The allowed limit for nested sub-pipelines has been surpassed, exceeding the maximum of %d.",
+							MaximumLookupPipelineDepth)));
+	}
+
+	EnsureTopLevelFieldValueType("$rankFusion", existingValue, BSON_TYPE_DOCUMENT);
+
+	bson_value_t pipelines = { 0 };
+	bson_value_t weights = { 0 };
+
+	bson_iter_t specIter;
+	BsonValueInitIterator(existingValue, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		const char *key = bson_iter_key(&specIter);
+		const bson_value_t *value = bson_iter_value(&specIter);
+		if (strcmp(key, "input") == 0)
+		{
+			EnsureTopLevelFieldValueType("$rankFusion.input", value, BSON_TYPE_DOCUMENT);
+
+			bson_iter_t inputIter;
+			BsonValueInitIterator(value, &inputIter);
+			while (bson_iter_next(&inputIter))
+			{
+				if (strcmp(bson_iter_key(&inputIter), "pipelines") != 0)
+				{
+					ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+									errmsg("Unrecognized $rankFusion.input option: %s",
+										   bson_iter_key(&inputIter))));
+				}
+
+				pipelines = *bson_iter_value(&inputIter);
+				EnsureTopLevelFieldValueType("$rankFusion.input.pipelines", &pipelines,
+											 BSON_TYPE_DOCUMENT);
+			}
+		}
+		else if (strcmp(key, "combination") == 0)
+		{
+			EnsureTopLevelFieldValueType("$rankFusion.combination", value,
+										 BSON_TYPE_DOCUMENT);
+
+			bson_iter_t combinationIter;
+			BsonValueInitIterator(value, &combinationIter);
+			while (bson_iter_next(&combinationIter))
+			{
+				if (strcmp(bson_iter_key(&combinationIter), "weights") != 0)
+				{
+					ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+									errmsg(
+										"Unrecognized $rankFusion.combination option: %s",
+										bson_iter_key(&combinationIter))));
+				}
+
+				weights = *bson_iter_value(&combinationIter);
+				EnsureTopLevelFieldValueType("$rankFusion.combination.weights", &weights,
+											 BSON_TYPE_DOCUMENT);
+			}
+		}
+		else if (strcmp(key, "scoreDetails") == 0)
+		{
+			if (BsonValueAsBool(value))
+			{
+				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_COMMANDNOTSUPPORTED),
+								errmsg("$rankFusion does not support scoreDetails yet.")));
+			}
+		}
+		else
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+							errmsg("Unrecognized $rankFusion option: %s", key)));
+		}
+	}
+
+	if (pipelines.value_type == BSON_TYPE_EOD || IsBsonValueEmptyDocument(&pipelines))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+						errmsg(
+							"$rankFusion requires at least one pipeline in input.pipelines.")));
+	}
+
+	if (weights.value_type != BSON_TYPE_EOD)
+	{
+		/* Every weight must be of an input pipeline */
+		bson_iter_t weightsIter;
+		BsonValueInitIterator(&weights, &weightsIter);
+		while (bson_iter_next(&weightsIter))
+		{
+			bson_iter_t pipelineIter;
+			BsonValueInitIterator(&pipelines, &pipelineIter);
+			if (!bson_iter_find_w_len(&pipelineIter, bson_iter_key(&weightsIter),
+									  bson_iter_key_len(&weightsIter)))
+			{
+				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+								errmsg(
+									"$rankFusion.combination.weights has a weight for the unknown pipeline %s.",
+									bson_iter_key(&weightsIter))));
+			}
+		}
+	}
+
+	/* The (document, fusion_id, fusion_score) of each ranked pipeline */
+	Query *unionQuery = makeNode(Query);
+	unionQuery->commandType = CMD_SELECT;
+	unionQuery->querySource = query->querySource;
+	unionQuery->canSetTag = true;
+	unionQuery->jointree = makeNode(FromExpr);
+
+	List *rangeTableReferences = NIL;
+	Query *firstPipelineQuery = NULL;
+
+	bson_iter_t pipelinesIter;
+	BsonValueInitIterator(&pipelines, &pipelinesIter);
+	int pipelineIndex = 0;
+	while (bson_iter_next(&pipelinesIter))
+	{
+		const char *pipelineName = bson_iter_key(&pipelinesIter);
+		const bson_value_t *pipeline = bson_iter_value(&pipelinesIter);
+		ValidateRankFusionPipeline(pipelineName, pipeline);
+
+		double weight = GetRankFusionPipelineWeight(&weights, pipelineName);
+		Query *pipelineQuery = BuildRankFusionPipelineQuery(pipeline, weight,
+															pipelineIndex, context);
+
+		bool includeAllColumns = true;
+		RangeTblEntry *pipelineRte = MakeSubQueryRte(pipelineQuery, pipelineIndex,
+													 context->nestedPipelineLevel,
+													 "rankFusionInput",
+													 includeAllColumns);
+		unionQuery->rtable = lappend(unionQuery->rtable, pipelineRte);
+
+		RangeTblRef *pipelineReference = makeNode(RangeTblRef);
+		pipelineReference->rtindex = list_length(unionQuery->rtable);
+		rangeTableReferences = lappend(rangeTableReferences, pipelineReference);
+
+		if (firstPipelineQuery == NULL)
+		{
+			firstPipelineQuery = pipelineQuery;
+		}
+
+		pipelineIndex++;
+	}
+
+	Node *setOperations = linitial(rangeTableReferences);
+	for (int i = 1; i < list_length(rangeTableReferences); i++)
+	{
+		SetOperationStmt *setOpStatement = makeNode(SetOperationStmt);
+		setOpStatement->all = true;
+		setOpStatement->op = SETOP_UNION;
+		setOpStatement->colCollations = list_make3_oid(InvalidOid, InvalidOid,
+													   InvalidOid);
+		setOpStatement->colTypes = list_make3_oid(BsonTypeId(), BsonTypeId(),
+												  FLOAT8OID);
+		setOpStatement->colTypmods = list_make3_int(-1, -1, -1);
+		setOpStatement->larg = setOperations;
+		setOpStatement->rarg = list_nth(rangeTableReferences, i);
+		setOperations = (Node *) setOpStatement;
+	}
+
+	if (IsA(setOperations, RangeTblRef))
+	{
+		/* A single pipeline, just select from its query */
+		unionQuery->jointree->fromlist = list_make1(setOperations);
+	}
+	else
+	{
+		unionQuery->setOperations = setOperations;
+	}
+
+	List *unionTargetList = NIL;
+	ListCell *cell;
+	foreach(cell, firstPipelineQuery->targetList)
+	{
+		TargetEntry *entry = lfirst(cell);
+		Var *entryVar = makeVar(1, entry->resno, exprType((Node *) entry->expr), -1,
+								InvalidOid, 0);
+		unionTargetList = lappend(unionTargetList,
+								  makeTargetEntry((Expr *) entryVar, entry->resno,
+												  entry->resname, false));
+	}
+
+	unionQuery->targetList = unionTargetList;
+
+	/* Sum the scores of each document over the pipelines */
+	bool includeAllColumns = true;
+	Query *fusionQuery = makeNode(Query);
+	fusionQuery->commandType = CMD_SELECT;
+	fusionQuery->querySource = query->querySource;
+	fusionQuery->canSetTag = true;
+	fusionQuery->rtable = list_make1(MakeSubQueryRte(unionQuery, context->stageNum,
+													 context->nestedPipelineLevel,
+													 "rankFusion",
+													 includeAllColumns));
+
+	RangeTblRef *unionReference = makeNode(RangeTblRef);
+	unionReference->rtindex = 1;
+	fusionQuery->jointree = makeFromExpr(list_make1(unionReference), NULL);
+
+	TargetEntry *documentEntry = linitial(unionTargetList);
+	Var *documentVar = makeVar(1, 1, BsonTypeId(), -1, InvalidOid, 0);
+	Var *fusionIdVar = makeVar(1, 2, BsonTypeId(), -1, InvalidOid, 0);
+	Var *fusionScoreVar = makeVar(1, 3, FLOAT8OID, -1, InvalidOid, 0);
+
+	ParseState *parseState = make_parsestate(NULL);
+	parseState->p_expr_kind = EXPR_KIND_SELECT_TARGET;
+	parseState->p_next_resno = 1;
+
+	Aggref *documentAggref = CreateMultiArgAggregate(BsonMaxAggregateFunctionOid(),
+													 list_make1(documentVar),
+													 list_make1_oid(BsonTypeId()),
+													 parseState);
+	Aggref *scoreAggref = CreateMultiArgAggregate(F_SUM_FLOAT8,
+												  list_make1(fusionScoreVar),
+												  list_make1_oid(FLOAT8OID),
+												  parseState);
+	scoreAggref->aggtype = FLOAT8OID;
+	fusionQuery->hasAggs = true;
+
+	/* Only the document is returned */
+	bool resjunk = true;
+	TargetEntry *fusionIdEntry = makeTargetEntry((Expr *) fusionIdVar, 2,
+												 "fusion_id", resjunk);
+	TargetEntry *fusionScoreEntry = makeTargetEntry((Expr *) scoreAggref, 3,
+													"fusion_score", resjunk);
+	fusionQuery->targetList = list_make3(
+		makeTargetEntry((Expr *) documentAggref, 1, documentEntry->resname, false),
+		fusionIdEntry, fusionScoreEntry);
+
+	SortGroupClause *groupClause = makeNode(SortGroupClause);
+	groupClause->tleSortGroupRef = assignSortGroupRef(fusionIdEntry,
+													  fusionQuery->targetList);
+	groupClause->eqop = BsonEqualOperatorId();
+	groupClause->sortop = BsonLessThanOperatorId();
+	groupClause->nulls_first = false;
+	groupClause->hashable = true;
+	fusionQuery->groupClause = list_make1(groupClause);
+
+	parseState->p_expr_kind = EXPR_KIND_ORDER_BY;
+	parseState->p_next_resno = 4;
+
+	SortBy *sortBy = makeNode(SortBy);
+	sortBy->location = -1;
+	sortBy->sortby_dir = SORTBY_DESC;
+	sortBy->sortby_nulls = SORTBY_NULLS_DEFAULT;
+	sortBy->node = (Node *) scoreAggref;
+	fusionQuery->sortClause = addTargetToSortList(parseState, fusionScoreEntry, NIL,
+												  fusionQuery->targetList, sortBy);
+	pfree(parseState);
+
+	/* Documents with the same score are returned by their _id */
+	SortGroupClause *idSortClause = copyObject(groupClause);
+	fusionQuery->sortClause = lappend(fusionQuery->sortClause, idSortClause);
+
+	/* Push next stage to a new subquery (since we did a sort) */
+	context->requiresSubQueryAfterProject = true;
+	return fusionQuery;
+}
+
+
+/*
+ * Validates that an input pipeline of $rankFusion only selects and ranks the
+ * documents of the collection.
+ */
+static void
+ValidateRankFusionPipeline(const char *pipelineName, const bson_value_t *pipeline)
+{
+	if (*pipelineName == '\0' || *pipelineName == '$' || strchr(pipelineName, '.') != NULL)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"$rankFusion pipeline names must be non-empty, not start with '$' and not contain '.', found: '%s'",
+							pipelineName)));
+	}
+
+	EnsureTopLevelFieldValueType("$rankFusion.input.pipelines", pipeline,
+								 BSON_TYPE_ARRAY);
+
+	bool isRanked = false;
+	bson_iter_t pipelineIter;
+	BsonValueInitIterator(pipeline, &pipelineIter);
+	while (bson_iter_next(&pipelineIter))
+	{
+		pgbsonelement stageElement = GetPipelineStage(&pipelineIter, "rankFusion",
+													  pipelineName);
+		const char *stageName = stageElement.path;
+		if (strcmp(stageName, "$vectorSearch") == 0 ||
+			strcmp(stageName, "$search") == 0 ||
+			strcmp(stageName, "$sort") == 0)
+		{
+			isRanked = true;
+		}
+		else if (strcmp(stageName, "$match") != 0 &&
+				 strcmp(stageName, "$limit") != 0 &&
+				 strcmp(stageName, "$skip") != 0)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+							errmsg(
+								"%s cannot be used in the $rankFusion pipeline %s, only $vectorSearch, $search, $match, $sort, $limit and $skip are allowed.",
+								stageName, pipelineName)));
+		}
+	}
+
+	if (!isRanked)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"The $rankFusion pipeline %s must rank its results with $vectorSearch, $search or $sort.",
+							pipelineName)));
+	}
+}
+
+
+/*
+ * Returns the weight of the named $rankFusion input pipeline, 1 if it has none.
+ */
+static double
+GetRankFusionPipelineWeight(const bson_value_t *weights, const char *pipelineName)
+{
+	if (weights->value_type == BSON_TYPE_EOD)
+	{
+		return 1.0;
+	}
+
+	bson_iter_t weightsIter;
+	BsonValueInitIterator(weights, &weightsIter);
+	if (!bson_iter_find(&weightsIter, pipelineName))
+	{
+		return 1.0;
+	}
+
+	const bson_value_t *weightValue = bson_iter_value(&weightsIter);
+	if (!BsonValueIsNumber(weightValue))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_TYPEMISMATCH),
+						errmsg(
+							"The $rankFusion weight of the pipeline %s must be a number, found: %s",
+							pipelineName, BsonTypeName(weightValue->value_type))));
+	}
+
+	double weight = BsonValueAsDouble(weightValue);
+	if (!(weight >= 0))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"The $rankFusion weight of the pipeline %s must be non-negative, found: %g",
+							pipelineName, weight)));
+	}
+
+	return weight;
+}
+
+
+/*
+ * Builds the query of a $rankFusion input pipeline on the collection, projecting
+ * the document with its _id and its score weight / (60 + rank). The rank is the
+ * row_number() of the document ordered by the sort of the pipeline.
+ */
+static Query *
+BuildRankFusionPipelineQuery(const bson_value_t *pipeline, double weight,
+							 int pipelineIndex, AggregationPipelineBuildContext *context)
+{
+	AggregationPipelineBuildContext subPipelineContext = { 0 };
+	subPipelineContext.nestedPipelineLevel = context->nestedPipelineLevel + 1;
+	subPipelineContext.databaseNameDatum = context->databaseNameDatum;
+	subPipelineContext.variableSpec = context->variableSpec;
+	subPipelineContext.parentStageName = ParentStageName_RANKFUSION;
+	strncpy((char *) subPipelineContext.collationString, context->collationString,
+			MAX_ICU_COLLATION_LENGTH);
+
+	pg_uuid_t *collectionUuid = NULL;
+	bson_value_t *indexHint = NULL;
+	Query *pipelineQuery = GenerateBaseTableQuery(context->databaseNameDatum,
+												  &context->collectionNameView,
+												  collectionUuid, indexHint,
+												  &subPipelineContext);
+
+	List *stages = ExtractAggregationStages(pipeline, &subPipelineContext);
+	pipelineQuery = MutateQueryWithPipeline(pipelineQuery, stages, &subPipelineContext);
+
+	/*
+	 * A sort on the outermost query of the pipeline numbers its documents in a
+	 * window ordered by it, returned after the document. The window is evaluated
+	 * before the $skip and $limit of the query, so these numbers are numbered
+	 * again from 1 above it.
+	 */
+	bool isSortedPipeline = pipelineQuery->sortClause != NIL;
+	List *sortTargetList = list_copy_tail(pipelineQuery->targetList, 1);
+	ListCell *cell;
+	foreach(cell, sortTargetList)
+	{
+		TargetEntry *entry = lfirst(cell);
+		isSortedPipeline = isSortedPipeline && entry->resjunk;
+	}
+
+	if (isSortedPipeline)
+	{
+		pipelineQuery->targetList = list_make1(linitial(pipelineQuery->targetList));
+		AddRowNumberTargetEntry(pipelineQuery, 2, "fusion_sort_row",
+								copyObject(pipelineQuery->sortClause));
+
+		AttrNumber resno = 2;
+		foreach(cell, sortTargetList)
+		{
+			TargetEntry *sortEntry = lfirst(cell);
+			sortEntry->resno = ++resno;
+		}
+
+		pipelineQuery->targetList = list_concat(pipelineQuery->targetList,
+												sortTargetList);
+		subPipelineContext.expandTargetList = true;
+	}
+
+	pipelineQuery = MigrateQueryToSubQuery(pipelineQuery, &subPipelineContext);
+
+	TargetEntry *documentEntry = linitial(pipelineQuery->targetList);
+	pipelineQuery->targetList = lappend(pipelineQuery->targetList,
+										makeTargetEntry(CreateIdProjectionExpr(
+															(Expr *) copyObject(
+																documentEntry->expr)),
+														2, "fusion_id", false));
+
+	/* Other pipelines are ranked in the order they return their documents */
+	List *rankOrderClause = NIL;
+	TargetEntry *sortRowEntry = NULL;
+	if (isSortedPipeline)
+	{
+		bool resjunk = true;
+		sortRowEntry = makeTargetEntry((Expr *) makeVar(1, 2, INT8OID, -1, InvalidOid,
+														0),
+									   4, "fusion_sort_row", resjunk);
+
+		SortGroupClause *sortRowClause = makeNode(SortGroupClause);
+		sortRowClause->tleSortGroupRef = assignSortGroupRef(sortRowEntry,
+															pipelineQuery->targetList);
+		sortRowClause->eqop = Int8EqualOperator;
+		sortRowClause->sortop = Int8LessOperator;
+		sortRowClause->nulls_first = false;
+		sortRowClause->hashable = true;
+		rankOrderClause = list_make1(sortRowClause);
+	}
+
+	AddRowNumberTargetEntry(pipelineQuery, 3, "fusion_score", rankOrderClause);
+	TargetEntry *scoreEntry = llast(pipelineQuery->targetList);
+
+	Const *rankConstant = makeConst(FLOAT8OID, -1, InvalidOid, sizeof(float8),
+									Float8GetDatum(RANK_FUSION_RANK_CONSTANT), false,
+									true);
+	Const *weightConst = makeConst(FLOAT8OID, -1, InvalidOid, sizeof(float8),
+								   Float8GetDatum(weight), false, true);
+	Expr *rankExpr = (Expr *) makeFuncExpr(F_FLOAT8_INT8, FLOAT8OID,
+										   list_make1(scoreEntry->expr), InvalidOid,
+										   InvalidOid, COERCE_EXPLICIT_CAST);
+	Expr *denominatorExpr = (Expr *) makeFuncExpr(F_FLOAT8PL, FLOAT8OID,
+												  list_make2(rankConstant, rankExpr),
+												  InvalidOid, InvalidOid,
+												  COERCE_EXPLICIT_CALL);
+	Expr *scoreExpr = (Expr *) makeFuncExpr(F_FLOAT8DIV, FLOAT8OID,
+											list_make2(weightConst, denominatorExpr),
+											InvalidOid, InvalidOid,
+											COERCE_EXPLICIT_CALL);
+	scoreEntry->expr = scoreExpr;
+
+	if (sortRowEntry != NULL)
+	{
+		pipelineQuery->targetList = lappend(pipelineQuery->targetList, sortRowEntry);
+	}
+
+	return pipelineQuery;
+}
+
+
 /*
  * Validates the facet pipeline definition.
  */
@@ -1700,11 +2263,19 @@ CreateCteSelectQuery(CommonTableExpr *baseCte, const char *prefix, int stageNum,
 	foreach(cell, baseQuery->targetList)
 	{
 		TargetEntry *tle = (TargetEntry *) lfirst(cell);
-		Var *newQueryOutput = makeVar(rtIndex, tle->resno, BsonTypeId(), -1,
-									  InvalidOid, 0);
-		TargetEntry *upperEntry = makeTargetEntry((Expr *) newQueryOutput, tle->resno,
-												  tle->resname,
-												  tle->resjunk);
+
+		/* Junk columns of the CTE can only be read by quals, they are not projected */
+		if (tle->resjunk)
+		{
+			continue;
+		}
+
+		Var *newQueryOutput = makeVar(rtIndex, tle->resno, exprType((Node *) tle->expr),
+									  exprTypmod((Node *) tle->expr),
+									  exprCollation((Node *) tle->expr), 0);
+		TargetEntry *upperEntry = makeTargetEntry((Expr *) newQueryOutput,
+												  list_length(upperTargetList) + 1,
+												  tle->resname, false);
 		upperTargetList = lappend(upperTargetList, upperEntry);
 	}
 
@@ -1723,6 +2294,50 @@ CreateCteSelectQuery(CommonTableExpr *baseCte, const char *prefix, int stageNum,
 }
 
 
+/*
+ * Returns true if the shard key is a single field and that field is the given path.
+ */
+static bool
+IsShardKeyOnSingleField(pgbson *shardKey, const StringView *field)
+{
+	if (shardKey == NULL)
+	{
+		return false;
+	}
+
+	pgbsonelement shardKeyElement;
+	if (!TryGetSinglePgbsonElementFromPgbson(shardKey, &shardKeyElement))
+	{
+		return false;
+	}
+
+	return shardKeyElement.pathLength == field->length &&
+		   strncmp(shardKeyElement.path, field->string, field->length) == 0;
+}
+
+
+/*
+ * Returns true if the query returns the stored documents of a single table
+ * as is (filters and sorts are allowed, but not projections or grouping).
+ */
+static bool
+IsUnprojectedBaseTableQuery(Query *query)
+{
+	if (list_length(query->rtable) != 1 || list_length(query->targetList) != 1 ||
+		query->groupClause != NIL || query->distinctClause != NIL ||
+		query->hasAggs || query->hasWindowFuncs || query->setOperations != NULL)
+	{
+		return false;
+	}
+
+	RangeTblEntry *entry = linitial(query->rtable);
+	TargetEntry *firstEntry = linitial(query->targetList);
+	return entry->rtekind == RTE_RELATION && IsA(firstEntry->expr, Var) &&
+		   ((Var *) firstEntry->expr)->varattno ==
+		   DOCUMENT_DATA_TABLE_DOCUMENT_VAR_ATTR_NUMBER;
+}
+
+
 /*
  * Parses the lookup aggregation value and extracts the from collection and pipeline.
  */
@@ -1959,7 +2574,7 @@ MakeLookupJoinRte(List *joinVars, List *colNames, List *joinLeftCols, List *join
 
 
 /*
- * Given a query in a specified RTE index that returns only BSON values, updates 3 lists based on the query:
+ * Given a query in a specified RTE index, updates 3 lists based on the query:
  * 1) OutputVars are going to be Var nodes that point to the (RTE, Output) position
  * 2) The names of the output columns across the query
  * 3) The integer result numbers of the Vars.
@@ -1974,8 +2589,9 @@ MakeBsonJoinVarsFromQuery(Index queryIndex, Query *query, List **outputVars,
 	{
 		TargetEntry *entry = lfirst(cell);
 
-		Var *outputVar = makeVar(queryIndex, entry->resno, BsonTypeId(), -1, InvalidOid,
-								 0);
+		Var *outputVar = makeVar(queryIndex, entry->resno, exprType((Node *) entry->expr),
+								 exprTypmod((Node *) entry->expr),
+								 exprCollation((Node *) entry->expr), 0);
 		*outputVars = lappend(*outputVars, outputVar);
 		*outputColNames = lappend(*outputColNames, makeString(entry->resname));
 		*joinCols = lappend_int(*joinCols, (int) entry->resno);
@@ -2293,6 +2909,28 @@ OptimizeLookup(LookupArgs *lookupArgs,
 		}
 	}
 
+	/*
+	 * If both collections are sharded on the join field alone, matching documents
+	 * have the same shard_key_value (shard keys can't be arrays and the hash doesn't
+	 * depend on the collection). Joining on it as well lets the distributed planner
+	 * push the join down to the shards when the collections are colocated.
+	 * This requires the join field of both sides to be the stored one, so neither
+	 * side can be projected before the join.
+	 */
+	optimizationArgs->isLookupJoinOnShardKey =
+		EnableColocatedLookupPushdown &&
+		lookupArgs->hasLookupMatch &&
+		!optimizationArgs->isLookupJoinOnRightId &&
+		!IsCollationApplicable(leftQueryContext->collationString) &&
+		leftQueryContext->mongoCollection != NULL &&
+		optimizationArgs->rightQueryContext.mongoCollection != NULL &&
+		IsShardKeyOnSingleField(leftQueryContext->mongoCollection->shardKey,
+								&lookupArgs->localField) &&
+		IsShardKeyOnSingleField(
+			optimizationArgs->rightQueryContext.mongoCollection->shardKey,
+			&lookupArgs->foreignField) &&
+		IsUnprojectedBaseTableQuery(leftQuery);
+
 	/* Last check - nested $lookup with let not supported on sharded (citus limit) */
 	if (optimizationArgs->hasLet &&
 		leftQueryContext->mongoCollection != NULL &&
@@ -2349,6 +2987,12 @@ ProcessLookupCoreWithLet(Query *query, AggregationPipelineBuildContext *context,
 	LookupOptimizationArgs optimizationArgs = { 0 };
 	OptimizeLookup(lookupArgs, leftQuery, context, &optimizationArgs);
 
+	if (CanUseLookupHashJoin(lookupArgs, context, lookupContext, &optimizationArgs))
+	{
+		return ProcessLookupCoreWithHashJoin(leftQuery, context, lookupArgs,
+											 &optimizationArgs);
+	}
+
 	/* Generate the lookup query */
 	/* Start with a fresh query */
 	Query *lookupQuery = makeNode(Query);
@@ -2418,6 +3062,35 @@ ProcessLookupCoreWithLet(Query *query, AggregationPipelineBuildContext *context,
 			rightQuery->targetList = lappend(rightQuery->targetList, objectEntry);
 		}
 
+		AttrNumber leftShardKeyAttrNum = InvalidAttrNumber;
+		AttrNumber rightShardKeyAttrNum = InvalidAttrNumber;
+		if (optimizationArgs.isLookupJoinOnShardKey &&
+			IsUnprojectedBaseTableQuery(rightQuery))
+		{
+			/*
+			 * Project the shard_key_value of both sides for the join. On the right it is
+			 * a junk column of the CTE, so it is only visible to the join qual below.
+			 */
+			Var *rightShardKeyVar = makeVar(1,
+											DOCUMENT_DATA_TABLE_SHARD_KEY_VALUE_VAR_ATTR_NUMBER,
+											INT8OID, -1, InvalidOid, 0);
+			rightShardKeyAttrNum = list_length(rightQuery->targetList) + 1;
+			rightQuery->targetList = lappend(rightQuery->targetList,
+											 makeTargetEntry((Expr *) rightShardKeyVar,
+															 rightShardKeyAttrNum,
+															 "lookup_shard_key", true));
+
+			Var *leftShardKeyVar = makeVar(1,
+										   DOCUMENT_DATA_TABLE_SHARD_KEY_VALUE_VAR_ATTR_NUMBER,
+										   INT8OID, -1, InvalidOid, 0);
+			leftShardKeyAttrNum = list_length(leftQuery->targetList) + 1;
+			leftQuery->targetList = lappend(leftQuery->targetList,
+											makeTargetEntry((Expr *) leftShardKeyVar,
+															leftShardKeyAttrNum,
+															"lookup_shard_key_value",
+															false));
+		}
+
 		CommonTableExpr *rightTableExpr = makeNode(CommonTableExpr);
 		rightTableExpr->ctename = "lookup_right_query";
 		rightTableExpr->ctequery = (Node *) rightQuery;
@@ -2543,6 +3216,20 @@ ProcessLookupCoreWithLet(Query *query, AggregationPipelineBuildContext *context,
 												 COERCE_EXPLICIT_CALL);
 			}
 
+			if (leftShardKeyAttrNum != InvalidAttrNumber)
+			{
+				/* AND lookupRight.lookup_shard_key = lookup.lookup_shard_key_value */
+				Var *rightShardKeyVar = makeVar(1, rightShardKeyAttrNum, INT8OID, -1,
+												InvalidOid, 0);
+				Var *leftShardKeyVar = makeVar(leftQueryRteIndex, leftShardKeyAttrNum,
+											   INT8OID, -1, InvalidOid, matchLevelsUp);
+				Expr *shardKeyClause = make_opclause(BigintEqualOperatorId(), BOOLOID,
+													 false, (Expr *) rightShardKeyVar,
+													 (Expr *) leftShardKeyVar,
+													 InvalidOid, InvalidOid);
+				rightQuals = lappend(rightQuals, shardKeyClause);
+			}
+
 			if (rightQuals == NIL)
 			{
 				rightQuery->jointree->quals = inClause;
@@ -2880,6 +3567,396 @@ ProcessLookupCoreWithLet(Query *query, AggregationPipelineBuildContext *context,
 }
 
 
+/*
+ * Whether the $lookup can be planned as a join on hashed join keys. This is limited
+ * to plain localField/foreignField lookups: the hash join keys are only consistent
+ * with the join filter when no collation applies, and pipelines, let and
+ * $lookup + $unwind keep using the lateral join.
+ * When the join can be done on the foreign _id the lateral join is kept as well
+ * since it can use the _id index for every local document.
+ */
+static bool
+CanUseLookupHashJoin(LookupArgs *lookupArgs, AggregationPipelineBuildContext *context,
+					 LookupContext *lookupContext,
+					 LookupOptimizationArgs *optimizationArgs)
+{
+	if (!EnableLookupHashJoin || !lookupArgs->hasLookupMatch ||
+		lookupContext->isLookupUnwind)
+	{
+		return false;
+	}
+
+	if (optimizationArgs->hasLet || optimizationArgs->isLookupAgnostic ||
+		optimizationArgs->isLookupJoinOnRightId)
+	{
+		return false;
+	}
+
+	if (lookupArgs->pipeline.value_type != BSON_TYPE_EOD ||
+		list_length(optimizationArgs->inlinedPipelineStages) > 0 ||
+		list_length(optimizationArgs->nonInlinedPipelineStages) > 0 ||
+		optimizationArgs->nonInlinedMatchStage != NULL)
+	{
+		return false;
+	}
+
+	return !IsCollationApplicable(context->collationString);
+}
+
+
+/*
+ * Builds the $lookup as a join on hashed join keys so that the planner can pick a
+ * hash join (and spill to disk past work_mem) instead of evaluating the join filter
+ * for every pair of local and foreign documents. The query generated is of the form:
+ *
+ * WITH lookupLeftCte AS (
+ *      SELECT document,
+ *          bson_dollar_lookup_extract_filter_expression(document, '{ "foreignField": "localField" }') AS lookup_filter,
+ *          row_number() OVER () AS lookup_row
+ *      FROM (<left query>))
+ * SELECT bson_dollar_merge_documents(l.document, COALESCE(m.lookup_matches, '{ "as": [] }'), true)
+ * FROM lookupLeftCte l LEFT JOIN (
+ *      SELECT lookup_row, bson_array_agg(document, 'as') AS lookup_matches
+ *      FROM (SELECT DISTINCT ON (lk.lookup_row, rk.lookup_foreign_row)
+ *              lk.lookup_row, rk.lookup_foreign_row, rk.document
+ *          FROM (SELECT lookup_row, lookup_filter, bson_dollar_lookup_filter_hashes(lookup_filter) AS lookup_hash
+ *                FROM lookupLeftCte) lk,
+ *              (SELECT document, row_number() OVER () AS lookup_foreign_row,
+ *                  bson_dollar_lookup_document_hashes(document, 'foreignField') AS lookup_hash
+ *                FROM (<right query>)) rk
+ *          WHERE lk.lookup_hash = rk.lookup_hash AND
+ *              bson_dollar_lookup_join_filter(rk.document, lk.lookup_filter, 'foreignField')
+ *          ORDER BY lk.lookup_row, rk.lookup_foreign_row) p
+ *      GROUP BY lookup_row) m
+ * ON l.lookup_row = m.lookup_row
+ * ORDER BY l.lookup_row
+ *
+ * The join keys only narrow down the candidates, the join filter is still applied on
+ * the key matches to preserve the $lookup semantics. A foreign document matching
+ * several local values is found once for each, so the pairs are deduplicated on the
+ * row numbers of both sides, which also keeps the matches of a local document in the
+ * order of the foreign documents like the lateral join. The final ORDER BY keeps the
+ * order of the local documents (e.g. of a prior $sort) through the join.
+ */
+static Query *
+ProcessLookupCoreWithHashJoin(Query *query, AggregationPipelineBuildContext *context,
+							  LookupArgs *lookupArgs,
+							  LookupOptimizationArgs *optimizationArgs)
+{
+	const AttrNumber documentAttrNum = 1;
+	const AttrNumber filterAttrNum = 2;
+	const AttrNumber rowAttrNum = 3;
+
+	/* Step 1: The left query with the lookup filter and a row identifier */
+	Query *leftQuery = MigrateQueryToSubQuery(query, context);
+	TargetEntry *leftDocumentEntry = linitial(leftQuery->targetList);
+
+	pgbson_writer filterWriter;
+	PgbsonWriterInit(&filterWriter);
+	PgbsonWriterAppendUtf8(&filterWriter, lookupArgs->foreignField.string,
+						   lookupArgs->foreignField.length,
+						   lookupArgs->localField.string);
+	List *extractFilterArgs = list_make2(copyObject(leftDocumentEntry->expr),
+										 MakeBsonConst(PgbsonWriterGetPgbson(
+														   &filterWriter)));
+	Expr *extractFilterExpr = (Expr *) makeFuncExpr(
+		DocumentDBApiInternalBsonLookupExtractFilterExpressionFunctionOid(),
+		BsonTypeId(), extractFilterArgs, InvalidOid, InvalidOid,
+		COERCE_EXPLICIT_CALL);
+	leftQuery->targetList = lappend(leftQuery->targetList,
+									makeTargetEntry(extractFilterExpr, filterAttrNum,
+													"lookup_filter", false));
+	AddRowNumberTargetEntry(leftQuery, rowAttrNum, "lookup_row", NIL);
+
+	StringInfo cteStr = makeStringInfo();
+	appendStringInfo(cteStr, "lookupLeftCte_%d", context->nestedPipelineLevel);
+	CommonTableExpr *leftCte = makeNode(CommonTableExpr);
+	leftCte->ctename = cteStr->data;
+	leftCte->ctequery = (Node *) leftQuery;
+
+	/* Step 2: The join keys of the left documents (the CTE is 3 levels up) */
+	int leftKeysCteLevelsUp = 3;
+	Query *leftKeysQuery = CreateCteSelectQuery(leftCte, "lookup_left_keys",
+												context->nestedPipelineLevel,
+												leftKeysCteLevelsUp);
+	TargetEntry *leftKeysFilterEntry = list_nth(leftKeysQuery->targetList,
+												filterAttrNum - 1);
+	TargetEntry *leftKeysRowEntry = list_nth(leftKeysQuery->targetList,
+											 rowAttrNum - 1);
+	FuncExpr *leftHashesExpr = makeFuncExpr(BsonDollarLookupFilterHashesFunctionOid(),
+											INT8OID,
+											list_make1(copyObject(
+														   leftKeysFilterEntry->expr)),
+											InvalidOid, InvalidOid,
+											COERCE_EXPLICIT_CALL);
+	leftHashesExpr->funcretset = true;
+	leftKeysQuery->targetList =
+		list_make3(makeTargetEntry(leftKeysRowEntry->expr, 1, "lookup_row", false),
+				   makeTargetEntry(leftKeysFilterEntry->expr, 2, "lookup_filter", false),
+				   makeTargetEntry((Expr *) leftHashesExpr, 3, "lookup_hash", false));
+	leftKeysQuery->hasTargetSRFs = true;
+
+	/*
+	 * Step 3: The join keys of the right documents, numbered in their order (the
+	 * window function is evaluated before the set returning function).
+	 */
+	Query *rightQuery = MigrateQueryToSubQuery(optimizationArgs->rightBaseQuery,
+											   &optimizationArgs->rightQueryContext);
+	TargetEntry *rightDocumentEntry = linitial(rightQuery->targetList);
+	AddRowNumberTargetEntry(rightQuery, 2, "lookup_foreign_row", NIL);
+	FuncExpr *rightHashesExpr = makeFuncExpr(
+		BsonDollarLookupDocumentHashesFunctionOid(), INT8OID,
+		list_make2(copyObject(rightDocumentEntry->expr),
+				   MakeTextConst(lookupArgs->foreignField.string,
+								 lookupArgs->foreignField.length)),
+		InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+	rightHashesExpr->funcretset = true;
+	rightQuery->targetList = lappend(rightQuery->targetList,
+									 makeTargetEntry((Expr *) rightHashesExpr, 3,
+													 "lookup_hash", false));
+	rightQuery->hasTargetSRFs = true;
+
+	/* Step 4: Match the join keys, recheck with the join filter and dedupe the pairs */
+	const Index leftKeysRteIndex = 1;
+	const Index rightKeysRteIndex = 2;
+	bool includeAllColumns = true;
+	Query *matchQuery = makeNode(Query);
+	matchQuery->commandType = CMD_SELECT;
+	matchQuery->querySource = query->querySource;
+	matchQuery->canSetTag = true;
+	matchQuery->rtable = list_make2(
+		MakeSubQueryRte(leftKeysQuery, 1, context->nestedPipelineLevel,
+						"lookupLeftKeys", includeAllColumns),
+		MakeSubQueryRte(rightQuery, 1, context->nestedPipelineLevel,
+						"lookupRightKeys", includeAllColumns));
+
+	RangeTblRef *leftKeysRef = makeNode(RangeTblRef);
+	leftKeysRef->rtindex = leftKeysRteIndex;
+	RangeTblRef *rightKeysRef = makeNode(RangeTblRef);
+	rightKeysRef->rtindex = rightKeysRteIndex;
+
+	Var *leftHashVar = makeVar(leftKeysRteIndex, 3, INT8OID, -1, InvalidOid, 0);
+	Var *rightHashVar = makeVar(rightKeysRteIndex, 3, INT8OID, -1, InvalidOid, 0);
+	Expr *hashEqualsExpr = make_opclause(Int8EqualOperator, BOOLOID, false,
+										 (Expr *) leftHashVar, (Expr *) rightHashVar,
+										 InvalidOid, InvalidOid);
+
+	Var *leftFilterVar = makeVar(leftKeysRteIndex, 2, BsonTypeId(), -1, InvalidOid, 0);
+	Var *rightDocumentVar = makeVar(rightKeysRteIndex, 1, BsonTypeId(), -1,
+									InvalidOid, 0);
+	Expr *joinFilterExpr = (Expr *) makeFuncExpr(
+		BsonDollarLookupJoinFilterFunctionOid(), BOOLOID,
+		list_make3(rightDocumentVar, leftFilterVar,
+				   MakeTextConst(lookupArgs->foreignField.string,
+								 lookupArgs->foreignField.length)),
+		InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+	matchQuery->jointree = makeFromExpr(list_make2(leftKeysRef, rightKeysRef),
+										(Node *) make_ands_explicit(
+											list_make2(hashEqualsExpr,
+													   joinFilterExpr)));
+
+	TargetEntry *matchRowEntry = makeTargetEntry(
+		(Expr *) makeVar(leftKeysRteIndex, 1, INT8OID, -1, InvalidOid, 0), 1,
+		"lookup_row", false);
+	TargetEntry *matchForeignRowEntry = makeTargetEntry(
+		(Expr *) makeVar(rightKeysRteIndex, 2, INT8OID, -1, InvalidOid, 0), 2,
+		"lookup_foreign_row", false);
+	matchQuery->targetList = list_make3(matchRowEntry, matchForeignRowEntry,
+										makeTargetEntry((Expr *) copyObject(
+															rightDocumentVar), 3,
+														"document", false));
+
+	SortGroupClause *rowSortClause = makeNode(SortGroupClause);
+	rowSortClause->tleSortGroupRef = assignSortGroupRef(matchRowEntry,
+														matchQuery->targetList);
+	rowSortClause->eqop = Int8EqualOperator;
+	rowSortClause->sortop = Int8LessOperator;
+	rowSortClause->nulls_first = false;
+	rowSortClause->hashable = true;
+
+	SortGroupClause *foreignRowSortClause = copyObject(rowSortClause);
+	foreignRowSortClause->tleSortGroupRef = assignSortGroupRef(matchForeignRowEntry,
+															   matchQuery->targetList);
+	matchQuery->distinctClause = list_make2(rowSortClause, foreignRowSortClause);
+	matchQuery->hasDistinctOn = true;
+	matchQuery->sortClause = list_make2(copyObject(rowSortClause),
+										copyObject(foreignRowSortClause));
+
+	/* Step 5: Group the matches per left row, they come in the foreign row order */
+	Query *groupQuery = makeNode(Query);
+	groupQuery->commandType = CMD_SELECT;
+	groupQuery->querySource = query->querySource;
+	groupQuery->canSetTag = true;
+	groupQuery->rtable = list_make1(MakeSubQueryRte(matchQuery, 1,
+													context->nestedPipelineLevel,
+													"lookupMatches",
+													includeAllColumns));
+	RangeTblRef *matchesRef = makeNode(RangeTblRef);
+	matchesRef->rtindex = 1;
+	groupQuery->jointree = makeFromExpr(list_make1(matchesRef), NULL);
+
+	TargetEntry *groupRowEntry = makeTargetEntry(
+		(Expr *) makeVar(1, 1, INT8OID, -1, InvalidOid, 0), 1, "lookup_row", false);
+	groupQuery->targetList = list_make1(groupRowEntry);
+
+	ParseState *parseState = make_parsestate(NULL);
+	parseState->p_expr_kind = EXPR_KIND_SELECT_TARGET;
+	parseState->p_next_resno = 2;
+
+	Aggref *matchesAggref = makeNode(Aggref);
+	matchesAggref->aggfnoid = BsonArrayAggregateFunctionOid();
+	matchesAggref->aggtype = BsonTypeId();
+	matchesAggref->aggtranstype = InvalidOid;
+	matchesAggref->aggkind = AGGKIND_NORMAL;
+	matchesAggref->aggsplit = AGGSPLIT_SIMPLE;
+	matchesAggref->aggno = -1;
+	matchesAggref->aggtransno = -1;
+	matchesAggref->location = -1;
+	matchesAggref->aggargtypes = list_make2_oid(BsonTypeId(), TEXTOID);
+
+	bool aggDistinct = false;
+	parseState->p_hasAggs = true;
+	transformAggregateCall(parseState, matchesAggref,
+						   list_make2(makeVar(1, 3, BsonTypeId(), -1, InvalidOid, 0),
+									  MakeTextConst(lookupArgs->lookupAs.string,
+													lookupArgs->lookupAs.length)),
+						   NIL, aggDistinct);
+	groupQuery->targetList = lappend(groupQuery->targetList,
+									 makeTargetEntry((Expr *) matchesAggref, 2,
+													 "lookup_matches", false));
+	groupQuery->hasAggs = true;
+	pfree(parseState);
+
+	SortGroupClause *groupClause = makeNode(SortGroupClause);
+	groupClause->tleSortGroupRef = assignSortGroupRef(groupRowEntry,
+													  groupQuery->targetList);
+	groupClause->eqop = Int8EqualOperator;
+	groupClause->sortop = Int8LessOperator;
+	groupClause->nulls_first = false;
+	groupClause->hashable = true;
+	groupQuery->groupClause = list_make1(groupClause);
+
+	/* Step 6: Left join the left documents with their matches */
+	Query *lookupQuery = makeNode(Query);
+	lookupQuery->commandType = CMD_SELECT;
+	lookupQuery->querySource = query->querySource;
+	lookupQuery->canSetTag = true;
+	lookupQuery->cteList = list_make1(leftCte);
+
+	context->numNestedLevels++;
+
+	const Index leftQueryRteIndex = 1;
+	const Index rightQueryRteIndex = 2;
+	const Index joinQueryRteIndex = 3;
+
+	int stageNum = 1;
+	RangeTblEntry *leftTree = CreateCteRte(leftCte, "lookup", stageNum, 0);
+	RangeTblEntry *rightTree = MakeSubQueryRte(groupQuery, 1,
+											   context->nestedPipelineLevel,
+											   "lookupRight", includeAllColumns);
+
+	List *outputVars = NIL;
+	List *outputColNames = NIL;
+	List *leftJoinCols = NIL;
+	List *rightJoinCols = NIL;
+	MakeBsonJoinVarsFromQuery(leftQueryRteIndex, leftQuery, &outputVars, &outputColNames,
+							  &leftJoinCols);
+	MakeBsonJoinVarsFromQuery(rightQueryRteIndex, groupQuery, &outputVars,
+							  &outputColNames, &rightJoinCols);
+	bool useInnerJoin = false;
+	RangeTblEntry *joinRte = MakeLookupJoinRte(outputVars, outputColNames, leftJoinCols,
+											   rightJoinCols, useInnerJoin);
+	lookupQuery->rtable = list_make3(leftTree, rightTree, joinRte);
+
+	RangeTblRef *leftRef = makeNode(RangeTblRef);
+	leftRef->rtindex = leftQueryRteIndex;
+	RangeTblRef *rightRef = makeNode(RangeTblRef);
+	rightRef->rtindex = rightQueryRteIndex;
+
+	JoinExpr *joinExpr = makeNode(JoinExpr);
+	joinExpr->jointype = joinRte->jointype;
+	joinExpr->rtindex = joinQueryRteIndex;
+	joinExpr->larg = (Node *) leftRef;
+	joinExpr->rarg = (Node *) rightRef;
+	joinExpr->quals = (Node *) make_opclause(
+		Int8EqualOperator, BOOLOID, false,
+		(Expr *) makeVar(leftQueryRteIndex, rowAttrNum, INT8OID, -1, InvalidOid, 0),
+		(Expr *) makeVar(rightQueryRteIndex, 1, INT8OID, -1, InvalidOid, 0),
+		InvalidOid, InvalidOid);
+	lookupQuery->jointree = makeFromExpr(list_make1(joinExpr), NULL);
+
+	Expr *leftOutput = (Expr *) makeVar(leftQueryRteIndex, documentAttrNum, BsonTypeId(),
+										-1, InvalidOid, 0);
+	Var *matchesVar = makeVar(rightQueryRteIndex, 2, BsonTypeId(), -1, InvalidOid, 0);
+#if PG_VERSION_NUM >= 160000
+
+	/* The matches are nulled by the LEFT JOIN for left rows without matches */
+	matchesVar->varnullingrels = bms_make_singleton(joinQueryRteIndex);
+#endif
+	Expr *rightOutput = GetArrayAggCoalesce((Expr *) matchesVar,
+											lookupArgs->lookupAs.string,
+											lookupArgs->lookupAs.length);
+
+	bool overrideArrayInMerge = true;
+	FuncExpr *addFields = makeFuncExpr(BsonDollaMergeDocumentsFunctionOid(),
+									   BsonTypeId(),
+									   list_make3(leftOutput, rightOutput,
+												  MakeBoolValueConst(
+													  overrideArrayInMerge)),
+									   InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+	/* Keep the order of the left documents through the join */
+	TargetEntry *leftRowEntry = makeTargetEntry(
+		(Expr *) makeVar(leftQueryRteIndex, rowAttrNum, INT8OID, -1, InvalidOid, 0), 2,
+		"lookup_row", true);
+	lookupQuery->targetList = list_make2(makeTargetEntry((Expr *) addFields, 1,
+														 "document", false),
+										 leftRowEntry);
+
+	SortGroupClause *leftRowSortClause = makeNode(SortGroupClause);
+	leftRowSortClause->tleSortGroupRef = assignSortGroupRef(leftRowEntry,
+															lookupQuery->targetList);
+	leftRowSortClause->eqop = Int8EqualOperator;
+	leftRowSortClause->sortop = Int8LessOperator;
+	leftRowSortClause->nulls_first = false;
+	leftRowSortClause->hashable = true;
+	lookupQuery->sortClause = list_make1(leftRowSortClause);
+
+	context->requiresSubQuery = true;
+	return lookupQuery;
+}
+
+
+/*
+ * Appends row_number() OVER (ORDER BY <orderClause>) to the target list of the query
+ * under the given name. The sort clauses must refer to entries of the target list.
+ * Without an ORDER BY the rows are numbered in the order the query produces them.
+ */
+static void
+AddRowNumberTargetEntry(Query *query, AttrNumber resno, const char *name,
+						List *orderClause)
+{
+	Index winRef = list_length(query->windowClause) + 1;
+	WindowFunc *rowNumberFunc = makeNode(WindowFunc);
+	rowNumberFunc->winfnoid = F_ROW_NUMBER;
+	rowNumberFunc->wintype = INT8OID;
+	rowNumberFunc->winref = winRef;
+	rowNumberFunc->winstar = false;
+	rowNumberFunc->winagg = false;
+	rowNumberFunc->location = -1;
+	query->targetList = lappend(query->targetList,
+								makeTargetEntry((Expr *) rowNumberFunc, resno,
+												pstrdup(name), false));
+
+	WindowClause *windowClause = makeNode(WindowClause);
+	windowClause->winref = winRef;
+	windowClause->orderClause = orderClause;
+	windowClause->frameOptions = FRAMEOPTION_DEFAULTS;
+	query->windowClause = lappend(query->windowClause, windowClause);
+	query->hasWindowFuncs = true;
+}
+
+
 /*
  * Validate that for Sharded collections, we track that lookup wtih Let
  * Doesn't have nested lookup due to citus limitations.
@@ -3411,6 +4488,11 @@ static Query *
 ProcessGraphLookupCore(Query *query, AggregationPipelineBuildContext *context,
 					   GraphLookupArgs *lookupArgs)
 {
+	if (CanUseNativeGraphLookup(context, lookupArgs))
+	{
+		return ProcessNativeGraphLookup(query, context, lookupArgs);
+	}
+
 	/* Similar to $lookup, if there's more than 1 projector push down */
 	if (list_length(query->targetList) > 1)
 	{
@@ -3479,6 +4561,126 @@ ProcessGraphLookupCore(Query *query, AggregationPipelineBuildContext *context,
 }
 
 
+/*
+ * Whether the graphLookup can be run as a native breadth first traversal
+ * (see bson_graph_lookup.c) instead of the recursive CTE.
+ */
+static bool
+CanUseNativeGraphLookup(AggregationPipelineBuildContext *context, GraphLookupArgs *args)
+{
+	if (!EnableNativeGraphLookup || IsCollationApplicable(context->collationString))
+	{
+		return false;
+	}
+
+	/* Views are traversed through their pipeline by the recursive CTE */
+	Datum collectionNameDatum = PointerGetDatum(
+		cstring_to_text_with_len(args->fromCollection.string,
+								 args->fromCollection.length));
+	MongoCollection *collection = GetMongoCollectionOrViewByNameDatum(
+		PointerGetDatum(context->databaseNameDatum), collectionNameDatum,
+		AccessShareLock);
+	if (collection != NULL && collection->viewDefinition != NULL)
+	{
+		return false;
+	}
+
+	/*
+	 * The traversal is done at runtime: build the base case query only to raise the
+	 * same errors as the recursive CTE for sharded collections and
+	 * restrictSearchWithMatch.
+	 */
+	int baseCteLevelsUp = 0;
+	GenerateBaseCaseQuery(context, args, baseCteLevelsUp);
+	return true;
+}
+
+
+/*
+ * Builds the native graph lookup query:
+ *
+ * SELECT bson_dollar_merge_documents(document,
+ *  bson_dollar_graph_lookup(
+ *      bson_expression_get(document, '{ "*connectToField*": { "$makeArray": "$*inputExpression*" } }'),
+ *      '{ "database": ..., "collection": ..., "connectToField": ..., ... }'), true)
+ * FROM (inputQuery) agg;
+ */
+static Query *
+ProcessNativeGraphLookup(Query *query, AggregationPipelineBuildContext *context,
+						 GraphLookupArgs *lookupArgs)
+{
+	ReportFeatureUsage(FEATURE_STAGE_GRAPH_LOOKUP_NATIVE);
+
+	query = MigrateQueryToSubQuery(query, context);
+	TargetEntry *documentEntry = linitial(query->targetList);
+
+	pgbson_writer specWriter;
+	PgbsonWriterInit(&specWriter);
+	PgbsonWriterAppendUtf8(&specWriter, "database", 8,
+						   text_to_cstring(context->databaseNameDatum));
+	PgbsonWriterAppendUtf8(&specWriter, "collection", 10,
+						   pnstrdup(lookupArgs->fromCollection.string,
+									lookupArgs->fromCollection.length));
+	PgbsonWriterAppendUtf8(&specWriter, "connectToField", 14,
+						   pnstrdup(lookupArgs->connectToField.string,
+									lookupArgs->connectToField.length));
+
+	/* { "connectToField": { "$makeArray": "$connectFromField" } } */
+	pgbson_writer connectFromWriter;
+	PgbsonWriterStartDocument(&specWriter, "connectFromExpression", 21,
+							  &connectFromWriter);
+	pgbson_writer makeArrayWriter;
+	PgbsonWriterStartDocument(&connectFromWriter, lookupArgs->connectToField.string,
+							  lookupArgs->connectToField.length, &makeArrayWriter);
+	PgbsonWriterAppendValue(&makeArrayWriter, "$makeArray", 10,
+							&lookupArgs->connectFromFieldExpression);
+	PgbsonWriterEndDocument(&connectFromWriter, &makeArrayWriter);
+	PgbsonWriterEndDocument(&specWriter, &connectFromWriter);
+
+	if (lookupArgs->maxDepth >= 0 && lookupArgs->maxDepth != INT32_MAX)
+	{
+		PgbsonWriterAppendInt32(&specWriter, "maxDepth", 8, lookupArgs->maxDepth);
+	}
+
+	if (lookupArgs->depthField.length > 0)
+	{
+		PgbsonWriterAppendUtf8(&specWriter, "depthField", 10,
+							   pnstrdup(lookupArgs->depthField.string,
+										lookupArgs->depthField.length));
+	}
+
+	if (lookupArgs->restrictSearch.value_type != BSON_TYPE_EOD)
+	{
+		PgbsonWriterAppendValue(&specWriter, "restrictSearchWithMatch", 23,
+								&lookupArgs->restrictSearch);
+	}
+
+	PgbsonWriterAppendUtf8(&specWriter, "as", 2,
+						   pnstrdup(lookupArgs->asField.string,
+									lookupArgs->asField.length));
+
+	FuncExpr *inputExpr = BuildInputExpressionForQuery(documentEntry->expr,
+													   &lookupArgs->connectToField,
+													   &lookupArgs->inputExpression,
+													   context);
+	FuncExpr *graphLookupExpr = makeFuncExpr(
+		BsonDollarGraphLookupFunctionOid(), BsonTypeId(),
+		list_make2(inputExpr, MakeBsonConst(PgbsonWriterGetPgbson(&specWriter))),
+		InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+	/* $graphlookup override nested array in merge projections */
+	bool overrideArrayInProjection = true;
+	documentEntry->expr = (Expr *) makeFuncExpr(
+		BsonDollaMergeDocumentsFunctionOid(), BsonTypeId(),
+		list_make3(documentEntry->expr, graphLookupExpr,
+				   MakeBoolValueConst(overrideArrayInProjection)),
+		InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+	context->requiresSubQuery = true;
+	return query;
+}
+
+
 /*
  * This builds the the caller of the recursive CTE for a graphLookup
  * For the structure of this query, see ProcessGraphLookupCore
@@ -35,6 +35,8 @@
 #include <rewrite/rewriteSearchCycle.h>
 #include <utils/version_utils.h>
 #include <executor/spi.h>
+#include <access/table.h>
+#include <utils/rel.h>
 
 #include "io/bson_core.h"
 #include "metadata/metadata_cache.h"
@@ -43,6 +45,7 @@
 #include "planner/documentdb_planner.h"
 #include "aggregation/bson_aggregation_pipeline.h"
 #include "commands/insert.h"
+#include "commands/create_indexes.h"
 #include "commands/parse_error.h"
 #include "commands/commands_common.h"
 #include "utils/feature_counter.h"
@@ -55,6 +58,7 @@
 #include "utils/query_utils.h"
 #include "utils/fmgr_utils.h"
 #include "schema_validation/schema_validation.h"
+#include "utils/guc_utils.h"
 
 #include "aggregation/bson_aggregation_pipeline_private.h"
 
@@ -123,6 +127,14 @@ extern bool EnableCollation;
 /* GUC to enable schema validation */
 extern bool EnableSchemaValidation;
 
+/* GUC to sort the $merge source by the 'on' fields */
+extern bool EnableSortedMergeSource;
+
+/* GUC to load the output of $out into a staging collection */
+extern bool EnableStagedOutLoad;
+
+extern char *ApiGucPrefixV2;
+
 static void ParseMergeStage(const bson_value_t *existingValue, const
 							char *currentNameSpace, MergeArgs *args);
 static void ParseOutStage(const bson_value_t *existingValue, const char *currentNameSpace,
@@ -179,10 +191,18 @@ static inline Expr * CreateSingleJoinExpr(const char *joinField,
 										  Var *targetObjectIdVar,
 										  const int extractFieldResNumber,
 										  const int sourceCollectionVarNo);
+static void AddOnFieldsSortToMergeSource(Query *query, int extractedOnFieldsInitIndex);
 static inline TargetEntry * MakeExtractFuncExprForMergeTE(const char *onField, uint32
 														  length, Var *sourceDocument,
 														  const int resNum);
 static void TruncateDataTable(int collectionId);
+static MongoCollection * TryCreateOutStagingCollection(const OutArgs *outArgs,
+													   MongoCollection *targetCollection,
+													   AggregationPipelineBuildContext *
+													   context);
+static void SetDataTableLogged(uint64 collectionId, bool logged);
+static bool IsDataTableClustered(Oid relationId);
+static void BuildCollectionIndexesOnStaging(OutputStagingInfo *outputStaging);
 static inline bool CheckSchemaValidationEnabledForDollarMergeOut(void);
 static inline void ValidateTargetNameSpaceForOutputStage(const StringView *targetDB,
 														 const StringView *
@@ -715,6 +735,11 @@ HandleMerge(const bson_value_t *existingValue, Query *query,
 									&mergeArgs.on);
 	}
 
+	if (EnableSortedMergeSource)
+	{
+		AddOnFieldsSortToMergeSource(query, sourceExtractedOnFieldsInitIndex);
+	}
+
 	context->expandTargetList = true;
 	query = MigrateQueryToSubQuery(query, context);
 	query->commandType = CMD_MERGE;
@@ -1336,6 +1361,50 @@ RearrangeTargetListForMerge(Query *query, MongoCollection *targetCollection,
 }
 
 
+/*
+ * Sorts the source of the $merge by the extracted 'on' fields so that the join
+ * probes the unique index of the target collection in key order, and rows that are
+ * inserted land in key order (i.e. mostly on the rightmost leaf of the index)
+ * instead of at random pages of the index.
+ *
+ * The source is left as is if it already has an order or a limit since the sort
+ * would otherwise change the documents that are merged.
+ */
+static void
+AddOnFieldsSortToMergeSource(Query *query, int extractedOnFieldsInitIndex)
+{
+	if (query->sortClause != NIL || query->limitCount != NULL ||
+		query->limitOffset != NULL)
+	{
+		return;
+	}
+
+	List *sortClause = NIL;
+	ListCell *cell;
+	foreach(cell, query->targetList)
+	{
+		TargetEntry *entry = (TargetEntry *) lfirst(cell);
+		if (entry->resno < extractedOnFieldsInitIndex ||
+			!IsA(entry->expr, FuncExpr) ||
+			((FuncExpr *) entry->expr)->funcid !=
+			BsonDollarMergeExtractFilterFunctionOid())
+		{
+			continue;
+		}
+
+		SortGroupClause *sortGroupClause = makeNode(SortGroupClause);
+		sortGroupClause->eqop = BsonEqualOperatorId();
+		sortGroupClause->sortop = BsonLessThanOperatorId();
+		sortGroupClause->hashable = false;
+		sortGroupClause->tleSortGroupRef = assignSortGroupRef(entry,
+															  query->targetList);
+		sortClause = lappend(sortClause, sortGroupClause);
+	}
+
+	query->sortClause = sortClause;
+}
+
+
 /* This function creates an target entry for bson_dollar_extract_merge_filter */
 static inline TargetEntry *
 MakeExtractFuncExprForMergeTE(const char *onField, uint32 length, Var *sourceDocument,
@@ -1999,8 +2068,29 @@ HandleOut(const bson_value_t *existingValue, Query *query,
 								"The target collection cannot be the same as the source collection in $out stage.")));
 		}
 
-		/* Truncate the target data table to delete all entries. This allows us to write new data into it */
-		TruncateDataTable(targetCollection->collectionId);
+		/*
+		 * Loading into a staging collection keeps the target readable until the
+		 * staging collection replaces it. The validator of the target would have
+		 * to move over as well, so targets with one are loaded in place.
+		 */
+		MongoCollection *stagingCollection = NULL;
+		if (EnableStagedOutLoad && context->allowStagedOutput &&
+			targetCollection->schemaValidator.validator == NULL)
+		{
+			stagingCollection = TryCreateOutStagingCollection(&outArgs,
+															  targetCollection,
+															  context);
+		}
+
+		if (stagingCollection != NULL)
+		{
+			targetCollection = stagingCollection;
+		}
+		else
+		{
+			/* Truncate the target data table to delete all entries. This allows us to write new data into it */
+			TruncateDataTable(targetCollection->collectionId);
+		}
 	}
 	else
 	{
@@ -2011,6 +2101,25 @@ HandleOut(const bson_value_t *existingValue, Query *query,
 		targetCollection =
 			CreateCollectionForInsert(StringViewGetTextDatum(&outArgs.targetDB),
 									  StringViewGetTextDatum(&outArgs.targetCollection));
+
+		/*
+		 * A target created here is only visible to this transaction, so it is
+		 * its own staging collection: it is loaded unlogged and not swapped.
+		 */
+		if (EnableStagedOutLoad && context->allowStagedOutput &&
+			IsDataTableCreatedWithinCurrentXact(targetCollection))
+		{
+			OutputStagingInfo *outputStaging = palloc0(sizeof(OutputStagingInfo));
+			outputStaging->databaseName =
+				DatumGetTextPP(StringViewGetTextDatum(&outArgs.targetDB));
+			outputStaging->stagingCollectionName =
+				DatumGetTextPP(StringViewGetTextDatum(&outArgs.targetCollection));
+			outputStaging->stagingCollectionId = targetCollection->collectionId;
+			context->outputStaging = outputStaging;
+
+			bool logged = false;
+			SetDataTableLogged(targetCollection->collectionId, logged);
+		}
 	}
 
 	RearrangeTargetListForMerge(query, targetCollection, false, NULL);
@@ -2081,6 +2190,200 @@ HandleOut(const bson_value_t *existingValue, Query *query,
 }
 
 
+/*
+ * Creates the staging collection that an $out into an existing target loads
+ * its output into. The staging collection is made unlogged for the load and
+ * only has the _id index until CompleteStagedOutput builds the indexes of the
+ * target on it. Returns NULL if the staging collection already exists, in
+ * which case the target is loaded in place.
+ */
+static MongoCollection *
+TryCreateOutStagingCollection(const OutArgs *outArgs, MongoCollection *targetCollection,
+							  AggregationPipelineBuildContext *context)
+{
+	Datum databaseDatum = StringViewGetTextDatum(&outArgs->targetDB);
+	text *stagingCollectionName =
+		cstring_to_text(psprintf("tmp.agg_out." UINT64_FORMAT,
+								 targetCollection->collectionId));
+
+	if (!CreateCollection(databaseDatum, PointerGetDatum(stagingCollectionName)))
+	{
+		return NULL;
+	}
+
+	MongoCollection *stagingCollection =
+		GetMongoCollectionByNameDatum(databaseDatum,
+									  PointerGetDatum(stagingCollectionName),
+									  RowExclusiveLock);
+	if (stagingCollection == NULL)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Unable to create the staging collection for $out"),
+						errdetail_log(
+							"Could not get collection from cache after creating the "
+							"staging collection")));
+	}
+
+	bool logged = false;
+	SetDataTableLogged(stagingCollection->collectionId, logged);
+
+	OutputStagingInfo *outputStaging = palloc0(sizeof(OutputStagingInfo));
+	outputStaging->databaseName = DatumGetTextPP(databaseDatum);
+	outputStaging->stagingCollectionName = stagingCollectionName;
+	outputStaging->stagingCollectionId = stagingCollection->collectionId;
+	outputStaging->targetCollectionName =
+		DatumGetTextPP(StringViewGetTextDatum(&outArgs->targetCollection));
+	outputStaging->targetCollectionId = targetCollection->collectionId;
+	outputStaging->targetIsClustered =
+		IsDataTableClustered(targetCollection->relationId);
+	context->outputStaging = outputStaging;
+
+	return stagingCollection;
+}
+
+
+/*
+ * Completes an $out that was loaded into a staging collection once the load
+ * has been drained (in the same transaction):
+ *  - The data table is made logged, which writes it to the WAL in bulk and
+ *    rebuilds its _id index.
+ *  - The indexes of the target are built over the loaded data, which uses
+ *    parallel index builds where the index access method supports them.
+ *  - The staging collection replaces the target: the target is dropped and
+ *    the staging collection is renamed to it, which only updates the
+ *    collection metadata since the data table is named by collection id.
+ */
+void
+CompleteStagedOutput(OutputStagingInfo *outputStaging)
+{
+	bool logged = true;
+	SetDataTableLogged(outputStaging->stagingCollectionId, logged);
+
+	if (outputStaging->targetCollectionId == 0)
+	{
+		/* The target was created by the $out and loaded in place */
+		return;
+	}
+
+	BuildCollectionIndexesOnStaging(outputStaging);
+
+	if (outputStaging->targetIsClustered)
+	{
+		StringInfo cmdStr = makeStringInfo();
+		appendStringInfo(cmdStr,
+						 "ALTER TABLE %s.documents_" UINT64_FORMAT
+						 " CLUSTER ON collection_pk_" UINT64_FORMAT,
+						 ApiDataSchemaName, outputStaging->stagingCollectionId,
+						 outputStaging->stagingCollectionId);
+
+		bool isNull = false;
+		bool readOnly = false;
+		ExtensionExecuteQueryViaSPI(cmdStr->data, readOnly, SPI_OK_UTILITY, &isNull);
+	}
+
+	bool dropTarget = true;
+	RenameCollection(PointerGetDatum(outputStaging->databaseName),
+					 PointerGetDatum(outputStaging->stagingCollectionName),
+					 PointerGetDatum(outputStaging->targetCollectionName),
+					 dropTarget);
+}
+
+
+/*
+ * Builds the valid indexes of the target of a staged $out (other than the
+ * _id index) on the staging collection.
+ */
+static void
+BuildCollectionIndexesOnStaging(OutputStagingInfo *outputStaging)
+{
+	StringInfo cmdStr = makeStringInfo();
+	appendStringInfo(cmdStr,
+					 "SELECT array_agg(%s.index_spec_as_bson(index_spec) ORDER BY index_id)"
+					 " FROM %s.collection_indexes WHERE collection_id = " UINT64_FORMAT
+					 " AND index_is_valid AND (index_spec).index_name != '%s'",
+					 ApiInternalSchemaName, ApiCatalogSchemaName,
+					 outputStaging->targetCollectionId, ID_INDEX_NAME);
+
+	bool isNull = true;
+	bool readOnly = true;
+	Datum indexSpecArray = ExtensionExecuteQueryViaSPI(cmdStr->data, readOnly,
+													   SPI_OK_SELECT, &isNull);
+	if (isNull)
+	{
+		return;
+	}
+
+	pgbson_writer createIndexesArgWriter;
+	PgbsonWriterInit(&createIndexesArgWriter);
+	PgbsonWriterAppendUtf8(&createIndexesArgWriter, "createIndexes", 13,
+						   text_to_cstring(outputStaging->stagingCollectionName));
+
+	pgbson_element_writer elementWriter;
+	PgbsonInitObjectElementWriter(&createIndexesArgWriter, &elementWriter,
+								  "indexes", 7);
+	PgbsonElementWriterWriteSQLValue(&elementWriter, isNull, indexSpecArray,
+									 RECORDARRAYOID);
+
+	Datum databaseDatum = PointerGetDatum(outputStaging->databaseName);
+
+	/* Follow the index specs of the target rather than the default opclass */
+	int savedGUCLevel = NewGUCNestLevel();
+	SetGUCLocally(psprintf("%s.defaultUseCompositeOpClass", ApiGucPrefixV2), "false");
+
+	bool buildAsUniqueForPrepareUnique = false;
+	CreateIndexesArg createIndexesArg =
+		ParseCreateIndexesArg(databaseDatum,
+							  PgbsonWriterGetPgbson(&createIndexesArgWriter),
+							  buildAsUniqueForPrepareUnique);
+
+	/* The staging collection was created in this transaction, the indexes are built right away */
+	bool skipCheckCollectionCreate = false;
+	bool uniqueIndexOnly = false;
+	create_indexes_non_concurrently(databaseDatum, createIndexesArg,
+									skipCheckCollectionCreate, uniqueIndexOnly);
+
+	RollbackGUCChange(savedGUCLevel);
+}
+
+
+/*
+ * Switches the data table of a collection that is only visible to the current
+ * transaction between unlogged (for a load) and logged.
+ */
+static void
+SetDataTableLogged(uint64 collectionId, bool logged)
+{
+	StringInfo cmdStr = makeStringInfo();
+	appendStringInfo(cmdStr,
+					 "ALTER TABLE %s.documents_" UINT64_FORMAT " SET %s",
+					 ApiDataSchemaName, collectionId, logged ? "LOGGED" : "UNLOGGED");
+
+	bool isNull = false;
+	bool readOnly = false;
+	ExtensionExecuteQueryViaSPI(cmdStr->data, readOnly, SPI_OK_UTILITY, &isNull);
+}
+
+
+static bool
+IsDataTableClustered(Oid relationId)
+{
+	Relation dataTable = table_open(relationId, AccessShareLock);
+	List *indexList = RelationGetIndexList(dataTable);
+	table_close(dataTable, NoLock);
+
+	ListCell *indexCell;
+	foreach(indexCell, indexList)
+	{
+		if (get_index_isclustered(lfirst_oid(indexCell)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /*
  * Truncate data table corresponding to the input collection id.
  */
@@ -16,9 +16,11 @@
 
 #include <access/table.h>
 #include <access/reloptions.h>
+#include <access/stratnum.h>
 #include <utils/rel.h>
 #include <catalog/namespace.h>
 #include <optimizer/planner.h>
+#include <optimizer/tlist.h>
 #include <nodes/nodes.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
@@ -44,6 +46,7 @@
 #include <parser/parse_relation.h>
 #include <parser/parse_func.h>
 #include <funcapi.h>
+#include <portability/instr_time.h>
 
 #include "io/bson_core.h"
 #include "metadata/metadata_cache.h"
@@ -57,11 +60,13 @@
 #include "utils/feature_counter.h"
 #include "utils/version_utils.h"
 #include "aggregation/bson_query.h"
+#include "aggregation/bson_query_shape.h"
 #include "metadata/index.h"
 
 #include "aggregation/bson_aggregation_pipeline_private.h"
 #include "aggregation/bson_bucket_auto.h"
 #include "api_hooks.h"
+#include "utils/stage_counter.h"
 #include "vector/vector_common.h"
 #include "aggregation/bson_project.h"
 #include "operators/bson_expression.h"
@@ -79,12 +84,21 @@ extern bool DefaultInlineWriteOperations;
 extern int MaxAggregationStagesAllowed;
 extern bool EnableIndexOrderbyPushdown;
 extern bool EnableConversionStreamableToSingleBatch;
+extern bool EnableParallelSingleBatchAggregation;
+extern bool EnableParallelUnionWith;
+extern bool EnableMultiPointReadPlan;
 extern bool EnableFindProjectionAfterOffset;
 extern bool EnableNewCountAggregates;
 extern bool EnableUseLookupNewProjectInlineMethod;
+extern bool EnableAggregationStageCounters;
+extern bool EnablePercentileSketches;
+extern bool EnableCombinableGroupAccumulators;
+extern bool EnableChangeStreamFilterPushdown;
+extern bool EnableSortedFindStreamingCursor;
 
 /* GUC to config tdigest compression */
 extern int TdigestCompressionAccuracy;
+extern int SampleOversamplingFactor;
 
 /*
  * The mutation function that modifies a given query with a pipeline stage's value.
@@ -154,6 +168,11 @@ typedef struct AggregationStageDefinition
 } AggregationStageDefinition;
 
 
+static bool IsSortSpecResumable(const bson_value_t *sortSpec);
+static bool AddSortResumeKeyToQuery(Query *query, QueryData *queryData);
+static Expr * CreateSortResumeSeekQual(Expr *sortExpr, Const *resumeValue);
+static List * ReplaceFullScanQualForSortPath(List *quals, FuncExpr *sortFunc,
+											 Expr *seekQual);
 static void AddCursorFunctionsToQuery(Query *query, Query *baseQuery,
 									  QueryData *queryData,
 									  AggregationPipelineBuildContext *context,
@@ -226,6 +245,8 @@ static bool RequiresPersistentCursorSkip(const bson_value_t *pipelineValue,
 										 bool *isSingleRowResult);
 static bool RequiresPersistentCursorFalseNoSingleRow(const bson_value_t *pipelineValue,
 													 bool *isSingleRowResult);
+static bool RequiresPersistentCursorFacet(const bson_value_t *pipelineValue,
+										  bool *isSingleRowResult);
 static bool RequiresPersistentCursorTrueSingleRow(const bson_value_t *pipelineValue,
 												  bool *isSingleRowResult);
 
@@ -239,6 +260,8 @@ static bool CanInlineLookupStageUnwind(const bson_value_t *stageValue, const
 									   StringView *lookupPath, bool hasLet);
 static bool CanInlineLookupStageTrue(const bson_value_t *stageValue, const
 									 StringView *lookupPath, bool hasLet);
+static bson_value_t MergeChangeStreamMatchFilters(const bson_value_t *changeStreamSpec,
+												  List *matchFilters);
 static void PreCheckChangeStreamPipelineStages(const bson_value_t *pipelineValue,
 											   const AggregationPipelineBuildContext *
 											   context);
@@ -436,7 +459,7 @@ static const AggregationStageDefinition StageDefinitions[] =
 	{
 		.stage = "$facet",
 		.mutateFunc = &HandleFacet,
-		.requiresPersistentCursor = &RequiresPersistentCursorTrue,
+		.requiresPersistentCursor = &RequiresPersistentCursorFacet,
 
 		/* Changes the projector - can't be inlined */
 		.canInlineLookupStageFunc = NULL,
@@ -653,6 +676,21 @@ static const AggregationStageDefinition StageDefinitions[] =
 		.allowBaseShardTablePushdown = true,
 		.stageEnum = Stage_Project,
 	},
+	{
+		.stage = "$rankFusion",
+		.mutateFunc = &HandleRankFusion,
+		.requiresPersistentCursor = &RequiresPersistentCursorTrue,
+		.canInlineLookupStageFunc = NULL,
+		.preservesStableSortOrder = false,
+		.canHandleAgnosticQueries = false,
+		.isProjectTransform = false,
+		.isOutputStage = false,
+		.pipelineCheckFunc = NULL,
+
+		/* Its input pipelines may have a $vectorSearch, see $vectorSearch */
+		.allowBaseShardTablePushdown = false,
+		.stageEnum = Stage_RankFusion,
+	},
 	{
 		.stage = "$redact",
 		.mutateFunc = &HandleRedact,
@@ -876,6 +914,9 @@ static const int AggregationStageCount = sizeof(StageDefinitions) /
 
 static const int MaxEvenFunctionArguments = ((int) (FUNC_MAX_ARGS / 2)) * 2;
 
+StaticAssertDecl(Stage_LookupUnwind < MAX_STAGE_COUNTER_COUNT,
+				 "stage enums should be less than MAX_STAGE_COUNTER_COUNT");
+
 PG_FUNCTION_INFO_V1(command_bson_aggregation_pipeline);
 PG_FUNCTION_INFO_V1(command_bson_aggregation_getmore);
 PG_FUNCTION_INFO_V1(command_api_collection);
@@ -1170,13 +1211,42 @@ MutateQueryWithPipeline(Query *query, List *aggregationStages,
 			}
 		}
 
-		query = definition->mutateFunc(&stage->stageValue, query,
-									   context);
+		if (EnableAggregationStageCounters)
+		{
+			instr_time startTime;
+			INSTR_TIME_SET_CURRENT(startTime);
+			Size allocatedBefore = MemoryContextMemAllocated(CurrentMemoryContext,
+															 true);
 
-		context->requiresPersistentCursor =
-			context->requiresPersistentCursor ||
+			query = definition->mutateFunc(&stage->stageValue, query,
+										   context);
+
+			instr_time buildTime;
+			INSTR_TIME_SET_CURRENT(buildTime);
+			INSTR_TIME_SUBTRACT(buildTime, startTime);
+			Size allocatedAfter = MemoryContextMemAllocated(CurrentMemoryContext,
+															true);
+			ReportStageBuildStats(definition->stageEnum,
+								  INSTR_TIME_GET_MICROSEC(buildTime),
+								  allocatedAfter > allocatedBefore ?
+								  allocatedAfter - allocatedBefore : 0);
+		}
+		else
+		{
+			query = definition->mutateFunc(&stage->stageValue, query,
+										   context);
+		}
+
+		/*
+		 * Every stage is asked even once the cursor is persisted: a later stage
+		 * (e.g. $unwind after $facet or $count) can turn a single row result back
+		 * into multiple rows.
+		 */
+		bool stageRequiresPersistentCursor =
 			definition->requiresPersistentCursor(&stage->stageValue,
 												 &context->isSingleRowResult);
+		context->requiresPersistentCursor =
+			context->requiresPersistentCursor || stageRequiresPersistentCursor;
 
 		if (!definition->preservesStableSortOrder)
 		{
@@ -1196,6 +1266,30 @@ MutateQueryWithPipeline(Query *query, List *aggregationStages,
 }
 
 
+/*
+ * Returns the name of the stage with the given Stage enum value,
+ * or NULL if there is no such stage.
+ */
+const char *
+GetAggregationStageNameById(int stageId)
+{
+	if (stageId == LookupUnwindStageDefinition.stageEnum)
+	{
+		return LookupUnwindStageDefinition.stage;
+	}
+
+	for (int i = 0; i < AggregationStageCount; i++)
+	{
+		if ((int) StageDefinitions[i].stageEnum == stageId)
+		{
+			return StageDefinitions[i].stage;
+		}
+	}
+
+	return NULL;
+}
+
+
 /*
  * Given a query and an aggregation pipeline mutates the query
  * to match the contents of the provided aggregation pipeline.
@@ -1363,6 +1457,12 @@ GenerateAggregationQuery(text *database, pgbson *aggregationSpec, QueryData *que
 	List *aggregationStages = ExtractAggregationStages(&pipelineValue,
 													   &context);
 
+	/*
+	 * Only the cursor commands complete a staged $out after draining it (see
+	 * HandleFirstPageRequest), explains and SQL calls load the target in place.
+	 */
+	context.allowStagedOutput = addCursorParams && !explain;
+
 	Query *query;
 	if (isCollectionAgnosticQuery)
 	{
@@ -1396,6 +1496,7 @@ GenerateAggregationQuery(text *database, pgbson *aggregationSpec, QueryData *que
 		/* CMD_MERGE is case when pipeline has output stage ($merge or $out) result will be always single batch. */
 		ThrowIfServerOrTransactionReadOnly();
 		queryData->cursorKind = QueryCursorType_SingleBatch;
+		queryData->outputStaging = context.outputStaging;
 	}
 	else if (queryData->cursorKind == QueryCursorType_Unspecified)
 	{
@@ -1410,6 +1511,22 @@ GenerateAggregationQuery(text *database, pgbson *aggregationSpec, QueryData *que
 	{
 		queryData->cursorKind = QueryCursorType_SingleBatch;
 	}
+	else if (queryData->cursorKind == QueryCursorType_Persistent &&
+			 context.isSingleRowResult && EnableParallelSingleBatchAggregation &&
+			 queryData->batchSize >= 1)
+	{
+		/*
+		 * A single document response needs only one page: drain it in one go so that
+		 * the query runs to completion and can be planned with parallel workers.
+		 */
+		queryData->cursorKind = QueryCursorType_SingleBatch;
+	}
+
+	/*
+	 * The branches of a $unionWith are independent scans, with parallel workers
+	 * they run as a parallel append instead of one after the other.
+	 */
+	queryData->allowParallelPlan = context.hasUnionWith && EnableParallelUnionWith;
 
 	queryData->namespaceName = context.namespaceName;
 
@@ -1439,6 +1556,7 @@ GenerateAggregationQuery(text *database, pgbson *aggregationSpec, QueryData *que
 									 &context);
 	}
 
+	SetQueryShapeHash(query, context.databaseNameDatum, aggregationSpec);
 	return query;
 }
 
@@ -1833,7 +1951,19 @@ default_find_case:
 	context.variableSpec = (Expr *) MakeBsonConst(parsedVariables);
 
 	context.isSingleRowResult = false;
-	if (sort.value_type != BSON_TYPE_EOD)
+
+	/*
+	 * A sorted find without skip or limit can be streamed by resuming each page
+	 * from the sort key of the next document to return. A getMore of such a
+	 * cursor always has a resume key, even if the flag was turned off since.
+	 */
+	bool isSortedStreamableFind = sort.value_type != BSON_TYPE_EOD &&
+								  skip.value_type == BSON_TYPE_EOD &&
+								  limit.value_type == BSON_TYPE_EOD &&
+								  (EnableSortedFindStreamingCursor ||
+								   queryData->sortResumeKeyConst != NULL) &&
+								  IsSortSpecResumable(&sort);
+	if (sort.value_type != BSON_TYPE_EOD && !isSortedStreamableFind)
 	{
 		context.requiresPersistentCursor = true;
 	}
@@ -1893,7 +2023,7 @@ default_find_case:
 	}
 
 	/* $near and $nearSphere add sort clause to query, for them we need persistent cursor. */
-	if (query->sortClause)
+	if (query->sortClause && !isSortedStreamableFind)
 	{
 		context.requiresPersistentCursor = true;
 	}
@@ -1920,6 +2050,7 @@ default_find_case:
 	{
 		/* Any attempts to push to a subquery should invalidate point read plans */
 		context.isPointReadQuery = false;
+		context.isMultiPointReadQuery = false;
 	}
 
 	if (queryData->cursorKind == QueryCursorType_Unspecified)
@@ -1937,6 +2068,15 @@ default_find_case:
 		 */
 		queryData->cursorKind = QueryCursorType_PointRead;
 	}
+	else if (context.isMultiPointReadQuery && EnableMultiPointReadPlan &&
+			 context.allowShardBaseTable && queryData->batchSize >= 1 &&
+			 queryData->cursorKind == QueryCursorType_Streamable)
+	{
+		/* An $in on _id without sort, skip or limit can probe the primary key
+		 * index for all the ids in one batch.
+		 */
+		queryData->cursorKind = QueryCursorType_MultiPointRead;
+	}
 
 	if (queryData->cursorKind == QueryCursorType_Streamable &&
 		context.isSingleRowResult && EnableConversionStreamableToSingleBatch &&
@@ -1945,6 +2085,22 @@ default_find_case:
 		queryData->cursorKind = QueryCursorType_SingleBatch;
 	}
 
+	if (isSortedStreamableFind && queryData->cursorKind == QueryCursorType_Streamable)
+	{
+		/*
+		 * Only the find cursor commands return the resume key columns. The resume
+		 * key needs a unique object_id, which only holds for unsharded collections,
+		 * and the sort to be on the base table query.
+		 */
+		bool canResumeSort = addCursorParams && query == baseQuery &&
+							 context.mongoCollection != NULL &&
+							 context.mongoCollection->shardKey == NULL &&
+							 !IsCollationApplicable(context.collationString) &&
+							 AddSortResumeKeyToQuery(query, queryData);
+		queryData->cursorKind = canResumeSort ? QueryCursorType_SortedStreamable :
+								QueryCursorType_Persistent;
+	}
+
 	if (addCursorParams)
 	{
 		bool addCursorAsConst = false;
@@ -1958,6 +2114,7 @@ default_find_case:
 								  addCursorAsConst);
 	}
 
+	SetQueryShapeHash(query, context.databaseNameDatum, findSpec);
 	return query;
 }
 
@@ -2393,6 +2550,12 @@ ParseGetMore(text **databaseName, pgbson *getMoreSpec, QueryData *queryData, boo
 			EnsureTopLevelFieldIsNumberLike("getMore.maxTimeMS", value);
 			SetExplicitStatementTimeout(BsonValueAsInt32(value));
 		}
+		else if (strcmp(pathKey, "maxAwaitTimeMS") == 0)
+		{
+			const bson_value_t *value = bson_iter_value(&cursorSpecIter);
+			EnsureTopLevelFieldIsNumberLike("getMore.maxAwaitTimeMS", value);
+			queryData->maxAwaitTimeMS = Max(BsonValueAsInt32(value), 0);
+		}
 		else if (strcmp(pathKey, "$db") == 0)
 		{
 			/* BackCompat: Ignore if provided top level */
@@ -2880,7 +3043,9 @@ ParseInputDocumentForMedianAndPercentile(const bson_value_t *inputDocument,
 						errdetail_log(
 							"BSON field '$%s.method' expects type 'string'", opName)));
 	}
-	if (strcmp(method->value.v_utf8.str, "approximate") != 0)
+	if (strcmp(method->value.v_utf8.str, "approximate") != 0 &&
+		!(EnablePercentileSketches &&
+		  strcmp(method->value.v_utf8.str, "mergeSketches") == 0))
 	{
 		/* Same error message for both $median and $percentile */
 		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE), errmsg(
@@ -3988,6 +4153,46 @@ PreCheckChangeStreamPipelineStages(const bson_value_t *pipelineValue,
 }
 
 
+/*
+ * Returns the $changeStream spec with the filters of the $match stages that follow it appended
+ * under "$_matchFilter", which the change stream provider evaluates against each event before
+ * serializing it. Multiple $match stages are combined with $and.
+ */
+static bson_value_t
+MergeChangeStreamMatchFilters(const bson_value_t *changeStreamSpec, List *matchFilters)
+{
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterConcat(&writer, PgbsonInitFromDocumentBsonValue(changeStreamSpec));
+
+	if (list_length(matchFilters) == 1)
+	{
+		PgbsonWriterAppendValue(&writer, "$_matchFilter", 13,
+								(const bson_value_t *) linitial(matchFilters));
+	}
+	else
+	{
+		pgbson_writer filterWriter;
+		PgbsonWriterStartDocument(&writer, "$_matchFilter", 13, &filterWriter);
+
+		pgbson_array_writer andWriter;
+		PgbsonWriterStartArray(&filterWriter, "$and", 4, &andWriter);
+
+		ListCell *filterCell;
+		foreach(filterCell, matchFilters)
+		{
+			PgbsonArrayWriterWriteValue(&andWriter,
+										(const bson_value_t *) lfirst(filterCell));
+		}
+
+		PgbsonWriterEndArray(&filterWriter, &andWriter);
+		PgbsonWriterEndDocument(&writer, &filterWriter);
+	}
+
+	return ConvertPgbsonToBsonValue(PgbsonWriterGetPgbson(&writer));
+}
+
+
 /*
  * Modifies the query to handle the $changeStream stage.
  * It forma a query that calls the $changeStream function.
@@ -4161,14 +4366,17 @@ AddShardKeyAndIdFilters(const bson_value_t *existingValue, Query *query,
 		 * push the Id filter to primary key index if the type needs to be collation aware (e.g., _id contains UTF8 )*/
 		bool isCollationAware;
 		bool isPointRead = false;
+		bool isMultiPointRead = false;
 		Expr *idFilter = CreateIdFilterForQuery(existingQuals, var->varno,
-												&isCollationAware, &isPointRead);
+												&isCollationAware, &isPointRead,
+												&isMultiPointRead);
 
 		if (idFilter != NULL &&
 			!(isCollationAware && IsCollationApplicable(context->collationString)))
 		{
 			existingQuals = lappend(existingQuals, idFilter);
 			context->isPointReadQuery = isPointRead;
+			context->isMultiPointReadQuery = isMultiPointRead;
 		}
 	}
 
@@ -5786,8 +5994,20 @@ AddPercentileMedianGroupAccumulator(Query *query, const bson_value_t *accumulato
 			InvalidOid, COERCE_EXPLICIT_CALL);
 	}
 
-	Oid aggregateFunctionOid = isMedianOp ? BsonMedianAggregateFunctionOid() :
+	/* 'mergeSketches' computes the percentiles from sketches built by $percentileSketch */
+	bool mergeSketches = strcmp(method.value.v_utf8.str, "mergeSketches") == 0;
+	Oid aggregateFunctionOid;
+	if (mergeSketches)
+	{
+		aggregateFunctionOid = isMedianOp ?
+							   BsonMedianFromSketchesAggregateFunctionOid() :
+							   BsonPercentileFromSketchesAggregateFunctionOid();
+	}
+	else
+	{
+		aggregateFunctionOid = isMedianOp ? BsonMedianAggregateFunctionOid() :
 							   BsonPercentileAggregateFunctionOid();
+	}
 	Aggref *aggref = CreateMultiArgAggregate(aggregateFunctionOid, list_make3(
 												 (Expr *) inputAccumFunc,
 												 accuracyConstValue, (Expr *) pAccumFunc),
@@ -5808,6 +6028,103 @@ AddPercentileMedianGroupAccumulator(Query *query, const bson_value_t *accumulato
 }
 
 
+/*
+ * Function used to support the $percentileSketch accumulator, which stores the
+ * t-digest of its input as a binary value so that it can be persisted (e.g.
+ * per time bucket with $merge) and merged later by $percentile/$median with
+ * method 'mergeSketches'.
+ * Syntax: { $percentileSketch: { input: <expression> } }
+ */
+inline static List *
+AddPercentileSketchGroupAccumulator(Query *query, const bson_value_t *accumulatorValue,
+									List *repathArgs, Const *accumulatorText,
+									ParseState *parseState, char *identifiers,
+									Expr *documentExpr, Expr *variableSpec)
+{
+	if (accumulatorValue->value_type != BSON_TYPE_DOCUMENT)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"Specification must be an object type, but instead received $percentileSketch with type: %s",
+							BsonTypeName(accumulatorValue->value_type))));
+	}
+
+	bson_value_t input = { 0 };
+	bson_iter_t docIter;
+	BsonValueInitIterator(accumulatorValue, &docIter);
+	while (bson_iter_next(&docIter))
+	{
+		const char *key = bson_iter_key(&docIter);
+		if (strcmp(key, "input") == 0)
+		{
+			input = *bson_iter_value(&docIter);
+		}
+		else
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_UNKNOWNBSONFIELD), errmsg(
+								"The BSON field named with operators '$percentileSketch.%s' is not recognized.",
+								key)));
+		}
+	}
+
+	if (input.value_type == BSON_TYPE_EOD)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_LOCATION40414), errmsg(
+							"The BSON field '$percentileSketch.input' is required but is currently missing from the data structure")));
+	}
+
+	Expr *inputConstValue = (Expr *) MakeBsonConst(BsonValueToDocumentPgbson(&input));
+	Const *accuracyConstValue = makeConst(INT4OID, -1, InvalidOid, sizeof(int32_t),
+										  Int32GetDatum(TdigestCompressionAccuracy),
+										  false, true);
+	Const *trueConst = makeConst(BOOLOID, -1, InvalidOid, 1, BoolGetDatum(true), false,
+								 true);
+
+	List *inputFuncArgs;
+	Oid bsonExpressionGetFunction;
+	if (variableSpec != NULL)
+	{
+		bsonExpressionGetFunction = BsonExpressionGetWithLetFunctionOid();
+		inputFuncArgs = list_make4(documentExpr, inputConstValue, trueConst,
+								   variableSpec);
+	}
+	else
+	{
+		bsonExpressionGetFunction = BsonExpressionGetFunctionOid();
+		inputFuncArgs = list_make3(documentExpr, inputConstValue, trueConst);
+	}
+
+	FuncExpr *inputAccumFunc = makeFuncExpr(bsonExpressionGetFunction, BsonTypeId(),
+											inputFuncArgs, InvalidOid,
+											InvalidOid, COERCE_EXPLICIT_CALL);
+	if (BsonTypeId() != DocumentDBCoreBsonTypeId())
+	{
+		inputAccumFunc = makeFuncExpr(
+			DocumentDBCoreBsonToBsonFunctionOId(), BsonTypeId(), list_make1(
+				inputAccumFunc),
+			InvalidOid,
+			InvalidOid, COERCE_EXPLICIT_CALL);
+	}
+
+	Aggref *aggref = CreateMultiArgAggregate(BsonPercentileSketchAggregateFunctionOid(),
+											 list_make2((Expr *) inputAccumFunc,
+														accuracyConstValue),
+											 list_make2_oid(BsonTypeId(),
+															accuracyConstValue->consttype),
+											 parseState);
+
+	repathArgs = lappend(repathArgs, AddGroupExpression((Expr *) accumulatorText,
+														parseState, identifiers, query,
+														TEXTOID, NULL));
+
+	repathArgs = lappend(repathArgs, AddGroupExpression((Expr *) aggref, parseState,
+														identifiers, query, BsonTypeId(),
+														NULL));
+
+	return repathArgs;
+}
+
+
 /*
  * Handles the $group stage.
  * Creates a subquery.
@@ -6196,26 +6513,32 @@ HandleGroup(const bson_value_t *existingValue, Query *query,
 		}
 		else if (StringViewEqualsCString(&accumulatorName, "$addToSet"))
 		{
+			Oid addToSetFunctionOid = EnableCombinableGroupAccumulators ?
+									  BsonAddToSetCombinableAggregateFunctionOid() :
+									  BsonAddToSetAggregateFunctionOid();
 			repathArgs = AddSimpleGroupAccumulator(query,
 												   &accumulatorElement.bsonValue,
 												   repathArgs,
 												   accumulatorText, parseState,
 												   identifiers,
 												   origEntry->expr,
-												   BsonAddToSetAggregateFunctionOid(),
+												   addToSetFunctionOid,
 												   context->variableSpec);
 		}
 		else if (StringViewEqualsCString(&accumulatorName, "$mergeObjects"))
 		{
 			if (context->sortSpec.value_type == BSON_TYPE_EOD)
 			{
+				Oid mergeObjectsFunctionOid = EnableCombinableGroupAccumulators ?
+											  BsonMergeObjectsCombinableFunctionOid() :
+											  BsonMergeObjectsOnSortedFunctionOid();
 				repathArgs = AddSimpleGroupAccumulator(query,
 													   &accumulatorElement.bsonValue,
 													   repathArgs,
 													   accumulatorText, parseState,
 													   identifiers,
 													   origEntry->expr,
-													   BsonMergeObjectsOnSortedFunctionOid(),
+													   mergeObjectsFunctionOid,
 													   context->variableSpec);
 			}
 			else
@@ -6236,13 +6559,23 @@ HandleGroup(const bson_value_t *existingValue, Query *query,
 		{
 			char *fieldPath = "";
 			bool handleSingleValue = true;
+
+			/*
+			 * The partial states are combined in no particular order, so the
+			 * combinable version is only used if the order of the pushed values
+			 * isn't defined by a preceding $sort.
+			 */
+			Oid pushFunctionOid = EnableCombinableGroupAccumulators &&
+								  context->sortSpec.value_type == BSON_TYPE_EOD ?
+								  BsonArrayAggregateCombinableFunctionOid() :
+								  BsonArrayAggregateAllArgsFunctionOid();
 			repathArgs = AddArrayAggGroupAccumulator(query,
 													 &accumulatorElement.bsonValue,
 													 repathArgs,
 													 accumulatorText, parseState,
 													 identifiers,
 													 origEntry->expr,
-													 BsonArrayAggregateAllArgsFunctionOid(),
+													 pushFunctionOid,
 													 fieldPath,
 													 handleSingleValue,
 													 context->variableSpec);
@@ -6398,6 +6731,17 @@ HandleGroup(const bson_value_t *existingValue, Query *query,
 															 context->variableSpec,
 															 false);
 		}
+		else if (EnablePercentileSketches &&
+				 StringViewEqualsCString(&accumulatorName, "$percentileSketch"))
+		{
+			repathArgs = AddPercentileSketchGroupAccumulator(query,
+															 &accumulatorElement.bsonValue,
+															 repathArgs,
+															 accumulatorText, parseState,
+															 identifiers,
+															 origEntry->expr,
+															 context->variableSpec);
+		}
 		else
 		{
 			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_LOCATION15952),
@@ -6641,6 +6985,19 @@ RequiresPersistentCursorTrue(const bson_value_t *pipelineValue, bool *isSingleRo
 }
 
 
+/*
+ * $facet needs the full input so it requires a persisted cursor, but it
+ * always produces a single document.
+ */
+static bool
+RequiresPersistentCursorFacet(const bson_value_t *pipelineValue, bool *isSingleRowResult)
+{
+	/* Multi-row unless the single row result can be drained in a single batch */
+	*isSingleRowResult = EnableParallelSingleBatchAggregation;
+	return true;
+}
+
+
 static bool
 RequiresPersistentCursorTrueSingleRow(const bson_value_t *pipelineValue,
 									  bool *isSingleRowResult)
@@ -7249,6 +7606,300 @@ AddCursorFunctionsToQuery(Query *query, Query *baseQuery,
 }
 
 
+/*
+ * Whether the sort of a find can be resumed from a sort key: $natural sorts by
+ * ctid and $meta sorts by a score, neither can be compared with a resume key.
+ */
+static bool
+IsSortSpecResumable(const bson_value_t *sortSpec)
+{
+	if (sortSpec->value_type != BSON_TYPE_DOCUMENT)
+	{
+		return false;
+	}
+
+	bson_iter_t sortIter;
+	BsonValueInitIterator(sortSpec, &sortIter);
+	while (bson_iter_next(&sortIter))
+	{
+		if (strcmp(bson_iter_key(&sortIter), "$natural") == 0 ||
+			!BsonValueIsNumber(bson_iter_value(&sortIter)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/*
+ * Turns a sorted find into a sorted streamable query, i.e.
+ * SELECT document, <sort keys>, object_id FROM ... WHERE <resume qual>
+ * ORDER BY <sort keys>, object_id
+ *
+ * The sort keys and object_id are returned after the document so that the cursor
+ * can build the resume key of the next page from the first row it doesn't return.
+ * object_id breaks the ties of the sort, so that a page never resumes in between
+ * documents with the same sort keys. If the query has a resume key, it only returns
+ * the documents sorted at or after it with a row comparison:
+ *   ROW(k1, k2, ..., object_id) >= ROW(r1, r2, ..., rid)
+ * and an ordered index scan on the first sort key seeks to r1 (see
+ * CreateSortResumeSeekQual), instead of scanning from the start of the index.
+ *
+ * Returns false if the query has outputs other than the document and its sort keys.
+ */
+static bool
+AddSortResumeKeyToQuery(Query *query, QueryData *queryData)
+{
+	if (list_length(query->targetList) != list_length(query->sortClause) + 1)
+	{
+		return false;
+	}
+
+	/* Return the sort keys in the order of the sort, after the document */
+	AttrNumber resno = 1;
+	List *targetList = list_make1(linitial(query->targetList));
+	ListCell *cell;
+	foreach(cell, query->sortClause)
+	{
+		SortGroupClause *sortClause = lfirst(cell);
+		TargetEntry *sortEntry = get_sortgroupclause_tle(sortClause, query->targetList);
+		sortEntry->resjunk = false;
+		sortEntry->resno = ++resno;
+		targetList = lappend(targetList, sortEntry);
+	}
+
+	Var *objectIdVar = makeVar(1, DOCUMENT_DATA_TABLE_OBJECT_ID_VAR_ATTR_NUMBER,
+							   BsonTypeId(), -1, InvalidOid, 0);
+	bool resjunk = false;
+	TargetEntry *objectIdEntry = makeTargetEntry((Expr *) objectIdVar, ++resno,
+												 "objectId", resjunk);
+	targetList = lappend(targetList, objectIdEntry);
+	query->targetList = targetList;
+
+	SortGroupClause *objectIdSortClause = makeNode(SortGroupClause);
+	objectIdSortClause->tleSortGroupRef = assignSortGroupRef(objectIdEntry,
+															 query->targetList);
+	objectIdSortClause->eqop = BsonEqualOperatorId();
+	objectIdSortClause->sortop = BsonLessThanOperatorId();
+	objectIdSortClause->nulls_first = false;
+	objectIdSortClause->hashable = false;
+	query->sortClause = lappend(query->sortClause, objectIdSortClause);
+
+	if (queryData->sortResumeKeyConst == NULL ||
+		IsPgbsonEmptyDocument(queryData->sortResumeKeyConst))
+	{
+		return true;
+	}
+
+	List *resumeValues = NIL;
+	bson_iter_t resumeKeyIter;
+	PgbsonInitIterator(queryData->sortResumeKeyConst, &resumeKeyIter);
+	if (bson_iter_find(&resumeKeyIter, "k") && BSON_ITER_HOLDS_ARRAY(&resumeKeyIter))
+	{
+		bson_iter_t keyIter;
+		bson_iter_recurse(&resumeKeyIter, &keyIter);
+		while (bson_iter_next(&keyIter))
+		{
+			resumeValues = lappend(resumeValues, MakeBsonConst(
+									   PgbsonInitFromDocumentBsonValue(
+										   bson_iter_value(&keyIter))));
+		}
+	}
+
+	if (list_length(resumeValues) != list_length(query->sortClause))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Sorted find resume key has %d keys, expected %d",
+							   list_length(resumeValues),
+							   list_length(query->sortClause))));
+	}
+
+	/*
+	 * The resume qual is the row comparison
+	 *   ROW(<k1 or r1>, ..., object_id) >= ROW(<r1 or k1>, ..., rid)
+	 * where the arguments of the descending keys are swapped so that every column
+	 * compares "after" as greater. The row comparison only uses the comparison
+	 * function of each sort operator family, so a family without a >= operator
+	 * (e.g. the >>> orderby family) is marked with its > operator.
+	 */
+	RowCompareExpr *resumeQual = makeNode(RowCompareExpr);
+	resumeQual->rctype = ROWCOMPARE_GE;
+
+	Expr *firstSortExpr = NULL;
+	Const *firstResumeValue = NULL;
+	ListCell *valueCell;
+	forboth(cell, query->sortClause, valueCell, resumeValues)
+	{
+		SortGroupClause *sortClause = lfirst(cell);
+		Expr *sortExpr = (Expr *) get_sortgroupclause_expr(sortClause,
+														   query->targetList);
+		Expr *resumeValue = lfirst(valueCell);
+
+		Oid opfamily = InvalidOid;
+		Oid opcintype = InvalidOid;
+		int16 strategy = 0;
+		if (!get_ordering_op_properties(sortClause->sortop, &opfamily, &opcintype,
+										&strategy))
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+							errmsg("Sort operator %u of a sorted find is not a btree "
+								   "ordering operator", sortClause->sortop)));
+		}
+
+		Oid compareOperator = get_opfamily_member(opfamily, opcintype, opcintype,
+												  BTGreaterEqualStrategyNumber);
+		if (!OidIsValid(compareOperator))
+		{
+			compareOperator = get_opfamily_member(opfamily, opcintype, opcintype,
+												  BTGreaterStrategyNumber);
+		}
+
+		bool isDescending = strategy == BTGreaterStrategyNumber;
+		resumeQual->opnos = lappend_oid(resumeQual->opnos, compareOperator);
+		resumeQual->opfamilies = lappend_oid(resumeQual->opfamilies, opfamily);
+		resumeQual->inputcollids = lappend_oid(resumeQual->inputcollids, InvalidOid);
+		resumeQual->largs = lappend(resumeQual->largs, isDescending ? resumeValue :
+									copyObject(sortExpr));
+		resumeQual->rargs = lappend(resumeQual->rargs, isDescending ?
+									copyObject(sortExpr) : resumeValue);
+
+		if (firstSortExpr == NULL)
+		{
+			firstSortExpr = sortExpr;
+			firstResumeValue = (Const *) resumeValue;
+		}
+	}
+
+	List *quals = query->jointree->quals != NULL ?
+				  make_ands_implicit((Expr *) query->jointree->quals) : NIL;
+
+	/*
+	 * The row comparison can't be an index scan key, so the ordered scan of the
+	 * first sort key seeks to its resume value instead.
+	 */
+	Expr *resumeSeekQual = CreateSortResumeSeekQual(firstSortExpr, firstResumeValue);
+	if (resumeSeekQual != NULL)
+	{
+		quals = ReplaceFullScanQualForSortPath(quals, (FuncExpr *) firstSortExpr,
+											   resumeSeekQual);
+	}
+
+	quals = lappend(quals, resumeQual);
+	query->jointree->quals = (Node *) make_ands_explicit(quals);
+
+	return true;
+}
+
+
+/*
+ * Creates the $range qual that an ordered index scan on the first sort key of a
+ * sorted streamable find uses to seek to the resume value of that key:
+ *   document @<> { "<path>": { "orderByScan": <dir>, "min" | "max": <value> } }
+ * The bound is not type bracketed, the orderByScan otherwise matches every document
+ * at runtime and the row comparison of the resume qual applies the resume key.
+ * Returns NULL if the sort key is not a path or its resume value has no seekable bound
+ * (null, missing, MinKey, MaxKey or an array).
+ */
+static Expr *
+CreateSortResumeSeekQual(Expr *sortExpr, Const *resumeValue)
+{
+	if (!IsA(sortExpr, FuncExpr) ||
+		((FuncExpr *) sortExpr)->funcid != BsonOrderByFunctionOid())
+	{
+		return NULL;
+	}
+
+	FuncExpr *sortFunc = (FuncExpr *) sortExpr;
+	Expr *documentExpr = linitial(sortFunc->args);
+	Expr *sortSpecExpr = lsecond(sortFunc->args);
+	if (!IsA(sortSpecExpr, Const) || ((Const *) sortSpecExpr)->constisnull)
+	{
+		return NULL;
+	}
+
+	pgbsonelement sortElement;
+	PgbsonToSinglePgbsonElement(DatumGetPgBson(((Const *) sortSpecExpr)->constvalue),
+								&sortElement);
+
+	pgbsonelement resumeElement;
+	PgbsonToSinglePgbsonElement(DatumGetPgBson(resumeValue->constvalue),
+								&resumeElement);
+	switch (resumeElement.bsonValue.value_type)
+	{
+		case BSON_TYPE_NULL:
+		case BSON_TYPE_UNDEFINED:
+		case BSON_TYPE_MINKEY:
+		case BSON_TYPE_MAXKEY:
+		case BSON_TYPE_ARRAY:
+		{
+			return NULL;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	int32_t sortDirection = BsonValueAsInt32(&sortElement.bsonValue);
+
+	pgbson_writer writer;
+	pgbson_writer rangeWriter;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterStartDocument(&writer, sortElement.path, sortElement.pathLength,
+							  &rangeWriter);
+	PgbsonWriterAppendInt32(&rangeWriter, "orderByScan", 11, sortDirection);
+	if (sortDirection > 0)
+	{
+		PgbsonWriterAppendValue(&rangeWriter, "min", 3, &resumeElement.bsonValue);
+		PgbsonWriterAppendBool(&rangeWriter, "minInclusive", 12, true);
+	}
+	else
+	{
+		PgbsonWriterAppendValue(&rangeWriter, "max", 3, &resumeElement.bsonValue);
+		PgbsonWriterAppendBool(&rangeWriter, "maxInclusive", 12, true);
+	}
+	PgbsonWriterEndDocument(&writer, &rangeWriter);
+
+	OpExpr *seekQual = (OpExpr *) make_opclause(BsonRangeMatchOperatorOid(), BOOLOID,
+												false, copyObject(documentExpr),
+												(Expr *) MakeBsonConst(
+													PgbsonWriterGetPgbson(&writer)),
+												InvalidOid, InvalidOid);
+	seekQual->opfuncid = BsonRangeMatchFunctionId();
+	return (Expr *) seekQual;
+}
+
+
+/*
+ * Replaces the full scan qual that lets an index order the sort on the path of
+ * sortFunc (see HandleSort) with the seek qual, or adds the seek qual if there is
+ * none.
+ */
+static List *
+ReplaceFullScanQualForSortPath(List *quals, FuncExpr *sortFunc, Expr *seekQual)
+{
+	Expr *sortSpecExpr = lsecond(sortFunc->args);
+
+	ListCell *cell;
+	foreach(cell, quals)
+	{
+		Expr *qual = lfirst(cell);
+		if (IsA(qual, FuncExpr) &&
+			((FuncExpr *) qual)->funcid == BsonFullScanFunctionOid() &&
+			equal(lsecond(((FuncExpr *) qual)->args), sortSpecExpr))
+		{
+			lfirst(cell) = seekQual;
+			return quals;
+		}
+	}
+
+	return lappend(quals, seekQual);
+}
+
+
 /*
  * This function adds the continuation condition to the query for change stream,
  * to make sure the continuation token is always returned to the caller event if
@@ -7371,6 +8022,14 @@ HandleSample(const bson_value_t *existingValue, Query *query,
 							"The size parameter provided to $sample must be a valid numeric value")));
 	}
 
+	/*
+	 * tsm_system_rows reads whole blocks, so rows of a block are sampled together.
+	 * Read more rows than requested so that the random order below picks the
+	 * sample out of more blocks.
+	 */
+	double blockSampleSize = Min(sizeDouble * SampleOversamplingFactor,
+								 (double) PG_INT64_MAX / 2);
+
 	/* If the sample is against the base RTE - convert to a sample CTE */
 	RangeTblEntry *rte = linitial(query->rtable);
 
@@ -7390,7 +8049,7 @@ HandleSample(const bson_value_t *existingValue, Query *query,
 
 			Const *constVal = (Const *) sampleArg;
 			int64_t finalSize = DatumGetInt64(constVal->constvalue);
-			finalSize = Min(finalSize, sizeDouble);
+			finalSize = Min(finalSize, blockSampleSize);
 			constVal->constvalue = Int64GetDatum(finalSize);
 		}
 		else
@@ -7400,8 +8059,8 @@ HandleSample(const bson_value_t *existingValue, Query *query,
 
 			Node *rowCountArg = (Node *) makeConst(INT8OID, -1, InvalidOid,
 												   sizeof(int64_t),
-												   Int64GetDatum(sizeDouble), false,
-												   true);
+												   Int64GetDatum(blockSampleSize),
+												   false, true);
 
 			tablesample_sys_rows->args = list_make1(rowCountArg);
 
@@ -8036,6 +8695,44 @@ TryOptimizeAggregationPipelines(List **aggregationStages,
 			}
 		}
 
+		else if (definition->stageEnum == Stage_ChangeStream &&
+				 EnableChangeStreamFilterPushdown &&
+				 stage->stageValue.value_type == BSON_TYPE_DOCUMENT)
+		{
+			/* Optimization for $changeStream stage
+			 * The $match stages directly following $changeStream are handed to the change stream
+			 * provider, so that it filters the events before they are serialized instead of
+			 * producing every event of the collection for the pipeline to discard.
+			 */
+			List *matchFilters = NIL;
+			ListCell *matchCell;
+			for_each_from(matchCell, stagesList, currentIndex + 1)
+			{
+				AggregationStage *nextStage = (AggregationStage *) lfirst(matchCell);
+				if (nextStage->stageDefinition->stageEnum != Stage_Match ||
+					nextStage->stageValue.value_type != BSON_TYPE_DOCUMENT)
+				{
+					break;
+				}
+
+				matchFilters = lappend(matchFilters, &nextStage->stageValue);
+			}
+
+			if (matchFilters != NIL)
+			{
+				stage->stageValue = MergeChangeStreamMatchFilters(&stage->stageValue,
+																  matchFilters);
+				for (int i = 0; i < list_length(matchFilters); i++)
+				{
+					stagesList = list_delete_nth_cell(stagesList, currentIndex + 1);
+				}
+
+				*aggregationStages = stagesList;
+				list_free(matchFilters);
+				break;
+			}
+		}
+
 		nextIndex = currentIndex + 1;
 	}
 
@@ -69,6 +69,33 @@ typedef struct BsonIntegralAndDerivativeAggState
 	bson_value_t anchorY;
 } BsonIntegralAndDerivativeAggState;
 
+/*
+ * Moving aggregate state for $integral and $derivative over sliding window frames.
+ * The points of the current frame are extracted once into the xValues/yValues buffers
+ * (dates are already converted to double) so that rows leaving the head of the frame
+ * can be removed without recomputing the frame from scratch.
+ */
+typedef struct BsonIntegralAndDerivativeMovingAggState
+{
+	/* The running integral of the frame, unused for $derivative */
+	bson_value_t result;
+
+	/* The points of the frame: [head, head + count) are valid */
+	bson_value_t *xValues;
+	bson_value_t *yValues;
+	int head;
+	int count;
+	int capacity;
+
+	/* number of decimal points in the frame, used to determine if we need to return decimal128 value */
+	int decimalCount;
+
+	/* The unit of the sortBy field in ms, 0 if not specified */
+	long timeUnitInMs;
+
+	bool isIntegral;
+} BsonIntegralAndDerivativeMovingAggState;
+
 /*
  * ArithmeticOperation is used to determine which operation to perform.
  * The operations are:
@@ -131,6 +158,11 @@ static void CalculateExpMovingAvg(bson_value_t *currentValue, bson_value_t *perV
 								  bson_value_t *weightValue, bool isAlpha,
 								  bson_value_t *resultValue);
 static MaxAlignedVarlena * AllocateBsonIntegralAndDerivativeAggState(void);
+static Datum BsonIntegralDerivativeMovingTransitionCore(PG_FUNCTION_ARGS,
+														bool isIntegral);
+static void AppendIntegralDerivativeMovingPoint(
+	BsonIntegralAndDerivativeMovingAggState *currentState, const bson_value_t *xValue,
+	const bson_value_t *yValue);
 
 static void HandleIntegralDerivative(bson_value_t *xBsonValue, bson_value_t *yBsonValue,
 									 long timeUnitInMs,
@@ -179,6 +211,10 @@ PG_FUNCTION_INFO_V1(bson_integral_derivative_final);
 PG_FUNCTION_INFO_V1(bson_std_dev_pop_samp_winfunc_invtransition);
 PG_FUNCTION_INFO_V1(bson_std_dev_pop_winfunc_final);
 PG_FUNCTION_INFO_V1(bson_std_dev_samp_winfunc_final);
+PG_FUNCTION_INFO_V1(bson_integral_moving_transition);
+PG_FUNCTION_INFO_V1(bson_derivative_moving_transition);
+PG_FUNCTION_INFO_V1(bson_integral_derivative_minvtransition);
+PG_FUNCTION_INFO_V1(bson_integral_derivative_moving_final);
 
 /*
  * Transition function for the BSONCOVARIANCEPOP and BSONCOVARIANCESAMP aggregate.
@@ -1319,6 +1355,175 @@ bson_std_dev_pop_samp_winfunc_invtransition(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * Moving transition function for the BSON_INTEGRAL aggregate over sliding frames.
+ * Appends the point to the frame buffer and adds the trapezoid between the
+ * previous last point and the new point to the running integral.
+ */
+Datum
+bson_integral_moving_transition(PG_FUNCTION_ARGS)
+{
+	return BsonIntegralDerivativeMovingTransitionCore(fcinfo, true);
+}
+
+
+/*
+ * Moving transition function for the BSON_DERIVATIVE aggregate over sliding frames.
+ * Appends the point to the frame buffer, the derivative is computed from the
+ * first and the last point of the frame in the final function.
+ */
+Datum
+bson_derivative_moving_transition(PG_FUNCTION_ARGS)
+{
+	return BsonIntegralDerivativeMovingTransitionCore(fcinfo, false);
+}
+
+
+/*
+ * Inverse transition function for the BSON_INTEGRAL and BSON_DERIVATIVE aggregates.
+ * Removes the first point of the frame, for $integral the trapezoid between the
+ * removed point and the new first point is subtracted from the running integral.
+ */
+Datum
+bson_integral_derivative_minvtransition(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggregateContext;
+	if (AggCheckCallContext(fcinfo, &aggregateContext) != AGG_CONTEXT_WINDOW)
+	{
+		ereport(ERROR, errmsg(
+					"window aggregate function called in non-window-aggregate context"));
+	}
+
+	if (PG_ARGISNULL(0))
+	{
+		/* Returning NULL is an indication that inverse can't be applied and the aggregation needs to be redone */
+		PG_RETURN_NULL();
+	}
+
+	MaxAlignedVarlena *bytes = GetMaxAlignedVarlena(PG_GETARG_BYTEA_P(0));
+	BsonIntegralAndDerivativeMovingAggState *currentState =
+		(BsonIntegralAndDerivativeMovingAggState *) bytes->state;
+
+	pgbson *xValue = PG_GETARG_MAYBE_NULL_PGBSON(1);
+	pgbson *yValue = PG_GETARG_MAYBE_NULL_PGBSON(2);
+	if (IsPgbsonEmptyDocument(xValue) || IsPgbsonEmptyDocument(yValue))
+	{
+		/* The row was skipped by the transition function */
+		PG_RETURN_POINTER(bytes);
+	}
+
+	if (currentState->count == 0)
+	{
+		PG_RETURN_NULL();
+	}
+
+	/*
+	 * Inverse function is called in sequence in which the rows are added using the transition
+	 * function, so the row leaving the frame is always the first point of the buffer.
+	 */
+	int head = currentState->head;
+	if (currentState->isIntegral && currentState->count > 1)
+	{
+		BsonIntegralAndDerivativeAggState pairState = {
+			.result = { .value_type = BSON_TYPE_DOUBLE, .value.v_double = 0.0 },
+			.anchorX = currentState->xValues[head],
+			.anchorY = currentState->yValues[head]
+		};
+		HandleIntegralDerivative(&currentState->xValues[head + 1],
+								 &currentState->yValues[head + 1],
+								 currentState->timeUnitInMs, &pairState, true);
+
+		bool overflowedFromInt64 = false;
+		if (!SubtractNumberFromBsonValue(&currentState->result, &pairState.result,
+										 &overflowedFromInt64))
+		{
+			PG_RETURN_NULL();
+		}
+	}
+
+	if (currentState->xValues[head].value_type == BSON_TYPE_DECIMAL128 ||
+		currentState->yValues[head].value_type == BSON_TYPE_DECIMAL128)
+	{
+		currentState->decimalCount--;
+	}
+
+	currentState->head++;
+	currentState->count--;
+
+	if (currentState->count <= 1)
+	{
+		/* The integral of a single point is 0, reset it to not carry rounding errors */
+		currentState->result.value_type = BSON_TYPE_DOUBLE;
+		currentState->result.value.v_double = 0.0;
+	}
+	else if (IsBsonValueNaN(&currentState->result) ||
+			 IsBsonValueInfinity(&currentState->result))
+	{
+		/* restart aggregate if NaN or Infinity in current state */
+		PG_RETURN_NULL();
+	}
+
+	PG_RETURN_POINTER(bytes);
+}
+
+
+/*
+ * Moving final function for the BSON_INTEGRAL and BSON_DERIVATIVE aggregates.
+ * This takes the frame buffer and outputs a bson "integral" or "derivative"
+ * with the appropriate type.
+ */
+Datum
+bson_integral_derivative_moving_final(PG_FUNCTION_ARGS)
+{
+	MaxAlignedVarlena *bytes =
+		PG_ARGISNULL(0) ? NULL : GetMaxAlignedVarlena(PG_GETARG_BYTEA_P(0));
+	pgbsonelement finalValue;
+	finalValue.path = "";
+	finalValue.pathLength = 0;
+	finalValue.bsonValue.value_type = BSON_TYPE_NULL;
+
+	if (bytes == NULL)
+	{
+		PG_RETURN_POINTER(PgbsonElementToPgbson(&finalValue));
+	}
+
+	BsonIntegralAndDerivativeMovingAggState *currentState =
+		(BsonIntegralAndDerivativeMovingAggState *) bytes->state;
+	if (currentState->isIntegral)
+	{
+		if (currentState->count > 0)
+		{
+			finalValue.bsonValue = currentState->result;
+
+			/* the decimal points that promoted the result have all left the frame */
+			if (currentState->decimalCount == 0 &&
+				finalValue.bsonValue.value_type == BSON_TYPE_DECIMAL128)
+			{
+				finalValue.bsonValue.value_type = BSON_TYPE_DOUBLE;
+				finalValue.bsonValue.value.v_double =
+					BsonValueAsDouble(&currentState->result);
+			}
+		}
+	}
+	else if (currentState->count > 1)
+	{
+		int head = currentState->head;
+		int last = head + currentState->count - 1;
+		BsonIntegralAndDerivativeAggState pairState = {
+			.result = { .value_type = BSON_TYPE_NULL },
+			.anchorX = currentState->xValues[head],
+			.anchorY = currentState->yValues[head]
+		};
+		HandleIntegralDerivative(&currentState->xValues[last],
+								 &currentState->yValues[last],
+								 currentState->timeUnitInMs, &pairState, false);
+		finalValue.bsonValue = pairState.result;
+	}
+
+	PG_RETURN_POINTER(PgbsonElementToPgbson(&finalValue));
+}
+
+
 /* --------------------------------------------------------- */
 /* Private helper methods */
 /* --------------------------------------------------------- */
@@ -1342,6 +1547,145 @@ AllocateBsonIntegralAndDerivativeAggState()
 }
 
 
+/*
+ * Core of the moving transition functions of BSON_INTEGRAL and BSON_DERIVATIVE.
+ */
+static Datum
+BsonIntegralDerivativeMovingTransitionCore(PG_FUNCTION_ARGS, bool isIntegral)
+{
+	MemoryContext aggregateContext;
+	if (AggCheckCallContext(fcinfo, &aggregateContext) != AGG_CONTEXT_WINDOW)
+	{
+		ereport(ERROR, errmsg(
+					"window aggregate function called in non-window-aggregate context"));
+	}
+
+	pgbson *xValue = PG_GETARG_MAYBE_NULL_PGBSON(1);
+	pgbson *yValue = PG_GETARG_MAYBE_NULL_PGBSON(2);
+	long timeUnitInt64 = PG_GETARG_INT64(3);
+	if (IsPgbsonEmptyDocument(xValue) || IsPgbsonEmptyDocument(yValue))
+	{
+		/* Skip the row, the inverse transition skips it the same way */
+		if (PG_ARGISNULL(0))
+		{
+			PG_RETURN_NULL();
+		}
+
+		PG_RETURN_POINTER(GetMaxAlignedVarlena(PG_GETARG_BYTEA_P(0)));
+	}
+
+	pgbsonelement xValueElement, yValueElement;
+	PgbsonToSinglePgbsonElement(xValue, &xValueElement);
+	PgbsonToSinglePgbsonElement(yValue, &yValueElement);
+	RunTimeCheckForIntegralAndDerivative(&xValueElement.bsonValue,
+										 &yValueElement.bsonValue, timeUnitInt64,
+										 isIntegral);
+
+	MaxAlignedVarlena *bytes;
+	BsonIntegralAndDerivativeMovingAggState *currentState;
+	if (PG_ARGISNULL(0))
+	{
+		/* Create the aggregate state in the aggregate context. */
+		MemoryContext oldContext = MemoryContextSwitchTo(aggregateContext);
+
+		bytes = AllocateZeroedMaxAlignedVarlena(
+			sizeof(BsonIntegralAndDerivativeMovingAggState));
+		currentState = (BsonIntegralAndDerivativeMovingAggState *) bytes->state;
+		currentState->result.value_type = BSON_TYPE_DOUBLE;
+		currentState->result.value.v_double = 0.0;
+		currentState->capacity = 16;
+		currentState->xValues = palloc(sizeof(bson_value_t) * currentState->capacity);
+		currentState->yValues = palloc(sizeof(bson_value_t) * currentState->capacity);
+		currentState->timeUnitInMs = timeUnitInt64;
+		currentState->isIntegral = isIntegral;
+
+		MemoryContextSwitchTo(oldContext);
+	}
+	else
+	{
+		bytes = GetMaxAlignedVarlena(PG_GETARG_BYTEA_P(0));
+		currentState = (BsonIntegralAndDerivativeMovingAggState *) bytes->state;
+	}
+
+	if (isIntegral && currentState->count > 0)
+	{
+		int last = currentState->head + currentState->count - 1;
+		BsonIntegralAndDerivativeAggState pairState = {
+			.result = currentState->result,
+			.anchorX = currentState->xValues[last],
+			.anchorY = currentState->yValues[last]
+		};
+		HandleIntegralDerivative(&xValueElement.bsonValue, &yValueElement.bsonValue,
+								 timeUnitInt64, &pairState, isIntegral);
+		currentState->result = pairState.result;
+	}
+
+	/* if xValue is a date, convert it to double, same as the anchor points */
+	bson_value_t pointX = xValueElement.bsonValue;
+	if (pointX.value_type == BSON_TYPE_DATE_TIME)
+	{
+		pointX.value_type = BSON_TYPE_DOUBLE;
+		pointX.value.v_double = BsonValueAsDouble(&xValueElement.bsonValue);
+	}
+
+	bson_value_t pointY = yValueElement.bsonValue;
+	if (!isIntegral && pointY.value_type == BSON_TYPE_DATE_TIME)
+	{
+		pointY.value_type = BSON_TYPE_DOUBLE;
+		pointY.value.v_double = BsonValueAsDouble(&yValueElement.bsonValue);
+	}
+
+	AppendIntegralDerivativeMovingPoint(currentState, &pointX, &pointY);
+	PG_RETURN_POINTER(bytes);
+}
+
+
+/*
+ * Appends a point at the end of the frame buffer, compacting or growing the
+ * buffer when the end is reached.
+ */
+static void
+AppendIntegralDerivativeMovingPoint(BsonIntegralAndDerivativeMovingAggState *currentState,
+									const bson_value_t *xValue,
+									const bson_value_t *yValue)
+{
+	if (currentState->head + currentState->count == currentState->capacity)
+	{
+		if (currentState->head >= currentState->capacity / 2)
+		{
+			/* More than half of the buffer has left the frame, move the frame to the front */
+			memmove(currentState->xValues, &currentState->xValues[currentState->head],
+					sizeof(bson_value_t) * currentState->count);
+			memmove(currentState->yValues, &currentState->yValues[currentState->head],
+					sizeof(bson_value_t) * currentState->count);
+			currentState->head = 0;
+		}
+		else
+		{
+			/* repalloc allocates in the context of the buffer i.e. the aggregate context */
+			currentState->capacity *= 2;
+			currentState->xValues = repalloc(currentState->xValues,
+											 sizeof(bson_value_t) *
+											 currentState->capacity);
+			currentState->yValues = repalloc(currentState->yValues,
+											 sizeof(bson_value_t) *
+											 currentState->capacity);
+		}
+	}
+
+	int index = currentState->head + currentState->count;
+	currentState->xValues[index] = *xValue;
+	currentState->yValues[index] = *yValue;
+	currentState->count++;
+
+	if (xValue->value_type == BSON_TYPE_DECIMAL128 ||
+		yValue->value_type == BSON_TYPE_DECIMAL128)
+	{
+		currentState->decimalCount++;
+	}
+}
+
+
 /*
  * Function to calculate variance/covariance state for inverse function.
  * If calculating variance, we use X and Y as the same value.
@@ -27,6 +27,7 @@
 #include <parser/analyze.h>
 #include <parser/parse_oper.h>
 #include <parser/parsetree.h>
+#include <tcop/tcopprot.h>
 #include <utils/builtins.h>
 #include <utils/rel.h>
 #include <utils/lsyscache.h>
@@ -84,6 +85,15 @@ static bool IsPgvectorIterativeScanAvailable();
 
 static pgbson * SetIterativeScanToSearchParam(pgbson *searchParamPgbson);
 
+static Query * HandleBatchedVectorSearch(Query *query, pgbson *vectorSearchSpecPgbson,
+										 const bson_value_t *queryVectors,
+										 AggregationPipelineBuildContext *context);
+static Query * GroupVectorSearchResults(Query *query, int queryIndex,
+										AggregationPipelineBuildContext *context);
+
+static void ChooseAdaptivePreFilterStrategy(VectorSearchOptions *vectorSearchOptions,
+											AggregationPipelineBuildContext *context);
+
 static char * GetVectorIterativeScanModeName(VectorIterativeScanMode iterativeScanMode);
 
 static void AddSearchParamFunctionToQuery(Query *query,
@@ -153,7 +163,8 @@ static Query * ReorderResultsForFilter(Query *joinQuery,
 
 static Query * ReorderResultsForCompression(Query *joinQuery,
 											AggregationPipelineBuildContext *context,
-											Expr *scoreExpr);
+											Expr *scoreExpr,
+											VectorIndexDistanceMetric distanceMetric);
 
 static Node * ReplaceDocumentVarOnSort(Node *input,
 									   ReplaceDocumentVarOnSortContext *context);
@@ -292,6 +303,14 @@ HandleSearch(const bson_value_t *existingValue, Query *query,
 
 	if (searchSpecType == VectorSearchSpecType_CosmosSearch)
 	{
+		bson_iter_t vectorsIter;
+		if (EnableVectorSearchBatchedQueries &&
+			PgbsonInitIteratorAtPath(vectorSearchSpecPgbson, "vectors", &vectorsIter))
+		{
+			return HandleBatchedVectorSearch(query, vectorSearchSpecPgbson,
+											 bson_iter_value(&vectorsIter), context);
+		}
+
 		ParseAndValidateCosmosSearchQuerySpec(vectorSearchSpecPgbson,
 											  &vectorSearchOptions);
 	}
@@ -389,6 +408,337 @@ SetIterativeScanToSearchParam(pgbson *searchParamPgbson)
 }
 
 
+/*
+ * Handles a cosmosSearch with a list of query vectors ("vectors") instead of
+ * a single "vector". Each query vector is searched with the rest of the spec
+ * and its results are grouped into one document per query vector:
+ *   { "results": [ <top k documents> ], "queryIndex": <position in vectors> }
+ * The searches are combined with UNION ALL so that the batch takes a single
+ * round trip and a single plan.
+ */
+static Query *
+HandleBatchedVectorSearch(Query *query, pgbson *vectorSearchSpecPgbson,
+						  const bson_value_t *queryVectors,
+						  AggregationPipelineBuildContext *context)
+{
+	ReportFeatureUsage(FEATURE_STAGE_SEARCH_VECTOR_BATCHED);
+	EnsureTopLevelFieldValueType("vectors", queryVectors, BSON_TYPE_ARRAY);
+
+	bson_iter_t specIter;
+	PgbsonInitIterator(vectorSearchSpecPgbson, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		if (strcmp(bson_iter_key(&specIter), "vector") == 0)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+							errmsg(
+								"Only one of $vector and $vectors can be specified.")));
+		}
+	}
+
+	Query *modifiedQuery = makeNode(Query);
+	modifiedQuery->commandType = CMD_SELECT;
+	modifiedQuery->querySource = query->querySource;
+	modifiedQuery->canSetTag = true;
+	modifiedQuery->jointree = makeNode(FromExpr);
+
+	int baseNestedLevels = context->numNestedLevels;
+	int maxNestedLevels = baseNestedLevels;
+	List *rangeTableReferences = NIL;
+	Query *firstBranchQuery = NULL;
+
+	bson_iter_t vectorsIter;
+	BsonValueInitIterator(queryVectors, &vectorsIter);
+	int queryIndex = 0;
+	while (bson_iter_next(&vectorsIter))
+	{
+		if (queryIndex >= VECTOR_SEARCH_MAX_BATCHED_VECTORS)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+							errmsg("$vectors cannot have more than %d query vectors.",
+								   VECTOR_SEARCH_MAX_BATCHED_VECTORS)));
+		}
+
+		/* The spec of this query vector: the shared options with "vector" */
+		pgbson_writer specWriter;
+		PgbsonWriterInit(&specWriter);
+		PgbsonInitIterator(vectorSearchSpecPgbson, &specIter);
+		while (bson_iter_next(&specIter))
+		{
+			if (strcmp(bson_iter_key(&specIter), "vectors") != 0)
+			{
+				PgbsonWriterAppendValue(&specWriter, bson_iter_key(&specIter),
+										bson_iter_key_len(&specIter),
+										bson_iter_value(&specIter));
+			}
+		}
+
+		PgbsonWriterAppendValue(&specWriter, "vector", 6,
+								bson_iter_value(&vectorsIter));
+
+		VectorSearchOptions vectorSearchOptions = { 0 };
+		vectorSearchOptions.searchSpecPgbson = PgbsonWriterGetPgbson(&specWriter);
+		vectorSearchOptions.resultCount = -1;
+		vectorSearchOptions.queryVectorLength = -1;
+		ParseAndValidateCosmosSearchQuerySpec(vectorSearchOptions.searchSpecPgbson,
+											  &vectorSearchOptions);
+
+		context->numNestedLevels = baseNestedLevels;
+		Query *branchQuery = HandleVectorSearchCore(copyObject(query),
+													&vectorSearchOptions, context);
+		branchQuery = GroupVectorSearchResults(branchQuery, queryIndex, context);
+		maxNestedLevels = Max(maxNestedLevels, context->numNestedLevels);
+
+		bool includeAllColumns = true;
+		RangeTblEntry *branchRte = MakeSubQueryRte(branchQuery, queryIndex, 0,
+												   "vectorSearchBatch",
+												   includeAllColumns);
+		modifiedQuery->rtable = lappend(modifiedQuery->rtable, branchRte);
+
+		RangeTblRef *branchReference = makeNode(RangeTblRef);
+		branchReference->rtindex = list_length(modifiedQuery->rtable);
+		rangeTableReferences = lappend(rangeTableReferences, branchReference);
+
+		if (firstBranchQuery == NULL)
+		{
+			firstBranchQuery = branchQuery;
+		}
+
+		queryIndex++;
+	}
+
+	if (queryIndex == 0)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg("$vectors cannot be an empty array.")));
+	}
+
+	context->numNestedLevels = maxNestedLevels;
+
+	/* Build the UNION ALL of the (document, queryIndex) of each query vector */
+	Node *setOperations = linitial(rangeTableReferences);
+	for (int i = 1; i < list_length(rangeTableReferences); i++)
+	{
+		SetOperationStmt *setOpStatement = makeNode(SetOperationStmt);
+		setOpStatement->all = true;
+		setOpStatement->op = SETOP_UNION;
+		setOpStatement->colCollations = list_make2_oid(InvalidOid, InvalidOid);
+		setOpStatement->colTypes = list_make2_oid(BsonTypeId(), INT4OID);
+		setOpStatement->colTypmods = list_make2_int(-1, -1);
+		setOpStatement->larg = setOperations;
+		setOpStatement->rarg = list_nth(rangeTableReferences, i);
+		setOperations = (Node *) setOpStatement;
+	}
+
+	if (IsA(setOperations, RangeTblRef))
+	{
+		/* A single query vector, just select from its query */
+		modifiedQuery->jointree->fromlist = list_make1(setOperations);
+	}
+	else
+	{
+		modifiedQuery->setOperations = setOperations;
+	}
+
+	TargetEntry *documentEntry = linitial(firstBranchQuery->targetList);
+	TargetEntry *queryIndexEntry = lsecond(firstBranchQuery->targetList);
+	Var *documentVar = makeVar(1, documentEntry->resno, BsonTypeId(), -1,
+							   InvalidOid, 0);
+	Var *queryIndexVar = makeVar(1, queryIndexEntry->resno, INT4OID, -1,
+								 InvalidOid, 0);
+	modifiedQuery->targetList = list_make2(
+		makeTargetEntry((Expr *) documentVar, 1, documentEntry->resname, false),
+		makeTargetEntry((Expr *) queryIndexVar, 2, queryIndexEntry->resname, false));
+
+	/* Return the groups in the order of the query vectors */
+	context->expandTargetList = true;
+	Query *wrapperQuery = MigrateQueryToSubQuery(modifiedQuery, context);
+
+	ParseState *parseState = make_parsestate(NULL);
+	parseState->p_expr_kind = EXPR_KIND_ORDER_BY;
+
+	SortBy *sortBy = makeNode(SortBy);
+	sortBy->location = -1;
+	sortBy->sortby_dir = SORTBY_ASC;
+	sortBy->node = (Node *) makeVar(1, 2, INT4OID, -1, InvalidOid, 0);
+
+	/* Only the document is returned, the query index is just for ordering */
+	bool resjunk = true;
+	TargetEntry *sortEntry = makeTargetEntry((Expr *) sortBy->node, 2,
+											 pstrdup("queryIndexValue"), resjunk);
+	wrapperQuery->targetList = list_make2(linitial(wrapperQuery->targetList),
+										  sortEntry);
+	parseState->p_next_resno = 3;
+	wrapperQuery->sortClause = addTargetToSortList(parseState, sortEntry, NIL,
+												   wrapperQuery->targetList, sortBy);
+	pfree(parseState);
+
+	/* Push next stage to a new subquery (since we did a sort) */
+	context->requiresSubQueryAfterProject = true;
+	return wrapperQuery;
+}
+
+
+/*
+ * Groups the results of the vector search of one query vector into a single
+ * { "results": [ ... ], "queryIndex": queryIndex } document, and projects the
+ * queryIndex as a second column to order the groups by.
+ */
+static Query *
+GroupVectorSearchResults(Query *query, int queryIndex,
+						 AggregationPipelineBuildContext *context)
+{
+	Query *groupQuery = MigrateQueryToSubQuery(query, context);
+	TargetEntry *documentEntry = linitial(groupQuery->targetList);
+
+	ParseState *parseState = make_parsestate(NULL);
+	parseState->p_expr_kind = EXPR_KIND_SELECT_TARGET;
+	parseState->p_next_resno = 1;
+
+	List *aggregateArgs = list_make2(documentEntry->expr,
+									 MakeTextConst("results", 7));
+	List *argTypesList = list_make2_oid(BsonTypeId(), TEXTOID);
+	Aggref *aggref = CreateMultiArgAggregate(BsonArrayAggregateFunctionOid(),
+											 aggregateArgs, argTypesList, parseState);
+	pfree(parseState);
+
+	/* A query vector without results gets an empty list */
+	pgbson_writer emptyResultsWriter;
+	PgbsonWriterInit(&emptyResultsWriter);
+	PgbsonWriterAppendEmptyArray(&emptyResultsWriter, "results", 7);
+
+	CoalesceExpr *resultsExpr = makeNode(CoalesceExpr);
+	resultsExpr->coalescetype = BsonTypeId();
+	resultsExpr->coalescecollid = InvalidOid;
+	resultsExpr->args = list_make2(aggref, MakeBsonConst(PgbsonWriterGetPgbson(
+															 &emptyResultsWriter)));
+	resultsExpr->location = -1;
+
+	pgbson_writer queryIndexWriter;
+	PgbsonWriterInit(&queryIndexWriter);
+	PgbsonWriterAppendInt32(&queryIndexWriter, "queryIndex", 10, queryIndex);
+
+	documentEntry->expr = (Expr *) makeFuncExpr(
+		BsonDollarAddFieldsFunctionOid(), BsonTypeId(),
+		list_make2(resultsExpr, MakeBsonConst(PgbsonWriterGetPgbson(
+												  &queryIndexWriter))),
+		InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+	Const *queryIndexConst = makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+									   Int32GetDatum(queryIndex), false, true);
+	groupQuery->targetList = list_make2(documentEntry,
+										makeTargetEntry((Expr *) queryIndexConst, 2,
+														"queryIndex", false));
+	groupQuery->hasAggs = true;
+	return groupQuery;
+}
+
+
+/*
+ * Chooses how a filtered vector search runs based on the planner's estimate
+ * of the number of documents that match the filter:
+ *  - exact: few documents match, so scoring all of them (filter index scan +
+ *    sort) is cheaper and has full recall compared to walking the vector index.
+ *  - iterative: the vector index is scanned iteratively. For hnsw efSearch is
+ *    widened by the inverse of the filter selectivity so that the first
+ *    iteration is likely to keep k documents after the filter.
+ * The chosen strategy is written to the search params so that it shows in
+ * the explain output of the vector search.
+ */
+static void
+ChooseAdaptivePreFilterStrategy(VectorSearchOptions *vectorSearchOptions,
+								AggregationPipelineBuildContext *context)
+{
+	/*
+	 * The estimate is planned against the local shard when there is one: the
+	 * shell table of a distributed collection has no statistics. A copy of the
+	 * context is used so that the search query itself is not affected.
+	 */
+	AggregationPipelineBuildContext estimateContext = *context;
+	estimateContext.allowShardBaseTable = true;
+
+	pg_uuid_t *collectionUuid = NULL;
+	const bson_value_t *indexHint = NULL;
+	Query *filterQuery = GenerateBaseTableQuery(context->databaseNameDatum,
+												&context->collectionNameView,
+												collectionUuid,
+												indexHint,
+												&estimateContext);
+	RangeTblEntry *rte = linitial(filterQuery->rtable);
+	if (rte->rtekind != RTE_RELATION)
+	{
+		return;
+	}
+
+	Relation collectionRelation = RelationIdGetRelation(rte->relid);
+	double totalRows = collectionRelation->rd_rel->reltuples;
+	RelationClose(collectionRelation);
+
+	if (totalRows <= 0)
+	{
+		/* Never analyzed, or a remote shard (shell table) of a distributed collection */
+		return;
+	}
+
+	filterQuery = AddFilterToQuery(filterQuery, &estimateContext, vectorSearchOptions);
+
+	int cursorOptions = 0;
+	PlannedStmt *filterPlan = pg_plan_query(filterQuery, NULL, cursorOptions, NULL);
+	double filteredRows = filterPlan->planTree->plan_rows;
+
+	const char *strategy = "iterative";
+	if (filteredRows <= VectorPreFilterExactSearchMaxRows &&
+		vectorSearchOptions->oversampling <= 1)
+	{
+		vectorSearchOptions->exactSearch = true;
+		strategy = "exact";
+	}
+
+	elog(DEBUG1, "Vector search filter is estimated to match %.0f of %.0f documents, "
+				 "using %s search", filteredRows, totalRows, strategy);
+
+	if (vectorSearchOptions->exactSearch)
+	{
+		return;
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+
+	bson_iter_t searchParamIter;
+	bool isHnsw = strcmp(vectorSearchOptions->vectorIndexDef->indexAccessMethodName,
+						 "hnsw") == 0;
+	if (isHnsw && totalRows >= VECTOR_SEARCH_SMALL_COLLECTION_ROWS &&
+		(vectorSearchOptions->searchParamPgbson == NULL ||
+		 (!PgbsonInitIteratorAtPath(vectorSearchOptions->searchParamPgbson,
+									VECTOR_PARAMETER_NAME_HNSW_EF_SEARCH,
+									&searchParamIter) &&
+		  !PgbsonInitIteratorAtPath(vectorSearchOptions->searchParamPgbson,
+									VECTOR_PARAMETER_NAME_TARGET_RECALL,
+									&searchParamIter))))
+	{
+		double selectivity = Max(filteredRows, 1) / totalRows;
+		double efSearch = ceil(vectorSearchOptions->resultCount / selectivity);
+		if (efSearch > HNSW_DEFAULT_EF_SEARCH)
+		{
+			PgbsonWriterAppendInt32(&writer, VECTOR_PARAMETER_NAME_HNSW_EF_SEARCH,
+									VECTOR_PARAMETER_NAME_HNSW_EF_SEARCH_STR_LEN,
+									(int32_t) Min(efSearch, HNSW_MAX_EF_SEARCH));
+		}
+	}
+
+	if (vectorSearchOptions->searchParamPgbson != NULL)
+	{
+		PgbsonWriterConcat(&writer, vectorSearchOptions->searchParamPgbson);
+	}
+
+	PgbsonWriterAppendUtf8(&writer, VECTOR_PARAMETER_NAME_PRE_FILTER_STRATEGY,
+						   VECTOR_PARAMETER_NAME_PRE_FILTER_STRATEGY_STR_LEN,
+						   strategy);
+	vectorSearchOptions->searchParamPgbson = PgbsonWriterGetPgbson(&writer);
+}
+
+
 static char *
 GetVectorIterativeScanModeName(VectorIterativeScanMode iterativeScanMode)
 {
@@ -897,11 +1247,28 @@ ReorderResultsForFilter(Query *joinQuery, AggregationPipelineBuildContext *conte
 
 /*
  * Adds a wrapper select query to the query and re-order by the full-vector distance.
+ *
+ * The score field added to the documents uses the same full-vector distance, so
+ * when the document still carries it, the score is moved to the wrapper query
+ * and computed from the distance column. This way the full vectors are extracted
+ * and compared once per candidate instead of twice.
  */
 static Query *
 ReorderResultsForCompression(Query *query, AggregationPipelineBuildContext *context,
-							 Expr *fullScoreExpr)
+							 Expr *fullScoreExpr, VectorIndexDistanceMetric distanceMetric)
 {
+	TargetEntry *documentEntry = linitial(query->targetList);
+	bool addScoreOnWrapper = false;
+	if (EnableVectorCompressionSingleRerankDistance &&
+		IsA(documentEntry->expr, FuncExpr) &&
+		((FuncExpr *) documentEntry->expr)->funcid ==
+		ApiBsonDocumentAddScoreFieldFunctionId())
+	{
+		FuncExpr *addScoreExpr = (FuncExpr *) documentEntry->expr;
+		documentEntry->expr = linitial(addScoreExpr->args);
+		addScoreOnWrapper = true;
+	}
+
 	TargetEntry *scoreEntry = makeTargetEntry(fullScoreExpr, 2, "fullScoreVal", false);
 	query->targetList = lappend(query->targetList, scoreEntry);
 
@@ -943,6 +1310,17 @@ ReorderResultsForCompression(Query *query, AggregationPipelineBuildContext *cont
 	pfree(parseState);
 	wrapperQuery->sortClause = sortlist;
 
+	if (addScoreOnWrapper)
+	{
+		TargetEntry *wrapperDocumentEntry = linitial(wrapperQuery->targetList);
+		Expr *scoreExpr = GenerateScoreExpr((Expr *) copyObject(orderVar),
+											distanceMetric);
+		List *args = list_make2(wrapperDocumentEntry->expr, scoreExpr);
+		wrapperDocumentEntry->expr = (Expr *) makeFuncExpr(
+			ApiBsonDocumentAddScoreFieldFunctionId(), BsonTypeId(), args, InvalidOid,
+			InvalidOid, COERCE_EXPLICIT_CALL);
+	}
+
 	return wrapperQuery;
 }
 
@@ -1368,6 +1746,13 @@ ParseAndValidateNativeVectorSearchSpec(const bson_value_t *nativeVectorSearchSpe
 									value->value.v_int32);
 			vectorSearchOptions->resultCount = BsonValueAsInt32(value);
 		}
+		else if (strcmp(key, VECTOR_PARAMETER_NAME_TARGET_RECALL) == 0)
+		{
+			/* Validated by the index specific search spec parsing */
+			PgbsonWriterAppendValue(&writer, VECTOR_PARAMETER_NAME_TARGET_RECALL,
+									VECTOR_PARAMETER_NAME_TARGET_RECALL_STR_LEN,
+									value);
+		}
 		else if (strcmp(key, "index") == 0)
 		{
 			/* Specifying index is not yet supported*/
@@ -1552,6 +1937,15 @@ HandleVectorSearchCore(Query *query, VectorSearchOptions *vectorSearchOptions,
 	/* Parse and validate the index specific options */
 	ParseAndValidateIndexSpecificOptions(vectorSearchOptions);
 
+	/* Pick exact or iterative search for the pre-filter from its estimated selectivity */
+	if (EnableVectorAdaptivePreFilter && EnableVectorPreFilter &&
+		!EnableVectorPreFilterV2 && !vectorSearchOptions->exactSearch &&
+		vectorSearchOptions->filterBson.value_type != BSON_TYPE_EOD &&
+		!IsBsonValueEmptyDocument(&vectorSearchOptions->filterBson))
+	{
+		ChooseAdaptivePreFilterStrategy(vectorSearchOptions, context);
+	}
+
 	/* Add the search param wrapper function to the query */
 	/* Create the WHERE bson_search_param(document, searchParamPgbson) and add it to the WHERE */
 	if (!vectorSearchOptions->exactSearch)
@@ -1704,7 +2098,8 @@ HandleVectorSearchCore(Query *query, VectorSearchOptions *vectorSearchOptions,
 	{
 		/* reorder the results by the full vector distance */
 		/* Exact search doesn't need to reorder */
-		query = ReorderResultsForCompression(query, context, sortExpr);
+		query = ReorderResultsForCompression(query, context, sortExpr,
+											 vectorSearchOptions->distanceMetric);
 	}
 
 	/* Add k limit to the top level query if oversampling is specified */
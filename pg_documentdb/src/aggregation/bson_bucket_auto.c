@@ -12,6 +12,7 @@
 #include <nodes/execnodes.h>
 #include <parser/parse_clause.h>
 #include <parser/parse_node.h>
+#include <utils/memutils.h>
 #include <windowapi.h>
 
 #include "aggregation/bson_project.h"
@@ -19,6 +20,7 @@
 #include "io/bson_core.h"
 #include "metadata/metadata_cache.h"
 #include "query/bson_compare.h"
+#include "aggregation/bson_tdigest.h"
 #include "utils/fmgr_utils.h"
 #include "utils/feature_counter.h"
 #include "utils/documentdb_errors.h"
@@ -38,6 +40,9 @@ typedef struct
 
 	/* granularity, example: POWERSOF2, R5 */
 	StringView granularity;
+
+	/* whether the boundaries are computed from approximate quantiles */
+	bool isApproximate;
 } BucketAutoArguments;
 
 /*
@@ -84,7 +89,35 @@ typedef struct
 	MemoryContext mcxt;
 } BucketAutoState;
 
+/*
+ * State of the approximate mode of $bucketAuto, where the rows are not sorted.
+ * The boundaries of all buckets are computed in a first pass over the partition
+ * and each row is then assigned to a bucket with a binary search.
+ */
+typedef struct
+{
+	/* whether the boundaries are computed */
+	bool initialized;
+
+	/* number of boundaries (the number of buckets + 1) */
+	int32 nBoundaries;
+
+	/* the boundaries as they're written, and as doubles for the search */
+	bson_value_t *boundaries;
+	double *boundaryDoubles;
+
+	/* whether the partition has null (or missing) groupBy values */
+	bool hasNulls;
+} BucketAutoApproximateState;
+
 static const char *BUCKETAUTO_BUCKET_ID_FIELD = "bucket_id";
+
+/* Internal field of the spec passed to the window function, set for approximate mode */
+static const char *BUCKETAUTO_APPROXIMATE_FIELD = "$approximate";
+
+extern bool EnableApproximateBucketAuto;
+extern int TdigestCompressionAccuracy;
+
 static const StringView BUCKETAUTO_GRANULARITY_SUPPORTED_TYPES[] = {
 	{ "POWERSOF2", 9 },
 	{ "1-2-5", 5 },
@@ -104,11 +137,21 @@ static const StringView BUCKETAUTO_GRANULARITY_SUPPORTED_TYPES[] = {
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
+static pgbson * BucketAutoApproximate(WindowObject winobj, const pgbson *currentValue,
+									  const BucketAutoArguments *args,
+									  MemoryContext mcxt);
+static void InitializeBucketAutoApproximateState(WindowObject winobj,
+												 const BucketAutoArguments *args,
+												 BucketAutoApproximateState *state,
+												 MemoryContext mcxt);
+static double ApplyGranularity(double value, const StringView *granularity,
+							   bool findLarger);
 static Query * BuildBucketAutoQuery(Query *query,
 									AggregationPipelineBuildContext *
 									context, const
 									bson_value_t *groupBy, const
-									bson_value_t *bucketAutoSpec);
+									bson_value_t *bucketAutoSpec,
+									bool isApproximate);
 
 static void BuildBucketAutoGroupSpec(const bson_value_t *output, bson_value_t *groupSpec);
 
@@ -185,6 +228,12 @@ bson_dollar_bucket_auto(PG_FUNCTION_ARGS)
 		ValidateValueIsNumberic(currentValue);
 	}
 
+	if (args->isApproximate)
+	{
+		PG_RETURN_POINTER(BucketAutoApproximate(winobj, currentValue, args,
+												fcinfo->flinfo->fn_mcxt));
+	}
+
 	/* initialize $bucketAuto state */
 	BucketAutoState *state;
 	state = (BucketAutoState *)
@@ -384,7 +433,8 @@ HandleBucketAuto(const bson_value_t *existingValue, Query *query,
 	/* step 1: ntile window function to assign bucket_id for each row. */
 	query = BuildBucketAutoQuery(query, context,
 								 &groupBy,
-								 existingValue);
+								 existingValue,
+								 EnableApproximateBucketAuto);
 
 	/* step 2: Group by bucket id and add output fields. */
 	bson_value_t groupSpec = { 0 };
@@ -402,12 +452,13 @@ HandleBucketAuto(const bson_value_t *existingValue, Query *query,
  *     SELECT document, bson_dollar_bucket_auto(bson_expression_get(document, '{ "" : "<groupByField>" }'::bson, true),  '{ "groupBy" : "<groupByField>", "buckets": <buckets> }'::bson) OVER (ORDER BY bson_expression_get(document, '{ "" : "<groupByField>" }'::bson, true)) AS bucket_id
  *     FROM <collection>
  *  ) AS new_document;
+ * In approximate mode the window has no ORDER BY, so the rows are not sorted.
  */
 static Query *
 BuildBucketAutoQuery(Query *query,
 					 AggregationPipelineBuildContext *context, const
 					 bson_value_t *groupBy, const
-					 bson_value_t *bucketAutoSpec)
+					 bson_value_t *bucketAutoSpec, bool isApproximate)
 {
 	/* get groupBy field function expression.
 	 * About let variables support, arguments "buckets" and "granularity" are constants, "output" with let will be handled by HandleGroup, we only need to take care of variableSpec when evaluating groupBy field.
@@ -453,6 +504,16 @@ BuildBucketAutoQuery(Query *query,
 	windowFunc->winagg = false;
 
 	pgbson *specBson = PgbsonInitFromDocumentBsonValue(bucketAutoSpec);
+	if (isApproximate)
+	{
+		pgbson_writer specWriter;
+		PgbsonWriterInit(&specWriter);
+		PgbsonWriterConcat(&specWriter, specBson);
+		PgbsonWriterAppendBool(&specWriter, BUCKETAUTO_APPROXIMATE_FIELD,
+							   strlen(BUCKETAUTO_APPROXIMATE_FIELD), true);
+		specBson = PgbsonWriterGetPgbson(&specWriter);
+	}
+
 	windowFunc->args = list_make2(getGroupbyFieldExpr, MakeBsonConst(specBson));
 
 	char *bucketIdFieldName = pstrdup(BUCKETAUTO_BUCKET_ID_FIELD);
@@ -479,24 +540,27 @@ BuildBucketAutoQuery(Query *query,
 		FRAMEOPTION_END_UNBOUNDED_FOLLOWING  /* Frame extends to the last row in the partition */
 		);
 
-	List *orderByClauseList = NIL;
-	SortBy *sortBy = makeNode(SortBy);
-	sortBy->location = -1;
-	sortBy->sortby_dir = SORTBY_ASC;
-	sortBy->node = (Node *) getGroupbyFieldExpr;
-
-	TargetEntry *sortEntry = makeTargetEntry((Expr *) sortBy->node,
-											 parseState->p_next_resno++,
-											 NULL, true);
-
-	/* Add order by clause's resjunc entry into target list */
-	query->targetList = lappend(query->targetList, sortEntry);
-
-	orderByClauseList = addTargetToSortList(parseState, sortEntry,
-											orderByClauseList,
-											query->targetList,
-											sortBy);
-	windowClause->orderClause = orderByClauseList;
+	if (!isApproximate)
+	{
+		List *orderByClauseList = NIL;
+		SortBy *sortBy = makeNode(SortBy);
+		sortBy->location = -1;
+		sortBy->sortby_dir = SORTBY_ASC;
+		sortBy->node = (Node *) getGroupbyFieldExpr;
+
+		TargetEntry *sortEntry = makeTargetEntry((Expr *) sortBy->node,
+												 parseState->p_next_resno++,
+												 NULL, true);
+
+		/* Add order by clause's resjunc entry into target list */
+		query->targetList = lappend(query->targetList, sortEntry);
+
+		orderByClauseList = addTargetToSortList(parseState, sortEntry,
+												orderByClauseList,
+												query->targetList,
+												sortBy);
+		windowClause->orderClause = orderByClauseList;
+	}
 	query->windowClause = lappend(query->windowClause, windowClause);
 
 	/*
@@ -592,21 +656,9 @@ SetLowerBound(const pgbson *currentValue, const BucketAutoArguments *args,
 		pgbsonelement currentValueElement;
 		PgbsonToSinglePgbsonElement(currentValue, &currentValueElement);
 		double currentValueDouble = BsonValueAsDouble(&currentValueElement.bsonValue);
-		double lowerBound = 0;
 		bool findLarger = false;
-		if (strcmp(args->granularity.string, "POWERSOF2") == 0)
-		{
-			lowerBound = FindClosestPowersOf2(currentValueDouble, findLarger);
-		}
-		else if (strcmp(args->granularity.string, "1-2-5") == 0)
-		{
-			lowerBound = FindClosest125(currentValueDouble, findLarger);
-		}
-		else
-		{
-			lowerBound = FindClosestRenardOrEseries(currentValueDouble, findLarger,
-													args->granularity.string);
-		}
+		double lowerBound = ApplyGranularity(currentValueDouble, &args->granularity,
+											 findLarger);
 
 		bson_value_t lowerBoundValue = {
 			.value_type = BSON_TYPE_DOUBLE,
@@ -665,22 +717,9 @@ SetUpperBound(WindowObject winobj, const BucketAutoArguments *args,
 
 		double maxOfCurrBucketDouble = BsonValueAsDouble(
 			&maxOfCurrBucketElement.bsonValue);
-		double upperBoundDouble = 0;
 		bool findLarger = true;
-		if (strcmp(args->granularity.string, "POWERSOF2") == 0)
-		{
-			upperBoundDouble = FindClosestPowersOf2(maxOfCurrBucketDouble, findLarger);
-		}
-		else if (strcmp(args->granularity.string, "1-2-5") == 0)
-		{
-			upperBoundDouble = FindClosest125(maxOfCurrBucketDouble, findLarger);
-		}
-		else
-		{
-			upperBoundDouble = FindClosestRenardOrEseries(maxOfCurrBucketDouble,
-														  findLarger,
-														  args->granularity.string);
-		}
+		double upperBoundDouble = ApplyGranularity(maxOfCurrBucketDouble,
+												   &args->granularity, findLarger);
 
 		bson_value_t upperBoundValue = {
 			.value_type = BSON_TYPE_DOUBLE,
@@ -765,6 +804,280 @@ SetUpperBound(WindowObject winobj, const BucketAutoArguments *args,
 }
 
 
+/*
+ * Returns the closest value in the granularity number series that is
+ * smaller (or larger with findLarger) than the value.
+ */
+static double
+ApplyGranularity(double value, const StringView *granularity, bool findLarger)
+{
+	if (strcmp(granularity->string, "POWERSOF2") == 0)
+	{
+		return FindClosestPowersOf2(value, findLarger);
+	}
+	else if (strcmp(granularity->string, "1-2-5") == 0)
+	{
+		return FindClosest125(value, findLarger);
+	}
+	else
+	{
+		return FindClosestRenardOrEseries(value, findLarger, granularity->string);
+	}
+}
+
+
+/*
+ * Computes the bucket of the current row in approximate mode. On the first
+ * call of the partition, all groupBy values are added to a t-digest and the
+ * boundaries of the buckets are estimated from its quantiles. The bucket of a
+ * row is then the last one whose lower bound is not larger than its value,
+ * rows with null values go to the first bucket.
+ */
+static pgbson *
+BucketAutoApproximate(WindowObject winobj, const pgbson *currentValue,
+					  const BucketAutoArguments *args, MemoryContext mcxt)
+{
+	BucketAutoApproximateState *state = (BucketAutoApproximateState *)
+										WinGetPartitionLocalMemory(winobj,
+																   sizeof(
+																	   BucketAutoApproximateState));
+	if (!state->initialized)
+	{
+		InitializeBucketAutoApproximateState(winobj, args, state, mcxt);
+	}
+
+	int32 bucket = 0;
+	pgbsonelement currentElement;
+	PgbsonToSinglePgbsonElement(currentValue, &currentElement);
+	if (BsonValueIsNumber(&currentElement.bsonValue))
+	{
+		/* Binary search for the last lower bound <= value */
+		double value = BsonValueAsDouble(&currentElement.bsonValue);
+		int32 low = 0;
+		int32 high = state->nBoundaries - 2;
+		while (low < high)
+		{
+			int32 mid = low + (high - low + 1) / 2;
+			if (state->boundaryDoubles[mid] <= value)
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+
+		bucket = low;
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	pgbson_writer innerWriter;
+	PgbsonWriterStartDocument(&writer, BUCKETAUTO_BUCKET_ID_FIELD,
+							  strlen(BUCKETAUTO_BUCKET_ID_FIELD), &innerWriter);
+	if (bucket == 0 && state->hasNulls)
+	{
+		PgbsonWriterAppendNull(&innerWriter, "min", 3);
+	}
+	else
+	{
+		PgbsonWriterAppendValue(&innerWriter, "min", 3, &state->boundaries[bucket]);
+	}
+
+	PgbsonWriterAppendValue(&innerWriter, "max", 3, &state->boundaries[bucket + 1]);
+	PgbsonWriterEndDocument(&writer, &innerWriter);
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * Computes the boundaries of the buckets in approximate mode from a single
+ * pass over the groupBy values of the partition. The first and last
+ * boundaries are the exact min and max values, the others are the estimated
+ * quantiles rounded up to the granularity (if any). Equal boundaries are
+ * merged, so there may be fewer buckets than requested.
+ */
+static void
+InitializeBucketAutoApproximateState(WindowObject winobj,
+									 const BucketAutoArguments *args,
+									 BucketAutoApproximateState *state,
+									 MemoryContext mcxt)
+{
+	int64 totalRows = WinGetPartitionRowCount(winobj);
+	int32 nBuckets = args->numBuckets;
+	if (totalRows < nBuckets)
+	{
+		nBuckets = (int32) Max(totalRows, 1);
+	}
+
+	double *percentiles = palloc(sizeof(double) * nBuckets);
+	for (int32 i = 1; i < nBuckets; i++)
+	{
+		percentiles[i - 1] = ((double) i) / nBuckets;
+	}
+
+	int compression = Min(Max(TdigestCompressionAccuracy, 10), 10000);
+	TDigestState *digest = CreateTDigestState(percentiles, nBuckets - 1, compression);
+
+	/*
+	 * The groupBy values are evaluated for each row of the partition, so these
+	 * are evaluated in a context that is reset per row. Numbers don't point
+	 * into the value, so the min and max can be kept as is.
+	 */
+	MemoryContext rowContext = AllocSetContextCreate(CurrentMemoryContext,
+													 "BucketAutoApproximateRowContext",
+													 ALLOCSET_DEFAULT_SIZES);
+	MemoryContext oldContext = MemoryContextSwitchTo(rowContext);
+
+	bool hasNumbers = false;
+	bson_value_t minValue = { 0 };
+	bson_value_t maxValue = { 0 };
+	double minDouble = 0;
+	double maxDouble = 0;
+	for (int64 i = 0; i < totalRows; i++)
+	{
+		CHECK_FOR_INTERRUPTS();
+		MemoryContextReset(rowContext);
+
+		bool isNull = false;
+		bool isOut = false;
+		Datum valueDatum = WinGetFuncArgInPartition(winobj, 0, i, WINDOW_SEEK_HEAD,
+													false, &isNull, &isOut);
+		if (isOut)
+		{
+			break;
+		}
+
+		pgbsonelement valueElement = { 0 };
+		if (!isNull)
+		{
+			PgbsonToSinglePgbsonElement(DatumGetPgBson(valueDatum), &valueElement);
+		}
+
+		if (isNull || valueElement.bsonValue.value_type == BSON_TYPE_NULL ||
+			valueElement.bsonValue.value_type == BSON_TYPE_EOD)
+		{
+			state->hasNulls = true;
+			continue;
+		}
+
+		if (!BsonValueIsNumber(&valueElement.bsonValue))
+		{
+			ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+							errmsg(
+								"Approximate $bucketAuto only supports numeric groupBy values, but encountered a value of type: %s",
+								BsonTypeName(valueElement.bsonValue.value_type))));
+		}
+
+		double value = BsonValueAsDouble(&valueElement.bsonValue);
+		if (!hasNumbers || value < minDouble)
+		{
+			minDouble = value;
+			minValue = valueElement.bsonValue;
+		}
+
+		if (!hasNumbers || value > maxDouble)
+		{
+			maxDouble = value;
+			maxValue = valueElement.bsonValue;
+		}
+
+		hasNumbers = true;
+		TDigestAddValue(digest, value);
+	}
+
+	MemoryContextSwitchTo(oldContext);
+	MemoryContextDelete(rowContext);
+
+	state->boundaries = MemoryContextAllocZero(mcxt, sizeof(bson_value_t) *
+											   (nBuckets + 1));
+	state->boundaryDoubles = MemoryContextAllocZero(mcxt, sizeof(double) *
+													(nBuckets + 1));
+
+	if (!hasNumbers)
+	{
+		/* Only nulls, these all go in a single bucket */
+		state->boundaries[0].value_type = BSON_TYPE_NULL;
+		state->boundaries[1].value_type = BSON_TYPE_NULL;
+		state->nBoundaries = 2;
+		state->initialized = true;
+		return;
+	}
+
+	double *quantiles = palloc(sizeof(double) * nBuckets);
+	if (nBuckets > 1)
+	{
+		TDigestComputePercentiles(digest, quantiles);
+	}
+
+	bool hasGranularity = args->granularity.length > 0;
+	int32 nBoundaries = 0;
+	for (int32 i = 0; i <= nBuckets; i++)
+	{
+		bson_value_t boundary;
+		double boundaryDouble;
+		if (i == 0)
+		{
+			boundaryDouble = hasGranularity ?
+							 ApplyGranularity(minDouble, &args->granularity, false) :
+							 minDouble;
+			boundary = minValue;
+		}
+		else if (i == nBuckets)
+		{
+			boundaryDouble = hasGranularity ?
+							 ApplyGranularity(maxDouble, &args->granularity, true) :
+							 maxDouble;
+			boundary = maxValue;
+		}
+		else
+		{
+			/* Quantiles are within [min, max] but may be estimated outside */
+			double quantile = Min(Max(quantiles[i - 1], minDouble), maxDouble);
+			boundaryDouble = hasGranularity ?
+							 ApplyGranularity(quantile, &args->granularity, true) :
+							 quantile;
+			boundary.value_type = BSON_TYPE_DOUBLE;
+		}
+
+		if (hasGranularity || boundary.value_type == BSON_TYPE_DOUBLE)
+		{
+			boundary.value_type = BSON_TYPE_DOUBLE;
+			boundary.value.v_double = boundaryDouble;
+		}
+
+		if (nBoundaries > 0 &&
+			boundaryDouble <= state->boundaryDoubles[nBoundaries - 1])
+		{
+			if (i == nBuckets && nBoundaries > 1)
+			{
+				/* The max is the upper bound of the last bucket */
+				state->boundaries[nBoundaries - 1] = boundary;
+				state->boundaryDoubles[nBoundaries - 1] = boundaryDouble;
+			}
+			else if (i == nBuckets)
+			{
+				state->boundaries[nBoundaries] = boundary;
+				state->boundaryDoubles[nBoundaries] = boundaryDouble;
+				nBoundaries++;
+			}
+
+			continue;
+		}
+
+		state->boundaries[nBoundaries] = boundary;
+		state->boundaryDoubles[nBoundaries] = boundaryDouble;
+		nBoundaries++;
+	}
+
+	pfree(quantiles);
+	pfree(percentiles);
+	state->nBoundaries = nBoundaries;
+	state->initialized = true;
+}
+
+
 static void
 InitializeBucketAutoArguments(BucketAutoArguments *args, const pgbson *spec)
 {
@@ -789,6 +1102,10 @@ InitializeBucketAutoArguments(BucketAutoArguments *args, const pgbson *spec)
 				.length = value->value.v_utf8.len
 			};
 		}
+		else if (strcmp(key, BUCKETAUTO_APPROXIMATE_FIELD) == 0)
+		{
+			args->isApproximate = BsonValueAsBool(value);
+		}
 	}
 }
 
@@ -9,6 +9,7 @@
  */
 
 #include <postgres.h>
+#include <common/int.h>
 #include <nodes/execnodes.h>
 #include <miscadmin.h>
 #include <parser/parse_clause.h>
@@ -154,11 +155,13 @@ typedef struct DensifyFullEntry
 /*
  * Holds either the step as bson_value_t
  * or as Interval is step is provided with a unit
+ * or as milliseconds if the unit has a fixed length
  */
 typedef union TypedStep
 {
 	bson_value_t numericStep;
 	Datum intervalStep;
+	int64 millisecondStep;
 } TypedStep;
 
 
@@ -238,6 +241,9 @@ static inline void ThorwLimitExceededError(int32 nDocumentsGenerated);
 static uint32 DensifyFullKeyHashFunc(const void *obj, size_t objsize);
 static pgbson * DensifyPartitionCore(PG_FUNCTION_ARGS, DensifyType type);
 static void TimeStepIncrementor(bson_value_t *baseValue, TypedStep *step);
+static void FixedTimeStepIncrementor(bson_value_t *baseValue, TypedStep *step);
+static bool TryGetFixedMillisecondStep(DateUnit unit, int64 amount,
+									   int64 *millisecondStep);
 static void NumericStepIncrementor(bson_value_t *baseValue, TypedStep *step);
 static int DensifyFullKeyHashCompare(const void *obj1, const void *obj2, Size objsize);
 static void PopulateDensifyArgs(DensifyArguments *arguments, const pgbson *densifySpec);
@@ -656,12 +662,9 @@ AddGroupByValueToGeneratedDocuments(pgbson_writer *writer, const pgbson *partiti
 	{
 		return;
 	}
-	bson_iter_t partitionByItr;
-	PgbsonInitIterator(partitionBy, &partitionByItr);
-	while (bson_iter_next(&partitionByItr))
-	{
-		PgbsonWriterAppendIter(writer, &partitionByItr);
-	}
+
+	/* The fields are written as is, so copy them over in one go */
+	PgbsonWriterConcat(writer, partitionBy);
 }
 
 
@@ -1449,6 +1452,78 @@ TimeStepIncrementor(bson_value_t *baseValue, TypedStep *step)
 }
 
 
+/*
+ * Increments dates by a step of a fixed length in milliseconds. This avoids
+ * the round trip through a postgres timestamp and interval for each of the
+ * generated documents.
+ */
+static void
+FixedTimeStepIncrementor(bson_value_t *baseValue, TypedStep *step)
+{
+	if (baseValue->value_type == BSON_TYPE_EOD || baseValue->value_type == BSON_TYPE_NULL)
+	{
+		return;
+	}
+
+	int64 result = 0;
+	if (pg_add_s64_overflow(baseValue->value.v_datetime, step->millisecondStep,
+							&result))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_OVERFLOW),
+						errmsg(
+							"value %lld (milliseconds) is out of range for timestamps.",
+							(long long) baseValue->value.v_datetime)));
+	}
+
+	baseValue->value.v_datetime = result;
+}
+
+
+/*
+ * Gets the step in milliseconds for units that always have the same length.
+ * Days and larger units depend on the time zone (and calendar), so these
+ * keep using an interval.
+ */
+static bool
+TryGetFixedMillisecondStep(DateUnit unit, int64 amount, int64 *millisecondStep)
+{
+	int64 unitMilliseconds;
+	switch (unit)
+	{
+		case DateUnit_Hour:
+		{
+			unitMilliseconds = 60 * 60 * MILLISECONDS_IN_SECOND;
+			break;
+		}
+
+		case DateUnit_Minute:
+		{
+			unitMilliseconds = 60 * MILLISECONDS_IN_SECOND;
+			break;
+		}
+
+		case DateUnit_Second:
+		{
+			unitMilliseconds = MILLISECONDS_IN_SECOND;
+			break;
+		}
+
+		case DateUnit_Millisecond:
+		{
+			unitMilliseconds = 1;
+			break;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+
+	return !pg_mul_s64_overflow(amount, unitMilliseconds, millisecondStep);
+}
+
+
 static uint32
 DensifyFullKeyHashFunc(const void *obj, size_t objsize)
 {
@@ -1652,9 +1727,17 @@ InitializeDensifyWindowState(DensifyWindowState *state, const pgbson *densifySpe
 	if (args->timeUnit != DateUnit_Invalid)
 	{
 		int64 amount = BsonValueAsInt64(&args->step);
-		state->typedStep.intervalStep = GetIntervalFromDateUnitAndAmount(args->timeUnit,
-																		 amount);
-		state->incrementor = &TimeStepIncrementor;
+		if (TryGetFixedMillisecondStep(args->timeUnit, amount,
+									   &state->typedStep.millisecondStep))
+		{
+			state->incrementor = &FixedTimeStepIncrementor;
+		}
+		else
+		{
+			state->typedStep.intervalStep = GetIntervalFromDateUnitAndAmount(
+				args->timeUnit, amount);
+			state->incrementor = &TimeStepIncrementor;
+		}
 	}
 	else
 	{
@@ -1679,12 +1762,21 @@ CheckEnoughRoomForNewDocuments(const bson_value_t *min, const bson_value_t *max,
 	{
 		int64 minMillis = min->value.v_datetime;
 		int64 maxMillis = max->value.v_datetime;
-		float8 secondsInInterval = DatumGetFloat8(DirectFunctionCall2(
-													  interval_part,
-													  CStringGetTextDatum(EPOCH),
-													  state->typedStep.intervalStep));
-		double nDocsToGenerate = (maxMillis - minMillis) / (secondsInInterval *
-															MILLISECONDS_IN_SECOND);
+		float8 millisInStep;
+		if (state->incrementor == &FixedTimeStepIncrementor)
+		{
+			millisInStep = (float8) state->typedStep.millisecondStep;
+		}
+		else
+		{
+			float8 secondsInInterval = DatumGetFloat8(DirectFunctionCall2(
+														  interval_part,
+														  CStringGetTextDatum(EPOCH),
+														  state->typedStep.intervalStep));
+			millisInStep = secondsInInterval * MILLISECONDS_IN_SECOND;
+		}
+
+		double nDocsToGenerate = (maxMillis - minMillis) / millisInStep;
 		return nDocsToGenerate <= (double) nDocsAvailable;
 	}
 	else
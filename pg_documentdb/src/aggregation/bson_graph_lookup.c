@@ -0,0 +1,416 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/aggregation/bson_graph_lookup.c
+ *
+ * Implementation of the breadth first traversal used by the native
+ * strategy of $graphLookup.
+ *
+ * The default $graphLookup plan is a recursive CTE that joins every path of
+ * the traversal with the foreign collection and deduplicates the documents at
+ * the end. Here the traversal is instead done level by level for each input
+ * document: every level issues a single (batched) probe of the foreign
+ * collection for all the values of the frontier, and the _id of visited documents
+ * and the values already probed are tracked in hash sets so that a document is
+ * only expanded once, at its smallest depth.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <executor/spi.h>
+#include <utils/builtins.h>
+
+#include "io/bson_core.h"
+#include "metadata/collection.h"
+#include "metadata/metadata_cache.h"
+#include "query/bson_compare.h"
+#include "utils/documentdb_errors.h"
+#include "utils/hashset_utils.h"
+
+/*
+ * Maximum number of frontier values probed in a single query against the
+ * foreign collection. Larger frontiers are probed in several batches.
+ */
+#define GRAPH_LOOKUP_MAX_PROBE_VALUES 1000
+
+/* The parsed spec of bson_dollar_graph_lookup */
+typedef struct GraphLookupTraversalSpec
+{
+	/* The database and the collection that is traversed */
+	char *databaseName;
+	char *collectionName;
+
+	/* The connectToField path */
+	char *connectToField;
+
+	/* The { "connectToField": { "$makeArray": "$connectFromField" } } expression */
+	pgbson *connectFromExpression;
+
+	/* The maximum depth of the traversal */
+	int32_t maxDepth;
+
+	/* Optional field to write the depth into */
+	const char *depthField;
+	uint32_t depthFieldLength;
+
+	/* Optional restrictSearchWithMatch query */
+	pgbson *restrictSearch;
+
+	/* The field the results are written into */
+	const char *asField;
+	uint32_t asFieldLength;
+} GraphLookupTraversalSpec;
+
+/* A document reached by the traversal */
+typedef struct GraphLookupResult
+{
+	bson_value_t objectId;
+	pgbson *document;
+	int32_t depth;
+} GraphLookupResult;
+
+
+static void ParseGraphLookupTraversalSpec(pgbson *specDocument,
+										  GraphLookupTraversalSpec *spec);
+static List * AddFrontierValues(List *frontier, HTAB *probedValues,
+								pgbson *valuesDocument);
+static char * BuildGraphLookupProbeQuery(MongoCollection *collection,
+										 GraphLookupTraversalSpec *spec);
+static int CompareGraphLookupResults(const void *left, const void *right);
+
+/* --------------------------------------------------------- */
+/* Top level exports */
+/* --------------------------------------------------------- */
+
+PG_FUNCTION_INFO_V1(bson_dollar_graph_lookup);
+
+
+/*
+ * bson_dollar_graph_lookup takes the start values of a $graphLookup for an input
+ * document i.e. { "connectToField": [ <startWith values> ] } along with the traversal
+ * spec and returns { "as": [ <matched documents> ] }.
+ */
+Datum
+bson_dollar_graph_lookup(PG_FUNCTION_ARGS)
+{
+	pgbson *startWith = PG_GETARG_PGBSON(0);
+	pgbson *specDocument = PG_GETARG_PGBSON(1);
+
+	GraphLookupTraversalSpec spec = { 0 };
+	ParseGraphLookupTraversalSpec(specDocument, &spec);
+
+	MemoryContext traversalContext = CurrentMemoryContext;
+	HTAB *visitedIds = CreateBsonValueHashSet();
+	HTAB *probedValues = CreateBsonValueHashSet();
+
+	List *frontier = AddFrontierValues(NIL, probedValues, startWith);
+	GraphLookupResult *results = NULL;
+	int numResults = 0;
+	int maxResults = 0;
+
+	MongoCollection *collection = GetMongoCollectionByNameDatum(
+		CStringGetTextDatum(spec.databaseName),
+		CStringGetTextDatum(spec.collectionName), AccessShareLock);
+
+	if (collection != NULL && frontier != NIL)
+	{
+		char *probeQuery = BuildGraphLookupProbeQuery(collection, &spec);
+
+		int argCount = spec.restrictSearch != NULL ? 4 : 3;
+		Oid argTypes[4] = { BsonTypeId(), BsonTypeId(), TEXTOID, BsonTypeId() };
+		Datum argValues[4] = {
+			0, PointerGetDatum(spec.connectFromExpression),
+			CStringGetTextDatum(spec.connectToField),
+			PointerGetDatum(spec.restrictSearch)
+		};
+
+		SPI_connect();
+
+		for (int32_t depth = 0; frontier != NIL && depth <= spec.maxDepth; depth++)
+		{
+			CHECK_FOR_INTERRUPTS();
+
+			List *nextFrontier = NIL;
+			int numValues = list_length(frontier);
+			for (int start = 0; start < numValues; start += GRAPH_LOOKUP_MAX_PROBE_VALUES)
+			{
+				int end = Min(start + GRAPH_LOOKUP_MAX_PROBE_VALUES, numValues);
+
+				/* { "connectToField": [ <frontier values> ] } */
+				pgbson_writer filterWriter;
+				PgbsonWriterInit(&filterWriter);
+				pgbson_array_writer valuesWriter;
+				PgbsonWriterStartArray(&filterWriter, spec.connectToField,
+									   strlen(spec.connectToField), &valuesWriter);
+				for (int i = start; i < end; i++)
+				{
+					PgbsonArrayWriterWriteValue(&valuesWriter, list_nth(frontier, i));
+				}
+				PgbsonWriterEndArray(&filterWriter, &valuesWriter);
+				argValues[0] = PointerGetDatum(PgbsonWriterGetPgbson(&filterWriter));
+
+				bool readOnly = true;
+				long maxTupleCount = 0;
+				if (SPI_execute_with_args(probeQuery, argCount, argTypes, argValues, NULL,
+										  readOnly, maxTupleCount) != SPI_OK_SELECT)
+				{
+					ereport(ERROR, (errmsg("could not run the $graphLookup probe query")));
+				}
+
+				for (uint64 row = 0; row < SPI_processed; row++)
+				{
+					bool isNull = false;
+					Datum objectIdDatum = SPI_getbinval(SPI_tuptable->vals[row],
+														SPI_tuptable->tupdesc, 1,
+														&isNull);
+					Datum documentDatum = SPI_getbinval(SPI_tuptable->vals[row],
+														SPI_tuptable->tupdesc, 2,
+														&isNull);
+					Datum connectFromDatum = SPI_getbinval(SPI_tuptable->vals[row],
+														   SPI_tuptable->tupdesc, 3,
+														   &isNull);
+
+					/* Copy out of the SPI context since the results outlive the probe */
+					pgbson *objectIdDocument = CopyPgbsonIntoMemoryContext(
+						DatumGetPgBson(objectIdDatum), traversalContext);
+					MemoryContext oldContext = MemoryContextSwitchTo(traversalContext);
+
+					pgbsonelement objectIdElement;
+					PgbsonToSinglePgbsonElement(objectIdDocument, &objectIdElement);
+
+					bool found = false;
+					hash_search(visitedIds, &objectIdElement.bsonValue, HASH_ENTER, &found);
+					if (found)
+					{
+						MemoryContextSwitchTo(oldContext);
+						continue;
+					}
+
+					if (numResults == maxResults)
+					{
+						maxResults = maxResults == 0 ? 16 : maxResults * 2;
+						results = results == NULL ?
+								  palloc(sizeof(GraphLookupResult) * maxResults) :
+								  repalloc(results, sizeof(GraphLookupResult) *
+										   maxResults);
+					}
+
+					results[numResults].objectId = objectIdElement.bsonValue;
+					results[numResults].document =
+						PgbsonCloneFromPgbson(DatumGetPgBson(documentDatum));
+					results[numResults].depth = depth;
+					numResults++;
+
+					if (!isNull && depth < spec.maxDepth)
+					{
+						pgbson *connectFromValues =
+							PgbsonCloneFromPgbson(DatumGetPgBson(connectFromDatum));
+						nextFrontier = AddFrontierValues(nextFrontier, probedValues,
+														 connectFromValues);
+					}
+
+					MemoryContextSwitchTo(oldContext);
+				}
+
+				SPI_freetuptable(SPI_tuptable);
+			}
+
+			frontier = nextFrontier;
+		}
+
+		SPI_finish();
+	}
+
+	/* Match the order of the recursive CTE plan which distincts on the _id */
+	if (numResults > 1)
+	{
+		qsort(results, numResults, sizeof(GraphLookupResult),
+			  CompareGraphLookupResults);
+	}
+
+	FmgrInfo mergeDocumentsInfo;
+	if (spec.depthFieldLength > 0)
+	{
+		fmgr_info(BsonDollaMergeDocumentsFunctionOid(), &mergeDocumentsInfo);
+	}
+
+	pgbson_writer resultWriter;
+	PgbsonWriterInit(&resultWriter);
+	pgbson_array_writer resultArrayWriter;
+	PgbsonWriterStartArray(&resultWriter, spec.asField, spec.asFieldLength,
+						   &resultArrayWriter);
+	for (int i = 0; i < numResults; i++)
+	{
+		pgbson *document = results[i].document;
+		if (spec.depthFieldLength > 0)
+		{
+			pgbson_writer depthWriter;
+			PgbsonWriterInit(&depthWriter);
+			PgbsonWriterAppendInt32(&depthWriter, spec.depthField, spec.depthFieldLength,
+									results[i].depth);
+
+			bool overrideArray = true;
+			document = DatumGetPgBson(FunctionCall3(&mergeDocumentsInfo,
+													PointerGetDatum(document),
+													PointerGetDatum(PgbsonWriterGetPgbson(
+																		&depthWriter)),
+													BoolGetDatum(overrideArray)));
+		}
+
+		PgbsonArrayWriterWriteDocument(&resultArrayWriter, document);
+	}
+	PgbsonWriterEndArray(&resultWriter, &resultArrayWriter);
+
+	hash_destroy(visitedIds);
+	hash_destroy(probedValues);
+
+	PG_RETURN_POINTER(PgbsonWriterGetPgbson(&resultWriter));
+}
+
+
+/* --------------------------------------------------------- */
+/* Private helper methods */
+/* --------------------------------------------------------- */
+
+/*
+ * Parses the spec built by the $graphLookup planner for bson_dollar_graph_lookup.
+ */
+static void
+ParseGraphLookupTraversalSpec(pgbson *specDocument, GraphLookupTraversalSpec *spec)
+{
+	bson_iter_t specIter;
+	PgbsonInitIterator(specDocument, &specIter);
+
+	spec->maxDepth = INT32_MAX;
+	while (bson_iter_next(&specIter))
+	{
+		const char *key = bson_iter_key(&specIter);
+		const bson_value_t *value = bson_iter_value(&specIter);
+		if (strcmp(key, "database") == 0)
+		{
+			spec->databaseName = pnstrdup(value->value.v_utf8.str,
+										  value->value.v_utf8.len);
+		}
+		else if (strcmp(key, "collection") == 0)
+		{
+			spec->collectionName = pnstrdup(value->value.v_utf8.str,
+											value->value.v_utf8.len);
+		}
+		else if (strcmp(key, "connectToField") == 0)
+		{
+			spec->connectToField = pnstrdup(value->value.v_utf8.str,
+											value->value.v_utf8.len);
+		}
+		else if (strcmp(key, "connectFromExpression") == 0)
+		{
+			spec->connectFromExpression = PgbsonInitFromDocumentBsonValue(value);
+		}
+		else if (strcmp(key, "maxDepth") == 0)
+		{
+			spec->maxDepth = BsonValueAsInt32(value);
+		}
+		else if (strcmp(key, "depthField") == 0)
+		{
+			spec->depthField = value->value.v_utf8.str;
+			spec->depthFieldLength = value->value.v_utf8.len;
+		}
+		else if (strcmp(key, "restrictSearchWithMatch") == 0)
+		{
+			spec->restrictSearch = PgbsonInitFromDocumentBsonValue(value);
+		}
+		else if (strcmp(key, "as") == 0)
+		{
+			spec->asField = value->value.v_utf8.str;
+			spec->asFieldLength = value->value.v_utf8.len;
+		}
+	}
+
+	if (spec->databaseName == NULL || spec->collectionName == NULL ||
+		spec->connectToField == NULL || spec->connectFromExpression == NULL ||
+		spec->asField == NULL)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Invalid spec provided to $graphLookup traversal")));
+	}
+}
+
+
+/*
+ * Adds the values of the { "connectToField": [ values ] } document that were
+ * not probed yet to the frontier.
+ */
+static List *
+AddFrontierValues(List *frontier, HTAB *probedValues, pgbson *valuesDocument)
+{
+	pgbsonelement valuesElement;
+	if (!TryGetSinglePgbsonElementFromPgbson(valuesDocument, &valuesElement) ||
+		valuesElement.bsonValue.value_type != BSON_TYPE_ARRAY)
+	{
+		return frontier;
+	}
+
+	bson_iter_t valuesIter;
+	BsonValueInitIterator(&valuesElement.bsonValue, &valuesIter);
+	while (bson_iter_next(&valuesIter))
+	{
+		const bson_value_t *value = bson_iter_value(&valuesIter);
+
+		bool found = false;
+		hash_search(probedValues, value, HASH_ENTER, &found);
+		if (!found)
+		{
+			bson_value_t *frontierValue = palloc(sizeof(bson_value_t));
+			*frontierValue = *value;
+			frontier = lappend(frontier, frontierValue);
+		}
+	}
+
+	return frontier;
+}
+
+
+/*
+ * Builds the query that finds the documents of the foreign collection matching
+ * a batch of frontier values along with the values for the next frontier:
+ *
+ * SELECT object_id, document,
+ *  bson_expression_get(document, '{ "connectToField": { "$makeArray": "$connectFromField" } }', false)
+ * FROM documents_<id>
+ * WHERE bson_dollar_lookup_join_filter(document, $1, 'connectToField')
+ *  AND document @@ 'restrictSearchWithMatch'
+ */
+static char *
+BuildGraphLookupProbeQuery(MongoCollection *collection, GraphLookupTraversalSpec *spec)
+{
+	StringInfoData probeQuery;
+	initStringInfo(&probeQuery);
+	appendStringInfo(&probeQuery,
+					 "SELECT object_id, document, %s.bson_expression_get(document, $2::%s, false)"
+					 " FROM %s.%s WHERE %s.bson_dollar_lookup_join_filter(document, $1::%s, $3::text)",
+					 ApiCatalogSchemaName, FullBsonTypeName,
+					 ApiDataSchemaName, collection->tableName,
+					 DocumentDBApiInternalSchemaName, FullBsonTypeName);
+
+	if (spec->restrictSearch != NULL)
+	{
+		appendStringInfo(&probeQuery, " AND document OPERATOR(%s.@@) $4::%s",
+						 ApiCatalogSchemaName, FullBsonTypeName);
+	}
+
+	return probeQuery.data;
+}
+
+
+static int
+CompareGraphLookupResults(const void *left, const void *right)
+{
+	const GraphLookupResult *leftResult = (const GraphLookupResult *) left;
+	const GraphLookupResult *rightResult = (const GraphLookupResult *) right;
+
+	bool isComparisonValidIgnore = false;
+	return CompareBsonValueAndType(&leftResult->objectId, &rightResult->objectId,
+								   &isComparisonValidIgnore);
+}
@@ -16,6 +16,7 @@
 #include "io/bson_core.h"
 #include "io/bson_traversal.h"
 #include "operators/bson_expression.h"
+#include "query/bson_compare.h"
 #include "utils/documentdb_errors.h"
 #include "utils/fmgr_utils.h"
 
@@ -57,6 +58,13 @@ typedef struct InverseMatchArgs
 static void PopulateInverseMatchArgs(InverseMatchArgs *args, bson_iter_t *specIter);
 static void ValidateQueryInput(const bson_value_t *value);
 static bool EvaluateInverseMatch(pgbson *document, const InverseMatchArgs *args);
+static bool CanQueryMatchAnyInput(const bson_value_t *queryValue,
+								  const bson_value_t *queryInput);
+static bool CanEqualityMatchInputDocument(const char *path, uint32_t pathLength,
+										  const bson_value_t *equalityValue,
+										  const bson_value_t *inputDocument);
+static bool TryGetSimpleEqualityValue(bson_iter_t *queryIter,
+									  const bson_value_t **equalityValue);
 static bool InverseMatchVisitTopLevelField(pgbsonelement *element, const
 										   StringView *filterPath,
 										   void *state);
@@ -64,6 +72,8 @@ static bool InverseMatchContinueProcessIntermediateArray(void *state, const
 														 bson_value_t *value, bool
 														 isArrayIndexSearch);
 
+extern bool EnableInverseMatchEqualityPrefilter;
+
 static const TraverseBsonExecutionFuncs InverseMatchExecutionFuncs = {
 	.ContinueProcessIntermediateArray = InverseMatchContinueProcessIntermediateArray,
 	.SetTraverseResult = NULL,
@@ -159,9 +169,6 @@ EvaluateInverseMatch(pgbson *document, const InverseMatchArgs *args)
 							BsonTypeName(queryValue.value_type))));
 	}
 
-	MemoryContext memoryContext = CurrentMemoryContext;
-	ExprEvalState *exprEvalState = GetExpressionEvalState(&queryValue, memoryContext);
-
 	pgbson_writer valueWriter;
 	PgbsonWriterInit(&valueWriter);
 	bson_value_t queryInput;
@@ -193,6 +200,20 @@ EvaluateInverseMatch(pgbson *document, const InverseMatchArgs *args)
 		ValidateQueryInput(&queryInput);
 	}
 
+	/*
+	 * Compiling the stored query dominates the cost of $inverseMatch, and most
+	 * stored queries (e.g. alerting rules) don't match a given input, so skip
+	 * the ones whose top level equality predicates can't match any input document.
+	 */
+	if (EnableInverseMatchEqualityPrefilter &&
+		!CanQueryMatchAnyInput(&queryValue, &queryInput))
+	{
+		return false;
+	}
+
+	MemoryContext memoryContext = CurrentMemoryContext;
+	ExprEvalState *exprEvalState = GetExpressionEvalState(&queryValue, memoryContext);
+
 	bson_type_t inputType = queryInput.value_type;
 	bool result = false;
 
@@ -219,6 +240,146 @@ EvaluateInverseMatch(pgbson *document, const InverseMatchArgs *args)
 }
 
 
+/*
+ * Returns false if the query can't match any of the input documents based on
+ * its top level equality predicates on non dotted paths, i.e. { "a": <value> }
+ * or { "a": { "$eq": <value> } }. Other predicates are left to the query evaluation
+ * so this may return true for queries that don't match.
+ */
+static bool
+CanQueryMatchAnyInput(const bson_value_t *queryValue, const bson_value_t *queryInput)
+{
+	bool isArrayInput = queryInput->value_type == BSON_TYPE_ARRAY;
+	bson_iter_t inputIter;
+	if (isArrayInput)
+	{
+		BsonValueInitIterator(queryInput, &inputIter);
+	}
+
+	bool hasInput = true;
+	while (isArrayInput ? bson_iter_next(&inputIter) : hasInput)
+	{
+		hasInput = false;
+		const bson_value_t *inputDocument = isArrayInput ?
+											bson_iter_value(&inputIter) : queryInput;
+
+		bool canMatch = true;
+		bson_iter_t queryIter;
+		BsonValueInitIterator(queryValue, &queryIter);
+		while (canMatch && bson_iter_next(&queryIter))
+		{
+			uint32_t pathLength = bson_iter_key_len(&queryIter);
+			const char *path = bson_iter_key(&queryIter);
+			const bson_value_t *equalityValue = NULL;
+			if (pathLength == 0 || path[0] == '$' ||
+				memchr(path, '.', pathLength) != NULL ||
+				!TryGetSimpleEqualityValue(&queryIter, &equalityValue))
+			{
+				continue;
+			}
+
+			canMatch = CanEqualityMatchInputDocument(path, pathLength, equalityValue,
+													 inputDocument);
+		}
+
+		if (canMatch)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * Gets the value of an implicit or explicit $eq predicate if it is a scalar
+ * whose $eq semantics are a plain comparison (no null, regex, array or document).
+ */
+static bool
+TryGetSimpleEqualityValue(bson_iter_t *queryIter, const bson_value_t **equalityValue)
+{
+	const bson_value_t *value = bson_iter_value(queryIter);
+	if (value->value_type == BSON_TYPE_DOCUMENT)
+	{
+		bson_iter_t operatorIter;
+		BsonValueInitIterator(value, &operatorIter);
+		if (!bson_iter_next(&operatorIter) ||
+			strcmp(bson_iter_key(&operatorIter), "$eq") != 0)
+		{
+			return false;
+		}
+
+		value = bson_iter_value(&operatorIter);
+		if (bson_iter_next(&operatorIter))
+		{
+			return false;
+		}
+	}
+
+	switch (value->value_type)
+	{
+		case BSON_TYPE_UTF8:
+		case BSON_TYPE_INT32:
+		case BSON_TYPE_INT64:
+		case BSON_TYPE_DOUBLE:
+		case BSON_TYPE_DECIMAL128:
+		case BSON_TYPE_BOOL:
+		case BSON_TYPE_OID:
+		case BSON_TYPE_DATE_TIME:
+		case BSON_TYPE_TIMESTAMP:
+		{
+			*equalityValue = value;
+			return true;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
+/*
+ * Whether the top level field of the input document (or one of the elements
+ * if it is an array) can be equal to the value.
+ */
+static bool
+CanEqualityMatchInputDocument(const char *path, uint32_t pathLength,
+							  const bson_value_t *equalityValue,
+							  const bson_value_t *inputDocument)
+{
+	bson_iter_t documentIter;
+	BsonValueInitIterator(inputDocument, &documentIter);
+	if (!bson_iter_find_w_len(&documentIter, path, pathLength))
+	{
+		return false;
+	}
+
+	bool isComparisonValid = false;
+	const bson_value_t *fieldValue = bson_iter_value(&documentIter);
+	if (fieldValue->value_type != BSON_TYPE_ARRAY)
+	{
+		return CompareBsonValueAndType(fieldValue, equalityValue,
+									   &isComparisonValid) == 0;
+	}
+
+	bson_iter_t arrayIter;
+	BsonValueInitIterator(fieldValue, &arrayIter);
+	while (bson_iter_next(&arrayIter))
+	{
+		if (CompareBsonValueAndType(bson_iter_value(&arrayIter), equalityValue,
+									&isComparisonValid) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /*
  * Parses the {"path": <document>, "input": <document or array of documents>, "defaultResult": <bool> }
  * and stores it into the args parameter. It just validates the input as the rest of validation is done at
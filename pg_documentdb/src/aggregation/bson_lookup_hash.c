@@ -0,0 +1,360 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/aggregation/bson_lookup_hash.c
+ *
+ * Implementation of the join key functions used by the hash join strategy
+ * of $lookup.
+ *
+ * The planner can only hash join on hashable equality operators, and the
+ * $lookup join filter (which has $in semantics with array expansion) is not one.
+ * To let the planner pick a hash join, both sides of the lookup are expanded into
+ * int8 join keys that are consistent with the $in comparison: if a foreign document
+ * matches a local value, the two share at least one key. The join filter is then
+ * applied as a recheck on the key matches, so the keys only need to be a superset
+ * of the actual matches.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <utils/builtins.h>
+
+#include "io/bson_core.h"
+#include "io/bson_hash.h"
+#include "io/bson_traversal.h"
+
+/*
+ * Seed used for the join key hashes.
+ */
+#define LOOKUP_JOIN_KEY_SEED 0
+
+/*
+ * Regular expressions in the local values match foreign strings by pattern which
+ * can't be hashed. These match a single key shared by every foreign document that has
+ * a string, symbol or regex value at the foreign path.
+ */
+#define LOOKUP_JOIN_KEY_STRING_CLASS INT64CONST(0x6c6b7570737472)
+
+/* The set of join keys collected for a single document */
+typedef struct LookupJoinKeys
+{
+	int64 *keys;
+	int numKeys;
+	int maxKeys;
+
+	/* Whether the string class key was already added */
+	bool hasStringClassKey;
+
+	/* Whether the null key was already added */
+	bool hasNullKey;
+} LookupJoinKeys;
+
+/* Per call state of the join key set returning functions */
+typedef struct LookupJoinKeysFuncState
+{
+	LookupJoinKeys joinKeys;
+	int currentKey;
+} LookupJoinKeysFuncState;
+
+
+static void AddJoinKey(LookupJoinKeys *joinKeys, int64 key);
+static void AddNullJoinKey(LookupJoinKeys *joinKeys);
+static void AddJoinKeyForValue(LookupJoinKeys *joinKeys, const bson_value_t *value,
+							   bool isLocalValue);
+static void SortAndDeduplicateJoinKeys(LookupJoinKeys *joinKeys);
+static int CompareJoinKeys(const void *left, const void *right);
+static Datum ReturnNextJoinKey(FunctionCallInfo fcinfo, FuncCallContext *funcContext);
+
+static bool JoinKeysContinueProcessIntermediateArray(void *state, const
+													 bson_value_t *value,
+													 bool isArrayIndexSearch);
+static void JoinKeysSetTraverseResult(void *state, TraverseBsonResult result);
+static bool JoinKeysVisitArrayField(pgbsonelement *element, const
+									StringView *traversePath, int arrayIndex,
+									void *state);
+static bool JoinKeysVisitTopLevelField(pgbsonelement *element, const
+									   StringView *traversePath, void *state);
+static void JoinKeysHandleIntermediateArrayPathNotFound(void *state, int32_t arrayIndex,
+														const StringView *remainingPath);
+
+static const TraverseBsonExecutionFuncs JoinKeysExecutionFuncs = {
+	.ContinueProcessIntermediateArray = JoinKeysContinueProcessIntermediateArray,
+	.SetTraverseResult = JoinKeysSetTraverseResult,
+	.VisitArrayField = JoinKeysVisitArrayField,
+	.VisitTopLevelField = JoinKeysVisitTopLevelField,
+	.SetIntermediateArrayIndex = NULL,
+	.HandleIntermediateArrayPathNotFound = JoinKeysHandleIntermediateArrayPathNotFound,
+	.SetIntermediateArrayStartEnd = NULL,
+};
+
+/* --------------------------------------------------------- */
+/* Top level exports */
+/* --------------------------------------------------------- */
+
+PG_FUNCTION_INFO_V1(bson_dollar_lookup_filter_hashes);
+PG_FUNCTION_INFO_V1(bson_dollar_lookup_document_hashes);
+
+
+/*
+ * bson_dollar_lookup_filter_hashes takes the lookup filter produced by
+ * bson_dollar_lookup_extract_filter_expression for the local document
+ * i.e. { "foreignField": [ <local values> ] } and returns the distinct
+ * join keys of the local values.
+ */
+Datum
+bson_dollar_lookup_filter_hashes(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcContext;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcContext = SRF_FIRSTCALL_INIT();
+		MemoryContext oldContext = MemoryContextSwitchTo(
+			funcContext->multi_call_memory_ctx);
+
+		pgbson *filter = PG_GETARG_PGBSON(0);
+		LookupJoinKeysFuncState *state = palloc0(sizeof(LookupJoinKeysFuncState));
+
+		bson_iter_t filterIter;
+		PgbsonInitIterator(filter, &filterIter);
+		if (!bson_iter_next(&filterIter) || !BSON_ITER_HOLDS_ARRAY(&filterIter))
+		{
+			ereport(ERROR, (errmsg("Lookup filter expected to contain an array")));
+		}
+
+		bson_iter_t valuesIter;
+		bson_iter_recurse(&filterIter, &valuesIter);
+		while (bson_iter_next(&valuesIter))
+		{
+			bool isLocalValue = true;
+			AddJoinKeyForValue(&state->joinKeys, bson_iter_value(&valuesIter),
+							   isLocalValue);
+		}
+
+		SortAndDeduplicateJoinKeys(&state->joinKeys);
+		funcContext->user_fctx = state;
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	funcContext = SRF_PERCALL_SETUP();
+	return ReturnNextJoinKey(fcinfo, funcContext);
+}
+
+
+/*
+ * bson_dollar_lookup_document_hashes takes a foreign document and the foreign
+ * field path and returns the distinct join keys of every value the $lookup join
+ * filter compares against at that path (the value itself and the elements of
+ * arrays along the path). Documents where the path is not found also return the
+ * null key since those match null local values.
+ */
+Datum
+bson_dollar_lookup_document_hashes(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcContext;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcContext = SRF_FIRSTCALL_INIT();
+		MemoryContext oldContext = MemoryContextSwitchTo(
+			funcContext->multi_call_memory_ctx);
+
+		pgbson *document = PG_GETARG_PGBSON(0);
+		char *path = text_to_cstring(PG_GETARG_TEXT_PP(1));
+		LookupJoinKeysFuncState *state = palloc0(sizeof(LookupJoinKeysFuncState));
+
+		bson_iter_t documentIterator;
+		PgbsonInitIterator(document, &documentIterator);
+		TraverseBson(&documentIterator, path, &state->joinKeys,
+					 &JoinKeysExecutionFuncs);
+
+		SortAndDeduplicateJoinKeys(&state->joinKeys);
+		funcContext->user_fctx = state;
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	funcContext = SRF_PERCALL_SETUP();
+	return ReturnNextJoinKey(fcinfo, funcContext);
+}
+
+
+/* --------------------------------------------------------- */
+/* Private helper methods */
+/* --------------------------------------------------------- */
+
+/*
+ * Returns the next join key of the set returning function or ends the set.
+ */
+static Datum
+ReturnNextJoinKey(FunctionCallInfo fcinfo, FuncCallContext *funcContext)
+{
+	LookupJoinKeysFuncState *state = (LookupJoinKeysFuncState *) funcContext->user_fctx;
+	if (state->currentKey < state->joinKeys.numKeys)
+	{
+		int64 key = state->joinKeys.keys[state->currentKey++];
+		SRF_RETURN_NEXT(funcContext, Int64GetDatum(key));
+	}
+
+	SRF_RETURN_DONE(funcContext);
+}
+
+
+static void
+AddJoinKey(LookupJoinKeys *joinKeys, int64 key)
+{
+	if (joinKeys->numKeys == joinKeys->maxKeys)
+	{
+		joinKeys->maxKeys = joinKeys->maxKeys == 0 ? 8 : joinKeys->maxKeys * 2;
+		joinKeys->keys = joinKeys->keys == NULL ?
+						 palloc(sizeof(int64) * joinKeys->maxKeys) :
+						 repalloc(joinKeys->keys, sizeof(int64) * joinKeys->maxKeys);
+	}
+
+	joinKeys->keys[joinKeys->numKeys++] = key;
+}
+
+
+/*
+ * Adds the key matching null, undefined and missing values.
+ */
+static void
+AddNullJoinKey(LookupJoinKeys *joinKeys)
+{
+	if (!joinKeys->hasNullKey)
+	{
+		bson_value_t nullValue = { 0 };
+		nullValue.value_type = BSON_TYPE_NULL;
+		AddJoinKey(joinKeys, (int64) HashBsonValueComparableExtended(&nullValue,
+																	 LOOKUP_JOIN_KEY_SEED));
+		joinKeys->hasNullKey = true;
+	}
+}
+
+
+/*
+ * Adds the join key of a value. The comparable hash is used (rather than the
+ * raw value hash) so that values that compare equal (e.g. 1 and 1.0, or null and
+ * undefined) map to the same key.
+ */
+static void
+AddJoinKeyForValue(LookupJoinKeys *joinKeys, const bson_value_t *value,
+				   bool isLocalValue)
+{
+	bool isStringClass = value->value_type == BSON_TYPE_UTF8 ||
+						 value->value_type == BSON_TYPE_SYMBOL ||
+						 value->value_type == BSON_TYPE_REGEX;
+
+	if (isStringClass && !joinKeys->hasStringClassKey)
+	{
+		/* Foreign strings & regexes can be matched by any local regex */
+		if (!isLocalValue || value->value_type == BSON_TYPE_REGEX)
+		{
+			AddJoinKey(joinKeys, LOOKUP_JOIN_KEY_STRING_CLASS);
+			joinKeys->hasStringClassKey = true;
+		}
+	}
+
+	if (isLocalValue && value->value_type == BSON_TYPE_REGEX)
+	{
+		return;
+	}
+
+	if (value->value_type == BSON_TYPE_NULL ||
+		value->value_type == BSON_TYPE_UNDEFINED)
+	{
+		AddNullJoinKey(joinKeys);
+		return;
+	}
+
+	AddJoinKey(joinKeys, (int64) HashBsonValueComparableExtended(value,
+																 LOOKUP_JOIN_KEY_SEED));
+}
+
+
+static void
+SortAndDeduplicateJoinKeys(LookupJoinKeys *joinKeys)
+{
+	if (joinKeys->numKeys <= 1)
+	{
+		return;
+	}
+
+	qsort(joinKeys->keys, joinKeys->numKeys, sizeof(int64), CompareJoinKeys);
+
+	int numUnique = 1;
+	for (int i = 1; i < joinKeys->numKeys; i++)
+	{
+		if (joinKeys->keys[i] != joinKeys->keys[numUnique - 1])
+		{
+			joinKeys->keys[numUnique++] = joinKeys->keys[i];
+		}
+	}
+
+	joinKeys->numKeys = numUnique;
+}
+
+
+static int
+CompareJoinKeys(const void *left, const void *right)
+{
+	int64 leftKey = *(const int64 *) left;
+	int64 rightKey = *(const int64 *) right;
+	return leftKey < rightKey ? -1 : (leftKey > rightKey ? 1 : 0);
+}
+
+
+/*
+ * Intermediate arrays are always walked since the join filter matches
+ * any of their elements.
+ */
+static bool
+JoinKeysContinueProcessIntermediateArray(void *state, const bson_value_t *value,
+										 bool isArrayIndexSearch)
+{
+	return true;
+}
+
+
+/*
+ * Paths that are not found (or can't be traversed) match null local values.
+ */
+static void
+JoinKeysSetTraverseResult(void *state, TraverseBsonResult result)
+{
+	AddNullJoinKey((LookupJoinKeys *) state);
+}
+
+
+static void
+JoinKeysHandleIntermediateArrayPathNotFound(void *state, int32_t arrayIndex,
+											const StringView *remainingPath)
+{
+	AddNullJoinKey((LookupJoinKeys *) state);
+}
+
+
+static bool
+JoinKeysVisitArrayField(pgbsonelement *element, const StringView *traversePath,
+						int arrayIndex, void *state)
+{
+	bool isLocalValue = false;
+	AddJoinKeyForValue((LookupJoinKeys *) state, &element->bsonValue, isLocalValue);
+	return true;
+}
+
+
+/*
+ * Adds the value at the path, arrays are added as a whole here and their elements
+ * through JoinKeysVisitArrayField.
+ */
+static bool
+JoinKeysVisitTopLevelField(pgbsonelement *element, const StringView *traversePath,
+						   void *state)
+{
+	bool isLocalValue = false;
+	AddJoinKeyForValue((LookupJoinKeys *) state, &element->bsonValue, isLocalValue);
+	return true;
+}
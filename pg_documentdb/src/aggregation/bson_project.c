@@ -38,7 +38,9 @@
 #include "utils/fmgr_utils.h"
 #include "commands/commands_common.h"
 #include "collation/collation.h"
+#include "utils/hashset_utils.h"
 
+extern bool EnableLookupFilterDeduplication;
 
 /* --------------------------------------------------------- */
 /* Error-Messages */
@@ -79,6 +81,11 @@ typedef struct BsonProjectionQueryState
 
 	/* Optional: Bson Project Document stage function hooks */
 	BsonProjectDocumentFunctions projectDocumentFuncs;
+
+	/* For projections that only include top level fields: the names of
+	 * the included fields, sorted for lookups (NULL otherwise) */
+	StringView *includedTopLevelFields;
+	int32 numIncludedTopLevelFields;
 } BsonProjectionQueryState;
 
 
@@ -125,6 +132,7 @@ static bool TraverseDocumentAndWriteLookupIndexCondition(pgbson_array_writer *ar
 static pgbson * BsonLookUpGetFilterExpression(pgbson *sourceDocument,
 											  pgbsonelement *lookupSpecElement, const
 											  char *collationString);
+static pgbson * DeduplicateLookupFilterValues(pgbson *filterExpression);
 
 static pgbson * BsonLookUpProject(pgbson *sourceDocument, int numMatchedDocuments,
 								  Datum *mathedArray, char *matchedDocsFieldName);
@@ -146,6 +154,10 @@ static void BuildBsonPathTreeForDollarProjectCore(BsonProjectionQueryState *stat
 												  BuildBsonPathTreeContext *
 												  pathTreeContext);
 static bool FilterNodeToWrite(void *state, int currentIndex);
+static void CompileTopLevelInclusionProjection(BsonProjectionQueryState *state);
+static pgbson * ProjectTopLevelInclusionDocument(pgbson *sourceDocument,
+												 const BsonProjectionQueryState *state);
+static int CompareStringViewForSort(const void *left, const void *right);
 static void PostProcessParseProjectNode(void *state, const StringView *path,
 										BsonPathNode *node,
 										bool *isExclusionIfNoInclusion,
@@ -1481,8 +1493,22 @@ pgbson *
 ProjectDocumentWithState(pgbson *sourceDocument,
 						 const BsonProjectionQueryState *state)
 {
+	if (state->includedTopLevelFields != NULL)
+	{
+		return ProjectTopLevelInclusionDocument(sourceDocument, state);
+	}
+
 	pgbson_writer writer;
-	PgbsonWriterInit(&writer);
+	if (state->projectNonMatchingFields)
+	{
+		/* $addFields/$set and exclusions write out most of the source document */
+		PgbsonWriterInitWithSizeHint(&writer, VARSIZE_ANY_EXHDR(sourceDocument));
+	}
+	else
+	{
+		PgbsonWriterInit(&writer);
+	}
+
 	bson_iter_t documentIterator;
 	PgbsonInitIterator(sourceDocument, &documentIterator);
 
@@ -1503,10 +1529,124 @@ ProjectDocumentWithState(pgbson *sourceDocument,
 				state->endTotalProjections);
 	}
 
+	/* Expressions on the same document share the lookups of its top level fields */
+	PgbsonFieldOffsetCacheScope fieldCacheScope =
+		PgbsonFieldOffsetCacheBegin(sourceDocument);
+
 	bool isInNestedArray = false;
 	TraverseObjectAndAppendToWriter(&documentIterator, state->root, &writer,
 									state->projectNonMatchingFields,
 									&projectDocState, isInNestedArray);
+
+	PgbsonFieldOffsetCacheEnd(fieldCacheScope);
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * Checks whether the projection only includes top level fields of the
+ * document (e.g. { a: 1, b: 1, _id: 0 }) and if so, keeps the sorted names of
+ * the included fields. These projections are then applied in a single pass
+ * over the document without walking the path tree.
+ */
+static void
+CompileTopLevelInclusionProjection(BsonProjectionQueryState *state)
+{
+	if (state->root == NULL || state->projectNonMatchingFields ||
+		state->projectDocumentFuncs.initializePendingProjectionFunc != NULL)
+	{
+		return;
+	}
+
+	int32 numIncludedFields = 0;
+	const BsonPathNode *child;
+	foreach_child(child, state->root)
+	{
+		if (child->nodeType == NodeType_LeafIncluded)
+		{
+			numIncludedFields++;
+		}
+		else if (child->nodeType != NodeType_LeafExcluded)
+		{
+			/* Nested paths and expressions need the path tree */
+			return;
+		}
+	}
+
+	if (numIncludedFields == 0)
+	{
+		return;
+	}
+
+	StringView *includedFields = palloc(sizeof(StringView) * numIncludedFields);
+	int32 index = 0;
+	foreach_child(child, state->root)
+	{
+		if (child->nodeType == NodeType_LeafIncluded)
+		{
+			includedFields[index++] = child->field;
+		}
+	}
+
+	qsort(includedFields, numIncludedFields, sizeof(StringView),
+		  CompareStringViewForSort);
+	state->includedTopLevelFields = includedFields;
+	state->numIncludedTopLevelFields = numIncludedFields;
+}
+
+
+static int
+CompareStringViewForSort(const void *left, const void *right)
+{
+	return CompareStringView((const StringView *) left, (const StringView *) right);
+}
+
+
+/*
+ * Applies a projection that only includes top level fields. The fields of
+ * the document are matched against the sorted names of the included fields,
+ * and each run of consecutive included fields is copied as is.
+ */
+static pgbson *
+ProjectTopLevelInclusionDocument(pgbson *sourceDocument,
+								 const BsonProjectionQueryState *state)
+{
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+
+	bson_iter_t documentIterator;
+	PgbsonInitIterator(sourceDocument, &documentIterator);
+
+	const uint8_t *runStart = NULL;
+	uint32_t runLength = 0;
+	while (bson_iter_next(&documentIterator))
+	{
+		StringView field = bson_iter_key_string_view(&documentIterator);
+		bool isIncluded = bsearch(&field, state->includedTopLevelFields,
+								  state->numIncludedTopLevelFields, sizeof(StringView),
+								  CompareStringViewForSort) != NULL;
+		if (isIncluded)
+		{
+			if (runStart == NULL)
+			{
+				runStart = documentIterator.raw + documentIterator.off;
+			}
+
+			runLength += documentIterator.next_off - documentIterator.off;
+		}
+		else if (runStart != NULL)
+		{
+			PgbsonWriterAppendRawElements(&writer, runStart, runLength);
+			runStart = NULL;
+			runLength = 0;
+		}
+	}
+
+	if (runStart != NULL)
+	{
+		PgbsonWriterAppendRawElements(&writer, runStart, runLength);
+	}
+
 	return PgbsonWriterGetPgbson(&writer);
 }
 
@@ -1677,6 +1817,7 @@ BuildBsonPathTreeForDollarProject(BsonProjectionQueryState *state,
 	context.allowInclusionExclusion = projectionContext->allowInclusionExclusion;
 
 	BuildBsonPathTreeForDollarProjectCore(state, projectionContext, &context);
+	CompileTopLevelInclusionProjection(state);
 }
 
 
@@ -1701,6 +1842,7 @@ BuildBsonPathTreeForDollarProjectFind(BsonProjectionQueryState *state,
 	BuildBsonPathTreeForDollarProjectCore(state, projectionContext, &context);
 	state->endTotalProjections = PostProcessStateForFind(&state->projectDocumentFuncs,
 														 &context);
+	CompileTopLevelInclusionProjection(state);
 }
 
 
@@ -1912,6 +2054,7 @@ BsonLookUpGetFilterExpression(pgbson *sourceDocument,
 		PgbsonArrayWriterWriteNull(&arrayWriter);
 	}
 
+	uint32_t numValues = PgbsonArrayWriterGetIndex(&arrayWriter);
 	PgbsonWriterEndArray(&writer, &arrayWriter);
 
 	if (IsCollationApplicable(collationString))
@@ -1919,6 +2062,65 @@ BsonLookUpGetFilterExpression(pgbson *sourceDocument,
 		PgbsonWriterAppendUtf8(&writer, "collation", 9, collationString);
 	}
 
+	pgbson *filterExpression = PgbsonWriterGetPgbson(&writer);
+	if (numValues > 1 && EnableLookupFilterDeduplication)
+	{
+		filterExpression = DeduplicateLookupFilterValues(filterExpression);
+	}
+
+	return filterExpression;
+}
+
+
+/*
+ * Removes the repeated values from the array of the lookup filter expression
+ * e.g. "a.b.c" : [ 1, 2, 1, 1 ] becomes "a.b.c" : [ 1, 2 ], so that the index
+ * isn't probed once per occurrence of a local value (arrays of references often
+ * repeat the same ones). The values are compared without the collation, values
+ * only equal under it are kept, which matches the same foreign documents.
+ */
+static pgbson *
+DeduplicateLookupFilterValues(pgbson *filterExpression)
+{
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+
+	bson_iter_t filterIter;
+	PgbsonInitIterator(filterExpression, &filterIter);
+
+	/* The array of values comes first, the collation (if any) is copied after it */
+	bson_iter_next(&filterIter);
+
+	pgbson_array_writer arrayWriter;
+	PgbsonWriterStartArray(&writer, bson_iter_key(&filterIter),
+						   bson_iter_key_len(&filterIter), &arrayWriter);
+
+	HTAB *writtenValues = CreateBsonValueHashSet();
+	bson_iter_t valuesIter;
+	bson_iter_recurse(&filterIter, &valuesIter);
+	while (bson_iter_next(&valuesIter))
+	{
+		const bson_value_t *value = bson_iter_value(&valuesIter);
+
+		bool found = false;
+		hash_search(writtenValues, value, HASH_ENTER, &found);
+		if (!found)
+		{
+			PgbsonArrayWriterWriteValue(&arrayWriter, value);
+		}
+	}
+
+	hash_destroy(writtenValues);
+	PgbsonWriterEndArray(&writer, &arrayWriter);
+
+	while (bson_iter_next(&filterIter))
+	{
+		PgbsonWriterAppendValue(&writer, bson_iter_key(&filterIter),
+								bson_iter_key_len(&filterIter),
+								bson_iter_value(&filterIter));
+	}
+
+	pfree(filterExpression);
 	return PgbsonWriterGetPgbson(&writer);
 }
 
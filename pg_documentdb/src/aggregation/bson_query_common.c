@@ -73,10 +73,22 @@ InitializeQueryDollarRange(const bson_value_t *filterValue,
 
 	if (rangeParams->isFullScan)
 	{
-		/* If full scan is requested, we ignore min and max values */
-		rangeParams->minValue.value_type = BSON_TYPE_MINKEY;
-		rangeParams->maxValue.value_type = BSON_TYPE_MAXKEY;
-		rangeParams->isMinInclusive = true;
-		rangeParams->isMaxInclusive = true;
+		/*
+		 * If full scan is requested, we ignore min and max values. An ordered scan
+		 * keeps the bound it resumes from (see CreateSortResumeSeekQual).
+		 */
+		if (rangeParams->orderScanDirection == 0 ||
+			rangeParams->minValue.value_type == BSON_TYPE_EOD)
+		{
+			rangeParams->minValue.value_type = BSON_TYPE_MINKEY;
+			rangeParams->isMinInclusive = true;
+		}
+
+		if (rangeParams->orderScanDirection == 0 ||
+			rangeParams->maxValue.value_type == BSON_TYPE_EOD)
+		{
+			rangeParams->maxValue.value_type = BSON_TYPE_MAXKEY;
+			rangeParams->isMaxInclusive = true;
+		}
 	}
 }
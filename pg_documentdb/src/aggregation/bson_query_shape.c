@@ -0,0 +1,246 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/aggregation/bson_query_shape.c
+ *
+ * Computes the query shape of find/aggregate requests.
+ *
+ * Two requests have the same shape if they only differ in the literals of
+ * their filters, limit and skip (and in per request options like batchSize
+ * or lsid). e.g. { find: "c", filter: { a: 1, b: { $gt: 5 } }, limit: 10 }
+ * and { find: "c", filter: { a: 2, b: { $gt: 7 } }, limit: 1 } share a shape.
+ * The type of each literal is still part of the shape since it usually
+ * changes the plan. Sort, projection and stages other than $match, $limit
+ * and $skip are hashed as is.
+ *
+ * The shape hash is set as the queryId of the generated query so that it
+ * shows up in EXPLAIN VERBOSE, in pg_stat_statements and in currentOp
+ * (through pg_stat_activity.query_id).
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <common/hashfn.h>
+#include <utils/backend_status.h>
+#include <utils/builtins.h>
+
+#include "aggregation/bson_query_shape.h"
+#include "io/bson_hash.h"
+
+/*
+ * Whether a value is part of the shape, or only its type is.
+ */
+typedef enum QueryShapeValueMode
+{
+	/* Scalars only contribute their type (filters, limit, skip) */
+	QueryShapeValueMode_Parameterized,
+
+	/* Values are part of the shape as is (sort, projection, other stages) */
+	QueryShapeValueMode_Literal,
+} QueryShapeValueMode;
+
+static uint64 HashQueryShapeField(uint64 hash, const char *key, uint32_t keyLength,
+								  const bson_value_t *value, QueryShapeValueMode mode);
+static uint64 HashQueryShapeDocument(uint64 hash, const bson_value_t *document,
+									 QueryShapeValueMode mode);
+static uint64 HashQueryShapePipeline(uint64 hash, const bson_value_t *pipeline);
+static bool IsQueryShapeIgnoredField(const char *key);
+static QueryShapeValueMode GetTopLevelFieldShapeMode(const char *key);
+
+extern bool EnableQueryShapeHash;
+
+/*
+ * Top level fields of find/aggregate requests that only affect how the
+ * results are returned and not the query itself.
+ */
+static const char *QueryShapeIgnoredFields[] = {
+	"$db", "$clusterTime", "$readPreference", "allowDiskUse",
+	"allowPartialResults", "apiDeprecationErrors", "apiStrict", "apiVersion",
+	"autocommit", "batchSize", "comment", "cursor", "lsid", "maxTimeMS",
+	"noCursorTimeout", "readConcern", "singleBatch", "startTransaction",
+	"txnNumber", "writeConcern"
+};
+
+
+/*
+ * Computes the query shape hash of a find/aggregate/count/distinct request
+ * on the given database.
+ */
+uint64
+ComputeQueryShapeHash(text *database, pgbson *querySpec)
+{
+	uint64 hash = 0;
+	if (database != NULL)
+	{
+		hash = hash_bytes_extended((const unsigned char *) VARDATA_ANY(database),
+								   VARSIZE_ANY_EXHDR(database), hash);
+	}
+
+	bson_iter_t specIter;
+	PgbsonInitIterator(querySpec, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		const char *key = bson_iter_key(&specIter);
+		if (IsQueryShapeIgnoredField(key))
+		{
+			continue;
+		}
+
+		const bson_value_t *value = bson_iter_value(&specIter);
+		if (strcmp(key, "pipeline") == 0 && value->value_type == BSON_TYPE_ARRAY)
+		{
+			hash = hash_bytes_extended((const unsigned char *) key, strlen(key), hash);
+			hash = HashQueryShapePipeline(hash, value);
+			continue;
+		}
+
+		hash = HashQueryShapeField(hash, key, bson_iter_key_len(&specIter), value,
+								   GetTopLevelFieldShapeMode(key));
+	}
+
+	/* 0 means no queryId in postgres */
+	return hash == 0 ? 1 : hash;
+}
+
+
+/*
+ * Sets the query shape hash of the request as the queryId of the generated
+ * query, and reports it for the backend so that currentOp can show it.
+ */
+void
+SetQueryShapeHash(Query *query, text *database, pgbson *querySpec)
+{
+	if (!EnableQueryShapeHash)
+	{
+		return;
+	}
+
+	query->queryId = ComputeQueryShapeHash(database, querySpec);
+
+	bool force = true;
+	pgstat_report_query_id(query->queryId, force);
+}
+
+
+/*
+ * Hashes a field of the request. Documents are walked recursively and arrays
+ * outside of logical operators are only hashed by their type in parameterized
+ * mode so that $in lists of different lengths share a shape.
+ */
+static uint64
+HashQueryShapeField(uint64 hash, const char *key, uint32_t keyLength,
+					const bson_value_t *value, QueryShapeValueMode mode)
+{
+	hash = hash_bytes_extended((const unsigned char *) key, keyLength, hash);
+	hash = hash_combine64(hash, value->value_type);
+
+	if (value->value_type == BSON_TYPE_DOCUMENT)
+	{
+		return HashQueryShapeDocument(hash, value, mode);
+	}
+
+	if (mode == QueryShapeValueMode_Literal)
+	{
+		return value->value_type == BSON_TYPE_ARRAY ?
+			   HashQueryShapeDocument(hash, value, mode) :
+			   HashBsonValueComparableExtended(value, hash);
+	}
+
+	if (value->value_type == BSON_TYPE_ARRAY &&
+		(strcmp(key, "$and") == 0 || strcmp(key, "$or") == 0 ||
+		 strcmp(key, "$nor") == 0))
+	{
+		return HashQueryShapeDocument(hash, value, mode);
+	}
+
+	return hash;
+}
+
+
+/*
+ * Hashes all the fields of a document (or the elements of an array).
+ */
+static uint64
+HashQueryShapeDocument(uint64 hash, const bson_value_t *document,
+					   QueryShapeValueMode mode)
+{
+	bson_iter_t documentIter;
+	BsonValueInitIterator(document, &documentIter);
+	while (bson_iter_next(&documentIter))
+	{
+		hash = HashQueryShapeField(hash, bson_iter_key(&documentIter),
+								   bson_iter_key_len(&documentIter),
+								   bson_iter_value(&documentIter), mode);
+	}
+
+	return hash;
+}
+
+
+/*
+ * Hashes an aggregation pipeline. The filters of $match stages and the
+ * values of $limit and $skip are parameterized, everything else is part
+ * of the shape.
+ */
+static uint64
+HashQueryShapePipeline(uint64 hash, const bson_value_t *pipeline)
+{
+	bson_iter_t pipelineIter;
+	BsonValueInitIterator(pipeline, &pipelineIter);
+	while (bson_iter_next(&pipelineIter))
+	{
+		const bson_value_t *stage = bson_iter_value(&pipelineIter);
+		if (stage->value_type != BSON_TYPE_DOCUMENT)
+		{
+			hash = HashBsonValueComparableExtended(stage, hash);
+			continue;
+		}
+
+		bson_iter_t stageIter;
+		BsonValueInitIterator(stage, &stageIter);
+		while (bson_iter_next(&stageIter))
+		{
+			const char *stageName = bson_iter_key(&stageIter);
+			QueryShapeValueMode mode =
+				strcmp(stageName, "$match") == 0 ||
+				strcmp(stageName, "$limit") == 0 ||
+				strcmp(stageName, "$skip") == 0 ?
+				QueryShapeValueMode_Parameterized : QueryShapeValueMode_Literal;
+			hash = HashQueryShapeField(hash, stageName, bson_iter_key_len(&stageIter),
+									   bson_iter_value(&stageIter), mode);
+		}
+	}
+
+	return hash;
+}
+
+
+/*
+ * Returns how the values of a top level field of the request are hashed.
+ */
+static QueryShapeValueMode
+GetTopLevelFieldShapeMode(const char *key)
+{
+	if (strcmp(key, "filter") == 0 || strcmp(key, "query") == 0 ||
+		strcmp(key, "limit") == 0 || strcmp(key, "skip") == 0)
+	{
+		return QueryShapeValueMode_Parameterized;
+	}
+
+	return QueryShapeValueMode_Literal;
+}
+
+
+static bool
+IsQueryShapeIgnoredField(const char *key)
+{
+	for (size_t i = 0; i < lengthof(QueryShapeIgnoredFields); i++)
+	{
+		if (strcmp(key, QueryShapeIgnoredFields[i]) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
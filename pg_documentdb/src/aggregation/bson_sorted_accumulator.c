@@ -29,9 +29,30 @@
 #include "utils/fmgr_utils.h"
 
 
+/* --------------------------------------------------------- */
+/* Type declaration */
+/* --------------------------------------------------------- */
+
+/*
+ * The sort specs of a sorted accumulator, deconstructed once per query and
+ * reused for every row when they're a constant of the query.
+ */
+typedef struct BsonOrderSortSpecs
+{
+	int numSortKeys;
+
+	/* The bson sort spec of each sort key, e.g. { "a": 1 } */
+	Datum sortSpecs[32];
+
+	/* Whether each sort key is ascending */
+	bool sortDirections[32];
+} BsonOrderSortSpecs;
+
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
+static void PopulateBsonOrderSortSpecs(BsonOrderSortSpecs *sortSpecs,
+									   ArrayType *sortSpecArray);
 static void ParseInputExpressionAndPersistValue(AggregationExpressionData *expressionData,
 												const bson_value_t *expressionValue,
 												ParseAggregationExpressionContext *context);
@@ -344,37 +365,40 @@ BsonOrderTransition(PG_FUNCTION_ARGS, bool invertSort, bool isSingle, bool
 	/* The 2nd argument is the input document*/
 	pgbson *inputDocument = PG_GETARG_MAYBE_NULL_PGBSON(1);
 	int64 numResults = 1;
-	ArrayType *val_array = NULL;
+	int sortSpecArgPosition = 2;
 
-	if (isSingle)
-	{
-		/* The 3rd argument is a list of sort specs */
-		val_array = PG_GETARG_ARRAYTYPE_P(2);
-	}
-	else
+	if (!isSingle)
 	{
 		/* The third parameter specifies the number of results that should be returned */
 		numResults = PG_GETARG_INT64(2);
 		Assert(numResults > 0);
 
 		/* The 4th argument is a list of sort specs */
-		val_array = PG_GETARG_ARRAYTYPE_P(3);
+		sortSpecArgPosition = 3;
 	}
 
-	Datum *sortSpecs;
-	bool *nulls;
-	int numSortKeys;
-	deconstruct_array(val_array,
-					  ARR_ELEMTYPE(val_array), -1, false, TYPALIGN_INT,
-					  &sortSpecs, &nulls, &numSortKeys);
-
-	Assert(numSortKeys != 0);
-	if (numSortKeys > 32)
+	/*
+	 * The sort specs are the same for every row of the group so they're only
+	 * deconstructed on the first row when they're a constant.
+	 */
+	ArrayType *sortSpecArray = PG_GETARG_ARRAYTYPE_P(sortSpecArgPosition);
+	const BsonOrderSortSpecs *cachedSortSpecs;
+	SetCachedFunctionState(
+		cachedSortSpecs,
+		BsonOrderSortSpecs,
+		sortSpecArgPosition,
+		PopulateBsonOrderSortSpecs,
+		sortSpecArray);
+
+	BsonOrderSortSpecs localSortSpecs;
+	if (cachedSortSpecs == NULL)
 	{
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg(
-							"Too many compound keys. A maximum of 32 keys is allowed.")));
+		PopulateBsonOrderSortSpecs(&localSortSpecs, sortSpecArray);
+		cachedSortSpecs = &localSortSpecs;
 	}
 
+	const Datum *sortSpecs = cachedSortSpecs->sortSpecs;
+	int numSortKeys = cachedSortSpecs->numSortKeys;
 
 	bool validateSort = false;
 
@@ -392,17 +416,8 @@ BsonOrderTransition(PG_FUNCTION_ARGS, bool invertSort, bool isSingle, bool
 		/* Only need one value right now. */
 		inputAggregateState.currentResult = palloc0(sizeof(BsonOrderAggValue *));
 		inputAggregateState.numSortKeys = numSortKeys;
-
-		for (int i = 0; i < numSortKeys; i++)
-		{
-			pgbson *sortKeySpec = DatumGetPgBson(sortSpecs[i]);
-			pgbsonelement sortKeyElement;
-			PgbsonToSinglePgbsonElement(sortKeySpec, &sortKeyElement);
-			sortKeyElement.pathLength = 0;
-			bool ascOrder = (BsonValueAsInt32(&sortKeyElement.bsonValue) == 1) ?
-							true : false;
-			inputAggregateState.sortDirections[i] = ascOrder;
-		}
+		memcpy(inputAggregateState.sortDirections, cachedSortSpecs->sortDirections,
+			   sizeof(bool) * numSortKeys);
 
 		/* Check if this is a single element sort call. */
 		if (isSingle)
@@ -550,6 +565,43 @@ BsonOrderTransition(PG_FUNCTION_ARGS, bool invertSort, bool isSingle, bool
 }
 
 
+/*
+ * Deconstructs the array of bson sort specs of a sorted accumulator along
+ * with the direction of each sort key.
+ */
+static void
+PopulateBsonOrderSortSpecs(BsonOrderSortSpecs *sortSpecs, ArrayType *sortSpecArray)
+{
+	Datum *sortSpecDatums;
+	bool *nulls;
+	int numSortKeys;
+	deconstruct_array(sortSpecArray,
+					  ARR_ELEMTYPE(sortSpecArray), -1, false, TYPALIGN_INT,
+					  &sortSpecDatums, &nulls, &numSortKeys);
+
+	Assert(numSortKeys != 0);
+	if (numSortKeys > 32)
+	{
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg(
+							"Too many compound keys. A maximum of 32 keys is allowed.")));
+	}
+
+	sortSpecs->numSortKeys = numSortKeys;
+	for (int i = 0; i < numSortKeys; i++)
+	{
+		/* Copied as the array may be detoasted in the memory of the current row */
+		pgbson *sortKeySpec = CopyPgbsonIntoMemoryContext(
+			DatumGetPgBson(sortSpecDatums[i]), CurrentMemoryContext);
+		sortSpecs->sortSpecs[i] = PointerGetDatum(sortKeySpec);
+
+		pgbsonelement sortKeyElement;
+		PgbsonToSinglePgbsonElement(sortKeySpec, &sortKeyElement);
+		sortSpecs->sortDirections[i] =
+			BsonValueAsInt32(&sortKeyElement.bsonValue) == 1;
+	}
+}
+
+
 /*
  * Applies the "state transition" (SFUNC) for accumulator.
  * The args are:
@@ -39,6 +39,7 @@
 
 #include "utils/documentdb_errors.h"
 #include "io/bson_core.h"
+#include "aggregation/bson_tdigest.h"
 
 /*
  * A centroid, used both for in-memory and on-disk storage.
@@ -129,6 +130,22 @@ static int centroid_cmp(const void *a, const void *b);
 #define MIN_COMPRESSION 10
 #define MAX_COMPRESSION 10000
 
+/*
+ * A t-digest persisted as a binary value ($percentileSketch) so that
+ * sketches built per bucket can be stored and merged later. The centroids
+ * of the compacted digest follow the header.
+ */
+typedef struct tdigest_sketch_t
+{
+	int32 version;              /* format of the sketch */
+	int32 compression;          /* compression used to build the sketch */
+	int64 count;                /* number of items added to the sketch */
+	int32 ncentroids;           /* number of centroids following the header */
+	int32 reserved;
+} tdigest_sketch_t;
+
+#define TDIGEST_SKETCH_VERSION 1
+
 
 /* prototypes */
 PG_FUNCTION_INFO_V1(tdigest_add_double);
@@ -139,6 +156,9 @@ PG_FUNCTION_INFO_V1(tdigest_array_percentiles);
 PG_FUNCTION_INFO_V1(tdigest_serial);
 PG_FUNCTION_INFO_V1(tdigest_deserial);
 PG_FUNCTION_INFO_V1(tdigest_combine);
+PG_FUNCTION_INFO_V1(tdigest_add_double_for_sketch);
+PG_FUNCTION_INFO_V1(tdigest_sketch_final);
+PG_FUNCTION_INFO_V1(tdigest_add_sketch);
 
 Datum tdigest_add_double(PG_FUNCTION_ARGS);
 Datum tdigest_add_double_array(PG_FUNCTION_ARGS);
@@ -148,6 +168,9 @@ Datum tdigest_array_percentiles(PG_FUNCTION_ARGS);
 Datum tdigest_serial(PG_FUNCTION_ARGS);
 Datum tdigest_deserial(PG_FUNCTION_ARGS);
 Datum tdigest_combine(PG_FUNCTION_ARGS);
+Datum tdigest_add_double_for_sketch(PG_FUNCTION_ARGS);
+Datum tdigest_sketch_final(PG_FUNCTION_ARGS);
+Datum tdigest_add_sketch(PG_FUNCTION_ARGS);
 
 static Datum double_array_to_bson_array(FunctionCallInfo fcinfo, double *darray, int len);
 static double * bson_to_double_array(FunctionCallInfo fcinfo, bson_value_t *barray,
@@ -1144,6 +1167,266 @@ tdigest_combine(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * Add a value to the tdigest (create one if needed). Transition function
+ * for the aggregate building a persistable sketch ($percentileSketch).
+ */
+Datum
+tdigest_add_double_for_sketch(PG_FUNCTION_ARGS)
+{
+	tdigest_aggstate_t *state;
+	MemoryContext aggcontext;
+
+	/* cannot be called directly because of internal-type argument */
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+	{
+		elog(ERROR, "tdigest_add_double_for_sketch called in non-aggregate context");
+	}
+
+	if (PG_ARGISNULL(0))
+	{
+		int compression = PG_GETARG_INT32(2);
+		check_compression(compression);
+
+		MemoryContext oldcontext = MemoryContextSwitchTo(aggcontext);
+		state = tdigest_aggstate_allocate(0, 0, compression);
+		MemoryContextSwitchTo(oldcontext);
+	}
+	else
+	{
+		state = (tdigest_aggstate_t *) PG_GETARG_POINTER(0);
+	}
+
+	pgbson *inputPgbson = PG_GETARG_MAYBE_NULL_PGBSON(1);
+	if (inputPgbson == NULL || IsPgbsonEmptyDocument(inputPgbson))
+	{
+		PG_RETURN_POINTER(state);
+	}
+
+	pgbsonelement inputPgbsonElement;
+	PgbsonToSinglePgbsonElement(inputPgbson, &inputPgbsonElement);
+	if (BsonValueIsNumber(&inputPgbsonElement.bsonValue) && !IsBsonValueNaN(
+			&inputPgbsonElement.bsonValue))
+	{
+		double value = BsonValueAsDoubleQuiet(&inputPgbsonElement.bsonValue);
+		tdigest_add(state, value);
+	}
+
+	PG_RETURN_POINTER(state);
+}
+
+
+/*
+ * Final function of $percentileSketch: compacts the digest and writes it
+ * as a binary value that $percentile/$median can merge with method
+ * 'mergeSketches'.
+ */
+Datum
+tdigest_sketch_final(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+
+	/* cannot be called directly because of internal-type argument */
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+	{
+		elog(ERROR, "tdigest_sketch_final called in non-aggregate context");
+	}
+
+	pgbsonelement finalValue;
+	finalValue.path = "";
+	finalValue.pathLength = 0;
+
+	if (PG_ARGISNULL(0))
+	{
+		finalValue.bsonValue.value_type = BSON_TYPE_NULL;
+		PG_RETURN_POINTER(PgbsonElementToPgbson(&finalValue));
+	}
+
+	tdigest_aggstate_t *state = (tdigest_aggstate_t *) PG_GETARG_POINTER(0);
+	tdigest_compact(state);
+
+	Size centroidsSize = state->ncentroids * sizeof(centroid_t);
+	Size sketchSize = sizeof(tdigest_sketch_t) + centroidsSize;
+	char *sketchBytes = palloc(sketchSize);
+
+	tdigest_sketch_t header = {
+		.version = TDIGEST_SKETCH_VERSION,
+		.compression = state->compression,
+		.count = state->count,
+		.ncentroids = state->ncentroids,
+		.reserved = 0
+	};
+	memcpy(sketchBytes, &header, sizeof(tdigest_sketch_t));
+	memcpy(sketchBytes + sizeof(tdigest_sketch_t), state->centroids, centroidsSize);
+
+	finalValue.bsonValue.value_type = BSON_TYPE_BINARY;
+	finalValue.bsonValue.value.v_binary.subtype = BSON_SUBTYPE_USER;
+	finalValue.bsonValue.value.v_binary.data = (uint8_t *) sketchBytes;
+	finalValue.bsonValue.value.v_binary.data_len = (uint32_t) sketchSize;
+
+	PG_RETURN_POINTER(PgbsonElementToPgbson(&finalValue));
+}
+
+
+/*
+ * Merges a sketch written by $percentileSketch into the tdigest (create one
+ * if needed). Transition function for $percentile and $median with method
+ * 'mergeSketches'. The percentiles are given as an array ($percentile) or
+ * as a single number ($median).
+ */
+Datum
+tdigest_add_sketch(PG_FUNCTION_ARGS)
+{
+	tdigest_aggstate_t *state;
+	MemoryContext aggcontext;
+
+	/* cannot be called directly because of internal-type argument */
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+	{
+		elog(ERROR, "tdigest_add_sketch called in non-aggregate context");
+	}
+
+	if (PG_ARGISNULL(0))
+	{
+		int compression = PG_GETARG_INT32(2);
+		check_compression(compression);
+
+		pgbson *percentilesPgbson = PG_GETARG_MAYBE_NULL_PGBSON(3);
+		if (percentilesPgbson == NULL || IsPgbsonEmptyDocument(percentilesPgbson))
+		{
+			PG_RETURN_NULL();
+		}
+
+		pgbsonelement percentilesPgbsonElement;
+		PgbsonToSinglePgbsonElement(percentilesPgbson, &percentilesPgbsonElement);
+
+		double singlePercentile;
+		double *percentiles;
+		int npercentiles;
+		if (percentilesPgbsonElement.bsonValue.value_type == BSON_TYPE_ARRAY)
+		{
+			percentiles = bson_to_double_array(fcinfo,
+											   &percentilesPgbsonElement.bsonValue,
+											   &npercentiles);
+		}
+		else
+		{
+			singlePercentile = BsonValueAsDouble(&percentilesPgbsonElement.bsonValue);
+			percentiles = &singlePercentile;
+			npercentiles = 1;
+		}
+
+		check_percentiles(percentiles, npercentiles);
+
+		MemoryContext oldcontext = MemoryContextSwitchTo(aggcontext);
+		state = tdigest_aggstate_allocate(npercentiles, 0, compression);
+		memcpy(state->percentiles, percentiles, sizeof(double) * npercentiles);
+		MemoryContextSwitchTo(oldcontext);
+	}
+	else
+	{
+		state = (tdigest_aggstate_t *) PG_GETARG_POINTER(0);
+	}
+
+	pgbson *inputPgbson = PG_GETARG_MAYBE_NULL_PGBSON(1);
+	if (inputPgbson == NULL || IsPgbsonEmptyDocument(inputPgbson))
+	{
+		PG_RETURN_POINTER(state);
+	}
+
+	pgbsonelement inputPgbsonElement;
+	PgbsonToSinglePgbsonElement(inputPgbson, &inputPgbsonElement);
+
+	/* documents without a sketch (e.g. empty buckets) are skipped */
+	if (inputPgbsonElement.bsonValue.value_type == BSON_TYPE_NULL ||
+		inputPgbsonElement.bsonValue.value_type == BSON_TYPE_UNDEFINED)
+	{
+		PG_RETURN_POINTER(state);
+	}
+
+	const bson_value_t *sketchValue = &inputPgbsonElement.bsonValue;
+	tdigest_sketch_t header;
+	if (sketchValue->value_type != BSON_TYPE_BINARY ||
+		sketchValue->value.v_binary.subtype != BSON_SUBTYPE_USER ||
+		sketchValue->value.v_binary.data_len < sizeof(tdigest_sketch_t))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE), errmsg(
+							"Expected a sketch produced by $percentileSketch, but instead received: %s",
+							BsonValueToJsonForLogging(sketchValue))));
+	}
+
+	memcpy(&header, sketchValue->value.v_binary.data, sizeof(tdigest_sketch_t));
+	if (header.version != TDIGEST_SKETCH_VERSION || header.ncentroids < 0 ||
+		sketchValue->value.v_binary.data_len !=
+		sizeof(tdigest_sketch_t) + header.ncentroids * sizeof(centroid_t))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE), errmsg(
+							"The percentile sketch is corrupted or has an unsupported format")));
+	}
+
+	const uint8_t *centroidBytes = sketchValue->value.v_binary.data +
+								   sizeof(tdigest_sketch_t);
+	for (int i = 0; i < header.ncentroids; i++)
+	{
+		centroid_t centroid;
+		memcpy(&centroid, centroidBytes + i * sizeof(centroid_t), sizeof(centroid_t));
+
+		/* same as tdigest_add, but the centroid keeps its weight */
+		state->centroids[state->ncentroids] = centroid;
+		state->ncentroids++;
+		state->count += centroid.count;
+		state->ncompacted = 0;
+
+		if (state->ncentroids == BUFFER_SIZE(state->compression))
+		{
+			tdigest_compact(state);
+		}
+	}
+
+	PG_RETURN_POINTER(state);
+}
+
+
+/*
+ * Creates a t-digest for the requested percentiles, for callers that build
+ * the digest from C rather than through the aggregates.
+ */
+TDigestState *
+CreateTDigestState(const double *percentiles, int npercentiles, int compression)
+{
+	check_compression(compression);
+
+	tdigest_aggstate_t *state = tdigest_aggstate_allocate(npercentiles, 0,
+														  compression);
+	if (npercentiles > 0)
+	{
+		memcpy(state->percentiles, percentiles, sizeof(double) * npercentiles);
+		check_percentiles(state->percentiles, npercentiles);
+	}
+
+	return state;
+}
+
+
+void
+TDigestAddValue(TDigestState *state, double value)
+{
+	tdigest_add(state, value);
+}
+
+
+/*
+ * Estimates the requested percentiles, result must have room for all of them.
+ * The digest must have at least one value.
+ */
+void
+TDigestComputePercentiles(TDigestState *state, double *result)
+{
+	Assert(state->count > 0);
+	tdigest_compute_quantiles(state, result);
+}
+
+
 /*
  * Comparator, ordering the centroids by mean value.
  *
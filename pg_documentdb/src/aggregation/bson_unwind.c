@@ -9,6 +9,7 @@
  */
 
 #include <postgres.h>
+#include <funcapi.h>
 
 #include "aggregation/bson_project.h"
 #include "aggregation/bson_projection_tree.h"
@@ -30,13 +31,66 @@ typedef struct DistinctTraverseState
 } DistinctTraverseState;
 
 
+/*
+ * State of the $unwind of a single document. The unwound documents are produced
+ * one at a time by BsonUnwindNext so that they can be streamed by a value per call
+ * set returning function instead of being materialized in a tuplestore first.
+ */
+typedef struct BsonUnwindState
+{
+	/* The source document */
+	pgbson *document;
+
+	/* The path being unwound (without the $ prefix) */
+	char *path;
+
+	/* Optional name of the index field to add to the output */
+	char *indexFieldName;
+
+	/* Whether to keep null and empty unwind values */
+	bool preserveNullAndEmpty;
+
+	/*
+	 * Whether the path and the index field are top level fields, in which case the
+	 * output documents are written directly rather than through a projection tree.
+	 */
+	bool isTopLevelPath;
+
+	/* Whether the value at the path is an array that is being iterated */
+	bool isArray;
+
+	/* Iterator over the array at the path */
+	bson_iter_t arrayIterator;
+
+	/* The index of the next element of the array */
+	long index;
+
+	/* The single output for non array values at the path, if any */
+	bool hasSingleResult;
+	Datum singleResult;
+
+	/* Whether all the outputs have been produced */
+	bool isDone;
+} BsonUnwindState;
+
+
 static pgbson * BsonUnwindElement(pgbson *document, char *path, char *indexFieldName,
 								  long index, const bson_value_t *element);
+static pgbson * BsonUnwindTopLevelElement(pgbson *document, const char *path,
+										  const char *indexFieldName, long index,
+										  const bson_value_t *element);
+static pgbson * BsonUnwindStateElement(BsonUnwindState *state, long index,
+									   const bson_value_t *element);
 static pgbson * BsonUnwindEmptyArray(pgbson *document, char *path, char *indexFieldName);
-static Datum BsonUnwindArray(PG_FUNCTION_ARGS, Tuplestorestate *tupleState,
-							 TupleDesc *tupleDescriptor,
-							 char *path, char *indexFieldName, bool
-							 preserveNullAndEmpty);
+static void InitializeBsonUnwindState(BsonUnwindState *state, pgbson *document,
+									  Datum documentDatum, char *path,
+									  char *indexFieldName, bool preserveNullAndEmpty);
+static bool BsonUnwindNext(BsonUnwindState *state, Datum *result);
+static Datum BsonUnwindValuePerCall(PG_FUNCTION_ARGS, FuncCallContext *funcContext);
+static Datum BsonUnwindMaterialize(PG_FUNCTION_ARGS, char *path, char *indexFieldName,
+								   bool preserveNullAndEmpty);
+static void ParseUnwindOptions(pgbson *spec, char **path, char **indexFieldName,
+							   bool *preserveNullAndEmpty);
 static bool DistinctContinueProcessIntermediateArray(void *state, const
 													 bson_value_t *value, bool
 													 isArrayIndexSearch);
@@ -56,6 +110,8 @@ PG_FUNCTION_INFO_V1(bson_dollar_unwind_with_options);
 PG_FUNCTION_INFO_V1(bson_distinct_unwind);
 PG_FUNCTION_INFO_V1(bson_lookup_unwind);
 
+extern bool EnableStreamingUnwind;
+
 /*
  * bson_dollar_unwind_with_options takes:
  * 1) a bson document
@@ -69,65 +125,37 @@ PG_FUNCTION_INFO_V1(bson_lookup_unwind);
 Datum
 bson_dollar_unwind_with_options(PG_FUNCTION_ARGS)
 {
-	pgbson *spec = PG_GETARG_PGBSON_PACKED(1);
-
 	char *path = NULL;
 	bool preserveNullAndEmpty = false;
 	char *indexFieldName = NULL;
 
-	bson_iter_t specIter;
-	PgbsonInitIterator(spec, &specIter);
-	while (bson_iter_next(&specIter))
+	if (!EnableStreamingUnwind)
 	{
-		if (strcmp(bson_iter_key(&specIter), "path") == 0)
-		{
-			const bson_value_t *pathValue = bson_iter_value(&specIter);
-			if (pathValue->value_type != BSON_TYPE_UTF8)
-			{
-				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
-									"$unwind path must be a text value")));
-			}
-
-			path = pathValue->value.v_utf8.str;
-		}
-		else if (strcmp(bson_iter_key(&specIter), "preserveNullAndEmptyArrays") == 0)
-		{
-			const bson_value_t *preserveNullAndEmptyValue = bson_iter_value(&specIter);
-			if (preserveNullAndEmptyValue->value_type != BSON_TYPE_BOOL)
-			{
-				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
-									"$unwind preserveNullAndEmptyArrays must be a bool value")));
-			}
-			preserveNullAndEmpty = preserveNullAndEmptyValue->value.v_bool;
-		}
-		else if (strcmp(bson_iter_key(&specIter), "includeArrayIndex") == 0)
-		{
-			const bson_value_t *arrayIndex = bson_iter_value(&specIter);
-			if (arrayIndex->value_type != BSON_TYPE_UTF8)
-			{
-				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
-									"$unwind includeArrayIndex must be a text value")));
-			}
-			indexFieldName = arrayIndex->value.v_utf8.str;
-		}
-		else
-		{
-			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
-								"option not recognized during unwind stage")));
-		}
+		ParseUnwindOptions(PG_GETARG_PGBSON_PACKED(1), &path, &indexFieldName,
+						   &preserveNullAndEmpty);
+		return BsonUnwindMaterialize(fcinfo, path, indexFieldName,
+									 preserveNullAndEmpty);
 	}
 
-	if (path == NULL)
+	FuncCallContext *funcContext;
+	if (SRF_IS_FIRSTCALL())
 	{
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
-							"$unwind requires a path")));
+		funcContext = SRF_FIRSTCALL_INIT();
+		MemoryContext oldContext = MemoryContextSwitchTo(
+			funcContext->multi_call_memory_ctx);
+
+		ParseUnwindOptions(PG_GETARG_PGBSON(1), &path, &indexFieldName,
+						   &preserveNullAndEmpty);
+
+		BsonUnwindState *state = palloc0(sizeof(BsonUnwindState));
+		InitializeBsonUnwindState(state, PG_GETARG_PGBSON(0), PG_GETARG_DATUM(0), path,
+								  indexFieldName, preserveNullAndEmpty);
+		funcContext->user_fctx = state;
+		MemoryContextSwitchTo(oldContext);
 	}
 
-	TupleDesc descriptor;
-	Tuplestorestate *tupleStore = SetupBsonTuplestore(fcinfo, &descriptor);
-
-	return BsonUnwindArray(fcinfo, tupleStore, &descriptor, path, indexFieldName,
-						   preserveNullAndEmpty);
+	funcContext = SRF_PERCALL_SETUP();
+	return BsonUnwindValuePerCall(fcinfo, funcContext);
 }
 
 
@@ -144,12 +172,29 @@ bson_dollar_unwind(PG_FUNCTION_ARGS)
 	char *indexFieldName = NULL;
 	bool preserveNullAndEmpty = false;
 
-	TupleDesc descriptor;
-	Tuplestorestate *tupleStore = SetupBsonTuplestore(fcinfo, &descriptor);
+	if (!EnableStreamingUnwind)
+	{
+		return BsonUnwindMaterialize(fcinfo, text_to_cstring(PG_GETARG_TEXT_PP(1)),
+									 indexFieldName, preserveNullAndEmpty);
+	}
 
-	return BsonUnwindArray(fcinfo, tupleStore, &descriptor, text_to_cstring(
-							   PG_GETARG_TEXT_PP(1)), indexFieldName,
-						   preserveNullAndEmpty);
+	FuncCallContext *funcContext;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcContext = SRF_FIRSTCALL_INIT();
+		MemoryContext oldContext = MemoryContextSwitchTo(
+			funcContext->multi_call_memory_ctx);
+
+		BsonUnwindState *state = palloc0(sizeof(BsonUnwindState));
+		InitializeBsonUnwindState(state, PG_GETARG_PGBSON(0), PG_GETARG_DATUM(0),
+								  text_to_cstring(PG_GETARG_TEXT_PP(1)),
+								  indexFieldName, preserveNullAndEmpty);
+		funcContext->user_fctx = state;
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	funcContext = SRF_PERCALL_SETUP();
+	return BsonUnwindValuePerCall(fcinfo, funcContext);
 }
 
 
@@ -245,7 +290,84 @@ bson_lookup_unwind(PG_FUNCTION_ARGS)
 /* --------------------------------------------------------- */
 
 /*
- * BsonUnwindArray is the internal implementation of $unwind as a set returning function
+ * Parses the options of $unwind of the form
+ *      { path: "$a.b", preserveNullAndEmptyArrays: bool, includeArrayIndex: string }
+ */
+static void
+ParseUnwindOptions(pgbson *spec, char **path, char **indexFieldName,
+				   bool *preserveNullAndEmpty)
+{
+	bson_iter_t specIter;
+	PgbsonInitIterator(spec, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		if (strcmp(bson_iter_key(&specIter), "path") == 0)
+		{
+			const bson_value_t *pathValue = bson_iter_value(&specIter);
+			if (pathValue->value_type != BSON_TYPE_UTF8)
+			{
+				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
+									"$unwind path must be a text value")));
+			}
+
+			*path = pathValue->value.v_utf8.str;
+		}
+		else if (strcmp(bson_iter_key(&specIter), "preserveNullAndEmptyArrays") == 0)
+		{
+			const bson_value_t *preserveNullAndEmptyValue = bson_iter_value(&specIter);
+			if (preserveNullAndEmptyValue->value_type != BSON_TYPE_BOOL)
+			{
+				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
+									"$unwind preserveNullAndEmptyArrays must be a bool value")));
+			}
+			*preserveNullAndEmpty = preserveNullAndEmptyValue->value.v_bool;
+		}
+		else if (strcmp(bson_iter_key(&specIter), "includeArrayIndex") == 0)
+		{
+			const bson_value_t *arrayIndex = bson_iter_value(&specIter);
+			if (arrayIndex->value_type != BSON_TYPE_UTF8)
+			{
+				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
+									"$unwind includeArrayIndex must be a text value")));
+			}
+			*indexFieldName = arrayIndex->value.v_utf8.str;
+		}
+		else
+		{
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
+								"option not recognized during unwind stage")));
+		}
+	}
+
+	if (*path == NULL)
+	{
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg(
+							"$unwind requires a path")));
+	}
+}
+
+
+/*
+ * Returns the next unwound document of a value per call $unwind or ends the set.
+ */
+static Datum
+BsonUnwindValuePerCall(PG_FUNCTION_ARGS, FuncCallContext *funcContext)
+{
+	BsonUnwindState *state = (BsonUnwindState *) funcContext->user_fctx;
+
+	Datum result;
+	if (BsonUnwindNext(state, &result))
+	{
+		SRF_RETURN_NEXT(funcContext, result);
+	}
+
+	SRF_RETURN_DONE(funcContext);
+}
+
+
+/*
+ * BsonUnwindMaterialize is the materialized implementation of $unwind as a set
+ * returning function that writes all the unwound documents to a tuplestore.
  *      path -> The path to be unwound
  *      indexFieldName -> optional string to add the index in the output document
  *      preserveNullAndEmpty -> whether to keep null and empty unwind values
@@ -253,12 +375,40 @@ bson_lookup_unwind(PG_FUNCTION_ARGS)
  *  PG_FUNCTION_ARGS contains the document
  */
 static Datum
-BsonUnwindArray(PG_FUNCTION_ARGS, Tuplestorestate *tupleStore, TupleDesc *tupleDescriptor,
-				char *path, char *indexFieldName, bool
-				preserveNullAndEmpty)
+BsonUnwindMaterialize(PG_FUNCTION_ARGS, char *path, char *indexFieldName,
+					  bool preserveNullAndEmpty)
 {
+	TupleDesc descriptor;
+	Tuplestorestate *tupleStore = SetupBsonTuplestore(fcinfo, &descriptor);
 	pgbson *document = PG_GETARG_PGBSON_PACKED(0);
 
+	BsonUnwindState state = { 0 };
+	InitializeBsonUnwindState(&state, document, PG_GETARG_DATUM(0), path,
+							  indexFieldName, preserveNullAndEmpty);
+
+	Datum values[1];
+	bool nulls[1] = { false };
+	while (BsonUnwindNext(&state, &values[0]))
+	{
+		tuplestore_putvalues(tupleStore, descriptor, values, nulls);
+	}
+
+	PG_FREE_IF_COPY(document, 0);
+	PG_RETURN_VOID();
+}
+
+
+/*
+ * InitializeBsonUnwindState validates the unwind path and positions the state
+ * at the value found at the path of the document.
+ *      path -> The path to be unwound
+ *      indexFieldName -> optional string to add the index in the output document
+ *      preserveNullAndEmpty -> whether to keep null and empty unwind values
+ */
+static void
+InitializeBsonUnwindState(BsonUnwindState *state, pgbson *document, Datum documentDatum,
+						  char *path, char *indexFieldName, bool preserveNullAndEmpty)
+{
 	/* Strip the $ prefix from the path */
 	if (strlen(path) <= 1)
 	{
@@ -273,6 +423,19 @@ BsonUnwindArray(PG_FUNCTION_ARGS, Tuplestorestate *tupleStore, TupleDesc *tupleD
 	}
 	path = path + 1;
 
+	state->document = document;
+	state->path = path;
+	state->indexFieldName = indexFieldName;
+	state->preserveNullAndEmpty = preserveNullAndEmpty;
+	state->isTopLevelPath = EnableStreamingUnwind && strchr(path, '.') == NULL &&
+							(indexFieldName == NULL ||
+							 (strchr(indexFieldName, '.') == NULL &&
+							  strcmp(indexFieldName, path) != 0));
+	state->isArray = false;
+	state->index = 0;
+	state->hasSingleResult = false;
+	state->isDone = false;
+
 	/* Start the iterator at the provided path */
 	bson_iter_t documentIterator;
 	if (!PgbsonInitIteratorAtPath(document, path, &documentIterator))
@@ -283,19 +446,12 @@ BsonUnwindArray(PG_FUNCTION_ARGS, Tuplestorestate *tupleStore, TupleDesc *tupleD
 			/* undefined elements are preserved */
 			bson_value_t element;
 			element.value_type = BSON_TYPE_EOD;
-			Datum values[1];
-			bool isNull = false;
-
-			values[0] = PointerGetDatum(BsonUnwindElement(document,
-														  path,
-														  indexFieldName,
-														  -1,
-														  &element));
-			tuplestore_putvalues(tupleStore, *tupleDescriptor, values, &isNull);
+			state->hasSingleResult = true;
+			state->singleResult = PointerGetDatum(BsonUnwindStateElement(state, -1,
+																		 &element));
 		}
 
-		PG_FREE_IF_COPY(document, 0);
-		PG_RETURN_VOID();
+		return;
 	}
 
 	if (!BSON_ITER_HOLDS_ARRAY(&documentIterator))
@@ -303,86 +459,116 @@ BsonUnwindArray(PG_FUNCTION_ARGS, Tuplestorestate *tupleStore, TupleDesc *tupleD
 		if (!BSON_ITER_HOLDS_NULL(&documentIterator))
 		{
 			/* Single non-null elements are always preserved */
-			Datum values[1];
-			bool nulls[1];
-
+			state->hasSingleResult = true;
 			if (indexFieldName == NULL)
 			{
 				/* This is just the source doc */
-				values[0] = PG_GETARG_DATUM(0);
+				state->singleResult = documentDatum;
 			}
 			else
 			{
 				const bson_value_t *element = bson_iter_value(&documentIterator);
-				values[0] = PointerGetDatum(BsonUnwindElement(document,
-															  path,
-															  indexFieldName,
-															  -1,
-															  element));
+				state->singleResult = PointerGetDatum(BsonUnwindStateElement(state, -1,
+																			 element));
 			}
-
-			nulls[0] = false;
-
-			tuplestore_putvalues(tupleStore, *tupleDescriptor, values, nulls);
 		}
 		else if (preserveNullAndEmpty)
 		{
 			/* Nulls are persisted if the document is preserved in the output */
 			bson_value_t element;
 			element.value_type = BSON_TYPE_NULL;
-			Datum values[1];
-			bool isNull = false;
-
-			values[0] = PointerGetDatum(BsonUnwindElement(document,
-														  path,
-														  indexFieldName,
-														  -1,
-														  &element));
-			tuplestore_putvalues(tupleStore, *tupleDescriptor, values, &isNull);
+			state->hasSingleResult = true;
+			state->singleResult = PointerGetDatum(BsonUnwindStateElement(state, -1,
+																		 &element));
 		}
 
-		PG_FREE_IF_COPY(document, 0);
-		PG_RETURN_VOID();
+		return;
 	}
 
-	bson_iter_t childIterator;
-
 	/* If the target path is an array, recurse into it */
-	bson_iter_recurse(&documentIterator, &childIterator);
+	state->isArray = true;
+	bson_iter_recurse(&documentIterator, &state->arrayIterator);
+}
+
+
+/*
+ * BsonUnwindNext produces the next unwound document of the state in result.
+ * Returns false once all the unwound documents have been produced.
+ */
+static bool
+BsonUnwindNext(BsonUnwindState *state, Datum *result)
+{
+	if (state->isDone)
+	{
+		return false;
+	}
+
+	if (!state->isArray)
+	{
+		state->isDone = true;
+		*result = state->singleResult;
+		return state->hasSingleResult;
+	}
 
-	long index = 0;
-	while (bson_iter_next(&childIterator))
+	if (bson_iter_next(&state->arrayIterator))
 	{
 		/* Project normal array elements and single non-null elements */
-		const bson_value_t *element = bson_iter_value(&childIterator);
+		const bson_value_t *element = bson_iter_value(&state->arrayIterator);
+		*result = PointerGetDatum(BsonUnwindStateElement(state, state->index, element));
+		state->index++;
+		return true;
+	}
 
-		pgbson *result = BsonUnwindElement(document, path, indexFieldName, index,
-										   element);
+	state->isDone = true;
+	if (state->index == 0 && state->preserveNullAndEmpty)
+	{
+		/* Empty arrays are removed if the document is preserved in the output */
+		*result = PointerGetDatum(BsonUnwindEmptyArray(state->document, state->path,
+													   state->indexFieldName));
+		return true;
+	}
 
-		Datum values[1];
-		bool nulls[1];
+	return false;
+}
 
-		values[0] = PointerGetDatum(result);
-		nulls[0] = false;
-		tuplestore_putvalues(tupleStore, *tupleDescriptor, values, nulls);
 
-		index++;
+/*
+ * Produces the output document for the element at the unwind target of the state.
+ */
+static pgbson *
+BsonUnwindStateElement(BsonUnwindState *state, long index, const bson_value_t *element)
+{
+	if (state->isTopLevelPath)
+	{
+		return BsonUnwindTopLevelElement(state->document, state->path,
+										 state->indexFieldName, index, element);
 	}
 
-	if (index == 0 && preserveNullAndEmpty)
-	{
-		Datum values[1];
-		bool isNull = false;
+	return BsonUnwindElement(state->document, state->path, state->indexFieldName,
+							 index, element);
+}
 
-		/* Empty arrays are removed if the document is preserved in the output */
-		values[0] = PointerGetDatum(BsonUnwindEmptyArray(
-										document, path,
-										indexFieldName));
-		tuplestore_putvalues(tupleStore, *tupleDescriptor, values, &isNull);
+
+/*
+ * Returns the value of the index field of an unwound document,
+ * null for values that are not array elements.
+ */
+static inline bson_value_t
+GetUnwindIndexValue(long index)
+{
+	bson_value_t indexValue;
+	memset(&indexValue, 0, sizeof(bson_value_t));
+	if (index > -1)
+	{
+		indexValue.value_type = BSON_TYPE_INT64;
+		indexValue.value.v_int64 = index;
+	}
+	else
+	{
+		indexValue.value_type = BSON_TYPE_NULL;
 	}
 
-	PG_FREE_IF_COPY(document, 0);
-	PG_RETURN_VOID();
+	return indexValue;
 }
 
 
@@ -444,18 +630,7 @@ BsonUnwindElement(pgbson *document, char *path, char *indexFieldName, long index
 	/* Create the node for the new indexField name */
 	if (indexFieldName != NULL)
 	{
-		bson_value_t indexValue;
-		memset(&indexValue, 0, sizeof(bson_value_t));
-		if (index > -1)
-		{
-			indexValue.value_type = BSON_TYPE_INT64;
-			indexValue.value.v_int64 = index;
-		}
-		else
-		{
-			indexValue.value_type = BSON_TYPE_NULL;
-		}
-
+		bson_value_t indexValue = GetUnwindIndexValue(index);
 		StringView indexFieldView = CreateStringViewFromString(indexFieldName);
 		TraverseDottedPathAndAddLeafFieldNode(&indexFieldView,
 											  &indexValue,
@@ -485,6 +660,55 @@ BsonUnwindElement(pgbson *document, char *path, char *indexFieldName, long index
 }
 
 
+/*
+ * BsonUnwindTopLevelElement produces the same document as BsonUnwindElement when
+ * the unwind path and the index field are top level fields. The fields of the source
+ * document are copied as is except for the unwound field which is replaced by the
+ * element, which avoids building a projection tree for every element of the array.
+ * As with $addFields, a new index field is added at the end of the document.
+ */
+static pgbson *
+BsonUnwindTopLevelElement(pgbson *document, const char *path, const char *indexFieldName,
+						  long index, const bson_value_t *element)
+{
+	pgbson_writer writer;
+	bson_iter_t documentIterator;
+	PgbsonWriterInit(&writer);
+	PgbsonInitIterator(document, &documentIterator);
+
+	bool indexFieldWritten = false;
+	while (bson_iter_next(&documentIterator))
+	{
+		const char *key = bson_iter_key(&documentIterator);
+		uint32_t keyLength = bson_iter_key_len(&documentIterator);
+		if (element->value_type != BSON_TYPE_EOD && strcmp(key, path) == 0)
+		{
+			PgbsonWriterAppendValue(&writer, key, keyLength, element);
+		}
+		else if (indexFieldName != NULL && strcmp(key, indexFieldName) == 0)
+		{
+			bson_value_t indexValue = GetUnwindIndexValue(index);
+			PgbsonWriterAppendValue(&writer, key, keyLength, &indexValue);
+			indexFieldWritten = true;
+		}
+		else
+		{
+			PgbsonWriterAppendValue(&writer, key, keyLength,
+									bson_iter_value(&documentIterator));
+		}
+	}
+
+	if (indexFieldName != NULL && !indexFieldWritten)
+	{
+		bson_value_t indexValue = GetUnwindIndexValue(index);
+		PgbsonWriterAppendValue(&writer, indexFieldName, strlen(indexFieldName),
+								&indexValue);
+	}
+
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
 /*
  * BsonUnwindEmptyArray produces the output document when an empty array is found
  * at the unwind target
@@ -11,6 +11,7 @@
 #include <postgres.h>
 #include <utils/builtins.h>
 #include <executor/spi.h>
+#include <utils/timestamp.h>
 
 #include "metadata/collection.h"
 #include "utils/documentdb_errors.h"
@@ -26,6 +27,10 @@
 
 
 static const char *IndexUsageKey = "index_usage";
+static const char *IndexTuplesKey = "index_tuples";
+static const char *IndexLastUsedKey = "index_last_used";
+
+extern bool EnableIndexStatsAccessDetails;
 
 PG_FUNCTION_INFO_V1(command_index_stats_aggregation);
 PG_FUNCTION_INFO_V1(command_index_stats_worker);
@@ -40,6 +45,10 @@ static pgbson * IndexStatsWorker(void *fcinfoPointer);
 
 static void MergeWorkerResults(MongoCollection *collection, List *workerResults,
 							   Tuplestorestate *tupleStore, TupleDesc tupleDescriptor);
+static void AddIndexStatToHash(HTAB *indexHash, const char *indexName,
+							   const bson_value_t *value);
+static void WriteIndexStatsHash(pgbson_writer *writer, const char *key, HTAB *indexHash);
+static void AddIndexStatsDocumentsToHash(List *indexDocs, HTAB *indexHash);
 
 
 /*
@@ -159,14 +168,19 @@ IndexStatsWorker(void *fcinfoPointer)
 	Assert(shardNames != NULL);
 
 	/*
-	 * Walk the indexes for these shards and write out their sizes.
+	 * Walk the indexes for these shards and write out their accesses.
+	 * idx_tup_read is the index entries returned by the scans of the index,
+	 * last_idx_scan is only tracked from PG16 onwards.
 	 */
-	pgbson_writer indexWriter;
-	PgbsonWriterStartDocument(&writer, IndexUsageKey, -1, &indexWriter);
-
+#if PG_VERSION_NUM >= 160000
+	const char *query =
+		"SELECT indexrelid, idx_scan, idx_tup_read, last_idx_scan"
+		" FROM pg_catalog.pg_stat_all_indexes WHERE relid =ANY ($1)";
+#else
 	const char *query =
-		"SELECT indexrelid, idx_scan FROM pg_catalog.pg_stat_all_indexes "
-		" WHERE relid =ANY ($1)";
+		"SELECT indexrelid, idx_scan, idx_tup_read, NULL::timestamptz"
+		" FROM pg_catalog.pg_stat_all_indexes WHERE relid =ANY ($1)";
+#endif
 
 	int nargs = 1;
 	Oid argTypes[1] = { OIDARRAYOID };
@@ -176,6 +190,8 @@ IndexStatsWorker(void *fcinfoPointer)
 	MemoryContext priorMemoryContext = CurrentMemoryContext;
 
 	HTAB *indexHash = CreatePgbsonElementHashSet();
+	HTAB *indexTuplesHash = CreatePgbsonElementHashSet();
+	HTAB *indexLastUsedHash = CreatePgbsonElementHashSet();
 	SPI_connect();
 
 	Portal statsPortal = SPI_cursor_open_with_args("workerIndexUsageStats", query, nargs,
@@ -218,7 +234,31 @@ IndexStatsWorker(void *fcinfoPointer)
 					continue;
 				}
 
-				int64 indexAccesses = DatumGetInt64(resultDatum);
+				bson_value_t indexAccesses = { 0 };
+				indexAccesses.value_type = BSON_TYPE_INT64;
+				indexAccesses.value.v_int64 = DatumGetInt64(resultDatum);
+
+				AttrNumber tuplesAttribute = 3;
+				bool tuplesIsNull;
+				resultDatum = SPI_getbinval(SPI_tuptable->vals[tupleNumber],
+											SPI_tuptable->tupdesc, tuplesAttribute,
+											&tuplesIsNull);
+				bson_value_t indexTuples = { 0 };
+				indexTuples.value_type = BSON_TYPE_INT64;
+				indexTuples.value.v_int64 = tuplesIsNull ? 0 : DatumGetInt64(resultDatum);
+
+				AttrNumber lastUsedAttribute = 4;
+				bool lastUsedIsNull;
+				resultDatum = SPI_getbinval(SPI_tuptable->vals[tupleNumber],
+											SPI_tuptable->tupdesc, lastUsedAttribute,
+											&lastUsedIsNull);
+				bson_value_t indexLastUsed = { 0 };
+				if (!lastUsedIsNull)
+				{
+					indexLastUsed.value_type = BSON_TYPE_DATE_TIME;
+					indexLastUsed.value.v_datetime =
+						GetDateTimeFromTimestamp(DatumGetTimestampTz(resultDatum));
+				}
 
 				/* Now write the result */
 				MemoryContext spiContext = MemoryContextSwitchTo(priorMemoryContext);
@@ -228,20 +268,17 @@ IndexStatsWorker(void *fcinfoPointer)
 																				useLibPq);
 				if (collectionIndexName != NULL)
 				{
-					pgbsonelement element = { 0 };
-					element.path = collectionIndexName;
-					element.pathLength = strlen(collectionIndexName);
-					element.bsonValue.value_type = BSON_TYPE_INT64;
-					element.bsonValue.value.v_int64 = indexAccesses;
-
-					bool found = false;
-					pgbsonelement *foundElement = hash_search(indexHash, &element,
-															  HASH_ENTER, &found);
-					if (found)
+					AddIndexStatToHash(indexHash, collectionIndexName, &indexAccesses);
+
+					if (EnableIndexStatsAccessDetails)
 					{
-						bool overflowedIgnore;
-						AddNumberToBsonValue(&foundElement->bsonValue, &element.bsonValue,
-											 &overflowedIgnore);
+						AddIndexStatToHash(indexTuplesHash, collectionIndexName,
+										   &indexTuples);
+						if (!lastUsedIsNull)
+						{
+							AddIndexStatToHash(indexLastUsedHash, collectionIndexName,
+											   &indexLastUsed);
+						}
 					}
 				}
 
@@ -258,21 +295,86 @@ IndexStatsWorker(void *fcinfoPointer)
 	SPI_cursor_close(statsPortal);
 	SPI_finish();
 
+	WriteIndexStatsHash(&writer, IndexUsageKey, indexHash);
+	hash_destroy(indexHash);
+
+	/* The details are only sent when requested, older coordinators reject them */
+	if (EnableIndexStatsAccessDetails)
+	{
+		WriteIndexStatsHash(&writer, IndexTuplesKey, indexTuplesHash);
+		WriteIndexStatsHash(&writer, IndexLastUsedKey, indexLastUsedHash);
+	}
+
+	hash_destroy(indexTuplesHash);
+	hash_destroy(indexLastUsedHash);
+
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * Accumulates a statistic of an index across the shards of the collection:
+ * counts are added and last used dates keep the latest one.
+ */
+static void
+AddIndexStatToHash(HTAB *indexHash, const char *indexName, const bson_value_t *value)
+{
+	pgbsonelement element = { 0 };
+	element.path = indexName;
+	element.pathLength = strlen(indexName);
+	element.bsonValue = *value;
+
+	bool found = false;
+	pgbsonelement *foundElement = hash_search(indexHash, &element, HASH_ENTER, &found);
+	if (!found)
+	{
+		return;
+	}
+
+	if (value->value_type == BSON_TYPE_DATE_TIME)
+	{
+		if (foundElement->bsonValue.value_type != BSON_TYPE_DATE_TIME ||
+			value->value.v_datetime > foundElement->bsonValue.value.v_datetime)
+		{
+			foundElement->bsonValue = *value;
+		}
+	}
+	else
+	{
+		bool overflowedIgnore = false;
+		AddNumberToBsonValue(&foundElement->bsonValue, value, &overflowedIgnore);
+	}
+}
+
+
+/*
+ * Writes the { "indexName": value } document of the statistics in the hash.
+ */
+static void
+WriteIndexStatsHash(pgbson_writer *writer, const char *key, HTAB *indexHash)
+{
+	pgbson_writer indexWriter;
+	PgbsonWriterStartDocument(writer, key, -1, &indexWriter);
+
 	HASH_SEQ_STATUS seq_status;
 	pgbsonelement *entry;
 
 	hash_seq_init(&seq_status, indexHash);
 	while ((entry = hash_seq_search(&seq_status)) != NULL)
 	{
-		int64 totalAccesses = BsonValueAsInt64(&entry->bsonValue);
-		PgbsonWriterAppendInt64(&indexWriter, entry->path, entry->pathLength,
-								totalAccesses);
+		if (entry->bsonValue.value_type == BSON_TYPE_DATE_TIME)
+		{
+			PgbsonWriterAppendValue(&indexWriter, entry->path, entry->pathLength,
+									&entry->bsonValue);
+		}
+		else
+		{
+			PgbsonWriterAppendInt64(&indexWriter, entry->path, entry->pathLength,
+									BsonValueAsInt64(&entry->bsonValue));
+		}
 	}
 
-	hash_destroy(indexHash);
-
-	PgbsonWriterEndDocument(&writer, &indexWriter);
-	return PgbsonWriterGetPgbson(&writer);
+	PgbsonWriterEndDocument(writer, &indexWriter);
 }
 
 
@@ -281,7 +383,7 @@ IndexStatsWorker(void *fcinfoPointer)
  * set of index documents that can be merged.
  */
 static List *
-ParseWorkerResults(List *workerResults)
+ParseWorkerResults(List *workerResults, List **indexTupleDocs, List **indexLastUsedDocs)
 {
 	ListCell *workerCell;
 
@@ -313,6 +415,18 @@ ParseWorkerResults(List *workerResults)
 				*value = *bson_iter_value(&workerIter);
 				indexDocs = lappend(indexDocs, value);
 			}
+			else if (strcmp(key, IndexTuplesKey) == 0)
+			{
+				bson_value_t *value = palloc(sizeof(bson_value_t));
+				*value = *bson_iter_value(&workerIter);
+				*indexTupleDocs = lappend(*indexTupleDocs, value);
+			}
+			else if (strcmp(key, IndexLastUsedKey) == 0)
+			{
+				bson_value_t *value = palloc(sizeof(bson_value_t));
+				*value = *bson_iter_value(&workerIter);
+				*indexLastUsedDocs = lappend(*indexLastUsedDocs, value);
+			}
 			else
 			{
 				ereport(ERROR, (errmsg("unknown field received from indexStats worker %s",
@@ -340,7 +454,10 @@ static void
 MergeWorkerResults(MongoCollection *collection, List *workerResults,
 				   Tuplestorestate *tupleStore, TupleDesc tupleDescriptor)
 {
-	List *indexDocs = ParseWorkerResults(workerResults);
+	List *indexTupleDocs = NIL;
+	List *indexLastUsedDocs = NIL;
+	List *indexDocs = ParseWorkerResults(workerResults, &indexTupleDocs,
+										 &indexLastUsedDocs);
 
 	bool excludeIdIndex = false;
 
@@ -359,31 +476,14 @@ MergeWorkerResults(MongoCollection *collection, List *workerResults,
 	 * into the bsonElement hash. If the entry for that indexName
 	 * already exists, add to the existing size.
 	 */
-	ListCell *indexCell;
-	foreach(indexCell, indexDocs)
-	{
-		bson_value_t *value = lfirst(indexCell);
-		bson_iter_t indexDocIter;
-		BsonValueInitIterator(value, &indexDocIter);
+	AddIndexStatsDocumentsToHash(indexDocs, bsonElementHash);
 
-		while (bson_iter_next(&indexDocIter))
-		{
-			pgbsonelement element = { 0 };
-			element.path = bson_iter_key(&indexDocIter);
-			element.pathLength = bson_iter_key_len(&indexDocIter);
-			element.bsonValue = *bson_iter_value(&indexDocIter);
-
-			bool found = false;
-			pgbsonelement *foundVal = hash_search(bsonElementHash, &element, HASH_ENTER,
-												  &found);
-			if (found)
-			{
-				bool overflowedIgnore = false;
-				AddNumberToBsonValue(&foundVal->bsonValue, &element.bsonValue,
-									 &overflowedIgnore);
-			}
-		}
-	}
+	/* The workers only report these with documentdb.enableIndexStatsAccessDetails */
+	bool hasAccessDetails = indexTupleDocs != NIL;
+	HTAB *indexTuplesHash = CreatePgbsonElementHashSet();
+	HTAB *indexLastUsedHash = CreatePgbsonElementHashSet();
+	AddIndexStatsDocumentsToHash(indexTupleDocs, indexTuplesHash);
+	AddIndexStatsDocumentsToHash(indexLastUsedDocs, indexLastUsedHash);
 
 	/* Extract postmaster start time */
 	TimestampTz timestamp = PgStartTime;
@@ -421,6 +521,26 @@ MergeWorkerResults(MongoCollection *collection, List *workerResults,
 		PgbsonWriterStartDocument(&writer, "accesses", 8, &childWriter);
 		PgbsonWriterAppendInt64(&childWriter, "ops", 3, usages);
 		PgbsonWriterAppendValue(&childWriter, "since", 5, &startTimeValue);
+
+		if (hasAccessDetails)
+		{
+			foundElement = hash_search(indexTuplesHash, &elem, HASH_FIND, &found);
+			PgbsonWriterAppendInt64(&childWriter, "keysExamined", 12,
+									found ? BsonValueAsInt64(&foundElement->bsonValue) :
+									0);
+
+			foundElement = hash_search(indexLastUsedHash, &elem, HASH_FIND, &found);
+			if (found)
+			{
+				PgbsonWriterAppendValue(&childWriter, "lastUsed", 8,
+										&foundElement->bsonValue);
+			}
+			else
+			{
+				PgbsonWriterAppendNull(&childWriter, "lastUsed", 8);
+			}
+		}
+
 		PgbsonWriterEndDocument(&writer, &childWriter);
 		PgbsonWriterAppendDocument(&writer, "spec", 4, IndexSpecAsBson(
 									   &details->indexSpec));
@@ -432,4 +552,28 @@ MergeWorkerResults(MongoCollection *collection, List *workerResults,
 	}
 
 	hash_destroy(bsonElementHash);
+	hash_destroy(indexTuplesHash);
+	hash_destroy(indexLastUsedHash);
+}
+
+
+/*
+ * Merges the { "indexName": value } documents of the workers into the hash.
+ */
+static void
+AddIndexStatsDocumentsToHash(List *indexDocs, HTAB *indexHash)
+{
+	ListCell *indexCell;
+	foreach(indexCell, indexDocs)
+	{
+		bson_value_t *value = lfirst(indexCell);
+		bson_iter_t indexDocIter;
+		BsonValueInitIterator(value, &indexDocIter);
+
+		while (bson_iter_next(&indexDocIter))
+		{
+			AddIndexStatToHash(indexHash, bson_iter_key(&indexDocIter),
+							   bson_iter_value(&indexDocIter));
+		}
+	}
 }
@@ -69,6 +69,8 @@ extern char *LocalhostConnectionString;
 extern int LatchTimeOutSec;
 extern int BackgroundWorkerJobTimeoutThresholdSec;
 extern bool PopulateBackgroundWorkerJobsTable;
+extern int MaxParallelBackgroundJobExecutions;
+extern char *ApiGucPrefixV2;
 
 static bool BackgroundWorkerReloadConfig = false;
 
@@ -152,6 +154,13 @@ typedef struct
 
 	/* Unique job execution instance ID (for telemetry). */
 	uint32_t jobInstanceId;
+
+	/*
+	 * The partition of the job's work this execution processes, for jobs that
+	 * support partitioned execution (partitionCount is 1 otherwise).
+	 */
+	int partitionIndex;
+	int partitionCount;
 } BackgroundWorkerJobExecution;
 
 extern void RegisterBackgroundWorkerJobAllowedCommand(BackgroundWorkerJobCommand command);
@@ -319,6 +328,9 @@ DocumentDBBackgroundWorkerMain(Datum main_arg)
 	/* Create list of job executions */
 	List *jobExecutions = NIL;
 
+	/* The number of parallel executions the job executions were generated with */
+	int jobExecutionsParallelism = MaxParallelBackgroundJobExecutions;
+
 	while (!got_sigterm)
 	{
 		/*
@@ -327,17 +339,22 @@ DocumentDBBackgroundWorkerMain(Datum main_arg)
 		 * below exists to adjust the internal state gracefuly when the
 		 * GUC value changes in real time.
 		 */
-		if (jobExecutions != NIL)
+		if (jobExecutions != NIL &&
+			(!EnableBackgroundWorkerJobs ||
+			 jobExecutionsParallelism != MaxParallelBackgroundJobExecutions))
 		{
-			if (!EnableBackgroundWorkerJobs)
-			{
-				FreeJobExecutions(jobExecutions);
-				jobExecutions = NIL;
-			}
+			/*
+			 * The partitions of the running executions are tied to the number of parallel
+			 * executions, so the executions are regenerated when it changes.
+			 */
+			FreeJobExecutions(jobExecutions);
+			jobExecutions = NIL;
 		}
-		else if (EnableBackgroundWorkerJobs)
+
+		if (jobExecutions == NIL && EnableBackgroundWorkerJobs)
 		{
 			jobExecutions = GenerateJobExecutions();
+			jobExecutionsParallelism = MaxParallelBackgroundJobExecutions;
 		}
 
 		/*
@@ -666,6 +683,16 @@ ExecuteJob(BackgroundWorkerJobExecution *jobExec, char *userName, char *database
 						 databaseName,
 						 jobExec->job.jobName);
 
+		if (jobExec->partitionCount > 1)
+		{
+			/* Assign the execution its partition of the job's work */
+			appendStringInfo(localhostConnStr,
+							 " options='-c %s.backgroundJobPartitionIndex=%d"
+							 " -c %s.backgroundJobPartitionCount=%d'",
+							 ApiGucPrefixV2, jobExec->partitionIndex,
+							 ApiGucPrefixV2, jobExec->partitionCount);
+		}
+
 		char *connStr = localhostConnStr->data;
 
 		conn = PQconnectStart(connStr);
@@ -890,7 +917,10 @@ CheckIfJobCommandIsAllowed(BackgroundWorkerJobCommand command)
 
 /*
  * Iterates JobRegistry array and returns a List of BackgroundWorkerJobExecution.
- * There's a 1:1 match between both entities.
+ * There's a 1:1 match between both entities, except for jobs that support partitioned
+ * execution which get one execution per partition. Each of these executions runs on
+ * its own connection, is scheduled and timed out on its own and logs its own events,
+ * so that a slow partition does not hold back the others.
  */
 static List *
 GenerateJobExecutions(void)
@@ -901,6 +931,8 @@ GenerateJobExecutions(void)
 	{
 		BackgroundWorkerJob job = JobRegistry[i];
 		BackgroundWorkerJobExecution *jobExec = CreateJobExecutionObj(job);
+		int partitionCount = job.supportsPartitionedExecution ?
+							 MaxParallelBackgroundJobExecutions : 1;
 
 		/*
 		 * Check for nullity. NULL is returned if an error happened while creating
@@ -928,6 +960,17 @@ GenerateJobExecutions(void)
 							 job.toBeExecutedOnMetadataCoordinatorOnly);
 
 			jobExecutions = lappend(jobExecutions, jobExec);
+			jobExec->partitionCount = partitionCount;
+
+			for (int partitionIndex = 1; partitionIndex < partitionCount;
+				 partitionIndex++)
+			{
+				BackgroundWorkerJobExecution *partitionJobExec =
+					palloc(sizeof(BackgroundWorkerJobExecution));
+				*partitionJobExec = *jobExec;
+				partitionJobExec->partitionIndex = partitionIndex;
+				jobExecutions = lappend(jobExecutions, partitionJobExec);
+			}
 
 			pfree(jobName->data);
 			pfree(jobName);
@@ -1045,6 +1088,8 @@ CreateJobExecutionObj(BackgroundWorkerJob job)
 	jobExec->commandQuery = commandQuery;
 	jobExec->jobInstanceId = 0;
 	jobExec->state = EXEC_STATE_IDLING;
+	jobExec->partitionIndex = 0;
+	jobExec->partitionCount = 1;
 
 	return jobExec;
 }
@@ -14,8 +14,12 @@
 #include <funcapi.h>
 #include <utils/varlena.h>
 #include <access/xact.h>
+#include <nodes/makefuncs.h>
+#include <storage/latch.h>
 #include <storage/proc.h>
 #include <utils/backend_status.h>
+#include <utils/timestamp.h>
+#include <utils/wait_event.h>
 
 #include <metadata/metadata_cache.h>
 #include <utils/documentdb_errors.h>
@@ -27,11 +31,14 @@
 #include <aggregation/bson_aggregation_pipeline.h>
 #include "aggregation/aggregation_commands.h"
 #include "infrastructure/cursor_store.h"
+#include "utils/command_activity.h"
 
 
 extern bool EnableNowSystemVariable;
 extern bool UseFileBasedPersistedCursors;
 extern bool EnableDelayedHoldPortal;
+extern int MaxTailableCursorAwaitTimeMs;
+extern int TailableCursorAwaitPollIntervalMs;
 
 /* --------------------------------------------------------- */
 /* Data types */
@@ -60,7 +67,12 @@ typedef enum CursorKind
 	/*
 	 * The cursor is a tailable cursor.
 	 */
-	CursorKind_Tailable = 3
+	CursorKind_Tailable = 3,
+
+	/*
+	 * The cursor is a sorted find streamed from a resume key.
+	 */
+	CursorKind_SortedStreaming = 4
 } CursorKind;
 
 
@@ -131,6 +143,12 @@ typedef struct
 	 * file based persisted cursors.
 	 */
 	bytea *cursorFileState;
+
+	/*
+	 * The resume key of a sorted streaming cursor, NULL if the
+	 * next page starts from the first document.
+	 */
+	pgbson *sortResumeKey;
 } QueryGetMoreInfo;
 
 /* --------------------------------------------------------- */
@@ -153,6 +171,17 @@ static pgbson * BuildPersistedContinuationDocument(const char *cursorName, int64
 												   timeSystemVariables,
 												   int numIterations);
 
+static Query * GenerateSortedStreamingGetMoreQuery(text *database,
+												   QueryGetMoreInfo *getMoreInfo,
+												   QueryData *queryData,
+												   bool setStatementTimeout);
+static pgbson * BuildSortedStreamingContinuationDocument(pgbson *querySpec,
+														 int64_t cursorId,
+														 pgbson *sortResumeKey,
+														 TimeSystemVariables *
+														 timeSystemVariables,
+														 int numIterations);
+
 static pgbson * BuildPersistedFileContinuationDocument(const char *cursorName, int64_t
 													   cursorId, QueryKind queryKind,
 													   TimeSystemVariables *
@@ -202,6 +231,7 @@ aggregate_cursor_first_page(text *database, pgbson *aggregationSpec,
 							int64_t cursorId)
 {
 	ReportFeatureUsage(FEATURE_COMMAND_AGG_CURSOR_FIRST_PAGE);
+	PublishCommandActivity("command", database, aggregationSpec);
 
 	bool generateCursorParams = true;
 	bool setStatementTimeout = true;
@@ -235,6 +265,7 @@ Datum
 find_cursor_first_page(text *database, pgbson *findSpec, int64_t cursorId)
 {
 	ReportFeatureUsage(FEATURE_COMMAND_FIND_CURSOR_FIRST_PAGE);
+	PublishCommandActivity("query", database, findSpec);
 
 	/* Parse the find spec for the purposes of query execution */
 	QueryData queryData = GenerateFirstPageQueryData();
@@ -499,6 +530,33 @@ aggregation_cursor_get_more(text *database, pgbson *getMoreSpec,
 			break;
 		}
 
+		case CursorKind_SortedStreaming:
+		{
+			QueryData queryData = { 0 };
+			bool setStatementTimeout = false;
+			Query *query = GenerateSortedStreamingGetMoreQuery(database, &getMoreInfo,
+															   &queryData,
+															   setStatementTimeout);
+
+			int numIterations = 0;
+			pgbson *sortResumeKey = NULL;
+			queryFullyDrained = DrainSortedStreamingQuery(query,
+														  getMoreInfo.queryData.batchSize,
+														  &numIterations,
+														  accumulatedSize,
+														  &arrayWriter,
+														  &sortResumeKey);
+			continuationDoc = queryFullyDrained ? NULL :
+							  BuildSortedStreamingContinuationDocument(
+				getMoreInfo.querySpec,
+				getMoreInfo.cursorId,
+				sortResumeKey,
+				&getMoreInfo.queryData.
+				timeSystemVariables,
+				numIterations);
+			break;
+		}
+
 		case CursorKind_Tailable:
 		{
 			Query *query;
@@ -517,6 +575,56 @@ aggregation_cursor_get_more(text *database, pgbson *getMoreSpec,
 													  getMoreInfo.queryData.batchSize,
 													  &numIterations,
 													  accumulatedSize, &arrayWriter);
+
+			/*
+			 * awaitData cursors: rather than returning an empty batch right away and
+			 * having the client spin on getMore, wait for new results up to
+			 * maxAwaitTimeMS (bounded by MaxTailableCursorAwaitTimeMs). The wait is on
+			 * the process latch so cancellation and termination are served promptly.
+			 */
+			int32_t maxAwaitTimeMs = Min(getMoreInfo.queryData.maxAwaitTimeMS,
+										 MaxTailableCursorAwaitTimeMs);
+			if (maxAwaitTimeMs > 0 && PgbsonArrayWriterGetIndex(&arrayWriter) == 0)
+			{
+				TimestampTz awaitDeadline =
+					TimestampTzPlusMilliseconds(GetCurrentTimestamp(), maxAwaitTimeMs);
+				while (PgbsonArrayWriterGetIndex(&arrayWriter) == 0)
+				{
+					long remainingMs =
+						TimestampDifferenceMilliseconds(GetCurrentTimestamp(),
+														awaitDeadline);
+					if (remainingMs <= 0)
+					{
+						break;
+					}
+
+					(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT |
+									 WL_EXIT_ON_PM_DEATH,
+									 Min(remainingMs, TailableCursorAwaitPollIntervalMs),
+									 PG_WAIT_EXTENSION);
+					ResetLatch(MyLatch);
+					CHECK_FOR_INTERRUPTS();
+
+					/* The planner may scribble on the query, so regenerate it for each poll */
+					QueryData pollQueryData = { 0 };
+					pollQueryData.timeSystemVariables =
+						getMoreInfo.queryData.timeSystemVariables;
+					query = GenerateAggregationQuery(database, getMoreInfo.querySpec,
+													 &pollQueryData,
+													 generateCursorParams,
+													 setStatementTimeout);
+					pgbson *pollResumeToken =
+						DrainTailableQuery(cursorMap, query,
+										   getMoreInfo.queryData.batchSize,
+										   &numIterations, accumulatedSize,
+										   &arrayWriter);
+					if (pollResumeToken != NULL)
+					{
+						postBatchResumeToken = pollResumeToken;
+					}
+				}
+			}
+
 			continuationDoc = BuildStreamingContinuationDocument(cursorMap,
 																 getMoreInfo.querySpec,
 																 getMoreInfo.cursorId,
@@ -555,6 +663,7 @@ command_distinct_query(PG_FUNCTION_ARGS)
 
 	text *database = PG_GETARG_TEXT_P(0);
 	pgbson *distinctSpec = PG_GETARG_PGBSON(1);
+	PublishCommandActivity("command", database, distinctSpec);
 
 	bool setStatementTimeout = true;
 	Query *query = GenerateDistinctQuery(database, distinctSpec, setStatementTimeout);
@@ -585,6 +694,7 @@ command_count_query(PG_FUNCTION_ARGS)
 
 	text *database = PG_GETARG_TEXT_P(0);
 	pgbson *countSpec = PG_GETARG_PGBSON(1);
+	PublishCommandActivity("command", database, countSpec);
 
 	bool setStatementTimeout = true;
 	Query *query = GenerateCountQuery(database, countSpec, setStatementTimeout);
@@ -712,6 +822,25 @@ GenerateGetMoreQuery(text *database, pgbson *getMoreSpec, pgbson *continuationSp
 			return query;
 		}
 
+		case CursorKind_SortedStreaming:
+		{
+			/* The page of the getMore: the find resumed from the resume key */
+			Query *query = GenerateSortedStreamingGetMoreQuery(database, &getMoreInfo,
+															   queryData,
+															   setStatementTimeout);
+			if (getMoreInfo.queryData.batchSize < INT_MAX)
+			{
+				query->limitCount = (Node *) makeConst(INT8OID, -1, InvalidOid,
+													   sizeof(int64_t),
+													   Int64GetDatum(
+														   (int64_t) getMoreInfo.
+														   queryData.batchSize + 1),
+													   false, true);
+			}
+
+			return query;
+		}
+
 		case CursorKind_Persisted:
 		case CursorKind_Tailable:
 		default:
@@ -724,6 +853,35 @@ GenerateGetMoreQuery(text *database, pgbson *getMoreSpec, pgbson *continuationSp
 }
 
 
+/*
+ * Builds the query of a getMore on a sorted streaming cursor: the find of the
+ * first page resumed from the resume key of the cursor.
+ */
+static Query *
+GenerateSortedStreamingGetMoreQuery(text *database, QueryGetMoreInfo *getMoreInfo,
+									QueryData *queryData, bool setStatementTimeout)
+{
+	queryData->timeSystemVariables = getMoreInfo->queryData.timeSystemVariables;
+	queryData->sortResumeKeyConst = getMoreInfo->sortResumeKey != NULL ?
+									getMoreInfo->sortResumeKey : PgbsonInitEmpty();
+
+	/* Only the cursor queries of a find return the resume key columns */
+	bool generateCursorParams = true;
+	Query *query = GenerateFindQuery(database, getMoreInfo->querySpec,
+									 queryData, generateCursorParams,
+									 setStatementTimeout);
+	if (queryData->cursorKind != QueryCursorType_SortedStreamable)
+	{
+		/* e.g. the collection was sharded or dropped since the first page */
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_CURSORNOTFOUND),
+						errmsg("Cursor %ld can no longer be resumed",
+							   getMoreInfo->cursorId)));
+	}
+
+	return query;
+}
+
+
 /*
  * Given a pre-built query (for find/aggregate) handles the cursor request
  * and builds a response for the first page.
@@ -751,6 +909,17 @@ HandleFirstPageRequest(pgbson *querySpec, int64_t cursorId,
 	pgbson *continuationDoc;
 	bool persistConnection = false;
 	pgbson *postBatchResumeToken = NULL;
+
+	bool isTopLevelTransaction = true;
+	if (queryData->cursorKind == QueryCursorType_MultiPointRead &&
+		(!UseFileBasedPersistedCursors || IsInTransactionBlock(isTopLevelTransaction)))
+	{
+		/* Results past the first batch spill to a cursor file, without it
+		 * the query is drained as a persisted cursor.
+		 */
+		queryData->cursorKind = QueryCursorType_Persistent;
+	}
+
 	switch (queryData->cursorKind)
 	{
 		case QueryCursorType_SingleBatch:
@@ -759,7 +928,14 @@ HandleFirstPageRequest(pgbson *querySpec, int64_t cursorId,
 			CreateAndDrainSingleBatchQuery("singleBatchCursor", query,
 										   queryData->batchSize,
 										   &numIterations,
-										   accumulatedSize, &arrayWriter);
+										   accumulatedSize, &arrayWriter,
+										   queryData->allowParallelPlan);
+
+			if (queryData->outputStaging != NULL)
+			{
+				CompleteStagedOutput(queryData->outputStaging);
+			}
+
 			queryFullyDrained = true;
 			continuationDoc = NULL;
 			cursorId = 0;
@@ -815,6 +991,30 @@ HandleFirstPageRequest(pgbson *querySpec, int64_t cursorId,
 			break;
 		}
 
+		case QueryCursorType_SortedStreamable:
+		{
+			ReportFeatureUsage(FEATURE_CURSOR_TYPE_SORTED_STREAMING);
+
+			pgbson *sortResumeKey = NULL;
+			queryFullyDrained = DrainSortedStreamingQuery(query, queryData->batchSize,
+														  &numIterations,
+														  accumulatedSize,
+														  &arrayWriter,
+														  &sortResumeKey);
+			continuationDoc = NULL;
+			if (!queryFullyDrained)
+			{
+				cursorId = GenerateCursorId(cursorId);
+				continuationDoc = BuildSortedStreamingContinuationDocument(querySpec,
+																		   cursorId,
+																		   sortResumeKey,
+																		   &queryData->
+																		   timeSystemVariables,
+																		   numIterations);
+			}
+			break;
+		}
+
 		case QueryCursorType_Persistent:
 		{
 			ReportFeatureUsage(FEATURE_CURSOR_TYPE_PERSISTENT);
@@ -858,7 +1058,9 @@ HandleFirstPageRequest(pgbson *querySpec, int64_t cursorId,
 																			   accumulatedSize,
 																			   &
 																			   arrayWriter,
-																			   closeCursor);
+																			   closeCursor,
+																			   queryData->
+																			   allowParallelPlan);
 				queryFullyDrained = cursorFileState == NULL;
 
 				if (!queryFullyDrained)
@@ -927,6 +1129,42 @@ HandleFirstPageRequest(pgbson *querySpec, int64_t cursorId,
 			break;
 		}
 
+		case QueryCursorType_MultiPointRead:
+		{
+			ReportFeatureUsage(FEATURE_CURSOR_TYPE_MULTI_POINT_READ);
+
+			current_cursor_count++;
+			int64_t cursorIdForBackendCursor = cursorId != 0 ? cursorId :
+											   (((int64_t) MyProcPid) << 32) |
+											   current_cursor_count;
+
+			StringInfo cursorStringInfo = makeStringInfo();
+			const char *cursorName = FormatCursorName(cursorStringInfo,
+													  cursorIdForBackendCursor);
+
+			persistConnection = false;
+			bytea *cursorFileState = CreateAndDrainMultiPointReadQuery(cursorName, query,
+																	   queryData->
+																	   batchSize,
+																	   &numIterations,
+																	   accumulatedSize,
+																	   &arrayWriter);
+			queryFullyDrained = cursorFileState == NULL;
+			continuationDoc = NULL;
+			if (!queryFullyDrained)
+			{
+				cursorId = GenerateCursorId(cursorId);
+				continuationDoc = BuildPersistedFileContinuationDocument(cursorName,
+																		 cursorId,
+																		 queryKind,
+																		 &queryData->
+																		 timeSystemVariables,
+																		 numIterations,
+																		 cursorFileState);
+			}
+			break;
+		}
+
 		default:
 		{
 			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
@@ -1076,9 +1314,51 @@ BuildPersistedContinuationDocument(const char *cursorName, int64_t cursorId, Que
 }
 
 
+/*
+ * Serializes a cursor document that can be reused by getMore for a sorted streaming
+ * find: the query spec is rerun from the resume key of the next page.
+ */
+static pgbson *
+BuildSortedStreamingContinuationDocument(pgbson *querySpec, int64_t cursorId,
+										 pgbson *sortResumeKey,
+										 TimeSystemVariables *timeSystemVariables,
+										 int numIterations)
+{
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterAppendInt64(&writer, "qi", 2, cursorId);
+	PgbsonWriterAppendBool(&writer, "qp", 2, false);
+	PgbsonWriterAppendInt32(&writer, "qk", 2, (int) QueryKind_Find);
+
+	/* Save the query with "qo" to differentiate from the unsorted streaming query. */
+	PgbsonWriterAppendDocument(&writer, "qo", 2, querySpec);
+
+	if (sortResumeKey != NULL)
+	{
+		PgbsonWriterAppendDocument(&writer, "qr", 2, sortResumeKey);
+	}
+
+	/* In the response add the number of iterations (used in tests) */
+	PgbsonWriterAppendInt32(&writer, "numIters", 8, numIterations);
+
+	/* Add time system variables accordingly */
+	if (EnableNowSystemVariable)
+	{
+		if (timeSystemVariables != NULL && timeSystemVariables->nowValue.value_type !=
+			BSON_TYPE_EOD)
+		{
+			PgbsonWriterAppendValue(&writer, "sn", 2, &timeSystemVariables->nowValue);
+		}
+	}
+
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
 /*
  * Parses the serialized cursor spec of the prior iteration. This is the inverse
- * function of BuildStreamingContinuationDocument and BuildPersistedContinuationDocument
+ * function of BuildStreamingContinuationDocument, BuildPersistedContinuationDocument
+ * and BuildSortedStreamingContinuationDocument
  */
 static void
 ParseCursorInputSpec(pgbson *cursorSpec, QueryGetMoreInfo *getMoreInfo)
@@ -1116,6 +1396,25 @@ ParseCursorInputSpec(pgbson *cursorSpec, QueryGetMoreInfo *getMoreInfo)
 						continue;
 					}
 
+					/* Query sorted streaming */
+					case 'o':
+					{
+						Assert(pathKey[2] == '\0');
+						getMoreInfo->querySpec = PgbsonInitFromDocumentBsonValue(
+							bson_iter_value(&cursorSpecIter));
+						getMoreInfo->cursorKind = CursorKind_SortedStreaming;
+						continue;
+					}
+
+					/* Query sort resume key */
+					case 'r':
+					{
+						Assert(pathKey[2] == '\0');
+						getMoreInfo->sortResumeKey = PgbsonInitFromDocumentBsonValue(
+							bson_iter_value(&cursorSpecIter));
+						continue;
+					}
+
 					/* Query cursor name */
 					case 'n':
 					{
@@ -17,7 +17,11 @@
 #include <utils/snapmgr.h>
 #include <utils/lsyscache.h>
 #include <utils/inval.h>
+#include <access/heapam.h>
 #include <access/table.h>
+#include <commands/progress.h>
+#include <pgstat.h>
+#include <storage/bufmgr.h>
 
 #include "commands/parse_error.h"
 #include "commands/commands_common.h"
@@ -1335,10 +1339,25 @@ IndexCheckExclusion(Relation heapRelation,
 								 true,  /* buffer access strategy OK */
 								 true); /* syncscan OK */
 
+	/*
+	 * Report the blocks scanned like a CREATE INDEX validation, so that a long
+	 * conversion is visible in pg_stat_progress_create_index.
+	 */
+	HeapScanDesc heapScan = (HeapScanDesc) scan;
+	BlockNumber previousBlock = InvalidBlockNumber;
+	int64 blocksDone = 0;
+	pgstat_progress_update_param(PROGRESS_SCAN_BLOCKS_TOTAL, heapScan->rs_nblocks);
+
 	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
 	{
 		CHECK_FOR_INTERRUPTS();
 
+		if (heapScan->rs_cblock != previousBlock)
+		{
+			previousBlock = heapScan->rs_cblock;
+			pgstat_progress_update_param(PROGRESS_SCAN_BLOCKS_DONE, ++blocksDone);
+		}
+
 		/*
 		 * In a partial index, ignore tuples that don't satisfy the predicate.
 		 */
@@ -1401,7 +1420,18 @@ UpdatePostgresIndexesForUnique(List *indexOids, bool unique)
 		Oid heapOid = indexRelation->rd_index->indrelid;
 		Relation heapRelation = table_open(heapOid, AccessShareLock);
 
-		IndexCheckExclusion(heapRelation, indexRelation, indexInfo);
+		/* Shards without data (e.g. the shell table) have nothing to validate */
+		if (RelationGetNumberOfBlocks(heapRelation) > 0)
+		{
+			pgstat_progress_start_command(PROGRESS_COMMAND_CREATE_INDEX, heapOid);
+			pgstat_progress_update_param(PROGRESS_CREATEIDX_INDEX_OID, shardIndexOid);
+			pgstat_progress_update_param(PROGRESS_CREATEIDX_PHASE,
+										 PROGRESS_CREATEIDX_PHASE_VALIDATE_TABLESCAN);
+
+			IndexCheckExclusion(heapRelation, indexRelation, indexInfo);
+
+			pgstat_progress_end_command();
+		}
 
 		index_close(indexRelation, AccessShareLock);
 		table_close(heapRelation, AccessShareLock);
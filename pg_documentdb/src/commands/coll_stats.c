@@ -12,6 +12,7 @@
 #include <fmgr.h>
 #include <funcapi.h>
 #include <utils/builtins.h>
+#include <utils/timestamp.h>
 #include <nodes/makefuncs.h>
 #include <catalog/namespace.h>
 
@@ -27,10 +28,12 @@
 #include "commands/parse_error.h"
 #include "commands/commands_common.h"
 #include "commands/diagnostic_commands_common.h"
+#include "infrastructure/documentdb_stats_cache.h"
 #include "api_hooks.h"
 
 extern int CollStatsCountPolicyThreshold;
 extern bool UsePgStatsLiveTuplesForCount;
+extern bool EnableStatsOnlyCollectionCount;
 extern bool ForceCollStatsDataCollection;
 
 PG_FUNCTION_INFO_V1(command_coll_stats);
@@ -74,6 +77,7 @@ typedef enum CollStatsAggMode
 
 /* Forward Declaration */
 static int64 GetDocumentsCountRunTime(MongoCollection *collection);
+static bool HasDocumentsRunTime(MongoCollection *collection);
 static int32 GetAverageColumnWidthRuntime(MongoCollection *collection);
 static int32 GetAverageColumnWidthSampled(MongoCollection *collection);
 static pgbson * BuildResponseMessage(CollStatsResult *result);
@@ -350,9 +354,16 @@ CollStatsCoordinator(Datum databaseName, Datum collectionName, int scale)
 	}
 	else
 	{
-		BuildResultData(databaseName, collectionName, &result, collection, scale,
-						CollStatsAggMode_CountAndStorage);
-		response = BuildResponseMessage(&result);
+		response = GetCachedStatsResponse(result.ns, collection->collectionId, scale);
+		if (response == NULL)
+		{
+			TimestampTz computationStartTime = GetCurrentTimestamp();
+			BuildResultData(databaseName, collectionName, &result, collection, scale,
+							CollStatsAggMode_CountAndStorage);
+			response = BuildResponseMessage(&result);
+			StoreCachedStatsResponse(result.ns, collection->collectionId, scale,
+									 computationStartTime, response);
+		}
 	}
 
 	return response;
@@ -500,6 +511,18 @@ MergeWorkerResults(CollStatsResult *result, MongoCollection *collection,
 		docCountFromAnalyze = totalDocCount;
 		docColumnSizeTotalResult = totalDocColumnSizeFromStats;
 	}
+	else if (EnableStatsOnlyCollectionCount && mode == CollStatsAggMode_Count &&
+			 (totalDocCountFromStats > 0 || !HasDocumentsRunTime(collection)))
+	{
+		/*
+		 * Only the count is requested (e.g. an unfiltered count command): take it
+		 * from the live tuple stats, which only lag behind committed writes
+		 * until they are reported. Only empty stats are checked against the table.
+		 */
+		ereport(DEBUG1, (errmsg("[collStats] Taking count only from live stats")));
+		docCountResult = totalDocCountFromStats;
+		docCountFromAnalyze = totalDocCount;
+	}
 	else if (totalDocCount < CollStatsCountPolicyThreshold)
 	{
 		ereport(DEBUG1, (errmsg(
@@ -1112,6 +1135,25 @@ GetDocumentsCountRunTime(MongoCollection *collection)
 }
 
 
+/*
+ * HasDocumentsRunTime returns whether the given collection has any documents,
+ * reading at most a single document.
+ */
+static bool
+HasDocumentsRunTime(MongoCollection *collection)
+{
+	StringInfo cmdStr = makeStringInfo();
+	appendStringInfo(cmdStr,
+					 "SELECT EXISTS (SELECT 1 FROM %s.documents_" UINT64_FORMAT ")",
+					 ApiDataSchemaName, collection->collectionId);
+	bool isNull = true;
+	bool readOnly = true;
+	Datum resultDatum = ExtensionExecuteQueryViaSPI(cmdStr->data, readOnly, SPI_OK_SELECT,
+													&isNull);
+	return !isNull && DatumGetBool(resultDatum);
+}
+
+
 /*
  * GetAverageColumnWidthRuntime returns average size of given column num of provided collection(table)
  * It calculates the average size of the 'document' column at runtime.
@@ -27,6 +27,7 @@
 #include "metadata/metadata_cache.h"
 #include "planner/documentdb_planner.h"
 #include "utils/timeout.h"
+#include "utils/guc_utils.h"
 
 
 extern bool ThrowDeadlockOnCrud;
@@ -34,6 +35,7 @@ extern bool EnableBackendStatementTimeout;
 extern int MaxCustomCommandTimeout;
 extern bool EnableVariablesSupportForWriteCommands;
 extern bool RumFailOnLostPath;
+extern bool EnableAsyncCommitWriteConcern;
 
 /*
  *  This is a list of command options that are not currently supported.
@@ -98,6 +100,8 @@ static int NumberOfIgnoredFields = sizeof(IgnoredCommonSpecFields) / sizeof(char
 static int CompareStringsCaseInsensitive(const void *a, const void *b);
 static pgbson * RewriteDocumentAddObjectIdCore(const bson_value_t *docValue,
 											   bson_value_t *objectIdToWrite);
+static pgbson * PrependObjectIdToDocument(const bson_value_t *docValue,
+										  const bson_oid_t *objectId);
 
 /*
  * FindShardKeyValueForDocumentId queries the collection for the shard key value that
@@ -290,6 +294,56 @@ SetExplicitStatementTimeout(int timeoutMilliseconds)
 }
 
 
+/*
+ * Applies the writeConcern of a write command to the commit of its
+ * transaction: writes that are unacknowledged (w: 0) or that don't wait for
+ * the journal (j: false) commit without waiting for their WAL to be flushed.
+ * A crash may lose the last of these writes but never applies them partially.
+ *
+ * Writes in multi-document transactions are left alone, their durability is
+ * the one of the commit of the transaction.
+ */
+void
+SetWriteConcernCommitMode(const bson_value_t *writeConcern)
+{
+	bool isTopLevel = true;
+	if (!EnableAsyncCommitWriteConcern ||
+		writeConcern->value_type != BSON_TYPE_DOCUMENT ||
+		IsInTransactionBlock(isTopLevel))
+	{
+		return;
+	}
+
+	bool isUnacknowledged = false;
+	bool isJournalRequested = false;
+	bool isJournalSkipped = false;
+
+	bson_iter_t writeConcernIter;
+	BsonValueInitIterator(writeConcern, &writeConcernIter);
+	while (bson_iter_next(&writeConcernIter))
+	{
+		const char *key = bson_iter_key(&writeConcernIter);
+		const bson_value_t *value = bson_iter_value(&writeConcernIter);
+		if (strcmp(key, "w") == 0 && BsonValueIsNumber(value))
+		{
+			isUnacknowledged = BsonValueAsInt64(value) == 0;
+		}
+		else if (strcmp(key, "j") == 0 && BsonValueIsNumberOrBool(value))
+		{
+			isJournalRequested = BsonValueAsBool(value);
+			isJournalSkipped = !isJournalRequested;
+		}
+	}
+
+	if (isJournalRequested || (!isUnacknowledged && !isJournalSkipped))
+	{
+		return;
+	}
+
+	SetGUCLocally("synchronous_commit", "off");
+}
+
+
 pgbson *
 GetObjectIdFilterFromQueryDocumentValue(const bson_value_t *queryDoc,
 										bool *queryHasNonIdFilters,
@@ -580,6 +634,9 @@ CommitWriteProcedureAndReacquireCollectionLock(MongoCollection *collection,
 	ereport(DEBUG1, (errmsg("Commiting intermediate state and "
 							"reacquiring collection lock")));
 
+	/* The commit mode set for the writeConcern only lasts for the transaction */
+	bool isAsyncCommit = synchronous_commit == SYNCHRONOUS_COMMIT_OFF;
+
 	if (ActiveSnapshotSet())
 	{
 		PopActiveSnapshot();
@@ -591,6 +648,11 @@ CommitWriteProcedureAndReacquireCollectionLock(MongoCollection *collection,
 	/* Initiate a new transaction */
 	StartTransactionCommand();
 
+	if (isAsyncCommit)
+	{
+		SetGUCLocally("synchronous_commit", "off");
+	}
+
 	/* Push the active snapshot if commands need it (Portals do) */
 	if (setSnapshot)
 	{
@@ -622,8 +684,6 @@ RewriteDocumentAddObjectIdCore(const bson_value_t *docValue,
 {
 	bson_iter_t it;
 	BsonValueInitIterator(docValue, &it);
-	pgbson_writer writer;
-	PgbsonWriterInit(&writer);
 	bool isFirstField = true;
 	bool documentHasIdField = false;
 	while (bson_iter_next(&it))
@@ -655,6 +715,8 @@ RewriteDocumentAddObjectIdCore(const bson_value_t *docValue,
 		ValidateIdField(value);
 
 		/* copy to the modified document but add in _id first. */
+		pgbson_writer writer;
+		PgbsonWriterInitWithSizeHint(&writer, docValue->value.v_doc.data_len);
 		PgbsonWriterAppendValue(&writer, "_id", 3, value);
 		BsonValueInitIterator(docValue, &documentIterator);
 		while (bson_iter_next(&documentIterator))
@@ -669,27 +731,70 @@ RewriteDocumentAddObjectIdCore(const bson_value_t *docValue,
 			value = bson_iter_value(&documentIterator);
 			PgbsonWriterAppendValue(&writer, bsonKey, bsonKeyLen, value);
 		}
+
+		return PgbsonWriterGetPgbson(&writer);
+	}
+
+	bson_value_t objectidValue;
+	objectidValue.value_type = BSON_TYPE_OID;
+	if (objectIdToWrite)
+	{
+		/* if objectId is passed by caller then we should write that */
+		objectidValue = *objectIdToWrite;
 	}
 	else
 	{
-		bson_value_t objectidValue;
-		objectidValue.value_type = BSON_TYPE_OID;
-		if (objectIdToWrite)
-		{
-			/* if objectId is passed by caller then we should write that */
-			objectidValue = *objectIdToWrite;
-		}
-		else
-		{
-			/* generate new object_id and set objectid. */
-			bson_oid_init(&(objectidValue.value.v_oid), NULL);
-		}
+		/* generate new object_id and set objectid. */
+		bson_oid_init(&(objectidValue.value.v_oid), NULL);
+	}
 
-		/* set the content now and add the object_id. */
-		PgbsonWriterAppendValue(&writer, "_id", 3, &objectidValue);
-		PgbsonWriterConcatBytes(&writer, docValue->value.v_doc.data,
-								docValue->value.v_doc.data_len);
+	if (objectidValue.value_type == BSON_TYPE_OID)
+	{
+		return PrependObjectIdToDocument(docValue, &objectidValue.value.v_oid);
 	}
 
+	/* set the content now and add the object_id. */
+	pgbson_writer writer;
+	PgbsonWriterInitWithSizeHint(&writer, docValue->value.v_doc.data_len);
+	PgbsonWriterAppendValue(&writer, "_id", 3, &objectidValue);
+	PgbsonWriterConcatBytes(&writer, docValue->value.v_doc.data,
+							docValue->value.v_doc.data_len);
 	return PgbsonWriterGetPgbson(&writer);
 }
+
+
+/*
+ * Builds the document with the given ObjectId as its _id followed by the fields
+ * of docValue by splicing the bytes of docValue after a new header and the _id
+ * element, so that the document is copied once instead of being appended to a
+ * writer and copied again out of it:
+ * | varlena header | length | 0x07 "_id\0" | ObjectId | fields of docValue | 0x00 |
+ */
+static pgbson *
+PrependObjectIdToDocument(const bson_value_t *docValue, const bson_oid_t *objectId)
+{
+	/* The type byte, "_id" with its terminator and the ObjectId */
+	const uint32_t idElementLength = 1 + 4 + sizeof(bson_oid_t);
+	const uint32_t documentLength = docValue->value.v_doc.data_len + idElementLength;
+
+	pgbson *result = (pgbson *) palloc(VARHDRSZ + documentLength);
+	SET_VARSIZE(result, VARHDRSZ + documentLength);
+
+	char *data = VARDATA(result);
+	uint32_t documentLengthLE = BSON_UINT32_TO_LE(documentLength);
+	memcpy(data, &documentLengthLE, sizeof(uint32_t));
+	data += sizeof(uint32_t);
+
+	*data = (char) BSON_TYPE_OID;
+	data++;
+	memcpy(data, "_id", 4);
+	data += 4;
+	memcpy(data, objectId->bytes, sizeof(bson_oid_t));
+	data += sizeof(bson_oid_t);
+
+	/* The fields and the terminator of the original document, after its length */
+	memcpy(data, docValue->value.v_doc.data + sizeof(uint32_t),
+		   docValue->value.v_doc.data_len - sizeof(uint32_t));
+
+	return result;
+}
@@ -3,7 +3,9 @@
  *
  * src/commands/compact.c
  *
- * Implementation of the blocking compact command.
+ * Implementation of the compact command. By default (force: true) the
+ * collection is rewritten with a blocking VACUUM FULL, with force: false
+ * a plain VACUUM that doesn't block reads and writes is run instead.
  *-------------------------------------------------------------------------
  */
 #include <postgres.h>
@@ -12,6 +14,7 @@
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <storage/lmgr.h>
+#include <utils/lsyscache.h>
 #include <utils/syscache.h>
 
 #include "api_hooks.h"
@@ -45,16 +48,16 @@ typedef struct CompactArgs
 	double freeSpaceTargetMB;
 
 	/*
-	 * This is not used today, with this false compact should be run on secondary nodes.
-	 * TODO: support force: false once we have writable secondaries. Today only force: true
-	 * is supported with blocking primary
+	 * Whether compact may block the collection. With force: false compact runs
+	 * online (a plain VACUUM) so that it can run on a primary that is serving writes.
 	 */
 	bool force;
 } CompactArgs;
 
 static void ParseCompactCommandSpec(pgbson *compactSpec, CompactArgs *args);
-static void PerformVacuum(MongoCollection *collection);
-static void ValidateLocksAndCheckAccess(MongoCollection *collection);
+static void PerformVacuum(MongoCollection *collection, bool isOnline);
+static void ValidateLocksAndCheckAccess(MongoCollection *collection, bool isOnline);
+static bool IsCollectionClusteredOnId(MongoCollection *collection);
 
 
 PG_FUNCTION_INFO_V1(command_compact);
@@ -97,6 +100,7 @@ command_compact(PG_FUNCTION_ARGS)
 
 	CompactArgs args;
 	memset(&args, 0, sizeof(CompactArgs));
+	args.force = true;
 	ParseCompactCommandSpec(compactSpec, &args);
 
 	if (args.databaseName == NULL || args.collectionName == NULL)
@@ -124,7 +128,8 @@ command_compact(PG_FUNCTION_ARGS)
 							   args.collectionName)));
 	}
 
-	ValidateLocksAndCheckAccess(collection);
+	bool isOnline = !args.force;
+	ValidateLocksAndCheckAccess(collection, isOnline);
 
 	/* Start building the response */
 	pgbson_writer response;
@@ -148,9 +153,10 @@ command_compact(PG_FUNCTION_ARGS)
 										 BYTES_PER_MB) >= args.freeSpaceTargetMB)
 	{
 		/* Only perform full vacuum if there are stats available and freeSpace target is met */
-		elog(LOG, "Performing compact vacuum full on collection %s.%s",
-			 args.databaseName, args.collectionName);
-		PerformVacuum(collection);
+		elog(LOG, "Performing compact %s on collection %s.%s",
+			 isOnline ? "vacuum" : "vacuum full", args.databaseName,
+			 args.collectionName);
+		PerformVacuum(collection, isOnline);
 	}
 
 	/* This is very rough, currently it doesn't considers the space freed by vacuuming index
@@ -170,13 +176,13 @@ command_compact(PG_FUNCTION_ARGS)
 /*
  * Performs the necessary checks to ensure that the current user has priveleges to
  * perform the compact operation on the collection, also checks if the realtion to be vacuumed
- * is available for exclusive access locking
+ * is available for exclusive access locking (or for vacuuming if the compact is online)
  */
 static void
-ValidateLocksAndCheckAccess(MongoCollection *collection)
+ValidateLocksAndCheckAccess(MongoCollection *collection, bool isOnline)
 {
 	/*
-	 * Check if the current user is permitted to perform VACUUM FULL on the collection.
+	 * Check if the current user is permitted to perform VACUUM (FULL) on the collection.
 	 */
 	HeapTuple tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(collection->relationId));
 	if (!HeapTupleIsValid(tuple))
@@ -193,7 +199,7 @@ ValidateLocksAndCheckAccess(MongoCollection *collection)
 	}
 	Form_pg_class classForm = (Form_pg_class) GETSTRUCT(tuple);
 
-	bits32 options = VACOPT_VACUUM | VACOPT_FULL;
+	bits32 options = isOnline ? VACOPT_VACUUM : VACOPT_VACUUM | VACOPT_FULL;
 	bool userCanVacuum = false;
 #if PG_VERSION_NUM >= 170000
 	userCanVacuum = vacuum_is_permitted_for_relation(collection->relationId,
@@ -221,10 +227,13 @@ ValidateLocksAndCheckAccess(MongoCollection *collection)
 	 * - To validate early if only 1 vacuum is running on the collection.
 	 *
 	 * Immediately unlock the table to avoid deadlock situation with VACUUM FULL.
+	 * An online compact only needs the lock VACUUM takes, which conflicts with
+	 * other vacuums but not with reads and writes.
 	 */
-	if (ConditionalLockRelationOid(collection->relationId, AccessExclusiveLock))
+	LOCKMODE lockMode = isOnline ? ShareUpdateExclusiveLock : AccessExclusiveLock;
+	if (ConditionalLockRelationOid(collection->relationId, lockMode))
 	{
-		UnlockRelationOid(collection->relationId, AccessExclusiveLock);
+		UnlockRelationOid(collection->relationId, lockMode);
 	}
 	else
 	{
@@ -245,24 +254,60 @@ ValidateLocksAndCheckAccess(MongoCollection *collection)
 /*
  * This sends a VACUUM FULL command to the local server via libpq, as VACUUM FULL can't
  * be executed in a transaction block.
+ *
+ * An online compact sends a plain VACUUM instead: the freed space is reused by
+ * later writes, and empty pages at the end of the collection are returned to
+ * the OS (taking the exclusive lock only briefly and backing off on conflicts).
+ * Indexes are vacuumed in parallel when they are large enough.
+ *
+ * Collections created with a clusteredIndex are rewritten with CLUSTER instead
+ * of VACUUM FULL (same lock), which also restores their _id order.
  */
 static void
-PerformVacuum(MongoCollection *collection)
+PerformVacuum(MongoCollection *collection, bool isOnline)
 {
 	Assert(collection != NULL && collection->relationId != InvalidOid);
 
-	const char *vacuumFullQuery = FormatSqlQuery("VACUUM FULL %s.documents_%ld",
-												 ApiDataSchemaName,
-												 collection->collectionId);
+	const char *vacuumQuery;
+	if (isOnline)
+	{
+		vacuumQuery = FormatSqlQuery("VACUUM (TRUNCATE) %s.documents_%ld",
+									 ApiDataSchemaName, collection->collectionId);
+	}
+	else if (IsCollectionClusteredOnId(collection))
+	{
+		vacuumQuery = FormatSqlQuery("CLUSTER %s.documents_%ld",
+									 ApiDataSchemaName, collection->collectionId);
+	}
+	else
+	{
+		vacuumQuery = FormatSqlQuery("VACUUM FULL %s.documents_%ld",
+									 ApiDataSchemaName, collection->collectionId);
+	}
 
 	/* VACUUM needs to be performed at the top level */
 	bool useSerialExecution = false;
 	Oid userOid = GetUserId();
-	ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ((char *) vacuumFullQuery, userOid,
+	ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ((char *) vacuumQuery, userOid,
 												   useSerialExecution);
 }
 
 
+/*
+ * Whether the _id index of the collection is the clustering index of its
+ * data table (i.e. it was created with a clusteredIndex).
+ */
+static bool
+IsCollectionClusteredOnId(MongoCollection *collection)
+{
+	char *primaryKeyIndexName = psprintf("collection_pk_" UINT64_FORMAT,
+										 collection->collectionId);
+	Oid primaryKeyIndexOid = get_relname_relid(primaryKeyIndexName,
+											   ApiDataNamespaceOid());
+	return OidIsValid(primaryKeyIndexOid) && get_index_isclustered(primaryKeyIndexOid);
+}
+
+
 static void
 ParseCompactCommandSpec(pgbson *compactSpec, CompactArgs *args)
 {
@@ -292,12 +337,6 @@ ParseCompactCommandSpec(pgbson *compactSpec, CompactArgs *args)
 		{
 			EnsureTopLevelFieldType("force", &specIter, BSON_TYPE_BOOL);
 			args->force = element.bsonValue.value.v_bool;
-			if (!args->force)
-			{
-				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_COMMANDNOTSUPPORTED),
-								errmsg(
-									"command compact option force:false is not supported")));
-			}
 		}
 		else if (strcmp(element.path, "dryRun") == 0)
 		{
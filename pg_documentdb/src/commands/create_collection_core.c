@@ -25,6 +25,8 @@
 
 extern bool EnableNativeColocation;
 extern bool EnableDataTableWithoutCreationTime;
+extern int CollectionDocumentCompression;
+extern bool EnableRetryTableTransactionIdIndex;
 
 static bool CanColocateAtDatabaseLevel(text *databaseDatum);
 static const char * CreatePostgresDataTable(uint64_t collectionId,
@@ -107,6 +109,69 @@ command_create_collection_core(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * CreateCollections creates the given collections (a list of collection name
+ * strings) of a database in the current transaction, skipping the ones that
+ * already exist, and returns the number of collections created.
+ *
+ * This is the same as calling CreateCollection for each collection, except
+ * that the checks on the metadata tables and the colocation of the database
+ * are only resolved once for the whole set of collections.
+ */
+int
+CreateCollections(text *databaseDatum, List *collectionNames)
+{
+	int numCollectionsCreated = 0;
+	ListCell *collectionNameCell = NULL;
+	if (!IsMetadataCoordinator())
+	{
+		/* Each collection is created through the metadata coordinator */
+		foreach(collectionNameCell, collectionNames)
+		{
+			Datum collectionNameDatum = CStringGetTextDatum(lfirst(collectionNameCell));
+			if (CreateCollection(PointerGetDatum(databaseDatum), collectionNameDatum))
+			{
+				numCollectionsCreated++;
+			}
+		}
+
+		return numCollectionsCreated;
+	}
+
+	EnsureMetadataTableReplicated("collections");
+
+	const char *colocateWith = NULL;
+	const char *shardingColumn = "shard_key_value";
+	SetUnshardedColocationData(databaseDatum, &shardingColumn, &colocateWith);
+
+	foreach(collectionNameCell, collectionNames)
+	{
+		text *collectionDatum = cstring_to_text(lfirst(collectionNameCell));
+		MongoCollection *collection = GetMongoCollectionByNameDatum(
+			PointerGetDatum(databaseDatum), PointerGetDatum(collectionDatum),
+			AccessShareLock);
+		if (collection != NULL)
+		{
+			continue;
+		}
+
+		bool collectionExists = false;
+		uint64_t collectionId = InsertMetadataIntoCollections(databaseDatum,
+															  collectionDatum,
+															  &collectionExists);
+		if (collectionExists)
+		{
+			continue;
+		}
+
+		CreatePostgresDataTable(collectionId, colocateWith, shardingColumn);
+		numCollectionsCreated++;
+	}
+
+	return numCollectionsCreated;
+}
+
+
 void
 SetUnshardedColocationData(text *databaseDatum, const char **shardingColumn, const
 						   char **colocateWith)
@@ -201,6 +266,20 @@ CreatePostgresDataTable(uint64_t collectionId, const char *colocateWith, const
 
 	StringInfo createTableStringInfo = makeStringInfo();
 
+	/*
+	 * Documents of a collection usually share the same field names, which lz4
+	 * compresses about as well as pglz while decompressing much faster.
+	 */
+	const char *documentCompression = "";
+	if (CollectionDocumentCompression == DocumentCompression_Pglz)
+	{
+		documentCompression = " compression pglz";
+	}
+	else if (CollectionDocumentCompression == DocumentCompression_Lz4)
+	{
+		documentCompression = " compression lz4";
+	}
+
 	/* Create the actual table */
 	appendStringInfo(createTableStringInfo,
 					 "CREATE TABLE %s ("
@@ -218,9 +297,9 @@ CreatePostgresDataTable(uint64_t collectionId, const char *colocateWith, const
 	                  *     defined in collection.h if you decide changing definiton
 	                  *     or position of document column.
 	                  */
-					 "document %s.bson not null",
+					 "document %s.bson%s not null",
 					 dataTableNameInfo->data,
-					 CoreSchemaName, CoreSchemaName);
+					 CoreSchemaName, CoreSchemaName, documentCompression);
 
 	/* Let's add creation_time column only when EnableDataTableWithoutCreationTime GUC is off */
 	if (EnableDataTableWithoutCreationTime)
@@ -325,9 +404,16 @@ CreateRetryTable(char *retryTableName, char *colocateWith, const
 	ExtensionExecuteQueryViaSPI(queryStringInfo->data, readOnly, SPI_OK_UTILITY,
 								&isNull);
 
+	/*
+	 * Retry records are only looked up by transaction id (across shards for
+	 * writes that target a single _id), the primary key covers the lookups
+	 * within a shard. Indexing the transaction id makes the cross shard lookup
+	 * a single index probe for the same write cost as the object_id index.
+	 */
 	resetStringInfo(queryStringInfo);
 	appendStringInfo(queryStringInfo,
-					 "CREATE INDEX ON %s (object_id)", retryTableName);
+					 "CREATE INDEX ON %s (%s)", retryTableName,
+					 EnableRetryTableTransactionIdIndex ? "transaction_id" : "object_id");
 	ExtensionExecuteQueryViaSPI(queryStringInfo->data, readOnly, SPI_OK_UTILITY,
 								&isNull);
 
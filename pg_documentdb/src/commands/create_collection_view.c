@@ -26,6 +26,7 @@
 #include "aggregation/bson_aggregation_pipeline.h"
 #include "utils/error_utils.h"
 #include "utils/feature_counter.h"
+#include "utils/query_utils.h"
 #include "utils/version_utils.h"
 
 /*
@@ -57,6 +58,9 @@ typedef struct CreateSpec
 
 	/* idIndex */
 	bson_value_t idIndex;
+
+	/* whether a clusteredIndex on _id was requested */
+	bool clustered;
 } CreateSpec;
 
 static const StringView SystemPrefix = { .string = "system.", .length = 7 };
@@ -76,9 +80,12 @@ static void WalkPipelineForViewCycles(Datum databaseDatum, const char *viewName,
 static bool CreateView(Datum databaseDatum, const char *viewName,
 					   const char *viewSource, const bson_value_t *pipeline);
 
+static void SetCollectionClusteredOnId(Datum databaseDatum, Datum collectionDatum);
+
 PG_FUNCTION_INFO_V1(command_create_collection_view);
 
 extern bool EnableSchemaValidation;
+extern bool EnableClusteredCollections;
 
 /*
  * command_create_collection_view represents the wire
@@ -122,6 +129,11 @@ command_create_collection_view(PG_FUNCTION_ARGS)
 		ReportFeatureUsage(FEATURE_COMMAND_CREATE_COLLECTION);
 		CreateCollection(databaseDatum, createDatum);
 
+		if (createDefinition->clustered)
+		{
+			SetCollectionClusteredOnId(databaseDatum, createDatum);
+		}
+
 		if (hasSchemaValidationSpec)
 		{
 			ReportFeatureUsage(FEATURE_COMMAND_CREATE_VALIDATION);
@@ -232,6 +244,82 @@ ValidateIdIndexDocument(const bson_value_t *idIndexDocument)
 }
 
 
+/*
+ * Validates the "clusteredIndex" field of a create() specification.
+ * Only { "key": { "_id": 1 }, "unique": true } (with an optional name and version)
+ * is valid.
+ */
+static void
+ValidateClusteredIndexDocument(const bson_value_t *clusteredIndexDocument)
+{
+	bson_iter_t clusteredIterator;
+	BsonValueInitIterator(clusteredIndexDocument, &clusteredIterator);
+
+	bool hasKey = false;
+	bool hasUnique = false;
+	while (bson_iter_next(&clusteredIterator))
+	{
+		const char *key = bson_iter_key(&clusteredIterator);
+		if (strcmp(key, "key") == 0)
+		{
+			EnsureTopLevelFieldType("create.clusteredIndex.key", &clusteredIterator,
+									BSON_TYPE_DOCUMENT);
+
+			bson_iter_t keyIterator;
+			BsonValueInitIterator(bson_iter_value(&clusteredIterator), &keyIterator);
+
+			pgbsonelement keyElement;
+			if (!TryGetSinglePgbsonElementFromBsonIterator(&keyIterator, &keyElement) ||
+				strcmp(keyElement.path, "_id") != 0 ||
+				!BsonValueIsNumber(&keyElement.bsonValue) ||
+				BsonValueAsDouble(&keyElement.bsonValue) != 1)
+			{
+				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INVALIDINDEXSPECIFICATIONOPTION),
+								errmsg("The clusteredIndex key must be { _id: 1 }")));
+			}
+
+			hasKey = true;
+		}
+		else if (strcmp(key, "unique") == 0)
+		{
+			EnsureTopLevelFieldIsBooleanLike("create.clusteredIndex.unique",
+											 &clusteredIterator);
+			if (!BsonValueAsBool(bson_iter_value(&clusteredIterator)))
+			{
+				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INVALIDINDEXSPECIFICATIONOPTION),
+								errmsg("The clusteredIndex must be unique")));
+			}
+
+			hasUnique = true;
+		}
+		else if (strcmp(key, "name") == 0)
+		{
+			EnsureTopLevelFieldType("create.clusteredIndex.name", &clusteredIterator,
+									BSON_TYPE_UTF8);
+
+			/* The specified name will be ignored. */
+		}
+		else if (strcmp(key, "v") == 0)
+		{
+			/* The version is ignored. */
+		}
+		else
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_UNKNOWNBSONFIELD),
+							errmsg("BSON field 'create.clusteredIndex.%s' is an "
+								   "unknown field", key)));
+		}
+	}
+
+	if (!hasKey || !hasUnique)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+						errmsg("BSON field 'create.clusteredIndex.%s' is missing "
+							   "but a required field", hasKey ? "unique" : "key")));
+	}
+}
+
+
 /*
  * ParseCreateSpec parses the wire
  * protocol message create() which creates a mongo
@@ -307,8 +395,16 @@ ParseCreateSpec(Datum databaseDatum, pgbson *createSpec, bool *hasSchemaValidati
 		}
 		else if (strcmp(key, "clusteredIndex") == 0)
 		{
-			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_COMMANDNOTSUPPORTED),
-							errmsg("clusteredIndex not supported yet")));
+			if (!EnableClusteredCollections)
+			{
+				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_COMMANDNOTSUPPORTED),
+								errmsg("clusteredIndex not supported yet")));
+			}
+
+			EnsureTopLevelFieldType("create.clusteredIndex", &createIter,
+									BSON_TYPE_DOCUMENT);
+			ValidateClusteredIndexDocument(bson_iter_value(&createIter));
+			spec->clustered = true;
 		}
 		else if (strcmp(key, "expireAfterSeconds") == 0)
 		{
@@ -406,6 +502,12 @@ ParseCreateSpec(Datum databaseDatum, pgbson *createSpec, bool *hasSchemaValidati
 							"'viewOn' needs to be specified.")));
 	}
 
+	if (spec->viewOn != NULL && spec->clustered)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INVALIDOPTIONS),
+						errmsg("'viewOn' and 'clusteredIndex' cannot both be specified")));
+	}
+
 	if (spec->viewOn != NULL && spec->idIndex.value_type != BSON_TYPE_EOD)
 	{
 		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INVALIDOPTIONS),
@@ -512,6 +614,38 @@ ValidateViewDefinition(Datum databaseDatum, const char *viewName, const
 }
 
 
+/*
+ * Marks the _id index of a newly created collection as the clustering index of
+ * its data table. The documents aren't kept ordered on writes, compact then
+ * rewrites the collection in _id order (see PerformVacuum) so that range scans
+ * on _id (e.g. time ordered ObjectIds) read the heap sequentially.
+ */
+static void
+SetCollectionClusteredOnId(Datum databaseDatum, Datum collectionDatum)
+{
+	MongoCollection *collection = GetMongoCollectionByNameDatum(databaseDatum,
+																collectionDatum,
+																NoLock);
+	if (collection == NULL)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Failed to find the collection created with a "
+							   "clusteredIndex")));
+	}
+
+	StringInfo clusterQuery = makeStringInfo();
+	appendStringInfo(clusterQuery,
+					 "ALTER TABLE %s.documents_" UINT64_FORMAT
+					 " CLUSTER ON collection_pk_" UINT64_FORMAT,
+					 ApiDataSchemaName, collection->collectionId,
+					 collection->collectionId);
+
+	bool readOnly = false;
+	bool isNull = false;
+	ExtensionExecuteQueryViaSPI(clusterQuery->data, readOnly, SPI_OK_UTILITY, &isNull);
+}
+
+
 /*
  * Creating a view is simply registering the view as metadata in ApiCatalogSchemaName.collections.
  */
@@ -158,14 +158,23 @@ typedef struct
 extern bool ForceIndexTermTruncation;
 extern int IndexTruncationLimitOverride;
 extern int MaxWildcardIndexKeySize;
+extern int MaxWildcardIndexTermsPerDocument;
 extern bool DefaultEnableLargeUniqueIndexKeys;
 extern bool SkipFailOnCollation;
 extern bool ForceWildcardReducedTerm;
 extern bool EnableCompositeUniqueHash;
 extern bool EnableCompositeWildcardIndex;
+extern bool EnableElemMatchNestedArrayTerm;
 
 extern char *AlternateIndexHandler;
 
+/*
+ * Options of the localhost backend that runs a CREATE INDEX CONCURRENTLY on
+ * the shards of a sharded collection, NULL unless the distribution layer sets
+ * them (e.g. to bound the shard index builds run in parallel on each node).
+ */
+char *IndexBuildParallelExecutionOptions = NULL;
+
 #define WILDCARD_INDEX_SUFFIX "$**"
 #define DOT_WILDCARD_INDEX_SUFFIX "." WILDCARD_INDEX_SUFFIX
 #define DOUBLE_DOT_IN_INDEX_PATH ".."
@@ -192,11 +201,13 @@ PG_FUNCTION_INFO_V1(generate_create_index_arg);
 
 PG_FUNCTION_INFO_V1(command_create_indexes_non_concurrently);
 PG_FUNCTION_INFO_V1(command_create_temp_indexes_non_concurrently);
+PG_FUNCTION_INFO_V1(command_create_collections_with_indexes);
 PG_FUNCTION_INFO_V1(command_index_build_is_in_progress);
 PG_FUNCTION_INFO_V1(command_fix_unique_index_stats_for_collection);
 
 static ReIndexResult reindex_concurrently(Datum dbNameDatum,
 										  Datum collectionNameDatum);
+static List * ParseCreateCollectionsWithIndexesSpec(Datum dbNameDatum, pgbson *spec);
 static IndexDef * ParseIndexDefDocument(const bson_iter_t *indexesArrayIter,
 										bool ignoreUnknownIndexOptions,
 										bool buildAsUniqueForPrepareUnique);
@@ -373,6 +384,35 @@ ComputeIndexTermLimit(uint32_t baseIndexTermLimit)
 }
 
 
+/*
+ * Returns the opclass option limiting the terms a document generates for a
+ * wildcard index, snapshotted from documentdb.maxWildcardIndexTermsPerDocument
+ * when the index is created so later changes don't affect existing indexes.
+ */
+static const char *
+GetWildcardTermLimitOption(void)
+{
+	if (MaxWildcardIndexTermsPerDocument <= 0)
+	{
+		return "";
+	}
+
+	return psprintf(",wtl=%d", MaxWildcardIndexTermsPerDocument);
+}
+
+
+/*
+ * Returns the opclass option that makes a single path index generate the root
+ * nested array term, snapshotted from documentdb.enableElemMatchNestedArrayTerm
+ * when the index is created since only those indexes have the term.
+ */
+static const char *
+GetNestedArrayTermOption(void)
+{
+	return EnableElemMatchNestedArrayTerm ? ",nat=true" : "";
+}
+
+
 inline static bool
 IsUniqueIndex(IndexDef *indexDef)
 {
@@ -559,6 +599,169 @@ command_create_temp_indexes_non_concurrently(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * command_create_collections_with_indexes implements
+ * ApiInternalSchema.create_collections_with_indexes(), which provisions a
+ * set of collections and their indexes in a single transaction, e.g. when
+ * onboarding a tenant.
+ *
+ * The whole spec is validated before anything is created. The collections
+ * are then created with the database colocation resolved once, and since
+ * their tables are empty (or created in this transaction), the indexes are
+ * built non-concurrently which is cheap on an empty table and avoids going
+ * through the index build queue for each of them.
+ */
+Datum
+command_create_collections_with_indexes(PG_FUNCTION_ARGS)
+{
+	Datum dbNameDatum = PG_GETARG_DATUM(0);
+	pgbson *spec = PgbsonDeduplicateFields(PG_GETARG_PGBSON(1));
+
+	ThrowIfServerOrTransactionReadOnly();
+	List *createIndexesArgList = ParseCreateCollectionsWithIndexesSpec(dbNameDatum,
+																		spec);
+
+	List *collectionNames = NIL;
+	ListCell *argCell = NULL;
+	foreach(argCell, createIndexesArgList)
+	{
+		CreateIndexesArg *createIndexesArg = (CreateIndexesArg *) lfirst(argCell);
+		collectionNames = lappend(collectionNames, createIndexesArg->collectionName);
+	}
+
+	int numCollectionsCreated = CreateCollections(DatumGetTextPP(dbNameDatum),
+												  collectionNames);
+
+	int numIndexesCreated = 0;
+	foreach(argCell, createIndexesArgList)
+	{
+		CreateIndexesArg *createIndexesArg = (CreateIndexesArg *) lfirst(argCell);
+		if (list_length(createIndexesArg->indexDefList) == 0)
+		{
+			continue;
+		}
+
+		/*
+		 * Existing collections are allowed here as well, as for the blocking
+		 * createIndexes, since no concurrent build is involved.
+		 */
+		bool skipCheckCollectionCreate = true;
+		bool uniqueIndexOnly = false;
+		CreateIndexesResult result = create_indexes_non_concurrently(
+			dbNameDatum, *createIndexesArg, skipCheckCollectionCreate, uniqueIndexOnly);
+		numIndexesCreated += result.numIndexesAfter - result.numIndexesBefore;
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterAppendInt32(&writer, "numCollectionsCreated",
+							strlen("numCollectionsCreated"), numCollectionsCreated);
+	PgbsonWriterAppendInt32(&writer, "numIndexesCreated", strlen("numIndexesCreated"),
+							numIndexesCreated);
+	PgbsonWriterAppendInt32(&writer, "ok", strlen("ok"), 1);
+	PG_RETURN_POINTER(PgbsonWriterGetPgbson(&writer));
+}
+
+
+/*
+ * Parses the spec of create_collections_with_indexes into a list of
+ * CreateIndexesArg, one per collection (with an empty indexDefList if the
+ * collection has no indexes specified).
+ */
+static List *
+ParseCreateCollectionsWithIndexesSpec(Datum dbNameDatum, pgbson *spec)
+{
+	List *createIndexesArgList = NIL;
+	bool gotCollectionsArray = false;
+
+	bson_iter_t specIter;
+	PgbsonInitIterator(spec, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		const char *specKey = bson_iter_key(&specIter);
+		if (strcmp(specKey, "collections") != 0)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_UNKNOWNBSONFIELD),
+							errmsg("BSON field '%s' is an unknown field", specKey)));
+		}
+
+		EnsureTopLevelFieldType("collections", &specIter, BSON_TYPE_ARRAY);
+		gotCollectionsArray = true;
+
+		bson_iter_t collectionsIter;
+		bson_iter_recurse(&specIter, &collectionsIter);
+		while (bson_iter_next(&collectionsIter))
+		{
+			EnsureTopLevelFieldType("collections.collection", &collectionsIter,
+									BSON_TYPE_DOCUMENT);
+
+			const char *collectionName = NULL;
+			const bson_value_t *indexesValue = NULL;
+
+			bson_iter_t collectionIter;
+			bson_iter_recurse(&collectionsIter, &collectionIter);
+			while (bson_iter_next(&collectionIter))
+			{
+				const char *key = bson_iter_key(&collectionIter);
+				if (strcmp(key, "name") == 0)
+				{
+					EnsureTopLevelFieldType("collections.name", &collectionIter,
+											BSON_TYPE_UTF8);
+					collectionName = bson_iter_utf8(&collectionIter, NULL);
+				}
+				else if (strcmp(key, "indexes") == 0)
+				{
+					EnsureTopLevelFieldType("collections.indexes", &collectionIter,
+											BSON_TYPE_ARRAY);
+					indexesValue = bson_iter_value(&collectionIter);
+				}
+				else
+				{
+					ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_UNKNOWNBSONFIELD),
+									errmsg("BSON field 'collections.%s' is an unknown field",
+										   key)));
+				}
+			}
+
+			if (collectionName == NULL)
+			{
+				ThrowTopLevelMissingFieldError("collections.name");
+			}
+
+			CreateIndexesArg *createIndexesArg = palloc0(sizeof(CreateIndexesArg));
+			if (indexesValue == NULL)
+			{
+				createIndexesArg->collectionName = pstrdup(collectionName);
+			}
+			else
+			{
+				/* Reuse the createIndexes parsing and validation for the indexes */
+				pgbson_writer createIndexesWriter;
+				PgbsonWriterInit(&createIndexesWriter);
+				PgbsonWriterAppendUtf8(&createIndexesWriter, "createIndexes",
+									   strlen("createIndexes"), collectionName);
+				PgbsonWriterAppendValue(&createIndexesWriter, "indexes",
+										strlen("indexes"), indexesValue);
+
+				bool buildAsUniqueForPrepareUnique = false;
+				*createIndexesArg = ParseCreateIndexesArg(
+					dbNameDatum, PgbsonWriterGetPgbson(&createIndexesWriter),
+					buildAsUniqueForPrepareUnique);
+			}
+
+			createIndexesArgList = lappend(createIndexesArgList, createIndexesArg);
+		}
+	}
+
+	if (!gotCollectionsArray)
+	{
+		ThrowTopLevelMissingFieldError("collections");
+	}
+
+	return createIndexesArgList;
+}
+
+
 /*
  * Update the index stats for unique indexes uuid column for the given collection to be 0
  * so that analyze doesn't run on such index columns.
@@ -5077,7 +5280,16 @@ ExecuteCreatePostgresIndexCmd(char *cmd, bool concurrently, const Oid userOid,
 {
 	if (concurrently)
 	{
-		ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ(cmd, userOid, useSerialExecution);
+		if (!useSerialExecution && IndexBuildParallelExecutionOptions != NULL)
+		{
+			ExtensionExecuteQueryAsUserOnLocalhostWithOptionsViaLibPQ(
+				cmd, userOid, useSerialExecution, IndexBuildParallelExecutionOptions);
+		}
+		else
+		{
+			ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ(cmd, userOid,
+														   useSerialExecution);
+		}
 	}
 	else
 	{
@@ -5498,6 +5710,8 @@ GenerateIndexExprStr(const char *indexAmSuffix,
 					ComputeIndexTermLimit(SINGLE_PATH_INDEX_TERM_SIZE_LIMIT));
 		}
 
+		const char *wildcardTermLimitOption = GetWildcardTermLimitOption();
+
 		if (indexDefKey->hasTextIndexes)
 		{
 			appendStringInfo(indexExprStr,
@@ -5523,13 +5737,15 @@ GenerateIndexExprStr(const char *indexAmSuffix,
 
 			appendStringInfo(indexExprStr,
 							 "%s document %s.bson_%s_single_path_ops"
-							 "(path='', iswildcard=true%s%s%s)",
+							 "(path='', iswildcard=true%s%s%s%s%s)",
 							 firstColumnWritten ? "," : "",
 							 indexAmOpClassCatalogSchema,
 							 indexAmSuffix,
 							 indexTermSizeLimitArg,
 							 wildcardIndexTruncatedPathLimit,
-							 useReducedWildcardOption);
+							 useReducedWildcardOption,
+							 wildcardTermLimitOption,
+							 GetNestedArrayTermOption());
 
 			firstColumnWritten = true;
 		}
@@ -5552,13 +5768,14 @@ GenerateIndexExprStr(const char *indexAmSuffix,
 			bool includeId = wpPathOps->idFieldInclusion == WP_IM_INCLUDE;
 			appendStringInfo(indexExprStr,
 							 "%s document %s.bson_%s_wildcard_project_path_ops"
-							 "(includeid=%s%s%s",
+							 "(includeid=%s%s%s%s",
 							 firstColumnWritten ? "," : "",
 							 indexAmOpClassCatalogSchema,
 							 indexAmSuffix,
 							 includeId ? "true" : "false",
 							 indexTermSizeLimitArg,
-							 wildcardIndexTruncatedPathLimit);
+							 wildcardIndexTruncatedPathLimit,
+							 wildcardTermLimitOption);
 
 			firstColumnWritten = true;
 
@@ -5808,18 +6025,24 @@ GenerateIndexExprStr(const char *indexAmSuffix,
 
 					const char *useReducedWildcardOption = "";
 					const char *generateNotFoundTermOption = "";
+					const char *wildcardTermLimitOption = "";
 					if (useReducedWildcardTerms && indexKeyPath->isWildcard)
 					{
 						useReducedWildcardOption = ",rwt=true";
 					}
 
+					if (indexKeyPath->isWildcard)
+					{
+						wildcardTermLimitOption = GetWildcardTermLimitOption();
+					}
+
 					if (generateNotFoundTerm)
 					{
 						generateNotFoundTermOption = ",generateNotFoundTerm=true";
 					}
 
 					appendStringInfo(indexExprStr,
-									 "%s document %s.bson_%s_single_path_ops(path=%s%s%s%s%s)",
+									 "%s document %s.bson_%s_single_path_ops(path=%s%s%s%s%s%s%s)",
 									 firstColumnWritten ? "," : "",
 									 indexAmOpClassCatalogSchema,
 									 indexAmSuffix,
@@ -5827,7 +6050,9 @@ GenerateIndexExprStr(const char *indexAmSuffix,
 									 indexKeyPath->isWildcard ? ",iswildcard=true" : "",
 									 indexTermSizeLimitArg,
 									 generateNotFoundTermOption,
-									 useReducedWildcardOption);
+									 useReducedWildcardOption,
+									 wildcardTermLimitOption,
+									 GetNestedArrayTermOption());
 					if (unique)
 					{
 						appendStringInfo(indexExprStr, " WITH OPERATOR(%s.=?=)",
@@ -110,6 +110,8 @@ typedef enum BackgroundIndexRunStatus
 bool ShouldSetupIndexQueueInUdf = true;
 extern int MaxIndexBuildAttempts;
 extern int IndexQueueEvictionIntervalInSec;
+extern int IndexBuildMaintenanceWorkMemKB;
+extern int IndexBuildMaxParallelWorkers;
 
 /* Do not retry the index build if error code belongs to following list. */
 static const SkippableError SkippableErrors[] = {
@@ -168,6 +170,7 @@ static void TryDropCollectionIndex(int indexId);
 static bool PruneSkippableIndexes(MemoryContext mcxt);
 static BackgroundIndexRunStatus build_index_concurrently_from_indexqueue_core(
 	MemoryContext stableContext);
+static char * GetIndexBuildBackendOptions(bool useSerialExecution);
 
 /*
  * command_build_index_concurrently is the implementation of the internal logic
@@ -411,9 +414,25 @@ build_index_concurrently_from_indexqueue_core(MemoryContext stableContext)
 			"Trying to create index with serial %d for index_id: %d and collectionId: "
 			UINT64_FORMAT, useSerialExecution,
 			indexCmdRequest->indexId, collectionId);
-		bool concurrently = true;
-		ExecuteCreatePostgresIndexCmd(cmd, concurrently, indexCmdRequest->userOid,
-									  useSerialExecution);
+		char *backendOptions = GetIndexBuildBackendOptions(useSerialExecution);
+		if (backendOptions == NULL)
+		{
+			bool concurrently = true;
+			ExecuteCreatePostgresIndexCmd(cmd, concurrently, indexCmdRequest->userOid,
+										  useSerialExecution);
+		}
+		else
+		{
+			/*
+			 * CREATE INDEX CONCURRENTLY can't run in a transaction block, so the
+			 * resource limits are set as options of the build connection.
+			 */
+			ExtensionExecuteQueryAsUserOnLocalhostWithOptionsViaLibPQ(cmd,
+																	  indexCmdRequest
+																	  ->userOid,
+																	  useSerialExecution,
+																	  backendOptions);
+		}
 		indexCreated = true;
 	}
 	PG_CATCH();
@@ -1937,3 +1956,43 @@ PruneSkippableIndexes(MemoryContext mcxt)
 
 	return prunedIndexes;
 }
+
+
+/*
+ * GetIndexBuildBackendOptions returns the backend options that limit the
+ * resources of a background index build, along with the parallel execution
+ * options of sharded collections, or NULL if the server settings should be
+ * used.
+ */
+static char *
+GetIndexBuildBackendOptions(bool useSerialExecution)
+{
+	const char *parallelExecutionOptions = useSerialExecution ? NULL :
+										   IndexBuildParallelExecutionOptions;
+	if (IndexBuildMaintenanceWorkMemKB <= 0 && IndexBuildMaxParallelWorkers < 0 &&
+		parallelExecutionOptions == NULL)
+	{
+		return NULL;
+	}
+
+	StringInfo options = makeStringInfo();
+	if (IndexBuildMaintenanceWorkMemKB > 0)
+	{
+		/* maintenance_work_mem can't go below 1MB */
+		appendStringInfo(options, "-c maintenance_work_mem=%dkB ",
+						 Max(IndexBuildMaintenanceWorkMemKB, 1024));
+	}
+
+	if (IndexBuildMaxParallelWorkers >= 0)
+	{
+		appendStringInfo(options, "-c max_parallel_maintenance_workers=%d ",
+						 IndexBuildMaxParallelWorkers);
+	}
+
+	if (parallelExecutionOptions != NULL)
+	{
+		appendStringInfo(options, "%s ", parallelExecutionOptions);
+	}
+
+	return options->data;
+}
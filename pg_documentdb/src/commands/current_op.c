@@ -32,6 +32,7 @@
 #include "metadata/index.h"
 #include "utils/guc_utils.h"
 #include "index_am/index_am_utils.h"
+#include "utils/command_activity.h"
 
 
 /*
@@ -112,6 +113,15 @@ typedef struct
 
 	/* Index spec for running create Index */
 	IndexSpec *indexSpec;
+
+	/* The query_id of the operation (the query shape hash for find/aggregate) */
+	int64 queryId;
+
+	/* The microseconds since Epoch of the query start */
+	int64 queryStartMicros;
+
+	/* The command published by the backend for this query, if any */
+	CommandActivitySlot *commandActivity;
 } SingleWorkerActivity;
 
 PG_FUNCTION_INFO_V1(command_current_op);
@@ -134,6 +144,10 @@ static const char * WriteCommandAndGetQueryType(const char *query,
 												SingleWorkerActivity *activity,
 												pgbson_writer *commandWriter);
 static void DetectMongoCollection(SingleWorkerActivity *activity);
+static CommandActivitySlot * FindCommandActivity(HTAB *commandActivities,
+												 SingleWorkerActivity *activity);
+static const char * WritePublishedCommandAndGetQueryType(
+	CommandActivitySlot *commandActivity, pgbson_writer *commandWriter);
 static IndexSpec * GetIndexSpecForShardedCreateIndexQuery(SingleWorkerActivity *activity);
 static void AddIndexBuilds(TupleDesc descriptor, Tuplestorestate *tupleStore);
 static const char * WriteIndexBuildProgressAndGetMessage(SingleWorkerActivity *activity,
@@ -144,6 +158,8 @@ static void WriteIndexSpec(SingleWorkerActivity *activity, pgbson_writer *comman
 
 extern char *CurrentOpApplicationName;
 extern bool CurrentOpAddSqlCommand;
+extern bool EnableQueryShapeHash;
+extern bool EnableCommandActivitySlots;
 
 
 /* Single node scenario - the global_pid can be assumed to be just the one for the coordinator */
@@ -408,6 +424,10 @@ CurrentOpWorkerCore(void *specPointer)
 
 	List *activities = WorkerGetBaseActivities();
 
+	/* Backends that published their command don't need their query text parsed */
+	HTAB *commandActivities = EnableCommandActivitySlots ?
+							  GetCommandActivitySnapshot() : NULL;
+
 	pgbson_writer writer;
 	PgbsonWriterInit(&writer);
 
@@ -438,6 +458,12 @@ CurrentOpWorkerCore(void *specPointer)
 		 * index progress need to be handled fully on the worker (the tables aren't
 		 * distributed).
 		 */
+		if (commandActivities != NULL)
+		{
+			activity->commandActivity = FindCommandActivity(commandActivities,
+															activity);
+		}
+
 		pgbson_writer singleActivityWriter;
 		PgbsonArrayWriterStartDocument(&childWriter, &singleActivityWriter);
 		WriteOneActivityToDocument(activity, &singleActivityWriter);
@@ -445,6 +471,10 @@ CurrentOpWorkerCore(void *specPointer)
 	}
 
 	list_free_deep(activities);
+	if (commandActivities != NULL)
+	{
+		hash_destroy(commandActivities);
+	}
 
 	PgbsonWriterEndArray(&writer, &childWriter);
 	return PgbsonWriterGetPgbson(&writer);
@@ -481,7 +511,9 @@ WorkerGetBaseActivities()
 						   " EXTRACT(epoch FROM now() - pa.state_change)::bigint AS state_change_since, "
 						   " pa.groupid AS shard_id, "
 						   " pa.backend_type AS backend_type, "
-						   " pa.leader_pid::bigint AS leaderPid "
+						   " pa.leader_pid::bigint AS leaderPid, "
+						   " pa.query_id AS query_id, "
+						   " (EXTRACT(epoch FROM pa.query_start) * 1000000)::bigint AS query_start_micros "
 						   " FROM (");
 
 	appendStringInfoString(queryInfo, DistributedOperationsQuery);
@@ -698,6 +730,24 @@ WorkerGetBaseActivities()
 			activity->leaderPid = DatumGetInt64(resultDatum);
 		}
 
+		/* query_id (Attr 14) */
+		resultDatum = SPI_getbinval(SPI_tuptable->vals[0],
+									SPI_tuptable->tupdesc, 14,
+									&isNull);
+		if (!isNull)
+		{
+			activity->queryId = DatumGetInt64(resultDatum);
+		}
+
+		/* query_start_micros (Attr 15) */
+		resultDatum = SPI_getbinval(SPI_tuptable->vals[0],
+									SPI_tuptable->tupdesc, 15,
+									&isNull);
+		if (!isNull)
+		{
+			activity->queryStartMicros = DatumGetInt64(resultDatum);
+		}
+
 		spiContext = MemoryContextSwitchTo(priorMemoryContext);
 		workerActivities = lappend(workerActivities, activity);
 		MemoryContextSwitchTo(spiContext);
@@ -719,7 +769,17 @@ static void
 WriteOneActivityToDocument(SingleWorkerActivity *workerActivity,
 						   pgbson_writer *singleActivityWriter)
 {
-	DetectMongoCollection(workerActivity);
+	if (workerActivity->commandActivity != NULL)
+	{
+		workerActivity->processedMongoDatabase =
+			workerActivity->commandActivity->databaseName;
+		workerActivity->processedMongoCollection =
+			workerActivity->commandActivity->collectionName;
+	}
+	else
+	{
+		DetectMongoCollection(workerActivity);
+	}
 
 	char *shardId = psprintf("shard_%d", workerActivity->shardId);
 	PgbsonWriterAppendUtf8(singleActivityWriter, "shard", 5, shardId);
@@ -800,15 +860,41 @@ WriteOneActivityToDocument(SingleWorkerActivity *workerActivity,
 		PgbsonWriterAppendInt64(singleActivityWriter, "secs_running", 12,
 								workerActivity->secsRunning);
 
+		if (EnableQueryShapeHash && workerActivity->queryId != 0)
+		{
+			PgbsonWriterAppendInt64(singleActivityWriter, "queryShapeHash", 14,
+									workerActivity->queryId);
+		}
+
 		pgbson_writer commandDocumentWriter;
 		PgbsonWriterStartDocument(singleActivityWriter, "command", 7,
 								  &commandDocumentWriter);
 
-		const char *queryType = WriteCommandAndGetQueryType(workerActivity->query,
-															workerActivity,
-															&commandDocumentWriter);
+		const char *queryType;
+		if (workerActivity->commandActivity != NULL)
+		{
+			queryType = WritePublishedCommandAndGetQueryType(
+				workerActivity->commandActivity, &commandDocumentWriter);
+		}
+		else
+		{
+			queryType = WriteCommandAndGetQueryType(workerActivity->query,
+													workerActivity,
+													&commandDocumentWriter);
+		}
+
 		PgbsonWriterEndDocument(singleActivityWriter, &commandDocumentWriter);
 		PgbsonWriterAppendUtf8(singleActivityWriter, "op", 2, queryType);
+
+		if (workerActivity->commandActivity != NULL)
+		{
+			CommandExecutionCounters *counters =
+				&workerActivity->commandActivity->executionCounters;
+			PgbsonWriterAppendInt64(singleActivityWriter, "docsExamined", 12,
+									(int64) counters->docsExamined);
+			PgbsonWriterAppendInt64(singleActivityWriter, "keysExamined", 12,
+									(int64) counters->keysExamined);
+		}
 	}
 	else if (workerActivity->state_change_since > 0)
 	{
@@ -1127,6 +1213,55 @@ WriteCommandAndGetQueryType(const char *query, SingleWorkerActivity *activity,
 }
 
 
+/*
+ * Returns the command published by the backend of the activity, if it was
+ * published for the query the activity is running.
+ */
+static CommandActivitySlot *
+FindCommandActivity(HTAB *commandActivities, SingleWorkerActivity *activity)
+{
+	if (activity->statPid <= 0 || activity->queryStartMicros == 0)
+	{
+		return NULL;
+	}
+
+	int pid = (int) activity->statPid;
+	bool found = false;
+	CommandActivitySlot *commandActivity = hash_search(commandActivities, &pid,
+													   HASH_FIND, &found);
+	if (!found)
+	{
+		return NULL;
+	}
+
+	/* A slot published by an earlier statement of the transaction doesn't apply */
+	int64 commandStartMicros = commandActivity->commandStartTime +
+							   ((POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) *
+								USECS_PER_DAY);
+	if (commandStartMicros != activity->queryStartMicros)
+	{
+		return NULL;
+	}
+
+	return commandActivity;
+}
+
+
+/*
+ * Writes the command document from the command published by the backend
+ * and returns its "op".
+ */
+static const char *
+WritePublishedCommandAndGetQueryType(CommandActivitySlot *commandActivity,
+									 pgbson_writer *commandWriter)
+{
+	PgbsonWriterAppendUtf8(commandWriter, commandActivity->commandName,
+						   strlen(commandActivity->commandName),
+						   commandActivity->collectionName);
+	return commandActivity->opType;
+}
+
+
 /*
  * Looks at the "raw" Mongo collection and extracts the
  * actual Mongo database/collection.
@@ -1539,25 +1674,34 @@ WriteIndexBuildProgressAndGetMessage(SingleWorkerActivity *activity,
 	StringInfo str = makeStringInfo();
 
 	/* NULLIF(blocks_total) ensures that "Progress" is NULL if blocks_total is 0 so we don't get div by zero errors and row_get_bson skips the field. */
+	/* The rates are computed from the start of the current transaction of the build which
+	 * for concurrent builds is the start of the current phase. The estimate of the remaining
+	 * time only applies to the table scan (where blocks_total is set).
+	 */
 	appendStringInfoString(str,
-						   "WITH c1 AS (SELECT phase, command LIKE '%%CONCURRENTLY%%' AS concurrent, blocks_done, blocks_total, (blocks_done * 100.0 / NULLIF(blocks_total, 0)) AS \"Progress\", "
-						   " tuples_done AS \"terms_done\", tuples_total AS \"terms_total\", "
-						   " (tuples_done * 100.0 / NULLIF(tuples_total, 0)) AS \"terms_progress\", ");
+						   "WITH c1 AS (SELECT p.phase, p.command LIKE '%%CONCURRENTLY%%' AS concurrent, p.blocks_done, p.blocks_total, (p.blocks_done * 100.0 / NULLIF(p.blocks_total, 0)) AS \"Progress\", "
+						   " p.tuples_done AS \"terms_done\", p.tuples_total AS \"terms_total\", "
+						   " (p.tuples_done * 100.0 / NULLIF(p.tuples_total, 0)) AS \"terms_progress\", "
+						   " EXTRACT(EPOCH FROM (pg_catalog.now() - a.xact_start))::float8 AS \"secs_running\", "
+						   " (p.blocks_done / NULLIF(EXTRACT(EPOCH FROM (pg_catalog.now() - a.xact_start)), 0))::float8 AS \"blocks_per_sec\", "
+						   " (p.tuples_done / NULLIF(EXTRACT(EPOCH FROM (pg_catalog.now() - a.xact_start)), 0))::float8 AS \"terms_per_sec\", "
+						   " (CASE WHEN p.blocks_total > 0 THEN (p.blocks_total - p.blocks_done) * EXTRACT(EPOCH FROM (pg_catalog.now() - a.xact_start)) / NULLIF(p.blocks_done, 0) END)::float8 AS \"estimated_secs_remaining\", "
+						   " (SELECT COUNT(*) FROM pg_catalog.pg_stat_activity w WHERE w.leader_pid = p.pid)::int4 AS \"workers\", ");
 
 	if (DefaultInlineWriteOperations)
 	{
 		/* Match the distributed set up to say a single node has a global pid of node 1 + PID (Similar to citus logic) */
 		appendStringInfoString(str,
 							   " (" SINGLE_NODE_ID_STR
-							   " + current_locker_pid)::int8 AS \"Waiting on op_prefix\""
-							   " FROM pg_stat_progress_create_index WHERE ("
-							   SINGLE_NODE_ID_STR " + current_locker_pid)::int8 = $1), ");
+							   " + p.current_locker_pid)::int8 AS \"Waiting on op_prefix\""
+							   " FROM pg_stat_progress_create_index p LEFT JOIN pg_catalog.pg_stat_activity a ON a.pid = p.pid WHERE ("
+							   SINGLE_NODE_ID_STR " + p.current_locker_pid)::int8 = $1), ");
 	}
 	else
 	{
 		appendStringInfoString(str,
-							   " pg_catalog.citus_calculate_gpid(pg_catalog.citus_nodeid_for_gpid($1), current_locker_pid::integer) AS \"Waiting on op_prefix\""
-							   " FROM pg_stat_progress_create_index WHERE pid IN (SELECT process_id FROM pg_catalog.get_all_active_transactions() WHERE global_pid = $1)), ");
+							   " pg_catalog.citus_calculate_gpid(pg_catalog.citus_nodeid_for_gpid($1), p.current_locker_pid::integer) AS \"Waiting on op_prefix\""
+							   " FROM pg_stat_progress_create_index p LEFT JOIN pg_catalog.pg_stat_activity a ON a.pid = p.pid WHERE p.pid IN (SELECT process_id FROM pg_catalog.get_all_active_transactions() WHERE global_pid = $1)), ");
 	}
 
 	appendStringInfo(str,
@@ -11,6 +11,7 @@
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <funcapi.h>
+#include <catalog/pg_type.h>
 #include <utils/portal.h>
 #include <utils/varlena.h>
 #include <utils/typcache.h>
@@ -49,6 +50,7 @@ extern bool EnablePrimaryKeyCursorScan;
 extern bool UseFileBasedPersistedCursors;
 extern bool EnableDebugQueryText;
 extern bool EnableDelayedHoldPortal;
+extern bool EnableParallelSingleBatchAggregation;
 
 static char LastOpenPortalName[NAMEDATALEN] = { 0 };
 
@@ -169,6 +171,7 @@ static bool ProcessCursorResultRowDataAttribute(TerminationReason *reason,
 												MemoryContext writerContext,
 												pgbson_array_writer *writer);
 
+static pgbson * BuildSortResumeKeyFromCursorResultRow(MemoryContext writerContext);
 static pgbson * ProcessCursorResultRowContinuationAttribute(HTAB *cursorMap,
 															MemoryContext writerContext,
 															bool isTailableCursor);
@@ -335,6 +338,48 @@ DrainStreamingQuery(HTAB *cursorMap, Query *query, int batchSize,
 }
 
 
+/*
+ * Drains a page of a sorted streamable find (see AddSortResumeKeyToQuery). The query
+ * is planned afresh for every page, so the page only needs the rows up to the first
+ * one past the batch: the sort keys of that row are the resume key the next page
+ * starts from, returned in resumeKey. Returns whether the query is fully drained.
+ */
+bool
+DrainSortedStreamingQuery(Query *query, int batchSize, int32_t *numIterations,
+						  uint32_t accumulatedSize, pgbson_array_writer *arrayWriter,
+						  pgbson **resumeKey)
+{
+	*resumeKey = NULL;
+	if (batchSize < INT_MAX)
+	{
+		query->limitCount = (Node *) makeConst(INT8OID, -1, InvalidOid, sizeof(int64_t),
+											   Int64GetDatum((int64_t) batchSize + 1),
+											   false, true);
+	}
+
+	MemoryContext currentContext = CurrentMemoryContext;
+	Portal queryPortal = PlanStreamingQuery(query, (Datum) 0, NULL);
+
+	int32_t accumulatedRows = 0;
+	uint64_t currentAccumulatedSize = 0;
+	TerminationReason reason = FetchCursorAndWriteUntilPageOrSize(
+		queryPortal, batchSize, arrayWriter, &accumulatedSize, NULL,
+		&accumulatedRows, &currentAccumulatedSize, currentContext);
+
+	/* A batchSize of 0 fetches nothing, the next page starts from the beginning */
+	if (reason != TerminationReason_CursorCompletion && batchSize > 0)
+	{
+		*resumeKey = BuildSortResumeKeyFromCursorResultRow(currentContext);
+	}
+
+	SPI_cursor_close(queryPortal);
+	SPI_finish();
+
+	(*numIterations)++;
+	return reason == TerminationReason_CursorCompletion;
+}
+
+
 /*
  * Drain a tailable query by planning and executing the query and fetch the results
  * using a cursor and then drain the cursor until there are no more events available
@@ -389,12 +434,23 @@ DrainTailableQuery(HTAB *cursorMap, Query *query, int batchSize,
 void
 CreateAndDrainSingleBatchQuery(const char *cursorName, Query *query,
 							   int batchSize, int32_t *numIterations, uint32_t
-							   accumulatedSize, pgbson_array_writer *arrayWriter)
+							   accumulatedSize, pgbson_array_writer *arrayWriter,
+							   bool allowParallelPlan)
 {
 	/* Set up cursor flags */
 	bool closeCursor = true;
 	int cursorOptions = CURSOR_OPT_BINARY | CURSOR_OPT_HOLD;
 
+	/*
+	 * The single batch is always drained by running the executor to completion
+	 * so the plan can use parallel workers (e.g. for the base scan of $facet).
+	 */
+	if ((EnableParallelSingleBatchAggregation || allowParallelPlan) &&
+		query->commandType == CMD_SELECT)
+	{
+		cursorOptions |= CURSOR_OPT_PARALLEL_OK;
+	}
+
 	/* Save the context before doing SPI */
 	MemoryContext currentContext = CurrentMemoryContext;
 
@@ -578,11 +634,21 @@ bytea *
 CreateAndDrainPersistedQueryWithFiles(const char *cursorName, Query *query,
 									  int batchSize, int32_t *numIterations, uint32_t
 									  accumulatedSize,
-									  pgbson_array_writer *arrayWriter, bool closeCursor)
+									  pgbson_array_writer *arrayWriter, bool closeCursor,
+									  bool allowParallelPlan)
 {
 	/* Set up cursor flags */
 	int cursorOptions = CURSOR_OPT_BINARY | CURSOR_OPT_HOLD;
 
+	/*
+	 * The results past the first batch are written to the cursor file, so the
+	 * executor runs to completion and the plan can use parallel workers.
+	 */
+	if (allowParallelPlan && query->commandType == CMD_SELECT)
+	{
+		cursorOptions |= CURSOR_OPT_PARALLEL_OK;
+	}
+
 	/* Save the context before doing SPI */
 	MemoryContext currentContext = CurrentMemoryContext;
 
@@ -610,6 +676,54 @@ CreateAndDrainPersistedQueryWithFiles(const char *cursorName, Query *query,
 }
 
 
+/*
+ * Given a query that is an $in on _id, tries the point read planner to probe
+ * the primary key index for the ids and drains the results in one batch.
+ * Results past the batch are spilled to a cursor file whose state is
+ * returned, or NULL if the query was fully drained.
+ */
+bytea *
+CreateAndDrainMultiPointReadQuery(const char *cursorName, Query *query,
+								  int batchSize, int32_t *numIterations,
+								  uint32_t accumulatedSize,
+								  pgbson_array_writer *arrayWriter)
+{
+	/* Set up cursor flags */
+	int cursorOptions = CURSOR_OPT_BINARY | CURSOR_OPT_HOLD;
+
+	/* Save the context before doing SPI */
+	MemoryContext currentContext = CurrentMemoryContext;
+
+	/* Plan the query */
+	ParamListInfo paramList = NULL;
+	PlannedStmt *queryPlan = TryCreatePointReadPlan(query);
+	if (queryPlan == NULL)
+	{
+		ereport(DEBUG1, (errmsg("Falling back to default postgres planner")));
+		queryPlan = pg_plan_query(query, NULL, cursorOptions, paramList);
+	}
+
+	bool closeCursor = false;
+	BsonStoreTupleDestReceiver *receiver = CreateBsonStoreTupleDestReceiver(arrayWriter,
+																			CurrentMemoryContext,
+																			batchSize,
+																			cursorName,
+																			accumulatedSize,
+																			closeCursor);
+	char *sourceText = "";
+	if (EnableDebugQueryText)
+	{
+		bool pretty = false;
+		sourceText = pg_get_querydef(query, pretty);
+	}
+	DrainStatementViaExecutor(queryPlan, paramList, sourceText, (DestReceiver *) receiver,
+							  currentContext);
+
+	/* return the continuation state */
+	return receiver->continuationState;
+}
+
+
 /*
  * Given a query that is a point read query, creates the portal for that
  * query in-line and then drains it and gets the first page.
@@ -1077,7 +1191,7 @@ DrainPersistedFileCursor(const char *cursorName, int batchSize,
 			break;
 		}
 
-		pfree(nextDocument);
+		/* The document is owned by the cursor file state - no need to free it */
 		nextDocument = ReadFromCursorFile(cursorState);
 	}
 
@@ -1344,6 +1458,44 @@ ProcessCursorResultRowDataAttribute(TerminationReason *reason,
 }
 
 
+/*
+ * Builds the resume key { "k": [ <sort keys>..., <object_id> ] } of a sorted
+ * streamable find from the attributes after the document of the current row.
+ */
+static pgbson *
+BuildSortResumeKeyFromCursorResultRow(MemoryContext writerContext)
+{
+	MemoryContext spiContext = MemoryContextSwitchTo(writerContext);
+
+	pgbson_writer writer;
+	pgbson_array_writer keyWriter;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterStartArray(&writer, "k", 1, &keyWriter);
+
+	int tupleNumber = 0;
+	TupleDesc tupleDesc = SPI_tuptable->tupdesc;
+	for (AttrNumber attrNumber = 2; attrNumber <= tupleDesc->natts; attrNumber++)
+	{
+		bool isNull = false;
+		Datum keyDatum = SPI_getbinval(SPI_tuptable->vals[tupleNumber], tupleDesc,
+									   attrNumber, &isNull);
+		if (isNull)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+							errmsg("Sorted find returned a null sort key. This is a bug")));
+		}
+
+		PgbsonArrayWriterWriteDocument(&keyWriter, DatumGetPgBsonPacked(keyDatum));
+	}
+
+	PgbsonWriterEndArray(&writer, &keyWriter);
+	pgbson *resumeKey = PgbsonWriterGetPgbson(&writer);
+
+	MemoryContextSwitchTo(spiContext);
+	return resumeKey;
+}
+
+
 /*
  * Process the "Continuation" attribute from the cursor result row. It updates
  * the cursor map with the continuation token if available.
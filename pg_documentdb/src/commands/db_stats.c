@@ -13,6 +13,7 @@
 #include <funcapi.h>
 #include <utils/guc.h>
 #include <utils/builtins.h>
+#include <utils/timestamp.h>
 #include "utils/lsyscache.h"
 #include <nodes/makefuncs.h>
 #include <catalog/namespace.h>
@@ -30,6 +31,7 @@
 #include "commands/parse_error.h"
 #include "commands/commands_common.h"
 #include "commands/diagnostic_commands_common.h"
+#include "infrastructure/documentdb_stats_cache.h"
 #include "api_hooks.h"
 
 PG_FUNCTION_INFO_V1(command_db_stats);
@@ -257,8 +259,17 @@ DbStatsCoordinator(Datum databaseName, int32 scale)
 	result.scaleFactor = scale;
 	result.ok = 1;
 
-	BuildResultData(databaseName, &result, scale);
-	pgbson *response = BuildResponseMessage(&result);
+	/* dbStats is not for a single collection, so it is cached with collection 0 */
+	uint64 collectionId = 0;
+	pgbson *response = GetCachedStatsResponse(result.db, collectionId, scale);
+	if (response == NULL)
+	{
+		TimestampTz computationStartTime = GetCurrentTimestamp();
+		BuildResultData(databaseName, &result, scale);
+		response = BuildResponseMessage(&result);
+		StoreCachedStatsResponse(result.db, collectionId, scale, computationStartTime,
+								 response);
+	}
 
 	return response;
 }
@@ -34,6 +34,7 @@
 #include "utils/error_utils.h"
 #include "utils/documentdb_errors.h"
 #include "utils/feature_counter.h"
+#include "utils/command_activity.h"
 #include "utils/version_utils.h"
 #include "utils/query_utils.h"
 #include "api_hooks.h"
@@ -92,8 +93,15 @@ typedef struct
 	List *writeErrors;
 } BatchDeletionResult;
 
+/*
+ * Maximum number of deleteMany filters combined into one $or when batching
+ * unordered deletes.
+ */
+#define MAX_BATCHED_DELETE_MANY_FILTERS 1000
+
 extern bool UseLocalExecutionShardQueries;
 extern bool EnableVariablesSupportForWriteCommands;
+extern bool EnableBatchedDeleteMany;
 
 PG_FUNCTION_INFO_V1(command_delete);
 PG_FUNCTION_INFO_V1(command_delete_one);
@@ -116,6 +124,12 @@ static void ProcessBatchDeletion(MongoCollection *collection,
 static pgbson * ProcessBatchDeleteUnsharded(MongoCollection *collection,
 											BatchDeletionSpec *batchSpec,
 											text *transactionId);
+static bool *ProcessBatchedDeleteMany(MongoCollection *collection, List *deletions,
+									   BatchDeletionResult *batchResult);
+static bool TryDeleteMatchingAnyFilter(MongoCollection *collection, List *deletions,
+									   bool *isBatched, int firstIndex, int lastIndex,
+									   const bson_value_t *variableSpec,
+									   uint64 *rowsDeleted);
 static uint64 ProcessDeletion(MongoCollection *collection, DeletionSpec *deletionSpec,
 							  bool forceInlineWrites, text *transactionId);
 static uint64 DeleteAllMatchingDocuments(MongoCollection *collection, pgbson *query,
@@ -185,6 +199,7 @@ command_delete(PG_FUNCTION_ARGS)
 	}
 
 	ReportFeatureUsage(FEATURE_COMMAND_DELETE);
+	PublishCommandActivity("remove", DatumGetTextPP(databaseNameDatum), deleteSpec);
 
 	/* fetch TupleDesc for return value, not interested in resultTypeId */
 	Oid *resultTypeId = NULL;
@@ -348,15 +363,15 @@ BuildBatchDeletionSpec(bson_iter_t *deleteCommandIter, pgbsonsequence *deleteDoc
 								errmsg("'delete.let' is not yet supported")));
 			}
 		}
+		else if (strcmp(field, "writeConcern") == 0)
+		{
+			SetWriteConcernCommitMode(bson_iter_value(deleteCommandIter));
+		}
 		else if (IsCommonSpecIgnoredField(field))
 		{
 			elog(DEBUG1, "Command field not recognized: delete.%s", field);
 
-			/*
-			 *  Silently ignore now, so that clients don't break
-			 *  TODO: implement me
-			 *      writeConcern
-			 */
+			/* Silently ignore now, so that clients don't break */
 		}
 		else
 		{
@@ -628,6 +643,16 @@ ProcessBatchDeletion(MongoCollection *collection, BatchDeletionSpec *batchSpec,
 	batchResult->rowsDeleted = 0;
 	batchResult->writeErrors = NIL;
 
+	/*
+	 * Unordered deleteMany operations don't depend on each other, so they can
+	 * run as a single delete on the union of their filters.
+	 */
+	bool *isDeletionBatched = NULL;
+	if (!isOrdered && EnableBatchedDeleteMany)
+	{
+		isDeletionBatched = ProcessBatchedDeleteMany(collection, deletions, batchResult);
+	}
+
 	/* declared volatile because of the longjmp in PG_CATCH */
 	volatile int deleteIndex = 0;
 
@@ -637,6 +662,11 @@ ProcessBatchDeletion(MongoCollection *collection, BatchDeletionSpec *batchSpec,
 		CHECK_FOR_INTERRUPTS();
 
 		DeletionSpec *deletionSpec = lfirst(deletionCell);
+		if (isDeletionBatched != NULL && isDeletionBatched[deleteIndex])
+		{
+			deleteIndex++;
+			continue;
+		}
 
 		/* declared volatile because of the longjmp in PG_CATCH */
 		volatile uint64 rowsDeleted = 0;
@@ -692,6 +722,175 @@ ProcessBatchDeletion(MongoCollection *collection, BatchDeletionSpec *batchSpec,
 }
 
 
+/*
+ * ProcessBatchedDeleteMany deletes the documents matching any of the
+ * deleteMany (limit 0) operations of an unordered batch with one $or query
+ * per group of filters, so the collection is scanned once (and the heap
+ * visited in ctid order by the bitmap scans of the $or branches) rather than
+ * once per filter. The deleted count is the same as running the operations
+ * one after the other since a document matching several filters is only
+ * deleted once either way.
+ *
+ * Returns an array flagging the operations that were processed, or NULL if
+ * none were. Operations of a group that fails (e.g. an invalid filter) are
+ * left to the regular one at a time processing which reports their errors.
+ */
+static bool *
+ProcessBatchedDeleteMany(MongoCollection *collection, List *deletions,
+						 BatchDeletionResult *batchResult)
+{
+	int numDeletions = list_length(deletions);
+	bool *isBatched = palloc0(sizeof(bool) * numDeletions);
+	const bson_value_t *variableSpec = NULL;
+
+	int numBatchable = 0;
+	for (int i = 0; i < numDeletions; i++)
+	{
+		DeletionSpec *deletionSpec = list_nth(deletions, i);
+		if (deletionSpec->limit == 0 &&
+			!deletionSpec->deleteOneParams.returnDeletedDocument &&
+			!IsCollationApplicable(deletionSpec->deleteOneParams.collationString))
+		{
+			isBatched[i] = true;
+			variableSpec = deletionSpec->deleteOneParams.variableSpec;
+			numBatchable++;
+		}
+	}
+
+	if (numBatchable < 2)
+	{
+		pfree(isBatched);
+		return NULL;
+	}
+
+	ReportFeatureUsage(FEATURE_COMMAND_DELETE_MANY_BATCHED);
+
+	int firstIndex = 0;
+	while (firstIndex < numDeletions)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		/* Find the range holding the next group of batchable filters */
+		int numFilters = 0;
+		int lastIndex = firstIndex;
+		for (; lastIndex < numDeletions &&
+			 numFilters < MAX_BATCHED_DELETE_MANY_FILTERS; lastIndex++)
+		{
+			numFilters += isBatched[lastIndex] ? 1 : 0;
+		}
+
+		if (numFilters == 0)
+		{
+			/* Only limit 1 deletes are left */
+			break;
+		}
+
+		uint64 rowsDeleted = 0;
+		if (TryDeleteMatchingAnyFilter(collection, deletions, isBatched, firstIndex,
+									   lastIndex, variableSpec, &rowsDeleted))
+		{
+			batchResult->rowsDeleted += rowsDeleted;
+		}
+		else
+		{
+			for (int i = firstIndex; i < lastIndex; i++)
+			{
+				isBatched[i] = false;
+			}
+		}
+
+		firstIndex = lastIndex;
+	}
+
+	return isBatched;
+}
+
+
+/*
+ * TryDeleteMatchingAnyFilter deletes the documents matching any of the
+ * batched filters in [firstIndex, lastIndex) in a subtransaction. Returns
+ * false if the delete failed and was rolled back.
+ */
+static bool
+TryDeleteMatchingAnyFilter(MongoCollection *collection, List *deletions,
+						   bool *isBatched, int firstIndex, int lastIndex,
+						   const bson_value_t *variableSpec, uint64 *rowsDeleted)
+{
+	pgbson_writer queryWriter;
+	PgbsonWriterInit(&queryWriter);
+
+	pgbson_array_writer filtersWriter;
+	PgbsonWriterStartArray(&queryWriter, "$or", 3, &filtersWriter);
+	for (int i = firstIndex; i < lastIndex; i++)
+	{
+		if (isBatched[i])
+		{
+			DeletionSpec *deletionSpec = list_nth(deletions, i);
+			PgbsonArrayWriterWriteValue(&filtersWriter,
+										deletionSpec->deleteOneParams.query);
+		}
+	}
+	PgbsonWriterEndArray(&queryWriter, &filtersWriter);
+	pgbson *query = PgbsonWriterGetPgbson(&queryWriter);
+
+	int64 shardKeyHash = 0;
+	bool isShardKeyValueCollationAware = false;
+	bool hasShardKeyValueFilter =
+		ComputeShardKeyHashForQuery(collection->shardKey, collection->collectionId, query,
+									&shardKeyHash, &isShardKeyValueCollationAware);
+
+	MemoryContext oldContext = CurrentMemoryContext;
+	ResourceOwner oldOwner = CurrentResourceOwner;
+
+	/* declared volatile because of the longjmp in PG_CATCH */
+	volatile bool isSuccess = false;
+	volatile uint64 deletedCount = 0;
+
+	BeginInternalSubTransaction(NULL);
+
+	PG_TRY();
+	{
+		const char *collationString = NULL;
+		deletedCount = DeleteAllMatchingDocuments(collection, query, variableSpec,
+												  collationString,
+												  hasShardKeyValueFilter,
+												  shardKeyHash);
+
+		/* Commit the inner transaction, return to outer xact context */
+		ReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldContext);
+		CurrentResourceOwner = oldOwner;
+
+		isSuccess = true;
+	}
+	PG_CATCH();
+	{
+		MemoryContextSwitchTo(oldContext);
+		ErrorData *errorData = CopyErrorDataAndFlush();
+
+		/* Abort inner transaction */
+		RollbackAndReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldContext);
+		CurrentResourceOwner = oldOwner;
+
+		if (IsOperatorInterventionError(errorData))
+		{
+			ReThrowError(errorData);
+		}
+
+		ereport(DEBUG1, (errmsg("batched deleteMany failed, deleting one at a time: %s",
+								errorData->message)));
+		FreeErrorData(errorData);
+		isSuccess = false;
+	}
+	PG_END_TRY();
+
+	pfree(query);
+	*rowsDeleted = deletedCount;
+	return isSuccess;
+}
+
+
 static pgbson *
 ProcessBatchDeleteUnsharded(MongoCollection *collection, BatchDeletionSpec *batchSpec,
 							text *transactionId)
@@ -16,6 +16,9 @@
 #include "lib/stringinfo.h"
 #include "access/xact.h"
 #include "utils/syscache.h"
+#include "utils/inval.h"
+#include "utils/array.h"
+#include "utils/snapmgr.h"
 #include "nodes/makefuncs.h"
 #include "catalog/namespace.h"
 
@@ -36,6 +39,10 @@ static char * ConstructDropCommandCstr(char *databaseName, char *collectionName,
 									   trackChanges);
 
 PG_FUNCTION_INFO_V1(command_drop_collection);
+PG_FUNCTION_INFO_V1(drop_orphaned_collection_tables_background);
+
+extern bool EnableDeferredCollectionDrop;
+extern int DeferredCollectionDropBatchSize;
 
 /*
  * command_drop_collection implements the logic
@@ -133,28 +140,44 @@ command_drop_collection(PG_FUNCTION_ARGS)
 		}
 	}
 
-	StringInfo deleteCommand = makeStringInfo();
-	bool readOnly;
 	bool isNull;
+	if (EnableDeferredCollectionDrop && collection->viewDefinition == NULL)
+	{
+		/*
+		 * Only the metadata is removed here, which makes the name reusable right
+		 * away. The data and retry tables are no longer referenced by any collection
+		 * and are dropped in batches by drop_orphaned_collection_tables_background.
+		 * Invalidate the data table the way dropping it would so that other backends
+		 * forget the collection.
+		 */
+		CacheInvalidateRelcacheByRelid(collection->relationId);
+	}
+	else
+	{
+		StringInfo deleteCommand = makeStringInfo();
+		bool readOnly;
+
+		appendStringInfo(deleteCommand,
+						 "DROP TABLE IF EXISTS %s.documents_"
+						 INT64_FORMAT,
+						 ApiDataSchemaName,
+						 collection->collectionId);
+		readOnly = false;
+		isNull = false;
 
-	appendStringInfo(deleteCommand,
-					 "DROP TABLE IF EXISTS %s.documents_"
-					 INT64_FORMAT,
-					 ApiDataSchemaName,
-					 collection->collectionId);
-	readOnly = false;
-	isNull = false;
-
-	ExtensionExecuteQueryViaSPI(deleteCommand->data, readOnly, SPI_OK_UTILITY, &isNull);
+		ExtensionExecuteQueryViaSPI(deleteCommand->data, readOnly, SPI_OK_UTILITY,
+									&isNull);
 
-	resetStringInfo(deleteCommand);
-	appendStringInfo(deleteCommand,
-					 "DROP TABLE IF EXISTS %s.retry_" INT64_FORMAT,
-					 ApiDataSchemaName, collection->collectionId);
-	readOnly = false;
-	isNull = false;
+		resetStringInfo(deleteCommand);
+		appendStringInfo(deleteCommand,
+						 "DROP TABLE IF EXISTS %s.retry_" INT64_FORMAT,
+						 ApiDataSchemaName, collection->collectionId);
+		readOnly = false;
+		isNull = false;
 
-	ExtensionExecuteQueryViaSPI(deleteCommand->data, readOnly, SPI_OK_UTILITY, &isNull);
+		ExtensionExecuteQueryViaSPI(deleteCommand->data, readOnly, SPI_OK_UTILITY,
+									&isNull);
+	}
 
 	StringInfo deleteFromCollectionsCommand = makeStringInfo();
 	appendStringInfo(deleteFromCollectionsCommand,
@@ -194,6 +217,80 @@ command_drop_collection(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * drop_orphaned_collection_tables_background drops the data and retry tables
+ * that no longer belong to a collection, i.e. those left behind by drops with
+ * enableDeferredCollectionDrop. Each table is dropped in its own transaction
+ * and at most p_batch_size tables are dropped per call so that reclaiming the
+ * storage of many dropped collections is spread over several runs of the job.
+ */
+Datum
+drop_orphaned_collection_tables_background(PG_FUNCTION_ARGS)
+{
+	int batchSize = PG_ARGISNULL(0) || PG_GETARG_INT32(0) <= 0 ?
+					DeferredCollectionDropBatchSize : PG_GETARG_INT32(0);
+
+	StringInfo orphanedTablesQuery = makeStringInfo();
+	appendStringInfo(orphanedTablesQuery,
+					 "SELECT pg_catalog.array_agg(relname::text) FROM ("
+					 " SELECT c.relname FROM pg_catalog.pg_class c"
+					 " WHERE c.relnamespace = %s::regnamespace AND c.relkind IN ('r', 'p')"
+					 " AND c.relname OPERATOR(pg_catalog.~) '^(documents|retry)_[0-9]+$'"
+					 " AND NOT EXISTS (SELECT 1 FROM %s.collections cl"
+					 " WHERE cl.collection_id = pg_catalog.substring(c.relname, '[0-9]+$')::bigint)"
+					 " ORDER BY c.oid LIMIT %d) t",
+					 quote_literal_cstr(ApiDataSchemaName), ApiCatalogSchemaName,
+					 batchSize);
+
+	MemoryContext priorMemoryContext = CurrentMemoryContext;
+
+	bool readOnly = true;
+	bool isNull = false;
+	Datum tablesDatum = ExtensionExecuteQueryViaSPI(orphanedTablesQuery->data, readOnly,
+													SPI_OK_SELECT, &isNull);
+	if (isNull)
+	{
+		PG_RETURN_VOID();
+	}
+
+	Datum *tableNames = NULL;
+	int numTables = 0;
+	ArrayType *tablesArray = DatumGetArrayTypeP(tablesDatum);
+	deconstruct_array(tablesArray, TEXTOID, -1, false, TYPALIGN_INT, &tableNames, NULL,
+					  &numTables);
+
+	List *tablesToDrop = NIL;
+	MemoryContext oldContext = MemoryContextSwitchTo(priorMemoryContext);
+	for (int i = 0; i < numTables; i++)
+	{
+		tablesToDrop = lappend(tablesToDrop, TextDatumGetCString(tableNames[i]));
+	}
+	MemoryContextSwitchTo(oldContext);
+
+	ListCell *tableCell;
+	foreach(tableCell, tablesToDrop)
+	{
+		char *tableName = (char *) lfirst(tableCell);
+		const char *dropQuery = FormatSqlQuery("DROP TABLE IF EXISTS %s.%s",
+											   ApiDataSchemaName,
+											   quote_identifier(tableName));
+
+		readOnly = false;
+		ExtensionExecuteQueryViaSPI(dropQuery, readOnly, SPI_OK_UTILITY, &isNull);
+
+		elog(LOG, "Dropped the table %s.%s of a dropped collection",
+			 ApiDataSchemaName, tableName);
+
+		/* Commit the drop  */
+		PopAllActiveSnapshots();
+		CommitTransactionCommand();
+		StartTransactionCommand();
+	}
+
+	PG_RETURN_VOID();
+}
+
+
 /*
  * Reconstructs the drop command from the parameter values
  */
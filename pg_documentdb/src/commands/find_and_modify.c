@@ -25,6 +25,7 @@
 #include "query/query_operator.h"
 #include "sharding/sharding.h"
 #include "utils/feature_counter.h"
+#include "utils/command_activity.h"
 #include "utils/version_utils.h"
 #include "schema_validation/schema_validation.h"
 #include "operators/bson_expression.h"
@@ -131,6 +132,7 @@ extern bool SkipFailOnCollation;
 extern bool EnableBypassDocumentValidation;
 extern bool EnableSchemaValidation;
 extern bool EnableVariablesSupportForWriteCommands;
+extern bool EnableFindAndModifySkipLocked;
 
 /*
  * command_find_and_modify implements findAndModify command.
@@ -153,6 +155,7 @@ command_find_and_modify(PG_FUNCTION_ARGS)
 	text *transactionId = !PG_ARGISNULL(2) ? PG_GETARG_TEXT_P(2) : NULL;
 
 	ReportFeatureUsage(FEATURE_COMMAND_FINDANDMODIFY);
+	PublishCommandActivity("command", DatumGetTextPP(databaseNameDatum), message);
 
 	/* fetch TupleDesc for return value, not interested in resultTypeId */
 	Oid *resultTypeId = NULL;
@@ -567,7 +570,8 @@ ProcessFindAndModifySpec(MongoCollection *collection, FindAndModifySpec *spec,
 			.returnFields = spec->returnFields,
 			.sort = spec->sort,
 			.update = spec->update,
-			.variableSpec = &spec->variableSpec
+			.variableSpec = &spec->variableSpec,
+			.skipLockedDocuments = EnableFindAndModifySkipLocked
 		};
 
 		UpdateOneResult updateOneResult = { 0 };
@@ -22,6 +22,12 @@
 #include <catalog/pg_class.h>
 #include <parser/parse_relation.h>
 #include <utils/lsyscache.h>
+#include <utils/acl.h>
+#include <utils/rls.h>
+#include <utils/rel.h>
+#include <access/heapam.h>
+#include <access/tableam.h>
+#include <executor/executor.h>
 
 #include "access/xact.h"
 #include "executor/spi.h"
@@ -39,6 +45,7 @@
 #include "io/pgbsonsequence.h"
 #include "utils/query_utils.h"
 #include "utils/feature_counter.h"
+#include "utils/command_activity.h"
 #include "metadata/metadata_cache.h"
 #include "utils/error_utils.h"
 #include "utils/version_utils.h"
@@ -145,6 +152,10 @@ static inline RangeTblEntry * CreateBaseTableRteForInsert(MongoCollection *colle
 														  shardOid,
 														  List **optionalPermInfos);
 static inline void ReportInsertFeatureUsage(int batchSize);
+static bool CanUseDirectShardMultiInsert(Oid shardOid);
+static uint64_t ExecuteDirectShardMultiInsert(MongoCollection *collection, Oid shardOid,
+											  int numRows, int64 *shardKeyValues,
+											  pgbson **objectIds, pgbson **documents);
 
 /*
  * ApiGucPrefix.enable_create_collection_on_insert GUC determines whether
@@ -155,6 +166,8 @@ extern bool UseLocalExecutionShardQueries;
 extern bool EnableBypassDocumentValidation;
 extern bool EnableSchemaValidation;
 extern bool EnableUpdateBsonDocument;
+extern bool EnableDirectShardMultiInsert;
+extern bool EnableInsertBatchResumeAfterFailure;
 
 /*
  * command_insert handles the insert command invocation through a PostgreSQL function.
@@ -166,6 +179,12 @@ Datum
 command_insert(PG_FUNCTION_ARGS)
 {
 	ReportFeatureUsage(FEATURE_COMMAND_INSERT);
+
+	if (!PG_ARGISNULL(0) && !PG_ARGISNULL(1))
+	{
+		PublishCommandActivity("insert", PG_GETARG_TEXT_PP(0), PG_GETARG_PGBSON(1));
+	}
+
 	bool isTransactional = true;
 	PG_RETURN_DATUM(CommandInsertCore(fcinfo, isTransactional, CurrentMemoryContext));
 }
@@ -186,6 +205,11 @@ command_insert_bulk(PG_FUNCTION_ARGS)
 							   " Please use the insert function instead")));
 	}
 
+	if (!PG_ARGISNULL(0) && !PG_ARGISNULL(1))
+	{
+		PublishCommandActivity("insert", PG_GETARG_TEXT_PP(0), PG_GETARG_PGBSON(1));
+	}
+
 	bool isTransactional = false;
 
 	/* For results we need a stable memory context across transactions */
@@ -329,6 +353,10 @@ BuildBatchInsertionSpec(bson_iter_t *insertCommandIter, pgbsonsequence *insertDo
 			SetExplicitStatementTimeout(BsonValueAsInt32(bson_iter_value(
 															 insertCommandIter)));
 		}
+		else if (strcmp(field, "writeConcern") == 0)
+		{
+			SetWriteConcernCommitMode(bson_iter_value(insertCommandIter));
+		}
 		else if (IsCommonSpecIgnoredField(field))
 		{
 			elog(DEBUG1, "Command field not recognized: insert.%s", field);
@@ -336,7 +364,6 @@ BuildBatchInsertionSpec(bson_iter_t *insertCommandIter, pgbsonsequence *insertDo
 			/*
 			 *  Silently ignore now, so that clients don't break
 			 *  TODO: implement me
-			 *      writeConcern
 			 *      comment
 			 */
 		}
@@ -560,10 +587,28 @@ DoMultiInsertWithoutTransactionId(MongoCollection *collection, List *inserts, Oi
 		List *valuesList = NIL;
 		ListCell *insertCell;
 
+		/*
+		 * For a local shard that needs nothing from the executor we write the rows
+		 * directly into the table, otherwise rows go through an INSERT ... VALUES plan.
+		 */
+		bool useDirectInsert = EnableDirectShardMultiInsert && shardOid != InvalidOid &&
+							   CanUseDirectShardMultiInsert(shardOid);
+
 		/* Make params for all the BSONs - we have 2 per insert - objectId/insertDoc */
 		int expectedNumParams = Min(list_length(inserts), BatchWriteSubTransactionCount);
 		ParamListInfo paramListInfo = makeParamList(expectedNumParams * 2);
 		int paramIndex = 0;
+
+		int64 *shardKeyValues = NULL;
+		pgbson **objectIds = NULL;
+		pgbson **insertDocs = NULL;
+		if (useDirectInsert)
+		{
+			shardKeyValues = palloc(sizeof(int64) * expectedNumParams);
+			objectIds = palloc(sizeof(pgbson *) * expectedNumParams);
+			insertDocs = palloc(sizeof(pgbson *) * expectedNumParams);
+		}
+
 		while (insertInnerIndex < list_length(inserts) &&
 			   insertCount < BatchWriteSubTransactionCount)
 		{
@@ -576,6 +621,16 @@ DoMultiInsertWithoutTransactionId(MongoCollection *collection, List *inserts, Oi
 				PreprocessInsertionDoc(documentValue, collection, &shardKeyValue,
 									   &objectId, evalState);
 
+			if (useDirectInsert)
+			{
+				shardKeyValues[insertCount] = shardKeyValue;
+				objectIds[insertCount] = objectId;
+				insertDocs[insertCount] = insertDoc;
+				insertCount++;
+				insertInnerIndex++;
+				continue;
+			}
+
 			/* Generate a values lists for the insert as
 			 * VALUES(shard_key_value, object_id, document, creationTime)
 			 */
@@ -600,7 +655,18 @@ DoMultiInsertWithoutTransactionId(MongoCollection *collection, List *inserts, Oi
 		paramListInfo->numParams = paramIndex;
 
 		uint64_t rowsProcessed = 0;
-		if (shardOid == InvalidOid)
+		if (useDirectInsert)
+		{
+			ThrowIfWriteCommandNotAllowed();
+
+			rowsProcessed = ExecuteDirectShardMultiInsert(collection, shardOid,
+														  insertCount, shardKeyValues,
+														  objectIds, insertDocs);
+			pfree(shardKeyValues);
+			pfree(objectIds);
+			pfree(insertDocs);
+		}
+		else if (shardOid == InvalidOid)
 		{
 			Query *query = CreateInsertQuery(collection, shardOid,
 											 valuesList);
@@ -796,11 +862,28 @@ DoBatchInsertNoTransactionId(MongoCollection *collection, BatchInsertionSpec *ba
 	int insertIndex = 0;
 	bool hasBatchedInsertFailed = false;
 
+	/*
+	 * When resuming batches after a failure, the documents of the failed batch
+	 * (up to this index) are retried one by one.
+	 */
+	int singleInsertEndIndex = list_length(insertions);
+
 	ListCell *insertCell = NULL;
 	while (insertIndex < list_length(insertions))
 	{
 		CHECK_FOR_INTERRUPTS();
 
+		if (hasBatchedInsertFailed && insertIndex >= singleInsertEndIndex)
+		{
+			/*
+			 * Every document of the failed batch went through a single insert,
+			 * so the remaining documents are batched again. This matters most for
+			 * sharded collections where each batch is a single multi-shard INSERT
+			 * while a single insert is a separate distributed statement.
+			 */
+			hasBatchedInsertFailed = false;
+		}
+
 		if (!isTransactional && insertIndex > 0)
 		{
 			/* For each iteration of the loop, commit prior work */
@@ -828,6 +911,13 @@ DoBatchInsertNoTransactionId(MongoCollection *collection, BatchInsertionSpec *ba
 			{
 				/* Has a failure, set hasFailures and retry */
 				hasBatchedInsertFailed = true;
+
+				if (EnableInsertBatchResumeAfterFailure)
+				{
+					singleInsertEndIndex = insertIndex +
+										   Min(list_length(insertions) - insertIndex,
+											   BatchWriteSubTransactionCount);
+				}
 			}
 
 			insertIndex += incrementCount;
@@ -1624,6 +1714,166 @@ ExecuteLocalShardInsertPlan(PlannedStmt *queryPlan, ParamListInfo paramListInfo)
 }
 
 
+/*
+ * Whether the rows of a batch insert into the local shard can be written directly
+ * into the table by ExecuteDirectShardMultiInsert. That skips the parts of the
+ * executor that are not replicated there, so shards that need them (insert triggers,
+ * row level security, non plain tables) are inserted into through a plan instead.
+ */
+static bool
+CanUseDirectShardMultiInsert(Oid shardOid)
+{
+	/* The shard is already locked by TryGetCollectionShardTable */
+	Relation shardRelation = RelationIdGetRelation(shardOid);
+	if (!RelationIsValid(shardRelation))
+	{
+		return false;
+	}
+
+	bool canUseDirectInsert = shardRelation->rd_rel->relkind == RELKIND_RELATION;
+
+	TriggerDesc *triggerDesc = shardRelation->trigdesc;
+	if (triggerDesc != NULL &&
+		(triggerDesc->trig_insert_before_row || triggerDesc->trig_insert_after_row ||
+		 triggerDesc->trig_insert_instead_row ||
+		 triggerDesc->trig_insert_before_statement ||
+		 triggerDesc->trig_insert_after_statement ||
+		 triggerDesc->trig_insert_new_table))
+	{
+		canUseDirectInsert = false;
+	}
+
+	RelationClose(shardRelation);
+
+	if (canUseDirectInsert &&
+		check_enable_rls(shardOid, InvalidOid, true) == RLS_ENABLED)
+	{
+		canUseDirectInsert = false;
+	}
+
+	return canUseDirectInsert;
+}
+
+
+/*
+ * Writes a batch of documents directly into the local shard table with
+ * table_multi_insert (similar to COPY FROM). This avoids building and executing
+ * an INSERT plan for the batch, while still checking the table constraints and
+ * maintaining the indexes (including unique and exclusion constraints) for every
+ * row. Any failure is raised as an error so that the caller can retry the batch one
+ * document at a time to report write errors.
+ *
+ * Returns the number of rows inserted.
+ */
+static uint64_t
+ExecuteDirectShardMultiInsert(MongoCollection *collection, Oid shardOid, int numRows,
+							  int64 *shardKeyValues, pgbson **objectIds,
+							  pgbson **documents)
+{
+	if (pg_class_aclcheck(shardOid, GetUserId(), ACL_INSERT) != ACLCHECK_OK)
+	{
+		aclcheck_error(ACLCHECK_NO_PRIV, OBJECT_TABLE, get_rel_name(shardOid));
+	}
+
+	EState *estate = CreateExecutorState();
+	MemoryContext oldContext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+#if PG_VERSION_NUM >= 160000
+	List *permInfos = NIL;
+	RangeTblEntry *shardRte = CreateBaseTableRteForInsert(collection, shardOid,
+														  &permInfos);
+	ExecInitRangeTable_Compat(estate, list_make1(shardRte), permInfos);
+#else
+	RangeTblEntry *shardRte = CreateBaseTableRteForInsert(collection, shardOid, NULL);
+	ExecInitRangeTable_Compat(estate, list_make1(shardRte), NIL);
+#endif
+
+	const Index shardRelId = 1;
+	estate->es_snapshot = GetActiveSnapshot();
+	estate->es_output_cid = GetCurrentCommandId(true);
+
+	ResultRelInfo *resultRelInfo = makeNode(ResultRelInfo);
+	ExecInitResultRelation(estate, resultRelInfo, shardRelId);
+	ExecOpenIndices(resultRelInfo, false);
+
+	Relation shardRelation = resultRelInfo->ri_RelationDesc;
+	TupleDesc tupleDesc = RelationGetDescr(shardRelation);
+	bool checkConstraints = tupleDesc->constr != NULL;
+
+	/* Same value as the creation_time written by CreateValuesListForInsert */
+	TimestampTz creationTime = (TimestampTz) 0;
+
+	TupleTableSlot **slots = palloc(sizeof(TupleTableSlot *) * numRows);
+	for (int i = 0; i < numRows; i++)
+	{
+		TupleTableSlot *slot = table_slot_create(shardRelation, &estate->es_tupleTable);
+		ExecClearTuple(slot);
+
+		/* Columns not written by inserts (e.g. change_description) stay NULL */
+		memset(slot->tts_isnull, true, sizeof(bool) * tupleDesc->natts);
+
+		slot->tts_values[DOCUMENT_DATA_TABLE_SHARD_KEY_VALUE_VAR_ATTR_NUMBER - 1] =
+			Int64GetDatum(shardKeyValues[i]);
+		slot->tts_isnull[DOCUMENT_DATA_TABLE_SHARD_KEY_VALUE_VAR_ATTR_NUMBER - 1] = false;
+		slot->tts_values[DOCUMENT_DATA_TABLE_OBJECT_ID_VAR_ATTR_NUMBER - 1] =
+			PointerGetDatum(objectIds[i]);
+		slot->tts_isnull[DOCUMENT_DATA_TABLE_OBJECT_ID_VAR_ATTR_NUMBER - 1] = false;
+		slot->tts_values[DOCUMENT_DATA_TABLE_DOCUMENT_VAR_ATTR_NUMBER - 1] =
+			PointerGetDatum(documents[i]);
+		slot->tts_isnull[DOCUMENT_DATA_TABLE_DOCUMENT_VAR_ATTR_NUMBER - 1] = false;
+
+		if (collection->mongoDataCreationTimeVarAttrNumber != -1)
+		{
+			AttrNumber creationTimeAttrNumber =
+				collection->mongoDataCreationTimeVarAttrNumber;
+			slot->tts_values[creationTimeAttrNumber - 1] =
+				TimestampTzGetDatum(creationTime);
+			slot->tts_isnull[creationTimeAttrNumber - 1] = false;
+		}
+
+		ExecStoreVirtualTuple(slot);
+
+		if (checkConstraints)
+		{
+			ExecConstraints(resultRelInfo, slot, estate);
+		}
+
+		slots[i] = slot;
+	}
+
+	BulkInsertState bulkInsertState = GetBulkInsertState();
+	table_multi_insert(shardRelation, slots, numRows, estate->es_output_cid, 0,
+					   bulkInsertState);
+	FreeBulkInsertState(bulkInsertState);
+
+	if (resultRelInfo->ri_NumIndices > 0)
+	{
+		for (int i = 0; i < numRows; i++)
+		{
+			CHECK_FOR_INTERRUPTS();
+
+			List *recheckIndexes = ExecInsertIndexTuples_Compat(resultRelInfo, slots[i],
+																estate, false, false,
+																NULL, NIL);
+			list_free(recheckIndexes);
+			ResetPerTupleExprContext(estate);
+		}
+	}
+
+	/* Make the rows visible to the rest of the command like the executor does */
+	CommandCounterIncrement();
+
+	ExecResetTupleTable(estate->es_tupleTable, false);
+	ExecCloseResultRelations(estate);
+	ExecCloseRangeTableRelations(estate);
+
+	MemoryContextSwitchTo(oldContext);
+	FreeExecutorState(estate);
+
+	return (uint64_t) numRows;
+}
+
+
 /* indicates the presence of a creation_time column in the table, either at attribute number 4 or 5 */
 static inline List *
 CreateValuesListForInsert(Const *shardKey, Expr *objectId, Expr *document, AttrNumber
@@ -48,7 +48,7 @@ FindRetryRecordInAnyShard(uint64 collectionId, text *transactionId,
 	appendStringInfo(&query,
 					 "SELECT object_id, rows_affected, shard_key_value "
 					 " FROM %s.retry_" UINT64_FORMAT
-					 " WHERE transaction_id = $1",
+					 " WHERE transaction_id = $1 LIMIT 1",
 					 ApiDataSchemaName, collectionId);
 
 	argTypes[0] = TEXTOID;
@@ -56,7 +56,7 @@ FindRetryRecordInAnyShard(uint64 collectionId, text *transactionId,
 
 	char *argNulls = NULL;
 	bool readOnly = false;
-	long maxTupleCount = 0;
+	long maxTupleCount = 1;
 
 	SPIPlanPtr plan = GetSPIQueryPlan(collectionId, QUERY_ID_RETRY_RECORD_SELECT,
 									  query.data, argTypes, argCount);
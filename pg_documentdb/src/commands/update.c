@@ -72,6 +72,7 @@
 #include "access/xact.h"
 #include "executor/spi.h"
 #include "lib/stringinfo.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/typcache.h"
 
@@ -92,6 +93,7 @@
 #include "io/pgbsonsequence.h"
 #include "utils/error_utils.h"
 #include "utils/feature_counter.h"
+#include "utils/command_activity.h"
 #include "utils/query_utils.h"
 #include "utils/version_utils.h"
 #include "schema_validation/schema_validation.h"
@@ -105,6 +107,9 @@
 	((state != NULL) && \
 	 (collection->schemaValidator.validationLevel == ValidationLevel_Moderate))
 
+/* The size of the options of a worker update spec besides the update specs */
+#define WORKER_SPEC_OPTIONS_SIZE_HINT 128
+
 extern int NumBsonDocumentsUpdated;
 
 /* This guc is temporary and is used to handle whether the parameter “bypassDocumentValidation” could be set in the request command.*/
@@ -113,6 +118,7 @@ extern bool EnableSchemaValidation;
 
 /* This GUC determines whether to use update_bson_document instead of the bson_update_document command. */
 extern bool EnableUpdateBsonDocument;
+extern bool EnableBatchedUpsertProbe;
 
 /*
  * UpdateSpec describes a single update operation.
@@ -396,6 +402,10 @@ static HeapTuple PerformUpdateCore(Datum databaseNameDatum, pgbson *updateSpec,
 
 static pgbson * SerializeUpdateBatchParams(int *updateIndex, List *updates,
 										   bool ordered, bool bypassDocumentValidation);
+static uint32_t EstimateUpdateOneParamsSize(UpdateOneParams *params);
+static void MarkUpsertsMatchingNoDocument(MongoCollection *collection, List *updates,
+										  int startIndex, int endIndex);
+static void ClearUpsertsMatchingNoDocument(List *updates, int startIndex, int endIndex);
 static void UpdateBatchResultFromWorkerResult(BatchUpdateResult *result, int32_t
 											  updateIndex, pgbson *resultBson);
 static void ProcessBatchUpdateNonTransactionalUnsharded(MongoCollection *collection,
@@ -447,6 +457,7 @@ command_update_bulk(PG_FUNCTION_ARGS)
 	}
 
 	ReportFeatureUsage(FEATURE_COMMAND_UPDATE_BULK);
+	PublishCommandActivity("update", DatumGetTextPP(databaseNameDatum), updateSpec);
 
 	/* fetch TupleDesc for return value, not interested in resultTypeId */
 	Oid *resultTypeId = NULL;
@@ -497,6 +508,7 @@ command_update(PG_FUNCTION_ARGS)
 	}
 
 	ReportFeatureUsage(FEATURE_COMMAND_UPDATE);
+	PublishCommandActivity("update", DatumGetTextPP(databaseNameDatum), updateSpec);
 
 	/* fetch TupleDesc for return value, not interested in resultTypeId */
 	Oid *resultTypeId = NULL;
@@ -819,15 +831,15 @@ BuildBatchUpdateSpec(bson_iter_t *updateCommandIter, pgbsonsequence *updateDocs)
 								errmsg("update.let is not yet supported")));
 			}
 		}
+		else if (strcmp(field, "writeConcern") == 0)
+		{
+			SetWriteConcernCommitMode(bson_iter_value(updateCommandIter));
+		}
 		else if (IsCommonSpecIgnoredField(field))
 		{
 			elog(DEBUG1, "Unrecognized command field: update.%s", field);
 
-			/*
-			 *  Silently ignore now, so that clients don't break
-			 *  TODO: implement me
-			 *      writeConcern
-			 */
+			/* Silently ignore now, so that clients don't break */
 		}
 		else
 		{
@@ -1105,10 +1117,22 @@ DoMultiUpdate(MongoCollection *collection, List *updates, text *transactionId,
 	BatchUpdateResult batchResultInner;
 	memset(&batchResultInner, 0, sizeof(batchResultInner));
 
+	int batchEndIndex = Min(list_length(updates),
+							updateIndex + BatchWriteSubTransactionCount);
+	bool probeUpserts = EnableBatchedUpsertProbe && collection->shardKey == NULL &&
+						(forceInlineWrites || DefaultInlineWriteOperations ||
+						 collection->shardTableName[0] != '\0');
+
 	BeginInternalSubTransaction(NULL);
 
 	PG_TRY();
 	{
+		if (probeUpserts)
+		{
+			MarkUpsertsMatchingNoDocument(collection, updates, updateIndex,
+										  batchEndIndex);
+		}
+
 		ListCell *updateCell;
 		while (updateInnerIndex < list_length(updates) &&
 			   updateCount < BatchWriteSubTransactionCount)
@@ -1126,6 +1150,11 @@ DoMultiUpdate(MongoCollection *collection, List *updates, text *transactionId,
 			updateCount++;
 		}
 
+		if (probeUpserts)
+		{
+			ClearUpsertsMatchingNoDocument(updates, updateIndex, batchEndIndex);
+		}
+
 		/* Commit the inner transaction, return to outer xact context */
 		ReleaseCurrentSubTransaction();
 		MemoryContextSwitchTo(oldContext);
@@ -1151,6 +1180,12 @@ DoMultiUpdate(MongoCollection *collection, List *updates, text *transactionId,
 		MemoryContextSwitchTo(oldContext);
 		CurrentResourceOwner = oldOwner;
 
+		/* The updates are retried one by one, which look up their documents */
+		if (probeUpserts)
+		{
+			ClearUpsertsMatchingNoDocument(updates, updateIndex, batchEndIndex);
+		}
+
 		if (IsOperatorInterventionError(errorData))
 		{
 			ReThrowError(errorData);
@@ -1164,6 +1199,130 @@ DoMultiUpdate(MongoCollection *collection, List *updates, text *transactionId,
 }
 
 
+/*
+ * MarkUpsertsMatchingNoDocument checks the _id only upserts of the updates in
+ * [startIndex, endIndex) against the _id index of the unsharded collection
+ * with a single query, and marks the ones that match no document so that they
+ * are inserted without first looking up their document one at a time.
+ *
+ * An _id that appears in more than one upsert of the batch is not marked since
+ * the first upsert inserts the document that the others update. A document
+ * inserted concurrently after the probe is still handled by the ON CONFLICT
+ * of the insert of the upsert.
+ */
+static void
+MarkUpsertsMatchingNoDocument(MongoCollection *collection, List *updates,
+							  int startIndex, int endIndex)
+{
+	List *candidateSpecs = NIL;
+	List *candidateIds = NIL;
+	for (int i = startIndex; i < endIndex; i++)
+	{
+		UpdateSpec *updateSpec = list_nth(updates, i);
+		UpdateOneParams *params = &updateSpec->updateOneParams;
+		if (updateSpec->isMulti || !params->isUpsert)
+		{
+			continue;
+		}
+
+		bool queryHasNonIdFilters = false;
+		bool isIdFilterCollationAware = false;
+		pgbson *objectId = GetObjectIdFilterFromQueryDocumentValue(params->query,
+																   &queryHasNonIdFilters,
+																   &isIdFilterCollationAware);
+		if (objectId == NULL || queryHasNonIdFilters || isIdFilterCollationAware)
+		{
+			continue;
+		}
+
+		candidateSpecs = lappend(candidateSpecs, updateSpec);
+		candidateIds = lappend(candidateIds, objectId);
+	}
+
+	/* A single upsert gains nothing from the probe */
+	if (list_length(candidateIds) < 2)
+	{
+		list_free(candidateSpecs);
+		list_free(candidateIds);
+		return;
+	}
+
+	int candidateCount = list_length(candidateIds);
+	Datum *idDatums = palloc(sizeof(Datum) * candidateCount);
+	for (int i = 0; i < candidateCount; i++)
+	{
+		idDatums[i] = PointerGetDatum(list_nth(candidateIds, i));
+	}
+
+	ArrayType *idArray = construct_array(idDatums, candidateCount, BsonTypeId(), -1,
+										 false, TYPALIGN_INT);
+
+	/* Returns the (1 based) positions of the unique _ids that match no document */
+	const char *tableName = collection->shardTableName[0] != '\0' ?
+							collection->shardTableName : collection->tableName;
+	StringInfoData probeQuery;
+	initStringInfo(&probeQuery);
+	appendStringInfo(&probeQuery,
+					 "SELECT pg_catalog.min(c.i) FROM pg_catalog.unnest($2) "
+					 "WITH ORDINALITY AS c(id, i) GROUP BY c.id "
+					 "HAVING pg_catalog.count(*) = 1 AND NOT EXISTS (SELECT 1 FROM %s.%s d"
+					 " WHERE d.shard_key_value = $1 AND d.object_id OPERATOR(%s.=) c.id)",
+					 ApiDataSchemaName, tableName, CoreSchemaName);
+
+	int argCount = 2;
+	Oid argTypes[2] = { INT8OID, GetBsonArrayTypeOid() };
+	Datum argValues[2] = {
+		Int64GetDatum((int64) collection->collectionId), PointerGetDatum(idArray)
+	};
+
+	SPI_connect();
+
+	bool readOnly = true;
+	long maxTupleCount = 0;
+	int spiStatus = SPI_execute_with_args(probeQuery.data, argCount, argTypes,
+										  argValues, NULL, readOnly, maxTupleCount);
+	if (spiStatus == SPI_OK_SELECT)
+	{
+		for (uint64 row = 0; row < SPI_processed; row++)
+		{
+			bool isNull = false;
+			Datum positionDatum = SPI_getbinval(SPI_tuptable->vals[row],
+												SPI_tuptable->tupdesc, 1, &isNull);
+			if (isNull)
+			{
+				continue;
+			}
+
+			int64 position = DatumGetInt64(positionDatum);
+			UpdateSpec *updateSpec = list_nth(candidateSpecs, (int) position - 1);
+			updateSpec->updateOneParams.isKnownToMatchNoDocument = true;
+		}
+	}
+
+	SPI_finish();
+
+	pfree(probeQuery.data);
+	pfree(idDatums);
+	list_free(candidateSpecs);
+	list_free(candidateIds);
+}
+
+
+/*
+ * Clears the marks of MarkUpsertsMatchingNoDocument, which only hold within
+ * the sub-transaction the probe ran in.
+ */
+static void
+ClearUpsertsMatchingNoDocument(List *updates, int startIndex, int endIndex)
+{
+	for (int i = startIndex; i < endIndex; i++)
+	{
+		UpdateSpec *updateSpec = list_nth(updates, i);
+		updateSpec->updateOneParams.isKnownToMatchNoDocument = false;
+	}
+}
+
+
 /*
  * Updates a single update in a single sub-transaction.
  */
@@ -2509,12 +2668,17 @@ SerializeUnshardedUpdateParams(const bson_value_t *updateSpec, bool isOrdered,
 						errmsg("Required field 'update.updates' is missing")));
 	}
 
+	/* The specs are the bulk of the worker spec, reserve for them upfront */
+	uint32_t sizeHint = updateSpec != NULL ? updateSpec->value.v_doc.data_len : 0;
+	if (variableSpec != NULL && variableSpec->value_type == BSON_TYPE_DOCUMENT)
+	{
+		sizeHint += variableSpec->value.v_doc.data_len;
+	}
+
 	pgbson_writer writer;
-	PgbsonWriterInit(&writer);
+	PgbsonWriterInitWithSizeHint(&writer, sizeHint + WORKER_SPEC_OPTIONS_SIZE_HINT);
 
 	pgbson_writer innerWriter;
-	PgbsonWriterInit(&innerWriter);
-
 	PgbsonWriterStartDocument(&writer, "updateUnsharded", -1, &innerWriter);
 
 	if (updateSpec != NULL)
@@ -2538,6 +2702,40 @@ SerializeUnshardedUpdateParams(const bson_value_t *updateSpec, bool isOrdered,
 }
 
 
+/*
+ * Estimates the size of the update spec written by WriteUpdateOneParamsAsUpdateSpec.
+ */
+static uint32_t
+EstimateUpdateOneParamsSize(UpdateOneParams *params)
+{
+	/* The field names, the flags and the headers of the spec */
+	uint32_t size = 64;
+	const bson_value_t *values[4] = {
+		params->query, params->update, params->sort, params->arrayFilters
+	};
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (values[i] == NULL)
+		{
+			continue;
+		}
+
+		if (values[i]->value_type == BSON_TYPE_DOCUMENT ||
+			values[i]->value_type == BSON_TYPE_ARRAY)
+		{
+			size += values[i]->value.v_doc.data_len;
+		}
+		else
+		{
+			size += sizeof(bson_value_t);
+		}
+	}
+
+	return size;
+}
+
+
 static void
 WriteUpdateOneParamsAsUpdateSpec(UpdateOneParams *params, pgbson_writer *writer)
 {
@@ -2567,8 +2765,21 @@ static pgbson *
 SerializeUpdateBatchParams(int *updateIndex, List *updates,
 						   bool ordered, bool bypassDocumentValidation)
 {
+	/*
+	 * Reserve the buffer for the whole sub-batch upfront so that large
+	 * updateMany batches are not serialized through a chain of reallocations.
+	 */
+	uint32_t sizeHint = WORKER_SPEC_OPTIONS_SIZE_HINT;
+	int lastUpdateIndex = Min(list_length(updates),
+							  *updateIndex + BatchWriteSubTransactionCount);
+	for (int i = *updateIndex; i < lastUpdateIndex; i++)
+	{
+		UpdateSpec *updateSpec = list_nth(updates, i);
+		sizeHint += EstimateUpdateOneParamsSize(&updateSpec->updateOneParams);
+	}
+
 	pgbson_writer commandWriter;
-	PgbsonWriterInit(&commandWriter);
+	PgbsonWriterInitWithSizeHint(&commandWriter, sizeHint);
 
 	/* Make it just look like an updateUnsharded */
 	pgbson_writer topLevelWriter;
@@ -3124,12 +3335,21 @@ UpdateOneInternal(MongoCollection *collection, UpdateOneParams *updateOneParams,
 						  NeedExistingDocForValidation(stateForSchemaValidation,
 													   collection);
 	bool hasOnlyObjectIdFilter = false;
-	bool foundDocument = SelectUpdateCandidate(collection,
-											   shardKeyHash,
-											   updateOneParams,
-											   &updateCandidate,
-											   getExistingDoc,
-											   &hasOnlyObjectIdFilter);
+	bool foundDocument = false;
+	if (updateOneParams->isKnownToMatchNoDocument)
+	{
+		/* The batch probe found no document with the _id of this upsert */
+		hasOnlyObjectIdFilter = true;
+	}
+	else
+	{
+		foundDocument = SelectUpdateCandidate(collection,
+											  shardKeyHash,
+											  updateOneParams,
+											  &updateCandidate,
+											  getExistingDoc,
+											  &hasOnlyObjectIdFilter);
+	}
 
 	if (!foundDocument)
 	{
@@ -3484,6 +3704,21 @@ SelectUpdateCandidate(MongoCollection *collection, int64 shardKeyHash,
 	appendStringInfo(&updateQuery,
 					 " LIMIT 1 FOR UPDATE");
 
+	/*
+	 * Concurrent consumers of a queue skip the documents the others are updating
+	 * instead of waiting on the same one, and then finding that it no longer
+	 * matches once its lock is released.
+	 */
+	if (updateOneParams->skipLockedDocuments && objectIdFilter == NULL &&
+		!updateOneParams->isUpsert)
+	{
+		appendStringInfo(&updateQuery, " SKIP LOCKED");
+		if (planId != 0)
+		{
+			planId += QUERY_UPDATE_SELECT_UPDATE_CANDIDATE_SKIP_LOCKED_OFFSET;
+		}
+	}
+
 	bool readOnly = false;
 	long maxTupleCount = 1;
 
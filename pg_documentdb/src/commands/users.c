@@ -1073,22 +1073,29 @@ connection_status(pgbson *showPrivilegesSpec)
 	bool noError = true;
 	const char *currentUser = GetUserNameFromId(GetUserId(), noError);
 
-	bool returnDocuments = false;
-	Datum userInfoDatum = GetSingleUserInfo(currentUser, returnDocuments);
-
-	if (userInfoDatum == (Datum) 0)
-	{
-		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
-						errmsg(
-							"Cannot find logged-in user")));
-	}
-
-	const char *parentRole = text_to_cstring(DatumGetTextP(userInfoDatum));
+	/* Drivers run connectionStatus often, so the role of the user is cached */
+	const char *parentRole = GetCachedUserParentRole(GetUserId());
 	if (parentRole == NULL)
 	{
-		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
-						errmsg(
-							"Unable to locate appropriate role for the specified user")));
+		bool returnDocuments = false;
+		Datum userInfoDatum = GetSingleUserInfo(currentUser, returnDocuments);
+
+		if (userInfoDatum == (Datum) 0)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+							errmsg(
+								"Cannot find logged-in user")));
+		}
+
+		parentRole = text_to_cstring(DatumGetTextP(userInfoDatum));
+		if (parentRole == NULL)
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+							errmsg(
+								"Unable to locate appropriate role for the specified user")));
+		}
+
+		CacheUserParentRole(GetUserId(), parentRole);
 	}
 
 	/*
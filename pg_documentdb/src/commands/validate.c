@@ -10,7 +10,8 @@
 
 /*
  * Currently this will only support validating the indexes. It'll only check
- * if the index is valid (checking the 'indisvalid' column in pg_index)
+ * if the index is valid (checking the 'indisvalid' column in pg_index).
+ * A full validation also counts the documents of the collection.
  */
 
 #include <postgres.h>
@@ -37,7 +38,7 @@ typedef struct
 	/* Indicates the name of a collection*/
 	const char *collectionName;
 
-	/* if full validation is required, currently a no-op*/
+	/* if full validation is required, the documents are also counted */
 	bool full;
 
 	/* if repair is required, currently a no-op */
@@ -55,6 +56,9 @@ typedef struct
 	/* The collection's total count of indexes */
 	int32 totalIndexes;
 
+	/* The number of documents in the collection, -1 if not counted */
+	int64 numRecords;
+
 	/* Details of each index along with it's validity */
 	pgbson *indexDetailsPgbson;
 
@@ -74,8 +78,10 @@ typedef struct
 	int32 ok;
 } ValidateResult;
 
-static void validateCollection(MongoCollection *collection, ValidateResult *result);
+static void validateCollection(MongoCollection *collection, bool full,
+							   ValidateResult *result);
 static void CheckIndisvalid(uint64 collectionId, ValidateResult *result);
+static int64 CountCollectionDocuments(MongoCollection *collection);
 static pgbson * BuildResponseMessage(ValidateResult *result);
 
 /*
@@ -178,12 +184,13 @@ command_validate(PG_FUNCTION_ARGS)
 	result.isValid = true;
 	result.isRepaired = false;
 	result.indexDetailsPgbson = NULL;
+	result.numRecords = -1;
 	result.warnings = NIL;
 	result.errors = NIL;
 	result.ok = 1;
 
 
-	validateCollection(collection, &result);
+	validateCollection(collection, validateSpec.full, &result);
 	pgbson *response = BuildResponseMessage(&result);
 	PG_RETURN_POINTER(response);
 }
@@ -193,13 +200,18 @@ command_validate(PG_FUNCTION_ARGS)
  * validateCollection is the internal implementation for validating a collection.
  */
 static void
-validateCollection(MongoCollection *collection, ValidateResult *result)
+validateCollection(MongoCollection *collection, bool full, ValidateResult *result)
 {
 	/* Validate indexes */
 
 	/* check the indisvalid column in pg_index */
 	CheckIndisvalid(collection->collectionId, result);
 
+	if (full)
+	{
+		result->numRecords = CountCollectionDocuments(collection);
+	}
+
 	/*
 	 * TODO Add further index validations here:
 	 * 1. Unique indexes must not have duplicate documents
@@ -311,6 +323,28 @@ CheckIndisvalid(uint64 collectionId, ValidateResult *result)
 }
 
 
+/*
+ * CountCollectionDocuments counts the documents of the collection for a full
+ * validation. The count is left to the planner so that large collections are
+ * scanned by parallel workers, each over a range of the heap.
+ */
+static int64
+CountCollectionDocuments(MongoCollection *collection)
+{
+	StringInfo cmdStr = makeStringInfo();
+	appendStringInfo(cmdStr, "SELECT pg_catalog.count(*) FROM %s.%s",
+					 ApiDataSchemaName, quote_identifier(collection->tableName));
+
+	bool readOnly = true;
+	bool isNull = false;
+	Datum countDatum = ExtensionExecuteQueryViaSPI(cmdStr->data, readOnly,
+												   SPI_OK_SELECT, &isNull);
+	pfree(cmdStr->data);
+
+	return isNull ? 0 : DatumGetInt64(countDatum);
+}
+
+
 /*
  * Builds the pgbson response for the validate() command
  */
@@ -321,6 +355,11 @@ BuildResponseMessage(ValidateResult *result)
 	PgbsonWriterInit(&writer);
 
 	PgbsonWriterAppendUtf8(&writer, "ns", 2, result->ns);
+	if (result->numRecords >= 0)
+	{
+		PgbsonWriterAppendInt64(&writer, "nrecords", 8, result->numRecords);
+	}
+
 	PgbsonWriterAppendInt64(&writer, "nIndexes", 8, result->totalIndexes);
 	PgbsonWriterAppendDocument(&writer, "indexDetails", 12, result->indexDetailsPgbson);
 	PgbsonWriterAppendBool(&writer, "valid", 5, result->isValid);
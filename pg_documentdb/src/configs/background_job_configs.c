@@ -12,6 +12,7 @@
 #include <miscadmin.h>
 #include <utils/guc.h>
 #include <limits.h>
+#include <postmaster/bgworker.h>
 #include "configs/config_initialization.h"
 #include "metadata/metadata_cache.h"
 
@@ -28,9 +29,24 @@ int IndexQueueEvictionIntervalInSec = DEFAULT_INDEX_BUILD_EVICTION_INTERVAL_IN_S
 #define DEFAULT_MAX_NUM_ACTIVE_USERS_INDEX_BUILDS 2
 int MaxNumActiveUsersIndexBuilds = DEFAULT_MAX_NUM_ACTIVE_USERS_INDEX_BUILDS;
 
+#define DEFAULT_ENABLE_INDEX_BUILD_SMALL_COLLECTIONS_FIRST false
+bool EnableIndexBuildSmallCollectionsFirst =
+	DEFAULT_ENABLE_INDEX_BUILD_SMALL_COLLECTIONS_FIRST;
+
+/* 0 keeps the server's maintenance_work_mem for background index builds */
+#define DEFAULT_INDEX_BUILD_MAINTENANCE_WORK_MEM_KB 0
+int IndexBuildMaintenanceWorkMemKB = DEFAULT_INDEX_BUILD_MAINTENANCE_WORK_MEM_KB;
+
+/* -1 keeps the server's max_parallel_maintenance_workers for background index builds */
+#define DEFAULT_INDEX_BUILD_MAX_PARALLEL_WORKERS -1
+int IndexBuildMaxParallelWorkers = DEFAULT_INDEX_BUILD_MAX_PARALLEL_WORKERS;
+
 #define DEFAULT_MAX_TTL_DELETE_BATCH_SIZE 10000
 int MaxTTLDeleteBatchSize = DEFAULT_MAX_TTL_DELETE_BATCH_SIZE;
 
+#define DEFAULT_DEFERRED_COLLECTION_DROP_BATCH_SIZE 100
+int DeferredCollectionDropBatchSize = DEFAULT_DEFERRED_COLLECTION_DROP_BATCH_SIZE;
+
 #define DEFAULT_TTL_PURGER_STATEMENT_TIMEOUT 60000
 int TTLPurgerStatementTimeout = DEFAULT_TTL_PURGER_STATEMENT_TIMEOUT;
 
@@ -56,12 +72,29 @@ bool RepeatPurgeIndexesForTTLTask = DEFAULT_REPEAT_PURGE_INDEXES_FOR_TTL_TASK;
 #define DEFAULT_ENABLE_TTL_DESC_SORT false
 bool EnableTTLDescSort = DEFAULT_ENABLE_TTL_DESC_SORT;
 
+#define DEFAULT_ENABLE_TTL_RESUME_KEY false
+bool EnableTTLResumeKey = DEFAULT_ENABLE_TTL_RESUME_KEY;
+
+#define DEFAULT_TTL_INDEX_PROGRESS_CACHE_SIZE 1024
+int TTLIndexProgressCacheSize = DEFAULT_TTL_INDEX_PROGRESS_CACHE_SIZE;
+
+/* 0 disables adapting the TTL batch size to the WAL generated */
+#define DEFAULT_TTL_TARGET_WAL_PER_BATCH_KB 0
+int TTLTargetWalPerBatchKB = DEFAULT_TTL_TARGET_WAL_PER_BATCH_KB;
+
+/* 0 disables adapting the TTL batch size to the replication lag */
+#define DEFAULT_TTL_MAX_REPLICATION_LAG_KB 0
+int TTLMaxReplicationLagKB = DEFAULT_TTL_MAX_REPLICATION_LAG_KB;
+
 #define DEFAULT_ENABLE_BG_WORKER true
 bool EnableBackgroundWorker = DEFAULT_ENABLE_BG_WORKER;
 
 #define DEFAULT_ENABLE_BG_WORKER_JOBS true
 bool EnableBackgroundWorkerJobs = DEFAULT_ENABLE_BG_WORKER_JOBS;
 
+#define DEFAULT_ENABLE_BG_WORKER_TTL_JOB false
+bool EnableBackgroundWorkerTTLJob = DEFAULT_ENABLE_BG_WORKER_TTL_JOB;
+
 #define DEFAULT_BG_WORKER_JOB_TIMEOUT_THRESHOLD_SEC 300
 int BackgroundWorkerJobTimeoutThresholdSec = DEFAULT_BG_WORKER_JOB_TIMEOUT_THRESHOLD_SEC;
 
@@ -71,6 +104,19 @@ char *BackgroundWorkerDatabaseName = DEFAULT_BG_DATABASE_NAME;
 #define DEFAULT_BG_LATCH_TIMEOUT_SEC 10
 int LatchTimeOutSec = DEFAULT_BG_LATCH_TIMEOUT_SEC;
 
+#define DEFAULT_BG_WORKER_MAX_PARALLEL_JOB_EXECUTIONS 1
+int MaxParallelBackgroundJobExecutions = DEFAULT_BG_WORKER_MAX_PARALLEL_JOB_EXECUTIONS;
+
+/*
+ * The partition of the work a background job execution is assigned, set on the
+ * connection of each execution of a job that runs partitioned.
+ */
+#define DEFAULT_BACKGROUND_JOB_PARTITION_INDEX 0
+int BackgroundJobPartitionIndex = DEFAULT_BACKGROUND_JOB_PARTITION_INDEX;
+
+#define DEFAULT_BACKGROUND_JOB_PARTITION_COUNT 1
+int BackgroundJobPartitionCount = DEFAULT_BACKGROUND_JOB_PARTITION_COUNT;
+
 #define DEFAULT_LOG_TTL_PROGRESS_ACTIVITY false
 bool LogTTLProgressActivity = DEFAULT_LOG_TTL_PROGRESS_ACTIVITY;
 
@@ -100,6 +146,17 @@ InitializeBackgroundJobConfigurations(const char *prefix, const char *newGucPref
 		0,
 		NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.deferredCollectionDropBatchSize", prefix),
+		gettext_noop(
+			"The max number of tables of dropped collections the background job drops per run."),
+		NULL,
+		&DeferredCollectionDropBatchSize,
+		DEFAULT_DEFERRED_COLLECTION_DROP_BATCH_SIZE, 1, INT_MAX,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.logTTLProgressActivity", prefix),
 		gettext_noop(
@@ -224,6 +281,50 @@ InitializeBackgroundJobConfigurations(const char *prefix, const char *newGucPref
 		0,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableTTLResumeKey", newGucPrefix),
+		gettext_noop(
+			"Whether or not TTL deletes with descending sort resume the index scan from the last deleted document."),
+		NULL,
+		&EnableTTLResumeKey,
+		DEFAULT_ENABLE_TTL_RESUME_KEY,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.ttlIndexProgressCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of TTL index shards whose purge progress is tracked across backends. Set 0 to disable."),
+		NULL,
+		&TTLIndexProgressCacheSize,
+		DEFAULT_TTL_INDEX_PROGRESS_CACHE_SIZE, 0, 1024 * 1024,
+		PGC_POSTMASTER,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.ttlTargetWalPerBatch", newGucPrefix),
+		gettext_noop(
+			"The target amount of WAL generated by a single batch of TTL deletes, the batch size is adapted towards it. Set 0 to disable."),
+		NULL,
+		&TTLTargetWalPerBatchKB,
+		DEFAULT_TTL_TARGET_WAL_PER_BATCH_KB, 0, INT_MAX,
+		PGC_USERSET,
+		GUC_UNIT_KB,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.ttlMaxReplicationLag", newGucPrefix),
+		gettext_noop(
+			"The replication lag past which the batch size of TTL deletes is reduced. Set 0 to disable."),
+		NULL,
+		&TTLMaxReplicationLagKB,
+		DEFAULT_TTL_MAX_REPLICATION_LAG_KB, 0, INT_MAX,
+		PGC_USERSET,
+		GUC_UNIT_KB,
+		NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.maxNumActiveUsersIndexBuilds", prefix),
 		gettext_noop("Max number of active users Index Builds that can run."),
@@ -233,6 +334,34 @@ InitializeBackgroundJobConfigurations(const char *prefix, const char *newGucPref
 		0,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableIndexBuildSmallCollectionsFirst", newGucPrefix),
+		gettext_noop(
+			"Whether to pick queued index builds of smaller collections before larger ones."),
+		NULL, &EnableIndexBuildSmallCollectionsFirst,
+		DEFAULT_ENABLE_INDEX_BUILD_SMALL_COLLECTIONS_FIRST,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.indexBuildMaintenanceWorkMem", newGucPrefix),
+		gettext_noop(
+			"The maintenance_work_mem used by background index builds. Set 0 to use the server setting."),
+		NULL, &IndexBuildMaintenanceWorkMemKB,
+		DEFAULT_INDEX_BUILD_MAINTENANCE_WORK_MEM_KB, 0, MAX_KILOBYTES,
+		PGC_USERSET,
+		GUC_UNIT_KB,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.indexBuildMaxParallelWorkers", newGucPrefix),
+		gettext_noop(
+			"The max_parallel_maintenance_workers used by background index builds. Set -1 to use the server setting."),
+		NULL, &IndexBuildMaxParallelWorkers,
+		DEFAULT_INDEX_BUILD_MAX_PARALLEL_WORKERS, -1, MAX_PARALLEL_WORKER_LIMIT,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.maxIndexBuildAttempts", prefix),
 		gettext_noop(
@@ -274,6 +403,13 @@ InitializeBackgroundJobConfigurations(const char *prefix, const char *newGucPref
 		NULL, &EnableBackgroundWorkerJobs, DEFAULT_ENABLE_BG_WORKER_JOBS,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBackgroundWorkerTTLJob", newGucPrefix),
+		gettext_noop(
+			"Run the TTL purge as a partitioned background worker job instead of the documentdb_ttl_task cron job."),
+		NULL, &EnableBackgroundWorkerTTLJob, DEFAULT_ENABLE_BG_WORKER_TTL_JOB,
+		PGC_POSTMASTER, 0, NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.backgroundWorkerJobTimeoutThresholdSec", newGucPrefix),
 		gettext_noop(
@@ -283,6 +419,28 @@ InitializeBackgroundJobConfigurations(const char *prefix, const char *newGucPref
 		PGC_USERSET,
 		0,
 		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.backgroundJobPartitionIndex", newGucPrefix),
+		gettext_noop(
+			"The partition of the work processed by a partitioned background job execution."),
+		NULL,
+		&BackgroundJobPartitionIndex,
+		DEFAULT_BACKGROUND_JOB_PARTITION_INDEX, 0, INT_MAX,
+		PGC_USERSET,
+		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.backgroundJobPartitionCount", newGucPrefix),
+		gettext_noop(
+			"The number of partitions the work of a partitioned background job is split into."),
+		NULL,
+		&BackgroundJobPartitionCount,
+		DEFAULT_BACKGROUND_JOB_PARTITION_COUNT, 1, INT_MAX,
+		PGC_USERSET,
+		GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE,
+		NULL, NULL, NULL);
 }
 
 
@@ -310,4 +468,17 @@ InitDocumentDBBackgroundWorkerConfigurations(const char *prefix)
 		PGC_POSTMASTER,
 		GUC_SUPERUSER_ONLY,
 		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.bg_worker_max_parallel_job_executions", prefix),
+		gettext_noop(
+			"Number of parallel executions (each on its own connection) of the background jobs that support partitioned execution."),
+		NULL,
+		&MaxParallelBackgroundJobExecutions,
+		DEFAULT_BG_WORKER_MAX_PARALLEL_JOB_EXECUTIONS,
+		1,
+		32,
+		PGC_SIGHUP,
+		GUC_SUPERUSER_ONLY,
+		NULL, NULL, NULL);
 }
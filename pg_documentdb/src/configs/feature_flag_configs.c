@@ -59,6 +59,20 @@ bool EnableVectorPreFilter = DEFAULT_ENABLE_VECTOR_PRE_FILTER;
 #define DEFAULT_ENABLE_VECTOR_PRE_FILTER_V2 false
 bool EnableVectorPreFilterV2 = DEFAULT_ENABLE_VECTOR_PRE_FILTER_V2;
 
+/* GUC to pick the pre-filtering strategy from the estimated filter selectivity. */
+#define DEFAULT_ENABLE_VECTOR_ADAPTIVE_PRE_FILTER false
+bool EnableVectorAdaptivePreFilter = DEFAULT_ENABLE_VECTOR_ADAPTIVE_PRE_FILTER;
+
+/* GUC to enable searching a list of query vectors in one $search. */
+#define DEFAULT_ENABLE_VECTOR_SEARCH_BATCHED_QUERIES false
+bool EnableVectorSearchBatchedQueries = DEFAULT_ENABLE_VECTOR_SEARCH_BATCHED_QUERIES;
+
+#define DEFAULT_ENABLE_VECTOR_EXTRACT_FAST_PATH false
+bool EnableVectorExtractFastPath = DEFAULT_ENABLE_VECTOR_EXTRACT_FAST_PATH;
+
+#define DEFAULT_ENABLE_VECTOR_BINARY_VECTOR_SUBTYPE false
+bool EnableVectorBinaryVectorSubtype = DEFAULT_ENABLE_VECTOR_BINARY_VECTOR_SUBTYPE;
+
 #define DEFAULT_ENABLE_VECTOR_FORCE_INDEX_PUSHDOWN false
 bool EnableVectorForceIndexPushdown = DEFAULT_ENABLE_VECTOR_FORCE_INDEX_PUSHDOWN;
 
@@ -69,6 +83,10 @@ bool EnableVectorCompressionHalf = DEFAULT_ENABLE_VECTOR_COMPRESSION_HALF;
 #define DEFAULT_ENABLE_VECTOR_COMPRESSION_PQ true
 bool EnableVectorCompressionPQ = DEFAULT_ENABLE_VECTOR_COMPRESSION_PQ;
 
+#define DEFAULT_ENABLE_VECTOR_COMPRESSION_SINGLE_RERANK_DISTANCE false
+bool EnableVectorCompressionSingleRerankDistance =
+	DEFAULT_ENABLE_VECTOR_COMPRESSION_SINGLE_RERANK_DISTANCE;
+
 #define DEFAULT_ENABLE_VECTOR_CALCULATE_DEFAULT_SEARCH_PARAM true
 bool EnableVectorCalculateDefaultSearchParameter =
 	DEFAULT_ENABLE_VECTOR_CALCULATE_DEFAULT_SEARCH_PARAM;
@@ -86,6 +104,12 @@ bool EnableCompositeIndexPlanner = DEFAULT_ENABLE_COMPOSITE_INDEX_PLANNER;
 #define DEFAULT_ENABLE_INDEX_ORDERBY_PUSHDOWN true
 bool EnableIndexOrderbyPushdown = DEFAULT_ENABLE_INDEX_ORDERBY_PUSHDOWN;
 
+#define DEFAULT_ENABLE_RUM_ROARING_BITMAP_INTERSECTION false
+bool EnableRumRoaringBitmapIntersection = DEFAULT_ENABLE_RUM_ROARING_BITMAP_INTERSECTION;
+
+#define DEFAULT_ENABLE_WILDCARD_INDEX_PATH_FILTER false
+bool EnableWildcardIndexPathFilter = DEFAULT_ENABLE_WILDCARD_INDEX_PATH_FILTER;
+
 /* Remove in v110 */
 #define DEFAULT_ENABLE_INDEX_ORDERBY_REVERSE true
 bool EnableIndexOrderByReverse = DEFAULT_ENABLE_INDEX_ORDERBY_REVERSE;
@@ -94,6 +118,10 @@ bool EnableIndexOrderByReverse = DEFAULT_ENABLE_INDEX_ORDERBY_REVERSE;
 #define DEFAULT_ENABLE_INDEX_ONLY_SCAN false
 bool EnableIndexOnlyScan = DEFAULT_ENABLE_INDEX_ONLY_SCAN;
 
+#define DEFAULT_ENABLE_COVERED_PROJECTION_INDEX_ONLY_SCAN false
+bool EnableCoveredProjectionIndexOnlyScan =
+	DEFAULT_ENABLE_COVERED_PROJECTION_INDEX_ONLY_SCAN;
+
 #define DEFAULT_ENABLE_ID_INDEX_CUSTOM_COST_FUNCTION true
 bool EnableIdIndexCustomCostFunction = DEFAULT_ENABLE_ID_INDEX_CUSTOM_COST_FUNCTION;
 
@@ -128,6 +156,9 @@ bool EnableCompositeWildcardIndex = DEFAULT_ENABLE_COMPOSITE_WILDCARD_INDEX;
 #define DEFAULT_ENABLE_NEW_OPERATOR_SELECTIVITY false
 bool EnableNewOperatorSelectivityMode = DEFAULT_ENABLE_NEW_OPERATOR_SELECTIVITY;
 
+#define DEFAULT_ENABLE_PATH_STATISTICS_SELECTIVITY false
+bool EnablePathStatisticsSelectivity = DEFAULT_ENABLE_PATH_STATISTICS_SELECTIVITY;
+
 #define DEFAULT_DISABLE_DOLLAR_FUNCTION_SELECTIVITY false
 bool DisableDollarSupportFuncSelectivity = DEFAULT_DISABLE_DOLLAR_FUNCTION_SELECTIVITY;
 
@@ -135,6 +166,28 @@ bool DisableDollarSupportFuncSelectivity = DEFAULT_DISABLE_DOLLAR_FUNCTION_SELEC
 #define DEFAULT_LOOKUP_ENABLE_INNER_JOIN true
 bool EnableLookupInnerJoin = DEFAULT_LOOKUP_ENABLE_INNER_JOIN;
 
+#define DEFAULT_ENABLE_LOOKUP_HASH_JOIN false
+bool EnableLookupHashJoin = DEFAULT_ENABLE_LOOKUP_HASH_JOIN;
+
+#define DEFAULT_ENABLE_NATIVE_GRAPH_LOOKUP false
+bool EnableNativeGraphLookup = DEFAULT_ENABLE_NATIVE_GRAPH_LOOKUP;
+
+#define DEFAULT_ENABLE_COLOCATED_LOOKUP_PUSHDOWN false
+bool EnableColocatedLookupPushdown = DEFAULT_ENABLE_COLOCATED_LOOKUP_PUSHDOWN;
+
+#define DEFAULT_ENABLE_SORTED_MERGE_SOURCE false
+bool EnableSortedMergeSource = DEFAULT_ENABLE_SORTED_MERGE_SOURCE;
+
+#define DEFAULT_ENABLE_STAGED_OUT_LOAD false
+bool EnableStagedOutLoad = DEFAULT_ENABLE_STAGED_OUT_LOAD;
+
+#define DEFAULT_ENABLE_INSERT_BATCH_RESUME_AFTER_FAILURE false
+bool EnableInsertBatchResumeAfterFailure =
+	DEFAULT_ENABLE_INSERT_BATCH_RESUME_AFTER_FAILURE;
+
+#define DEFAULT_ENABLE_SHARD_KEY_IN_ARRAY_FILTER false
+bool EnableShardKeyInArrayFilter = DEFAULT_ENABLE_SHARD_KEY_IN_ARRAY_FILTER;
+
 #define DEFAULT_FORCE_BITMAP_SCAN_FOR_LOOKUP false
 bool ForceBitmapScanForLookup = DEFAULT_FORCE_BITMAP_SCAN_FOR_LOOKUP;
 
@@ -166,6 +219,112 @@ bool EnableUpdateBsonDocument = DEFAULT_ENABLE_UPDATE_BSON_DOCUMENT;
 #define DEFAULT_ENABLE_NEW_COUNT_AGGREGATES true
 bool EnableNewCountAggregates = DEFAULT_ENABLE_NEW_COUNT_AGGREGATES;
 
+#define DEFAULT_ENABLE_SHARED_QUERY_PLAN_HINTS false
+bool EnableSharedQueryPlanHints = DEFAULT_ENABLE_SHARED_QUERY_PLAN_HINTS;
+
+#define DEFAULT_ENABLE_GEONEAR_ORDERED_INDEX_SCAN false
+bool EnableGeonearOrderedIndexScan = DEFAULT_ENABLE_GEONEAR_ORDERED_INDEX_SCAN;
+
+#define DEFAULT_ENABLE_GEOSPATIAL_BULK_POINT_PARSING false
+bool EnableGeospatialBulkPointParsing = DEFAULT_ENABLE_GEOSPATIAL_BULK_POINT_PARSING;
+
+#define DEFAULT_ENABLE_TEXT_VECTOR_REUSE_FOR_SCORE false
+bool EnableTextVectorReuseForScore = DEFAULT_ENABLE_TEXT_VECTOR_REUSE_FOR_SCORE;
+
+#define DEFAULT_ENABLE_JSON_SCHEMA_COMPILED_VALIDATION false
+bool EnableJsonSchemaCompiledValidation = DEFAULT_ENABLE_JSON_SCHEMA_COMPILED_VALIDATION;
+
+#define DEFAULT_ENABLE_AGGREGATION_STAGE_COUNTERS false
+bool EnableAggregationStageCounters = DEFAULT_ENABLE_AGGREGATION_STAGE_COUNTERS;
+
+#define DEFAULT_ENABLE_PERCENTILE_SKETCHES false
+bool EnablePercentileSketches = DEFAULT_ENABLE_PERCENTILE_SKETCHES;
+
+#define DEFAULT_ENABLE_COMBINABLE_GROUP_ACCUMULATORS false
+bool EnableCombinableGroupAccumulators = DEFAULT_ENABLE_COMBINABLE_GROUP_ACCUMULATORS;
+
+#define DEFAULT_ENABLE_STREAMING_UNWIND false
+bool EnableStreamingUnwind = DEFAULT_ENABLE_STREAMING_UNWIND;
+
+#define DEFAULT_ENABLE_QUERY_SHAPE_HASH false
+bool EnableQueryShapeHash = DEFAULT_ENABLE_QUERY_SHAPE_HASH;
+
+#define DEFAULT_ENABLE_STATS_ONLY_COLLECTION_COUNT false
+bool EnableStatsOnlyCollectionCount = DEFAULT_ENABLE_STATS_ONLY_COLLECTION_COUNT;
+
+#define DEFAULT_ENABLE_DISTINCT_INDEX_ONLY_SCAN false
+bool EnableDistinctIndexOnlyScan = DEFAULT_ENABLE_DISTINCT_INDEX_ONLY_SCAN;
+
+#define DEFAULT_ENABLE_GROUP_INDEX_ONLY_SCAN false
+bool EnableGroupIndexOnlyScan = DEFAULT_ENABLE_GROUP_INDEX_ONLY_SCAN;
+
+#define DEFAULT_ENABLE_APPROXIMATE_BUCKET_AUTO false
+bool EnableApproximateBucketAuto = DEFAULT_ENABLE_APPROXIMATE_BUCKET_AUTO;
+
+#define DEFAULT_ENABLE_INVERSE_MATCH_EQUALITY_PREFILTER true
+bool EnableInverseMatchEqualityPrefilter =
+	DEFAULT_ENABLE_INVERSE_MATCH_EQUALITY_PREFILTER;
+
+#define DEFAULT_ENABLE_CLUSTERED_COLLECTIONS false
+bool EnableClusteredCollections = DEFAULT_ENABLE_CLUSTERED_COLLECTIONS;
+
+#define DEFAULT_ENABLE_QUERY_DOCUMENT_SLICE_DETOAST false
+bool EnableQueryDocumentSliceDetoast = DEFAULT_ENABLE_QUERY_DOCUMENT_SLICE_DETOAST;
+
+#define DEFAULT_ENABLE_DEFERRED_COLLECTION_DROP false
+bool EnableDeferredCollectionDrop = DEFAULT_ENABLE_DEFERRED_COLLECTION_DROP;
+
+#define DEFAULT_ENABLE_CHANGE_STREAM_FILTER_PUSHDOWN false
+bool EnableChangeStreamFilterPushdown = DEFAULT_ENABLE_CHANGE_STREAM_FILTER_PUSHDOWN;
+
+#define DEFAULT_ENABLE_COMMAND_ACTIVITY_SLOTS false
+bool EnableCommandActivitySlots = DEFAULT_ENABLE_COMMAND_ACTIVITY_SLOTS;
+
+#define DEFAULT_ENABLE_ROLE_PRIVILEGE_CACHE true
+bool EnableRolePrivilegeCache = DEFAULT_ENABLE_ROLE_PRIVILEGE_CACHE;
+
+#define DEFAULT_ENABLE_BATCHED_UPSERT_PROBE false
+bool EnableBatchedUpsertProbe = DEFAULT_ENABLE_BATCHED_UPSERT_PROBE;
+
+#define DEFAULT_ENABLE_FIND_AND_MODIFY_SKIP_LOCKED false
+bool EnableFindAndModifySkipLocked = DEFAULT_ENABLE_FIND_AND_MODIFY_SKIP_LOCKED;
+
+#define DEFAULT_ENABLE_COMPILED_QUERY_MATCH false
+bool EnableCompiledQueryMatch = DEFAULT_ENABLE_COMPILED_QUERY_MATCH;
+
+#define DEFAULT_ENABLE_TEXT_INDEX_SKIP_RUNTIME_RECHECK false
+bool EnableTextIndexSkipRuntimeRecheck = DEFAULT_ENABLE_TEXT_INDEX_SKIP_RUNTIME_RECHECK;
+
+#define DEFAULT_ENABLE_INDEX_STATS_ACCESS_DETAILS false
+bool EnableIndexStatsAccessDetails = DEFAULT_ENABLE_INDEX_STATS_ACCESS_DETAILS;
+
+#define DEFAULT_ENABLE_CACHED_COMPARISON_FILTERS false
+bool EnableCachedComparisonFilters = DEFAULT_ENABLE_CACHED_COMPARISON_FILTERS;
+
+#define DEFAULT_ENABLE_DOLLAR_MAP_DOUBLE_KERNELS false
+bool EnableDollarMapDoubleKernels = DEFAULT_ENABLE_DOLLAR_MAP_DOUBLE_KERNELS;
+
+#define DEFAULT_ENABLE_LOOKUP_FILTER_DEDUPLICATION false
+bool EnableLookupFilterDeduplication = DEFAULT_ENABLE_LOOKUP_FILTER_DEDUPLICATION;
+
+#define DEFAULT_ENABLE_PARALLEL_UNION_WITH false
+bool EnableParallelUnionWith = DEFAULT_ENABLE_PARALLEL_UNION_WITH;
+
+#define DEFAULT_ENABLE_ASYNC_COMMIT_WRITE_CONCERN false
+bool EnableAsyncCommitWriteConcern = DEFAULT_ENABLE_ASYNC_COMMIT_WRITE_CONCERN;
+
+#define DEFAULT_ENABLE_IMPLIED_PARTIAL_INDEX_MATCH false
+bool EnableImpliedPartialIndexMatch = DEFAULT_ENABLE_IMPLIED_PARTIAL_INDEX_MATCH;
+
+#define DEFAULT_ENABLE_RANK_FUSION_STAGE false
+bool EnableRankFusionStage = DEFAULT_ENABLE_RANK_FUSION_STAGE;
+
+#define DEFAULT_ENABLE_SORTED_FIND_STREAMING_CURSOR false
+bool EnableSortedFindStreamingCursor = DEFAULT_ENABLE_SORTED_FIND_STREAMING_CURSOR;
+
+#define DEFAULT_ENABLE_ELEMMATCH_NESTED_ARRAY_TERM false
+bool EnableElemMatchNestedArrayTerm = DEFAULT_ENABLE_ELEMMATCH_NESTED_ARRAY_TERM;
+
 
 /*
  * SECTION: Aggregation & Query feature flags
@@ -173,16 +332,41 @@ bool EnableNewCountAggregates = DEFAULT_ENABLE_NEW_COUNT_AGGREGATES;
 #define DEFAULT_ENABLE_NOW_SYSTEM_VARIABLE true
 bool EnableNowSystemVariable = DEFAULT_ENABLE_NOW_SYSTEM_VARIABLE;
 
+#define DEFAULT_ENABLE_QUERY_DOCUMENT_DETOAST_CACHE false
+bool EnableQueryDocumentDetoastCache = DEFAULT_ENABLE_QUERY_DOCUMENT_DETOAST_CACHE;
+
+#define DEFAULT_ENABLE_DIRECT_SHARD_MULTI_INSERT false
+bool EnableDirectShardMultiInsert = DEFAULT_ENABLE_DIRECT_SHARD_MULTI_INSERT;
+
+#define DEFAULT_ENABLE_BATCHED_DELETE_MANY false
+bool EnableBatchedDeleteMany = DEFAULT_ENABLE_BATCHED_DELETE_MANY;
+
+#define DEFAULT_ENABLE_IN_PLACE_FIXED_SIZE_UPDATES false
+bool EnableInPlaceFixedSizeUpdates = DEFAULT_ENABLE_IN_PLACE_FIXED_SIZE_UPDATES;
+
 #define DEFAULT_ENABLE_PRIMARY_KEY_CURSOR_SCAN false
 bool EnablePrimaryKeyCursorScan = DEFAULT_ENABLE_PRIMARY_KEY_CURSOR_SCAN;
 
 #define DEFAULT_USE_FILE_BASED_PERSISTED_CURSORS false
 bool UseFileBasedPersistedCursors = DEFAULT_USE_FILE_BASED_PERSISTED_CURSORS;
 
+#define DEFAULT_ENABLE_CURSOR_FILE_COMPRESSION false
+bool EnableCursorFileCompression = DEFAULT_ENABLE_CURSOR_FILE_COMPRESSION;
+
+#define DEFAULT_ENABLE_CURSOR_FILE_MEMORY_MAP true
+bool EnableCursorFileMemoryMap = DEFAULT_ENABLE_CURSOR_FILE_MEMORY_MAP;
+
 #define DEFAULT_ENABLE_CONVERSION_STREAMABLE_SINGLE_BATCH true
 bool EnableConversionStreamableToSingleBatch =
 	DEFAULT_ENABLE_CONVERSION_STREAMABLE_SINGLE_BATCH;
 
+#define DEFAULT_ENABLE_PARALLEL_SINGLE_BATCH_AGGREGATION false
+bool EnableParallelSingleBatchAggregation =
+	DEFAULT_ENABLE_PARALLEL_SINGLE_BATCH_AGGREGATION;
+
+#define DEFAULT_ENABLE_MULTI_POINT_READ_PLAN false
+bool EnableMultiPointReadPlan = DEFAULT_ENABLE_MULTI_POINT_READ_PLAN;
+
 #define DEFAULT_ENABLE_FIND_PROJECTION_AFTER_OFFSET true
 bool EnableFindProjectionAfterOffset = DEFAULT_ENABLE_FIND_PROJECTION_AFTER_OFFSET;
 
@@ -230,6 +414,9 @@ bool SkipFailOnCollation = DEFAULT_SKIP_FAIL_ON_COLLATION;
 bool EnableLookupIdJoinOptimizationOnCollation =
 	DEFAULT_ENABLE_LOOKUP_ID_JOIN_OPTIMIZATION_ON_COLLATION;
 
+#define DEFAULT_ENABLE_COLLATION_SORT_KEY_ORDER_BY true
+bool EnableCollationSortKeyOrderBy = DEFAULT_ENABLE_COLLATION_SORT_KEY_ORDER_BY;
+
 
 /*
  * SECTION: DML Write Path feature flags
@@ -245,6 +432,9 @@ bool RumFailOnLostPath = DEFAULT_RUM_FAIL_ON_LOST_PATH;
 #define DEFAULT_RECREATE_RETRY_TABLE_ON_SHARDING false
 bool RecreateRetryTableOnSharding = DEFAULT_RECREATE_RETRY_TABLE_ON_SHARDING;
 
+#define DEFAULT_ENABLE_RETRY_TABLE_TRANSACTION_ID_INDEX false
+bool EnableRetryTableTransactionIdIndex = DEFAULT_ENABLE_RETRY_TABLE_TRANSACTION_ID_INDEX;
+
 #define DEFAULT_ENABLE_DATA_TABLES_WITHOUT_CREATION_TIME true
 bool EnableDataTableWithoutCreationTime =
 	DEFAULT_ENABLE_DATA_TABLES_WITHOUT_CREATION_TIME;
@@ -288,6 +478,36 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		NULL, &EnableVectorPreFilter, DEFAULT_ENABLE_VECTOR_PRE_FILTER,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableVectorAdaptivePreFilter", newGucPrefix),
+		gettext_noop(
+			"Enables choosing between exact and iterative vector search from the estimated selectivity of the pre-filter."),
+		NULL, &EnableVectorAdaptivePreFilter, DEFAULT_ENABLE_VECTOR_ADAPTIVE_PRE_FILTER,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableVectorSearchBatchedQueries", newGucPrefix),
+		gettext_noop(
+			"Enables passing a list of query vectors (vectors) to a cosmosSearch vector search."),
+		NULL, &EnableVectorSearchBatchedQueries,
+		DEFAULT_ENABLE_VECTOR_SEARCH_BATCHED_QUERIES,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableVectorExtractFastPath", newGucPrefix),
+		gettext_noop(
+			"Whether to build vectors directly from bson arrays when extracting vectors for indexing."),
+		NULL, &EnableVectorExtractFastPath, DEFAULT_ENABLE_VECTOR_EXTRACT_FAST_PATH,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableVectorBinaryVectorSubtype", newGucPrefix),
+		gettext_noop(
+			"Whether to index float32 and int8 bson binary vectors (subtype 9) in vector indexes."),
+		NULL, &EnableVectorBinaryVectorSubtype,
+		DEFAULT_ENABLE_VECTOR_BINARY_VECTOR_SUBTYPE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enableVectorPreFilterV2", prefix),
 		gettext_noop(
@@ -316,6 +536,14 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		NULL, &EnableVectorCompressionPQ, DEFAULT_ENABLE_VECTOR_COMPRESSION_PQ,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableVectorCompressionSingleRerankDistance", newGucPrefix),
+		gettext_noop(
+			"Enables computing the full vector distance once per candidate when reranking compressed vector index results"),
+		NULL, &EnableVectorCompressionSingleRerankDistance,
+		DEFAULT_ENABLE_VECTOR_COMPRESSION_SINGLE_RERANK_DISTANCE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enableVectorCalculateDefaultSearchParam", newGucPrefix),
 		gettext_noop(
@@ -332,6 +560,15 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		DEFAULT_ENABLE_NEW_OPERATOR_SELECTIVITY,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enablePathStatisticsSelectivity", newGucPrefix),
+		gettext_noop(
+			"Determines whether the selectivity of $eq, $in, $exists and $range uses the "
+			"per-path statistics gathered by ANALYZE on the documents."),
+		NULL, &EnablePathStatisticsSelectivity,
+		DEFAULT_ENABLE_PATH_STATISTICS_SELECTIVITY,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.disableDollarSupportFuncSelectivity", newGucPrefix),
 		gettext_noop(
@@ -369,6 +606,14 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		NULL, &RecreateRetryTableOnSharding, DEFAULT_RECREATE_RETRY_TABLE_ON_SHARDING,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableRetryTableTransactionIdIndex", newGucPrefix),
+		gettext_noop(
+			"Whether or not new retry tables index the transaction id instead of the object id."),
+		NULL, &EnableRetryTableTransactionIdIndex,
+		DEFAULT_ENABLE_RETRY_TABLE_TRANSACTION_ID_INDEX,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.skipFailOnCollation", newGucPrefix),
 		gettext_noop(
@@ -384,6 +629,14 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		DEFAULT_ENABLE_LOOKUP_ID_JOIN_OPTIMIZATION_ON_COLLATION,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCollationSortKeyOrderBy", newGucPrefix),
+		gettext_noop(
+			"Whether or not collation aware sorts on strings compare precomputed ICU sort keys instead of comparing the strings with the collator."),
+		NULL, &EnableCollationSortKeyOrderBy,
+		DEFAULT_ENABLE_COLLATION_SORT_KEY_ORDER_BY,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enableNowSystemVariable", newGucPrefix),
 		gettext_noop(
@@ -440,6 +693,38 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		DEFAULT_ENABLE_DATA_TABLES_WITHOUT_CREATION_TIME,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableQueryDocumentDetoastCache", newGucPrefix),
+		gettext_noop(
+			"Whether to share detoasted documents across the query operators evaluated on the same row."),
+		NULL, &EnableQueryDocumentDetoastCache,
+		DEFAULT_ENABLE_QUERY_DOCUMENT_DETOAST_CACHE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableDirectShardMultiInsert", newGucPrefix),
+		gettext_noop(
+			"Whether batched inserts into a local shard write the rows directly into the table instead of through an insert plan."),
+		NULL, &EnableDirectShardMultiInsert,
+		DEFAULT_ENABLE_DIRECT_SHARD_MULTI_INSERT,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBatchedDeleteMany", newGucPrefix),
+		gettext_noop(
+			"Whether or not to run the deleteMany operations of unordered deletes as a single delete on the union of their filters."),
+		NULL, &EnableBatchedDeleteMany,
+		DEFAULT_ENABLE_BATCHED_DELETE_MANY,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableInPlaceFixedSizeUpdates", newGucPrefix),
+		gettext_noop(
+			"Whether or not to apply updates that only change fixed size values by patching a copy of the document."),
+		NULL, &EnableInPlaceFixedSizeUpdates,
+		DEFAULT_ENABLE_IN_PLACE_FIXED_SIZE_UPDATES,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.useFileBasedPersistedCursors", newGucPrefix),
 		gettext_noop(
@@ -448,6 +733,22 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		DEFAULT_USE_FILE_BASED_PERSISTED_CURSORS,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCursorFileCompression", newGucPrefix),
+		gettext_noop(
+			"Whether or not to compress the blocks of file based persisted cursors."),
+		NULL, &EnableCursorFileCompression,
+		DEFAULT_ENABLE_CURSOR_FILE_COMPRESSION,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCursorFileMemoryMap", newGucPrefix),
+		gettext_noop(
+			"Whether or not to read file based persisted cursors through a memory mapping."),
+		NULL, &EnableCursorFileMemoryMap,
+		DEFAULT_ENABLE_CURSOR_FILE_MEMORY_MAP,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enableUsersInfoPrivileges", newGucPrefix),
 		gettext_noop(
@@ -488,6 +789,69 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		DEFAULT_LOOKUP_ENABLE_INNER_JOIN,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableLookupHashJoin", newGucPrefix),
+		gettext_noop(
+			"Whether or not to plan localField/foreignField $lookup as a join on hashed join keys "
+			"so that the planner can pick a hash join."),
+		NULL, &EnableLookupHashJoin,
+		DEFAULT_ENABLE_LOOKUP_HASH_JOIN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableNativeGraphLookup", newGucPrefix),
+		gettext_noop(
+			"Whether or not to run $graphLookup as a breadth first traversal with one "
+			"batched probe of the foreign collection per level instead of a recursive CTE."),
+		NULL, &EnableNativeGraphLookup,
+		DEFAULT_ENABLE_NATIVE_GRAPH_LOOKUP,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableColocatedLookupPushdown", newGucPrefix),
+		gettext_noop(
+			"Whether or not $lookup between collections sharded on the join field also "
+			"joins on the shard key value so that colocated joins run on the shards."),
+		NULL, &EnableColocatedLookupPushdown,
+		DEFAULT_ENABLE_COLOCATED_LOOKUP_PUSHDOWN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableSortedMergeSource", newGucPrefix),
+		gettext_noop(
+			"Whether or not to sort the source of $merge by the 'on' fields so that the "
+			"target collection's unique index is probed and updated in key order."),
+		NULL, &EnableSortedMergeSource,
+		DEFAULT_ENABLE_SORTED_MERGE_SOURCE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableStagedOutLoad", newGucPrefix),
+		gettext_noop(
+			"Whether or not $out loads its output into an unlogged staging collection, "
+			"builds the indexes after the load and then swaps it in for the target."),
+		NULL, &EnableStagedOutLoad,
+		DEFAULT_ENABLE_STAGED_OUT_LOAD,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableInsertBatchResumeAfterFailure", newGucPrefix),
+		gettext_noop(
+			"Whether or not a multi-document insert goes back to inserting in batches "
+			"once the documents of a failed batch have been retried one by one."),
+		NULL, &EnableInsertBatchResumeAfterFailure,
+		DEFAULT_ENABLE_INSERT_BATCH_RESUME_AFTER_FAILURE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableShardKeyInArrayFilter", newGucPrefix),
+		gettext_noop(
+			"Whether or not $in filters on the shard key are pruned through a single "
+			"shard_key_value = ANY(...) filter over the distinct shard key hashes."),
+		NULL, &EnableShardKeyInArrayFilter,
+		DEFAULT_ENABLE_SHARD_KEY_IN_ARRAY_FILTER,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.forceBitmapScanForLookup", newGucPrefix),
 		gettext_noop(
@@ -532,6 +896,22 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		NULL, &EnableIndexOrderbyPushdown, DEFAULT_ENABLE_INDEX_ORDERBY_PUSHDOWN,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableRumRoaringBitmapIntersection", newGucPrefix),
+		gettext_noop(
+			"Whether bitmap scans on RUM indexes with multiple scan keys intersect per key roaring bitmaps."),
+		NULL, &EnableRumRoaringBitmapIntersection,
+		DEFAULT_ENABLE_RUM_ROARING_BITMAP_INTERSECTION,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableWildcardIndexPathFilter", newGucPrefix),
+		gettext_noop(
+			"Whether wildcard RUM indexes keep a filter of document paths that lets scans on paths absent from the index return no results."),
+		NULL, &EnableWildcardIndexPathFilter,
+		DEFAULT_ENABLE_WILDCARD_INDEX_PATH_FILTER,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enableIndexOrderbyReverse", newGucPrefix),
 		gettext_noop("Whether or not to enable order by reverse index pushdown"),
@@ -547,6 +927,22 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		DEFAULT_ENABLE_CONVERSION_STREAMABLE_SINGLE_BATCH,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableParallelSingleBatchAggregation", newGucPrefix),
+		gettext_noop(
+			"Whether to drain pipelines producing a single document (e.g. $facet) in a single batch planned with parallel workers."),
+		NULL, &EnableParallelSingleBatchAggregation,
+		DEFAULT_ENABLE_PARALLEL_SINGLE_BATCH_AGGREGATION,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableMultiPointReadPlan", newGucPrefix),
+		gettext_noop(
+			"Whether to read $in queries on _id as point reads on the primary key index in a single batch."),
+		NULL, &EnableMultiPointReadPlan,
+		DEFAULT_ENABLE_MULTI_POINT_READ_PLAN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enableFindProjectionAfterOffset", newGucPrefix),
 		gettext_noop(
@@ -584,6 +980,14 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		NULL, &EnableIndexOnlyScan, DEFAULT_ENABLE_INDEX_ONLY_SCAN,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCoveredProjectionIndexOnlyScan", newGucPrefix),
+		gettext_noop(
+			"Whether to allow index only scans on composite indexes for find queries whose projection only includes index paths."),
+		NULL, &EnableCoveredProjectionIndexOnlyScan,
+		DEFAULT_ENABLE_COVERED_PROJECTION_INDEX_ONLY_SCAN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.usePgStatsLiveTuplesForCount", newGucPrefix),
 		gettext_noop(
@@ -714,6 +1118,284 @@ InitializeFeatureFlagConfigurations(const char *prefix, const char *newGucPrefix
 		NULL, &EnableNewCountAggregates, DEFAULT_ENABLE_NEW_COUNT_AGGREGATES,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enableSharedQueryPlanHints", newGucPrefix),
+		gettext_noop(
+			"Whether to share learnt generic plan choices of CRUD query plans across backends."),
+		NULL, &EnableSharedQueryPlanHints, DEFAULT_ENABLE_SHARED_QUERY_PLAN_HINTS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableGeonearOrderedIndexScan", newGucPrefix),
+		gettext_noop(
+			"Whether to prefer the distance ordered geo index scan for $geoNear queries when the geo index is forced."),
+		NULL, &EnableGeonearOrderedIndexScan, DEFAULT_ENABLE_GEONEAR_ORDERED_INDEX_SCAN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableGeospatialBulkPointParsing", newGucPrefix),
+		gettext_noop(
+			"Whether to presize buffers and read double coordinates directly when parsing GeoJSON rings and lines."),
+		NULL, &EnableGeospatialBulkPointParsing,
+		DEFAULT_ENABLE_GEOSPATIAL_BULK_POINT_PARSING,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableTextVectorReuseForScore", newGucPrefix),
+		gettext_noop(
+			"Whether to reuse the text vector of a document across the $text runtime match and textScore evaluations."),
+		NULL, &EnableTextVectorReuseForScore,
+		DEFAULT_ENABLE_TEXT_VECTOR_REUSE_FOR_SCORE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableJsonSchemaCompiledValidation", newGucPrefix),
+		gettext_noop(
+			"Whether to build field lookups in the $jsonSchema tree and hash documents for uniqueItems."),
+		NULL, &EnableJsonSchemaCompiledValidation,
+		DEFAULT_ENABLE_JSON_SCHEMA_COMPILED_VALIDATION,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableAggregationStageCounters", newGucPrefix),
+		gettext_noop(
+			"Whether to count the time and memory spent building each aggregation stage."),
+		NULL, &EnableAggregationStageCounters,
+		DEFAULT_ENABLE_AGGREGATION_STAGE_COUNTERS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enablePercentileSketches", newGucPrefix),
+		gettext_noop(
+			"Whether to support $percentileSketch and merging sketches in $percentile and $median."),
+		NULL, &EnablePercentileSketches,
+		DEFAULT_ENABLE_PERCENTILE_SKETCHES,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCombinableGroupAccumulators", newGucPrefix),
+		gettext_noop(
+			"Whether to use the combinable versions of $push, $addToSet and $mergeObjects in $group so they support partial aggregation."),
+		NULL, &EnableCombinableGroupAccumulators,
+		DEFAULT_ENABLE_COMBINABLE_GROUP_ACCUMULATORS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableStreamingUnwind", newGucPrefix),
+		gettext_noop(
+			"Whether $unwind returns the unwound documents one at a time instead of materializing them in a tuplestore."),
+		NULL, &EnableStreamingUnwind,
+		DEFAULT_ENABLE_STREAMING_UNWIND,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableQueryShapeHash", newGucPrefix),
+		gettext_noop(
+			"Whether to set the query shape hash of find and aggregate requests as the queryId of their queries."),
+		NULL, &EnableQueryShapeHash,
+		DEFAULT_ENABLE_QUERY_SHAPE_HASH,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableStatsOnlyCollectionCount", newGucPrefix),
+		gettext_noop(
+			"Whether unfiltered counts of small collections are taken from the live tuple statistics instead of counting the documents."),
+		NULL, &EnableStatsOnlyCollectionCount,
+		DEFAULT_ENABLE_STATS_ONLY_COLLECTION_COUNT,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableDistinctIndexOnlyScan", newGucPrefix),
+		gettext_noop(
+			"Whether to allow index only scans on composite indexes for distinct queries on a top level index path."),
+		NULL, &EnableDistinctIndexOnlyScan,
+		DEFAULT_ENABLE_DISTINCT_INDEX_ONLY_SCAN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableGroupIndexOnlyScan", newGucPrefix),
+		gettext_noop(
+			"Whether to allow index only scans on composite indexes for group queries whose keys and accumulators only reference top level index paths."),
+		NULL, &EnableGroupIndexOnlyScan,
+		DEFAULT_ENABLE_GROUP_INDEX_ONLY_SCAN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableApproximateBucketAuto", newGucPrefix),
+		gettext_noop(
+			"Whether $bucketAuto computes the bucket boundaries from approximate quantiles of numeric values instead of sorting the documents."),
+		NULL, &EnableApproximateBucketAuto,
+		DEFAULT_ENABLE_APPROXIMATE_BUCKET_AUTO,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableInverseMatchEqualityPrefilter", newGucPrefix),
+		gettext_noop(
+			"Whether $inverseMatch skips compiling stored queries whose top level equality predicates can't match the input."),
+		NULL, &EnableInverseMatchEqualityPrefilter,
+		DEFAULT_ENABLE_INVERSE_MATCH_EQUALITY_PREFILTER,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableClusteredCollections", newGucPrefix),
+		gettext_noop(
+			"Whether collections can be created with a clusteredIndex on _id that compact keeps the documents ordered by."),
+		NULL, &EnableClusteredCollections,
+		DEFAULT_ENABLE_CLUSTERED_COLLECTIONS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableQueryDocumentSliceDetoast", newGucPrefix),
+		gettext_noop(
+			"Whether query operators on large toasted documents only detoast the prefix of the document that holds the queried field."),
+		NULL, &EnableQueryDocumentSliceDetoast,
+		DEFAULT_ENABLE_QUERY_DOCUMENT_SLICE_DETOAST,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableDeferredCollectionDrop", newGucPrefix),
+		gettext_noop(
+			"Whether drop removes the collection metadata and leaves dropping its tables to the drop_orphaned_collection_tables_background job."),
+		NULL, &EnableDeferredCollectionDrop,
+		DEFAULT_ENABLE_DEFERRED_COLLECTION_DROP,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableChangeStreamFilterPushdown", newGucPrefix),
+		gettext_noop(
+			"Determines whether $match stages directly following $changeStream are handed to the change stream provider to filter events before they are serialized."),
+		NULL, &EnableChangeStreamFilterPushdown,
+		DEFAULT_ENABLE_CHANGE_STREAM_FILTER_PUSHDOWN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCommandActivitySlots", newGucPrefix),
+		gettext_noop(
+			"Whether backends publish the commands they run to shared memory slots that currentOp reads instead of parsing the query text."),
+		NULL, &EnableCommandActivitySlots,
+		DEFAULT_ENABLE_COMMAND_ACTIVITY_SLOTS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableRolePrivilegeCache", newGucPrefix),
+		gettext_noop(
+			"Whether the privileges of the built-in roles and the roles of the users are cached per backend for connectionStatus, usersInfo and rolesInfo."),
+		NULL, &EnableRolePrivilegeCache,
+		DEFAULT_ENABLE_ROLE_PRIVILEGE_CACHE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBatchedUpsertProbe", newGucPrefix),
+		gettext_noop(
+			"Whether the _id only upserts of a batch update are checked against the _id index together and skip the lookup when no document matches."),
+		NULL, &EnableBatchedUpsertProbe,
+		DEFAULT_ENABLE_BATCHED_UPSERT_PROBE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableFindAndModifySkipLocked", newGucPrefix),
+		gettext_noop(
+			"Whether findAndModify updates without upsert skip the documents locked by concurrent writes when their query does not filter on _id."),
+		NULL, &EnableFindAndModifySkipLocked,
+		DEFAULT_ENABLE_FIND_AND_MODIFY_SKIP_LOCKED,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCompiledQueryMatch", newGucPrefix),
+		gettext_noop(
+			"Whether the bson_query_match fallback compiles its filter once per call site instead of rebuilding and constant folding the filter for every document."),
+		NULL, &EnableCompiledQueryMatch,
+		DEFAULT_ENABLE_COMPILED_QUERY_MATCH,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableTextIndexSkipRuntimeRecheck", newGucPrefix),
+		gettext_noop(
+			"Whether $text queries served by a text index bitmap scan skip re-tokenizing the matched documents, relying on the index to match terms and phrases through their stored positions."),
+		NULL, &EnableTextIndexSkipRuntimeRecheck,
+		DEFAULT_ENABLE_TEXT_INDEX_SKIP_RUNTIME_RECHECK,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableIndexStatsAccessDetails", newGucPrefix),
+		gettext_noop(
+			"Whether $indexStats also reports the index tuples returned by the scans of each index and when it was last scanned."),
+		NULL, &EnableIndexStatsAccessDetails,
+		DEFAULT_ENABLE_INDEX_STATS_ACCESS_DETAILS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableCachedComparisonFilters", newGucPrefix),
+		gettext_noop(
+			"Whether or not to parse the constant filters of the comparison query operators once per call site."),
+		NULL, &EnableCachedComparisonFilters,
+		DEFAULT_ENABLE_CACHED_COMPARISON_FILTERS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableDollarMapDoubleKernels", newGucPrefix),
+		gettext_noop(
+			"Whether or not to compute $map over double arrays directly when its expression is a supported numeric operator on the element."),
+		NULL, &EnableDollarMapDoubleKernels,
+		DEFAULT_ENABLE_DOLLAR_MAP_DOUBLE_KERNELS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableLookupFilterDeduplication", newGucPrefix),
+		gettext_noop(
+			"Whether or not to remove the duplicate local values from the index condition of a $lookup."),
+		NULL, &EnableLookupFilterDeduplication,
+		DEFAULT_ENABLE_LOOKUP_FILTER_DEDUPLICATION,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableParallelUnionWith", newGucPrefix),
+		gettext_noop(
+			"Whether pipelines with $unionWith that run to completion can be planned with parallel workers, so their branches run as a parallel append."),
+		NULL, &EnableParallelUnionWith,
+		DEFAULT_ENABLE_PARALLEL_UNION_WITH,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableAsyncCommitWriteConcern", newGucPrefix),
+		gettext_noop(
+			"Whether write commands with an unacknowledged (w: 0) or unjournaled (j: false) writeConcern commit without waiting for the WAL flush."),
+		NULL, &EnableAsyncCommitWriteConcern,
+		DEFAULT_ENABLE_ASYNC_COMMIT_WRITE_CONCERN,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableImpliedPartialIndexMatch", newGucPrefix),
+		gettext_noop(
+			"Whether partial indexes can be used by queries whose range filters imply the partialFilterExpression of the index."),
+		NULL, &EnableImpliedPartialIndexMatch,
+		DEFAULT_ENABLE_IMPLIED_PARTIAL_INDEX_MATCH,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableRankFusionStage", newGucPrefix),
+		gettext_noop(
+			"Enables the $rankFusion stage fusing ranked text and vector search pipelines in a single query."),
+		NULL, &EnableRankFusionStage,
+		DEFAULT_ENABLE_RANK_FUSION_STAGE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableSortedFindStreamingCursor", newGucPrefix),
+		gettext_noop(
+			"Enables streaming sorted finds by resuming each getMore from the sort key of the next document to return."),
+		NULL, &EnableSortedFindStreamingCursor,
+		DEFAULT_ENABLE_SORTED_FIND_STREAMING_CURSOR,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableElemMatchNestedArrayTerm", newGucPrefix),
+		gettext_noop(
+			"Whether new indexes mark documents with nested arrays so that index matches of $elemMatch can skip the recheck."),
+		NULL, &EnableElemMatchNestedArrayTerm,
+		DEFAULT_ENABLE_ELEMMATCH_NESTED_ARRAY_TERM,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.useNewUniqueHashEqualityFunction", newGucPrefix),
 		gettext_noop(
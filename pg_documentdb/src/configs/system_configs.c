@@ -15,6 +15,7 @@
 #include "configs/config_initialization.h"
 #include "vector/vector_configs.h"
 #include "index_am/documentdb_rum.h"
+#include "metadata/collection.h"
 
 /*
  * Externally defined GUC constants
@@ -42,6 +43,30 @@ int ShardingMaxChunks = DEFAULT_SHARDING_MAX_CHUNKS;
 #define DEFAULT_QUERY_PLAN_CACHE_SIZE_LIMIT 100
 int QueryPlanCacheSizeLimit = DEFAULT_QUERY_PLAN_CACHE_SIZE_LIMIT;
 
+#define DEFAULT_SHARED_QUERY_PLAN_HINT_CACHE_SIZE 4096
+int SharedQueryPlanHintCacheSize = DEFAULT_SHARED_QUERY_PLAN_HINT_CACHE_SIZE;
+
+#define DEFAULT_STATS_CACHE_SIZE 256
+int StatsCacheSize = DEFAULT_STATS_CACHE_SIZE;
+
+#define DEFAULT_STATS_CACHE_MAX_STALENESS_MS 0
+int StatsCacheMaxStalenessMs = DEFAULT_STATS_CACHE_MAX_STALENESS_MS;
+
+#define DEFAULT_SHARED_COLLECTION_CACHE_SIZE 0
+int SharedCollectionCacheSize = DEFAULT_SHARED_COLLECTION_CACHE_SIZE;
+
+#define DEFAULT_SHARED_METADATA_CACHE_SIZE 0
+int SharedMetadataCacheSize = DEFAULT_SHARED_METADATA_CACHE_SIZE;
+
+#define DEFAULT_SAMPLE_OVERSAMPLING_FACTOR 1
+int SampleOversamplingFactor = DEFAULT_SAMPLE_OVERSAMPLING_FACTOR;
+
+#define DEFAULT_REGEX_COMPILE_CACHE_SIZE 64
+int RegexCompileCacheSize = DEFAULT_REGEX_COMPILE_CACHE_SIZE;
+
+#define DEFAULT_GEOSPATIAL_SHAPE_CACHE_SIZE 0
+int GeospatialShapeCacheSize = DEFAULT_GEOSPATIAL_SHAPE_CACHE_SIZE;
+
 /* TODO: Raise this back to 100,000 once we can optimize sub-transaction */
 /* handling with multi-node clusters. */
 #define DEFAULT_MAX_WRITE_BATCH_SIZE 25000
@@ -71,6 +96,9 @@ int32 MaxIndexesPerCollection = DEFAULT_MAX_INDEXES_PER_COLLECTION;
 #define DEFAULT_MAX_WILDCARD_INDEX_KEY_SIZE 200
 int MaxWildcardIndexKeySize = DEFAULT_MAX_WILDCARD_INDEX_KEY_SIZE;
 
+#define DEFAULT_MAX_WILDCARD_INDEX_TERMS_PER_DOCUMENT 0
+int MaxWildcardIndexTermsPerDocument = DEFAULT_MAX_WILDCARD_INDEX_TERMS_PER_DOCUMENT;
+
 /* default value for max validator size */
 #define DEFAULT_MAX_SCHEMA_VALIDATOR_SIZE 10 * 1024
 int MaxSchemaValidatorSize = DEFAULT_MAX_SCHEMA_VALIDATOR_SIZE;
@@ -98,6 +126,10 @@ bool ForceRUMIndexScanToBitmapHeapScan = DEFAULT_FORCE_RUM_INDEXSCAN_TO_BITMAPHE
 #define DEFAULT_FORCE_USE_INDEX_IF_AVAILABLE true
 bool ForceUseIndexIfAvailable = DEFAULT_FORCE_USE_INDEX_IF_AVAILABLE;
 
+#define DEFAULT_COMPOSITE_INDEX_SKIP_SCAN_MAX_DISTINCT_VALUES 0
+int CompositeIndexSkipScanMaxDistinctValues =
+	DEFAULT_COMPOSITE_INDEX_SKIP_SCAN_MAX_DISTINCT_VALUES;
+
 #define DEFAULT_THROW_DEADLOCK_ON_CRUD false
 bool ThrowDeadlockOnCrud = DEFAULT_THROW_DEADLOCK_ON_CRUD;
 
@@ -129,6 +161,12 @@ bool EnableUserCrud = DEFAULT_ENABLE_USER_CRUD;
 #define DEFAULT_VECTOR_ITERATIVE_SCAN_MODE VectorIterativeScan_RELAXED_ORDER
 int VectorPreFilterIterativeScanMode = DEFAULT_VECTOR_ITERATIVE_SCAN_MODE;
 
+#define DEFAULT_COLLECTION_DOCUMENT_COMPRESSION DocumentCompression_Default
+int CollectionDocumentCompression = DEFAULT_COLLECTION_DOCUMENT_COMPRESSION;
+
+#define DEFAULT_VECTOR_PRE_FILTER_EXACT_SEARCH_MAX_ROWS 10000
+int VectorPreFilterExactSearchMaxRows = DEFAULT_VECTOR_PRE_FILTER_EXACT_SEARCH_MAX_ROWS;
+
 #define DEFAULT_ENABLE_GEONEAR_FORCE_INDEX_PUSHDOWN true
 bool EnableGeonearForceIndexPushdown = DEFAULT_ENABLE_GEONEAR_FORCE_INDEX_PUSHDOWN;
 
@@ -151,9 +189,27 @@ int DefaultCursorExpiryTimeLimitSeconds = DEFAULT_CURSOR_EXPIRY_TIME_LIMIT_SECON
 int MaxAllowedCursorIntermediateFileSizeMB =
 	DEFAULT_MAX_CURSOR_FILE_INTERMEDIATE_FILE_SIZE_MB;
 
+#define DEFAULT_CURSOR_FILE_BLOCK_SIZE_KB 64
+int CursorFileBlockSizeKB = DEFAULT_CURSOR_FILE_BLOCK_SIZE_KB;
+
 #define DEFAULT_MAX_CURSOR_FILE_COUNT 5000
 int MaxCursorFileCount = DEFAULT_MAX_CURSOR_FILE_COUNT;
 
+#define DEFAULT_MAX_TAILABLE_CURSOR_AWAIT_TIME_MS 0
+int MaxTailableCursorAwaitTimeMs = DEFAULT_MAX_TAILABLE_CURSOR_AWAIT_TIME_MS;
+
+#define DEFAULT_TAILABLE_CURSOR_AWAIT_POLL_INTERVAL_MS 100
+int TailableCursorAwaitPollIntervalMs = DEFAULT_TAILABLE_CURSOR_AWAIT_POLL_INTERVAL_MS;
+
+#define DEFAULT_SLOW_COMMAND_LOG_THRESHOLD_MS -1
+int SlowCommandLogThresholdMs = DEFAULT_SLOW_COMMAND_LOG_THRESHOLD_MS;
+
+#define DEFAULT_SLOW_COMMAND_PROFILE_THRESHOLD_MS -1
+int SlowCommandProfileThresholdMs = DEFAULT_SLOW_COMMAND_PROFILE_THRESHOLD_MS;
+
+#define DEFAULT_SLOW_COMMAND_PROFILE_SAMPLE_RATE 1.0
+double SlowCommandProfileSampleRate = DEFAULT_SLOW_COMMAND_PROFILE_SAMPLE_RATE;
+
 /* Starting pg18 use documentdb_extended_rum for the rum library */
 #if PG_VERSION_NUM >= 180000
 #define DEFAULT_RUM_LIBRARY_LOAD_OPTION RumLibraryLoadOption_RequireDocumentDBRum
@@ -166,6 +222,16 @@ RumLibraryLoadOptions DocumentDBRumLibraryLoadOption = DEFAULT_RUM_LIBRARY_LOAD_
 #define DEFAULT_ENABLE_STATEMENT_TIMEOUT true
 bool EnableBackendStatementTimeout = DEFAULT_ENABLE_STATEMENT_TIMEOUT;
 
+static const struct config_enum_entry DOCUMENT_COMPRESSION_OPTIONS[] =
+{
+	{ "default", DocumentCompression_Default, false },
+	{ "pglz", DocumentCompression_Pglz, false },
+#ifdef USE_LZ4
+	{ "lz4", DocumentCompression_Lz4, false },
+#endif
+	{ NULL, 0, false }
+};
+
 static struct config_enum_entry rum_load_options[4] = {
 	{ "none", RumLibraryLoadOption_None, false },
 	{ "prefer_documentdb_extended_rum", RumLibraryLoadOption_PreferDocumentDBRum, false },
@@ -202,6 +268,94 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 		0,
 		NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.sharedQueryPlanHintCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of query plan hints shared across backends. Set 0 to disable."),
+		NULL,
+		&SharedQueryPlanHintCacheSize,
+		DEFAULT_SHARED_QUERY_PLAN_HINT_CACHE_SIZE, 0, 1024 * 1024,
+		PGC_POSTMASTER,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.statsCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of collStats/dbStats responses cached across backends. Set 0 to disable."),
+		NULL,
+		&StatsCacheSize,
+		DEFAULT_STATS_CACHE_SIZE, 0, 64 * 1024,
+		PGC_POSTMASTER,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.statsCacheMaxStalenessMs", newGucPrefix),
+		gettext_noop(
+			"The maximum age in milliseconds of a cached collStats/dbStats response that can be returned. Set 0 to always compute the stats."),
+		NULL,
+		&StatsCacheMaxStalenessMs,
+		DEFAULT_STATS_CACHE_MAX_STALENESS_MS, 0, INT_MAX,
+		PGC_USERSET,
+		GUC_UNIT_MS,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.sharedCollectionCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of collection catalog entries cached across backends. Set 0 to disable."),
+		NULL,
+		&SharedCollectionCacheSize,
+		DEFAULT_SHARED_COLLECTION_CACHE_SIZE, 0, 1024 * 1024,
+		PGC_POSTMASTER,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.sharedMetadataCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of databases whose resolved extension function, operator and type OIDs are cached across backends. Set 0 to disable."),
+		NULL,
+		&SharedMetadataCacheSize,
+		DEFAULT_SHARED_METADATA_CACHE_SIZE, 0, 1024,
+		PGC_POSTMASTER,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.sampleOversamplingFactor", newGucPrefix),
+		gettext_noop(
+			"Set how many times more rows than requested $sample reads with block sampling before picking the result at random. Larger values spread the sample over more blocks."),
+		NULL,
+		&SampleOversamplingFactor,
+		DEFAULT_SAMPLE_OVERSAMPLING_FACTOR, 1, 1000,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.regexCompileCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of compiled regular expressions cached per backend for aggregation operators. Set 0 to disable."),
+		NULL,
+		&RegexCompileCacheSize,
+		DEFAULT_REGEX_COMPILE_CACHE_SIZE, 0, 1024 * 1024,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.geospatialShapeCacheSize", newGucPrefix),
+		gettext_noop(
+			"Set the number of $geoWithin and $geoIntersects query shapes cached per backend. Set 0 to disable."),
+		NULL,
+		&GeospatialShapeCacheSize,
+		DEFAULT_GEOSPATIAL_SHAPE_CACHE_SIZE, 0, 64 * 1024,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.maxWriteBatchSize", prefix),
 		gettext_noop("The max number of write operations permitted in a write batch."),
@@ -230,6 +384,14 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 		NULL, &ForceUseIndexIfAvailable, DEFAULT_FORCE_USE_INDEX_IF_AVAILABLE,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.compositeIndexSkipScanMaxDistinctValues", prefix),
+		gettext_noop(
+			"The max number of distinct values of the leading path of a composite index for which a query that does not filter on it can skip scan the index. Set 0 to disable."),
+		NULL, &CompositeIndexSkipScanMaxDistinctValues,
+		DEFAULT_COMPOSITE_INDEX_SKIP_SCAN_MAX_DISTINCT_VALUES, 0, INT_MAX,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.coll_stats_count_policy_threshold", prefix),
 		gettext_noop("Set the collStats 'count policy' change threshold"),
@@ -288,6 +450,16 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 		0,
 		NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.maxWildcardIndexTermsPerDocument", newGucPrefix),
+		gettext_noop(
+			"The max index keys a document can generate for wildcard indexes created with this setting, 0 for no limit."),
+		NULL, &MaxWildcardIndexTermsPerDocument,
+		DEFAULT_MAX_WILDCARD_INDEX_TERMS_PER_DOCUMENT, 0, INT32_MAX,
+		PGC_USERSET,
+		0,
+		NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.maxSchemaValidatorSize", prefix),
 		gettext_noop(
@@ -416,6 +588,15 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 		VECTOR_ITERATIVE_SCAN_OPTIONS,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.vectorPreFilterExactSearchMaxRows", newGucPrefix),
+		gettext_noop(
+			"The estimated number of documents matching a vector search filter up to which "
+			"an exact search is used when adaptive pre-filtering is enabled."),
+		NULL, &VectorPreFilterExactSearchMaxRows,
+		DEFAULT_VECTOR_PRE_FILTER_EXACT_SEARCH_MAX_ROWS, 0, INT_MAX,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.defaultCursorFirstPageBatchSize", newGucPrefix),
 		gettext_noop("The default batch size for the first page of a cursor."),
@@ -446,6 +627,13 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 		NULL, &MaxAllowedCursorIntermediateFileSizeMB,
 		DEFAULT_MAX_CURSOR_FILE_INTERMEDIATE_FILE_SIZE_MB,
 		1, INT_MAX, PGC_USERSET, 0, NULL, NULL, NULL);
+	DefineCustomIntVariable(
+		psprintf("%s.cursorFileBlockSizeKB", newGucPrefix),
+		gettext_noop(
+			"Size of the blocks documents are grouped into in cursor files."),
+		NULL, &CursorFileBlockSizeKB,
+		DEFAULT_CURSOR_FILE_BLOCK_SIZE_KB, 8, 16 * 1024,
+		PGC_USERSET, 0, NULL, NULL, NULL);
 	DefineCustomIntVariable(
 		psprintf("%s.maxCursorFileCount", newGucPrefix),
 		gettext_noop(
@@ -454,6 +642,49 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 		DEFAULT_MAX_CURSOR_FILE_COUNT, 0, INT_MAX,
 		PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.maxTailableCursorAwaitTimeMS", newGucPrefix),
+		gettext_noop(
+			"Upper bound on the maxAwaitTimeMS a getMore on a tailable cursor waits for new "
+			"results before returning an empty batch. set to 0 to return empty batches right away."),
+		NULL, &MaxTailableCursorAwaitTimeMs,
+		DEFAULT_MAX_TAILABLE_CURSOR_AWAIT_TIME_MS, 0, INT_MAX,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.tailableCursorAwaitPollIntervalMS", newGucPrefix),
+		gettext_noop(
+			"Interval at which a getMore waiting on a tailable cursor checks for new results."),
+		NULL, &TailableCursorAwaitPollIntervalMs,
+		DEFAULT_TAILABLE_CURSOR_AWAIT_POLL_INTERVAL_MS, 1, 60000,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.slowCommandLogThresholdMS", newGucPrefix),
+		gettext_noop(
+			"Commands running for at least this long are logged with the documents and index keys "
+			"they examined. set to -1 to disable logging slow commands."),
+		NULL, &SlowCommandLogThresholdMs,
+		DEFAULT_SLOW_COMMAND_LOG_THRESHOLD_MS, -1, INT_MAX,
+		PGC_USERSET, GUC_UNIT_MS, NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		psprintf("%s.slowCommandProfileThresholdMS", newGucPrefix),
+		gettext_noop(
+			"Sampled commands running for at least this long are recorded in the slow command "
+			"profile of their database. set to -1 to disable the slow command profile."),
+		NULL, &SlowCommandProfileThresholdMs,
+		DEFAULT_SLOW_COMMAND_PROFILE_THRESHOLD_MS, -1, INT_MAX,
+		PGC_USERSET, GUC_UNIT_MS, NULL, NULL, NULL);
+
+	DefineCustomRealVariable(
+		psprintf("%s.slowCommandProfileSampleRate", newGucPrefix),
+		gettext_noop(
+			"The fraction of commands sampled for the slow command profile."),
+		NULL, &SlowCommandProfileSampleRate,
+		DEFAULT_SLOW_COMMAND_PROFILE_SAMPLE_RATE, 0.0, 1.0,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
 	DefineCustomEnumVariable(
 		psprintf("%s.rum_library_load_option", newGucPrefix),
 		gettext_noop("Specifies the RUM library load option for DocumentDB."),
@@ -468,4 +699,13 @@ InitializeSystemConfigurations(const char *prefix, const char *newGucPrefix)
 			"Whether to enable per statement backend timeout override in the backend."),
 		NULL, &EnableBackendStatementTimeout, DEFAULT_ENABLE_STATEMENT_TIMEOUT,
 		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomEnumVariable(
+		psprintf("%s.collectionDocumentCompression", newGucPrefix),
+		gettext_noop(
+			"The TOAST compression method of the document column of collections created "
+			"by the session. 'default' uses the server's default_toast_compression."),
+		NULL, &CollectionDocumentCompression, DEFAULT_COLLECTION_DOCUMENT_COMPRESSION,
+		DOCUMENT_COMPRESSION_OPTIONS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
 }
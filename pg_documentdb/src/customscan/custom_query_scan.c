@@ -24,6 +24,7 @@
 #include <miscadmin.h>
 #include <optimizer/paths.h>
 #include <access/ginblock.h>
+#include <catalog/pg_type.h>
 
 #if PG_VERSION_NUM >= 180000
 #include <commands/explain_format.h>
@@ -44,6 +45,8 @@
 #include "customscan/bson_custom_scan_private.h"
 
 
+extern bool EnableTextIndexSkipRuntimeRecheck;
+
 /* --------------------------------------------------------- */
 /* Data-types */
 /* --------------------------------------------------------- */
@@ -131,6 +134,10 @@ static TupleTableSlot * ExtensionQueryScanNext(CustomScanState *node);
 static bool ExtensionQueryScanNextRecheck(ScanState *state, TupleTableSlot *slot);
 
 
+static void SkipTextRuntimeRecheckForBitmapScan(Plan *nestedPlan);
+static bool BitmapPlanHasTextIndexQual(Plan *bitmapPlan);
+static bool IsTextIndexQual(Node *qual);
+
 static List * AddCustomPathForVectorCore(PlannerInfo *info, List *pathList,
 										 RelOptInfo *rel,
 										 InputQueryState *queryState, bool
@@ -296,6 +303,112 @@ AddCustomPathCore(List *pathList, InputQueryState *queryState)
 }
 
 
+/*
+ * The $text filter is kept as a bson_text_meta_qual that re-tokenizes each
+ * document, since the path that wins is not known when the restriction is
+ * rewritten. When the winner is a bitmap scan of the text index, the index
+ * already matched the terms and verified the phrases against the positions
+ * stored with them, so the runtime check of the meta qual is turned off.
+ * The text index qual is derived from the meta qual, so the bitmap scan has
+ * no recheck condition of its own: the meta qual with the runtime check
+ * becomes the recheck condition, which only runs for lossy pages and
+ * matches that asked for a recheck.
+ */
+static void
+SkipTextRuntimeRecheckForBitmapScan(Plan *nestedPlan)
+{
+	if (!IsA(nestedPlan, BitmapHeapScan))
+	{
+		return;
+	}
+
+	BitmapHeapScan *bitmapScan = (BitmapHeapScan *) nestedPlan;
+	if (!BitmapPlanHasTextIndexQual(outerPlan(nestedPlan)))
+	{
+		return;
+	}
+
+	ListCell *cell;
+	foreach(cell, nestedPlan->qual)
+	{
+		Node *qual = lfirst(cell);
+		if (!IsA(qual, FuncExpr) ||
+			((FuncExpr *) qual)->funcid != BsonTextSearchMetaQualFuncId())
+		{
+			continue;
+		}
+
+		bitmapScan->bitmapqualorig = lappend(bitmapScan->bitmapqualorig,
+											 copyObject(qual));
+
+		/* The meta qual still tracks the query for $meta, only skip its evaluation */
+		FuncExpr *metaQual = (FuncExpr *) copyObject(qual);
+		lfourth(metaQual->args) = makeBoolConst(false, false);
+		lfirst(cell) = metaQual;
+	}
+}
+
+
+/*
+ * Whether every document of the bitmap produced by the plan matched the text
+ * index qual: either a scan of the text index, or an intersection with one.
+ */
+static bool
+BitmapPlanHasTextIndexQual(Plan *bitmapPlan)
+{
+	if (bitmapPlan == NULL)
+	{
+		return false;
+	}
+
+	ListCell *cell;
+	if (IsA(bitmapPlan, BitmapAnd))
+	{
+		foreach(cell, ((BitmapAnd *) bitmapPlan)->bitmapplans)
+		{
+			if (BitmapPlanHasTextIndexQual(lfirst(cell)))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	if (!IsA(bitmapPlan, BitmapIndexScan))
+	{
+		return false;
+	}
+
+	foreach(cell, ((BitmapIndexScan *) bitmapPlan)->indexqualorig)
+	{
+		if (IsTextIndexQual(lfirst(cell)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * Whether the qual is the text index operator, i.e. an operator on a
+ * constant tsquery.
+ */
+static bool
+IsTextIndexQual(Node *qual)
+{
+	if (!IsA(qual, OpExpr) || list_length(((OpExpr *) qual)->args) != 2)
+	{
+		return false;
+	}
+
+	Node *queryNode = lsecond(((OpExpr *) qual)->args);
+	return IsA(queryNode, Const) && ((Const *) queryNode)->consttype == TSQUERYOID;
+}
+
+
 /*
  * Helper method that walks all paths in the rel's pathlist for vector search with pre-filter
  * and checks if the given user specified filter path is matching with any of the index paths.
@@ -434,6 +547,12 @@ ExtensionQueryScanPlanCustomPath(PlannerInfo *root,
 	/* The main plan comes in first */
 	Plan *nestedPlan = linitial(custom_plans);
 
+	InputQueryState *inputState = linitial(best_path->custom_private);
+	if (EnableTextIndexSkipRuntimeRecheck && inputState->hasQueryTextData)
+	{
+		SkipTextRuntimeRecheckForBitmapScan(nestedPlan);
+	}
+
 	/* Push the projection down to the inner plan */
 	if (tlist != NIL)
 	{
@@ -1717,6 +1717,16 @@ ParseContinuationState(ExtensionScanState *extensionScanState,
 						}
 
 						tableName = bson_iter_utf8(&singleContinuationDoc, NULL);
+
+						/*
+						 * The table name is written first, so the entries of other
+						 * shards are skipped without looking at their values. This keeps
+						 * each shard's parse cheap when a scan spans many shards.
+						 */
+						if (strcmp(tableName, continuation->queryTableName) != 0)
+						{
+							break;
+						}
 					}
 					else if (StringViewEquals(&keyView,
 											  &CursorContinuationValue))
@@ -1793,6 +1803,9 @@ ParseContinuationState(ExtensionScanState *extensionScanState,
 					   sizeof(ItemPointerData));
 				extensionScanState->rawUsercontinuation = *currentValue;
 				extensionScanState->hasUserContinuationState = true;
+
+				/* Each shard has a single entry in the continuation */
+				break;
 			}
 		}
 		else
@@ -11,6 +11,7 @@
 #include <utils/guc.h>
 #include <limits.h>
 #include <access/xact.h>
+#include <catalog/pg_type.h>
 #include <postmaster/bgworker.h>
 #include <storage/ipc.h>
 #include <storage/shmem.h>
@@ -18,6 +19,7 @@
 #include "documentdb_api_init.h"
 #include "metadata/metadata_guc.h"
 #include "metadata/metadata_cache.h"
+#include "metadata/collection_shared_cache.h"
 #include "planner/documentdb_planner.h"
 #include "customscan/custom_scan_registrations.h"
 #include "commands/connection_management.h"
@@ -29,14 +31,23 @@
 #include "index_am/documentdb_rum.h"
 #include "infrastructure/bgworker_job_logger.h"
 #include "infrastructure/cursor_store.h"
+#include "infrastructure/documentdb_plan_cache.h"
+#include "infrastructure/documentdb_stats_cache.h"
+#include "utils/stage_counter.h"
+#include "utils/command_activity.h"
+#include "utils/slow_command_profile.h"
+#include "ttl/ttl_index.h"
 #include "background_worker/background_worker_job.h"
 #include "index_am/roaring_bitmap_adapter.h"
+#include "io/bson_core.h"
+#include "query/bson_dollar_operators.h"
 
 /* --------------------------------------------------------- */
 /* Data Types & Enum values */
 /* --------------------------------------------------------- */
 
 extern bool EnableBackgroundWorker;
+extern bool EnableBackgroundWorkerTTLJob;
 static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
 static shmem_request_hook_type prev_shmem_request_hook = NULL;
 
@@ -48,6 +59,7 @@ bool ShouldUpgradeDataTables = true;
 /* Forward declaration */
 /* --------------------------------------------------------- */
 extern void RegisterBackgroundWorkerJobAllowedCommand(BackgroundWorkerJobCommand command);
+extern void RegisterBackgroundWorkerJob(BackgroundWorkerJob job);
 
 /* callbacks for transaction management */
 static void DocumentDBTransactionCallback(XactEvent event, void *arg);
@@ -191,6 +203,45 @@ InitializeBackgroundWorkerJobAllowedCommands(void)
 		.name = "build_index_background", .schema = ApiInternalSchemaName
 	};
 	RegisterBackgroundWorkerJobAllowedCommand(buildIndexConcurrently);
+
+	BackgroundWorkerJobCommand dropOrphanedCollectionTables = {
+		.name = "drop_orphaned_collection_tables_background",
+		.schema = ApiInternalSchemaName
+	};
+	RegisterBackgroundWorkerJobAllowedCommand(dropOrphanedCollectionTables);
+}
+
+
+/*
+ * Registers the background worker jobs run by the extension itself.
+ */
+void
+InitializeBackgroundWorkerJobs(void)
+{
+	if (!EnableBackgroundWorker || !EnableBackgroundWorkerTTLJob)
+	{
+		return;
+	}
+
+	/*
+	 * The TTL purge runs as one execution per partition of the collections, the
+	 * documentdb_ttl_task cron job yields to it (see delete_expired_rows).
+	 */
+	BackgroundWorkerJob ttlJob = {
+		.jobId = TTL_BACKGROUND_JOB_ID,
+		.jobName = "documentdb_ttl_task",
+		.command = {
+			.name = "delete_expired_rows_background", .schema = ApiInternalSchemaName
+		},
+		.argument = {
+			.argType = INT4OID, .argValue = "-1", .isNull = false
+		},
+		.get_schedule_interval_in_seconds_hook = NULL,
+		.timeoutInSeconds = TTL_BACKGROUND_JOB_TIMEOUT_SEC,
+		.toBeExecutedOnMetadataCoordinatorOnly = true,
+		.supportsPartitionedExecution = true
+	};
+	RegisterBackgroundWorkerJob(ttlJob);
 }
 
 
@@ -211,6 +262,14 @@ DocumentDBSharedMemoryRequest(void)
 	RequestAddinShmemSpace(VersionCacheShmemSize());
 	RequestAddinShmemSpace(FileCursorShmemSize());
 	RequestAddinShmemSpace(BgWorkerJobLoggerShmemSize());
+	RequestAddinShmemSpace(QueryPlanHintShmemSize());
+	RequestAddinShmemSpace(TtlIndexProgressShmemSize());
+	RequestAddinShmemSpace(StatsCacheShmemSize());
+	RequestAddinShmemSpace(SharedStageCounterShmemSize());
+	RequestAddinShmemSpace(SharedCollectionCacheShmemSize());
+	RequestAddinShmemSpace(SharedMetadataCacheShmemSize());
+	RequestAddinShmemSpace(CommandActivityShmemSize());
+	RequestAddinShmemSpace(SlowCommandProfileShmemSize());
 }
 
 
@@ -222,6 +281,14 @@ DocumentDBSharedMemoryInit(void)
 	InitializeVersionCache();
 	InitializeFileCursorShmem();
 	InitializeBgWorkerJobLoggerShmem();
+	InitializeQueryPlanHintShmem();
+	InitializeTtlIndexProgressShmem();
+	InitializeStatsCacheShmem();
+	SharedStageCounterShmemInit();
+	InitializeSharedCollectionCacheShmem();
+	InitializeSharedMetadataCacheShmem();
+	InitializeCommandActivityShmem();
+	InitializeSlowCommandProfileShmem();
 
 	if (prev_shmem_startup_hook != NULL)
 	{
@@ -240,6 +307,21 @@ DocumentDBTransactionCallback(XactEvent event, void *arg)
 		{
 			ConnMgrTryCancelActiveConnection();
 			DeletePendingCursorFiles();
+			ResetQueryDocumentDetoastCache();
+			PgbsonFieldOffsetCacheReset();
+			ApplyPendingSharedCollectionInvalidations(false);
+			ClearCommandActivity();
+			break;
+		}
+
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_PREPARE:
+		{
+			ResetQueryDocumentDetoastCache();
+			ApplyPendingSharedCollectionInvalidations(event != XACT_EVENT_PREPARE);
+			PublishDocumentDBApiOidCache();
+			ClearCommandActivity();
 			break;
 		}
 
@@ -260,6 +342,9 @@ DocumentDBSubTransactionCallback(SubXactEvent event, SubTransactionId mySubid,
 		case SUBXACT_EVENT_ABORT_SUB:
 		{
 			ConnMgrTryCancelActiveConnection();
+
+			/* Scopes of the field offset cache are not ended on error */
+			PgbsonFieldOffsetCacheReset();
 			break;
 		}
 
@@ -27,6 +27,8 @@
 #include "include/geospatial/bson_geospatial_wkb_iterator.h"
 #include "include/geospatial/bson_geospatial_common.h"
 
+extern bool EnableGeospatialBulkPointParsing;
+
 
 /* Hash entry for points to track duplicate points */
 typedef struct PointsHashEntry
@@ -114,7 +116,8 @@ static char * GetRingPointsStringForError(char *currPtr, int32 numPoints);
 
 
 /* HashSet utilities for Points */
-static HTAB * CreatePointsHashSet(void);
+static HTAB * CreatePointsHashSet(long numPoints);
+static inline bool TryGetBoundedDoublePoint(const bson_value_t *value, Point *outPoint);
 static int PointsHashEntryCompareFunc(const void *obj1, const void *obj2, Size objsize);
 static uint32 PointsHashEntryHashFunc(const void *obj, Size objsize);
 
@@ -570,13 +573,33 @@ WriteBufferGeoJsonMultiPoints(const bson_value_t *multiPointValue, const GeoJson
 	bool isPolyOrLinestring =
 		((type & (GeoJsonType_LINESTRING | GeoJsonType_POLYGON)) != 0);
 
+	/*
+	 * With bulk parsing the buffer and the points hash are sized upfront for all the
+	 * points, so that large rings don't repeatedly grow the buffer and split the hash.
+	 */
+	long numPointsHint = 32;
+	if (EnableGeospatialBulkPointParsing)
+	{
+		numPointsHint = 0;
+		bson_iter_t countIter;
+		BsonValueInitIterator(multiPointValue, &countIter);
+		while (bson_iter_next(&countIter))
+		{
+			numPointsHint++;
+		}
+
+		enlargeStringInfo(geoJsonWKB, WKB_BYTE_SIZE_NUM +
+						  numPointsHint * WKB_BYTE_SIZE_POINT);
+		numPointsHint = Max(numPointsHint, 32);
+	}
+
 	/* Create a hash set for polygon validation to identify duplicate points (not adjacent) */
 	HTAB *pointsHash = NULL;
 	int duplicateFirst = -1;
 	int duplicateSecond = -1;
 	if (type == GeoJsonType_POLYGON)
 	{
-		pointsHash = CreatePointsHashSet();
+		pointsHash = CreatePointsHashSet(numPointsHint);
 	}
 
 	/*
@@ -606,12 +629,16 @@ WriteBufferGeoJsonMultiPoints(const bson_value_t *multiPointValue, const GeoJson
 		memset(&point, 0, sizeof(Point));
 
 		const bson_value_t *value = bson_iter_value(&multiPointsValueIter);
-		bool isValid = ParseBsonValueAsPointWithBounds(value, shouldThrowError,
-													   state->errorCtxt, &point);
-
-		if (!isValid)
+		if (!EnableGeospatialBulkPointParsing ||
+			!TryGetBoundedDoublePoint(value, &point))
 		{
-			return false;
+			bool isValid = ParseBsonValueAsPointWithBounds(value, shouldThrowError,
+														   state->errorCtxt, &point);
+
+			if (!isValid)
+			{
+				return false;
+			}
 		}
 
 		/* 1st: Skip adjacent same points for Polygon on line string */
@@ -1599,7 +1626,7 @@ WriteBufferGeoJsonCore(const bson_value_t *value, bool insideGeoJsonGeometryColl
  * Creates the points hash table for finding duplicate points in the multiple points rings
  */
 static HTAB *
-CreatePointsHashSet()
+CreatePointsHashSet(long numPoints)
 {
 	HASHCTL hashInfo = CreateExtensionHashCTL(
 		sizeof(PointsHashEntry),
@@ -1607,11 +1634,52 @@ CreatePointsHashSet()
 		PointsHashEntryCompareFunc,
 		PointsHashEntryHashFunc);
 
-	return hash_create("GeoJSON Polygon Points Hash value", 32, &hashInfo,
+	return hash_create("GeoJSON Polygon Points Hash value", numPoints, &hashInfo,
 					   DefaultExtensionHashFlags);
 }
 
 
+/*
+ * Reads the common [<double>, <double>] coordinate pair directly from the array.
+ * Returns false for anything else (other numeric types, documents, non finite
+ * or out of bounds values) so that the caller can parse the value with
+ * ParseBsonValueAsPointWithBounds and report the same errors.
+ */
+static inline bool
+TryGetBoundedDoublePoint(const bson_value_t *value, Point *outPoint)
+{
+	if (value->value_type != BSON_TYPE_ARRAY)
+	{
+		return false;
+	}
+
+	bson_iter_t pointIter;
+	BsonValueInitIterator(value, &pointIter);
+	if (!bson_iter_next(&pointIter) || !BSON_ITER_HOLDS_DOUBLE(&pointIter))
+	{
+		return false;
+	}
+
+	double x = bson_iter_double(&pointIter);
+	if (!bson_iter_next(&pointIter) || !BSON_ITER_HOLDS_DOUBLE(&pointIter))
+	{
+		return false;
+	}
+
+	double y = bson_iter_double(&pointIter);
+
+	/* NaN fails these comparisons as well */
+	if (!(x >= -180.0 && x <= 180.0 && y >= -90.0 && y <= 90.0))
+	{
+		return false;
+	}
+
+	outPoint->x = x;
+	outPoint->y = y;
+	return true;
+}
+
+
 /*
  * Get the GeoJsonType from the value representing the type in string
  */
@@ -18,6 +18,7 @@
 #include "io/pgbsonelement.h"
 #include "geospatial/bson_geospatial_common.h"
 #include "geospatial/bson_geospatial_wkb_iterator.h"
+#include "infrastructure/documentdb_geospatial_shape_cache.h"
 #include "planner/mongo_query_operator.h"
 #include "metadata/metadata_cache.h"
 #include "utils/documentdb_errors.h"
@@ -190,7 +191,7 @@ PopulateBsonDollarGeoWithinQueryState(RuntimeBsonGeospatialState *runtimeState,
 	runtimeState->opInfo->queryOperatorType = QUERY_OPERATOR_GEOWITHIN;
 	runtimeState->state.isSpherical = shapeOperator->isSpherical;
 	runtimeState->state.geoSpatialDatum =
-		shapeOperator->getShapeDatum(&shapePointsValue, runtimeState->opInfo);
+		GetCachedShapeDatum(shapeOperator, &shapePointsValue, runtimeState->opInfo);
 
 	/*
 	 * Postgis provides ST_Within function but that doesn't provide the same
@@ -225,7 +226,7 @@ PopulateBsonDollarGeoIntersectQueryState(RuntimeBsonGeospatialState *runtimeStat
 	runtimeState->opInfo->queryOperatorType = QUERY_OPERATOR_GEOINTERSECTS;
 	runtimeState->state.isSpherical = shapeOperator->isSpherical;
 	runtimeState->state.geoSpatialDatum =
-		shapeOperator->getShapeDatum(&shapePointsValue, runtimeState->opInfo);
+		GetCachedShapeDatum(shapeOperator, &shapePointsValue, runtimeState->opInfo);
 
 	runtimeState->postgisFuncFmgrInfo =
 		(FmgrInfo **) palloc0(PostgisFuncsForDollarGeo_MAX * sizeof(FmgrInfo *));
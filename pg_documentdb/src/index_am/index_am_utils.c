@@ -35,6 +35,7 @@ BsonIndexAmEntry RumIndexAmEntry = {
 	.is_backwards_scan_supported = false,
 	.is_index_only_scan_supported = false,
 	.can_support_parallel_scans = false,
+	.is_skip_scan_supported = false,
 	.get_am_oid = RumIndexAmId,
 	.get_single_path_op_family_oid = BsonRumSinglePathOperatorFamily,
 	.get_composite_path_op_family_oid = BsonRumCompositeIndexOperatorFamily,
@@ -395,6 +396,18 @@ GetIndexSupportsBackwardsScan(Oid relam, bool *indexCanOrder)
 }
 
 
+/*
+ * Whether the index AM can skip over the values of the leading columns of
+ * a composite index that are not specified in the query.
+ */
+bool
+GetIndexAmSupportsSkipScan(Oid relam)
+{
+	const BsonIndexAmEntry *amEntry = GetBsonIndexAmEntryByIndexOid(relam);
+	return amEntry != NULL && amEntry->is_skip_scan_supported;
+}
+
+
 static const char *
 GetRumCatalogSchema(void)
 {
@@ -0,0 +1,137 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/index_am/index_path_filter.c
+ *
+ * Implementation of the bloom filter of document paths kept for wildcard
+ * indexes. The filter lets scans on paths that no document in the index
+ * has return no results without descending the entry tree.
+ *-------------------------------------------------------------------------
+ */
+
+#include <postgres.h>
+#include <common/hashfn.h>
+#include <lib/stringinfo.h>
+
+#include "io/bson_core.h"
+#include "index_am/index_path_filter.h"
+
+#define INDEX_PATH_FILTER_NUM_BITS (INDEX_PATH_FILTER_SIZE * 8)
+#define INDEX_PATH_FILTER_NUM_HASHES 4
+
+static void AddPathsForIterator(uint8 *filter, bson_iter_t *iter, StringInfo path);
+static void AddPathToFilter(uint8 *filter, const char *path, uint32_t pathLength);
+
+
+/*
+ * Adds every path of the document to the filter. Array elements share the
+ * path of the array (i.e. {a: [{b: 1}]} adds "a" and "a.b"), which matches
+ * how the query paths are resolved against arrays.
+ */
+void
+IndexPathFilterAddDocumentPaths(uint8 *filter, pgbson *document)
+{
+	bson_iter_t iter;
+	StringInfoData path;
+
+	initStringInfo(&path);
+	PgbsonInitIterator(document, &iter);
+	AddPathsForIterator(filter, &iter, &path);
+	pfree(path.data);
+}
+
+
+bool
+IndexPathFilterMayContainPath(const uint8 *filter, const char *path,
+							  uint32_t pathLength)
+{
+	uint64 hash = hash_bytes_extended((const unsigned char *) path, pathLength, 0);
+	uint32 hash1 = (uint32) hash;
+	uint32 hash2 = (uint32) (hash >> 32) | 1;
+
+	for (uint32 i = 0; i < INDEX_PATH_FILTER_NUM_HASHES; i++)
+	{
+		uint32 bit = (hash1 + i * hash2) % INDEX_PATH_FILTER_NUM_BITS;
+		if ((filter[bit / 8] & (1 << (bit % 8))) == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void
+AddPathsForIterator(uint8 *filter, bson_iter_t *iter, StringInfo path)
+{
+	int basePathLength = path->len;
+	while (bson_iter_next(iter))
+	{
+		bson_type_t type = bson_iter_type(iter);
+		bson_iter_t childIter;
+
+		if (basePathLength > 0)
+		{
+			appendStringInfoChar(path, '.');
+		}
+
+		appendBinaryStringInfo(path, bson_iter_key(iter), bson_iter_key_len(iter));
+		AddPathToFilter(filter, path->data, path->len);
+
+		if (type == BSON_TYPE_DOCUMENT && bson_iter_recurse(iter, &childIter))
+		{
+			AddPathsForIterator(filter, &childIter, path);
+		}
+		else if (type == BSON_TYPE_ARRAY && bson_iter_recurse(iter, &childIter))
+		{
+			/* Elements are addressed by the path of the array itself */
+			while (bson_iter_next(&childIter))
+			{
+				bson_type_t elementType = bson_iter_type(&childIter);
+				bson_iter_t elementIter;
+				if ((elementType == BSON_TYPE_DOCUMENT ||
+					 elementType == BSON_TYPE_ARRAY) &&
+					bson_iter_recurse(&childIter, &elementIter))
+				{
+					if (elementType == BSON_TYPE_DOCUMENT)
+					{
+						AddPathsForIterator(filter, &elementIter, path);
+					}
+					else
+					{
+						/* Nested arrays: look for documents one level down */
+						while (bson_iter_next(&elementIter))
+						{
+							bson_iter_t nestedIter;
+							if (BSON_ITER_HOLDS_DOCUMENT(&elementIter) &&
+								bson_iter_recurse(&elementIter, &nestedIter))
+							{
+								AddPathsForIterator(filter, &nestedIter, path);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		CHECK_FOR_INTERRUPTS();
+		path->len = basePathLength;
+		path->data[basePathLength] = '\0';
+	}
+}
+
+
+static void
+AddPathToFilter(uint8 *filter, const char *path, uint32_t pathLength)
+{
+	uint64 hash = hash_bytes_extended((const unsigned char *) path, pathLength, 0);
+	uint32 hash1 = (uint32) hash;
+	uint32 hash2 = (uint32) (hash >> 32) | 1;
+
+	for (uint32 i = 0; i < INDEX_PATH_FILTER_NUM_HASHES; i++)
+	{
+		uint32 bit = (hash1 + i * hash2) % INDEX_PATH_FILTER_NUM_BITS;
+		filter[bit / 8] |= (1 << (bit % 8));
+	}
+}
@@ -10,6 +10,7 @@
 
 #include <postgres.h>
 #include <storage/itemptr.h>
+#include <nodes/tidbitmap.h>
 #include "../roaring_bitmaps/roaring.h"
 #include "index_am/roaring_bitmap_adapter.h"
 #include "index_am/documentdb_rum.h"
@@ -66,6 +67,59 @@ FreeRoaringBitmapState(void *state)
 }
 
 
+/*
+ * Intersects the tuples of otherState into state.
+ */
+void
+RoaringBitmapStateIntersect(void *state, const void *otherState)
+{
+	RoaringBitmapState *bitmapState = (RoaringBitmapState *) state;
+	const RoaringBitmapState *otherBitmapState = (const RoaringBitmapState *) otherState;
+	roaring64_bitmap_and_inplace(bitmapState->bitmap, otherBitmapState->bitmap);
+}
+
+
+uint64
+RoaringBitmapStateCardinality(const void *state)
+{
+	const RoaringBitmapState *bitmapState = (const RoaringBitmapState *) state;
+	return roaring64_bitmap_get_cardinality(bitmapState->bitmap);
+}
+
+
+/*
+ * Adds the tuples of the bitmap to the TIDBitmap in batches (the bitmap
+ * iterates in TID order so the batches are mostly on the same pages).
+ */
+int64
+RoaringBitmapStateAddToTidBitmap(const void *state, TIDBitmap *tbm, bool recheck)
+{
+#define ROARING_TID_BATCH_SIZE 256
+	const RoaringBitmapState *bitmapState = (const RoaringBitmapState *) state;
+	uint64_t values[ROARING_TID_BATCH_SIZE];
+	ItemPointerData tids[ROARING_TID_BATCH_SIZE];
+	int64 numTuples = 0;
+
+	roaring64_iterator_t *iterator = roaring64_iterator_create(bitmapState->bitmap);
+	uint64_t numRead;
+	while ((numRead = roaring64_iterator_read(iterator, values,
+											  ROARING_TID_BATCH_SIZE)) > 0)
+	{
+		for (uint64_t i = 0; i < numRead; i++)
+		{
+			ItemPointerSet(&tids[i], (BlockNumber) (values[i] >> 32),
+						   (OffsetNumber) (values[i] & 0xFFFF));
+		}
+
+		tbm_add_tuples(tbm, tids, (int) numRead, recheck);
+		numTuples += numRead;
+	}
+
+	roaring64_iterator_free(iterator);
+	return numTuples;
+}
+
+
 static void *
 roaring_pg_malloc(size_t num_bytes)
 {
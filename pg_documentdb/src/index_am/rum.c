@@ -18,9 +18,13 @@
 #include <utils/lsyscache.h>
 #include <access/relscan.h>
 #include <utils/rel.h>
+#include <access/tableam.h>
 #include "math.h"
 #include <commands/explain.h>
 #include <access/gin.h>
+#include <nodes/makefuncs.h>
+#include <optimizer/cost.h>
+#include <portability/instr_time.h>
 
 #if PG_VERSION_NUM >= 180000
 #include <commands/explain_state.h>
@@ -34,16 +38,24 @@
 #include "metadata/metadata_cache.h"
 #include "opclass/bson_gin_composite_scan.h"
 #include "index_am/index_am_utils.h"
+#include "index_am/roaring_bitmap_adapter.h"
+#include "index_am/index_path_filter.h"
 #include "opclass/bson_gin_index_term.h"
 #include "opclass/bson_gin_private.h"
 #include "utils/documentdb_errors.h"
 #include "utils/error_utils.h"
+#include "query/bson_dollar_selectivity.h"
+#include "utils/command_activity.h"
+#include "utils/slow_command_profile.h"
 
 extern bool ForceUseIndexIfAvailable;
 extern bool EnableIndexOrderbyPushdown;
 extern bool EnableIndexOnlyScan;
 extern bool EnableCompositeIndexPlanner;
 extern bool DisableExtendedRumExplainPlans;
+extern int CompositeIndexSkipScanMaxDistinctValues;
+extern bool EnableRumRoaringBitmapIntersection;
+extern bool EnableWildcardIndexPathFilter;
 
 extern const RumIndexArrayStateFuncs RoaringStateFuncs;
 
@@ -62,6 +74,13 @@ const RumIndexArrayStateFuncs *IndexArrayStateFuncs = &RoaringStateFuncs;
 static GetMultikeyStatusFunc rum_index_multi_key_get_func = NULL;
 static UpdateMultikeyStatusFunc rum_index_multi_key_update_func = NULL;
 
+typedef bool (*GetPathFilterFunc)(Relation index, uint8 *filter, uint32 filterSize);
+typedef void (*UpdatePathFilterFunc)(Relation index, const uint8 *filter,
+									 uint32 filterSize, bool initialize);
+
+static GetPathFilterFunc rum_index_path_filter_get_func = NULL;
+static UpdatePathFilterFunc rum_index_path_filter_update_func = NULL;
+
 typedef enum IndexMultiKeyStatus
 {
 	IndexMultiKeyStatus_Unknown = 0,
@@ -71,6 +90,58 @@ typedef enum IndexMultiKeyStatus
 	IndexMultiKeyStatus_HasNoArrays = 2
 } IndexMultiKeyStatus;
 
+/*
+ * Stats of a bitmap scan that intersected per key roaring bitmaps, kept
+ * for explain. They live in the memory context of the scan and unlink
+ * themselves from RoaringIntersectionStatsList when it goes away.
+ */
+typedef struct RoaringIntersectionStats
+{
+	IndexScanDesc scan;
+
+	int numKeys;
+
+	/* The number of tuples matched by each scan key */
+	uint64 *keyBitmapSizes;
+
+	/* The number of tuples after the intersection */
+	uint64 resultSize;
+
+	double intersectionTimeMs;
+
+	MemoryContextCallback resetCallback;
+
+	struct RoaringIntersectionStats *next;
+} RoaringIntersectionStats;
+
+static RoaringIntersectionStats *RoaringIntersectionStatsList = NULL;
+
+/*
+ * Path filter state of a scan on a wildcard index. A scan is void if one of
+ * its keys requires a path that the path filter of the index says no
+ * document has. Like the intersection stats, these live in the memory context
+ * of the scan and unlink themselves from PathFilterScanStateList.
+ */
+typedef struct PathFilterScanState
+{
+	IndexScanDesc scan;
+
+	/* The path filter read from the index (NULL if not yet read) */
+	uint8 *filter;
+
+	/* Whether the index has a valid path filter */
+	bool hasFilter;
+
+	/* Whether the current scan keys can match no document */
+	bool isVoidScan;
+
+	MemoryContextCallback resetCallback;
+
+	struct PathFilterScanState *next;
+} PathFilterScanState;
+
+static PathFilterScanState *PathFilterScanStateList = NULL;
+
 typedef struct DocumentDBRumIndexState
 {
 	IndexScanDesc innerScan;
@@ -99,6 +170,18 @@ static bool MatchClauseWithIndexForFuncExpr(IndexPath *path, int32_t indexcol,
 static bool ValidateMatchForOrderbyQuals(IndexPath *path);
 
 static bool IsTextIndexMatch(IndexPath *path);
+static bool TryGetSkipScanDistinctValues(PlannerInfo *root, IndexPath *path,
+										 double *distinctValues);
+static int64 GetBitmapWithRoaringIntersection(IndexScanDesc scan, TIDBitmap *tbm,
+											  IndexAmRoutine *coreRoutine);
+static void RemoveRoaringIntersectionStats(void *arg);
+static bool IsWildcardIndexOptions(bytea *indexOptions);
+static bool IsWildcardIndexRelation(Relation indexRelation);
+static void UpdatePathFilterForScan(IndexScanDesc scan);
+static bool IsVoidPathFilterScan(IndexScanDesc scan);
+static void RemovePathFilterScanState(void *arg);
+static void BuildPathFilterCallback(Relation index, ItemPointer tid, Datum *values,
+									bool *isnull, bool tupleIsAlive, void *state);
 
 static IndexMultiKeyStatus CheckIndexHasArrays(Relation indexRelation,
 											   IndexAmRoutine *coreRoutine);
@@ -170,6 +253,8 @@ typedef enum RumFunctionCatalog
 	RumFunction_RumGetMultiKeyStatus,
 	RumFunction_RumUpdateMultiKeyStatus,
 	RumFunction_SetUnredactedLogHook,
+	RumFunction_RumGetPathFilter,
+	RumFunction_RumUpdatePathFilter,
 	RumFunction_Max,
 } RumFunctionCatalog;
 
@@ -188,7 +273,9 @@ static const char *RumFunctionArray[RumFunction_Max] =
 	[RumFunction_CanRumIndexScanOrdered] = "can_rum_index_scan_ordered",
 	[RumFunction_RumGetMultiKeyStatus] = "rum_get_multi_key_status",
 	[RumFunction_RumUpdateMultiKeyStatus] = "rum_update_multi_key_status",
-	[RumFunction_SetUnredactedLogHook] = "SetRumUnredactedLogEmitHook"
+	[RumFunction_SetUnredactedLogHook] = "SetRumUnredactedLogEmitHook",
+	[RumFunction_RumGetPathFilter] = "rum_get_path_filter",
+	[RumFunction_RumUpdatePathFilter] = "rum_update_path_filter"
 };
 
 
@@ -208,6 +295,8 @@ static const char *DocumentDBRumFunctionArray[RumFunction_Max] =
 	[RumFunction_RumGetMultiKeyStatus] = "documentdb_rum_get_multi_key_status",
 	[RumFunction_RumUpdateMultiKeyStatus] = "documentdb_rum_update_multi_key_status",
 	[RumFunction_SetUnredactedLogHook] = "DocumentDBSetRumUnredactedLogEmitHook",
+	[RumFunction_RumGetPathFilter] = "documentdb_rum_get_path_filter",
+	[RumFunction_RumUpdatePathFilter] = "documentdb_rum_update_path_filter",
 };
 
 
@@ -553,6 +642,27 @@ LoadRumRoutine(void)
 							   !missingOk,
 							   ignoreLibFileHandle);
 
+	/*
+	 * Optional path filter of wildcard indexes: only the documentdb RUM library
+	 * provides it, so the other libraries must still load without it.
+	 */
+	rum_index_path_filter_get_func =
+		load_external_function(rumLibPath,
+							   functionCatalog[RumFunction_RumGetPathFilter],
+							   false,
+							   ignoreLibFileHandle);
+	rum_index_path_filter_update_func =
+		load_external_function(rumLibPath,
+							   functionCatalog[RumFunction_RumUpdatePathFilter],
+							   false,
+							   ignoreLibFileHandle);
+	if (rum_index_path_filter_get_func == NULL ||
+		rum_index_path_filter_update_func == NULL)
+	{
+		rum_index_path_filter_get_func = NULL;
+		rum_index_path_filter_update_func = NULL;
+	}
+
 	ereport(LOG, (errmsg("rum library has update func %d, get func %d",
 						 rum_index_multi_key_update_func != NULL,
 						 rum_index_multi_key_get_func != NULL)));
@@ -610,6 +720,7 @@ extension_rumcostestimate_core(PlannerInfo *root, IndexPath *path, double loop_c
 		return;
 	}
 
+	double skipScanDistinctValues = 0;
 	if (IsCompositeOpFamilyOid(path->indexinfo->relam,
 							   path->indexinfo->opfamily[0]))
 	{
@@ -618,9 +729,11 @@ extension_rumcostestimate_core(PlannerInfo *root, IndexPath *path, double loop_c
 		/* If this is a composite index, then we need to ensure that
 		 * the first column of the index matches the query path.
 		 * This is because using the composite index would require specifying
-		 * the first column.
+		 * the first column - unless the index can skip over the (few) distinct
+		 * values of the first column.
 		 */
-		if (!firstColumnSpecified)
+		if (!firstColumnSpecified &&
+			!TryGetSkipScanDistinctValues(root, path, &skipScanDistinctValues))
 		{
 			*indexStartupCost = 0;
 			*indexTotalCost = INFINITY;
@@ -635,6 +748,12 @@ extension_rumcostestimate_core(PlannerInfo *root, IndexPath *path, double loop_c
 		root, path, loop_count, indexStartupCost, indexTotalCost,
 		indexSelectivity, indexCorrelation, indexPages);
 
+	if (skipScanDistinctValues > 0)
+	{
+		/* A skip scan seeks into the index once per distinct leading value */
+		*indexTotalCost += skipScanDistinctValues * random_page_cost;
+	}
+
 	/* Do a pass to check for text indexes (We force push down with cost == 0) */
 	if (IsTextIndexMatch(path))
 	{
@@ -649,6 +768,51 @@ extension_rumcostestimate_core(PlannerInfo *root, IndexPath *path, double loop_c
 }
 
 
+/*
+ * Checks whether a composite index path with no filter on the first index path
+ * can be answered by a skip scan: The index AM enumerates the distinct values
+ * of the first path and seeks to the bounds of the other paths within each of
+ * them. This is only worth it if ANALYZE found few distinct values for the first
+ * path, and returns that number of distinct values in that case.
+ */
+static bool
+TryGetSkipScanDistinctValues(PlannerInfo *root, IndexPath *path,
+							 double *distinctValues)
+{
+	if (CompositeIndexSkipScanMaxDistinctValues <= 0 ||
+		list_length(path->indexclauses) == 0 ||
+		path->indexinfo->indexkeys[0] == 0 ||
+		path->indexinfo->opclassoptions == NULL ||
+		!GetIndexAmSupportsSkipScan(path->indexinfo->relam))
+	{
+		return false;
+	}
+
+	BsonGinCompositePathOptions *options =
+		(BsonGinCompositePathOptions *) path->indexinfo->opclassoptions[0];
+	if (options == NULL || options->wildcardPathIndex == 0)
+	{
+		return false;
+	}
+
+	Var *documentVar = makeVar(path->indexinfo->rel->relid,
+							   path->indexinfo->indexkeys[0], BsonTypeId(), -1,
+							   InvalidOid, 0);
+	const char *firstIndexPath = GetCompositeFirstIndexPath(options);
+	double firstPathDistinctValues = 0;
+	if (!TryGetPathDistinctValueCount(root, (Node *) documentVar,
+									  path->indexinfo->rel->relid, firstIndexPath,
+									  &firstPathDistinctValues) ||
+		firstPathDistinctValues > CompositeIndexSkipScanMaxDistinctValues)
+	{
+		return false;
+	}
+
+	*distinctValues = Max(firstPathDistinctValues, 1.0);
+	return true;
+}
+
+
 /* Check if the index supports index-only scans based on the index rel am. */
 bool
 CompositeIndexSupportsIndexOnlyScan(const IndexPath *indexPath)
@@ -817,9 +981,14 @@ ValidateMatchForOrderbyQuals(IndexPath *path)
 			return false;
 		}
 
-		/* Validate that it's a supported operator */
+		/* Validate that it's a supported operator: The composite index planner
+		 * builds the order by clauses with make_opclause, which leaves the
+		 * opfuncid unset, and uses the reverse operator for descending sorts.
+		 */
 		OpExpr *opQual = (OpExpr *) orderQual;
-		if (opQual->opfuncid != BsonOrderByFunctionOid())
+		if (opQual->opfuncid != BsonOrderByFunctionOid() &&
+			opQual->opno != BsonOrderByIndexOperatorId() &&
+			opQual->opno != BsonOrderByReverseIndexOperatorId())
 		{
 			return false;
 		}
@@ -891,6 +1060,8 @@ IndexScanDesc
 extension_rumbeginscan_core(Relation rel, int nkeys, int norderbys,
 							IndexAmRoutine *coreRoutine)
 {
+	ReportIndexScanForProfile(rel);
+
 	if (IsCompositeOpClass(rel))
 	{
 		IndexScanDesc scan = RelationGetIndexScan(rel, nkeys, norderbys);
@@ -947,6 +1118,13 @@ extension_rumrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 	extension_rumrescan_core(scan, scankey, nscankeys,
 							 orderbys, norderbys, &rum_index_routine,
 							 rum_index_multi_key_get_func, rum_index_scan_ordered);
+
+	if (EnableWildcardIndexPathFilter && rum_index_path_filter_get_func != NULL &&
+		!IsCompositeOpClass(scan->indexRelation) &&
+		IsWildcardIndexRelation(scan->indexRelation))
+	{
+		UpdatePathFilterForScan(scan);
+	}
 }
 
 
@@ -1075,6 +1253,11 @@ static int64
 extension_amgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 {
 	EnsureRumLibLoaded();
+	if (IsVoidPathFilterScan(scan))
+	{
+		return 0;
+	}
+
 	return extension_rumgetbitmap_core(scan, tbm, &rum_index_routine);
 }
 
@@ -1083,15 +1266,130 @@ int64
 extension_rumgetbitmap_core(IndexScanDesc scan, TIDBitmap *tbm,
 							IndexAmRoutine *coreRoutine)
 {
+	int64 numTuples;
 	if (IsCompositeOpClass(scan->indexRelation))
 	{
 		DocumentDBRumIndexState *outerScanState =
 			(DocumentDBRumIndexState *) scan->opaque;
-		return coreRoutine->amgetbitmap(outerScanState->innerScan, tbm);
+		numTuples = coreRoutine->amgetbitmap(outerScanState->innerScan, tbm);
+	}
+	else if (EnableRumRoaringBitmapIntersection && scan->numberOfKeys > 1 &&
+			 scan->numberOfOrderBys == 0)
+	{
+		numTuples = GetBitmapWithRoaringIntersection(scan, tbm, coreRoutine);
+	}
+	else
+	{
+		numTuples = coreRoutine->amgetbitmap(scan, tbm);
+	}
+
+	ReportKeysExamined(numTuples);
+	return numTuples;
+}
+
+
+/*
+ * Answers a bitmap scan with multiple scan keys by scanning each key on its
+ * own into a roaring bitmap, and intersecting the bitmaps before the tuples
+ * are handed to the TIDBitmap for the heap access. This trades the per item
+ * consistent checks of the core scan for the roaring container intersections,
+ * which wins when all keys match a large part of the index.
+ */
+static int64
+GetBitmapWithRoaringIntersection(IndexScanDesc scan, TIDBitmap *tbm,
+								 IndexAmRoutine *coreRoutine)
+{
+	/* On rescans, reuse the stats of the prior run of the scan */
+	RoaringIntersectionStats *stats = RoaringIntersectionStatsList;
+	while (stats != NULL && stats->scan != scan)
+	{
+		stats = stats->next;
+	}
+
+	if (stats == NULL)
+	{
+		stats = palloc0(sizeof(RoaringIntersectionStats));
+		stats->scan = scan;
+		stats->numKeys = scan->numberOfKeys;
+		stats->keyBitmapSizes = palloc0(sizeof(uint64) * scan->numberOfKeys);
+
+		stats->resetCallback.func = RemoveRoaringIntersectionStats;
+		stats->resetCallback.arg = stats;
+		MemoryContextRegisterResetCallback(CurrentMemoryContext, &stats->resetCallback);
+		stats->next = RoaringIntersectionStatsList;
+		RoaringIntersectionStatsList = stats;
 	}
 	else
 	{
-		return coreRoutine->amgetbitmap(scan, tbm);
+		memset(stats->keyBitmapSizes, 0, sizeof(uint64) * stats->numKeys);
+	}
+
+	instr_time intersectionTime;
+	INSTR_TIME_SET_ZERO(intersectionTime);
+
+	void *resultBitmap = NULL;
+	bool recheck = false;
+	for (int i = 0; i < scan->numberOfKeys; i++)
+	{
+		IndexScanDesc keyScan = coreRoutine->ambeginscan(scan->indexRelation, 1, 0);
+		keyScan->heapRelation = scan->heapRelation;
+		keyScan->xs_snapshot = scan->xs_snapshot;
+		coreRoutine->amrescan(keyScan, &scan->keyData[i], 1, NULL, 0);
+
+		void *keyBitmap = RoaringStateFuncs.createState();
+		while (coreRoutine->amgettuple(keyScan, ForwardScanDirection))
+		{
+			recheck = recheck || keyScan->xs_recheck;
+			RoaringStateFuncs.addItem(keyBitmap, &keyScan->xs_heaptid);
+		}
+
+		coreRoutine->amendscan(keyScan);
+		stats->keyBitmapSizes[i] = RoaringBitmapStateCardinality(keyBitmap);
+
+		if (resultBitmap == NULL)
+		{
+			resultBitmap = keyBitmap;
+		}
+		else
+		{
+			instr_time startTime, endTime;
+			INSTR_TIME_SET_CURRENT(startTime);
+			RoaringBitmapStateIntersect(resultBitmap, keyBitmap);
+			INSTR_TIME_SET_CURRENT(endTime);
+			INSTR_TIME_ACCUM_DIFF(intersectionTime, endTime, startTime);
+
+			RoaringStateFuncs.freeState(keyBitmap);
+		}
+
+		if (RoaringBitmapStateCardinality(resultBitmap) == 0)
+		{
+			/* Nothing left to intersect with */
+			break;
+		}
+	}
+
+	stats->resultSize = RoaringBitmapStateCardinality(resultBitmap);
+	stats->intersectionTimeMs = INSTR_TIME_GET_MILLISEC(intersectionTime);
+
+	int64 numTuples = RoaringBitmapStateAddToTidBitmap(resultBitmap, tbm, recheck);
+	RoaringStateFuncs.freeState(resultBitmap);
+	return numTuples;
+}
+
+
+static void
+RemoveRoaringIntersectionStats(void *arg)
+{
+	RoaringIntersectionStats **current = &RoaringIntersectionStatsList;
+	while (*current != NULL)
+	{
+		if (*current == (RoaringIntersectionStats *) arg)
+		{
+			*current = (*current)->next;
+			return;
+		}
+
+		current = &(*current)->next;
 	}
 }
 
@@ -1100,6 +1398,11 @@ static bool
 extension_amgettuple(IndexScanDesc scan, ScanDirection direction)
 {
 	EnsureRumLibLoaded();
+	if (IsVoidPathFilterScan(scan))
+	{
+		return false;
+	}
+
 	return extension_rumgettuple_core(scan, direction, &rum_index_routine);
 }
 
@@ -1112,6 +1415,7 @@ GetOneTupleCore(DocumentDBRumIndexState *outerScanState,
 	bool result = coreRoutine->amgettuple(outerScanState->innerScan, direction);
 	if (result)
 	{
+		ReportKeysExamined(1);
 		scan->xs_heaptid = outerScanState->innerScan->xs_heaptid;
 		scan->xs_recheck = outerScanState->innerScan->xs_recheck;
 		scan->xs_recheckorderby = outerScanState->innerScan->xs_recheckorderby;
@@ -1185,7 +1489,13 @@ extension_rumgettuple_core(IndexScanDesc scan, ScanDirection direction,
 	}
 	else
 	{
-		return coreRoutine->amgettuple(scan, direction);
+		bool result = coreRoutine->amgettuple(scan, direction);
+		if (result)
+		{
+			ReportKeysExamined(1);
+		}
+
+		return result;
 	}
 }
 
@@ -1198,10 +1508,28 @@ extension_rumbuild(Relation heapRelation,
 	EnsureRumLibLoaded();
 
 	bool amCanBuildParallel = true;
-	return extension_rumbuild_core(heapRelation, indexRelation,
-								   indexInfo, &rum_index_routine,
-								   rum_index_multi_key_update_func,
-								   amCanBuildParallel);
+	IndexBuildResult *result = extension_rumbuild_core(heapRelation, indexRelation,
+													   indexInfo, &rum_index_routine,
+													   rum_index_multi_key_update_func,
+													   amCanBuildParallel);
+
+	/*
+	 * Seed the path filter with a pass over the table: parallel build workers
+	 * insert through the core routine directly, so the paths can't be
+	 * collected as the tuples are built.
+	 */
+	if (EnableWildcardIndexPathFilter && rum_index_path_filter_update_func != NULL &&
+		IsWildcardIndexRelation(indexRelation))
+	{
+		uint8 *filter = palloc0(INDEX_PATH_FILTER_SIZE);
+		table_index_build_scan(heapRelation, indexRelation, indexInfo, false, false,
+							   BuildPathFilterCallback, filter, NULL);
+		rum_index_path_filter_update_func(indexRelation, filter,
+										  INDEX_PATH_FILTER_SIZE, true);
+		pfree(filter);
+	}
+
+	return result;
 }
 
 
@@ -1248,10 +1576,29 @@ extension_ruminsert(Relation indexRelation,
 {
 	EnsureRumLibLoaded();
 
-	return extension_ruminsert_core(indexRelation, values, isnull,
-									heap_tid, heapRelation, checkUnique,
-									indexUnchanged, indexInfo,
-									&rum_index_routine, rum_index_multi_key_update_func);
+	bool result = extension_ruminsert_core(indexRelation, values, isnull,
+										   heap_tid, heapRelation, checkUnique,
+										   indexUnchanged, indexInfo,
+										   &rum_index_routine,
+										   rum_index_multi_key_update_func);
+
+	/*
+	 * Keep the path filter a superset of the paths in the index. This does not
+	 * depend on the session setting so that the filter stays valid for sessions
+	 * that use it.
+	 */
+	if (rum_index_path_filter_get_func != NULL &&
+		IsWildcardIndexRelation(indexRelation) &&
+		rum_index_path_filter_get_func(indexRelation, NULL, INDEX_PATH_FILTER_SIZE))
+	{
+		uint8 *filter = palloc0(INDEX_PATH_FILTER_SIZE);
+		BuildPathFilterCallback(indexRelation, heap_tid, values, isnull, true, filter);
+		rum_index_path_filter_update_func(indexRelation, filter,
+										  INDEX_PATH_FILTER_SIZE, false);
+		pfree(filter);
+	}
+
+	return result;
 }
 
 
@@ -1281,6 +1628,157 @@ extension_ruminsert_core(Relation indexRelation,
 }
 
 
+static bool
+IsWildcardIndexOptions(bytea *indexOptions)
+{
+	BsonGinIndexOptionsBase *options = (BsonGinIndexOptionsBase *) indexOptions;
+	if (options == NULL)
+	{
+		return false;
+	}
+
+	return options->type == IndexOptionsType_Wildcard ||
+		   (options->type == IndexOptionsType_SinglePath &&
+			((BsonGinSinglePathOptions *) options)->isWildcard);
+}
+
+
+/*
+ * Returns true if any key column of the index is a wildcard index column.
+ */
+static bool
+IsWildcardIndexRelation(Relation indexRelation)
+{
+	bytea **indexOptions = RelationGetIndexAttOptions(indexRelation, false);
+	for (int i = 0; i < IndexRelationGetNumberOfKeyAttributes(indexRelation); i++)
+	{
+		if (IsWildcardIndexOptions(indexOptions[i]))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * Checks the scan keys of a scan on a wildcard index against the path filter
+ * of the index, and marks the scan as void if a key requires a path that no
+ * document in the index has.
+ */
+static void
+UpdatePathFilterForScan(IndexScanDesc scan)
+{
+	PathFilterScanState *state = PathFilterScanStateList;
+	while (state != NULL && state->scan != scan)
+	{
+		state = state->next;
+	}
+
+	if (state == NULL)
+	{
+		state = palloc0(sizeof(PathFilterScanState));
+		state->scan = scan;
+		state->filter = palloc(INDEX_PATH_FILTER_SIZE);
+		state->hasFilter = rum_index_path_filter_get_func(scan->indexRelation,
+														  state->filter,
+														  INDEX_PATH_FILTER_SIZE);
+
+		state->resetCallback.func = RemovePathFilterScanState;
+		state->resetCallback.arg = state;
+		MemoryContextRegisterResetCallback(CurrentMemoryContext, &state->resetCallback);
+		state->next = PathFilterScanStateList;
+		PathFilterScanStateList = state;
+	}
+
+	state->isVoidScan = false;
+	if (!state->hasFilter)
+	{
+		return;
+	}
+
+	bytea **indexOptions = RelationGetIndexAttOptions(scan->indexRelation, false);
+	for (int i = 0; i < scan->numberOfKeys; i++)
+	{
+		ScanKey key = &scan->keyData[i];
+		if (key->sk_flags & SK_ISNULL)
+		{
+			continue;
+		}
+
+		const char *path;
+		uint32_t pathLength;
+		if (GetWildcardIndexQueryRequiredPath(indexOptions[key->sk_attno - 1],
+											  key->sk_argument,
+											  (BsonIndexStrategy) key->sk_strategy,
+											  &path, &pathLength) &&
+			!IndexPathFilterMayContainPath(state->filter, path, pathLength))
+		{
+			state->isVoidScan = true;
+			return;
+		}
+	}
+}
+
+
+static bool
+IsVoidPathFilterScan(IndexScanDesc scan)
+{
+	PathFilterScanState *state = PathFilterScanStateList;
+	while (state != NULL)
+	{
+		if (state->scan == scan)
+		{
+			return state->isVoidScan;
+		}
+
+		state = state->next;
+	}
+
+	return false;
+}
+
+
+static void
+RemovePathFilterScanState(void *arg)
+{
+	PathFilterScanState **current = &PathFilterScanStateList;
+	while (*current != NULL)
+	{
+		if (*current == (PathFilterScanState *) arg)
+		{
+			*current = (*current)->next;
+			return;
+		}
+
+		current = &(*current)->next;
+	}
+}
+
+
+/*
+ * Adds the paths of the documents in the wildcard columns of an index tuple
+ * to the path filter passed in as the state.
+ */
+static void
+BuildPathFilterCallback(Relation index, ItemPointer tid, Datum *values,
+						bool *isnull, bool tupleIsAlive, void *state)
+{
+	uint8 *filter = (uint8 *) state;
+	bytea **indexOptions = RelationGetIndexAttOptions(index, false);
+	for (int i = 0; i < IndexRelationGetNumberOfKeyAttributes(index); i++)
+	{
+		if (isnull[i] || !IsWildcardIndexOptions(indexOptions[i]))
+		{
+			continue;
+		}
+
+		IndexPathFilterAddDocumentPaths(filter, DatumGetPgBson(values[i]));
+	}
+}
+
+
 static bool
 RumGetMultiKeyStatusSlow(Relation indexRelation)
 {
@@ -1417,4 +1915,27 @@ ExplainRegularIndexScan(IndexScanDesc scan, struct ExplainState *es)
 		/* See if there's a hook to explain more in this index */
 		TryExplainByIndexAm(scan, es);
 	}
+
+	for (RoaringIntersectionStats *stats = RoaringIntersectionStatsList; stats != NULL;
+		 stats = stats->next)
+	{
+		if (stats->scan != scan)
+		{
+			continue;
+		}
+
+		List *keyBitmapSizes = NIL;
+		for (int i = 0; i < stats->numKeys; i++)
+		{
+			keyBitmapSizes = lappend(keyBitmapSizes,
+									 psprintf(UINT64_FORMAT, stats->keyBitmapSizes[i]));
+		}
+
+		ExplainPropertyList("roaringKeyBitmapSizes", keyBitmapSizes, es);
+		ExplainPropertyInteger("roaringIntersectionSize", "tuples",
+							   (int64) stats->resultSize, es);
+		ExplainPropertyFloat("roaringIntersectionTime", "ms",
+							 stats->intersectionTimeMs, 3, es);
+		break;
+	}
 }
@@ -0,0 +1,325 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/infrastructure/command_activity.c
+ *
+ * Per backend slots in shared memory describing the command each backend
+ * is running.
+ *
+ * Each backend publishes the command name and namespace of the commands it
+ * starts into its own slot, so that currentOp can report them without
+ * parsing the query text of pg_stat_activity and looking up the collection
+ * of the locked tables.
+ *
+ * The slots also hold the documents and index keys examined by the command,
+ * which are logged along with the command when it runs for longer than the
+ * slow command threshold, and recorded in the slow command profile.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <miscadmin.h>
+#include <access/xact.h>
+#include <executor/instrument.h>
+#include <port/atomics.h>
+#include <storage/shmem.h>
+#if PG_VERSION_NUM >= 170000
+#include <storage/proc.h>
+#else
+#include <storage/backendid.h>
+#endif
+#include <utils/timestamp.h>
+
+#include "utils/command_activity.h"
+#include "utils/slow_command_profile.h"
+
+
+extern bool EnableCommandActivitySlots;
+extern int SlowCommandLogThresholdMs;
+
+static CommandActivitySlot *CommandActivitySlotArray = NULL;
+
+/* The command of the current backend, also copied to its slot if enabled */
+static CommandActivitySlot LocalCommandActivity = { 0 };
+
+/* Whether the current backend started a command in this transaction */
+static bool CommandActivityPublished = false;
+
+/* Whether the command was also published to the shared memory slot */
+static bool CommandActivityInSlot = false;
+
+/* The buffer usage of the backend when the command started */
+static BufferUsage CommandStartBufferUsage = { 0 };
+
+CommandExecutionCounters *CurrentCommandExecutionCounters =
+	&LocalCommandActivity.executionCounters;
+
+static inline volatile CommandActivitySlot * GetMyCommandActivitySlot(void);
+static void CopyTruncatedName(char *target, const char *source, size_t length,
+							  size_t maxLength);
+static void SetTempFileCounters(CommandExecutionCounters *counters);
+static void LogSlowCommand(int64 durationMs);
+
+
+Size
+CommandActivityShmemSize(void)
+{
+	return mul_size(sizeof(CommandActivitySlot), MaxBackends);
+}
+
+
+/*
+ * InitializeCommandActivityShmem initializes the shared memory slots of
+ * the commands run by every backend.
+ */
+void
+InitializeCommandActivityShmem(void)
+{
+	bool found;
+
+	size_t shmemSize = CommandActivityShmemSize();
+	CommandActivitySlotArray = (CommandActivitySlot *)
+							   ShmemInitStruct("Command Activity Slots",
+											   shmemSize, &found);
+
+	if (!found)
+	{
+		MemSet(CommandActivitySlotArray, 0, shmemSize);
+	}
+}
+
+
+/*
+ * PublishCommandActivity records the command that the current backend starts
+ * and resets its execution counters. The command name and the collection are
+ * the first field of the command spec and its value (e.g. { "find": "coll" }).
+ */
+void
+PublishCommandActivity(const char *opType, text *databaseName, pgbson *commandSpec)
+{
+	const char *commandName = "";
+	uint32_t commandNameLength = 0;
+	const char *collectionName = "";
+	uint32_t collectionNameLength = 0;
+
+	bson_iter_t specIter;
+	PgbsonInitIterator(commandSpec, &specIter);
+	if (bson_iter_next(&specIter))
+	{
+		commandName = bson_iter_key(&specIter);
+		commandNameLength = bson_iter_key_len(&specIter);
+		if (BSON_ITER_HOLDS_UTF8(&specIter))
+		{
+			collectionName = bson_iter_utf8(&specIter, &collectionNameLength);
+		}
+	}
+
+	CommandActivitySlot *activity = &LocalCommandActivity;
+	activity->pid = MyProcPid;
+	activity->commandStartTime = GetCurrentStatementStartTimestamp();
+	CopyTruncatedName(activity->opType, opType, strlen(opType),
+					  COMMAND_ACTIVITY_NAME_LENGTH);
+	CopyTruncatedName(activity->commandName, commandName, commandNameLength,
+					  COMMAND_ACTIVITY_NAME_LENGTH);
+	CopyTruncatedName(activity->databaseName, VARDATA_ANY(databaseName),
+					  VARSIZE_ANY_EXHDR(databaseName), MAX_DATABASE_NAME_LENGTH);
+	CopyTruncatedName(activity->collectionName, collectionName, collectionNameLength,
+					  MAX_COLLECTION_NAME_LENGTH);
+	activity->executionCounters.docsExamined = 0;
+	activity->executionCounters.keysExamined = 0;
+	activity->executionCounters.keysInserted = 0;
+	activity->executionCounters.tempBytesWritten = 0;
+	activity->executionCounters.tempBytesRead = 0;
+	CommandStartBufferUsage = pgBufferUsage;
+
+	StartSlowCommandProfile(commandSpec);
+
+	CommandActivityPublished = true;
+	CommandActivityInSlot = EnableCommandActivitySlots &&
+							CommandActivitySlotArray != NULL;
+	if (!CommandActivityInSlot)
+	{
+		CurrentCommandExecutionCounters = &activity->executionCounters;
+		return;
+	}
+
+	volatile CommandActivitySlot *slot = GetMyCommandActivitySlot();
+	uint32 changeCount = slot->changeCount;
+
+	slot->changeCount = changeCount + 1;
+	pg_write_barrier();
+
+	activity->changeCount = changeCount + 1;
+	memcpy((CommandActivitySlot *) slot, activity, sizeof(CommandActivitySlot));
+
+	pg_write_barrier();
+	slot->changeCount = changeCount + 2;
+
+	CurrentCommandExecutionCounters =
+		(CommandExecutionCounters *) &slot->executionCounters;
+}
+
+
+/*
+ * ClearCommandActivity ends the command of the current backend once its
+ * transaction ends: it is logged and profiled if it ran longer than the slow
+ * command thresholds and its slot is marked as unused.
+ */
+void
+ClearCommandActivity(void)
+{
+	if (!CommandActivityPublished)
+	{
+		return;
+	}
+
+	if (SlowCommandLogThresholdMs >= 0 || CurrentCommandProfiled)
+	{
+		int64 durationMs = TimestampDifferenceMilliseconds(
+			LocalCommandActivity.commandStartTime, GetCurrentTimestamp());
+
+		SetTempFileCounters(CurrentCommandExecutionCounters);
+		LogSlowCommand(durationMs);
+		RecordSlowCommandProfile(&LocalCommandActivity,
+								 CurrentCommandExecutionCounters, durationMs);
+	}
+
+	if (CommandActivityInSlot)
+	{
+		volatile CommandActivitySlot *slot = GetMyCommandActivitySlot();
+
+		slot->changeCount++;
+		pg_write_barrier();
+		slot->pid = 0;
+		pg_write_barrier();
+		slot->changeCount++;
+	}
+
+	CommandActivityPublished = false;
+	CommandActivityInSlot = false;
+	CurrentCommandExecutionCounters = &LocalCommandActivity.executionCounters;
+}
+
+
+/*
+ * GetCommandActivitySnapshot returns a hash table of consistent copies of
+ * the slots in use, keyed by the pid of their backend.
+ */
+HTAB *
+GetCommandActivitySnapshot(void)
+{
+	HASHCTL hashInfo = { 0 };
+	hashInfo.keysize = sizeof(int);
+	hashInfo.entrysize = sizeof(CommandActivitySlot);
+	hashInfo.hcxt = CurrentMemoryContext;
+	HTAB *activities = hash_create("Command Activity Snapshot", 32, &hashInfo,
+								   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	if (CommandActivitySlotArray == NULL)
+	{
+		return activities;
+	}
+
+	for (int i = 0; i < MaxBackends; i++)
+	{
+		volatile CommandActivitySlot *slot = &CommandActivitySlotArray[i];
+		CommandActivitySlot copy;
+
+		/* Same protocol as pgstat_read_current_status */
+		for (;;)
+		{
+			uint32 beforeChangeCount = slot->changeCount;
+			pg_read_barrier();
+
+			memcpy(&copy, (CommandActivitySlot *) slot, sizeof(CommandActivitySlot));
+
+			pg_read_barrier();
+			uint32 afterChangeCount = slot->changeCount;
+			if (beforeChangeCount == afterChangeCount &&
+				(beforeChangeCount & 1) == 0)
+			{
+				break;
+			}
+
+			CHECK_FOR_INTERRUPTS();
+		}
+
+		if (copy.pid == 0)
+		{
+			continue;
+		}
+
+		bool found;
+		CommandActivitySlot *entry = hash_search(activities, &copy.pid, HASH_ENTER,
+												 &found);
+		*entry = copy;
+	}
+
+	return activities;
+}
+
+
+static inline volatile CommandActivitySlot *
+GetMyCommandActivitySlot(void)
+{
+#if PG_VERSION_NUM >= 170000
+	return &CommandActivitySlotArray[MyProcNumber];
+#else
+	return &CommandActivitySlotArray[MyBackendId - 1];
+#endif
+}
+
+
+static void
+CopyTruncatedName(char *target, const char *source, size_t length, size_t maxLength)
+{
+	size_t copyLength = Min(length, maxLength - 1);
+	memcpy(target, source, copyLength);
+	target[copyLength] = '\0';
+}
+
+
+/*
+ * Sets the temporary file bytes of the command from the growth of the buffer
+ * usage of the backend, which includes the usage of its parallel workers.
+ */
+static void
+SetTempFileCounters(CommandExecutionCounters *counters)
+{
+	int64 blocksWritten = pgBufferUsage.temp_blks_written -
+						  CommandStartBufferUsage.temp_blks_written;
+	int64 blocksRead = pgBufferUsage.temp_blks_read -
+					   CommandStartBufferUsage.temp_blks_read;
+
+	counters->tempBytesWritten = (uint64) Max(blocksWritten, 0) * BLCKSZ;
+	counters->tempBytesRead = (uint64) Max(blocksRead, 0) * BLCKSZ;
+}
+
+
+/*
+ * Logs the command of the current backend along with its execution counters
+ * if it ran for longer than documentdb.slowCommandLogThresholdMS.
+ */
+static void
+LogSlowCommand(int64 durationMs)
+{
+	if (SlowCommandLogThresholdMs < 0 || durationMs < SlowCommandLogThresholdMs)
+	{
+		return;
+	}
+
+	CommandExecutionCounters *counters = CurrentCommandExecutionCounters;
+	ereport(LOG, (errmsg("slow command %s on %s.%s took " INT64_FORMAT " ms, "
+						 "docsExamined: " UINT64_FORMAT ", keysExamined: "
+						 UINT64_FORMAT ", keysInserted: " UINT64_FORMAT
+						 ", tempBytesWritten: " UINT64_FORMAT
+						 ", tempBytesRead: " UINT64_FORMAT,
+						 LocalCommandActivity.commandName,
+						 LocalCommandActivity.databaseName,
+						 LocalCommandActivity.collectionName,
+						 durationMs, counters->docsExamined,
+						 counters->keysExamined, counters->keysInserted,
+						 counters->tempBytesWritten,
+						 counters->tempBytesRead),
+				  errhidestmt(true)));
+}
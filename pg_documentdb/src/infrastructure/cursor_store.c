@@ -14,6 +14,14 @@
  * There is also a background job that cleans up the cursor files after
  * a certain expiry time limit.
  *
+ * The file is written as a sequence of blocks. Each block has a
+ * CursorFileBlockHeader followed by the (optionally compressed) block
+ * payload. The payload holds whole documents each padded to MAXALIGN so
+ * that readers can hand out documents that point straight into the
+ * block (or into a read-only mapping of the file for uncompressed blocks)
+ * without copying them out first. The continuation state tracks the
+ * block's file offset and the offset of the next document in the block.
+ *
  *-------------------------------------------------------------------------
  */
 
@@ -36,7 +44,13 @@
 #endif
 #include <utils/backend_status.h>
 
+#include <common/pg_lzcompress.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
@@ -51,6 +65,9 @@ extern bool UseFileBasedPersistedCursors;
 extern int MaxAllowedCursorIntermediateFileSizeMB;
 extern int DefaultCursorExpiryTimeLimitSeconds;
 extern int MaxCursorFileCount;
+extern int CursorFileBlockSizeKB;
+extern bool EnableCursorFileCompression;
+extern bool EnableCursorFileMemoryMap;
 
 
 /*
@@ -62,13 +79,52 @@ typedef struct SerializedCursorState
 	/* The name of the file in the cursor directory */
 	char cursorFileName[NAMEDATALEN];
 
-	/* The offset into the file */
+	/* The offset into the file (of the block holding the next document on reads) */
 	uint32_t file_offset;
 
 	/* The total file length (updated during writes) */
 	uint32_t file_length;
+
+	/* The offset of the next document within the uncompressed block */
+	uint32_t block_offset;
 } SerializedCursorState;
 
+
+/*
+ * The compression applied to the payload of a cursor file block.
+ */
+typedef enum CursorFileBlockCompression
+{
+	CursorFileBlockCompression_None = 0,
+
+	CursorFileBlockCompression_Pglz = 1,
+
+	CursorFileBlockCompression_Lz4 = 2,
+} CursorFileBlockCompression;
+
+
+/*
+ * The header written ahead of every block in the cursor file.
+ * This is kept at MAXALIGN size so that the payload following it
+ * stays aligned both in the read buffers and in the file mapping.
+ */
+typedef struct CursorFileBlockHeader
+{
+	/* The number of payload bytes stored in the file (excluding padding) */
+	uint32_t storedLength;
+
+	/* The number of payload bytes once decompressed */
+	uint32_t rawLength;
+
+	/* The number of documents in the block */
+	uint32_t documentCount;
+
+	/* The CursorFileBlockCompression of the payload */
+	uint32_t compression;
+} CursorFileBlockHeader;
+
+#define CURSOR_FILE_BLOCK_HEADER_SIZE MAXALIGN(sizeof(CursorFileBlockHeader))
+
 typedef struct CursorFileState
 {
 	/* The serialized cursor state (see above) */
@@ -80,16 +136,38 @@ typedef struct CursorFileState
 	/* Whether or not we're in R/W mode or R/O mode */
 	bool isReadWrite;
 
-	/* Temporary in-memory buffer for the cursor contents */
-	PGAlignedBlock buffer;
+	/*
+	 * Temporary in-memory buffer for the block being written, or for the
+	 * decompressed/read block in read mode. The first CURSOR_FILE_BLOCK_HEADER_SIZE
+	 * bytes are reserved for the block header.
+	 */
+	char *blockBuffer;
+	uint32_t blockBufferSize;
+
+	/* Buffer for compressed block payloads */
+	char *compressBuffer;
+	uint32_t compressBufferSize;
+
+	/* The payload of the block currently read (in the block buffer or the mapping) */
+	char *blockData;
+
+	/* Number of bytes in the block payload that are valid (used in reads) */
+	uint32_t blockLength;
+
+	/* Position into the block payload currently written/read */
+	uint32_t pos;
 
-	/* Position into the buffer currently written/read */
-	int pos;
+	/* Number of documents written into the current block */
+	uint32_t documentCount;
 
-	/* Number of bytes in buffer that are valid (used in reads) */
-	int nbytes;
+	/* In read mode - the file offset of the current block and the one after it */
+	uint32_t blockFileOffset;
+	uint32_t nextBlockFileOffset;
+	bool blockLoaded;
 
-	uint32_t next_offset;
+	/* In read mode - the read-only mapping of the cursor file if one was made */
+	char *mapping;
+	Size mappingLength;
 
 	/* In read more - whether or not the cursor is complete */
 	bool cursorComplete;
@@ -121,7 +199,18 @@ PG_FUNCTION_INFO_V1(cursor_directory_cleanup);
 
 
 static void FlushBuffer(CursorFileState *cursorFileState);
-static bool FillBuffer(CursorFileState *cursorFileState, char *buffer, int32_t length);
+static bool LoadCursorFileBlock(CursorFileState *cursorFileState);
+static void ReadCursorFileBytes(CursorFileState *cursorFileState, char *buffer,
+								uint32_t length, uint32_t offset);
+static int32_t CompressCursorFileBlock(CursorFileState *cursorFileState,
+									   uint32_t *compression);
+static void DecompressCursorFileBlock(CursorFileState *cursorFileState,
+									  CursorFileBlockHeader *header,
+									  const char *storedData);
+static void EnsureCursorBufferSize(CursorFileState *cursorFileState, char **buffer,
+								   uint32_t *bufferSize, uint32_t requiredSize);
+static void MapCursorFile(CursorFileState *cursorFileState);
+static void UnmapCursorFile(CursorFileState *cursorFileState);
 
 static void DecrementCursorCount(void);
 static bool IncrementCursorCount(void);
@@ -133,6 +222,10 @@ static int64_t TryDeleteCursorFile(struct dirent *de, int64_t expirtyTimeLimitSe
 static CursorStoreSharedData *CursorStoreSharedState = NULL;
 static char PendingCursorFile[NAMEDATALEN] = { 0 };
 
+/* The mapping of the cursor file being read - released on transaction abort */
+static char *PendingCursorMapping = NULL;
+static Size PendingCursorMappingLength = 0;
+
 /* Whether or not the cursor_set has been initialized during shared startup */
 static bool cursor_set_initialized = false;
 
@@ -324,49 +417,39 @@ CreateCursorFile(const char *cursorName)
 
 /*
  * Given a cursor file that is created, writes a given document to that
- * cursor file. The file is written as
- * <length><document> where length is the size of the pgbson including the
- * varlen header.
- * The data is buffered in memory and flushed every BLCKSZ bytes.
+ * cursor file. The document is appended to the current block as is
+ * (including its varlena header) and padded to MAXALIGN.
+ * The block is flushed once it reaches cursorFileBlockSizeKB; documents
+ * are never split across blocks so a large document may produce a larger block.
  */
 void
 WriteToCursorFile(CursorFileState *cursorFileState, pgbson *dataBson)
 {
-	int32_t sizeRemaining = BLCKSZ - cursorFileState->pos;
+	uint32_t dataSize = VARSIZE_ANY(dataBson);
+	uint32_t alignedSize = MAXALIGN(dataSize);
+	uint32_t blockSize = ((uint32_t) CursorFileBlockSizeKB) * 1024;
 
-	/* We don't have enough to write even the length - flush the buffer */
-	if (sizeRemaining < 4)
+	/* The document doesn't fit in the current block - flush the block */
+	if (cursorFileState->pos > 0 && cursorFileState->pos + alignedSize > blockSize)
 	{
 		FlushBuffer(cursorFileState);
 	}
 
-	int32_t dataSize = VARSIZE(dataBson);
-	char *data = (char *) dataBson;
-
-	/* Write the length to the buffer */
-	memcpy(cursorFileState->buffer.data + cursorFileState->pos, &dataSize, 4);
-	cursorFileState->pos += 4;
+	EnsureCursorBufferSize(cursorFileState, &cursorFileState->blockBuffer,
+						   &cursorFileState->blockBufferSize,
+						   CURSOR_FILE_BLOCK_HEADER_SIZE +
+						   Max(blockSize, cursorFileState->pos + alignedSize));
 
-	/* Now write the file into the buffer and then write it out to the file */
-	while (dataSize > 0)
+	char *target = cursorFileState->blockBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE +
+				   cursorFileState->pos;
+	memcpy(target, dataBson, dataSize);
+	if (alignedSize > dataSize)
 	{
-		sizeRemaining = BLCKSZ - cursorFileState->pos;
-		if (sizeRemaining >= dataSize)
-		{
-			memcpy(cursorFileState->buffer.data + cursorFileState->pos, data, dataSize);
-			cursorFileState->pos += dataSize;
-			break;
-		}
-		else
-		{
-			memcpy(cursorFileState->buffer.data + cursorFileState->pos, data,
-				   sizeRemaining);
-			cursorFileState->pos += sizeRemaining;
-			data += sizeRemaining;
-			dataSize -= sizeRemaining;
-			FlushBuffer(cursorFileState);
-		}
+		memset(target + dataSize, 0, alignedSize - dataSize);
 	}
+
+	cursorFileState->pos += alignedSize;
+	cursorFileState->documentCount++;
 }
 
 
@@ -390,6 +473,13 @@ GetCurrentCursorCount(int32_t *currentCursorCount, int32_t *measuredCursorCount,
 void
 DeletePendingCursorFiles(void)
 {
+	if (PendingCursorMapping != NULL)
+	{
+		munmap(PendingCursorMapping, PendingCursorMappingLength);
+		PendingCursorMapping = NULL;
+		PendingCursorMappingLength = 0;
+	}
+
 	if (!UseFileBasedPersistedCursors || !cursor_set_initialized)
 	{
 		return;
@@ -452,12 +542,19 @@ DeserializeFileState(bytea *cursorFileState)
 		ereport(ERROR, (errmsg("File based cursor is not enabled")));
 	}
 
+	if (VARSIZE(cursorFileState) != sizeof(SerializedCursorState) + VARHDRSZ)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_CURSORNOTFOUND),
+						errmsg("Cursor could not be located")));
+	}
+
 	CursorFileState *fileState = palloc0(sizeof(CursorFileState));
 	fileState->cursorState = *(SerializedCursorState *) VARDATA(cursorFileState);
 	fileState->bufFile = PathNameOpenTemporaryFile(fileState->cursorState.cursorFileName,
 												   O_RDONLY | PG_BINARY | O_EXCL);
 	fileState->isReadWrite = false;
-	fileState->next_offset = fileState->cursorState.file_offset;
+	fileState->blockFileOffset = fileState->cursorState.file_offset;
+	fileState->pos = fileState->cursorState.block_offset;
 
 	if (fileState->bufFile < 0 && errno == ENOENT)
 	{
@@ -474,6 +571,12 @@ DeserializeFileState(bytea *cursorFileState)
 
 	/* Register the cursor file for transaction abort */
 	strncpy(PendingCursorFile, fileState->cursorState.cursorFileName, NAMEDATALEN);
+
+	if (EnableCursorFileMemoryMap)
+	{
+		MapCursorFile(fileState);
+	}
+
 	return fileState;
 }
 
@@ -481,7 +584,9 @@ DeserializeFileState(bytea *cursorFileState)
 /*
  * Given a cursor file state, reads the next document from the
  * cursor file. The file is expected to be in the cursor directory.
- * Blocks are pre-buffered in BLCKSZ chunks.
+ * The returned document points into the current block (or the file
+ * mapping) and is only valid until the next call to ReadFromCursorFile
+ * or until the cursor file state is closed - callers must not free it.
  *
  * Also updates the flush state of the cursor file state based on the
  * prior value read. This ensures that if we return a document, that we
@@ -490,26 +595,47 @@ DeserializeFileState(bytea *cursorFileState)
 pgbson *
 ReadFromCursorFile(CursorFileState *cursorFileState)
 {
-	/* First step, advance the file stream forward with what was buffered before */
-	cursorFileState->cursorState.file_offset = cursorFileState->next_offset;
+	/* First step, advance the file stream forward with what was returned before */
+	cursorFileState->cursorState.file_offset = cursorFileState->blockFileOffset;
+	cursorFileState->cursorState.block_offset = cursorFileState->pos;
 
-	int32_t length = 0;
-	if (!FillBuffer(cursorFileState, (char *) &length, 4))
+	while (!cursorFileState->blockLoaded ||
+		   cursorFileState->pos >= cursorFileState->blockLength)
 	{
-		return NULL;
+		if (cursorFileState->blockLoaded)
+		{
+			cursorFileState->blockFileOffset = cursorFileState->nextBlockFileOffset;
+			cursorFileState->pos = 0;
+		}
+
+		if (!LoadCursorFileBlock(cursorFileState))
+		{
+			/* There's no more blocks left */
+			cursorFileState->cursorComplete = true;
+			return NULL;
+		}
 	}
 
-	if ((Size) length > BSON_MAX_SIZE)
+	pgbson *bson = (pgbson *) (cursorFileState->blockData + cursorFileState->pos);
+	Size length = VARSIZE_ANY(bson);
+	if (length > BSON_MAX_SIZE ||
+		length > cursorFileState->blockLength - cursorFileState->pos)
 	{
 		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
-						errmsg("Invalid BSON size in cursor file %d", length)));
+						errmsg("Invalid BSON size in cursor file %zu", length)));
 	}
 
-	pgbson *bson = palloc(length);
-	if (!FillBuffer(cursorFileState, (char *) bson, length))
+	cursorFileState->pos += MAXALIGN(length);
+	if (cursorFileState->pos >= cursorFileState->blockLength)
 	{
-		pfree(bson);
-		return NULL;
+		/*
+		 * Move past the exhausted block so that the continuation points at
+		 * the start of the next block. The block contents stay valid until
+		 * the next read loads the following block.
+		 */
+		cursorFileState->blockFileOffset = cursorFileState->nextBlockFileOffset;
+		cursorFileState->pos = 0;
+		cursorFileState->blockLoaded = false;
 	}
 
 	return bson;
@@ -517,85 +643,357 @@ ReadFromCursorFile(CursorFileState *cursorFileState)
 
 
 /*
- * Fills the specified buffer with length bytes from the cursor file.
+ * Loads the block at blockFileOffset of the cursor file into the
+ * cursor file state. Uncompressed blocks of a mapped file are served
+ * directly from the mapping, otherwise the block is read (and decompressed)
+ * into the block buffer.
  * returns false if the end of the file is reached.
  */
 static bool
-FillBuffer(CursorFileState *cursorFileState, char *buffer, int32_t length)
+LoadCursorFileBlock(CursorFileState *cursorFileState)
+{
+	uint32_t offset = cursorFileState->blockFileOffset;
+	uint32_t fileLength = cursorFileState->cursorState.file_length;
+	if (offset >= fileLength)
+	{
+		return false;
+	}
+
+	if (fileLength - offset < CURSOR_FILE_BLOCK_HEADER_SIZE)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Invalid block header in cursor file at offset %u",
+							   offset)));
+	}
+
+	CursorFileBlockHeader header;
+	if (cursorFileState->mapping != NULL)
+	{
+		memcpy(&header, cursorFileState->mapping + offset, sizeof(CursorFileBlockHeader));
+	}
+	else
+	{
+		ReadCursorFileBytes(cursorFileState, (char *) &header,
+							sizeof(CursorFileBlockHeader), offset);
+	}
+
+	uint32_t payloadOffset = offset + CURSOR_FILE_BLOCK_HEADER_SIZE;
+	if (header.storedLength > fileLength - payloadOffset ||
+		header.rawLength > MaxAllocSize - CURSOR_FILE_BLOCK_HEADER_SIZE ||
+		(header.compression == CursorFileBlockCompression_None &&
+		 header.storedLength != header.rawLength))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Invalid block header in cursor file at offset %u",
+							   offset)));
+	}
+
+	const char *storedData;
+	if (cursorFileState->mapping != NULL)
+	{
+		storedData = cursorFileState->mapping + payloadOffset;
+	}
+	else if (header.compression == CursorFileBlockCompression_None)
+	{
+		EnsureCursorBufferSize(cursorFileState, &cursorFileState->blockBuffer,
+							   &cursorFileState->blockBufferSize,
+							   CURSOR_FILE_BLOCK_HEADER_SIZE + header.storedLength);
+		ReadCursorFileBytes(cursorFileState,
+							cursorFileState->blockBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE,
+							header.storedLength, payloadOffset);
+		storedData = cursorFileState->blockBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE;
+	}
+	else
+	{
+		EnsureCursorBufferSize(cursorFileState, &cursorFileState->compressBuffer,
+							   &cursorFileState->compressBufferSize,
+							   CURSOR_FILE_BLOCK_HEADER_SIZE + header.storedLength);
+		ReadCursorFileBytes(cursorFileState,
+							cursorFileState->compressBuffer +
+							CURSOR_FILE_BLOCK_HEADER_SIZE,
+							header.storedLength, payloadOffset);
+		storedData = cursorFileState->compressBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE;
+	}
+
+	if (header.compression == CursorFileBlockCompression_None)
+	{
+		cursorFileState->blockData = (char *) storedData;
+	}
+	else
+	{
+		DecompressCursorFileBlock(cursorFileState, &header, storedData);
+		cursorFileState->blockData = cursorFileState->blockBuffer +
+									 CURSOR_FILE_BLOCK_HEADER_SIZE;
+	}
+
+	cursorFileState->blockLength = header.rawLength;
+	cursorFileState->nextBlockFileOffset = payloadOffset + MAXALIGN(header.storedLength);
+	cursorFileState->blockLoaded = true;
+	return true;
+}
+
+
+/*
+ * Reads exactly length bytes at the given offset of the cursor file.
+ */
+static void
+ReadCursorFileBytes(CursorFileState *cursorFileState, char *buffer, uint32_t length,
+					uint32_t offset)
+{
+	int bytesRead = FileRead(cursorFileState->bufFile, buffer, length, offset,
+							 WAIT_EVENT_BUFFILE_READ);
+	if (bytesRead < 0)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("Failed to read file \"%s\": %m",
+						cursorFileState->cursorState.cursorFileName)));
+	}
+	else if ((uint32_t) bytesRead != length)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Unexpected end of cursor file at offset %u", offset)));
+	}
+}
+
+
+/*
+ * Decompresses the stored payload of a block into the block buffer.
+ */
+static void
+DecompressCursorFileBlock(CursorFileState *cursorFileState,
+						  CursorFileBlockHeader *header, const char *storedData)
 {
-	while (length > 0)
+	EnsureCursorBufferSize(cursorFileState, &cursorFileState->blockBuffer,
+						   &cursorFileState->blockBufferSize,
+						   CURSOR_FILE_BLOCK_HEADER_SIZE + header->rawLength);
+	char *target = cursorFileState->blockBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE;
+
+	int32_t rawLength = -1;
+	switch (header->compression)
 	{
-		if (cursorFileState->nbytes == 0)
+		case CursorFileBlockCompression_Pglz:
 		{
-			int bytesRead = FileRead(cursorFileState->bufFile,
-									 cursorFileState->buffer.data, BLCKSZ,
-									 cursorFileState->next_offset,
-									 WAIT_EVENT_BUFFILE_READ);
-			cursorFileState->nbytes += bytesRead;
-			cursorFileState->pos = 0;
-			if (bytesRead == 0)
-			{
-				/* There's no more bytes left */
-				cursorFileState->cursorComplete = true;
-				return false;
-			}
+			bool checkComplete = true;
+			rawLength = pglz_decompress(storedData, header->storedLength, target,
+										header->rawLength, checkComplete);
+			break;
 		}
 
-		int32_t currentAvailable = cursorFileState->nbytes - cursorFileState->pos;
-		if (currentAvailable >= length)
+#ifdef USE_LZ4
+		case CursorFileBlockCompression_Lz4:
 		{
-			memcpy(buffer, cursorFileState->buffer.data + cursorFileState->pos, length);
-			cursorFileState->pos += length;
-			cursorFileState->next_offset += length;
-			return true;
+			rawLength = LZ4_decompress_safe(storedData, target, header->storedLength,
+											header->rawLength);
+			break;
 		}
+#endif
 
-		memcpy(buffer, cursorFileState->buffer.data + cursorFileState->pos,
-			   currentAvailable);
+		default:
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+							errmsg("Unsupported compression %u in cursor file",
+								   header->compression)));
+		}
+	}
 
-		cursorFileState->pos = cursorFileState->nbytes = 0;
-		cursorFileState->next_offset += currentAvailable;
-		buffer += currentAvailable;
-		length -= currentAvailable;
+	if (rawLength < 0 || (uint32_t) rawLength != header->rawLength)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Failed to decompress block in cursor file")));
 	}
+}
 
-	return true;
+
+/*
+ * Compresses the pending block payload into the compress buffer.
+ * Uses LZ4 when the server is built with it and pglz otherwise.
+ * returns the compressed length, or -1 if the block is not worth compressing.
+ */
+static int32_t
+CompressCursorFileBlock(CursorFileState *cursorFileState, uint32_t *compression)
+{
+	const char *source = cursorFileState->blockBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE;
+	int32_t sourceLength = (int32_t) cursorFileState->pos;
+
+#ifdef USE_LZ4
+	int32_t maxLength = LZ4_compressBound(sourceLength);
+#else
+	int32_t maxLength = PGLZ_MAX_OUTPUT(sourceLength);
+#endif
+
+	EnsureCursorBufferSize(cursorFileState, &cursorFileState->compressBuffer,
+						   &cursorFileState->compressBufferSize,
+						   CURSOR_FILE_BLOCK_HEADER_SIZE + MAXALIGN(maxLength));
+	char *target = cursorFileState->compressBuffer + CURSOR_FILE_BLOCK_HEADER_SIZE;
+
+#ifdef USE_LZ4
+	int32_t compressedLength = LZ4_compress_default(source, target, sourceLength,
+													maxLength);
+	*compression = CursorFileBlockCompression_Lz4;
+#else
+	int32_t compressedLength = pglz_compress(source, sourceLength, target,
+											 PGLZ_strategy_default);
+	*compression = CursorFileBlockCompression_Pglz;
+#endif
+
+	if (compressedLength <= 0 || compressedLength >= sourceLength)
+	{
+		return -1;
+	}
+
+	/* Zero the alignment padding so the file contents are deterministic */
+	memset(target + compressedLength, 0,
+		   MAXALIGN(compressedLength) - compressedLength);
+	return compressedLength;
+}
+
+
+/*
+ * Ensures the given buffer of the cursor file state can hold requiredSize bytes.
+ * Buffers are allocated in the same memory context as the cursor file state.
+ */
+static void
+EnsureCursorBufferSize(CursorFileState *cursorFileState, char **buffer,
+					   uint32_t *bufferSize, uint32_t requiredSize)
+{
+	if (*bufferSize >= requiredSize)
+	{
+		return;
+	}
+
+	uint32_t newSize = Max(requiredSize, *bufferSize * 2);
+	if (*buffer == NULL)
+	{
+		*buffer = MemoryContextAlloc(GetMemoryChunkContext(cursorFileState), newSize);
+	}
+	else
+	{
+		*buffer = repalloc(*buffer, newSize);
+	}
+
+	*bufferSize = newSize;
 }
 
 
 /*
- * Writes whatever bytes have been filed into the buffer to the
- * cursor file. This is called when the buffer is full or
- * when the cursor file is closed.
+ * Maps the cursor file read-only so that uncompressed blocks can be
+ * served without copying them into the block buffer. If the mapping
+ * fails, reads fall back to the buffered FileRead path.
+ */
+static void
+MapCursorFile(CursorFileState *cursorFileState)
+{
+	Size fileLength = cursorFileState->cursorState.file_length;
+	if (fileLength == 0)
+	{
+		return;
+	}
+
+	void *mapping = mmap(NULL, fileLength, PROT_READ, MAP_PRIVATE,
+						 FileGetRawDesc(cursorFileState->bufFile), 0);
+	if (mapping == MAP_FAILED)
+	{
+		ereport(DEBUG1, (errmsg("Failed to map cursor file \"%s\": %m",
+								cursorFileState->cursorState.cursorFileName)));
+		return;
+	}
+
+#ifdef MADV_SEQUENTIAL
+	madvise(mapping, fileLength, MADV_SEQUENTIAL);
+#endif
+
+	cursorFileState->mapping = mapping;
+	cursorFileState->mappingLength = fileLength;
+
+	/* Register the mapping for transaction abort */
+	PendingCursorMapping = mapping;
+	PendingCursorMappingLength = fileLength;
+}
+
+
+static void
+UnmapCursorFile(CursorFileState *cursorFileState)
+{
+	if (cursorFileState->mapping == NULL)
+	{
+		return;
+	}
+
+	munmap(cursorFileState->mapping, cursorFileState->mappingLength);
+	if (PendingCursorMapping == cursorFileState->mapping)
+	{
+		PendingCursorMapping = NULL;
+		PendingCursorMappingLength = 0;
+	}
+
+	cursorFileState->mapping = NULL;
+	cursorFileState->mappingLength = 0;
+	cursorFileState->blockData = NULL;
+	cursorFileState->blockLoaded = false;
+}
+
+
+/*
+ * Writes the pending block, prefixed by its header, to the
+ * cursor file. The payload is compressed if enabled and worthwhile.
+ * This is called when the block is full or when the cursor file is closed.
  */
 static void
 FlushBuffer(CursorFileState *cursorFileState)
 {
-	if (cursorFileState->pos > 0)
+	if (cursorFileState->pos == 0)
 	{
-		int bytesWritten = FileWrite(cursorFileState->bufFile,
-									 cursorFileState->buffer.data, cursorFileState->pos,
-									 cursorFileState->cursorState.file_offset,
-									 WAIT_EVENT_BUFFILE_WRITE);
+		return;
+	}
+
+	CursorFileBlockHeader header = {
+		.storedLength = cursorFileState->pos,
+		.rawLength = cursorFileState->pos,
+		.documentCount = cursorFileState->documentCount,
+		.compression = CursorFileBlockCompression_None
+	};
 
-		if (bytesWritten != cursorFileState->pos)
+	char *blockToWrite = cursorFileState->blockBuffer;
+	if (EnableCursorFileCompression)
+	{
+		uint32_t compression = CursorFileBlockCompression_None;
+		int32_t compressedLength = CompressCursorFileBlock(cursorFileState,
+														   &compression);
+		if (compressedLength > 0)
 		{
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("Failed to save data to file")));
+			header.storedLength = compressedLength;
+			header.compression = compression;
+			blockToWrite = cursorFileState->compressBuffer;
 		}
+	}
 
-		cursorFileState->cursorState.file_offset += cursorFileState->pos;
-		cursorFileState->pos = 0;
+	memset(blockToWrite, 0, CURSOR_FILE_BLOCK_HEADER_SIZE);
+	memcpy(blockToWrite, &header, sizeof(CursorFileBlockHeader));
 
-		Size maxFileSize = ((Size) MaxAllowedCursorIntermediateFileSizeMB) * 1024L * 1024;
-		if (cursorFileState->cursorState.file_offset > maxFileSize)
-		{
-			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
-							errmsg("Cursor file size %u exceeded the limit %d MB",
-								   cursorFileState->cursorState.file_offset,
-								   MaxAllowedCursorIntermediateFileSizeMB)));
-		}
+	int bytesToWrite = CURSOR_FILE_BLOCK_HEADER_SIZE + MAXALIGN(header.storedLength);
+	int bytesWritten = FileWrite(cursorFileState->bufFile, blockToWrite, bytesToWrite,
+								 cursorFileState->cursorState.file_offset,
+								 WAIT_EVENT_BUFFILE_WRITE);
+
+	if (bytesWritten != bytesToWrite)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("Failed to save data to file")));
+	}
+
+	cursorFileState->cursorState.file_offset += bytesToWrite;
+	cursorFileState->pos = 0;
+	cursorFileState->documentCount = 0;
+
+	Size maxFileSize = ((Size) MaxAllowedCursorIntermediateFileSizeMB) * 1024L * 1024;
+	if (cursorFileState->cursorState.file_offset > maxFileSize)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg("Cursor file size %u exceeded the limit %d MB",
+							   cursorFileState->cursorState.file_offset,
+							   MaxAllowedCursorIntermediateFileSizeMB)));
 	}
 }
 
@@ -615,9 +1013,11 @@ CursorFileStateClose(CursorFileState *cursorFileState, MemoryContext writerConte
 		cursorFileState->cursorState.file_length =
 			cursorFileState->cursorState.file_offset;
 		cursorFileState->cursorState.file_offset = 0;
+		cursorFileState->cursorState.block_offset = 0;
 		pgstat_report_tempfile(cursorFileState->cursorState.file_length);
 	}
 
+	UnmapCursorFile(cursorFileState);
 	PendingCursorFile[0] = '\0';
 	FileClose(cursorFileState->bufFile);
 	if (cursorFileState->cursorComplete)
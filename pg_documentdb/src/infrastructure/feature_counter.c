@@ -216,6 +216,7 @@ static char FeatureMapping[MAX_FEATURE_COUNT][MAX_FEATURE_NAME_LENGTH] = {
 	[FEATURE_COMMAND_CURRENTOP] = "command_current_op",
 	[FEATURE_COMMAND_DBSTATS] = "command_dbstats",
 	[FEATURE_COMMAND_DELETE] = "command_delete",
+	[FEATURE_COMMAND_DELETE_MANY_BATCHED] = "command_delete_many_batched",
 	[FEATURE_COMMAND_DISTINCT] = "command_distinct",
 	[FEATURE_COMMAND_FINDANDMODIFY] = "command_findAndModify",
 	[FEATURE_COMMAND_FIND_CURSOR_FIRST_PAGE] = "command_find_cursor_first_page",
@@ -280,6 +281,8 @@ static char FeatureMapping[MAX_FEATURE_COUNT][MAX_FEATURE_NAME_LENGTH] = {
 		"create_unique_index_with_term_truncation",
 
 	/* Feature Mapping region - Cursor types */
+	[FEATURE_CURSOR_TYPE_MULTI_POINT_READ] = "cursor_type_multi_point_read",
+	[FEATURE_CURSOR_TYPE_SORTED_STREAMING] = "cursor_type_sorted_streaming",
 	[FEATURE_CURSOR_TYPE_PERSISTENT] = "cursor_type_persistent",
 	[FEATURE_CURSOR_TYPE_POINT_READ] = "cursor_type_point_read",
 	[FEATURE_CURSOR_TYPE_SINGLE_BATCH] = "cursor_type_single_batch",
@@ -352,6 +355,7 @@ static char FeatureMapping[MAX_FEATURE_COUNT][MAX_FEATURE_NAME_LENGTH] = {
 	[FEATURE_STAGE_FILL] = "fill",
 	[FEATURE_STAGE_GEONEAR] = "geo_near",
 	[FEATURE_STAGE_GRAPH_LOOKUP] = "graphLookup",
+	[FEATURE_STAGE_GRAPH_LOOKUP_NATIVE] = "graphLookupNative",
 	[FEATURE_STAGE_GROUP] = "group",
 	[FEATURE_STAGE_GROUP_ACC_BOTTOMN] = "bottomN",
 	[FEATURE_STAGE_GROUP_ACC_FIRSTN] = "firstN_acc",
@@ -371,12 +375,14 @@ static char FeatureMapping[MAX_FEATURE_COUNT][MAX_FEATURE_NAME_LENGTH] = {
 	[FEATURE_STAGE_OUT] = "out",
 	[FEATURE_STAGE_PROJECT] = "project",
 	[FEATURE_STAGE_PROJECT_FIND] = "project_find",
+	[FEATURE_STAGE_RANK_FUSION] = "rank_fusion",
 	[FEATURE_STAGE_REDACT] = "redact",
 	[FEATURE_STAGE_REPLACE_ROOT] = "replace_root",
 	[FEATURE_STAGE_REPLACE_WITH] = "replace_with",
 	[FEATURE_STAGE_SAMPLE] = "sample",
 	[FEATURE_STAGE_SEARCH] = "search",
 	[FEATURE_STAGE_SEARCH_VECTOR] = "search_vector",
+	[FEATURE_STAGE_SEARCH_VECTOR_BATCHED] = "search_vector_batched",
 	[FEATURE_STAGE_SEARCH_VECTOR_COMPRESSION_HALF] = "search_vector_compression_half",
 	[FEATURE_STAGE_SEARCH_VECTOR_COMPRESSION_PQ] = "search_vector_compression_pq",
 	[FEATURE_STAGE_SEARCH_VECTOR_DEFAULT_NPROBES] = "search_vector_default_nprobes",
@@ -419,6 +425,12 @@ static char FeatureMapping[MAX_FEATURE_COUNT][MAX_FEATURE_NAME_LENGTH] = {
 	[FEATURE_UPDATE_OPERATOR_UNSET] = "update_operator_unset",
 
 	/* Feature usage stats */
+	[FEATURE_USAGE_GEO_SHAPE_CACHE_HIT] = "geo_shape_cache_hit",
+	[FEATURE_USAGE_GEO_SHAPE_CACHE_MISS] = "geo_shape_cache_miss",
+	[FEATURE_USAGE_REGEX_CACHE_HIT] = "regex_cache_hit",
+	[FEATURE_USAGE_REGEX_CACHE_MISS] = "regex_cache_miss",
+	[FEATURE_USAGE_STATS_CACHE_HIT] = "stats_cache_hit",
+	[FEATURE_USAGE_STATS_CACHE_MISS] = "stats_cache_miss",
 	[FEATURE_USAGE_TTL_PURGER_CALLS] = "ttl_purger_calls",
 	[FEATURE_USAGE_TTL_SATURATED_BATCHES] = "ttl_saturated_batches",
 	[FEATURE_USAGE_TTL_SLOW_BATCHES] = "ttl_slow_batches",
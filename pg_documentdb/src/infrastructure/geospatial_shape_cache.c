@@ -0,0 +1,247 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/infrastructure/geospatial_shape_cache.c
+ *
+ * Implementation of a backend local cache of geospatial query shapes.
+ *
+ * $geoWithin and $geoIntersects parse the query shape into a PostGIS
+ * geometry/geography once per query (at runtime and in the index consistent
+ * functions), which for large polygons means validating and building the
+ * shape again for each query. Applications like geofencing query the same
+ * shapes over and over, so the built shape is cached keyed by the shape
+ * value, the shape operator, the query operator and the query stage. The
+ * serialized PostGIS value already carries its bounding box, and PostGIS
+ * keeps the prepared form of a repeated argument in the FmgrInfo of the
+ * comparison function, so caching the built shape is enough for both. A
+ * least recently used (LRU) queue is kept to limit the size of the cache.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <common/hashfn.h>
+#include <lib/ilist.h>
+#include <utils/datum.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
+
+#include "infrastructure/documentdb_geospatial_shape_cache.h"
+#include "utils/feature_counter.h"
+
+/* ShapeCacheKey is used as the key of a shape in the cache */
+typedef struct ShapeCacheKey
+{
+	/* hash of the shape value, the shape operator and the query context */
+	uint64 shapeHash;
+} ShapeCacheKey;
+
+typedef struct ShapeCacheEntry
+{
+	/* key of the shape in the hash */
+	ShapeCacheKey shapeKey;
+
+	/* the context the shape was built for */
+	GeospatialShapeOperator op;
+	MongoQueryOperatorType queryOperatorType;
+	QueryStage queryStage;
+
+	/* the serialized shape value */
+	bson_type_t shapeValueType;
+	uint32_t shapeLength;
+	uint8_t *shapeBytes;
+
+	/* the PostGIS geometry/geography built for the shape */
+	Datum shapeDatum;
+
+	/* node in the LRU queue */
+	dlist_node lruNode;
+
+	/* whether this cache entry was fully built */
+	bool isValid;
+} ShapeCacheEntry;
+
+/* internal function declarations */
+static void InitializeShapeCache(void);
+static void RemoveShapeCacheEntry(ShapeCacheEntry *entry);
+static bool ShapeCacheEntryMatches(ShapeCacheEntry *entry,
+								   const ShapeOperator *shapeOperator,
+								   const bson_value_t *shapePointsValue,
+								   const ShapeOperatorInfo *opInfo);
+
+/* memory context in which the cache is allocated */
+static MemoryContext ShapeCacheContext = NULL;
+
+/* hash table containing the cached shapes */
+static HTAB *ShapeCacheHash = NULL;
+
+/* linked list for keeping track of LRU */
+static dlist_head ShapeCacheLRUQueue;
+
+/* number of entries in the shape cache */
+static int CachedShapeCount = 0;
+
+/* number of entries allowed in the shape cache */
+extern int GeospatialShapeCacheSize;
+
+
+/*
+ * GetCachedShapeDatum returns the PostGIS geometry/geography for the shape
+ * value of the shape operator, building it on a cache miss. The returned
+ * datum is allocated in the current memory context since the query state
+ * that holds it can outlive the cache entry.
+ *
+ * Shapes with operator specific state ($center and $centerSphere) and
+ * non document values are built without the cache.
+ */
+Datum
+GetCachedShapeDatum(const ShapeOperator *shapeOperator,
+					const bson_value_t *shapePointsValue,
+					ShapeOperatorInfo *opInfo)
+{
+	if (GeospatialShapeCacheSize <= 0 ||
+		opInfo->opState != NULL ||
+		shapeOperator->op == GeospatialShapeOperator_CENTER ||
+		shapeOperator->op == GeospatialShapeOperator_CENTERSPHERE ||
+		(shapePointsValue->value_type != BSON_TYPE_DOCUMENT &&
+		 shapePointsValue->value_type != BSON_TYPE_ARRAY))
+	{
+		return shapeOperator->getShapeDatum(shapePointsValue, opInfo);
+	}
+
+	InitializeShapeCache();
+
+	uint64 shapeHash = hash_bytes_extended(shapePointsValue->value.v_doc.data,
+										   shapePointsValue->value.v_doc.data_len,
+										   shapePointsValue->value_type);
+	shapeHash = hash_combine64(shapeHash, shapeOperator->op);
+	shapeHash = hash_combine64(shapeHash, opInfo->queryOperatorType);
+	shapeHash = hash_combine64(shapeHash, opInfo->queryStage);
+
+	ShapeCacheKey shapeKey = { .shapeHash = shapeHash };
+
+	bool foundInCache = false;
+	ShapeCacheEntry *entry = hash_search(ShapeCacheHash, &shapeKey, HASH_ENTER,
+										 &foundInCache);
+	if (foundInCache && entry->isValid)
+	{
+		if (ShapeCacheEntryMatches(entry, shapeOperator, shapePointsValue, opInfo))
+		{
+			ReportFeatureUsage(FEATURE_USAGE_GEO_SHAPE_CACHE_HIT);
+
+			/* move entry to the tail of the queue */
+			dlist_delete(&entry->lruNode);
+			dlist_push_tail(&ShapeCacheLRUQueue, &entry->lruNode);
+			return datumCopy(entry->shapeDatum, false, -1);
+		}
+
+		/* Hash collision with a different shape: replace the old one */
+		dlist_delete(&entry->lruNode);
+		CachedShapeCount--;
+		pfree(entry->shapeBytes);
+		pfree(DatumGetPointer(entry->shapeDatum));
+	}
+
+	/*
+	 * Since HASH_ENTER doesn't zero-initialize cache-entry, we first set
+	 * isValid to false before performing any other operations so that an
+	 * error while building the shape (e.g. an invalid polygon) doesn't leave
+	 * a garbage entry behind.
+	 */
+	entry->isValid = false;
+	ReportFeatureUsage(FEATURE_USAGE_GEO_SHAPE_CACHE_MISS);
+
+	if (CachedShapeCount >= GeospatialShapeCacheSize &&
+		!dlist_is_empty(&ShapeCacheLRUQueue))
+	{
+		dlist_node *lruNode = dlist_head_node(&ShapeCacheLRUQueue);
+		RemoveShapeCacheEntry(dlist_container(ShapeCacheEntry, lruNode, lruNode));
+	}
+
+	/* Build the shape in the caller's context, only the result is kept */
+	Datum shapeDatum = shapeOperator->getShapeDatum(shapePointsValue, opInfo);
+
+	MemoryContext oldContext = MemoryContextSwitchTo(ShapeCacheContext);
+	entry->shapeDatum = datumCopy(shapeDatum, false, -1);
+	entry->shapeBytes = palloc(shapePointsValue->value.v_doc.data_len);
+	memcpy(entry->shapeBytes, shapePointsValue->value.v_doc.data,
+		   shapePointsValue->value.v_doc.data_len);
+	MemoryContextSwitchTo(oldContext);
+
+	entry->op = shapeOperator->op;
+	entry->queryOperatorType = opInfo->queryOperatorType;
+	entry->queryStage = opInfo->queryStage;
+	entry->shapeValueType = shapePointsValue->value_type;
+	entry->shapeLength = shapePointsValue->value.v_doc.data_len;
+
+	/*
+	 * Now that we initialized all the fields without any errors, append the
+	 * cache entry at the tail of the queue and mark it as valid.
+	 */
+	dlist_push_tail(&ShapeCacheLRUQueue, &entry->lruNode);
+	CachedShapeCount++;
+	entry->isValid = true;
+
+	return shapeDatum;
+}
+
+
+/*
+ * InitializeShapeCache initializes the session-level shape cache.
+ */
+static void
+InitializeShapeCache(void)
+{
+	if (ShapeCacheHash != NULL)
+	{
+		return;
+	}
+
+	ShapeCacheContext = AllocSetContextCreate(CacheMemoryContext,
+											  "DocumentDB geospatial shape cache context",
+											  ALLOCSET_DEFAULT_SIZES);
+
+	HASHCTL info;
+	memset(&info, 0, sizeof(info));
+	info.keysize = sizeof(ShapeCacheKey);
+	info.entrysize = sizeof(ShapeCacheEntry);
+	info.hcxt = ShapeCacheContext;
+	int hashFlags = HASH_ELEM | HASH_BLOBS | HASH_CONTEXT;
+
+	ShapeCacheHash = hash_create("DocumentDB geospatial shape cache hash", 32, &info,
+								 hashFlags);
+
+	dlist_init(&ShapeCacheLRUQueue);
+}
+
+
+/*
+ * RemoveShapeCacheEntry removes a valid entry from the cache and frees its
+ * shape.
+ */
+static void
+RemoveShapeCacheEntry(ShapeCacheEntry *entry)
+{
+	dlist_delete(&entry->lruNode);
+	CachedShapeCount--;
+
+	pfree(entry->shapeBytes);
+	pfree(DatumGetPointer(entry->shapeDatum));
+
+	bool foundInCache = false;
+	hash_search(ShapeCacheHash, &entry->shapeKey, HASH_REMOVE, &foundInCache);
+}
+
+
+static bool
+ShapeCacheEntryMatches(ShapeCacheEntry *entry, const ShapeOperator *shapeOperator,
+					   const bson_value_t *shapePointsValue,
+					   const ShapeOperatorInfo *opInfo)
+{
+	return entry->op == shapeOperator->op &&
+		   entry->queryOperatorType == opInfo->queryOperatorType &&
+		   entry->queryStage == opInfo->queryStage &&
+		   entry->shapeValueType == shapePointsValue->value_type &&
+		   entry->shapeLength == shapePointsValue->value.v_doc.data_len &&
+		   memcmp(entry->shapeBytes, shapePointsValue->value.v_doc.data,
+				  entry->shapeLength) == 0;
+}
@@ -10,13 +10,25 @@
  * and a set of query flags. A least recently used (LRU) queue is kept
  * to limit the size of the cache.
  *
+ * SPI plans are backend local and cannot be shared. What is shared across
+ * backends is a small directory of plan hints: once a backend's plancache
+ * has settled on a generic plan for a query key, new backends preparing
+ * the same query key start out with a generic plan instead of going through
+ * the custom plan trials again (which is what dominates the cold start cost
+ * after a gateway reconnects its pool).
+ *
  *-------------------------------------------------------------------------
  */
 #include "postgres.h"
 #include "fmgr.h"
 #include "miscadmin.h"
 
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
 #include "utils/memutils.h"
+#include "utils/plancache.h"
 
 #include "infrastructure/documentdb_plan_cache.h"
 
@@ -46,10 +58,57 @@ typedef struct QueryPlanCacheEntry
 
 	/* whether this cache entry was fully built */
 	bool isValid;
+
+	/* whether the plan hint for this entry was already published (or not needed) */
+	bool isHintPublished;
 } QueryPlanCacheEntry;
 
+
+/* Number of collection epoch slots used to invalidate shared plan hints */
+#define QUERY_PLAN_HINT_EPOCH_SLOTS 1024
+
+/*
+ * QueryPlanHintEntry is an entry in the shared plan hints hash.
+ */
+typedef struct QueryPlanHintEntry
+{
+	/* key of the query plan in the hash (must be first) */
+	QueryKey queryKey;
+
+	/* The collection epoch at the time the hint was published */
+	uint32 collectionEpoch;
+
+	/* whether the plancache settled on a generic plan for this query */
+	bool preferGenericPlan;
+} QueryPlanHintEntry;
+
+/*
+ * Shared state for the plan hints directory.
+ */
+typedef struct QueryPlanHintSharedData
+{
+	/* The tranche id of the hints lock */
+	int trancheId;
+
+	/* The tranche name of the hints lock */
+	char *trancheName;
+
+	/* Lock protecting the shared hints hash */
+	LWLock lock;
+
+	/*
+	 * Epochs bumped on relcache invalidation of a collection. Collections
+	 * are hashed into the slots - collisions only cause spurious invalidations.
+	 */
+	pg_atomic_uint32 collectionEpochs[QUERY_PLAN_HINT_EPOCH_SLOTS];
+} QueryPlanHintSharedData;
+
 /* internal function declarations */
 static void RemoveOldestQueryPlan(void);
+static bool GetSharedQueryPlanHint(QueryKey *queryKey);
+static bool TryPublishSharedQueryPlanHint(QueryPlanCacheEntry *entry);
+static void RemoveStaleSharedQueryPlanHints(void);
+static inline uint32 GetCollectionEpoch(uint64 collectionId);
 
 /* memory context in which the cache is allocated */
 static MemoryContext QueryPlanCacheContext = NULL;
@@ -66,6 +125,18 @@ static int CachedPlansCount = 0;
 /* number of entries allowed in the query plan cache */
 extern int QueryPlanCacheSizeLimit;
 
+/* number of entries allowed in the shared plan hints directory */
+extern int SharedQueryPlanHintCacheSize;
+
+/* whether or not to use and publish shared plan hints */
+extern bool EnableSharedQueryPlanHints;
+
+/* shared state of the plan hints directory (NULL if not available) */
+static QueryPlanHintSharedData *QueryPlanHintSharedState = NULL;
+
+/* shared hash (QueryKey -> QueryPlanHintEntry) */
+static HTAB *SharedQueryPlanHintHash = NULL;
+
 
 /*
  * InitializeQueryPlanCache initalized the session-level query plan
@@ -156,7 +227,17 @@ GetSPIQueryPlanWithLocalShard(uint64 collectionId, const char *shardTableName, u
 			RemoveOldestQueryPlan();
 		}
 
-		SPIPlanPtr plan = SPI_prepare(query, argCount, argTypes);
+		/*
+		 * If another backend already learnt that this query settles on a
+		 * generic plan, skip the custom plan trials.
+		 */
+		int cursorOptions = 0;
+		if (EnableSharedQueryPlanHints && GetSharedQueryPlanHint(&queryKey))
+		{
+			cursorOptions |= CURSOR_OPT_GENERIC_PLAN;
+		}
+
+		SPIPlanPtr plan = SPI_prepare_cursor(query, argCount, argTypes, cursorOptions);
 		if (plan == NULL)
 		{
 			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
@@ -165,6 +246,7 @@ GetSPIQueryPlanWithLocalShard(uint64 collectionId, const char *shardTableName, u
 
 		SPI_keepplan(plan);
 		entry->plan = plan;
+		entry->isHintPublished = cursorOptions != 0;
 
 		/*
 		 * Now that we initialized all the fields without any errors, i) append
@@ -185,12 +267,101 @@ GetSPIQueryPlanWithLocalShard(uint64 collectionId, const char *shardTableName, u
 		/* move entry to the tail of the queue */
 		dlist_delete(&entry->lruNode);
 		dlist_push_tail(&QueryPlanLRUQueue, &entry->lruNode);
+
+		if (EnableSharedQueryPlanHints && !entry->isHintPublished)
+		{
+			entry->isHintPublished = TryPublishSharedQueryPlanHint(entry);
+		}
 	}
 
 	return entry->plan;
 }
 
 
+/*
+ * QueryPlanHintShmemSize returns the shared memory needed for the
+ * shared plan hints directory.
+ */
+Size
+QueryPlanHintShmemSize(void)
+{
+	Size size = MAXALIGN(sizeof(QueryPlanHintSharedData));
+	if (SharedQueryPlanHintCacheSize > 0)
+	{
+		size = add_size(size, hash_estimate_size(SharedQueryPlanHintCacheSize,
+												 sizeof(QueryPlanHintEntry)));
+	}
+
+	return size;
+}
+
+
+/*
+ * InitializeQueryPlanHintShmem initializes the shared plan hints
+ * directory.
+ */
+void
+InitializeQueryPlanHintShmem(void)
+{
+	bool found = false;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	QueryPlanHintSharedState =
+		(QueryPlanHintSharedData *) ShmemInitStruct(
+			"DocumentDB Query Plan Hints Data",
+			sizeof(QueryPlanHintSharedData),
+			&found);
+
+	if (!found)
+	{
+		QueryPlanHintSharedState->trancheId = LWLockNewTrancheId();
+		QueryPlanHintSharedState->trancheName = "DocumentDB Query Plan Hints Tranche";
+		LWLockRegisterTranche(QueryPlanHintSharedState->trancheId,
+							  QueryPlanHintSharedState->trancheName);
+		LWLockInitialize(&QueryPlanHintSharedState->lock,
+						 QueryPlanHintSharedState->trancheId);
+
+		for (int i = 0; i < QUERY_PLAN_HINT_EPOCH_SLOTS; i++)
+		{
+			pg_atomic_init_u32(&QueryPlanHintSharedState->collectionEpochs[i], 0);
+		}
+	}
+
+	if (SharedQueryPlanHintCacheSize > 0)
+	{
+		HASHCTL info;
+		memset(&info, 0, sizeof(info));
+		info.keysize = sizeof(QueryKey);
+		info.entrysize = sizeof(QueryPlanHintEntry);
+		SharedQueryPlanHintHash = ShmemInitHash("DocumentDB Query Plan Hints Hash",
+												SharedQueryPlanHintCacheSize,
+												SharedQueryPlanHintCacheSize,
+												&info, HASH_ELEM | HASH_BLOBS);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+
+/*
+ * InvalidateSharedQueryPlanHints invalidates the shared plan hints of a
+ * collection. This is called from the relcache invalidation of the collection
+ * hence it only bumps an epoch rather than walking the hints.
+ */
+void
+InvalidateSharedQueryPlanHints(uint64 collectionId)
+{
+	if (QueryPlanHintSharedState == NULL)
+	{
+		return;
+	}
+
+	pg_atomic_fetch_add_u32(
+		&QueryPlanHintSharedState->collectionEpochs[collectionId %
+													QUERY_PLAN_HINT_EPOCH_SLOTS], 1);
+}
+
+
 /*
  * RemoveOldestQueryPlan removes the oldest query plan, which is
  * at the head of the LRU queue.
@@ -210,3 +381,122 @@ RemoveOldestQueryPlan(void)
 
 	CachedPlansCount--;
 }
+
+
+/*
+ * GetCollectionEpoch returns the current invalidation epoch of a collection.
+ */
+static inline uint32
+GetCollectionEpoch(uint64 collectionId)
+{
+	return pg_atomic_read_u32(
+		&QueryPlanHintSharedState->collectionEpochs[collectionId %
+													QUERY_PLAN_HINT_EPOCH_SLOTS]);
+}
+
+
+/*
+ * GetSharedQueryPlanHint returns true if another backend published that the
+ * given query settles on a generic plan (and the collection was not invalidated
+ * since).
+ */
+static bool
+GetSharedQueryPlanHint(QueryKey *queryKey)
+{
+	if (SharedQueryPlanHintHash == NULL)
+	{
+		return false;
+	}
+
+	bool preferGenericPlan = false;
+	uint32 currentEpoch = GetCollectionEpoch(queryKey->collectionId);
+
+	LWLockAcquire(&QueryPlanHintSharedState->lock, LW_SHARED);
+	QueryPlanHintEntry *hintEntry = hash_search(SharedQueryPlanHintHash, queryKey,
+												HASH_FIND, NULL);
+	if (hintEntry != NULL && hintEntry->collectionEpoch == currentEpoch)
+	{
+		preferGenericPlan = hintEntry->preferGenericPlan;
+	}
+
+	LWLockRelease(&QueryPlanHintSharedState->lock);
+	return preferGenericPlan;
+}
+
+
+/*
+ * TryPublishSharedQueryPlanHint publishes the plan hint of a local cache
+ * entry once the plancache has chosen a generic plan for it. Returns true
+ * if there is nothing more to publish for the entry.
+ */
+static bool
+TryPublishSharedQueryPlanHint(QueryPlanCacheEntry *entry)
+{
+	if (SharedQueryPlanHintHash == NULL)
+	{
+		return true;
+	}
+
+	List *planSources = SPI_plan_get_plan_sources(entry->plan);
+	if (list_length(planSources) != 1)
+	{
+		/* Multi-statement plans are not tracked */
+		return true;
+	}
+
+	CachedPlanSource *planSource = (CachedPlanSource *) linitial(planSources);
+	if (planSource->num_generic_plans == 0)
+	{
+		/* Still in custom plan mode - check again on later executions */
+		return false;
+	}
+
+	uint32 currentEpoch = GetCollectionEpoch(entry->queryKey.collectionId);
+
+	LWLockAcquire(&QueryPlanHintSharedState->lock, LW_EXCLUSIVE);
+	QueryPlanHintEntry *hintEntry = hash_search(SharedQueryPlanHintHash,
+												&entry->queryKey, HASH_ENTER_NULL,
+												NULL);
+	if (hintEntry == NULL)
+	{
+		/* The directory is full: make room by pruning invalidated hints */
+		RemoveStaleSharedQueryPlanHints();
+		hintEntry = hash_search(SharedQueryPlanHintHash, &entry->queryKey,
+								HASH_ENTER_NULL, NULL);
+	}
+
+	if (hintEntry != NULL)
+	{
+		hintEntry->collectionEpoch = currentEpoch;
+		hintEntry->preferGenericPlan = true;
+	}
+
+	LWLockRelease(&QueryPlanHintSharedState->lock);
+
+	/* If the directory is still full, we don't retry for this entry */
+	return true;
+}
+
+
+/*
+ * RemoveStaleSharedQueryPlanHints removes hints whose collection was
+ * invalidated after they were published. Expects the hints lock to be held
+ * in exclusive mode.
+ */
+static void
+RemoveStaleSharedQueryPlanHints(void)
+{
+	HASH_SEQ_STATUS status;
+	QueryPlanHintEntry *hintEntry;
+
+	hash_seq_init(&status, SharedQueryPlanHintHash);
+	while ((hintEntry = hash_seq_search(&status)) != NULL)
+	{
+		if (hintEntry->collectionEpoch !=
+			GetCollectionEpoch(hintEntry->queryKey.collectionId))
+		{
+			hash_search(SharedQueryPlanHintHash, &hintEntry->queryKey, HASH_REMOVE,
+						NULL);
+		}
+	}
+}
@@ -0,0 +1,242 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/infrastructure/regex_cache.c
+ *
+ * Implementation of a backend local cache of compiled regular expressions.
+ *
+ * Aggregation operators like $regexMatch compile their pattern once at parse
+ * time when it is a constant, but patterns that come from a field path or a
+ * variable (e.g. within $filter or $map) are compiled for every document they
+ * are evaluated against. These patterns usually repeat, so the compiled (and
+ * JIT compiled) pattern is cached keyed by the pattern, the options and the
+ * compile flags. A least recently used (LRU) queue is kept to limit the size
+ * of the cache.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <common/hashfn.h>
+#include <lib/ilist.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
+
+#include "infrastructure/documentdb_regex_cache.h"
+#include "utils/feature_counter.h"
+
+/* RegexCacheKey is used as the key of a compiled regex in the cache */
+typedef struct RegexCacheKey
+{
+	/* hash of the pattern, the options and the compile flags */
+	uint64 regexHash;
+} RegexCacheKey;
+
+typedef struct RegexCacheEntry
+{
+	/* key of the compiled regex in the hash */
+	RegexCacheKey regexKey;
+
+	/* the pattern and options the regex was compiled with */
+	char *regexPatternStr;
+	char *options;
+
+	/* whether the regex was compiled with PCRE2_NO_AUTO_CAPTURE */
+	bool enableNoAutoCapture;
+
+	/* the compiled regex */
+	PcreData *pcreData;
+
+	/* node in the LRU queue */
+	dlist_node lruNode;
+
+	/* whether this cache entry was fully built */
+	bool isValid;
+} RegexCacheEntry;
+
+/* internal function declarations */
+static void InitializeRegexCache(void);
+static void RemoveRegexCacheEntry(RegexCacheEntry *entry);
+static bool RegexCacheEntryMatches(RegexCacheEntry *entry, const char *regexPatternStr,
+								   const char *options, bool enableNoAutoCapture);
+
+/* memory context in which the cache is allocated */
+static MemoryContext RegexCacheContext = NULL;
+
+/* hash table containing the compiled regexes */
+static HTAB *RegexCacheHash = NULL;
+
+/* linked list for keeping track of LRU */
+static dlist_head RegexCacheLRUQueue;
+
+/* number of entries in the regex cache */
+static int CachedRegexCount = 0;
+
+/* number of entries allowed in the regex cache */
+extern int RegexCompileCacheSize;
+
+
+/*
+ * GetCachedRegexForAggregation returns the compiled regex for the pattern
+ * and options to be used by the aggregation regex operators, compiling it
+ * on a cache miss. The returned PcreData is owned by the cache and must not
+ * be freed by the caller.
+ * Returns NULL if the cache is disabled, in which case the caller should
+ * compile (and free) the regex itself.
+ */
+PcreData *
+GetCachedRegexForAggregation(char *regexPatternStr, char *options,
+							 bool enableNoAutoCapture,
+							 const char *regexInvalidErrorMessage)
+{
+	if (RegexCompileCacheSize <= 0)
+	{
+		return NULL;
+	}
+
+	InitializeRegexCache();
+
+	uint64 regexHash = hash_bytes_extended((const unsigned char *) regexPatternStr,
+										   strlen(regexPatternStr),
+										   enableNoAutoCapture ? 1 : 0);
+	if (options != NULL)
+	{
+		regexHash = hash_bytes_extended((const unsigned char *) options,
+										strlen(options), regexHash);
+	}
+
+	RegexCacheKey regexKey = { .regexHash = regexHash };
+
+	bool foundInCache = false;
+	RegexCacheEntry *entry = hash_search(RegexCacheHash, &regexKey, HASH_ENTER,
+										 &foundInCache);
+	if (foundInCache && entry->isValid)
+	{
+		if (RegexCacheEntryMatches(entry, regexPatternStr, options,
+								   enableNoAutoCapture))
+		{
+			ReportFeatureUsage(FEATURE_USAGE_REGEX_CACHE_HIT);
+
+			/* move entry to the tail of the queue */
+			dlist_delete(&entry->lruNode);
+			dlist_push_tail(&RegexCacheLRUQueue, &entry->lruNode);
+			return entry->pcreData;
+		}
+
+		/* Hash collision with a different pattern: replace the old one */
+		dlist_delete(&entry->lruNode);
+		CachedRegexCount--;
+		FreePcreData(entry->pcreData);
+		pfree(entry->regexPatternStr);
+		if (entry->options != NULL)
+		{
+			pfree(entry->options);
+		}
+	}
+
+	/*
+	 * Since HASH_ENTER doesn't zero-initialize cache-entry, we first set
+	 * isValid to false before performing any other operations so that an
+	 * error while compiling (e.g. an invalid pattern) doesn't leave a
+	 * garbage entry behind.
+	 */
+	entry->isValid = false;
+	ReportFeatureUsage(FEATURE_USAGE_REGEX_CACHE_MISS);
+
+	if (CachedRegexCount >= RegexCompileCacheSize &&
+		!dlist_is_empty(&RegexCacheLRUQueue))
+	{
+		dlist_node *lruNode = dlist_head_node(&RegexCacheLRUQueue);
+		RemoveRegexCacheEntry(dlist_container(RegexCacheEntry, lruNode, lruNode));
+	}
+
+	/* PCRE2 allocates with palloc so compile in the cache context */
+	MemoryContext oldContext = MemoryContextSwitchTo(RegexCacheContext);
+	PcreData *pcreData = RegexCompileForAggregation(regexPatternStr, options,
+													enableNoAutoCapture,
+													regexInvalidErrorMessage);
+	entry->regexPatternStr = pstrdup(regexPatternStr);
+	entry->options = options != NULL ? pstrdup(options) : NULL;
+	MemoryContextSwitchTo(oldContext);
+
+	entry->enableNoAutoCapture = enableNoAutoCapture;
+	entry->pcreData = pcreData;
+
+	/*
+	 * Now that we initialized all the fields without any errors, append the
+	 * cache entry at the tail of the queue and mark it as valid.
+	 */
+	dlist_push_tail(&RegexCacheLRUQueue, &entry->lruNode);
+	CachedRegexCount++;
+	entry->isValid = true;
+
+	return entry->pcreData;
+}
+
+
+/*
+ * InitializeRegexCache initializes the session-level regex cache.
+ */
+static void
+InitializeRegexCache(void)
+{
+	if (RegexCacheHash != NULL)
+	{
+		return;
+	}
+
+	RegexCacheContext = AllocSetContextCreate(CacheMemoryContext,
+											  "DocumentDB regex cache context",
+											  ALLOCSET_DEFAULT_SIZES);
+
+	HASHCTL info;
+	memset(&info, 0, sizeof(info));
+	info.keysize = sizeof(RegexCacheKey);
+	info.entrysize = sizeof(RegexCacheEntry);
+	info.hcxt = RegexCacheContext;
+	int hashFlags = HASH_ELEM | HASH_BLOBS | HASH_CONTEXT;
+
+	RegexCacheHash = hash_create("DocumentDB regex cache hash", 32, &info, hashFlags);
+
+	dlist_init(&RegexCacheLRUQueue);
+}
+
+
+/*
+ * RemoveRegexCacheEntry removes a valid entry from the cache and frees its
+ * compiled regex.
+ */
+static void
+RemoveRegexCacheEntry(RegexCacheEntry *entry)
+{
+	dlist_delete(&entry->lruNode);
+	CachedRegexCount--;
+
+	FreePcreData(entry->pcreData);
+	pfree(entry->regexPatternStr);
+	if (entry->options != NULL)
+	{
+		pfree(entry->options);
+	}
+
+	bool foundInCache = false;
+	hash_search(RegexCacheHash, &entry->regexKey, HASH_REMOVE, &foundInCache);
+}
+
+
+static bool
+RegexCacheEntryMatches(RegexCacheEntry *entry, const char *regexPatternStr,
+					   const char *options, bool enableNoAutoCapture)
+{
+	if (entry->enableNoAutoCapture != enableNoAutoCapture ||
+		strcmp(entry->regexPatternStr, regexPatternStr) != 0)
+	{
+		return false;
+	}
+
+	if (entry->options == NULL || options == NULL)
+	{
+		return entry->options == options;
+	}
+
+	return strcmp(entry->options, options) == 0;
+}
@@ -0,0 +1,363 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/infrastructure/slow_command_profile.c
+ *
+ * Profile of the slow commands, kept in a ring buffer in shared memory.
+ *
+ * A sample of the commands (documentdb.slowCommandProfileSampleRate) keep a
+ * copy of their command spec when they start. When such a command ends after
+ * running for longer than documentdb.slowCommandProfileThresholdMS, it is
+ * added to the ring buffer along with its duration, its execution counters
+ * and the index it scanned, overwriting the oldest entry. The entries of a
+ * database are read by the slowCommandProfile command.
+ *
+ * The buffer is only written by the commands that are slow so its lock isn't
+ * taken by the other commands.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <miscadmin.h>
+#include <fmgr.h>
+#include <catalog/pg_authid.h>
+#include <common/pg_prng.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/acl.h>
+#include <utils/builtins.h>
+
+#include "io/bson_core.h"
+#include "metadata/index.h"
+#include "utils/slow_command_profile.h"
+
+
+extern int SlowCommandProfileThresholdMs;
+extern double SlowCommandProfileSampleRate;
+
+/*
+ * The number of slow commands kept in the profile, across all databases.
+ */
+#define MAX_SLOW_COMMAND_PROFILE_ENTRIES 256
+
+/*
+ * Commands with a larger spec only keep their command name and collection.
+ */
+#define MAX_SLOW_COMMAND_PROFILE_COMMAND_SIZE 2048
+
+typedef struct SlowCommandProfileEntry
+{
+	CommandActivitySlot activity;
+
+	/* The user that ran the command */
+	Oid userId;
+
+	int64 durationMs;
+
+	/* The index id of the first index scanned by the command, 0 if none */
+	int indexId;
+
+	/* The size of the command spec, 0 if it was too large to keep */
+	uint32 commandSize;
+
+	char command[MAX_SLOW_COMMAND_PROFILE_COMMAND_SIZE];
+} SlowCommandProfileEntry;
+
+typedef struct SlowCommandProfileStore
+{
+	int trancheId;
+	char *trancheName;
+
+	LWLock lock;
+
+	/* The number of entries ever written, the next one goes at its modulo */
+	uint64 entriesWritten;
+
+	SlowCommandProfileEntry entries[MAX_SLOW_COMMAND_PROFILE_ENTRIES];
+} SlowCommandProfileStore;
+
+static SlowCommandProfileStore *SlowCommandProfile = NULL;
+
+/* The profile entry of the command running in the current backend */
+static SlowCommandProfileEntry LocalProfileEntry = { 0 };
+
+bool CurrentCommandProfiled = false;
+
+static void WriteProfileEntry(pgbson_array_writer *profileWriter,
+							  const SlowCommandProfileEntry *entry);
+
+PG_FUNCTION_INFO_V1(command_slow_command_profile);
+
+
+Size
+SlowCommandProfileShmemSize(void)
+{
+	return MAXALIGN(sizeof(SlowCommandProfileStore));
+}
+
+
+void
+InitializeSlowCommandProfileShmem(void)
+{
+	bool found = false;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	SlowCommandProfile = (SlowCommandProfileStore *) ShmemInitStruct(
+		"DocumentDB Slow Command Profile",
+		SlowCommandProfileShmemSize(),
+		&found);
+
+	if (!found)
+	{
+		MemSet(SlowCommandProfile, 0, SlowCommandProfileShmemSize());
+
+		SlowCommandProfile->trancheId = LWLockNewTrancheId();
+		SlowCommandProfile->trancheName = "SlowCommandProfileTranche";
+		LWLockRegisterTranche(SlowCommandProfile->trancheId,
+							  SlowCommandProfile->trancheName);
+		LWLockInitialize(&SlowCommandProfile->lock, SlowCommandProfile->trancheId);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+	Assert(SlowCommandProfile->trancheId != 0);
+}
+
+
+/*
+ * StartSlowCommandProfile decides whether the command starting in the current
+ * backend is sampled for the profile and if so keeps a copy of its spec, since
+ * the spec is freed before the command ends.
+ */
+void
+StartSlowCommandProfile(pgbson *commandSpec)
+{
+	CurrentCommandProfiled = false;
+	if (SlowCommandProfileThresholdMs < 0 || SlowCommandProfile == NULL ||
+		SlowCommandProfileSampleRate <= 0)
+	{
+		return;
+	}
+
+	if (SlowCommandProfileSampleRate < 1.0 &&
+		pg_prng_double(&pg_global_prng_state) >= SlowCommandProfileSampleRate)
+	{
+		return;
+	}
+
+	LocalProfileEntry.userId = GetUserId();
+	LocalProfileEntry.indexId = 0;
+
+	uint32 commandSize = VARSIZE_ANY_EXHDR(commandSpec);
+	if (commandSize <= MAX_SLOW_COMMAND_PROFILE_COMMAND_SIZE)
+	{
+		memcpy(LocalProfileEntry.command, VARDATA_ANY(commandSpec), commandSize);
+		LocalProfileEntry.commandSize = commandSize;
+	}
+	else
+	{
+		LocalProfileEntry.commandSize = 0;
+	}
+
+	CurrentCommandProfiled = true;
+}
+
+
+/*
+ * RecordSlowCommandProfile adds the command that ended in the current backend
+ * to the profile if it was sampled and ran for longer than the threshold.
+ */
+void
+RecordSlowCommandProfile(const CommandActivitySlot *activity,
+						 const CommandExecutionCounters *counters, int64 durationMs)
+{
+	if (!CurrentCommandProfiled)
+	{
+		return;
+	}
+
+	CurrentCommandProfiled = false;
+	if (SlowCommandProfileThresholdMs < 0 || durationMs < SlowCommandProfileThresholdMs)
+	{
+		return;
+	}
+
+	LocalProfileEntry.activity = *activity;
+	LocalProfileEntry.activity.executionCounters = *counters;
+	LocalProfileEntry.durationMs = durationMs;
+
+	/* Only the used part of the command buffer is copied */
+	Size entrySize = offsetof(SlowCommandProfileEntry, command) +
+					 LocalProfileEntry.commandSize;
+
+	LWLockAcquire(&SlowCommandProfile->lock, LW_EXCLUSIVE);
+
+	SlowCommandProfileEntry *entry =
+		&SlowCommandProfile->entries[SlowCommandProfile->entriesWritten %
+									 MAX_SLOW_COMMAND_PROFILE_ENTRIES];
+	memcpy(entry, &LocalProfileEntry, entrySize);
+	SlowCommandProfile->entriesWritten++;
+
+	LWLockRelease(&SlowCommandProfile->lock);
+}
+
+
+/*
+ * Keeps the first index of the extension scanned by the profiled command,
+ * whose key is reported as the plan summary of the command.
+ */
+void
+ReportProfiledIndexScan(Relation indexRelation)
+{
+	if (LocalProfileEntry.indexId != 0)
+	{
+		return;
+	}
+
+	/* documents_rum_index_<indexId> or documents_rum_index_<indexId>_<shardId> */
+	const char *relationName = RelationGetRelationName(indexRelation);
+	int prefixLength = strlen(DOCUMENT_DATA_TABLE_INDEX_NAME_FORMAT_PREFIX);
+	if (strncmp(relationName, DOCUMENT_DATA_TABLE_INDEX_NAME_FORMAT_PREFIX,
+				prefixLength) != 0)
+	{
+		return;
+	}
+
+	char *numEndPointer = NULL;
+	long indexId = strtol(relationName + prefixLength, &numEndPointer, 10);
+	if (*numEndPointer == '\0' || *numEndPointer == '_')
+	{
+		LocalProfileEntry.indexId = (int) indexId;
+	}
+}
+
+
+/*
+ * command_slow_command_profile returns the profile entries of a database,
+ * oldest first:
+ * { "profile": [ { "op", "ns", "command", "planSummary", "keysExamined",
+ *   "docsExamined", "keysInserted", "usedDisk", "tempBytesWritten", "tempBytesRead", "millis",
+ *   "ts" } ], "ok": 1 }
+ *
+ * Users without pg_read_all_stats only see the commands they ran.
+ */
+Datum
+command_slow_command_profile(PG_FUNCTION_ARGS)
+{
+	char *databaseName = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	bool readAllEntries = has_privs_of_role(GetUserId(), ROLE_PG_READ_ALL_STATS);
+
+	List *entries = NIL;
+	if (SlowCommandProfile != NULL)
+	{
+		/* Copy the entries first, the plan summaries need catalog lookups */
+		LWLockAcquire(&SlowCommandProfile->lock, LW_SHARED);
+
+		uint64 entriesWritten = SlowCommandProfile->entriesWritten;
+		uint64 firstEntry = entriesWritten > MAX_SLOW_COMMAND_PROFILE_ENTRIES ?
+							entriesWritten - MAX_SLOW_COMMAND_PROFILE_ENTRIES : 0;
+		for (uint64 i = firstEntry; i < entriesWritten; i++)
+		{
+			SlowCommandProfileEntry *entry =
+				&SlowCommandProfile->entries[i % MAX_SLOW_COMMAND_PROFILE_ENTRIES];
+			if (strcmp(entry->activity.databaseName, databaseName) != 0 ||
+				(!readAllEntries && entry->userId != GetUserId()))
+			{
+				continue;
+			}
+
+			Size entrySize = offsetof(SlowCommandProfileEntry, command) +
+							 entry->commandSize;
+			SlowCommandProfileEntry *entryCopy = palloc(entrySize);
+			memcpy(entryCopy, entry, entrySize);
+			entries = lappend(entries, entryCopy);
+		}
+
+		LWLockRelease(&SlowCommandProfile->lock);
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+
+	pgbson_array_writer profileWriter;
+	PgbsonWriterStartArray(&writer, "profile", 7, &profileWriter);
+
+	ListCell *entryCell;
+	foreach(entryCell, entries)
+	{
+		WriteProfileEntry(&profileWriter, lfirst(entryCell));
+	}
+
+	PgbsonWriterEndArray(&writer, &profileWriter);
+	PgbsonWriterAppendDouble(&writer, "ok", 2, 1);
+
+	PG_RETURN_POINTER(PgbsonWriterGetPgbson(&writer));
+}
+
+
+static void
+WriteProfileEntry(pgbson_array_writer *profileWriter,
+				  const SlowCommandProfileEntry *entry)
+{
+	const CommandActivitySlot *activity = &entry->activity;
+
+	pgbson_writer entryWriter;
+	PgbsonArrayWriterStartDocument(profileWriter, &entryWriter);
+
+	PgbsonWriterAppendUtf8(&entryWriter, "op", 2, activity->opType);
+
+	char *mongoNamespace = psprintf("%s.%s", activity->databaseName,
+									activity->collectionName);
+	PgbsonWriterAppendUtf8(&entryWriter, "ns", 2, mongoNamespace);
+
+	if (entry->commandSize > 0)
+	{
+		PgbsonWriterAppendDocument(&entryWriter, "command", 7,
+								   PgbsonInitFromBuffer(entry->command,
+														entry->commandSize));
+	}
+	else
+	{
+		/* The spec was too large to keep, only its first field is reported */
+		pgbson_writer commandWriter;
+		PgbsonWriterStartDocument(&entryWriter, "command", 7, &commandWriter);
+		PgbsonWriterAppendUtf8(&commandWriter, activity->commandName,
+							   strlen(activity->commandName),
+							   activity->collectionName);
+		PgbsonWriterEndDocument(&entryWriter, &commandWriter);
+		PgbsonWriterAppendBool(&entryWriter, "commandTruncated", 16, true);
+	}
+
+	IndexDetails *indexDetails = entry->indexId != 0 ?
+								 IndexIdGetIndexDetails(entry->indexId) : NULL;
+	if (indexDetails != NULL)
+	{
+		PgbsonWriterAppendUtf8(&entryWriter, "planSummary", 11,
+							   psprintf("IXSCAN %s", PgbsonToJsonForLogging(
+											indexDetails->indexSpec.indexKeyDocument)));
+	}
+
+	PgbsonWriterAppendInt64(&entryWriter, "keysExamined", 12,
+							activity->executionCounters.keysExamined);
+	PgbsonWriterAppendInt64(&entryWriter, "docsExamined", 12,
+							activity->executionCounters.docsExamined);
+
+	if (activity->executionCounters.keysInserted > 0)
+	{
+		PgbsonWriterAppendInt64(&entryWriter, "keysInserted", 12,
+								activity->executionCounters.keysInserted);
+	}
+
+	if (activity->executionCounters.tempBytesWritten > 0)
+	{
+		PgbsonWriterAppendBool(&entryWriter, "usedDisk", 8, true);
+		PgbsonWriterAppendInt64(&entryWriter, "tempBytesWritten", 16,
+								activity->executionCounters.tempBytesWritten);
+		PgbsonWriterAppendInt64(&entryWriter, "tempBytesRead", 13,
+								activity->executionCounters.tempBytesRead);
+	}
+
+	PgbsonWriterAppendInt64(&entryWriter, "millis", 6, entry->durationMs);
+	PgbsonWriterAppendDateTime(&entryWriter, "ts", 2, activity->commandStartTime);
+
+	PgbsonArrayWriterEndDocument(profileWriter, &entryWriter);
+}
@@ -0,0 +1,150 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/infrastructure/stage_counter.c
+ *
+ * Per backend counters of the time and memory spent building each
+ * aggregation stage.
+ *
+ * Like the feature counters, each backend writes to its own slot in shared
+ * memory without locks or atomics, and the slots are only summed up when
+ * the stats are read.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <miscadmin.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <nodes/execnodes.h>
+#include <storage/shmem.h>
+#include <utils/builtins.h>
+#include <utils/tuplestore.h>
+
+#include "aggregation/bson_aggregation_pipeline.h"
+#include "utils/stage_counter.h"
+
+
+#define STAGE_COUNTER_STATS_COLUMNS 4
+
+static void PopulateStageCounters(StageCounters *aggregatedStageCounters);
+static void ResetStageCounters(void);
+
+StageCounters *StageCounterBackendArray = NULL;
+
+
+PG_FUNCTION_INFO_V1(get_stage_counter_stats);
+
+/*
+ * get_stage_counter_stats returns the number of times each aggregation stage
+ * was built along with the time and memory spent building it, summed over
+ * all backends.
+ */
+Datum
+get_stage_counter_stats(PG_FUNCTION_ARGS)
+{
+	bool resetStatsAfterRead = PG_GETARG_BOOL(0);
+
+	ReturnSetInfo *resultSet = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc tupleDescriptor = NULL;
+	if (get_call_result_type(fcinfo, NULL, &tupleDescriptor) != TYPEFUNC_COMPOSITE)
+	{
+		elog(ERROR, "return type must be a row type");
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(
+		resultSet->econtext->ecxt_per_query_memory);
+	Tuplestorestate *tupleStore = tuplestore_begin_heap(true, false, work_mem);
+	resultSet->returnMode = SFRM_Materialize;
+	resultSet->setResult = tupleStore;
+	resultSet->setDesc = tupleDescriptor;
+	MemoryContextSwitchTo(oldContext);
+
+	StageCounters aggregatedStageCounters;
+	PopulateStageCounters(&aggregatedStageCounters);
+
+	if (resetStatsAfterRead)
+	{
+		ResetStageCounters();
+	}
+
+	Datum values[STAGE_COUNTER_STATS_COLUMNS] = { 0 };
+	bool isNulls[STAGE_COUNTER_STATS_COLUMNS] = { 0 };
+	for (int i = 0; i < MAX_STAGE_COUNTER_COUNT; i++)
+	{
+		const char *stageName = GetAggregationStageNameById(i);
+		if (aggregatedStageCounters[i].invocations == 0 || stageName == NULL)
+		{
+			continue;
+		}
+
+		values[0] = PointerGetDatum(cstring_to_text(stageName));
+		values[1] = Int64GetDatum((int64) aggregatedStageCounters[i].invocations);
+		values[2] = Int64GetDatum(
+			(int64) aggregatedStageCounters[i].totalBuildTimeMicros);
+		values[3] = Int64GetDatum((int64) aggregatedStageCounters[i].allocatedBytes);
+		tuplestore_putvalues(tupleStore, tupleDescriptor, values, isNulls);
+	}
+
+	PG_RETURN_VOID();
+}
+
+
+Size
+SharedStageCounterShmemSize(void)
+{
+	return mul_size(sizeof(StageCounters), MaxBackends);
+}
+
+
+/*
+ * SharedStageCounterShmemInit initializes the shared memory used
+ * for keeping track of stage counters across backends.
+ */
+void
+SharedStageCounterShmemInit(void)
+{
+	bool found;
+
+	size_t stageCounterShmemSize = SharedStageCounterShmemSize();
+	StageCounterBackendArray = (StageCounters *)
+							   ShmemInitStruct("Stage Counter Array",
+											   stageCounterShmemSize, &found);
+
+	if (!found)
+	{
+		MemSet(StageCounterBackendArray, 0, stageCounterShmemSize);
+	}
+}
+
+
+/*
+ * Resets the stage counters of all backends. As with the feature counters,
+ * counts written between the read and the reset may be lost.
+ */
+static void
+ResetStageCounters(void)
+{
+	pg_write_barrier();
+	MemSet(StageCounterBackendArray, 0, SharedStageCounterShmemSize());
+}
+
+
+static void
+PopulateStageCounters(StageCounters *aggregatedStageCounters)
+{
+	MemSet(*aggregatedStageCounters, 0, sizeof(StageCounters));
+
+	pg_memory_barrier();
+	for (int i = 0; i < MaxBackends; i++)
+	{
+		for (int j = 0; j < MAX_STAGE_COUNTER_COUNT; j++)
+		{
+			StageCounter *counter = &StageCounterBackendArray[i][j];
+			(*aggregatedStageCounters)[j].invocations += counter->invocations;
+			(*aggregatedStageCounters)[j].totalBuildTimeMicros +=
+				counter->totalBuildTimeMicros;
+			(*aggregatedStageCounters)[j].allocatedBytes += counter->allocatedBytes;
+		}
+	}
+}
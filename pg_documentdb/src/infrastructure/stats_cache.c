@@ -0,0 +1,289 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/infrastructure/stats_cache.c
+ *
+ * Implementation of a shared cache of collStats/dbStats responses.
+ *
+ * collStats and dbStats fan out to every node and compute relation sizes
+ * and document counts on demand. Monitoring agents poll these commands every
+ * few seconds, usually from different connections, so the responses are
+ * cached in shared memory keyed by the database, the namespace, the
+ * collection and the scale. A request only reuses a response that is younger than the staleness
+ * bound chosen by the session (statsCacheMaxStalenessMs), which keeps the
+ * default behavior of always computing fresh stats.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/hsearch.h>
+#include <utils/timestamp.h>
+
+#include "metadata/collection.h"
+#include "infrastructure/documentdb_stats_cache.h"
+#include "utils/feature_counter.h"
+
+/* Responses larger than this (e.g. collections with many indexes) are not cached */
+#define STATS_CACHE_MAX_RESPONSE_SIZE 4096
+
+/* StatsCacheKey is used as the key of a response in the cache */
+typedef struct StatsCacheKey
+{
+	/* the database the collection/namespace belongs to */
+	Oid databaseId;
+
+	/* the namespace (db.coll for collStats and db for dbStats) */
+	char namespaceName[MAX_NAMESPACE_NAME_LENGTH + 1];
+
+	/* the collection for collStats, 0 for dbStats */
+	uint64 collectionId;
+
+	/* the scale requested */
+	int32 scale;
+} StatsCacheKey;
+
+typedef struct StatsCacheEntry
+{
+	/* key of the response in the hash (must be first) */
+	StatsCacheKey key;
+
+	/* time at which the computation of the response started */
+	TimestampTz computedTime;
+
+	/* the serialized response (a pgbson) */
+	uint32 responseSize;
+	char response[STATS_CACHE_MAX_RESPONSE_SIZE];
+} StatsCacheEntry;
+
+/*
+ * Shared state of the stats cache.
+ */
+typedef struct StatsCacheSharedData
+{
+	/* The tranche id of the cache lock */
+	int trancheId;
+
+	/* The tranche name of the cache lock */
+	char *trancheName;
+
+	/* Lock protecting the shared cache hash */
+	LWLock lock;
+} StatsCacheSharedData;
+
+/* internal function declarations */
+static bool InitializeStatsCacheKey(StatsCacheKey *key, const char *namespaceName,
+									uint64 collectionId, int32 scale);
+static void RemoveOldestStatsCacheEntry(void);
+
+/* number of entries allowed in the shared stats cache */
+extern int StatsCacheSize;
+
+/* the maximum age of a cached response a session accepts, 0 disables the cache */
+extern int StatsCacheMaxStalenessMs;
+
+/* shared state of the stats cache (NULL if not available) */
+static StatsCacheSharedData *StatsCacheSharedState = NULL;
+
+/* shared hash (StatsCacheKey -> StatsCacheEntry) */
+static HTAB *SharedStatsCacheHash = NULL;
+
+
+/*
+ * StatsCacheShmemSize returns the shared memory needed for the stats cache.
+ */
+Size
+StatsCacheShmemSize(void)
+{
+	Size size = MAXALIGN(sizeof(StatsCacheSharedData));
+	if (StatsCacheSize > 0)
+	{
+		size = add_size(size, hash_estimate_size(StatsCacheSize,
+												 sizeof(StatsCacheEntry)));
+	}
+
+	return size;
+}
+
+
+/*
+ * InitializeStatsCacheShmem initializes the shared stats cache.
+ */
+void
+InitializeStatsCacheShmem(void)
+{
+	bool found = false;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	StatsCacheSharedState =
+		(StatsCacheSharedData *) ShmemInitStruct(
+			"DocumentDB Stats Cache Data",
+			sizeof(StatsCacheSharedData),
+			&found);
+
+	if (!found)
+	{
+		StatsCacheSharedState->trancheId = LWLockNewTrancheId();
+		StatsCacheSharedState->trancheName = "DocumentDB Stats Cache Tranche";
+		LWLockRegisterTranche(StatsCacheSharedState->trancheId,
+							  StatsCacheSharedState->trancheName);
+		LWLockInitialize(&StatsCacheSharedState->lock,
+						 StatsCacheSharedState->trancheId);
+	}
+
+	if (StatsCacheSize > 0)
+	{
+		HASHCTL info;
+		memset(&info, 0, sizeof(info));
+		info.keysize = sizeof(StatsCacheKey);
+		info.entrysize = sizeof(StatsCacheEntry);
+		SharedStatsCacheHash = ShmemInitHash("DocumentDB Stats Cache Hash",
+											 StatsCacheSize, StatsCacheSize,
+											 &info, HASH_ELEM | HASH_BLOBS);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+
+/*
+ * GetCachedStatsResponse returns a copy of the cached response for the
+ * namespace, collection and scale if there is one that is within the
+ * staleness bound of the session. Returns NULL otherwise.
+ */
+pgbson *
+GetCachedStatsResponse(const char *namespaceName, uint64 collectionId, int32 scale)
+{
+	if (StatsCacheMaxStalenessMs <= 0 || SharedStatsCacheHash == NULL)
+	{
+		return NULL;
+	}
+
+	StatsCacheKey key;
+	if (!InitializeStatsCacheKey(&key, namespaceName, collectionId, scale))
+	{
+		return NULL;
+	}
+
+	pgbson *response = NULL;
+	TimestampTz now = GetCurrentTimestamp();
+
+	LWLockAcquire(&StatsCacheSharedState->lock, LW_SHARED);
+	bool found = false;
+	StatsCacheEntry *entry = hash_search(SharedStatsCacheHash, &key, HASH_FIND, &found);
+	if (found && !TimestampDifferenceExceeds(entry->computedTime, now,
+											 StatsCacheMaxStalenessMs))
+	{
+		response = (pgbson *) palloc(entry->responseSize);
+		memcpy(response, entry->response, entry->responseSize);
+	}
+	LWLockRelease(&StatsCacheSharedState->lock);
+
+	ReportFeatureUsage(response != NULL ? FEATURE_USAGE_STATS_CACHE_HIT :
+					   FEATURE_USAGE_STATS_CACHE_MISS);
+	return response;
+}
+
+
+/*
+ * StoreCachedStatsResponse stores a freshly computed response in the cache,
+ * evicting the oldest response if the cache is full. The response is aged from
+ * computationStartTime, so that a slow computation does not extend the staleness
+ * bound past the time its data was read.
+ */
+void
+StoreCachedStatsResponse(const char *namespaceName, uint64 collectionId, int32 scale,
+						 TimestampTz computationStartTime, const pgbson *response)
+{
+	if (StatsCacheMaxStalenessMs <= 0 || SharedStatsCacheHash == NULL)
+	{
+		return;
+	}
+
+	uint32 responseSize = VARSIZE_ANY(response);
+	StatsCacheKey key;
+	if (responseSize > STATS_CACHE_MAX_RESPONSE_SIZE ||
+		!InitializeStatsCacheKey(&key, namespaceName, collectionId, scale))
+	{
+		return;
+	}
+
+	LWLockAcquire(&StatsCacheSharedState->lock, LW_EXCLUSIVE);
+
+	bool found = false;
+	StatsCacheEntry *entry = hash_search(SharedStatsCacheHash, &key, HASH_FIND, &found);
+	if (found && entry->computedTime >= computationStartTime)
+	{
+		/* a concurrent computation that started later already stored its response */
+		LWLockRelease(&StatsCacheSharedState->lock);
+		return;
+	}
+
+	if (!found && hash_get_num_entries(SharedStatsCacheHash) >= StatsCacheSize)
+	{
+		RemoveOldestStatsCacheEntry();
+	}
+
+	entry = hash_search(SharedStatsCacheHash, &key, HASH_ENTER_NULL, &found);
+	if (entry != NULL)
+	{
+		entry->computedTime = computationStartTime;
+		entry->responseSize = responseSize;
+		memcpy(entry->response, response, responseSize);
+	}
+
+	LWLockRelease(&StatsCacheSharedState->lock);
+}
+
+
+/*
+ * Builds the (zero padded) key for the hash, returns false if the
+ * namespace doesn't fit the key.
+ */
+static bool
+InitializeStatsCacheKey(StatsCacheKey *key, const char *namespaceName,
+						uint64 collectionId, int32 scale)
+{
+	if (strlen(namespaceName) > MAX_NAMESPACE_NAME_LENGTH)
+	{
+		return false;
+	}
+
+	memset(key, 0, sizeof(StatsCacheKey));
+	key->databaseId = MyDatabaseId;
+	strcpy(key->namespaceName, namespaceName);
+	key->collectionId = collectionId;
+	key->scale = scale;
+	return true;
+}
+
+
+/*
+ * Removes the oldest response from the cache. The cache is small and only
+ * written once per computed response, so a scan is good enough here.
+ * Must be called with the cache lock held exclusively.
+ */
+static void
+RemoveOldestStatsCacheEntry(void)
+{
+	HASH_SEQ_STATUS status;
+	StatsCacheEntry *entry;
+	StatsCacheEntry *oldestEntry = NULL;
+
+	hash_seq_init(&status, SharedStatsCacheHash);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		if (oldestEntry == NULL || entry->computedTime < oldestEntry->computedTime)
+		{
+			oldestEntry = entry;
+		}
+	}
+
+	if (oldestEntry != NULL)
+	{
+		bool found = false;
+		hash_search(SharedStatsCacheHash, &oldestEntry->key, HASH_REMOVE, &found);
+	}
+}
@@ -9,6 +9,8 @@
 
 #include <postgres.h>
 #include "utils/hsearch.h"
+#include "common/hashfn.h"
+#include "miscadmin.h"
 #include "io/bson_core.h"
 #include "query/bson_compare.h"
 #include "types/decimal128.h"
@@ -60,8 +62,14 @@ static SchemaNode * BuildSchemaTreeCore(bson_iter_t *schemaIter,
 										const char *field,
 										SchemaNodeType nodeType);
 static void BuildSchemaTreeCoreOnNode(bson_iter_t *schemaIter, SchemaNode *node);
+static void BuildSchemaTreeLookups(SchemaNode *node);
+static void BuildObjectFieldLookup(SchemaNode *node);
+static uint32 SchemaFieldLookupHashFunc(const void *obj, size_t objsize);
+static int SchemaFieldLookupCompareFunc(const void *obj1, const void *obj2,
+										Size objsize);
 
 extern bool EnableSchemaEnforcementForCSFLE;
+extern bool EnableJsonSchemaCompiledValidation;
 
 /* -------------------------------------------------------- */
 /*              Exported Functions                          */
@@ -76,6 +84,16 @@ BuildSchemaTree(SchemaTreeState *treeState, bson_iter_t *schemaIter)
 {
 	SchemaNode *node = BuildSchemaTreeCore(schemaIter, "",
 										   SchemaNodeType_Root);
+
+	/*
+	 * The tree is built once per schema and then used for every document, so
+	 * also build the field lookups that the validation uses for each field.
+	 */
+	if (EnableJsonSchemaCompiledValidation)
+	{
+		BuildSchemaTreeLookups(node);
+	}
+
 	treeState->rootNode = node;
 }
 
@@ -94,6 +112,14 @@ FindFieldNodeByName(const SchemaNode *node, const char *field)
 		return NULL;
 	}
 
+	if (node->validations.object->fieldLookup != NULL)
+	{
+		StringView fieldView = CreateStringViewFromString(field);
+		const SchemaFieldLookupEntry *entry = FindSchemaFieldLookupEntry(node,
+																		 &fieldView);
+		return entry != NULL ? entry->fieldNode : NULL;
+	}
+
 	SchemaFieldNode *fieldNode = node->validations.object->properties;
 	while (fieldNode != NULL)
 	{
@@ -108,6 +134,24 @@ FindFieldNodeByName(const SchemaNode *node, const char *field)
 }
 
 
+/*
+ * Returns the lookup entry (property node and required position) of the
+ * field for an object node with a built field lookup, NULL if the field is
+ * neither a property nor required.
+ */
+const SchemaFieldLookupEntry *
+FindSchemaFieldLookupEntry(const SchemaNode *node, const StringView *field)
+{
+	Assert(node->validations.object->fieldLookup != NULL);
+
+	SchemaFieldLookupEntry searchEntry = { .field = *field };
+	bool found = false;
+	SchemaFieldLookupEntry *entry = hash_search(node->validations.object->fieldLookup,
+												&searchEntry, HASH_FIND, &found);
+	return found ? entry : NULL;
+}
+
+
 /* -------------------------------------------------------- */
 /*              Core Functions                              */
 /* -------------------------------------------------------- */
@@ -1149,6 +1193,141 @@ FreeUnusedValidators(SchemaNode *node)
 }
 
 
+/*
+ * Walks the schema tree and builds the field lookup of every object node.
+ */
+static void
+BuildSchemaTreeLookups(SchemaNode *node)
+{
+	check_stack_depth();
+
+	if (node == NULL)
+	{
+		return;
+	}
+
+	if (node->validations.object != NULL)
+	{
+		SchemaFieldNode *fieldNode = node->validations.object->properties;
+		while (fieldNode != NULL)
+		{
+			BuildSchemaTreeLookups((SchemaNode *) fieldNode);
+			fieldNode = (SchemaFieldNode *) fieldNode->base.next;
+		}
+
+		BuildObjectFieldLookup(node);
+	}
+
+	if (node->validations.array != NULL)
+	{
+		uint16_t arrayFlags = node->validationFlags.array;
+		if (arrayFlags & ArrayValidationTypes_ItemsObject)
+		{
+			BuildSchemaTreeLookups((SchemaNode *) node->validations.array->itemsNode);
+		}
+		else if (arrayFlags & ArrayValidationTypes_ItemsArray)
+		{
+			SchemaNode *itemNode = (SchemaNode *) node->validations.array->itemsArray;
+			while (itemNode != NULL)
+			{
+				BuildSchemaTreeLookups(itemNode);
+				itemNode = itemNode->next;
+			}
+		}
+
+		if (arrayFlags & ArrayValidationTypes_AdditionalItemsObject)
+		{
+			BuildSchemaTreeLookups(
+				(SchemaNode *) node->validations.array->additionalItemsNode);
+		}
+	}
+}
+
+
+/*
+ * Builds the hash of the property and required field names of an
+ * object node, so that validating a document is a single lookup per field
+ * instead of a walk of the properties list and a hash of the required
+ * fields built for every document.
+ */
+static void
+BuildObjectFieldLookup(SchemaNode *node)
+{
+	ValidationsObject *object = node->validations.object;
+	if (object->properties == NULL &&
+		!(node->validationFlags.object & ObjectValidationTypes_Required))
+	{
+		return;
+	}
+
+	HASHCTL hashInfo = CreateExtensionHashCTL(
+		sizeof(StringView),
+		sizeof(SchemaFieldLookupEntry),
+		SchemaFieldLookupCompareFunc,
+		SchemaFieldLookupHashFunc);
+	HTAB *fieldLookup = hash_create("JSON Schema Field Lookup", 16, &hashInfo,
+									DefaultExtensionHashFlags);
+
+	bool found = false;
+	SchemaFieldNode *fieldNode = object->properties;
+	while (fieldNode != NULL)
+	{
+		SchemaFieldLookupEntry *entry = hash_search(fieldLookup, &fieldNode->field,
+													HASH_ENTER, &found);
+		if (!found)
+		{
+			entry->fieldNode = fieldNode;
+			entry->requiredIndex = -1;
+		}
+
+		fieldNode = (SchemaFieldNode *) fieldNode->base.next;
+	}
+
+	int32_t numRequiredFields = 0;
+	if (node->validationFlags.object & ObjectValidationTypes_Required)
+	{
+		bson_iter_t iter;
+		BsonValueInitIterator(object->required, &iter);
+		while (bson_iter_next(&iter))
+		{
+			uint32_t length = 0;
+			const char *field = bson_iter_utf8(&iter, &length);
+			StringView fieldView = { .string = field, .length = length };
+			SchemaFieldLookupEntry *entry = hash_search(fieldLookup, &fieldView,
+														HASH_ENTER, &found);
+			if (!found)
+			{
+				entry->fieldNode = NULL;
+			}
+
+			/* 'required' has no duplicates, this is validated when parsing it */
+			entry->requiredIndex = numRequiredFields++;
+		}
+	}
+
+	object->fieldLookup = fieldLookup;
+	object->numRequiredFields = numRequiredFields;
+}
+
+
+static uint32
+SchemaFieldLookupHashFunc(const void *obj, size_t objsize)
+{
+	const SchemaFieldLookupEntry *entry = (const SchemaFieldLookupEntry *) obj;
+	return hash_bytes((const unsigned char *) entry->field.string,
+					  (int) entry->field.length);
+}
+
+
+static int
+SchemaFieldLookupCompareFunc(const void *obj1, const void *obj2, Size objsize)
+{
+	const SchemaFieldLookupEntry *entry1 = (const SchemaFieldLookupEntry *) obj1;
+	const SchemaFieldLookupEntry *entry2 = (const SchemaFieldLookupEntry *) obj2;
+	return CompareStringView(&entry1->field, &entry2->field);
+}
+
+
 static inline ValidationsObject *
 InitValidationsObject(void)
 {
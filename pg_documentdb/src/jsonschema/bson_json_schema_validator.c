@@ -13,6 +13,7 @@
 #include <fmgr.h>
 #include <funcapi.h>
 #include <miscadmin.h>
+#include <common/hashfn.h>
 
 #include "io/bson_core.h"
 #include "query/bson_compare.h"
@@ -33,11 +34,23 @@ typedef struct BsonKeyValuePair
 	List *subDocKvList;
 } BsonKeyValuePair;
 
+/* Documents of an array with the same key order independent hash */
+typedef struct UnorderedDocumentHashEntry
+{
+	/* The key order independent hash of the documents (key of the hash) */
+	uint32 documentHash;
+
+	/* List of bson_value_t * of the documents with this hash */
+	List *documents;
+} UnorderedDocumentHashEntry;
+
 static bool ValidateBsonValueAgainstSchemaTree(const bson_value_t *value,
 											   const SchemaNode *node);
 
 static bool ValidateBsonValueCommon(const bson_value_t *value,
 									const SchemaNode *node);
+static bool ValidateBsonValueObjectWithLookup(const bson_value_t *value,
+											  const SchemaNode *node);
 static bool ValidateBsonValueObject(const bson_value_t *value,
 									const SchemaNode *node);
 static bool ValidateBsonValueString(const bson_value_t *value,
@@ -61,8 +74,13 @@ static int CompareBsonKvPairs(BsonKeyValuePair *pairA, BsonKeyValuePair *pairB,
 static List * GetSortedListOfKeyValuePairs(const bson_value_t *value);
 
 static bool IsBsonArrayUnique(const bson_value_t *value, bool ignoreKeyOrderInObject);
+static bool IsBsonArrayUniqueWithDocumentHash(const bson_value_t *value);
+static uint32 GetUnorderedDocumentHash(const bson_value_t *value);
+static bool AreDocumentsEqualIgnoringKeyOrder(const bson_value_t *documentA,
+											  const bson_value_t *documentB);
 
 extern bool EnableSchemaEnforcementForCSFLE;
+extern bool EnableJsonSchemaCompiledValidation;
 
 /* --------------------------------------------------------- */
 /* Top level exports */
@@ -207,6 +225,11 @@ ValidateBsonValueObject(const bson_value_t *value, const SchemaNode *node)
 		return true;
 	}
 
+	if (node->validations.object->fieldLookup != NULL)
+	{
+		return ValidateBsonValueObjectWithLookup(value, node);
+	}
+
 	HTAB *hashTableForRequired = NULL;
 	bool isRequiredValid = false;
 	int requiredCount = 0;
@@ -279,6 +302,60 @@ ValidateBsonValueObject(const bson_value_t *value, const SchemaNode *node)
 }
 
 
+/*
+ * Same as ValidateBsonValueObject for an object node with a built field
+ * lookup: every field of the document is a single hash lookup for both its
+ * property node and whether it is required.
+ */
+static bool
+ValidateBsonValueObjectWithLookup(const bson_value_t *value, const SchemaNode *node)
+{
+	int32_t numRequiredFields = node->validations.object->numRequiredFields;
+	bool *seenRequiredFields = numRequiredFields > 0 ?
+							   palloc0(sizeof(bool) * numRequiredFields) : NULL;
+	int32_t requiredCount = numRequiredFields;
+
+	bson_iter_t iter;
+	BsonValueInitIterator(value, &iter);
+	while (bson_iter_next(&iter))
+	{
+		StringView fieldView = {
+			.string = bson_iter_key(&iter),
+			.length = bson_iter_key_len(&iter)
+		};
+
+		const SchemaFieldLookupEntry *entry = FindSchemaFieldLookupEntry(node,
+																		 &fieldView);
+		if (entry == NULL)
+		{
+			continue;
+		}
+
+		if (entry->fieldNode != NULL &&
+			!ValidateBsonValueAgainstSchemaTree(bson_iter_value(&iter),
+												(SchemaNode *) entry->fieldNode))
+		{
+			return false;
+		}
+
+		if (entry->requiredIndex >= 0 && !seenRequiredFields[entry->requiredIndex])
+		{
+			seenRequiredFields[entry->requiredIndex] = true;
+			requiredCount--;
+		}
+	}
+
+	if (seenRequiredFields != NULL)
+	{
+		pfree(seenRequiredFields);
+	}
+
+	/* TODO: Add more object validations here */
+
+	return requiredCount == 0;
+}
+
+
 /*
  * Validate given bson value against given Json Schema tree / sub-tree for
  * String validations set:
@@ -586,6 +663,11 @@ bool
 IsBsonArrayUnique(const bson_value_t *value, bool ignoreKeyOrderInObject)
 {
 	Assert(value->value_type == BSON_TYPE_ARRAY);
+	if (ignoreKeyOrderInObject && EnableJsonSchemaCompiledValidation)
+	{
+		return IsBsonArrayUniqueWithDocumentHash(value);
+	}
+
 	HTAB *bsonValueHashSet = CreateBsonValueHashSet();
 	List *docsList = NIL;
 	bool found = false;
@@ -637,6 +719,138 @@ IsBsonArrayUnique(const bson_value_t *value, bool ignoreKeyOrderInObject)
 }
 
 
+/*
+ * Same as IsBsonArrayUnique when the key order in objects is ignored, but
+ * instead of comparing the sorted key value lists of every document against
+ * all the previous documents, documents are hashed with a key order
+ * independent hash and only documents with the same hash are compared.
+ */
+static bool
+IsBsonArrayUniqueWithDocumentHash(const bson_value_t *value)
+{
+	HTAB *bsonValueHashSet = CreateBsonValueHashSet();
+
+	HASHCTL hashInfo;
+	memset(&hashInfo, 0, sizeof(HASHCTL));
+	hashInfo.keysize = sizeof(uint32);
+	hashInfo.entrysize = sizeof(UnorderedDocumentHashEntry);
+	hashInfo.hcxt = CurrentMemoryContext;
+	HTAB *documentHashSet = hash_create("JSON Schema Unique Documents Hash", 32,
+										&hashInfo,
+										HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	bool isUnique = true;
+	bool found = false;
+	bson_iter_t arrayIter;
+	BsonValueInitIterator(value, &arrayIter);
+	while (isUnique && bson_iter_next(&arrayIter))
+	{
+		const bson_value_t *arrayValue = bson_iter_value(&arrayIter);
+		hash_search(bsonValueHashSet, arrayValue, HASH_ENTER, &found);
+		if (found)
+		{
+			isUnique = false;
+			break;
+		}
+
+		/* Empty documents are already found as duplicates by the first hash */
+		if (arrayValue->value_type != BSON_TYPE_DOCUMENT ||
+			IsBsonValueEmptyDocument(arrayValue))
+		{
+			continue;
+		}
+
+		uint32 documentHash = GetUnorderedDocumentHash(arrayValue);
+		UnorderedDocumentHashEntry *entry = hash_search(documentHashSet, &documentHash,
+														HASH_ENTER, &found);
+		if (!found)
+		{
+			entry->documents = NIL;
+		}
+
+		ListCell *cell;
+		foreach(cell, entry->documents)
+		{
+			if (AreDocumentsEqualIgnoringKeyOrder(lfirst(cell), arrayValue))
+			{
+				isUnique = false;
+				break;
+			}
+		}
+
+		bson_value_t *document = palloc(sizeof(bson_value_t));
+		*document = *arrayValue;
+		entry->documents = lappend(entry->documents, document);
+	}
+
+	hash_destroy(bsonValueHashSet);
+	hash_destroy(documentHashSet);
+	return isUnique;
+}
+
+
+/*
+ * Returns a hash of the document that doesn't depend on the order of its keys
+ * (at any depth of nested documents) and is equal for documents the sorted
+ * key value list comparison considers equal. Numbers that aren't integers
+ * all hash the same since they can compare equal across numeric types.
+ */
+static uint32
+GetUnorderedDocumentHash(const bson_value_t *value)
+{
+	check_stack_depth();
+
+	uint32 documentHash = 0;
+	bson_iter_t iter;
+	BsonValueInitIterator(value, &iter);
+	while (bson_iter_next(&iter))
+	{
+		const bson_value_t *fieldValue = bson_iter_value(&iter);
+		uint32 valueHash;
+		if (fieldValue->value_type == BSON_TYPE_DOCUMENT)
+		{
+			valueHash = GetUnorderedDocumentHash(fieldValue);
+		}
+		else if (BsonValueIsNumber(fieldValue))
+		{
+			bool checkFixedInteger = true;
+			int64 integerValue = IsBsonValue64BitInteger(fieldValue, checkFixedInteger) ?
+								 BsonValueAsInt64(fieldValue) : 0;
+			valueHash = hash_bytes((const unsigned char *) &integerValue,
+								   sizeof(int64));
+		}
+		else
+		{
+			valueHash = BsonValueHashUint32(fieldValue);
+		}
+
+		uint32 keyHash = hash_bytes((const unsigned char *) bson_iter_key(&iter),
+									bson_iter_key_len(&iter));
+
+		/* Adding the hash of each field makes it independent of the field order */
+		documentHash += hash_combine(keyHash, valueHash);
+	}
+
+	return documentHash;
+}
+
+
+static bool
+AreDocumentsEqualIgnoringKeyOrder(const bson_value_t *documentA,
+								  const bson_value_t *documentB)
+{
+	List *docKvListA = GetSortedListOfKeyValuePairs(documentA);
+	List *docKvListB = GetSortedListOfKeyValuePairs(documentB);
+
+	bool isComparisonValid = true;
+	int cmp = CompareBsonDocKvLists(docKvListA, docKvListB, &isComparisonValid);
+
+	FreeDocKvList(docKvListA);
+	FreeDocKvList(docKvListB);
+	return isComparisonValid && cmp == 0;
+}
+
+
 /* --------------------------------------------------------- */
 /* Helper Functions */
 /* --------------------------------------------------------- */
@@ -31,6 +31,7 @@
 #include "utils/version_utils.h"
 
 #include "metadata/collection.h"
+#include "metadata/collection_shared_cache.h"
 #include "metadata/metadata_cache.h"
 #include "utils/documentdb_errors.h"
 #include "metadata/relation_utils.h"
@@ -41,6 +42,7 @@
 #include "commands/parse_error.h"
 #include "utils/feature_counter.h"
 #include "jsonschema/bson_json_schema_tree.h"
+#include "infrastructure/documentdb_plan_cache.h"
 
 #define CREATE_COLLECTION_FUNC_NARGS 2
 
@@ -247,6 +249,9 @@ InvalidateCollectionByRelationId(Oid relationId)
 	{
 		MongoCollection *collection = &(entryById->collection);
 
+		/* plans learnt for the collection may no longer apply */
+		InvalidateSharedQueryPlanHints(collection->collectionId);
+
 		/* delete entry from the collection name -> collection cache */
 		NameToCollectionCacheEntry *entryByName =
 			hash_search(NameToCollectionHash, &(collection->name),
@@ -344,21 +349,40 @@ GetMongoCollectionByColId(uint64 collectionId, LOCKMODE lockMode)
 	MongoCollection collection;
 	memset(&collection, 0, sizeof(collection));
 
-	/*
-	 * Temporarily disable unimportant logs related to collection catalog lookup
-	 * so that regression test outputs don't become flaky (e.g.: due to commands
-	 * being executed by Citus locally).
-	 */
-	int savedGUCLevel = NewGUCNestLevel();
-	SetGUCLocally("client_min_messages", "WARNING");
+	/* other backends may have read the catalog row already */
+	bool collectionExists = false;
+	bool foundInSharedCache =
+		TryGetSharedCollectionByRelationId(documentsTableOid, &collection) &&
+		collection.collectionId == collectionId;
+	uint64 sharedCacheVersion = GetSharedCollectionCacheVersion();
 
-	/* Read the collection metadata from ApiCatalogSchemaName.collections */
-	bool collectionExists =
-		GetMongoCollectionFromCatalogById(collectionId, documentsTableOid,
-										  &collection);
+	if (foundInSharedCache)
+	{
+		collectionExists = true;
+		collection.relationId = documentsTableOid;
+		if (collection.shardKey == NULL && collection.viewDefinition == NULL)
+		{
+			TrySetCollectionShard(&collection);
+		}
+	}
+	else
+	{
+		/*
+		 * Temporarily disable unimportant logs related to collection catalog lookup
+		 * so that regression test outputs don't become flaky (e.g.: due to commands
+		 * being executed by Citus locally).
+		 */
+		int savedGUCLevel = NewGUCNestLevel();
+		SetGUCLocally("client_min_messages", "WARNING");
 
-	/* rollback the GUC change that we made for client_min_messages */
-	RollbackGUCChange(savedGUCLevel);
+		/* Read the collection metadata from ApiCatalogSchemaName.collections */
+		collectionExists =
+			GetMongoCollectionFromCatalogById(collectionId, documentsTableOid,
+											  &collection);
+
+		/* rollback the GUC change that we made for client_min_messages */
+		RollbackGUCChange(savedGUCLevel);
+	}
 
 	if (!collectionExists)
 	{
@@ -382,6 +406,11 @@ GetMongoCollectionByColId(uint64 collectionId, LOCKMODE lockMode)
 		return NULL;
 	}
 
+	if (!foundInSharedCache)
+	{
+		StoreSharedCollection(&collection, sharedCacheVersion);
+	}
+
 	/* if we experience OOM below, reset the cache to prevent corruption */
 	CollectionCacheIsValid = false;
 
@@ -684,26 +713,34 @@ GetMongoCollectionByNameDatumCore(Datum databaseNameDatum, Datum collectionNameD
 	MongoCollection collection;
 	memset(&collection, 0, sizeof(collection));
 
-	/*
-	 * Temporarily disable unimportant logs related to collection catalog lookup
-	 * so that regression test outputs don't become flaky (e.g.: due to commands
-	 * being executed by Citus locally).
-	 */
-	int savedGUCLevel = NewGUCNestLevel();
-	SetGUCLocally("client_min_messages", "WARNING");
+	/* other backends may have read the catalog row already */
+	bool collectionExists = TryGetSharedCollectionByName(&qualifiedName, &collection);
+	bool foundInSharedCache = collectionExists;
+	uint64 sharedCacheVersion = GetSharedCollectionCacheVersion();
 
-	/*
-	 * Read the collection metadata from ApiCatalogSchemaName.collections or error
-	 * out if the collection does not exist. (We do not cache negative entries,
-	 * since we expect them to be rare)
-	 */
-	bool collectionExists =
-		GetMongoCollectionFromCatalogByNameDatum(databaseNameDatum,
-												 collectionNameDatum,
-												 &collection);
+	if (!foundInSharedCache)
+	{
+		/*
+		 * Temporarily disable unimportant logs related to collection catalog lookup
+		 * so that regression test outputs don't become flaky (e.g.: due to commands
+		 * being executed by Citus locally).
+		 */
+		int savedGUCLevel = NewGUCNestLevel();
+		SetGUCLocally("client_min_messages", "WARNING");
 
-	/* rollback the GUC change that we made for client_min_messages */
-	RollbackGUCChange(savedGUCLevel);
+		/*
+		 * Read the collection metadata from ApiCatalogSchemaName.collections or error
+		 * out if the collection does not exist. (We do not cache negative entries,
+		 * since we expect them to be rare)
+		 */
+		collectionExists =
+			GetMongoCollectionFromCatalogByNameDatum(databaseNameDatum,
+													 collectionNameDatum,
+													 &collection);
+
+		/* rollback the GUC change that we made for client_min_messages */
+		RollbackGUCChange(savedGUCLevel);
+	}
 
 	if (!collectionExists)
 	{
@@ -729,6 +766,10 @@ GetMongoCollectionByNameDatumCore(Datum databaseNameDatum, Datum collectionNameD
 		}
 	}
 
+	if (!foundInSharedCache)
+	{
+		StoreSharedCollection(&collection, sharedCacheVersion);
+	}
 
 	/* if we experience OOM below, reset the cache to prevent corruption */
 	CollectionCacheIsValid = false;
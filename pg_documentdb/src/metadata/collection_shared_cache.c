@@ -0,0 +1,713 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/metadata/collection_shared_cache.c
+ *
+ * Implementation of a shared cache of the ApiCatalogSchemaName.collections
+ * rows.
+ *
+ * Every backend keeps its own collections cache (see collection.c) and fills
+ * it with an SPI query on the catalog. With many collections and short lived
+ * backends most of those queries read rows that another backend just read,
+ * so the catalog rows are also kept in shared memory, keyed by database and
+ * name and by database and the relation ID of the data table.
+ *
+ * The cache is kept in sync through the same relcache invalidations as the
+ * backend caches: an invalidation of a data table removes its entry, and a
+ * full invalidation (which is what updates and deletes of the catalog send)
+ * bumps the reset version so that all entries older than it are ignored.
+ * Since a backend reads the catalog before it stores the row, every
+ * invalidation also bumps the cache version and a row is only stored if no
+ * invalidation happened since the read started. The writing backend executes
+ * its own invalidations before it commits, so they are applied once more
+ * after the commit.
+ *
+ * Transactions that wrote anything (and so may have changed the catalog) and
+ * transactions with a transaction snapshot neither read from nor write to
+ * the shared cache.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include <postgres.h>
+#include <miscadmin.h>
+#include <access/transam.h>
+#include <access/xact.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/hsearch.h>
+#include <nodes/pg_list.h>
+#include <utils/memutils.h>
+
+#include "metadata/collection_shared_cache.h"
+
+/* Rows with larger shard keys, views and validators in total are not cached */
+#define SHARED_COLLECTION_MAX_DATA_SIZE 2048
+
+/* Transactions invalidating more relations than this reset the cache on commit */
+#define MAX_PENDING_SHARED_INVALIDATIONS 64
+
+/* SharedCollectionNameKey is used as the key of a collection in the name hash */
+typedef struct SharedCollectionNameKey
+{
+	Oid databaseId;
+
+	MongoCollectionName name;
+} SharedCollectionNameKey;
+
+/* SharedCollectionRelationIdKey is used as the key in the relation ID hash */
+typedef struct SharedCollectionRelationIdKey
+{
+	Oid databaseId;
+
+	Oid relationId;
+} SharedCollectionRelationIdKey;
+
+typedef struct SharedCollectionCacheEntry
+{
+	/* key of the entry in the name hash (must be first) */
+	SharedCollectionNameKey key;
+
+	/* the reset version at the time the entry was stored */
+	uint64 resetVersion;
+
+	uint64 collectionId;
+
+	/* the relation ID of the data table (InvalidOid for views) */
+	Oid relationId;
+
+	pg_uuid_t collectionUUID;
+
+	ValidationLevels validationLevel;
+
+	ValidationActions validationAction;
+
+	/* sizes of the shard key, view definition and validator in data (0 if NULL) */
+	uint32 shardKeySize;
+	uint32 viewDefinitionSize;
+	uint32 validatorSize;
+	char data[SHARED_COLLECTION_MAX_DATA_SIZE];
+} SharedCollectionCacheEntry;
+
+typedef struct SharedCollectionRelationIdEntry
+{
+	/* key of the entry in the relation ID hash (must be first) */
+	SharedCollectionRelationIdKey key;
+
+	/* name of the collection in the name hash */
+	MongoCollectionName name;
+} SharedCollectionRelationIdEntry;
+
+/*
+ * Shared state of the collection cache.
+ */
+typedef struct SharedCollectionCacheData
+{
+	/* The tranche id of the cache lock */
+	int trancheId;
+
+	/* The tranche name of the cache lock */
+	char *trancheName;
+
+	/* Lock protecting the shared hashes */
+	LWLock lock;
+
+	/* Bumped on every invalidation, a row read before a bump is not stored */
+	pg_atomic_uint64 cacheVersion;
+
+	/* Bumped on full invalidations, entries stored before a bump are ignored */
+	pg_atomic_uint64 resetVersion;
+
+	/* The reset version for which the entries older than it were removed */
+	uint64 sweptResetVersion;
+} SharedCollectionCacheData;
+
+static void InitializeSharedCollectionNameKey(SharedCollectionNameKey *key,
+											  const MongoCollectionName *name);
+static void InitializeSharedCollectionRelationIdKey(SharedCollectionRelationIdKey *key,
+													Oid relationId);
+static void InvalidateSharedCollectionByRelationIdCore(Oid relationId);
+static void ResetSharedCollectionCacheCore(void);
+static void AddPendingSharedInvalidation(Oid relationId);
+static bool IsSharedCollectionEntryValid(SharedCollectionCacheEntry *entry);
+static void CopySharedCollectionEntry(SharedCollectionCacheEntry *entry,
+									  MongoCollection *collection);
+static bool RemoveStaleSharedCollections(void);
+static void RemoveSharedCollection(SharedCollectionCacheEntry *entry);
+
+/* number of collections allowed in the shared cache, 0 disables the cache */
+extern int SharedCollectionCacheSize;
+
+/* shared state of the collection cache (NULL if not available) */
+static SharedCollectionCacheData *SharedCollectionCacheState = NULL;
+
+/* shared hash (SharedCollectionNameKey -> SharedCollectionCacheEntry) */
+static HTAB *SharedCollectionNameHash = NULL;
+
+/* shared hash (SharedCollectionRelationIdKey -> SharedCollectionRelationIdEntry) */
+static HTAB *SharedCollectionRelationIdHash = NULL;
+
+/* relations invalidated by the current transaction (in TopMemoryContext) */
+static List *PendingSharedInvalidations = NIL;
+
+/* whether the current transaction reset the cache */
+static bool PendingSharedReset = false;
+
+
+/*
+ * SharedCollectionCacheShmemSize returns the shared memory needed for the
+ * collection cache.
+ */
+Size
+SharedCollectionCacheShmemSize(void)
+{
+	Size size = MAXALIGN(sizeof(SharedCollectionCacheData));
+	if (SharedCollectionCacheSize > 0)
+	{
+		size = add_size(size, hash_estimate_size(SharedCollectionCacheSize,
+												 sizeof(SharedCollectionCacheEntry)));
+		size = add_size(size, hash_estimate_size(SharedCollectionCacheSize,
+												 sizeof(
+													 SharedCollectionRelationIdEntry)));
+	}
+
+	return size;
+}
+
+
+/*
+ * InitializeSharedCollectionCacheShmem initializes the shared collection cache.
+ */
+void
+InitializeSharedCollectionCacheShmem(void)
+{
+	bool found = false;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	SharedCollectionCacheState =
+		(SharedCollectionCacheData *) ShmemInitStruct(
+			"DocumentDB Shared Collection Cache Data",
+			sizeof(SharedCollectionCacheData),
+			&found);
+
+	if (!found)
+	{
+		SharedCollectionCacheState->trancheId = LWLockNewTrancheId();
+		SharedCollectionCacheState->trancheName =
+			"DocumentDB Shared Collection Cache Tranche";
+		LWLockRegisterTranche(SharedCollectionCacheState->trancheId,
+							  SharedCollectionCacheState->trancheName);
+		LWLockInitialize(&SharedCollectionCacheState->lock,
+						 SharedCollectionCacheState->trancheId);
+		pg_atomic_init_u64(&SharedCollectionCacheState->cacheVersion, 0);
+		pg_atomic_init_u64(&SharedCollectionCacheState->resetVersion, 0);
+		SharedCollectionCacheState->sweptResetVersion = 0;
+	}
+
+	if (SharedCollectionCacheSize > 0)
+	{
+		HASHCTL info;
+		memset(&info, 0, sizeof(info));
+		info.keysize = sizeof(SharedCollectionNameKey);
+		info.entrysize = sizeof(SharedCollectionCacheEntry);
+		SharedCollectionNameHash = ShmemInitHash(
+			"DocumentDB Shared Collection Name Hash",
+			SharedCollectionCacheSize, SharedCollectionCacheSize,
+			&info, HASH_ELEM | HASH_BLOBS);
+
+		memset(&info, 0, sizeof(info));
+		info.keysize = sizeof(SharedCollectionRelationIdKey);
+		info.entrysize = sizeof(SharedCollectionRelationIdEntry);
+		SharedCollectionRelationIdHash = ShmemInitHash(
+			"DocumentDB Shared Collection Relation Id Hash",
+			SharedCollectionCacheSize, SharedCollectionCacheSize,
+			&info, HASH_ELEM | HASH_BLOBS);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+
+/*
+ * Whether the current transaction can read from and write to the shared cache.
+ */
+bool
+CanUseSharedCollectionCache(void)
+{
+	return SharedCollectionNameHash != NULL &&
+		   !IsolationUsesXactSnapshot() &&
+		   !TransactionIdIsValid(GetTopTransactionIdIfAny());
+}
+
+
+/*
+ * Returns the version to pass to StoreSharedCollection for a row that is
+ * about to be read from the catalog.
+ */
+uint64
+GetSharedCollectionCacheVersion(void)
+{
+	if (SharedCollectionCacheState == NULL)
+	{
+		return 0;
+	}
+
+	return pg_atomic_read_u64(&SharedCollectionCacheState->cacheVersion);
+}
+
+
+/*
+ * TryGetSharedCollectionByName fills the catalog fields of the collection
+ * from the shared cache. Returns false if the collection is not cached.
+ */
+bool
+TryGetSharedCollectionByName(const MongoCollectionName *name,
+							 MongoCollection *collection)
+{
+	if (!CanUseSharedCollectionCache())
+	{
+		return false;
+	}
+
+	SharedCollectionNameKey key;
+	InitializeSharedCollectionNameKey(&key, name);
+
+	bool found = false;
+	LWLockAcquire(&SharedCollectionCacheState->lock, LW_SHARED);
+	SharedCollectionCacheEntry *entry = hash_search(SharedCollectionNameHash, &key,
+													HASH_FIND, &found);
+	found = found && IsSharedCollectionEntryValid(entry);
+	if (found)
+	{
+		CopySharedCollectionEntry(entry, collection);
+	}
+	LWLockRelease(&SharedCollectionCacheState->lock);
+
+	return found;
+}
+
+
+/*
+ * TryGetSharedCollectionByRelationId fills the catalog fields of the collection
+ * backed by the given data table from the shared cache. Returns false if the
+ * collection is not cached.
+ */
+bool
+TryGetSharedCollectionByRelationId(Oid relationId, MongoCollection *collection)
+{
+	if (!CanUseSharedCollectionCache())
+	{
+		return false;
+	}
+
+	SharedCollectionRelationIdKey key;
+	InitializeSharedCollectionRelationIdKey(&key, relationId);
+
+	bool found = false;
+	LWLockAcquire(&SharedCollectionCacheState->lock, LW_SHARED);
+	SharedCollectionRelationIdEntry *relationIdEntry =
+		hash_search(SharedCollectionRelationIdHash, &key, HASH_FIND, &found);
+	if (found)
+	{
+		SharedCollectionNameKey nameKey;
+		InitializeSharedCollectionNameKey(&nameKey, &relationIdEntry->name);
+		SharedCollectionCacheEntry *entry = hash_search(SharedCollectionNameHash,
+														&nameKey, HASH_FIND, &found);
+		found = found && entry->relationId == relationId &&
+				IsSharedCollectionEntryValid(entry);
+		if (found)
+		{
+			CopySharedCollectionEntry(entry, collection);
+		}
+	}
+	LWLockRelease(&SharedCollectionCacheState->lock);
+
+	return found;
+}
+
+
+/*
+ * StoreSharedCollection stores the catalog fields of a collection read from the
+ * catalog, unless an invalidation happened since the cacheVersion was obtained
+ * (the row may already be stale then) or the cache is full.
+ */
+void
+StoreSharedCollection(const MongoCollection *collection, uint64 cacheVersion)
+{
+	if (!CanUseSharedCollectionCache())
+	{
+		return;
+	}
+
+	uint32 shardKeySize = collection->shardKey != NULL ?
+						  VARSIZE(collection->shardKey) : 0;
+	uint32 viewDefinitionSize = collection->viewDefinition != NULL ?
+								VARSIZE(collection->viewDefinition) : 0;
+	uint32 validatorSize = collection->schemaValidator.validator != NULL ?
+						   VARSIZE(collection->schemaValidator.validator) : 0;
+	if ((uint64) shardKeySize + viewDefinitionSize + validatorSize >
+		SHARED_COLLECTION_MAX_DATA_SIZE)
+	{
+		return;
+	}
+
+	SharedCollectionNameKey key;
+	InitializeSharedCollectionNameKey(&key, &collection->name);
+
+	LWLockAcquire(&SharedCollectionCacheState->lock, LW_EXCLUSIVE);
+
+	if (pg_atomic_read_u64(&SharedCollectionCacheState->cacheVersion) != cacheVersion)
+	{
+		LWLockRelease(&SharedCollectionCacheState->lock);
+		return;
+	}
+
+	bool found = false;
+	hash_search(SharedCollectionNameHash, &key, HASH_FIND, &found);
+	if (!found &&
+		hash_get_num_entries(SharedCollectionNameHash) >= SharedCollectionCacheSize &&
+		!RemoveStaleSharedCollections())
+	{
+		LWLockRelease(&SharedCollectionCacheState->lock);
+		return;
+	}
+
+	SharedCollectionCacheEntry *entry = hash_search(SharedCollectionNameHash, &key,
+													HASH_ENTER_NULL, &found);
+	if (entry == NULL)
+	{
+		LWLockRelease(&SharedCollectionCacheState->lock);
+		return;
+	}
+
+	SharedCollectionRelationIdKey relationIdKey;
+	if (found && OidIsValid(entry->relationId) &&
+		entry->relationId != collection->relationId)
+	{
+		/* the name now points to a different table */
+		bool foundRelationId = false;
+		InitializeSharedCollectionRelationIdKey(&relationIdKey, entry->relationId);
+		hash_search(SharedCollectionRelationIdHash, &relationIdKey, HASH_REMOVE,
+					&foundRelationId);
+	}
+
+	entry->resetVersion = pg_atomic_read_u64(&SharedCollectionCacheState->resetVersion);
+	entry->collectionId = collection->collectionId;
+	entry->relationId = collection->viewDefinition == NULL ?
+						collection->relationId : InvalidOid;
+	entry->collectionUUID = collection->collectionUUID;
+	entry->validationLevel = collection->schemaValidator.validationLevel;
+	entry->validationAction = collection->schemaValidator.validationAction;
+	entry->shardKeySize = shardKeySize;
+	entry->viewDefinitionSize = viewDefinitionSize;
+	entry->validatorSize = validatorSize;
+
+	char *data = entry->data;
+	if (shardKeySize > 0)
+	{
+		memcpy(data, collection->shardKey, shardKeySize);
+		data += shardKeySize;
+	}
+
+	if (viewDefinitionSize > 0)
+	{
+		memcpy(data, collection->viewDefinition, viewDefinitionSize);
+		data += viewDefinitionSize;
+	}
+
+	if (validatorSize > 0)
+	{
+		memcpy(data, collection->schemaValidator.validator, validatorSize);
+	}
+
+	if (OidIsValid(entry->relationId))
+	{
+		InitializeSharedCollectionRelationIdKey(&relationIdKey, entry->relationId);
+		SharedCollectionRelationIdEntry *relationIdEntry =
+			hash_search(SharedCollectionRelationIdHash, &relationIdKey,
+						HASH_ENTER_NULL, &found);
+		if (relationIdEntry != NULL)
+		{
+			relationIdEntry->name = entry->key.name;
+		}
+	}
+
+	LWLockRelease(&SharedCollectionCacheState->lock);
+}
+
+
+/*
+ * InvalidateSharedCollectionByRelationId is called for relcache invalidations
+ * of a specific relation and removes the collection backed by it, if any.
+ */
+void
+InvalidateSharedCollectionByRelationId(Oid relationId)
+{
+	if (SharedCollectionNameHash == NULL)
+	{
+		return;
+	}
+
+	InvalidateSharedCollectionByRelationIdCore(relationId);
+
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+	{
+		/* other backends may read the old row again until we commit */
+		AddPendingSharedInvalidation(relationId);
+	}
+}
+
+
+/*
+ * ResetSharedCollectionCache is called for full relcache invalidations (and
+ * invalidations of the catalog) and makes all the cached entries stale.
+ * The entries are removed lazily when space is needed.
+ */
+void
+ResetSharedCollectionCache(void)
+{
+	if (SharedCollectionNameHash == NULL)
+	{
+		return;
+	}
+
+	ResetSharedCollectionCacheCore();
+
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+	{
+		PendingSharedReset = true;
+	}
+}
+
+
+/*
+ * ApplyPendingSharedCollectionInvalidations is called at the end of a
+ * transaction. On commit, it applies the invalidations of the transaction
+ * once more, since rows read by other backends before the commit may have
+ * been stored after they were first applied.
+ */
+void
+ApplyPendingSharedCollectionInvalidations(bool isCommit)
+{
+	if (isCommit)
+	{
+		if (PendingSharedReset)
+		{
+			ResetSharedCollectionCacheCore();
+		}
+		else
+		{
+			ListCell *relationIdCell;
+			foreach(relationIdCell, PendingSharedInvalidations)
+			{
+				InvalidateSharedCollectionByRelationIdCore(lfirst_oid(relationIdCell));
+			}
+		}
+	}
+
+	list_free(PendingSharedInvalidations);
+	PendingSharedInvalidations = NIL;
+	PendingSharedReset = false;
+}
+
+
+static void
+InvalidateSharedCollectionByRelationIdCore(Oid relationId)
+{
+	pg_atomic_fetch_add_u64(&SharedCollectionCacheState->cacheVersion, 1);
+
+	SharedCollectionRelationIdKey key;
+	InitializeSharedCollectionRelationIdKey(&key, relationId);
+
+	/* Most relations are not cached collections, check that first */
+	bool found = false;
+	LWLockAcquire(&SharedCollectionCacheState->lock, LW_SHARED);
+	hash_search(SharedCollectionRelationIdHash, &key, HASH_FIND, &found);
+	LWLockRelease(&SharedCollectionCacheState->lock);
+
+	if (!found)
+	{
+		return;
+	}
+
+	LWLockAcquire(&SharedCollectionCacheState->lock, LW_EXCLUSIVE);
+	SharedCollectionRelationIdEntry *relationIdEntry =
+		hash_search(SharedCollectionRelationIdHash, &key, HASH_FIND, &found);
+	if (found)
+	{
+		SharedCollectionNameKey nameKey;
+		InitializeSharedCollectionNameKey(&nameKey, &relationIdEntry->name);
+		SharedCollectionCacheEntry *entry = hash_search(SharedCollectionNameHash,
+														&nameKey, HASH_FIND, &found);
+		if (found && entry->relationId == relationId)
+		{
+			RemoveSharedCollection(entry);
+		}
+		else
+		{
+			hash_search(SharedCollectionRelationIdHash, &key, HASH_REMOVE, &found);
+		}
+	}
+	LWLockRelease(&SharedCollectionCacheState->lock);
+}
+
+
+static void
+ResetSharedCollectionCacheCore(void)
+{
+	pg_atomic_fetch_add_u64(&SharedCollectionCacheState->cacheVersion, 1);
+	pg_atomic_fetch_add_u64(&SharedCollectionCacheState->resetVersion, 1);
+}
+
+
+/*
+ * Remembers a relation invalidated by the current transaction, falling back
+ * to a reset on commit for transactions that invalidate many relations.
+ */
+static void
+AddPendingSharedInvalidation(Oid relationId)
+{
+	if (PendingSharedReset || list_member_oid(PendingSharedInvalidations, relationId))
+	{
+		return;
+	}
+
+	if (list_length(PendingSharedInvalidations) >= MAX_PENDING_SHARED_INVALIDATIONS)
+	{
+		PendingSharedReset = true;
+		return;
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(TopMemoryContext);
+	PendingSharedInvalidations = lappend_oid(PendingSharedInvalidations, relationId);
+	MemoryContextSwitchTo(oldContext);
+}
+
+
+/*
+ * Builds the (zero padded) keys for the hashes of the current database.
+ */
+static void
+InitializeSharedCollectionNameKey(SharedCollectionNameKey *key,
+								  const MongoCollectionName *name)
+{
+	memset(key, 0, sizeof(SharedCollectionNameKey));
+	key->databaseId = MyDatabaseId;
+	key->name = *name;
+}
+
+
+static void
+InitializeSharedCollectionRelationIdKey(SharedCollectionRelationIdKey *key,
+										Oid relationId)
+{
+	memset(key, 0, sizeof(SharedCollectionRelationIdKey));
+	key->databaseId = MyDatabaseId;
+	key->relationId = relationId;
+}
+
+
+static bool
+IsSharedCollectionEntryValid(SharedCollectionCacheEntry *entry)
+{
+	return entry->resetVersion ==
+		   pg_atomic_read_u64(&SharedCollectionCacheState->resetVersion);
+}
+
+
+/*
+ * Copies the catalog fields of the entry into the collection. The bson fields
+ * are copied into the current memory context.
+ */
+static void
+CopySharedCollectionEntry(SharedCollectionCacheEntry *entry, MongoCollection *collection)
+{
+	memset(collection, 0, sizeof(MongoCollection));
+	collection->name = entry->key.name;
+	collection->collectionId = entry->collectionId;
+	collection->collectionUUID = entry->collectionUUID;
+	collection->schemaValidator.validationLevel = entry->validationLevel;
+	collection->schemaValidator.validationAction = entry->validationAction;
+
+	char *data = entry->data;
+	if (entry->shardKeySize > 0)
+	{
+		collection->shardKey = (pgbson *) palloc(entry->shardKeySize);
+		memcpy(collection->shardKey, data, entry->shardKeySize);
+		data += entry->shardKeySize;
+	}
+
+	if (entry->viewDefinitionSize > 0)
+	{
+		collection->viewDefinition = (pgbson *) palloc(entry->viewDefinitionSize);
+		memcpy(collection->viewDefinition, data, entry->viewDefinitionSize);
+		data += entry->viewDefinitionSize;
+	}
+
+	if (entry->validatorSize > 0)
+	{
+		collection->schemaValidator.validator = (pgbson *) palloc(entry->validatorSize);
+		memcpy(collection->schemaValidator.validator, data, entry->validatorSize);
+	}
+
+	/* table name is: documents_<collection id> */
+	snprintf(collection->tableName, NAMEDATALEN, DOCUMENT_DATA_TABLE_NAME_FORMAT,
+			 collection->collectionId);
+}
+
+
+/*
+ * Removes all the entries stored before the last reset to make space.
+ * A scan is only done once per reset, returns false if there was nothing
+ * to remove. Must be called with the cache lock held exclusively.
+ */
+static bool
+RemoveStaleSharedCollections(void)
+{
+	uint64 resetVersion = pg_atomic_read_u64(&SharedCollectionCacheState->resetVersion);
+	if (SharedCollectionCacheState->sweptResetVersion == resetVersion)
+	{
+		return false;
+	}
+
+	SharedCollectionCacheState->sweptResetVersion = resetVersion;
+
+	bool removedEntries = false;
+	HASH_SEQ_STATUS status;
+	SharedCollectionCacheEntry *entry;
+	hash_seq_init(&status, SharedCollectionNameHash);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		if (entry->resetVersion != resetVersion)
+		{
+			/* removing the current element is allowed during a seq scan */
+			RemoveSharedCollection(entry);
+			removedEntries = true;
+		}
+	}
+
+	return removedEntries;
+}
+
+
+/*
+ * Removes the entry from both hashes. Must be called with the cache lock held
+ * exclusively.
+ */
+static void
+RemoveSharedCollection(SharedCollectionCacheEntry *entry)
+{
+	bool found = false;
+	if (OidIsValid(entry->relationId))
+	{
+		/* the sweep also removes entries of other databases */
+		SharedCollectionRelationIdKey relationIdKey;
+		memset(&relationIdKey, 0, sizeof(relationIdKey));
+		relationIdKey.databaseId = entry->key.databaseId;
+		relationIdKey.relationId = entry->relationId;
+		hash_search(SharedCollectionRelationIdHash, &relationIdKey, HASH_REMOVE,
+					&found);
+	}
+
+	hash_search(SharedCollectionNameHash, &entry->key, HASH_REMOVE, &found);
+}
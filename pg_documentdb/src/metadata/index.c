@@ -39,6 +39,7 @@
 #include "utils/hashset_utils.h"
 
 extern int MaxNumActiveUsersIndexBuilds;
+extern bool EnableIndexBuildSmallCollectionsFirst;
 extern int IndexBuildScheduleInSec;
 
 /* --------------------------------------------------------- */
@@ -1689,7 +1690,24 @@ GetCollectionIdsForIndexBuild(List *excludeCollectionIds)
 		appendStringInfo(cmdStr, " WHERE collection_id <> ALL($2) ");
 	}
 	appendStringInfo(cmdStr,
-					 " ORDER BY cmd_type ASC, index_cmd_status ASC LIMIT $1");
+					 " ORDER BY cmd_type ASC, index_cmd_status ASC");
+
+	if (EnableIndexBuildSmallCollectionsFirst)
+	{
+		/*
+		 * Pick the builds of small collections first so that they don't wait
+		 * behind a long running build of a large collection. Shell tables on
+		 * a distributed coordinator have no size, so there this stays in queue
+		 * order.
+		 */
+		appendStringInfo(cmdStr,
+						 ", COALESCE(pg_catalog.pg_total_relation_size("
+						 "pg_catalog.to_regclass(pg_catalog.format('%s.documents_%%s', "
+						 "iq.collection_id))), 0) ASC",
+						 ApiDataSchemaName);
+	}
+
+	appendStringInfo(cmdStr, " LIMIT $1");
 	appendStringInfo(cmdStr, ") a");
 
 	int argCount = 1;
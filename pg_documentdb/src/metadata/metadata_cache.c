@@ -11,10 +11,14 @@
 #include <fmgr.h>
 #include <miscadmin.h>
 #include <access/genam.h>
+#include <access/htup_details.h>
 #include <access/table.h>
 #include <catalog/pg_extension.h>
 #include <catalog/pg_proc.h>
 #include <catalog/pg_type.h>
+#include <common/hashfn.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
 #include <utils/fmgroids.h>
 
 #include "commands/extension.h"
@@ -30,10 +34,12 @@
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/version_utils.h"
+#include "access/xact.h"
 #include "catalog/pg_am.h"
 
 #include "metadata/metadata_cache.h"
 #include "metadata/collection.h"
+#include "metadata/collection_shared_cache.h"
 #include "commands/defrem.h"
 
 
@@ -940,6 +946,24 @@ typedef struct DocumentDBApiOidCacheData
 	/* OID of the BSONPERCENTILE aggregate function */
 	Oid ApiCatalogBsonPercentileAggregateFunctionOid;
 
+	/* OID of the BSONPERCENTILESKETCH aggregate function */
+	Oid ApiCatalogBsonPercentileSketchAggregateFunctionOid;
+
+	/* OID of the BSONPERCENTILEFROMSKETCHES aggregate function */
+	Oid ApiCatalogBsonPercentileFromSketchesAggregateFunctionOid;
+
+	/* OID of the BSONMEDIANFROMSKETCHES aggregate function */
+	Oid ApiCatalogBsonMedianFromSketchesAggregateFunctionOid;
+
+	/* OID of the BSON_ARRAY_AGG_COMBINABLE aggregate function */
+	Oid ApiCatalogBsonArrayAggregateCombinableFunctionOid;
+
+	/* OID of the BSON_ADD_TO_SET_COMBINABLE aggregate function */
+	Oid ApiCatalogBsonAddToSetCombinableAggregateFunctionOid;
+
+	/* OID of the BSON_MERGE_OBJECTS_COMBINABLE aggregate function */
+	Oid ApiCatalogBsonMergeObjectsCombinableFunctionOid;
+
 	/* OID of the pg_catalog.any_value aggregate */
 	Oid PostgresAnyValueFunctionOid;
 
@@ -991,6 +1015,15 @@ typedef struct DocumentDBApiOidCacheData
 	/* OID of ApiInternalSchemaNameV2.bson_dollar_lookup_join_filter function */
 	Oid BsonDollarLookupJoinFilterFunctionOid;
 
+	/* OID of ApiInternalSchemaNameV2.bson_dollar_lookup_filter_hashes function */
+	Oid BsonDollarLookupFilterHashesFunctionOid;
+
+	/* OID of ApiInternalSchemaNameV2.bson_dollar_lookup_document_hashes function */
+	Oid BsonDollarLookupDocumentHashesFunctionOid;
+
+	/* OID of ApiInternalSchemaNameV2.bson_dollar_graph_lookup function */
+	Oid BsonDollarGraphLookupFunctionOid;
+
 	/* OID of the bson_lookup_unwind function */
 	Oid BsonLookupUnwindFunctionOid;
 
@@ -1201,6 +1234,59 @@ typedef struct DocumentDBApiOidCacheData
 
 static DocumentDBApiOidCacheData Cache;
 
+/* number of Oid fields in DocumentDBApiOidCacheData (all fields are OIDs) */
+#define OID_CACHE_FIELD_COUNT (sizeof(DocumentDBApiOidCacheData) / sizeof(Oid))
+
+/*
+ * SharedOidCacheSlot holds the OIDs resolved by any backend of a database
+ * while the installed extensions matched the signature.
+ */
+typedef struct SharedOidCacheSlot
+{
+	/* the database of the OIDs, InvalidOid for unused slots */
+	Oid databaseId;
+
+	/* signature of the pg_extension rows the OIDs were resolved with */
+	uint64 extensionSignature;
+
+	DocumentDBApiOidCacheData oids;
+} SharedOidCacheSlot;
+
+/*
+ * Shared state of the OID cache.
+ */
+typedef struct SharedOidCacheData
+{
+	/* The tranche id of the cache lock */
+	int trancheId;
+
+	/* The tranche name of the cache lock */
+	char *trancheName;
+
+	/* Lock protecting the slots */
+	LWLock lock;
+
+	/* the slot to reuse next when all slots are taken */
+	int nextVictimSlot;
+
+	SharedOidCacheSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} SharedOidCacheData;
+
+static uint64 GetExtensionCatalogSignature(void);
+static void LoadSharedOidCache(void);
+
+/* number of databases whose OIDs are cached across backends, 0 disables it */
+extern int SharedMetadataCacheSize;
+
+/* shared state of the OID cache (NULL if not available) */
+static SharedOidCacheData *SharedOidCacheState = NULL;
+
+/* signature of the extensions the local cache was initialized with, 0 if unknown */
+static uint64 LocalExtensionSignature = 0;
+
+/* the local cache as of the last load from or publish to the shared cache */
+static DocumentDBApiOidCacheData PublishedCache;
+
 /*
  * InitializeDocumentDBApiExtensionCache (re)initializes the cache.
  *
@@ -1257,6 +1343,9 @@ InitializeDocumentDBApiExtensionCache(void)
 	Cache.CollectionsTableId = get_relname_relid("collections",
 												 Cache.ApiCatalogNamespaceId);
 
+	/* other backends may already have resolved the remaining OIDs */
+	LoadSharedOidCache();
+
 	/* after cache reset (e.g. drop+create extension), also reset collections cache */
 	ResetCollectionsCache();
 
@@ -1265,6 +1354,194 @@ InitializeDocumentDBApiExtensionCache(void)
 }
 
 
+/*
+ * SharedMetadataCacheShmemSize returns the shared memory needed for the
+ * shared OID cache.
+ */
+Size
+SharedMetadataCacheShmemSize(void)
+{
+	return add_size(offsetof(SharedOidCacheData, slots),
+					mul_size(sizeof(SharedOidCacheSlot), SharedMetadataCacheSize));
+}
+
+
+/*
+ * InitializeSharedMetadataCacheShmem initializes the shared OID cache.
+ */
+void
+InitializeSharedMetadataCacheShmem(void)
+{
+	bool found = false;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	SharedOidCacheState =
+		(SharedOidCacheData *) ShmemInitStruct("DocumentDB Shared Oid Cache Data",
+											   SharedMetadataCacheShmemSize(),
+											   &found);
+
+	if (!found)
+	{
+		memset(SharedOidCacheState, 0, SharedMetadataCacheShmemSize());
+		SharedOidCacheState->trancheId = LWLockNewTrancheId();
+		SharedOidCacheState->trancheName = "DocumentDB Shared Oid Cache Tranche";
+		LWLockRegisterTranche(SharedOidCacheState->trancheId,
+							  SharedOidCacheState->trancheName);
+		LWLockInitialize(&SharedOidCacheState->lock, SharedOidCacheState->trancheId);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+
+/*
+ * PublishDocumentDBApiOidCache is called at the end of a transaction and adds
+ * the OIDs resolved by this backend since the last call to the shared cache,
+ * so that other backends of the database don't have to look them up again.
+ * Writing transactions are skipped since they may have resolved objects that
+ * are not committed yet.
+ */
+void
+PublishDocumentDBApiOidCache(void)
+{
+	if (SharedMetadataCacheSize <= 0 || SharedOidCacheState == NULL ||
+		CacheValidity != CACHE_VALID || LocalExtensionSignature == 0 ||
+		TransactionIdIsValid(GetTopTransactionIdIfAny()) ||
+		memcmp(&Cache, &PublishedCache, sizeof(DocumentDBApiOidCacheData)) == 0)
+	{
+		return;
+	}
+
+	Oid *localOids = (Oid *) &Cache;
+	SharedOidCacheSlot *slot = NULL;
+
+	LWLockAcquire(&SharedOidCacheState->lock, LW_EXCLUSIVE);
+
+	for (int i = 0; i < SharedMetadataCacheSize; i++)
+	{
+		if (SharedOidCacheState->slots[i].databaseId == MyDatabaseId)
+		{
+			slot = &SharedOidCacheState->slots[i];
+			break;
+		}
+
+		if (slot == NULL && SharedOidCacheState->slots[i].databaseId == InvalidOid)
+		{
+			slot = &SharedOidCacheState->slots[i];
+		}
+	}
+
+	if (slot == NULL)
+	{
+		slot = &SharedOidCacheState->slots[SharedOidCacheState->nextVictimSlot];
+		SharedOidCacheState->nextVictimSlot =
+			(SharedOidCacheState->nextVictimSlot + 1) % SharedMetadataCacheSize;
+	}
+
+	if (slot->databaseId != MyDatabaseId ||
+		slot->extensionSignature != LocalExtensionSignature)
+	{
+		/* the slot belongs to another database or to other extension versions */
+		slot->databaseId = MyDatabaseId;
+		slot->extensionSignature = LocalExtensionSignature;
+		memset(&slot->oids, 0, sizeof(DocumentDBApiOidCacheData));
+	}
+
+	Oid *sharedOids = (Oid *) &slot->oids;
+	for (Size i = 0; i < OID_CACHE_FIELD_COUNT; i++)
+	{
+		if (localOids[i] != InvalidOid)
+		{
+			sharedOids[i] = localOids[i];
+		}
+	}
+
+	LWLockRelease(&SharedOidCacheState->lock);
+
+	PublishedCache = Cache;
+}
+
+
+/*
+ * Fills the unresolved OIDs of the local cache from the shared cache of the
+ * database, if the installed extensions did not change since they were
+ * resolved. Transactions that have written anything (e.g. ALTER EXTENSION)
+ * neither read nor write the shared cache.
+ */
+static void
+LoadSharedOidCache(void)
+{
+	LocalExtensionSignature = 0;
+	PublishedCache = Cache;
+
+	if (SharedMetadataCacheSize <= 0 || SharedOidCacheState == NULL ||
+		TransactionIdIsValid(GetTopTransactionIdIfAny()))
+	{
+		return;
+	}
+
+	LocalExtensionSignature = GetExtensionCatalogSignature();
+
+	Oid *localOids = (Oid *) &Cache;
+	LWLockAcquire(&SharedOidCacheState->lock, LW_SHARED);
+	for (int i = 0; i < SharedMetadataCacheSize; i++)
+	{
+		SharedOidCacheSlot *slot = &SharedOidCacheState->slots[i];
+		if (slot->databaseId != MyDatabaseId ||
+			slot->extensionSignature != LocalExtensionSignature)
+		{
+			continue;
+		}
+
+		Oid *sharedOids = (Oid *) &slot->oids;
+		for (Size j = 0; j < OID_CACHE_FIELD_COUNT; j++)
+		{
+			if (localOids[j] == InvalidOid)
+			{
+				localOids[j] = sharedOids[j];
+			}
+		}
+
+		break;
+	}
+	LWLockRelease(&SharedOidCacheState->lock);
+
+	PublishedCache = Cache;
+}
+
+
+/*
+ * Returns a signature of all rows of pg_extension. The cached OIDs belong to
+ * objects of the extension or its dependencies (e.g. PostGIS and pgvector),
+ * and creating, dropping or updating any extension writes a new row version.
+ * The raw xmin is used since it is preserved when the row is frozen.
+ */
+static uint64
+GetExtensionCatalogSignature(void)
+{
+	uint64 signature = 1;
+
+	Relation relation = table_open(ExtensionRelationId, AccessShareLock);
+	SysScanDesc scandesc = systable_beginscan(relation, InvalidOid, false, NULL, 0,
+											  NULL);
+
+	HeapTuple extensionTuple;
+	while (HeapTupleIsValid(extensionTuple = systable_getnext(scandesc)))
+	{
+		Form_pg_extension extensionForm = (Form_pg_extension) GETSTRUCT(extensionTuple);
+		signature = hash_combine64(signature,
+								   ((uint64) extensionForm->oid << 32) |
+								   HeapTupleHeaderGetRawXmin(extensionTuple->t_data));
+	}
+
+	systable_endscan(scandesc);
+	table_close(relation, AccessShareLock);
+
+	/* 0 is reserved for unknown signatures */
+	return signature == 0 ? 1 : signature;
+}
+
+
 /* Invalidates the collections cache using the collections table oid.
  * this is used to be able to invalidate the cache via the version cache
  * so that the lifetime of both are tight together.
@@ -1298,11 +1575,13 @@ InvalidateDocumentDBApiCache(Datum argument, Oid relationId)
 		 */
 		CacheValidity = CACHE_INVALID;
 		ResetCollectionsCache();
+		ResetSharedCollectionCache();
 		InvalidateVersionCache();
 	}
 	else
 	{
 		/* got an invalidation for a specific relation */
+		InvalidateSharedCollectionByRelationId(relationId);
 
 		if (CacheValidity == CACHE_VALID)
 		{
@@ -4539,6 +4818,60 @@ BsonPercentileAggregateFunctionOid(void)
 }
 
 
+Oid
+BsonPercentileSketchAggregateFunctionOid(void)
+{
+	return GetAggregateFunctionByName(
+		&Cache.ApiCatalogBsonPercentileSketchAggregateFunctionOid,
+		DocumentDBApiInternalSchemaName, "bsonpercentilesketch");
+}
+
+
+Oid
+BsonPercentileFromSketchesAggregateFunctionOid(void)
+{
+	return GetAggregateFunctionByName(
+		&Cache.ApiCatalogBsonPercentileFromSketchesAggregateFunctionOid,
+		DocumentDBApiInternalSchemaName, "bsonpercentilefromsketches");
+}
+
+
+Oid
+BsonMedianFromSketchesAggregateFunctionOid(void)
+{
+	return GetAggregateFunctionByName(
+		&Cache.ApiCatalogBsonMedianFromSketchesAggregateFunctionOid,
+		DocumentDBApiInternalSchemaName, "bsonmedianfromsketches");
+}
+
+
+Oid
+BsonArrayAggregateCombinableFunctionOid(void)
+{
+	return GetAggregateFunctionByName(
+		&Cache.ApiCatalogBsonArrayAggregateCombinableFunctionOid,
+		DocumentDBApiInternalSchemaName, "bson_array_agg_combinable");
+}
+
+
+Oid
+BsonAddToSetCombinableAggregateFunctionOid(void)
+{
+	return GetAggregateFunctionByName(
+		&Cache.ApiCatalogBsonAddToSetCombinableAggregateFunctionOid,
+		DocumentDBApiInternalSchemaName, "bson_add_to_set_combinable");
+}
+
+
+Oid
+BsonMergeObjectsCombinableFunctionOid(void)
+{
+	return GetAggregateFunctionByName(
+		&Cache.ApiCatalogBsonMergeObjectsCombinableFunctionOid,
+		DocumentDBApiInternalSchemaName, "bson_merge_objects_combinable");
+}
+
+
 Oid
 BsonAddToSetAggregateFunctionOid(void)
 {
@@ -4627,6 +4960,68 @@ BsonDollarLookupJoinFilterFunctionOid(void)
 }
 
 
+Oid
+BsonDollarLookupFilterHashesFunctionOid(void)
+{
+	InitializeDocumentDBApiExtensionCache();
+
+	if (Cache.BsonDollarLookupFilterHashesFunctionOid == InvalidOid)
+	{
+		List *functionNameList = list_make2(makeString(DocumentDBApiInternalSchemaName),
+											makeString(
+												"bson_dollar_lookup_filter_hashes"));
+		Oid paramOids[1] = { BsonTypeId() };
+		bool missingOK = false;
+
+		Cache.BsonDollarLookupFilterHashesFunctionOid =
+			LookupFuncName(functionNameList, 1, paramOids, missingOK);
+	}
+
+	return Cache.BsonDollarLookupFilterHashesFunctionOid;
+}
+
+
+Oid
+BsonDollarLookupDocumentHashesFunctionOid(void)
+{
+	InitializeDocumentDBApiExtensionCache();
+
+	if (Cache.BsonDollarLookupDocumentHashesFunctionOid == InvalidOid)
+	{
+		List *functionNameList = list_make2(makeString(DocumentDBApiInternalSchemaName),
+											makeString(
+												"bson_dollar_lookup_document_hashes"));
+		Oid paramOids[2] = { BsonTypeId(), TEXTOID };
+		bool missingOK = false;
+
+		Cache.BsonDollarLookupDocumentHashesFunctionOid =
+			LookupFuncName(functionNameList, 2, paramOids, missingOK);
+	}
+
+	return Cache.BsonDollarLookupDocumentHashesFunctionOid;
+}
+
+
+Oid
+BsonDollarGraphLookupFunctionOid(void)
+{
+	InitializeDocumentDBApiExtensionCache();
+
+	if (Cache.BsonDollarGraphLookupFunctionOid == InvalidOid)
+	{
+		List *functionNameList = list_make2(makeString(DocumentDBApiInternalSchemaName),
+											makeString("bson_dollar_graph_lookup"));
+		Oid paramOids[2] = { BsonTypeId(), BsonTypeId() };
+		bool missingOK = false;
+
+		Cache.BsonDollarGraphLookupFunctionOid =
+			LookupFuncName(functionNameList, 2, paramOids, missingOK);
+	}
+
+	return Cache.BsonDollarGraphLookupFunctionOid;
+}
+
+
 Oid
 BsonLookupUnwindFunctionOid(void)
 {
@@ -1968,7 +1968,36 @@ AddMultiBoundaryForDollarRange(int32_t indexAttribute,
 
 	if (params->isFullScan)
 	{
-		/* Don't update any bounds */
+		/*
+		 * Don't update any bounds, unless an ordered scan resumes from a sort key:
+		 * it seeks to the key across types as the key is a sort order, not a filter.
+		 */
+		if (params->orderScanDirection != 0 &&
+			(params->minValue.value_type != BSON_TYPE_MINKEY ||
+			 params->maxValue.value_type != BSON_TYPE_MAXKEY))
+		{
+			CompositeIndexBoundsSet *set = CreateCompositeIndexBoundsSet(1,
+																		 indexAttribute,
+																		 wildcardPath);
+			CompositeSingleBound bound = GetTypeLowerBound(BSON_TYPE_MINKEY);
+			if (params->minValue.value_type != BSON_TYPE_MINKEY)
+			{
+				bound.bound = params->minValue;
+				bound.isBoundInclusive = params->isMinInclusive;
+			}
+			SetLowerBound(&set->bounds[0].lowerBound, &bound);
+
+			bound = GetTypeUpperBound(BSON_TYPE_MAXKEY);
+			if (params->maxValue.value_type != BSON_TYPE_MAXKEY)
+			{
+				bound.bound = params->maxValue;
+				bound.isBoundInclusive = params->isMaxInclusive;
+			}
+			SetUpperBound(&set->bounds[0].upperBound, &bound);
+			indexBounds->variableBoundsList = lappend(indexBounds->variableBoundsList,
+													  set);
+		}
+
 		return;
 	}
 
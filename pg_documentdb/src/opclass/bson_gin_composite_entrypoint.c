@@ -42,6 +42,10 @@
  #include "collation/collation.h"
  #include "opclass/bson_gin_composite_scan.h"
  #include "opclass/bson_gin_composite_private.h"
+#include "utils/command_activity.h"
+
+/* The strategy of the ordering transform calls that project an index only scan tuple */
+#define COMPOSITE_INDEX_ONLY_SCAN_STRATEGY UINT16_MAX
 
 typedef enum RumIndexTransformOperation
 {
@@ -79,6 +83,11 @@ extern bool EnableCompositeWildcardIndex;
 extern int MaxWildcardIndexKeySize;
 
 static void ValidateCompositePathSpec(const char *prefix);
+static pgbson * ProjectCompositeTermsForIndexOnlyScan(FunctionCallInfo fcinfo,
+													  BsonIndexTerm *compareTerm,
+													  const char **indexPaths,
+													  uint32_t *indexPathLengths,
+													  int numPaths, Datum currentKey);
 static Size FillCompositePathSpec(const char *prefix, void *buffer);
 static Datum * GenerateCompositeTermsCore(pgbson *doc,
 										  BsonGinCompositePathOptions *options,
@@ -158,6 +167,7 @@ gin_bson_composite_path_extract_value(PG_FUNCTION_ARGS)
 		(BsonGinCompositePathOptions *) PG_GET_OPCLASS_OPTIONS();
 
 	Datum *indexEntries = GenerateCompositeTermsCore(bson, options, nentries);
+	ReportKeysInserted(*nentries);
 	PG_RETURN_POINTER(indexEntries);
 }
 
@@ -1234,54 +1244,11 @@ gin_bson_composite_ordering_transform(PG_FUNCTION_ARGS)
 	pgbson *result = NULL;
 
 	/* Index only scan, we need to reconstruct and project the document back. */
-	if (strategy == UINT16_MAX)
+	if (strategy == COMPOSITE_INDEX_ONLY_SCAN_STRATEGY)
 	{
-		pgbson_heap_writer *writer;
-
-		/* Start over if the priorKey is not provided (handles the rescan scenario)
-		 * Note that we don't check or free the writer since the MemoryContext
-		 * is reset in between rescan scenarios.
-		 */
-		if (fcinfo->flinfo->fn_extra == NULL || currentKey == (Datum) 0)
-		{
-			writer = PgbsonHeapWriterInit();
-			fcinfo->flinfo->fn_extra = (void *) writer;
-		}
-		else
-		{
-			writer = (pgbson_heap_writer *) fcinfo->flinfo->fn_extra;
-			PgbsonHeapWriterReset(writer);
-		}
-
-		for (int i = 0; i < numPaths; i++)
-		{
-			BsonIndexTerm *term = &compareTerm[i];
-			PgbsonHeapWriterAppendValue(writer, indexPaths[i], indexPathLengths[i],
-										&term->element.bsonValue);
-		}
-
-		bson_value_t value = PgbsonHeapWriterGetValue(writer);
-
-		if (currentKey == (Datum) 0)
-		{
-			result = PgbsonInitFromDocumentBsonValue(&value);
-		}
-		else
-		{
-			pgbson *existing = DatumGetPgBson(currentKey);
-			Size currentSize = VARSIZE(existing);
-
-			Size requiredSize = value.value.v_doc.data_len + VARHDRSZ;
-			if (currentSize < requiredSize)
-			{
-				existing = repalloc(existing, requiredSize);
-			}
-
-			uint8_t *dataValues = (uint8_t *) VARDATA(existing);
-			memcpy(dataValues, value.value.v_doc.data, value.value.v_doc.data_len);
-			SET_VARSIZE(existing, requiredSize);
-			result = existing;
-		}
+		result = ProjectCompositeTermsForIndexOnlyScan(fcinfo, compareTerm, indexPaths,
+													   indexPathLengths, numPaths,
+													   currentKey);
 	}
 	else
 	{
@@ -1347,6 +1314,72 @@ gin_bson_composite_ordering_transform(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * Reconstructs the document of an index only scan from the terms of a composite
+ * index tuple, reusing the document of the prior tuple when there is one.
+ * Index paths that don't exist in the document have undefined value terms: these
+ * are only left out here, so that find projections of the reconstructed document
+ * match the table. The ordering of these paths still uses the undefined value.
+ */
+static pgbson *
+ProjectCompositeTermsForIndexOnlyScan(FunctionCallInfo fcinfo,
+									  BsonIndexTerm *compareTerm,
+									  const char **indexPaths,
+									  uint32_t *indexPathLengths, int numPaths,
+									  Datum currentKey)
+{
+	pgbson_heap_writer *writer;
+
+	/* Start over if the priorKey is not provided (handles the rescan scenario)
+	 * Note that we don't check or free the writer since the MemoryContext
+	 * is reset in between rescan scenarios.
+	 */
+	if (fcinfo->flinfo->fn_extra == NULL || currentKey == (Datum) 0)
+	{
+		writer = PgbsonHeapWriterInit();
+		fcinfo->flinfo->fn_extra = (void *) writer;
+	}
+	else
+	{
+		writer = (pgbson_heap_writer *) fcinfo->flinfo->fn_extra;
+		PgbsonHeapWriterReset(writer);
+	}
+
+	for (int i = 0; i < numPaths; i++)
+	{
+		BsonIndexTerm *term = &compareTerm[i];
+		if (IsIndexTermValueUndefined(term))
+		{
+			continue;
+		}
+
+		PgbsonHeapWriterAppendValue(writer, indexPaths[i], indexPathLengths[i],
+									&term->element.bsonValue);
+	}
+
+	bson_value_t value = PgbsonHeapWriterGetValue(writer);
+
+	if (currentKey == (Datum) 0)
+	{
+		return PgbsonInitFromDocumentBsonValue(&value);
+	}
+
+	pgbson *existing = DatumGetPgBson(currentKey);
+	Size currentSize = VARSIZE(existing);
+
+	Size requiredSize = value.value.v_doc.data_len + VARHDRSZ;
+	if (currentSize < requiredSize)
+	{
+		existing = repalloc(existing, requiredSize);
+	}
+
+	uint8_t *dataValues = (uint8_t *) VARDATA(existing);
+	memcpy(dataValues, value.value.v_doc.data, value.value.v_doc.data_len);
+	SET_VARSIZE(existing, requiredSize);
+	return existing;
+}
+
+
 /*
  * gin_bson_composite_path_options sets up the option specification for single field indexes
  * This initializes the structure that is used by the Index AM to process user specified
@@ -131,6 +131,8 @@ extern bool EnableCollation;
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
+static void EnsureWildcardTermsWithinLimit(GinEntryPathData *pathData,
+										   int32_t maxTermsPerDocument);
 static void GenerateTermsCore(bson_iter_t *bsonIter, const char *basePath,
 							  uint32_t basePathLen, bool traverseArrays,
 							  bool isArrayTerm, GenerateTermsContext *context,
@@ -377,9 +379,15 @@ GenerateSinglePathTermsCore(pgbson *bson, GenerateTermsContext *context,
 	context->generateNotFoundTerm = singlePathOptions->generateNotFoundTerm;
 	pathData->useReducedWildcardTerms =
 		singlePathOptions->isWildcard && singlePathOptions->useReducedWildcardTerms;
+	pathData->generateNestedArrayTerm = singlePathOptions->generateNestedArrayTerm;
 
 	bool addRootTerm = true;
 	GenerateTerms(bson, context, pathData, addRootTerm);
+
+	if (singlePathOptions->isWildcard)
+	{
+		EnsureWildcardTermsWithinLimit(pathData, singlePathOptions->maxTermsPerDocument);
+	}
 }
 
 
@@ -400,6 +408,7 @@ GenerateWildcardPathTermsCore(pgbson *bson, GenerateTermsContext *context,
 
 	bool addRootTerm = true;
 	GenerateTerms(bson, context, pathData, addRootTerm);
+	EnsureWildcardTermsWithinLimit(pathData, wildcardOptions->maxTermsPerDocument);
 }
 
 
@@ -681,15 +690,16 @@ GinBsonConsistentCore(BsonIndexStrategy strategy,
 
 		case BSON_INDEX_STRATEGY_DOLLAR_ELEMMATCH:
 		{
+			/* elemMatch can have false positives due to array of arrays,
+			 * and secondly due to truncation of terms. The elemMatch
+			 * consistent decides when these can be ruled out.
+			 */
 			*recheck = false;
-			bool res = GinBsonElemMatchConsistent(check, extra_data, numKeys);
-			if (res)
+			bool res = GinBsonElemMatchConsistent(check, extra_data, numKeys, recheck,
+												  isPreconsistent);
+			if (!res)
 			{
-				/* We need to recheck elemMatch since we can have
-				 * false positives due to array of arrays, and secondly
-				 * due to truncation of terms.
-				 */
-				*recheck = true;
+				*recheck = false;
 			}
 
 			return res;
@@ -1046,6 +1056,24 @@ GinBsonComparePartialOrderBy(BsonIndexTerm *queryValue,
 /* --------------------------------------------------------- */
 
 
+/*
+ * Fails the write of a document with more value terms for a wildcard index
+ * than the limit the index was created with, this bounds the index entries a
+ * document with many dynamic keys adds.
+ */
+static void
+EnsureWildcardTermsWithinLimit(GinEntryPathData *pathData, int32_t maxTermsPerDocument)
+{
+	if (maxTermsPerDocument > 0 && pathData->coreTermsCount > maxTermsPerDocument)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"Document generates %d wildcard index keys, exceeding the maximum of %d allowed for the index.",
+							pathData->coreTermsCount, maxTermsPerDocument)));
+	}
+}
+
+
 /*
  * Validates that terms array has at least 'required' Datum entries
  * in its array of terms.
@@ -1111,6 +1139,7 @@ GenerateTermsForPath(pgbson *bson, GenerateTermsContext *context)
 		pathData->hasTruncatedTerms = false;
 		pathData->hasArrayAncestors = false;
 		pathData->hasArrayValues = false;
+		pathData->hasNestedArrays = false;
 	}
 
 	bool inArrayContext = false;
@@ -1201,6 +1230,12 @@ GenerateTerms(pgbson *bson, GenerateTermsContext *context, GinEntryPathData *pat
 			AddTerm(&pathData->terms, GenerateRootMultiKeyTerm(
 						&pathData->termMetadata));
 		}
+
+		if (pathData->generateNestedArrayTerm && pathData->hasNestedArrays)
+		{
+			AddTerm(&pathData->terms, GenerateRootNestedArrayTerm(
+						&pathData->termMetadata));
+		}
 	}
 }
 
@@ -1243,9 +1278,11 @@ GenerateArrayPath(bson_iter_t *bsonIter, const char *pathToInsert,
 
 	bool someArrayPathsHaveTerms[INDEX_MAX_KEYS] = { 0 };
 	bool someArrayPathsHaveNoTerms[INDEX_MAX_KEYS] = { 0 };
+	bool hasArrayElements = false;
 	while (bson_iter_next(&containerIter))
 	{
 		bson_iter_t containerCopy = containerIter;
+		hasArrayElements = hasArrayElements || BSON_ITER_HOLDS_ARRAY(&containerIter);
 		bool inArrayContextInner = true;
 		bool isArrayTermInner = false;
 		bool isCheckForArrayTermsWithNestedDocumentInner = false;
@@ -1325,6 +1362,12 @@ GenerateArrayPath(bson_iter_t *bsonIter, const char *pathToInsert,
 		{
 			pathData->hasArrayPartialTermExistence = true;
 		}
+
+		/* The elements of inner arrays also generate terms at the parent path */
+		if (hasArrayElements)
+		{
+			pathData->hasNestedArrays = true;
+		}
 	}
 
 	if (pathBuilderBuffer.data != NULL)
@@ -83,8 +83,17 @@ typedef struct BsonElemMatchState
 {
 	union
 	{
-		/* The elemMatch filter is a query expression to be evaluated */
-		BsonElemMatchIndexExprState expressionState;
+		struct
+		{
+			/* The elemMatch filter is a query expression to be evaluated */
+			BsonElemMatchIndexExprState expressionState;
+
+			/* The index of the root truncated term in the query keys (or -1) */
+			int rootTruncatedTermIndex;
+
+			/* The index of the root nested array term in the query keys (or -1) */
+			int rootNestedArrayTermIndex;
+		};
 
 		struct
 		{
@@ -212,10 +221,11 @@ GinBsonComparePartialElemMatch(BsonIndexTerm *queryValue, BsonIndexTerm *compare
  * Given an array of check booleans (one for each term queried against the index)
  * for a document, an array of extraData per term, and a number of terms,
  * validates whether that document would be a match for the $elemMatch.
- *
+ * Sets recheck if the match needs to be revalidated against the document.
  */
 bool
-GinBsonElemMatchConsistent(bool *checkArray, Pointer *extraData, int32_t numKeys)
+GinBsonElemMatchConsistent(bool *checkArray, Pointer *extraData, int32_t numKeys,
+						   bool *recheck, bool isPreconsistent)
 {
 	/* First pass - check for expression or nested filters */
 	bool hasExpression = false;
@@ -237,19 +247,40 @@ GinBsonElemMatchConsistent(bool *checkArray, Pointer *extraData, int32_t numKeys
 		 * If the expression evaluated to false, then it's still a match
 		 * if the term was truncated.
 		 */
+		BsonElemMatchState *state = (BsonElemMatchState *) extraData[0];
 		res = false;
 		for (int i = 0; i < numKeys && !res; i++)
 		{
-			res = res || checkArray[i];
+			/* The nested array term only tells whether the array terms can be trusted */
+			if (i != state->rootNestedArrayTermIndex)
+			{
+				res = res || checkArray[i];
+			}
 		}
+
+		/*
+		 * The expression was evaluated against the array terms at the path. These
+		 * are the values at the path unless the document has arrays of arrays (the
+		 * inner arrays generate terms at the same path) or truncated terms.
+		 * Without the nested array term in the index we can't tell those apart.
+		 */
+		bool hasTruncatedTerms = state->rootTruncatedTermIndex >= 0 &&
+								 checkArray[state->rootTruncatedTermIndex];
+		*recheck = isPreconsistent ||
+				   state->rootNestedArrayTermIndex < 0 ||
+				   checkArray[state->rootNestedArrayTermIndex] ||
+				   hasTruncatedTerms;
 	}
 	else
 	{
 		/* Given the query state, go to the root of the query expression
 		 * And evaluate the consistent state from the root
+		 * The terms of the nested filters don't record which array element
+		 * they came from, so a match always needs to be revalidated.
 		 */
 		BsonElemMatchState *state = (BsonElemMatchState *) extraData[0];
 		res = GetElemMatchQualConsistentResult(state->filterExpressionRoot, checkArray);
+		*recheck = true;
 	}
 
 	return res;
@@ -261,6 +292,24 @@ GinBsonElemMatchConsistent(bool *checkArray, Pointer *extraData, int32_t numKeys
 /* --------------------------------------------------------- */
 
 
+/*
+ * Whether the index generates the root nested array term for documents
+ * with arrays of arrays.
+ */
+inline static bool
+IndexGeneratesNestedArrayTerm(bytea *options)
+{
+	if (options == NULL)
+	{
+		return false;
+	}
+
+	BsonGinIndexOptionsBase *optionsBase = (BsonGinIndexOptionsBase *) options;
+	return optionsBase->type == IndexOptionsType_SinglePath &&
+		   ((BsonGinSinglePathOptions *) options)->generateNestedArrayTerm;
+}
+
+
 /*
  * Generates the terms to be evaluated against for $elemMatch based
  * on the top level expression.
@@ -278,9 +327,9 @@ GinBsonExtractQueryElemMatchForExpression(BsonExtractQueryArgs *args)
 	pgbson_writer bsonWriter;
 
 	*nentries = 1;
-	Datum *entries = (Datum *) palloc(sizeof(Datum) * 2);
-	*partialmatch = (bool *) palloc(sizeof(bool) * 2);
-	*extra_data = (Pointer *) palloc(sizeof(Pointer) * 2);
+	Datum *entries = (Datum *) palloc(sizeof(Datum) * 3);
+	*partialmatch = (bool *) palloc(sizeof(bool) * 3);
+	*extra_data = (Pointer *) palloc(sizeof(Pointer) * 3);
 
 	/* now create a bson for that path which has the min value for the field */
 	/* we map this to an empty array since that's the smallest value we'll encounter */
@@ -300,6 +349,8 @@ GinBsonExtractQueryElemMatchForExpression(BsonExtractQueryArgs *args)
 	elemMatchState->expressionState.isEmptyExpression = IsBsonValueEmptyDocument(
 		&documentElement.bsonValue);
 	elemMatchState->isExpression = true;
+	elemMatchState->rootTruncatedTermIndex = -1;
+	elemMatchState->rootNestedArrayTermIndex = -1;
 
 	Pointer *extraDataPtr = *extra_data;
 	extraDataPtr[0] = (Pointer) elemMatchState;
@@ -310,10 +361,21 @@ GinBsonExtractQueryElemMatchForExpression(BsonExtractQueryArgs *args)
 
 	if (args->termMetadata.indexTermSizeLimit > 0)
 	{
-		*nentries = 2;
-		extraDataPtr[1] = (Pointer) elemMatchState;
-		(*partialmatch)[1] = false;
-		entries[1] = GenerateRootTruncatedTerm(&args->termMetadata);
+		elemMatchState->rootTruncatedTermIndex = *nentries;
+		extraDataPtr[*nentries] = (Pointer) elemMatchState;
+		(*partialmatch)[*nentries] = false;
+		entries[*nentries] = GenerateRootTruncatedTerm(&args->termMetadata);
+		(*nentries)++;
+	}
+
+	if (IndexGeneratesNestedArrayTerm(args->options))
+	{
+		/* Documents without nested arrays can skip the recheck */
+		elemMatchState->rootNestedArrayTermIndex = *nentries;
+		extraDataPtr[*nentries] = (Pointer) elemMatchState;
+		(*partialmatch)[*nentries] = false;
+		entries[*nentries] = GenerateRootNestedArrayTerm(&args->termMetadata);
+		(*nentries)++;
 	}
 
 	return entries;
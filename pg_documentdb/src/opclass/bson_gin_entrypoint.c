@@ -36,6 +36,7 @@
 #include "utils/documentdb_errors.h"
 #include "metadata/metadata_cache.h"
 #include "collation/collation.h"
+#include "utils/command_activity.h"
 
 extern bool EnableExprLookupIndexPushdown;
 extern bool EnableValueOnlyIndexTerms;
@@ -94,6 +95,7 @@ gin_bson_single_path_extract_value(PG_FUNCTION_ARGS)
 	GenerateSinglePathTermsCore(bson, &context, &pathData, options);
 
 	*nentries = pathData.terms.index;
+	ReportKeysInserted(*nentries);
 
 	PG_FREE_IF_COPY(bson, 0);
 	PG_RETURN_POINTER(pathData.terms.entries);
@@ -126,6 +128,7 @@ gin_bson_wildcard_project_extract_value(PG_FUNCTION_ARGS)
 	pathData.termMetadata = GetIndexTermMetadata(options);
 	GenerateWildcardPathTermsCore(bson, &context, &pathData, options);
 	*nentries = pathData.terms.index;
+	ReportKeysInserted(*nentries);
 
 	PG_FREE_IF_COPY(bson, 0);
 	PG_RETURN_POINTER(pathData.terms.entries);
@@ -654,6 +657,18 @@ gin_bson_single_path_options(PG_FUNCTION_ARGS)
 							 false,
 							 offsetof(BsonGinSinglePathOptions, useReducedWildcardTerms));
 
+	add_local_bool_reloption(relopts, "nat",
+							 "Whether to generate the root nested array term for documents with arrays of arrays",
+							 false,
+							 offsetof(BsonGinSinglePathOptions, generateNestedArrayTerm));
+
+	add_local_int_reloption(relopts, "wtl",
+							"The max terms a wildcard index generates for a document.",
+							0, /* default value */
+							0, /* min */
+							INT32_MAX, /* max */
+							offsetof(BsonGinSinglePathOptions, maxTermsPerDocument));
+
 	add_local_int_reloption(relopts, "v",
 							"The version of the options struct.",
 							IndexOptionsVersion_V0,         /* default value */
@@ -740,6 +755,13 @@ gin_bson_wildcard_project_options(PG_FUNCTION_ARGS)
 							INT32_MAX, /* max */
 							offsetof(BsonGinWildcardProjectionPathOptions,
 									 base.wildcardIndexTruncatedPathLimit));
+	add_local_int_reloption(relopts, "wtl",
+							"The max terms a wildcard index generates for a document.",
+							0, /* default value */
+							0, /* min */
+							INT32_MAX, /* max */
+							offsetof(BsonGinWildcardProjectionPathOptions,
+									 maxTermsPerDocument));
 
 	add_local_int_reloption(relopts, "v",
 							"The version of the options struct.",
@@ -864,6 +886,112 @@ GetFirstPathFromIndexOptionsIfApplicable(bytea *indexOptions, bool *isWildcardIn
 }
 
 
+/*
+ * Returns true if the qualifier value can only match documents that have a
+ * value at the query path on a wildcard index. In that case the query path is
+ * returned so that the scan can be skipped if no document in the index has
+ * that path. Null, undefined and MinKey/MaxKey values (which also match
+ * documents missing the path) and negations never qualify.
+ */
+bool
+GetWildcardIndexQueryRequiredPath(bytea *indexOptions, Datum queryValue,
+								  BsonIndexStrategy strategy, const char **path,
+								  uint32_t *pathLength)
+{
+	BsonGinIndexOptionsBase *options = (BsonGinIndexOptionsBase *) indexOptions;
+	if (options == NULL ||
+		!(options->type == IndexOptionsType_Wildcard ||
+		  (options->type == IndexOptionsType_SinglePath &&
+		   ((BsonGinSinglePathOptions *) options)->isWildcard)))
+	{
+		return false;
+	}
+
+	switch (strategy)
+	{
+		case BSON_INDEX_STRATEGY_DOLLAR_EQUAL:
+		case BSON_INDEX_STRATEGY_DOLLAR_GREATER:
+		case BSON_INDEX_STRATEGY_DOLLAR_GREATER_EQUAL:
+		case BSON_INDEX_STRATEGY_DOLLAR_LESS:
+		case BSON_INDEX_STRATEGY_DOLLAR_LESS_EQUAL:
+		case BSON_INDEX_STRATEGY_DOLLAR_IN:
+		case BSON_INDEX_STRATEGY_DOLLAR_EXISTS:
+		case BSON_INDEX_STRATEGY_DOLLAR_REGEX:
+		case BSON_INDEX_STRATEGY_DOLLAR_SIZE:
+		case BSON_INDEX_STRATEGY_DOLLAR_MOD:
+		case BSON_INDEX_STRATEGY_DOLLAR_BITS_ALL_CLEAR:
+		case BSON_INDEX_STRATEGY_DOLLAR_BITS_ANY_CLEAR:
+		case BSON_INDEX_STRATEGY_DOLLAR_BITS_ALL_SET:
+		case BSON_INDEX_STRATEGY_DOLLAR_BITS_ANY_SET:
+		{
+			break;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+
+	pgbson *queryBson = DatumGetPgBsonPacked(queryValue);
+	pgbsonelement filterElement;
+	if (EnableCollation)
+	{
+		PgbsonToSinglePgbsonElementWithCollation(queryBson, &filterElement);
+	}
+	else
+	{
+		PgbsonToSinglePgbsonElement(queryBson, &filterElement);
+	}
+
+	if (filterElement.pathLength == 0 ||
+		QueryPathHasDigits(filterElement.path, filterElement.pathLength))
+	{
+		return false;
+	}
+
+	if (strategy == BSON_INDEX_STRATEGY_DOLLAR_EXISTS)
+	{
+		if (!BsonValueAsBool(&filterElement.bsonValue))
+		{
+			return false;
+		}
+	}
+	else if (strategy == BSON_INDEX_STRATEGY_DOLLAR_IN)
+	{
+		if (filterElement.bsonValue.value_type != BSON_TYPE_ARRAY)
+		{
+			return false;
+		}
+
+		bson_iter_t arrayIter;
+		BsonValueInitIterator(&filterElement.bsonValue, &arrayIter);
+		while (bson_iter_next(&arrayIter))
+		{
+			bson_type_t elementType = bson_iter_type(&arrayIter);
+			if (elementType == BSON_TYPE_NULL || elementType == BSON_TYPE_UNDEFINED ||
+				elementType == BSON_TYPE_MINKEY || elementType == BSON_TYPE_MAXKEY)
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		bson_type_t valueType = filterElement.bsonValue.value_type;
+		if (valueType == BSON_TYPE_NULL || valueType == BSON_TYPE_UNDEFINED ||
+			valueType == BSON_TYPE_MINKEY || valueType == BSON_TYPE_MAXKEY)
+		{
+			return false;
+		}
+	}
+
+	*path = filterElement.path;
+	*pathLength = filterElement.pathLength;
+	return true;
+}
+
+
 /*
  * ValidateIndexForQualifierValue checks that a given queryValue can be satisfied
  * by the current index given the indexOptions for that index and an operator strategy.
@@ -20,6 +20,7 @@
 #include "geospatial/bson_geospatial_common.h"
 #include "geospatial/bson_geospatial_geonear.h"
 #include "geospatial/bson_geospatial_shape_operators.h"
+#include "infrastructure/documentdb_geospatial_shape_cache.h"
 #include "opclass/bson_gin_common.h"
 #include "opclass/bson_gin_index_mgmt.h"
 #include "metadata/metadata_cache.h"
@@ -433,8 +434,8 @@ PopulateGeospatialQueryState(IndexBsonGeospatialState *state,
 		case BSON_INDEX_STRATEGY_DOLLAR_GEOWITHIN:
 		{
 			opInfo->queryOperatorType = QUERY_OPERATOR_GEOWITHIN;
-			state->state.geoSpatialDatum = shapeOperator->getShapeDatum(&points,
-																		opInfo);
+			state->state.geoSpatialDatum = GetCachedShapeDatum(shapeOperator,
+															   &points, opInfo);
 
 			if (shapeOperator->op == GeospatialShapeOperator_CENTERSPHERE ||
 				shapeOperator->op == GeospatialShapeOperator_CENTER)
@@ -457,8 +458,8 @@ PopulateGeospatialQueryState(IndexBsonGeospatialState *state,
 		case BSON_INDEX_STRATEGY_DOLLAR_GEOINTERSECTS:
 		{
 			opInfo->queryOperatorType = QUERY_OPERATOR_GEOINTERSECTS;
-			state->state.geoSpatialDatum = shapeOperator->getShapeDatum(&points,
-																		opInfo);
+			state->state.geoSpatialDatum = GetCachedShapeDatum(shapeOperator,
+															   &points, opInfo);
 
 			break;
 		}
@@ -42,6 +42,7 @@ static void ThrowErrorArraysNotSupported(const char *path, int pathLength);
 
 static Datum * GenerateTermsForDollarEqual(pgbsonelement *queryElement, int *nentries);
 static Datum * GenerateTermsForDollarIn(pgbsonelement *queryElement, int *nentries);
+static int CompareHashTerms(const void *left, const void *right);
 
 static bool HashIndexVisitTopLevelField(pgbsonelement *element, const
 										StringView *filterPath,
@@ -391,10 +392,44 @@ GenerateTermsForDollarIn(pgbsonelement *queryElement, int *nentries)
 		entries[index] = Int64GetDatum(0);
 	}
 
+	/*
+	 * Large $in lists (e.g. tenant keyed lookups) are probed one term at a time,
+	 * so sort the hashes to probe the entry tree in key order and drop duplicates
+	 * (equal values or hash collisions) so each hash is only looked up once.
+	 * The consistent function matches if any term matches, so order doesn't matter.
+	 */
+	if (*nentries > 1)
+	{
+		qsort(entries, *nentries, sizeof(Datum), CompareHashTerms);
+
+		int numUnique = 1;
+		for (int i = 1; i < *nentries; i++)
+		{
+			if (DatumGetInt64(entries[i]) != DatumGetInt64(entries[numUnique - 1]))
+			{
+				entries[numUnique++] = entries[i];
+			}
+		}
+
+		*nentries = numUnique;
+	}
+
 	return entries;
 }
 
 
+/*
+ * qsort comparator for the int64 hash terms of the index.
+ */
+static int
+CompareHashTerms(const void *left, const void *right)
+{
+	int64 leftHash = DatumGetInt64(*(const Datum *) left);
+	int64 rightHash = DatumGetInt64(*(const Datum *) right);
+	return leftHash < rightHash ? -1 : (leftHash > rightHash ? 1 : 0);
+}
+
+
 /* Helper function to throw common error when array is found during the
  * extractValue document traversal. */
 static void
@@ -22,6 +22,7 @@
 #include <catalog/namespace.h>
 #include <utils/array.h>
 #include <nodes/makefuncs.h>
+#include <utils/memutils.h>
 
 #include "io/bson_core.h"
 #include "opclass/bson_gin_common.h"
@@ -34,6 +35,7 @@
 
 
 extern QueryTextIndexData *QueryTextData;
+extern bool EnableTextVectorReuseForScore;
 extern Datum documentdb_rum_extract_tsvector(PG_FUNCTION_ARGS);
 
 /* --------------------------------------------------------- */
@@ -80,6 +82,8 @@ static void ValidateWeightsSpec(const char *weightsSpec);
 static Size FillWeightsSpec(const char *weightsSpec, void *buffer);
 
 
+static TSVector GetTsVectorForTextScore(pgbson *document,
+										BsonGinTextPathOptions *options);
 static TSVector GenerateTsVectorWithOptions(pgbson *doc,
 											BsonGinTextPathOptions *options);
 
@@ -293,7 +297,7 @@ bson_dollar_text_meta_qual(PG_FUNCTION_ARGS)
 	/* If a runtime check is required, do it */
 	if (evaluateRuntimeCheck)
 	{
-		TSVector vector = GenerateTsVectorWithOptions(document, textOptions);
+		TSVector vector = GetTsVectorForTextScore(document, textOptions);
 		if (vector == NULL)
 		{
 			PG_RETURN_BOOL(false);
@@ -407,7 +411,7 @@ EvaluateMetaTextScore(pgbson *document)
 
 	BsonGinTextPathOptions *textOptions =
 		(BsonGinTextPathOptions *) QueryTextData->indexOptions;
-	TSVector vector = GenerateTsVectorWithOptions(document, textOptions);
+	TSVector vector = GetTsVectorForTextScore(document, textOptions);
 
 	if (vector == NULL)
 	{
@@ -1303,6 +1307,69 @@ GetLanguagePathOverride(const StringView *pathView, StringView *lastParentPath,
 }
 
 
+/*
+ * Returns the TSVector of the document for the runtime $text match and the
+ * textScore. Both the match and every $meta: "textScore" of a query (e.g.
+ * one in the sort and one in the projection) evaluate the same document, so
+ * the vector of the last document is kept and reused while the document and
+ * the options stay the same, instead of parsing the document text again.
+ */
+static TSVector
+GetTsVectorForTextScore(pgbson *document, BsonGinTextPathOptions *options)
+{
+	/* The last document and options the vector was generated for */
+	static MemoryContext TextScoreVectorContext = NULL;
+	static pgbson *LastVectorDocument = NULL;
+	static bytea *LastVectorOptions = NULL;
+	static TSVector LastVector = NULL;
+
+	if (!EnableTextVectorReuseForScore)
+	{
+		return GenerateTsVectorWithOptions(document, options);
+	}
+
+	bytea *optionsBytea = (bytea *) options;
+	if (LastVectorDocument != NULL &&
+		VARSIZE(LastVectorDocument) == VARSIZE(document) &&
+		VARSIZE(LastVectorOptions) == VARSIZE(optionsBytea) &&
+		memcmp(LastVectorDocument, document, VARSIZE(document)) == 0 &&
+		memcmp(LastVectorOptions, optionsBytea, VARSIZE(optionsBytea)) == 0)
+	{
+		return LastVector;
+	}
+
+	TSVector vector = GenerateTsVectorWithOptions(document, options);
+
+	if (TextScoreVectorContext == NULL)
+	{
+		TextScoreVectorContext = AllocSetContextCreate(TopMemoryContext,
+													   "DocumentDB text score vector context",
+													   ALLOCSET_SMALL_SIZES);
+	}
+
+	/* Forget the previous document before copying so that an error leaves no stale entry */
+	LastVectorDocument = NULL;
+	MemoryContextReset(TextScoreVectorContext);
+
+	if (vector == NULL)
+	{
+		return NULL;
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(TextScoreVectorContext);
+	LastVectorOptions = (bytea *) palloc(VARSIZE(optionsBytea));
+	memcpy(LastVectorOptions, optionsBytea, VARSIZE(optionsBytea));
+	LastVector = (TSVector) palloc(VARSIZE(vector));
+	memcpy(LastVector, vector, VARSIZE(vector));
+	pgbson *documentCopy = (pgbson *) palloc(VARSIZE(document));
+	memcpy(documentCopy, document, VARSIZE(document));
+	MemoryContextSwitchTo(oldContext);
+
+	LastVectorDocument = documentCopy;
+	return vector;
+}
+
+
 /*
  * Helper function given a document and an index spec, generates
  * the TSVector that would be inserted given the options.
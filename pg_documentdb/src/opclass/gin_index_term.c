@@ -154,7 +154,12 @@ gin_bson_compare(PG_FUNCTION_ARGS)
 	bool isLeftComposite = IsIndexTermMetadataComposite(leftBuffer[0]);
 	bool isRightComposite = IsIndexTermMetadataComposite(rightBuffer[0]);
 	int32_t compareTerm;
-	if (isLeftComposite || isRightComposite)
+	if (leftSize == rightSize && memcmp(leftBuffer, rightBuffer, leftSize) == 0)
+	{
+		/* Byte-identical terms (metadata included) are equal: skip the parsing */
+		compareTerm = 0;
+	}
+	else if (isLeftComposite || isRightComposite)
 	{
 		/* Both are composite terms: Compare as composite */
 		compareTerm = CompareCompositeIndexTerms(leftBuffer, leftSize, rightBuffer,
@@ -251,6 +256,20 @@ CompareCompositeIndexTerms(const uint8_t *leftBuffer, uint32_t leftIndexTermSize
 		uint32_t leftSize = VARSIZE_ANY(leftBytes);
 		uint32_t rightSize = VARSIZE_ANY(rightBytes);
 
+		/*
+		 * Terms on an entry page are sorted, so neighbouring composite terms
+		 * commonly share their leading terms byte for byte: compare those on
+		 * the serialized form and only parse the first term that differs.
+		 */
+		if (leftSize == rightSize && memcmp(leftBuffer, rightBuffer, leftSize) == 0)
+		{
+			leftBuffer += leftSize;
+			rightBuffer += rightSize;
+			leftIndexTermSize -= leftSize;
+			rightIndexTermSize -= rightSize;
+			continue;
+		}
+
 		BsonIndexTerm leftTerm;
 		BsonIndexTerm rightTerm;
 		InitializeBsonIndexTerm(leftBytes, &leftTerm);
@@ -1560,6 +1579,36 @@ GenerateRootMultiKeyTerm(const IndexTermCreateMetadata *termData)
 }
 
 
+/*
+ * This is the root term that all documents get when an array at the indexed path
+ * or its ancestors has an array element.
+ * Like the multi-key term it points to the illegal path ('') and is a metadata
+ * term. Its value '[ [] ]' differentiates it from the multi-key term.
+ * This allows $elemMatch to trust the array terms of documents without it.
+ */
+Datum
+GenerateRootNestedArrayTerm(const IndexTermCreateMetadata *termData)
+{
+	bson_iter_t iter;
+	pgbson_writer writer;
+	pgbson_array_writer arrayWriter;
+	pgbson_array_writer innerArrayWriter;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterStartArray(&writer, "", 0, &arrayWriter);
+	PgbsonArrayWriterStartArray(&arrayWriter, &innerArrayWriter);
+	PgbsonArrayWriterEndArray(&arrayWriter, &innerArrayWriter);
+	PgbsonWriterEndArray(&writer, &arrayWriter);
+
+	PgbsonWriterGetIterator(&writer, &iter);
+
+	pgbsonelement element = { 0 };
+	BsonIterToSinglePgbsonElement(&iter, &element);
+	IndexTermMetadata termMetadata = IndexTermIsMetadata;
+	return PointerGetDatum(SerializeBsonIndexTermCore(&element, termData,
+													  termMetadata).indexTermVal);
+}
+
+
 /*
  * This is a marker term that is generated when a given document has a term
  * that is truncated.
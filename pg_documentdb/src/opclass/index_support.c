@@ -45,6 +45,7 @@
 #include "vector/vector_spec.h"
 #include "utils/version_utils.h"
 #include "query/bson_compare.h"
+#include "io/bsonvalue_utils.h"
 #include "index_am/index_am_utils.h"
 #include "query/bson_dollar_selectivity.h"
 #include "planner/documentdb_planner.h"
@@ -201,7 +202,10 @@ static OpExpr * CreateExistsTrueOpExpr(Expr *documentExpr, const char *sourcePat
 static List * GetSortDetails(PlannerInfo *root, Index rti,
 							 bool *hasOrderBy, bool *hasGroupby, bool *isOrderById);
 static bool IsValidIndexPathForIdOrderBy(IndexPath *indexPath, List *sortDetails);
-static bool IsValidForIndexOnlyScans(PlannerInfo *root);
+static bool IsValidForIndexOnlyScans(PlannerInfo *root, pgbson **coveredProjectionSpec,
+									 Expr **coveredDocumentExpr);
+static bool IsProjectionCoveredByCompositeIndex(pgbson *projectionSpec,
+												bytea *indexOptions);
 
 /*-------------------------------*/
 /* Force index support functions */
@@ -209,6 +213,7 @@ static bool IsValidForIndexOnlyScans(PlannerInfo *root);
 static List * UpdateIndexListForGeonear(List *existingIndex,
 										ReplaceExtensionFunctionContext *context);
 static bool MatchIndexPathForGeonear(IndexPath *path, void *matchContext);
+static bool MatchOrderedIndexPathForGeonear(IndexPath *path, void *matchContext);
 static bool TryUseAlternateIndexGeonear(PlannerInfo *root, RelOptInfo *rel,
 										ReplaceExtensionFunctionContext *context,
 										MatchIndexPath matchIndexPath);
@@ -253,6 +258,12 @@ static bool TryUseAlternateIndexForPrimaryKeyLookup(PlannerInfo *root, RelOptInf
 													MatchIndexPath matchIndexPath);
 static void PrimaryKeyLookupUnableToFindIndex(void);
 static bool IsBsonRangeArgsForFullScan(List *args);
+static bool IsPartialFilterClauseImplied(Expr *predicate, List *restrictInfoList);
+static bool IsComparableForImplication(const bson_value_t *value);
+static bool QueryOperatorImpliesPredicate(MongoQueryOperatorType queryOperator,
+										  const bson_value_t *queryValue,
+										  MongoQueryOperatorType predicateOperator,
+										  const bson_value_t *predicateValue);
 
 static const ForceIndexSupportFuncs ForceIndexOperatorSupport[] =
 {
@@ -307,6 +318,7 @@ static const ForceIndexSupportFuncs ForceIndexOperatorSupport[] =
 
 extern bool EnableVectorForceIndexPushdown;
 extern bool EnableGeonearForceIndexPushdown;
+extern bool EnableGeonearOrderedIndexScan;
 extern bool UseNewElemMatchIndexPushdown;
 extern bool UseNewElemMatchIndexOperatorOnPushdown;
 extern bool DisableDollarSupportFuncSelectivity;
@@ -322,8 +334,12 @@ extern bool EnableIdIndexPushdown;
 extern bool ForceIndexOnlyScanIfAvailable;
 extern bool EnableIdIndexCustomCostFunction;
 extern bool EnableIndexOnlyScan;
+extern bool EnableCoveredProjectionIndexOnlyScan;
+extern bool EnableDistinctIndexOnlyScan;
+extern bool EnableGroupIndexOnlyScan;
 extern bool EnableOrderByIdOnCostFunction;
 extern bool EnablePrimaryKeyCursorScan;
+extern bool EnableImpliedPartialIndexMatch;
 
 /* --------------------------------------------------------- */
 /* Top level exports */
@@ -1312,6 +1328,29 @@ ForceIndexForQueryOperators(PlannerInfo *root, RelOptInfo *rel,
 													 forceIndexFuncs->matchIndexPath,
 													 context->forceIndexQueryOpData.
 													 opExtraState);
+
+		if (matchingPath != NULL &&
+			context->forceIndexQueryOpData.type == ForceIndexOpType_GeoNear &&
+			EnableGeonearOrderedIndexScan)
+		{
+			/*
+			 * Prefer the distance ordered scan of the geo index if one was created,
+			 * so that documents stream in distance order and a limit stops the scan
+			 * early instead of a bitmap scan that sorts all the candidates.
+			 */
+			Path *orderedPath = FindIndexPathForQueryOperator(rel, rel->pathlist,
+															  context,
+															  MatchOrderedIndexPathForGeonear,
+															  context->
+															  forceIndexQueryOpData.
+															  opExtraState);
+			if (orderedPath != NULL)
+			{
+				matchingPath = orderedPath;
+				rel->pathlist = list_make1(orderedPath);
+				rel->partial_pathlist = NIL;
+			}
+		}
 	}
 
 	if (matchingPath == NULL)
@@ -1531,20 +1570,514 @@ PlanHasAggregates(PlannerInfo *root)
 }
 
 
+/*
+ * Checks whether the target list of the query is a single find projection
+ * on the document with a constant spec, i.e. bson_dollar_project(document, spec)
+ * or bson_dollar_project_find(document, spec[, query]). Returns the spec
+ * if it is, NULL otherwise.
+ */
+static pgbson *
+GetCoveredProjectionCandidateSpec(PlannerInfo *root)
+{
+	pgbson *projectionSpec = NULL;
+	ListCell *cell;
+	foreach(cell, root->processed_tlist)
+	{
+		TargetEntry *entry = lfirst_node(TargetEntry, cell);
+		if (!IsA(entry->expr, FuncExpr))
+		{
+			bool entryHasVarOrQuery = false;
+			expression_tree_walker((Node *) entry->expr,
+								   ProjectionReferencesDocumentVar,
+								   &entryHasVarOrQuery);
+			if (entryHasVarOrQuery)
+			{
+				return NULL;
+			}
+
+			continue;
+		}
+
+		FuncExpr *funcExpr = (FuncExpr *) entry->expr;
+		bool isFindProjection = funcExpr->funcid == BsonDollarProjectFindFunctionOid() &&
+								list_length(funcExpr->args) <= 3;
+		bool isProjection = funcExpr->funcid == BsonDollarProjectFunctionOid() &&
+							list_length(funcExpr->args) == 2;
+		if (projectionSpec != NULL || (!isFindProjection && !isProjection))
+		{
+			return NULL;
+		}
+
+		Expr *documentExpr = linitial(funcExpr->args);
+		Expr *specExpr = lsecond(funcExpr->args);
+		if (!IsA(documentExpr, Var) || !IsA(specExpr, Const) ||
+			((Const *) specExpr)->constisnull)
+		{
+			return NULL;
+		}
+
+		if (list_length(funcExpr->args) == 3 && !IsA(lthird(funcExpr->args), Const))
+		{
+			return NULL;
+		}
+
+		projectionSpec = DatumGetPgBson(((Const *) specExpr)->constvalue);
+	}
+
+	return projectionSpec;
+}
+
+
+/*
+ * Checks whether the target list of the query is the distinct unwind of a
+ * top level path, i.e. bson_distinct_unwind(document, 'path') as built by the
+ * distinct command. The unwind only needs the value of that path, so this is
+ * treated as the projection { path: 1, _id: 0 } and the spec is returned along
+ * with the document expression. Returns NULL otherwise.
+ */
+static pgbson *
+GetCoveredDistinctCandidateSpec(PlannerInfo *root, Expr **documentExpr)
+{
+	if (root->parse->distinctClause == NIL || !root->parse->hasTargetSRFs)
+	{
+		return NULL;
+	}
+
+	FuncExpr *distinctUnwind = NULL;
+	ListCell *cell;
+	foreach(cell, root->processed_tlist)
+	{
+		TargetEntry *entry = lfirst_node(TargetEntry, cell);
+		if (IsA(entry->expr, FuncExpr) &&
+			((FuncExpr *) entry->expr)->funcid == BsonDistinctUnwindFunctionOid())
+		{
+			if (distinctUnwind != NULL)
+			{
+				return NULL;
+			}
+
+			distinctUnwind = (FuncExpr *) entry->expr;
+			continue;
+		}
+
+		bool entryHasVarOrQuery = false;
+		expression_tree_walker((Node *) entry->expr,
+							   ProjectionReferencesDocumentVar,
+							   &entryHasVarOrQuery);
+		if (entryHasVarOrQuery)
+		{
+			return NULL;
+		}
+	}
+
+	if (distinctUnwind == NULL || list_length(distinctUnwind->args) != 2)
+	{
+		return NULL;
+	}
+
+	Expr *documentArg = linitial(distinctUnwind->args);
+	Expr *pathArg = lsecond(distinctUnwind->args);
+	if (!IsA(documentArg, Var) || !IsA(pathArg, Const) ||
+		((Const *) pathArg)->constisnull)
+	{
+		return NULL;
+	}
+
+	char *distinctPath = TextDatumGetCString(((Const *) pathArg)->constvalue);
+	if (distinctPath[0] == '\0' || distinctPath[0] == '$' ||
+		strchr(distinctPath, '.') != NULL)
+	{
+		/* Nested paths are not stored as such in the rebuilt document */
+		return NULL;
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterAppendInt32(&writer, distinctPath, strlen(distinctPath), 1);
+	if (strcmp(distinctPath, "_id") != 0)
+	{
+		PgbsonWriterAppendInt32(&writer, "_id", 3, 0);
+	}
+
+	*documentExpr = documentArg;
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * Checks whether an expression spec only reads top level paths of the
+ * document (or is a constant), adding the paths read to the list. Operators
+ * and variables may read anything, so they are not covered.
+ */
 static bool
-IsValidForIndexOnlyScans(PlannerInfo *root)
+IsCoveredGroupExpressionValue(const bson_value_t *value, List **paths)
 {
-	if (!PlanHasAggregates(root) ||
-		root->hasJoinRTEs)
+	if (value->value_type == BSON_TYPE_UTF8)
 	{
-		/* Don't handle simple queries for now - only things with aggregates
-		 * Note: Things like GroupBy with no aggregates will not work here, but
-		 * that's okay. We also only consider base tables for index only scans.
-		 * TODO: This can also be extended to handle covered indexes later.
-		 */
+		const char *pathString = value->value.v_utf8.str;
+		uint32_t pathLength = value->value.v_utf8.len;
+		if (pathLength == 0 || pathString[0] != '$')
+		{
+			return true;
+		}
+
+		if (pathLength == 1 || memchr(pathString + 1, '$', pathLength - 1) != NULL ||
+			memchr(pathString + 1, '.', pathLength - 1) != NULL)
+		{
+			/* Variables and nested paths */
+			return false;
+		}
+
+		char *path = pnstrdup(pathString + 1, pathLength - 1);
+		ListCell *cell;
+		foreach(cell, *paths)
+		{
+			if (strcmp(lfirst(cell), path) == 0)
+			{
+				return true;
+			}
+		}
+
+		*paths = lappend(*paths, path);
+		return true;
+	}
+	else if (value->value_type == BSON_TYPE_DOCUMENT ||
+			 value->value_type == BSON_TYPE_ARRAY)
+	{
+		bson_iter_t valueIter;
+		BsonValueInitIterator(value, &valueIter);
+		while (bson_iter_next(&valueIter))
+		{
+			if (value->value_type == BSON_TYPE_DOCUMENT &&
+				bson_iter_key(&valueIter)[0] == '$')
+			{
+				return false;
+			}
+
+			if (!IsCoveredGroupExpressionValue(bson_iter_value(&valueIter), paths))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+typedef struct CoveredGroupWalkerContext
+{
+	/* The document the expressions are evaluated against */
+	Expr *documentExpr;
+
+	/* The top level paths (char *) read by the expressions */
+	List *paths;
+
+	/* Whether something other than the covered paths reads the document */
+	bool isNotCovered;
+} CoveredGroupWalkerContext;
+
+
+static bool
+CoveredGroupExpressionWalker(Node *node, CoveredGroupWalkerContext *context)
+{
+	CHECK_FOR_INTERRUPTS();
+
+	if (node == NULL || context->isNotCovered)
+	{
+		return false;
+	}
+
+	if (IsA(node, Var) || IsA(node, Query))
+	{
+		context->isNotCovered = true;
+		return false;
+	}
+
+	if (IsA(node, FuncExpr) &&
+		((FuncExpr *) node)->funcid == BsonExpressionGetFunctionOid() &&
+		list_length(((FuncExpr *) node)->args) == 3 &&
+		IsA(linitial(((FuncExpr *) node)->args), Var))
+	{
+		/* bson_expression_get(document, { "": expression }, isNullOnEmpty) */
+		FuncExpr *funcExpr = (FuncExpr *) node;
+		Expr *documentExpr = linitial(funcExpr->args);
+		Expr *specExpr = lsecond(funcExpr->args);
+		if (!IsA(specExpr, Const) || ((Const *) specExpr)->constisnull ||
+			!IsA(lthird(funcExpr->args), Const) ||
+			(context->documentExpr != NULL &&
+			 !equal(context->documentExpr, documentExpr)))
+		{
+			context->isNotCovered = true;
+			return false;
+		}
+
+		pgbsonelement specElement;
+		PgbsonToSinglePgbsonElement(DatumGetPgBson(((Const *) specExpr)->constvalue),
+									&specElement);
+		if (!IsCoveredGroupExpressionValue(&specElement.bsonValue, &context->paths))
+		{
+			context->isNotCovered = true;
+			return false;
+		}
+
+		context->documentExpr = documentExpr;
+		return false;
+	}
+
+	return expression_tree_walker(node, CoveredGroupExpressionWalker, context);
+}
+
+
+/*
+ * Checks whether a group query (e.g. from $group or $sortByCount) only reads
+ * top level paths of the document in its group keys and accumulators. These
+ * only need the values of those paths, so this is treated as the projection
+ * { path1: 1, ..., _id: 0 } and the spec is returned along with the document
+ * expression. Returns NULL otherwise.
+ */
+static pgbson *
+GetCoveredGroupCandidateSpec(PlannerInfo *root, Expr **documentExpr)
+{
+	if (root->parse->groupClause == NIL || root->parse->havingQual != NULL ||
+		root->parse->hasTargetSRFs || root->parse->hasWindowFuncs)
+	{
+		return NULL;
+	}
+
+	CoveredGroupWalkerContext context = { 0 };
+	expression_tree_walker((Node *) root->processed_tlist,
+						   CoveredGroupExpressionWalker, &context);
+	if (context.isNotCovered || context.paths == NIL)
+	{
+		return NULL;
+	}
+
+	bool hasIdPath = false;
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	ListCell *cell;
+	foreach(cell, context.paths)
+	{
+		const char *path = lfirst(cell);
+		hasIdPath = hasIdPath || strcmp(path, "_id") == 0;
+		PgbsonWriterAppendInt32(&writer, path, strlen(path), 1);
+	}
+
+	if (!hasIdPath)
+	{
+		PgbsonWriterAppendInt32(&writer, "_id", 3, 0);
+	}
+
+	*documentExpr = context.documentExpr;
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * A distinct or group query without filters has no index paths to turn into
+ * index only scans. For those, this builds a full scan index path on every
+ * composite index that covers the paths read by the query so that the values
+ * can be read from the index terms instead of the documents.
+ */
+static List *
+CreateCoveredFullScanPaths(PlannerInfo *root, RelOptInfo *rel,
+						   Expr *documentExpr, pgbson *coveredSpec)
+{
+	if (rel->baserestrictinfo != NIL)
+	{
+		/* The filters are matched against the existing index paths */
+		return NIL;
+	}
+
+	List *fullScanPaths = NIL;
+	ListCell *cell;
+	foreach(cell, rel->indexlist)
+	{
+		IndexOptInfo *indexInfo = lfirst(cell);
+		if (!IsBsonRegularIndexAm(indexInfo->relam) ||
+			indexInfo->indpred != NIL || indexInfo->nkeycolumns < 1 ||
+			indexInfo->opclassoptions == NULL ||
+			!IsOrderBySupportedOnOpClass(indexInfo->relam, indexInfo->opfamily[0]))
+		{
+			/* Partial (and sparse) indexes don't have a term for every document */
+			continue;
+		}
+
+		bytea *indexOptions = indexInfo->opclassoptions[0];
+		if (!IsProjectionCoveredByCompositeIndex(coveredSpec, indexOptions))
+		{
+			continue;
+		}
+
+		bool isWildcardIndex = false;
+		const char *firstIndexPath = GetFirstPathFromIndexOptionsIfApplicable(
+			indexOptions, &isWildcardIndex);
+		if (firstIndexPath == NULL || isWildcardIndex)
+		{
+			continue;
+		}
+
+		int32_t orderByScanDirectionNone = 0;
+		OpExpr *scanClause = CreateFullScanOpExpr(documentExpr, firstIndexPath,
+												  strlen(firstIndexPath),
+												  orderByScanDirectionNone);
+
+		RestrictInfo *fullScanRestrictInfo =
+			make_simple_restrictinfo(root, (Expr *) scanClause);
+		IndexClause *singleIndexClause = makeNode(IndexClause);
+		singleIndexClause->rinfo = fullScanRestrictInfo;
+		singleIndexClause->indexquals = list_make1(fullScanRestrictInfo);
+		singleIndexClause->lossy = false;
+		singleIndexClause->indexcol = 0;
+		singleIndexClause->indexcols = NIL;
+
+		IndexPath *fullScanPath = create_index_path(root, indexInfo,
+													list_make1(singleIndexClause),
+													NIL, NIL, NIL,
+													ForwardScanDirection, false,
+													NULL, 1, false);
+		fullScanPaths = lappend(fullScanPaths, fullScanPath);
+	}
+
+	return fullScanPaths;
+}
+
+
+/*
+ * Checks whether a find projection can be computed from the document that
+ * the composite index reconstructs from its terms. This is the case for an
+ * inclusion projection of top level paths that are all index paths, where
+ * _id is either excluded or is itself an index path.
+ */
+static bool
+IsProjectionCoveredByCompositeIndex(pgbson *projectionSpec, bytea *indexOptions)
+{
+	if (indexOptions == NULL ||
+		((BsonGinIndexOptionsBase *) indexOptions)->type != IndexOptionsType_Composite ||
+		((BsonGinCompositePathOptions *) indexOptions)->wildcardPathIndex >= 0)
+	{
+		return false;
+	}
+
+	bool hasIdPath = false;
+	bool hasIncludedPath = false;
+	bson_iter_t projectionIter;
+	PgbsonInitIterator(projectionSpec, &projectionIter);
+	while (bson_iter_next(&projectionIter))
+	{
+		const char *path = bson_iter_key(&projectionIter);
+		const bson_value_t *value = bson_iter_value(&projectionIter);
+		if (!BsonValueIsNumberOrBool(value) || strchr(path, '.') != NULL ||
+			path[0] == '$')
+		{
+			/* Expressions, nested paths and operators need the full document */
+			return false;
+		}
+
+		int8_t sortDirection = 0;
+		bool isIndexPath = GetCompositeOpClassColumnNumber(path, indexOptions,
+														   &sortDirection) >= 0;
+		bool isIdPath = strcmp(path, "_id") == 0;
+		if (!BsonValueAsBool(value))
+		{
+			if (!isIdPath)
+			{
+				/* Exclusion projections return paths that are not indexed */
+				return false;
+			}
+
+			hasIdPath = true;
+			continue;
+		}
+
+		if (!isIndexPath)
+		{
+			return false;
+		}
+
+		hasIdPath = hasIdPath || isIdPath;
+		hasIncludedPath = true;
+	}
+
+	if (!hasIdPath)
+	{
+		/* _id is included by default, so it needs to be in the index */
+		int8_t sortDirection = 0;
+		hasIdPath = GetCompositeOpClassColumnNumber("_id", indexOptions,
+													&sortDirection) >= 0;
+	}
+
+	return hasIdPath && hasIncludedPath;
+}
+
+
+/*
+ * Checks whether the query shape allows index only scans: Queries with
+ * aggregates that don't reference the document, or (when coveredProjectionSpec
+ * is provided) find queries with a projection that may be covered by a composite
+ * index. In the latter case the projection spec is returned so that it can
+ * be matched against the paths of each index. Distinct and group queries
+ * that only read top level paths are treated as a projection of those paths,
+ * and the document expression they read is returned as well.
+ */
+static bool
+IsValidForIndexOnlyScans(PlannerInfo *root, pgbson **coveredProjectionSpec,
+						 Expr **coveredDocumentExpr)
+{
+	if (coveredProjectionSpec != NULL)
+	{
+		*coveredProjectionSpec = NULL;
+		*coveredDocumentExpr = NULL;
+	}
+
+	if (root->hasJoinRTEs)
+	{
+		/* We only consider base tables for index only scans. */
 		return false;
 	}
 
+	if (coveredProjectionSpec != NULL && EnableDistinctIndexOnlyScan &&
+		root->parse->groupClause == NIL && !root->parse->hasWindowFuncs)
+	{
+		/* The outer query aggregates the distinct values, so this is checked
+		 * before the aggregates below which require no document references.
+		 */
+		*coveredProjectionSpec = GetCoveredDistinctCandidateSpec(root,
+																 coveredDocumentExpr);
+		if (*coveredProjectionSpec != NULL)
+		{
+			return true;
+		}
+	}
+
+	if (coveredProjectionSpec != NULL && EnableGroupIndexOnlyScan &&
+		root->parse->hasAggs)
+	{
+		*coveredProjectionSpec = GetCoveredGroupCandidateSpec(root,
+															  coveredDocumentExpr);
+		if (*coveredProjectionSpec != NULL)
+		{
+			return true;
+		}
+	}
+
+	if (!PlanHasAggregates(root))
+	{
+		/* Note: Things like GroupBy with no aggregates will not work here, but
+		 * that's okay. Simple queries are only handled when the projection is
+		 * covered by the index paths.
+		 */
+		if (coveredProjectionSpec == NULL || !EnableCoveredProjectionIndexOnlyScan ||
+			root->parse->groupClause != NIL || root->parse->hasWindowFuncs)
+		{
+			return false;
+		}
+
+		*coveredProjectionSpec = GetCoveredProjectionCandidateSpec(root);
+		return *coveredProjectionSpec != NULL;
+	}
+
 	bool projectionHasVarOrQuery = false;
 	expression_tree_walker((Node *) root->processed_tlist,
 						   ProjectionReferencesDocumentVar,
@@ -1561,13 +2094,256 @@ IsValidForIndexOnlyScans(PlannerInfo *root)
 }
 
 
+/*
+ * Postgres only uses a partial index if the quals of the query prove its
+ * predicate, which for the bson operators means the same clause is in the
+ * query. Range filters of the query also imply the range and $exists clauses
+ * of a partialFilterExpression on the same path: { a: { $gt: 10 } } implies
+ * { a: { $gte: 5 } } and { a: { $exists: true } }. This marks the partial
+ * indexes implied that way as usable and builds their index paths.
+ */
+void
+ConsiderPartialIndexesImpliedByQuals(PlannerInfo *root, RelOptInfo *rel)
+{
+	if (!EnableImpliedPartialIndexMatch || rel->baserestrictinfo == NIL)
+	{
+		return;
+	}
+
+	bool hasImpliedIndexes = false;
+	ListCell *indexCell;
+	foreach(indexCell, rel->indexlist)
+	{
+		IndexOptInfo *index = lfirst_node(IndexOptInfo, indexCell);
+		if (index->indpred == NIL || index->predOK)
+		{
+			continue;
+		}
+
+		bool isImplied = true;
+		ListCell *predicateCell;
+		foreach(predicateCell, index->indpred)
+		{
+			if (!IsPartialFilterClauseImplied(lfirst(predicateCell),
+											  rel->baserestrictinfo))
+			{
+				isImplied = false;
+				break;
+			}
+		}
+
+		if (isImplied)
+		{
+			/* All the quals stay in indrestrictinfo, they're rechecked as filters */
+			index->predOK = true;
+			hasImpliedIndexes = true;
+		}
+	}
+
+	if (hasImpliedIndexes)
+	{
+		/* The paths of the other indexes are added again, add_path keeps one of each */
+		create_index_paths(root, rel);
+	}
+}
+
+
+/*
+ * Whether a clause of a partialFilterExpression is implied by one of the
+ * restriction clauses on the same path.
+ */
+static bool
+IsPartialFilterClauseImplied(Expr *predicate, List *restrictInfoList)
+{
+	List *predicateArgs = NIL;
+	const MongoQueryOperator *predicateOperator =
+		GetMongoQueryOperatorFromExpr((Node *) predicate, &predicateArgs);
+	if (predicateOperator->operatorType == QUERY_OPERATOR_UNKNOWN ||
+		list_length(predicateArgs) != 2 || !IsA(linitial(predicateArgs), Var) ||
+		!IsA(lsecond(predicateArgs), Const))
+	{
+		return false;
+	}
+
+	pgbsonelement predicateElement;
+	if (!TryGetSinglePgbsonElementFromPgbson(
+			DatumGetPgBson(((Const *) lsecond(predicateArgs))->constvalue),
+			&predicateElement))
+	{
+		return false;
+	}
+
+	Var *predicateVar = linitial(predicateArgs);
+	ListCell *restrictInfoCell;
+	foreach(restrictInfoCell, restrictInfoList)
+	{
+		RestrictInfo *restrictInfo = lfirst_node(RestrictInfo, restrictInfoCell);
+
+		/* Query operators with a collation have more than 2 args and are skipped */
+		List *queryArgs = NIL;
+		const MongoQueryOperator *queryOperator =
+			GetMongoQueryOperatorFromExpr((Node *) restrictInfo->clause, &queryArgs);
+		if (queryOperator->operatorType == QUERY_OPERATOR_UNKNOWN ||
+			list_length(queryArgs) != 2 || !IsA(linitial(queryArgs), Var) ||
+			!IsA(lsecond(queryArgs), Const) ||
+			((Var *) linitial(queryArgs))->varattno != predicateVar->varattno)
+		{
+			continue;
+		}
+
+		Const *queryConst = lsecond(queryArgs);
+		pgbsonelement queryElement;
+		if (queryConst->constisnull ||
+			!TryGetSinglePgbsonElementFromPgbson(DatumGetPgBson(queryConst->constvalue),
+												 &queryElement))
+		{
+			continue;
+		}
+
+		if (queryElement.pathLength != predicateElement.pathLength ||
+			strncmp(queryElement.path, predicateElement.path,
+					predicateElement.pathLength) != 0)
+		{
+			continue;
+		}
+
+		if (QueryOperatorImpliesPredicate(queryOperator->operatorType,
+										  &queryElement.bsonValue,
+										  predicateOperator->operatorType,
+										  &predicateElement.bsonValue))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * Scalars whose query comparisons only match values of the same sort order
+ * type, documents and arrays are compared as a whole and null (or minKey/maxKey)
+ * bounds also match missing fields.
+ */
+static bool
+IsComparableForImplication(const bson_value_t *value)
+{
+	switch (value->value_type)
+	{
+		case BSON_TYPE_NULL:
+		case BSON_TYPE_UNDEFINED:
+		case BSON_TYPE_MINKEY:
+		case BSON_TYPE_MAXKEY:
+		case BSON_TYPE_DOCUMENT:
+		case BSON_TYPE_ARRAY:
+		case BSON_TYPE_REGEX:
+		{
+			return false;
+		}
+
+		default:
+		{
+			return true;
+		}
+	}
+}
+
+
+/*
+ * Whether a query clause on a path implies a partialFilterExpression clause
+ * on the same path (each matched value of the query matches the predicate).
+ */
+static bool
+QueryOperatorImpliesPredicate(MongoQueryOperatorType queryOperator,
+							  const bson_value_t *queryValue,
+							  MongoQueryOperatorType predicateOperator,
+							  const bson_value_t *predicateValue)
+{
+	if (queryOperator != QUERY_OPERATOR_EQ && queryOperator != QUERY_OPERATOR_GT &&
+		queryOperator != QUERY_OPERATOR_GTE && queryOperator != QUERY_OPERATOR_LT &&
+		queryOperator != QUERY_OPERATOR_LTE)
+	{
+		/* $exists: true in the query is the same clause as in the predicate */
+		return false;
+	}
+
+	if (!IsComparableForImplication(queryValue))
+	{
+		return false;
+	}
+
+	if (predicateOperator == QUERY_OPERATOR_GTE &&
+		predicateValue->value_type == BSON_TYPE_MINKEY)
+	{
+		/* The index predicate of $exists: true is { path: { $gte: MinKey } } */
+		return true;
+	}
+
+	if (!IsComparableForImplication(predicateValue) ||
+		CompareBsonSortOrderType(queryValue, predicateValue) != 0)
+	{
+		return false;
+	}
+
+	bool isComparisonValid = false;
+	int compare = CompareBsonValueAndType(queryValue, predicateValue,
+										  &isComparisonValid);
+	if (!isComparisonValid)
+	{
+		return false;
+	}
+
+	switch (predicateOperator)
+	{
+		case QUERY_OPERATOR_EQ:
+		{
+			return queryOperator == QUERY_OPERATOR_EQ && compare == 0 &&
+				   queryValue->value_type == predicateValue->value_type;
+		}
+
+		case QUERY_OPERATOR_GTE:
+		{
+			return (queryOperator == QUERY_OPERATOR_EQ ||
+					queryOperator == QUERY_OPERATOR_GT ||
+					queryOperator == QUERY_OPERATOR_GTE) && compare >= 0;
+		}
+
+		case QUERY_OPERATOR_GT:
+		{
+			return (queryOperator == QUERY_OPERATOR_GT && compare >= 0) ||
+				   ((queryOperator == QUERY_OPERATOR_EQ ||
+					 queryOperator == QUERY_OPERATOR_GTE) && compare > 0);
+		}
+
+		case QUERY_OPERATOR_LTE:
+		{
+			return (queryOperator == QUERY_OPERATOR_EQ ||
+					queryOperator == QUERY_OPERATOR_LT ||
+					queryOperator == QUERY_OPERATOR_LTE) && compare <= 0;
+		}
+
+		case QUERY_OPERATOR_LT:
+		{
+			return (queryOperator == QUERY_OPERATOR_LT && compare <= 0) ||
+				   ((queryOperator == QUERY_OPERATOR_EQ ||
+					 queryOperator == QUERY_OPERATOR_LTE) && compare < 0);
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
 /*
  * Check whether we can handle index scans as index only scans.
  * This is possible if:
  * 1) The query is against a base table
  * 2) There are no joins
- * 3) Projection is covered (Today this requires projection to be a constant but
- *    this can be extended in the future)
+ * 3) Projection is covered (Today this requires projection to be a constant, or
+ *    an inclusion projection of composite index paths for find queries)
  * 4) Filters are covered by the index.
  * 5) The index filters are are not lossy operators.
  * 6) The index is a composite index.
@@ -1581,7 +2357,9 @@ ConsiderIndexOnlyScan(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte,
 		return;
 	}
 
-	if (!IsValidForIndexOnlyScans(root))
+	pgbson *coveredProjectionSpec = NULL;
+	Expr *coveredDocumentExpr = NULL;
+	if (!IsValidForIndexOnlyScans(root, &coveredProjectionSpec, &coveredDocumentExpr))
 	{
 		return;
 	}
@@ -1592,9 +2370,18 @@ ConsiderIndexOnlyScan(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte,
 		return;
 	}
 
+	List *candidatePaths = rel->pathlist;
+	if (coveredDocumentExpr != NULL)
+	{
+		candidatePaths = list_concat_copy(rel->pathlist,
+										  CreateCoveredFullScanPaths(
+											  root, rel, coveredDocumentExpr,
+											  coveredProjectionSpec));
+	}
+
 	List *addedPaths = NIL;
 	ListCell *cell;
-	foreach(cell, rel->pathlist)
+	foreach(cell, candidatePaths)
 	{
 		Path *path = (Path *) lfirst(cell);
 		if (IsA(path, BitmapHeapPath))
@@ -1624,6 +2411,12 @@ ConsiderIndexOnlyScan(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte,
 		if (IsBtreePrimaryKeyIndex(indexPath->indexinfo) &&
 			EnableIdIndexPushdown)
 		{
+			if (coveredProjectionSpec != NULL)
+			{
+				/* The _id index does not return the document */
+				continue;
+			}
+
 			if (EnableIdIndexCustomCostFunction && !ForceIndexOnlyScanIfAvailable)
 			{
 				continue;
@@ -1663,6 +2456,16 @@ ConsiderIndexOnlyScan(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte,
 				continue;
 			}
 
+			if (coveredProjectionSpec != NULL &&
+				!IsProjectionCoveredByCompositeIndex(coveredProjectionSpec,
+													 indexPath->indexinfo->opclassoptions
+													 != NULL ?
+													 indexPath->indexinfo->
+													 opclassoptions[0] : NULL))
+			{
+				continue;
+			}
+
 			if (!IndexClausesValidForIndexOnlyScan(indexPath, rel, context))
 			{
 				continue;
@@ -1793,7 +2596,7 @@ documentdb_btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	}
 
 	if (EnableIdIndexCustomCostFunction && EnableIndexOnlyScan &&
-		IsValidForIndexOnlyScans(root))
+		IsValidForIndexOnlyScans(root, NULL, NULL))
 	{
 		bool hasOtherQuals = false;
 		IndexPath *modified = TrimIndexRestrictInfoForBtreePath(root, path,
@@ -1846,6 +2649,19 @@ GetSortDetails(PlannerInfo *root, Index rti,
 
 		EquivalenceMember *member = linitial(pathkey->pk_eclass->ec_members);
 
+		if (IsA(member->em_expr, Var) && *hasOrderBy &&
+			lnext(root->query_pathkeys, sortCell) == NULL &&
+			((Var *) member->em_expr)->varno == (int) rti &&
+			((Var *) member->em_expr)->varattno ==
+			DOCUMENT_DATA_TABLE_OBJECT_ID_VAR_ATTR_NUMBER)
+		{
+			/*
+			 * A sorted streamable find breaks the ties of its sort by object_id:
+			 * the sort before it can still be ordered by the index.
+			 */
+			break;
+		}
+
 		if (!IsA(member->em_expr, FuncExpr))
 		{
 			return NIL;
@@ -3882,6 +4698,26 @@ MatchIndexPathForGeonear(IndexPath *indexPath, void *matchContext)
 }
 
 
+/*
+ * Matches the index path for $geoNear query like MatchIndexPathForGeonear
+ * and additionally checks that the path is ordered by the geonear distance
+ * operator i.e. it is a nearest neighbor scan of the index.
+ */
+static bool
+MatchOrderedIndexPathForGeonear(IndexPath *indexPath, void *matchContext)
+{
+	if (list_length(indexPath->indexorderbys) != 1 ||
+		!MatchIndexPathForGeonear(indexPath, matchContext))
+	{
+		return false;
+	}
+
+	Expr *orderByExpr = linitial(indexPath->indexorderbys);
+	return IsA(orderByExpr, OpExpr) &&
+		   ((OpExpr *) orderByExpr)->opno == BsonGeonearDistanceOperatorId();
+}
+
+
 /*
  * This function just performs a pointer equality for two index
  * paths provided
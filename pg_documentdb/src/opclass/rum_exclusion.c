@@ -48,6 +48,7 @@
 
 #include "io/bson_core.h"
 #include "io/bson_hash.h"
+#include "query/bson_compare.h"
 #include "utils/documentdb_errors.h"
 #include "utils/version_utils.h"
 #include "utils/hashset_utils.h"
@@ -62,6 +63,12 @@
 extern int DefaultUniqueIndexKeyhashOverride;
 extern bool UseNewUniqueHashEqualityFunction;
 
+/*
+ * The number of terms of the left document up to which the unique recheck
+ * compares terms directly instead of building a hash table.
+ */
+#define UNIQUE_RECHECK_MAX_LINEAR_TERMS 16
+
 static pgbson * GetShardKeyAndDocument(HeapTupleHeader input, int64_t *shardKey);
 static IndexTraverseOption GetExclusionIndexTraverseOption(void *contextOptions,
 														   const char *currentPath,
@@ -83,6 +90,12 @@ static HTAB * GetUniqueShardDocumentTermsHTABNew(pgbson *uniqueShardDocument,
 												 int64_t *shardKeyValue,
 												 bool *hasShardKeyValue);
 static HTAB * GetUniqueShardDocumentTermsHTAB(pgbson *document);
+static bool TryCheckUniqueShardConflictWithoutHash(pgbson *left, pgbson *right,
+												   int64_t *leftShardKey,
+												   bool *hasLeftShardKey,
+												   int64_t *rightShardKey,
+												   bool *hasRightShardKey,
+												   bool *uniquenessConflict);
 
 typedef struct IndexBounds
 {
@@ -469,24 +482,34 @@ BsonUniqueShardEqualNew(PG_FUNCTION_ARGS)
 	pgbson *left = PG_GETARG_PGBSON_PACKED(0);
 	pgbson *right = PG_GETARG_PGBSON_PACKED(1);
 
-
-	/* Build HTAB with every pair of { <path> : <term> } */
 	int64_t leftShardKey = 0;
 	bool hasLeftShardKey = false;
-	HTAB *leftHashTable = GetUniqueShardDocumentTermsHTABNew(left, &leftShardKey,
-															 &hasLeftShardKey);
-
-	/*
-	 * Iterate through pgbson on the right to check if every path (key) has
-	 * a term match on the left.
-	 */
 	int64_t rightShardKey = 0;
 	bool hasRightShardKey = false;
-	bool uniquenessConflict = ProcessUniqueShardDocumentKeysNew(right, &rightShardKey,
-																&hasRightShardKey,
-																leftHashTable, HASH_FIND);
+	bool uniquenessConflict = false;
+	if (!TryCheckUniqueShardConflictWithoutHash(left, right, &leftShardKey,
+												&hasLeftShardKey, &rightShardKey,
+												&hasRightShardKey,
+												&uniquenessConflict))
+	{
+		/* Build HTAB with every pair of { <path> : <term> } */
+		leftShardKey = 0;
+		hasLeftShardKey = false;
+		HTAB *leftHashTable = GetUniqueShardDocumentTermsHTABNew(left, &leftShardKey,
+																 &hasLeftShardKey);
+
+		/*
+		 * Iterate through pgbson on the right to check if every path (key) has
+		 * a term match on the left.
+		 */
+		uniquenessConflict = ProcessUniqueShardDocumentKeysNew(right, &rightShardKey,
+															   &hasRightShardKey,
+															   leftHashTable,
+															   HASH_FIND);
+
+		hash_destroy(leftHashTable);
+	}
 
-	hash_destroy(leftHashTable);
 	PG_FREE_IF_COPY(left, 0);
 	PG_FREE_IF_COPY(right, 1);
 
@@ -1204,6 +1227,104 @@ ProcessUniqueShardDocumentKeysNew(pgbson *uniqueShardDocument,
 }
 
 
+/*
+ * Unique indexes usually have a handful of paths with a single term each
+ * (arrays add more), so the terms of the left document are compared directly
+ * instead of building a hash table for every recheck. Returns false if the left
+ * document has too many terms, in which case the hash table is used.
+ * The matching is the same as ProcessUniqueShardDocumentKeysNew: there is a
+ * conflict if every path of the right document has a term on the left.
+ */
+static bool
+TryCheckUniqueShardConflictWithoutHash(pgbson *left, pgbson *right,
+									   int64_t *leftShardKey, bool *hasLeftShardKey,
+									   int64_t *rightShardKey, bool *hasRightShardKey,
+									   bool *uniquenessConflict)
+{
+	pgbsonelement leftTerms[UNIQUE_RECHECK_MAX_LINEAR_TERMS];
+	int32_t numLeftTerms = 0;
+
+	bson_iter_t specIter;
+	PgbsonInitIterator(left, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		const char *key = bson_iter_key(&specIter);
+		if (strcmp(key, "$shard_key_value") == 0)
+		{
+			*leftShardKey = BsonValueAsInt64(bson_iter_value(&specIter));
+			*hasLeftShardKey = true;
+			continue;
+		}
+
+		if (!BSON_ITER_HOLDS_ARRAY(&specIter))
+		{
+			continue;
+		}
+
+		uint32_t keyPathLength = bson_iter_key_len(&specIter);
+		bson_iter_t arrayIter;
+		bson_iter_recurse(&specIter, &arrayIter);
+		while (bson_iter_next(&arrayIter))
+		{
+			if (numLeftTerms == UNIQUE_RECHECK_MAX_LINEAR_TERMS)
+			{
+				return false;
+			}
+
+			leftTerms[numLeftTerms].path = key;
+			leftTerms[numLeftTerms].pathLength = keyPathLength;
+			leftTerms[numLeftTerms].bsonValue = *bson_iter_value(&arrayIter);
+			numLeftTerms++;
+		}
+	}
+
+	*uniquenessConflict = true;
+	PgbsonInitIterator(right, &specIter);
+	while (bson_iter_next(&specIter))
+	{
+		const char *key = bson_iter_key(&specIter);
+		if (strcmp(key, "$shard_key_value") == 0)
+		{
+			*rightShardKey = BsonValueAsInt64(bson_iter_value(&specIter));
+			*hasRightShardKey = true;
+			continue;
+		}
+
+		if (!BSON_ITER_HOLDS_ARRAY(&specIter) || !*uniquenessConflict)
+		{
+			continue;
+		}
+
+		uint32_t keyPathLength = bson_iter_key_len(&specIter);
+		bson_iter_t arrayIter;
+		bson_iter_recurse(&specIter, &arrayIter);
+
+		bool keyTermMatch = false;
+		while (!keyTermMatch && bson_iter_next(&arrayIter))
+		{
+			const bson_value_t *rightTerm = bson_iter_value(&arrayIter);
+			for (int32_t i = 0; i < numLeftTerms && !keyTermMatch; i++)
+			{
+				bool isComparisonValidIgnore = false;
+				keyTermMatch = leftTerms[i].pathLength == keyPathLength &&
+							   strncmp(leftTerms[i].path, key, keyPathLength) == 0 &&
+							   CompareBsonValueAndType(&leftTerms[i].bsonValue,
+													   rightTerm,
+													   &isComparisonValidIgnore) == 0;
+			}
+		}
+
+		if (!keyTermMatch)
+		{
+			/* Keep going to find the shard key value of the right document */
+			*uniquenessConflict = false;
+		}
+	}
+
+	return true;
+}
+
+
 static HTAB *
 GetUniqueShardDocumentTermsHTAB(pgbson *uniqueShardDocument)
 {
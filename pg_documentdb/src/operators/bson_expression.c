@@ -39,6 +39,7 @@
 #include "utils/version_utils.h"
 #include "collation/collation.h"
 #include "metadata/metadata_cache.h"
+#include "query/bson_dollar_operators.h"
 
 
 /* --------------------------------------------------------- */
@@ -577,7 +578,8 @@ PG_FUNCTION_INFO_V1(bson_expression_map);
 Datum
 bson_expression_get(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	/* Accumulators on the same tuple share the detoasted document */
+	pgbson *document = GetDetoastCachedDocument(PG_GETARG_DATUM(0));
 	pgbson *expression = PG_GETARG_PGBSON(1);
 	bool isNullOnEmpty = PG_GETARG_BOOL(2);
 	pgbson *variableSpec = NULL;
@@ -660,8 +662,6 @@ bson_expression_get(PG_FUNCTION_ARGS)
 		returnedBson = PgbsonWriterGetPgbson(&returnedWriter);
 	}
 
-
-	PG_FREE_IF_COPY(document, 0);
 	PG_RETURN_POINTER(returnedBson);
 }
 
@@ -1355,8 +1355,8 @@ EvaluateFieldPathAndWriteCore(bson_iter_t *document, const char *dottedPathExpre
 	const char *dotKeyStr = memchr(dottedPathExpression, '.', dottedPathExpressionLength);
 	if (dotKeyStr == NULL)
 	{
-		if (!bson_iter_find_w_len(document, dottedPathExpression,
-								  dottedPathExpressionLength))
+		if (!PgbsonIterFindWithFieldCache(document, dottedPathExpression,
+										  dottedPathExpressionLength))
 		{
 			if (isNullOnEmpty)
 			{
@@ -1375,7 +1375,7 @@ EvaluateFieldPathAndWriteCore(bson_iter_t *document, const char *dottedPathExpre
 	}
 
 	uint32_t currentFieldLength = dotKeyStr - dottedPathExpression;
-	if (!bson_iter_find_w_len(document, dottedPathExpression, currentFieldLength))
+	if (!PgbsonIterFindWithFieldCache(document, dottedPathExpression, currentFieldLength))
 	{
 		if (isNullOnEmpty)
 		{
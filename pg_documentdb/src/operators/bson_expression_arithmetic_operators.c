@@ -89,6 +89,10 @@ static void HandlePreParsedArithmeticVariableOperands(pgbson *doc, void *argumen
 													  ExpressionResult *expressionResult,
 													  ProcessArithmeticOperatorVariableOperands
 													  processOperatorFunc);
+static List * FoldLeadingConstantNumericOperands(List *argumentsList, void *state,
+												 const bson_value_t *initialValue,
+												 ProcessArithmeticOperatorVariableOperands
+												 processOperatorFunc);
 static bool ProcessDollarAdd(const bson_value_t *currentElement, void *state,
 							 bson_value_t *result);
 static bool ProcessDollarMultiply(const bson_value_t *currentElement, void *state,
@@ -886,12 +890,82 @@ ParseArithmeticOperatorVariableOperands(const bson_value_t *argument,
 	}
 	else
 	{
-		data->operator.arguments = argumentsList;
+		data->operator.arguments = FoldLeadingConstantNumericOperands(argumentsList,
+																	  state,
+																	  &data->value,
+																	  processOperatorFunc);
 		data->operator.argumentsKind = AggregationExpressionArgumentsKind_List;
 	}
 }
 
 
+/*
+ * Folds the leading constant operands of a variable operands arithmetic operator
+ * into a single constant operand when they are all int32, int64 or double, e.g.
+ * { "$add": [ 1, 2.5, "$a" ] } is evaluated as { "$add": [ 3.5, "$a" ] }.
+ * Only the leading operands are folded so that the operations happen in the same
+ * order (and with the same promotions and rounding) as they would per document:
+ * the accumulated value of the prefix combined with the initial value of the
+ * operator yields the accumulated value itself for $add (0) and $multiply (1).
+ */
+static List *
+FoldLeadingConstantNumericOperands(List *argumentsList, void *state,
+								   const bson_value_t *initialValue,
+								   ProcessArithmeticOperatorVariableOperands
+								   processOperatorFunc)
+{
+	int numConstantOperands = 0;
+	ListCell *cell;
+	foreach(cell, argumentsList)
+	{
+		AggregationExpressionData *currentData = lfirst(cell);
+		if (!IsAggregationExpressionConstant(currentData) ||
+			(currentData->value.value_type != BSON_TYPE_INT32 &&
+			 currentData->value.value_type != BSON_TYPE_INT64 &&
+			 currentData->value.value_type != BSON_TYPE_DOUBLE))
+		{
+			break;
+		}
+
+		numConstantOperands++;
+	}
+
+	if (numConstantOperands < 2)
+	{
+		return argumentsList;
+	}
+
+	bson_value_t accumulatedValue = *initialValue;
+	List *foldedArgumentsList = NIL;
+	AggregationExpressionData *foldedData = NULL;
+	foreach(cell, argumentsList)
+	{
+		AggregationExpressionData *currentData = lfirst(cell);
+		if (foreach_current_index(cell) >= numConstantOperands)
+		{
+			foldedArgumentsList = lappend(foldedArgumentsList, currentData);
+			continue;
+		}
+
+		processOperatorFunc(&currentData->value, state, &accumulatedValue);
+		if (foldedData == NULL)
+		{
+			foldedData = currentData;
+			foldedArgumentsList = lappend(foldedArgumentsList, foldedData);
+		}
+		else
+		{
+			pfree(currentData);
+		}
+	}
+
+	foldedData->value = accumulatedValue;
+	list_free(argumentsList);
+	return foldedArgumentsList;
+}
+
+
+
 /* Helper to evaluate pre-parsed expressions of operators that take variable number of operands. */
 static void
 HandlePreParsedArithmeticVariableOperands(pgbson *doc, void *arguments, void *state,
@@ -907,11 +981,20 @@ HandlePreParsedArithmeticVariableOperands(pgbson *doc, void *arguments, void *st
 	{
 		AggregationExpressionData *currentData = list_nth(argumentList, idx);
 
-		bool isNullOnEmpty = false;
-		ExpressionResult childResult = ExpressionResultCreateChild(expressionResult);
-		EvaluateAggregationExpressionData(currentData, doc, &childResult, isNullOnEmpty);
-
-		bson_value_t currentValue = childResult.value;
+		/* Constant operands don't need to go through a child expression result */
+		bson_value_t currentValue;
+		if (IsAggregationExpressionConstant(currentData))
+		{
+			currentValue = currentData->value;
+		}
+		else
+		{
+			bool isNullOnEmpty = false;
+			ExpressionResult childResult = ExpressionResultCreateChild(expressionResult);
+			EvaluateAggregationExpressionData(currentData, doc, &childResult,
+											  isNullOnEmpty);
+			currentValue = childResult.value;
+		}
 
 		bool continueEnumerating = processOperatorFunc(&currentValue, state, result);
 		if (!continueEnumerating)
@@ -38,6 +38,7 @@
 #define SIZE_OF_PARENT_OF_ARRAY_FOR_BSON 7
 
 extern bool EnableOperatorVariablesInLookup;
+extern bool EnableDollarMapDoubleKernels;
 
 /* --------------------------------------------------------- */
 /* Type declaration */
@@ -52,8 +53,17 @@ typedef struct DollarInArguments
 	AggregationExpressionData *targetValue;
 	AggregationExpressionData *searchArray;
 	const char *collationString;
+
+	/* Hash set of the elements of a large constant search array (NULL if none) */
+	HTAB *searchArrayHashSet;
 } DollarInArguments;
 
+/*
+ * Constant $in arrays with more than this many elements are hashed when the
+ * expression is parsed, so that each evaluation is a single lookup.
+ */
+#define DOLLAR_IN_HASH_SET_MIN_ELEMENTS 16
+
 /* State for a $arrayElemAt, $first or $last operator. */
 typedef struct ArrayElemAtArgumentState
 {
@@ -104,6 +114,27 @@ typedef struct DollarFirstNLastNArguments
 	AggregationExpressionData elementsToFetch;
 } DollarFirstNLastNArguments;
 
+/*
+ * The numeric operators that $map computes directly over the double elements
+ * of its input when its 'in' expression applies them to the 'as' variable.
+ */
+typedef enum DollarMapDoubleKernel
+{
+	DollarMapDoubleKernel_None = 0,
+
+	/* { $sin: "$$this" } */
+	DollarMapDoubleKernel_Sin = 1,
+
+	/* { $cos: "$$this" } */
+	DollarMapDoubleKernel_Cos = 2,
+
+	/* { $tan: "$$this" } */
+	DollarMapDoubleKernel_Tan = 3,
+
+	/* { $multiply: [ "$$this", <number> ] } */
+	DollarMapDoubleKernel_Multiply = 4,
+} DollarMapDoubleKernel;
+
 /* Struct that represents the parsed arguments to a $map expression. */
 typedef struct DollarMapArguments
 {
@@ -115,6 +146,12 @@ typedef struct DollarMapArguments
 
 	/* Optional: A name for the variable that represents each individual element of the input array. */
 	AggregationExpressionData as;
+
+	/* The operator of 'in' computed directly over the double elements, if any. */
+	DollarMapDoubleKernel doubleKernel;
+
+	/* The constant factor of the DollarMapDoubleKernel_Multiply kernel. */
+	double kernelFactor;
 } DollarMapArguments;
 
 /* Struct that represents the parsed arguments to a $sortArray expression. */
@@ -218,6 +255,11 @@ static void HandlePreParsedDollarArrayElemAtCore(pgbson *doc, void *arguments,
 												 ExpressionResult *expressionResult,
 												 char *operatorName);
 
+static HTAB * BuildDollarInHashSet(const bson_value_t *searchArray,
+								   const char *collationString);
+static bool TryProcessDollarInWithHashSet(const DollarInArguments *state,
+										  const bson_value_t *targetValue,
+										  bson_value_t *result);
 static void ProcessDollarIn(bson_value_t *targetValue, const bson_value_t *searchArray,
 							const char *collationString, bson_value_t *result);
 static void ProcessDollarSlice(void *state, bson_value_t *result);
@@ -283,6 +325,11 @@ static void ProcessDollarSortArray(bson_value_t *inputValue, SortContext *sortCo
 static void RegisterOperatorVariables(ParseAggregationExpressionContext *parentContext,
 									  ParseAggregationExpressionContext *currentContext,
 									  List *operatorVariablesList);
+static void SetDollarMapDoubleKernel(DollarMapArguments *arguments);
+static bool IsDollarMapAliasVariable(const AggregationExpressionData *data,
+									 const bson_value_t *aliasValue);
+static bool TryApplyDollarMapDoubleKernel(const DollarMapArguments *arguments,
+										  double element, bson_value_t *result);
 
 /* --------------------------------------------------------- */
 /* Parse and Handle Pre-parse functions */
@@ -500,6 +547,12 @@ ParseDollarIn(const bson_value_t *argument, AggregationExpressionData *data,
 			state->collationString = pstrdup(context->collationString);
 		}
 
+		if (IsAggregationExpressionConstant(secondArg))
+		{
+			state->searchArrayHashSet = BuildDollarInHashSet(&secondArg->value,
+															 state->collationString);
+		}
+
 		data->operator.arguments = state;
 		data->operator.argumentsKind = AggregationExpressionArgumentsKind_Palloc;
 	}
@@ -521,13 +574,19 @@ HandlePreParsedDollarIn(pgbson *doc, void *argument, ExpressionResult *expressio
 	EvaluateAggregationExpressionData(firstArg, doc, &childResult, isNullOnEmpty);
 	bson_value_t firstValue = childResult.value;
 
+	bson_value_t result;
+	if (TryProcessDollarInWithHashSet(state, &firstValue, &result))
+	{
+		ExpressionResultSetValue(expressionResult, &result);
+		return;
+	}
+
 	ExpressionResultReset(&childResult);
 
 	AggregationExpressionData *secondArg = state->searchArray;
 	EvaluateAggregationExpressionData(secondArg, doc, &childResult, isNullOnEmpty);
 	bson_value_t secondValue = childResult.value;
 
-	bson_value_t result;
 	ProcessDollarIn(&firstValue, &secondValue, state->collationString, &result);
 	ExpressionResultSetValue(expressionResult, &result);
 }
@@ -1734,6 +1793,11 @@ ParseDollarMap(const bson_value_t *argument, AggregationExpressionData *data,
 
 	ParseAggregationExpressionData(&arguments->in, &in, mapContext);
 
+	if (EnableDollarMapDoubleKernels)
+	{
+		SetDollarMapDoubleKernel(arguments);
+	}
+
 	list_free(mapVariables);
 	hash_destroy(mapContext->operatorVariables);
 	pfree(mapContext);
@@ -1805,6 +1869,17 @@ HandlePreParsedDollarMap(pgbson *doc, void *arguments,
 	{
 		const bson_value_t *currentElem = bson_iter_value(&arrayIter);
 
+		/* Double elements skip binding the variable and evaluating 'in' */
+		bson_value_t kernelResult;
+		if (mapArguments->doubleKernel != DollarMapDoubleKernel_None &&
+			currentElem->value_type == BSON_TYPE_DOUBLE &&
+			TryApplyDollarMapDoubleKernel(mapArguments, currentElem->value.v_double,
+										  &kernelResult))
+		{
+			PgbsonArrayWriterWriteValue(&arrayWriter, &kernelResult);
+			continue;
+		}
+
 		ExpressionResult elementExpression = ExpressionResultCreateChild(
 			&childExpression);
 		ExpressionResultSetConstantVariable(&childExpression, &aliasName, currentElem);
@@ -2871,6 +2946,124 @@ HandlePreParsedDollarArrayElemAtCore(pgbson *doc, void *argument,
 /* Process operator helper functions */
 /* --------------------------------------------------------- */
 
+/*
+ * Builds the hash set of the elements of a constant $in search array. Returns
+ * NULL if the array is small enough to be scanned, or if it isn't an array in
+ * which case the error is raised at evaluation time.
+ */
+static HTAB *
+BuildDollarInHashSet(const bson_value_t *searchArray, const char *collationString)
+{
+	if (searchArray->value_type != BSON_TYPE_ARRAY ||
+		BsonDocumentValueCountKeys(searchArray) <= DOLLAR_IN_HASH_SET_MIN_ELEMENTS)
+	{
+		return NULL;
+	}
+
+	bool useCollation = IsCollationApplicable(collationString);
+	int metadataSize = 0;
+	HTAB *hashSet = useCollation ?
+					CreateBsonValueWithCollationHashSet(metadataSize) :
+					CreateBsonValueHashSet();
+
+	/* The entries point into the array, which lives as long as the parsed expression */
+	bson_iter_t arrayIterator;
+	BsonValueInitIterator(searchArray, &arrayIterator);
+	while (bson_iter_next(&arrayIterator))
+	{
+		const bson_value_t *arrayValue = bson_iter_value(&arrayIterator);
+
+		bool found = false;
+		if (useCollation)
+		{
+			BsonValueHashEntry hashEntry = {
+				.bsonValue = *arrayValue,
+				.collationString = collationString
+			};
+
+			hash_search(hashSet, &hashEntry, HASH_ENTER, &found);
+		}
+		else
+		{
+			hash_search(hashSet, arrayValue, HASH_ENTER, &found);
+		}
+	}
+
+	return hashSet;
+}
+
+
+/*
+ * Evaluates $in with a single lookup in the hash set of its constant search
+ * array. Returns false if there is no hash set, or for targets that are
+ * missing, null or undefined, which keep the semantics of the scan in
+ * ProcessDollarIn.
+ *
+ * It also returns false for targets whose hash may differ from the hash of an
+ * element that compares equal to them: documents and arrays are hashed by
+ * their bytes, so { "a": 1 } and { "a": 1.0 } differ, and doubles and
+ * decimals share the hash of other numeric types only when they are 64 bit
+ * integers, so 0.5 and NumberDecimal("0.5") differ.
+ */
+static bool
+TryProcessDollarInWithHashSet(const DollarInArguments *state,
+							  const bson_value_t *targetValue, bson_value_t *result)
+{
+	if (state->searchArrayHashSet == NULL)
+	{
+		return false;
+	}
+
+	switch (targetValue->value_type)
+	{
+		case BSON_TYPE_EOD:
+		case BSON_TYPE_NULL:
+		case BSON_TYPE_UNDEFINED:
+		case BSON_TYPE_DOCUMENT:
+		case BSON_TYPE_ARRAY:
+		{
+			return false;
+		}
+
+		case BSON_TYPE_DOUBLE:
+		case BSON_TYPE_DECIMAL128:
+		{
+			bool checkFixedInteger = true;
+			if (!IsBsonValue64BitInteger(targetValue, checkFixedInteger))
+			{
+				return false;
+			}
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	bool found = false;
+	if (IsCollationApplicable(state->collationString))
+	{
+		BsonValueHashEntry hashEntry = {
+			.bsonValue = *targetValue,
+			.collationString = state->collationString
+		};
+
+		hash_search(state->searchArrayHashSet, &hashEntry, HASH_FIND, &found);
+	}
+	else
+	{
+		hash_search(state->searchArrayHashSet, targetValue, HASH_FIND, &found);
+	}
+
+	result->value_type = BSON_TYPE_BOOL;
+	result->value.v_bool = found;
+	return true;
+}
+
+
 /*
  * Process the $in operator and returns true or false if the first argument is
  * found or not in the second argument which is the array to search. */
@@ -3324,8 +3517,7 @@ ProcessDollarSortArray(bson_value_t *inputValue, SortContext *sortContext,
 		iteration++;
 	}
 
-	qsort_arg(elementsArr, nElementsInArray, sizeof(ElementWithIndex),
-			  CompareBsonValuesForSort, sortContext);
+	SortElementsWithIndex(elementsArr, nElementsInArray, sortContext);
 
 	pgbson_writer writer;
 	PgbsonWriterInit(&writer);
@@ -4434,3 +4626,138 @@ RegisterOperatorVariables(ParseAggregationExpressionContext *parentContext,
 		hash_search(currentContext->operatorVariables, &varNameView, HASH_ENTER, NULL);
 	}
 }
+
+
+/*
+ * Sets the kernel $map uses for its double elements when its 'in' expression
+ * is a trigonometric operator on the 'as' variable or a $multiply of the 'as'
+ * variable by a number, e.g. { $map: { input: "$a", in: { $sin: "$$this" } } }.
+ */
+static void
+SetDollarMapDoubleKernel(DollarMapArguments *arguments)
+{
+	const AggregationExpressionData *in = &arguments->in;
+	arguments->doubleKernel = DollarMapDoubleKernel_None;
+
+	if (in->kind != AggregationExpressionKind_Operator)
+	{
+		return;
+	}
+
+	HandlePreParsedOperatorFunc handleFunc = in->operator.handleExpressionFunc;
+	if (handleFunc == HandlePreParsedDollarSin ||
+		handleFunc == HandlePreParsedDollarCos ||
+		handleFunc == HandlePreParsedDollarTan)
+	{
+		if (!IsDollarMapAliasVariable(in->operator.arguments, &arguments->as.value))
+		{
+			return;
+		}
+
+		arguments->doubleKernel =
+			handleFunc == HandlePreParsedDollarSin ? DollarMapDoubleKernel_Sin :
+			handleFunc == HandlePreParsedDollarCos ? DollarMapDoubleKernel_Cos :
+			DollarMapDoubleKernel_Tan;
+	}
+	else if (handleFunc == HandlePreParsedDollarMultiply &&
+			 in->operator.argumentsKind == AggregationExpressionArgumentsKind_List &&
+			 list_length(in->operator.arguments) == 2)
+	{
+		List *multiplyArguments = in->operator.arguments;
+		AggregationExpressionData *first = linitial(multiplyArguments);
+		AggregationExpressionData *second = lsecond(multiplyArguments);
+		AggregationExpressionData *factor = NULL;
+		if (IsDollarMapAliasVariable(first, &arguments->as.value))
+		{
+			factor = second;
+		}
+		else if (IsDollarMapAliasVariable(second, &arguments->as.value))
+		{
+			factor = first;
+		}
+
+		if (factor == NULL || factor->kind != AggregationExpressionKind_Constant)
+		{
+			return;
+		}
+
+		/* x * c gives the same double as the operator for int32 and non NaN factors */
+		if (factor->value.value_type == BSON_TYPE_INT32)
+		{
+			arguments->kernelFactor = factor->value.value.v_int32;
+		}
+		else if (factor->value.value_type == BSON_TYPE_DOUBLE &&
+				 !isnan(factor->value.value.v_double))
+		{
+			arguments->kernelFactor = factor->value.value.v_double;
+		}
+		else
+		{
+			return;
+		}
+
+		arguments->doubleKernel = DollarMapDoubleKernel_Multiply;
+	}
+}
+
+
+/*
+ * Whether the expression is exactly the 'as' variable of the $map, e.g. "$$this".
+ */
+static bool
+IsDollarMapAliasVariable(const AggregationExpressionData *data,
+						 const bson_value_t *aliasValue)
+{
+	if (data == NULL || data->kind != AggregationExpressionKind_Variable)
+	{
+		return false;
+	}
+
+	const char *variable = data->value.value.v_utf8.str;
+	uint32_t variableLength = data->value.value.v_utf8.len;
+	return variableLength == aliasValue->value.v_utf8.len + 2 &&
+		   strncmp(variable + 2, aliasValue->value.v_utf8.str,
+				   aliasValue->value.v_utf8.len) == 0;
+}
+
+
+/*
+ * Computes the kernel of the $map over a double element. Returns false for the
+ * elements the operator errors on, which go through the evaluation of 'in' so
+ * that they fail the same way.
+ */
+static bool
+TryApplyDollarMapDoubleKernel(const DollarMapArguments *arguments, double element,
+							  bson_value_t *result)
+{
+	result->value_type = BSON_TYPE_DOUBLE;
+	switch (arguments->doubleKernel)
+	{
+		case DollarMapDoubleKernel_Sin:
+		case DollarMapDoubleKernel_Cos:
+		case DollarMapDoubleKernel_Tan:
+		{
+			if (isinf(element))
+			{
+				return false;
+			}
+
+			result->value.v_double =
+				arguments->doubleKernel == DollarMapDoubleKernel_Sin ? sin(element) :
+				arguments->doubleKernel == DollarMapDoubleKernel_Cos ? cos(element) :
+				tan(element);
+			return true;
+		}
+
+		case DollarMapDoubleKernel_Multiply:
+		{
+			result->value.v_double = element * arguments->kernelFactor;
+			return true;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
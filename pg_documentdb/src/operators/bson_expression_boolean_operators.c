@@ -40,6 +40,9 @@ static void HandlePreParsedBooleanVariableOperands(pgbson *doc, void *arguments,
 static bool ProcessBooleanOperator(const bson_value_t *currentElement,
 								   bson_value_t *result,
 								   bool isFieldPathExpression, BooleanType booleanType);
+static List * SimplifyBooleanVariableOperands(List *argumentsList,
+											  BooleanType booleanType,
+											  bool *isAbsorbed);
 
 /*
  * Parses an $or expression and sets the parsed data in the data argument.
@@ -209,9 +212,114 @@ ParseBooleanVariableOperands(const bson_value_t *argument,
 	}
 	else
 	{
-		data->operator.arguments = argumentsList;
-		data->operator.argumentsKind = AggregationExpressionArgumentsKind_List;
+		bool isAbsorbed = false;
+		argumentsList = SimplifyBooleanVariableOperands(argumentsList, booleanType,
+														&isAbsorbed);
+		if (argumentsList == NIL)
+		{
+			/* Only constants were left: the result is the absorbing value if one was found */
+			data->value.value_type = BSON_TYPE_BOOL;
+			data->value.value.v_bool = booleanType == BooleanType_And ? !isAbsorbed :
+									   isAbsorbed;
+			data->kind = AggregationExpressionKind_Constant;
+		}
+		else
+		{
+			data->operator.arguments = argumentsList;
+			data->operator.argumentsKind = AggregationExpressionArgumentsKind_List;
+		}
+	}
+}
+
+
+/*
+ * Simplifies the operands of an $and/$or that has at least one non constant operand:
+ *  - Nested operators of the same kind are flattened into the parent since
+ *    { "$and": [ a, { "$and": [ b, c ] } ] } is equivalent to { "$and": [ a, b, c ] }.
+ *  - Constant operands that don't change the result (truthy for $and and falsy for $or)
+ *    are removed.
+ *  - Operands after a constant that short circuits the evaluation (falsy for $and and
+ *    truthy for $or) are never evaluated so they are removed. The operands before it
+ *    are kept since they can still error at runtime.
+ * Returns the simplified list or NIL if only constants were left, in which case
+ * isAbsorbed is set if a short circuiting constant was found.
+ */
+static List *
+SimplifyBooleanVariableOperands(List *argumentsList, BooleanType booleanType,
+								bool *isAbsorbed)
+{
+	HandlePreParsedOperatorFunc handlerFunc = booleanType == BooleanType_And ?
+											  HandlePreParsedDollarAnd :
+											  HandlePreParsedDollarOr;
+	bool absorbingValue = booleanType == BooleanType_Or;
+
+	List *simplifiedList = NIL;
+	bool hasNonConstantOperand = false;
+	*isAbsorbed = false;
+
+	ListCell *cell;
+	foreach(cell, argumentsList)
+	{
+		AggregationExpressionData *currentData = lfirst(cell);
+
+		if (*isAbsorbed)
+		{
+			pfree(currentData);
+			continue;
+		}
+
+		if (IsAggregationExpressionConstant(currentData))
+		{
+			if (BsonValueAsBool(&currentData->value) == absorbingValue)
+			{
+				*isAbsorbed = true;
+				simplifiedList = lappend(simplifiedList, currentData);
+			}
+			else
+			{
+				pfree(currentData);
+			}
+
+			continue;
+		}
+
+		hasNonConstantOperand = true;
+		if (currentData->kind == AggregationExpressionKind_Operator &&
+			currentData->operator.handleExpressionFunc == handlerFunc &&
+			currentData->operator.argumentsKind ==
+			AggregationExpressionArgumentsKind_List)
+		{
+			/* The nested operands were already simplified when the nested operator was parsed */
+			List *nestedList = (List *) currentData->operator.arguments;
+			ListCell *nestedCell;
+			foreach(nestedCell, nestedList)
+			{
+				AggregationExpressionData *nestedData = lfirst(nestedCell);
+				if (IsAggregationExpressionConstant(nestedData))
+				{
+					*isAbsorbed = true;
+				}
+
+				simplifiedList = lappend(simplifiedList, nestedData);
+			}
+
+			list_free(nestedList);
+			pfree(currentData);
+			continue;
+		}
+
+		simplifiedList = lappend(simplifiedList, currentData);
+	}
+
+	list_free(argumentsList);
+
+	if (!hasNonConstantOperand)
+	{
+		list_free_deep(simplifiedList);
+		return NIL;
 	}
+
+	return simplifiedList;
 }
 
 
@@ -230,16 +338,30 @@ HandlePreParsedBooleanVariableOperands(pgbson *doc, void *arguments,
 	{
 		AggregationExpressionData *currentData = list_nth(argumentList, idx);
 
-		bool isNullOnEmpty = false;
-		ExpressionResult childResult = ExpressionResultCreateChild(expressionResult);
-		EvaluateAggregationExpressionData(currentData, doc, &childResult, isNullOnEmpty);
+		/* Constant operands don't need to go through a child expression result */
+		bool continueEnumerating;
+		if (IsAggregationExpressionConstant(currentData))
+		{
+			bool isFieldPathExpression = false;
+			continueEnumerating = ProcessBooleanOperator(&currentData->value, result,
+														 isFieldPathExpression,
+														 booleanType);
+		}
+		else
+		{
+			bool isNullOnEmpty = false;
+			ExpressionResult childResult = ExpressionResultCreateChild(expressionResult);
+			EvaluateAggregationExpressionData(currentData, doc, &childResult,
+											  isNullOnEmpty);
+
+			bson_value_t currentValue = childResult.value;
+			continueEnumerating = ProcessBooleanOperator(&currentValue,
+														 result,
+														 childResult.
+														 isFieldPathExpression,
+														 booleanType);
+		}
 
-		bson_value_t currentValue = childResult.value;
-		bool continueEnumerating = ProcessBooleanOperator(&currentValue,
-														  result,
-														  childResult.
-														  isFieldPathExpression,
-														  booleanType);
 		if (!continueEnumerating)
 		{
 			break;
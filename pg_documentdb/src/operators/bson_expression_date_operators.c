@@ -11,6 +11,7 @@
 #include <pgtime.h>
 #include <fmgr.h>
 #include <math.h>
+#include <common/int.h>
 #include <utils/numeric.h>
 #include <utils/datetime.h>
 #include <utils/timestamp.h>
@@ -39,6 +40,14 @@
 #define DATE_FROM_PART_START_DATE_MS -62135596800000L
 #define DATE_TRUNC_TIMESTAMP_MS 946684800000L
 #define SECONDS_IN_DAY 86400
+
+/*
+ * This represents unix ms for 9999-12-31T23:59:59.999. Dates between 0001-01-01 and this
+ * date get their parts and $dateTrunc bins computed with integer arithmetic when the
+ * timezone is a UTC offset.
+ */
+#define DATE_FAST_PATH_END_DATE_MS 253402300799999L
+#define MILLISECONDS_IN_DAY (SECONDS_IN_DAY * MILLISECONDS_IN_SECOND)
 #define CONDITIONAL_EREPORT(isOnErrorPresent, ereportCall) \
 	if (!isOnErrorPresent) { \
 		ereportCall; \
@@ -188,6 +197,27 @@ typedef struct DollarDateFromPartsBsonValue
 	bool isIsoFormat;
 } DollarDateFromPartsBsonValue;
 
+/*
+ * The parts of a date in a UTC offset timezone, computed with integer arithmetic
+ * instead of going through the postgres timestamp routines.
+ */
+typedef struct UtcOffsetDateParts
+{
+	int year;
+	int month;
+	int day;
+	int hour;
+	int minute;
+	int second;
+	int millisecond;
+
+	/* Day of the week in the 0-6 range, starting on Sunday like postgres' dow */
+	int dayOfWeek;
+
+	/* Day of the year in the 1-366 range */
+	int dayOfYear;
+} UtcOffsetDateParts;
+
 /* State for a $dateTrunc operator. */
 typedef struct DollarDateTruncArgumentState
 {
@@ -544,6 +574,19 @@ static bool GetTimezoneToApply(const bson_value_t *timezoneValue, const
 							   char *operatorName, ExtensionTimezone *timezoneToApply);
 static bool GetIsIsoRequested(bson_value_t *isoValue, bool *isIsoRequested);
 static uint32_t GetDatePartFromPgTimestamp(Datum pgTimestamp, DatePart datePart);
+static bool TryGetDatePartsForUtcOffset(int64_t dateInMs, ExtensionTimezone timezone,
+										UtcOffsetDateParts *dateParts);
+static uint32_t GetDatePartFromUtcOffsetDateParts(const UtcOffsetDateParts *dateParts,
+												  DatePart datePart);
+static inline uint32_t GetDatePartFromPartsOrPgTimestamp(const UtcOffsetDateParts *
+														 dateParts,
+														 Datum pgTimestamp,
+														 DatePart datePart);
+static bool TrySetResultValueForDateBinWithUtcOffset(int64_t dateInMs,
+													 ExtensionTimezone timezoneToApply,
+													 int64 binSize,
+													 DateTruncUnit dateTruncUnit,
+													 bson_value_t *result);
 static StringView GetDateStringWithFormat(int64_t dateInMs, ExtensionTimezone timezone,
 										  StringView format);
 static DateUnit GetDateUnitFromString(char *unit);
@@ -2099,7 +2142,19 @@ ProcessDollarDateToParts(const bson_value_t *dateValue, bool isIsoRequested,
 						 ExtensionTimezone timezoneToApply, bson_value_t *result)
 {
 	int64_t dateInMs = BsonValueAsDateTime(dateValue);
-	Datum pgTimestamp = GetPgTimestampFromEpochWithTimezone(dateInMs, timezoneToApply);
+
+	/* UTC offsets don't need a postgres timestamp to get the date parts */
+	UtcOffsetDateParts utcOffsetDateParts;
+	const UtcOffsetDateParts *dateParts = NULL;
+	Datum pgTimestamp = (Datum) 0;
+	if (TryGetDatePartsForUtcOffset(dateInMs, timezoneToApply, &utcOffsetDateParts))
+	{
+		dateParts = &utcOffsetDateParts;
+	}
+	else
+	{
+		pgTimestamp = GetPgTimestampFromEpochWithTimezone(dateInMs, timezoneToApply);
+	}
 
 	/* Get date parts and write them to the result. */
 	pgbson_writer objectWriter;
@@ -2119,27 +2174,37 @@ ProcessDollarDateToParts(const bson_value_t *dateValue, bool isIsoRequested,
 
 	if (isIsoRequested)
 	{
-		int isoWeekY = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_IsoWeekYear);
-		int isoWeek = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_IsoWeek);
-		int isoDoW = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_IsoDayOfWeek);
+		int isoWeekY = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+														 DatePart_IsoWeekYear);
+		int isoWeek = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+														DatePart_IsoWeek);
+		int isoDoW = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+													   DatePart_IsoDayOfWeek);
 		PgbsonWriterAppendInt32(&childWriter, "isoWeekYear", 11, isoWeekY);
 		PgbsonWriterAppendInt32(&childWriter, "isoWeek", 7, isoWeek);
 		PgbsonWriterAppendInt32(&childWriter, "isoDayOfWeek", 12, isoDoW);
 	}
 	else
 	{
-		int year = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_Year);
-		int month = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_Month);
-		int dom = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_DayOfMonth);
+		int year = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+													 DatePart_Year);
+		int month = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+													  DatePart_Month);
+		int dom = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+													DatePart_DayOfMonth);
 		PgbsonWriterAppendInt32(&childWriter, "year", 4, year);
 		PgbsonWriterAppendInt32(&childWriter, "month", 5, month);
 		PgbsonWriterAppendInt32(&childWriter, "day", 3, dom);
 	}
 
-	int hour = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_Hour);
-	int minute = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_Minute);
-	int second = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_Second);
-	int ms = GetDatePartFromPgTimestamp(pgTimestamp, DatePart_Millisecond);
+	int hour = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+												 DatePart_Hour);
+	int minute = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+												   DatePart_Minute);
+	int second = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+												   DatePart_Second);
+	int ms = GetDatePartFromPartsOrPgTimestamp(dateParts, pgTimestamp,
+											   DatePart_Millisecond);
 	PgbsonWriterAppendInt32(&childWriter, "hour", 4, hour);
 	PgbsonWriterAppendInt32(&childWriter, "minute", 6, minute);
 	PgbsonWriterAppendInt32(&childWriter, "second", 6, second);
@@ -2224,9 +2289,18 @@ GetDatePartResult(bson_value_t *dateValue, ExtensionTimezone timezone, DatePart
 
 
 	int64_t dateTimeInMs = BsonValueAsDateTime(dateValue);
-	Datum pgTimestamp = GetPgTimestampFromEpochWithTimezone(dateTimeInMs,
-															timezone);
-	uint32_t datePartResult = GetDatePartFromPgTimestamp(pgTimestamp, datePart);
+	uint32_t datePartResult;
+	UtcOffsetDateParts dateParts;
+	if (TryGetDatePartsForUtcOffset(dateTimeInMs, timezone, &dateParts))
+	{
+		datePartResult = GetDatePartFromUtcOffsetDateParts(&dateParts, datePart);
+	}
+	else
+	{
+		Datum pgTimestamp = GetPgTimestampFromEpochWithTimezone(dateTimeInMs,
+																timezone);
+		datePartResult = GetDatePartFromPgTimestamp(pgTimestamp, datePart);
+	}
 
 	if (datePart == DatePart_IsoWeekYear)
 	{
@@ -3006,6 +3080,147 @@ GetDatePartFromPgTimestamp(Datum pgTimestamp, DatePart datePart)
 }
 
 
+/*
+ * Computes the parts of the date in the timezone with integer arithmetic if the timezone
+ * is a UTC offset (including UTC) and the date is between years 1 and 9999, which covers
+ * virtually all the dates seen by the date operators. Returns false otherwise, in which
+ * case the caller needs to use the postgres timestamp routines.
+ */
+static bool
+TryGetDatePartsForUtcOffset(int64_t dateInMs, ExtensionTimezone timezone,
+							UtcOffsetDateParts *dateParts)
+{
+	int64_t localDateInMs;
+	if (!timezone.isUtcOffset ||
+		pg_add_s64_overflow(dateInMs, timezone.offsetInMs, &localDateInMs) ||
+		localDateInMs < DATE_FROM_PART_START_DATE_MS ||
+		localDateInMs > DATE_FAST_PATH_END_DATE_MS)
+	{
+		return false;
+	}
+
+	int64_t daysSinceEpoch = localDateInMs / MILLISECONDS_IN_DAY;
+	int64_t msInDay = localDateInMs % MILLISECONDS_IN_DAY;
+	if (msInDay < 0)
+	{
+		msInDay += MILLISECONDS_IN_DAY;
+		daysSinceEpoch--;
+	}
+
+	int julianDay = (int) daysSinceEpoch + UNIX_EPOCH_JDATE;
+	j2date(julianDay, &dateParts->year, &dateParts->month, &dateParts->day);
+	dateParts->dayOfWeek = j2day(julianDay);
+	dateParts->dayOfYear = julianDay - date2j(dateParts->year, 1, 1) + 1;
+
+	dateParts->millisecond = msInDay % MILLISECONDS_IN_SECOND;
+	int64_t secondsInDay = msInDay / MILLISECONDS_IN_SECOND;
+	dateParts->second = secondsInDay % SECONDS_IN_MINUTE;
+	dateParts->minute = (secondsInDay / SECONDS_IN_MINUTE) % MINUTES_IN_HOUR;
+	dateParts->hour = secondsInDay / (SECONDS_IN_MINUTE * MINUTES_IN_HOUR);
+	return true;
+}
+
+
+/*
+ * Returns the requested unit part from the date parts computed by TryGetDatePartsForUtcOffset,
+ * following the same ranges as GetDatePartFromPgTimestamp.
+ */
+static uint32_t
+GetDatePartFromUtcOffsetDateParts(const UtcOffsetDateParts *dateParts, DatePart datePart)
+{
+	switch (datePart)
+	{
+		case DatePart_Hour:
+		{
+			return dateParts->hour;
+		}
+
+		case DatePart_Minute:
+		{
+			return dateParts->minute;
+		}
+
+		case DatePart_Second:
+		{
+			return dateParts->second;
+		}
+
+		case DatePart_Millisecond:
+		{
+			return dateParts->millisecond;
+		}
+
+		case DatePart_Year:
+		{
+			return dateParts->year;
+		}
+
+		case DatePart_Month:
+		{
+			return dateParts->month;
+		}
+
+		case DatePart_DayOfYear:
+		{
+			return dateParts->dayOfYear;
+		}
+
+		case DatePart_DayOfMonth:
+		{
+			return dateParts->day;
+		}
+
+		case DatePart_DayOfWeek:
+		{
+			return dateParts->dayOfWeek + 1;
+		}
+
+		case DatePart_IsoWeekYear:
+		{
+			return date2isoyear(dateParts->year, dateParts->month, dateParts->day);
+		}
+
+		case DatePart_IsoWeek:
+		{
+			return date2isoweek(dateParts->year, dateParts->month, dateParts->day);
+		}
+
+		case DatePart_IsoDayOfWeek:
+		{
+			return dateParts->dayOfWeek == 0 ? DAYS_IN_WEEK : dateParts->dayOfWeek;
+		}
+
+		case DatePart_Week:
+		{
+			/* See GetDatePartFromPgTimestamp for the non ISO week numbering */
+			return ((dateParts->dayOfYear - (dateParts->dayOfWeek + 1)) + DAYS_IN_WEEK) /
+				   DAYS_IN_WEEK;
+		}
+
+		default:
+		{
+			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+							errmsg("Invalid date part unit %d", datePart),
+							errdetail_log("Invalid date part unit %d", datePart)));
+		}
+	}
+}
+
+
+/*
+ * Returns the requested unit part from the date parts if they were computed,
+ * otherwise from the postgres timestamp.
+ */
+static inline uint32_t
+GetDatePartFromPartsOrPgTimestamp(const UtcOffsetDateParts *dateParts, Datum pgTimestamp,
+								  DatePart datePart)
+{
+	return dateParts != NULL ?
+		   GetDatePartFromUtcOffsetDateParts(dateParts, datePart) :
+		   GetDatePartFromPgTimestamp(pgTimestamp, datePart);
+}
+
+
 /*
  * New Method Implementation for aggrgegation operators
  */
@@ -4358,6 +4573,87 @@ SetResultValueForDateTruncFromDateBin(Datum pgTimestamp, Datum referenceTimestam
 }
 
 
+/*
+ * Computes the same bin as date_bin for the millisecond to hour units with integer
+ * arithmetic when the timezone is a UTC offset. For a UTC offset the reference
+ * timestamp is a fixed number of ms, so the bin start is the reference plus the
+ * number of whole bins since the reference (rounded towards -infinity).
+ * Returns false if the date or the result is not within years 1 and 9999 or the bin
+ * size overflows, in which case the caller uses date_bin.
+ */
+static bool
+TrySetResultValueForDateBinWithUtcOffset(int64_t dateInMs,
+										 ExtensionTimezone timezoneToApply,
+										 int64 binSize, DateTruncUnit dateTruncUnit,
+										 bson_value_t *result)
+{
+	if (!timezoneToApply.isUtcOffset || binSize <= 0 ||
+		dateInMs < DATE_FROM_PART_START_DATE_MS || dateInMs > DATE_FAST_PATH_END_DATE_MS)
+	{
+		return false;
+	}
+
+	int64_t unitInMs;
+	switch (dateTruncUnit)
+	{
+		case DateTruncUnit_Millisecond:
+		{
+			unitInMs = 1;
+			break;
+		}
+
+		case DateTruncUnit_Second:
+		{
+			unitInMs = MILLISECONDS_IN_SECOND;
+			break;
+		}
+
+		case DateTruncUnit_Minute:
+		{
+			unitInMs = MILLISECONDS_IN_SECOND * SECONDS_IN_MINUTE;
+			break;
+		}
+
+		case DateTruncUnit_Hour:
+		{
+			unitInMs = MILLISECONDS_IN_SECOND * SECONDS_IN_MINUTE * MINUTES_IN_HOUR;
+			break;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+
+	int64_t binSizeInMs;
+	if (pg_mul_s64_overflow(binSize, unitInMs, &binSizeInMs))
+	{
+		return false;
+	}
+
+	/* Same reference as GetPgTimestampFromEpochWithoutTimezone for a UTC offset */
+	int64_t referenceInMs = DATE_TRUNC_TIMESTAMP_MS - timezoneToApply.offsetInMs;
+	int64_t elapsedMs = dateInMs - referenceInMs;
+	int64_t elapsedBins = elapsedMs / binSizeInMs;
+	if (elapsedMs % binSizeInMs < 0)
+	{
+		elapsedBins--;
+	}
+
+	int64_t binStartInMs;
+	if (pg_mul_s64_overflow(elapsedBins, binSizeInMs, &binStartInMs) ||
+		pg_add_s64_overflow(binStartInMs, referenceInMs, &binStartInMs) ||
+		binStartInMs < DATE_FROM_PART_START_DATE_MS)
+	{
+		return false;
+	}
+
+	result->value.v_datetime = binStartInMs;
+	return true;
+}
+
+
 /* This function calculates the date bin for unit type day.
  * Firstly, this calculates interval difference between start and end timestamp.
  * Converts, that difference interval to number of days.
@@ -4424,6 +4720,15 @@ SetResultValueForDollarDateTrunc(DateTruncUnit dateTruncUnit, WeekDay weekDay,
 {
 	result->value_type = BSON_TYPE_DATE_TIME;
 	int64_t dateValueInMs = BsonValueAsDateTime(date);
+	if (IsValidUnitForDateBinOid(dateTruncUnit) && resultTimezone.isUtcOffset &&
+		resultTimezone.offsetInMs == 0 &&
+		TrySetResultValueForDateBinWithUtcOffset(dateValueInMs, timezoneToApply,
+												 binSize->value.v_int64, dateTruncUnit,
+												 result))
+	{
+		return;
+	}
+
 	Datum datePgTimestamp = GetPgTimestampFromEpochWithTimezone(dateValueInMs,
 																resultTimezone);
 	if (IsValidUnitForDateBinOid(dateTruncUnit))
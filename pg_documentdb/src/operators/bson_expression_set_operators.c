@@ -86,6 +86,12 @@ typedef struct SetOperatorBsonValueHashEntry
 /* Size of the count and lastSeenArray fields in SetOperatorBsonValueHashEntry */
 #define BsonValueHashEntryExtraDataSize (2 * sizeof(int))
 
+/*
+ * Arrays with up to this many elements are compared with a linear scan in
+ * $setDifference and $setIsSubset, which is cheaper than creating a hash table.
+ */
+#define SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS 16
+
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
@@ -125,6 +131,10 @@ static void ProcessDollarSetDifference(void *state, const char *collationString,
 									   bson_value_t *result);
 static void ProcessDollarSetIsSubset(void *state, const char *collationString,
 									 bson_value_t *result);
+static int LoadSmallArrayElements(const bson_value_t *array, bson_value_t *elements);
+static bool SmallArrayContainsValue(const bson_value_t *elements, int numElements,
+									const bson_value_t *value,
+									const char *collationString);
 static void ProcessSetElement(const bson_value_t *currentValue,
 							  DollarSetOperatorState *state);
 static bool ProcessDollarAllOrAnyElementsTrue(const bson_value_t *currentValue,
@@ -883,6 +893,42 @@ ProcessDollarSetDifference(void *state, const char *collationString, bson_value_
 							BsonTypeName(context->secondArgument.value_type))));
 	}
 
+	bson_iter_t arrayIterator;
+	pgbson_writer writer;
+	pgbson_array_writer arrayWriter;
+
+	bson_value_t secondElements[SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS];
+	bson_value_t firstElements[SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS];
+	int numSecondElements = LoadSmallArrayElements(&context->secondArgument,
+												   secondElements);
+	int numFirstElements = numSecondElements < 0 ? -1 :
+						   LoadSmallArrayElements(&context->firstArgument,
+												  firstElements);
+	if (numFirstElements >= 0)
+	{
+		PgbsonWriterInit(&writer);
+		PgbsonWriterStartArray(&writer, "", 0, &arrayWriter);
+
+		/* The elements written so far are tracked to skip duplicates of the first array */
+		bson_value_t writtenElements[SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS];
+		int numWrittenElements = 0;
+		for (int i = 0; i < numFirstElements; i++)
+		{
+			if (!SmallArrayContainsValue(secondElements, numSecondElements,
+										 &firstElements[i], collationString) &&
+				!SmallArrayContainsValue(writtenElements, numWrittenElements,
+										 &firstElements[i], collationString))
+			{
+				PgbsonArrayWriterWriteValue(&arrayWriter, &firstElements[i]);
+				writtenElements[numWrittenElements++] = firstElements[i];
+			}
+		}
+
+		PgbsonWriterEndArray(&writer, &arrayWriter);
+		*result = PgbsonArrayWriterGetValue(&arrayWriter);
+		return;
+	}
+
 	DollarSetOperatorState setDifferenceState =
 	{
 		.arrayCount = 0,
@@ -894,12 +940,9 @@ ProcessDollarSetDifference(void *state, const char *collationString, bson_value_
 
 	ProcessSetElement(&context->secondArgument, &setDifferenceState);
 
-	bson_iter_t arrayIterator;
 	BsonValueInitIterator(&context->firstArgument, &arrayIterator);
 
-	pgbson_writer writer;
 	PgbsonWriterInit(&writer);
-	pgbson_array_writer arrayWriter;
 	PgbsonWriterStartArray(&writer, "", 0, &arrayWriter);
 
 	while (bson_iter_next(&arrayIterator))
@@ -956,6 +999,27 @@ ProcessDollarSetIsSubset(void *state, const char *collationString, bson_value_t
 							BsonTypeNameExtended(context->secondArgument.value_type))));
 	}
 
+	bson_iter_t arrayIterator;
+	bool isSubset = true;
+
+	bson_value_t secondElements[SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS];
+	int numSecondElements = LoadSmallArrayElements(&context->secondArgument,
+												   secondElements);
+	if (numSecondElements >= 0)
+	{
+		BsonValueInitIterator(&context->firstArgument, &arrayIterator);
+		while (isSubset && bson_iter_next(&arrayIterator))
+		{
+			isSubset = SmallArrayContainsValue(secondElements, numSecondElements,
+											   bson_iter_value(&arrayIterator),
+											   collationString);
+		}
+
+		result->value_type = BSON_TYPE_BOOL;
+		result->value.v_bool = isSubset;
+		return;
+	}
+
 	DollarSetOperatorState setIsSubsetState =
 	{
 		.arrayCount = 0,
@@ -967,10 +1031,8 @@ ProcessDollarSetIsSubset(void *state, const char *collationString, bson_value_t
 
 	ProcessSetElement(&context->secondArgument, &setIsSubsetState);
 
-	bson_iter_t arrayIterator;
 	BsonValueInitIterator(&context->firstArgument, &arrayIterator);
 
-	bool isSubset = true;
 	while (bson_iter_next(&arrayIterator))
 	{
 		const bson_value_t *arrayElement = bson_iter_value(&arrayIterator);
@@ -998,6 +1060,72 @@ ProcessDollarSetIsSubset(void *state, const char *collationString, bson_value_t
 }
 
 
+/*
+ * Copies the elements of the array to elements if it has at most
+ * SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS elements and returns how many there
+ * are. Returns -1 if the array is larger.
+ *
+ * It also returns -1 if an element may compare equal to a value with a
+ * different hash, since the hash tables then tell them apart and the scan
+ * must not: documents and arrays are hashed by their bytes, and doubles and
+ * decimals share the hash of other numeric types only when they are 64 bit
+ * integers.
+ */
+static int
+LoadSmallArrayElements(const bson_value_t *array, bson_value_t *elements)
+{
+	bson_iter_t arrayIterator;
+	BsonValueInitIterator(array, &arrayIterator);
+
+	int numElements = 0;
+	while (bson_iter_next(&arrayIterator))
+	{
+		if (numElements == SET_OPERATOR_LINEAR_SCAN_MAX_ELEMENTS)
+		{
+			return -1;
+		}
+
+		const bson_value_t *element = bson_iter_value(&arrayIterator);
+		bool checkFixedInteger = true;
+		if (element->value_type == BSON_TYPE_DOCUMENT ||
+			element->value_type == BSON_TYPE_ARRAY ||
+			((element->value_type == BSON_TYPE_DOUBLE ||
+			  element->value_type == BSON_TYPE_DECIMAL128) &&
+			 !IsBsonValue64BitInteger(element, checkFixedInteger)))
+		{
+			return -1;
+		}
+
+		elements[numElements++] = *element;
+	}
+
+	return numElements;
+}
+
+
+/*
+ * Returns whether the value equals any of the elements, using the same
+ * comparison as the set operator hash tables.
+ */
+static bool
+SmallArrayContainsValue(const bson_value_t *elements, int numElements,
+						const bson_value_t *value, const char *collationString)
+{
+	for (int i = 0; i < numElements; i++)
+	{
+		bool isComparisonValidIgnore;
+		if (CompareBsonValueAndTypeWithCollation(&elements[i], value,
+												 &isComparisonValidIgnore,
+												 collationString) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /*
  * For the currentElement which is of type BSON_TYPE_ARRAY,
  * iterate through currentElement and add all unique elements hash table
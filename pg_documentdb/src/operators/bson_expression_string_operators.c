@@ -9,6 +9,7 @@
  */
 
 #include <postgres.h>
+#include <port/pg_bitutils.h>
 
 #include "io/bson_core.h"
 #include "query/bson_compare.h"
@@ -18,6 +19,7 @@
 #include "utils/string_view.h"
 #include "utils/hashset_utils.h"
 #include "types/pcre_regex.h"
+#include "infrastructure/documentdb_regex_cache.h"
 #include "query/bson_dollar_operators.h"
 
 #define PCRE2_INDEX_UNSET (~(size_t) 0)
@@ -183,7 +185,8 @@ static void WriteOutputOfDollarRegexFindAll(bson_value_t *input, RegexData *rege
 											bson_value_t *result);
 static bool ValidateEvaluatedRegexInput(bson_value_t *input, bson_value_t *regex,
 										bson_value_t *options, RegexData *regexData,
-										const char *opName, bool enableNoAutoCapture);
+										const char *opName, bool enableNoAutoCapture,
+										bool *isRegexCached);
 static bson_value_t ConstructResultForDollarRegex(RegexData *regexData,
 												  bson_value_t *input,
 												  size_t *outputVector, int outputLen,
@@ -211,6 +214,8 @@ static inline StringView * AllocateStringViewFromBsonValueString(const
 static inline bool BsonValueStringHasNullCharcter(const bson_value_t *element);
 static inline bool IsUtf8ContinuationByte(const char *utf8Str);
 static inline size_t Utf8CodePointCount(const bson_value_t *utf8Str);
+static int FindSubstringInBytes(const char *string, int startIndex, int endIndex,
+								const char *substring, int substringLength);
 static inline void ConvertToLower(char *str, uint32_t len);
 static inline int GetSubstringPosition(char *str, char *substr, int strLen,
 									   int subStrLen, int lastPost);
@@ -675,8 +680,9 @@ HandlePreParsedDollarRegexFind(pgbson *doc, void *arguments,
 		regexData.pcreData = regexArgs->pcreData;
 	}
 
+	bool isRegexCached = false;
 	if (!ValidateEvaluatedRegexInput(&input, &regex, &options, &regexData, "$regexFind",
-									 enableNoAutoCapture))
+									 enableNoAutoCapture, &isRegexCached))
 	{
 		ExpressionResultSetValue(expressionResult, &resultValue);
 		return;
@@ -697,7 +703,7 @@ HandlePreParsedDollarRegexFind(pgbson *doc, void *arguments,
 												&ignorePreviousMatchCP);
 	ExpressionResultSetValue(expressionResult, &resultValue);
 
-	if (!isRegexAlreadyCompiled)
+	if (!isRegexAlreadyCompiled && !isRegexCached)
 	{
 		FreePcreData(regexData.pcreData);
 	}
@@ -769,8 +775,9 @@ HandlePreParsedDollarRegexMatch(pgbson *doc, void *arguments,
 		regexData.pcreData = regexArgs->pcreData;
 	}
 
+	bool isRegexCached = false;
 	if (!ValidateEvaluatedRegexInput(&input, &regex, &options, &regexData, "$regexMatch",
-									 enableNoAutoCapture))
+									 enableNoAutoCapture, &isRegexCached))
 	{
 		bson_value_t falseValue = {
 			.value_type = BSON_TYPE_BOOL,
@@ -785,7 +792,7 @@ HandlePreParsedDollarRegexMatch(pgbson *doc, void *arguments,
 	resultValue.value.v_bool = CompareRegexTextMatch(&input, &regexData);
 	ExpressionResultSetValue(expressionResult, &resultValue);
 
-	if (!isRegexAlreadyCompiled)
+	if (!isRegexAlreadyCompiled && !isRegexCached)
 	{
 		FreePcreData(regexData.pcreData);
 	}
@@ -856,8 +863,10 @@ HandlePreParsedDollarRegexFindAll(pgbson *doc, void *arguments,
 		regexData.pcreData = regexArgs->pcreData;
 	}
 
+	bool isRegexCached = false;
 	if (!ValidateEvaluatedRegexInput(&input, &regex, &options, &regexData,
-									 "$regexFindAll", enableNoAutoCapture))
+									 "$regexFindAll", enableNoAutoCapture,
+									 &isRegexCached))
 	{
 		InitBsonValueAsEmptyArray(&result);
 		ExpressionResultSetValue(expressionResult, &result);
@@ -867,7 +876,7 @@ HandlePreParsedDollarRegexFindAll(pgbson *doc, void *arguments,
 	WriteOutputOfDollarRegexFindAll(&input, &regexData, &result);
 	ExpressionResultSetValue(expressionResult, &result);
 
-	if (!isRegexAlreadyCompiled)
+	if (!isRegexAlreadyCompiled && !isRegexCached)
 	{
 		FreePcreData(regexData.pcreData);
 	}
@@ -1532,7 +1541,7 @@ ParseDollarRegexInput(const bson_value_t *operatorValue,
 	{
 		if (!ValidateEvaluatedRegexInput(&regexArgs->input.value, &regexArgs->regex.value,
 										 &regexArgs->options.value, regexData, opName,
-										 enableNoAutoCapture))
+										 enableNoAutoCapture, NULL))
 		{
 			*isNullOrUndefinedInput = true;
 		}
@@ -1549,7 +1558,7 @@ ParseDollarRegexInput(const bson_value_t *operatorValue,
 	{
 		if (ValidateEvaluatedRegexInput(&regexArgs->input.value, &regexArgs->regex.value,
 										&regexArgs->options.value, regexData, opName,
-										enableNoAutoCapture))
+										enableNoAutoCapture, NULL))
 		{
 			regexArgs->pcreData = regexData->pcreData;
 		}
@@ -1912,22 +1921,10 @@ ProcessDollarIndexOfBytes(void *state, bson_value_t *result)
 		return;
 	}
 
-	char *string = context->firstArgument.value.v_utf8.str;
-	string += startIndex;
-	int charToCmp = context->secondArgument.value.v_utf8.len;
-
-	while (startIndex + charToCmp <= endIndex)
-	{
-		if (memcmp(string, context->secondArgument.value.v_utf8.str,
-				   charToCmp) == 0)
-		{
-			result->value.v_int32 = startIndex;
-			return;
-		}
-
-		string++;
-		startIndex++;
-	}
+	result->value.v_int32 = FindSubstringInBytes(
+		context->firstArgument.value.v_utf8.str, startIndex, endIndex,
+		context->secondArgument.value.v_utf8.str,
+		context->secondArgument.value.v_utf8.len);
 }
 
 
@@ -1951,9 +1948,10 @@ ProcessDollarIndexOfCP(void *state, bson_value_t *result)
 	ProcessDollarIndexOfCore(context, isIndexOfBytesOp, &startIndex,
 							 &endIndex);
 
+	int cpCount = Utf8CodePointCount(&context->firstArgument);
 	if (endIndex == -1)
 	{
-		endIndex = Utf8CodePointCount(&context->firstArgument);
+		endIndex = cpCount;
 	}
 
 	if (startIndex > endIndex)
@@ -1961,6 +1959,17 @@ ProcessDollarIndexOfCP(void *state, bson_value_t *result)
 		return;
 	}
 
+	/* In an ASCII string every byte is a code point, so the indexes are byte offsets */
+	if ((uint32_t) cpCount == context->firstArgument.value.v_utf8.len)
+	{
+		result->value.v_int32 = FindSubstringInBytes(
+			context->firstArgument.value.v_utf8.str, startIndex,
+			Min(endIndex, cpCount),
+			context->secondArgument.value.v_utf8.str,
+			context->secondArgument.value.v_utf8.len);
+		return;
+	}
+
 	char *string = context->firstArgument.value.v_utf8.str;
 	int currCP = 0;
 
@@ -2372,14 +2381,67 @@ static inline size_t
 Utf8CodePointCount(const bson_value_t *utf8Str)
 {
 	char *str = utf8Str->value.v_utf8.str;
-	size_t codePointCount = 0;
-	for (uint32_t currByte = 0; currByte < utf8Str->value.v_utf8.len; currByte++)
+	uint32_t len = utf8Str->value.v_utf8.len;
+	uint32_t currByte = 0;
+	size_t continuationByteCount = 0;
+
+	/*
+	 * Count the continuation bytes (10xxxxxx) 8 bytes at a time: a byte is one
+	 * if its high bit is set and the bit below it (shifted into the high bit
+	 * position) is not.
+	 */
+	for (; currByte + sizeof(uint64) <= len; currByte += sizeof(uint64))
 	{
-		/* Increment the codePointCount if the current byte is not a UTF-8 continuation byte. */
-		codePointCount += !IsUtf8ContinuationByte(str++);
+		uint64 chunk;
+		memcpy(&chunk, str + currByte, sizeof(uint64));
+		uint64 continuationBytes = chunk & ~(chunk << 1) & UINT64CONST(0x8080808080808080);
+		continuationByteCount += pg_popcount64(continuationBytes);
 	}
 
-	return codePointCount;
+	for (; currByte < len; currByte++)
+	{
+		continuationByteCount += IsUtf8ContinuationByte(str + currByte);
+	}
+
+	return len - continuationByteCount;
+}
+
+
+/*
+ * Returns the byte offset of the first occurrence of the substring that
+ * starts at or after startIndex and ends at or before endIndex, or -1 if
+ * there is none.
+ */
+static int
+FindSubstringInBytes(const char *string, int startIndex, int endIndex,
+					 const char *substring, int substringLength)
+{
+	if (substringLength == 0)
+	{
+		return startIndex <= endIndex ? startIndex : -1;
+	}
+
+	/* Jump between the occurrences of the first byte of the substring */
+	int lastStartIndex = endIndex - substringLength;
+	while (startIndex <= lastStartIndex)
+	{
+		const char *candidate = memchr(string + startIndex, substring[0],
+									   lastStartIndex - startIndex + 1);
+		if (candidate == NULL)
+		{
+			return -1;
+		}
+
+		startIndex = candidate - string;
+		if (memcmp(candidate, substring, substringLength) == 0)
+		{
+			return startIndex;
+		}
+
+		startIndex++;
+	}
+
+	return -1;
 }
 
 
@@ -2591,6 +2653,14 @@ ProcessDollarSubstrCP(void *state, bson_value_t *result)
 		return;
 	}
 
+	/* In an ASCII string every byte is a code point */
+	if (cpCount == result->value.v_utf8.len)
+	{
+		result->value.v_utf8.str += offset;
+		result->value.v_utf8.len = Min(length, remainingCPCount);
+		return;
+	}
+
 	while (offset > 0)
 	{
 		if (!IsUtf8ContinuationByte(result->value.v_utf8.str++))
@@ -2778,11 +2848,14 @@ ParseDollarReplaceAll(const bson_value_t *argument, AggregationExpressionData *d
  * The function fills the RegexData as well and returns `true` if the input argument is not null, otherwise `false`.
  * If "regexData->pcreData" is not NULL, the function assumes the regex and options are constant and already validated and compiled, we just validate the input and bail.
  * If function allocate memory for `regexArgs->pcreData` caller needs to free it.
+ * If isRegexCached is provided, the regex is compiled through the backend regex cache
+ * and isRegexCached is set when the returned `regexArgs->pcreData` is owned by the cache.
  */
 static bool
 ValidateEvaluatedRegexInput(bson_value_t *input, bson_value_t *regex,
 							bson_value_t *options, RegexData *regexData,
-							const char *opName, bool enableNoAutoCapture)
+							const char *opName, bool enableNoAutoCapture,
+							bool *isRegexCached)
 {
 	/* regexData->pcreData is not NULL, the function assumes the regex and options are constant and already validated and compiled */
 	if (regexData->pcreData != NULL)
@@ -2929,10 +3002,23 @@ ValidateEvaluatedRegexInput(bson_value_t *input, bson_value_t *regex,
 		char regexInvalidErrorMessage[40] = { 0 };
 		Assert(strlen(opName) <= 20);
 		sprintf(regexInvalidErrorMessage, "Invalid Regex in %s", opName);
-		regexData->pcreData = RegexCompileForAggregation(regexData->regex,
-														 regexData->options,
-														 enableNoAutoCapture,
-														 regexInvalidErrorMessage);
+
+		if (isRegexCached != NULL)
+		{
+			regexData->pcreData = GetCachedRegexForAggregation(regexData->regex,
+															   regexData->options,
+															   enableNoAutoCapture,
+															   regexInvalidErrorMessage);
+			*isRegexCached = regexData->pcreData != NULL;
+		}
+
+		if (regexData->pcreData == NULL)
+		{
+			regexData->pcreData = RegexCompileForAggregation(regexData->regex,
+															 regexData->options,
+															 enableNoAutoCapture,
+															 regexInvalidErrorMessage);
+		}
 	}
 
 	return validInput;
@@ -36,6 +36,11 @@ typedef struct ConvertToTypeArguments
 	AggregationExpressionData *formatData;
 	AggregationExpressionData *onNullData;
 	AggregationExpressionData *onErrorData;
+
+	/* Whether 'to' is constant and not null, its type and subtype are then resolved at parse time */
+	bool isToTypeResolved;
+	bson_type_t toType;
+	bson_subtype_t toSubtype;
 } ConvertToTypeArguments;
 
 
@@ -77,6 +82,7 @@ static void HandlePreParsedTypeOperatorOneOperand(pgbson *doc, void *arguments,
 												  ProcessToTypeOperator
 												  processOperatorFunc);
 
+static bool IsConversionInfallible(bson_type_t sourceType, bson_type_t toType);
 static void ApplyDollarConvert(List *arguments,
 							   const AggregationExpressionData *onErrorData,
 							   bson_value_t *result, bool *hasError);
@@ -600,6 +606,13 @@ ParseDollarConvert(const bson_value_t *argument, AggregationExpressionData *data
 		{
 			ValidateBinDataSubType(toSubtype);
 		}
+
+		if (!IsExpressionResultNullOrUndefined(&arguments->toData->value))
+		{
+			arguments->isToTypeResolved = true;
+			arguments->toType = toType;
+			arguments->toSubtype = toSubtype;
+		}
 	}
 
 	arguments->inputData = palloc0(sizeof(AggregationExpressionData));
@@ -744,33 +757,42 @@ HandlePreParsedDollarConvert(pgbson *doc, void *arguments,
 	}
 
 	bson_value_t toValue = { 0 };
-	childResult = ExpressionResultCreateChild(expressionResult);
-	EvaluateAggregationExpressionData(toData, doc, &childResult, false);
-	toValue = childResult.value;
-	ExpressionResultReset(&childResult);
-
-
 	bson_subtype_t toSubtype = BSON_SUBTYPE_BINARY;
-	if (toValue.value_type == BSON_TYPE_DOCUMENT)
+	bson_type_t toType = BSON_TYPE_EOD;
+	if (args->isToTypeResolved)
 	{
-		bson_value_t originalToValue = toValue;
-		GetToTypeAndSubTypeForConvert(&originalToValue, &toValue,
-									  &toSubtype);
+		/* A constant 'to' was validated when parsing, only its value is used below */
+		toValue = toData->value;
+		toType = args->toType;
+		toSubtype = args->toSubtype;
 	}
+	else
+	{
+		childResult = ExpressionResultCreateChild(expressionResult);
+		EvaluateAggregationExpressionData(toData, doc, &childResult, false);
+		toValue = childResult.value;
+		ExpressionResultReset(&childResult);
 
-	bson_type_t toType = BSON_TYPE_EOD;
-	ValidateAndGetConvertToType(&toValue, &toType);
+		if (toValue.value_type == BSON_TYPE_DOCUMENT)
+		{
+			bson_value_t originalToValue = toValue;
+			GetToTypeAndSubTypeForConvert(&originalToValue, &toValue,
+										  &toSubtype);
+		}
 
-	if (toType == BSON_TYPE_BINARY)
-	{
-		ValidateBinDataSubType(toSubtype);
+		ValidateAndGetConvertToType(&toValue, &toType);
 
-		if (!IsExpressionResultNullOrUndefined(&formatValue))
+		if (toType == BSON_TYPE_BINARY)
 		{
-			ValidateConvertToTypeFormat(formatValue);
+			ValidateBinDataSubType(toSubtype);
 		}
 	}
 
+	if (toType == BSON_TYPE_BINARY && !IsExpressionResultNullOrUndefined(&formatValue))
+	{
+		ValidateConvertToTypeFormat(formatValue);
+	}
+
 	bson_value_t inputValue = { 0 };
 	childResult = ExpressionResultCreateChild(expressionResult);
 	EvaluateAggregationExpressionData(inputData, doc, &childResult, false);
@@ -1982,6 +2004,16 @@ static void
 ApplyDollarConvert(List *arguments, const AggregationExpressionData *onErrorData,
 				   bson_value_t *result, bool *hasError)
 {
+	/* Without onError the error is rethrown, so there is nothing to catch */
+	bson_value_t *currentValue = (bson_value_t *) linitial(arguments);
+	bson_type_t *toType = (bson_type_t *) lsecond(arguments);
+	if (onErrorData == NULL ||
+		IsConversionInfallible(currentValue->value_type, *toType))
+	{
+		ProcessDollarConvert(arguments, result);
+		return;
+	}
+
 	MemoryContext savedMemoryContext = CurrentMemoryContext;
 
 	PG_TRY();
@@ -2007,6 +2039,62 @@ ApplyDollarConvert(List *arguments, const AggregationExpressionData *onErrorData
 }
 
 
+/*
+ * Whether converting a value of the source type to the target type never throws,
+ * in which case onError can't apply and the conversion needs no error handling.
+ */
+static bool
+IsConversionInfallible(bson_type_t sourceType, bson_type_t toType)
+{
+	switch (toType)
+	{
+		case BSON_TYPE_BOOL:
+		{
+			return true;
+		}
+
+		case BSON_TYPE_INT32:
+		{
+			return sourceType == BSON_TYPE_BOOL || sourceType == BSON_TYPE_INT32;
+		}
+
+		case BSON_TYPE_INT64:
+		{
+			return sourceType == BSON_TYPE_BOOL || sourceType == BSON_TYPE_INT32 ||
+				   sourceType == BSON_TYPE_INT64 || sourceType == BSON_TYPE_DATE_TIME;
+		}
+
+		case BSON_TYPE_DOUBLE:
+		{
+			return sourceType == BSON_TYPE_BOOL || sourceType == BSON_TYPE_INT32 ||
+				   sourceType == BSON_TYPE_INT64 || sourceType == BSON_TYPE_DOUBLE ||
+				   sourceType == BSON_TYPE_DATE_TIME;
+		}
+
+		case BSON_TYPE_DECIMAL128:
+		{
+			return sourceType == BSON_TYPE_BOOL || sourceType == BSON_TYPE_INT32 ||
+				   sourceType == BSON_TYPE_INT64 || sourceType == BSON_TYPE_DOUBLE ||
+				   sourceType == BSON_TYPE_DECIMAL128 ||
+				   sourceType == BSON_TYPE_DATE_TIME;
+		}
+
+		case BSON_TYPE_UTF8:
+		{
+			return sourceType == BSON_TYPE_BOOL || sourceType == BSON_TYPE_INT32 ||
+				   sourceType == BSON_TYPE_INT64 || sourceType == BSON_TYPE_DOUBLE ||
+				   sourceType == BSON_TYPE_DECIMAL128 || sourceType == BSON_TYPE_UTF8 ||
+				   sourceType == BSON_TYPE_OID;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
 /* Converts a string to an int32 and if not possible throws an exception for the $convert operator. */
 static int32_t
 ConvertStringToInt32(const bson_value_t *value)
@@ -53,6 +53,7 @@ _PG_init(void)
 	MarkGUCPrefixReserved("documentdb");
 
 	InitializeBackgroundWorkerJobAllowedCommands();
+	InitializeBackgroundWorkerJobs();
 	InitializeDocumentDBBackgroundWorker("pg_documentdb", "documentdb", "documentdb");
 
 	InstallDocumentDBApiPostgresHooks();
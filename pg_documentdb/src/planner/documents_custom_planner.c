@@ -21,7 +21,8 @@
 #include "metadata/collection.h"
 #include "planner/documents_custom_planner.h"
 
-static bool SetPointReadQualsOnIndexScan(IndexScan *indexScan, Expr *queryQuals);
+static bool SetPointReadQualsOnIndexScan(IndexScan *indexScan, Expr *queryQuals,
+										 bool *isMultiPointRead);
 static List * FormatProjections(List *targetEntries);
 
 /*
@@ -130,11 +131,32 @@ TryCreatePointReadPlan(Query *query)
 		return NULL;
 	}
 
-	if (!SetPointReadQualsOnIndexScan(indexScan, (Expr *) query->jointree->quals))
+	bool isMultiPointRead = false;
+	if (!SetPointReadQualsOnIndexScan(indexScan, (Expr *) query->jointree->quals,
+									  &isMultiPointRead))
 	{
 		return NULL;
 	}
 
+	if (isMultiPointRead)
+	{
+		/* The index scan returns every id in the $in list in index order, so
+		 * it can't serve a sort or a limit.
+		 */
+		if (query->sortClause != NIL || query->limitCount != NULL)
+		{
+			return NULL;
+		}
+
+		ScalarArrayOpExpr *idArrayExpr = lsecond(indexScan->indexqual);
+		Node *idArray = lsecond(idArrayExpr->args);
+		if (IsA(idArray, ArrayExpr))
+		{
+			indexScan->scan.plan.plan_rows = list_length(
+				((ArrayExpr *) idArray)->elements);
+		}
+	}
+
 	/* Finally, filter and set the projections if successful */
 	indexScan->scan.plan.targetlist = FormatProjections(query->targetList);
 	stmt->planTree = (Plan *) indexScan;
@@ -178,6 +200,7 @@ FormatProjections(List *targetEntries)
 static bool
 TraverseQualsAndExtract(List *quals, List **queryRuntimeClauses,
 						Expr **objectIdExp, Expr **objectIdOrigExp,
+						Expr **objectIdArrayExp, Expr **objectIdArrayOrigExp,
 						Expr **shardKeyExp, Expr **shardKeyOrigExp)
 {
 	ListCell *cell;
@@ -273,6 +296,37 @@ TraverseQualsAndExtract(List *quals, List **queryRuntimeClauses,
 				continue;
 			}
 
+			case T_ScalarArrayOpExpr:
+			{
+				/* object_id = ANY(ARRAY[...]) generated for an $in on _id */
+				ScalarArrayOpExpr *arrayOpExpr = (ScalarArrayOpExpr *) expr;
+				Expr *firstArg = linitial(arrayOpExpr->args);
+				if (*objectIdArrayExp != NULL || !arrayOpExpr->useOr ||
+					arrayOpExpr->opno != BsonEqualOperatorId() ||
+					!IsA(firstArg, Var) ||
+					((Var *) firstArg)->varattno !=
+					DOCUMENT_DATA_TABLE_OBJECT_ID_VAR_ATTR_NUMBER)
+				{
+					*queryRuntimeClauses = lappend(*queryRuntimeClauses, expr);
+					continue;
+				}
+
+				if (arrayOpExpr->opfuncid == 0)
+				{
+					/* Set the opFuncId for runtime execution */
+					arrayOpExpr->opfuncid = get_opcode(arrayOpExpr->opno);
+				}
+
+				ScalarArrayOpExpr *newArrayOpExpr = copyObject(arrayOpExpr);
+				Var *indexVar = makeVar(INDEX_VAR, 2, BsonTypeId(), -1,
+										InvalidOid, 0);
+				newArrayOpExpr->args = list_make2(indexVar,
+												  lsecond(arrayOpExpr->args));
+				*objectIdArrayExp = (Expr *) newArrayOpExpr;
+				*objectIdArrayOrigExp = (Expr *) arrayOpExpr;
+				continue;
+			}
+
 			case T_FuncExpr:
 			{
 				FuncExpr *funcExpr = (FuncExpr *) expr;
@@ -302,6 +356,7 @@ TraverseQualsAndExtract(List *quals, List **queryRuntimeClauses,
 				{
 					if (!TraverseQualsAndExtract(boolExpr->args, queryRuntimeClauses,
 												 objectIdExp, objectIdOrigExp,
+												 objectIdArrayExp, objectIdArrayOrigExp,
 												 shardKeyExp, shardKeyOrigExp))
 					{
 						return false;
@@ -329,26 +384,45 @@ TraverseQualsAndExtract(List *quals, List **queryRuntimeClauses,
 
 /*
  * Scan quals and ensure that there's a point read in there.
+ * An _id equality is preferred, otherwise an _id = ANY(...) from an $in is
+ * pushed to the index as a multi point read (btree sorts and deduplicates
+ * the array keys and probes each of them).
  * returns false if it couldn't form a point read plan.
  */
 static bool
-SetPointReadQualsOnIndexScan(IndexScan *indexScan, Expr *queryQuals)
+SetPointReadQualsOnIndexScan(IndexScan *indexScan, Expr *queryQuals,
+							 bool *isMultiPointRead)
 {
 	List *runtimeClauses = NIL;
 	List *quals = make_ands_implicit(queryQuals);
 
 	Expr *objectIdExpr = NULL;
 	Expr *objectIdOriginalExpr = NULL;
+	Expr *objectIdArrayExpr = NULL;
+	Expr *objectIdArrayOriginalExpr = NULL;
 	Expr *shardKeyExpr = NULL;
 	Expr *shardKeyOriginalExpr = NULL;
 
 	if (!TraverseQualsAndExtract(quals, &runtimeClauses, &objectIdExpr,
-								 &objectIdOriginalExpr, &shardKeyExpr,
+								 &objectIdOriginalExpr, &objectIdArrayExpr,
+								 &objectIdArrayOriginalExpr, &shardKeyExpr,
 								 &shardKeyOriginalExpr))
 	{
 		return false;
 	}
 
+	*isMultiPointRead = false;
+	if (objectIdExpr != NULL && objectIdArrayOriginalExpr != NULL)
+	{
+		runtimeClauses = lappend(runtimeClauses, objectIdArrayOriginalExpr);
+	}
+	else if (objectIdArrayExpr != NULL)
+	{
+		objectIdExpr = objectIdArrayExpr;
+		objectIdOriginalExpr = objectIdArrayOriginalExpr;
+		*isMultiPointRead = true;
+	}
+
 	/* Not a point read */
 	if (objectIdExpr == NULL || shardKeyExpr == NULL)
 	{
@@ -494,6 +494,9 @@ ExtensionRelPathlistHookCoreNew(PlannerInfo *root, RelOptInfo *rel, Index rti,
 		ForceExcludeNonIndexPaths(root, rel, rti, rte);
 	}
 
+	/* Add the paths of partial indexes implied by the range filters of the query */
+	ConsiderPartialIndexesImpliedByQuals(root, rel);
+
 	/*
 	 * Before determining anything further, detect any force pushdown scenarios by walking
 	 * the restriction paths.
@@ -10,7 +10,9 @@
 
 #include <postgres.h>
 #include <miscadmin.h>
+#include <access/detoast.h>
 #include <utils/array.h>
+#include <utils/memutils.h>
 #include <utils/builtins.h>
 #include <math.h>
 
@@ -29,6 +31,7 @@
 #include "collation/collation.h"
 #include "utils/version_utils.h"
 #include "aggregation/bson_query.h"
+#include "utils/command_activity.h"
 
 /*
  * Custom bson_orderBy options to allow specific types when sorting.
@@ -130,6 +133,20 @@ typedef struct TraverseElementValidateState
 	const char *collationString;
 } TraverseElementValidateState;
 
+/*
+ * The filter of a comparison operator ($eq, $gt, ...) parsed once per call
+ * site when it is a constant.
+ */
+typedef struct CachedComparisonFilter
+{
+	/* Copy of the filter the element points into */
+	pgbson *filter;
+
+	pgbsonelement filterElement;
+
+	const char *collationString;
+} CachedComparisonFilter;
+
 /* Comparison state for the $in operator */
 typedef struct TraverseInValidateState
 {
@@ -278,12 +295,62 @@ typedef struct
 
 	/* Whether or not the sort is on a reverse sort */
 	bool isReverse;
+
+	/* The ICU sort key of a string element for the collation (if precomputed) */
+	const uint8_t *sortKey;
+	uint32_t sortKeyLength;
 } BsonSortInput;
 
 
+/*
+ * The last document the query operators detoasted from external storage.
+ * A filter with several predicates (e.g. { "a": 1, "b": { "$gt": 2 } })
+ * is evaluated as one operator call per predicate on the same tuple, each of
+ * which would otherwise fetch and decompress the same toasted document.
+ * The entry is keyed on the toast pointer, which uniquely identifies the
+ * value within a transaction, and is released at the end of the transaction.
+ */
+typedef struct QueryDocumentDetoastCache
+{
+	/* The toast relation and value of the cached document */
+	Oid toastRelationId;
+	Oid toastValueId;
+
+	/* The detoasted document (allocated in the cache memory context) */
+	pgbson *document;
+} QueryDocumentDetoastCache;
+
+
 typedef bool (*IsQueryFilterNullFunc)(const TraverseValidateState *state);
 extern bool EnableCollation;
+extern bool EnableCollationSortKeyOrderBy;
 extern bool EnableNowSystemVariable;
+extern bool EnableQueryDocumentDetoastCache;
+extern bool EnableQueryDocumentSliceDetoast;
+extern bool EnableCachedComparisonFilters;
+
+static QueryDocumentDetoastCache DetoastCache = { 0 };
+static MemoryContext DetoastCacheContext = NULL;
+
+/* The last document the query operators were evaluated against */
+static Pointer LastExaminedDocument = NULL;
+
+/*
+ * Gets the document argument of a query operator, sharing the detoasted
+ * document across the operators evaluated on the same tuple. The filter of
+ * the operator ({ <path>: <value> }) is the argument following the document.
+ */
+#define PG_GETARG_QUERY_DOCUMENT(n) (GetQueryDocumentFromDatum(PG_GETARG_DATUM(n), \
+															   PG_GETARG_DATUM((n) + 1)))
+
+/*
+ * The sizes of the prefixes of a large toasted document that are detoasted
+ * to look for the queried field before detoasting the whole document.
+ * Only documents larger than QUERY_DOCUMENT_SLICE_MIN_DOCUMENT_SIZE are sliced.
+ */
+#define QUERY_DOCUMENT_SLICE_SIZE (8 * 1024)
+#define QUERY_DOCUMENT_SLICE_MAX_SIZE (64 * 1024)
+#define QUERY_DOCUMENT_SLICE_MIN_DOCUMENT_SIZE (256 * 1024)
 
 /* --------------------------------------------------------- */
 /* Forward declaration */
@@ -354,7 +421,26 @@ static bool CompareBsonAgainstQuery(const pgbson *element,
 									const pgbson *filter,
 									CompareMatchValueFunc compareFunc,
 									IsQueryFilterNullFunc isQueryFilterNull);
+static bool CompareBsonAgainstCachedQuery(PG_FUNCTION_ARGS, const pgbson *element,
+										  const pgbson *filter,
+										  CompareMatchValueFunc compareFunc,
+										  IsQueryFilterNullFunc isQueryFilterNull);
+static bool CompareBsonAgainstQueryElement(const pgbson *element,
+										   pgbsonelement *filterElement,
+										   const char *collationString,
+										   CompareMatchValueFunc compareFunc,
+										   IsQueryFilterNullFunc isQueryFilterNull);
+static void PopulateCachedComparisonFilter(CachedComparisonFilter *cachedFilter,
+										   const pgbson *filter);
 static bool IsExistPositiveMatch(pgbson *filter);
+static pgbson * GetQueryDocumentFromDatum(Datum documentDatum, Datum filterDatum);
+static pgbson * GetDocumentFromDetoastCache(const struct varatt_external *toastPointer);
+static pgbson * DetoastDocumentIntoCache(Datum documentDatum,
+										 const struct varatt_external *toastPointer);
+static pgbson * TryGetQueryDocumentFromSlices(struct varlena *attr, Datum filterDatum);
+static bool TryGetTopLevelFieldFromSlice(struct varlena *attr, int32 sliceSize,
+										 const StringView *fieldName,
+										 pgbson **fieldDocument);
 static pgbsonelement PopulateRegexState(PG_FUNCTION_ARGS,
 										TraverseRegexValidateState *state);
 static void PopulateRegexFromQuery(RegexData *regexState, pgbsonelement *filterElement);
@@ -617,7 +703,7 @@ PG_FUNCTION_INFO_V1(bson_value_dollar_bits_any_set);
 Datum
 bson_dollar_size(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	bson_iter_t documentIterator;
@@ -667,7 +753,7 @@ bson_value_dollar_size(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_type(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
@@ -701,7 +787,7 @@ bson_value_dollar_type(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_all(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	TraverseAllValidateState validationState = {
 		.elementState =
 		{
@@ -797,7 +883,7 @@ bson_value_dollar_all(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_elemmatch(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	bson_iter_t documentIterator;
 	TraverseElemMatchValidateState state = {
 		.traverseState = { 0 },
@@ -844,7 +930,7 @@ bson_value_dollar_elemmatch(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_bits_all_clear(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
@@ -860,7 +946,7 @@ bson_dollar_bits_all_clear(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_bits_any_clear(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
@@ -876,7 +962,7 @@ bson_dollar_bits_any_clear(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_bits_all_set(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
@@ -892,7 +978,7 @@ bson_dollar_bits_all_set(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_bits_any_set(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
@@ -978,7 +1064,7 @@ bson_value_dollar_bits_any_set(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_regex(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	bson_iter_t documentIterator;
 	TraverseRegexValidateState state = {
 		{ 0 }, { 0 }
@@ -1022,7 +1108,7 @@ bson_value_dollar_regex(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_mod(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
@@ -1057,11 +1143,12 @@ bson_value_dollar_mod(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_eq(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 	IsQueryFilterNullFunc isNullFilterEquality = IsQueryFilterNullForValue;
-	PG_RETURN_BOOL(CompareBsonAgainstQuery(document, filter, CompareEqualMatch,
-										   isNullFilterEquality));
+	PG_RETURN_BOOL(CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												 CompareEqualMatch,
+												 isNullFilterEquality));
 }
 
 
@@ -1095,12 +1182,13 @@ bson_value_dollar_eq(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_gt(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
-	PG_RETURN_BOOL(CompareBsonAgainstQuery(document, filter, CompareGreaterMatch,
-										   isNullFilterEquality));
+	PG_RETURN_BOOL(CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												 CompareGreaterMatch,
+												 isNullFilterEquality));
 }
 
 
@@ -1129,12 +1217,13 @@ bson_value_dollar_gt(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_not_gt(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *query = (pgbson *) PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
-	bool result = CompareBsonAgainstQuery(document, query, CompareGreaterMatch,
-										  isNullFilterEquality);
+	bool result = CompareBsonAgainstCachedQuery(fcinfo, document, query,
+												CompareGreaterMatch,
+												isNullFilterEquality);
 	PG_RETURN_BOOL(!result);
 }
 
@@ -1149,11 +1238,12 @@ bson_dollar_not_gt(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_gte(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 	IsQueryFilterNullFunc isNullFilterEquality = IsQueryFilterNullForValue;
-	PG_RETURN_BOOL(CompareBsonAgainstQuery(document, filter, CompareGreaterEqualMatch,
-										   isNullFilterEquality));
+	PG_RETURN_BOOL(CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												 CompareGreaterEqualMatch,
+												 isNullFilterEquality));
 }
 
 
@@ -1167,11 +1257,12 @@ bson_dollar_gte(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_not_gte(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 	IsQueryFilterNullFunc isNullFilterEquality = IsQueryFilterNullForValue;
-	bool result = CompareBsonAgainstQuery(document, filter, CompareGreaterEqualMatch,
-										  isNullFilterEquality);
+	bool result = CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												CompareGreaterEqualMatch,
+												isNullFilterEquality);
 	PG_RETURN_BOOL(!result);
 }
 
@@ -1220,7 +1311,7 @@ bson_dollar_index_hint(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_range(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 	const DollarRangeParams *cachedRangeParamsState;
 	SetCachedFunctionState(
@@ -1331,12 +1422,13 @@ bson_value_dollar_gte(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_not_lt(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
-	bool result = CompareBsonAgainstQuery(document, filter, CompareLessMatch,
-										  isNullFilterEquality);
+	bool result = CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												CompareLessMatch,
+												isNullFilterEquality);
 	PG_RETURN_BOOL(!result);
 }
 
@@ -1351,12 +1443,13 @@ bson_dollar_not_lt(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_lt(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = NULL;
-	PG_RETURN_BOOL(CompareBsonAgainstQuery(document, filter, CompareLessMatch,
-										   isNullFilterEquality));
+	PG_RETURN_BOOL(CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												 CompareLessMatch,
+												 isNullFilterEquality));
 }
 
 
@@ -1387,12 +1480,13 @@ bson_value_dollar_lt(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_lte(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = IsQueryFilterNullForValue;
-	PG_RETURN_BOOL(CompareBsonAgainstQuery(document, filter, CompareLessEqualMatch,
-										   isNullFilterEquality));
+	PG_RETURN_BOOL(CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												 CompareLessEqualMatch,
+												 isNullFilterEquality));
 }
 
 
@@ -1406,12 +1500,13 @@ bson_dollar_lte(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_not_lte(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = IsQueryFilterNullForValue;
-	bool result = CompareBsonAgainstQuery(document, filter, CompareLessEqualMatch,
-										  isNullFilterEquality);
+	bool result = CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												CompareLessEqualMatch,
+												isNullFilterEquality);
 	PG_RETURN_BOOL(!result);
 }
 
@@ -1442,7 +1537,7 @@ bson_value_dollar_lte(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_in(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	bson_iter_t documentIterator;
 	TraverseInValidateState state = { 0 };
 
@@ -1521,7 +1616,7 @@ bson_value_dollar_in(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_nin(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	bson_iter_t documentIterator;
 	TraverseInValidateState state = { 0 };
 
@@ -1578,12 +1673,13 @@ bson_value_dollar_nin(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_ne(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	IsQueryFilterNullFunc isNullFilterEquality = IsQueryFilterNullForValue;
-	PG_RETURN_BOOL(!CompareBsonAgainstQuery(document, filter, CompareEqualMatch,
-											isNullFilterEquality));
+	PG_RETURN_BOOL(!CompareBsonAgainstCachedQuery(fcinfo, document, filter,
+												  CompareEqualMatch,
+												  isNullFilterEquality));
 }
 
 
@@ -1613,7 +1709,7 @@ bson_value_dollar_ne(PG_FUNCTION_ARGS)
 Datum
 bson_dollar_exists(PG_FUNCTION_ARGS)
 {
-	pgbson *document = PG_GETARG_PGBSON(0);
+	pgbson *document = PG_GETARG_QUERY_DOCUMENT(0);
 	pgbson *filter = PG_GETARG_PGBSON(1);
 
 	bool existsPositiveMatch = IsExistPositiveMatch(filter);
@@ -1842,6 +1938,8 @@ PgbsonToBsonSortInput(pgbson *bson, BsonSortInput *sortInput)
 	sortInput->collationString = NULL;
 	sortInput->isTruncated = false;
 	sortInput->isReverse = false;
+	sortInput->sortKey = NULL;
+	sortInput->sortKeyLength = 0;
 
 	if (!bson_iter_next(&iter))
 	{
@@ -1864,11 +1962,17 @@ PgbsonToBsonSortInput(pgbson *bson, BsonSortInput *sortInput)
 		{
 			sortInput->isReverse = bson_iter_bool(&iter);
 		}
+		else if (strcmp(bson_iter_key(&iter), "k") == 0 && BSON_ITER_HOLDS_BINARY(&iter))
+		{
+			bson_subtype_t subtype;
+			bson_iter_binary(&iter, &subtype, &sortInput->sortKeyLength,
+							 &sortInput->sortKey);
+		}
 		else
 		{
 			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
 							errmsg(
-								"invalid input BSON: entry in the bson document must have key \"collation\" or \"t\" or \"r\"")));
+								"invalid input BSON: entry in the bson document must have key \"collation\" or \"t\" or \"r\" or \"k\"")));
 		}
 	}
 }
@@ -1908,7 +2012,21 @@ CompareBsonSortInputForOrderingCore(BsonSortInput *left, BsonSortInput *right)
 	/* compare the left and right values */
 	int cmp = 0;
 	bool isComparisonValid = true;
-	if (collationString != NULL)
+	if (collationString != NULL && left->sortKey != NULL && right->sortKey != NULL)
+	{
+		/*
+		 * Both are strings with precomputed sort keys for the same collation.
+		 * ICU sort keys compare with memcmp the same as the strings compare with the
+		 * collator (they are null terminated with no other null bytes).
+		 */
+		uint32_t minLength = Min(left->sortKeyLength, right->sortKeyLength);
+		cmp = memcmp(left->sortKey, right->sortKey, minLength);
+		if (cmp == 0)
+		{
+			cmp = (int) left->sortKeyLength - (int) right->sortKeyLength;
+		}
+	}
+	else if (collationString != NULL)
 	{
 		cmp = CompareBsonValueAndTypeWithCollation(&left->element.bsonValue,
 												   &right->element.bsonValue,
@@ -2684,11 +2802,270 @@ CompareModOperator(const bson_value_t *srcVal, const bson_value_t *modArrVal)
 }
 
 
+/*
+ * Releases the document cached by the query operators. This is called at
+ * the end of the transaction since toast value ids are only guaranteed
+ * to identify the same value within it.
+ */
+void
+ResetQueryDocumentDetoastCache(void)
+{
+	PgbsonFieldOffsetCacheRelease(DetoastCache.document);
+
+	DetoastCache.toastRelationId = InvalidOid;
+	DetoastCache.toastValueId = InvalidOid;
+	DetoastCache.document = NULL;
+
+	if (DetoastCacheContext != NULL)
+	{
+		MemoryContextReset(DetoastCacheContext);
+	}
+}
+
+
 /* --------------------------------------------------------- */
 /* Helpers */
 /* --------------------------------------------------------- */
 
 
+/*
+ * Detoasts the document argument of a query operator. Documents stored
+ * out of line are detoasted once and reused by subsequent operators on the
+ * same tuple. Large documents may instead be served from a prefix of the
+ * document that holds the queried field (see TryGetQueryDocumentFromSlices).
+ * Everything else goes through the regular detoast path.
+ *
+ * Note: The returned document must not be freed by the caller.
+ */
+static pgbson *
+GetQueryDocumentFromDatum(Datum documentDatum, Datum filterDatum)
+{
+	struct varlena *attr = (struct varlena *) DatumGetPointer(documentDatum);
+
+	/* The operators evaluated on the same tuple get the same datum */
+	if ((Pointer) attr != LastExaminedDocument)
+	{
+		LastExaminedDocument = (Pointer) attr;
+		ReportDocumentExamined();
+	}
+	if ((!EnableQueryDocumentDetoastCache && !EnableQueryDocumentSliceDetoast) ||
+		!VARATT_IS_EXTERNAL_ONDISK(attr))
+	{
+		return DatumGetPgBson(documentDatum);
+	}
+
+	struct varatt_external toastPointer;
+	VARATT_EXTERNAL_GET_POINTER(toastPointer, attr);
+
+	pgbson *cachedDocument = GetDocumentFromDetoastCache(&toastPointer);
+	if (cachedDocument != NULL)
+	{
+		return cachedDocument;
+	}
+
+	if (EnableQueryDocumentSliceDetoast &&
+		toastPointer.va_rawsize > QUERY_DOCUMENT_SLICE_MIN_DOCUMENT_SIZE)
+	{
+		pgbson *fieldDocument = TryGetQueryDocumentFromSlices(attr, filterDatum);
+		if (fieldDocument != NULL)
+		{
+			return fieldDocument;
+		}
+	}
+
+	if (!EnableQueryDocumentDetoastCache)
+	{
+		return DatumGetPgBson(documentDatum);
+	}
+
+	return DetoastDocumentIntoCache(documentDatum, &toastPointer);
+}
+
+
+/*
+ * Detoasts a document that several path extractions are evaluated on (e.g.
+ * the accumulators of a $group reading different fields of the same tuple)
+ * through the query document detoast cache, so that the document is only
+ * fetched and decompressed once and the lookups share its top level field
+ * index. Unlike the query operators, the whole document is always needed.
+ *
+ * Note: The returned document must not be freed by the caller.
+ */
+pgbson *
+GetDetoastCachedDocument(Datum documentDatum)
+{
+	struct varlena *attr = (struct varlena *) DatumGetPointer(documentDatum);
+	if (!EnableQueryDocumentDetoastCache || !VARATT_IS_EXTERNAL_ONDISK(attr))
+	{
+		return DatumGetPgBson(documentDatum);
+	}
+
+	struct varatt_external toastPointer;
+	VARATT_EXTERNAL_GET_POINTER(toastPointer, attr);
+
+	pgbson *cachedDocument = GetDocumentFromDetoastCache(&toastPointer);
+	if (cachedDocument != NULL)
+	{
+		return cachedDocument;
+	}
+
+	return DetoastDocumentIntoCache(documentDatum, &toastPointer);
+}
+
+
+/*
+ * Returns the cached document if it was detoasted from the given toast
+ * pointer, NULL otherwise.
+ */
+static pgbson *
+GetDocumentFromDetoastCache(const struct varatt_external *toastPointer)
+{
+	if (!EnableQueryDocumentDetoastCache ||
+		DetoastCache.document == NULL ||
+		DetoastCache.toastValueId != toastPointer->va_valueid ||
+		DetoastCache.toastRelationId != toastPointer->va_toastrelid)
+	{
+		return NULL;
+	}
+
+	PgbsonFieldOffsetCacheSetDocument(DetoastCache.document);
+	return DetoastCache.document;
+}
+
+
+/*
+ * Detoasts the document and makes it the cached document, replacing the
+ * prior one.
+ */
+static pgbson *
+DetoastDocumentIntoCache(Datum documentDatum,
+						 const struct varatt_external *toastPointer)
+{
+	if (DetoastCacheContext == NULL)
+	{
+		DetoastCacheContext = AllocSetContextCreate(TopMemoryContext,
+													"Query document detoast cache",
+													ALLOCSET_DEFAULT_SIZES);
+	}
+
+	/* Release the prior document before fetching the new one */
+	ResetQueryDocumentDetoastCache();
+
+	MemoryContext originalContext = MemoryContextSwitchTo(DetoastCacheContext);
+	pgbson *document = DatumGetPgBson(documentDatum);
+	MemoryContextSwitchTo(originalContext);
+
+	DetoastCache.toastRelationId = toastPointer->va_toastrelid;
+	DetoastCache.toastValueId = toastPointer->va_valueid;
+	DetoastCache.document = document;
+
+	/* Operators on the same tuple also share the lookups of its top level fields */
+	PgbsonFieldOffsetCacheSetDocument(document);
+	return document;
+}
+
+
+/*
+ * A query operator only looks at the top level field its filter path starts
+ * with, so for documents that are large enough the field is looked up in
+ * growing prefixes of the document (which are only partially fetched and
+ * decompressed) and a document with just that field is returned.
+ * Returns NULL if the field isn't within the prefixes (including when the
+ * field doesn't exist), in which case the whole document is needed.
+ */
+static pgbson *
+TryGetQueryDocumentFromSlices(struct varlena *attr, Datum filterDatum)
+{
+	pgbson *filter = DatumGetPgBsonPacked(filterDatum);
+	bson_iter_t filterIter;
+	PgbsonInitIterator(filter, &filterIter);
+	if (!bson_iter_next(&filterIter))
+	{
+		return NULL;
+	}
+
+	StringView filterPath = {
+		.string = bson_iter_key(&filterIter),
+		.length = bson_iter_key_len(&filterIter)
+	};
+	StringView fieldName = StringViewFindPrefix(&filterPath, '.');
+	if (fieldName.string == NULL)
+	{
+		fieldName = filterPath;
+	}
+
+	if (fieldName.length == 0)
+	{
+		return NULL;
+	}
+
+	pgbson *fieldDocument = NULL;
+	for (int32 sliceSize = QUERY_DOCUMENT_SLICE_SIZE;
+		 sliceSize <= QUERY_DOCUMENT_SLICE_MAX_SIZE; sliceSize *= 8)
+	{
+		if (TryGetTopLevelFieldFromSlice(attr, sliceSize, &fieldName, &fieldDocument))
+		{
+			return fieldDocument;
+		}
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Looks for a top level field in the first sliceSize bytes of the document.
+ * The slice is terminated as if it were a complete document so that it can be
+ * iterated, and the field is only used if it ends within the slice.
+ */
+static bool
+TryGetTopLevelFieldFromSlice(struct varlena *attr, int32 sliceSize,
+							 const StringView *fieldName, pgbson **fieldDocument)
+{
+	struct varlena *slice = detoast_attr_slice(attr, 0, sliceSize);
+	uint32_t sliceLength = VARSIZE_ANY_EXHDR(slice);
+
+	uint8_t *sliceData = palloc(sliceLength + 1);
+	memcpy(sliceData, VARDATA_ANY(slice), sliceLength);
+	sliceData[sliceLength] = 0;
+
+	uint32_t sliceDocumentLength = BSON_UINT32_TO_LE(sliceLength + 1);
+	memcpy(sliceData, &sliceDocumentLength, sizeof(uint32_t));
+	pfree(slice);
+
+	bool found = false;
+	bson_iter_t sliceIter;
+	if (sliceLength > 4 &&
+		bson_iter_init_from_data(&sliceIter, sliceData, sliceLength + 1))
+	{
+		while (bson_iter_next(&sliceIter))
+		{
+			if (sliceIter.next_off > sliceLength)
+			{
+				/* The element runs into the end of the slice */
+				break;
+			}
+
+			if (bson_iter_key_len(&sliceIter) == fieldName->length &&
+				strncmp(bson_iter_key(&sliceIter), fieldName->string,
+						fieldName->length) == 0)
+			{
+				pgbson_writer writer;
+				PgbsonWriterInit(&writer);
+				PgbsonWriterAppendValue(&writer, fieldName->string, fieldName->length,
+										bson_iter_value(&sliceIter));
+				*fieldDocument = PgbsonWriterGetPgbson(&writer);
+				found = true;
+				break;
+			}
+		}
+	}
+
+	pfree(sliceData);
+	return found;
+}
+
+
 /*
  * Helper for BsonOrderBy that accepts a options to strictly check the types of documents involved
  * in the ordering.
@@ -2747,6 +3124,28 @@ BsonOrderbyCore(pgbson *document, pgbson *filter, const char *collationString,
 	if (IsCollationApplicable(collationString))
 	{
 		PgbsonWriterAppendUtf8(&writer, "collation", 9, collationString);
+
+		/*
+		 * Strings are compared with the collator on every comparison of the sort,
+		 * precompute the sort key once per document so that the sort comparisons
+		 * are a memcmp of the keys instead.
+		 */
+		if (EnableCollationSortKeyOrderBy &&
+			state.orderByValue.value_type == BSON_TYPE_UTF8 &&
+			!IsSimpleCollation(collationString))
+		{
+			char *sortKey = GetCollationSortKey(collationString,
+												state.orderByValue.value.v_utf8.str,
+												state.orderByValue.value.v_utf8.len);
+
+			bson_value_t sortKeyValue = { 0 };
+			sortKeyValue.value_type = BSON_TYPE_BINARY;
+			sortKeyValue.value.v_binary.subtype = BSON_SUBTYPE_BINARY;
+			sortKeyValue.value.v_binary.data = (uint8_t *) sortKey;
+			sortKeyValue.value.v_binary.data_len = strlen(sortKey);
+			PgbsonWriterAppendValue(&writer, "k", 1, &sortKeyValue);
+			pfree(sortKey);
+		}
 	}
 
 	if (options == CustomOrderByOptions_SetReverseFlag)
@@ -2815,23 +3214,96 @@ CompareBsonAgainstQuery(const pgbson *element,
 						CompareMatchValueFunc compareFunc,
 						IsQueryFilterNullFunc isQueryFilterNull)
 {
-	bson_iter_t documentIterator;
 	pgbsonelement filterElement;
-	TraverseElementValidateState state = { 0 };
-	PgbsonInitIterator(element, &documentIterator);
-
+	const char *collationString = NULL;
 	if (EnableCollation)
 	{
-		state.collationString = PgbsonToSinglePgbsonElementWithCollation(filter,
-																		 &filterElement);
+		collationString = PgbsonToSinglePgbsonElementWithCollation(filter,
+																   &filterElement);
 	}
 	else
 	{
 		PgbsonToSinglePgbsonElement(filter, &filterElement);
 	}
 
-	filterElement.pathLength = 0;
-	state.filter = &filterElement;
+	return CompareBsonAgainstQueryElement(element, &filterElement, collationString,
+										  compareFunc, isQueryFilterNull);
+}
+
+
+/*
+ * Same as CompareBsonAgainstQuery but parses a constant filter once for the
+ * call site of the operator function instead of for every document.
+ */
+static bool
+CompareBsonAgainstCachedQuery(PG_FUNCTION_ARGS, const pgbson *element,
+							  const pgbson *filter, CompareMatchValueFunc compareFunc,
+							  IsQueryFilterNullFunc isQueryFilterNull)
+{
+	const CachedComparisonFilter *cachedFilter = NULL;
+	if (EnableCachedComparisonFilters)
+	{
+		SetCachedFunctionState(
+			cachedFilter,
+			CachedComparisonFilter,
+			1,
+			PopulateCachedComparisonFilter,
+			filter);
+	}
+
+	if (cachedFilter == NULL)
+	{
+		return CompareBsonAgainstQuery(element, filter, compareFunc, isQueryFilterNull);
+	}
+
+	/* The path length of the element is reset for the traversal, so it is copied */
+	pgbsonelement filterElement = cachedFilter->filterElement;
+	return CompareBsonAgainstQueryElement(element, &filterElement,
+										  cachedFilter->collationString, compareFunc,
+										  isQueryFilterNull);
+}
+
+
+/*
+ * Keeps a copy of the filter of a comparison operator along with its parsed
+ * element and collation.
+ */
+static void
+PopulateCachedComparisonFilter(CachedComparisonFilter *cachedFilter,
+							   const pgbson *filter)
+{
+	cachedFilter->filter = CopyPgbsonIntoMemoryContext(filter, CurrentMemoryContext);
+	if (EnableCollation)
+	{
+		cachedFilter->collationString = PgbsonToSinglePgbsonElementWithCollation(
+			cachedFilter->filter, &cachedFilter->filterElement);
+	}
+	else
+	{
+		PgbsonToSinglePgbsonElement(cachedFilter->filter, &cachedFilter->filterElement);
+		cachedFilter->collationString = NULL;
+	}
+}
+
+
+/*
+ * Traverses the document to the path of the parsed filter element and
+ * evaluates the comparison function against the values found.
+ */
+static bool
+CompareBsonAgainstQueryElement(const pgbson *element, pgbsonelement *filterElement,
+							   const char *collationString,
+							   CompareMatchValueFunc compareFunc,
+							   IsQueryFilterNullFunc isQueryFilterNull)
+{
+	bson_iter_t documentIterator;
+	TraverseElementValidateState state = { 0 };
+	PgbsonInitIterator(element, &documentIterator);
+
+	const char *filterPath = filterElement->path;
+	filterElement->pathLength = 0;
+	state.filter = filterElement;
+	state.collationString = collationString;
 	state.traverseState.matchFunc = compareFunc;
 	bool isFilterNull = isQueryFilterNull != NULL && isQueryFilterNull(
 		&state.traverseState);
@@ -2846,7 +3318,7 @@ CompareBsonAgainstQuery(const pgbson *element,
 		execFuncs = &CompareNullExecutionFuncs;
 	}
 
-	TraverseBson(&documentIterator, filterElement.path, &state.traverseState, execFuncs);
+	TraverseBson(&documentIterator, filterPath, &state.traverseState, execFuncs);
 	return ProcessQueryResultAndGetMatch(isQueryFilterNull, &state.traverseState);
 }
 
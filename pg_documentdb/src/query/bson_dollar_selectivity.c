@@ -12,16 +12,38 @@
 #include <utils/lsyscache.h>
 #include <nodes/pathnodes.h>
 #include <utils/selfuncs.h>
+#include <access/htup_details.h>
 #include <metadata/metadata_cache.h>
 #include <planner/mongo_query_operator.h>
 
 #include "query/bson_dollar_selectivity.h"
 #include "aggregation/bson_query_common.h"
+#include "io/bson_analyze.h"
+#include "query/bson_compare.h"
 
 extern bool EnableNewOperatorSelectivityMode;
 extern bool EnableCompositeIndexPlanner;
 extern bool LowSelectivityForLookup;
 extern bool SetSelectivityForFullScan;
+extern bool EnablePathStatisticsSelectivity;
+
+/*
+ * The statistics of a single path of a bson column, read from the
+ * STATISTIC_KIND_BSON_PATH_STATISTICS slot. The values point into the slot.
+ */
+typedef struct BsonPathStatistics
+{
+	double existsFraction;
+	double nullFraction;
+	double distinctCount;
+
+	int mostCommonCount;
+	bson_value_t *mostCommonValues;
+	double *mostCommonFrequencies;
+
+	int histogramCount;
+	bson_value_t *histogramBounds;
+} BsonPathStatistics;
 
 static bool IsDollarRangeFullScan(List *args);
 static double GetStatisticsNoStatsData(List *args, Oid selectivityOpExpr, double
@@ -29,6 +51,26 @@ static double GetStatisticsNoStatsData(List *args, Oid selectivityOpExpr, double
 
 static double GetDisableStatisticSelectivity(List *args, double
 											 defaultDisabledSelectivity);
+static BsonIndexStrategy GetSelectivityIndexStrategy(Oid selectivityOpExpr,
+													 Const *secondConst);
+static bool TryGetPathStatisticsSelectivity(PlannerInfo *planner, Oid selectivityOpExpr,
+											List *args, int varRelId,
+											double *selectivity);
+static pgbson * GetPathStatisticsDocument(PlannerInfo *planner, Node *documentExpr,
+										  int varRelId, const char *queryPath,
+										  uint32_t queryPathLength);
+static bool ComputePathStatisticsSelectivity(pgbson *statisticsDocument,
+											 BsonIndexStrategy indexStrategy,
+											 const pgbsonelement *dollarElement,
+											 double *selectivity);
+static double GetPathEqualitySelectivity(const BsonPathStatistics *pathStatistics,
+										 const bson_value_t *value);
+static double GetPathRangeSelectivity(const BsonPathStatistics *pathStatistics,
+									  const DollarRangeParams *rangeParams);
+static double GetPathHistogramFraction(const BsonPathStatistics *pathStatistics,
+									   const bson_value_t *value);
+static void ReadBsonValueArray(const bson_value_t *arrayValue, bson_value_t **values,
+							   int *count);
 
 PG_FUNCTION_INFO_V1(bson_dollar_selectivity);
 
@@ -83,6 +125,14 @@ GetDollarOperatorSelectivity(PlannerInfo *planner, Oid selectivityOpExpr,
 		return 1.0;
 	}
 
+	double pathSelectivity = 0;
+	if (EnablePathStatisticsSelectivity &&
+		TryGetPathStatisticsSelectivity(planner, selectivityOpExpr, args, varRelId,
+										&pathSelectivity))
+	{
+		return pathSelectivity;
+	}
+
 	if (!EnableNewOperatorSelectivityMode && !EnableCompositeIndexPlanner)
 	{
 		return GetDisableStatisticSelectivity(args, defaultExprSelectivity);
@@ -151,33 +201,12 @@ GetStatisticsNoStatsData(List *args, Oid selectivityOpExpr, double defaultExprSe
 	}
 
 	Const *secondConst = (Const *) secondNode;
-	BsonIndexStrategy indexStrategy = BSON_INDEX_STRATEGY_INVALID;
-	if (secondConst->consttype == BsonQueryTypeId())
-	{
-		Oid selectFuncId = get_opcode(selectivityOpExpr);
-		const MongoIndexOperatorInfo *indexOp = GetMongoIndexOperatorInfoByPostgresFuncId(
-			selectFuncId);
-		indexStrategy = indexOp->indexStrategy;
-	}
-	else
-	{
-		/* This is an index pushdown operator */
-		const MongoIndexOperatorInfo *indexOp = GetMongoIndexOperatorByPostgresOperatorId(
-			selectivityOpExpr);
-		indexStrategy = indexOp->indexStrategy;
-	}
-
+	BsonIndexStrategy indexStrategy = GetSelectivityIndexStrategy(selectivityOpExpr,
+																  secondConst);
 	if (indexStrategy == BSON_INDEX_STRATEGY_INVALID)
 	{
-		if (selectivityOpExpr == BsonRangeMatchOperatorOid())
-		{
-			indexStrategy = BSON_INDEX_STRATEGY_DOLLAR_RANGE;
-		}
-		else
-		{
-			/* Unknown - thunk to PG value */
-			return defaultExprSelectivity;
-		}
+		/* Unknown - thunk to PG value */
+		return defaultExprSelectivity;
 	}
 
 	pgbsonelement dollarElement;
@@ -288,3 +317,433 @@ GetDisableStatisticSelectivity(List *args, double defaultExprSelectivity)
 		return LowSelectivity;
 	}
 }
+
+
+/*
+ * Returns the index strategy of a bson operator whose query is the given Const.
+ */
+static BsonIndexStrategy
+GetSelectivityIndexStrategy(Oid selectivityOpExpr, Const *secondConst)
+{
+	BsonIndexStrategy indexStrategy = BSON_INDEX_STRATEGY_INVALID;
+	if (secondConst->consttype == BsonQueryTypeId())
+	{
+		Oid selectFuncId = get_opcode(selectivityOpExpr);
+		const MongoIndexOperatorInfo *indexOp = GetMongoIndexOperatorInfoByPostgresFuncId(
+			selectFuncId);
+		indexStrategy = indexOp->indexStrategy;
+	}
+	else
+	{
+		/* This is an index pushdown operator */
+		const MongoIndexOperatorInfo *indexOp = GetMongoIndexOperatorByPostgresOperatorId(
+			selectivityOpExpr);
+		indexStrategy = indexOp->indexStrategy;
+	}
+
+	if (indexStrategy == BSON_INDEX_STRATEGY_INVALID &&
+		selectivityOpExpr == BsonRangeMatchOperatorOid())
+	{
+		indexStrategy = BSON_INDEX_STRATEGY_DOLLAR_RANGE;
+	}
+
+	return indexStrategy;
+}
+
+
+/*
+ * Computes the selectivity of $eq, $in, $exists and $range using the per-path
+ * statistics that ANALYZE gathers on the document column (see bson_analyze.c
+ * in documentdb_core). Returns false if there are no statistics for the path
+ * (e.g. nested paths or statistics not gathered), in which case the default
+ * selectivity applies.
+ */
+static bool
+TryGetPathStatisticsSelectivity(PlannerInfo *planner, Oid selectivityOpExpr,
+								List *args, int varRelId, double *selectivity)
+{
+	if (list_length(args) != 2 || !IsA(lsecond(args), Const) ||
+		((Const *) lsecond(args))->constisnull)
+	{
+		return false;
+	}
+
+	Const *secondConst = (Const *) lsecond(args);
+	BsonIndexStrategy indexStrategy = GetSelectivityIndexStrategy(selectivityOpExpr,
+																  secondConst);
+	if (indexStrategy != BSON_INDEX_STRATEGY_DOLLAR_EQUAL &&
+		indexStrategy != BSON_INDEX_STRATEGY_DOLLAR_IN &&
+		indexStrategy != BSON_INDEX_STRATEGY_DOLLAR_EXISTS &&
+		indexStrategy != BSON_INDEX_STRATEGY_DOLLAR_RANGE)
+	{
+		return false;
+	}
+
+	pgbsonelement dollarElement;
+	PgbsonToSinglePgbsonElement(DatumGetPgBson(secondConst->constvalue),
+								&dollarElement);
+
+	pgbson *statisticsDocument = GetPathStatisticsDocument(planner, linitial(args),
+														   varRelId,
+														   dollarElement.path,
+														   dollarElement.pathLength);
+	if (statisticsDocument == NULL)
+	{
+		return false;
+	}
+
+	return ComputePathStatisticsSelectivity(statisticsDocument, indexStrategy,
+											&dollarElement, selectivity);
+}
+
+
+/*
+ * Returns the number of distinct values of a path from the per-path statistics
+ * of the document column. Returns false if there are no statistics for the path.
+ */
+bool
+TryGetPathDistinctValueCount(PlannerInfo *planner, Node *documentExpr, int varRelId,
+							 const char *path, double *distinctCount)
+{
+	pgbson *statisticsDocument = GetPathStatisticsDocument(planner, documentExpr,
+														   varRelId, path,
+														   strlen(path));
+	if (statisticsDocument == NULL)
+	{
+		return false;
+	}
+
+	bson_iter_t statisticsIter;
+	PgbsonInitIterator(statisticsDocument, &statisticsIter);
+	if (!bson_iter_find(&statisticsIter, BSON_PATH_STATISTICS_DISTINCT_COUNT) ||
+		!BsonValueIsNumber(bson_iter_value(&statisticsIter)))
+	{
+		return false;
+	}
+
+	*distinctCount = BsonValueAsDouble(bson_iter_value(&statisticsIter));
+	return true;
+}
+
+
+/*
+ * Returns a copy of the statistics document of the query path from the
+ * STATISTIC_KIND_BSON_PATH_STATISTICS slot of the document column, or NULL
+ * if ANALYZE did not gather statistics for it.
+ */
+static pgbson *
+GetPathStatisticsDocument(PlannerInfo *planner, Node *documentExpr, int varRelId,
+						  const char *queryPath, uint32_t queryPathLength)
+{
+	VariableStatData variableData;
+	examine_variable(planner, documentExpr, varRelId, &variableData);
+	if (!HeapTupleIsValid(variableData.statsTuple))
+	{
+		ReleaseVariableStats(variableData);
+		return NULL;
+	}
+
+	AttStatsSlot statisticsSlot;
+	pgbson *result = NULL;
+	if (get_attstatsslot(&statisticsSlot, variableData.statsTuple,
+						 STATISTIC_KIND_BSON_PATH_STATISTICS, InvalidOid,
+						 ATTSTATSSLOT_VALUES))
+	{
+		for (int i = 0; i < statisticsSlot.nvalues; i++)
+		{
+			pgbson *statisticsDocument = DatumGetPgBson(statisticsSlot.values[i]);
+			bson_iter_t statisticsIter;
+			PgbsonInitIterator(statisticsDocument, &statisticsIter);
+			if (!bson_iter_find(&statisticsIter, BSON_PATH_STATISTICS_PATH) ||
+				!BSON_ITER_HOLDS_UTF8(&statisticsIter))
+			{
+				continue;
+			}
+
+			uint32_t pathLength = 0;
+			const char *path = bson_iter_utf8(&statisticsIter, &pathLength);
+			if (pathLength == queryPathLength &&
+				strncmp(path, queryPath, pathLength) == 0)
+			{
+				result = PgbsonCloneFromPgbson(statisticsDocument);
+				break;
+			}
+		}
+
+		free_attstatsslot(&statisticsSlot);
+	}
+
+	ReleaseVariableStats(variableData);
+	return result;
+}
+
+
+/*
+ * Computes the selectivity of the operator from the statistics document of
+ * its path.
+ */
+static bool
+ComputePathStatisticsSelectivity(pgbson *statisticsDocument,
+								 BsonIndexStrategy indexStrategy,
+								 const pgbsonelement *dollarElement,
+								 double *selectivity)
+{
+	BsonPathStatistics pathStatistics = { 0 };
+	bson_value_t *frequencies = NULL;
+	int frequencyCount = 0;
+
+	bson_iter_t statisticsIter;
+	PgbsonInitIterator(statisticsDocument, &statisticsIter);
+	while (bson_iter_next(&statisticsIter))
+	{
+		const char *key = bson_iter_key(&statisticsIter);
+		const bson_value_t *value = bson_iter_value(&statisticsIter);
+		if (strcmp(key, BSON_PATH_STATISTICS_EXISTS_FRACTION) == 0)
+		{
+			pathStatistics.existsFraction = BsonValueAsDouble(value);
+		}
+		else if (strcmp(key, BSON_PATH_STATISTICS_NULL_FRACTION) == 0)
+		{
+			pathStatistics.nullFraction = BsonValueAsDouble(value);
+		}
+		else if (strcmp(key, BSON_PATH_STATISTICS_DISTINCT_COUNT) == 0)
+		{
+			pathStatistics.distinctCount = BsonValueAsDouble(value);
+		}
+		else if (strcmp(key, BSON_PATH_STATISTICS_MCV) == 0)
+		{
+			ReadBsonValueArray(value, &pathStatistics.mostCommonValues,
+							   &pathStatistics.mostCommonCount);
+		}
+		else if (strcmp(key, BSON_PATH_STATISTICS_MCV_FREQUENCIES) == 0)
+		{
+			ReadBsonValueArray(value, &frequencies, &frequencyCount);
+		}
+		else if (strcmp(key, BSON_PATH_STATISTICS_HISTOGRAM) == 0)
+		{
+			ReadBsonValueArray(value, &pathStatistics.histogramBounds,
+							   &pathStatistics.histogramCount);
+		}
+	}
+
+	if (frequencyCount != pathStatistics.mostCommonCount)
+	{
+		return false;
+	}
+
+	pathStatistics.mostCommonFrequencies = palloc(Max(frequencyCount, 1) *
+												  sizeof(double));
+	for (int i = 0; i < frequencyCount; i++)
+	{
+		pathStatistics.mostCommonFrequencies[i] = BsonValueAsDouble(&frequencies[i]);
+	}
+
+	double pathSelectivity;
+	switch (indexStrategy)
+	{
+		case BSON_INDEX_STRATEGY_DOLLAR_EQUAL:
+		{
+			pathSelectivity = GetPathEqualitySelectivity(&pathStatistics,
+														 &dollarElement->bsonValue);
+			break;
+		}
+
+		case BSON_INDEX_STRATEGY_DOLLAR_IN:
+		{
+			if (dollarElement->bsonValue.value_type != BSON_TYPE_ARRAY)
+			{
+				return false;
+			}
+
+			/* The $in values are disjoint, so their selectivities add up */
+			pathSelectivity = 0;
+			bson_iter_t inIter;
+			BsonValueInitIterator(&dollarElement->bsonValue, &inIter);
+			while (bson_iter_next(&inIter))
+			{
+				const bson_value_t *inValue = bson_iter_value(&inIter);
+				if (inValue->value_type == BSON_TYPE_REGEX)
+				{
+					return false;
+				}
+
+				pathSelectivity += GetPathEqualitySelectivity(&pathStatistics, inValue);
+			}
+
+			break;
+		}
+
+		case BSON_INDEX_STRATEGY_DOLLAR_EXISTS:
+		{
+			int32_t value = BsonValueAsInt32(&dollarElement->bsonValue);
+			pathSelectivity = value > 0 ? pathStatistics.existsFraction :
+							  1.0 - pathStatistics.existsFraction;
+			break;
+		}
+
+		case BSON_INDEX_STRATEGY_DOLLAR_RANGE:
+		{
+			DollarRangeParams rangeParams = { 0 };
+			InitializeQueryDollarRange(&dollarElement->bsonValue, &rangeParams);
+			if (rangeParams.isFullScan || rangeParams.isElemMatch)
+			{
+				return false;
+			}
+
+			pathSelectivity = GetPathRangeSelectivity(&pathStatistics, &rangeParams);
+			break;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+
+	/* Never estimate 0 rows, since the statistics come from a sample */
+	*selectivity = Max(Min(pathSelectivity, 1.0), 0.0001);
+	return true;
+}
+
+
+/*
+ * Selectivity of an equality on the path. Null also matches documents
+ * that don't have the path.
+ */
+static double
+GetPathEqualitySelectivity(const BsonPathStatistics *pathStatistics,
+						   const bson_value_t *value)
+{
+	if (value->value_type == BSON_TYPE_NULL)
+	{
+		return 1.0 - pathStatistics->existsFraction + pathStatistics->nullFraction;
+	}
+
+	double mostCommonFraction = 0;
+	for (int i = 0; i < pathStatistics->mostCommonCount; i++)
+	{
+		if (BsonValueEquals(&pathStatistics->mostCommonValues[i], value))
+		{
+			return Min(pathStatistics->mostCommonFrequencies[i],
+					   pathStatistics->existsFraction);
+		}
+
+		mostCommonFraction += pathStatistics->mostCommonFrequencies[i];
+	}
+
+	/* Otherwise the value is one of the remaining distinct values */
+	double remainingFraction = pathStatistics->existsFraction -
+							   pathStatistics->nullFraction - mostCommonFraction;
+	double remainingDistinct = pathStatistics->distinctCount -
+							   pathStatistics->mostCommonCount;
+	return Max(remainingFraction, 0) / Max(remainingDistinct, 1);
+}
+
+
+/*
+ * Selectivity of a $range on the path: the most common values in the range
+ * plus the fraction of the histogram between the bounds.
+ */
+static double
+GetPathRangeSelectivity(const BsonPathStatistics *pathStatistics,
+						const DollarRangeParams *rangeParams)
+{
+	bool hasMin = rangeParams->minValue.value_type != BSON_TYPE_EOD;
+	bool hasMax = rangeParams->maxValue.value_type != BSON_TYPE_EOD;
+
+	double selectivity = 0;
+	double mostCommonFraction = 0;
+	for (int i = 0; i < pathStatistics->mostCommonCount; i++)
+	{
+		bool isComparisonValid = false;
+		const bson_value_t *value = &pathStatistics->mostCommonValues[i];
+		mostCommonFraction += pathStatistics->mostCommonFrequencies[i];
+
+		int minCompare = hasMin ? CompareBsonValueAndType(value,
+														  &rangeParams->minValue,
+														  &isComparisonValid) : 1;
+		int maxCompare = hasMax ? CompareBsonValueAndType(value,
+														  &rangeParams->maxValue,
+														  &isComparisonValid) : -1;
+		if ((minCompare > 0 || (minCompare == 0 && rangeParams->isMinInclusive)) &&
+			(maxCompare < 0 || (maxCompare == 0 && rangeParams->isMaxInclusive)))
+		{
+			selectivity += pathStatistics->mostCommonFrequencies[i];
+		}
+	}
+
+	double remainingFraction = pathStatistics->existsFraction -
+							   pathStatistics->nullFraction - mostCommonFraction;
+	if (remainingFraction > 0 && pathStatistics->histogramCount > 1)
+	{
+		double lowerFraction = hasMin ?
+							   GetPathHistogramFraction(pathStatistics,
+														&rangeParams->minValue) : 0;
+		double upperFraction = hasMax ?
+							   GetPathHistogramFraction(pathStatistics,
+														&rangeParams->maxValue) : 1;
+		selectivity += remainingFraction * Max(upperFraction - lowerFraction, 0);
+	}
+
+	return Min(selectivity, pathStatistics->existsFraction);
+}
+
+
+/*
+ * Returns the fraction of the histogram values that sort before the value,
+ * presuming the value is in the middle of the bucket it falls in.
+ */
+static double
+GetPathHistogramFraction(const BsonPathStatistics *pathStatistics,
+						 const bson_value_t *value)
+{
+	int boundCount = pathStatistics->histogramCount;
+	int boundsBefore = 0;
+	while (boundsBefore < boundCount)
+	{
+		bool isComparisonValid = false;
+		if (CompareBsonValueAndType(&pathStatistics->histogramBounds[boundsBefore],
+									value, &isComparisonValid) > 0)
+		{
+			break;
+		}
+
+		boundsBefore++;
+	}
+
+	if (boundsBefore == 0)
+	{
+		return 0;
+	}
+	else if (boundsBefore == boundCount)
+	{
+		return 1;
+	}
+
+	return (boundsBefore - 0.5) / (boundCount - 1);
+}
+
+
+/*
+ * Reads the elements of a bson array into a palloc'd array of values.
+ */
+static void
+ReadBsonValueArray(const bson_value_t *arrayValue, bson_value_t **values, int *count)
+{
+	*count = 0;
+	*values = NULL;
+	if (arrayValue->value_type != BSON_TYPE_ARRAY)
+	{
+		return;
+	}
+
+	int capacity = BsonDocumentValueCountKeys(arrayValue);
+	*values = palloc(Max(capacity, 1) * sizeof(bson_value_t));
+
+	bson_iter_t arrayIter;
+	BsonValueInitIterator(arrayValue, &arrayIter);
+	while (bson_iter_next(&arrayIter) && *count < capacity)
+	{
+		(*values)[(*count)++] = *bson_iter_value(&arrayIter);
+	}
+}
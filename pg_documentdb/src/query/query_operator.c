@@ -59,6 +59,8 @@
 #include "utils/version_utils.h"
 #include "collation/collation.h"
 #include "jsonschema/bson_json_schema_tree.h"
+#include "operators/bson_expr_eval.h"
+#include "utils/fmgr_utils.h"
 
 
 /*
@@ -107,12 +109,16 @@ typedef struct IdFilterWalkerContext
 
 	/* Whether or not the _id filter is an equality (point read) */
 	bool isPointReadQuery;
+
+	/* Whether or not the _id filter is an $in (multi point read) */
+	bool isMultiPointReadQuery;
 } IdFilterWalkerContext;
 
 extern bool EnableCollation;
 extern bool EnableLetAndCollationForQueryMatch;
 extern bool EnableVariablesSupportForWriteCommands;
 extern bool EnableIdIndexPushdown;
+extern bool EnableCompiledQueryMatch;
 
 /* --------------------------------------------------------- */
 /* Forward declaration */
@@ -235,10 +241,25 @@ PG_FUNCTION_INFO_V1(bson_query_match);
 PG_FUNCTION_INFO_V1(bson_true_match);
 PG_FUNCTION_INFO_V1(query_match_support);
 
+/*
+ * The filter of a bson_query_match call compiled into an expression over
+ * the document, cached across the documents of a call site when the
+ * filter is a constant.
+ */
+typedef struct CompiledQueryMatchState
+{
+	ExprEvalState *evalState;
+} CompiledQueryMatchState;
+
+static void PopulateCompiledQueryMatchState(CompiledQueryMatchState *state,
+											pgbson *query);
+
 
 /*
  * bson_query_match is a lazy, inefficient implementation of the @@
  * operator and bson_query_match, used only when we cannot replace it in the planner hook.
+ * With documentdb.enableCompiledQueryMatch the filter is instead compiled once per call
+ * site and evaluated against each document.
  */
 Datum
 bson_query_match(PG_FUNCTION_ARGS)
@@ -251,6 +272,35 @@ bson_query_match(PG_FUNCTION_ARGS)
 
 	ereport(NOTICE, (errmsg("using bson_query_match implementation")));
 
+	if (EnableCompiledQueryMatch && PG_NARGS() == 2)
+	{
+		/*
+		 * Compile the filter once per call site so that the operators keep
+		 * their parsed operands (regexes, $in sets) across documents.
+		 */
+		CompiledQueryMatchState *compiledState = NULL;
+		SetCachedFunctionState(compiledState, CompiledQueryMatchState, 1,
+							   PopulateCompiledQueryMatchState, query);
+
+		CompiledQueryMatchState localState = { 0 };
+		if (compiledState == NULL)
+		{
+			PopulateCompiledQueryMatchState(&localState, query);
+			compiledState = &localState;
+		}
+
+		bson_value_t documentValue = ConvertPgbsonToBsonValue(document);
+		bool matched = EvalBooleanExpressionAgainstBson(compiledState->evalState,
+														&documentValue);
+
+		if (compiledState == &localState)
+		{
+			FreeExprEvalState(localState.evalState, CurrentMemoryContext);
+		}
+
+		PG_RETURN_BOOL(matched);
+	}
+
 	ReplaceBsonQueryOperatorsContext context;
 	memset(&context, 0, sizeof(context));
 
@@ -322,6 +372,21 @@ bson_query_match(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * Compiles the filter of bson_query_match into an expression evaluated
+ * against the documents.
+ */
+static void
+PopulateCompiledQueryMatchState(CompiledQueryMatchState *state, pgbson *query)
+{
+	bson_value_t queryValue = ConvertPgbsonToBsonValue(query);
+	bool hasOperatorRestrictions = false;
+	state->evalState = GetExpressionEvalStateForBsonInput(&queryValue,
+														  CurrentMemoryContext,
+														  hasOperatorRestrictions);
+}
+
+
 /*
  * bson_true_match is a dummy placeholder function used to hold
  * a pointer to the parameterized value in the planner hook for the @@
@@ -1056,10 +1121,12 @@ ExpandBsonQueryOperator(OpExpr *queryOpExpr, Node *queryNode,
 				 * push the Id filter to primary key index if the type needs to be collation aware (e.g., _id contains UTF8 )*/
 				bool isCollationAware;
 				bool isPointRead;
+				bool isMultiPointRead;
 				Expr *idFilter = CreateIdFilterForQuery(quals,
 														collectionVarno,
 														&isCollationAware,
-														&isPointRead);
+														&isPointRead,
+														&isMultiPointRead);
 
 				/* include _id filter in quals */
 				if (idFilter != NULL &&
@@ -3444,6 +3511,7 @@ CheckAndAddIdFilter(List *opArgs, IdFilterWalkerContext *context,
 					inOperator->args = list_make2(documentIdVar, arrayExpr);
 
 					context->idQuals = lappend(context->idQuals, inOperator);
+					context->isMultiPointReadQuery = true;
 				}
 
 				return;
@@ -3533,7 +3601,8 @@ Expr *
 CreateIdFilterForQuery(List *existingQuals,
 					   Index collectionVarno,
 					   bool *isCollationAware,
-					   bool *isPointRead)
+					   bool *isPointRead,
+					   bool *isMultiPointRead)
 {
 	IdFilterWalkerContext walkerContext = { 0 };
 	walkerContext.idQuals = NIL;
@@ -3543,6 +3612,7 @@ CreateIdFilterForQuery(List *existingQuals,
 
 	*isCollationAware = walkerContext.isCollationAware;
 	*isPointRead = walkerContext.isPointReadQuery;
+	*isMultiPointRead = walkerContext.isMultiPointReadQuery;
 	if (walkerContext.idQuals == NIL)
 	{
 		return NULL;
@@ -15,6 +15,8 @@
 #include <lib/stringinfo.h>
 #include <utils/builtins.h>
 #include <nodes/makefuncs.h>
+#include <utils/array.h>
+#include <utils/lsyscache.h>
 
 #include "io/bson_core.h"
 #include "api_hooks.h"
@@ -37,6 +39,7 @@ extern bool RecreateRetryTableOnSharding;
 extern char *ApiGucPrefixV2;
 extern bool EnablePrepareUnique;
 extern bool ForceUpdateIndexInline;
+extern bool EnableShardKeyInArrayFilter;
 
 /* Metadata about shard keys - this is unchanged through
  * iterating though the query for the shard key.
@@ -133,6 +136,9 @@ static bool ComputeShardKeyFieldValuesHash(ShardKeyFieldValues *shardKeyValues,
 										   int64 *shardKeyHash,
 										   bool *isShardKeyValueCollationAware);
 static void ValidateShardKey(const pgbson *shardKeyDoc);
+static Expr * CreateShardKeyValueArrayFilter(int collectionVarno, Datum *hashDatums,
+											 int hashCount);
+static int CompareShardKeyHashes(const void *left, const void *right);
 static void FindShardKeyFieldValuesForQuery(bson_iter_t *queryDocument,
 											const ShardKeyMetadata *shardKeyMetadata,
 											ShardKeyFieldValues *shardKeyValues);
@@ -634,6 +640,44 @@ CreateShardKeyValueFilter(int collectionVarno, Const *valueConst)
 }
 
 
+/*
+ * CreateShardKeyValueArrayFilter creates a filter of the form
+ * shard_key_value = ANY(ARRAY[<hash>, ...]) for the given varno, which the
+ * distributed planner prunes to the shards owning the hashes.
+ */
+static Expr *
+CreateShardKeyValueArrayFilter(int collectionVarno, Datum *hashDatums, int hashCount)
+{
+	AttrNumber shardKeyAttNum = DOCUMENT_DATA_TABLE_SHARD_KEY_VALUE_VAR_ATTR_NUMBER;
+	Var *shardKeyValueVar = makeVar(collectionVarno, shardKeyAttNum, INT8OID, -1,
+									InvalidOid, 0);
+
+	ArrayType *hashArray = construct_array(hashDatums, hashCount, INT8OID, 8,
+										   FLOAT8PASSBYVAL, TYPALIGN_DOUBLE);
+	Const *hashArrayConst = makeConst(INT8ARRAYOID, -1, InvalidOid, -1,
+									  PointerGetDatum(hashArray), false, false);
+
+	ScalarArrayOpExpr *arrayFilter = makeNode(ScalarArrayOpExpr);
+	arrayFilter->opno = BigintEqualOperatorId();
+	arrayFilter->opfuncid = get_opcode(arrayFilter->opno);
+	arrayFilter->useOr = true;
+	arrayFilter->inputcollid = InvalidOid;
+	arrayFilter->args = list_make2(shardKeyValueVar, hashArrayConst);
+	arrayFilter->location = -1;
+
+	return (Expr *) arrayFilter;
+}
+
+
+static int
+CompareShardKeyHashes(const void *left, const void *right)
+{
+	int64 leftHash = DatumGetInt64(*(const Datum *) left);
+	int64 rightHash = DatumGetInt64(*(const Datum *) right);
+	return leftHash < rightHash ? -1 : (leftHash > rightHash ? 1 : 0);
+}
+
+
 /*
  * ComputeShardKeyHashForQueryValue returns whether the given query filters all
  * shard key fields by a specific value and computes the hash of the values.
@@ -958,6 +1002,14 @@ ConsiderShardKeyFiltersForInClauses(const ShardKeyMetadata *shardKeyMetadata,
 	List *shardKeyValueExprs = NIL;
 	ShardKeyFieldValues currentValues;
 	InitShardKeyFieldValues(shardKeyMetadata, &currentValues);
+
+	/*
+	 * With the array filter, the distinct hashes are collected into a single
+	 * shard_key_value = ANY(...) filter instead of an OR of equalities.
+	 */
+	Datum *hashDatums = EnableShardKeyInArrayFilter ?
+						palloc(totalShardKeys * sizeof(Datum)) : NULL;
+	int hashCount = 0;
 	for (int i = 0; i < totalShardKeys; i++)
 	{
 		int indexToUse = i;
@@ -969,6 +1021,20 @@ ConsiderShardKeyFiltersForInClauses(const ShardKeyMetadata *shardKeyMetadata,
 			indexToUse = indexToUse / shardKeyValue[j].valueCount;
 		}
 
+		if (hashDatums != NULL)
+		{
+			int64_t shardKeyHash;
+			if (!ComputeShardKeyFieldValuesHash(&currentValues, shardKeyMetadata,
+												&shardKeyHash,
+												isShardKeyValueCollationAware))
+			{
+				continue;
+			}
+
+			hashDatums[hashCount++] = Int64GetDatum(shardKeyHash);
+			continue;
+		}
+
 		Expr *shardKeyFilter = CreateShardKeyFilterCore(shardKeyMetadata, &currentValues,
 														isShardKeyValueCollationAware,
 														collectionVarno);
@@ -978,6 +1044,41 @@ ConsiderShardKeyFiltersForInClauses(const ShardKeyMetadata *shardKeyMetadata,
 		}
 	}
 
+	if (hashDatums != NULL && hashCount > 1)
+	{
+		/* different values in the $in frequently share a hash (e.g. 1 and 1.0) */
+		qsort(hashDatums, hashCount, sizeof(Datum), CompareShardKeyHashes);
+
+		int numUnique = 1;
+		for (int i = 1; i < hashCount; i++)
+		{
+			if (DatumGetInt64(hashDatums[i]) != DatumGetInt64(hashDatums[numUnique - 1]))
+			{
+				hashDatums[numUnique++] = hashDatums[i];
+			}
+		}
+
+		hashCount = numUnique;
+	}
+
+	if (hashDatums != NULL)
+	{
+		if (hashCount == 1)
+		{
+			Const *shardKeyValueConst = makeConst(INT8OID, -1, InvalidOid, 8,
+												  hashDatums[0], false, true);
+			shardKeyValueExprs = list_make1(CreateShardKeyValueFilter(collectionVarno,
+																	  shardKeyValueConst));
+		}
+		else if (hashCount > 1)
+		{
+			shardKeyValueExprs = list_make1(CreateShardKeyValueArrayFilter(
+												collectionVarno, hashDatums, hashCount));
+		}
+
+		pfree(hashDatums);
+	}
+
 
 	for (int i = 0; i < shardKeyMetadata->fieldCount; i++)
 	{
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+#
+# Runs a fixed corpus of aggregation pipelines over the sample-data datasets at
+# several scale factors and records, for each pipeline and scale factor, the
+# median execution time and a fingerprint of the plan generated for it.
+#
+# When a baseline of an earlier run is given, pipelines whose plan fingerprint
+# changed or whose execution time regressed beyond the tolerance are reported
+# and the script exits with a failure.
+#
+# Usage: aggregation_bench.py [options] <sample-data dir> <pipelines file>
+
+import argparse
+import hashlib
+import json
+import pathlib
+import re
+import statistics
+import subprocess
+import sys
+
+sys.path.insert(0, str(pathlib.Path(__file__).resolve().parents[4] /
+                       'pg_documentdb_core' / 'src' / 'test' / 'bench'))
+
+from sample_data_to_json import extract_collection_batches, to_json  # noqa: E402
+
+INSERT_BATCH_SIZE = 1000
+
+# Catalog ids and scale factors differ between runs, so they are masked before
+# fingerprinting the plans.
+CATALOG_ID_PATTERN = re.compile(r'(documents|retry|documents_rum_index)_\d+')
+DATABASE_PATTERN = re.compile(r'agg_bench_sf\d+')
+
+
+def run_psql(psql, sql):
+    result = subprocess.run([psql, '-X', '-q', '-A', '-t', '-v', 'ON_ERROR_STOP=1'],
+                            input=sql, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit(result.stderr)
+    return result.stdout.strip()
+
+
+def load_collections(sample_data_dir):
+    collections = {}
+    for script in sorted(pathlib.Path(sample_data_dir).glob('*.js')):
+        for collection, batch in extract_collection_batches(script.read_text()):
+            collections.setdefault(collection, []).extend(to_json(batch))
+    return collections
+
+
+def rename_references(value, ids, suffix):
+    """Suffixes every string that is the _id of a sample document, so that the
+    references between the collections stay within each copy of the data."""
+    if isinstance(value, dict):
+        return {key: rename_references(field, ids, suffix) for key, field in value.items()}
+    if isinstance(value, list):
+        return [rename_references(element, ids, suffix) for element in value]
+    if isinstance(value, str) and value in ids:
+        return value + suffix
+    return value
+
+
+def load_database(psql, database, collections, copies):
+    ids = {document['_id'] for documents in collections.values() for document in documents}
+
+    commands = ["SELECT documentdb_api.drop_database('%s');" % database]
+    for collection, documents in collections.items():
+        scaled = []
+        for copy in range(copies):
+            suffix = '' if copy == 0 else '_%d' % copy
+            scaled.extend(rename_references(document, ids, suffix) for document in documents)
+
+        for start in range(0, len(scaled), INSERT_BATCH_SIZE):
+            command = json.dumps({'insert': collection,
+                                  'documents': scaled[start:start + INSERT_BATCH_SIZE]})
+            commands.append("SELECT documentdb_api.insert('%s', $cmd$%s$cmd$::documentdb_core.bson);" %
+                            (database, command))
+
+    commands.append("SELECT FORMAT('ANALYZE documentdb_data.documents_%%s', collection_id) "
+                    "FROM documentdb_api_catalog.collections WHERE database_name = '%s' \\gexec" %
+                    database)
+    run_psql(psql, '\n'.join(commands) + '\n')
+
+
+def explain(psql, database, command, options):
+    sql = ("EXPLAIN (%s, FORMAT JSON) SELECT document FROM "
+           "documentdb_api_catalog.bson_aggregation_pipeline('%s', $cmd$%s$cmd$::documentdb_core.bson);" %
+           (options, database, json.dumps(command)))
+    return json.loads(run_psql(psql, sql))[0]
+
+
+def plan_shape(plan):
+    shape = plan['Node Type']
+    children = [plan_shape(child) for child in plan.get('Plans', [])]
+    return '%s(%s)' % (shape, ', '.join(children)) if children else shape
+
+
+def plan_fingerprint(plan):
+    normalized = CATALOG_ID_PATTERN.sub(r'\1_N', json.dumps(plan, sort_keys=True))
+    normalized = DATABASE_PATTERN.sub('agg_bench_sfN', normalized)
+    return hashlib.sha256(normalized.encode()).hexdigest()[:16]
+
+
+def run_pipeline(psql, database, pipeline, iterations):
+    command = {'aggregate': pipeline['collection'], 'pipeline': pipeline['pipeline'], 'cursor': {}}
+
+    plan = explain(psql, database, command, 'COSTS OFF, VERBOSE ON')['Plan']
+    times = [explain(psql, database, command, 'ANALYZE ON, TIMING OFF')['Execution Time']
+             for _ in range(iterations)]
+
+    return {'executionTimeMillis': round(statistics.median(times), 3),
+            'planFingerprint': plan_fingerprint(plan),
+            'planShape': plan_shape(plan)}
+
+
+def find_regressions(results, baseline, tolerance):
+    regressions = []
+    for key, result in sorted(results.items()):
+        prior = baseline.get(key)
+        if prior is None:
+            continue
+
+        if result['planFingerprint'] != prior['planFingerprint']:
+            regressions.append('%s: plan changed from %s to %s' %
+                               (key, prior['planShape'], result['planShape']))
+
+        allowed = prior['executionTimeMillis'] * (1 + tolerance / 100.0)
+        if result['executionTimeMillis'] > allowed:
+            regressions.append('%s: execution time %.3f ms is above the baseline of %.3f ms' %
+                               (key, result['executionTimeMillis'], prior['executionTimeMillis']))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('sample_data_dir')
+    parser.add_argument('pipelines')
+    parser.add_argument('--scale-factors', default='1,10,100')
+    parser.add_argument('--copies-per-scale', type=int, default=100,
+                        help='copies of the sample data loaded per unit of scale factor')
+    parser.add_argument('--iterations', type=int, default=5)
+    parser.add_argument('--baseline', help='results of an earlier run to compare against')
+    parser.add_argument('--tolerance', type=float, default=20.0,
+                        help='allowed execution time regression in percent')
+    parser.add_argument('--output', default='results.json')
+    parser.add_argument('--psql', default='psql')
+    args = parser.parse_args()
+
+    collections = load_collections(args.sample_data_dir)
+    pipelines = json.loads(pathlib.Path(args.pipelines).read_text())
+
+    results = {}
+    for scale_factor in [int(factor) for factor in args.scale_factors.split(',')]:
+        database = 'agg_bench_sf%d' % scale_factor
+        load_database(args.psql, database, collections, scale_factor * args.copies_per_scale)
+
+        for pipeline in pipelines:
+            result = run_pipeline(args.psql, database, pipeline, args.iterations)
+            key = '%s/sf%d' % (pipeline['name'], scale_factor)
+            results[key] = result
+            print('%-40s %10.3f ms  %s  %s' % (key, result['executionTimeMillis'],
+                                                result['planFingerprint'], result['planShape']))
+
+        run_psql(args.psql, "SELECT documentdb_api.drop_database('%s');" % database)
+
+    pathlib.Path(args.output).write_text(json.dumps(results, indent=4, sort_keys=True) + '\n')
+
+    if args.baseline and pathlib.Path(args.baseline).exists():
+        baseline = json.loads(pathlib.Path(args.baseline).read_text())
+        regressions = find_regressions(results, baseline, args.tolerance)
+        for regression in regressions:
+            print('Regression: %s' % regression, file=sys.stderr)
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
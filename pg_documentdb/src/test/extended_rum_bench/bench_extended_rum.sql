@@ -0,0 +1,159 @@
+-- Benchmarks the extended RUM index access method over several distributions of
+-- the indexed terms:
+--
+--   unique   every document has its own term (entry tree heavy)
+--   uniform  1000 terms with the same number of documents each
+--   skewed   1000 terms with a power law distribution of documents
+--   single   every document has the same term (one large posting tree)
+--
+-- Stages per distribution:
+--
+--   insert        documents inserted into a collection with the index
+--   term_scan     count of the most frequent term, dominated by posting list decoding
+--   range_scan    count over every term of the index
+--   ordered_scan  $sort + $limit served by an ordered index scan, reported per query
+--   vacuum        vacuum of the index after deleting half of the documents
+--
+-- The server needs documentdb.alternate_index_handler_name = 'extended_rum' so that the
+-- indexes are built with the extended RUM access method.
+--
+-- psql -v rows=<n> -v batch_size=<n> -v scan_iterations=<n> -v distributions=<list> \
+--     -f bench_extended_rum.sql
+
+\set QUIET on
+CREATE EXTENSION IF NOT EXISTS documentdb_extended_rum CASCADE;
+SET client_min_messages TO WARNING;
+SET documentdb.enableIndexOrderbyPushdown TO on;
+SET documentdb.forceDisableSeqScan TO on;
+
+CREATE TEMP TABLE rum_bench_results (
+    distribution text, stage text, operations bigint, duration interval);
+CREATE TEMP TABLE rum_bench_marks (distribution text PRIMARY KEY, started timestamptz);
+
+-- The term of the i-th document for a distribution.
+CREATE FUNCTION pg_temp.rum_bench_term(distribution text, i int)
+RETURNS int
+LANGUAGE sql
+AS $$
+    SELECT CASE distribution
+        WHEN 'unique' THEN i
+        WHEN 'uniform' THEN i % 1000
+        WHEN 'skewed' THEN floor(power(random(), 4) * 1000)::int
+        WHEN 'single' THEN 1
+    END
+$$;
+
+-- The most frequent term of a distribution.
+CREATE FUNCTION pg_temp.rum_bench_hot_term(distribution text, total_rows int)
+RETURNS int
+LANGUAGE sql
+AS $$
+    SELECT CASE distribution
+        WHEN 'unique' THEN total_rows / 2
+        WHEN 'single' THEN 1
+        ELSE 0
+    END
+$$;
+
+CREATE FUNCTION pg_temp.rum_bench_table(distribution text)
+RETURNS text
+LANGUAGE sql
+AS $$
+    SELECT FORMAT('documentdb_data.documents_%s', collection_id)
+    FROM documentdb_api_catalog.collections
+    WHERE database_name = 'rum_bench' AND collection_name = distribution
+$$;
+
+CREATE FUNCTION pg_temp.rum_bench_record(distribution text, stage text, operations bigint,
+                                         started timestamptz)
+RETURNS void
+LANGUAGE sql
+AS $$
+    INSERT INTO rum_bench_results VALUES (distribution, stage, operations, clock_timestamp() - started)
+$$;
+
+-- Times count queries through the index, returns the number of documents matched per query.
+CREATE FUNCTION pg_temp.rum_bench_count(distribution text, stage text, query text, iterations int)
+RETURNS bigint
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    started timestamptz;
+    matched bigint;
+BEGIN
+    started := clock_timestamp();
+    FOR i IN 1..iterations LOOP
+        SELECT (document->>'n')::bigint INTO matched
+        FROM documentdb_api_catalog.bson_aggregation_count('rum_bench',
+            FORMAT('{ "count": "%s", "query": %s }', distribution, query)::documentdb_core.bson);
+    END LOOP;
+    PERFORM pg_temp.rum_bench_record(distribution, stage, matched * iterations, started);
+    RETURN matched;
+END;
+$$;
+
+-- Loads the collection of a distribution and runs the scan stages over it.
+CREATE FUNCTION pg_temp.rum_bench_run(distribution text, total_rows int, batch_size int, iterations int)
+RETURNS void
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    started timestamptz;
+    documents text;
+BEGIN
+    PERFORM documentdb_api.drop_collection('rum_bench', distribution);
+    PERFORM documentdb_api.create_collection('rum_bench', distribution);
+    EXECUTE FORMAT('ALTER TABLE %s SET (autovacuum_enabled = off)', pg_temp.rum_bench_table(distribution));
+    PERFORM documentdb_api_internal.create_indexes_non_concurrently('rum_bench',
+        FORMAT('{ "createIndexes": "%s", "indexes": [ { "key": { "a": 1 }, "name": "a_1" } ] }',
+               distribution)::documentdb_core.bson, TRUE);
+
+    started := clock_timestamp();
+    FOR batch_start IN 1..total_rows BY batch_size LOOP
+        SELECT string_agg(FORMAT('{ "_id": %s, "a": %s }', i, pg_temp.rum_bench_term(distribution, i)), ',')
+            INTO documents
+        FROM generate_series(batch_start, LEAST(batch_start + batch_size - 1, total_rows)) i;
+        PERFORM documentdb_api.insert('rum_bench',
+            FORMAT('{ "insert": "%s", "documents": [ %s ] }', distribution, documents)::documentdb_core.bson);
+    END LOOP;
+    PERFORM pg_temp.rum_bench_record(distribution, 'insert', total_rows, started);
+
+    PERFORM pg_temp.rum_bench_count(distribution, 'term_scan',
+        FORMAT('{ "a": %s }', pg_temp.rum_bench_hot_term(distribution, total_rows)), iterations);
+    PERFORM pg_temp.rum_bench_count(distribution, 'range_scan',
+        '{ "a": { "$gte": 0 } }', iterations);
+
+    started := clock_timestamp();
+    FOR i IN 1..iterations LOOP
+        PERFORM document FROM documentdb_api_catalog.bson_aggregation_pipeline('rum_bench',
+            FORMAT('{ "aggregate": "%s", "pipeline": [ { "$sort": { "a": 1 } }, { "$limit": 100 } ], "cursor": {} }',
+                   distribution)::documentdb_core.bson);
+    END LOOP;
+    PERFORM pg_temp.rum_bench_record(distribution, 'ordered_scan', iterations, started);
+
+    PERFORM documentdb_api.delete('rum_bench',
+        FORMAT('{ "delete": "%s", "deletes": [ { "q": { "_id": { "$mod": [ 2, 1 ] } }, "limit": 0 } ] }',
+               distribution)::documentdb_core.bson);
+END;
+$$;
+
+\set QUIET off
+
+SELECT pg_temp.rum_bench_run(distribution, :rows, :batch_size, :scan_iterations)
+FROM unnest(string_to_array(:'distributions', ',')) distribution;
+
+-- VACUUM can't run inside a function, so it's timed between two statements.
+SELECT FORMAT($$INSERT INTO rum_bench_marks VALUES (%L, clock_timestamp())$$, distribution),
+       FORMAT('VACUUM (INDEX_CLEANUP ON, DISABLE_PAGE_SKIPPING ON) %s', pg_temp.rum_bench_table(distribution)),
+       FORMAT($$SELECT pg_temp.rum_bench_record(%L, 'vacuum', %s, started) FROM rum_bench_marks WHERE distribution = %L$$,
+              distribution, (:rows + 1) / 2, distribution)
+FROM unnest(string_to_array(:'distributions', ',')) distribution \gexec
+
+SELECT distribution, stage, operations,
+       round((extract(epoch FROM duration) * 1000)::numeric, 1) AS duration_ms,
+       round((operations / NULLIF(extract(epoch FROM duration), 0))::numeric, 1) AS ops_per_sec
+FROM rum_bench_results
+ORDER BY array_position(string_to_array(:'distributions', ','), distribution),
+         array_position(ARRAY['insert', 'term_scan', 'range_scan', 'ordered_scan', 'vacuum'], stage);
+
+SELECT documentdb_api.drop_database('rum_bench');
@@ -0,0 +1,103 @@
+-- Injects failures in the middle of page splits of the extended RUM index and checks
+-- that the index still returns the same documents as a sequential scan once the
+-- incomplete splits are finished by later inserts and by vacuum.
+--
+-- The server needs documentdb.alternate_index_handler_name = 'extended_rum' so that the
+-- index is built with the extended RUM access method.
+--
+-- psql -v rows=<n> -v batch_size=<n> -f extended_rum_faults.sql
+
+\set QUIET on
+CREATE EXTENSION IF NOT EXISTS documentdb_extended_rum CASCADE;
+SET client_min_messages TO WARNING;
+
+-- Small data pages so that every few inserts of the same term split a posting tree page.
+SET documentdb_rum.data_page_posting_tree_size = 3;
+SET documentdb_rum.track_incomplete_split TO on;
+SET documentdb_rum.fix_incomplete_split TO on;
+
+-- Fails if an index scan and a sequential scan of the query don't return the same count.
+CREATE FUNCTION pg_temp.rum_faults_check(stage text, query text)
+RETURNS text
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    index_count bigint;
+    seq_count bigint;
+    count_command documentdb_core.bson := FORMAT(
+        '{ "count": "faults", "query": %s }', query)::documentdb_core.bson;
+BEGIN
+    SET LOCAL documentdb.forceDisableSeqScan TO on;
+    SELECT (document->>'n')::bigint INTO index_count
+    FROM documentdb_api_catalog.bson_aggregation_count('rum_faults', count_command);
+
+    SET LOCAL documentdb.forceDisableSeqScan TO off;
+    SET LOCAL enable_indexscan TO off;
+    SET LOCAL enable_bitmapscan TO off;
+    SELECT (document->>'n')::bigint INTO seq_count
+    FROM documentdb_api_catalog.bson_aggregation_count('rum_faults', count_command);
+
+    IF index_count IS DISTINCT FROM seq_count THEN
+        RAISE EXCEPTION '%: index scan of % returned % documents, sequential scan returned %',
+            stage, query, index_count, seq_count;
+    END IF;
+
+    RETURN FORMAT('%s: %s documents match %s', stage, index_count, query);
+END;
+$$;
+
+-- Inserts documents with the given id range, half of them with the hot term 1.
+CREATE FUNCTION pg_temp.rum_faults_insert(first_id int, last_id int)
+RETURNS void
+LANGUAGE sql
+AS $$
+    SELECT documentdb_api.insert('rum_faults',
+        FORMAT('{ "insert": "faults", "documents": [ %s ] }',
+               string_agg(FORMAT('{ "_id": %s, "a": %s }', i, CASE WHEN i % 2 = 0 THEN 1 ELSE i END), ','))::documentdb_core.bson)
+    FROM generate_series(first_id, last_id) i
+$$;
+
+-- Inserts a batch with a failure injected into its page splits, returns whether it failed.
+CREATE FUNCTION pg_temp.rum_faults_insert_with_failure(first_id int, last_id int)
+RETURNS bool
+LANGUAGE plpgsql
+AS $$
+BEGIN
+    SET LOCAL documentdb_rum.enable_inject_page_split_incomplete TO on;
+    PERFORM pg_temp.rum_faults_insert(first_id, last_id);
+    RETURN false;
+EXCEPTION WHEN OTHERS THEN
+    RETURN true;
+END;
+$$;
+
+SELECT documentdb_api.drop_collection('rum_faults', 'faults');
+SELECT documentdb_api.create_collection('rum_faults', 'faults');
+SELECT documentdb_api_internal.create_indexes_non_concurrently('rum_faults',
+    '{ "createIndexes": "faults", "indexes": [ { "key": { "a": 1 }, "name": "a_1" } ] }', TRUE);
+SELECT FORMAT('documentdb_data.documents_%s', collection_id) AS faults_table
+FROM documentdb_api_catalog.collections
+WHERE database_name = 'rum_faults' AND collection_name = 'faults' \gset
+\set QUIET off
+
+SELECT pg_temp.rum_faults_insert(1, :rows);
+SELECT pg_temp.rum_faults_check('load', '{ "a": 1 }');
+
+-- Every batch below is rolled back after leaving splits of the index incomplete.
+SELECT COUNT(*) FILTER (WHERE pg_temp.rum_faults_insert_with_failure(i, i + :batch_size - 1)) AS injected_failures
+FROM generate_series(:rows + 1, 2 * :rows, :batch_size) i;
+SELECT pg_temp.rum_faults_check('after injected failures', '{ "a": 1 }');
+SELECT pg_temp.rum_faults_check('after injected failures', '{ "a": { "$gte": 0 } }');
+
+-- Later inserts finish the incomplete splits on their way down the tree.
+SELECT pg_temp.rum_faults_insert(2 * :rows + 1, 3 * :rows);
+SELECT pg_temp.rum_faults_check('after finishing splits', '{ "a": 1 }');
+SELECT pg_temp.rum_faults_check('after finishing splits', '{ "a": { "$gte": 0 } }');
+
+SELECT documentdb_api.delete('rum_faults',
+    '{ "delete": "faults", "deletes": [ { "q": { "_id": { "$mod": [ 4, 0 ] } }, "limit": 0 } ] }');
+VACUUM (INDEX_CLEANUP ON, DISABLE_PAGE_SKIPPING ON) :faults_table;
+SELECT pg_temp.rum_faults_check('after vacuum', '{ "a": 1 }');
+SELECT pg_temp.rum_faults_check('after vacuum', '{ "a": { "$gte": 0 } }');
+
+SELECT documentdb_api.drop_database('rum_faults');
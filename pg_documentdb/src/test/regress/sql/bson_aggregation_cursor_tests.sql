@@ -202,6 +202,26 @@ SELECT * FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 5, pa
 SELECT * FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 5, pageSize => 2, pipeline => '{ "": [{ "$group": { "_id": "$_id", "c": { "$max": "$a" } } }] }');
 ROLLBACK;
 
+-- filters on the large documents, with and without slice detoasting of a document prefix
+-- the queried field starts in the first slice
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$lte": 2 }, "a": { "$regex": "^Sample" } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$gte": 9 }, "a": { "$type": "string" } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+-- the queried field is after the large field, or missing, so the whole document is read
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$lt": 3 }, "c": { "$size": 5001 } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": 5, "c": "d" }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$gt": 8 }, "z": { "$exists": false } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "c": { "$size": 5000 } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SET documentdb.enableQueryDocumentSliceDetoast TO on;
+-- the queried field starts in the first slice
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$lte": 2 }, "a": { "$regex": "^Sample" } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$gte": 9 }, "a": { "$type": "string" } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+-- the queried field is after the large field, or missing, so the whole document is read
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$lt": 3 }, "c": { "$size": 5001 } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": 5, "c": "d" }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "_id": { "$gt": 8 }, "z": { "$exists": false } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+SELECT document FROM bson_aggregation_find('db', '{ "find": "get_aggregation_cursor_test", "filter": { "c": { "$size": 5000 } }, "projection": { "_id": 1 }, "sort": { "_id": 1 } }');
+RESET documentdb.enableQueryDocumentSliceDetoast;
+
 -- with sharded
 SELECT documentdb_api.shard_collection('db', 'get_aggregation_cursor_test', '{ "_id": "hashed" }', false);
 SELECT * FROM aggregation_cursor_test.drain_find_query(loopCount => 6, pageSize => 100000);
@@ -279,4 +299,81 @@ END;
 SELECT * FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 1, pageSize => 1, pipeline => '{ "": [{ "$skip": 2 }]}');
 
 -- now run a new query - this should close the cursor above, and continue with a fresh query
-SELECT * FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 1, pageSize => 1, pipeline => '{ "": [{ "$skip": 2 }]}');
\ No newline at end of file
+SELECT * FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 1, pageSize => 1, pipeline => '{ "": [{ "$skip": 2 }]}');
+
+-- single row stages followed by stages producing multiple rows drain all the rows with a persisted cursor
+SET documentdb.enableParallelSingleBatchAggregation TO on;
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 3, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$facet": { "docs": [ { "$project": { "_id": 1 } } ] } }, { "$unwind": "$docs" }, { "$replaceRoot": { "newRoot": "$docs" } }]}');
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 3, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$count": "n" }, { "$project": { "_id": { "$range": [ 0, "$n" ] } } }, { "$unwind": "$_id" }]}');
+-- a single row result is still drained in a single batch
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 0, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$facet": { "docs": [ { "$project": { "_id": 1 } } ] } }, { "$project": { "_id": { "$size": "$docs" } } }]}');
+RESET documentdb.enableParallelSingleBatchAggregation;
+
+-- $unionWith pipelines drained to completion may be planned with parallel workers
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 6, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$project": { "_id": 1 } }, { "$unionWith": { "coll": "get_aggregation_cursor_smalldoc_test", "pipeline": [ { "$project": { "_id": { "$add": [ "$_id", 10 ] } } } ] } }, { "$sort": { "_id": 1 } }]}');
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 3, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$unionWith": "get_aggregation_cursor_smalldoc_test" }, { "$group": { "_id": "$_id", "n": { "$sum": 1 } } }, { "$match": { "n": 2 } }, { "$sort": { "_id": 1 } }]}');
+SET documentdb.enableParallelUnionWith TO on;
+SET parallel_setup_cost TO 0;
+SET parallel_tuple_cost TO 0;
+SET min_parallel_table_scan_size TO 0;
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 6, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$project": { "_id": 1 } }, { "$unionWith": { "coll": "get_aggregation_cursor_smalldoc_test", "pipeline": [ { "$project": { "_id": { "$add": [ "$_id", 10 ] } } } ] } }, { "$sort": { "_id": 1 } }]}');
+SELECT filteredDoc FROM aggregation_cursor_test.drain_aggregation_query(loopCount => 3, pageSize => 3, collection_name => 'get_aggregation_cursor_smalldoc_test',
+    pipeline => '{ "": [{ "$unionWith": "get_aggregation_cursor_smalldoc_test" }, { "$group": { "_id": "$_id", "n": { "$sum": 1 } } }, { "$match": { "n": 2 } }, { "$sort": { "_id": 1 } }]}');
+RESET min_parallel_table_scan_size;
+RESET parallel_tuple_cost;
+RESET parallel_setup_cost;
+RESET documentdb.enableParallelUnionWith;
+
+-- sorted finds stream their pages by resuming from the sort key of the next document to return
+CREATE FUNCTION aggregation_cursor_test.drain_sorted_find_query(
+    loopCount int, pageSize int, sort bson, filter bson DEFAULT NULL) RETURNS TABLE(filteredDoc bson, sortedQuery bson, resumeKey bson) AS
+$$
+    DECLARE
+        i int;
+        doc bson;
+        cont bson;
+        findSpec bson;
+        getMoreSpec bson;
+    BEGIN
+
+    WITH r1 AS (SELECT 'get_aggregation_cursor_smalldoc_test' AS "find", filter AS "filter", sort AS "sort", pageSize AS "batchSize")
+    SELECT row_get_bson(r1) INTO findSpec FROM r1;
+
+    WITH r1 AS (SELECT 'get_aggregation_cursor_smalldoc_test' AS "collection", 4294967294::int8 AS "getMore", pageSize AS "batchSize")
+    SELECT row_get_bson(r1) INTO getMoreSpec FROM r1;
+
+    SELECT cursorPage, continuation INTO STRICT doc, cont FROM
+                    documentdb_api.find_cursor_first_page(database => 'db', commandSpec => findSpec, cursorId => 4294967294);
+
+    FOR i IN 0..loopCount LOOP
+        IF i > 0 THEN
+            SELECT cursorPage, continuation INTO STRICT doc, cont FROM documentdb_api.cursor_get_more(database => 'db', getMoreSpec => getMoreSpec, continuationSpec => cont);
+        END IF;
+
+        filteredDoc := documentdb_api_catalog.bson_dollar_project(doc,
+            '{ "cursor.id": 1, "ids": { "$ifNull": [ "$cursor.firstBatch._id", "$cursor.nextBatch._id" ] } }'::documentdb_core.bson);
+        sortedQuery := documentdb_api_catalog.bson_dollar_project(cont, '{ "sorted": { "$type": "$qo" } }'::documentdb_core.bson);
+        resumeKey := documentdb_api_catalog.bson_dollar_project(cont, '{ "resumeKey": { "$type": "$qr" } }'::documentdb_core.bson);
+        RETURN NEXT;
+    END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+
+SET documentdb.enableSortedFindStreamingCursor TO on;
+SELECT * FROM aggregation_cursor_test.drain_sorted_find_query(loopCount => 3, pageSize => 3, sort => '{ "_id": -1 }');
+-- a page that ends the results doesn't leave a cursor behind
+SELECT * FROM aggregation_cursor_test.drain_sorted_find_query(loopCount => 1, pageSize => 5, sort => '{ "_id": -1 }');
+-- all the documents have the same "a": ties are broken by _id so none is skipped or repeated across pages
+SELECT * FROM aggregation_cursor_test.drain_sorted_find_query(loopCount => 2, pageSize => 4, sort => '{ "a": 1 }');
+SELECT * FROM aggregation_cursor_test.drain_sorted_find_query(loopCount => 2, pageSize => 3, sort => '{ "a": -1, "_id": -1 }', filter => '{ "_id": { "$gt": 3 } }');
+-- with the flag off the same finds use a persisted cursor
+SET documentdb.enableSortedFindStreamingCursor TO off;
+SELECT * FROM aggregation_cursor_test.drain_sorted_find_query(loopCount => 3, pageSize => 3, sort => '{ "_id": -1 }');
+SELECT * FROM aggregation_cursor_test.drain_sorted_find_query(loopCount => 2, pageSize => 3, sort => '{ "a": -1, "_id": -1 }', filter => '{ "_id": { "$gt": 3 } }');
+RESET documentdb.enableSortedFindStreamingCursor;
@@ -30,4 +30,61 @@ SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('diagnosti
 -- index_stats should work
 SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('diagnostic_db', '{ "aggregate": "diag_coll1", "pipeline": [ { "$indexStats": { }}, { "$project": { "accesses.since": 0 }}]}');
 SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('diagnostic_db', '{ "aggregate": "diag_coll2", "pipeline": [ { "$indexStats": { }}, { "$project": { "accesses.since": 0 }}]}');
-SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('diagnostic_db', '{ "aggregate": "diag_coll3", "pipeline": [ { "$indexStats": { }}, { "$project": { "accesses.since": 0 }}]}');
\ No newline at end of file
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('diagnostic_db', '{ "aggregate": "diag_coll3", "pipeline": [ { "$indexStats": { }}, { "$project": { "accesses.since": 0 }}]}');
+
+-- collStats/dbStats responses are reused from the cache within the staleness bound of the session
+SELECT documentdb_api.insert_one('stats_cache_db', 'cache_coll', '{ "_id": 1 }');
+SELECT documentdb_api.insert_one('stats_cache_db', 'cache_coll', '{ "_id": 2 }');
+SET documentdb.statsCacheMaxStalenessMs TO 3600000;
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.coll_stats('stats_cache_db', 'cache_coll'), '{ "count": 1 }');
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.db_stats('stats_cache_db'), '{ "collections": 1 }');
+SELECT documentdb_api.insert_one('stats_cache_db', 'cache_coll', '{ "_id": 3 }');
+SELECT documentdb_api.insert_one('stats_cache_db', 'cache_coll2', '{ "_id": 1 }');
+
+-- the cached responses are returned, a different scale is cached separately
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.coll_stats('stats_cache_db', 'cache_coll'), '{ "count": 1 }');
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.db_stats('stats_cache_db'), '{ "collections": 1 }');
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.coll_stats('stats_cache_db', 'cache_coll', 1024), '{ "count": 1 }');
+
+-- the session can require fresh stats
+SET documentdb.statsCacheMaxStalenessMs TO 0;
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.coll_stats('stats_cache_db', 'cache_coll'), '{ "count": 1 }');
+SELECT documentdb_api_catalog.bson_dollar_project(documentdb_api.db_stats('stats_cache_db'), '{ "collections": 1 }');
+RESET documentdb.statsCacheMaxStalenessMs;
+
+-- sampled slow commands are recorded in the profile of their database
+SET enable_seqscan TO off;
+
+-- the durations, start times and counters of the profile entries depend on the run, they are left out
+
+-- with the default threshold, commands are not profiled
+SELECT cursorPage FROM find_cursor_first_page('diagnostic_db', '{ "find": "diag_coll2", "filter": { "a": 2 } }');
+SELECT document FROM count_query('diagnostic_db', '{ "count": "diag_coll2", "query": { "a": { "$gte": 2 } } }');
+SELECT documentdb_api_catalog.bson_dollar_project(slow_command_profile('diagnostic_db'), '{ "profile.millis": 0, "profile.ts": 0, "profile.keysExamined": 0, "profile.docsExamined": 0 }');
+
+-- commands that are not sampled are not profiled either
+SET documentdb.slowCommandProfileThresholdMS TO 0;
+SET documentdb.slowCommandProfileSampleRate TO 0;
+SELECT cursorPage FROM find_cursor_first_page('diagnostic_db', '{ "find": "diag_coll2", "filter": { "a": 2 } }');
+SELECT document FROM count_query('diagnostic_db', '{ "count": "diag_coll2", "query": { "a": { "$gte": 2 } } }');
+SELECT documentdb_api_catalog.bson_dollar_project(slow_command_profile('diagnostic_db'), '{ "profile.millis": 0, "profile.ts": 0, "profile.keysExamined": 0, "profile.docsExamined": 0 }');
+
+-- sampled commands over the threshold are profiled, with the key of the index they scanned
+SET documentdb.slowCommandProfileSampleRate TO 1;
+SELECT cursorPage FROM find_cursor_first_page('diagnostic_db', '{ "find": "diag_coll2", "filter": { "a": 2 } }');
+SELECT document FROM count_query('diagnostic_db', '{ "count": "diag_coll2", "query": { "a": { "$gte": 2 } } }');
+SELECT documentdb_api_catalog.bson_dollar_project(slow_command_profile('diagnostic_db'), '{ "profile.millis": 0, "profile.ts": 0, "profile.keysExamined": 0, "profile.docsExamined": 0 }');
+
+-- large command specs only keep the command name and collection
+RESET enable_seqscan;
+SELECT cursorPage FROM find_cursor_first_page('diagnostic_db', FORMAT('{ "find": "diag_coll2", "filter": { "b": "%s" } }', repeat('z', 3000))::bson);
+SELECT documentdb_api_catalog.bson_dollar_project(slow_command_profile('diagnostic_db'), '{ "profile.millis": 0, "profile.ts": 0, "profile.keysExamined": 0, "profile.docsExamined": 0 }');
+
+-- commands of other databases are not returned
+SELECT slow_command_profile('slow_profile_other_db');
+
+RESET documentdb.slowCommandProfileSampleRate;
+RESET documentdb.slowCommandProfileThresholdMS;
+SELECT cursorPage FROM find_cursor_first_page('diagnostic_db', '{ "find": "diag_coll2", "filter": { "a": 2 } }');
+SELECT document FROM count_query('diagnostic_db', '{ "count": "diag_coll2", "query": { "a": { "$gte": 2 } } }');
+SELECT documentdb_api_catalog.bson_dollar_project(slow_command_profile('diagnostic_db'), '{ "profile.millis": 0, "profile.ts": 0, "profile.keysExamined": 0, "profile.docsExamined": 0 }');
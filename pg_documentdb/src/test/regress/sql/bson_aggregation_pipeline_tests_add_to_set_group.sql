@@ -40,6 +40,19 @@ $$;
 /* should fail with intermediate size error */
 SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "sizes_test", "pipeline": [ { "$group": { "_id": "$groupName", "data": { "$addToSet": "$c" } } } ] }');
 
+/* the accumulators and expressions on a tuple share the detoasted document with the detoast cache */
+SET documentdb.enableQueryDocumentDetoastCache TO on;
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "sizes_test", "pipeline": [ { "$group": { "_id": "$groupName", "data": { "$addToSet": "$c" } } } ] }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "sizes_test", "pipeline": [ { "$group": { "_id": "$groupName", "n": { "$sum": 1 }, "sumId": { "$sum": "$_id" }, "maxId": { "$max": "$_id" }, "minSize": { "$min": { "$size": "$c" } } } }, { "$sort": { "_id": 1 } } ] }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "sizes_test", "pipeline": [ { "$match": { "_id": { "$lte": 3 } } }, { "$sort": { "_id": 1 } }, { "$project": { "_id": 1, "first": { "$strLenBytes": { "$arrayElemAt": [ "$c", 0 ] } }, "last": { "$arrayElemAt": [ "$c", -1 ] }, "same": { "$eq": [ "$groupName", "A" ] } } } ] }');
+/* updated documents are detoasted again */
+BEGIN;
+SELECT documentdb_api.update('db', '{ "update": "sizes_test", "updates": [ { "q": { "_id": 1 }, "u": { "$set": { "groupName": "B" } } } ] }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "sizes_test", "pipeline": [ { "$group": { "_id": "$groupName", "n": { "$sum": 1 }, "sumId": { "$sum": "$_id" }, "maxId": { "$max": "$_id" }, "minSize": { "$min": { "$size": "$c" } } } }, { "$sort": { "_id": 1 } } ] }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db', '{ "aggregate": "sizes_test", "pipeline": [ { "$match": { "_id": { "$lte": 3 } } }, { "$sort": { "_id": 1 } }, { "$project": { "_id": 1, "first": { "$strLenBytes": { "$arrayElemAt": [ "$c", 0 ] } }, "last": { "$arrayElemAt": [ "$c", -1 ] }, "same": { "$eq": [ "$groupName", "A" ] } } } ] }');
+ROLLBACK;
+RESET documentdb.enableQueryDocumentDetoastCache;
+
 /* shard collection */
 SELECT documentdb_api.shard_collection('db', 'salesTest', '{ "_id": "hashed" }', false);
 
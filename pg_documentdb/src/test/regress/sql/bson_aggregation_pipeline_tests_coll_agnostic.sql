@@ -19,4 +19,23 @@ EXPLAIN (VERBOSE ON, COSTS OFF) SELECT document FROM bson_aggregation_pipeline('
 SELECT current_op_command('{ "op_prefix": { "$lt": 2 }}');
 
 -- collection agnostic with no pipeline should work and return 0 rows.
-SELECT document from bson_aggregation_pipeline('db', '{ "aggregate" : 1.0, "pipeline" : [  ], "cursor" : {  }, "txnNumber" : 0, "lsid" : { "id" : { "$binary" : { "base64": "H+W3J//vSn6obaefeJ6j/g==", "subType" : "04" } } }, "$db" : "admin" }');
\ No newline at end of file
+SELECT document from bson_aggregation_pipeline('db', '{ "aggregate" : 1.0, "pipeline" : [  ], "cursor" : {  }, "txnNumber" : 0, "lsid" : { "id" : { "$binary" : { "base64": "H+W3J//vSn6obaefeJ6j/g==", "subType" : "04" } } }, "$db" : "admin" }');
+
+-- without the activity slots, the command of the current session is parsed from its query text
+SELECT cursorPage FROM documentdb_api.aggregate_cursor_first_page('admin', '{ "aggregate": 1, "pipeline": [ { "$currentOp": {} }, { "$match": { "command.aggregate": { "$exists": true } } }, { "$replaceRoot": { "newRoot": { "command": "$command", "op": "$op", "nsType": { "$type": "$ns" }, "ns": "$ns", "docsExaminedType": { "$type": "$docsExamined" } } } } ], "cursor": {} }');
+
+-- with them, the command and namespace are the ones published by the session
+SET documentdb.enableCommandActivitySlots TO on;
+SELECT cursorPage FROM documentdb_api.aggregate_cursor_first_page('admin', '{ "aggregate": 1, "pipeline": [ { "$currentOp": {} }, { "$match": { "command.aggregate": { "$exists": true } } }, { "$replaceRoot": { "newRoot": { "command": "$command", "op": "$op", "nsType": { "$type": "$ns" }, "ns": "$ns", "docsExaminedType": { "$type": "$docsExamined" } } } } ], "cursor": {} }');
+
+-- a command published by an earlier statement of the transaction isn't used for the next one
+BEGIN;
+SELECT cursorPage FROM documentdb_api.aggregate_cursor_first_page('admin', '{ "aggregate": 1, "pipeline": [ { "$currentOp": {} }, { "$match": { "command.aggregate": { "$exists": true } } }, { "$replaceRoot": { "newRoot": { "command": "$command", "op": "$op", "nsType": { "$type": "$ns" }, "ns": "$ns", "docsExaminedType": { "$type": "$docsExamined" } } } } ], "cursor": {} }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('admin', '{ "aggregate": 1, "pipeline": [ { "$currentOp": {} }, { "$match": { "command.aggregate": { "$exists": true } } }, { "$replaceRoot": { "newRoot": { "command": "$command", "op": "$op", "nsType": { "$type": "$ns" }, "ns": "$ns", "docsExaminedType": { "$type": "$docsExamined" } } } } ] }');
+COMMIT;
+
+-- the slot is cleared at the end of the transaction
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('admin', '{ "aggregate": 1, "pipeline": [ { "$currentOp": {} }, { "$match": { "command.aggregate": { "$exists": true } } }, { "$replaceRoot": { "newRoot": { "command": "$command", "op": "$op", "nsType": { "$type": "$ns" }, "ns": "$ns", "docsExaminedType": { "$type": "$docsExamined" } } } } ] }');
+
+RESET documentdb.enableCommandActivitySlots;
+SELECT cursorPage FROM documentdb_api.aggregate_cursor_first_page('admin', '{ "aggregate": 1, "pipeline": [ { "$currentOp": {} }, { "$match": { "command.aggregate": { "$exists": true } } }, { "$replaceRoot": { "newRoot": { "command": "$command", "op": "$op", "nsType": { "$type": "$ns" }, "ns": "$ns", "docsExaminedType": { "$type": "$docsExamined" } } } } ], "cursor": {} }');
@@ -68,3 +68,39 @@ SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
 
 SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
     '{ "aggregate": "graphlookup_visitors", "pipeline": [ { "$graphLookup": { "from": "graphlookup_places", "startWith": "$homePlace", "connectFromField": "nearby", "connectToField": "placeCode", "as": "reachablePlaces", "maxDepth": 2 } } ]}');
+
+
+-- breadth first traversal: cycles, maxDepth and restrictSearchWithMatch
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_nodes', '{ "_id" : 1, "name" : "a", "next" : [ "b", "c" ] }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_nodes', '{ "_id" : 2, "name" : "b", "next" : [ "d" ] }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_nodes', '{ "_id" : 3, "name" : "c", "next" : [ "d", "a" ] }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_nodes', '{ "_id" : 4, "name" : "d", "next" : [ "e" ], "blocked" : true }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_nodes', '{ "_id" : 5, "name" : "e", "next" : [ "a" ] }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_nodes', '{ "_id" : 6, "name" : "f", "next" : [ ] }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_start', '{ "_id" : 1, "start" : "a" }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_start', '{ "_id" : 2, "start" : "e" }');
+SELECT documentdb_api.insert_one('db', 'graphlookup_bfs_start', '{ "_id" : 3, "start" : "x" }');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops" } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops", "maxDepth": 0 } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops", "maxDepth": 1 } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "maxDepth": 2 } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops", "restrictSearchWithMatch": { "blocked": { "$ne": true } } } }, { "$sort": { "_id": 1 } } ]}');
+
+-- the native traversal returns the same documents at the same depths
+SET documentdb.enableNativeGraphLookup TO on;
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops" } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops", "maxDepth": 0 } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops", "maxDepth": 1 } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "maxDepth": 2 } }, { "$sort": { "_id": 1 } } ]}');
+SELECT document FROM documentdb_api_catalog.bson_aggregation_pipeline('db',
+    '{ "aggregate": "graphlookup_bfs_start", "pipeline": [ { "$graphLookup": { "from": "graphlookup_bfs_nodes", "startWith": "$start", "connectFromField": "next", "connectToField": "name", "as": "reached", "depthField": "hops", "restrictSearchWithMatch": { "blocked": { "$ne": true } } } }, { "$sort": { "_id": 1 } } ]}');
+RESET documentdb.enableNativeGraphLookup;
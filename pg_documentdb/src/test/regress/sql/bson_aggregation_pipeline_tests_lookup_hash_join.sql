@@ -0,0 +1,21 @@
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+
+SET documentdb.next_collection_id TO 9300;
+SET documentdb.next_collection_index_id TO 9300;
+
+SELECT documentdb_api.insert_one('db', 'lookup_hash_orders', '{ "_id": 1, "item": "a", "qty": 5 }');
+SELECT documentdb_api.insert_one('db', 'lookup_hash_orders', '{ "_id": 2, "item": [ "b", "a" ], "qty": 1 }');
+SELECT documentdb_api.insert_one('db', 'lookup_hash_orders', '{ "_id": 3, "item": "c", "qty": 3 }');
+SELECT documentdb_api.insert_one('db', 'lookup_hash_inventory', '{ "_id": 10, "sku": "a" }');
+SELECT documentdb_api.insert_one('db', 'lookup_hash_inventory', '{ "_id": 11, "sku": [ "a", "b" ] }');
+SELECT documentdb_api.insert_one('db', 'lookup_hash_inventory', '{ "_id": 12, "sku": "b" }');
+
+-- the order of the local documents and of the matches is the same with the lateral join and the hash join
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "lookup_hash_orders", "pipeline": [ { "$sort": { "qty": -1 } }, { "$lookup": { "from": "lookup_hash_inventory", "localField": "item", "foreignField": "sku", "as": "matched" } } ] }');
+SET documentdb.enableLookupHashJoin TO on;
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "lookup_hash_orders", "pipeline": [ { "$sort": { "qty": -1 } }, { "$lookup": { "from": "lookup_hash_inventory", "localField": "item", "foreignField": "sku", "as": "matched" } } ] }');
+
+-- a foreign document matching several local values is returned once
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "lookup_hash_inventory", "pipeline": [ { "$match": { "_id": 11 } }, { "$lookup": { "from": "lookup_hash_orders", "localField": "sku", "foreignField": "item", "as": "orders" } } ] }');
+RESET documentdb.enableLookupHashJoin;
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "lookup_hash_inventory", "pipeline": [ { "$match": { "_id": 11 } }, { "$lookup": { "from": "lookup_hash_orders", "localField": "sku", "foreignField": "item", "as": "orders" } } ] }');
@@ -0,0 +1,48 @@
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+
+SET documentdb.next_collection_id TO 9500;
+SET documentdb.next_collection_index_id TO 9500;
+
+SELECT documentdb_api.insert_one('db', 'rank_fusion_docs', '{ "_id": 1, "a": 1, "b": 5 }');
+SELECT documentdb_api.insert_one('db', 'rank_fusion_docs', '{ "_id": 2, "a": 2, "b": 4 }');
+SELECT documentdb_api.insert_one('db', 'rank_fusion_docs', '{ "_id": 3, "a": 3, "b": 3 }');
+SELECT documentdb_api.insert_one('db', 'rank_fusion_docs', '{ "_id": 4, "a": 4, "b": 2 }');
+SELECT documentdb_api.insert_one('db', 'rank_fusion_docs', '{ "_id": 5, "a": 5, "b": 1 }');
+
+-- the stage is behind a flag
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } } } } ] }');
+
+SET documentdb.enableRankFusionStage TO on;
+
+-- a document ranked by both pipelines sums its scores, documents with the same score are returned by _id
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } } } } ] }');
+
+-- the weights scale the score of each pipeline
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "combination": { "weights": { "byB": 2 } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "combination": { "weights": { "byA": 0.5 } } } } ] }');
+
+-- the ranks follow the sort of each pipeline and start at 1 after its $skip
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": -1 } }, { "$skip": 1 }, { "$limit": 1 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 1 } ] } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byB": [ { "$match": { "a": { "$gte": 2 } } }, { "$sort": { "b": -1 } } ] } } } } ] }');
+
+-- a pipeline that matches nothing adds no scores
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$match": { "a": { "$gt": 10 } } }, { "$sort": { "a": 1 } } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 2 } ] } } } } ] }');
+
+-- later stages run on the fused documents
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } } } }, { "$limit": 2 }, { "$project": { "_id": 1 } } ] }');
+
+-- invalid specifications
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$match": { } }, { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "unknown": 1 } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] }, "other": 1 } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$match": { "a": 1 } } ] } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$project": { "a": 1 } } ] } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "$byA": [ { "$sort": { "a": 1 } } ] } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "by.A": [ { "$sort": { "a": 1 } } ] } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "combination": { "weights": { "byC": 1 } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "combination": { "weights": { "byA": "1" } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "combination": { "weights": { "byA": -1 } } } } ] }');
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "rank_fusion_docs", "pipeline": [ { "$rankFusion": { "input": { "pipelines": { "byA": [ { "$sort": { "a": 1 } }, { "$limit": 3 } ], "byB": [ { "$sort": { "b": 1 } }, { "$limit": 3 } ] } }, "scoreDetails": true } } ] }');
+
+RESET documentdb.enableRankFusionStage;
@@ -161,6 +161,33 @@ SELECT documentdb_api.insert('db', '{"insert":"targetWhenMatchMerge", "documents
    { "_id" : 6, "movie": "Iron Man 1", "Budget": 130000000, "year": 2013 }
 ]}');
 
+-- the same merges with the source sorted on the on fields give the same target documents
+BEGIN;
+SET LOCAL documentdb.enableSortedMergeSource TO on;
+-- As all doc from source matches with target so there should not be any change in target collection. 
+SELECT * FROM aggregate_cursor_first_page('db', '{ "aggregate": "sourceWhenMatchMerge", "pipeline": [  {"$merge" : { "into": "targetWhenMatchMerge", "whenMatched" : "merge" }} ], "cursor": { "batchSize": 1 } }', 4294967294);
+
+select document from documentdb_api.collection('db', 'targetWhenMatchMerge');
+
+-- Let's Add one more column by projection and see if it merges in target collection.
+SELECT * FROM aggregate_cursor_first_page('db', '{ "aggregate": "sourceWhenMatchMerge", 
+"pipeline": [ 
+               {"$project" : {"_id" : 1, "new_column" : "testing merge"}}, 
+               {"$merge" : { "into": "targetWhenMatchMerge", "whenMatched" : "merge" }} 
+            ], 
+"cursor": { "batchSize": 1 } }', 4294967294);
+select document from documentdb_api.collection('db', 'targetWhenMatchMerge');
+
+-- let's try to modify value of existing column of target collection. 
+SELECT * FROM aggregate_cursor_first_page('db', '{ "aggregate": "sourceWhenMatchMerge", 
+"pipeline": [ 
+               {"$project" : {"_id" : 1, "year" : {"$add" : ["$year" , 1]}}}, 
+               {"$merge" : { "into": "targetWhenMatchMerge", "whenMatched" : "merge" }} 
+            ], 
+"cursor": { "batchSize": 1 } }', 4294967294);
+select document from documentdb_api.collection('db', 'targetWhenMatchMerge');
+ROLLBACK;
+
 -- As all doc from source matches with target so there should not be any change in target collection. 
 SELECT * FROM aggregate_cursor_first_page('db', '{ "aggregate": "sourceWhenMatchMerge", "pipeline": [  {"$merge" : { "into": "targetWhenMatchMerge", "whenMatched" : "merge" }} ], "cursor": { "batchSize": 1 } }', 4294967294);
 
@@ -94,4 +94,14 @@ EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "fin
 EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "$expr": { "$lt": [ 10, "$a" ] } } }');
 
 EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "$expr": { "$lte": [ "$a", 10 ] } } }');
-EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "$expr": { "$lte": [ 10, "$a" ] } } }');
\ No newline at end of file
+EXPLAIN (COSTS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "$expr": { "$lte": [ 10, "$a" ] } } }');
+
+-- bitmap scans on a regular index with multiple scan keys can intersect a roaring bitmap per key
+SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "b": { "$in": [ 5, 50, 500, 600 ], "$gte": 50 } } }');
+SELECT regexp_replace(trim(line), 'roaringIntersectionTime: [0-9\.]+ ms', 'roaringIntersectionTime: xxx ms') AS line FROM documentdb_test_helpers.run_explain_and_trim($cmd$
+    EXPLAIN (COSTS OFF, ANALYZE ON, SUMMARY OFF, TIMING OFF, BUFFERS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "b": { "$in": [ 5, 50, 500, 600 ], "$gte": 50 } } }') $cmd$) line WHERE line ~ 'roaring';
+SET documentdb.enableRumRoaringBitmapIntersection TO on;
+SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "b": { "$in": [ 5, 50, 500, 600 ], "$gte": 50 } } }');
+SELECT regexp_replace(trim(line), 'roaringIntersectionTime: [0-9\.]+ ms', 'roaringIntersectionTime: xxx ms') AS line FROM documentdb_test_helpers.run_explain_and_trim($cmd$
+    EXPLAIN (COSTS OFF, ANALYZE ON, SUMMARY OFF, TIMING OFF, BUFFERS OFF) SELECT document FROM bson_aggregation_find('exprdb', '{ "find": "exprcoll", "filter": { "b": { "$in": [ 5, 50, 500, 600 ], "$gte": 50 } } }') $cmd$) line WHERE line ~ 'roaring';
+RESET documentdb.enableRumRoaringBitmapIntersection;
@@ -0,0 +1,30 @@
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+
+SET documentdb.next_collection_id TO 9400;
+SET documentdb.next_collection_index_id TO 9400;
+
+SELECT documentdb_api.insert_one('db', 'path_stats', '{ "_id": 1, "a": 1, "b": "x" }');
+SELECT documentdb_api.insert_one('db', 'path_stats', '{ "_id": 2, "a": 1, "b": null }');
+SELECT documentdb_api.insert_one('db', 'path_stats', '{ "_id": 3, "a": 2, "b": [ 1, 2 ] }');
+-- documents wider than the width threshold are not sampled for the path statistics
+SELECT documentdb_api.insert_one('db', 'path_stats', FORMAT('{ "_id": 4, "a": 3, "big": "%s" }', repeat('x', 1100))::documentdb_core.bson);
+
+-- without the flag ANALYZE only gathers the standard statistics
+ANALYZE documentdb_data.documents_9401;
+SELECT COUNT(*) FROM pg_statistic
+    WHERE starelid = 'documentdb_data.documents_9401'::regclass AND staattnum = (SELECT attnum FROM pg_attribute WHERE attrelid = 'documentdb_data.documents_9401'::regclass AND attname = 'document')
+    AND 10001 IN (stakind1, stakind2, stakind3, stakind4, stakind5);
+
+-- with the flag the top level paths get a statistics slot, the fractions are over all the sampled rows
+SET documentdb_core.enableBsonPathStatistics TO on;
+ANALYZE documentdb_data.documents_9401;
+SELECT unnest(CASE 10001 WHEN stakind1 THEN stavalues1::text WHEN stakind2 THEN stavalues2::text
+    WHEN stakind3 THEN stavalues3::text WHEN stakind4 THEN stavalues4::text WHEN stakind5 THEN stavalues5::text END::documentdb_core.bson[]) AS path_statistics
+    FROM pg_statistic
+    WHERE starelid = 'documentdb_data.documents_9401'::regclass AND staattnum = (SELECT attnum FROM pg_attribute WHERE attrelid = 'documentdb_data.documents_9401'::regclass AND attname = 'document')
+    ORDER BY 1;
+RESET documentdb_core.enableBsonPathStatistics;
+ANALYZE documentdb_data.documents_9401;
+SELECT COUNT(*) FROM pg_statistic
+    WHERE starelid = 'documentdb_data.documents_9401'::regclass AND staattnum = (SELECT attnum FROM pg_attribute WHERE attrelid = 'documentdb_data.documents_9401'::regclass AND attname = 'document')
+    AND 10001 IN (stakind1, stakind2, stakind3, stakind4, stakind5);
@@ -0,0 +1,39 @@
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SET documentdb.next_collection_id TO 9600;
+SET documentdb.next_collection_index_id TO 9600;
+
+
+-- the regression instance caches the collection catalog rows across backends
+SHOW documentdb.sharedCollectionCacheSize;
+SELECT documentdb_api.insert_one('shared_cache_db', 'cached_coll', '{ "_id": 1, "a": 1 }');
+SELECT document FROM bson_aggregation_find('shared_cache_db', '{ "find": "cached_coll" }');
+
+-- a new backend reads the collection from the shared cache
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_cache_db', '{ "find": "cached_coll" }');
+
+-- dropping and recreating the collection replaces its data table, new backends read the new one
+SET documentdb.next_collection_id TO 9610;
+SET documentdb.next_collection_index_id TO 9610;
+SELECT documentdb_api.drop_collection('shared_cache_db', 'cached_coll');
+SELECT documentdb_api.insert_one('shared_cache_db', 'cached_coll', '{ "_id": 2, "a": 2 }');
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_cache_db', '{ "find": "cached_coll" }');
+SELECT collection_id FROM documentdb_api_catalog.collections WHERE database_name = 'shared_cache_db' AND collection_name = 'cached_coll';
+
+-- renaming the collection is seen by new backends under both names
+SELECT documentdb_api.rename_collection('shared_cache_db', 'cached_coll', 'renamed_coll');
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_cache_db', '{ "find": "cached_coll" }');
+SELECT document FROM bson_aggregation_find('shared_cache_db', '{ "find": "renamed_coll" }');
+
+-- indexes created after the collection was cached are used by new backends
+SELECT documentdb_api_internal.create_indexes_non_concurrently('shared_cache_db', '{ "createIndexes": "renamed_coll", "indexes": [ { "key": { "a": 1 }, "name": "a_1", "unique": true } ] }', true);
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT documentdb_api.insert_one('shared_cache_db', 'renamed_coll', '{ "_id": 3, "a": 2 }');
+SELECT document FROM bson_aggregation_find('shared_cache_db', '{ "find": "renamed_coll", "filter": { "a": 2 }, "hint": "a_1" }');
+SELECT documentdb_api.drop_database('shared_cache_db');
@@ -54,3 +54,27 @@ select documentdb_api.insert_one('db', 'bsontypetests', '{"_id": [1]}');
 
 -- assert object_id matches the '_id' from the content - should be numRows.
 SELECT COUNT(*) FROM documentdb_data.documents_1001 where object_id::bson = bson_get_value(document, '_id');
+
+-- the single pass validator accepts the same documents
+SET documentdb_core.enableBsonFastValidation TO on;
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"1", "value": { "$numberInt" : "11" }, "valueMax": { "$numberInt" : "2147483647" }, "valueMin": { "$numberInt" : "-2147483648" }}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"2", "value":{"$numberLong" : "134311"}, "valueMax": { "$numberLong" : "9223372036854775807" }, "valueMin": { "$numberLong" : "-9223372036854775808" }}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"3", "value":{"$numberDouble" : "0"}, "valueMax": { "$numberDouble" : "1.7976931348623157E+308" }, "valueMin": { "$numberDouble" : "-1.7976931348623157E+308" }, "valueEpsilon": { "$numberDouble": "4.94065645841247E-324"}, "valueinfinity": {"$numberDouble":"Infinity"}}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"4", "value": "Bright stars illuminate the calm ocean during a peaceful night."}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"5", "value": {"$binary": { "base64": "U29tZVRleHRUb0VuY29kZQ==", "subType": "02"}}}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"6", "valueMin": { "$minKey": 1 }, "valueMax": { "$maxKey": 1 }}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"7", "tsField": {"$timestamp":{"t":1565545664,"i":1}}, "dateBefore1970": {"$date":{"$numberLong":"-1577923200000"}}, "dateField": {"$date":{"$numberLong":"1565546054692"}}, "oidField": {"$oid":"5d505646cf6d4fe581014ab2"}}', NULL);
+SELECT documentdb_api.insert_one('db','bsontypetests_fast','{"_id":"8", "arrayOfObject": [{ "こんにちは": "ありがとう" }, { "¿Cómo estás?": "Muy bien!" }, { "Что ты делал на этой неделе?": "Ничего" }]}', NULL);
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 9, "$field": 1}');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 10, "field": { "$subField": 1 } }');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 11, "field": [ { "$subField": 1 } ] }');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 12, ".field": 1}');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 13, "fie.ld": 1}');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 14, "field": { ".subField": 1 } }');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 15, "field": { "sub.Field": 1 } }');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": 16, "field": [ { "sub.Field": 1 } ] }');
+select documentdb_api.insert_one('db', 'bsontypetests_fast', '{"_id": {"$regex": "^A", "$options": ""}}');
+SELECT documentdb_api.insert_one('db', 'bsontypetests_fast', '{ "_id": { "a": 2, "$c": 3 } }');
+select documentdb_api.insert_one('db', 'bsontypetests_fast', '{"_id": [1]}');
+SELECT COUNT(*) FROM documentdb_api.collection('db', 'bsontypetests') a JOIN documentdb_api.collection('db', 'bsontypetests_fast') b ON a.object_id = b.object_id AND a.document = b.document;
+RESET documentdb_core.enableBsonFastValidation;
@@ -110,4 +110,30 @@ SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_cyc
 
 
 -- create with long name
-SELECT documentdb_api.create_collection_view('db', FORMAT('{ "create": "create_view_cycle_4_%s", "viewOn": "create_view_cycle_1" }', repeat('1bc', 80))::documentdb_core.bson);
\ No newline at end of file
+SELECT documentdb_api.create_collection_view('db', FORMAT('{ "create": "create_view_cycle_4_%s", "viewOn": "create_view_cycle_1" }', repeat('1bc', 80))::documentdb_core.bson);
+
+-- clustered collections
+SET documentdb.enableClusteredCollections TO on;
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "clusteredIndex": { } }');
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "clusteredIndex": { "key": { "a": 1 }, "unique": true } }');
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "clusteredIndex": { "key": { "_id": 1 } } }');
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "clusteredIndex": { "key": { "_id": 1 }, "unique": false } }');
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "clusteredIndex": { "key": { "_id": 1 }, "unique": true, "sparse": true } }');
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "viewOn": "create_view_tests_not_capped1", "clusteredIndex": { "key": { "_id": 1 }, "unique": true } }');
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered", "clusteredIndex": { "key": { "_id": 1 }, "unique": true, "name": "_id_" } }');
+SELECT c.collection_name, i.indisclustered FROM documentdb_api_catalog.collections c JOIN pg_index i ON i.indrelid = ('documentdb_data.documents_' || c.collection_id)::regclass AND i.indisprimary WHERE c.database_name = 'db' AND c.collection_name IN ('create_view_clustered', 'create_view_tests_not_capped1') ORDER BY 1;
+
+-- compact rewrites the collection in _id order
+SELECT documentdb_api.insert_one('db', 'create_view_clustered', '{ "_id": 3 }');
+SELECT documentdb_api.insert_one('db', 'create_view_clustered', '{ "_id": 1 }');
+SELECT documentdb_api.insert_one('db', 'create_view_clustered', '{ "_id": 2 }');
+DO $$
+BEGIN
+EXECUTE format('ANALYZE documentdb_data.documents_%s', (SELECT collection_id FROM documentdb_api_catalog.collections WHERE database_name = 'db' AND collection_name = 'create_view_clustered'));
+END;
+$$;
+SELECT document FROM documentdb_api.collection('db', 'create_view_clustered');
+SELECT documentdb_api.compact('{"compact": "create_view_clustered", "$db": "db"}');
+SELECT document FROM documentdb_api.collection('db', 'create_view_clustered');
+RESET documentdb.enableClusteredCollections;
+SELECT documentdb_api.create_collection_view('db', '{ "create": "create_view_clustered_2", "clusteredIndex": { "key": { "_id": 1 }, "unique": true } }');
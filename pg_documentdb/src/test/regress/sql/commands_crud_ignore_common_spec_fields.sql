@@ -53,4 +53,30 @@ select documentdb_api.insert('db', '{
 	"documents":[{"_id":2,"a":"id2"}],
 	"ordered": false,
         "bypassDocumentValidation": true,
-	"comment": "NoOp2"}');
\ No newline at end of file
+	"comment": "NoOp2"}');
+
+-- the writeConcern is ignored by default, with async commit unacknowledged and unjournaled writes don't wait for the WAL flush
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 3, "a": 3 } ], "writeConcern": { "w": 0 } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.update('db', '{ "update": "ignoreCommonSpec", "updates": [ { "q": { "_id": 1 }, "u": { "$set": { "b": 1 } } } ], "writeConcern": { "w": 0 } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 4, "a": 4 } ], "writeConcern": { "w": 1, "j": false } }');
+SET documentdb.enableAsyncCommitWriteConcern TO on;
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 5, "a": 5 } ], "writeConcern": { "w": 0 } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 6, "a": 6 } ], "writeConcern": { "w": 1, "j": false } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.update('db', '{ "update": "ignoreCommonSpec", "updates": [ { "q": { "_id": 2 }, "u": { "$set": { "b": 2 } } } ], "writeConcern": { "w": 0 } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.delete('db', '{ "delete": "ignoreCommonSpec", "deletes": [ { "q": { "_id": 6 }, "limit": 1 } ], "writeConcern": { "j": false } }');
+
+-- acknowledged, journaled and majority writes still wait for it
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 7, "a": 7 } ], "writeConcern": { "w": 1 } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 8, "a": 8 } ], "writeConcern": { "w": 0, "j": true } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.update('db', '{ "update": "ignoreCommonSpec", "updates": [ { "q": { "_id": 7 }, "u": { "$set": { "b": 7 } } } ], "writeConcern": { "w": "majority" } }');
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.delete('db', '{ "delete": "ignoreCommonSpec", "deletes": [ { "q": { "_id": 8 }, "limit": 1 } ], "writeConcern": { } }');
+
+-- the commit mode only lasts for the transaction of the write
+SHOW synchronous_commit;
+
+-- writes in multi-document transactions commit with the transaction
+BEGIN;
+SELECT p_result, current_setting('synchronous_commit') AS synchronous_commit FROM documentdb_api.insert('db', '{ "insert": "ignoreCommonSpec", "documents": [ { "_id": 9, "a": 9 } ], "writeConcern": { "w": 0 } }');
+COMMIT;
+RESET documentdb.enableAsyncCommitWriteConcern;
+SELECT document FROM bson_aggregation_pipeline('db', '{ "aggregate": "ignoreCommonSpec", "pipeline": [ { "$sort": { "_id": 1 } } ] }');
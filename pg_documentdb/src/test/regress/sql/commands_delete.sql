@@ -76,6 +76,24 @@ select documentdb_api.delete('db', '{"delete":"removeme", "deletes":[{"q":{"a":1
 select count(*) from documentdb_api.collection('db', 'removeme');
 rollback;
 
+-- unordered deleteMany operations can run as a single delete on the union of their filters
+begin;
+select documentdb_api.delete('db', '{"delete":"removeme", "deletes":[{"q":{"a":{"$lte":3}},"limit":0},{"q":{"a":{"$gte":2,"$lte":5}},"limit":0},{"q":{"_id":10},"limit":1}],"ordered":false}');
+select count(*) from documentdb_api.collection('db', 'removeme');
+rollback;
+SET documentdb.enableBatchedDeleteMany TO on;
+begin;
+select documentdb_api.delete('db', '{"delete":"removeme", "deletes":[{"q":{"a":{"$lte":3}},"limit":0},{"q":{"a":{"$gte":2,"$lte":5}},"limit":0},{"q":{"_id":10},"limit":1}],"ordered":false}');
+select count(*) from documentdb_api.collection('db', 'removeme');
+select feature_name, usage_count from documentdb_api_internal.command_feature_counter_stats(true) where feature_name = 'command_delete_many_batched';
+rollback;
+-- a batch with an invalid filter falls back to one delete at a time
+begin;
+select documentdb_api.delete('db', '{"delete":"removeme", "deletes":[{"q":{"a":1},"limit":0},{"q":{"$a":2},"limit":0},{"q":{"a":3},"limit":0}],"ordered":false}');
+select count(*) from documentdb_api.collection('db', 'removeme');
+rollback;
+RESET documentdb.enableBatchedDeleteMany;
+
 -- delete 1 without filters is supported for unsharded collections
 begin;
 select documentdb_api.delete('db', '{"delete":"removeme", "deletes":[{"q":{},"limit":1}]}');
@@ -350,6 +350,22 @@ select documentdb_api.update('db', '{"update":"updateme"}', '{ "":[{"q":{"_id":3
 select count(*) from documentdb_api.collection('db', 'updateme') where document @@ '{ "bz":2 }';
 rollback;
 
+-- batch of upserts by _id, with the _id index probed once for the batch
+begin;
+select documentdb_api.update('db', '{"update":"updateme", "updates":[{"q":{"_id":1},"u":{"$set":{"bp":1}},"upsert":true},{"q":{"_id":40},"u":{"$set":{"bp":1}},"upsert":true},{"q":{"_id":41},"u":{"$set":{"bp":1}},"upsert":true},{"q":{"_id":41},"u":{"$set":{"bp":2}},"upsert":true},{"q":{"_id":42, "a": 10},"u":{"$set":{"bp":1}},"upsert":true}]}');
+select count(*) from documentdb_api.collection('db', 'updateme') where document @@ '{ "bp": 1 }';
+select count(*) from documentdb_api.collection('db', 'updateme') where document @@ '{ "bp": 2 }';
+select document from documentdb_api.collection('db', 'updateme') where document @@ '{ "_id": { "$in": [ 40, 41 ] } }' order by object_id;
+rollback;
+
+begin;
+set local documentdb.enableBatchedUpsertProbe to on;
+select documentdb_api.update('db', '{"update":"updateme", "updates":[{"q":{"_id":1},"u":{"$set":{"bp":1}},"upsert":true},{"q":{"_id":40},"u":{"$set":{"bp":1}},"upsert":true},{"q":{"_id":41},"u":{"$set":{"bp":1}},"upsert":true},{"q":{"_id":41},"u":{"$set":{"bp":2}},"upsert":true},{"q":{"_id":42, "a": 10},"u":{"$set":{"bp":1}},"upsert":true}]}');
+select count(*) from documentdb_api.collection('db', 'updateme') where document @@ '{ "bp": 1 }';
+select count(*) from documentdb_api.collection('db', 'updateme') where document @@ '{ "bp": 2 }';
+select document from documentdb_api.collection('db', 'updateme') where document @@ '{ "_id": { "$in": [ 40, 41 ] } }' order by object_id;
+rollback;
+
 -- update with docs specified on both
 begin;
 select documentdb_api.update('db', '{"update":"updateme",  "updates":[{"q":{"_id":33, "a": 10 },"u":{"$set":{"b":2}},"multi":true,"upsert":true}]}', '{ "":[{"q":{"_id":33, "a": 10 },"u":{"$set":{"b":1}},"multi":false,"upsert":true}] }');
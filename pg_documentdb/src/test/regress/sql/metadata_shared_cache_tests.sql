@@ -0,0 +1,53 @@
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SET documentdb.next_collection_id TO 9700;
+SET documentdb.next_collection_index_id TO 9700;
+
+
+-- the regression instance shares the resolved extension OIDs across the backends of a database
+SHOW documentdb.sharedMetadataCacheSize;
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 1, "a": 1 }');
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 2, "a": 2 }');
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 3, "a": 3 }');
+SELECT document FROM bson_aggregation_find('shared_oid_db', '{ "find": "oid_coll", "filter": { "a": { "$gt": 1 } }, "projection": { "_id": 0, "a": 1 } }');
+SELECT document FROM bson_aggregation_pipeline('shared_oid_db', '{ "aggregate": "oid_coll", "pipeline": [ { "$group": { "_id": null, "total": { "$sum": "$a" } } } ] }');
+
+-- a new backend starts from the OIDs resolved by the previous one
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_oid_db', '{ "find": "oid_coll", "filter": { "a": { "$gt": 1 } }, "projection": { "_id": 0, "a": 1 } }');
+SELECT document FROM bson_aggregation_pipeline('shared_oid_db', '{ "aggregate": "oid_coll", "pipeline": [ { "$group": { "_id": null, "total": { "$sum": "$a" } } } ] }');
+
+-- recreating the extension changes the extension signature, the slot of the database is
+-- filled again with the new OIDs
+SET client_min_messages TO WARNING;
+DROP EXTENSION documentdb CASCADE;
+CREATE EXTENSION documentdb VERSION '0.108-0';
+RESET client_min_messages;
+SELECT extversion FROM pg_extension WHERE extname = 'documentdb';
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SET documentdb.next_collection_id TO 9710;
+SET documentdb.next_collection_index_id TO 9710;
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 1, "a": 1 }');
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 2, "a": 2 }');
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 3, "a": 3 }');
+SELECT document FROM bson_aggregation_find('shared_oid_db', '{ "find": "oid_coll", "filter": { "a": { "$gt": 1 } }, "projection": { "_id": 0, "a": 1 } }');
+SELECT document FROM bson_aggregation_pipeline('shared_oid_db', '{ "aggregate": "oid_coll", "pipeline": [ { "$group": { "_id": null, "total": { "$sum": "$a" } } } ] }');
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_oid_db', '{ "find": "oid_coll", "filter": { "a": { "$gt": 1 } }, "projection": { "_id": 0, "a": 1 } }');
+SELECT document FROM bson_aggregation_pipeline('shared_oid_db', '{ "aggregate": "oid_coll", "pipeline": [ { "$group": { "_id": null, "total": { "$sum": "$a" } } } ] }');
+
+-- updating the extension changes the extension signature as well
+ALTER EXTENSION documentdb UPDATE;
+SELECT extversion = default_version FROM pg_extension, pg_available_extensions WHERE extname = 'documentdb' AND name = 'documentdb';
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_oid_db', '{ "find": "oid_coll", "filter": { "a": { "$gt": 1 } }, "projection": { "_id": 0, "a": 1 } }');
+SELECT document FROM bson_aggregation_pipeline('shared_oid_db', '{ "aggregate": "oid_coll", "pipeline": [ { "$group": { "_id": null, "total": { "$sum": "$a" } } } ] }');
+SELECT documentdb_api.insert_one('shared_oid_db', 'oid_coll', '{ "_id": 4, "a": 4 }');
+\c -
+SET search_path TO documentdb_api,documentdb_core,documentdb_api_catalog;
+SELECT document FROM bson_aggregation_find('shared_oid_db', '{ "find": "oid_coll", "filter": { "a": { "$gt": 1 } }, "projection": { "_id": 0, "a": 1 } }');
+SELECT document FROM bson_aggregation_pipeline('shared_oid_db', '{ "aggregate": "oid_coll", "pipeline": [ { "$group": { "_id": null, "total": { "$sum": "$a" } } } ] }');
+SELECT documentdb_api.drop_database('shared_oid_db');
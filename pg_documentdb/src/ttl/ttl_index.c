@@ -10,10 +10,14 @@
 #include <postgres.h>
 #include <stdlib.h>
 
+#include <access/xlog.h>
 #include <catalog/namespace.h>
 #include <commands/sequence.h>
 #include <executor/spi.h>
 #include <portability/instr_time.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/hsearch.h>
 
 #include "io/bson_core.h"
 #include "metadata/collection.h"
@@ -27,6 +31,7 @@
 #include "utils/error_utils.h"
 #include "utils/index_utils.h"
 #include "utils/version_utils.h"
+#include "ttl/ttl_index.h"
 
 extern bool LogTTLProgressActivity;
 extern bool RepeatPurgeIndexesForTTLTask;
@@ -45,6 +50,14 @@ extern double TTLDeleteSaturationThreshold;
 extern int TTLSlowBatchDeleteThresholdInMS;
 extern bool EnableSelectiveTTLLogging;
 extern bool EnableTTLBatchObservability;
+extern bool EnableTTLResumeKey;
+extern int TTLIndexProgressCacheSize;
+extern int TTLTargetWalPerBatchKB;
+extern int TTLMaxReplicationLagKB;
+extern int BackgroundJobPartitionIndex;
+extern int BackgroundJobPartitionCount;
+extern bool EnableBackgroundWorker;
+extern bool EnableBackgroundWorkerTTLJob;
 
 bool UseV2TTLIndexPurger = true;
 
@@ -86,6 +99,57 @@ typedef struct TtlIndexEntry
 	char *indexName;
 } TtlIndexEntry;
 
+/* The lowest batch size the adaptive TTL batch size goes down to */
+#define TTL_MIN_ADAPTIVE_BATCH_SIZE 100
+
+/*
+ * TtlIndexProgressKey identifies a TTL index on a given shard table.
+ */
+typedef struct TtlIndexProgressKey
+{
+	/* The TTL index id */
+	uint64 indexId;
+
+	/* The shard table being pruned */
+	char shardTableName[NAMEDATALEN];
+} TtlIndexProgressKey;
+
+/*
+ * TtlIndexProgressEntry is the purge progress of a TTL index on a shard, kept in
+ * shared memory so that it survives across TTL task invocations.
+ */
+typedef struct TtlIndexProgressEntry
+{
+	/* key of the entry in the hash (must be first) */
+	TtlIndexProgressKey key;
+
+	/* Whether the ordered index scan can resume from resumeExpiry */
+	bool hasResumeKey;
+
+	/*
+	 * The sort key (in descending order) of the last document deleted by the ordered
+	 * index scan. The documents before it in the scan order were already deleted.
+	 */
+	int64 resumeExpiry;
+
+	/* The batch size adapted to the WAL generated and the replication lag (0 if none) */
+	int32 adaptiveBatchSize;
+
+	/* Cumulative number of documents deleted and time spent deleting them */
+	uint64 deletedDocuments;
+	double deleteTimeMs;
+} TtlIndexProgressEntry;
+
+typedef struct TtlIndexProgressSharedData
+{
+	int trancheId;
+	char *trancheName;
+	LWLock lock;
+} TtlIndexProgressSharedData;
+
+static TtlIndexProgressSharedData *TtlIndexProgressSharedState = NULL;
+static HTAB *TtlIndexProgressHash = NULL;
+
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
@@ -96,6 +160,15 @@ static uint64 DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *inde
 											bool *IsTaskTimeBudgetExceeded);
 static bool IsTaskTimeBudgetExceeded(instr_time startTime, double *elapsedTime, int
 									 budget);
+static void GetTtlIndexProgress(TtlIndexProgressKey *progressKey,
+								TtlIndexProgressEntry *progress);
+static double UpdateTtlIndexProgress(TtlIndexProgressKey *progressKey,
+									 TtlIndexProgressEntry *progress,
+									 uint64 rowsDeleted, double elapsedTimeMs);
+static int32 GetAdaptiveTTLBatchSize(int32 batchSize, uint64 rowsDeleted,
+									 uint64 walBytes);
+static void DeleteExpiredRows(int32 batchSize);
+static inline bool IsBackgroundWorkerTTLJobEnabled(void);
 
 /* --------------------------------------------------------- */
 /* Top level exports */
@@ -192,21 +265,52 @@ shuffle_list(List *list)
 }
 
 
-/* This is the entry point for the delete_expired_rows UDF. This is called by a background job to do the
- * TTL index purging. Basically this function does it in 2 phases.
- * 1. It gets all the TTL indexes from the documentdb_api_catalog.collection_indexes table.
- * 2. For every TTL index, gets is partial filter expression and expiration seconds, it gets the index PG table and shard tables for distributed scenarios
- *    and calls into DeleteExpiredRowsForIndexCore to delete the documents that meet the index conditions.
+/* This is the entry point for the delete_expired_rows UDF. This is called by the documentdb_ttl_task
+ * cron job to do the TTL index purging. When the partitioned background worker TTL job is enabled,
+ * the job does the purge (see delete_expired_rows_background) and this is a no-op so that every TTL
+ * index is purged once.
  */
 Datum
 delete_expired_rows(PG_FUNCTION_ARGS)
 {
-	if (!UseV2TTLIndexPurger)
+	if (!UseV2TTLIndexPurger || IsBackgroundWorkerTTLJobEnabled())
+	{
+		PG_RETURN_VOID();
+	}
+
+	DeleteExpiredRows(PG_GETARG_INT32(0));
+	PG_RETURN_VOID();
+}
+
+
+/*
+ * Drop-in replacement for delete_expired_rows. This is called periodically by the
+ * background worker framework and purges only when enableBackgroundWorkerTTLJob is set,
+ * in which case the cron job yields to it. The background worker runs it as parallel
+ * executions, each of which purges its partition of the collections.
+ */
+Datum
+delete_expired_rows_background(PG_FUNCTION_ARGS)
+{
+	if (!UseV2TTLIndexPurger || !IsBackgroundWorkerTTLJobEnabled())
 	{
 		PG_RETURN_VOID();
 	}
 
-	int32_t batchSize = PG_GETARG_INT32(0);
+	DeleteExpiredRows(PG_GETARG_INT32(0));
+	PG_RETURN_VOID();
+}
+
+
+/*
+ * DeleteExpiredRows does the TTL index purging in 2 phases.
+ * 1. It gets all the TTL indexes from the documentdb_api_catalog.collection_indexes table.
+ * 2. For every TTL index, gets is partial filter expression and expiration seconds, it gets the index PG table and shard tables for distributed scenarios
+ *    and calls into DeleteExpiredRowsForIndexCore to delete the documents that meet the index conditions.
+ */
+static void
+DeleteExpiredRows(int32 batchSize)
+{
 
 	StringInfo cmdGetIndexes = makeStringInfo();
 
@@ -217,12 +321,24 @@ delete_expired_rows(PG_FUNCTION_ARGS)
 					 "(index_spec).index_is_sparse, "
 					 "COALESCE(%s.bson_get_value_text((index_spec).index_options::%s,'enableCompositeTerm'::text)::bool, %s.bson_get_value_text((index_spec).index_options::%s, 'enableOrderedIndex'::text)::bool, false) as index_is_ordered, "
 					 "(index_spec).index_name FROM %s.collection_indexes "
-					 "WHERE index_is_valid AND (index_spec).index_expire_after_seconds >= 0 "
-					 "ORDER BY collection_id, index_id",
+					 "WHERE index_is_valid AND (index_spec).index_expire_after_seconds >= 0 ",
 					 ApiCatalogToCoreSchemaName, FullBsonTypeName,
 					 ApiCatalogToCoreSchemaName, FullBsonTypeName,
 					 ApiCatalogSchemaName);
 
+	/*
+	 * When the background worker runs the TTL task as parallel executions, each
+	 * execution only purges its partition of the collections.
+	 */
+	if (BackgroundJobPartitionCount > 1)
+	{
+		appendStringInfo(cmdGetIndexes, "AND collection_id %% %d = %d ",
+						 BackgroundJobPartitionCount,
+						 BackgroundJobPartitionIndex % BackgroundJobPartitionCount);
+	}
+
+	appendStringInfoString(cmdGetIndexes, "ORDER BY collection_id, index_id");
+
 	List *ttlIndexEntries = NIL;
 	SPIParseOpenOptions parseOptions =
 	{
@@ -355,7 +471,7 @@ delete_expired_rows(PG_FUNCTION_ARGS)
 	if (list_length(ttlIndexEntries) < 1)
 	{
 		/* No TTL indexes to cleanup. */
-		PG_RETURN_VOID();
+		return;
 	}
 
 	/* We have the TTL index records, now cleanup as much as we can in individual transactions before the time budget expires. */
@@ -579,19 +695,180 @@ end:
 	}
 
 	MemoryContextSwitchTo(oldContext);
-	PG_RETURN_VOID();
+	return;
 }
 
 
 /*
- * Drop-in replacement for delete_expired_rows. This will be called periodically by the
- * background worker framework and will coexist with the previous UDF until it reaches
- * stability.
+ * Whether the TTL purge runs as the partitioned background worker job rather than
+ * the documentdb_ttl_task cron job.
  */
-Datum
-delete_expired_rows_background(PG_FUNCTION_ARGS)
+static inline bool
+IsBackgroundWorkerTTLJobEnabled(void)
 {
-	PG_RETURN_VOID();
+	return EnableBackgroundWorker && EnableBackgroundWorkerTTLJob;
+}
+
+
+/*
+ * TtlIndexProgressShmemSize returns the shared memory needed for the
+ * TTL index purge progress.
+ */
+Size
+TtlIndexProgressShmemSize(void)
+{
+	Size size = MAXALIGN(sizeof(TtlIndexProgressSharedData));
+	if (TTLIndexProgressCacheSize > 0)
+	{
+		size = add_size(size, hash_estimate_size(TTLIndexProgressCacheSize,
+												 sizeof(TtlIndexProgressEntry)));
+	}
+
+	return size;
+}
+
+
+/*
+ * InitializeTtlIndexProgressShmem initializes the shared TTL index purge progress.
+ */
+void
+InitializeTtlIndexProgressShmem(void)
+{
+	bool found = false;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	TtlIndexProgressSharedState =
+		(TtlIndexProgressSharedData *) ShmemInitStruct(
+			"DocumentDB TTL Index Progress Data",
+			sizeof(TtlIndexProgressSharedData),
+			&found);
+
+	if (!found)
+	{
+		TtlIndexProgressSharedState->trancheId = LWLockNewTrancheId();
+		TtlIndexProgressSharedState->trancheName = "DocumentDB TTL Index Progress Tranche";
+		LWLockRegisterTranche(TtlIndexProgressSharedState->trancheId,
+							  TtlIndexProgressSharedState->trancheName);
+		LWLockInitialize(&TtlIndexProgressSharedState->lock,
+						 TtlIndexProgressSharedState->trancheId);
+	}
+
+	if (TTLIndexProgressCacheSize > 0)
+	{
+		HASHCTL info;
+		memset(&info, 0, sizeof(info));
+		info.keysize = sizeof(TtlIndexProgressKey);
+		info.entrysize = sizeof(TtlIndexProgressEntry);
+		TtlIndexProgressHash = ShmemInitHash("DocumentDB TTL Index Progress Hash",
+											 TTLIndexProgressCacheSize,
+											 TTLIndexProgressCacheSize,
+											 &info, HASH_ELEM | HASH_BLOBS);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+
+/*
+ * Copies the purge progress of the TTL index on the shard into progress (left zeroed
+ * if the index is not tracked yet).
+ */
+static void
+GetTtlIndexProgress(TtlIndexProgressKey *progressKey, TtlIndexProgressEntry *progress)
+{
+	memset(progress, 0, sizeof(TtlIndexProgressEntry));
+
+	LWLockAcquire(&TtlIndexProgressSharedState->lock, LW_SHARED);
+	TtlIndexProgressEntry *entry = hash_search(TtlIndexProgressHash, progressKey,
+											   HASH_FIND, NULL);
+	if (entry != NULL)
+	{
+		*progress = *entry;
+	}
+
+	LWLockRelease(&TtlIndexProgressSharedState->lock);
+}
+
+
+/*
+ * Publishes the resume key and the adaptive batch size in progress for the TTL index
+ * on the shard and accumulates the documents deleted by the batch. Returns the
+ * cumulative number of documents deleted per second for the index on the shard.
+ * If the progress hash is full the index is simply not tracked.
+ */
+static double
+UpdateTtlIndexProgress(TtlIndexProgressKey *progressKey, TtlIndexProgressEntry *progress,
+					   uint64 rowsDeleted, double elapsedTimeMs)
+{
+	double docsPerSecond = elapsedTimeMs > 0 ? rowsDeleted * 1000.0 / elapsedTimeMs : 0;
+
+	LWLockAcquire(&TtlIndexProgressSharedState->lock, LW_EXCLUSIVE);
+	bool found = false;
+	TtlIndexProgressEntry *entry = hash_search(TtlIndexProgressHash, progressKey,
+											   HASH_ENTER_NULL, &found);
+	if (entry != NULL)
+	{
+		if (!found)
+		{
+			entry->deletedDocuments = 0;
+			entry->deleteTimeMs = 0;
+		}
+
+		entry->hasResumeKey = progress->hasResumeKey;
+		entry->resumeExpiry = progress->resumeExpiry;
+		entry->adaptiveBatchSize = progress->adaptiveBatchSize;
+		entry->deletedDocuments += rowsDeleted;
+		entry->deleteTimeMs += elapsedTimeMs;
+
+		if (entry->deleteTimeMs > 0)
+		{
+			docsPerSecond = entry->deletedDocuments * 1000.0 / entry->deleteTimeMs;
+		}
+	}
+
+	LWLockRelease(&TtlIndexProgressSharedState->lock);
+	return docsPerSecond;
+}
+
+
+/*
+ * Returns the batch size to use for the next batch of deletes of a TTL index given
+ * the WAL generated by the current batch and the replication lag. The batch size
+ * moves towards the target WAL per batch (at most doubling per batch) and is halved
+ * while the replication lag is past the configured maximum.
+ * Returns 0 if the batch size is not adapted.
+ */
+static int32
+GetAdaptiveTTLBatchSize(int32 batchSize, uint64 rowsDeleted, uint64 walBytes)
+{
+	if (TTLTargetWalPerBatchKB <= 0 && TTLMaxReplicationLagKB <= 0)
+	{
+		return 0;
+	}
+
+	double nextBatchSize = batchSize;
+	if (TTLTargetWalPerBatchKB > 0 && rowsDeleted > 0 && walBytes > 0)
+	{
+		double walBytesPerRow = (double) walBytes / rowsDeleted;
+		nextBatchSize = Min(TTLTargetWalPerBatchKB * 1024.0 / walBytesPerRow,
+							batchSize * 2.0);
+	}
+
+	if (TTLMaxReplicationLagKB > 0 && !RecoveryInProgress())
+	{
+		bool readOnly = true;
+		bool isNull = false;
+		Datum lagDatum = ExtensionExecuteQueryViaSPI(
+			"SELECT COALESCE(max(pg_catalog.pg_wal_lsn_diff(pg_catalog.pg_current_wal_lsn(), replay_lsn)), 0)::int8"
+			" FROM pg_catalog.pg_stat_replication", readOnly, SPI_OK_SELECT, &isNull);
+		if (!isNull && DatumGetInt64(lagDatum) > TTLMaxReplicationLagKB * 1024L)
+		{
+			nextBatchSize = Min(nextBatchSize, batchSize / 2.0);
+		}
+	}
+
+	nextBatchSize = Max(nextBatchSize, TTL_MIN_ADAPTIVE_BATCH_SIZE);
+	return (int32) Min(nextBatchSize, MaxTTLDeleteBatchSize);
 }
 
 
@@ -630,6 +907,22 @@ DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *indexEntry, int64
 {
 	int32 ttlDeleteBatchSize = (batchSize != -1) ? batchSize :
 							   MaxTTLDeleteBatchSize;
+
+	TtlIndexProgressKey progressKey;
+	TtlIndexProgressEntry progress = { 0 };
+	bool trackProgress = TtlIndexProgressHash != NULL;
+	if (trackProgress)
+	{
+		memset(&progressKey, 0, sizeof(TtlIndexProgressKey));
+		progressKey.indexId = indexEntry->indexId;
+		strlcpy(progressKey.shardTableName, tableName, NAMEDATALEN);
+		GetTtlIndexProgress(&progressKey, &progress);
+
+		if (progress.adaptiveBatchSize > 0)
+		{
+			ttlDeleteBatchSize = Min(ttlDeleteBatchSize, progress.adaptiveBatchSize);
+		}
+	}
 	pgbson *indexKeyDocument = DatumGetPgBson(indexEntry->indexKeyDatum);
 	pgbson *indexPfe = (indexEntry->indexPfeDatum != (Datum) 0) ?
 					   DatumGetPgBson(indexEntry->indexPfeDatum) : NULL;
@@ -719,6 +1012,23 @@ DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *indexEntry, int64
 							 EnableIndexOrderbyPushdown &&
 							 indexEntry->indexIsOrdered;
 
+	/*
+	 *  When many documents expire at once, every batch walks the ordered index from the
+	 *  cutoff over the entries of the documents deleted by the previous batches. With a
+	 *  resume key the scan starts from the sort key of the last document deleted instead:
+	 *  the documents that come after it in the descending scan have a sort key (their
+	 *  largest value) lower or equal to it, so they all match the $lte bound.
+	 */
+	bool useResumeKey = EnableTTLResumeKey && useDescendingSort && trackProgress;
+	int resumeKeyArgIndex = -1;
+	if (useResumeKey && progress.hasResumeKey)
+	{
+		resumeKeyArgIndex = argCount;
+		argCount++;
+		appendStringInfo(cmdStrDeleteRows, " AND %s.bson_dollar_lte(document, $%d::%s)",
+						 ApiCatalogSchemaName, argCount, FullBsonTypeName);
+	}
+
 	/* Fetch the entries to be deleted in descending order if the index is orderd */
 	if (useDescendingSort)
 	{
@@ -732,10 +1042,23 @@ DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *indexEntry, int64
 	appendStringInfo(cmdStrDeleteRows, " LIMIT %d FOR UPDATE SKIP LOCKED) ",
 					 ttlDeleteBatchSize);
 
+	if (useResumeKey)
+	{
+		/* Return the lowest sort key deleted, i.e. the last one in the descending scan */
+		StringInfo cmdStrDeleteRowsWithResumeKey = makeStringInfo();
+		appendStringInfo(cmdStrDeleteRowsWithResumeKey,
+						 "WITH deleted_rows AS (%s"
+						 " RETURNING %s.bson_orderby(document, '{ \"%s\": -1 }'::%s) AS sort_key)"
+						 " SELECT count(*)::int8, %s.bsonmin(sort_key) FROM deleted_rows",
+						 cmdStrDeleteRows->data, ApiCatalogSchemaName, indexKey,
+						 FullBsonTypeName, ApiCatalogSchemaName);
+		cmdStrDeleteRows = cmdStrDeleteRowsWithResumeKey;
+	}
+
 	bool readOnly = false;
 	char *argNulls = NULL;
-	Oid argTypes[5];
-	Datum argValues[5];
+	Oid argTypes[6];
+	Datum argValues[6];
 
 	pgbson_writer writer;
 	PgbsonWriterInit(&writer);
@@ -774,6 +1097,22 @@ DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *indexEntry, int64
 		}
 	}
 
+	if (resumeKeyArgIndex >= 0)
+	{
+		pgbson_writer resumeKeyWriter;
+		PgbsonWriterInit(&resumeKeyWriter);
+		bson_value_t resumeKeyField = { 0 };
+		resumeKeyField.value_type = BSON_TYPE_DATE_TIME;
+		resumeKeyField.value.v_datetime = progress.resumeExpiry;
+		PgbsonWriterAppendValue(&resumeKeyWriter, indexKey, strlen(indexKey),
+								&resumeKeyField);
+
+		argTypes[resumeKeyArgIndex] = BYTEAOID;
+		argValues[resumeKeyArgIndex] = PointerGetDatum(CastPgbsonToBytea(
+														   PgbsonWriterGetPgbson(
+															   &resumeKeyWriter)));
+	}
+
 	SetGUCLocally(psprintf("%s.forceUseIndexIfAvailable", ApiGucPrefix), "true");
 
 	if (disableSeqAndBitmapScan)
@@ -782,15 +1121,73 @@ DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *indexEntry, int64
 		SetGUCLocally("enable_bitmapscan", "false");
 	}
 
-	uint64 rowsCount = ExtensionExecuteCappedStatementWithArgsViaSPI(
-		cmdStrDeleteRows->data,
-		argCount,
-		argTypes,
-		argValues, argNulls,
-		readOnly,
-		SPI_OK_DELETE,
-		TTLPurgerStatementTimeout, TTLPurgerLockTimeout);
+	instr_time batchStartTime;
+	INSTR_TIME_SET_CURRENT(batchStartTime);
+	XLogRecPtr walStartPtr = GetXLogInsertRecPtr();
+
+	uint64 rowsCount = 0;
+	pgbson *lastSortKey = NULL;
+	if (useResumeKey)
+	{
+		Datum results[2];
+		bool resultNulls[2];
+		ExtensionExecuteCappedMultiValueQueryWithArgsViaSPI(
+			cmdStrDeleteRows->data,
+			argCount,
+			argTypes,
+			argValues, argNulls,
+			readOnly,
+			SPI_OK_SELECT,
+			results, resultNulls, 2,
+			TTLPurgerStatementTimeout, TTLPurgerLockTimeout);
+
+		rowsCount = resultNulls[0] ? 0 : (uint64) DatumGetInt64(results[0]);
+		lastSortKey = resultNulls[1] ? NULL : DatumGetPgBson(results[1]);
+	}
+	else
+	{
+		rowsCount = ExtensionExecuteCappedStatementWithArgsViaSPI(
+			cmdStrDeleteRows->data,
+			argCount,
+			argTypes,
+			argValues, argNulls,
+			readOnly,
+			SPI_OK_DELETE,
+			TTLPurgerStatementTimeout, TTLPurgerLockTimeout);
+	}
+
+	uint64 walBytes = GetXLogInsertRecPtr() - walStartPtr;
+	instr_time batchDuration;
+	INSTR_TIME_SET_CURRENT(batchDuration);
+	INSTR_TIME_SUBTRACT(batchDuration, batchStartTime);
+	double batchDurationMs = INSTR_TIME_GET_MILLISEC(batchDuration);
 
+	double docsPerSecond = batchDurationMs > 0 ? rowsCount * 1000.0 / batchDurationMs : 0;
+	if (trackProgress)
+	{
+		/*
+		 * A partial batch means the scan reached the end of the expired documents: the
+		 * next batch starts again from the cutoff to pick up the documents that expired
+		 * since (or were skipped as locked).
+		 */
+		progress.hasResumeKey = false;
+		if (useResumeKey && lastSortKey != NULL &&
+			rowsCount >= (uint64) ttlDeleteBatchSize)
+		{
+			pgbsonelement sortKeyElement;
+			PgbsonToSinglePgbsonElement(lastSortKey, &sortKeyElement);
+			if (sortKeyElement.bsonValue.value_type == BSON_TYPE_DATE_TIME)
+			{
+				progress.hasResumeKey = true;
+				progress.resumeExpiry = sortKeyElement.bsonValue.value.v_datetime;
+			}
+		}
+
+		progress.adaptiveBatchSize = GetAdaptiveTTLBatchSize(ttlDeleteBatchSize,
+															 rowsCount, walBytes);
+		docsPerSecond = UpdateTtlIndexProgress(&progressKey, &progress, rowsCount,
+											   batchDurationMs);
+	}
 
 	double saturationRatio = 0.0;
 	double batchDeleteElapsedTime = 0.0;
@@ -867,16 +1264,18 @@ DeleteExpiredRowsForIndexCore(char *tableName, TtlIndexEntry *indexEntry, int64
 			"has_pfe=%d, isTaskTimeBudgetExceeded=%d, logFeatureCounterEvent=%d, "
 			"duration= %.2f, saturation_ratio=%.2f, "
 			"statement_timeout=%d, lock_timeout=%d, used_hints=%d, disabled_seq_scan=%d, "
-			"index_is_ordered=%d, use_desc_sort=%d",
+			"index_is_ordered=%d, use_desc_sort=%d, used_resume_key=%d, wal_bytes=%lu, "
+			"docs_per_second=%.2f",
 			(int64) rowsCount, indexEntry->collectionId,
 			shardId, indexEntry->indexId, ttlDeleteBatchSize,
 			currentTime - indexExpiryMilliseconds, LogTTLProgressActivity,
 			TTLSlowBatchDeleteThresholdInMS, TTLDeleteSaturationThreshold,
-			(argCount == 2), *isTaskTimeBudgetExceeded, logFeatureCounterEvent,
+			(indexPfe != NULL), *isTaskTimeBudgetExceeded, logFeatureCounterEvent,
 			batchDeleteElapsedTime, saturationRatio,
 			TTLPurgerStatementTimeout, TTLPurgerLockTimeout,
 			useIndexHintsForTTLQuery, disableSeqAndBitmapScan,
-			indexEntry->indexIsOrdered, useDescendingSort);
+			indexEntry->indexIsOrdered, useDescendingSort, (resumeKeyArgIndex >= 0),
+			walBytes, docsPerSecond);
 	}
 
 	if (rowsCount > 0)
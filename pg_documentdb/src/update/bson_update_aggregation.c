@@ -299,7 +299,17 @@ ProcessAggregationPipelineUpdate(pgbson *sourceDoc,
 	{
 		UpdateAggregationStageData *stageData = lfirst(stageCell);
 
+		pgbson *stageInput = finalDocument;
 		stageData->updateFunc(&finalDocument, &stageData->state);
+
+		/*
+		 * The output of a prior stage is only read by this stage, free it so that
+		 * a multi stage update doesn't hold a copy of the document per stage.
+		 */
+		if (stageInput != sourceDoc && stageInput != finalDocument)
+		{
+			pfree(stageInput);
+		}
 	}
 
 	if (isUpsert)
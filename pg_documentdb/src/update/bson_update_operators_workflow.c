@@ -28,6 +28,8 @@
 #include "utils/hashset_utils.h"
 #include "commands/commands_common.h"
 
+extern bool EnableInPlaceFixedSizeUpdates;
+
 #include "api_hooks_def.h"
 
 /* --------------------------------------------------------- */
@@ -94,6 +96,12 @@ typedef struct PositionalData
 		 */
 		BsonPositionalQueryData *positionalQueryData;
 	};
+
+	/*
+	 * For PositionalType_None, the field parsed as an array index (-1 if it
+	 * isn't one) so that it isn't parsed again for every array element.
+	 */
+	int32_t arrayIndex;
 } PositionalData;
 
 
@@ -142,6 +150,29 @@ typedef struct BsonUpdateIntermediatePathNode
 	const BsonPathNode *sourceOrTargetNodeForRenameOP;
 } BsonUpdateIntermediatePathNode;
 
+
+/* Maximum number of fields an update can patch in place */
+#define MAX_FIXED_SIZE_UPDATE_PATCHES 16
+
+/* A fixed size value to overwrite in the source document */
+typedef struct FixedSizeUpdatePatch
+{
+	/* offset of the value from the start of the document */
+	uint32_t offset;
+
+	/* the size and little endian bytes of the new value */
+	int length;
+	uint8_t bytes[16];
+} FixedSizeUpdatePatch;
+
+
+/* The values an update overwrites when it's applied in place */
+typedef struct FixedSizeUpdatePatches
+{
+	int numPatches;
+	FixedSizeUpdatePatch patches[MAX_FIXED_SIZE_UPDATE_PATCHES];
+} FixedSizeUpdatePatches;
+
 /*
  * TREE BUILDING DATA STRUCTURES
  * These are temporary stack allocated data structures used to pass information
@@ -348,6 +379,19 @@ static bool HandleUnresolvedArrayFields(const BsonUpdateIntermediatePathNode *tr
 /* Operator specific writer state functions */
 static void * HandlePullWriterGetState(const bson_value_t *tree);
 
+/* In place update functions */
+static bool TryApplyFixedSizeUpdateInPlace(pgbson *sourceDoc,
+										   const BsonUpdateIntermediatePathNode *tree,
+										   const CurrentDocumentState *state,
+										   pgbson **updatedDocument);
+static bool CollectFixedSizeUpdatePatches(const BsonIntermediatePathNode *node,
+										  const uint8_t *levelData, uint32_t levelLength,
+										  const uint8_t *documentStart,
+										  const CurrentDocumentState *state,
+										  FixedSizeUpdatePatches *patches);
+static bool IsFixedSizeUpdateOperator(WriteUpdatedValuesFunc writeFunc);
+static int GetFixedSizeValueBytes(const bson_value_t *value, uint8_t *bytes);
+
 /* Operator writer functions */
 
 static MongoUpdateOperatorSpec MongoUpdateOperators[] =
@@ -789,11 +833,25 @@ ProcessUpdateOperatorWithState(pgbson *sourceDoc,
 		.indexOfPositionalTypeQueryFilter = -1
 	};
 
+	/*
+	 * Updates that only change fixed size values to values of the same type
+	 * (e.g. a counter $inc) are applied by patching a copy of the source.
+	 */
+	pgbson *inPlaceDocument = NULL;
+	if (EnableInPlaceFixedSizeUpdates && !isUpsert && updateTracker == NULL &&
+		TryApplyFixedSizeUpdateInPlace(sourceDoc,
+									   (const BsonUpdateIntermediatePathNode *)
+									   updateState,
+									   &currentDocState, &inPlaceDocument))
+	{
+		return inPlaceDocument;
+	}
+
 	PgbsonInitIterator(sourceDoc, &docIterator);
 
-	/* Update */
+	/* Update: the updated document is usually about the size of the source */
 	pgbson_writer writer;
-	PgbsonWriterInit(&writer);
+	PgbsonWriterInitWithSizeHint(&writer, VARSIZE_ANY_EXHDR(sourceDoc));
 
 	const BsonUpdateIntermediatePathNode *updateRoot =
 		(const BsonUpdateIntermediatePathNode *) updateState;
@@ -839,6 +897,277 @@ ProcessUpdateOperatorWithState(pgbson *sourceDoc,
 }
 
 
+/*
+ * Tries to apply the update by overwriting the bytes of the values it changes
+ * in a copy of the source document. This is possible when every node of the
+ * update is a $set, $inc, $mul, $min or $max on an existing, non _id, fixed size
+ * field reached through documents only, and the new value has the same type
+ * as the existing one (so the document layout doesn't change).
+ *
+ * Returns false if the update needs to go through the regular tree rewrite.
+ * Otherwise sets updatedDocument to the patched document, or NULL if the
+ * update was a no-op.
+ */
+static bool
+TryApplyFixedSizeUpdateInPlace(pgbson *sourceDoc,
+							   const BsonUpdateIntermediatePathNode *tree,
+							   const CurrentDocumentState *state,
+							   pgbson **updatedDocument)
+{
+	if (tree->positionalData.type != PositionalType_None ||
+		tree->sourceOrTargetNodeForRenameOP != NULL)
+	{
+		return false;
+	}
+
+	const uint8_t *documentStart = (const uint8_t *) VARDATA_ANY(sourceDoc);
+	uint32_t documentLength = VARSIZE_ANY_EXHDR(sourceDoc);
+
+	FixedSizeUpdatePatches patches;
+	patches.numPatches = 0;
+	if (!CollectFixedSizeUpdatePatches(&tree->base, documentStart, documentLength,
+									   documentStart, state, &patches))
+	{
+		return false;
+	}
+
+	if (patches.numPatches == 0)
+	{
+		*updatedDocument = NULL;
+		return true;
+	}
+
+	pgbson *document = palloc(VARHDRSZ + documentLength);
+	SET_VARSIZE(document, VARHDRSZ + documentLength);
+	uint8_t *targetData = (uint8_t *) VARDATA(document);
+	memcpy(targetData, documentStart, documentLength);
+
+	for (int i = 0; i < patches.numPatches; i++)
+	{
+		FixedSizeUpdatePatch *patch = &patches.patches[i];
+		memcpy(targetData + patch->offset, patch->bytes, patch->length);
+	}
+
+	*updatedDocument = document;
+	return true;
+}
+
+
+/*
+ * Computes the new values of the leaves under the node, given the bson of
+ * the (sub) document that corresponds to the node.
+ * Returns false if any of the nodes can't be patched in place.
+ */
+static bool
+CollectFixedSizeUpdatePatches(const BsonIntermediatePathNode *node,
+							  const uint8_t *levelData, uint32_t levelLength,
+							  const uint8_t *documentStart,
+							  const CurrentDocumentState *state,
+							  FixedSizeUpdatePatches *patches)
+{
+	bool isRootLevel = levelData == documentStart;
+
+	const BsonPathNode *child;
+	foreach_child(child, node)
+	{
+		if (isRootLevel && StringViewEquals(&child->field, &IdFieldStringView))
+		{
+			/* _id updates go through the _id validation of the regular path */
+			return false;
+		}
+
+		bson_iter_t fieldIter;
+		if (!bson_iter_init_from_data(&fieldIter, levelData, levelLength) ||
+			!bson_iter_find_w_len(&fieldIter, child->field.string, child->field.length))
+		{
+			/* Adding a field changes the layout */
+			return false;
+		}
+
+		if (child->nodeType == NodeType_Intermediate)
+		{
+			const BsonUpdateIntermediatePathNode *intermediateNode =
+				CastAsUpdateIntermediateNode(child);
+			if (intermediateNode->positionalData.type != PositionalType_None ||
+				intermediateNode->sourceOrTargetNodeForRenameOP != NULL ||
+				!BSON_ITER_HOLDS_DOCUMENT(&fieldIter))
+			{
+				return false;
+			}
+
+			uint32_t childLength = 0;
+			const uint8_t *childData = NULL;
+			bson_iter_document(&fieldIter, &childLength, &childData);
+			if (!CollectFixedSizeUpdatePatches(&intermediateNode->base, childData,
+											   childLength, documentStart, state,
+											   patches))
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		if (!NodeType_IsLeaf(child->nodeType))
+		{
+			return false;
+		}
+
+		const BsonUpdateLeafNode *leafNode = CastAsUpdateLeafNode(child);
+		if (leafNode->positionalData.type != PositionalType_None ||
+			leafNode->base.fieldData.kind != AggregationExpressionKind_Constant ||
+			!IsFixedSizeUpdateOperator(leafNode->writeFunc))
+		{
+			return false;
+		}
+
+		const bson_value_t *existingValue = bson_iter_value(&fieldIter);
+		uint8_t existingBytes[16];
+		int existingLength = GetFixedSizeValueBytes(existingValue, existingBytes);
+		if (existingLength == 0)
+		{
+			return false;
+		}
+
+		pgbson_writer valueWriter;
+		PgbsonWriterInit(&valueWriter);
+		pgbson_element_writer elementWriter;
+		PgbsonInitObjectElementWriter(&valueWriter, &elementWriter, "", 0);
+
+		UpdateOperatorWriter updateWriter;
+		memset(&updateWriter, 0, sizeof(UpdateOperatorWriter));
+		updateWriter.writer = &elementWriter;
+		updateWriter.relativePath = leafNode->relativePath;
+
+		UpdateSetValueState setValueState =
+		{
+			.fieldPath = &child->field,
+			.relativePath = leafNode->relativePath,
+			.isArray = false,
+			.hasArrayAncestors = false
+		};
+
+		leafNode->writeFunc(existingValue, &updateWriter,
+							&leafNode->base.fieldData.value,
+							leafNode->updateNodeContext, &setValueState, state);
+
+		if (updateWriter.modifyType == MODIFY_TYPE_NOCHANGE)
+		{
+			continue;
+		}
+
+		bson_value_t newValue = PgbsonElementWriterGetValue(&elementWriter);
+		if (updateWriter.modifyType != MODIFY_TYPE_CHANGED ||
+			newValue.value_type != existingValue->value_type ||
+			patches->numPatches == MAX_FIXED_SIZE_UPDATE_PATCHES)
+		{
+			return false;
+		}
+
+		/* The value follows the type byte and the null terminated key */
+		FixedSizeUpdatePatch *patch = &patches->patches[patches->numPatches++];
+		patch->offset = (uint32_t) (levelData - documentStart) +
+						bson_iter_offset(&fieldIter) + 1 + child->field.length + 1;
+		patch->length = GetFixedSizeValueBytes(&newValue, patch->bytes);
+		Assert(patch->length == existingLength);
+	}
+
+	return true;
+}
+
+
+/*
+ * Whether the update operator produces a single scalar from the existing
+ * value and the update value.
+ */
+static bool
+IsFixedSizeUpdateOperator(WriteUpdatedValuesFunc writeFunc)
+{
+	return writeFunc == HandleUpdateDollarSet ||
+		   writeFunc == HandleUpdateDollarInc ||
+		   writeFunc == HandleUpdateDollarMul ||
+		   writeFunc == HandleUpdateDollarMin ||
+		   writeFunc == HandleUpdateDollarMax;
+}
+
+
+/*
+ * Writes the bson encoding of a fixed size value to bytes and returns its
+ * length, or returns 0 if the value isn't of a fixed size type.
+ */
+static int
+GetFixedSizeValueBytes(const bson_value_t *value, uint8_t *bytes)
+{
+	switch (value->value_type)
+	{
+		case BSON_TYPE_DOUBLE:
+		{
+			uint64_t bits;
+			memcpy(&bits, &value->value.v_double, sizeof(double));
+			bits = BSON_UINT64_TO_LE(bits);
+			memcpy(bytes, &bits, sizeof(uint64_t));
+			return sizeof(uint64_t);
+		}
+
+		case BSON_TYPE_INT32:
+		{
+			uint32_t bits = BSON_UINT32_TO_LE((uint32_t) value->value.v_int32);
+			memcpy(bytes, &bits, sizeof(uint32_t));
+			return sizeof(uint32_t);
+		}
+
+		case BSON_TYPE_INT64:
+		{
+			uint64_t bits = BSON_UINT64_TO_LE((uint64_t) value->value.v_int64);
+			memcpy(bytes, &bits, sizeof(uint64_t));
+			return sizeof(uint64_t);
+		}
+
+		case BSON_TYPE_DATE_TIME:
+		{
+			uint64_t bits = BSON_UINT64_TO_LE((uint64_t) value->value.v_datetime);
+			memcpy(bytes, &bits, sizeof(uint64_t));
+			return sizeof(uint64_t);
+		}
+
+		case BSON_TYPE_BOOL:
+		{
+			bytes[0] = value->value.v_bool ? 1 : 0;
+			return 1;
+		}
+
+		case BSON_TYPE_TIMESTAMP:
+		{
+			uint32_t increment = BSON_UINT32_TO_LE(value->value.v_timestamp.increment);
+			uint32_t timestamp = BSON_UINT32_TO_LE(value->value.v_timestamp.timestamp);
+			memcpy(bytes, &increment, sizeof(uint32_t));
+			memcpy(bytes + sizeof(uint32_t), &timestamp, sizeof(uint32_t));
+			return 2 * sizeof(uint32_t);
+		}
+
+		case BSON_TYPE_DECIMAL128:
+		{
+			uint64_t low = BSON_UINT64_TO_LE(value->value.v_decimal128.low);
+			uint64_t high = BSON_UINT64_TO_LE(value->value.v_decimal128.high);
+			memcpy(bytes, &low, sizeof(uint64_t));
+			memcpy(bytes + sizeof(uint64_t), &high, sizeof(uint64_t));
+			return 2 * sizeof(uint64_t);
+		}
+
+		case BSON_TYPE_OID:
+		{
+			memcpy(bytes, value->value.v_oid.bytes, sizeof(value->value.v_oid.bytes));
+			return sizeof(value->value.v_oid.bytes);
+		}
+
+		default:
+		{
+			return 0;
+		}
+	}
+}
+
+
 /*
  * Writes a modified value to the target pgbson_element_writer and marks
  * the update as modifying the original document.
@@ -1455,7 +1784,7 @@ GetNodePositionalDataFromPath(const StringView *path,
 	if (StringViewEquals(path, &PositionalType_AllString))
 	{
 		return (PositionalData) {
-				   .expression = NULL, .type = PositionalType_All
+				   .expression = NULL, .type = PositionalType_All, .arrayIndex = -1
 		};
 	}
 	else if (StringViewEquals(path, &PositionalFilterString))
@@ -1470,7 +1799,8 @@ GetNodePositionalDataFromPath(const StringView *path,
 
 		return (PositionalData) {
 				   .type = PositionalType_QueryFilter,
-				   .positionalQueryData = state->positionalSpec->processedQuerySpec
+				   .positionalQueryData = state->positionalSpec->processedQuerySpec,
+				   .arrayIndex = -1
 		};
 	}
 	else if (path->length > 3 &&
@@ -1509,12 +1839,14 @@ GetNodePositionalDataFromPath(const StringView *path,
 													 CurrentMemoryContext);
 		return (PositionalData) {
 				   .expression = expr,
-				   .type = PositionalType_ArrayFilter
+				   .type = PositionalType_ArrayFilter,
+				   .arrayIndex = -1
 		};
 	}
 
 	return (PositionalData) {
-			   .expression = NULL, .type = PositionalType_None
+			   .expression = NULL, .type = PositionalType_None,
+			   .arrayIndex = StringViewToPositiveInteger(path)
 	};
 }
 
@@ -1974,14 +2306,10 @@ IsNodeMatchForIteratorPath(const BsonPathNode *node,
 
 			if (isArray)
 			{
-				char buffer[UINT32_MAX_STR_LEN];
-				const char *key;
-				uint32_t keyLength = bson_uint32_to_string(
-					(uint32_t) state->indexOfPositionalTypeQueryFilter, &key,
-					buffer,
-					sizeof buffer);
-				StringView keyView = { .string = key, .length = keyLength };
-				return StringViewEquals(&keyView, fieldPath);
+				/* Compare the element index rather than formatting the matched index
+				 * as a key for every element of the array */
+				return StringViewToPositiveInteger(fieldPath) ==
+					   state->indexOfPositionalTypeQueryFilter;
 			}
 			else
 			{
@@ -2021,8 +2349,7 @@ IsNodeMatchForIteratorPath(const BsonPathNode *node,
 		{
 			if (isArray)
 			{
-				int32_t arrayIndex = StringViewToPositiveInteger(&node->field);
-				if (arrayIndex < 0)
+				if (positionalData->arrayIndex < 0)
 				{
 					ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
 									errmsg("Invalid array index path %.*s",
@@ -2206,8 +2533,9 @@ HandleUnresolvedArrayFields(const BsonUpdateIntermediatePathNode *tree,
 			continue;
 		}
 
-		int32_t pathIndex = StringViewToPositiveInteger(
-			&child->field);
+		int32_t pathIndex = positionalData->type == PositionalType_None ?
+							positionalData->arrayIndex :
+							StringViewToPositiveInteger(&child->field);
 
 		/* track the highest index that is requested. */
 		if (pathIndex >= 0)
@@ -38,7 +38,8 @@ static char * ExtensionExecuteQueryWithArgsViaLibPQ(char *query, char *connStr,
 													char **parameterValues);
 static void PGConnFinishIO(PGconn *conn);
 static char * PGConnReturnFirstField(PGconn *conn);
-static char * GetLocalhostConnStr(const Oid userOid, bool useSerialExecution);
+static char * GetLocalhostConnStr(const Oid userOid, bool useSerialExecution,
+								  const char *backendOptions);
 
 /*
  * ExtensionExecuteQueryViaSPI executes given query via SPI and returns first
@@ -201,6 +202,72 @@ ExtensionExecuteCappedQueryWithArgsViaSPI(const char *query, int nargs, Oid *arg
 }
 
 
+/*
+ * ExtensionExecuteCappedMultiValueQueryWithArgsViaSPI acts very same as
+ * ExtensionExecuteCappedQueryWithArgsViaSPI except that it returns the first
+ * numValues attributes of the first tuple returned.
+ */
+void
+ExtensionExecuteCappedMultiValueQueryWithArgsViaSPI(const char *query, int nargs,
+													Oid *argTypes, Datum *argValues,
+													char *argNulls, bool readOnly,
+													int expectedSPIOK, Datum *datums,
+													bool *isNull, int numValues,
+													int statementTimeout, int lockTimeout)
+{
+	int spiOptions = 0;
+	if (lockTimeout > 0 || statementTimeout > 0)
+	{
+		spiOptions = SPI_OPT_NONATOMIC;
+	}
+
+	if (SPI_connect_ext(spiOptions) != SPI_OK_CONNECT)
+	{
+		ereport(ERROR, (errmsg("could not connect to SPI manager")));
+	}
+
+	ereport(DEBUG1, (errmsg("executing \"%s\" via SPI", query)));
+
+	if (lockTimeout > 0)
+	{
+		int ret = SPI_exec(FormatSqlQuery("SET LOCAL lock_timeout TO %d", lockTimeout),
+						   0);
+		if (ret != SPI_OK_UTILITY)
+		{
+			elog(ERROR, "SPI_exec to set local lock_timeout failed: error code %d", ret);
+		}
+	}
+
+	if (statementTimeout > 0)
+	{
+		int ret = SPI_exec(FormatSqlQuery("SET LOCAL statement_timeout TO %d",
+										  statementTimeout), 0);
+		if (ret != SPI_OK_UTILITY)
+		{
+			elog(ERROR, "SPI_exec to set local statement_timeout failed: error code %d",
+				 ret);
+		}
+	}
+
+	int tupleCountLimit = 1;
+	if (SPI_execute_with_args(query, nargs, argTypes, argValues, argNulls,
+							  readOnly, tupleCountLimit) != expectedSPIOK)
+	{
+		ereport(ERROR, (errmsg("could not run SPI query")));
+	}
+
+	for (int i = 0; i < numValues; i++)
+	{
+		datums[i] = SPIReturnDatum(&isNull[i], i + 1);
+	}
+
+	if (SPI_finish() != SPI_OK_FINISH)
+	{
+		ereport(ERROR, (errmsg("could not finish SPI connection")));
+	}
+}
+
+
 /*
  * ExtensionExecuteCappedStatementWithArgsViaSPI acts very same as ExtensionExecuteQueryViaSPI
  * except that it allows passing params seperately without embedding them to
@@ -348,7 +415,8 @@ ExtensionExecuteQueryOnLocalhostViaLibPQ(char *query)
 {
 	bool useSerialExecution = false;
 	return ExtensionExecuteQueryViaLibPQ(query, GetLocalhostConnStr(InvalidOid,
-																	useSerialExecution));
+																	useSerialExecution,
+																	NULL));
 }
 
 
@@ -360,7 +428,24 @@ ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ(char *query, const Oid userOid, b
 											   useSerialExecution)
 {
 	return ExtensionExecuteQueryViaLibPQ(query, GetLocalhostConnStr(userOid,
-																	useSerialExecution));
+																	useSerialExecution,
+																	NULL));
+}
+
+
+/*
+ * Same as ExtensionExecuteQueryAsUserOnLocalhostViaLibPQ, but starts the
+ * backend with the given command-line options (e.g. "-c work_mem=64MB") so
+ * that settings apply to statements that can't run in a transaction block.
+ */
+char *
+ExtensionExecuteQueryAsUserOnLocalhostWithOptionsViaLibPQ(char *query, const Oid userOid,
+														  bool useSerialExecution,
+														  const char *backendOptions)
+{
+	return ExtensionExecuteQueryViaLibPQ(query, GetLocalhostConnStr(userOid,
+																	useSerialExecution,
+																	backendOptions));
 }
 
 
@@ -372,7 +457,8 @@ ExtensionExecuteQueryWithArgsAsUserOnLocalhostViaLibPQ(char *query, const Oid us
 {
 	bool useSerialExecution = false;
 	return ExtensionExecuteQueryWithArgsViaLibPQ(query, GetLocalhostConnStr(userOid,
-																			useSerialExecution),
+																			useSerialExecution,
+																			NULL),
 												 nParams, paramTypes, parameterValues);
 }
 
@@ -793,9 +879,12 @@ PGConnReportError(PGconn *conn, PGresult *result, int elevel)
  * GetLocalhostConnStr returns connection string to be used when connecting
  * to current database of localhost.
  * If userOid is InvalidOid, falls back to authenticated userId.
+ * backendOptions, if not NULL, are passed as the options of the connection;
+ * they come before the serial execution flags so those take precedence.
  */
 static char *
-GetLocalhostConnStr(const Oid userOid, bool useSerialExecution)
+GetLocalhostConnStr(const Oid userOid, bool useSerialExecution,
+					const char *backendOptions)
 {
 	const char *user_name;
 	const bool no_err = false;
@@ -823,6 +912,11 @@ GetLocalhostConnStr(const Oid userOid, bool useSerialExecution)
 					 get_database_name(MyDatabaseId),
 					 applicationName);
 
+	if (backendOptions != NULL)
+	{
+		appendStringInfo(localhostConnStr, " options='%s'", backendOptions);
+	}
+
 	if (useSerialExecution && SerialExecutionFlags != NULL)
 	{
 		appendStringInfoString(localhostConnStr, SerialExecutionFlags);
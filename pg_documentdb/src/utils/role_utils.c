@@ -15,6 +15,9 @@
 #include "commands/commands_common.h"
 #include "commands/parse_error.h"
 #include "libpq/scram.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
 #include "metadata/metadata_cache.h"
 #include "utils/documentdb_errors.h"
 #include "utils/documentdb_errors.h"
@@ -50,6 +53,44 @@ extern bool EnableUsersInfoPrivileges;
 /* GUC that controls whether native authentication is enabled*/
 extern bool IsNativeAuthEnabled;
 
+/* GUC that controls whether role privileges and user roles are cached */
+extern bool EnableRolePrivilegeCache;
+
+/*
+ * The consolidated privileges of a built-in role, as the elements of the
+ * "privileges" array of a document.
+ */
+typedef struct RolePrivilegesCacheEntry
+{
+	char roleName[NAMEDATALEN];
+	pgbson *privileges;
+} RolePrivilegesCacheEntry;
+
+/*
+ * The role a user is a member of, as resolved from pg_auth_members.
+ */
+typedef struct UserRoleCacheEntry
+{
+	Oid userId;
+	char parentRole[NAMEDATALEN];
+} UserRoleCacheEntry;
+
+static MemoryContext RoleCacheContext = NULL;
+
+/*
+ * The privileges of the built-in roles only depend on the static definitions
+ * below, so they are kept for the lifetime of the backend.
+ */
+static HTAB *RolePrivilegesCache = NULL;
+
+/*
+ * The roles of the users are reset by any change of pg_authid or
+ * pg_auth_members, including the ones of other backends.
+ */
+static MemoryContext UserRoleCacheContext = NULL;
+static HTAB *UserRoleCache = NULL;
+static bool UserRoleCacheValid = false;
+
 static void WriteSinglePrivilegeDocument(const ConsolidatedPrivilege *privilege,
 										 pgbson_array_writer *privilegesArrayWriter);
 static void ConsolidatePrivileges(List **consolidatedPrivileges,
@@ -64,6 +105,9 @@ static void ConsolidatePrivilegesForRole(const char *roleName,
 static void WritePrivilegeListToArray(List *consolidatedPrivileges,
 									  pgbson_array_writer *privilegesArrayWriter);
 static void DeepFreePrivileges(List *consolidatedPrivileges);
+static void InitializeRoleCache(void);
+static void InvalidateUserRoleCache(Datum argument, int cacheId, uint32 hashValue);
+static pgbson * GetCachedRolePrivileges(const char *roleName);
 
 /*
  * Static definitions for user privileges and roles
@@ -297,6 +341,24 @@ WriteSingleRolePrivileges(const char *roleName,
 						errmsg("Role name cannot be NULL.")));
 	}
 
+	if (EnableRolePrivilegeCache && strlen(roleName) < NAMEDATALEN)
+	{
+		bson_iter_t privilegesIter;
+		PgbsonInitIterator(GetCachedRolePrivileges(roleName), &privilegesIter);
+		if (bson_iter_next(&privilegesIter) && BSON_ITER_HOLDS_ARRAY(&privilegesIter))
+		{
+			bson_iter_t privilegeIter;
+			bson_iter_recurse(&privilegesIter, &privilegeIter);
+			while (bson_iter_next(&privilegeIter))
+			{
+				PgbsonArrayWriterWriteValue(privilegesArrayWriter,
+											bson_iter_value(&privilegeIter));
+			}
+		}
+
+		return;
+	}
+
 	List *consolidatedPrivileges = NIL;
 
 	ConsolidatePrivilegesForRole(roleName, &consolidatedPrivileges);
@@ -320,10 +382,24 @@ WriteMultipleRolePrivileges(HTAB *rolesTable,
 		return;
 	}
 
-	List *consolidatedPrivileges = NIL;
 	HASH_SEQ_STATUS status;
 	StringView *roleEntry;
 
+	/* The privileges of a single role are served from the role cache */
+	if (EnableRolePrivilegeCache && hash_get_num_entries(rolesTable) == 1)
+	{
+		hash_seq_init(&status, rolesTable);
+		roleEntry = hash_seq_search(&status);
+		hash_seq_term(&status);
+
+		char *roleName = pnstrdup(roleEntry->string, roleEntry->length);
+		WriteSingleRolePrivileges(roleName, privilegesArrayWriter);
+		pfree(roleName);
+		return;
+	}
+
+	List *consolidatedPrivileges = NIL;
+
 	hash_seq_init(&status, rolesTable);
 	while ((roleEntry = hash_seq_search(&status)) != NULL)
 	{
@@ -697,6 +773,48 @@ DeepFreePrivileges(List *consolidatedPrivileges)
 }
 
 
+/*
+ * Looks up the role the given user is a member of in the cache of the
+ * backend. Returns NULL if the user isn't cached.
+ */
+const char *
+GetCachedUserParentRole(Oid userId)
+{
+	if (!EnableRolePrivilegeCache)
+	{
+		return NULL;
+	}
+
+	InitializeRoleCache();
+
+	bool found = false;
+	UserRoleCacheEntry *entry = hash_search(UserRoleCache, &userId, HASH_FIND,
+											&found);
+	return found ? pstrdup(entry->parentRole) : NULL;
+}
+
+
+/*
+ * Caches the role the given user is a member of, until the next change of
+ * the roles or of their members.
+ */
+void
+CacheUserParentRole(Oid userId, const char *parentRole)
+{
+	if (!EnableRolePrivilegeCache || strlen(parentRole) >= NAMEDATALEN)
+	{
+		return;
+	}
+
+	InitializeRoleCache();
+
+	bool found = false;
+	UserRoleCacheEntry *entry = hash_search(UserRoleCache, &userId, HASH_ENTER,
+											&found);
+	strlcpy(entry->parentRole, parentRole, NAMEDATALEN);
+}
+
+
 List *
 ConvertUserOrRoleNamesDatumToList(Datum *nameDatums, int namesCount)
 {
@@ -722,3 +840,99 @@ ConvertUserOrRoleNamesDatumToList(Datum *nameDatums, int namesCount)
 
 	return namesList;
 }
+
+
+/*
+ * Creates the role caches of the backend, and resets the user roles if they
+ * were invalidated since they were cached.
+ */
+static void
+InitializeRoleCache(void)
+{
+	if (RoleCacheContext == NULL)
+	{
+		/* postgres does not always initialize CacheMemoryContext */
+		CreateCacheMemoryContext();
+
+		RoleCacheContext = AllocSetContextCreate(CacheMemoryContext,
+												 "DocumentDBRoleCacheContext",
+												 ALLOCSET_DEFAULT_SIZES);
+		UserRoleCacheContext = AllocSetContextCreate(RoleCacheContext,
+													 "DocumentDBUserRoleCacheContext",
+													 ALLOCSET_SMALL_SIZES);
+
+		HASHCTL privilegesInfo = { 0 };
+		privilegesInfo.keysize = NAMEDATALEN;
+		privilegesInfo.entrysize = sizeof(RolePrivilegesCacheEntry);
+		privilegesInfo.hcxt = RoleCacheContext;
+		RolePrivilegesCache = hash_create("DocumentDB Role Privileges Cache", 8,
+										  &privilegesInfo,
+										  HASH_ELEM | HASH_STRINGS | HASH_CONTEXT);
+
+		CacheRegisterSyscacheCallback(AUTHOID, InvalidateUserRoleCache, (Datum) 0);
+		CacheRegisterSyscacheCallback(AUTHMEMMEMROLE, InvalidateUserRoleCache,
+									  (Datum) 0);
+	}
+
+	if (!UserRoleCacheValid)
+	{
+		MemoryContextReset(UserRoleCacheContext);
+
+		HASHCTL userRoleInfo = { 0 };
+		userRoleInfo.keysize = sizeof(Oid);
+		userRoleInfo.entrysize = sizeof(UserRoleCacheEntry);
+		userRoleInfo.hcxt = UserRoleCacheContext;
+		UserRoleCache = hash_create("DocumentDB User Role Cache", 16, &userRoleInfo,
+									HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+		UserRoleCacheValid = true;
+	}
+}
+
+
+/*
+ * Syscache callback for pg_authid and pg_auth_members. The cache is only
+ * marked as invalid here since invalidations can be processed while it's
+ * in use, it's reset on its next lookup.
+ */
+static void
+InvalidateUserRoleCache(Datum argument, int cacheId, uint32 hashValue)
+{
+	UserRoleCacheValid = false;
+}
+
+
+/*
+ * Returns the consolidated privileges of a built-in role as a document
+ * { "privileges": [ ... ] }, building them on the first call for the role.
+ */
+static pgbson *
+GetCachedRolePrivileges(const char *roleName)
+{
+	InitializeRoleCache();
+
+	bool found = false;
+	RolePrivilegesCacheEntry *entry = hash_search(RolePrivilegesCache, roleName,
+												  HASH_FIND, &found);
+	if (found)
+	{
+		return entry->privileges;
+	}
+
+	List *consolidatedPrivileges = NIL;
+	ConsolidatePrivilegesForRole(roleName, &consolidatedPrivileges);
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	pgbson_array_writer privilegesArrayWriter;
+	PgbsonWriterStartArray(&writer, "privileges", 10, &privilegesArrayWriter);
+	WritePrivilegeListToArray(consolidatedPrivileges, &privilegesArrayWriter);
+	PgbsonWriterEndArray(&writer, &privilegesArrayWriter);
+	DeepFreePrivileges(consolidatedPrivileges);
+
+	pgbson *privileges = CopyPgbsonIntoMemoryContext(PgbsonWriterGetPgbson(&writer),
+													 RoleCacheContext);
+
+	entry = hash_search(RolePrivilegesCache, roleName, HASH_ENTER, &found);
+	entry->privileges = privileges;
+	return entry->privileges;
+}
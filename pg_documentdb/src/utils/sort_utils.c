@@ -14,6 +14,20 @@
 #include "utils/documentdb_errors.h"
 #include "query/bson_compare.h"
 
+/*
+ * An element along with the values of its sort keys, which are looked up
+ * once per element rather than on every comparison.
+ */
+typedef struct ElementWithSortKeys
+{
+	ElementWithIndex element;
+	bson_value_t *sortKeys;
+} ElementWithSortKeys;
+
+static void ExtractSortKeys(const bson_value_t *value, SortContext *sortContext,
+							bson_value_t *sortKeys);
+static int CompareElementsWithSortKeys(const void *a, const void *b, void *args);
+
 /**
  * Validate sort spec and set SortContext once verified
  *
@@ -221,3 +235,118 @@ CompareBsonValuesForSort(const void *a, const void *b, void *args)
 	}
 	return direction == SortDirection_Ascending ? result : -result;
 }
+
+
+/*
+ * Sorts the elements according to the sort context, like qsort_arg with
+ * CompareBsonValuesForSort. When sorting on object fields, the values of the
+ * sort keys are extracted from each element once before sorting instead of
+ * twice per comparison.
+ */
+void
+SortElementsWithIndex(ElementWithIndex *elements, int64_t numElements,
+					  SortContext *sortContext)
+{
+	if (sortContext->sortType != SortType_ObjectFieldSort || numElements < 2)
+	{
+		qsort_arg(elements, numElements, sizeof(ElementWithIndex),
+				  CompareBsonValuesForSort, sortContext);
+		return;
+	}
+
+	int numSortKeys = list_length(sortContext->sortSpecList);
+	ElementWithSortKeys *elementsWithKeys =
+		palloc(numElements * sizeof(ElementWithSortKeys));
+	bson_value_t *sortKeys = palloc(numElements * numSortKeys * sizeof(bson_value_t));
+
+	for (int64_t i = 0; i < numElements; i++)
+	{
+		elementsWithKeys[i].element = elements[i];
+		elementsWithKeys[i].sortKeys = &sortKeys[i * numSortKeys];
+		ExtractSortKeys(&elements[i].bsonValue, sortContext,
+						elementsWithKeys[i].sortKeys);
+	}
+
+	qsort_arg(elementsWithKeys, numElements, sizeof(ElementWithSortKeys),
+			  CompareElementsWithSortKeys, sortContext);
+
+	for (int64_t i = 0; i < numElements; i++)
+	{
+		elements[i] = elementsWithKeys[i].element;
+	}
+
+	pfree(sortKeys);
+	pfree(elementsWithKeys);
+}
+
+
+/*
+ * Extracts the value of each sort key of the sort context from the value.
+ * Keys that don't exist (or values that aren't documents) are treated as
+ * null, like in CompareBsonValuesForSort.
+ */
+static void
+ExtractSortKeys(const bson_value_t *value, SortContext *sortContext,
+				bson_value_t *sortKeys)
+{
+	int keyIndex = 0;
+	ListCell *sortSpecCell = NULL;
+	foreach(sortSpecCell, sortContext->sortSpecList)
+	{
+		SortSpecData *sortSpec = (SortSpecData *) lfirst(sortSpecCell);
+		bson_value_t *sortKey = &sortKeys[keyIndex++];
+		sortKey->value_type = BSON_TYPE_NULL;
+
+		if (value->value_type == BSON_TYPE_DOCUMENT)
+		{
+			bson_iter_t docIter, keyIter;
+			BsonValueInitIterator(value, &docIter);
+			if (bson_iter_find_descendant(&docIter, sortSpec->key, &keyIter))
+			{
+				*sortKey = *bson_iter_value(&keyIter);
+			}
+		}
+	}
+}
+
+
+/*
+ * Equivalent of CompareBsonValuesForSort on object fields for elements whose
+ * sort keys were extracted upfront.
+ */
+static int
+CompareElementsWithSortKeys(const void *a, const void *b, void *args)
+{
+	const ElementWithSortKeys *left = (ElementWithSortKeys *) a;
+	const ElementWithSortKeys *right = (ElementWithSortKeys *) b;
+	SortContext *sortContext = (SortContext *) args;
+	bool isCompareValid = false;
+	SortDirection direction = SortDirection_Ascending;
+	int result = 0;
+
+	int keyIndex = 0;
+	ListCell *sortSpecCell = NULL;
+	foreach(sortSpecCell, sortContext->sortSpecList)
+	{
+		SortSpecData *sortSpec = (SortSpecData *) lfirst(sortSpecCell);
+		direction = sortSpec->direction;
+		result = CompareBsonValueAndTypeWithCollation(&left->sortKeys[keyIndex],
+													  &right->sortKeys[keyIndex],
+													  &isCompareValid,
+													  sortContext->collationString);
+		if (result != 0)
+		{
+			break;
+		}
+
+		keyIndex++;
+	}
+
+	if (result == 0)
+	{
+		/* Maintain the order of original documents in case both sort fields are equal*/
+		return left->element.index - right->element.index;
+	}
+
+	return direction == SortDirection_Ascending ? result : -result;
+}
@@ -10,7 +10,9 @@
 
 
 #include <postgres.h>
+#include <math.h>
 #include <fmgr.h>
+#include <port/pg_bswap.h>
 #include <miscadmin.h>
 #include <access/reloptions.h>
 #include <executor/executor.h>
@@ -30,11 +32,35 @@
 #include "io/bson_core.h"
 #include "metadata/metadata_cache.h"
 #include "vector/bson_extract_vector.h"
+#include "vector/vector_common.h"
 
 /* --------------------------------------------------------- */
 /* Data-types */
 /* --------------------------------------------------------- */
 
+/* BSON binary subtype for packed vectors and the element types in its header */
+#define BSON_SUBTYPE_VECTOR 0x09
+#define BSON_VECTOR_DTYPE_INT8 0x03
+#define BSON_VECTOR_DTYPE_FLOAT32 0x27
+#define BSON_VECTOR_HEADER_SIZE 2
+
+/*
+ * The pgvector 'vector' type layout.
+ * Copy from pgvector/src/vector.h
+ */
+typedef struct PgVector
+{
+	int32 vl_len_;              /* varlena header (do not touch directly!) */
+	int16 dim;                  /* number of dimensions */
+	int16 unused;               /* reserved for future use, always zero */
+	float x[FLEXIBLE_ARRAY_MEMBER];
+} PgVector;
+
+#define PG_VECTOR_SIZE(_dim) (offsetof(PgVector, x) + sizeof(float) * (_dim))
+
+static Datum ExtractVectorFromBinaryVector(const bson_value_t *value, bool *isNull);
+static PgVector * AllocatePgVector(int32_t numDimensions);
+
 
 PG_FUNCTION_INFO_V1(command_bson_extract_vector);
 
@@ -80,6 +106,12 @@ command_bson_extract_vector_base(pgbson *document, char *pathStr, bool *isNull)
 		return (Datum) 0;
 	}
 
+	if (EnableVectorBinaryVectorSubtype &&
+		bson_iter_type(&documentIter) == BSON_TYPE_BINARY)
+	{
+		return ExtractVectorFromBinaryVector(bson_iter_value(&documentIter), isNull);
+	}
+
 	if (bson_iter_type(&documentIter) != BSON_TYPE_ARRAY)
 	{
 		/* We ignore non leaf arrays for the path */
@@ -110,6 +142,39 @@ command_bson_extract_vector_base(pgbson *document, char *pathStr, bool *isNull)
 		return (Datum) 0;
 	}
 
+	if (EnableVectorExtractFastPath && numElements <= VECTOR_MAX_DIMENSIONS)
+	{
+		/*
+		 * Build the vector directly instead of going through a float8[] and
+		 * array_to_vector. Non finite values fall back to that path so that
+		 * pgvector raises its usual errors.
+		 */
+		PgVector *vector = AllocatePgVector(numElements);
+		bool allFinite = true;
+
+		int index = 0;
+		currentArrayIter = documentIter;
+		while (bson_iter_next(&currentArrayIter))
+		{
+			double value = BsonValueAsDouble(bson_iter_value(&currentArrayIter));
+			vector->x[index] = (float) value;
+			if (isnan(vector->x[index]) || isinf(vector->x[index]))
+			{
+				allFinite = false;
+				break;
+			}
+
+			index++;
+		}
+
+		if (allFinite)
+		{
+			return PointerGetDatum(vector);
+		}
+
+		pfree(vector);
+	}
+
 	Datum *floatDatumArray = palloc(sizeof(Datum) * numElements);
 
 	int i = 0;
@@ -131,3 +196,91 @@ command_bson_extract_vector_base(pgbson *document, char *pathStr, bool *isNull)
 		InvalidOid, PointerGetDatum(array), Int32GetDatum(-1),
 		BoolGetDatum(false));
 }
+
+
+/*
+ * Extracts a vector from a BSON binary vector (subtype 9): a dtype byte, a
+ * padding byte and the packed elements. float32 vectors are copied as is and
+ * int8 vectors are widened. Other element types (e.g. packed bits) and
+ * malformed values are ignored like non vector values.
+ */
+static Datum
+ExtractVectorFromBinaryVector(const bson_value_t *value, bool *isNull)
+{
+	*isNull = true;
+	if (value->value.v_binary.subtype != BSON_SUBTYPE_VECTOR ||
+		value->value.v_binary.data_len <= BSON_VECTOR_HEADER_SIZE)
+	{
+		return (Datum) 0;
+	}
+
+	const uint8_t *data = value->value.v_binary.data;
+	uint32_t dataLength = value->value.v_binary.data_len - BSON_VECTOR_HEADER_SIZE;
+	const uint8_t *elements = data + BSON_VECTOR_HEADER_SIZE;
+
+	PgVector *vector = NULL;
+	if (data[0] == BSON_VECTOR_DTYPE_FLOAT32)
+	{
+		if (dataLength % sizeof(float) != 0 ||
+			dataLength / sizeof(float) > VECTOR_MAX_DIMENSIONS)
+		{
+			return (Datum) 0;
+		}
+
+		int32_t numDimensions = dataLength / sizeof(float);
+		vector = AllocatePgVector(numDimensions);
+
+		/* BSON is little endian, same as what the vector is stored as here */
+#ifdef WORDS_BIGENDIAN
+		for (int i = 0; i < numDimensions; i++)
+		{
+			uint32 element;
+			memcpy(&element, elements + i * sizeof(float), sizeof(float));
+			element = pg_bswap32(element);
+			memcpy(&vector->x[i], &element, sizeof(float));
+		}
+#else
+		memcpy(vector->x, elements, dataLength);
+#endif
+
+		for (int i = 0; i < numDimensions; i++)
+		{
+			if (isnan(vector->x[i]) || isinf(vector->x[i]))
+			{
+				pfree(vector);
+				return (Datum) 0;
+			}
+		}
+	}
+	else if (data[0] == BSON_VECTOR_DTYPE_INT8)
+	{
+		if (dataLength > VECTOR_MAX_DIMENSIONS)
+		{
+			return (Datum) 0;
+		}
+
+		vector = AllocatePgVector(dataLength);
+		for (uint32_t i = 0; i < dataLength; i++)
+		{
+			vector->x[i] = (float) ((int8) elements[i]);
+		}
+	}
+	else
+	{
+		return (Datum) 0;
+	}
+
+	*isNull = false;
+	return PointerGetDatum(vector);
+}
+
+
+static PgVector *
+AllocatePgVector(int32_t numDimensions)
+{
+	Size size = PG_VECTOR_SIZE(numDimensions);
+	PgVector *vector = (PgVector *) palloc0(size);
+	SET_VARSIZE(vector, size);
+	vector->dim = numDimensions;
+	return vector;
+}
@@ -97,6 +97,12 @@ static pgbson * CalculateIVFSearchParamBson(bytea *indexOptions, Cardinality ind
 static pgbson * CalculateHNSWSearchParamBson(bytea *indexOptions, Cardinality indexRows,
 											 pgbson *searchParamBson);
 
+static pgbson * ParseTargetRecallSearchSpec(bson_iter_t *specIter, pgbson *searchSpec);
+
+static double GetTargetRecallFromSearchParam(pgbson *searchParamBson);
+
+static const char * GetSingleSearchOptionName(pgbson *searchSpec);
+
 static VectorIndexCompressionType ExtractIVFCompressionType(bytea *indexOptions);
 
 static VectorIndexCompressionType ExtractHNSWCompressionType(bytea *indexOptions);
@@ -525,8 +531,9 @@ ParseIVFIndexSearchSpec(const VectorSearchOptions *vectorSearchOptions)
 			{
 				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
 								errmsg("Only one search option can be specified. "
-									   "You have specified options nProbes already,"
-									   " and the second option nProbes is not allowed.")));
+									   "You have specified options %s already,"
+									   " and the second option nProbes is not allowed.",
+									   GetSingleSearchOptionName(searchSpec))));
 			}
 
 			pgbson_writer writer;
@@ -535,6 +542,10 @@ ParseIVFIndexSearchSpec(const VectorSearchOptions *vectorSearchOptions)
 										&specIter), value);
 			searchSpec = PgbsonWriterGetPgbson(&writer);
 		}
+		else if (strcmp(key, VECTOR_PARAMETER_NAME_TARGET_RECALL) == 0)
+		{
+			searchSpec = ParseTargetRecallSearchSpec(&specIter, searchSpec);
+		}
 	}
 
 	return searchSpec;
@@ -601,8 +612,9 @@ ParseHNSWIndexSearchSpec(const VectorSearchOptions *vectorSearchOptions)
 			{
 				ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
 								errmsg("Only one search option can be specified. "
-									   "You have specified options efSearch already, "
-									   "and the second option efSearch is not allowed.")));
+									   "You have specified options %s already, "
+									   "and the second option efSearch is not allowed.",
+									   GetSingleSearchOptionName(searchSpec))));
 			}
 
 			pgbson_writer writer;
@@ -611,6 +623,10 @@ ParseHNSWIndexSearchSpec(const VectorSearchOptions *vectorSearchOptions)
 										&specIter), value);
 			searchSpec = PgbsonWriterGetPgbson(&writer);
 		}
+		else if (strcmp(key, VECTOR_PARAMETER_NAME_TARGET_RECALL) == 0)
+		{
+			searchSpec = ParseTargetRecallSearchSpec(&specIter, searchSpec);
+		}
 	}
 
 	return searchSpec;
@@ -620,6 +636,78 @@ ParseHNSWIndexSearchSpec(const VectorSearchOptions *vectorSearchOptions)
 /* --------------------------------------------------------- */
 /* Private methods */
 /* --------------------------------------------------------- */
+
+/*
+ * Returns the name of the search option in a search spec that has a
+ * single option.
+ */
+static const char *
+GetSingleSearchOptionName(pgbson *searchSpec)
+{
+	bson_iter_t specIter;
+	PgbsonInitIterator(searchSpec, &specIter);
+	return bson_iter_next(&specIter) ? bson_iter_key(&specIter) : "";
+}
+
+
+/*
+ * Parses the targetRecall search option: the recall (0, 1] the nProbes or
+ * efSearch of the search are derived from at planning time. This is an
+ * alternative to specifying the index specific option.
+ */
+static pgbson *
+ParseTargetRecallSearchSpec(bson_iter_t *specIter, pgbson *searchSpec)
+{
+	if (!BSON_ITER_HOLDS_NUMBER(specIter))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg("$targetRecall must be a number value.")));
+	}
+
+	double targetRecall = BsonValueAsDouble(bson_iter_value(specIter));
+	if (!(targetRecall > 0 && targetRecall <= 1))
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE),
+						errmsg(
+							"$targetRecall must be greater than 0 and less than or equal to 1.")));
+	}
+
+	if (searchSpec != NULL)
+	{
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_FAILEDTOPARSE),
+						errmsg("Only one search option can be specified. "
+							   "You have specified options %s already, "
+							   "and the second option targetRecall is not allowed.",
+							   GetSingleSearchOptionName(searchSpec))));
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterAppendDouble(&writer, VECTOR_PARAMETER_NAME_TARGET_RECALL,
+							 VECTOR_PARAMETER_NAME_TARGET_RECALL_STR_LEN,
+							 targetRecall);
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * Returns the targetRecall in the search params, or -1 if it is not set.
+ */
+static double
+GetTargetRecallFromSearchParam(pgbson *searchParamBson)
+{
+	bson_iter_t documentIterator;
+	if (searchParamBson != NULL &&
+		PgbsonInitIteratorAtPath(searchParamBson, VECTOR_PARAMETER_NAME_TARGET_RECALL,
+								 &documentIterator))
+	{
+		return BsonValueAsDouble(bson_iter_value(&documentIterator));
+	}
+
+	return -1;
+}
+
+
 static pgbson *
 CalculateIVFSearchParamBson(bytea *indexOptions, Cardinality indexRows,
 							pgbson *searchParamBson)
@@ -649,10 +737,29 @@ CalculateIVFSearchParamBson(bytea *indexOptions, Cardinality indexRows,
 	}
 
 	int defaultNumProbes = -1;
+	double targetRecall = GetTargetRecallFromSearchParam(searchParamBson);
 	if (numLists <= 0)
 	{
 		defaultNumProbes = IVFFLAT_DEFAULT_NPROBES;
 	}
+	else if (targetRecall > 0)
+	{
+		/*
+		 * Probing sqrt(lists) clusters gives around VECTOR_REFERENCE_RECALL, and
+		 * each further reduction of the missed neighbors by the same factor
+		 * needs as many probes again. A recall of 1 probes all the lists.
+		 */
+		if (targetRecall >= 1)
+		{
+			defaultNumProbes = numLists;
+		}
+		else
+		{
+			double probes = sqrt(numLists) * log(1 - targetRecall) /
+							log(1 - VECTOR_REFERENCE_RECALL);
+			defaultNumProbes = (int) Min(Max(ceil(probes), 1), numLists);
+		}
+	}
 	else
 	{
 		if (EnableVectorCalculateDefaultSearchParameter)
@@ -734,7 +841,30 @@ CalculateHNSWSearchParamBson(bytea *indexOptions, Cardinality indexRows,
 	}
 
 	int defaultEfSearch = -1;
-	if (efConstruction < 0)
+	double targetRecall = GetTargetRecallFromSearchParam(searchParamBson);
+	if (targetRecall > 0)
+	{
+		/*
+		 * The default efSearch gives around VECTOR_REFERENCE_RECALL on an index of
+		 * VECTOR_SEARCH_SMALL_COLLECTION_ROWS rows. Each further reduction of the
+		 * missed neighbors by the same factor needs as many candidates again, and
+		 * larger graphs need more candidates (log scale) for the same recall.
+		 */
+		if (targetRecall >= 1)
+		{
+			defaultEfSearch = HNSW_MAX_EF_SEARCH;
+		}
+		else
+		{
+			double sizeFactor = Max(log10(Max(indexRows, 1)) /
+									log10(VECTOR_SEARCH_SMALL_COLLECTION_ROWS), 1);
+			double efSearch = HNSW_DEFAULT_EF_SEARCH * sizeFactor *
+							  log(1 - targetRecall) / log(1 - VECTOR_REFERENCE_RECALL);
+			defaultEfSearch = (int) Min(Max(ceil(efSearch), HNSW_MIN_EF_SEARCH),
+										HNSW_MAX_EF_SEARCH);
+		}
+	}
+	else if (efConstruction < 0)
 	{
 		defaultEfSearch = HNSW_DEFAULT_EF_SEARCH;
 	}
@@ -23,6 +23,7 @@ void ParseAndGetCollationString(const bson_value_t *collationValue,
 								const char *collationString);
 char * GetCollationSortKey(const char *collationString, char *key, int keyLength);
 
+void PrewarmCollatorCache(const char *collationList);
 int StringCompareWithCollation(const char *left, uint32_t leftLength,
 							   const char *right, uint32_t rightLength, const
 							   char *collationStr);
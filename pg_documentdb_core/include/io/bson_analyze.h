@@ -0,0 +1,43 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * include/io/bson_analyze.h
+ *
+ * Declarations of the per-path statistics gathered by ANALYZE on bson columns.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef BSON_ANALYZE_H
+#define BSON_ANALYZE_H
+
+/*
+ * pg_statistic kind of the per-path statistics slot of a bson column.
+ * Kinds 1-99 are reserved for Postgres and 100-299 for PostGIS and ESRI,
+ * so this is picked outside of those.
+ *
+ * The slot holds one bson document per top level path of the sampled
+ * documents, of the form:
+ * {
+ *   "p": <path>,
+ *   "e": <fraction of documents that have the path>,
+ *   "a": <fraction of documents where the path is an array>,
+ *   "n": <fraction of documents where the path is null>,
+ *   "d": <number of distinct non null values (array elements included)>,
+ *   "mcv": [ <most common values> ],
+ *   "mcf": [ <fraction of documents matching each of them> ],
+ *   "h": [ <histogram bounds of the remaining values> ]
+ * }
+ */
+#define STATISTIC_KIND_BSON_PATH_STATISTICS 10001
+
+#define BSON_PATH_STATISTICS_PATH "p"
+#define BSON_PATH_STATISTICS_EXISTS_FRACTION "e"
+#define BSON_PATH_STATISTICS_ARRAY_FRACTION "a"
+#define BSON_PATH_STATISTICS_NULL_FRACTION "n"
+#define BSON_PATH_STATISTICS_DISTINCT_COUNT "d"
+#define BSON_PATH_STATISTICS_MCV "mcv"
+#define BSON_PATH_STATISTICS_MCV_FREQUENCIES "mcf"
+#define BSON_PATH_STATISTICS_HISTOGRAM "h"
+
+#endif
@@ -73,6 +73,7 @@ bool IsBsonHexadecimalString(const char *string);
 
 /* input functions from various sources (json string, buffers, bytea) */
 pgbson * PgbsonInitFromJson(const char *jsonString);
+pgbson * PgbsonInitFromJsonWithLength(const char *jsonString, ssize_t jsonLength);
 pgbson * PgbsonInitFromBuffer(const char *buffer, uint32_t bufferLength);
 pgbson * PgbsonCloneFromPgbson(const pgbson *bson);
 pgbson * PgbsonInitEmpty(void);
@@ -120,6 +121,24 @@ pgbson * PgbsonDeduplicateFields(const pgbson *document);
 List * PgbsonDecomposeFields(const pgbson *document);
 void PgbsonGetBsonValueAtPath(const pgbson *bson, const char *path, bson_value_t *value);
 
+/*
+ * State of an enclosing field offset cache scope, restored by
+ * PgbsonFieldOffsetCacheEnd.
+ */
+typedef struct PgbsonFieldOffsetCacheScope
+{
+	const pgbson *previousDocument;
+	uint64_t generation;
+} PgbsonFieldOffsetCacheScope;
+
+/* Field offset cache for repeated top level field lookups on a document */
+PgbsonFieldOffsetCacheScope PgbsonFieldOffsetCacheBegin(const pgbson *document);
+void PgbsonFieldOffsetCacheEnd(PgbsonFieldOffsetCacheScope scope);
+void PgbsonFieldOffsetCacheSetDocument(const pgbson *document);
+void PgbsonFieldOffsetCacheRelease(const pgbson *document);
+void PgbsonFieldOffsetCacheReset(void);
+bool PgbsonIterFindWithFieldCache(bson_iter_t *iter, const char *key, uint32_t keyLength);
+
 /*
  * Validate if the pgbson is an empty document.
  * Note that the bson spec (https://bsonspec.org/spec.html) implies that an array has
@@ -62,6 +62,7 @@ typedef struct pgbson_element_writer
 
 
 void PgbsonWriterInit(pgbson_writer *writer);
+void PgbsonWriterInitWithSizeHint(pgbson_writer *writer, uint32_t sizeHint);
 uint32_t PgbsonWriterGetSize(pgbson_writer *writer);
 uint32_t PgbsonArrayWriterGetSize(pgbson_array_writer *writer);
 void PgbsonWriterCopyToBuffer(pgbson_writer *writer, uint8_t *buffer, uint32_t length);
@@ -158,6 +159,8 @@ void PgbsonWriterConcat(pgbson_writer *writer, const pgbson *document);
 void PgbsonWriterConcatWriter(pgbson_writer *writer, pgbson_writer *writerToConcat);
 void PgbsonWriterConcatBytes(pgbson_writer *writer, const uint8_t *bsonBytes, uint32_t
 							 bsonBytesLength);
+void PgbsonWriterAppendRawElements(pgbson_writer *writer, const uint8_t *elements,
+								   uint32_t elementsLength);
 
 uint32_t PgbsonArrayWriterGetIndex(pgbson_array_writer *arrayWriter);
 bool IsPgbsonWriterEmptyDocument(pgbson_writer *writer);
@@ -30,4 +30,28 @@
 
 #endif
 
+#if PG_VERSION_NUM >= 180000
+#define ExecInitRangeTable_Compat(estate, rangeTable, permInfos) \
+	ExecInitRangeTable(estate, rangeTable, permInfos, \
+					   bms_add_range(NULL, 1, list_length(rangeTable)))
+#elif PG_VERSION_NUM >= 160000
+#define ExecInitRangeTable_Compat(estate, rangeTable, permInfos) \
+	ExecInitRangeTable(estate, rangeTable, permInfos)
+#else
+#define ExecInitRangeTable_Compat(estate, rangeTable, permInfos) \
+	ExecInitRangeTable(estate, rangeTable)
+#endif
+
+#if PG_VERSION_NUM >= 160000
+#define ExecInsertIndexTuples_Compat(resultRelInfo, slot, estate, update, noDupErr, \
+									 specConflict, arbiterIndexes) \
+	ExecInsertIndexTuples(resultRelInfo, slot, estate, update, noDupErr, specConflict, \
+						  arbiterIndexes, false)
+#else
+#define ExecInsertIndexTuples_Compat(resultRelInfo, slot, estate, update, noDupErr, \
+									 specConflict, arbiterIndexes) \
+	ExecInsertIndexTuples(resultRelInfo, slot, estate, update, noDupErr, specConflict, \
+						  arbiterIndexes)
+#endif
+
 #endif
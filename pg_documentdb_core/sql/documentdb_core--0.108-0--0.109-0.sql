@@ -1 +1,3 @@
-#include "udfs/bson_io/bson_io--0.109-0.sql"
\ No newline at end of file
+#include "udfs/bson_io/bson_io--0.109-0.sql"
+#include "udfs/bson_btree/bson_btree--0.109-0.sql"
+#include "schema/btree_opclass_sort_support--0.109-0.sql"
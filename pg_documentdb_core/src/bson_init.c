@@ -45,6 +45,26 @@ bool EnableCollation = DEFAULT_ENABLE_COLLATION;
 #define DEFAULT_SKIP_BSON_ARRAY_TRAVERSE_OPTIMIZATION false
 bool SkipBsonArrayTraverseOptimization = DEFAULT_SKIP_BSON_ARRAY_TRAVERSE_OPTIMIZATION;
 
+/* GUC controlling whether top level field lookups are served from the field offset cache */
+#define DEFAULT_ENABLE_BSON_FIELD_OFFSET_CACHE false
+bool EnableBsonFieldOffsetCache = DEFAULT_ENABLE_BSON_FIELD_OFFSET_CACHE;
+
+/* GUC controlling whether writers reserve their buffer based on the size hint given */
+#define DEFAULT_ENABLE_BSON_WRITER_SIZE_HINT false
+bool EnableBsonWriterSizeHint = DEFAULT_ENABLE_BSON_WRITER_SIZE_HINT;
+
+/* GUC controlling whether input bson is validated by the single pass validator first */
+#define DEFAULT_ENABLE_BSON_FAST_VALIDATION false
+bool EnableBsonFastValidation = DEFAULT_ENABLE_BSON_FAST_VALIDATION;
+
+/* GUC controlling whether ANALYZE gathers per-path statistics on bson columns */
+#define DEFAULT_ENABLE_BSON_PATH_STATISTICS false
+bool EnableBsonPathStatistics = DEFAULT_ENABLE_BSON_PATH_STATISTICS;
+
+/* GUC listing the ICU collation strings whose collators are opened at startup */
+#define DEFAULT_COLLATION_PREWARM_LIST ""
+char *CollationPrewarmList = DEFAULT_COLLATION_PREWARM_LIST;
+
 /* --------------------------------------------------------- */
 /* Top level exports */
 /* --------------------------------------------------------- */
@@ -91,6 +111,46 @@ InitDocumentDBCoreConfigurations(const char *prefix)
 		NULL, &SkipBsonArrayTraverseOptimization,
 		DEFAULT_SKIP_BSON_ARRAY_TRAVERSE_OPTIMIZATION,
 		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBsonFieldOffsetCache", prefix),
+		gettext_noop(
+			"Determines whether top level field lookups on a document being evaluated reuse the offsets of previously found fields."),
+		NULL, &EnableBsonFieldOffsetCache,
+		DEFAULT_ENABLE_BSON_FIELD_OFFSET_CACHE,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBsonWriterSizeHint", prefix),
+		gettext_noop(
+			"Determines whether bson writers reserve their buffer upfront from the size of the input document."),
+		NULL, &EnableBsonWriterSizeHint,
+		DEFAULT_ENABLE_BSON_WRITER_SIZE_HINT,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBsonFastValidation", prefix),
+		gettext_noop(
+			"Determines whether input bson is validated in a single pass before falling back to libbson."),
+		NULL, &EnableBsonFastValidation,
+		DEFAULT_ENABLE_BSON_FAST_VALIDATION,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomBoolVariable(
+		psprintf("%s.enableBsonPathStatistics", prefix),
+		gettext_noop(
+			"Determines whether ANALYZE gathers statistics of the top level paths of bson columns."),
+		NULL, &EnableBsonPathStatistics,
+		DEFAULT_ENABLE_BSON_PATH_STATISTICS,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomStringVariable(
+		psprintf("%s.collationPrewarmList", prefix),
+		gettext_noop(
+			"Comma separated list of ICU collation strings whose collators are opened when the library is loaded, so backends do not open them on first use."),
+		NULL, &CollationPrewarmList,
+		DEFAULT_COLLATION_PREWARM_LIST,
+		PGC_POSTMASTER, 0, NULL, NULL, NULL);
 }
 
 
@@ -19,6 +19,8 @@
 #include <unicode/umachine.h>
 #include <utils/pg_locale.h>
 #include <common/hashfn.h>
+#include <nodes/pg_list.h>
+#include <utils/varlena.h>
 
 #include "io/bson_core.h"
 #include "lib/stringinfo.h"
@@ -242,7 +244,17 @@ char supported_locale_codes[ALPHABET_SIZE][ALPHABET_SIZE] = {
 
 static HTAB *collation_cache = NULL;
 
+/*
+ * The last collation looked up in the collator cache. Comparisons of a sort or
+ * a query almost always use the same collation so this avoids hashing the
+ * collation string on every comparison.
+ */
+static char last_collation_string[MAX_ICU_COLLATION_LENGTH + 1] = { 0 };
+static ucollator_cache_entry *last_collation_entry = NULL;
+
 static ucollator_cache_entry * LookupUCollatorCache(const char *collationString);
+static void EnsureUCollatorCache(void);
+static UCollator * OpenUCollator(const char *collationString, bool missingOk);
 static void GenerateICULocaleAndExtractCollationOption(char *inputLocale, char **locale,
 													   char **collationOptionString);
 
@@ -888,49 +900,154 @@ LookupUCollatorCache(const char *collationString)
 	ucollator_cache_entry *cache_entry;
 	bool found;
 
-	if (collation_cache == NULL)
+	if (last_collation_entry != NULL &&
+		strcmp(last_collation_string, collationString) == 0)
 	{
-		/* First time through, initialize the hash table */
-		HASHCTL ctl;
-		memset(&ctl, 0, sizeof(ctl));
-
-		ctl.keysize = sizeof(char *);
-		ctl.entrysize = sizeof(ucollator_cache_entry);
-
-		MemoryContext tempContext = AllocSetContextCreate(CurrentMemoryContext,
-														  "Collation Context",
-														  ALLOCSET_DEFAULT_SIZES);
-
-		MemoryContext oldContext = MemoryContextSwitchTo(tempContext);
-		collation_cache = hash_create("Collator cache", 100, &ctl,
-									  HASH_ELEM | HASH_BLOBS);
-		MemoryContextSwitchTo(oldContext);
+		return last_collation_entry;
 	}
 
+	EnsureUCollatorCache();
+
 	unsigned long collationKey = djb2(collationString);
 
-	cache_entry = hash_search(collation_cache, &collationKey, HASH_ENTER, &found);
+	cache_entry = hash_search(collation_cache, &collationKey, HASH_FIND, &found);
 	if (!found)
 	{
+		/* Open the collator first so that a failure does not leave an empty entry */
+		bool missingOk = false;
+		UCollator *collator = OpenUCollator(collationString, missingOk);
+
+		cache_entry = hash_search(collation_cache, &collationKey, HASH_ENTER, &found);
 		cache_entry->collationKey = collationKey;
-		UErrorCode status = U_ZERO_ERROR;
-		UCollator *collator = ucol_open(collationString, &status);
+		cache_entry->collator = collator;
+	}
 
-		if (U_FAILURE(status))
+	if (strlen(collationString) <= MAX_ICU_COLLATION_LENGTH)
+	{
+		strcpy(last_collation_string, collationString);
+		last_collation_entry = cache_entry;
+	}
+
+	return cache_entry;
+}
+
+
+/*
+ * PrewarmCollatorCache opens the collators of a comma separated list of ICU
+ * collation strings (e.g. "en-u-ks-level2,fr-u-ks-level1") into the collator
+ * cache. It is called from _PG_init, so when the library is preloaded the
+ * collators are opened once in the postmaster and every backend forked from
+ * it starts with them instead of opening them on its first comparison.
+ */
+void
+PrewarmCollatorCache(const char *collationList)
+{
+	if (collationList == NULL || collationList[0] == '\0')
+	{
+		return;
+	}
+
+	char *rawList = pstrdup(collationList);
+	List *collationStrings = NIL;
+	if (!SplitGUCList(rawList, ',', &collationStrings))
+	{
+		ereport(WARNING, (errmsg("invalid list syntax of the collations to prewarm: %s",
+								 collationList)));
+		return;
+	}
+
+	EnsureUCollatorCache();
+
+	ListCell *collationCell;
+	foreach(collationCell, collationStrings)
+	{
+		const char *collationString = lfirst(collationCell);
+		if (!IsCollationValid(collationString) || IsSimpleCollation(collationString))
 		{
-			ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
-							errmsg(
-								"Collation is not supported by ICU for collation language tag: %s",
-								collationString),
-							errdetail_log(
-								"Collation is not supported by ICU for collation language tag: %s",
-								collationString)));
+			continue;
 		}
 
+		unsigned long collationKey = djb2(collationString);
+		bool found;
+		hash_search(collation_cache, &collationKey, HASH_FIND, &found);
+		if (found)
+		{
+			continue;
+		}
+
+		bool missingOk = true;
+		UCollator *collator = OpenUCollator(collationString, missingOk);
+		if (collator == NULL)
+		{
+			ereport(WARNING, (errmsg("skipping the prewarm of unsupported collation %s",
+									 collationString)));
+			continue;
+		}
+
+		ucollator_cache_entry *cache_entry = hash_search(collation_cache, &collationKey,
+														 HASH_ENTER, &found);
+		cache_entry->collationKey = collationKey;
 		cache_entry->collator = collator;
 	}
 
-	return cache_entry;
+	list_free(collationStrings);
+	pfree(rawList);
+}
+
+
+static void
+EnsureUCollatorCache(void)
+{
+	if (collation_cache != NULL)
+	{
+		return;
+	}
+
+	/* First time through, initialize the hash table */
+	HASHCTL ctl;
+	memset(&ctl, 0, sizeof(ctl));
+
+	ctl.keysize = sizeof(char *);
+	ctl.entrysize = sizeof(ucollator_cache_entry);
+
+	MemoryContext tempContext = AllocSetContextCreate(CurrentMemoryContext,
+													  "Collation Context",
+													  ALLOCSET_DEFAULT_SIZES);
+
+	MemoryContext oldContext = MemoryContextSwitchTo(tempContext);
+	collation_cache = hash_create("Collator cache", 100, &ctl,
+								  HASH_ELEM | HASH_BLOBS);
+	MemoryContextSwitchTo(oldContext);
+}
+
+
+/*
+ * Opens the ICU collator of a collation string. Returns NULL if ICU does
+ * not support it and missingOk is set, errors otherwise.
+ */
+static UCollator *
+OpenUCollator(const char *collationString, bool missingOk)
+{
+	UErrorCode status = U_ZERO_ERROR;
+	UCollator *collator = ucol_open(collationString, &status);
+
+	if (U_FAILURE(status))
+	{
+		if (missingOk)
+		{
+			return NULL;
+		}
+
+		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_INTERNALERROR),
+						errmsg(
+							"Collation is not supported by ICU for collation language tag: %s",
+							collationString),
+						errdetail_log(
+							"Collation is not supported by ICU for collation language tag: %s",
+							collationString)));
+	}
+
+	return collator;
 }
 
 
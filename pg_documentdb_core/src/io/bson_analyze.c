@@ -11,19 +11,428 @@
 
 #include <postgres.h>
 #include <fmgr.h>
+#include <access/detoast.h>
 #include <commands/vacuum.h>
+#include <utils/hsearch.h>
+
+#include "io/bson_core.h"
+#include "io/bson_analyze.h"
+#include "query/bson_compare.h"
+#include "utils/type_cache.h"
+
+/* Paths longer than this are not tracked */
+#define MAX_STATISTICS_PATH_LENGTH 63
+
+/* Maximum number of top level paths tracked per column */
+#define MAX_STATISTICS_PATHS 64
+
+/* Number of most common values and histogram bounds kept per path */
+#define NUM_PATH_MCV 10
+#define NUM_PATH_HISTOGRAM_BOUNDS 11
+
+/*
+ * Documents wider than this are not sampled for the per-path statistics, as
+ * the standard statistics do with WIDTH_THRESHOLD (see analyze.c). This keeps
+ * the memory used by the sampled values bounded.
+ */
+#define PATH_STATISTICS_WIDTH_THRESHOLD 1024
+
+extern bool EnableBsonPathStatistics;
+
+/*
+ * State kept between bson_typanalyze and the compute_stats callback:
+ * the standard callback and its state run first.
+ */
+typedef struct BsonAnalyzeData
+{
+	AnalyzeAttrComputeStatsFunc stdComputeStats;
+
+	void *stdExtraData;
+} BsonAnalyzeData;
+
+/* Values sampled for a single top level path */
+typedef struct BsonPathSample
+{
+	/* the path (hash key, must be first) */
+	char path[MAX_STATISTICS_PATH_LENGTH + 1];
+
+	/* number of sampled documents that have the path */
+	int documentCount;
+
+	/* number of sampled documents where the path is an array */
+	int arrayCount;
+
+	/* number of sampled documents where the path is null */
+	int nullCount;
+
+	/* copies of the non null values of the path (array elements included) */
+	bson_value_t *values;
+	int valueCount;
+	int valueCapacity;
+} BsonPathSample;
+
+/* A run of equal values in the sorted values of a path */
+typedef struct BsonValueRun
+{
+	int start;
+	int count;
+	bool isMostCommon;
+} BsonValueRun;
+
+static void ComputeBsonStats(VacAttrStatsP stats, AnalyzeAttrFetchFunc fetchfunc,
+							 int samplerows, double totalrows);
+static void AddPathSampleValue(BsonPathSample *sample, const bson_value_t *value,
+							   int maxValues);
+static pgbson * BuildPathStatistics(BsonPathSample *sample, int samplerows);
+static int CompareBsonValuesForSort(const void *left, const void *right);
+static int CompareRunsByCount(const void *left, const void *right);
 
 PG_FUNCTION_INFO_V1(bson_typanalyze);
 
 
 /*
  * Implement type analyze for bson.
- * Right now thunks to the default - but in the future
- * will be extended to support more.
+ * The standard statistics are gathered on the documents and, when
+ * enableBsonPathStatistics is on, per-path statistics of the top level
+ * fields of the documents are added in a separate slot
+ * (see STATISTIC_KIND_BSON_PATH_STATISTICS).
  */
 Datum
 bson_typanalyze(PG_FUNCTION_ARGS)
 {
 	VacAttrStats *stats = (VacAttrStats *) PG_GETARG_POINTER(0);
-	PG_RETURN_BOOL(std_typanalyze(stats));
+	if (!std_typanalyze(stats))
+	{
+		PG_RETURN_BOOL(false);
+	}
+
+	if (EnableBsonPathStatistics)
+	{
+		BsonAnalyzeData *analyzeData = palloc(sizeof(BsonAnalyzeData));
+		analyzeData->stdComputeStats = stats->compute_stats;
+		analyzeData->stdExtraData = stats->extra_data;
+		stats->compute_stats = ComputeBsonStats;
+		stats->extra_data = analyzeData;
+	}
+
+	PG_RETURN_BOOL(true);
+}
+
+
+/*
+ * Computes the standard statistics of the column and then the per-path
+ * statistics into the first free slot.
+ */
+static void
+ComputeBsonStats(VacAttrStatsP stats, AnalyzeAttrFetchFunc fetchfunc,
+				 int samplerows, double totalrows)
+{
+	BsonAnalyzeData *analyzeData = (BsonAnalyzeData *) stats->extra_data;
+	stats->extra_data = analyzeData->stdExtraData;
+	analyzeData->stdComputeStats(stats, fetchfunc, samplerows, totalrows);
+	stats->extra_data = analyzeData;
+
+	int slot = 0;
+	while (slot < STATISTIC_NUM_SLOTS && stats->stakind[slot] != 0)
+	{
+		slot++;
+	}
+
+	if (!stats->stats_valid || slot == STATISTIC_NUM_SLOTS)
+	{
+		return;
+	}
+
+	HASHCTL hashInfo;
+	memset(&hashInfo, 0, sizeof(hashInfo));
+	hashInfo.keysize = MAX_STATISTICS_PATH_LENGTH + 1;
+	hashInfo.entrysize = sizeof(BsonPathSample);
+	hashInfo.hcxt = CurrentMemoryContext;
+	HTAB *pathSamples = hash_create("Bson path statistics", MAX_STATISTICS_PATHS,
+									&hashInfo, HASH_ELEM | HASH_STRINGS | HASH_CONTEXT);
+
+	/* Bound the values of a path so that large arrays don't blow up the sample */
+	int maxValuesPerPath = samplerows * 4;
+
+	for (int rowIndex = 0; rowIndex < samplerows; rowIndex++)
+	{
+		vacuum_delay_point();
+
+		bool isNull = false;
+		Datum value = fetchfunc(stats, rowIndex, &isNull);
+		if (isNull || toast_raw_datum_size(value) > PATH_STATISTICS_WIDTH_THRESHOLD)
+		{
+			continue;
+		}
+
+		/* The sampled values are copied, so the document is freed once it is walked */
+		pgbson *document = DatumGetPgBson(value);
+		bson_iter_t documentIter;
+		PgbsonInitIterator(document, &documentIter);
+		while (bson_iter_next(&documentIter))
+		{
+			const char *path = bson_iter_key(&documentIter);
+			if (bson_iter_key_len(&documentIter) > MAX_STATISTICS_PATH_LENGTH)
+			{
+				continue;
+			}
+
+			bool found = false;
+			BsonPathSample *sample = hash_search(pathSamples, path, HASH_FIND, &found);
+			if (!found)
+			{
+				if (hash_get_num_entries(pathSamples) >= MAX_STATISTICS_PATHS)
+				{
+					continue;
+				}
+
+				sample = hash_search(pathSamples, path, HASH_ENTER, &found);
+				sample->documentCount = 0;
+				sample->arrayCount = 0;
+				sample->nullCount = 0;
+				sample->valueCount = 0;
+				sample->valueCapacity = 0;
+				sample->values = NULL;
+			}
+
+			sample->documentCount++;
+			const bson_value_t *fieldValue = bson_iter_value(&documentIter);
+			if (fieldValue->value_type == BSON_TYPE_NULL)
+			{
+				sample->nullCount++;
+			}
+			else if (fieldValue->value_type == BSON_TYPE_ARRAY)
+			{
+				/* Queries on the path match the elements, so those are sampled */
+				sample->arrayCount++;
+				bson_iter_t arrayIter;
+				BsonValueInitIterator(fieldValue, &arrayIter);
+				while (bson_iter_next(&arrayIter))
+				{
+					AddPathSampleValue(sample, bson_iter_value(&arrayIter),
+									   maxValuesPerPath);
+				}
+			}
+			else
+			{
+				AddPathSampleValue(sample, fieldValue, maxValuesPerPath);
+			}
+		}
+
+		if ((Pointer) document != DatumGetPointer(value))
+		{
+			pfree(document);
+		}
+	}
+
+	int numPaths = hash_get_num_entries(pathSamples);
+	if (numPaths == 0)
+	{
+		hash_destroy(pathSamples);
+		return;
+	}
+
+	MemoryContext oldContext = MemoryContextSwitchTo(stats->anl_context);
+	Datum *pathStatistics = palloc(numPaths * sizeof(Datum));
+	MemoryContextSwitchTo(oldContext);
+
+	int pathIndex = 0;
+	HASH_SEQ_STATUS status;
+	BsonPathSample *sample;
+	hash_seq_init(&status, pathSamples);
+	while ((sample = hash_seq_search(&status)) != NULL)
+	{
+		pgbson *statistics = BuildPathStatistics(sample, samplerows);
+
+		oldContext = MemoryContextSwitchTo(stats->anl_context);
+		pgbson *statisticsCopy = palloc(VARSIZE(statistics));
+		memcpy(statisticsCopy, statistics, VARSIZE(statistics));
+		MemoryContextSwitchTo(oldContext);
+
+		pathStatistics[pathIndex++] = PointerGetDatum(statisticsCopy);
+	}
+
+	hash_destroy(pathSamples);
+
+	stats->stakind[slot] = STATISTIC_KIND_BSON_PATH_STATISTICS;
+	stats->staop[slot] = InvalidOid;
+	stats->stacoll[slot] = InvalidOid;
+	stats->stavalues[slot] = pathStatistics;
+	stats->numvalues[slot] = numPaths;
+	stats->statypid[slot] = BsonTypeId();
+	stats->statyplen[slot] = -1;
+	stats->statypbyval[slot] = false;
+	stats->statypalign[slot] = TYPALIGN_INT;
+}
+
+
+/*
+ * Adds a copy of a non null value to the sampled values of a path.
+ */
+static void
+AddPathSampleValue(BsonPathSample *sample, const bson_value_t *value, int maxValues)
+{
+	if (value->value_type == BSON_TYPE_NULL || sample->valueCount >= maxValues)
+	{
+		return;
+	}
+
+	if (sample->valueCount == sample->valueCapacity)
+	{
+		sample->valueCapacity = sample->valueCapacity == 0 ? 64 :
+								sample->valueCapacity * 2;
+		sample->values = sample->values == NULL ?
+						 palloc(sample->valueCapacity * sizeof(bson_value_t)) :
+						 repalloc(sample->values,
+								  sample->valueCapacity * sizeof(bson_value_t));
+	}
+
+	bson_value_copy(value, &sample->values[sample->valueCount++]);
+}
+
+
+/*
+ * Builds the statistics document of a path from its sampled values. The most
+ * common values are the most frequent values that occur more than once, the
+ * histogram is built (equi-depth) on the values that remain.
+ */
+static pgbson *
+BuildPathStatistics(BsonPathSample *sample, int samplerows)
+{
+	if (sample->valueCount > 1)
+	{
+		qsort(sample->values, sample->valueCount, sizeof(bson_value_t),
+			  CompareBsonValuesForSort);
+	}
+
+	/* Collapse the sorted values into runs of equal values */
+	BsonValueRun *runs = palloc(Max(sample->valueCount, 1) * sizeof(BsonValueRun));
+	int runCount = 0;
+	for (int i = 0; i < sample->valueCount; i++)
+	{
+		if (runCount > 0 &&
+			CompareBsonValuesForSort(&sample->values[runs[runCount - 1].start],
+									 &sample->values[i]) == 0)
+		{
+			runs[runCount - 1].count++;
+			continue;
+		}
+
+		runs[runCount].start = i;
+		runs[runCount].count = 1;
+		runs[runCount].isMostCommon = false;
+		runCount++;
+	}
+
+	BsonValueRun **runsByCount = palloc(Max(runCount, 1) * sizeof(BsonValueRun *));
+	for (int i = 0; i < runCount; i++)
+	{
+		runsByCount[i] = &runs[i];
+	}
+
+	if (runCount > 1)
+	{
+		qsort(runsByCount, runCount, sizeof(BsonValueRun *), CompareRunsByCount);
+	}
+
+	pgbson_writer writer;
+	PgbsonWriterInit(&writer);
+	PgbsonWriterAppendUtf8(&writer, BSON_PATH_STATISTICS_PATH, -1, sample->path);
+	PgbsonWriterAppendDouble(&writer, BSON_PATH_STATISTICS_EXISTS_FRACTION, -1,
+							 (double) sample->documentCount / samplerows);
+	PgbsonWriterAppendDouble(&writer, BSON_PATH_STATISTICS_ARRAY_FRACTION, -1,
+							 (double) sample->arrayCount / samplerows);
+	PgbsonWriterAppendDouble(&writer, BSON_PATH_STATISTICS_NULL_FRACTION, -1,
+							 (double) sample->nullCount / samplerows);
+	PgbsonWriterAppendDouble(&writer, BSON_PATH_STATISTICS_DISTINCT_COUNT, -1,
+							 (double) runCount);
+
+	int mostCommonCount = 0;
+	while (mostCommonCount < Min(runCount, NUM_PATH_MCV) &&
+		   runsByCount[mostCommonCount]->count > 1)
+	{
+		runsByCount[mostCommonCount]->isMostCommon = true;
+		mostCommonCount++;
+	}
+
+	pgbson_array_writer arrayWriter;
+	PgbsonWriterStartArray(&writer, BSON_PATH_STATISTICS_MCV, -1, &arrayWriter);
+	for (int i = 0; i < mostCommonCount; i++)
+	{
+		PgbsonArrayWriterWriteValue(&arrayWriter,
+									&sample->values[runsByCount[i]->start]);
+	}
+	PgbsonWriterEndArray(&writer, &arrayWriter);
+
+	int mostCommonValueCount = 0;
+	PgbsonWriterStartArray(&writer, BSON_PATH_STATISTICS_MCV_FREQUENCIES, -1,
+						   &arrayWriter);
+	for (int i = 0; i < mostCommonCount; i++)
+	{
+		bson_value_t frequency = {
+			.value_type = BSON_TYPE_DOUBLE,
+			.value.v_double = (double) runsByCount[i]->count / samplerows
+		};
+		PgbsonArrayWriterWriteValue(&arrayWriter, &frequency);
+		mostCommonValueCount += runsByCount[i]->count;
+	}
+	PgbsonWriterEndArray(&writer, &arrayWriter);
+
+	/* The histogram bounds are picked at equal distances over the remaining values */
+	int remainingCount = sample->valueCount - mostCommonValueCount;
+	int boundCount = Min(remainingCount, NUM_PATH_HISTOGRAM_BOUNDS);
+	PgbsonWriterStartArray(&writer, BSON_PATH_STATISTICS_HISTOGRAM, -1, &arrayWriter);
+	if (boundCount > 1)
+	{
+		int runIndex = 0;
+		int remainingBeforeRun = 0;
+		for (int boundIndex = 0; boundIndex < boundCount; boundIndex++)
+		{
+			int position = (int) ((int64) boundIndex * (remainingCount - 1) /
+								  (boundCount - 1));
+			while (runs[runIndex].isMostCommon ||
+				   remainingBeforeRun + runs[runIndex].count <= position)
+			{
+				if (!runs[runIndex].isMostCommon)
+				{
+					remainingBeforeRun += runs[runIndex].count;
+				}
+
+				runIndex++;
+			}
+
+			PgbsonArrayWriterWriteValue(&arrayWriter,
+										&sample->values[runs[runIndex].start]);
+		}
+	}
+	PgbsonWriterEndArray(&writer, &arrayWriter);
+
+	pfree(runsByCount);
+	pfree(runs);
+	return PgbsonWriterGetPgbson(&writer);
+}
+
+
+/*
+ * qsort comparator of bson values in the bson sort order.
+ */
+static int
+CompareBsonValuesForSort(const void *left, const void *right)
+{
+	bool isComparisonValid = false;
+	return CompareBsonValueAndType((const bson_value_t *) left,
+								   (const bson_value_t *) right,
+								   &isComparisonValid);
+}
+
+
+/*
+ * qsort comparator of value runs, by descending count.
+ */
+static int
+CompareRunsByCount(const void *left, const void *right)
+{
+	const BsonValueRun *leftRun = *(const BsonValueRun *const *) left;
+	const BsonValueRun *rightRun = *(const BsonValueRun *const *) right;
+	return rightRun->count - leftRun->count;
 }
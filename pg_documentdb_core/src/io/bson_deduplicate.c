@@ -10,6 +10,7 @@
 #include <postgres.h>
 #include <fmgr.h>
 #include <miscadmin.h>
+#include <common/hashfn.h>
 #include <nodes/pg_list.h>
 #include <utils/hsearch.h>
 
@@ -17,11 +18,26 @@
 #include "utils/hashset_utils.h"
 
 
+/*
+ * Documents with up to this many fields are checked for duplicates with an
+ * open addressing table on the stack, wider ones use a hash set.
+ */
+#define DEDUPLICATE_INLINE_FIELD_COUNT 32
+#define DEDUPLICATE_INLINE_SLOT_COUNT 64
+
+typedef struct FieldNameSlot
+{
+	const char *name;
+	uint32_t length;
+} FieldNameSlot;
+
 /*
  * Other helper functions.
  */
 static pgbson * PgbsonDeduplicateFieldsHandleDocumentIter(bson_iter_t *documentIter);
 static bson_value_t PgbsonDeduplicateFieldsRecurseArrayElements(bson_iter_t *arrayIter);
+static bool BsonDocumentHasDuplicateFields(bson_iter_t *documentIter);
+static bool BsonArrayHasDuplicateFields(bson_iter_t *arrayIter);
 
 
 PG_FUNCTION_INFO_V1(bson_deduplicate_fields);
@@ -58,6 +74,14 @@ pgbson *
 PgbsonDeduplicateFields(const pgbson *document)
 {
 	bson_iter_t iter;
+	PgbsonInitIterator(document, &iter);
+
+	/* Documents almost never have duplicate fields, so they are returned as is */
+	if (!BsonDocumentHasDuplicateFields(&iter))
+	{
+		return (pgbson *) document;
+	}
+
 	PgbsonInitIterator(document, &iter);
 	return PgbsonDeduplicateFieldsHandleDocumentIter(&iter);
 }
@@ -197,3 +221,122 @@ PgbsonDeduplicateFieldsRecurseArrayElements(bson_iter_t *arrayIter)
 	PgbsonToSinglePgbsonElement(PgbsonWriterGetPgbson(&singleElementDocWriter), &element);
 	return element.bsonValue;
 }
+
+
+/*
+ * BsonDocumentHasDuplicateFields returns whether the document or any document
+ * nested in it has the same field more than once, without building anything.
+ */
+static bool
+BsonDocumentHasDuplicateFields(bson_iter_t *documentIter)
+{
+	check_stack_depth();
+
+	FieldNameSlot slots[DEDUPLICATE_INLINE_SLOT_COUNT] = { 0 };
+	HTAB *fieldNameHashSet = NULL;
+	int fieldCount = 0;
+	bool hasDuplicates = false;
+
+	while (!hasDuplicates && bson_iter_next(documentIter))
+	{
+		const char *name = bson_iter_key(documentIter);
+		uint32_t length = bson_iter_key_len(documentIter);
+
+		if (fieldCount == DEDUPLICATE_INLINE_FIELD_COUNT)
+		{
+			/* Move the fields seen so far to a hash set for wide documents */
+			fieldNameHashSet = CreatePgbsonElementHashSet();
+			for (int i = 0; i < DEDUPLICATE_INLINE_SLOT_COUNT; i++)
+			{
+				if (slots[i].name != NULL)
+				{
+					PgbsonElementHashEntry entry = { 0 };
+					entry.element.path = slots[i].name;
+					entry.element.pathLength = slots[i].length;
+					hash_search(fieldNameHashSet, &entry, HASH_ENTER, NULL);
+				}
+			}
+		}
+
+		if (fieldNameHashSet != NULL)
+		{
+			PgbsonElementHashEntry entry = { 0 };
+			entry.element.path = name;
+			entry.element.pathLength = length;
+
+			bool found = false;
+			hash_search(fieldNameHashSet, &entry, HASH_ENTER, &found);
+			hasDuplicates = found;
+		}
+		else
+		{
+			uint32 slot = hash_bytes((const unsigned char *) name, (int) length) &
+						  (DEDUPLICATE_INLINE_SLOT_COUNT - 1);
+			while (slots[slot].name != NULL)
+			{
+				if (slots[slot].length == length &&
+					memcmp(slots[slot].name, name, length) == 0)
+				{
+					hasDuplicates = true;
+					break;
+				}
+
+				slot = (slot + 1) & (DEDUPLICATE_INLINE_SLOT_COUNT - 1);
+			}
+
+			slots[slot].name = name;
+			slots[slot].length = length;
+		}
+
+		fieldCount++;
+
+		if (!hasDuplicates && BSON_ITER_HOLDS_DOCUMENT(documentIter))
+		{
+			bson_iter_t innerDocumentIter;
+			bson_iter_recurse(documentIter, &innerDocumentIter);
+			hasDuplicates = BsonDocumentHasDuplicateFields(&innerDocumentIter);
+		}
+		else if (!hasDuplicates && BSON_ITER_HOLDS_ARRAY(documentIter))
+		{
+			bson_iter_t arrayIter;
+			bson_iter_recurse(documentIter, &arrayIter);
+			hasDuplicates = BsonArrayHasDuplicateFields(&arrayIter);
+		}
+	}
+
+	if (fieldNameHashSet != NULL)
+	{
+		hash_destroy(fieldNameHashSet);
+	}
+
+	return hasDuplicates;
+}
+
+
+/*
+ * BsonArrayHasDuplicateFields returns whether any document nested in the
+ * array has the same field more than once.
+ */
+static bool
+BsonArrayHasDuplicateFields(bson_iter_t *arrayIter)
+{
+	check_stack_depth();
+
+	while (bson_iter_next(arrayIter))
+	{
+		if (BSON_ITER_HOLDS_DOCUMENT(arrayIter) || BSON_ITER_HOLDS_ARRAY(arrayIter))
+		{
+			bson_iter_t innerIter;
+			bson_iter_recurse(arrayIter, &innerIter);
+			bool hasDuplicates = BSON_ITER_HOLDS_DOCUMENT(arrayIter) ?
+								 BsonDocumentHasDuplicateFields(&innerIter) :
+								 BsonArrayHasDuplicateFields(&innerIter);
+			if (hasDuplicates)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
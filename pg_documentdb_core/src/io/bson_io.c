@@ -153,9 +153,10 @@ bson_hex_to_bson(PG_FUNCTION_ARGS)
 Datum
 bson_json_to_bson(PG_FUNCTION_ARGS)
 {
-	text *jsonText = PG_GETARG_TEXT_P(0);
-	const char *jsonString = text_to_cstring(jsonText);
-	pgbson *bson = PgbsonInitFromJson(jsonString);
+	/* Parse the text in place, without a null terminated copy */
+	text *jsonText = PG_GETARG_TEXT_PP(0);
+	pgbson *bson = PgbsonInitFromJsonWithLength(VARDATA_ANY(jsonText),
+												VARSIZE_ANY_EXHDR(jsonText));
 	PG_RETURN_POINTER(bson);
 }
 
@@ -13,6 +13,7 @@
 #include <lib/stringinfo.h>
 #include <utils/timestamp.h>
 #include <utils/json.h>
+#include <mb/pg_wchar.h>
 
 #define PRIVATE_PGBSON_H
 #include "io/pgbson.h"
@@ -30,9 +31,78 @@ static pgbson * CreatePgbsonfromBson_t(bson_t *document, bool destroyDocument);
 
 static pgbson * CreatePgbsonfromBsonBytes(const uint8_t *rawbytes, uint32_t length);
 
+static void AppendBsonValueForShellLogging(StringInfo str, const bson_value_t *bson);
+
 static const char *BsonHexPrefix = "BSONHEX";
 static const uint32_t BsonHexPrefixLength = 7;
 
+/*
+ * The maximum number of top level fields tracked by the field offset cache.
+ * Lookups on fields past this fall back to walking the document.
+ */
+#define FIELD_OFFSET_CACHE_MAX_FIELDS 256
+
+/*
+ * A top level field of the active document along with an iterator
+ * positioned on it.
+ */
+typedef struct FieldOffsetCacheEntry
+{
+	const char *key;
+	uint32_t keyLength;
+	bson_iter_t iterator;
+} FieldOffsetCacheEntry;
+
+/*
+ * Index of the top level fields of the document that is currently being
+ * evaluated. The index is built lazily: a lookup only walks the document
+ * up to the field it needs and later lookups continue the walk from there.
+ */
+typedef struct FieldOffsetCache
+{
+	/* The document the index is built on (NULL if none) */
+	const pgbson *document;
+
+	/* The fields seen so far in document order */
+	int numFields;
+	FieldOffsetCacheEntry fields[FIELD_OFFSET_CACHE_MAX_FIELDS];
+
+	/* Iterator positioned on the last field indexed */
+	bson_iter_t walkIterator;
+
+	/* Whether the walk reached the end of the document */
+	bool walkComplete;
+
+	/* Whether the field count exceeded FIELD_OFFSET_CACHE_MAX_FIELDS */
+	bool walkTruncated;
+
+	/* Bumped every time a document is released */
+	uint64_t generation;
+} FieldOffsetCache;
+
+extern bool EnableBsonFieldOffsetCache;
+extern bool EnableBsonWriterSizeHint;
+extern bool EnableBsonFastValidation;
+
+/* Size hints are capped to the maximum size of a document */
+#define PGBSON_WRITER_MAX_SIZE_HINT (16 * 1024 * 1024)
+
+static FieldOffsetCache FieldCache = { 0 };
+
+static bool FindDescendantWithFieldCache(bson_iter_t *documentIterator,
+										 const char *path, bson_iter_t *iterator);
+static bool IsFieldCacheRootIterator(const bson_iter_t *iter);
+static void ResetFieldCacheIndex(const pgbson *document);
+
+/*
+ * Nesting depth past which the fast validation defers to libbson.
+ */
+#define FAST_VALIDATE_MAX_DEPTH 100
+
+static bool TryFastValidateBsonBytes(const uint8_t *documentBytes,
+									 uint32_t documentBytesLength,
+									 bool validateUtf8, int depth);
+
 
 /* --------------------------------------------------------- */
 /* pgbson functions */
@@ -193,10 +263,22 @@ PgbsonToHexadecimalString(const pgbson *bsonDocument)
  */
 pgbson *
 PgbsonInitFromJson(const char *jsonString)
+{
+	return PgbsonInitFromJsonWithLength(jsonString, -1);
+}
+
+
+/*
+ * Initializes a pgbson structure from an extended json syntax string of
+ * the given length, which doesn't need to be null terminated. -1 means the
+ * string is null terminated.
+ */
+pgbson *
+PgbsonInitFromJsonWithLength(const char *jsonString, ssize_t jsonLength)
 {
 	bson_t bson;
 	bson_error_t error;
-	bool parseResult = bson_init_from_json(&bson, jsonString, -1, &error);
+	bool parseResult = bson_init_from_json(&bson, jsonString, jsonLength, &error);
 	if (!parseResult)
 	{
 		ereport(ERROR, (errcode(ERRCODE_DOCUMENTDB_BADVALUE), errmsg(
@@ -262,6 +344,9 @@ BsonValueToJsonForLoggingCore(const bson_value_t *value, bool quoteStrings)
 			{
 				StringInfoData strData;
 				initStringInfo(&strData);
+
+				/* Reserve room for the string and its quotes, escapes are rare */
+				enlargeStringInfo(&strData, value->value.v_utf8.len + 2);
 				escape_json(&strData, value->value.v_utf8.str);
 				returnValue = strData.data;
 			}
@@ -304,7 +389,7 @@ BsonValueToJsonForLoggingCore(const bson_value_t *value, bool quoteStrings)
 		{
 			char finalString[BSON_DECIMAL128_STRING];
 			bson_decimal128_to_string(&(value->value.v_decimal128), finalString);
-			returnValue = pnstrdup(finalString, strlen(finalString));
+			returnValue = pstrdup(finalString);
 			break;
 		}
 
@@ -324,8 +409,13 @@ BsonValueToJsonForLoggingCore(const bson_value_t *value, bool quoteStrings)
 			 *   7 for '{ "" : ' prefix, and
 			 *   2 for ' }' suffix.
 			 */
-			char *repr = bson_as_relaxed_extended_json(&bson, NULL);
-			returnValue = pnstrdup(repr + 7, strlen(repr) - 9);
+			size_t reprLength = 0;
+			char *repr = bson_as_relaxed_extended_json(&bson, &reprLength);
+
+			/* Strip them in place rather than copying the value into a new string */
+			memmove(repr, repr + 7, reprLength - 9);
+			repr[reprLength - 9] = '\0';
+			returnValue = repr;
 			break;
 		}
 	}
@@ -364,6 +454,19 @@ const char *
 FormatBsonValueForShellLogging(const bson_value_t *bson)
 {
 	StringInfo str = makeStringInfo();
+	AppendBsonValueForShellLogging(str, bson);
+	return str->data;
+}
+
+
+/*
+ * Appends the shell logging format of the value to the string. Nested
+ * documents are written into the same string rather than formatted
+ * separately and copied in.
+ */
+static void
+AppendBsonValueForShellLogging(StringInfo str, const bson_value_t *bson)
+{
 	switch (bson->value_type)
 	{
 		case BSON_TYPE_INT32:
@@ -411,8 +514,9 @@ FormatBsonValueForShellLogging(const bson_value_t *bson)
 					appendStringInfoString(str, separator);
 				}
 
-				const char *bsonValStr = FormatBsonValueForShellLogging(bsonValue);
-				appendStringInfo(str, "%s: %s", key, bsonValStr);
+				appendStringInfoString(str, key);
+				appendBinaryStringInfo(str, ": ", 2);
+				AppendBsonValueForShellLogging(str, bsonValue);
 				separator = ", ";
 			}
 
@@ -433,7 +537,6 @@ FormatBsonValueForShellLogging(const bson_value_t *bson)
 								"Expected Numeric, document or UTF8 bson value type")));
 		}
 	}
-	return str->data;
 }
 
 
@@ -504,6 +607,23 @@ ValidateInputBsonBytes(const uint8_t *documentBytes,
 					   uint32_t documentBytesLength,
 					   bson_validate_flags_t validateFlag)
 {
+	/*
+	 * The fast path only accepts documents it fully validated, anything else
+	 * (including invalid documents so that the errors stay the same) goes
+	 * through libbson.
+	 */
+	if (EnableBsonFastValidation &&
+		(validateFlag == BSON_VALIDATE_NONE || validateFlag == BSON_VALIDATE_UTF8))
+	{
+		bool validateUtf8 = validateFlag == BSON_VALIDATE_UTF8;
+		int depth = 0;
+		if (TryFastValidateBsonBytes(documentBytes, documentBytesLength,
+									 validateUtf8, depth))
+		{
+			return;
+		}
+	}
+
 	bson_t bson;
 	if (!bson_init_static(&bson, documentBytes, documentBytesLength))
 	{
@@ -681,7 +801,7 @@ PgbsonInitIteratorAtPath(const pgbson *bson, const char *path, bson_iter_t *iter
 {
 	bson_iter_t documentIterator;
 	PgbsonInitIterator(bson, &documentIterator);
-	return bson_iter_find_descendant(&documentIterator, path, iterator);
+	return FindDescendantWithFieldCache(&documentIterator, path, iterator);
 }
 
 
@@ -696,7 +816,7 @@ PgbsonGetBsonValueAtPath(const pgbson *bson, const char *path, bson_value_t *val
 	bson_iter_t iterator;
 	PgbsonInitIterator(bson, &documentIterator);
 
-	if (!bson_iter_find_descendant(&documentIterator, path, &iterator))
+	if (!FindDescendantWithFieldCache(&documentIterator, path, &iterator))
 	{
 		value->value_type = BSON_TYPE_EOD;
 	}
@@ -747,6 +867,167 @@ BsonValueInitIterator(const bson_value_t *value, bson_iter_t *iterator)
 }
 
 
+/* --------------------------------------------------------- */
+/* Field offset cache functions */
+/* --------------------------------------------------------- */
+
+/*
+ * Makes the document the active document of the field offset cache for the
+ * duration of a scope, e.g. the projection of a single document. Returns the
+ * state needed to restore the active document of the enclosing scope in
+ * PgbsonFieldOffsetCacheEnd.
+ */
+PgbsonFieldOffsetCacheScope
+PgbsonFieldOffsetCacheBegin(const pgbson *document)
+{
+	PgbsonFieldOffsetCacheScope scope = {
+		.previousDocument = FieldCache.document,
+		.generation = FieldCache.generation
+	};
+
+	PgbsonFieldOffsetCacheSetDocument(document);
+	return scope;
+}
+
+
+/*
+ * Ends a scope started by PgbsonFieldOffsetCacheBegin. The enclosing document
+ * is only restored if no document was released in between since it may no
+ * longer be valid.
+ */
+void
+PgbsonFieldOffsetCacheEnd(PgbsonFieldOffsetCacheScope scope)
+{
+	if (scope.generation != FieldCache.generation)
+	{
+		ResetFieldCacheIndex(NULL);
+		return;
+	}
+
+	PgbsonFieldOffsetCacheSetDocument(scope.previousDocument);
+}
+
+
+/*
+ * Sets the active document of the field offset cache. The index is dropped
+ * if the document differs from the current one.
+ */
+void
+PgbsonFieldOffsetCacheSetDocument(const pgbson *document)
+{
+	if (!EnableBsonFieldOffsetCache)
+	{
+		document = NULL;
+	}
+
+	if (FieldCache.document != document)
+	{
+		ResetFieldCacheIndex(document);
+	}
+}
+
+
+/*
+ * Called by owners of a document before freeing it so that neither the index
+ * nor a pending scope keep referring to it.
+ */
+void
+PgbsonFieldOffsetCacheRelease(const pgbson *document)
+{
+	if (document == NULL)
+	{
+		return;
+	}
+
+	FieldCache.generation++;
+	if (FieldCache.document == document)
+	{
+		ResetFieldCacheIndex(NULL);
+	}
+}
+
+
+/*
+ * Drops the active document and invalidates all pending scopes. Used on
+ * (sub)transaction abort where scopes are not ended.
+ */
+void
+PgbsonFieldOffsetCacheReset(void)
+{
+	FieldCache.generation++;
+	ResetFieldCacheIndex(NULL);
+}
+
+
+/*
+ * Equivalent of bson_iter_find_w_len that serves the lookup from the field
+ * offset cache when the iterator is at the root of the active document and
+ * has not been advanced yet. The iterator is left in the same state as
+ * bson_iter_find_w_len would leave it in: positioned on the first field with
+ * the key, or exhausted if there is none. Any other iterator goes through
+ * bson_iter_find_w_len.
+ */
+bool
+PgbsonIterFindWithFieldCache(bson_iter_t *iter, const char *key, uint32_t keyLength)
+{
+	if (FieldCache.document == NULL || !IsFieldCacheRootIterator(iter))
+	{
+		return bson_iter_find_w_len(iter, key, keyLength);
+	}
+
+	for (int i = 0; i < FieldCache.numFields; i++)
+	{
+		FieldOffsetCacheEntry *entry = &FieldCache.fields[i];
+		if (entry->keyLength == keyLength &&
+			memcmp(entry->key, key, keyLength) == 0)
+		{
+			*iter = entry->iterator;
+			return true;
+		}
+	}
+
+	/* Continue indexing the document from where the last lookup stopped */
+	while (!FieldCache.walkComplete && !FieldCache.walkTruncated)
+	{
+		if (!bson_iter_next(&FieldCache.walkIterator))
+		{
+			FieldCache.walkComplete = true;
+			break;
+		}
+
+		if (FieldCache.numFields == FIELD_OFFSET_CACHE_MAX_FIELDS)
+		{
+			FieldCache.walkTruncated = true;
+			break;
+		}
+
+		FieldOffsetCacheEntry *entry = &FieldCache.fields[FieldCache.numFields++];
+		entry->key = bson_iter_key(&FieldCache.walkIterator);
+		entry->keyLength = bson_iter_key_len(&FieldCache.walkIterator);
+		entry->iterator = FieldCache.walkIterator;
+
+		if (entry->keyLength == keyLength &&
+			memcmp(entry->key, key, keyLength) == 0)
+		{
+			*iter = entry->iterator;
+			return true;
+		}
+	}
+
+	if (FieldCache.walkComplete)
+	{
+		/* The walk iterator is exhausted just like the caller's would be */
+		*iter = FieldCache.walkIterator;
+		return false;
+	}
+
+	/* Truncated: the indexed fields did not match, look at the remainder */
+	FieldOffsetCacheEntry *lastEntry = &FieldCache.fields[FieldCache.numFields - 1];
+	*iter = lastEntry->iterator;
+	return bson_iter_find_w_len(iter, key, keyLength);
+}
+
+
 /* --------------------------------------------------------- */
 /* pgbson_writer functions */
 /* --------------------------------------------------------- */
@@ -761,6 +1042,34 @@ PgbsonWriterInit(pgbson_writer *writer)
 }
 
 
+/*
+ * Initializes a bson writer with its buffer reserved upfront for a document of
+ * about sizeHint bytes. Used when the output is expected to be close in size to
+ * an input document (e.g. an update or an $addFields of it) so that the buffer
+ * is not grown through a chain of reallocations and copies. Child writers append
+ * in place into the buffer of this writer and benefit from the reservation too.
+ */
+void
+PgbsonWriterInitWithSizeHint(pgbson_writer *writer, uint32_t sizeHint)
+{
+	bson_init(&(writer->innerBson));
+	if (!EnableBsonWriterSizeHint || sizeHint <= sizeof(bson_t))
+	{
+		/* Small documents fit in the inline buffer of the bson_t */
+		return;
+	}
+
+	sizeHint = Min(sizeHint, PGBSON_WRITER_MAX_SIZE_HINT);
+
+	/*
+	 * bson_reserve_buffer grows the buffer and marks its contents as the document,
+	 * bson_reinit then resets it to an empty document while keeping the buffer.
+	 */
+	bson_reserve_buffer(&(writer->innerBson), sizeHint);
+	bson_reinit(&(writer->innerBson));
+}
+
+
 /*
  * Initializes a bson writer on the heap using bson_new() so that it's ready to write data
  *
@@ -1579,6 +1888,35 @@ PgbsonWriterConcatBytes(pgbson_writer *writer, const uint8_t *bsonBytes, uint32_
 }
 
 
+/*
+ * Appends the raw bytes of one or more consecutive elements of a document
+ * (e.g. from bson_iter_t off to next_off) to the writer. bson_concat takes a
+ * complete document, so the elements are framed with a header and trailer
+ * first.
+ */
+void
+PgbsonWriterAppendRawElements(pgbson_writer *writer, const uint8_t *elements,
+							  uint32_t elementsLength)
+{
+	uint8_t stackBuffer[256];
+	uint32_t documentLength = elementsLength + 5;
+	uint8_t *buffer = documentLength <= sizeof(stackBuffer) ? stackBuffer :
+					  palloc(documentLength);
+
+	uint32_t documentLengthLe = BSON_UINT32_TO_LE(documentLength);
+	memcpy(buffer, &documentLengthLe, sizeof(uint32_t));
+	memcpy(buffer + sizeof(uint32_t), elements, elementsLength);
+	buffer[documentLength - 1] = 0;
+
+	PgbsonWriterConcatBytes(writer, buffer, documentLength);
+
+	if (buffer != stackBuffer)
+	{
+		pfree(buffer);
+	}
+}
+
+
 /*
  * Initializes an elementwriter to write to the current index of an array.
  */
@@ -1768,6 +2106,279 @@ BsonValueToDocumentPgbson(const bson_value_t *value)
 /* Private helper methods */
 /* --------------------------------------------------------- */
 
+/*
+ * Same as bson_iter_find_descendant for the root iterator of a document
+ * except that the first path segment is looked up through the field offset
+ * cache.
+ */
+static bool
+FindDescendantWithFieldCache(bson_iter_t *documentIterator, const char *path,
+							 bson_iter_t *iterator)
+{
+	if (FieldCache.document == NULL)
+	{
+		return bson_iter_find_descendant(documentIterator, path, iterator);
+	}
+
+	const char *dotKey = strchr(path, '.');
+	uint32_t segmentLength = dotKey == NULL ? strlen(path) : (uint32_t) (dotKey - path);
+	if (!PgbsonIterFindWithFieldCache(documentIterator, path, segmentLength))
+	{
+		return false;
+	}
+
+	if (dotKey == NULL)
+	{
+		*iterator = *documentIterator;
+		return true;
+	}
+
+	bson_iter_t childIterator;
+	if ((BSON_ITER_HOLDS_DOCUMENT(documentIterator) ||
+		 BSON_ITER_HOLDS_ARRAY(documentIterator)) &&
+		bson_iter_recurse(documentIterator, &childIterator))
+	{
+		return bson_iter_find_descendant(&childIterator, dotKey + 1, iterator);
+	}
+
+	return false;
+}
+
+
+/*
+ * Whether the iterator was initialized at the root of the active document
+ * of the field offset cache and has not been advanced.
+ */
+static bool
+IsFieldCacheRootIterator(const bson_iter_t *iter)
+{
+	return iter->raw == (const uint8_t *) VARDATA_ANY(FieldCache.document) &&
+		   iter->len == VARSIZE_ANY_EXHDR(FieldCache.document) &&
+		   iter->off == 0 && iter->next_off == 4;
+}
+
+
+/*
+ * Drops the index of the field offset cache and points it at the given
+ * document (which may be NULL).
+ */
+static void
+ResetFieldCacheIndex(const pgbson *document)
+{
+	FieldCache.document = document;
+	FieldCache.numFields = 0;
+	FieldCache.walkComplete = false;
+	FieldCache.walkTruncated = false;
+
+	if (document != NULL &&
+		!bson_iter_init_from_data(&FieldCache.walkIterator,
+								  (const uint8_t *) VARDATA_ANY(document),
+								  VARSIZE_ANY_EXHDR(document)))
+	{
+		FieldCache.document = NULL;
+	}
+}
+
+
+/*
+ * Reads a little endian int32 from the bson bytes.
+ */
+static inline int32_t
+ReadBsonInt32(const uint8_t *bytes)
+{
+	int32_t value;
+	memcpy(&value, bytes, sizeof(int32_t));
+	return BSON_UINT32_FROM_LE(value);
+}
+
+
+/*
+ * Whether the bytes are valid UTF-8 without embedded nulls, this uses the
+ * postgres verifier which checks ASCII runs a word at a time.
+ */
+static inline bool
+IsValidUtf8Bytes(const uint8_t *bytes, uint32_t length)
+{
+	return pg_encoding_verifymbstr(PG_UTF8, (const char *) bytes, length) ==
+		   (int) length;
+}
+
+
+/*
+ * Validates the framing of a bson document (and optionally the UTF-8 of its
+ * keys and strings) in a single pass over its bytes: the document and every
+ * nested document must be well formed and every value must fit within its
+ * parent. Returns false if the document is invalid or has values that are left
+ * for libbson to validate (e.g. code with scope, regexes or deprecated binary
+ * subtypes); in that case the caller must validate the document with libbson.
+ */
+static bool
+TryFastValidateBsonBytes(const uint8_t *documentBytes, uint32_t documentBytesLength,
+						 bool validateUtf8, int depth)
+{
+	if (depth > FAST_VALIDATE_MAX_DEPTH || documentBytesLength < 5 ||
+		(uint32_t) ReadBsonInt32(documentBytes) != documentBytesLength ||
+		documentBytes[documentBytesLength - 1] != 0)
+	{
+		return false;
+	}
+
+	/* The offset of the terminating null of the document */
+	uint32_t endOffset = documentBytesLength - 1;
+	uint32_t offset = 4;
+	while (offset < endOffset)
+	{
+		uint8_t type = documentBytes[offset++];
+
+		const uint8_t *key = documentBytes + offset;
+		const uint8_t *keyEnd = memchr(key, 0, endOffset - offset);
+		if (keyEnd == NULL)
+		{
+			return false;
+		}
+
+		uint32_t keyLength = (uint32_t) (keyEnd - key);
+		if (validateUtf8 && !IsValidUtf8Bytes(key, keyLength))
+		{
+			return false;
+		}
+
+		offset += keyLength + 1;
+
+		const uint8_t *value = documentBytes + offset;
+		uint32_t remaining = endOffset - offset;
+		uint32_t valueLength;
+		switch ((bson_type_t) type)
+		{
+			case BSON_TYPE_UNDEFINED:
+			case BSON_TYPE_NULL:
+			case BSON_TYPE_MINKEY:
+			case BSON_TYPE_MAXKEY:
+			{
+				valueLength = 0;
+				break;
+			}
+
+			case BSON_TYPE_BOOL:
+			{
+				if (remaining < 1 || value[0] > 1)
+				{
+					return false;
+				}
+
+				valueLength = 1;
+				break;
+			}
+
+			case BSON_TYPE_INT32:
+			{
+				valueLength = 4;
+				break;
+			}
+
+			case BSON_TYPE_DOUBLE:
+			case BSON_TYPE_INT64:
+			case BSON_TYPE_DATE_TIME:
+			case BSON_TYPE_TIMESTAMP:
+			{
+				valueLength = 8;
+				break;
+			}
+
+			case BSON_TYPE_OID:
+			{
+				valueLength = 12;
+				break;
+			}
+
+			case BSON_TYPE_DECIMAL128:
+			{
+				valueLength = 16;
+				break;
+			}
+
+			case BSON_TYPE_UTF8:
+			case BSON_TYPE_CODE:
+			case BSON_TYPE_SYMBOL:
+			{
+				if (remaining < 4)
+				{
+					return false;
+				}
+
+				int32_t stringLength = ReadBsonInt32(value);
+				if (stringLength < 1 || (uint32_t) stringLength > remaining - 4 ||
+					value[4 + stringLength - 1] != 0)
+				{
+					return false;
+				}
+
+				if (validateUtf8 && !IsValidUtf8Bytes(value + 4, stringLength - 1))
+				{
+					return false;
+				}
+
+				valueLength = 4 + (uint32_t) stringLength;
+				break;
+			}
+
+			case BSON_TYPE_DOCUMENT:
+			case BSON_TYPE_ARRAY:
+			{
+				if (remaining < 5)
+				{
+					return false;
+				}
+
+				int32_t nestedLength = ReadBsonInt32(value);
+				if (nestedLength < 5 || (uint32_t) nestedLength > remaining ||
+					!TryFastValidateBsonBytes(value, nestedLength, validateUtf8,
+											  depth + 1))
+				{
+					return false;
+				}
+
+				valueLength = (uint32_t) nestedLength;
+				break;
+			}
+
+			case BSON_TYPE_BINARY:
+			{
+				if (remaining < 5)
+				{
+					return false;
+				}
+
+				int32_t binaryLength = ReadBsonInt32(value);
+				if (binaryLength < 0 || (uint32_t) binaryLength > remaining - 5 ||
+					value[4] == BSON_SUBTYPE_BINARY_DEPRECATED)
+				{
+					return false;
+				}
+
+				valueLength = 5 + (uint32_t) binaryLength;
+				break;
+			}
+
+			default:
+			{
+				/* Left for libbson */
+				return false;
+			}
+		}
+
+		if (valueLength > remaining)
+		{
+			return false;
+		}
+
+		offset += valueLength;
+	}
+
+	return offset == endOffset;
+}
+
+
 /*
  * Creates a pgbson structure from a libbson bson_t type.
  * the bson_t is optionally destroyed and the memory reclaimed after conversion.
@@ -956,7 +956,8 @@ TraverseBsonCore(bson_iter_t *documentIterator, const StringView *traversePath,
 	if (dotKeyStr.string == NULL)
 	{
 		/* no dot key - find the field in the current bson. */
-		if (!bson_iter_find_string_view(documentIterator, traversePath))
+		if (!PgbsonIterFindWithFieldCache(documentIterator, traversePath->string,
+										  traversePath->length))
 		{
 			if (executionFunctions->SetTraverseResult != NULL)
 			{
@@ -1009,7 +1010,8 @@ TraverseBsonCore(bson_iter_t *documentIterator, const StringView *traversePath,
 		return false;
 	}
 
-	if (!bson_iter_find_string_view(documentIterator, &dotKeyStr))
+	if (!PgbsonIterFindWithFieldCache(documentIterator, dotKeyStr.string,
+									  dotKeyStr.length))
 	{
 		if (executionFunctions->SetTraverseResult != NULL)
 		{
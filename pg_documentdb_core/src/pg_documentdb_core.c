@@ -12,6 +12,7 @@
 #include <utils/guc.h>
 
 #include "bson_init.h"
+#include "collation/collation.h"
 
 PG_MODULE_MAGIC;
 
@@ -20,6 +21,8 @@ void _PG_fini(void);
 
 bool SkipDocumentDBCoreLoad = false;
 
+extern char *CollationPrewarmList;
+
 /*
  * _PG_init gets called when the extension is loaded.
  */
@@ -44,6 +47,10 @@ _PG_init(void)
 	InitDocumentDBCoreConfigurations("documentdb_core");
 
 	MarkGUCPrefixReserved("documentdb_core");
+
+	/* Opened in the postmaster, so backends inherit the collators */
+	PrewarmCollatorCache(CollationPrewarmList);
+
 	ereport(LOG, (errmsg("Initialized documentdb_core extension")));
 }
 
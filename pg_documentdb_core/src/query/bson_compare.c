@@ -12,6 +12,7 @@
 #include <miscadmin.h>
 #include <utils/array.h>
 #include <utils/builtins.h>
+#include <utils/sortsupport.h>
 #include <utils/timestamp.h>
 #include <math.h>
 
@@ -29,6 +30,43 @@
 
 static const int64 MillisecondsInSecond = 1000;
 
+/*
+ * State used to generate abbreviated sort keys for bson documents.
+ *
+ * The abbreviated key of a document packs (in most to least significant order):
+ *  - 8 bits: the sort order type of the first field + 1 (0 for empty documents).
+ *  - 8 bits: how the first field name compares with the first field name
+ *            seen by the sort (the reference path): less, equal or greater.
+ *  - 48 bits: an order preserving prefix of the first field value, only when the
+ *             field name is the reference path.
+ * Unsigned comparisons of the keys are consistent with ComparePgbson: unequal keys
+ * compare the same as the documents, while equal keys defer to the full comparison.
+ * Sorts on bson_orderby outputs (single field documents on the same path) mostly
+ * resolve on the abbreviated keys alone.
+ */
+typedef struct BsonAbbreviatedKeyState
+{
+	/* The first field name seen, every key is relative to it */
+	char *referencePath;
+	uint32_t referencePathLength;
+
+	/* Number of keys generated */
+	int64 numKeys;
+
+	/* Number of keys that carry no value prefix */
+	int64 numTypeOnlyKeys;
+} BsonAbbreviatedKeyState;
+
+#define ABBREVIATED_KEY_PATH_LESS 0
+#define ABBREVIATED_KEY_PATH_EQUAL 1
+#define ABBREVIATED_KEY_PATH_GREATER 2
+
+/* Number of bits of the abbreviated key used for the value prefix */
+#define ABBREVIATED_KEY_VALUE_BITS 48
+
+/* Minimum number of keys before considering aborting the abbreviation */
+#define ABBREVIATED_KEY_MIN_ABORT_CHECK 1000
+
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
@@ -43,12 +81,20 @@ static int CompareBsonValue(const bson_value_t *left, const bson_value_t *right,
 static double BsonValueAsDoubleCore(const bson_value_t *value, bool quiet);
 static bool IsBsonValue64BitIntegerCore(const bson_value_t *value, bool checkFixedInteger,
 										bool quantizeDoubleValue);
+static int ComparePgbsonDatumsForSort(Datum left, Datum right, SortSupport sortSupport);
+#if SIZEOF_DATUM == 8
+static Datum BsonAbbreviatedKeyConvert(Datum original, SortSupport sortSupport);
+static int BsonAbbreviatedKeyCompare(Datum left, Datum right, SortSupport sortSupport);
+static bool BsonAbbreviatedKeyAbort(int memtupcount, SortSupport sortSupport);
+static bool GetBsonValueSortKeyPrefix(const bson_value_t *value, uint64 *prefix);
+#endif
 
 /* --------------------------------------------------------- */
 /* Top level exports */
 /* --------------------------------------------------------- */
 
 PG_FUNCTION_INFO_V1(extension_bson_compare);
+PG_FUNCTION_INFO_V1(extension_bson_sort_support);
 PG_FUNCTION_INFO_V1(extension_bson_equal);
 PG_FUNCTION_INFO_V1(extension_bson_not_equal);
 PG_FUNCTION_INFO_V1(extension_bson_gt);
@@ -73,6 +119,36 @@ extension_bson_compare(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * Sort support function for the bson btree operator class.
+ * Sorts (including the bounded top-N heap sorts of ORDER BY ... LIMIT) and
+ * btree index builds call the comparator directly instead of going through
+ * the function manager for every comparison.
+ */
+Datum
+extension_bson_sort_support(PG_FUNCTION_ARGS)
+{
+	SortSupport sortSupport = (SortSupport) PG_GETARG_POINTER(0);
+	sortSupport->comparator = ComparePgbsonDatumsForSort;
+
+#if SIZEOF_DATUM == 8
+	if (sortSupport->abbreviate)
+	{
+		MemoryContext oldContext = MemoryContextSwitchTo(sortSupport->ssup_cxt);
+		sortSupport->ssup_extra = palloc0(sizeof(BsonAbbreviatedKeyState));
+		MemoryContextSwitchTo(oldContext);
+
+		sortSupport->abbrev_full_comparator = ComparePgbsonDatumsForSort;
+		sortSupport->comparator = BsonAbbreviatedKeyCompare;
+		sortSupport->abbrev_converter = BsonAbbreviatedKeyConvert;
+		sortSupport->abbrev_abort = BsonAbbreviatedKeyAbort;
+	}
+#endif
+
+	PG_RETURN_VOID();
+}
+
+
 Datum
 extension_bson_equal(PG_FUNCTION_ARGS)
 {
@@ -311,6 +387,245 @@ ComparePgbson(const pgbson *leftBson, const pgbson *rightBson)
 }
 
 
+/*
+ * SortSupport comparator for bson datums, matches extension_bson_compare.
+ */
+static int
+ComparePgbsonDatumsForSort(Datum left, Datum right, SortSupport sortSupport)
+{
+	pgbson *leftBson = DatumGetPgBsonPacked(left);
+	pgbson *rightBson = DatumGetPgBsonPacked(right);
+
+	int compareResult = ComparePgbson(leftBson, rightBson);
+
+	if ((Pointer) leftBson != DatumGetPointer(left))
+	{
+		pfree(leftBson);
+	}
+
+	if ((Pointer) rightBson != DatumGetPointer(right))
+	{
+		pfree(rightBson);
+	}
+
+	return compareResult;
+}
+
+
+#if SIZEOF_DATUM == 8
+
+/*
+ * Converts a bson document into its abbreviated sort key (see BsonAbbreviatedKeyState).
+ */
+static Datum
+BsonAbbreviatedKeyConvert(Datum original, SortSupport sortSupport)
+{
+	BsonAbbreviatedKeyState *state = (BsonAbbreviatedKeyState *) sortSupport->ssup_extra;
+	pgbson *document = DatumGetPgBsonPacked(original);
+
+	state->numKeys++;
+
+	bson_iter_t documentIter;
+	PgbsonInitIterator(document, &documentIter);
+	if (!bson_iter_next(&documentIter))
+	{
+		/* Empty documents sort first */
+		state->numTypeOnlyKeys++;
+		return UInt64GetDatum(0);
+	}
+
+	StringView path = bson_iter_key_string_view(&documentIter);
+	const bson_value_t *value = bson_iter_value(&documentIter);
+
+	if (state->referencePath == NULL)
+	{
+		state->referencePath = MemoryContextAlloc(sortSupport->ssup_cxt,
+												  path.length + 1);
+		memcpy(state->referencePath, path.string, path.length);
+		state->referencePath[path.length] = '\0';
+		state->referencePathLength = path.length;
+	}
+
+	const char *collationStringIgnore = NULL;
+	int pathCompare = CompareStrings(path.string, path.length, state->referencePath,
+									 state->referencePathLength,
+									 collationStringIgnore);
+
+	uint64 key = ((uint64) (GetSortOrderType(value->value_type) + 1)) << 56;
+	uint64 valuePrefix = 0;
+	if (pathCompare < 0)
+	{
+		key |= ((uint64) ABBREVIATED_KEY_PATH_LESS) << ABBREVIATED_KEY_VALUE_BITS;
+		state->numTypeOnlyKeys++;
+	}
+	else if (pathCompare > 0)
+	{
+		key |= ((uint64) ABBREVIATED_KEY_PATH_GREATER) << ABBREVIATED_KEY_VALUE_BITS;
+		state->numTypeOnlyKeys++;
+	}
+	else
+	{
+		key |= ((uint64) ABBREVIATED_KEY_PATH_EQUAL) << ABBREVIATED_KEY_VALUE_BITS;
+		if (GetBsonValueSortKeyPrefix(value, &valuePrefix))
+		{
+			key |= valuePrefix >> (64 - ABBREVIATED_KEY_VALUE_BITS);
+		}
+		else
+		{
+			state->numTypeOnlyKeys++;
+		}
+	}
+
+	if ((Pointer) document != DatumGetPointer(original))
+	{
+		pfree(document);
+	}
+
+	return UInt64GetDatum(key);
+}
+
+
+static int
+BsonAbbreviatedKeyCompare(Datum left, Datum right, SortSupport sortSupport)
+{
+	uint64 leftKey = DatumGetUInt64(left);
+	uint64 rightKey = DatumGetUInt64(right);
+	return leftKey > rightKey ? 1 : (leftKey == rightKey ? 0 : -1);
+}
+
+
+/*
+ * Abbreviation is only worth it when most keys carry a value prefix, e.g. it's
+ * not for sorts on documents or arrays, or on documents with different paths.
+ */
+static bool
+BsonAbbreviatedKeyAbort(int memtupcount, SortSupport sortSupport)
+{
+	BsonAbbreviatedKeyState *state = (BsonAbbreviatedKeyState *) sortSupport->ssup_extra;
+	if (state->numKeys < ABBREVIATED_KEY_MIN_ABORT_CHECK)
+	{
+		return false;
+	}
+
+	return state->numTypeOnlyKeys * 2 > state->numKeys;
+}
+
+
+/*
+ * Gets a 64 bit order preserving prefix of a bson value to be compared with values
+ * of the same sort order type as unsigned integers: values that compare equal
+ * have the same prefix and values with different prefixes compare the same as
+ * their prefixes (the prefix of types with a variable length value is truncated
+ * so different values can share a prefix).
+ * Returns false if there is no prefix for the type of value.
+ */
+static bool
+GetBsonValueSortKeyPrefix(const bson_value_t *value, uint64 *prefix)
+{
+	switch (value->value_type)
+	{
+		case BSON_TYPE_DOUBLE:
+		case BSON_TYPE_INT32:
+		case BSON_TYPE_INT64:
+		case BSON_TYPE_DECIMAL128:
+		{
+			/* Numbers compare across types, normalize them to doubles */
+			double doubleValue;
+			if (value->value_type == BSON_TYPE_DECIMAL128)
+			{
+				doubleValue = IsDecimal128NaN(value) ? NAN :
+							  GetBsonDecimal128AsDoubleQuiet(value);
+			}
+			else
+			{
+				doubleValue = BsonValueAsDouble(value);
+			}
+
+			if (isnan(doubleValue))
+			{
+				/* NaN sorts before every other number */
+				*prefix = 0;
+				return true;
+			}
+
+			if (doubleValue == 0)
+			{
+				/* -0 and 0 compare equal */
+				doubleValue = 0;
+			}
+
+			uint64 bits;
+			memcpy(&bits, &doubleValue, sizeof(uint64));
+			*prefix = (bits & UINT64CONST(0x8000000000000000)) ? ~bits :
+					  bits | UINT64CONST(0x8000000000000000);
+			return true;
+		}
+
+		case BSON_TYPE_UTF8:
+		case BSON_TYPE_SYMBOL:
+		{
+			const char *string = value->value_type == BSON_TYPE_UTF8 ?
+								 value->value.v_utf8.str :
+								 value->value.v_symbol.symbol;
+			uint32_t length = value->value_type == BSON_TYPE_UTF8 ?
+							  value->value.v_utf8.len :
+							  value->value.v_symbol.len;
+
+			/* Binary comparison of the strings: big endian packing of the first bytes */
+			uint64 result = 0;
+			for (uint32_t i = 0; i < sizeof(uint64); i++)
+			{
+				uint8_t byte = i < length ? (uint8_t) string[i] : 0;
+				result = (result << 8) | byte;
+			}
+
+			*prefix = result;
+			return true;
+		}
+
+		case BSON_TYPE_OID:
+		{
+			uint64 result = 0;
+			for (uint32_t i = 0; i < sizeof(uint64); i++)
+			{
+				result = (result << 8) | value->value.v_oid.bytes[i];
+			}
+
+			*prefix = result;
+			return true;
+		}
+
+		case BSON_TYPE_BOOL:
+		{
+			*prefix = value->value.v_bool ? UINT64CONST(0x8000000000000000) : 0;
+			return true;
+		}
+
+		case BSON_TYPE_DATE_TIME:
+		{
+			*prefix = ((uint64) value->value.v_datetime) ^
+					  UINT64CONST(0x8000000000000000);
+			return true;
+		}
+
+		case BSON_TYPE_TIMESTAMP:
+		{
+			*prefix = (((uint64) value->value.v_timestamp.timestamp) << 32) |
+					  value->value.v_timestamp.increment;
+			return true;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
+#endif
+
+
 /*
  * Compares 2 pgbson objects which may be null.
  */
@@ -22,6 +22,30 @@
 /* Data-types */
 /* --------------------------------------------------------- */
 
+/*
+ * Every value hash combines the hash of its type code, and every document
+ * field the hash of its path. These only depend on the hash function and the
+ * seed, so they are cached per hash function for the last seed used: group
+ * keys and hash join keys (single field documents with an empty path) then
+ * only hash the bytes of their value.
+ */
+typedef struct BsonHashConstantsCache
+{
+	int64 seed;
+	bool isSeedSet;
+
+	/* Hashes of the type codes (bson types are a single byte) */
+	uint64 typeCodeHashes[256];
+	bool typeCodeHashValid[256];
+
+	/* Hash of the empty path */
+	uint64 emptyPathHash;
+	bool emptyPathHashValid;
+} BsonHashConstantsCache;
+
+static BsonHashConstantsCache Uint32HashConstants = { 0 };
+static BsonHashConstantsCache Uint64HashConstants = { 0 };
+
 /* --------------------------------------------------------- */
 /* Forward declaration */
 /* --------------------------------------------------------- */
@@ -34,6 +58,14 @@
 
 static uint64 HashCombineUint32AsUint64(uint64 left, uint64 right);
 static uint64 HashNumber(double number, int64 seed);
+static inline BsonHashConstantsCache * GetHashConstantsCache(
+	uint64 (*hash_bytes_func)(const uint8_t *bytes, uint32_t bytesLength, int64 seed),
+	int64 seed);
+static inline uint64 HashTypeCode(int typeCodeInt,
+								  uint64 (*hash_bytes_func)(const uint8_t *bytes,
+															uint32_t bytesLength,
+															int64 seed),
+								  int64 seed);
 static uint64 HashBytesUint64(const uint8_t *bytes, uint32_t bytesLength, int64 seed);
 static uint64 HashBytesUint32AsUint64(const uint8_t *bytes, uint32_t bytesLength, int64
 									  seed);
@@ -480,8 +512,26 @@ BsonHashCompare(bson_iter_t *bsonIterValue,
 		BsonIterToPgbsonElement(bsonIterValue, &leftElement);
 
 		/* next compare field name. */
-		uint64_t pathHash = hash_bytes_func((uint8_t *) leftElement.path,
-											leftElement.pathLength, seed);
+		uint64_t pathHash;
+		BsonHashConstantsCache *constants;
+		if (leftElement.pathLength == 0 &&
+			(constants = GetHashConstantsCache(hash_bytes_func, seed)) != NULL)
+		{
+			if (!constants->emptyPathHashValid)
+			{
+				constants->emptyPathHash = hash_bytes_func((uint8_t *) leftElement.path,
+														   0, seed);
+				constants->emptyPathHashValid = true;
+			}
+
+			pathHash = constants->emptyPathHash;
+		}
+		else
+		{
+			pathHash = hash_bytes_func((uint8_t *) leftElement.path,
+									   leftElement.pathLength, seed);
+		}
+
 		hashValue = hash_combine_func(hashValue, pathHash);
 
 		uint64_t valueHash = HashBsonValueCompare(&leftElement.bsonValue, hash_bytes_func,
@@ -493,6 +543,66 @@ BsonHashCompare(bson_iter_t *bsonIterValue,
 }
 
 
+/*
+ * Returns the constants cache of the hash function (reset if the seed
+ * changed), or NULL if the function has no cache.
+ */
+static inline BsonHashConstantsCache *
+GetHashConstantsCache(uint64 (*hash_bytes_func)(const uint8_t *bytes,
+												uint32_t bytesLength, int64 seed),
+					  int64 seed)
+{
+	BsonHashConstantsCache *constants;
+	if (hash_bytes_func == HashBytesUint32AsUint64)
+	{
+		constants = &Uint32HashConstants;
+	}
+	else if (hash_bytes_func == HashBytesUint64)
+	{
+		constants = &Uint64HashConstants;
+	}
+	else
+	{
+		return NULL;
+	}
+
+	if (!constants->isSeedSet || constants->seed != seed)
+	{
+		memset(constants, 0, sizeof(BsonHashConstantsCache));
+		constants->seed = seed;
+		constants->isSeedSet = true;
+	}
+
+	return constants;
+}
+
+
+/*
+ * Returns the hash of a bson type code, same as hashing the int type code.
+ */
+static inline uint64
+HashTypeCode(int typeCodeInt,
+			 uint64 (*hash_bytes_func)(const uint8_t *bytes, uint32_t bytesLength,
+									   int64 seed),
+			 int64 seed)
+{
+	BsonHashConstantsCache *constants = GetHashConstantsCache(hash_bytes_func, seed);
+	if (constants == NULL || typeCodeInt < 0 || typeCodeInt > 255)
+	{
+		return hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed);
+	}
+
+	if (!constants->typeCodeHashValid[typeCodeInt])
+	{
+		constants->typeCodeHashes[typeCodeInt] =
+			hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed);
+		constants->typeCodeHashValid[typeCodeInt] = true;
+	}
+
+	return constants->typeCodeHashes[typeCodeInt];
+}
+
+
 /*
  * HashNumber returns the hash of a double.
  */
@@ -523,14 +633,14 @@ HashBsonValueCompare(const bson_value_t *value,
 		case BSON_TYPE_MINKEY:
 		{
 			typeCodeInt = (int) BSON_TYPE_MINKEY;
-			return hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed);
+			return HashTypeCode(typeCodeInt, hash_bytes_func, seed);
 		}
 
 		case BSON_TYPE_UNDEFINED:
 		case BSON_TYPE_NULL:
 		{
 			typeCodeInt = (int) BSON_TYPE_UNDEFINED;
-			return hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed);
+			return HashTypeCode(typeCodeInt, hash_bytes_func, seed);
 		}
 
 		case BSON_TYPE_INT32:
@@ -540,7 +650,7 @@ HashBsonValueCompare(const bson_value_t *value,
 			typeCodeInt = BSON_TYPE_INT64;
 			int64_t int64Value = BsonValueAsInt64(value);
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) &int64Value, sizeof(int64_t), seed));
 		}
 
@@ -554,13 +664,13 @@ HashBsonValueCompare(const bson_value_t *value,
 			{
 				int64_t int64Value = BsonValueAsInt64(value);
 				return hash_combine_func(
-					hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+					HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 					hash_bytes_func((uint8_t *) &int64Value, sizeof(int64_t), seed));
 			}
 
 			bson_decimal128_t decimalValue = GetBsonValueAsDecimal128(value);
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) &decimalValue, sizeof(bson_decimal128_t),
 								seed));
 		}
@@ -570,7 +680,7 @@ HashBsonValueCompare(const bson_value_t *value,
 		{
 			typeCodeInt = (int) BSON_TYPE_UTF8;
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) value->value.v_utf8.str,
 								value->value.v_utf8.len, seed));
 		}
@@ -589,15 +699,14 @@ HashBsonValueCompare(const bson_value_t *value,
 			}
 
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				BsonHashCompare(&leftInnerIt, hash_bytes_func, hash_combine_func, seed));
 		}
 
 		case BSON_TYPE_BINARY:
 		{
 			return hash_combine_func(
-				hash_combine_func(hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int),
-												  seed),
+				hash_combine_func(HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 								  hash_bytes_func(
 									  (uint8_t *) &value->value.v_binary.subtype,
 									  sizeof(bson_subtype_t), seed)),
@@ -608,21 +717,21 @@ HashBsonValueCompare(const bson_value_t *value,
 		case BSON_TYPE_OID:
 		{
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) &value->value.v_oid.bytes, 12, seed));
 		}
 
 		case BSON_TYPE_BOOL:
 		{
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) &value->value.v_bool, sizeof(bool), seed));
 		}
 
 		case BSON_TYPE_DATE_TIME:
 		{
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) &value->value.v_datetime, sizeof(int64_t),
 								seed));
 		}
@@ -630,8 +739,7 @@ HashBsonValueCompare(const bson_value_t *value,
 		case BSON_TYPE_TIMESTAMP:
 		{
 			return hash_combine_func(
-				hash_combine_func(hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int),
-												  seed),
+				hash_combine_func(HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 								  hash_bytes_func(
 									  (uint8_t *) &value->value.v_timestamp.increment,
 									  sizeof(uint32_t), seed)),
@@ -641,8 +749,7 @@ HashBsonValueCompare(const bson_value_t *value,
 
 		case BSON_TYPE_REGEX:
 		{
-			uint64 hashValue = hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int),
-											   seed);
+			uint64 hashValue = HashTypeCode(typeCodeInt, hash_bytes_func, seed);
 
 			if (value->value.v_regex.regex != NULL)
 			{
@@ -668,7 +775,7 @@ HashBsonValueCompare(const bson_value_t *value,
 		case BSON_TYPE_DBPOINTER:
 		{
 			uint64 codeHash = hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) value->value.v_dbpointer.collection,
 								value->value.v_dbpointer.collection_len, seed));
 
@@ -682,7 +789,7 @@ HashBsonValueCompare(const bson_value_t *value,
 		case BSON_TYPE_CODE:
 		{
 			return hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) value->value.v_code.code,
 								value->value.v_code.code_len, seed));
 		}
@@ -690,7 +797,7 @@ HashBsonValueCompare(const bson_value_t *value,
 		case BSON_TYPE_CODEWSCOPE:
 		{
 			uint64 codeHash = hash_combine_func(
-				hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed),
+				HashTypeCode(typeCodeInt, hash_bytes_func, seed),
 				hash_bytes_func((uint8_t *) value->value.v_code.code,
 								value->value.v_code.code_len, seed));
 
@@ -711,7 +818,7 @@ HashBsonValueCompare(const bson_value_t *value,
 
 		case BSON_TYPE_MAXKEY:
 		{
-			return hash_bytes_func((uint8_t *) &typeCodeInt, sizeof(int), seed);
+			return HashTypeCode(typeCodeInt, hash_bytes_func, seed);
 		}
 
 		default:
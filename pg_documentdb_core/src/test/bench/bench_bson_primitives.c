@@ -0,0 +1,327 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/test/bench/bench_bson_primitives.c
+ *
+ * Micro-benchmarks for the bson primitives of documentdb_core.
+ *
+ * The benchmarks run inside a backend (the primitives rely on palloc and
+ * ereport) through a function exposed by a standalone test module that
+ * is not part of the extension itself. Each primitive is run over the
+ * whole corpus for the requested number of iterations and reported as
+ * the average time and memory allocated per operation.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <catalog/pg_type.h>
+#include <portability/instr_time.h>
+#include <utils/array.h>
+#include <utils/builtins.h>
+#include <utils/memutils.h>
+
+#include "io/bson_core.h"
+#include "query/bson_compare.h"
+#include "collation/collation.h"
+
+PG_MODULE_MAGIC;
+
+/* The corpus of documents the primitives run over */
+typedef struct BenchCorpus
+{
+	int numDocuments;
+
+	/* The documents as extended json */
+	char **jsonDocuments;
+
+	/* The documents as bson */
+	pgbson **documents;
+
+	/* The top level string values of all documents */
+	int numStrings;
+	bson_value_t *strings;
+} BenchCorpus;
+
+/* A single primitive to benchmark: runs the primitive over the corpus once */
+typedef uint64 (*BenchPrimitiveFunc)(BenchCorpus *corpus, const char *collation);
+
+typedef struct BenchPrimitive
+{
+	const char *name;
+	BenchPrimitiveFunc func;
+} BenchPrimitive;
+
+static uint64 BenchPgbsonInitFromJson(BenchCorpus *corpus, const char *collation);
+static uint64 BenchCompareBsonValue(BenchCorpus *corpus, const char *collation);
+static uint64 BenchBsonValueHash(BenchCorpus *corpus, const char *collation);
+static uint64 BenchPgbsonDeduplicateFields(BenchCorpus *corpus, const char *collation);
+static uint64 BenchPgbsonWriterAppendValue(BenchCorpus *corpus, const char *collation);
+static uint64 BenchStringCompareWithCollation(BenchCorpus *corpus,
+											  const char *collation);
+static BenchCorpus * BuildBenchCorpus(ArrayType *jsonArray);
+
+static const BenchPrimitive BenchPrimitives[] = {
+	{ "PgbsonInitFromJson", BenchPgbsonInitFromJson },
+	{ "CompareBsonValue", BenchCompareBsonValue },
+	{ "BsonValueHash", BenchBsonValueHash },
+	{ "PgbsonDeduplicateFields", BenchPgbsonDeduplicateFields },
+	{ "PgbsonWriterAppendValue", BenchPgbsonWriterAppendValue },
+	{ "StringCompareWithCollation", BenchStringCompareWithCollation },
+};
+
+/*
+ * Keeps the compiler from optimizing away the results of the primitives.
+ */
+static volatile int64 BenchSink = 0;
+
+PG_FUNCTION_INFO_V1(documentdb_core_bench_primitives);
+
+
+/*
+ * documentdb_core_bench_primitives(corpus text[], iterations int, collation text)
+ * runs every primitive over the json documents of the corpus and returns a row
+ * per primitive with the number of operations run, the average nanoseconds per
+ * operation and the average bytes allocated per operation.
+ */
+Datum
+documentdb_core_bench_primitives(PG_FUNCTION_ARGS)
+{
+	ArrayType *jsonArray = PG_GETARG_ARRAYTYPE_P(0);
+	int iterations = PG_GETARG_INT32(1);
+	const char *collation = text_to_cstring(PG_GETARG_TEXT_PP(2));
+
+	if (iterations <= 0)
+	{
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						errmsg("iterations must be a positive number")));
+	}
+
+	InitMaterializedSRF(fcinfo, 0);
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+
+	BenchCorpus *corpus = BuildBenchCorpus(jsonArray);
+
+	MemoryContext benchContext = AllocSetContextCreate(CurrentMemoryContext,
+													   "documentdb core bench",
+													   ALLOCSET_DEFAULT_SIZES);
+
+	for (size_t i = 0; i < lengthof(BenchPrimitives); i++)
+	{
+		const BenchPrimitive *primitive = &BenchPrimitives[i];
+		uint64 operations = 0;
+		Size allocatedBytes = 0;
+		instr_time elapsed;
+		INSTR_TIME_SET_ZERO(elapsed);
+
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			CHECK_FOR_INTERRUPTS();
+
+			MemoryContextReset(benchContext);
+			Size baseline = MemoryContextMemAllocated(benchContext, true);
+			MemoryContext oldContext = MemoryContextSwitchTo(benchContext);
+
+			instr_time start;
+			instr_time end;
+			INSTR_TIME_SET_CURRENT(start);
+			operations += primitive->func(corpus, collation);
+			INSTR_TIME_SET_CURRENT(end);
+
+			MemoryContextSwitchTo(oldContext);
+			INSTR_TIME_ACCUM_DIFF(elapsed, end, start);
+			allocatedBytes += MemoryContextMemAllocated(benchContext, true) - baseline;
+		}
+
+		Datum values[4];
+		bool nulls[4] = { false, false, false, false };
+		values[0] = CStringGetTextDatum(primitive->name);
+		values[1] = Int64GetDatum(operations);
+		values[2] = Float8GetDatum(operations == 0 ? 0 :
+								   INSTR_TIME_GET_DOUBLE(elapsed) * 1e9 / operations);
+		values[3] = Float8GetDatum(operations == 0 ? 0 :
+								   (double) allocatedBytes / operations);
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	MemoryContextDelete(benchContext);
+	PG_RETURN_VOID();
+}
+
+
+/*
+ * Parses the json documents of the corpus and collects the inputs shared by the
+ * primitives.
+ */
+static BenchCorpus *
+BuildBenchCorpus(ArrayType *jsonArray)
+{
+	Datum *elements;
+	bool *nulls;
+	int numElements;
+	deconstruct_array(jsonArray, TEXTOID, -1, false, TYPALIGN_INT,
+					  &elements, &nulls, &numElements);
+
+	BenchCorpus *corpus = palloc0(sizeof(BenchCorpus));
+	corpus->jsonDocuments = palloc0(sizeof(char *) * numElements);
+	corpus->documents = palloc0(sizeof(pgbson *) * numElements);
+
+	List *strings = NIL;
+	for (int i = 0; i < numElements; i++)
+	{
+		if (nulls[i])
+		{
+			continue;
+		}
+
+		char *json = TextDatumGetCString(elements[i]);
+		pgbson *document = PgbsonInitFromJson(json);
+		corpus->jsonDocuments[corpus->numDocuments] = json;
+		corpus->documents[corpus->numDocuments] = document;
+		corpus->numDocuments++;
+
+		bson_iter_t iter;
+		PgbsonInitIterator(document, &iter);
+		while (bson_iter_next(&iter))
+		{
+			if (BSON_ITER_HOLDS_UTF8(&iter))
+			{
+				bson_value_t *value = palloc(sizeof(bson_value_t));
+				*value = *bson_iter_value(&iter);
+				strings = lappend(strings, value);
+			}
+		}
+	}
+
+	if (corpus->numDocuments == 0)
+	{
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						errmsg("the benchmark corpus must not be empty")));
+	}
+
+	corpus->numStrings = list_length(strings);
+	corpus->strings = palloc0(sizeof(bson_value_t) * (corpus->numStrings + 1));
+
+	ListCell *cell;
+	int index = 0;
+	foreach(cell, strings)
+	{
+		corpus->strings[index++] = *(bson_value_t *) lfirst(cell);
+	}
+
+	return corpus;
+}
+
+
+static uint64
+BenchPgbsonInitFromJson(BenchCorpus *corpus, const char *collation)
+{
+	for (int i = 0; i < corpus->numDocuments; i++)
+	{
+		pgbson *document = PgbsonInitFromJson(corpus->jsonDocuments[i]);
+		BenchSink += VARSIZE(document);
+	}
+
+	return corpus->numDocuments;
+}
+
+
+/*
+ * Compares every document with the next one in the corpus (and the last one
+ * with itself so that equal documents are covered as well).
+ */
+static uint64
+BenchCompareBsonValue(BenchCorpus *corpus, const char *collation)
+{
+	for (int i = 0; i < corpus->numDocuments; i++)
+	{
+		int next = i + 1 < corpus->numDocuments ? i + 1 : i;
+		bson_value_t left = ConvertPgbsonToBsonValue(corpus->documents[i]);
+		bson_value_t right = ConvertPgbsonToBsonValue(corpus->documents[next]);
+
+		bool isComparisonValid = false;
+		BenchSink += CompareBsonValueAndType(&left, &right, &isComparisonValid);
+	}
+
+	return corpus->numDocuments;
+}
+
+
+static uint64
+BenchBsonValueHash(BenchCorpus *corpus, const char *collation)
+{
+	const int64 seed = 0;
+	for (int i = 0; i < corpus->numDocuments; i++)
+	{
+		bson_value_t value = ConvertPgbsonToBsonValue(corpus->documents[i]);
+		BenchSink += BsonValueHash(&value, seed);
+	}
+
+	return corpus->numDocuments;
+}
+
+
+static uint64
+BenchPgbsonDeduplicateFields(BenchCorpus *corpus, const char *collation)
+{
+	for (int i = 0; i < corpus->numDocuments; i++)
+	{
+		pgbson *document = PgbsonDeduplicateFields(corpus->documents[i]);
+		BenchSink += VARSIZE(document);
+	}
+
+	return corpus->numDocuments;
+}
+
+
+/*
+ * Rewrites every document field by field, one operation per field appended.
+ */
+static uint64
+BenchPgbsonWriterAppendValue(BenchCorpus *corpus, const char *collation)
+{
+	uint64 operations = 0;
+	for (int i = 0; i < corpus->numDocuments; i++)
+	{
+		pgbson_writer writer;
+		PgbsonWriterInit(&writer);
+
+		bson_iter_t iter;
+		PgbsonInitIterator(corpus->documents[i], &iter);
+		while (bson_iter_next(&iter))
+		{
+			PgbsonWriterAppendValue(&writer, bson_iter_key(&iter),
+									bson_iter_key_len(&iter), bson_iter_value(&iter));
+			operations++;
+		}
+
+		BenchSink += PgbsonWriterGetSize(&writer);
+		PgbsonWriterFree(&writer);
+	}
+
+	return operations;
+}
+
+
+/*
+ * Compares every top level string of the corpus with the next one.
+ */
+static uint64
+BenchStringCompareWithCollation(BenchCorpus *corpus, const char *collation)
+{
+	for (int i = 0; i + 1 < corpus->numStrings; i++)
+	{
+		const bson_value_t *left = &corpus->strings[i];
+		const bson_value_t *right = &corpus->strings[i + 1];
+		BenchSink += StringCompareWithCollation(left->value.v_utf8.str,
+												left->value.v_utf8.len,
+												right->value.v_utf8.str,
+												right->value.v_utf8.len,
+												collation);
+	}
+
+	return corpus->numStrings > 0 ? corpus->numStrings - 1 : 0;
+}
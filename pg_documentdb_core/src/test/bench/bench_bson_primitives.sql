@@ -0,0 +1,25 @@
+-- Runs the documentdb_core bson primitive micro-benchmarks over a corpus of
+-- extended json documents (one per line).
+--
+-- psql -v iterations=<n> -v collation=<icu tag> -f bench_bson_primitives.sql < <corpus>
+
+\set QUIET on
+CREATE EXTENSION IF NOT EXISTS documentdb_core;
+LOAD 'pg_documentdb_core_bench';
+
+CREATE OR REPLACE FUNCTION pg_temp.documentdb_core_bench_primitives(
+    corpus text[], iterations int, collation text,
+    OUT primitive text, OUT operations bigint, OUT ns_per_op float8,
+    OUT bytes_per_op float8)
+RETURNS SETOF record
+LANGUAGE C STRICT
+AS 'pg_documentdb_core_bench', 'documentdb_core_bench_primitives';
+
+CREATE TEMP TABLE bench_corpus (document text);
+\copy bench_corpus FROM pstdin WITH (FORMAT csv, QUOTE e'\x01', DELIMITER e'\x02')
+\set QUIET off
+
+SELECT primitive, operations, round(ns_per_op::numeric, 1) AS ns_per_op,
+       round(bytes_per_op::numeric, 1) AS bytes_per_op
+FROM pg_temp.documentdb_core_bench_primitives(
+    (SELECT array_agg(document) FROM bench_corpus), :iterations, :'collation');
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+#
+# Converts the insertMany() batches of the sample-data shell scripts into
+# extended json documents (one per line) that can be loaded as bson.
+#
+# Usage: sample_data_to_json.py <sample-data dir> <output file>
+
+import json
+import pathlib
+import re
+import sys
+
+DATE_PATTERN = re.compile(r'new Date\("([^"]*)"\)')
+UNQUOTED_KEY_PATTERN = re.compile(r'([{,]\s*)([A-Za-z_$][\w$]*)\s*:')
+TRAILING_COMMA_PATTERN = re.compile(r',(\s*[}\]])')
+INSERT_PATTERN = re.compile(r'db\.(\w+)\.insertMany\(\[')
+
+
+def extract_collection_batches(script):
+    batches = []
+    for match in INSERT_PATTERN.finditer(script):
+        begin = match.end() - 1
+        depth = 0
+        inString = False
+        index = begin
+        while index < len(script):
+            char = script[index]
+            if inString:
+                if char == '\\':
+                    # skip the escaped character
+                    index += 1
+                elif char == '"':
+                    inString = False
+            elif char == '"':
+                inString = True
+            elif char == '[':
+                depth += 1
+            elif char == ']':
+                depth -= 1
+                if depth == 0:
+                    batches.append((match.group(1), script[begin:index + 1]))
+                    break
+            index += 1
+
+    return batches
+
+
+def extract_batches(script):
+    return [batch for _, batch in extract_collection_batches(script)]
+
+
+def to_json(batch):
+    batch = DATE_PATTERN.sub(r'{"$date": "\1"}', batch)
+    batch = UNQUOTED_KEY_PATTERN.sub(r'\1"\2":', batch)
+    batch = TRAILING_COMMA_PATTERN.sub(r'\1', batch)
+    return json.loads(batch)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: sample_data_to_json.py <sample-data dir> <output file>")
+
+    documents = []
+    for script in sorted(pathlib.Path(sys.argv[1]).glob('*.js')):
+        for batch in extract_batches(script.read_text()):
+            documents.extend(to_json(batch))
+
+    with open(sys.argv[2], 'w') as output:
+        for document in documents:
+            output.write(json.dumps(document, separators=(',', ':')) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -19,6 +19,7 @@
 #include <bid_conf.h>
 #include <bid_functions.h>
 #include <math.h>
+#include <common/int.h>
 #include <lib/stringinfo.h>
 
 #include "utils/documentdb_errors.h"
@@ -47,6 +48,20 @@
  */
 #define BID128_EXP_BITS_OFFSET 49
 
+/*
+ * Masks of the high 64 bits of a decimal128 used by the fast paths for small
+ * coefficients. When the two bits after the sign are 11 the value is either
+ * infinity, NaN or uses the large coefficient encoding.
+ */
+#define BID128_SIGN_MASK64 0x8000000000000000ull
+#define BID128_COMBINATION_MASK64 0x6000000000000000ull
+#define BID128_EXP_MASK 0x3fffull
+#define BID128_HIGH_COEFFICIENT_MASK64 0x0001ffffffffffffull
+#define BID128_MAX_BIASED_EXP 12287
+
+/* The largest power of 10 that fits in an int64 */
+#define MAX_INT64_POWER_OF_TEN 18
+
 /* rounding modes can be separately defined while doing any mathematical operations on decimal128 */
 /* For more info: https://en.wikipedia.org/wiki/Floating-point_arithmetic#Rounding_modes */
 typedef enum Decimal128RoundingMode
@@ -106,6 +121,24 @@ typedef enum Decimal128MathOperation
 
 typedef unsigned int _IDEC_flags;
 
+/*
+ * A finite decimal128 whose coefficient fits in an int64. Most decimals stored
+ * in practice (e.g. amounts with a few fractional digits) have this form, which
+ * allows adding, subtracting, multiplying and comparing them with native integer
+ * arithmetic instead of going through the BID library.
+ */
+typedef struct SmallDecimal128
+{
+	/* The signed coefficient */
+	int64_t coefficient;
+
+	/* The biased exponent */
+	int32_t exponent;
+
+	/* The sign bit, kept separately to tell -0 from 0 */
+	bool isNegative;
+} SmallDecimal128;
+
 #define HIGH_BITS(x) (x->value.v_decimal128.high)
 #define LOW_BITS(x) (x->value.v_decimal128.low)
 
@@ -143,6 +176,15 @@ static void LogWith1Operand(const char *logMessage, const BID_UINT128 *op1, cons
 static void LogWith2Operands(const char *logMessage, const BID_UINT128 *op1, const
 							 BID_UINT128 *op2, const _IDEC_flags *flag);
 static Decimal128Result GetDecimal128ResultFromFlag(_IDEC_flags flag);
+static inline bool TryGetSmallDecimal128(const bson_value_t *value,
+										 SmallDecimal128 *smallDecimal);
+static inline void SetSmallDecimal128(int64_t coefficient, int32_t exponent,
+									  bool isNegative, bson_value_t *result);
+static inline bool TryAlignSmallDecimal128Exponents(SmallDecimal128 *x,
+													SmallDecimal128 *y);
+static bool TrySmallDecimal128Operation(const bson_value_t *x, const bson_value_t *y,
+										bson_value_t *result,
+										Decimal128MathOperation operation);
 static int64_t Decimal128ToInt64Floor(const bson_value_t *value, bool *isOverFlow);
 static Decimal128Result RoundOrTruncateDecimal128Number(const bson_value_t *number,
 														int64_t precision,
@@ -631,6 +673,20 @@ int
 CompareBsonDecimal128(const bson_value_t *left, const bson_value_t *right,
 					  bool *isComparisonValid)
 {
+	CheckDecimal128Type(left);
+	CheckDecimal128Type(right);
+
+	/* Fast path for small coefficients whose exponents can be aligned */
+	SmallDecimal128 leftSmall, rightSmall;
+	if (TryGetSmallDecimal128(left, &leftSmall) &&
+		TryGetSmallDecimal128(right, &rightSmall) &&
+		TryAlignSmallDecimal128Exponents(&leftSmall, &rightSmall))
+	{
+		*isComparisonValid = true;
+		return leftSmall.coefficient == rightSmall.coefficient ? 0 :
+			   leftSmall.coefficient > rightSmall.coefficient ? 1 : -1;
+	}
+
 	_IDEC_flags my_fpsf = ALL_EXCEPTION_FLAG_CLEAR;
 
 	BID_UINT128 leftBid = GetBIDUINT128FromBsonValue(left);
@@ -1092,6 +1148,11 @@ Decimal128MathematicalOperation2Operands(const bson_value_t *x, const bson_value
 										 bson_value_t *result, Decimal128MathOperation
 										 operation)
 {
+	if (TrySmallDecimal128Operation(x, y, result, operation))
+	{
+		return Decimal128Result_Success;
+	}
+
 	BID_UINT128 zBid;
 	BID_UINT128 xBid = GetBIDUINT128FromBsonValue(x);
 	BID_UINT128 yBid = GetBIDUINT128FromBsonValue(y);
@@ -1367,6 +1428,156 @@ Decimal128MathematicalOperation1Operand(const bson_value_t *value, bson_value_t
 }
 
 
+/*
+ * Performs add, subtract and multiply with integer arithmetic when both operands
+ * are small decimals. These operations are exact for such operands, so the result
+ * is the same as the one of the BID library: the exponent is the smaller exponent
+ * of the operands for add/subtract and the sum of the exponents for multiply.
+ * Returns false if the operation is not supported, the operands are not small
+ * decimals or the result doesn't fit the fast path, the caller then uses the
+ * BID library.
+ */
+static bool
+TrySmallDecimal128Operation(const bson_value_t *x, const bson_value_t *y,
+							bson_value_t *result, Decimal128MathOperation operation)
+{
+	if (operation != Decimal128MathOperation_Add &&
+		operation != Decimal128MathOperation_Subtract &&
+		operation != Decimal128MathOperation_Multiply)
+	{
+		return false;
+	}
+
+	CheckDecimal128Type(x);
+	CheckDecimal128Type(y);
+
+	SmallDecimal128 xSmall, ySmall;
+	if (!TryGetSmallDecimal128(x, &xSmall) || !TryGetSmallDecimal128(y, &ySmall))
+	{
+		return false;
+	}
+
+	int64_t coefficient;
+	if (operation == Decimal128MathOperation_Multiply)
+	{
+		int32_t exponent = xSmall.exponent + ySmall.exponent - (int32_t) BID128_EXP_BIAS;
+		if (exponent < 0 || exponent > BID128_MAX_BIASED_EXP ||
+			pg_mul_s64_overflow(xSmall.coefficient, ySmall.coefficient, &coefficient))
+		{
+			return false;
+		}
+
+		SetSmallDecimal128(coefficient, exponent,
+						   xSmall.isNegative != ySmall.isNegative, result);
+		return true;
+	}
+
+	if (operation == Decimal128MathOperation_Subtract)
+	{
+		ySmall.coefficient = -ySmall.coefficient;
+		ySmall.isNegative = !ySmall.isNegative;
+	}
+
+	if (!TryAlignSmallDecimal128Exponents(&xSmall, &ySmall) ||
+		pg_add_s64_overflow(xSmall.coefficient, ySmall.coefficient, &coefficient))
+	{
+		return false;
+	}
+
+	/* An exact zero sum is +0 unless both operands are negative (rounding to nearest) */
+	bool isNegative = coefficient < 0 ||
+					  (coefficient == 0 && xSmall.isNegative && ySmall.isNegative);
+	SetSmallDecimal128(coefficient, xSmall.exponent, isNegative, result);
+	return true;
+}
+
+
+/*
+ * Reads the decimal128 value as a SmallDecimal128, returns false if the value is
+ * not finite or its coefficient doesn't fit in an int64.
+ */
+static inline bool
+TryGetSmallDecimal128(const bson_value_t *value, SmallDecimal128 *smallDecimal)
+{
+	uint64_t high = HIGH_BITS(value);
+	uint64_t low = LOW_BITS(value);
+
+	if ((high & BID128_COMBINATION_MASK64) == BID128_COMBINATION_MASK64 ||
+		(high & BID128_HIGH_COEFFICIENT_MASK64) != 0 || low > (uint64_t) PG_INT64_MAX)
+	{
+		return false;
+	}
+
+	smallDecimal->isNegative = (high & BID128_SIGN_MASK64) != 0;
+	smallDecimal->exponent = (int32_t) ((high >> BID128_EXP_BITS_OFFSET) &
+										BID128_EXP_MASK);
+	smallDecimal->coefficient = smallDecimal->isNegative ? -(int64_t) low :
+								(int64_t) low;
+	return true;
+}
+
+
+/*
+ * Writes the coefficient with the biased exponent to result as a decimal128.
+ */
+static inline void
+SetSmallDecimal128(int64_t coefficient, int32_t exponent, bool isNegative,
+				   bson_value_t *result)
+{
+	/* Computed in unsigned arithmetic so that PG_INT64_MIN doesn't overflow */
+	uint64_t magnitude = coefficient < 0 ? -(uint64_t) coefficient :
+						 (uint64_t) coefficient;
+
+	result->value_type = BSON_TYPE_DECIMAL128;
+	result->value.v_decimal128.high = (isNegative ? BID128_SIGN_MASK64 : 0) |
+									  ((uint64_t) exponent << BID128_EXP_BITS_OFFSET);
+	result->value.v_decimal128.low = magnitude;
+}
+
+
+/*
+ * Scales the coefficient of the operand with the larger exponent so that both
+ * operands have the smaller exponent. Returns false if the coefficient overflows.
+ */
+static inline bool
+TryAlignSmallDecimal128Exponents(SmallDecimal128 *x, SmallDecimal128 *y)
+{
+	if (x->exponent == y->exponent)
+	{
+		return true;
+	}
+
+	SmallDecimal128 *larger = x->exponent > y->exponent ? x : y;
+	SmallDecimal128 *smaller = x->exponent > y->exponent ? y : x;
+	int32_t difference = larger->exponent - smaller->exponent;
+	if (difference > MAX_INT64_POWER_OF_TEN)
+	{
+		/* A zero can take any exponent */
+		if (larger->coefficient != 0)
+		{
+			return false;
+		}
+
+		larger->exponent = smaller->exponent;
+		return true;
+	}
+
+	int64_t scale = 1;
+	for (int32_t i = 0; i < difference; i++)
+	{
+		scale *= 10;
+	}
+
+	if (pg_mul_s64_overflow(larger->coefficient, scale, &larger->coefficient))
+	{
+		return false;
+	}
+
+	larger->exponent = smaller->exponent;
+	return true;
+}
+
+
 /**
  * This method returns the Intel Math Library representation from bson decimal128 representation
  */
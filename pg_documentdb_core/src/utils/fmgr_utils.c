@@ -9,7 +9,9 @@
  */
 #include <postgres.h>
 #include <miscadmin.h>
+#include <catalog/pg_proc.h>
 #include <nodes/primnodes.h>
+#include <utils/lsyscache.h>
 
 #include "utils/fmgr_utils.h"
 
@@ -25,7 +27,9 @@
  * that are Const or PARAM_EXTERN (The parameter value that is supplied
  * from outside the plan for a bind variable in sql statement).
  * Function calls/CoerceViaIO calls etc are deemed to be unsafe in this
- * context.
+ * context, with the exception of immutable cast functions over a
+ * Const or PARAM_EXTERN (e.g. $1::bson on a bytea parameter) which are
+ * constant for the execution of the plan as well.
  */
 bool
 IsSafeToReuseFmgrFunctionExtraMultiArgs(PG_FUNCTION_ARGS, int *argLocations, int numArgs)
@@ -79,6 +83,23 @@ IsSafeToReuseFmgrFunctionExtraMultiArgs(PG_FUNCTION_ARGS, int *argLocations, int
 			}
 		}
 
+		/*
+		 * Generic plans keep casts of bind variables (e.g. $1::bson for a bytea
+		 * parameter) as a function call on the Param; these are still constant
+		 * across the rows of an execution if the cast is immutable.
+		 */
+		if (IsA(node, FuncExpr))
+		{
+			FuncExpr *funcExpr = (FuncExpr *) node;
+			if ((funcExpr->funcformat == COERCE_IMPLICIT_CAST ||
+				 funcExpr->funcformat == COERCE_EXPLICIT_CAST) &&
+				list_length(funcExpr->args) == 1 &&
+				func_volatile(funcExpr->funcid) == PROVOLATILE_IMMUTABLE)
+			{
+				node = (Node *) linitial(funcExpr->args);
+			}
+		}
+
 		/* Only allow reusing if the parameter requested is a const or a Param of type extern */
 		if (!IsA(node, Const) &&
 			(!IsA(node, Param) || (((Param *) node)->paramkind != PARAM_EXTERN)))
@@ -434,6 +434,7 @@ typedef struct RumOptions
 	bool useAlternativeOrder;
 	int attachColumn;
 	int addToColumn;
+	int insertBufferSize;       /* in KB, -1 uses documentdb_rum.insert_buffer_size */
 }   RumOptions;
 
 #define ALT_ADD_INFO_NULL_FLAG (0x8000)
@@ -551,6 +552,12 @@ extern Datum rumtuple_get_key(RumState *rumstate, IndexTuple tuple,
 extern void rumGetStats(Relation index, RumStatsData *stats);
 extern void rumUpdateStats(Relation index, const RumStatsData *stats,
 						   bool isBuild);
+extern PGDLLEXPORT bool documentdb_rum_get_path_filter(Relation index, uint8 *filter,
+													   uint32 filterSize);
+extern PGDLLEXPORT void documentdb_rum_update_path_filter(Relation index,
+														  const uint8 *filter,
+														  uint32 filterSize,
+														  bool initialize);
 
 /* ruminsert.c */
 extern IndexBuildResult * rumbuild(Relation heap, Relation index,
@@ -569,6 +576,9 @@ extern bool ruminsert(Relation index, Datum *values, bool *isnull,
 extern void rumEntryInsert(RumState *rumstate,
 						   OffsetNumber attnum, Datum key, RumNullCategory category,
 						   RumItem *items, uint32 nitem, RumStatsData *buildStats);
+#if PG_VERSION_NUM >= 170000
+extern void ruminsertcleanup(Relation index, struct IndexInfo *indexInfo);
+#endif
 
 /* rumbtree.c */
 
@@ -993,6 +1003,8 @@ extern void InitializeRumVacuumState(void);
 extern RumVacuumCycleId rum_start_vacuum_cycle_id(Relation rel);
 extern void rum_end_vacuum_cycle_id(Relation rel);
 extern RumVacuumCycleId rum_vacuum_get_cycleId(Relation rel);
+extern BlockNumber rum_vacuum_get_resume_block(Relation rel);
+extern void rum_vacuum_set_resume_block(Relation rel, BlockNumber blkno);
 
 
 /* rumvalidate.c */
@@ -1088,17 +1100,21 @@ extern PGDLLIMPORT bool RumSkipRetryOnDeletePage;
 extern PGDLLIMPORT bool RumForceOrderedIndexScan;
 extern PGDLLIMPORT bool RumPreferOrderedIndexScan;
 extern PGDLLIMPORT bool RumEnableSkipIntermediateEntry;
+extern PGDLLIMPORT bool RumEnableParallelBackwardOrderedScan;
 extern PGDLLIMPORT bool RumVacuumEntryItems;
 extern PGDLLIMPORT bool RumUseNewItemPtrDecoding;
+extern PGDLLIMPORT bool RumEnableFastItemDecoding;
 extern PGDLLIMPORT bool RumPruneEmptyPages;
 extern PGDLLIMPORT bool RumTrackIncompleteSplit;
 extern PGDLLIMPORT bool RumFixIncompleteSplit;
 extern PGDLLIMPORT bool RumInjectPageSplitIncomplete;
 extern PGDLLIMPORT bool RumEnableParallelVacuumFlags;
 extern PGDLLIMPORT bool RumEnableCustomCostEstimate;
+extern PGDLLIMPORT bool RumEnableStreamingOrderedScanCost;
 extern PGDLLIMPORT bool RumEnableNewBulkDelete;
 extern PGDLLIMPORT bool RumNewBulkDeleteInlineDataPages;
 extern PGDLLIMPORT bool RumVacuumSkipPrunePostingTreePages;
+extern PGDLLIMPORT int RumVacuumMaxPrunePostingTreeEntryPages;
 extern PGDLLIMPORT bool RumEnableSupportDeadIndexItems;
 extern PGDLLIMPORT bool RumSkipResetOnDeadEntryPage;
 
@@ -1332,18 +1348,58 @@ rumDataPageLeafReadWithBlockNumberIncr(Pointer ptr, OffsetNumber attnum, RumItem
 }
 
 
+/*
+ * Reads nitems consecutive items of a posting list or a leaf data page.
+ * In large posting lists most items are close to the prior one: They have a
+ * block number increment below 128, an offset below 64 and no additional info,
+ * and are stored in exactly two bytes. Those are decoded in place without the
+ * generic varbyte loops, and the rest fall back to the generic decoding.
+ */
+static inline Pointer
+rumDataPageLeafReadItemsWithBlockNumberIncr(Pointer ptr, OffsetNumber attnum,
+											RumItem *items, int nitems,
+											bool copyAddInfo, RumState *rumstate,
+											uint64 *blockNumberIncrPtr)
+{
+	bool canDecodeFast = RumEnableFastItemDecoding && !rumstate->useAlternativeOrder;
+	for (int i = 0; i < nitems; i++)
+	{
+		/* Every item takes at least two bytes (block increment and offset) */
+		const unsigned char *bytes = (const unsigned char *) ptr;
+		if (canDecodeFast && (bytes[0] & HIGHBIT) == 0 &&
+			(bytes[1] & (HIGHBIT | SEVENTHBIT)) == SEVENTHBIT &&
+			(bytes[1] & SIXMASK) != InvalidOffsetNumber)
+		{
+			*blockNumberIncrPtr += bytes[0];
+			items[i].iptr.ip_blkid.bi_lo = *blockNumberIncrPtr & 0xFFFF;
+			items[i].iptr.ip_blkid.bi_hi = (*blockNumberIncrPtr >> 16) & 0xFFFF;
+			items[i].iptr.ip_posid = bytes[1] & SIXMASK;
+			items[i].addInfoIsNull = true;
+			items[i].addInfo = (Datum) 0;
+			ptr += 2;
+			continue;
+		}
+
+		ptr = rumDataPageLeafReadWithBlockNumberIncr(ptr, attnum, &items[i],
+													 copyAddInfo, rumstate,
+													 blockNumberIncrPtr);
+	}
+
+	return ptr;
+}
+
+
 inline static void
 rumPopulateDataPage(RumState *rumstate, RumScanEntry entry, OffsetNumber maxoff, Page
 					pageInner)
 {
 	InitBlockNumberIncrZero(blockNumberIncr);
 	Pointer ptr = RumDataPageGetData(pageInner);
-	for (OffsetNumber i = FirstOffsetNumber; i <= maxoff; i = OffsetNumberNext(i))
+	if (maxoff >= FirstOffsetNumber)
 	{
-		ptr = rumDataPageLeafReadWithBlockNumberIncr(ptr, entry->attnum,
-													 &entry->list[i - FirstOffsetNumber],
-													 true,
-													 rumstate, &blockNumberIncr);
+		rumDataPageLeafReadItemsWithBlockNumberIncr(ptr, entry->attnum, entry->list,
+													maxoff - FirstOffsetNumber + 1,
+													true, rumstate, &blockNumberIncr);
 	}
 
 	if (maxoff < 1)
@@ -32,6 +32,9 @@ PGDLLEXPORT bool RumThrowErrorOnInvalidDataPage =
 #define RUM_DEFAULT_USE_NEW_ITEM_PTR_DECODING true
 PGDLLEXPORT bool RumUseNewItemPtrDecoding = RUM_DEFAULT_USE_NEW_ITEM_PTR_DECODING;
 
+#define RUM_DEFAULT_ENABLE_FAST_ITEM_DECODING true
+PGDLLEXPORT bool RumEnableFastItemDecoding = RUM_DEFAULT_ENABLE_FAST_ITEM_DECODING;
+
 #define RUM_ENABLE_PARALLEL_VACUUM_FLAGS true
 PGDLLEXPORT bool RumEnableParallelVacuumFlags = RUM_ENABLE_PARALLEL_VACUUM_FLAGS;
 
@@ -65,10 +68,17 @@ PGDLLEXPORT bool RumPreferOrderedIndexScan = RUM_DEFAULT_PREFER_ORDERED_INDEX_SC
 PGDLLEXPORT bool RumEnableSkipIntermediateEntry =
 	RUM_DEFAULT_ENABLE_SKIP_INTERMEDIATE_ENTRY;
 
+#define RUM_DEFAULT_ENABLE_PARALLEL_BACKWARD_ORDERED_SCAN false
+PGDLLEXPORT bool RumEnableParallelBackwardOrderedScan =
+	RUM_DEFAULT_ENABLE_PARALLEL_BACKWARD_ORDERED_SCAN;
+
 /* ruminsert.c */
 #define RUM_DEFAULT_ENABLE_PARALLEL_INDEX_BUILD true
 PGDLLEXPORT bool RumEnableParallelIndexBuild = RUM_DEFAULT_ENABLE_PARALLEL_INDEX_BUILD;
 
+#define RUM_DEFAULT_INSERT_BUFFER_SIZE 0
+PGDLLEXPORT int RumInsertBufferSize = RUM_DEFAULT_INSERT_BUFFER_SIZE;
+
 #define RUM_DEFAULT_PARALLEL_INDEX_WORKERS_OVERRIDE -1
 PGDLLEXPORT int RumParallelIndexWorkersOverride =
 	RUM_DEFAULT_PARALLEL_INDEX_WORKERS_OVERRIDE;
@@ -94,6 +104,10 @@ PGDLLEXPORT bool RumNewBulkDeleteInlineDataPages =
 PGDLLEXPORT bool RumVacuumSkipPrunePostingTreePages =
 	RUM_DEFAULT_SKIP_PRUNE_POSTING_TREE_PAGES;
 
+#define RUM_DEFAULT_VACUUM_MAX_PRUNE_POSTING_TREE_ENTRY_PAGES 0
+PGDLLEXPORT int RumVacuumMaxPrunePostingTreeEntryPages =
+	RUM_DEFAULT_VACUUM_MAX_PRUNE_POSTING_TREE_ENTRY_PAGES;
+
 #define RUM_DEFAULT_VACUUM_CYCLE_ID_OVERRIDE -1
 int32_t RumVacuumCycleIdOverride = RUM_DEFAULT_VACUUM_CYCLE_ID_OVERRIDE;
 
@@ -114,6 +128,10 @@ PGDLLEXPORT bool RumEnableSupportDeadIndexItems =
 #define RUM_DEFAULT_ENABLE_CUSTOM_COST_ESTIMATE true
 PGDLLEXPORT bool RumEnableCustomCostEstimate = RUM_DEFAULT_ENABLE_CUSTOM_COST_ESTIMATE;
 
+#define RUM_DEFAULT_ENABLE_STREAMING_ORDERED_SCAN_COST false
+PGDLLEXPORT bool RumEnableStreamingOrderedScanCost =
+	RUM_DEFAULT_ENABLE_STREAMING_ORDERED_SCAN_COST;
+
 PGDLLEXPORT rum_format_log_hook rum_unredacted_log_emit_hook = NULL;
 
 
@@ -180,9 +198,19 @@ InitializeCommonDocumentDBGUCs(const char *rumGucPrefix, const
 		PGC_USERSET, 0,
 		NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.insert_buffer_size", documentDBRumGucPrefix),
+		"Sets the memory in KB used to buffer index entries of a statement before merging them "
+		"into the index in sorted batches (default: 0, insert entries directly). Requires PG17 or later.",
+		NULL,
+		&RumInsertBufferSize,
+		RUM_DEFAULT_INSERT_BUFFER_SIZE, 0, MAX_KILOBYTES,
+		PGC_USERSET, GUC_UNIT_KB,
+		NULL, NULL, NULL);
+
 	DefineCustomIntVariable(
 		psprintf("%s.parallel_index_workers_override", documentDBRumGucPrefix),
-		"Sets the number of parallel index workers to use (default: -1, meaning no override)",
+		"Sets the number of parallel index workers to use (default: -1, use the planned workers; 0 disables parallel builds)",
 		NULL,
 		&RumParallelIndexWorkersOverride,
 		RUM_DEFAULT_PARALLEL_INDEX_WORKERS_OVERRIDE, -1, INT_MAX,
@@ -216,6 +244,15 @@ InitializeCommonDocumentDBGUCs(const char *rumGucPrefix, const
 		PGC_USERSET, 0,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enable_parallel_backward_ordered_scan", documentDBRumGucPrefix),
+		"Sets whether or not workers can participate in backward ordered scans",
+		NULL,
+		&RumEnableParallelBackwardOrderedScan,
+		RUM_DEFAULT_ENABLE_PARALLEL_BACKWARD_ORDERED_SCAN,
+		PGC_USERSET, 0,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.vacuum_cleanup_entries", documentDBRumGucPrefix),
 		"Sets whether or not to clean up entries during vacuuming",
@@ -233,6 +270,15 @@ InitializeCommonDocumentDBGUCs(const char *rumGucPrefix, const
 		PGC_USERSET, 0,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enable_fast_item_decoding", documentDBRumGucPrefix),
+		"Sets whether or not to decode two byte item pointers of posting lists in place",
+		NULL,
+		&RumEnableFastItemDecoding,
+		RUM_DEFAULT_ENABLE_FAST_ITEM_DECODING,
+		PGC_USERSET, 0,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enable_inject_page_split_incomplete", documentDBRumGucPrefix),
 		"Test GUC - sets whether or not to enable injecting a failure in the middle of a page split",
@@ -260,6 +306,15 @@ InitializeCommonDocumentDBGUCs(const char *rumGucPrefix, const
 		PGC_USERSET, 0,
 		NULL, NULL, NULL);
 
+	DefineCustomBoolVariable(
+		psprintf("%s.enable_streaming_ordered_scan_cost", documentDBRumGucPrefix),
+		"Sets whether ordered index scans only charge the initial descent as startup cost",
+		NULL,
+		&RumEnableStreamingOrderedScanCost,
+		RUM_DEFAULT_ENABLE_STREAMING_ORDERED_SCAN_COST,
+		PGC_USERSET, 0,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.prune_rum_empty_pages", documentDBRumGucPrefix),
 		"Sets whether or not to prune empty pages during vacuuming",
@@ -296,6 +351,16 @@ InitializeCommonDocumentDBGUCs(const char *rumGucPrefix, const
 		PGC_USERSET, 0,
 		NULL, NULL, NULL);
 
+	DefineCustomIntVariable(
+		psprintf("%s.vacuum_max_prune_posting_tree_entry_pages", documentDBRumGucPrefix),
+		"Sets the maximum number of entry leaf pages whose posting trees are pruned in a single vacuum cleanup "
+		"(default: 0, prune the whole index). Subsequent vacuums resume where the previous one stopped.",
+		NULL,
+		&RumVacuumMaxPrunePostingTreeEntryPages,
+		RUM_DEFAULT_VACUUM_MAX_PRUNE_POSTING_TREE_ENTRY_PAGES, 0, INT_MAX,
+		PGC_USERSET, 0,
+		NULL, NULL, NULL);
+
 	DefineCustomBoolVariable(
 		psprintf("%s.enable_support_dead_index_items", documentDBRumGucPrefix),
 		"Sets whether or not to enable support for handling LP_DEAD items",
@@ -366,6 +431,13 @@ InitializeCommonDocumentDBGUCs(const char *rumGucPrefix, const
 					   , AccessExclusiveLock
 #endif
 					   );
+	add_int_reloption(rum_relopt_kind, "insert_buffer_size",
+					  "Memory in KB used to buffer index entries of a statement (-1 uses the server setting)",
+					  -1, -1, MAX_KILOBYTES
+#if PG_VERSION_NUM >= 130000
+					  , ShareUpdateExclusiveLock
+#endif
+					  );
 }
 
 
@@ -379,13 +451,16 @@ documentdb_rumoptions(Datum reloptions, bool validate)
 		  offsetIfDefault },
 		{ "to", RELOPT_TYPE_STRING, offsetof(RumOptions, addToColumn), offsetIfDefault },
 		{ "order_by_attach", RELOPT_TYPE_BOOL, offsetof(RumOptions, useAlternativeOrder),
+		  offsetIfDefault },
+		{ "insert_buffer_size", RELOPT_TYPE_INT, offsetof(RumOptions, insertBufferSize),
 		  offsetIfDefault }
 	};
 #else
 	static const relopt_parse_elt tab[] = {
 		{ "attach", RELOPT_TYPE_STRING, offsetof(RumOptions, attachColumn) },
 		{ "to", RELOPT_TYPE_STRING, offsetof(RumOptions, addToColumn) },
-		{ "order_by_attach", RELOPT_TYPE_BOOL, offsetof(RumOptions, useAlternativeOrder) }
+		{ "order_by_attach", RELOPT_TYPE_BOOL, offsetof(RumOptions, useAlternativeOrder) },
+		{ "insert_buffer_size", RELOPT_TYPE_INT, offsetof(RumOptions, insertBufferSize) }
 	};
 #endif
 
@@ -32,12 +32,9 @@ rumReadTuple(RumState *rumstate, OffsetNumber attnum,
 	if (RumUseNewItemPtrDecoding)
 	{
 		InitBlockNumberIncr(blockNumberIncr, (&item.iptr));
-		for (i = 0; i < nipd; i++)
-		{
-			ptr = rumDataPageLeafReadWithBlockNumberIncr(ptr, attnum, &item, copyAddInfo,
-														 rumstate, &blockNumberIncr);
-			items[i] = item;
-		}
+		rumDataPageLeafReadItemsWithBlockNumberIncr(ptr, attnum, items, nipd,
+													copyAddInfo, rumstate,
+													&blockNumberIncr);
 	}
 	else
 	{
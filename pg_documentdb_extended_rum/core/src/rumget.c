@@ -3947,84 +3947,91 @@ MoveBuffersForOrderedScanParallel(RumScanOpaque so, RumBtree btree, ParallelInde
 								  parallelScan)
 {
 	RumOrderByScanData *scanData = so->orderByScanData;
+	bool isForward = ScanDirectionIsForward(so->orderScanDirection);
 	Page page;
-	if (ScanDirectionIsForward(so->orderScanDirection))
+
+	/*
+	 * Workers seize the leaf pages one at a time in the scan direction, so the
+	 * entries each worker returns are in index order and their streams can be
+	 * merged by a Gather Merge.
+	 */
+	if (scanData->isPageValid &&
+		(isForward ?
+		 scanData->orderStack->off <= PageGetMaxOffsetNumber(
+			 scanData->orderByEntryPageCopy) :
+		 scanData->orderStack->off >= FirstOffsetNumber))
 	{
-		if (scanData->isPageValid &&
-			scanData->orderStack->off <= PageGetMaxOffsetNumber(
-				scanData->orderByEntryPageCopy))
-		{
-			/* Current page is still valid */
-			return true;
-		}
+		/* Current page is still valid */
+		return true;
+	}
+
+	/* About to move pages, kill entries if needed */
+	if (scanData->isPageValid && RumEnableSupportDeadIndexItems &&
+		so->numKilled > 0)
+	{
+		RumKillEntryItems(so, scanData);
+	}
 
-		/* About to move pages, kill entries if needed */
-		if (scanData->isPageValid && RumEnableSupportDeadIndexItems &&
-			so->numKilled > 0)
+	while (true)
+	{
+		BlockNumber startingBlock;
+		bool hasMore = rum_parallel_seize(parallelScan, &startingBlock);
+		if (!hasMore)
 		{
-			RumKillEntryItems(so, scanData);
+			return false;
 		}
 
-		while (true)
+		if (startingBlock == InvalidBlockNumber)
 		{
-			BlockNumber startingBlock;
-			bool hasMore = rum_parallel_seize(parallelScan, &startingBlock);
-			if (!hasMore)
-			{
-				return false;
-			}
-
-			if (startingBlock == InvalidBlockNumber)
-			{
-				/* We won the race and have registered the starting block
-				 * start by copying this and moving forward on this buffer while
-				 * notifying the parallel state that we've currently processed this block.
-				 */
-				LockBuffer(scanData->orderStack->buffer, RUM_SHARE);
-				page = BufferGetPage(scanData->orderStack->buffer);
-				CopyPageContents(page, scanData->orderByEntryPageCopy);
-				scanData->isPageValid = true;
-
-				/* In the forward scan we store the right link as read right now in the parallel data */
-				rum_parallel_release(parallelScan, RumPageRightLink(page));
-				LockBuffer(scanData->orderStack->buffer, RUM_UNLOCK);
-				return true;
-			}
-
-			/*
-			 * Some other thread had updated the parallel state already, this page is the right sibling of
-			 * the page that was last scanned. We now hold the lock on traversal of pages. The current page
-			 * is considered valid if it's not dead.
+			/* We won the race and have registered the starting block
+			 * start by copying this and moving forward on this buffer while
+			 * notifying the parallel state that we've currently processed this block.
+			 * The offset is where startScan positioned the scan on the page.
 			 */
-			ReleaseBuffer(scanData->orderStack->buffer);
-			scanData->orderStack->blkno = startingBlock;
-			scanData->orderStack->buffer = ReadBuffer(btree->index, startingBlock);
 			LockBuffer(scanData->orderStack->buffer, RUM_SHARE);
 			page = BufferGetPage(scanData->orderStack->buffer);
+			CopyPageContents(page, scanData->orderByEntryPageCopy);
+			scanData->isPageValid = true;
 
-			/* Let other threads move on with the next buffer */
-			/* In the forward scan we store the right link as read right now in the parallel data */
-			rum_parallel_release(parallelScan, RumPageRightLink(page));
-			if (RumPageIsDeleted(page) || RumPageIsHalfDead(page))
-			{
-				/* TODO: Should we release here? */
-				continue;
-			}
-			else
-			{
-				/* The page is valid - use it */
-				CopyPageContents(page, scanData->orderByEntryPageCopy);
-				scanData->isPageValid = true;
+			/* We store the sibling in the scan direction as read right now in the parallel data */
+			rum_parallel_release(parallelScan, isForward ? RumPageRightLink(page) :
+								 RumPageLeftLink(page));
+			LockBuffer(scanData->orderStack->buffer, RUM_UNLOCK);
+			return true;
+		}
 
-				LockBuffer(scanData->orderStack->buffer, RUM_UNLOCK);
-				return true;
-			}
+		/*
+		 * Some other thread had updated the parallel state already, this page is the sibling of
+		 * the page that was last scanned. We now hold the lock on traversal of pages. The current page
+		 * is considered valid if it's not dead.
+		 */
+		ReleaseBuffer(scanData->orderStack->buffer);
+		scanData->orderStack->blkno = startingBlock;
+		scanData->orderStack->buffer = ReadBuffer(btree->index, startingBlock);
+		LockBuffer(scanData->orderStack->buffer, RUM_SHARE);
+		page = BufferGetPage(scanData->orderStack->buffer);
+
+		/* Let other threads move on with the next buffer */
+		rum_parallel_release(parallelScan, isForward ? RumPageRightLink(page) :
+							 RumPageLeftLink(page));
+		if (RumPageIsDeleted(page) || RumPageIsHalfDead(page))
+		{
+			/* TODO: Should we release here? */
+			LockBuffer(scanData->orderStack->buffer, RUM_UNLOCK);
+			continue;
+		}
+		else
+		{
+			/* The page is valid - use it from its first entry in the scan direction */
+			CopyPageContents(page, scanData->orderByEntryPageCopy);
+			scanData->isPageValid = true;
+			scanData->orderStack->off = isForward ? FirstOffsetNumber :
+										PageGetMaxOffsetNumber(
+				scanData->orderByEntryPageCopy);
+
+			LockBuffer(scanData->orderStack->buffer, RUM_UNLOCK);
+			return true;
 		}
-	}
-	else
-	{
-		/* Backward scan logic */
-		ereport(ERROR, (errmsg("TODO : IMPLEMENT ME")));
 	}
 }
 
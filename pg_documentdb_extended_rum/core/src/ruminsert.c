@@ -41,6 +41,34 @@
 
 extern bool RumEnableParallelIndexBuild;
 extern int RumParallelIndexWorkersOverride;
+extern int RumInsertBufferSize;
+
+#if PG_VERSION_NUM >= 170000
+
+/*
+ * State of the per statement insert buffer, kept in the IndexInfo's
+ * ii_AmCache. Index entries of the inserted tuples are accumulated in
+ * sorted order and merged into the entry and posting trees in batches,
+ * once the buffer fills up and when the executor closes the index at the
+ * end of the statement (ruminsertcleanup).
+ */
+typedef struct RumInsertBuffer
+{
+	RumState rumstate;
+	BuildAccumulator accum;
+
+	/* Holds the accumulated entries, reset on every flush */
+	MemoryContext accumCtx;
+
+	/* Short lived context for extracting entries of a single tuple */
+	MemoryContext funcCtx;
+
+	/* Flush threshold in bytes */
+	long maxMemory;
+} RumInsertBuffer;
+
+static void rumInsertBufferFlush(RumInsertBuffer *buffer);
+#endif
 
 extern PGDLLEXPORT void documentdb_rum_parallel_build_main(dsm_segment *seg,
 														   shm_toc *toc);
@@ -2328,9 +2356,17 @@ rumbuild_parallel(Relation heap, Relation index, struct IndexInfo *indexInfo,
 	 * reasonable too, because we sort the data just like btree. It does
 	 * ignore the memory used to accumulate data in memory (set by work_mem),
 	 * but there is no way to communicate that to plan_create_index_workers.
+	 *
+	 * The planned number of workers (which honors max_parallel_maintenance_workers
+	 * and the parallel_workers reloption of the table) is used unless the override
+	 * is set: 0 disables the parallel build and a positive value replaces it.
 	 */
+	if (!canBuildParallel || RumParallelIndexWorkersOverride == 0)
+	{
+		indexInfo->ii_ParallelWorkers = 0;
+	}
 #if PG_VERSION_NUM >= 160000
-	if (RumParallelIndexWorkersOverride > 0 && canBuildParallel)
+	else if (RumParallelIndexWorkersOverride > 0)
 	{
 		int parallel_workers = RumParallelIndexWorkersOverride;
 		parallel_workers = Min(parallel_workers,
@@ -2347,9 +2383,7 @@ rumbuild_parallel(Relation heap, Relation index, struct IndexInfo *indexInfo,
 	}
 #endif
 
-	if (indexInfo->ii_ParallelWorkers > 0 &&
-		RumParallelIndexWorkersOverride > 0 &&
-		canBuildParallel)
+	if (indexInfo->ii_ParallelWorkers > 0)
 	{
 		ereport(DEBUG1, (errmsg("parallel index build requested with %d workers",
 								indexInfo->ii_ParallelWorkers)));
@@ -2368,7 +2402,6 @@ rumbuild_parallel(Relation heap, Relation index, struct IndexInfo *indexInfo,
 	 */
 	if (buildstate->bs_leader)
 	{
-		/* TODO: Enable parallel index build here */
 		SortCoordinate coordinate;
 
 		coordinate = (SortCoordinate) palloc0(sizeof(SortCoordinateData));
@@ -2535,6 +2568,180 @@ rumHeapTupleInsert(RumState *rumstate, OffsetNumber attnum,
 }
 
 
+#if PG_VERSION_NUM >= 170000
+
+/*
+ * Returns the size in KB of the insert buffer to use for the index, 0
+ * if entries should be inserted directly.
+ */
+static int
+RumGetInsertBufferSize(Relation index)
+{
+	if (index->rd_options)
+	{
+		RumOptions *options = (RumOptions *) index->rd_options;
+		if (options->insertBufferSize >= 0)
+		{
+			return options->insertBufferSize;
+		}
+	}
+
+	return RumInsertBufferSize;
+}
+
+
+static RumInsertBuffer *
+rumInitInsertBuffer(Relation index, struct IndexInfo *indexInfo, int bufferSizeKb)
+{
+	MemoryContext oldCtx = MemoryContextSwitchTo(indexInfo->ii_Context);
+	RumInsertBuffer *buffer = palloc0(sizeof(RumInsertBuffer));
+
+	initRumState(&buffer->rumstate, index);
+	buffer->accumCtx = RumContextCreate(indexInfo->ii_Context,
+										"Rum insert buffer context");
+	buffer->funcCtx = RumContextCreate(indexInfo->ii_Context,
+									   "Rum insert buffer temporary context");
+	buffer->maxMemory = bufferSizeKb * 1024L;
+
+	MemoryContextSwitchTo(buffer->accumCtx);
+	rumInitBA(&buffer->accum);
+	buffer->accum.rumstate = &buffer->rumstate;
+
+	MemoryContextSwitchTo(oldCtx);
+	return buffer;
+}
+
+
+/*
+ * Extract index entries for a single indexable item, and add them to the
+ * insert buffer. Mirrors rumHeapTupleBulkInsert.
+ */
+static void
+rumHeapTupleBufferedInsert(RumInsertBuffer *buffer, OffsetNumber attnum,
+						   Datum value, bool isNull,
+						   ItemPointer heapptr,
+						   Datum outerAddInfo,
+						   bool outerAddInfoIsNull)
+{
+	Datum *entries;
+	RumNullCategory *categories;
+	int32 nentries;
+	MemoryContext oldCtx;
+	Datum *addInfo;
+	bool *addInfoIsNull;
+	int i;
+	Form_pg_attribute attr = buffer->rumstate.addAttrs[attnum - 1];
+
+	oldCtx = MemoryContextSwitchTo(buffer->funcCtx);
+	entries = rumExtractEntries(&buffer->rumstate, attnum, value, isNull,
+								&nentries, &categories, &addInfo, &addInfoIsNull);
+
+	if (attnum == buffer->rumstate.attrnAddToColumn)
+	{
+		addInfo = palloc(sizeof(*addInfo) * nentries);
+		addInfoIsNull = palloc(sizeof(*addInfoIsNull) * nentries);
+
+		for (i = 0; i < nentries; i++)
+		{
+			addInfo[i] = outerAddInfo;
+			addInfoIsNull[i] = outerAddInfoIsNull;
+		}
+	}
+
+	MemoryContextSwitchTo(buffer->accumCtx);
+	for (i = 0; i < nentries; i++)
+	{
+		if (!addInfoIsNull[i])
+		{
+			/* Check existance of additional information attribute in index */
+			if (!attr)
+			{
+				Form_pg_attribute current_attr = RumTupleDescAttr(
+					buffer->rumstate.origTupdesc, attnum - 1);
+
+				elog(ERROR,
+					 "additional information attribute \"%s\" is not found in index",
+					 NameStr(current_attr->attname));
+			}
+
+			addInfo[i] = datumCopy(addInfo[i], attr->attbyval, attr->attlen);
+		}
+	}
+
+	rumInsertBAEntries(&buffer->accum, heapptr, attnum,
+					   entries, addInfo, addInfoIsNull, categories, nentries);
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextReset(buffer->funcCtx);
+}
+
+
+/*
+ * Merges the buffered entries into the index in key order, inserting all
+ * the items of a key with a single descent of the entry tree.
+ */
+static void
+rumInsertBufferFlush(RumInsertBuffer *buffer)
+{
+	RumItem *items;
+	Datum key;
+	RumNullCategory category;
+	uint32 nlist;
+	OffsetNumber attnum;
+	MemoryContext oldCtx;
+
+	if (buffer->accum.eas_used == 0)
+	{
+		return;
+	}
+
+	oldCtx = MemoryContextSwitchTo(buffer->funcCtx);
+
+	rumBeginBAScan(&buffer->accum);
+	while ((items = rumGetBAEntry(&buffer->accum,
+								  &attnum, &key, &category, &nlist)) != NULL)
+	{
+		CHECK_FOR_INTERRUPTS();
+		rumEntryInsert(&buffer->rumstate, attnum, key, category,
+					   items, nlist, NULL);
+		MemoryContextReset(buffer->funcCtx);
+	}
+
+	MemoryContextSwitchTo(oldCtx);
+
+	MemoryContextReset(buffer->accumCtx);
+	oldCtx = MemoryContextSwitchTo(buffer->accumCtx);
+	rumInitBA(&buffer->accum);
+	buffer->accum.rumstate = &buffer->rumstate;
+	MemoryContextSwitchTo(oldCtx);
+}
+
+
+/*
+ * Called by the executor when it closes the index at the end of the
+ * statement: merges whatever is left in the insert buffer, so that the
+ * entries are in the index before any later command can see the rows.
+ */
+void
+ruminsertcleanup(Relation index, struct IndexInfo *indexInfo)
+{
+	RumInsertBuffer *buffer = (RumInsertBuffer *) indexInfo->ii_AmCache;
+
+	if (buffer == NULL)
+	{
+		return;
+	}
+
+	rumInsertBufferFlush(buffer);
+	MemoryContextDelete(buffer->accumCtx);
+	MemoryContextDelete(buffer->funcCtx);
+	indexInfo->ii_AmCache = NULL;
+}
+
+
+#endif
+
+
 bool
 ruminsert(Relation index, Datum *values, bool *isnull,
 		  ItemPointer ht_ctid, Relation heapRel,
@@ -2554,6 +2761,52 @@ ruminsert(Relation index, Datum *values, bool *isnull,
 	Datum outerAddInfo = (Datum) 0;
 	bool outerAddInfoIsNull = true;
 
+#if PG_VERSION_NUM >= 170000
+
+	/*
+	 * Buffer the entries for a batched merge unless the index enforces a
+	 * constraint: unique and exclusion checks scan the index right after
+	 * the insert and must see the new entries.
+	 */
+	if (indexInfo != NULL && checkUnique == UNIQUE_CHECK_NO &&
+		indexInfo->ii_ExclusionOps == NULL)
+	{
+		RumInsertBuffer *buffer = (RumInsertBuffer *) indexInfo->ii_AmCache;
+		if (buffer == NULL)
+		{
+			int bufferSizeKb = RumGetInsertBufferSize(index);
+			if (bufferSizeKb > 0)
+			{
+				buffer = rumInitInsertBuffer(index, indexInfo, bufferSizeKb);
+				indexInfo->ii_AmCache = buffer;
+			}
+		}
+
+		if (buffer != NULL)
+		{
+			if (AttributeNumberIsValid(buffer->rumstate.attrnAttachColumn))
+			{
+				outerAddInfo = values[buffer->rumstate.attrnAttachColumn - 1];
+				outerAddInfoIsNull = isnull[buffer->rumstate.attrnAttachColumn - 1];
+			}
+
+			for (i = 0; i < buffer->rumstate.origTupdesc->natts; i++)
+			{
+				rumHeapTupleBufferedInsert(buffer, (OffsetNumber) (i + 1),
+										   values[i], isnull[i], ht_ctid,
+										   outerAddInfo, outerAddInfoIsNull);
+			}
+
+			if (buffer->accum.allocatedMemory >= buffer->maxMemory)
+			{
+				rumInsertBufferFlush(buffer);
+			}
+
+			return false;
+		}
+	}
+#endif
+
 	insertCtx = RumContextCreate(CurrentMemoryContext,
 								 "Rum insert temporary context");
 
@@ -1234,7 +1234,8 @@ rum_parallel_scan_start_notify(IndexScanDesc scan)
 	LWLockAcquire(&psdata->rum_ps_lock, LW_EXCLUSIVE);
 	psdata->parallel_scan_state = RumParallelScanState_StartScanDone;
 	psdata->isParallelScanEligible = so->scanType == RumOrderedScan &&
-									 ScanDirectionIsForward(so->orderScanDirection);
+									 (ScanDirectionIsForward(so->orderScanDirection) ||
+									  RumEnableParallelBackwardOrderedScan);
 	psdata->rum_ps_current_page = InvalidBlockNumber;
 	isParallelEnabled = psdata->isParallelScanEligible;
 	LWLockRelease(&psdata->rum_ps_lock);
@@ -488,6 +488,28 @@ RumCostEstimateCore(PlannerInfo *root, IndexPath *path, double loop_count,
 	/* Now add a cpu cost per tuple in the posting lists / trees */
 	*indexTotalCost += (numTuples * *indexSelectivity) * (cpu_index_tuple_cost);
 	*indexPages = dataPagesFetched;
+
+	/*
+	 * An ordered scan streams the entries in index order instead of collecting
+	 * the partial matches up front, so a LIMIT on top of it stops after reading
+	 * about as many entries as it returns. Only charge the entry tree descent
+	 * for each search entry as the startup cost so that the planner pro-rates
+	 * the rest of the scan for such plans. The total cost is unchanged.
+	 */
+	if (RumEnableStreamingOrderedScanCost && path->indexorderbys != NIL)
+	{
+		Cost streamingStartupCost = qual_arg_cost +
+									counts.searchEntries *
+									(DEFAULT_PAGE_CPU_MULTIPLIER * cpu_operator_cost +
+									 spc_random_page_cost);
+		if (numEntries > 1)
+		{
+			streamingStartupCost += ceil(log(numEntries) / log(2.0)) *
+									cpu_operator_cost * counts.searchEntries;
+		}
+
+		*indexStartupCost = Min(*indexStartupCost, streamingStartupCost);
+	}
 }
 
 
@@ -40,7 +40,27 @@ typedef struct RumSharedVacInfo
 	RumSingleVacInfo vacuums[FLEXIBLE_ARRAY_MEMBER];
 } RumSharedVacInfo;
 
+/*
+ * Number of indexes for which the progress of an incremental vacuum
+ * cleanup is remembered. When all slots are in use, the slot that was
+ * assigned the longest ago is reused.
+ */
+#define RUM_VACUUM_PROGRESS_SLOTS 256
+
+typedef struct RumSingleVacProgress
+{
+	LockRelId relid;             /* global identifier of an index */
+	BlockNumber resumeBlkno;     /* entry page to resume posting tree pruning at */
+} RumSingleVacProgress;
+
+typedef struct RumSharedVacProgress
+{
+	int next_slot;                      /* next slot to reuse when all are taken */
+	RumSingleVacProgress progress[RUM_VACUUM_PROGRESS_SLOTS];
+} RumSharedVacProgress;
+
 PGDLLEXPORT RumSharedVacInfo *rumSharedVacInfo;
+static RumSharedVacProgress *rumSharedVacProgress;
 extern int32_t RumVacuumCycleIdOverride;
 
 PGDLLEXPORT int RumParallelScanTrancheId = 0;
@@ -62,6 +82,7 @@ RumVacuumShmemSize(void)
 
 	size = offsetof(RumSharedVacInfo, vacuums);
 	size = add_size(size, mul_size(MaxBackends, sizeof(RumSingleVacInfo)));
+	size = add_size(size, MAXALIGN(sizeof(RumSharedVacProgress)));
 	return size;
 }
 
@@ -74,6 +95,8 @@ RumVacuumShmemInit(void)
 	rumSharedVacInfo = (RumSharedVacInfo *) ShmemInitStruct("RUM Shared Vacuum State",
 															RumVacuumShmemSize(),
 															&found);
+	rumSharedVacProgress = (RumSharedVacProgress *) ShmemInitStruct(
+		"RUM Shared Vacuum Progress", sizeof(RumSharedVacProgress), &found);
 
 	if (!IsUnderPostmaster)
 	{
@@ -89,6 +112,8 @@ RumVacuumShmemInit(void)
 
 		rumSharedVacInfo->num_vacuums = 0;
 		rumSharedVacInfo->max_vacuums = MaxBackends;
+
+		memset(rumSharedVacProgress, 0, sizeof(RumSharedVacProgress));
 	}
 	else
 	{
@@ -277,3 +302,89 @@ rum_vacuum_get_cycleId(Relation rel)
 	LWLockRelease(BtreeVacuumLock);
 	return result;
 }
+
+
+/*
+ * Returns the entry page at which the previous incremental vacuum cleanup
+ * of the index stopped pruning posting trees, or InvalidBlockNumber if the
+ * previous cleanup completed a full pass (or none was recorded).
+ */
+PGDLLEXPORT BlockNumber
+rum_vacuum_get_resume_block(Relation rel)
+{
+	BlockNumber result = InvalidBlockNumber;
+	int i;
+
+	LWLockAcquire(BtreeVacuumLock, LW_SHARED);
+
+	for (i = 0; i < RUM_VACUUM_PROGRESS_SLOTS; i++)
+	{
+		RumSingleVacProgress *progress = &rumSharedVacProgress->progress[i];
+
+		if (progress->relid.relId == rel->rd_lockInfo.lockRelId.relId &&
+			progress->relid.dbId == rel->rd_lockInfo.lockRelId.dbId)
+		{
+			result = progress->resumeBlkno;
+			break;
+		}
+	}
+
+	LWLockRelease(BtreeVacuumLock);
+	return result;
+}
+
+
+/*
+ * Records the entry page at which the next incremental vacuum cleanup of
+ * the index should resume pruning posting trees. Passing InvalidBlockNumber
+ * clears the progress so that the next cleanup starts from the first page.
+ */
+PGDLLEXPORT void
+rum_vacuum_set_resume_block(Relation rel, BlockNumber blkno)
+{
+	RumSingleVacProgress *freeSlot = NULL;
+	int i;
+
+	LWLockAcquire(BtreeVacuumLock, LW_EXCLUSIVE);
+
+	for (i = 0; i < RUM_VACUUM_PROGRESS_SLOTS; i++)
+	{
+		RumSingleVacProgress *progress = &rumSharedVacProgress->progress[i];
+
+		if (progress->relid.relId == rel->rd_lockInfo.lockRelId.relId &&
+			progress->relid.dbId == rel->rd_lockInfo.lockRelId.dbId)
+		{
+			if (blkno == InvalidBlockNumber)
+			{
+				memset(progress, 0, sizeof(RumSingleVacProgress));
+			}
+			else
+			{
+				progress->resumeBlkno = blkno;
+			}
+
+			LWLockRelease(BtreeVacuumLock);
+			return;
+		}
+
+		if (freeSlot == NULL && progress->relid.relId == InvalidOid)
+		{
+			freeSlot = progress;
+		}
+	}
+
+	if (blkno != InvalidBlockNumber)
+	{
+		if (freeSlot == NULL)
+		{
+			freeSlot = &rumSharedVacProgress->progress[rumSharedVacProgress->next_slot];
+			rumSharedVacProgress->next_slot = (rumSharedVacProgress->next_slot + 1) %
+											  RUM_VACUUM_PROGRESS_SLOTS;
+		}
+
+		freeSlot->relid = rel->rd_lockInfo.lockRelId;
+		freeSlot->resumeBlkno = blkno;
+	}
+
+	LWLockRelease(BtreeVacuumLock);
+}
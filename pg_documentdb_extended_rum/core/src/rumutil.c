@@ -167,6 +167,9 @@ documentdb_rumhandler(PG_FUNCTION_ARGS)
 	amroutine->ambuild = rumbuild;
 	amroutine->ambuildempty = rumbuildempty;
 	amroutine->aminsert = ruminsert;
+#if PG_VERSION_NUM >= 170000
+	amroutine->aminsertcleanup = ruminsertcleanup;
+#endif
 	amroutine->ambulkdelete = rumbulkdelete;
 	amroutine->amvacuumcleanup = rumvacuumcleanup;
 	amroutine->amcanreturn = NULL;
@@ -1132,6 +1135,135 @@ rumGetStats(Relation index, RumStatsData *stats)
 }
 
 
+/*
+ * The path filter is an opaque bitmap that the index's owner maintains in the
+ * free space of the metapage, right after RumMetaPageData. The unused
+ * tailFreeSize of the (removed) pending list records its size: a zero size
+ * means the index has no filter (e.g. the filter was never initialized for the
+ * index since it was created before filters existed).
+ */
+#define RumPageGetPathFilter(page) \
+	((uint8 *) PageGetContents(page) + MAXALIGN(sizeof(RumMetaPageData)))
+
+#define RUM_MAX_PATH_FILTER_SIZE \
+	(BLCKSZ - MAXALIGN(SizeOfPageHeaderData) - MAXALIGN(sizeof(RumMetaPageData)) - \
+	 MAXALIGN(sizeof(RumPageOpaqueData)))
+
+
+/*
+ * Returns true if the index has a path filter of the requested size. When
+ * filter is not NULL the filter is copied into it.
+ */
+PGDLLEXPORT bool
+documentdb_rum_get_path_filter(Relation index, uint8 *filter, uint32 filterSize)
+{
+	Buffer metabuffer;
+	Page metapage;
+	RumMetaPageData *metadata;
+	bool hasFilter;
+
+	metabuffer = ReadBuffer(index, RUM_METAPAGE_BLKNO);
+	LockBuffer(metabuffer, RUM_SHARE);
+	metapage = BufferGetPage(metabuffer);
+	metadata = RumPageGetMeta(metapage);
+
+	hasFilter = filterSize > 0 && metadata->tailFreeSize == filterSize;
+	if (hasFilter && filter != NULL)
+	{
+		memcpy(filter, RumPageGetPathFilter(metapage), filterSize);
+	}
+
+	UnlockReleaseBuffer(metabuffer);
+	return hasFilter;
+}
+
+
+/*
+ * Merges (ORs) the given bits into the path filter of the index. If
+ * initialize is true, the filter is (re)created with the given bits -
+ * this is only valid when the bits cover every tuple in the index, e.g.
+ * right after build. Otherwise, the bits are only merged if the index
+ * already has a filter, and no WAL is written if no new bits are set.
+ */
+PGDLLEXPORT void
+documentdb_rum_update_path_filter(Relation index, const uint8 *filter,
+								  uint32 filterSize, bool initialize)
+{
+	Buffer metaBuffer;
+	Page metapage;
+	RumMetaPageData *metadata;
+	GenericXLogState *state;
+	uint8 *pageFilter;
+	uint32 i;
+	bool hasNewBits = false;
+
+	if (filterSize == 0 || filterSize > RUM_MAX_PATH_FILTER_SIZE)
+	{
+		elog(ERROR, "invalid path filter size %u", filterSize);
+	}
+
+	metaBuffer = ReadBuffer(index, RUM_METAPAGE_BLKNO);
+	LockBuffer(metaBuffer, initialize ? RUM_EXCLUSIVE : RUM_SHARE);
+	metapage = BufferGetPage(metaBuffer);
+	metadata = RumPageGetMeta(metapage);
+
+	if (!initialize)
+	{
+		if (metadata->tailFreeSize != filterSize)
+		{
+			UnlockReleaseBuffer(metaBuffer);
+			return;
+		}
+
+		pageFilter = RumPageGetPathFilter(metapage);
+		for (i = 0; i < filterSize && !hasNewBits; i++)
+		{
+			hasNewBits = (filter[i] & ~pageFilter[i]) != 0;
+		}
+
+		if (!hasNewBits)
+		{
+			UnlockReleaseBuffer(metaBuffer);
+			return;
+		}
+
+		/* Upgrade the lock and recheck, the filter may have changed meanwhile */
+		LockBuffer(metaBuffer, RUM_UNLOCK);
+		LockBuffer(metaBuffer, RUM_EXCLUSIVE);
+		if (metadata->tailFreeSize != filterSize)
+		{
+			UnlockReleaseBuffer(metaBuffer);
+			return;
+		}
+	}
+
+	state = GenericXLogStart(index);
+	metapage = GenericXLogRegisterBuffer(state, metaBuffer, 0);
+	metadata = RumPageGetMeta(metapage);
+	pageFilter = RumPageGetPathFilter(metapage);
+
+	if (initialize)
+	{
+		memcpy(pageFilter, filter, filterSize);
+		metadata->tailFreeSize = filterSize;
+
+		/* Make sure the filter is not treated as the page's hole */
+		((PageHeader) metapage)->pd_lower = Max(((PageHeader) metapage)->pd_lower,
+												(pageFilter + filterSize) - (uint8 *) metapage);
+	}
+	else
+	{
+		for (i = 0; i < filterSize; i++)
+		{
+			pageFilter[i] |= filter[i];
+		}
+	}
+
+	GenericXLogFinish(state);
+	UnlockReleaseBuffer(metaBuffer);
+}
+
+
 /*
  * Write the given statistics to the index's metapage
  *
@@ -39,6 +39,7 @@ extern bool RumVacuumEntryItems;
 extern bool RumPruneEmptyPages;
 extern bool RumEnableNewBulkDelete;
 extern bool RumVacuumSkipPrunePostingTreePages;
+extern int RumVacuumMaxPrunePostingTreeEntryPages;
 extern bool RumTraversePageOnlyOnBackTrack;
 extern bool RumSkipGlobalVisibilityCheckOnPrune;
 
@@ -1825,6 +1826,9 @@ rumvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 	bool isVacuumCleanup = true;
 	RumVacuumState gvs;
 	RumVacuumStatistics vacStats = { 0 };
+	BlockNumber pruneStartBlkno = RUM_ROOT_BLKNO;
+	BlockNumber pruneResumeBlkno = InvalidBlockNumber;
+	int32_t numPrunedEntryLeafPages = 0;
 
 	/*
 	 * In an autovacuum analyze, we want to clean up pending insertions.
@@ -1878,6 +1882,22 @@ rumvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 								 0);
 	totFreePages = 0;
 
+	/*
+	 * With incremental pruning, only a bounded number of entry leaf pages
+	 * have their posting trees pruned per cleanup: pick up where the previous
+	 * cleanup of this index stopped. The scan below still visits every page
+	 * to recycle pages and collect stats, which is a cheap sequential read
+	 * compared to walking the posting trees.
+	 */
+	if (RumVacuumMaxPrunePostingTreeEntryPages > 0)
+	{
+		pruneStartBlkno = rum_vacuum_get_resume_block(index);
+		if (pruneStartBlkno == InvalidBlockNumber || pruneStartBlkno >= npages)
+		{
+			pruneStartBlkno = RUM_ROOT_BLKNO;
+		}
+	}
+
 	for (blkno = RUM_ROOT_BLKNO; blkno < npages; blkno++)
 	{
 		Buffer buffer;
@@ -1922,7 +1942,9 @@ rumvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 			if (RumPageIsLeaf(page))
 			{
 				if (gvs.inlineVacuumBulkDelDataPages &&
-					!RumVacuumSkipPrunePostingTreePages)
+					!RumVacuumSkipPrunePostingTreePages &&
+					blkno >= pruneStartBlkno &&
+					pruneResumeBlkno == InvalidBlockNumber)
 				{
 					/* If we did an inline bulk delete of data pages, then
 					 * We will have empty data pages that are still parented
@@ -1934,11 +1956,21 @@ rumvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 					 * deletion to the page.
 					 * TraverseAndPrunePostingTrees will release the buffer as well.
 					 */
+					idxStat.nEntries += PageGetMaxOffsetNumber(page);
 					releaseBuffer = false;
 					TraverseAndPrunePostingTrees(&gvs, page, buffer, blkno, &vacStats);
-				}
 
-				idxStat.nEntries += PageGetMaxOffsetNumber(page);
+					numPrunedEntryLeafPages++;
+					if (RumVacuumMaxPrunePostingTreeEntryPages > 0 &&
+						numPrunedEntryLeafPages >= RumVacuumMaxPrunePostingTreeEntryPages)
+					{
+						pruneResumeBlkno = blkno + 1;
+					}
+				}
+				else
+				{
+					idxStat.nEntries += PageGetMaxOffsetNumber(page);
+				}
 			}
 		}
 
@@ -1951,6 +1983,16 @@ rumvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 									 blkno);
 	}
 
+	if (RumVacuumMaxPrunePostingTreeEntryPages > 0 &&
+		gvs.inlineVacuumBulkDelDataPages && !RumVacuumSkipPrunePostingTreePages)
+	{
+		/* Remember where to resume; a completed pass starts over next time */
+		rum_vacuum_set_resume_block(index, pruneResumeBlkno);
+		elog_rum_unredacted(
+			"Vacuum cleanup[index=%u] pruned posting trees of %d entry pages starting at block %u, resume block %u",
+			index->rd_id, numPrunedEntryLeafPages, pruneStartBlkno, pruneResumeBlkno);
+	}
+
 	/* Update the metapage with accurate page and entry counts */
 	idxStat.nTotalPages = npages;
 	rumUpdateStats(info->index, &idxStat, false);
@@ -6,7 +6,12 @@
  *-------------------------------------------------------------------------
  */
 
-use std::{str::from_utf8, sync::Arc};
+use std::{
+    collections::HashMap,
+    str::from_utf8,
+    sync::{Arc, Mutex},
+    time::Instant,
+};
 
 use crate::{
     context::{ConnectionContext, RequestContext},
@@ -19,6 +24,7 @@ use crate::{
 };
 use base64::{engine::general_purpose, Engine as _};
 use bson::{rawdoc, spec::BinarySubtype};
+use once_cell::sync::Lazy;
 use rand::Rng;
 use serde_json::Value;
 use tokio::{
@@ -29,6 +35,22 @@ use tokio_postgres::types::Type;
 
 const NONCE_LENGTH: usize = 2;
 
+/// Upper bound on the number of users whose salt and iterations are cached.
+const SCRAM_SALT_CACHE_MAX_ENTRIES: usize = 10000;
+
+/// Salt and iteration count of a user, as returned by the first SCRAM step.
+struct ScramSaltCacheEntry {
+    salt: String,
+    iterations: i32,
+    cached_at: Instant,
+}
+
+/// Gateway wide cache of the SCRAM salt and iterations per user, so a reconnect storm
+/// does not need a backend round trip for the first step of every handshake.
+/// The proof is always verified by the backend against the stored keys.
+static SCRAM_SALT_CACHE: Lazy<Mutex<HashMap<String, ScramSaltCacheEntry>>> =
+    Lazy::new(|| Mutex::new(HashMap::new()));
+
 #[derive(Debug, Clone, PartialEq)]
 pub enum AuthKind {
     Native,
@@ -514,6 +536,8 @@ async fn handle_sasl_continue(
             .map_err(DocumentDBError::pg_response_invalid)?
             != 1
         {
+            // The password may have changed since the salt was cached.
+            invalidate_cached_salt_and_iteration(username);
             return Err(DocumentDBError::authentication_failed(
                 "Invalid key".to_string(),
             ));
@@ -632,6 +656,17 @@ async fn get_salt_and_iteration(
         }
     }
 
+    let cache_ttl_secs = connection_context
+        .service_context
+        .dynamic_configuration()
+        .scram_salt_cache_ttl_secs()
+        .await;
+    if cache_ttl_secs > 0 {
+        if let Some(cached) = get_cached_salt_and_iteration(username, cache_ttl_secs) {
+            return Ok(cached);
+        }
+    }
+
     let results = connection_context
         .service_context
         .connection_pool_manager()
@@ -674,9 +709,50 @@ async fn get_salt_and_iteration(
         .get_str("salt")
         .map_err(DocumentDBError::pg_response_invalid)?;
 
+    if cache_ttl_secs > 0 {
+        cache_salt_and_iteration(username, salt, iterations, cache_ttl_secs);
+    }
+
     Ok((salt.to_string(), iterations))
 }
 
+fn get_cached_salt_and_iteration(username: &str, cache_ttl_secs: u64) -> Option<(String, i32)> {
+    let cache = SCRAM_SALT_CACHE.lock().ok()?;
+    cache
+        .get(username)
+        .filter(|entry| entry.cached_at.elapsed() < Duration::from_secs(cache_ttl_secs))
+        .map(|entry| (entry.salt.clone(), entry.iterations))
+}
+
+fn cache_salt_and_iteration(username: &str, salt: &str, iterations: i32, cache_ttl_secs: u64) {
+    let Ok(mut cache) = SCRAM_SALT_CACHE.lock() else {
+        return;
+    };
+
+    if cache.len() >= SCRAM_SALT_CACHE_MAX_ENTRIES {
+        let ttl = Duration::from_secs(cache_ttl_secs);
+        cache.retain(|_, entry| entry.cached_at.elapsed() < ttl);
+        if cache.len() >= SCRAM_SALT_CACHE_MAX_ENTRIES {
+            return;
+        }
+    }
+
+    cache.insert(
+        username.to_string(),
+        ScramSaltCacheEntry {
+            salt: salt.to_string(),
+            iterations,
+            cached_at: Instant::now(),
+        },
+    );
+}
+
+fn invalidate_cached_salt_and_iteration(username: &str) {
+    if let Ok(mut cache) = SCRAM_SALT_CACHE.lock() {
+        cache.remove(username);
+    }
+}
+
 pub async fn get_user_oid(connection_context: &ConnectionContext, username: &str) -> Result<u32> {
     let user_oid_rows = connection_context
         .service_context
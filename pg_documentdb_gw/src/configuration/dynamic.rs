@@ -14,6 +14,7 @@ use bson::RawBson;
 use crate::{configuration::Version, postgres};
 
 pub const POSTGRES_RECOVERY_KEY: &str = "IsPostgresInRecovery";
+pub const POSTGRES_REPLICATION_LAG_KEY: &str = "PostgresReplicationLagSeconds";
 
 /// Used for configurations which can change during runtime.
 #[async_trait]
@@ -38,6 +39,33 @@ pub trait DynamicConfiguration: Send + Sync + Debug {
         self.get_bool("enableConnectionStatus", false).await
     }
 
+    async fn enable_adaptive_pool_sizing(&self) -> bool {
+        self.get_bool("enableAdaptivePoolSizing", false).await
+    }
+
+    /// Milliseconds a request waits for a concurrency slot of its user, 0 rejects it right away.
+    async fn admission_queue_timeout_ms(&self) -> u64 {
+        self.get_i32("admissionQueueTimeoutMs", 1000).await.max(0) as u64
+    }
+
+    async fn adaptive_pool_min_connections(&self) -> usize {
+        self.get_i32("adaptivePoolMinConnections", 2).await.max(1) as usize
+    }
+
+    /// Fetches the next batch of non-persisted cursors in the background after a getMore.
+    async fn enable_cursor_prefetch(&self) -> bool {
+        self.get_bool("enableCursorPrefetch", false).await
+    }
+
+    /// Lets identical concurrent find, count and distinct commands share a single query.
+    async fn enable_read_coalescing(&self) -> bool {
+        self.get_bool("enableReadCoalescing", false).await
+    }
+
+    async fn enable_wire_compression(&self) -> bool {
+        self.get_bool("enableWireCompression", false).await
+    }
+
     async fn enable_verbose_logging_in_gateway(&self) -> bool {
         self.get_bool("enableVerboseLoggingInGateway", false).await
     }
@@ -51,6 +79,12 @@ pub trait DynamicConfiguration: Send + Sync + Debug {
         !self.get_bool(POSTGRES_RECOVERY_KEY, false).await
     }
 
+    /// Seconds the hot standby is behind its primary as of the last configuration refresh, 0
+    /// when it has replayed all the WAL it received or isn't in recovery.
+    async fn replication_lag_seconds(&self) -> i32 {
+        self.get_i32(POSTGRES_REPLICATION_LAG_KEY, 0).await
+    }
+
     async fn is_read_only_for_disk_full(&self) -> bool {
         self.get_bool("default_transaction_read_only", false).await
     }
@@ -63,6 +97,23 @@ pub trait DynamicConfiguration: Send + Sync + Debug {
             || self.get_bool("simulateReadReplica", false).await
     }
 
+    /// Number of documents per sub batch when pipelining unordered inserts, 0 disables pipelining.
+    async fn pipelined_insert_batch_size(&self) -> usize {
+        self.get_i32("pipelinedInsertBatchSize", 0).await.max(0) as usize
+    }
+
+    /// Concurrent aggregate, count, distinct and stats commands per user, 0 disables the limit.
+    async fn max_concurrent_heavy_requests_per_user(&self) -> usize {
+        self.get_i32("maxConcurrentHeavyRequestsPerUser", 0)
+            .await
+            .max(0) as usize
+    }
+
+    /// Concurrent reads and writes per user, 0 disables the limit.
+    async fn max_concurrent_requests_per_user(&self) -> usize {
+        self.get_i32("maxConcurrentRequestsPerUser", 0).await.max(0) as usize
+    }
+
     async fn max_write_batch_size(&self) -> i32 {
         self.get_i32("maxWriteBatchSize", 100000).await
     }
@@ -71,6 +122,41 @@ pub trait DynamicConfiguration: Send + Sync + Debug {
         self.get_bool("readOnly", false).await
     }
 
+    /// Requests per second a user may send, 0 disables the rate limit.
+    async fn request_rate_limit_per_user(&self) -> u32 {
+        self.get_i32("requestRateLimitPerUser", 0).await.max(0) as u32
+    }
+
+    /// Whether responses of reads of the namespace (db.collection) are cached in the gateway,
+    /// resultCacheCollections is a comma separated list of namespaces.
+    async fn is_result_cache_collection(&self, namespace: &str) -> bool {
+        self.get_str("resultCacheCollections")
+            .await
+            .is_some_and(|collections| {
+                collections
+                    .split(',')
+                    .any(|collection| collection.trim() == namespace)
+            })
+    }
+
+    /// Responses cached per collection, newer responses are not cached once it is reached.
+    async fn result_cache_max_entries_per_collection(&self) -> usize {
+        self.get_i32("resultCacheMaxEntriesPerCollection", 1000)
+            .await
+            .max(0) as usize
+    }
+
+    /// Milliseconds a cached response is served for, bounding how long writes that don't go
+    /// through this gateway go unnoticed.
+    async fn result_cache_ttl_ms(&self) -> u64 {
+        self.get_i32("resultCacheTtlMs", 1000).await.max(0) as u64
+    }
+
+    /// Seconds the SCRAM salt and iterations of a user are cached in the gateway, 0 disables the cache.
+    async fn scram_salt_cache_ttl_secs(&self) -> u64 {
+        self.get_i32("scramSaltCacheTtlSecs", 0).await.max(0) as u64
+    }
+
     async fn send_shutdown_responses(&self) -> bool {
         self.get_bool("SendShutdownResponses", false).await
     }
@@ -50,6 +50,10 @@ pub trait SetupConfiguration: DynClone + Send + Sync + Debug {
     /// Returns the timeout duration (in seconds) for transactions.
     fn transaction_timeout_secs(&self) -> u64;
 
+    /// Returns the time (in seconds) after which a transaction that is not running a
+    /// statement is aborted to release its backend, if enabled.
+    fn transaction_idle_timeout_secs(&self) -> Option<u64>;
+
     /// Indicates whether the application should only serve on local host or
     /// be available from all addresses.
     fn use_local_host(&self) -> bool;
@@ -78,9 +82,20 @@ pub trait SetupConfiguration: DynClone + Send + Sync + Debug {
     /// Returns the number of worker threads for the async runtime.
     fn async_runtime_worker_threads(&self) -> usize;
 
+    /// Returns the number of single threaded runtimes that each accept connections on their own
+    /// SO_REUSEPORT listener and run the connections they accept, if enabled.
+    fn listener_runtimes(&self) -> Option<usize>;
+
     /// Returns the timeout duration (in minutes) for PostgreSQL connections
     fn postgres_idle_connection_timeout_minutes(&self) -> u64;
 
+    /// Returns the port on which request latency metrics are served, if they are enabled.
+    fn metrics_listen_port(&self) -> Option<u16>;
+
+    /// Returns the address the metrics endpoint binds to. The endpoint is not authenticated, so
+    /// it only listens on the loopback interface unless an address is configured.
+    fn metrics_listen_address(&self) -> &str;
+
     /// Provides a way to downcast the trait object to a concrete type.
     fn as_any(&self) -> &dyn std::any::Any;
 }
@@ -8,16 +8,17 @@
 
 use std::{collections::HashMap, sync::Arc};
 
+use arc_swap::ArcSwap;
 use async_trait::async_trait;
 use bson::{rawbson, RawBson};
 use serde::Deserialize;
-use tokio::{
-    sync::RwLock,
-    time::{Duration, Instant},
-};
+use tokio::time::{Duration, Instant};
 
 use crate::{
-    configuration::{dynamic::POSTGRES_RECOVERY_KEY, DynamicConfiguration, SetupConfiguration},
+    configuration::{
+        dynamic::{POSTGRES_RECOVERY_KEY, POSTGRES_REPLICATION_LAG_KEY},
+        DynamicConfiguration, SetupConfiguration,
+    },
     error::{DocumentDBError, Result},
     postgres::{Connection, ConnectionPool, QueryCatalog},
     requests::request_tracker::RequestTracker,
@@ -101,6 +102,24 @@ impl PgConfigurationInner {
         let in_recovery: bool = pg_is_in_recovery_row.first().is_some_and(|row| row.get(0));
         configs.insert(POSTGRES_RECOVERY_KEY.to_string(), in_recovery.to_string());
 
+        // The replay lag of a hot standby, checked against maxStalenessSeconds of the reads
+        if in_recovery {
+            let replication_lag_row = conn
+                .query(
+                    self.query_catalog.pg_replication_lag(),
+                    &[],
+                    &[],
+                    None,
+                    &mut request_tracker,
+                )
+                .await?;
+            let replication_lag: i32 = replication_lag_row.first().map_or(0, |row| row.get(0));
+            configs.insert(
+                POSTGRES_REPLICATION_LAG_KEY.to_string(),
+                replication_lag.to_string(),
+            );
+        }
+
         log::info!("Dynamic configurations loaded: {configs:?}");
         Ok(configs)
     }
@@ -114,11 +133,19 @@ impl PgConfigurationInner {
     }
 }
 
+/// The configurations as of a refresh, replaced as a whole by the next refresh.
+#[derive(Debug)]
+struct ConfigurationSnapshot {
+    values: HashMap<String, String>,
+    loaded_at: Instant,
+}
+
+/// Requests read the current snapshot without taking a lock, so they never wait on the
+/// refresh thread and their getters complete without yielding.
 #[derive(Debug)]
 pub struct PgConfiguration {
     inner: PgConfigurationInner,
-    values: RwLock<HashMap<String, String>>,
-    last_update_at: RwLock<Instant>,
+    snapshot: ArcSwap<ConfigurationSnapshot>,
 }
 
 impl PgConfiguration {
@@ -174,14 +201,13 @@ impl PgConfiguration {
             system_requests_pool: system_requests_pool.clone(),
         };
 
-        let values = RwLock::new(inner.load_configurations(&connection).await?);
-
-        let configuration = Arc::new(PgConfiguration {
-            inner,
-            values,
-            last_update_at: RwLock::new(Instant::now()),
+        let snapshot = ArcSwap::from_pointee(ConfigurationSnapshot {
+            values: inner.load_configurations(&connection).await?,
+            loaded_at: Instant::now(),
         });
 
+        let configuration = Arc::new(PgConfiguration { inner, snapshot });
+
         let refresh_interval = setup_configuration.dynamic_configuration_refresh_interval_secs();
         Self::start_dynamic_configuration_refresh_thread(configuration.clone(), refresh_interval);
 
@@ -189,7 +215,7 @@ impl PgConfiguration {
     }
 
     pub async fn last_update_at(&self) -> Instant {
-        *self.last_update_at.read().await
+        self.snapshot.load().loaded_at
     }
 
     pub async fn reload_configuration_with_connection(&self, conn: &Connection) -> Result<()> {
@@ -201,15 +227,10 @@ impl PgConfiguration {
             }
         };
 
-        {
-            let mut config_writable = self.values.write().await;
-            *config_writable = new_config;
-        }
-
-        {
-            let mut last_update = self.last_update_at.write().await;
-            *last_update = Instant::now();
-        }
+        self.snapshot.store(Arc::new(ConfigurationSnapshot {
+            values: new_config,
+            loaded_at: Instant::now(),
+        }));
 
         Ok(())
     }
@@ -218,40 +239,33 @@ impl PgConfiguration {
 #[async_trait]
 impl DynamicConfiguration for PgConfiguration {
     async fn get_str(&self, key: &str) -> Option<String> {
-        self.values.read().await.get(key).cloned()
+        self.snapshot.load().values.get(key).cloned()
     }
 
     async fn get_bool(&self, key: &str, default: bool) -> bool {
-        let ret = self
+        self.snapshot
+            .load()
             .values
-            .read()
-            .await
             .get(key)
             .map(|v| v.parse::<bool>().unwrap_or(default))
-            .unwrap_or(default);
-        ret
+            .unwrap_or(default)
     }
 
     async fn get_i32(&self, key: &str, default: i32) -> i32 {
-        let ret = self
+        self.snapshot
+            .load()
             .values
-            .read()
-            .await
             .get(key)
             .map(|v| v.parse::<i32>().unwrap_or(default))
-            .unwrap_or(default);
-        ret
+            .unwrap_or(default)
     }
 
     async fn equals_value(&self, key: &str, value: &str) -> bool {
-        let ret = self
+        self.snapshot
+            .load()
             .values
-            .read()
-            .await
             .get(key)
-            .map(|v| v == value)
-            .unwrap_or(false);
-        ret
+            .is_some_and(|v| v == value)
     }
 
     fn topology(&self) -> RawBson {
@@ -26,6 +26,8 @@ pub struct DocumentDBSetupConfiguration {
     // Gateway listener configuration
     pub use_local_host: Option<bool>,
     pub gateway_listen_port: Option<u16>,
+    pub metrics_listen_port: Option<u16>,
+    pub metrics_listen_address: Option<String>,
 
     // Postgres configuration
     pub postgres_system_user: Option<String>,
@@ -36,6 +38,7 @@ pub struct DocumentDBSetupConfiguration {
     #[serde(default)]
     pub allow_transaction_snapshot: Option<bool>,
     pub transaction_timeout_secs: Option<u64>,
+    pub transaction_idle_timeout_secs: Option<u64>,
     pub cursor_timeout_secs: Option<u64>,
     pub certificate_options: CertificateOptions,
 
@@ -48,6 +51,7 @@ pub struct DocumentDBSetupConfiguration {
 
     // Runtime configuration
     pub async_runtime_worker_threads: Option<usize>,
+    pub listener_runtimes: Option<usize>,
 }
 
 impl DocumentDBSetupConfiguration {
@@ -100,6 +104,10 @@ impl SetupConfiguration for DocumentDBSetupConfiguration {
         self.transaction_timeout_secs.unwrap_or(30)
     }
 
+    fn transaction_idle_timeout_secs(&self) -> Option<u64> {
+        self.transaction_idle_timeout_secs.filter(|secs| *secs > 0)
+    }
+
     fn use_local_host(&self) -> bool {
         self.use_local_host.unwrap_or(false)
     }
@@ -142,7 +150,21 @@ impl SetupConfiguration for DocumentDBSetupConfiguration {
         })
     }
 
+    fn listener_runtimes(&self) -> Option<usize> {
+        self.listener_runtimes.filter(|runtimes| *runtimes > 0)
+    }
+
     fn postgres_idle_connection_timeout_minutes(&self) -> u64 {
         self.postgres_idle_connection_timeout_minutes.unwrap_or(5)
     }
+
+    fn metrics_listen_port(&self) -> Option<u16> {
+        self.metrics_listen_port
+    }
+
+    fn metrics_listen_address(&self) -> &str {
+        self.metrics_listen_address
+            .as_deref()
+            .unwrap_or("127.0.0.1")
+    }
 }
@@ -0,0 +1,196 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/context/admission.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{
+    collections::HashMap,
+    sync::{Arc, Mutex},
+    time::{Duration, Instant},
+};
+
+use tokio::sync::{OwnedSemaphorePermit, Semaphore};
+
+use crate::{
+    configuration::DynamicConfiguration,
+    error::{DocumentDBError, ErrorCode, Result},
+    requests::RequestType,
+    telemetry::admission_metrics::{AdmissionOutcome, ADMISSION_METRICS},
+};
+
+/// Classes of commands which get their own concurrency limit per user, so that heavy
+/// commands of a user cannot take the slots of its point reads and writes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum CommandClass {
+    /// Commands that may scan or aggregate whole collections
+    Heavy,
+
+    /// Reads and writes of individual documents or batches
+    Standard,
+}
+
+impl CommandClass {
+    /// Returns the class of the request, or None for commands that are not subject to admission
+    /// control (handshakes, sessions, transactions and administrative commands).
+    pub fn of(request_type: &RequestType) -> Option<Self> {
+        match request_type {
+            RequestType::Aggregate
+            | RequestType::Count
+            | RequestType::Distinct
+            | RequestType::CollStats
+            | RequestType::DbStats
+            | RequestType::Validate => Some(CommandClass::Heavy),
+            RequestType::Find
+            | RequestType::GetMore
+            | RequestType::Insert
+            | RequestType::Update
+            | RequestType::Delete
+            | RequestType::FindAndModify => Some(CommandClass::Standard),
+            _ => None,
+        }
+    }
+}
+
+/// Token bucket refilled at the rate limit, holding up to one second worth of requests.
+struct TokenBucket {
+    tokens: f64,
+    last_refill: Instant,
+}
+
+impl TokenBucket {
+    fn try_take(&mut self, rate: f64) -> bool {
+        let now = Instant::now();
+        let refill = now.duration_since(self.last_refill).as_secs_f64() * rate;
+        self.tokens = (self.tokens + refill).min(rate);
+        self.last_refill = now;
+        if self.tokens < 1.0 {
+            return false;
+        }
+
+        self.tokens -= 1.0;
+        true
+    }
+}
+
+/// Held while a request runs, releases its concurrency slot when dropped.
+pub struct AdmissionPermit {
+    _permit: Option<OwnedSemaphorePermit>,
+}
+
+/// Per user rate limits and concurrency limits (per command class) of the requests that the
+/// gateway sends to Postgres, configured through the dynamic configuration.
+#[derive(Default)]
+pub struct AdmissionController {
+    semaphores: Mutex<HashMap<(String, CommandClass), (usize, Arc<Semaphore>)>>,
+    token_buckets: Mutex<HashMap<String, TokenBucket>>,
+}
+
+impl AdmissionController {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Admits the request of the user, waiting up to the admission queue timeout for a
+    /// concurrency slot. Requests over the rate limit or that can't get a slot in time are
+    /// rejected.
+    pub async fn admit(
+        &self,
+        username: &str,
+        command_class: CommandClass,
+        dynamic_config: &Arc<dyn DynamicConfiguration>,
+    ) -> Result<AdmissionPermit> {
+        let rate_limit = dynamic_config.request_rate_limit_per_user().await;
+        if rate_limit > 0 && !self.try_take_token(username, rate_limit as f64) {
+            ADMISSION_METRICS.record(AdmissionOutcome::RateLimited);
+            return Err(DocumentDBError::documentdb_error(
+                ErrorCode::IngressRequestRateLimitExceeded,
+                format!("The request rate limit of {rate_limit} requests per second of the user has been exceeded."),
+            ));
+        }
+
+        let max_concurrency = match command_class {
+            CommandClass::Heavy => {
+                dynamic_config
+                    .max_concurrent_heavy_requests_per_user()
+                    .await
+            }
+            CommandClass::Standard => dynamic_config.max_concurrent_requests_per_user().await,
+        };
+        if max_concurrency == 0 {
+            ADMISSION_METRICS.record(AdmissionOutcome::Admitted);
+            return Ok(AdmissionPermit { _permit: None });
+        }
+
+        let semaphore = self.semaphore(username, command_class, max_concurrency);
+        if let Ok(permit) = Arc::clone(&semaphore).try_acquire_owned() {
+            ADMISSION_METRICS.record(AdmissionOutcome::Admitted);
+            return Ok(AdmissionPermit {
+                _permit: Some(permit),
+            });
+        }
+
+        // Queue for a slot unless the queue timeout asks for fast rejection
+        let queue_timeout_ms = dynamic_config.admission_queue_timeout_ms().await;
+        if queue_timeout_ms > 0 {
+            ADMISSION_METRICS.record(AdmissionOutcome::Queued);
+            if let Ok(Ok(permit)) = tokio::time::timeout(
+                Duration::from_millis(queue_timeout_ms),
+                semaphore.acquire_owned(),
+            )
+            .await
+            {
+                ADMISSION_METRICS.record(AdmissionOutcome::Admitted);
+                return Ok(AdmissionPermit {
+                    _permit: Some(permit),
+                });
+            }
+        }
+
+        ADMISSION_METRICS.record(AdmissionOutcome::ConcurrencyLimited);
+        Err(DocumentDBError::documentdb_error(
+            ErrorCode::IngressRequestRateLimitExceeded,
+            format!(
+                "The user already has {max_concurrency} concurrent requests of this kind running."
+            ),
+        ))
+    }
+
+    fn try_take_token(&self, username: &str, rate: f64) -> bool {
+        let mut token_buckets = self
+            .token_buckets
+            .lock()
+            .expect("Admission lock is not poisoned");
+        token_buckets
+            .entry(username.to_string())
+            .or_insert_with(|| TokenBucket {
+                tokens: rate,
+                last_refill: Instant::now(),
+            })
+            .try_take(rate)
+    }
+
+    fn semaphore(
+        &self,
+        username: &str,
+        command_class: CommandClass,
+        max_concurrency: usize,
+    ) -> Arc<Semaphore> {
+        let mut semaphores = self
+            .semaphores
+            .lock()
+            .expect("Admission lock is not poisoned");
+        let entry = semaphores
+            .entry((username.to_string(), command_class))
+            .or_insert_with(|| (max_concurrency, Arc::new(Semaphore::new(max_concurrency))));
+
+        // When the limit changes, requests holding slots of the old semaphore just finish on it
+        if entry.0 != max_concurrency {
+            *entry = (max_concurrency, Arc::new(Semaphore::new(max_concurrency)));
+        }
+
+        Arc::clone(&entry.1)
+    }
+}
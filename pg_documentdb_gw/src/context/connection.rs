@@ -19,9 +19,10 @@ use uuid::{Builder, Uuid};
 use crate::{
     auth::AuthState,
     configuration::DynamicConfiguration,
-    context::{Cursor, CursorStoreEntry, ServiceContext},
+    context::{Cursor, CursorPrefetch, CursorStoreEntry, ServiceContext},
     error::{DocumentDBError, Result},
     postgres::Connection,
+    protocol::compression::Compressor,
     telemetry::TelemetryProvider,
 };
 
@@ -31,6 +32,8 @@ pub struct ConnectionContext {
     pub service_context: Arc<ServiceContext>,
     pub auth_state: AuthState,
     pub requires_response: bool,
+    pub response_compressor: Option<Compressor>,
+    pub compressors: Vec<Compressor>,
     pub client_information: Option<RawDocumentBuf>,
     pub transaction: Option<(Vec<u8>, i64)>,
     pub telemetry_provider: Option<Box<dyn TelemetryProvider>>,
@@ -66,6 +69,8 @@ impl ConnectionContext {
             service_context: Arc::new(service_context),
             auth_state: AuthState::new(),
             requires_response: true,
+            response_compressor: None,
+            compressors: Vec::new(),
             client_information: None,
             transaction: None,
             telemetry_provider,
@@ -105,6 +110,7 @@ impl ConnectionContext {
         db: &str,
         collection: &str,
         session_id: Option<Vec<u8>>,
+        prefetch: Option<CursorPrefetch>,
     ) {
         let key = (cursor.cursor_id, username.to_string());
         let value = CursorStoreEntry {
@@ -114,6 +120,7 @@ impl ConnectionContext {
             collection: collection.to_string(),
             timestamp: Instant::now(),
             session_id,
+            prefetch,
         };
 
         // If there is a transaction, add the cursor to its store
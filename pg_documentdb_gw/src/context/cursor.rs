@@ -7,15 +7,16 @@
  */
 
 use std::{
-    collections::HashMap,
+    collections::{HashMap, VecDeque},
     sync::Arc,
     time::{Duration, Instant},
 };
 
 use bson::RawDocumentBuf;
 use tokio::{sync::RwLock, task::JoinHandle};
+use tokio_postgres::Row;
 
-use crate::{configuration::SetupConfiguration, postgres::Connection};
+use crate::{configuration::SetupConfiguration, error::Result, postgres::Connection};
 
 #[derive(Debug)]
 pub struct Cursor {
@@ -23,6 +24,35 @@ pub struct Cursor {
     pub cursor_id: i64,
 }
 
+/// The next batch of a cursor, fetched in the background while the client processes the current one.
+/// At most one batch is buffered per cursor, and the fetch is aborted if the cursor is dropped.
+#[derive(Debug)]
+pub struct CursorPrefetch {
+    /// The batchSize of the getMore the batch was fetched for.
+    pub batch_size: Option<i64>,
+    pub handle: JoinHandle<Result<Vec<Row>>>,
+}
+
+impl CursorPrefetch {
+    /// Waits for the prefetched batch, returns None if it failed so the caller can fetch it again.
+    pub async fn take(mut self) -> Option<Vec<Row>> {
+        match (&mut self.handle).await {
+            Ok(Ok(rows)) => Some(rows),
+            Ok(Err(e)) => {
+                log::debug!("Cursor prefetch failed, fetching the batch again: {e:?}");
+                None
+            }
+            Err(_) => None,
+        }
+    }
+}
+
+impl Drop for CursorPrefetch {
+    fn drop(&mut self) {
+        self.handle.abort();
+    }
+}
+
 pub struct CursorStoreEntry {
     pub conn: Option<Arc<Connection>>,
     pub cursor: Cursor,
@@ -30,28 +60,70 @@ pub struct CursorStoreEntry {
     pub collection: String,
     pub timestamp: Instant,
     pub session_id: Option<Vec<u8>>,
+    pub prefetch: Option<CursorPrefetch>,
+}
+
+type CursorKey = (i64, String);
+
+/// Number of independently locked shards of a cursor store.
+const CURSOR_STORE_SHARD_COUNT: usize = 16;
+
+#[derive(Default)]
+struct CursorStoreShard {
+    cursors: HashMap<CursorKey, CursorStoreEntry>,
+
+    /// Cursors in the order they were added with the time they were added at, so the
+    /// reaper only visits expired cursors. Cursors that were taken or re-added since
+    /// leave stale items that are skipped when they reach the front.
+    expiry_queue: VecDeque<(Instant, CursorKey)>,
+}
+
+impl CursorStoreShard {
+    fn remove_expired(&mut self, cursor_timeout: Duration) {
+        while let Some((timestamp, _)) = self.expiry_queue.front() {
+            if timestamp.elapsed() < cursor_timeout {
+                break;
+            }
+
+            if let Some((timestamp, key)) = self.expiry_queue.pop_front() {
+                if self
+                    .cursors
+                    .get(&key)
+                    .is_some_and(|entry| entry.timestamp <= timestamp)
+                {
+                    self.cursors.remove(&key);
+                }
+            }
+        }
+    }
 }
 
 // Maps CursorId, Username -> Connection, Cursor
+// The map is sharded by cursor id so that getMores on different cursors do not contend.
 pub struct CursorStore {
-    cursors: Arc<RwLock<HashMap<(i64, String), CursorStoreEntry>>>,
+    shards: Arc<Vec<RwLock<CursorStoreShard>>>,
+    use_reaper: bool,
     _reaper: Option<JoinHandle<()>>,
 }
 
 impl CursorStore {
     pub fn new(config: &dyn SetupConfiguration, use_reaper: bool) -> Self {
-        let cursors: Arc<RwLock<HashMap<(i64, String), CursorStoreEntry>>> =
-            Arc::new(RwLock::new(HashMap::new()));
+        let shards: Arc<Vec<RwLock<CursorStoreShard>>> = Arc::new(
+            (0..CURSOR_STORE_SHARD_COUNT)
+                .map(|_| RwLock::new(CursorStoreShard::default()))
+                .collect(),
+        );
         let cursor_timeout = Duration::from_secs(config.cursor_timeout_secs());
 
-        let cursors_clone = cursors.clone();
+        let shards_clone = shards.clone();
         let reaper = if use_reaper {
             Some(tokio::spawn(async move {
                 let mut interval = tokio::time::interval(cursor_timeout / 10);
                 loop {
                     interval.tick().await;
-                    let mut cursors = cursors_clone.write().await;
-                    cursors.retain(|_, v| v.timestamp.elapsed() < cursor_timeout)
+                    for shard in shards_clone.iter() {
+                        shard.write().await.remove_expired(cursor_timeout);
+                    }
                 }
             }))
         } else {
@@ -59,43 +131,59 @@ impl CursorStore {
         };
 
         CursorStore {
-            cursors,
+            shards,
+            use_reaper,
             _reaper: reaper,
         }
     }
 
-    pub async fn add_cursor(&self, k: (i64, String), v: CursorStoreEntry) {
-        let mut cursors = self.cursors.write().await;
-        cursors.insert(k, v);
+    fn shard(&self, cursor_id: i64) -> &RwLock<CursorStoreShard> {
+        &self.shards[(cursor_id as u64 % CURSOR_STORE_SHARD_COUNT as u64) as usize]
+    }
+
+    pub async fn add_cursor(&self, k: CursorKey, v: CursorStoreEntry) {
+        let mut shard = self.shard(k.0).write().await;
+        if self.use_reaper {
+            shard.expiry_queue.push_back((v.timestamp, k.clone()));
+        }
+        shard.cursors.insert(k, v);
     }
 
-    pub async fn get_cursor(&self, k: (i64, String)) -> Option<CursorStoreEntry> {
-        let mut cursors = self.cursors.write().await;
-        cursors.remove(&k)
+    pub async fn get_cursor(&self, k: CursorKey) -> Option<CursorStoreEntry> {
+        let mut shard = self.shard(k.0).write().await;
+        shard.cursors.remove(&k)
+    }
+
+    async fn retain_cursors<F>(&self, f: F)
+    where
+        F: Fn(&CursorStoreEntry) -> bool,
+    {
+        for shard in self.shards.iter() {
+            shard.write().await.cursors.retain(|_, v| f(v));
+        }
     }
 
     pub async fn invalidate_cursors_by_collection(&self, db: &str, collection: &str) {
-        let mut cursors = self.cursors.write().await;
-        cursors.retain(|_, v| !(v.collection == collection && v.db == db))
+        self.retain_cursors(|v| !(v.collection == collection && v.db == db))
+            .await
     }
 
     pub async fn invalidate_cursors_by_database(&self, db: &str) {
-        let mut cursors = self.cursors.write().await;
-        cursors.retain(|_, v| v.db != db)
+        self.retain_cursors(|v| v.db != db).await
     }
 
     pub async fn invalidate_cursors_by_session(&self, session: &[u8]) {
-        let mut cursors = self.cursors.write().await;
-        cursors.retain(|_, v| v.session_id.as_deref() != Some(session))
+        self.retain_cursors(|v| v.session_id.as_deref() != Some(session))
+            .await
     }
 
     pub async fn kill_cursors(&self, user: String, cursors: &[i64]) -> (Vec<i64>, Vec<i64>) {
         let mut removed_cursors = Vec::new();
         let mut missing_cursors = Vec::new();
 
-        let mut cursor_store = self.cursors.write().await;
         for cursor in cursors.iter() {
-            if cursor_store.remove(&(*cursor, user.clone())).is_some() {
+            let mut shard = self.shard(*cursor).write().await;
+            if shard.cursors.remove(&(*cursor, user.clone())).is_some() {
                 removed_cursors.push(*cursor);
             } else {
                 missing_cursors.push(*cursor);
@@ -6,16 +6,22 @@
  *-------------------------------------------------------------------------
  */
 
+mod admission;
 mod connection;
 mod cursor;
+mod read_coalescer;
 mod request;
+mod result_cache;
 mod service;
 mod transaction;
 
-pub use cursor::{Cursor, CursorStore, CursorStoreEntry};
+pub use cursor::{Cursor, CursorPrefetch, CursorStore, CursorStoreEntry};
 
 pub use transaction::{RequestTransactionInfo, Transaction, TransactionStore};
 
+pub use admission::{AdmissionController, AdmissionPermit, CommandClass};
 pub use connection::ConnectionContext;
+pub use read_coalescer::{ReadCoalescer, ReadFlight};
 pub use request::RequestContext;
+pub use result_cache::ResultCache;
 pub use service::ServiceContext;
@@ -0,0 +1,91 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/context/read_coalescer.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{collections::HashMap, sync::Mutex};
+
+use bson::RawDocumentBuf;
+use tokio::sync::watch;
+
+/// The result of a coalesced read as seen by the followers: None while the read is in flight,
+/// then the response of the leader if it can be shared.
+type SharedResponse = Option<Option<RawDocumentBuf>>;
+
+/// Lets identical reads that run at the same time share a single query: the first read
+/// (the leader) runs the query and the others (the followers) wait for its response.
+#[derive(Default)]
+pub struct ReadCoalescer {
+    in_flight: Mutex<HashMap<Vec<u8>, watch::Receiver<SharedResponse>>>,
+}
+
+pub enum ReadFlight<'a> {
+    Leader(ReadFlightLeader<'a>),
+    Follower(watch::Receiver<SharedResponse>),
+}
+
+impl ReadCoalescer {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Joins the read identified by the key if one is in flight, or starts it otherwise.
+    pub fn join(&self, key: Vec<u8>) -> ReadFlight<'_> {
+        let mut in_flight = self
+            .in_flight
+            .lock()
+            .expect("Read coalescer lock is not poisoned");
+        if let Some(receiver) = in_flight.get(&key) {
+            return ReadFlight::Follower(receiver.clone());
+        }
+
+        let (sender, receiver) = watch::channel(None);
+        in_flight.insert(key.clone(), receiver);
+        ReadFlight::Leader(ReadFlightLeader {
+            coalescer: self,
+            key,
+            sender,
+        })
+    }
+
+    /// Waits for the leader of the read and returns its response, or None if the followers need
+    /// to run the read themselves (the response could not be shared or the leader failed).
+    pub async fn wait_for_leader(
+        mut receiver: watch::Receiver<SharedResponse>,
+    ) -> Option<RawDocumentBuf> {
+        match receiver.wait_for(Option::is_some).await {
+            Ok(response) => response.clone().flatten(),
+            Err(_) => None,
+        }
+    }
+}
+
+/// Held by the leader of a read, the read stops being in flight when it is dropped.
+pub struct ReadFlightLeader<'a> {
+    coalescer: &'a ReadCoalescer,
+    key: Vec<u8>,
+    sender: watch::Sender<SharedResponse>,
+}
+
+impl ReadFlightLeader<'_> {
+    /// Hands the response of the read (if it can be shared) to the followers.
+    pub fn complete(self, response: Option<RawDocumentBuf>) {
+        // There may be no followers, in which case there is nobody to notify
+        let _ = self.sender.send(Some(response));
+    }
+}
+
+impl Drop for ReadFlightLeader<'_> {
+    fn drop(&mut self) {
+        // A leader that is dropped without completing closes the channel, which sends its
+        // followers to run the read themselves.
+        self.coalescer
+            .in_flight
+            .lock()
+            .expect("Read coalescer lock is not poisoned")
+            .remove(&self.key);
+    }
+}
@@ -0,0 +1,134 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/context/result_cache.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{
+    collections::HashMap,
+    sync::Mutex,
+    time::{Duration, Instant},
+};
+
+use bson::RawDocumentBuf;
+
+struct CachedResponse {
+    stored_at: Instant,
+    response: RawDocumentBuf,
+}
+
+#[derive(Default)]
+struct NamespaceEntries {
+    /// Bumped by every write to the namespace, a read only stores its response if no write
+    /// happened while it ran.
+    generation: u64,
+    responses: HashMap<Vec<u8>, CachedResponse>,
+}
+
+/// Caches the responses of reads of rarely written collections, such as configuration or
+/// feature flag collections, so that repeated reads don't reach the backend.
+///
+/// Writes that go through the gateway invalidate the responses of their namespace, and the
+/// responses expire after a TTL to bound how long writes made elsewhere go unnoticed.
+#[derive(Default)]
+pub struct ResultCache {
+    namespaces: Mutex<HashMap<String, NamespaceEntries>>,
+}
+
+impl ResultCache {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Returns the cached response of the read if it is younger than the TTL.
+    pub fn get(&self, namespace: &str, key: &[u8], ttl: Duration) -> Option<RawDocumentBuf> {
+        let namespaces = self
+            .namespaces
+            .lock()
+            .expect("Result cache lock is not poisoned");
+        let cached = namespaces.get(namespace)?.responses.get(key)?;
+        (cached.stored_at.elapsed() < ttl).then(|| cached.response.clone())
+    }
+
+    /// Returns the generation of the namespace, to be passed to store once the read completes.
+    /// The namespace is tracked from then on so that writes racing with the read are noticed.
+    pub fn generation(&self, namespace: &str) -> u64 {
+        self.namespaces
+            .lock()
+            .expect("Result cache lock is not poisoned")
+            .entry(namespace.to_string())
+            .or_default()
+            .generation
+    }
+
+    /// Stores the response of a read that started at the given generation, unless the namespace
+    /// was written since or already holds max_entries responses.
+    pub fn store(
+        &self,
+        namespace: &str,
+        key: Vec<u8>,
+        generation: u64,
+        response: RawDocumentBuf,
+        ttl: Duration,
+        max_entries: usize,
+    ) {
+        let mut namespaces = self
+            .namespaces
+            .lock()
+            .expect("Result cache lock is not poisoned");
+        let Some(entries) = namespaces.get_mut(namespace) else {
+            return;
+        };
+        if entries.generation != generation {
+            return;
+        }
+
+        if entries.responses.len() >= max_entries && !entries.responses.contains_key(&key) {
+            entries
+                .responses
+                .retain(|_, cached| cached.stored_at.elapsed() < ttl);
+            if entries.responses.len() >= max_entries {
+                return;
+            }
+        }
+
+        entries.responses.insert(
+            key,
+            CachedResponse {
+                stored_at: Instant::now(),
+                response,
+            },
+        );
+    }
+
+    /// Drops the responses of the namespace after a write to it.
+    pub fn invalidate(&self, namespace: &str) {
+        let mut namespaces = self
+            .namespaces
+            .lock()
+            .expect("Result cache lock is not poisoned");
+        if let Some(entries) = namespaces.get_mut(namespace) {
+            entries.generation += 1;
+            entries.responses.clear();
+        }
+    }
+
+    /// Drops the responses of all the namespaces of the database after it is dropped.
+    pub fn invalidate_database(&self, db: &str) {
+        let mut namespaces = self
+            .namespaces
+            .lock()
+            .expect("Result cache lock is not poisoned");
+        for (namespace, entries) in namespaces.iter_mut() {
+            if namespace
+                .strip_prefix(db)
+                .is_some_and(|collection| collection.starts_with('.'))
+            {
+                entries.generation += 1;
+                entries.responses.clear();
+            }
+        }
+    }
+}
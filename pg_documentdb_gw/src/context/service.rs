@@ -10,7 +10,7 @@ use std::{sync::Arc, time::Duration};
 
 use crate::{
     configuration::{DynamicConfiguration, SetupConfiguration},
-    context::{CursorStore, TransactionStore},
+    context::{AdmissionController, CursorStore, ReadCoalescer, ResultCache, TransactionStore},
     postgres::{PoolManager, QueryCatalog},
     service::TlsProvider,
 };
@@ -21,6 +21,9 @@ pub struct ServiceContextInner {
     pub connection_pool_manager: PoolManager,
     pub cursor_store: CursorStore,
     pub transaction_store: TransactionStore,
+    pub read_coalescer: ReadCoalescer,
+    pub result_cache: ResultCache,
+    pub admission_controller: AdmissionController,
     pub query_catalog: QueryCatalog,
     pub tls_provider: TlsProvider,
 }
@@ -37,6 +40,7 @@ impl ServiceContext {
         tls_provider: TlsProvider,
     ) -> Self {
         let timeout_secs = setup_configuration.transaction_timeout_secs();
+        let idle_timeout_secs = setup_configuration.transaction_idle_timeout_secs();
         let cursor_store = CursorStore::new(setup_configuration.as_ref(), true);
 
         let inner = ServiceContextInner {
@@ -44,7 +48,13 @@ impl ServiceContext {
             dynamic_configuration,
             connection_pool_manager,
             cursor_store,
-            transaction_store: TransactionStore::new(Duration::from_secs(timeout_secs)),
+            transaction_store: TransactionStore::new(
+                Duration::from_secs(timeout_secs),
+                idle_timeout_secs.map(Duration::from_secs),
+            ),
+            read_coalescer: ReadCoalescer::new(),
+            result_cache: ResultCache::new(),
+            admission_controller: AdmissionController::new(),
             query_catalog,
             tls_provider,
         };
@@ -67,6 +77,18 @@ impl ServiceContext {
         &self.0.transaction_store
     }
 
+    pub fn admission_controller(&self) -> &AdmissionController {
+        &self.0.admission_controller
+    }
+
+    pub fn read_coalescer(&self) -> &ReadCoalescer {
+        &self.0.read_coalescer
+    }
+
+    pub fn result_cache(&self) -> &ResultCache {
+        &self.0.result_cache
+    }
+
     pub fn query_catalog(&self) -> &QueryCatalog {
         &self.0.query_catalog
     }
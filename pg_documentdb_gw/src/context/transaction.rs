@@ -16,7 +16,7 @@ use crate::{
 };
 use std::{
     collections::HashMap,
-    sync::Arc,
+    sync::{Arc, Mutex},
     time::{Duration, Instant},
 };
 
@@ -36,6 +36,7 @@ pub struct Transaction {
     pub transaction_number: i64,
     pub cursors: CursorStore,
     transaction: Option<postgres::Transaction>,
+    last_used: Mutex<Instant>,
 }
 
 impl Transaction {
@@ -51,13 +52,30 @@ impl Transaction {
             transaction_number: request.transaction_number,
             transaction: Some(postgres::Transaction::start(conn, isolation_level).await?),
             cursors: CursorStore::new(config, false),
+            last_used: Mutex::new(Instant::now()),
         })
     }
 
     pub fn get_connection(&self) -> Option<Arc<Connection>> {
+        if let Ok(mut last_used) = self.last_used.lock() {
+            *last_used = Instant::now();
+        }
+
         self.transaction.as_ref().map(|t| t.get_connection())
     }
 
+    /// Whether the transaction has not run a statement for the idle timeout and nothing
+    /// holds its connection, so aborting it only releases an idle backend.
+    fn is_idle(&self, idle_timeout: Duration) -> bool {
+        self.transaction
+            .as_ref()
+            .is_some_and(|t| t.is_connection_unused())
+            && self
+                .last_used
+                .lock()
+                .is_ok_and(|last_used| last_used.elapsed() >= idle_timeout)
+    }
+
     pub fn get_session_id(&self) -> &[u8] {
         &self.session_id
     }
@@ -138,17 +156,31 @@ pub struct TransactionStore {
 }
 
 impl TransactionStore {
-    pub fn new(expiration: Duration) -> Self {
+    /// Transactions are aborted once they are older than the expiration, or when an idle
+    /// timeout is given, once they have been idle for longer than it.
+    pub fn new(expiration: Duration, idle_timeout: Option<Duration>) -> Self {
         let transactions = Arc::new(RwLock::new(HashMap::new()));
+        let reap_interval = idle_timeout.map_or(expiration, |idle| idle.min(expiration)) / 2;
         TransactionStore {
             transactions: transactions.clone(),
             last_seen_transactions: RwLock::new(HashMap::new()),
             _reaper: tokio::spawn(async move {
-                let mut interval = tokio::time::interval(expiration / 2);
+                let mut interval = tokio::time::interval(reap_interval);
                 loop {
                     interval.tick().await;
                     let mut cursors = transactions.write().await;
-                    cursors.retain(|_, (time, _)| time.elapsed() < expiration)
+                    cursors.retain(|_, (time, transaction): &mut TransactionEntry| {
+                        if time.elapsed() >= expiration {
+                            return false;
+                        }
+
+                        if idle_timeout.is_some_and(|idle| transaction.is_idle(idle)) {
+                            log::info!("Aborting an idle transaction to release its connection.");
+                            return false;
+                        }
+
+                        true
+                    })
                 }
             }),
         }
@@ -111,6 +111,7 @@ fn write_output_stage(
 pub async fn process_explain(
     request_context: &mut RequestContext<'_>,
     verbosity: Option<Verbosity>,
+    profile: Option<bool>,
     connection_context: &ConnectionContext,
     pg_data_client: &impl PgDataClient,
 ) -> Result<Response> {
@@ -132,6 +133,12 @@ pub async fn process_explain(
                 .map_or(Verbosity::QueryPlanner, Verbosity::from_str)
         });
 
+        // Profiling reports the time spent in each stage, which needs the plan to be executed
+        let profile = profile.unwrap_or_else(|| {
+            let request = request_context.payload;
+            request.document().get_bool("profile").unwrap_or(false)
+        });
+
         match result.0 {
             "explain" => {
                 if let Some(explain_doc) = result.1.as_document() {
@@ -152,6 +159,7 @@ pub async fn process_explain(
                     Box::pin(process_explain(
                         &mut new_request_context,
                         Some(verbosity),
+                        Some(profile),
                         connection_context,
                         pg_data_client,
                     ))
@@ -167,6 +175,7 @@ pub async fn process_explain(
                     request_context,
                     "pipeline",
                     verbosity,
+                    profile,
                     connection_context,
                     pg_data_client,
                 )
@@ -177,6 +186,7 @@ pub async fn process_explain(
                     request_context,
                     "find",
                     verbosity,
+                    profile,
                     connection_context,
                     pg_data_client,
                 )
@@ -187,6 +197,7 @@ pub async fn process_explain(
                     request_context,
                     "count",
                     verbosity,
+                    profile,
                     connection_context,
                     pg_data_client,
                 )
@@ -197,6 +208,7 @@ pub async fn process_explain(
                     request_context,
                     "distinct",
                     verbosity,
+                    profile,
                     connection_context,
                     pg_data_client,
                 )
@@ -234,12 +246,22 @@ impl Verbosity {
             _ => Verbosity::Default,
         }
     }
+
+    fn is_execution(&self) -> bool {
+        matches!(
+            self,
+            Verbosity::ExecutionStats
+                | Verbosity::AllPlansExecution
+                | Verbosity::AllShardsExecution
+        )
+    }
 }
 
 async fn run_explain(
     request_context: &mut RequestContext<'_>,
     query_base: &str,
     verbosity: Verbosity,
+    profile: bool,
     connection_context: &ConnectionContext,
     pg_data_client: &impl PgDataClient,
 ) -> Result<Response> {
@@ -268,6 +290,7 @@ async fn run_explain(
                 subtype,
                 query_base,
                 verbosity,
+                profile && verbosity.is_execution(),
                 connection_context.service_context.query_catalog(),
             )
             .await?;
@@ -343,6 +366,7 @@ async fn transform_explain(
     subtype: RequestType,
     query_base: &str,
     verbosity: Verbosity,
+    profile: bool,
     query_catalog: &QueryCatalog,
 ) -> Result<RawDocumentBuf> {
     let mut plans: Vec<PostgresExplain> = serde_json::from_value(explain_content).map_err(|e| {
@@ -364,11 +388,14 @@ async fn transform_explain(
 
     let is_unsharded = is_unsharded(&plan);
 
-    let plan = try_simplify_plan(plan, is_unsharded, query_base, query_catalog);
+    let mut plan = try_simplify_plan(plan, is_unsharded, query_base, query_catalog);
+    if profile {
+        compute_self_times(&mut plan);
+    }
 
     let collection_path = format!("{db}.{collection}");
     let mut base_result = if subtype == RequestType::Aggregate {
-        aggregate_explain(plan, &collection_path, verbosity, query_catalog)
+        aggregate_explain(plan, &collection_path, verbosity, profile, query_catalog)
     } else {
         cursor_explain(plan, &collection_path, false, verbosity, query_catalog)
     };
@@ -1026,6 +1053,7 @@ fn aggregate_explain(
     mut plan: ExplainPlan,
     collection_path: &str,
     verbosity: Verbosity,
+    profile: bool,
     query_catalog: &QueryCatalog,
 ) -> RawDocumentBuf {
     let (agg_type, shard_count) = walk_plan(
@@ -1046,7 +1074,14 @@ fn aggregate_explain(
     );
 
     if shard_count == 0 {
-        return aggregate_explain_core(plan, agg_type, collection_path, verbosity, query_catalog);
+        return aggregate_explain_core(
+            plan,
+            agg_type,
+            collection_path,
+            verbosity,
+            profile,
+            query_catalog,
+        );
     }
 
     let result = determine_pipeline_split(&mut plan);
@@ -1068,6 +1103,7 @@ fn aggregate_explain(
                         agg_type,
                         collection_path,
                         verbosity,
+                        profile,
                         query_catalog,
                     ),
                 );
@@ -1080,13 +1116,20 @@ fn aggregate_explain(
 
             return rawdoc! {
                 "splitPipeline": {
-                    "mergerPart": aggregate_explain_core(plan, AggregationType::StageBasedAggregation, collection_path, verbosity, query_catalog)
+                    "mergerPart": aggregate_explain_core(plan, AggregationType::StageBasedAggregation, collection_path, verbosity, profile, query_catalog)
                 },
                 "shards":  shards_explain
             };
         }
     }
-    aggregate_explain_core(plan, agg_type, collection_path, verbosity, query_catalog)
+    aggregate_explain_core(
+        plan,
+        agg_type,
+        collection_path,
+        verbosity,
+        profile,
+        query_catalog,
+    )
 }
 
 fn determine_pipeline_split(
@@ -1125,13 +1168,19 @@ fn aggregate_explain_core(
     agg_type: AggregationType,
     collection_path: &str,
     verbosity: Verbosity,
+    profile: bool,
     query_catalog: &QueryCatalog,
 ) -> RawDocumentBuf {
     match agg_type {
         AggregationType::SimpleAggregation => {
+            let profile_doc = profile.then(|| stage_profile(&plan));
+            let mut doc = cursor_explain(plan, collection_path, false, verbosity, query_catalog);
+            if let Some(profile_doc) = profile_doc {
+                doc.append("profile", profile_doc);
+            }
             rawdoc! {
                 "stages": [
-                    { "$cursor": cursor_explain(plan, collection_path, false, verbosity, query_catalog) }
+                    { "$cursor": doc }
                 ]
             }
         }
@@ -1151,6 +1200,9 @@ fn aggregate_explain_core(
                     if let Some(f) = f {
                         f(&plan, &mut doc, query_catalog)
                     }
+                    if profile {
+                        doc.append("profile", stage_profile(&plan));
+                    }
                     rawdoc! { documentdb_name: doc }
                 })
                 .collect();
@@ -1602,6 +1654,65 @@ fn execution_stats(plan: ExplainPlan, query_catalog: &QueryCatalog) -> RawDocume
     }
 }
 
+/// Computes the time and shared blocks each node of the plan spent itself, without its inputs,
+/// so that they can be summed up per aggregation stage. Postgres reports both cumulatively
+/// over the inputs of a node, and the time per loop. Returns the totals of the node.
+fn compute_self_times(plan: &mut ExplainPlan) -> (f64, i64) {
+    let loops = plan.actual_loops.unwrap_or(1).max(1);
+    let total_time = plan.actual_total_time.unwrap_or(0.0) * loops as f64;
+    let total_blocks = plan.shared_hit_blocks.unwrap_or(0) + plan.shared_read_blocks.unwrap_or(0);
+
+    let mut input_time = 0.0;
+    let mut input_blocks = 0;
+    if let Some(inner_plans) = plan.inner_plans.as_mut() {
+        for inner_plan in inner_plans {
+            let (time, blocks) = compute_self_times(inner_plan);
+            input_time += time;
+            input_blocks += blocks;
+        }
+    }
+
+    // The plans of the shards run remotely, the time of the node waiting on them stays its own.
+    if let Some(dplan) = plan.distributed_plan.as_mut() {
+        for task in dplan.job.tasks.iter_mut() {
+            for worker_plans in task.worker_plans.iter_mut() {
+                for worker_plan in worker_plans.iter_mut() {
+                    compute_self_times(&mut worker_plan.plan);
+                }
+            }
+        }
+    }
+
+    plan.self_time = (total_time - input_time).max(0.0);
+    plan.self_shared_blocks = (total_blocks - input_blocks).max(0);
+    (total_time, total_blocks)
+}
+
+/// Sums up the self times of the nodes that make up an aggregation stage. The nodes of the
+/// stages below it have already been split off the plan when the stages were classified.
+fn sum_self_times(plan: &ExplainPlan) -> (f64, i64) {
+    let mut totals = (plan.self_time, plan.self_shared_blocks);
+    if let Some(inner_plans) = plan.inner_plans.as_ref() {
+        for inner_plan in inner_plans {
+            let (time, blocks) = sum_self_times(inner_plan);
+            totals.0 += time;
+            totals.1 += blocks;
+        }
+    }
+    totals
+}
+
+fn stage_profile(plan: &ExplainPlan) -> RawDocumentBuf {
+    let loops = plan.actual_loops.unwrap_or(1).max(1);
+    let (self_time, self_blocks) = sum_self_times(plan);
+    rawdoc! {
+        "nReturned": smallest_from_i64(plan.actual_rows.unwrap_or(0) * loops),
+        "inclusiveTimeMillis": truncate_latency(plan.actual_total_time.unwrap_or(0.0) * loops as f64),
+        "exclusiveTimeMillis": truncate_latency(self_time),
+        "exclusiveBlocksAccessed": smallest_from_i64(self_blocks),
+    }
+}
+
 fn distribute_index_details(plan: &mut ExplainPlan, index_details: Option<Vec<IndexDetails>>) {
     plan.index_details = index_details;
 
@@ -60,6 +60,9 @@ pub struct PostgresExplain {
 #[derive(Deserialize, Debug, Clone, Default)]
 #[serde(rename_all = "PascalCase")]
 pub struct ExplainPlan {
+    #[serde(rename = "Actual Loops")]
+    pub actual_loops: Option<i64>,
+
     #[serde(rename = "Actual Rows")]
     pub actual_rows: Option<i64>,
 
@@ -177,6 +180,15 @@ pub struct ExplainPlan {
 
     #[serde(rename = "IndexDetails")]
     pub index_details: Option<Vec<IndexDetails>>,
+
+    /// Time spent in the node itself, excluding its inputs (only computed for profile explains).
+    #[serde(skip)]
+    pub self_time: f64,
+
+    /// Shared blocks accessed by the node itself, excluding its inputs (only computed for
+    /// profile explains).
+    #[serde(skip)]
+    pub self_shared_blocks: i64,
 }
 
 #[derive(Deserialize, Debug, Clone)]
@@ -26,9 +26,9 @@ pub use crate::postgres::QueryCatalog;
 
 use either::Either::{Left, Right};
 use openssl::ssl::Ssl;
-use socket2::TcpKeepalive;
-use std::net::IpAddr;
-use std::{pin::Pin, sync::Arc, time::Duration};
+use socket2::{Domain, Socket, TcpKeepalive, Type};
+use std::net::{IpAddr, SocketAddr};
+use std::{pin::Pin, sync::Arc, thread, time::Duration};
 use tokio::{
     io::BufStream,
     net::{TcpListener, TcpStream},
@@ -46,6 +46,7 @@ use crate::{
     responses::{CommandError, Response},
     telemetry::{
         client_info::parse_client_info, error_code_to_status_code, event_id::EventId,
+        latency_histograms::REQUEST_LATENCY_HISTOGRAMS, metrics_endpoint::run_metrics_endpoint,
         TelemetryProvider,
     },
 };
@@ -54,6 +55,9 @@ use crate::{
 const TCP_KEEPALIVE_TIME_SECS: u64 = 180;
 const TCP_KEEPALIVE_INTERVAL_SECS: u64 = 60;
 
+// Backlog of the SO_REUSEPORT listeners of the listener runtimes
+const LISTENER_BACKLOG: i32 = 1024;
+
 // Buffer configuration constants
 const STREAM_READ_BUFFER_SIZE: usize = 8 * 1024;
 const STREAM_WRITE_BUFFER_SIZE: usize = 8 * 1024;
@@ -66,6 +70,10 @@ type GwStream = BufStream<SslStream<TcpStream>>;
 /// new connections until the cancellation token is triggered. Each connection is
 /// handled in a separate async task.
 ///
+/// With `ListenerRuntimes` configured, connections are instead accepted by that many threads,
+/// each running a single threaded runtime with its own SO_REUSEPORT listener, so the kernel
+/// spreads the connections over the threads and a connection never migrates between them.
+///
 /// # Arguments
 ///
 /// * `service_context` - The service configuration and context
@@ -89,20 +97,102 @@ pub async fn run_gateway<T>(
     token: CancellationToken,
 ) -> Result<()>
 where
-    T: PgDataClient,
+    T: PgDataClient + 'static,
 {
-    // TCP configuration part
-    let tcp_listener = TcpListener::bind(format!(
+    let listen_host = if service_context.setup_configuration().use_local_host() {
+        "127.0.0.1"
+    } else {
+        "[::]"
+    };
+
+    // Request latency metrics are served on their own port when configured
+    if let Some(metrics_port) = service_context.setup_configuration().metrics_listen_port() {
+        let metrics_address = format!(
+            "{}:{metrics_port}",
+            service_context
+                .setup_configuration()
+                .metrics_listen_address()
+        );
+        let metrics_token = token.clone();
+        tokio::spawn(async move {
+            if let Err(e) = run_metrics_endpoint(metrics_address, metrics_token).await {
+                log::error!("Failed to serve gateway metrics: {e:?}.");
+            }
+        });
+    }
+
+    let listen_address = format!(
         "{}:{}",
-        if service_context.setup_configuration().use_local_host() {
-            "127.0.0.1"
-        } else {
-            "[::]"
-        },
+        listen_host,
         service_context.setup_configuration().gateway_listen_port(),
-    ))
-    .await?;
+    );
+
+    if let Some(listener_runtimes) = service_context.setup_configuration().listener_runtimes() {
+        let listen_address: SocketAddr = listen_address
+            .parse()
+            .map_err(|e| DocumentDBError::internal_error(format!("Invalid address: {e}")))?;
+
+        for runtime_index in 0..listener_runtimes {
+            // Bind in the caller so that a bind failure fails the startup
+            let listener = bind_reuse_port_listener(listen_address)?;
+            let runtime_service_context = service_context.clone();
+            let runtime_telemetry = telemetry.clone();
+            let runtime_token = token.clone();
+            thread::Builder::new()
+                .name(format!("gateway-listener-{runtime_index}"))
+                .spawn(move || {
+                    let runtime = tokio::runtime::Builder::new_current_thread()
+                        .enable_all()
+                        .build()
+                        .expect("Failed to create listener runtime");
+                    runtime.block_on(async move {
+                        let tcp_listener = TcpListener::from_std(listener)
+                            .expect("Failed to register the listener with the runtime");
+                        accept_connections::<T>(
+                            tcp_listener,
+                            runtime_service_context,
+                            runtime_telemetry,
+                            runtime_token,
+                        )
+                        .await
+                    });
+                })?;
+        }
+
+        log::info!("Accepting connections on {listener_runtimes} listener runtimes");
+        token.cancelled().await;
+        return Ok(());
+    }
+
+    // TCP configuration part
+    let tcp_listener = TcpListener::bind(listen_address).await?;
 
+    accept_connections::<T>(tcp_listener, service_context, telemetry, token).await;
+    Ok(())
+}
+
+/// Creates a non blocking listener with SO_REUSEPORT, so that several listeners can accept
+/// connections on the same address.
+fn bind_reuse_port_listener(address: SocketAddr) -> Result<std::net::TcpListener> {
+    let socket = Socket::new(Domain::for_address(address), Type::STREAM, None)?;
+    socket.set_reuse_address(true)?;
+    socket.set_reuse_port(true)?;
+    socket.set_nonblocking(true)?;
+    socket.bind(&address.into())?;
+    socket.listen(LISTENER_BACKLOG)?;
+    Ok(socket.into())
+}
+
+/// Accepts connections on the listener and handles each of them in a task of the current
+/// runtime, until the token is cancelled.
+async fn accept_connections<T>(
+    tcp_listener: TcpListener,
+    service_context: ServiceContext,
+    telemetry: Option<Box<dyn TelemetryProvider>>,
+    token: CancellationToken,
+) where
+    T: PgDataClient + 'static,
+{
     // Listen for new tcp connections until token is not cancelled
     loop {
         tokio::select! {
@@ -123,7 +213,7 @@ where
                 });
             }
             () = token.cancelled() => {
-                return Ok(())
+                return
             }
         }
     }
@@ -334,10 +424,16 @@ where
 
     let handle_request_start = request_tracker.start_timer();
     let buffer_read_start = request_tracker.start_timer();
+    connection_context.response_compressor = None;
     let message = protocol::reader::read_request(header, stream).await?;
 
     request_tracker.record_duration(RequestIntervalKind::BufferRead, buffer_read_start);
 
+    // Compressed requests are processed (and responded to) based on the original message
+    connection_context.response_compressor = message.compressor;
+    let effective_header = message.effective_header();
+    let header = &effective_header;
+
     if connection_context
         .dynamic_configuration()
         .send_shutdown_responses()
@@ -399,6 +495,19 @@ where
         None
     };
 
+    if connection_context
+        .service_context
+        .setup_configuration()
+        .metrics_listen_port()
+        .is_some()
+    {
+        REQUEST_LATENCY_HISTOGRAMS.record(
+            request_context.info.db().unwrap_or_default(),
+            *request_context.payload.request_type(),
+            request_context.tracker,
+        );
+    }
+
     if connection_context
         .dynamic_configuration()
         .enable_verbose_logging_in_gateway()
@@ -446,7 +555,17 @@ where
 
     // Write the response back to the stream
     if connection_context.requires_response {
-        responses::writer::write(header, &response, stream).await?;
+        let write_response_start = request_context.tracker.start_timer();
+        responses::writer::write(
+            header,
+            &response,
+            connection_context.response_compressor,
+            stream,
+        )
+        .await?;
+        request_context
+            .tracker
+            .record_duration(RequestIntervalKind::WriteResponse, write_response_start);
     }
 
     if let Some(telemetry) = connection_context.telemetry_provider.as_ref() {
@@ -481,7 +600,13 @@ async fn log_and_write_error(
     let command_error = CommandError::from_error(connection_context, e, activity_id).await;
     let response = command_error.to_raw_document_buf()?;
 
-    responses::writer::write_and_flush(header, &response, stream).await?;
+    responses::writer::write_and_flush_with_compressor(
+        header,
+        &response,
+        connection_context.response_compressor,
+        stream,
+    )
+    .await?;
 
     // telemetry can block so do it after write and flush.
     log::error!(activity_id = activity_id; "Request failure: {e}");
@@ -6,7 +6,12 @@
  *-------------------------------------------------------------------------
  */
 
-use std::time::Duration;
+use std::{
+    future::{poll_fn, Future},
+    pin::Pin,
+    task::Poll,
+    time::Duration,
+};
 
 use tokio_postgres::{
     types::{ToSql, Type},
@@ -14,11 +19,15 @@ use tokio_postgres::{
 };
 
 use crate::{
-    error::Result,
+    error::{DocumentDBError, Result},
     postgres::{PgDocument, PoolConnection},
     requests::{request_tracker::RequestTracker, RequestIntervalKind},
 };
 
+// Statement timeouts are set through a prepared set_config rather than SET, so that they are
+// parsed once per connection like the other statements instead of on every request.
+const SET_STATEMENT_TIMEOUT: &str = "SELECT pg_catalog.set_config('statement_timeout', $1, $2)";
+
 // Provides functions which coerce bson to BYTEA. Any statement binding a PgDocument should use query_typed and not query
 // WrongType { postgres: Other(Other { name: "bson", oid: 18934, kind: Simple, schema: "schema_name" }), rust: "document_gateway::postgres::document::PgDocument" })
 // Will be occur if the wrong one is used.
@@ -58,6 +67,17 @@ impl Timeout {
 }
 
 impl Connection {
+    async fn set_statement_timeout(&self, max_time_ms: i64, is_local: bool) -> Result<()> {
+        let statement = self
+            .pool_connection
+            .prepare_typed_cached(SET_STATEMENT_TIMEOUT, &[Type::TEXT, Type::BOOL])
+            .await?;
+        self.pool_connection
+            .query(&statement, &[&max_time_ms.to_string(), &is_local])
+            .await?;
+        Ok(())
+    }
+
     async fn query_internal(
         &self,
         query: &str,
@@ -71,6 +91,37 @@ impl Connection {
         Ok(self.pool_connection.query(&statement, params).await?)
     }
 
+    /// Runs the statement once for every set of parameters without waiting for the previous
+    /// results: tokio-postgres pipelines the queries that are polled concurrently on a client.
+    /// Each query runs in its own transaction, so the result of every query is returned.
+    pub async fn query_pipelined(
+        &self,
+        query: &str,
+        parameter_types: &[Type],
+        params: &[&[&(dyn ToSql + Sync)]],
+        request_tracker: &mut RequestTracker,
+    ) -> Result<Vec<Result<Vec<Row>>>> {
+        let request_start = request_tracker.start_timer();
+        let statement = self
+            .pool_connection
+            .prepare_typed_cached(query, parameter_types)
+            .await?;
+
+        let results = join_all(
+            params
+                .iter()
+                .map(|params| self.pool_connection.query(&statement, params))
+                .collect(),
+        )
+        .await;
+        request_tracker.record_duration(RequestIntervalKind::ProcessRequest, request_start);
+
+        Ok(results
+            .into_iter()
+            .map(|result| result.map_err(DocumentDBError::from))
+            .collect())
+    }
+
     pub async fn query(
         &self,
         query: &str,
@@ -85,9 +136,7 @@ impl Connection {
                 max_time_ms,
             }) if self.in_transaction => {
                 let set_timeout_start = request_tracker.start_timer();
-                self.pool_connection
-                    .batch_execute(&format!("set local statement_timeout to {max_time_ms}"))
-                    .await?;
+                self.set_statement_timeout(max_time_ms, true).await?;
                 request_tracker.record_duration(
                     RequestIntervalKind::PostgresSetStatementTimeout,
                     set_timeout_start,
@@ -98,11 +147,7 @@ impl Connection {
                 request_tracker.record_duration(RequestIntervalKind::ProcessRequest, request_start);
 
                 let set_timeout_start = request_tracker.start_timer();
-                self.pool_connection
-                    .batch_execute(&format!(
-                        "set local statement_timeout to {}",
-                        Duration::from_secs(120).as_millis()
-                    ))
+                self.set_statement_timeout(Duration::from_secs(120).as_millis() as i64, true)
                     .await?;
                 request_tracker.record_duration(
                     RequestIntervalKind::PostgresSetStatementTimeout,
@@ -123,9 +168,7 @@ impl Connection {
                 );
 
                 let set_timeout_start = request_tracker.start_timer();
-                self.pool_connection
-                    .batch_execute(&format!("set local statement_timeout to {max_time_ms}"))
-                    .await?;
+                self.set_statement_timeout(max_time_ms, true).await?;
                 request_tracker.record_duration(
                     RequestIntervalKind::PostgresSetStatementTimeout,
                     set_timeout_start,
@@ -153,9 +196,7 @@ impl Connection {
                 max_time_ms,
             }) => {
                 let set_timeout_start = request_tracker.start_timer();
-                self.pool_connection
-                    .batch_execute(&format!("set statement_timeout to {max_time_ms}"))
-                    .await?;
+                self.set_statement_timeout(max_time_ms, false).await?;
                 request_tracker.record_duration(
                     RequestIntervalKind::PostgresSetStatementTimeout,
                     set_timeout_start,
@@ -166,11 +207,7 @@ impl Connection {
                 request_tracker.record_duration(RequestIntervalKind::ProcessRequest, request_start);
 
                 let set_timeout_start = request_tracker.start_timer();
-                self.pool_connection
-                    .batch_execute(&format!(
-                        "set statement_timeout to {}",
-                        Duration::from_secs(120).as_millis()
-                    ))
+                self.set_statement_timeout(Duration::from_secs(120).as_millis() as i64, false)
                     .await?;
                 request_tracker.record_duration(
                     RequestIntervalKind::PostgresSetStatementTimeout,
@@ -218,3 +255,33 @@ impl Connection {
         }
     }
 }
+
+/// Polls all the futures concurrently and returns their outputs in order.
+async fn join_all<F: Future>(futures: Vec<F>) -> Vec<F::Output> {
+    let mut futures: Vec<Pin<Box<F>>> = futures.into_iter().map(Box::pin).collect();
+    let mut outputs: Vec<Option<F::Output>> = futures.iter().map(|_| None).collect();
+
+    poll_fn(|cx| {
+        let mut is_pending = false;
+        for (future, output) in futures.iter_mut().zip(outputs.iter_mut()) {
+            if output.is_none() {
+                match future.as_mut().poll(cx) {
+                    Poll::Ready(value) => *output = Some(value),
+                    Poll::Pending => is_pending = true,
+                }
+            }
+        }
+
+        if is_pending {
+            Poll::Pending
+        } else {
+            Poll::Ready(())
+        }
+    })
+    .await;
+
+    outputs
+        .into_iter()
+        .map(|output| output.expect("All futures completed"))
+        .collect()
+}
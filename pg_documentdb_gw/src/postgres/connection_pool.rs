@@ -9,9 +9,10 @@
 use std::{
     collections::hash_map::DefaultHasher,
     hash::{Hash, Hasher},
+    sync::atomic::{AtomicU64, AtomicUsize, Ordering},
 };
 
-use deadpool_postgres::{Manager, Pool, Runtime, Status};
+use deadpool_postgres::{Manager, ManagerConfig, Pool, RecyclingMethod, Runtime, Status};
 use tokio::{
     sync::RwLock,
     time::{Duration, Instant},
@@ -22,6 +23,9 @@ use crate::{configuration::SetupConfiguration, error::Result, QueryCatalog};
 
 const POOL_PRUNE_INTERVAL_SECS: u64 = 10;
 
+/// Acquire waits longer than this mean the pool is too small for its load
+const ACQUIRE_WAIT_GROW_THRESHOLD_NANOS: u64 = 5_000_000;
+
 fn pg_configuration(
     setup_configuration: &dyn SetupConfiguration,
     query_catalog: &QueryCatalog,
@@ -79,11 +83,43 @@ impl ConnectionPoolStatus {
     }
 }
 
+/// Load observed on a pool since it was last sampled, used to size the pool adaptively.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct ConnectionPoolDemand {
+    pub acquires: u64,
+    pub max_acquire_wait_nanos: u64,
+
+    /// Connections currently open and the maximum allowed.
+    pub size: usize,
+    pub max_size: usize,
+}
+
+impl ConnectionPoolDemand {
+    /// The size the pool wants: grows by a quarter when acquires had to wait, otherwise shrinks
+    /// by at most a quarter towards the connections it keeps open (idle ones are pruned).
+    pub fn desired_size(&self, min_size: usize) -> usize {
+        let step = (self.max_size / 4).max(1);
+        let desired = if self.max_acquire_wait_nanos > ACQUIRE_WAIT_GROW_THRESHOLD_NANOS {
+            self.max_size + step
+        } else {
+            (self.size + 1).max(self.max_size.saturating_sub(step))
+        };
+
+        desired.max(min_size)
+    }
+}
+
 #[derive(Debug)]
 pub struct ConnectionPool {
     pool: Pool,
     last_used: RwLock<Instant>,
     identifier: String,
+
+    // Acquire statistics since the pool was last sampled
+    acquires: AtomicU64,
+    max_acquire_wait_nanos: AtomicU64,
+
+    max_size: AtomicUsize,
 }
 
 impl ConnectionPool {
@@ -103,7 +139,15 @@ impl ConnectionPool {
             &application_name,
         );
 
-        let manager = Manager::new(config, NoTls);
+        // The statements prepared by Connection are cached on the physical connection, recycling
+        // must not DISCARD them (as RecyclingMethod::Clean would) for them to be prepared only once.
+        let manager = Manager::from_config(
+            config,
+            NoTls,
+            ManagerConfig {
+                recycling_method: RecyclingMethod::Fast,
+            },
+        );
 
         let pool_builder = Pool::builder(manager)
             .runtime(Runtime::Tokio1)
@@ -141,13 +185,47 @@ impl ConnectionPool {
             pool,
             last_used: RwLock::new(Instant::now()),
             identifier: pool_identifier,
+            acquires: AtomicU64::new(0),
+            max_acquire_wait_nanos: AtomicU64::new(0),
+            max_size: AtomicUsize::new(max_size),
         })
     }
 
     pub async fn acquire_connection(&self) -> Result<PoolConnection> {
-        let mut write_lock = self.last_used.write().await;
-        *write_lock = Instant::now();
-        Ok(self.pool.get().await?)
+        let acquire_start = {
+            let mut write_lock = self.last_used.write().await;
+            *write_lock = Instant::now();
+            *write_lock
+        };
+
+        let connection = self.pool.get().await;
+
+        self.acquires.fetch_add(1, Ordering::Relaxed);
+        self.max_acquire_wait_nanos
+            .fetch_max(acquire_start.elapsed().as_nanos() as u64, Ordering::Relaxed);
+
+        Ok(connection?)
+    }
+
+    /// Returns the load of the pool since the last time it was sampled and resets it.
+    pub fn sample_demand(&self) -> ConnectionPoolDemand {
+        ConnectionPoolDemand {
+            acquires: self.acquires.swap(0, Ordering::Relaxed),
+            max_acquire_wait_nanos: self.max_acquire_wait_nanos.swap(0, Ordering::Relaxed),
+            size: self.pool.status().size,
+            max_size: self.max_size(),
+        }
+    }
+
+    pub fn max_size(&self) -> usize {
+        self.max_size.load(Ordering::Relaxed)
+    }
+
+    /// Changes the maximum number of connections, connections over the new size are closed
+    /// as they are returned to the pool.
+    pub fn resize(&self, max_size: usize) {
+        self.pool.resize(max_size);
+        self.max_size.store(max_size, Ordering::Relaxed);
     }
 
     pub async fn last_used(&self) -> Instant {
@@ -6,7 +6,7 @@
  *-------------------------------------------------------------------------
  */
 
-use std::{future::Future, sync::Arc};
+use std::{future::Future, ops::Range, sync::Arc};
 
 use async_trait::async_trait;
 use bson::{RawDocument, RawDocumentBuf};
@@ -14,7 +14,7 @@ use tokio_postgres::Row;
 
 use crate::{
     auth::AuthState,
-    context::{ConnectionContext, Cursor, RequestContext, ServiceContext},
+    context::{ConnectionContext, Cursor, CursorPrefetch, RequestContext, ServiceContext},
     error::Result,
     explain::Verbosity,
     postgres::Transaction,
@@ -156,12 +156,32 @@ pub trait PgDataClient: Send + Sync {
         connection_context: &ConnectionContext,
     ) -> Result<Vec<Row>>;
 
+    /// Starts fetching the batch after `continuation` in the background on a pooled connection,
+    /// using the getMore of the current request.
+    async fn start_cursor_prefetch(
+        &self,
+        request_context: &mut RequestContext<'_>,
+        db: &str,
+        continuation: &RawDocument,
+        connection_context: &ConnectionContext,
+    ) -> Result<CursorPrefetch>;
+
     async fn execute_insert(
         &self,
         request_context: &mut RequestContext<'_>,
         connection_context: &ConnectionContext,
     ) -> Result<Vec<Row>>;
 
+    /// Inserts the sub batches of the document sequence of the request (each with the indexes of
+    /// its documents) pipelined on a single connection, returning the result of every sub batch.
+    /// A failed sub batch doesn't roll back the others.
+    async fn execute_insert_pipelined(
+        &self,
+        request_context: &mut RequestContext<'_>,
+        connection_context: &ConnectionContext,
+        batches: &[(Range<usize>, &[u8])],
+    ) -> Result<Vec<(Range<usize>, Result<Vec<Row>>)>>;
+
     async fn execute_list_collections(
         &self,
         request_context: &mut RequestContext<'_>,
@@ -253,6 +273,12 @@ pub trait PgDataClient: Send + Sync {
         connection_context: &ConnectionContext,
     ) -> Result<Response>;
 
+    async fn execute_slow_command_profile(
+        &self,
+        request_context: &mut RequestContext<'_>,
+        connection_context: &ConnectionContext,
+    ) -> Result<Response>;
+
     #[allow(clippy::too_many_arguments)]
     async fn execute_rename_collection(
         &self,
@@ -6,18 +6,23 @@
  *-------------------------------------------------------------------------
  */
 
-use std::sync::Arc;
+use std::{ops::Range, sync::Arc};
 
 use async_trait::async_trait;
 use bson::{RawDocument, RawDocumentBuf};
-use tokio_postgres::{error::SqlState, types::Type, Row};
+use tokio_postgres::{
+    error::SqlState,
+    types::{ToSql, Type},
+    Row,
+};
 
 use crate::{
     auth::AuthState,
-    context::{ConnectionContext, Cursor, RequestContext, ServiceContext},
+    context::{ConnectionContext, Cursor, CursorPrefetch, RequestContext, ServiceContext},
     error::{DocumentDBError, Result},
     explain::Verbosity,
     postgres::{PgDataClient, PoolConnection},
+    requests::request_tracker::RequestTracker,
     responses::{PgResponse, Response},
 };
 
@@ -515,6 +520,51 @@ impl PgDataClient for DocumentDBDataClient {
         Ok(get_more_rows)
     }
 
+    async fn start_cursor_prefetch(
+        &self,
+        request_context: &mut RequestContext<'_>,
+        db: &str,
+        continuation: &RawDocument,
+        connection_context: &ConnectionContext,
+    ) -> Result<CursorPrefetch> {
+        let (request, request_info, _) = request_context.get_components();
+        let connection_pool = Arc::clone(self.connection_pool.as_ref().ok_or(
+            DocumentDBError::internal_error(
+                "Prefetching a cursor on unauthorized data client".to_string(),
+            ),
+        )?);
+
+        let query = connection_context
+            .service_context
+            .query_catalog()
+            .cursor_get_more()
+            .to_string();
+        let db = db.to_string();
+        let get_more = request.document().to_raw_document_buf();
+        let continuation = continuation.to_raw_document_buf();
+        let max_time_ms = request_info.max_time_ms;
+        let batch_size = get_more
+            .get("batchSize")
+            .ok()
+            .flatten()
+            .and_then(|v| v.as_i64().or_else(|| v.as_i32().map(i64::from)));
+
+        let handle = tokio::spawn(async move {
+            let connection = Connection::new(connection_pool.acquire_connection().await?, false);
+            connection
+                .query(
+                    &query,
+                    &[Type::TEXT, Type::BYTEA, Type::BYTEA],
+                    &[&db, &PgDocument(&get_more), &PgDocument(&continuation)],
+                    Timeout::command(max_time_ms),
+                    &mut RequestTracker::new(),
+                )
+                .await
+        });
+
+        Ok(CursorPrefetch { batch_size, handle })
+    }
+
     async fn execute_insert(
         &self,
         request_context: &mut RequestContext<'_>,
@@ -540,6 +590,41 @@ impl PgDataClient for DocumentDBDataClient {
         Ok(insert_rows)
     }
 
+    async fn execute_insert_pipelined(
+        &self,
+        request_context: &mut RequestContext<'_>,
+        connection_context: &ConnectionContext,
+        batches: &[(Range<usize>, &[u8])],
+    ) -> Result<Vec<(Range<usize>, Result<Vec<Row>>)>> {
+        let (request, request_info, request_tracker) = request_context.get_components();
+        let db = request_info.db()?.to_string();
+        let command = PgDocument(request.document());
+        let documents: Vec<Option<&[u8]>> = batches.iter().map(|(_, batch)| Some(*batch)).collect();
+
+        let params: Vec<[&(dyn ToSql + Sync); 3]> = documents
+            .iter()
+            .map(|batch| [&db as &(dyn ToSql + Sync), &command, batch])
+            .collect();
+        let params: Vec<&[&(dyn ToSql + Sync)]> = params.iter().map(|p| p.as_slice()).collect();
+
+        let batch_rows = self
+            .pull_connection(connection_context)
+            .await?
+            .query_pipelined(
+                connection_context.service_context.query_catalog().insert(),
+                &[Type::TEXT, Type::BYTEA, Type::BYTEA],
+                &params,
+                request_tracker,
+            )
+            .await?;
+
+        Ok(batches
+            .iter()
+            .map(|(documents, _)| documents.clone())
+            .zip(batch_rows)
+            .collect())
+    }
+
     async fn execute_list_collections(
         &self,
         request_context: &mut RequestContext<'_>,
@@ -899,6 +984,30 @@ impl PgDataClient for DocumentDBDataClient {
         Ok(Response::Pg(PgResponse::new(db_stats_rows)))
     }
 
+    async fn execute_slow_command_profile(
+        &self,
+        request_context: &mut RequestContext<'_>,
+        connection_context: &ConnectionContext,
+    ) -> Result<Response> {
+        let (_, request_info, request_tracker) = request_context.get_components();
+        let slow_command_profile_rows = self
+            .pull_connection(connection_context)
+            .await?
+            .query(
+                connection_context
+                    .service_context
+                    .query_catalog()
+                    .slow_command_profile(),
+                &[Type::TEXT],
+                &[&request_info.db()?.to_string()],
+                Timeout::transaction(request_info.max_time_ms),
+                request_tracker,
+            )
+            .await?;
+
+        Ok(Response::Pg(PgResponse::new(slow_command_profile_rows)))
+    }
+
     async fn execute_rename_collection(
         &self,
         request_context: &mut RequestContext<'_>,
@@ -16,12 +16,14 @@ mod query_catalog;
 mod transaction;
 
 pub use connection::{Connection, Timeout, TimeoutType};
-pub use connection_pool::{ConnectionPool, ConnectionPoolStatus, PoolConnection};
+pub use connection_pool::{
+    ConnectionPool, ConnectionPoolDemand, ConnectionPoolStatus, PoolConnection,
+};
 pub use data_client::PgDataClient;
 pub use document::PgDocument;
 pub use documentdb_data_client::DocumentDBDataClient;
 pub use pool_manager::{
-    clean_unused_pools, PoolManager, AUTHENTICATION_MAX_CONNECTIONS,
+    adjust_data_pool_sizes, clean_unused_pools, PoolManager, AUTHENTICATION_MAX_CONNECTIONS,
     SYSTEM_REQUESTS_MAX_CONNECTIONS,
 };
 pub use query_catalog::{create_query_catalog, QueryCatalog};
@@ -30,6 +30,8 @@ pub const AUTHENTICATION_MAX_CONNECTIONS: usize = 5;
 const POSTGRES_POOL_CLEANUP_INTERVAL_SEC: u64 = 300;
 /// The threshold when a connection pool needs to be disposed
 const POSTGRES_POOL_DISPOSE_INTERVAL_SEC: u64 = 7200;
+/// How often the user data pools are resized when adaptive pool sizing is enabled
+const POSTGRES_POOL_ADJUST_INTERVAL_SEC: u64 = 5;
 
 pub struct PoolManager {
     query_catalog: QueryCatalog,
@@ -121,13 +123,36 @@ impl PoolManager {
             return Ok(());
         }
 
+        let real_max_connections = self.get_real_max_connections(max_connections).await;
+
+        // With adaptive sizing new pools start with a fair share of the budget and grow with load
+        let pool_size = if self
+            .dynamic_configuration
+            .enable_adaptive_pool_sizing()
+            .await
+        {
+            let pool_count = write_lock
+                .keys()
+                .filter(|(_, _, pool_max_connections)| *pool_max_connections == max_connections)
+                .count();
+            let min_size = self
+                .dynamic_configuration
+                .adaptive_pool_min_connections()
+                .await;
+            (real_max_connections / (pool_count + 1))
+                .max(min_size)
+                .min(real_max_connections)
+        } else {
+            real_max_connections
+        };
+
         let user_data_pool = Arc::new(ConnectionPool::new_with_user(
             self.setup_configuration.as_ref(),
             &self.query_catalog,
             username,
             Some(password),
             format!("{}-UserData", self.setup_configuration.application_name()),
-            self.get_real_max_connections(max_connections).await,
+            pool_size,
         )?);
 
         write_lock.insert(key, user_data_pool);
@@ -190,6 +215,42 @@ impl PoolManager {
         clean(&self.system_shared_pools, max_age).await;
     }
 
+    /// Resizes the user data pools from the load they observed, sharing the connection budget
+    /// between users so that a busy user can't starve the others.
+    pub async fn adjust_data_pool_sizes(&self) {
+        let max_connections = self.dynamic_configuration.max_connections().await;
+        let budget = self.get_real_max_connections(max_connections).await;
+        let min_size = self
+            .dynamic_configuration
+            .adaptive_pool_min_connections()
+            .await;
+
+        let pools: Vec<Arc<ConnectionPool>> = self
+            .user_data_pools
+            .read()
+            .await
+            .iter()
+            .filter(|((_, _, pool_max_connections), _)| *pool_max_connections == max_connections)
+            .map(|(_, pool)| Arc::clone(pool))
+            .collect();
+
+        if pools.is_empty() {
+            return;
+        }
+
+        let demands: Vec<usize> = pools
+            .iter()
+            .map(|pool| pool.sample_demand().desired_size(min_size))
+            .collect();
+
+        let sizes = fair_share_allocation(&demands, budget, min_size);
+        for (pool, size) in pools.iter().zip(sizes) {
+            if pool.max_size() != size {
+                pool.resize(size);
+            }
+        }
+    }
+
     pub async fn report_pool_stats(&self) -> Vec<ConnectionPoolStatus> {
         async fn report<K>(
             map: &RwLock<HashMap<K, Arc<ConnectionPool>>>,
@@ -215,6 +276,55 @@ impl PoolManager {
     }
 }
 
+/// Splits the budget between the demands with max-min fairness: demands under the fair share
+/// are granted in full and what they leave is shared by the larger ones. Every demand gets at
+/// least min_size, even when that exceeds the budget, so no user is starved.
+fn fair_share_allocation(demands: &[usize], budget: usize, min_size: usize) -> Vec<usize> {
+    let demands: Vec<usize> = demands
+        .iter()
+        .map(|demand| (*demand).max(min_size))
+        .collect();
+    if demands.iter().sum::<usize>() <= budget {
+        return demands;
+    }
+
+    let mut order: Vec<usize> = (0..demands.len()).collect();
+    order.sort_by_key(|index| demands[*index]);
+
+    let mut allocation = vec![0; demands.len()];
+    let mut remaining_budget = budget;
+    for (position, index) in order.iter().enumerate() {
+        let fair_share = remaining_budget / (demands.len() - position);
+        let granted = demands[*index].min(fair_share).max(min_size);
+        allocation[*index] = granted;
+        remaining_budget = remaining_budget.saturating_sub(granted);
+    }
+
+    allocation
+}
+
+pub fn adjust_data_pool_sizes(service_context: ServiceContext) {
+    tokio::spawn(async move {
+        let mut adjust_interval = interval(Duration::from_secs(POSTGRES_POOL_ADJUST_INTERVAL_SEC));
+        loop {
+            adjust_interval.tick().await;
+
+            if !service_context
+                .dynamic_configuration()
+                .enable_adaptive_pool_sizing()
+                .await
+            {
+                continue;
+            }
+
+            service_context
+                .connection_pool_manager()
+                .adjust_data_pool_sizes()
+                .await;
+        }
+    });
+}
+
 pub fn clean_unused_pools(service_context: ServiceContext) {
     tokio::spawn(async move {
         let mut cleanup_interval =
@@ -235,3 +345,25 @@ pub fn clean_unused_pools(service_context: ServiceContext) {
         }
     });
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_fair_share_within_budget_grants_demands() {
+        assert_eq!(fair_share_allocation(&[4, 10, 1], 20, 2), vec![4, 10, 2]);
+    }
+
+    #[test]
+    fn test_fair_share_over_budget_is_max_min_fair() {
+        // The small demand is granted, the rest is split between the two large ones
+        assert_eq!(fair_share_allocation(&[2, 30, 40], 20, 2), vec![2, 9, 9]);
+        assert_eq!(fair_share_allocation(&[6, 12, 40], 30, 2), vec![6, 12, 12]);
+    }
+
+    #[test]
+    fn test_fair_share_keeps_minimum() {
+        assert_eq!(fair_share_allocation(&[10, 10, 10], 3, 2), vec![2, 2, 2]);
+    }
+}
@@ -23,6 +23,7 @@ pub struct QueryCatalog {
     // dynamic.rs
     pub pg_settings: String,
     pub pg_is_in_recovery: String,
+    pub pg_replication_lag: String,
 
     // version.rs
     pub extension_versions: String,
@@ -82,6 +83,7 @@ pub struct QueryCatalog {
     pub get_parameter: String,
     pub compact: String,
     pub kill_op: String,
+    pub slow_command_profile: String,
 
     // indexing.rs
     pub create_indexes_background: String,
@@ -145,6 +147,10 @@ impl QueryCatalog {
         &self.pg_is_in_recovery
     }
 
+    pub fn pg_replication_lag(&self) -> &str {
+        &self.pg_replication_lag
+    }
+
     // Topology getter
     pub fn extension_versions(&self) -> &str {
         &self.extension_versions
@@ -401,6 +407,10 @@ impl QueryCatalog {
         &self.kill_op
     }
 
+    pub fn slow_command_profile(&self) -> &str {
+        &self.slow_command_profile
+    }
+
     pub fn kill_cursors(&self) -> &str {
         &self.kill_cursors
     }
@@ -416,6 +426,7 @@ pub fn create_query_catalog() -> QueryCatalog {
             // dynamic.rs
             pg_settings: "SELECT name, setting FROM pg_settings WHERE name LIKE 'documentdb.%' OR name IN ('max_connections', 'default_transaction_read_only')".to_string(),
             pg_is_in_recovery: "SELECT pg_is_in_recovery()".to_string(),
+            pg_replication_lag: "SELECT CASE WHEN pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0 ELSE COALESCE(EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()), 0)::int4 END".to_string(),
 
             // explain/mod.rs
             explain: "EXPLAIN (FORMAT JSON, ANALYZE {analyze}, VERBOSE True, BUFFERS {analyze}, TIMING {analyze}) SELECT document FROM documentdb_api_catalog.bson_aggregation_{query_base}($1, $2)".to_string(),
@@ -479,6 +490,7 @@ pub fn create_query_catalog() -> QueryCatalog {
             get_parameter: "SELECT documentdb_api.get_parameter($1, $2, $3)".to_string(),
             compact: "SELECT documentdb_api.compact($1)".to_string(),
             kill_op: "SELECT documentdb_api.kill_op($1)".to_string(),
+            slow_command_profile: "SELECT documentdb_api.slow_command_profile($1)".to_string(),
 
             // indexing.rs
             create_indexes_background: "SELECT * FROM documentdb_api.create_indexes_background($1, $2)".to_string(),
@@ -46,6 +46,11 @@ impl Transaction {
         Arc::clone(&self.conn)
     }
 
+    /// Whether no statement or cursor currently holds the connection of the transaction.
+    pub fn is_connection_unused(&self) -> bool {
+        Arc::strong_count(&self.conn) == 1
+    }
+
     pub async fn commit(&mut self) -> Result<()> {
         self.conn.batch_execute("COMMIT").await?;
         self.committed = true;
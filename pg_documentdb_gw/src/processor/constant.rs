@@ -575,6 +575,14 @@ static SUPPORTED_COMMANDS : [CommandInfo; 57] = [
 		requires_auth: true,
 		secondary_override_ok: None,
 	},
+	CommandInfo {
+		command_name: "slowCommandProfile",
+		admin_only: false,
+		help: "Return the sampled slow commands of the database.",
+		secondary_ok: false,
+		requires_auth: true,
+		secondary_override_ok: None,
+	},
 	CommandInfo {
 		command_name: "startSession",
 		admin_only: false,
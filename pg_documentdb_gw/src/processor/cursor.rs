@@ -35,6 +35,7 @@ pub async fn save_cursor(
                 request_info.db()?,
                 request_info.collection()?,
                 request_info.session_id.map(|v| v.to_vec()),
+                None,
             )
             .await;
     }
@@ -130,6 +131,7 @@ pub async fn process_get_more(
         db,
         collection,
         session_id,
+        prefetch,
         ..
     } = connection_context
         .get_cursor(id, connection_context.auth_state.username()?)
@@ -139,19 +141,51 @@ pub async fn process_get_more(
             "Provided cursor was not found.".to_string(),
         ))?;
 
-    let results = pg_data_client
-        .execute_cursor_get_more(
-            request_context,
-            &db,
-            &cursor,
-            &cursor_connection,
-            connection_context,
-        )
-        .await?;
+    // A batch prefetched for a different batchSize is discarded, the continuation is unchanged
+    let batch_size = request
+        .document()
+        .get("batchSize")?
+        .and_then(|v| v.as_i64().or_else(|| v.as_i32().map(i64::from)));
+    let prefetched = match prefetch {
+        Some(prefetch) if prefetch.batch_size == batch_size => prefetch.take().await,
+        _ => None,
+    };
+
+    let results = match prefetched {
+        Some(rows) => rows,
+        None => {
+            pg_data_client
+                .execute_cursor_get_more(
+                    request_context,
+                    &db,
+                    &cursor,
+                    &cursor_connection,
+                    connection_context,
+                )
+                .await?
+        }
+    };
 
     if let Some(row) = results.first() {
         let continuation: Option<PgDocument> = row.try_get(1)?;
         if let Some(continuation) = continuation {
+            // Persisted cursors are bound to their connection and transactions to theirs,
+            // so only cursors that resume from the continuation alone are prefetched.
+            let prefetch = if cursor_connection.is_none()
+                && connection_context.transaction.is_none()
+                && connection_context
+                    .dynamic_configuration()
+                    .enable_cursor_prefetch()
+                    .await
+            {
+                pg_data_client
+                    .start_cursor_prefetch(request_context, &db, continuation.0, connection_context)
+                    .await
+                    .ok()
+            } else {
+                None
+            };
+
             connection_context
                 .add_cursor(
                     cursor_connection,
@@ -163,6 +197,7 @@ pub async fn process_get_more(
                     &db,
                     &collection,
                     session_id,
+                    prefetch,
                 )
                 .await;
         }
@@ -17,6 +17,7 @@ use crate::{
     error::{DocumentDBError, ErrorCode, Result},
     postgres::PgDataClient,
     processor::cursor,
+    protocol::reader::split_document_sequence,
     responses::{PgResponse, Response},
 };
 
@@ -56,8 +57,42 @@ pub async fn process_find(
 pub async fn process_insert(
     request_context: &mut RequestContext<'_>,
     connection_context: &ConnectionContext,
+    dynamic_config: &Arc<dyn DynamicConfiguration>,
     pg_data_client: &impl PgDataClient,
 ) -> Result<Response> {
+    // Unordered inserts outside of transactions can run their document sequence as pipelined
+    // sub batches: a failed sub batch doesn't stop the others, same as for the whole batch.
+    let pipeline_batch_size = dynamic_config.pipelined_insert_batch_size().await;
+    if pipeline_batch_size > 0
+        && connection_context.transaction.is_none()
+        && request_context.info.max_time_ms.is_none()
+        && !request_context
+            .payload
+            .document()
+            .get_bool("ordered")
+            .unwrap_or(true)
+    {
+        if let Some(extra) = request_context.payload.extra() {
+            let batches = split_document_sequence(extra, pipeline_batch_size)?;
+            if batches.len() > 1 {
+                let batch_rows = pg_data_client
+                    .execute_insert_pipelined(request_context, connection_context, &batches)
+                    .await?;
+
+                let responses = batch_rows
+                    .into_iter()
+                    .map(|(documents, rows)| (documents, rows.map(PgResponse::new)))
+                    .collect();
+                return PgResponse::transform_pipelined_write_results(
+                    responses,
+                    connection_context,
+                    request_context.activity_id,
+                )
+                .await;
+            }
+        }
+    }
+
     let insert_rows = pg_data_client
         .execute_insert(request_context, connection_context)
         .await?;
@@ -212,6 +247,16 @@ pub async fn process_db_stats(
         .await
 }
 
+pub async fn process_slow_command_profile(
+    request_context: &mut RequestContext<'_>,
+    connection_context: &ConnectionContext,
+    pg_data_client: &impl PgDataClient,
+) -> Result<Response> {
+    pg_data_client
+        .execute_slow_command_profile(request_context, connection_context)
+        .await
+}
+
 pub async fn process_current_op(
     request_context: &mut RequestContext<'_>,
     connection_context: &ConnectionContext,
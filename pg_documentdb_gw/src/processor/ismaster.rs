@@ -11,13 +11,15 @@ use std::{
     time::{SystemTime, UNIX_EPOCH},
 };
 
-use bson::rawdoc;
+use bson::{rawdoc, RawArrayBuf};
 
 use crate::{
     configuration::DynamicConfiguration,
     context::{ConnectionContext, RequestContext},
     error::{DocumentDBError, ErrorCode, Result},
-    protocol::{MAX_BSON_OBJECT_SIZE, MAX_MESSAGE_SIZE_BYTES, OK_SUCCEEDED},
+    protocol::{
+        compression::Compressor, MAX_BSON_OBJECT_SIZE, MAX_MESSAGE_SIZE_BYTES, OK_SUCCEEDED,
+    },
     responses::{RawResponse, Response},
 };
 
@@ -65,6 +67,25 @@ pub async fn process(
         "ok": OK_SUCCEEDED,
     };
 
+    // Reply with the compressors requested by the client that the gateway supports
+    if dynamic_configuration.enable_wire_compression().await {
+        if let Ok(requested) = request.document().get_array("compression") {
+            connection_context.compressors = requested
+                .into_iter()
+                .filter_map(|value| value.ok().and_then(|v| v.as_str()))
+                .filter_map(Compressor::from_name)
+                .collect();
+        }
+
+        if !connection_context.compressors.is_empty() {
+            let mut compression = RawArrayBuf::new();
+            for compressor in &connection_context.compressors {
+                compression.push(compressor.name());
+            }
+            response_doc.append("compression", compression);
+        }
+    }
+
     // Add the operationTime field if change streams GUC is enabled
     if dynamic_configuration.enable_change_streams().await {
         response_doc.append(
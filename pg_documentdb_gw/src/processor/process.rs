@@ -11,12 +11,15 @@ use std::{
     time::{Duration, Instant},
 };
 
+use bson::RawDocumentBuf;
 use deadpool_postgres::{HookError, PoolError};
 use tokio_postgres::error::SqlState;
 
 use crate::{
     configuration::DynamicConfiguration,
-    context::{ConnectionContext, RequestContext},
+    context::{
+        CommandClass, ConnectionContext, ReadCoalescer, ReadFlight, RequestContext, ServiceContext,
+    },
     error::{DocumentDBError, ErrorCode, Result},
     explain,
     postgres::PgDataClient,
@@ -24,10 +27,14 @@ use crate::{
         constant, cursor, data_description, data_management, indexing, ismaster, roles, session,
         transaction, users,
     },
-    requests::RequestType,
-    responses::Response,
+    requests::{read_concern::ReadConcern, RequestType},
+    responses::{RawResponse, Response},
 };
 
+/// Fields in which identical reads of different clients may differ without changing the result
+const READ_COALESCING_IGNORED_FIELDS: [&str; 4] =
+    ["lsid", "$clusterTime", "$readPreference", "comment"];
+
 enum Retry {
     Long,
     Short,
@@ -40,8 +47,75 @@ pub async fn process_request(
     pg_data_client: impl PgDataClient,
 ) -> Result<Response> {
     let dynamic_config = connection_context.dynamic_configuration();
+    let service_context = Arc::clone(&connection_context.service_context);
+
+    // Held until the request completes to count against the concurrency limit of the user
+    let _admission_permit = match CommandClass::of(request_context.payload.request_type()) {
+        Some(command_class) => Some(
+            service_context
+                .admission_controller()
+                .admit(
+                    connection_context.auth_state.username()?,
+                    command_class,
+                    &dynamic_config,
+                )
+                .await?,
+        ),
+        None => None,
+    };
+
+    if let Some(read_preference) = request_context.info.read_preference() {
+        read_preference.check_satisfiable(
+            !dynamic_config.is_postgres_writable().await,
+            dynamic_config.replication_lag_seconds().await,
+        )?;
+    }
 
     transaction::handle(request_context, connection_context, &pg_data_client).await?;
+
+    let mut read_key = None;
+    let mut enable_read_coalescing = false;
+    let mut result_cache_read = None;
+    if is_shareable_read(request_context, connection_context) {
+        enable_read_coalescing = dynamic_config.enable_read_coalescing().await;
+
+        // Reads of collections configured for result caching are served from the cache while
+        // fresh
+        let mut result_cache_namespace = None;
+        if let Some(namespace) = request_namespace(request_context) {
+            if dynamic_config.is_result_cache_collection(&namespace).await {
+                result_cache_namespace = Some(namespace);
+            }
+        }
+
+        if enable_read_coalescing || result_cache_namespace.is_some() {
+            read_key = Some(shareable_read_key(request_context, connection_context)?);
+        }
+
+        if let (Some(namespace), Some(key)) = (result_cache_namespace, &read_key) {
+            let ttl = Duration::from_millis(dynamic_config.result_cache_ttl_ms().await);
+            let result_cache = service_context.result_cache();
+            if let Some(response) = result_cache.get(&namespace, key, ttl) {
+                return Ok(Response::Raw(RawResponse(response)));
+            }
+            let generation = result_cache.generation(&namespace);
+            result_cache_read = Some((namespace, key.clone(), generation, ttl));
+        }
+    }
+
+    // Identical reads running at the same time share the query of the first one
+    let mut read_flight_leader = None;
+    if let Some(key) = read_key.filter(|_| enable_read_coalescing) {
+        match service_context.read_coalescer().join(key) {
+            ReadFlight::Leader(leader) => read_flight_leader = Some(leader),
+            ReadFlight::Follower(receiver) => {
+                if let Some(response) = ReadCoalescer::wait_for_leader(receiver).await {
+                    return Ok(Response::Raw(RawResponse(response)));
+                }
+            }
+        }
+    }
+
     let start_time = Instant::now();
 
     let mut retries = 0;
@@ -141,8 +215,14 @@ pub async fn process_request(
                 .await
             }
             RequestType::Explain => {
-                explain::process_explain(request_context, None, connection_context, &pg_data_client)
-                    .await
+                explain::process_explain(
+                    request_context,
+                    None,
+                    None,
+                    connection_context,
+                    &pg_data_client,
+                )
+                .await
             }
             RequestType::Find => {
                 data_management::process_find(request_context, connection_context, &pg_data_client)
@@ -176,6 +256,7 @@ pub async fn process_request(
                 data_management::process_insert(
                     request_context,
                     connection_context,
+                    &dynamic_config,
                     &pg_data_client,
                 )
                 .await
@@ -293,6 +374,14 @@ pub async fn process_request(
                 )
                 .await
             }
+            RequestType::SlowCommandProfile => {
+                data_management::process_slow_command_profile(
+                    request_context,
+                    connection_context,
+                    &pg_data_client,
+                )
+                .await
+            }
             RequestType::RenameCollection => {
                 data_description::process_rename_collection(
                     request_context,
@@ -419,6 +508,33 @@ pub async fn process_request(
         }
     };
 
+    let shared_response = if read_flight_leader.is_some() || result_cache_read.is_some() {
+        result.as_ref().ok().and_then(shareable_read_response)
+    } else {
+        None
+    };
+
+    if let Some((namespace, key, generation, ttl)) = result_cache_read {
+        if let Some(response) = &shared_response {
+            service_context.result_cache().store(
+                &namespace,
+                key,
+                generation,
+                response.clone(),
+                ttl,
+                dynamic_config
+                    .result_cache_max_entries_per_collection()
+                    .await,
+            );
+        }
+    }
+
+    if let Some(leader) = read_flight_leader {
+        leader.complete(shared_response);
+    }
+
+    invalidate_result_cache(request_context, &service_context, &dynamic_config).await;
+
     if connection_context.transaction.is_some() {
         match result {
             Err(DocumentDBError::UntypedDocumentDBError(112, _, _, _))
@@ -436,6 +552,90 @@ pub async fn process_request(
     result
 }
 
+/// Whether the response of the read can be shared with identical reads of other sessions:
+/// reads outside of transactions that don't need a snapshot or a quorum.
+fn is_shareable_read(
+    request_context: &RequestContext<'_>,
+    connection_context: &ConnectionContext,
+) -> bool {
+    matches!(
+        request_context.payload.request_type(),
+        RequestType::Find | RequestType::Count | RequestType::Distinct
+    ) && connection_context.transaction.is_none()
+        && request_context.info.transaction_info.is_none()
+        && request_context.payload.extra().is_none()
+        && matches!(
+            request_context.info.read_concern(),
+            ReadConcern::Unspecified | ReadConcern::Local | ReadConcern::Available
+        )
+}
+
+/// Returns the key identifying a shareable read across sessions.
+fn shareable_read_key(
+    request_context: &RequestContext<'_>,
+    connection_context: &ConnectionContext,
+) -> Result<Vec<u8>> {
+    // Reads are only shared between sessions of the same user, which have the same privileges
+    let mut key = RawDocumentBuf::new();
+    key.append("$user", connection_context.auth_state.username()?);
+    request_context.payload.extract_fields(|k, v| {
+        if !READ_COALESCING_IGNORED_FIELDS.contains(&k) {
+            key.append(k, v.to_raw_bson());
+        }
+        Ok(())
+    })?;
+
+    Ok(key.into_bytes())
+}
+
+/// Returns the namespace (db.collection) the request targets, if it targets one.
+fn request_namespace(request_context: &RequestContext<'_>) -> Option<String> {
+    let db = request_context.info.db().ok()?;
+    let collection = request_context.info.collection().ok()?;
+    Some(format!("{db}.{collection}"))
+}
+
+/// Drops the cached responses of the namespaces the request may have written to.
+async fn invalidate_result_cache(
+    request_context: &RequestContext<'_>,
+    service_context: &ServiceContext,
+    dynamic_config: &Arc<dyn DynamicConfiguration>,
+) {
+    match request_context.payload.request_type() {
+        RequestType::Insert
+        | RequestType::Update
+        | RequestType::Delete
+        | RequestType::FindAndModify
+        | RequestType::Drop
+        | RequestType::CollMod
+        | RequestType::RenameCollection => {
+            if let Some(namespace) = request_namespace(request_context) {
+                if dynamic_config.is_result_cache_collection(&namespace).await {
+                    service_context.result_cache().invalidate(&namespace);
+                }
+            }
+        }
+        RequestType::DropDatabase => {
+            if let Ok(db) = request_context.info.db() {
+                service_context.result_cache().invalidate_database(db);
+            }
+        }
+        _ => {}
+    }
+}
+
+/// Returns a copy of the response of a coalesced read for its followers, unless it opened a
+/// cursor, which belongs to the connection of the leader.
+fn shareable_read_response(response: &Response) -> Option<RawDocumentBuf> {
+    let document = response.as_raw_document().ok()?;
+    let cursor_id = document
+        .get_document("cursor")
+        .ok()
+        .and_then(|cursor| cursor.get_i64("id").ok())
+        .unwrap_or(0);
+    (cursor_id == 0).then(|| document.to_raw_document_buf())
+}
+
 async fn retry_policy(
     dynamic_config: &Arc<dyn DynamicConfiguration>,
     error: &tokio_postgres::Error,
@@ -0,0 +1,165 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/protocol/buffer_pool.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::cell::RefCell;
+
+use crate::telemetry::buffer_pool_metrics::{BufferPoolOutcome, BUFFER_POOL_METRICS};
+
+/// The smallest pooled buffer is 1 KiB, smaller requests are rounded up to it.
+const MIN_CLASS_SHIFT: u32 = 10;
+
+/// The largest pooled buffer is 1 MiB, larger messages are rare and allocated on demand
+/// so that an occasional 48 MB message does not stay pinned in the pool.
+const MAX_CLASS_SHIFT: u32 = 20;
+
+const CLASS_COUNT: usize = (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1) as usize;
+
+/// Buffers kept per size class, covers the requests in flight on a worker thread.
+const MAX_BUFFERS_PER_CLASS: usize = 8;
+
+/// Upper bound of the bytes retained by the pool of a worker thread.
+const MAX_POOLED_BYTES_PER_THREAD: usize = 8 * 1024 * 1024;
+
+/// Free buffers of a worker thread by power of two size class. A buffer is kept in the class
+/// of the largest power of two its capacity holds, so any buffer of a class fits its size.
+struct BufferPool {
+    classes: [Vec<Vec<u8>>; CLASS_COUNT],
+    pooled_bytes: usize,
+}
+
+impl BufferPool {
+    const fn new() -> Self {
+        const EMPTY: Vec<Vec<u8>> = Vec::new();
+        BufferPool {
+            classes: [EMPTY; CLASS_COUNT],
+            pooled_bytes: 0,
+        }
+    }
+
+    fn pop(&mut self, class: usize) -> Option<Vec<u8>> {
+        let buffer = self.classes[class].pop()?;
+        self.pooled_bytes -= buffer.capacity();
+        Some(buffer)
+    }
+
+    fn push(&mut self, class: usize, mut buffer: Vec<u8>) -> bool {
+        if self.classes[class].len() >= MAX_BUFFERS_PER_CLASS
+            || self.pooled_bytes + buffer.capacity() > MAX_POOLED_BYTES_PER_THREAD
+        {
+            return false;
+        }
+
+        buffer.clear();
+        self.pooled_bytes += buffer.capacity();
+        self.classes[class].push(buffer);
+        true
+    }
+}
+
+thread_local! {
+    // Connections are tasks moving between the worker threads, a pool per thread needs no locking.
+    static BUFFER_POOL: RefCell<BufferPool> = const { RefCell::new(BufferPool::new()) };
+}
+
+fn class_size(class: usize) -> usize {
+    1 << (class as u32 + MIN_CLASS_SHIFT)
+}
+
+/// The smallest class whose buffers can hold `size` bytes.
+fn class_for_size(size: usize) -> Option<usize> {
+    if size > class_size(CLASS_COUNT - 1) {
+        return None;
+    }
+
+    let shift = size.next_power_of_two().trailing_zeros().max(MIN_CLASS_SHIFT);
+    Some((shift - MIN_CLASS_SHIFT) as usize)
+}
+
+/// The largest class whose buffers a buffer of `capacity` bytes can stand in for.
+fn class_for_capacity(capacity: usize) -> Option<usize> {
+    if capacity < class_size(0) || capacity >= class_size(CLASS_COUNT - 1) * 2 {
+        return None;
+    }
+
+    let shift = usize::BITS - 1 - capacity.leading_zeros();
+    Some((shift - MIN_CLASS_SHIFT) as usize)
+}
+
+/// Returns an empty buffer with room for at least `capacity` bytes, reusing a pooled one if possible.
+pub fn take_with_capacity(capacity: usize) -> Vec<u8> {
+    let Some(class) = class_for_size(capacity) else {
+        BUFFER_POOL_METRICS.record(BufferPoolOutcome::Unpooled);
+        return Vec::with_capacity(capacity);
+    };
+
+    let pooled = BUFFER_POOL
+        .try_with(|pool| pool.borrow_mut().pop(class))
+        .ok()
+        .flatten();
+    match pooled {
+        Some(buffer) => {
+            BUFFER_POOL_METRICS.record(BufferPoolOutcome::Hit);
+            buffer
+        }
+        None => {
+            BUFFER_POOL_METRICS.record(BufferPoolOutcome::Miss);
+            Vec::with_capacity(class_size(class))
+        }
+    }
+}
+
+/// Returns a buffer of `len` zeroed bytes, reusing a pooled one if possible.
+pub fn take_zeroed(len: usize) -> Vec<u8> {
+    let mut buffer = take_with_capacity(len);
+    buffer.resize(len, 0);
+    buffer
+}
+
+/// Hands a buffer back to the pool of the current thread, it is freed if it is outside the
+/// pooled sizes or the pool is full.
+pub fn give_back(buffer: Vec<u8>) {
+    let Some(class) = class_for_capacity(buffer.capacity()) else {
+        return;
+    };
+
+    let pooled = BUFFER_POOL
+        .try_with(|pool| pool.borrow_mut().push(class, buffer))
+        .unwrap_or(false);
+    if !pooled {
+        BUFFER_POOL_METRICS.record(BufferPoolOutcome::Discarded);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buffers_are_reused_by_size_class() {
+        let buffer = take_zeroed(3000);
+        assert_eq!(buffer.len(), 3000);
+        assert!(buffer.capacity() >= 4096);
+        let address = buffer.as_ptr();
+        give_back(buffer);
+
+        let reused = take_with_capacity(4000);
+        assert_eq!(reused.as_ptr(), address);
+        assert!(reused.is_empty());
+    }
+
+    #[test]
+    fn test_size_classes() {
+        assert_eq!(class_for_size(1), Some(0));
+        assert_eq!(class_for_size(1025), Some(1));
+        assert_eq!(class_for_capacity(1025), Some(0));
+        assert_eq!(class_for_size(1024 * 1024), Some(CLASS_COUNT - 1));
+        assert_eq!(class_for_size(1024 * 1024 + 1), None);
+        assert_eq!(class_for_capacity(48_000_000), None);
+        assert_eq!(class_for_capacity(512), None);
+    }
+}
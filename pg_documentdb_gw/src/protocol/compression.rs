@@ -0,0 +1,325 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/protocol/compression.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{
+    cell::RefCell,
+    io::Cursor,
+    sync::atomic::{AtomicU64, Ordering},
+    time::Instant,
+};
+
+use miniz_oxide::{
+    deflate::core::{
+        compress_to_output, create_comp_flags_from_zip_params, CompressorOxide, TDEFLFlush,
+        TDEFLStatus,
+    },
+    inflate::{
+        core::{decompress, inflate_flags, DecompressorOxide},
+        TINFLStatus,
+    },
+};
+
+use crate::{
+    error::{DocumentDBError, Result},
+    protocol::{opcode::OpCode, util::SyncLittleEndianRead, MAX_MESSAGE_SIZE_BYTES},
+};
+
+/// Size of the OP_COMPRESSED prefix: originalOpcode (i32), uncompressedSize (i32), compressorId (u8)
+pub const COMPRESSED_PREFIX_LENGTH: usize =
+    2 * std::mem::size_of::<i32>() + std::mem::size_of::<u8>();
+
+/// zlib compression level used for responses (favors latency over ratio)
+const ZLIB_COMPRESSION_LEVEL: i32 = 1;
+
+/// zlib window bits - a positive value requests the zlib header and adler32 trailer
+const ZLIB_WINDOW_BITS: i32 = 15;
+
+/// Compressors as defined by the wire protocol compressor ids.
+///
+/// Only the compressors the gateway can encode and decode are negotiated, drivers fall back
+/// to the next compressor in their list (or no compression) for the rest.
+#[derive(Copy, Clone, Debug, Eq, PartialEq)]
+pub enum Compressor {
+    Noop = 0,
+    Zlib = 2,
+}
+
+impl Compressor {
+    /// Compressors advertised in the hello response, in order of preference.
+    pub const NEGOTIABLE: [Compressor; 1] = [Compressor::Zlib];
+
+    pub fn from_id(id: u8) -> Result<Self> {
+        match id {
+            0 => Ok(Compressor::Noop),
+            2 => Ok(Compressor::Zlib),
+            _ => Err(DocumentDBError::bad_value(format!(
+                "Unsupported compressor id: {id}"
+            ))),
+        }
+    }
+
+    pub fn from_name(name: &str) -> Option<Self> {
+        Self::NEGOTIABLE
+            .into_iter()
+            .find(|compressor| compressor.name() == name)
+    }
+
+    pub fn name(&self) -> &'static str {
+        match self {
+            Compressor::Noop => "noop",
+            Compressor::Zlib => "zlib",
+        }
+    }
+}
+
+/// Cumulative counters for a compressor in one direction.
+#[derive(Debug, Default)]
+pub struct CompressionCounters {
+    pub operations: AtomicU64,
+    pub bytes_in: AtomicU64,
+    pub bytes_out: AtomicU64,
+    pub elapsed_nanos: AtomicU64,
+}
+
+impl CompressionCounters {
+    const fn new() -> Self {
+        CompressionCounters {
+            operations: AtomicU64::new(0),
+            bytes_in: AtomicU64::new(0),
+            bytes_out: AtomicU64::new(0),
+            elapsed_nanos: AtomicU64::new(0),
+        }
+    }
+
+    fn record(&self, bytes_in: usize, bytes_out: usize, start: Instant) {
+        self.operations.fetch_add(1, Ordering::Relaxed);
+        self.bytes_in.fetch_add(bytes_in as u64, Ordering::Relaxed);
+        self.bytes_out
+            .fetch_add(bytes_out as u64, Ordering::Relaxed);
+        self.elapsed_nanos
+            .fetch_add(start.elapsed().as_nanos() as u64, Ordering::Relaxed);
+    }
+}
+
+static ZLIB_COMPRESS_COUNTERS: CompressionCounters = CompressionCounters::new();
+static ZLIB_DECOMPRESS_COUNTERS: CompressionCounters = CompressionCounters::new();
+static NOOP_COUNTERS: CompressionCounters = CompressionCounters::new();
+
+/// Returns the (compress, decompress) counters for the compressor.
+pub fn compression_counters(
+    compressor: Compressor,
+) -> (&'static CompressionCounters, &'static CompressionCounters) {
+    match compressor {
+        Compressor::Noop => (&NOOP_COUNTERS, &NOOP_COUNTERS),
+        Compressor::Zlib => (&ZLIB_COMPRESS_COUNTERS, &ZLIB_DECOMPRESS_COUNTERS),
+    }
+}
+
+thread_local! {
+    // The deflate state is large, keep one per worker thread rather than one per response.
+    static ZLIB_COMPRESSOR: RefCell<Option<Box<CompressorOxide>>> = const { RefCell::new(None) };
+}
+
+/// The prefix of an OP_COMPRESSED message following the standard header.
+#[derive(Debug)]
+pub struct CompressedPrefix {
+    pub original_op_code: OpCode,
+    pub uncompressed_size: usize,
+    pub compressor: Compressor,
+}
+
+impl CompressedPrefix {
+    pub fn read(message: &[u8]) -> Result<Self> {
+        let mut reader = Cursor::new(message);
+        let original_op_code = OpCode::from_value(reader.read_i32_sync()?);
+        let uncompressed_size = reader.read_i32_sync()?;
+        let compressor = Compressor::from_id(reader.read_u8_sync()?)?;
+
+        if original_op_code == OpCode::Compressed || original_op_code == OpCode::INVALID {
+            return Err(DocumentDBError::bad_value(format!(
+                "Invalid original opcode in compressed message: {original_op_code:?}"
+            )));
+        }
+
+        if uncompressed_size < 0 || uncompressed_size > MAX_MESSAGE_SIZE_BYTES {
+            return Err(DocumentDBError::bad_value(format!(
+                "Invalid uncompressed size in compressed message: {uncompressed_size}"
+            )));
+        }
+
+        Ok(CompressedPrefix {
+            original_op_code,
+            uncompressed_size: uncompressed_size as usize,
+            compressor,
+        })
+    }
+}
+
+/// Decompresses `compressed` into `output`, which is sized to exactly the uncompressed size
+/// advertised by the client so that the parsed message can borrow from it directly.
+pub fn decompress_into(
+    compressor: Compressor,
+    compressed: &[u8],
+    uncompressed_size: usize,
+    output: &mut Vec<u8>,
+) -> Result<()> {
+    let start = Instant::now();
+    output.clear();
+    match compressor {
+        Compressor::Noop => {
+            if compressed.len() != uncompressed_size {
+                return Err(DocumentDBError::bad_value(
+                    "Uncompressed size did not match the message size".to_string(),
+                ));
+            }
+
+            output.extend_from_slice(compressed);
+        }
+        Compressor::Zlib => {
+            output.resize(uncompressed_size, 0);
+            let mut decompressor = Box::<DecompressorOxide>::default();
+            let (status, _, bytes_written) = decompress(
+                &mut decompressor,
+                compressed,
+                output.as_mut_slice(),
+                0,
+                inflate_flags::TINFL_FLAG_PARSE_ZLIB_HEADER
+                    | inflate_flags::TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF,
+            );
+
+            if status != TINFLStatus::Done || bytes_written != uncompressed_size {
+                return Err(DocumentDBError::bad_value(format!(
+                    "Failed to decompress zlib message: {status:?}"
+                )));
+            }
+        }
+    }
+
+    compression_counters(compressor)
+        .1
+        .record(compressed.len(), uncompressed_size, start);
+    Ok(())
+}
+
+/// Compresses the concatenation of `parts` into `output` without first assembling the
+/// uncompressed message.
+pub fn compress_parts_into(
+    compressor: Compressor,
+    parts: &[&[u8]],
+    output: &mut Vec<u8>,
+) -> Result<()> {
+    let start = Instant::now();
+    let bytes_in: usize = parts.iter().map(|part| part.len()).sum();
+    output.clear();
+
+    match compressor {
+        Compressor::Noop => {
+            output.reserve(bytes_in);
+            for part in parts {
+                output.extend_from_slice(part);
+            }
+        }
+        Compressor::Zlib => ZLIB_COMPRESSOR.with(|cell| -> Result<()> {
+            let mut cached = cell.borrow_mut();
+            let deflate = cached.get_or_insert_with(|| {
+                Box::new(CompressorOxide::new(create_comp_flags_from_zip_params(
+                    ZLIB_COMPRESSION_LEVEL,
+                    ZLIB_WINDOW_BITS,
+                    0,
+                )))
+            });
+            deflate.reset();
+
+            for (index, part) in parts.iter().enumerate() {
+                let flush = if index + 1 == parts.len() {
+                    TDEFLFlush::Finish
+                } else {
+                    TDEFLFlush::None
+                };
+
+                let (status, _) = compress_to_output(deflate, part, flush, |chunk| {
+                    output.extend_from_slice(chunk);
+                    true
+                });
+
+                let expected = if flush == TDEFLFlush::Finish {
+                    TDEFLStatus::Done
+                } else {
+                    TDEFLStatus::Okay
+                };
+
+                if status != expected {
+                    return Err(DocumentDBError::internal_error(format!(
+                        "Failed to compress zlib response: {status:?}"
+                    )));
+                }
+            }
+
+            Ok(())
+        })?,
+    }
+
+    compression_counters(compressor)
+        .0
+        .record(bytes_in, output.len(), start);
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_zlib_round_trip_multiple_parts() {
+        let flags = 0u32.to_le_bytes();
+        let payload: Vec<u8> = (0..64 * 1024).map(|i| (i % 251) as u8).collect();
+        let parts: [&[u8]; 3] = [&flags, &[0u8], &payload];
+
+        let mut compressed = Vec::new();
+        compress_parts_into(Compressor::Zlib, &parts, &mut compressed).unwrap();
+        assert!(compressed.len() < payload.len());
+
+        let uncompressed_size = flags.len() + 1 + payload.len();
+        let mut decompressed = Vec::new();
+        decompress_into(
+            Compressor::Zlib,
+            &compressed,
+            uncompressed_size,
+            &mut decompressed,
+        )
+        .unwrap();
+
+        assert_eq!(&decompressed[..4], &flags);
+        assert_eq!(decompressed[4], 0);
+        assert_eq!(&decompressed[5..], payload.as_slice());
+    }
+
+    #[test]
+    fn test_zlib_size_mismatch_fails() {
+        let payload = b"hello compressed world";
+        let mut compressed = Vec::new();
+        compress_parts_into(Compressor::Zlib, &[payload], &mut compressed).unwrap();
+
+        let mut decompressed = Vec::new();
+        assert!(decompress_into(
+            Compressor::Zlib,
+            &compressed,
+            payload.len() + 1,
+            &mut decompressed
+        )
+        .is_err());
+    }
+
+    #[test]
+    fn test_negotiable_compressors() {
+        assert_eq!(Compressor::from_name("zlib"), Some(Compressor::Zlib));
+        assert_eq!(Compressor::from_name("snappy"), None);
+        assert_eq!(Compressor::from_name("noop"), None);
+        assert!(Compressor::from_id(3).is_err());
+    }
+}
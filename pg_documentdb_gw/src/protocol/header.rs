@@ -26,6 +26,16 @@ impl Header {
     /// Size of the header in bytes (always 16 bytes)
     pub const LENGTH: usize = 4 * std::mem::size_of::<i32>();
 
+    /// Returns the header in wire format (little-endian), for writing it along with the body.
+    pub fn to_bytes(&self) -> [u8; Header::LENGTH] {
+        let mut bytes = [0u8; Header::LENGTH];
+        bytes[0..4].copy_from_slice(&self.length.to_le_bytes());
+        bytes[4..8].copy_from_slice(&self.request_id.to_le_bytes());
+        bytes[8..12].copy_from_slice(&self.response_to.to_le_bytes());
+        bytes[12..16].copy_from_slice(&(self.op_code as i32).to_le_bytes());
+        bytes
+    }
+
     /// Writes the header to the provided stream in wire format.
     ///
     /// The header is written in little-endian byte order as required by the wire protocol.
@@ -8,6 +8,8 @@
 
 use crate::error::{DocumentDBError, Result};
 
+pub mod buffer_pool;
+pub mod compression;
 pub mod header;
 pub mod message;
 pub mod opcode;
@@ -8,6 +8,7 @@
 
 use std::{
     io::{Cursor, ErrorKind},
+    ops::Range,
     str::FromStr,
 };
 
@@ -16,7 +17,12 @@ use tokio::io::AsyncReadExt;
 
 use crate::{
     error::{DocumentDBError, Result},
-    protocol::{extract_database_and_collection_names, opcode::OpCode},
+    protocol::{
+        buffer_pool,
+        compression::{self, CompressedPrefix, COMPRESSED_PREFIX_LENGTH},
+        extract_database_and_collection_names,
+        opcode::OpCode,
+    },
     requests::{Request, RequestMessage, RequestType},
     GwStream,
 };
@@ -44,22 +50,58 @@ pub async fn read_header(stream: &mut GwStream) -> Result<Option<Header>> {
     }
 }
 
-/// Given an already read header, read the remaining message bytes into a RequestMessage
+/// Given an already read header, read the remaining message bytes into a RequestMessage.
+/// The message buffer is taken from the buffer pool and returned to it when the message is dropped.
 pub async fn read_request(header: &Header, stream: &mut GwStream) -> Result<RequestMessage> {
     let message_size = usize::try_from(header.length).map_err(|_| {
         DocumentDBError::bad_value("Message length could not be converted to a usize".to_string())
     })?;
 
     // 16 bytes of the message were already used by the headers
-    let mut message: Vec<u8> = vec![0; message_size - Header::LENGTH];
+    let mut message = buffer_pool::take_zeroed(message_size - Header::LENGTH);
 
     stream.read_exact(&mut message).await?;
 
+    if header.op_code == OpCode::Compressed {
+        let request = decompress_request(header, &message);
+        buffer_pool::give_back(message);
+        return request;
+    }
+
     Ok(RequestMessage {
         request: message,
         op_code: header.op_code,
         request_id: header.request_id,
         response_to: header.response_to,
+        compressor: None,
+    })
+}
+
+/// Unwraps an OP_COMPRESSED message into the original message.
+/// The body is decompressed into a buffer of exactly the uncompressed size which the parsed
+/// request then borrows from, so there is no further copy of the message.
+fn decompress_request(header: &Header, message: &[u8]) -> Result<RequestMessage> {
+    if message.len() < COMPRESSED_PREFIX_LENGTH {
+        return Err(DocumentDBError::bad_value(
+            "Compressed message is shorter than the compression header".to_string(),
+        ));
+    }
+
+    let prefix = CompressedPrefix::read(message)?;
+    let mut request = buffer_pool::take_with_capacity(prefix.uncompressed_size);
+    compression::decompress_into(
+        prefix.compressor,
+        &message[COMPRESSED_PREFIX_LENGTH..],
+        prefix.uncompressed_size,
+        &mut request,
+    )?;
+
+    Ok(RequestMessage {
+        request,
+        op_code: prefix.original_op_code,
+        request_id: header.request_id,
+        response_to: header.response_to,
+        compressor: Some(prefix.compressor),
     })
 }
 
@@ -236,3 +278,78 @@ fn read_documents(bytes: &'_ [u8]) -> Result<RawArrayBuf> {
     }
     Ok(result)
 }
+
+/// Splits a document sequence into sub sequences of at most batch_size documents, each with the
+/// indexes of its documents in the sequence.
+pub fn split_document_sequence(
+    bytes: &[u8],
+    batch_size: usize,
+) -> Result<Vec<(Range<usize>, &[u8])>> {
+    let mut batches = Vec::new();
+    let mut batch_start = 0;
+    let mut batch_first_index = 0;
+    let mut document_count = 0;
+    let mut pos = 0;
+    while pos < bytes.len() {
+        if bytes.len() - pos < 4 {
+            return Err(DocumentDBError::bad_value(
+                "Invalid document sequence.".to_string(),
+            ));
+        }
+
+        let doc_size = i32::from_le_bytes(
+            bytes[pos..pos + 4]
+                .try_into()
+                .expect("Slice of wrong length"),
+        );
+        if doc_size < 5 || doc_size as usize > bytes.len() - pos {
+            return Err(DocumentDBError::bad_value(
+                "Invalid document sequence.".to_string(),
+            ));
+        }
+
+        pos += doc_size as usize;
+        document_count += 1;
+        if document_count - batch_first_index == batch_size.max(1) {
+            batches.push((batch_first_index..document_count, &bytes[batch_start..pos]));
+            batch_start = pos;
+            batch_first_index = document_count;
+        }
+    }
+
+    if batch_start < bytes.len() {
+        batches.push((batch_first_index..document_count, &bytes[batch_start..]));
+    }
+
+    Ok(batches)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_split_document_sequence() {
+        let mut sequence = Vec::new();
+        for i in 0..5 {
+            sequence.extend_from_slice(rawdoc! { "_id": i }.as_bytes());
+        }
+
+        let batches = split_document_sequence(&sequence, 2).unwrap();
+        let documents: Vec<Range<usize>> = batches
+            .iter()
+            .map(|(documents, _)| documents.clone())
+            .collect();
+        assert_eq!(documents, vec![0..2, 2..4, 4..5]);
+
+        let total: usize = batches.iter().map(|(_, batch)| batch.len()).sum();
+        assert_eq!(total, sequence.len());
+        assert_eq!(read_documents(batches[2].1).unwrap().into_iter().count(), 1);
+    }
+
+    #[test]
+    fn test_split_document_sequence_rejects_truncated() {
+        let sequence = rawdoc! { "_id": 1 }.as_bytes().to_vec();
+        assert!(split_document_sequence(&sequence[..sequence.len() - 1], 2).is_err());
+    }
+}
@@ -24,7 +24,7 @@ use crate::{
     bson::convert_to_f64,
     context::RequestTransactionInfo,
     error::{DocumentDBError, ErrorCode, Result},
-    protocol::opcode::OpCode,
+    protocol::{buffer_pool, compression::Compressor, header::Header, opcode::OpCode},
 };
 
 pub use request_tracker::RequestIntervalKind;
@@ -36,6 +36,28 @@ pub struct RequestMessage {
     pub op_code: OpCode,
     pub request_id: i32,
     pub response_to: i32,
+
+    /// The compressor of the request if it was sent as OP_COMPRESSED.
+    /// Responses to compressed requests are compressed with the same compressor.
+    pub compressor: Option<Compressor>,
+}
+
+impl RequestMessage {
+    /// The header of the uncompressed message, responses are formatted based on it.
+    pub fn effective_header(&self) -> Header {
+        Header {
+            length: (self.request.len() + Header::LENGTH) as i32,
+            request_id: self.request_id,
+            response_to: self.response_to,
+            op_code: self.op_code,
+        }
+    }
+}
+
+impl Drop for RequestMessage {
+    fn drop(&mut self) {
+        buffer_pool::give_back(std::mem::take(&mut self.request));
+    }
 }
 
 #[derive(Debug)]
@@ -52,6 +74,7 @@ pub struct RequestInfo<'a> {
     collection: Option<&'a str>,
     pub session_id: Option<&'a [u8]>,
     read_concern: ReadConcern,
+    read_preference: Option<ReadPreference>,
 }
 
 impl RequestInfo<'_> {
@@ -63,6 +86,7 @@ impl RequestInfo<'_> {
             collection: None,
             session_id: None,
             read_concern: ReadConcern::default(),
+            read_preference: None,
         }
     }
 
@@ -82,9 +106,13 @@ impl RequestInfo<'_> {
     pub fn read_concern(&self) -> &ReadConcern {
         &self.read_concern
     }
+
+    pub fn read_preference(&self) -> Option<&ReadPreference> {
+        self.read_preference.as_ref()
+    }
 }
 
-#[derive(PartialEq, Debug)]
+#[derive(PartialEq, Eq, Hash, Clone, Copy, Debug)]
 pub enum RequestType {
     AbortTransaction,
     Aggregate,
@@ -139,6 +167,7 @@ pub enum RequestType {
     SaslContinue,
     SaslStart,
     ShardCollection,
+    SlowCommandProfile,
     UnshardCollection,
     Update,
     UpdateRole,
@@ -227,6 +256,7 @@ impl FromStr for RequestType {
             "saslContinue" => Ok(RequestType::SaslContinue),
             "saslStart" => Ok(RequestType::SaslStart),
             "shardCollection" => Ok(RequestType::ShardCollection),
+            "slowCommandProfile" => Ok(RequestType::SlowCommandProfile),
             "unshardCollection" => Ok(RequestType::UnshardCollection),
             "update" => Ok(RequestType::Update),
             "updateRole" => Ok(RequestType::UpdateRole),
@@ -349,6 +379,7 @@ impl<'a> Request<'a> {
         let mut isolation_level = None;
         let mut collection = None;
         let mut read_concern = ReadConcern::default();
+        let mut read_preference = None;
 
         let collection_field = self.collection_field();
         for entry in self.document() {
@@ -406,7 +437,9 @@ impl<'a> Request<'a> {
                         isolation_level = Some(IsolationLevel::RepeatableRead)
                     }
                 }
-                "$readPreference" => ReadPreference::parse(v.as_document())?,
+                "$readPreference" => {
+                    read_preference = Some(ReadPreference::parse(v.as_document())?)
+                }
                 key if collection_field.contains(&key) => {
                     // Aggregate needs special handling because having '1' as a collection is valid
                     collection = if collection_field[0] == "aggregate" {
@@ -443,6 +476,7 @@ impl<'a> Request<'a> {
             transaction_info,
             db,
             read_concern,
+            read_preference,
         })
     }
 
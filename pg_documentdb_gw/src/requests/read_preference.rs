@@ -10,9 +10,12 @@ use crate::error::{DocumentDBError, ErrorCode, Result};
 use bson::RawDocument;
 use std::str::FromStr;
 
-pub struct ReadPreference {}
+pub struct ReadPreference {
+    pub mode: ReadPreferenceMode,
+    pub max_staleness_seconds: Option<i32>,
+}
 
-#[derive(PartialEq)]
+#[derive(PartialEq, Debug, Clone, Copy)]
 pub enum ReadPreferenceMode {
     Primary,
     Secondary,
@@ -40,7 +43,7 @@ impl FromStr for ReadPreferenceMode {
 }
 
 impl ReadPreference {
-    pub fn parse(raw_document: Option<&RawDocument>) -> Result<()> {
+    pub fn parse(raw_document: Option<&RawDocument>) -> Result<ReadPreference> {
         match raw_document {
             None => Err(DocumentDBError::documentdb_error(
                 ErrorCode::FailedToParse,
@@ -162,13 +165,6 @@ impl ReadPreference {
                     }
                 }
 
-                if read_preference_mode == ReadPreferenceMode::Secondary {
-                    return Err(DocumentDBError::documentdb_error(
-                        ErrorCode::FailedToSatisfyReadPreference,
-                        "no server available for query with ReadPreference secondary".to_string(),
-                    ));
-                }
-
                 if hedge == Some(true) {
                     return Err(DocumentDBError::documentdb_error(
                         ErrorCode::BadValue,
@@ -176,8 +172,74 @@ impl ReadPreference {
                     ));
                 }
 
-                Ok(())
+                Ok(ReadPreference {
+                    mode: read_preference_mode,
+                    max_staleness_seconds,
+                })
+            }
+        }
+    }
+
+    /// Checks that the server the gateway runs against can serve the read preference. A hot
+    /// standby serves the secondary modes as long as its replay lag is within
+    /// maxStalenessSeconds, a primary can't serve mode 'secondary'.
+    pub fn check_satisfiable(&self, in_recovery: bool, replication_lag_seconds: i32) -> Result<()> {
+        if !in_recovery {
+            if self.mode == ReadPreferenceMode::Secondary {
+                return Err(DocumentDBError::documentdb_error(
+                    ErrorCode::FailedToSatisfyReadPreference,
+                    "no server available for query with ReadPreference secondary".to_string(),
+                ));
             }
+
+            return Ok(());
         }
+
+        match self.max_staleness_seconds {
+            Some(max_staleness_seconds) if replication_lag_seconds > max_staleness_seconds => {
+                Err(DocumentDBError::documentdb_error(
+                    ErrorCode::FailedToSatisfyReadPreference,
+                    format!(
+                        "no server available for query with maxStalenessSeconds {max_staleness_seconds}, the replica is {replication_lag_seconds} seconds behind"
+                    ),
+                ))
+            }
+            _ => Ok(()),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn read_preference(
+        mode: ReadPreferenceMode,
+        max_staleness_seconds: Option<i32>,
+    ) -> ReadPreference {
+        ReadPreference {
+            mode,
+            max_staleness_seconds,
+        }
+    }
+
+    #[test]
+    fn test_secondary_requires_replica() {
+        let secondary = read_preference(ReadPreferenceMode::Secondary, None);
+        assert!(secondary.check_satisfiable(false, 0).is_err());
+        assert!(secondary.check_satisfiable(true, 0).is_ok());
+
+        let secondary_preferred = read_preference(ReadPreferenceMode::SecondaryPreferred, None);
+        assert!(secondary_preferred.check_satisfiable(false, 0).is_ok());
+    }
+
+    #[test]
+    fn test_max_staleness_on_replica() {
+        let nearest = read_preference(ReadPreferenceMode::Nearest, Some(90));
+        assert!(nearest.check_satisfiable(true, 90).is_ok());
+        assert!(nearest.check_satisfiable(true, 91).is_err());
+
+        // A primary is never stale
+        assert!(nearest.check_satisfiable(false, 120).is_ok());
     }
 }
@@ -8,7 +8,7 @@
 
 use tokio::time::Instant;
 
-#[derive(Debug)]
+#[derive(Debug, Clone, Copy)]
 pub enum RequestIntervalKind {
     /// Interval kind for reading stream from request body. BufferRead + HandleRequest is the full duration of a request spent in the Gateway.
     BufferRead,
@@ -34,6 +34,9 @@ pub enum RequestIntervalKind {
     /// Time spent committing a Postgres transaction.
     PostgresTransactionCommit,
 
+    /// Time spent writing the response back to the client.
+    WriteResponse,
+
     /// Special value used to define the size of the metrics array.
     MaxUnused,
 }
@@ -6,7 +6,9 @@
  *-------------------------------------------------------------------------
  */
 
-use bson::{Bson, Document, RawDocument, RawDocumentBuf};
+use std::ops::Range;
+
+use bson::{doc, Bson, Document, RawDocument, RawDocumentBuf};
 
 use documentdb_macros::documentdb_int_error_mapping;
 use tokio_postgres::{error::SqlState, Row};
@@ -15,10 +17,11 @@ use crate::{
     context::{ConnectionContext, Cursor},
     error::{DocumentDBError, ErrorCode, Result},
     postgres::PgDocument,
+    protocol::OK_SUCCEEDED,
     responses::constant::{duplicate_key_violation_message, pg_returned_invalid_response_message},
 };
 
-use super::{raw::RawResponse, Response};
+use super::{error::CommandError, raw::RawResponse, Response};
 
 /// Response from PG. This holds ownership of the response from the backend
 #[derive(Debug)]
@@ -98,6 +101,93 @@ impl PgResponse {
         Ok(Response::Pg(self))
     }
 
+    /// Merges the write results of the sub batches of a pipelined write (each with the indexes of
+    /// its documents) into the write result of the whole batch: counts are summed and the write
+    /// errors are concatenated with their index relative to the whole batch.
+    ///
+    /// The sub batches commit on their own, so a sub batch that failed as a whole is reported as
+    /// a write error for each of its documents rather than failing the command, which would hide
+    /// the documents the other sub batches inserted.
+    pub async fn transform_pipelined_write_results(
+        responses: Vec<(Range<usize>, Result<PgResponse>)>,
+        connection_context: &ConnectionContext,
+        activity_id: &str,
+    ) -> Result<Response> {
+        let mut merged: Option<Document> = None;
+        let mut count: i64 = 0;
+        let mut write_errors = Vec::new();
+        for (documents, response) in responses {
+            let response = match response {
+                Ok(response) => response,
+                Err(e) => {
+                    let error = CommandError::from_error(connection_context, &e, activity_id).await;
+                    for index in documents {
+                        write_errors.push(Bson::Document(doc! {
+                            "index": index as i32,
+                            "code": error.code,
+                            "errmsg": error.message.clone(),
+                        }));
+                    }
+                    continue;
+                }
+            };
+
+            let result = Document::try_from(response.as_raw_document()?)?;
+            count += match result.get("n") {
+                Some(Bson::Int32(n)) => i64::from(*n),
+                Some(Bson::Int64(n)) => *n,
+                _ => 0,
+            };
+
+            if let Ok(errors) = result.get_array("writeErrors") {
+                for error in errors {
+                    let mut error = error.clone();
+                    let mut index = documents.start as i64;
+                    if let Some(error_document) = error.as_document_mut() {
+                        index += match error_document.get("index") {
+                            Some(Bson::Int32(index)) => i64::from(*index),
+                            Some(Bson::Int64(index)) => *index,
+                            _ => 0,
+                        };
+                        error_document.insert("index", index as i32);
+                    }
+
+                    // Errors that fail a whole command only fail the document of this sub batch
+                    if let Err(e) = response
+                        .transform_error(connection_context, &mut error, activity_id)
+                        .await
+                    {
+                        let command_error =
+                            CommandError::from_error(connection_context, &e, activity_id).await;
+                        error = Bson::Document(doc! {
+                            "index": index as i32,
+                            "code": command_error.code,
+                            "errmsg": command_error.message,
+                        });
+                    }
+
+                    write_errors.push(error);
+                }
+            }
+
+            if merged.is_none() {
+                merged = Some(result);
+            }
+        }
+
+        let mut merged = merged.unwrap_or_else(|| doc! { "ok": OK_SUCCEEDED });
+        merged.insert("n", count as i32);
+        if write_errors.is_empty() {
+            merged.remove("writeErrors");
+        } else {
+            merged.insert("writeErrors", write_errors);
+        }
+
+        Ok(Response::Raw(RawResponse(RawDocumentBuf::from_document(
+            &merged,
+        )?)))
+    }
+
     async fn transform_error(
         &self,
         context: &ConnectionContext,
@@ -9,16 +9,27 @@
 use crate::{
     context::ConnectionContext,
     error::{DocumentDBError, Result},
-    protocol::{header::Header, opcode::OpCode},
+    protocol::{
+        buffer_pool,
+        compression::{self, Compressor, COMPRESSED_PREFIX_LENGTH},
+        header::Header,
+        opcode::OpCode,
+    },
     responses::constant::bson_serialize_error_message,
     CommandError, GwStream, Response,
 };
 use bson::{to_raw_document_buf, RawDocument};
+use std::io::{self, IoSlice};
 use tokio::io::AsyncWriteExt;
 
 /// Write a server response to the client stream
-pub async fn write(header: &Header, response: &Response, stream: &mut GwStream) -> Result<()> {
-    write_and_flush(header, response.as_raw_document()?, stream).await
+pub async fn write(
+    header: &Header,
+    response: &Response,
+    compressor: Option<Compressor>,
+    stream: &mut GwStream,
+) -> Result<()> {
+    write_and_flush_with_compressor(header, response.as_raw_document()?, compressor, stream).await
 }
 
 /// Write a raw BSON object to the client stream
@@ -26,13 +37,31 @@ pub async fn write_and_flush(
     header: &Header,
     response: &RawDocument,
     stream: &mut GwStream,
+) -> Result<()> {
+    write_and_flush_with_compressor(header, response, None, stream).await
+}
+
+/// Write a raw BSON object to the client stream, compressing it if the request was compressed
+pub async fn write_and_flush_with_compressor(
+    header: &Header,
+    response: &RawDocument,
+    compressor: Option<Compressor>,
+    stream: &mut GwStream,
 ) -> Result<()> {
     // The format of the response will depend on the OP which the client sent
     match header.op_code {
         OpCode::Command => unimplemented!(),
 
         // Messages are always responded to with messages
-        OpCode::Msg => write_message(header, response, stream).await,
+        OpCode::Msg => match compressor {
+            Some(compressor) => {
+                write_compressed_message(header, response, compressor, stream).await
+            }
+            None => write_message(header, response, stream).await,
+        },
+
+        // The compressed request could not be unwrapped, reply with an uncompressed message
+        OpCode::Compressed => write_message(header, response, stream).await,
 
         // Query is responded to with Reply
         OpCode::Query => {
@@ -44,15 +73,16 @@ pub async fn write_and_flush(
                 response_to: header.request_id,
                 op_code: OpCode::Reply,
             };
-            header.write_to(stream).await?;
 
-            stream.write_i32_le(0).await?; // Response flags
-            stream.write_i64_le(0).await?; // Cursor Id
-            stream.write_i32_le(0).await?; // startingFrom
-            stream.write_i32_le(1).await?; // numberReturned
+            // Response flags, cursor id, startingFrom and numberReturned
+            let mut reply_header = [0u8; 20];
+            reply_header[16..20].copy_from_slice(&1i32.to_le_bytes());
 
-            stream.write_all(response.as_bytes()).await?;
-            Ok(())
+            write_all_vectored(
+                stream,
+                &[&header.to_bytes(), &reply_header, response.as_bytes()],
+            )
+            .await
         }
 
         // Insert has no response
@@ -69,6 +99,8 @@ pub async fn write_and_flush(
 }
 
 /// Serializes the Message to bytes and writes them to `writer`.
+/// The response is written from where it is (e.g. the row returned by Postgres) along with the
+/// message prefix, it is never copied into an assembled message.
 pub async fn write_message(
     header: &Header,
     response: &RawDocument,
@@ -85,15 +117,78 @@ pub async fn write_message(
         response_to: header.request_id,
         op_code: OpCode::Msg,
     };
-    header.write_to(writer).await?;
 
-    // Write Flags
-    writer.write_u32_le(0).await?;
+    // Flags, then the payload type of the section
+    let flags_and_payload_type = [0u8; 5];
+
+    write_all_vectored(
+        writer,
+        &[
+            &header.to_bytes(),
+            &flags_and_payload_type,
+            response.as_bytes(),
+        ],
+    )
+    .await
+}
+
+/// Writes all the parts to `writer` with vectored writes, resuming after partial writes.
+async fn write_all_vectored(writer: &mut GwStream, parts: &[&[u8]]) -> Result<()> {
+    let mut parts: Vec<&[u8]> = parts.iter().copied().filter(|p| !p.is_empty()).collect();
+    let mut index = 0;
+    while index < parts.len() {
+        let slices: Vec<IoSlice> = parts[index..].iter().map(|p| IoSlice::new(p)).collect();
+        let mut written = writer.write_vectored(&slices).await?;
+        if written == 0 {
+            return Err(io::Error::from(io::ErrorKind::WriteZero).into());
+        }
+
+        while index < parts.len() && written >= parts[index].len() {
+            written -= parts[index].len();
+            index += 1;
+        }
 
-    // Write payload type + section
-    writer.write_u8(0).await?;
+        if written > 0 {
+            parts[index] = &parts[index][written..];
+        }
+    }
+
+    Ok(())
+}
+
+/// Serializes the Message and writes it to `writer` as an OP_COMPRESSED message.
+/// The message sections are fed to the compressor directly, the uncompressed OP_MSG is never assembled.
+pub async fn write_compressed_message(
+    header: &Header,
+    response: &RawDocument,
+    compressor: Compressor,
+    writer: &mut GwStream,
+) -> Result<()> {
+    let flags = 0u32.to_le_bytes();
+    let payload_type = [0u8];
+    let uncompressed_length = flags.len() + payload_type.len() + response.as_bytes().len();
+
+    // BSON usually compresses to well under half its size, the buffer grows past it if not
+    let mut compressed = buffer_pool::take_with_capacity(uncompressed_length / 2);
+    compression::compress_parts_into(
+        compressor,
+        &[&flags, &payload_type, response.as_bytes()],
+        &mut compressed,
+    )?;
+
+    let header = Header {
+        length: (Header::LENGTH + COMPRESSED_PREFIX_LENGTH + compressed.len()) as i32,
+        request_id: header.request_id,
+        response_to: header.request_id,
+        op_code: OpCode::Compressed,
+    };
+    header.write_to(writer).await?;
 
-    writer.write_all(response.as_bytes()).await?;
+    writer.write_i32_le(OpCode::Msg as i32).await?;
+    writer.write_i32_le(uncompressed_length as i32).await?;
+    writer.write_u8(compressor as u8).await?;
+    writer.write_all(&compressed).await?;
+    buffer_pool::give_back(compressed);
 
     Ok(())
 }
@@ -10,7 +10,9 @@ use std::process::{Command, Stdio};
 
 use openssl::{
     error::ErrorStack,
-    ssl::{SslAcceptor, SslAcceptorBuilder, SslMethod, SslVersion},
+    ssl::{
+        SslAcceptor, SslAcceptorBuilder, SslMethod, SslOptions, SslSessionCacheMode, SslVersion,
+    },
 };
 
 use crate::{
@@ -34,6 +36,12 @@ use crate::{
 pub type AcceptorBuilderFn =
     fn(method: SslMethod) -> std::result::Result<SslAcceptorBuilder, ErrorStack>;
 
+/// Number of TLS sessions kept by the server for session id resumption
+const TLS_SESSION_CACHE_SIZE: i32 = 20 * 1024;
+
+/// Session id context of the gateway, sessions are only resumed within the same context
+const TLS_SESSION_ID_CONTEXT: &[u8] = b"documentdb_gateway";
+
 /// Default certificate validity period in days for auto-generated certificates
 const DEFAULT_CERT_VALIDITY_DAYS: &str = "365";
 
@@ -184,5 +192,13 @@ pub fn create_tls_acceptor(
     ssl_acceptor.set_min_proto_version(Some(SslVersion::TLS1_2))?;
     ssl_acceptor.set_max_proto_version(Some(SslVersion::TLS1_3))?;
 
+    // Let reconnecting clients resume their session (through a session ticket or the session
+    // cache) instead of doing a full handshake. The ticket keys are generated with the context,
+    // so they rotate whenever the certificates are reloaded and a new acceptor is built.
+    ssl_acceptor.clear_options(SslOptions::NO_TICKET);
+    ssl_acceptor.set_session_cache_mode(SslSessionCacheMode::SERVER);
+    ssl_acceptor.set_session_cache_size(TLS_SESSION_CACHE_SIZE);
+    ssl_acceptor.set_session_id_context(TLS_SESSION_ID_CONTEXT)?;
+
     Ok(ssl_acceptor)
 }
@@ -45,6 +45,7 @@ pub fn get_service_context(
     );
 
     postgres::clean_unused_pools(service_context.clone());
+    postgres::adjust_data_pool_sizes(service_context.clone());
 
     service_context
 }
@@ -0,0 +1,70 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/telemetry/admission_metrics.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{
+    fmt::Write,
+    sync::atomic::{AtomicU64, Ordering},
+};
+
+const METRIC_NAME: &str = "documentdb_gateway_admission_requests_total";
+
+/// Outcomes of the admission control of a request.
+#[derive(Debug, Clone, Copy)]
+pub enum AdmissionOutcome {
+    Admitted,
+    Queued,
+    RateLimited,
+    ConcurrencyLimited,
+}
+
+const OUTCOMES: [(AdmissionOutcome, &str); 4] = [
+    (AdmissionOutcome::Admitted, "admitted"),
+    (AdmissionOutcome::Queued, "queued"),
+    (AdmissionOutcome::RateLimited, "rate_limited"),
+    (AdmissionOutcome::ConcurrencyLimited, "concurrency_limited"),
+];
+
+/// Counters of the admission outcomes of the requests, shared by all connections.
+#[derive(Debug)]
+pub struct AdmissionMetrics {
+    counts: [AtomicU64; OUTCOMES.len()],
+}
+
+impl AdmissionMetrics {
+    pub fn record(&self, outcome: AdmissionOutcome) {
+        self.counts[outcome as usize].fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Renders the counters in the Prometheus text exposition format.
+    pub fn render_prometheus(&self) -> String {
+        let mut output = String::new();
+        let _ = writeln!(
+            output,
+            "# HELP {METRIC_NAME} Requests by the outcome of their admission control."
+        );
+        let _ = writeln!(output, "# TYPE {METRIC_NAME} counter");
+        for (outcome, name) in OUTCOMES {
+            let _ = writeln!(
+                output,
+                "{METRIC_NAME}{{outcome=\"{name}\"}} {}",
+                self.counts[outcome as usize].load(Ordering::Relaxed)
+            );
+        }
+
+        output
+    }
+}
+
+pub static ADMISSION_METRICS: AdmissionMetrics = AdmissionMetrics {
+    counts: [
+        AtomicU64::new(0),
+        AtomicU64::new(0),
+        AtomicU64::new(0),
+        AtomicU64::new(0),
+    ],
+};
@@ -0,0 +1,74 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/telemetry/buffer_pool_metrics.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{
+    fmt::Write,
+    sync::atomic::{AtomicU64, Ordering},
+};
+
+const METRIC_NAME: &str = "documentdb_gateway_message_buffers_total";
+
+/// Outcomes of taking a message buffer from or giving it back to the buffer pool.
+#[derive(Debug, Clone, Copy)]
+pub enum BufferPoolOutcome {
+    /// A pooled buffer was reused.
+    Hit,
+    /// The pool had no buffer of the size, one was allocated.
+    Miss,
+    /// The message is larger than the pooled sizes, its buffer was allocated and freed directly.
+    Unpooled,
+    /// The pool was full when the buffer was given back, it was freed.
+    Discarded,
+}
+
+const OUTCOMES: [(BufferPoolOutcome, &str); 4] = [
+    (BufferPoolOutcome::Hit, "hit"),
+    (BufferPoolOutcome::Miss, "miss"),
+    (BufferPoolOutcome::Unpooled, "unpooled"),
+    (BufferPoolOutcome::Discarded, "discarded"),
+];
+
+/// Counters of the message buffer pool outcomes, summed over the worker threads.
+#[derive(Debug)]
+pub struct BufferPoolMetrics {
+    counts: [AtomicU64; OUTCOMES.len()],
+}
+
+impl BufferPoolMetrics {
+    pub fn record(&self, outcome: BufferPoolOutcome) {
+        self.counts[outcome as usize].fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Renders the counters in the Prometheus text exposition format.
+    pub fn render_prometheus(&self) -> String {
+        let mut output = String::new();
+        let _ = writeln!(
+            output,
+            "# HELP {METRIC_NAME} Request and response buffers by the outcome of their pooling."
+        );
+        let _ = writeln!(output, "# TYPE {METRIC_NAME} counter");
+        for (outcome, name) in OUTCOMES {
+            let _ = writeln!(
+                output,
+                "{METRIC_NAME}{{outcome=\"{name}\"}} {}",
+                self.counts[outcome as usize].load(Ordering::Relaxed)
+            );
+        }
+
+        output
+    }
+}
+
+pub static BUFFER_POOL_METRICS: BufferPoolMetrics = BufferPoolMetrics {
+    counts: [
+        AtomicU64::new(0),
+        AtomicU64::new(0),
+        AtomicU64::new(0),
+        AtomicU64::new(0),
+    ],
+};
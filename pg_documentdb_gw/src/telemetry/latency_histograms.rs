@@ -0,0 +1,318 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/telemetry/latency_histograms.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use std::{
+    collections::HashMap,
+    fmt::Write,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc, RwLock,
+    },
+};
+
+use once_cell::sync::Lazy;
+
+use crate::requests::{request_tracker::RequestTracker, RequestIntervalKind, RequestType};
+
+/// Number of bits of sub buckets per power of two, buckets are at most 1/8th of their value wide.
+const SUB_BUCKET_BITS: u32 = 3;
+const SUB_BUCKET_COUNT: usize = 1 << SUB_BUCKET_BITS;
+
+/// Largest power of two tracked (2^40 ns is ~18 minutes), larger values land in the last bucket.
+const MAX_EXPONENT: u32 = 40;
+
+const BUCKET_COUNT: usize = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) as usize * SUB_BUCKET_COUNT;
+
+/// Maximum number of databases tracked, the rest are grouped under one database.
+const MAX_TRACKED_DATABASES: usize = 64;
+const OVERFLOW_DATABASE: &str = "_other";
+
+/// Quantiles exported for every histogram.
+const EXPORTED_QUANTILES: [f64; 4] = [0.5, 0.9, 0.99, 0.999];
+
+/// Intervals of a request that are exported, with their metric label.
+const EXPORTED_INTERVALS: [(RequestIntervalKind, &str); 6] = [
+    (RequestIntervalKind::BufferRead, "buffer_read"),
+    (RequestIntervalKind::FormatRequest, "format_request"),
+    (RequestIntervalKind::ProcessRequest, "process_request"),
+    (RequestIntervalKind::FormatResponse, "format_response"),
+    (RequestIntervalKind::WriteResponse, "write_response"),
+    (RequestIntervalKind::HandleRequest, "handle_request"),
+];
+
+const METRIC_NAME: &str = "documentdb_gateway_request_interval_seconds";
+
+/// A log-linear (HDR style) histogram of durations in nanoseconds.
+///
+/// Recording is lock free so the histogram can be shared across connections.
+#[derive(Debug)]
+pub struct LatencyHistogram {
+    buckets: Box<[AtomicU64]>,
+    count: AtomicU64,
+    sum_nanos: AtomicU64,
+}
+
+impl Default for LatencyHistogram {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl LatencyHistogram {
+    pub fn new() -> Self {
+        LatencyHistogram {
+            buckets: (0..BUCKET_COUNT).map(|_| AtomicU64::new(0)).collect(),
+            count: AtomicU64::new(0),
+            sum_nanos: AtomicU64::new(0),
+        }
+    }
+
+    pub fn record(&self, nanos: u64) {
+        self.buckets[bucket_index(nanos)].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum_nanos.fetch_add(nanos, Ordering::Relaxed);
+    }
+
+    pub fn count(&self) -> u64 {
+        self.count.load(Ordering::Relaxed)
+    }
+
+    pub fn sum_nanos(&self) -> u64 {
+        self.sum_nanos.load(Ordering::Relaxed)
+    }
+
+    /// Returns the value at the quantile (0 to 1), within the precision of its bucket.
+    pub fn value_at_quantile(&self, quantile: f64) -> u64 {
+        let counts: Vec<u64> = self
+            .buckets
+            .iter()
+            .map(|bucket| bucket.load(Ordering::Relaxed))
+            .collect();
+        let total: u64 = counts.iter().sum();
+        if total == 0 {
+            return 0;
+        }
+
+        let rank = ((quantile.clamp(0.0, 1.0) * total as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (index, count) in counts.iter().enumerate() {
+            seen += count;
+            if seen >= rank {
+                return bucket_midpoint(index);
+            }
+        }
+
+        bucket_midpoint(BUCKET_COUNT - 1)
+    }
+}
+
+fn bucket_index(nanos: u64) -> usize {
+    if nanos < SUB_BUCKET_COUNT as u64 {
+        return nanos as usize;
+    }
+
+    let exponent = 63 - nanos.leading_zeros();
+    if exponent > MAX_EXPONENT {
+        return BUCKET_COUNT - 1;
+    }
+
+    let sub_bucket = (nanos >> (exponent - SUB_BUCKET_BITS)) as usize & (SUB_BUCKET_COUNT - 1);
+    (exponent - SUB_BUCKET_BITS + 1) as usize * SUB_BUCKET_COUNT + sub_bucket
+}
+
+fn bucket_midpoint(index: usize) -> u64 {
+    if index < SUB_BUCKET_COUNT {
+        return index as u64;
+    }
+
+    let exponent = (index / SUB_BUCKET_COUNT) as u32 + SUB_BUCKET_BITS - 1;
+    let sub_bucket = (index % SUB_BUCKET_COUNT) as u64;
+    let width = 1u64 << (exponent - SUB_BUCKET_BITS);
+    (SUB_BUCKET_COUNT as u64 + sub_bucket) * width + width / 2
+}
+
+/// The histograms of every exported interval for one (database, command) pair.
+#[derive(Debug)]
+struct IntervalHistograms {
+    histograms: [LatencyHistogram; EXPORTED_INTERVALS.len()],
+}
+
+impl IntervalHistograms {
+    fn new() -> Self {
+        IntervalHistograms {
+            histograms: std::array::from_fn(|_| LatencyHistogram::new()),
+        }
+    }
+}
+
+/// Per command, per database latency histograms of the request intervals.
+///
+/// The histograms are keyed by database and then by request type, so that a request finds its
+/// histograms without building an owned key.
+#[derive(Debug, Default)]
+pub struct RequestLatencyHistograms {
+    entries: RwLock<HashMap<String, HashMap<RequestType, Arc<IntervalHistograms>>>>,
+}
+
+// Global singleton
+pub static REQUEST_LATENCY_HISTOGRAMS: Lazy<RequestLatencyHistograms> =
+    Lazy::new(RequestLatencyHistograms::default);
+
+impl RequestLatencyHistograms {
+    /// Records the intervals of a completed request, intervals that were not hit are skipped.
+    pub fn record(&self, database: &str, command: RequestType, tracker: &RequestTracker) {
+        let histograms = self.get_or_create(database, command);
+        for (index, (interval, _)) in EXPORTED_INTERVALS.iter().enumerate() {
+            let nanos = tracker.get_interval_elapsed_time(*interval);
+            if nanos > 0 {
+                histograms.histograms[index].record(nanos as u64);
+            }
+        }
+    }
+
+    fn get_or_create(&self, database: &str, command: RequestType) -> Arc<IntervalHistograms> {
+        {
+            let entries = self.entries.read().unwrap_or_else(|e| e.into_inner());
+            if let Some(histograms) = entries
+                .get(database)
+                .and_then(|commands| commands.get(&command))
+            {
+                return Arc::clone(histograms);
+            }
+        }
+
+        let mut entries = self.entries.write().unwrap_or_else(|e| e.into_inner());
+        let database = if entries.contains_key(database) || entries.len() < MAX_TRACKED_DATABASES {
+            database
+        } else {
+            OVERFLOW_DATABASE
+        };
+
+        Arc::clone(
+            entries
+                .entry(database.to_owned())
+                .or_default()
+                .entry(command)
+                .or_insert_with(|| Arc::new(IntervalHistograms::new())),
+        )
+    }
+
+    /// Renders the histograms as summaries in the Prometheus text exposition format.
+    pub fn render_prometheus(&self) -> String {
+        let mut output = String::new();
+        let _ = writeln!(
+            output,
+            "# HELP {METRIC_NAME} Duration of the intervals of requests handled by the gateway."
+        );
+        let _ = writeln!(output, "# TYPE {METRIC_NAME} summary");
+
+        let entries = self.entries.read().unwrap_or_else(|e| e.into_inner());
+        let mut series: Vec<(&String, String, &Arc<IntervalHistograms>)> = entries
+            .iter()
+            .flat_map(|(database, commands)| {
+                commands
+                    .iter()
+                    .map(move |(command, histograms)| (database, command.to_string(), histograms))
+            })
+            .collect();
+        series.sort_by(|left, right| (left.0, &left.1).cmp(&(right.0, &right.1)));
+
+        for (database, command, histograms) in series {
+            for (index, (_, interval_name)) in EXPORTED_INTERVALS.iter().enumerate() {
+                let histogram = &histograms.histograms[index];
+                let count = histogram.count();
+                if count == 0 {
+                    continue;
+                }
+
+                let labels = format!(
+                    "database=\"{}\",command=\"{}\",interval=\"{interval_name}\"",
+                    escape_label_value(database),
+                    escape_label_value(&command)
+                );
+
+                for quantile in EXPORTED_QUANTILES {
+                    let _ = writeln!(
+                        output,
+                        "{METRIC_NAME}{{{labels},quantile=\"{quantile}\"}} {}",
+                        nanos_to_seconds(histogram.value_at_quantile(quantile))
+                    );
+                }
+
+                let _ = writeln!(
+                    output,
+                    "{METRIC_NAME}_sum{{{labels}}} {}",
+                    nanos_to_seconds(histogram.sum_nanos())
+                );
+                let _ = writeln!(output, "{METRIC_NAME}_count{{{labels}}} {count}");
+            }
+        }
+
+        output
+    }
+}
+
+fn nanos_to_seconds(nanos: u64) -> f64 {
+    nanos as f64 / 1_000_000_000.0
+}
+
+fn escape_label_value(value: &str) -> String {
+    value
+        .replace('\\', "\\\\")
+        .replace('"', "\\\"")
+        .replace('\n', "\\n")
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bucket_index_is_monotonic_and_contiguous() {
+        let mut previous = 0;
+        for nanos in 0..100_000u64 {
+            let index = bucket_index(nanos);
+            assert!(index == previous || index == previous + 1);
+            previous = index;
+        }
+
+        assert_eq!(bucket_index(u64::MAX), BUCKET_COUNT - 1);
+    }
+
+    #[test]
+    fn test_quantiles_within_bucket_precision() {
+        let histogram = LatencyHistogram::new();
+        for nanos in 1..=10_000u64 {
+            histogram.record(nanos * 1000);
+        }
+
+        assert_eq!(histogram.count(), 10_000);
+        for (quantile, expected) in [(0.5, 5_000_000f64), (0.99, 9_900_000f64)] {
+            let value = histogram.value_at_quantile(quantile) as f64;
+            assert!(
+                (value - expected).abs() / expected < 0.07,
+                "{quantile}: {value}"
+            );
+        }
+    }
+
+    #[test]
+    fn test_render_prometheus_escapes_labels() {
+        let histograms = RequestLatencyHistograms::default();
+        let mut tracker = RequestTracker::new();
+        tracker.request_interval_metrics_array[RequestIntervalKind::ProcessRequest as usize] =
+            1_000_000;
+        histograms.record("my\"db", RequestType::Find, &tracker);
+
+        let output = histograms.render_prometheus();
+        assert!(output.contains(
+            "documentdb_gateway_request_interval_seconds_count{database=\"my\\\"db\",command=\"Find\",interval=\"process_request\"} 1"
+        ));
+        assert!(!output.contains("interval=\"buffer_read\""));
+    }
+}
@@ -0,0 +1,95 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) Microsoft Corporation.  All rights reserved.
+ *
+ * src/telemetry/metrics_endpoint.rs
+ *
+ *-------------------------------------------------------------------------
+ */
+
+use tokio::{
+    io::{AsyncReadExt, AsyncWriteExt},
+    net::{TcpListener, TcpStream},
+};
+use tokio_util::sync::CancellationToken;
+
+use crate::{
+    error::Result,
+    telemetry::{
+        admission_metrics::ADMISSION_METRICS, buffer_pool_metrics::BUFFER_POOL_METRICS,
+        latency_histograms::REQUEST_LATENCY_HISTOGRAMS,
+    },
+};
+
+/// Maximum size of the request head read from a scraper.
+const MAX_REQUEST_HEAD_SIZE: usize = 8 * 1024;
+
+const METRICS_PATH: &str = "/metrics";
+
+/// Serves the gateway latency histograms, admission and buffer pool counters in the Prometheus text format over plain HTTP
+/// until the cancellation token is triggered.
+pub async fn run_metrics_endpoint(address: String, token: CancellationToken) -> Result<()> {
+    let listener = TcpListener::bind(&address).await?;
+    log::info!("Serving gateway metrics on {address}{METRICS_PATH}");
+
+    loop {
+        tokio::select! {
+            stream_and_address = listener.accept() => {
+                match stream_and_address {
+                    Ok((stream, _)) => {
+                        tokio::spawn(async move {
+                            if let Err(e) = handle_metrics_request(stream).await {
+                                log::warn!("Failed to serve metrics request: {e:?}.");
+                            }
+                        });
+                    }
+                    Err(e) => log::warn!("Failed to accept a metrics connection: {e:?}."),
+                }
+            }
+            () = token.cancelled() => {
+                return Ok(())
+            }
+        }
+    }
+}
+
+async fn handle_metrics_request(mut stream: TcpStream) -> Result<()> {
+    let mut head = Vec::with_capacity(1024);
+    let mut buffer = [0u8; 1024];
+    while !head.windows(4).any(|window| window == b"\r\n\r\n") {
+        let read = stream.read(&mut buffer).await?;
+        if read == 0 || head.len() + read > MAX_REQUEST_HEAD_SIZE {
+            break;
+        }
+
+        head.extend_from_slice(&buffer[..read]);
+    }
+
+    let request_line = head
+        .split(|byte| *byte == b'\n')
+        .next()
+        .map(|line| String::from_utf8_lossy(line).into_owned())
+        .unwrap_or_default();
+    let mut parts = request_line.split_whitespace();
+    let method = parts.next().unwrap_or_default();
+    let path = parts.next().unwrap_or_default();
+
+    let (status, content_type, body) = if method == "GET" && path == METRICS_PATH {
+        (
+            "200 OK",
+            "text/plain; version=0.0.4",
+            REQUEST_LATENCY_HISTOGRAMS.render_prometheus()
+                + &ADMISSION_METRICS.render_prometheus()
+                + &BUFFER_POOL_METRICS.render_prometheus(),
+        )
+    } else {
+        ("404 Not Found", "text/plain", String::new())
+    };
+
+    let response = format!(
+        "HTTP/1.1 {status}\r\nContent-Type: {content_type}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{body}",
+        body.len()
+    );
+    stream.write_all(response.as_bytes()).await?;
+    stream.shutdown().await?;
+    Ok(())
+}
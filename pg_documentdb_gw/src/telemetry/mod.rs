@@ -6,8 +6,12 @@
  *-------------------------------------------------------------------------
  */
 
+pub mod admission_metrics;
+pub mod buffer_pool_metrics;
 pub mod client_info;
 pub mod event_id;
+pub mod latency_histograms;
+pub mod metrics_endpoint;
 
 use crate::{
     context::ConnectionContext,
@@ -48,6 +52,7 @@ pub fn error_code_to_status_code(error: i32) -> u16 {
         Some(ErrorCode::InternalError) => 500,
         Some(ErrorCode::ExceededTimeLimit) => 408,
         Some(ErrorCode::DuplicateKey) => 409,
+        Some(ErrorCode::IngressRequestRateLimitExceeded) => 429,
         _ => 400,
     }
 }